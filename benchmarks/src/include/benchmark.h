@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * Copyright 2008-2025 by Aerospike.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ******************************************************************************/
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_event.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==========================================================
+// Constants
+//
+
+// Histogram sub-buckets per power of two. Recorded values are exact below
+// BENCH_HIST_SUB_COUNT and within 1/64 of the true value above it.
+#define BENCH_HIST_SUB_BITS 7
+#define BENCH_HIST_SUB_COUNT (1 << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_HALF_COUNT (BENCH_HIST_SUB_COUNT / 2)
+
+// Maximum bins written per record.
+#define BENCH_MAX_BINS 128
+
+// Largest power of two tracked. Larger values are recorded in the last bucket.
+#define BENCH_HIST_MAX_BIT 40
+
+#define BENCH_HIST_SIZE \
+	(BENCH_HIST_SUB_COUNT + (BENCH_HIST_MAX_BIT - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_HALF_COUNT)
+
+//==========================================================
+// Types
+//
+
+typedef enum {
+	BENCH_MODE_SYNC,
+	BENCH_MODE_ASYNC,
+	BENCH_MODE_PIPELINE
+} bench_mode;
+
+typedef enum {
+	BENCH_DIST_UNIFORM,
+	BENCH_DIST_ZIPF
+} bench_dist;
+
+typedef enum {
+	BENCH_VALUE_BYTES,
+	BENCH_VALUE_INT
+} bench_value;
+
+typedef struct bench_config_s {
+	char host[256];
+	int port;
+	char user[AS_USER_SIZE];
+	char password[AS_PASSWORD_SIZE];
+	char ns[AS_NAMESPACE_MAX_SIZE];
+	char set[AS_SET_MAX_SIZE];
+	const char* output;
+
+	bench_mode mode;
+	bench_dist dist;
+	bench_value value_type;
+
+	uint64_t start_key;
+	uint64_t keys;
+	double zipf_theta;
+
+	// Percent of commands that are reads. The rest are writes.
+	uint32_t read_pct;
+	uint32_t bins;
+	uint32_t bin_size;
+
+	// Keys per read command. Reads use batch commands when greater than one.
+	uint32_t batch_size;
+
+	// Sync benchmark threads.
+	uint32_t threads;
+
+	// Async event loops and the total number of commands kept in flight.
+	uint32_t event_loops;
+	uint32_t concurrency;
+
+	// Target commands per second. Zero is unlimited.
+	uint64_t tps;
+	uint32_t warmup_sec;
+	uint32_t duration_sec;
+	uint32_t timeout_ms;
+
+	// Write every key once in order before the measured run.
+	bool populate;
+	bool quiet;
+} bench_config;
+
+typedef struct bench_histogram_s {
+	uint64_t counts[BENCH_HIST_SIZE];
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+} bench_histogram;
+
+typedef struct bench_zipf_s {
+	uint64_t n;
+	double theta;
+	double alpha;
+	double zetan;
+	double eta;
+	double half_pow;
+} bench_zipf;
+
+typedef struct bench_counters_s {
+	uint64_t count;
+	uint64_t errors;
+	uint64_t timeouts;
+	uint64_t not_found;
+} bench_counters;
+
+// Statistics and random state owned by one sync thread or one event loop.
+typedef struct bench_worker_s {
+	struct bench_s* bench;
+	as_event_loop* event_loop;
+	uint64_t rng;
+	bench_counters reads;
+	bench_counters writes;
+	bench_histogram read_latency;
+	bench_histogram write_latency;
+	uint8_t* value;
+	pthread_t thread;
+} bench_worker;
+
+// Async command slot. Slots are reused for the whole run.
+typedef struct bench_command_s {
+	bench_worker* worker;
+	as_batch_records* records;
+	uint64_t rng;
+	uint64_t begin_ns;
+	bool is_read;
+	bool busy;
+} bench_command;
+
+typedef struct bench_s {
+	bench_config* config;
+	aerospike as;
+	bench_zipf zipf;
+	bench_worker* workers;
+	uint32_t n_workers;
+	bench_command* commands;
+	as_bin_name* bin_names;
+
+	// Set by the main thread. Read by workers.
+	volatile bool running;
+	volatile bool recording;
+
+	// Async commands in flight over all event loops.
+	uint32_t in_flight;
+
+	uint64_t begin_ns;
+	uint64_t end_ns;
+} bench;
+
+//==========================================================
+// Functions
+//
+
+void bench_histogram_init(bench_histogram* h);
+void bench_histogram_add(bench_histogram* h, uint64_t value);
+void bench_histogram_merge(bench_histogram* dst, const bench_histogram* src);
+uint64_t bench_histogram_percentile(const bench_histogram* h, double percentile);
+
+uint64_t bench_random(uint64_t* state);
+void bench_zipf_init(bench_zipf* z, uint64_t n, double theta);
+uint64_t bench_zipf_next(const bench_zipf* z, uint64_t* state);
+uint64_t bench_next_key(bench* b, uint64_t* rng);
+
+as_batch_records* bench_batch_create(bench* b);
+bool bench_populate(bench* b);
+bool bench_run_sync(bench* b);
+bool bench_run_async(bench* b);
+void bench_async_wait(bench* b);
+
+void bench_report(bench* b, FILE* out);
+uint64_t bench_now_ns(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * Copyright 2008-2025 by Aerospike.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ******************************************************************************/
+#include "benchmark.h"
+
+#include <string.h>
+
+//==========================================================
+// Static Functions
+//
+
+static inline uint32_t
+bench_histogram_index(uint64_t value)
+{
+	if (value < BENCH_HIST_SUB_COUNT) {
+		return (uint32_t)value;
+	}
+
+	uint32_t msb = 63 - (uint32_t)__builtin_clzll(value);
+
+	if (msb > BENCH_HIST_MAX_BIT) {
+		return BENCH_HIST_SIZE - 1;
+	}
+
+	uint32_t sub = (uint32_t)(value >> (msb - BENCH_HIST_SUB_BITS + 1));
+
+	return BENCH_HIST_SUB_COUNT + (msb - BENCH_HIST_SUB_BITS) * BENCH_HIST_HALF_COUNT +
+		(sub - BENCH_HIST_HALF_COUNT);
+}
+
+// Return midpoint of values recorded in bucket.
+static uint64_t
+bench_histogram_value(uint32_t index)
+{
+	if (index < BENCH_HIST_SUB_COUNT) {
+		return index;
+	}
+
+	uint32_t offset = index - BENCH_HIST_SUB_COUNT;
+	uint32_t shift = offset / BENCH_HIST_HALF_COUNT + 1;
+	uint64_t sub = offset % BENCH_HIST_HALF_COUNT + BENCH_HIST_HALF_COUNT;
+
+	return (sub << shift) + (((uint64_t)1 << shift) >> 1);
+}
+
+//==========================================================
+// Functions
+//
+
+void
+bench_histogram_init(bench_histogram* h)
+{
+	memset(h, 0, sizeof(bench_histogram));
+	h->min = UINT64_MAX;
+}
+
+void
+bench_histogram_add(bench_histogram* h, uint64_t value)
+{
+	h->counts[bench_histogram_index(value)]++;
+	h->total++;
+	h->sum += value;
+
+	if (value < h->min) {
+		h->min = value;
+	}
+
+	if (value > h->max) {
+		h->max = value;
+	}
+}
+
+void
+bench_histogram_merge(bench_histogram* dst, const bench_histogram* src)
+{
+	for (uint32_t i = 0; i < BENCH_HIST_SIZE; i++) {
+		dst->counts[i] += src->counts[i];
+	}
+	dst->total += src->total;
+	dst->sum += src->sum;
+
+	if (src->min < dst->min) {
+		dst->min = src->min;
+	}
+
+	if (src->max > dst->max) {
+		dst->max = src->max;
+	}
+}
+
+uint64_t
+bench_histogram_percentile(const bench_histogram* h, double percentile)
+{
+	if (h->total == 0) {
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t)(percentile / 100.0 * (double)h->total + 0.5);
+
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	uint64_t seen = 0;
+
+	for (uint32_t i = 0; i < BENCH_HIST_SIZE; i++) {
+		seen += h->counts[i];
+
+		if (seen >= rank) {
+			uint64_t value = bench_histogram_value(i);
+
+			// Bucket midpoint may fall outside the recorded range.
+			if (value < h->min) {
+				return h->min;
+			}
+
+			if (value > h->max) {
+				return h->max;
+			}
+			return value;
+		}
+	}
+	return h->max;
+}
@@ -0,0 +1,671 @@
+/*******************************************************************************
+ * Copyright 2008-2025 by Aerospike.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ******************************************************************************/
+#include "benchmark.h"
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_batch.h>
+#include <aerospike/version.h>
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//==========================================================
+// Constants
+//
+
+static const char* g_short_opts = "h:p:U:P:n:s:k:K:r:b:o:T:B:z:l:c:m:D:Z:g:w:d:t:j:Iqu";
+
+static const struct option g_long_opts[] = {
+	{"hosts",         required_argument, 0, 'h'},
+	{"port",          required_argument, 0, 'p'},
+	{"user",          required_argument, 0, 'U'},
+	{"password",      required_argument, 0, 'P'},
+	{"namespace",     required_argument, 0, 'n'},
+	{"set",           required_argument, 0, 's'},
+	{"keys",          required_argument, 0, 'k'},
+	{"start-key",     required_argument, 0, 'K'},
+	{"read-pct",      required_argument, 0, 'r'},
+	{"bins",          required_argument, 0, 'b'},
+	{"bin-size",      required_argument, 0, 'o'},
+	{"value-type",    required_argument, 0, 'T'},
+	{"batch-size",    required_argument, 0, 'B'},
+	{"threads",       required_argument, 0, 'z'},
+	{"event-loops",   required_argument, 0, 'l'},
+	{"concurrency",   required_argument, 0, 'c'},
+	{"mode",          required_argument, 0, 'm'},
+	{"distribution",  required_argument, 0, 'D'},
+	{"zipf-theta",    required_argument, 0, 'Z'},
+	{"tps",           required_argument, 0, 'g'},
+	{"warmup",        required_argument, 0, 'w'},
+	{"duration",      required_argument, 0, 'd'},
+	{"timeout",       required_argument, 0, 't'},
+	{"json",          required_argument, 0, 'j'},
+	{"populate",      no_argument,       0, 'I'},
+	{"quiet",         no_argument,       0, 'q'},
+	{"usage",         no_argument,       0, 'u'},
+	{0, 0, 0, 0}
+};
+
+static const char* g_mode_names[] = {"sync", "async", "pipeline"};
+static const char* g_dist_names[] = {"uniform", "zipf"};
+static const char* g_value_names[] = {"bytes", "int"};
+
+#if defined(AS_USE_LIBEV)
+static const char* g_event_lib = "libev";
+#elif defined(AS_USE_LIBUV)
+static const char* g_event_lib = "libuv";
+#elif defined(AS_USE_LIBEVENT)
+static const char* g_event_lib = "libevent";
+#else
+static const char* g_event_lib = "none";
+#endif
+
+//==========================================================
+// Static Functions
+//
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+		"Usage: benchmark [options]\n\n"
+		"  -h, --hosts <host>          Seed host. Default: 127.0.0.1\n"
+		"  -p, --port <port>           Seed port. Default: 3000\n"
+		"  -U, --user <user>           User name.\n"
+		"  -P, --password <password>   Password.\n"
+		"  -n, --namespace <ns>        Namespace. Default: test\n"
+		"  -s, --set <set>             Set name. Default: bench\n"
+		"  -k, --keys <count>          Number of keys. Default: 1000000\n"
+		"  -K, --start-key <key>       First integer key. Default: 0\n"
+		"  -r, --read-pct <percent>    Percent of commands that are reads. Default: 50\n"
+		"  -b, --bins <count>          Bins per record. Default: 1\n"
+		"  -o, --bin-size <bytes>      Size of bytes bin values. Default: 100\n"
+		"  -T, --value-type <type>     bytes | int. Default: bytes\n"
+		"  -B, --batch-size <keys>     Keys per read. Batch reads are used when > 1. Default: 1\n"
+		"  -z, --threads <count>       Sync threads. Default: 16\n"
+		"  -l, --event-loops <count>   Async event loops. Default: 1\n"
+		"  -c, --concurrency <count>   Async commands in flight. Default: 100\n"
+		"  -m, --mode <mode>           sync | async | pipeline. Default: sync\n"
+		"  -D, --distribution <dist>   uniform | zipf. Default: uniform\n"
+		"  -Z, --zipf-theta <theta>    Zipf skew between 0 and 1. Default: 0.99\n"
+		"  -g, --tps <count>           Target commands per second. Default: 0 (unlimited)\n"
+		"  -w, --warmup <seconds>      Unmeasured warmup. Default: 5\n"
+		"  -d, --duration <seconds>    Measured run time. Default: 30\n"
+		"  -t, --timeout <ms>          Command total timeout. Default: 1000\n"
+		"  -j, --json <file>           Write JSON report to file instead of stdout.\n"
+		"  -I, --populate              Write all keys once before the run.\n"
+		"  -q, --quiet                 Do not print per second progress.\n"
+		"  -u, --usage                 Print this message.\n");
+}
+
+static bool
+parse_name(const char* arg, const char** names, uint32_t n, uint32_t* out)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		if (strcmp(arg, names[i]) == 0) {
+			*out = i;
+			return true;
+		}
+	}
+	fprintf(stderr, "Invalid value: %s\n", arg);
+	return false;
+}
+
+static bool
+copy_arg(char* trg, const char* arg, size_t size)
+{
+	if (strlen(arg) >= size) {
+		fprintf(stderr, "Value too long: %s\n", arg);
+		return false;
+	}
+	strcpy(trg, arg);
+	return true;
+}
+
+static bool
+parse_opts(bench_config* c, int argc, char* argv[])
+{
+	memset(c, 0, sizeof(bench_config));
+	strcpy(c->host, "127.0.0.1");
+	c->port = 3000;
+	strcpy(c->ns, "test");
+	strcpy(c->set, "bench");
+	c->keys = 1000000;
+	c->zipf_theta = 0.99;
+	c->read_pct = 50;
+	c->bins = 1;
+	c->bin_size = 100;
+	c->batch_size = 1;
+	c->threads = 16;
+	c->event_loops = 1;
+	c->concurrency = 100;
+	c->warmup_sec = 5;
+	c->duration_sec = 30;
+	c->timeout_ms = 1000;
+
+	uint32_t v;
+	int opt;
+	int i;
+
+	while ((opt = getopt_long(argc, argv, g_short_opts, g_long_opts, &i)) != -1) {
+		switch (opt) {
+			case 'h':
+				if (! copy_arg(c->host, optarg, sizeof(c->host))) {
+					return false;
+				}
+				break;
+
+			case 'p':
+				c->port = atoi(optarg);
+				break;
+
+			case 'U':
+				if (! copy_arg(c->user, optarg, sizeof(c->user))) {
+					return false;
+				}
+				break;
+
+			case 'P':
+				if (! copy_arg(c->password, optarg, sizeof(c->password))) {
+					return false;
+				}
+				break;
+
+			case 'n':
+				if (! copy_arg(c->ns, optarg, sizeof(c->ns))) {
+					return false;
+				}
+				break;
+
+			case 's':
+				if (! copy_arg(c->set, optarg, sizeof(c->set))) {
+					return false;
+				}
+				break;
+
+			case 'k':
+				c->keys = strtoull(optarg, NULL, 10);
+				break;
+
+			case 'K':
+				c->start_key = strtoull(optarg, NULL, 10);
+				break;
+
+			case 'r':
+				c->read_pct = (uint32_t)atoi(optarg);
+				break;
+
+			case 'b':
+				c->bins = (uint32_t)atoi(optarg);
+				break;
+
+			case 'o':
+				c->bin_size = (uint32_t)atoi(optarg);
+				break;
+
+			case 'T':
+				if (! parse_name(optarg, g_value_names, 2, &v)) {
+					return false;
+				}
+				c->value_type = (bench_value)v;
+				break;
+
+			case 'B':
+				c->batch_size = (uint32_t)atoi(optarg);
+				break;
+
+			case 'z':
+				c->threads = (uint32_t)atoi(optarg);
+				break;
+
+			case 'l':
+				c->event_loops = (uint32_t)atoi(optarg);
+				break;
+
+			case 'c':
+				c->concurrency = (uint32_t)atoi(optarg);
+				break;
+
+			case 'm':
+				if (! parse_name(optarg, g_mode_names, 3, &v)) {
+					return false;
+				}
+				c->mode = (bench_mode)v;
+				break;
+
+			case 'D':
+				if (! parse_name(optarg, g_dist_names, 2, &v)) {
+					return false;
+				}
+				c->dist = (bench_dist)v;
+				break;
+
+			case 'Z':
+				c->zipf_theta = atof(optarg);
+				break;
+
+			case 'g':
+				c->tps = strtoull(optarg, NULL, 10);
+				break;
+
+			case 'w':
+				c->warmup_sec = (uint32_t)atoi(optarg);
+				break;
+
+			case 'd':
+				c->duration_sec = (uint32_t)atoi(optarg);
+				break;
+
+			case 't':
+				c->timeout_ms = (uint32_t)atoi(optarg);
+				break;
+
+			case 'j':
+				c->output = optarg;
+				break;
+
+			case 'I':
+				c->populate = true;
+				break;
+
+			case 'q':
+				c->quiet = true;
+				break;
+
+			case 'u':
+			default:
+				usage();
+				return false;
+		}
+	}
+
+	if (c->keys == 0 || c->read_pct > 100 || c->bins == 0 || c->bins > BENCH_MAX_BINS ||
+		c->batch_size == 0 || c->threads == 0 || c->event_loops == 0 || c->concurrency == 0 ||
+		c->duration_sec == 0) {
+		fprintf(stderr, "Invalid option value\n");
+		usage();
+		return false;
+	}
+
+	if (c->dist == BENCH_DIST_ZIPF && (c->keys < 3 || c->zipf_theta <= 0 || c->zipf_theta >= 1)) {
+		fprintf(stderr, "Zipf requires at least 3 keys and theta between 0 and 1\n");
+		return false;
+	}
+
+	if (c->mode == BENCH_MODE_PIPELINE && c->batch_size > 1) {
+		fprintf(stderr, "Batch commands can not be pipelined\n");
+		return false;
+	}
+
+#if ! AS_EVENT_LIB_DEFINED
+	if (c->mode != BENCH_MODE_SYNC) {
+		fprintf(stderr, "Async modes require building with EVENT_LIB\n");
+		return false;
+	}
+#endif
+	return true;
+}
+
+static bool
+bench_init(bench* b, bench_config* c)
+{
+	memset(b, 0, sizeof(bench));
+	b->config = c;
+
+	if (c->dist == BENCH_DIST_ZIPF) {
+		bench_zipf_init(&b->zipf, c->keys, c->zipf_theta);
+	}
+
+	b->bin_names = malloc(sizeof(as_bin_name) * c->bins);
+
+	for (uint32_t i = 0; i < c->bins; i++) {
+		snprintf(b->bin_names[i], sizeof(as_bin_name), "b%u", i);
+	}
+
+	b->n_workers = (c->mode == BENCH_MODE_SYNC) ? c->threads : c->event_loops;
+	b->workers = calloc(b->n_workers, sizeof(bench_worker));
+
+	uint64_t seed = bench_now_ns();
+
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		bench_worker* w = &b->workers[i];
+		w->bench = b;
+		w->rng = seed + (i + 1) * 0x9E3779B97F4A7C15ULL;
+		bench_histogram_init(&w->read_latency);
+		bench_histogram_init(&w->write_latency);
+		w->value = malloc(c->bin_size ? c->bin_size : 1);
+
+		for (uint32_t j = 0; j < c->bin_size; j++) {
+			w->value[j] = (uint8_t)bench_random(&w->rng);
+		}
+	}
+
+	if (c->mode != BENCH_MODE_SYNC) {
+		b->commands = calloc(c->concurrency, sizeof(bench_command));
+
+		for (uint32_t i = 0; i < c->concurrency; i++) {
+			bench_command* cmd = &b->commands[i];
+			cmd->worker = &b->workers[i % b->n_workers];
+			cmd->rng = seed ^ ((i + 1) * 0xBF58476D1CE4E5B9ULL);
+
+			if (c->batch_size > 1) {
+				// Records are reset and reused by every batch read on this slot.
+				cmd->records = bench_batch_create(b);
+			}
+		}
+	}
+	return true;
+}
+
+static void
+bench_destroy(bench* b)
+{
+	if (b->commands) {
+		for (uint32_t i = 0; i < b->config->concurrency; i++) {
+			if (b->commands[i].records) {
+				as_batch_records_destroy(b->commands[i].records);
+			}
+		}
+		free(b->commands);
+	}
+
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		free(b->workers[i].value);
+	}
+	free(b->workers);
+	free(b->bin_names);
+}
+
+static bool
+bench_connect(bench* b)
+{
+	bench_config* c = b->config;
+
+#if AS_EVENT_LIB_DEFINED
+	if (c->mode != BENCH_MODE_SYNC) {
+		if (! as_event_create_loops(c->event_loops)) {
+			fprintf(stderr, "Failed to create event loops\n");
+			return false;
+		}
+
+		for (uint32_t i = 0; i < b->n_workers; i++) {
+			b->workers[i].event_loop = as_event_loop_get_by_index(i);
+		}
+	}
+#endif
+
+	as_config config;
+	as_config_init(&config);
+
+	if (! as_config_add_hosts(&config, c->host, (uint16_t)c->port)) {
+		fprintf(stderr, "Invalid host(s) %s\n", c->host);
+		as_event_close_loops();
+		return false;
+	}
+
+	as_config_set_user(&config, c->user, c->password);
+	config.policies.read.base.total_timeout = c->timeout_ms;
+	config.policies.write.base.total_timeout = c->timeout_ms;
+	config.policies.batch.base.total_timeout = c->timeout_ms;
+
+	uint32_t conns = c->concurrency / c->event_loops + 1;
+
+	if (config.async_max_conns_per_node < conns) {
+		config.async_max_conns_per_node = conns;
+	}
+
+	aerospike_init(&b->as, &config);
+
+	as_error err;
+
+	if (aerospike_connect(&b->as, &err) != AEROSPIKE_OK) {
+		fprintf(stderr, "aerospike_connect() returned %d - %s\n", err.code, err.message);
+		aerospike_destroy(&b->as);
+		as_event_close_loops();
+		return false;
+	}
+	return true;
+}
+
+static void
+bench_sum(bench* b, bench_counters* reads, bench_counters* writes)
+{
+	memset(reads, 0, sizeof(bench_counters));
+	memset(writes, 0, sizeof(bench_counters));
+
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		bench_worker* w = &b->workers[i];
+		reads->count += w->reads.count;
+		reads->errors += w->reads.errors + w->reads.timeouts;
+		writes->count += w->writes.count;
+		writes->errors += w->writes.errors + w->writes.timeouts;
+	}
+}
+
+static void
+bench_wait(bench* b, uint32_t seconds, bool progress)
+{
+	bench_counters prev_reads;
+	bench_counters prev_writes;
+	bench_sum(b, &prev_reads, &prev_writes);
+
+	for (uint32_t i = 1; i <= seconds && b->running; i++) {
+		sleep(1);
+
+		if (! progress) {
+			continue;
+		}
+
+		bench_counters reads;
+		bench_counters writes;
+		bench_sum(b, &reads, &writes);
+
+		fprintf(stderr, "%us reads/s=%llu writes/s=%llu errors=%llu\n", i,
+			(unsigned long long)(reads.count - prev_reads.count),
+			(unsigned long long)(writes.count - prev_writes.count),
+			(unsigned long long)(reads.errors + writes.errors));
+
+		prev_reads = reads;
+		prev_writes = writes;
+	}
+}
+
+static void
+bench_report_latency(FILE* out, const bench_histogram* h)
+{
+	fprintf(out,
+		"\"latency_us\": {\"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+		"\"p99\": %.3f, \"p99.9\": %.3f, \"p99.99\": %.3f, \"max\": %.3f}",
+		h->total ? h->min / 1000.0 : 0.0,
+		h->total ? (double)h->sum / h->total / 1000.0 : 0.0,
+		bench_histogram_percentile(h, 50) / 1000.0,
+		bench_histogram_percentile(h, 90) / 1000.0,
+		bench_histogram_percentile(h, 99) / 1000.0,
+		bench_histogram_percentile(h, 99.9) / 1000.0,
+		bench_histogram_percentile(h, 99.99) / 1000.0,
+		h->max / 1000.0);
+}
+
+static void
+bench_report_op(
+	FILE* out, const char* name, const bench_counters* c, const bench_histogram* h, double sec,
+	uint32_t keys_per_op
+	)
+{
+	fprintf(out,
+		"  \"%s\": {\"count\": %llu, \"keys\": %llu, \"errors\": %llu, \"timeouts\": %llu, "
+		"\"not_found\": %llu, \"tps\": %.1f, ",
+		name, (unsigned long long)c->count, (unsigned long long)c->count * keys_per_op,
+		(unsigned long long)c->errors, (unsigned long long)c->timeouts,
+		(unsigned long long)c->not_found, sec > 0 ? c->count / sec : 0.0);
+	bench_report_latency(out, h);
+	fprintf(out, "},\n");
+}
+
+//==========================================================
+// Functions
+//
+
+void
+bench_report(bench* b, FILE* out)
+{
+	bench_config* c = b->config;
+	bench_counters reads = {0};
+	bench_counters writes = {0};
+	bench_histogram* read_latency = malloc(sizeof(bench_histogram));
+	bench_histogram* write_latency = malloc(sizeof(bench_histogram));
+
+	bench_histogram_init(read_latency);
+	bench_histogram_init(write_latency);
+
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		bench_worker* w = &b->workers[i];
+
+		reads.count += w->reads.count;
+		reads.errors += w->reads.errors;
+		reads.timeouts += w->reads.timeouts;
+		reads.not_found += w->reads.not_found;
+		writes.count += w->writes.count;
+		writes.errors += w->writes.errors;
+		writes.timeouts += w->writes.timeouts;
+		writes.not_found += w->writes.not_found;
+		bench_histogram_merge(read_latency, &w->read_latency);
+		bench_histogram_merge(write_latency, &w->write_latency);
+	}
+
+	double sec = (b->end_ns - b->begin_ns) / 1e9;
+
+	fprintf(out, "{\n");
+	fprintf(out, "  \"client_version\": \"%s\",\n", aerospike_client_version);
+	fprintf(out, "  \"event_lib\": \"%s\",\n", g_event_lib);
+	fprintf(out,
+		"  \"config\": {\"mode\": \"%s\", \"distribution\": \"%s\", \"zipf_theta\": %.3f, "
+		"\"keys\": %llu, \"read_pct\": %u, \"bins\": %u, \"bin_size\": %u, \"value_type\": \"%s\", "
+		"\"batch_size\": %u, \"threads\": %u, \"event_loops\": %u, \"concurrency\": %u, "
+		"\"target_tps\": %llu, \"warmup_sec\": %u, \"duration_sec\": %u, \"timeout_ms\": %u},\n",
+		g_mode_names[c->mode], g_dist_names[c->dist], c->zipf_theta,
+		(unsigned long long)c->keys, c->read_pct, c->bins, c->bin_size,
+		g_value_names[c->value_type], c->batch_size,
+		c->mode == BENCH_MODE_SYNC ? c->threads : 0,
+		c->mode == BENCH_MODE_SYNC ? 0 : c->event_loops,
+		c->mode == BENCH_MODE_SYNC ? c->threads : c->concurrency,
+		(unsigned long long)c->tps, c->warmup_sec, c->duration_sec, c->timeout_ms);
+	fprintf(out, "  \"elapsed_sec\": %.3f,\n", sec);
+	bench_report_op(out, "reads", &reads, read_latency, sec, c->batch_size);
+	bench_report_op(out, "writes", &writes, write_latency, sec, 1);
+	fprintf(out, "  \"total\": {\"count\": %llu, \"tps\": %.1f}\n",
+		(unsigned long long)(reads.count + writes.count),
+		sec > 0 ? (reads.count + writes.count) / sec : 0.0);
+	fprintf(out, "}\n");
+
+	free(read_latency);
+	free(write_latency);
+}
+
+int
+main(int argc, char* argv[])
+{
+	bench_config config;
+
+	if (! parse_opts(&config, argc, argv)) {
+		return -1;
+	}
+
+	bench* b = malloc(sizeof(bench));
+	bench_init(b, &config);
+
+	if (! bench_connect(b)) {
+		bench_destroy(b);
+		free(b);
+		return -1;
+	}
+
+	int rv = 0;
+	b->running = true;
+
+	if (config.populate) {
+		fprintf(stderr, "Populating %llu keys\n", (unsigned long long)config.keys);
+
+		uint64_t begin = bench_now_ns();
+
+		if (! bench_populate(b)) {
+			rv = -1;
+		}
+		fprintf(stderr, "Populate took %.3fs\n", (bench_now_ns() - begin) / 1e9);
+	}
+
+	bool started = false;
+
+	if (rv == 0) {
+		started = (config.mode == BENCH_MODE_SYNC) ? bench_run_sync(b) : bench_run_async(b);
+	}
+
+	if (started) {
+		bench_wait(b, config.warmup_sec, false);
+
+		b->begin_ns = bench_now_ns();
+		b->recording = true;
+		bench_wait(b, config.duration_sec, ! config.quiet);
+		b->recording = false;
+		b->end_ns = bench_now_ns();
+		b->running = false;
+
+		if (config.mode == BENCH_MODE_SYNC) {
+			for (uint32_t i = 0; i < b->n_workers; i++) {
+				pthread_join(b->workers[i].thread, NULL);
+			}
+		}
+		else {
+			bench_async_wait(b);
+		}
+
+		FILE* out = stdout;
+
+		if (config.output) {
+			out = fopen(config.output, "w");
+
+			if (! out) {
+				fprintf(stderr, "Failed to open %s\n", config.output);
+				out = stdout;
+			}
+		}
+
+		bench_report(b, out);
+
+		if (out != stdout) {
+			fclose(out);
+		}
+	}
+	else {
+		rv = -1;
+	}
+
+	as_error err;
+	aerospike_close(&b->as, &err);
+	aerospike_destroy(&b->as);
+	as_event_close_loops();
+	bench_destroy(b);
+	free(b);
+	return rv;
+}
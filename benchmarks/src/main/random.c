@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * Copyright 2008-2025 by Aerospike.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ******************************************************************************/
+#include "benchmark.h"
+
+#include <math.h>
+
+//==========================================================
+// Static Functions
+//
+
+static double
+bench_zeta(uint64_t n, double theta)
+{
+	double sum = 0;
+
+	for (uint64_t i = 1; i <= n; i++) {
+		sum += 1.0 / pow((double)i, theta);
+	}
+	return sum;
+}
+
+static inline double
+bench_random_double(uint64_t* state)
+{
+	return (double)(bench_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//==========================================================
+// Functions
+//
+
+uint64_t
+bench_random(uint64_t* state)
+{
+	// xorshift64*
+	uint64_t x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Zipf generator from Gray et al., "Quickly Generating Billion-Record Synthetic
+// Databases". Rank 0 is the most popular key. Initialization is O(n).
+void
+bench_zipf_init(bench_zipf* z, uint64_t n, double theta)
+{
+	z->n = n;
+	z->theta = theta;
+	z->alpha = 1.0 / (1.0 - theta);
+	z->zetan = bench_zeta(n, theta);
+	z->half_pow = 1.0 + pow(0.5, theta);
+
+	double zeta2 = bench_zeta(2, theta);
+	z->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / z->zetan);
+}
+
+uint64_t
+bench_zipf_next(const bench_zipf* z, uint64_t* state)
+{
+	double u = bench_random_double(state);
+	double uz = u * z->zetan;
+
+	if (uz < 1.0) {
+		return 0;
+	}
+
+	if (uz < z->half_pow) {
+		return 1;
+	}
+
+	uint64_t rank = (uint64_t)((double)z->n * pow(z->eta * u - z->eta + 1.0, z->alpha));
+	return rank < z->n ? rank : z->n - 1;
+}
+
+uint64_t
+bench_next_key(bench* b, uint64_t* rng)
+{
+	bench_config* c = b->config;
+	uint64_t offset;
+
+	if (c->dist == BENCH_DIST_ZIPF) {
+		offset = bench_zipf_next(&b->zipf, rng);
+	}
+	else {
+		offset = bench_random(rng) % c->keys;
+	}
+	return c->start_key + offset;
+}
@@ -0,0 +1,493 @@
+/*******************************************************************************
+ * Copyright 2008-2025 by Aerospike.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ******************************************************************************/
+#include "benchmark.h"
+
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_record.h>
+
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+//==========================================================
+// Forward Declarations
+//
+
+static void bench_async_issue(bench_command* cmd);
+
+//==========================================================
+// Common
+//
+
+uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static void
+bench_sleep_ns(uint64_t ns)
+{
+	struct timespec ts;
+	ts.tv_sec = (time_t)(ns / 1000000000);
+	ts.tv_nsec = (long)(ns % 1000000000);
+	nanosleep(&ts, NULL);
+}
+
+static inline bool
+bench_is_read(bench_config* c, uint64_t* rng)
+{
+	return bench_random(rng) % 100 < c->read_pct;
+}
+
+// Bin value arrays must hold config bins entries. Values reference the worker's
+// buffer, so writing the record does not allocate.
+static void
+bench_set_bins(
+	bench* b, as_record* rec, as_bytes* bytes, const uint8_t* value, uint64_t* rng
+	)
+{
+	bench_config* c = b->config;
+
+	for (uint32_t i = 0; i < c->bins; i++) {
+		if (c->value_type == BENCH_VALUE_INT) {
+			as_record_set_int64(rec, b->bin_names[i], (int64_t)bench_random(rng));
+		}
+		else {
+			as_bytes_init_wrap(&bytes[i], (uint8_t*)value, c->bin_size, false);
+			as_record_set_bytes(rec, b->bin_names[i], &bytes[i]);
+		}
+	}
+}
+
+as_batch_records*
+bench_batch_create(bench* b)
+{
+	bench_config* c = b->config;
+	as_batch_records* records = as_batch_records_create(c->batch_size);
+
+	for (uint32_t i = 0; i < c->batch_size; i++) {
+		as_batch_read_record* r = as_batch_read_reserve(records);
+		r->read_all_bins = true;
+	}
+	return records;
+}
+
+static void
+bench_batch_set_keys(bench* b, as_batch_records* records, uint64_t* rng)
+{
+	bench_config* c = b->config;
+	as_vector* list = &records->list;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_batch_read_record* r = as_vector_get(list, i);
+		as_key_init_int64(&r->key, c->ns, c->set, (int64_t)bench_next_key(b, rng));
+	}
+}
+
+static void
+bench_record_result(bench* b, bench_worker* w, bool is_read, as_status status, uint64_t begin_ns)
+{
+	if (! b->recording) {
+		return;
+	}
+
+	bench_counters* counters = is_read ? &w->reads : &w->writes;
+	counters->count++;
+
+	switch (status) {
+		case AEROSPIKE_OK:
+			break;
+
+		case AEROSPIKE_ERR_RECORD_NOT_FOUND:
+			counters->not_found++;
+			break;
+
+		case AEROSPIKE_ERR_TIMEOUT:
+			counters->timeouts++;
+			return;
+
+		default:
+			counters->errors++;
+			return;
+	}
+
+	uint64_t elapsed = bench_now_ns() - begin_ns;
+	bench_histogram_add(is_read ? &w->read_latency : &w->write_latency, elapsed);
+}
+
+//==========================================================
+// Populate
+//
+
+static uint64_t g_populate_next;
+
+static void*
+bench_populate_worker(void* udata)
+{
+	bench_worker* w = udata;
+	bench* b = w->bench;
+	bench_config* c = b->config;
+	uint64_t end = c->start_key + c->keys;
+	as_bytes bytes[BENCH_MAX_BINS];
+
+	while (b->running) {
+		uint64_t k = as_faa_uint64(&g_populate_next, 1);
+
+		if (k >= end) {
+			break;
+		}
+
+		as_key key;
+		as_key_init_int64(&key, c->ns, c->set, (int64_t)k);
+
+		as_record rec;
+		as_record_inita(&rec, (uint16_t)c->bins);
+		bench_set_bins(b, &rec, bytes, w->value, &w->rng);
+
+		as_error err;
+
+		if (aerospike_key_put(&b->as, &err, NULL, &key, &rec) != AEROSPIKE_OK) {
+			w->writes.errors++;
+		}
+		w->writes.count++;
+		as_record_destroy(&rec);
+	}
+	return NULL;
+}
+
+bool
+bench_populate(bench* b)
+{
+	bench_config* c = b->config;
+	g_populate_next = c->start_key;
+
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		bench_worker* w = &b->workers[i];
+
+		if (pthread_create(&w->thread, NULL, bench_populate_worker, w) != 0) {
+			fprintf(stderr, "Failed to create populate thread\n");
+			b->running = false;
+
+			for (uint32_t j = 0; j < i; j++) {
+				pthread_join(b->workers[j].thread, NULL);
+			}
+			return false;
+		}
+	}
+
+	uint64_t errors = 0;
+
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		bench_worker* w = &b->workers[i];
+		pthread_join(w->thread, NULL);
+		errors += w->writes.errors;
+		memset(&w->writes, 0, sizeof(bench_counters));
+	}
+
+	if (errors > 0) {
+		fprintf(stderr, "Populate failed to write %llu records\n", (unsigned long long)errors);
+	}
+	return b->running;
+}
+
+//==========================================================
+// Sync
+//
+
+static void*
+bench_sync_worker(void* udata)
+{
+	bench_worker* w = udata;
+	bench* b = w->bench;
+	bench_config* c = b->config;
+	uint64_t interval = c->tps ? 1000000000ULL * b->n_workers / c->tps : 0;
+	uint64_t next = bench_now_ns();
+	as_batch_records* records = (c->batch_size > 1) ? bench_batch_create(b) : NULL;
+	as_bytes bytes[BENCH_MAX_BINS];
+
+	// Reuse record bins across reads.
+	as_record result;
+	as_record_init(&result, (uint16_t)c->bins);
+	as_record* resultp = &result;
+
+	while (b->running) {
+		if (interval) {
+			uint64_t now = bench_now_ns();
+
+			if (next > now) {
+				bench_sleep_ns(next - now);
+			}
+			else if (now - next > interval * 100) {
+				// Do not burst to catch up after a long stall.
+				next = now;
+			}
+			next += interval;
+		}
+
+		bool is_read = bench_is_read(c, &w->rng);
+		as_error err;
+		as_status status;
+		uint64_t begin = bench_now_ns();
+
+		if (is_read && records) {
+			bench_batch_set_keys(b, records, &w->rng);
+			status = aerospike_batch_read(&b->as, &err, NULL, records);
+			as_batch_records_reset(records);
+		}
+		else {
+			as_key key;
+			as_key_init_int64(&key, c->ns, c->set, (int64_t)bench_next_key(b, &w->rng));
+
+			if (is_read) {
+				status = aerospike_key_get(&b->as, &err, NULL, &key, &resultp);
+			}
+			else {
+				as_record rec;
+				as_record_inita(&rec, (uint16_t)c->bins);
+				bench_set_bins(b, &rec, bytes, w->value, &w->rng);
+				status = aerospike_key_put(&b->as, &err, NULL, &key, &rec);
+				as_record_destroy(&rec);
+			}
+		}
+		bench_record_result(b, w, is_read, status, begin);
+	}
+
+	as_record_destroy(&result);
+
+	if (records) {
+		as_batch_records_destroy(records);
+	}
+	return NULL;
+}
+
+bool
+bench_run_sync(bench* b)
+{
+	for (uint32_t i = 0; i < b->n_workers; i++) {
+		bench_worker* w = &b->workers[i];
+
+		if (pthread_create(&w->thread, NULL, bench_sync_worker, w) != 0) {
+			fprintf(stderr, "Failed to create benchmark thread\n");
+			b->running = false;
+
+			for (uint32_t j = 0; j < i; j++) {
+				pthread_join(b->workers[j].thread, NULL);
+			}
+			return false;
+		}
+	}
+	return true;
+}
+
+//==========================================================
+// Async
+//
+
+static bool g_throttle;
+static pthread_t g_feeder;
+
+static void
+bench_async_complete(bench_command* cmd, as_status status)
+{
+	bench* b = cmd->worker->bench;
+
+	bench_record_result(b, cmd->worker, cmd->is_read, status, cmd->begin_ns);
+
+	if (cmd->records) {
+		as_batch_records_reset(cmd->records);
+	}
+
+	if (b->running && ! g_throttle) {
+		bench_async_issue(cmd);
+		return;
+	}
+
+	as_store_uint8((uint8_t*)&cmd->busy, false);
+	as_decr_uint32(&b->in_flight);
+}
+
+static void
+bench_read_listener(as_error* err, as_record* record, void* udata, as_event_loop* event_loop)
+{
+	bench_async_complete(udata, err ? err->code : AEROSPIKE_OK);
+}
+
+static void
+bench_batch_listener(as_error* err, as_batch_records* records, void* udata, as_event_loop* event_loop)
+{
+	bench_async_complete(udata, err ? err->code : AEROSPIKE_OK);
+}
+
+static void
+bench_write_listener(as_error* err, void* udata, as_event_loop* event_loop)
+{
+	bench_async_complete(udata, err ? err->code : AEROSPIKE_OK);
+}
+
+static void
+bench_pipe_listener(void* udata, as_event_loop* event_loop)
+{
+	// Next pipelined command is issued on completion.
+}
+
+static void
+bench_async_issue(bench_command* cmd)
+{
+	bench_worker* w = cmd->worker;
+	bench* b = w->bench;
+	bench_config* c = b->config;
+	as_pipe_listener pipe = (c->mode == BENCH_MODE_PIPELINE) ? bench_pipe_listener : NULL;
+	as_error err;
+	as_status status;
+
+	cmd->is_read = bench_is_read(c, &cmd->rng);
+	cmd->begin_ns = bench_now_ns();
+
+	if (cmd->is_read && c->batch_size > 1) {
+		bench_batch_set_keys(b, cmd->records, &cmd->rng);
+		status = aerospike_batch_read_async(&b->as, &err, NULL, cmd->records,
+			bench_batch_listener, cmd, w->event_loop);
+	}
+	else {
+		as_key key;
+		as_key_init_int64(&key, c->ns, c->set, (int64_t)bench_next_key(b, &cmd->rng));
+
+		if (cmd->is_read) {
+			status = aerospike_key_get_async(&b->as, &err, NULL, &key, bench_read_listener, cmd,
+				w->event_loop, pipe);
+		}
+		else {
+			// Async commands are serialized before returning, so stack values are safe.
+			as_bytes bytes[BENCH_MAX_BINS];
+			as_record rec;
+			as_record_inita(&rec, (uint16_t)c->bins);
+			bench_set_bins(b, &rec, bytes, w->value, &cmd->rng);
+			status = aerospike_key_put_async(&b->as, &err, NULL, &key, &rec, bench_write_listener,
+				cmd, w->event_loop, pipe);
+			as_record_destroy(&rec);
+		}
+	}
+
+	if (status != AEROSPIKE_OK) {
+		// Retire slot instead of retrying, so a persistent queue error can not recurse.
+		bench_record_result(b, w, cmd->is_read, status, cmd->begin_ns);
+
+		if (cmd->records) {
+			as_batch_records_reset(cmd->records);
+		}
+		as_store_uint8((uint8_t*)&cmd->busy, false);
+		as_decr_uint32(&b->in_flight);
+	}
+}
+
+static void*
+bench_async_feeder(void* udata)
+{
+	bench* b = udata;
+	bench_config* c = b->config;
+	uint64_t interval = 1000000000ULL / c->tps;
+	uint64_t next = bench_now_ns();
+	uint32_t slot = 0;
+
+	while (b->running) {
+		uint64_t now = bench_now_ns();
+
+		if (next > now) {
+			bench_sleep_ns(next - now);
+		}
+		else if (now - next > interval * 100) {
+			next = now;
+		}
+		next += interval;
+
+		// Wait for a free command slot.
+		bench_command* cmd;
+
+		while (true) {
+			cmd = &b->commands[slot];
+
+			if (++slot == c->concurrency) {
+				slot = 0;
+			}
+
+			if (! as_load_uint8((uint8_t*)&cmd->busy)) {
+				break;
+			}
+
+			if (slot == 0) {
+				if (! b->running) {
+					return NULL;
+				}
+				sched_yield();
+			}
+		}
+
+		cmd->busy = true;
+		as_incr_uint32(&b->in_flight);
+		bench_async_issue(cmd);
+	}
+	return NULL;
+}
+
+bool
+bench_run_async(bench* b)
+{
+	bench_config* c = b->config;
+
+	g_throttle = c->tps > 0;
+
+	if (g_throttle) {
+		if (pthread_create(&g_feeder, NULL, bench_async_feeder, b) != 0) {
+			fprintf(stderr, "Failed to create feeder thread\n");
+			b->running = false;
+			return false;
+		}
+		return true;
+	}
+
+	// Each completion issues the next command on the same slot.
+	as_store_uint32(&b->in_flight, c->concurrency);
+
+	for (uint32_t i = 0; i < c->concurrency; i++) {
+		bench_command* cmd = &b->commands[i];
+		cmd->busy = true;
+		bench_async_issue(cmd);
+	}
+	return true;
+}
+
+void
+bench_async_wait(bench* b)
+{
+	if (g_throttle) {
+		pthread_join(g_feeder, NULL);
+	}
+
+	while (as_load_uint32(&b->in_flight) > 0) {
+		bench_sleep_ns(1000000);
+	}
+}
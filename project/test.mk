@@ -19,7 +19,11 @@ TEST_AEROSPIKE += util/*.c
 TEST_AEROSPIKE += filter_exp.c
 TEST_AEROSPIKE += exp_operate.c
 TEST_AEROSPIKE += transaction.c
+TEST_AEROSPIKE += transaction_hash.c
+TEST_AEROSPIKE += near_cache_file.c
+TEST_AEROSPIKE += scan_ledger.c
 TEST_AEROSPIKE += transaction_async.c
+TEST_AEROSPIKE += write_behind.c
 
 TEST_SOURCE = $(wildcard $(addprefix $(SOURCE_TEST)/, $(TEST_AEROSPIKE)))
 
@@ -77,8 +81,27 @@ ifeq ($(EVENT_LIB),libevent)
   TEST_LDFLAGS += -levent_core -levent_pthreads
 endif
 
+ifeq ($(EVENT_LIB),liburing)
+  TEST_LDFLAGS += -luring
+endif
+
+ifdef USE_LZ4
+  TEST_LDFLAGS += -llz4
+endif
+
+ifdef USE_ZSTD
+  TEST_LDFLAGS += -lzstd
+endif
+
 TEST_LDFLAGS += -lssl -lcrypto -lpthread -lyaml -lm -lz $(LINK_SUFFIX)
 
+# Count heap allocations in hot path benchmarks.
+BENCH_LDFLAGS =
+
+ifeq ($(OS),Linux)
+  BENCH_LDFLAGS += -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+endif
+
 AS_HOST := 127.0.0.1
 AS_PORT := 3000
 AS_ARGS := -h $(AS_HOST) -p $(AS_PORT)
@@ -102,6 +125,53 @@ test-gdb: test-build
 .PHONY: test-build
 test-build: $(TARGET_TEST)/aerospike_test
 
+.PHONY: bench
+bench: $(TARGET_TEST)/partition_bench $(TARGET_TEST)/hot_path_bench
+	$(TARGET_TEST)/partition_bench
+	$(TARGET_TEST)/hot_path_bench
+
+# Client throughput against in-process loopback mock cluster.
+.PHONY: mock-bench
+mock-bench: $(TARGET_TEST)/mock_bench
+	$(TARGET_TEST)/mock_bench
+
+# Latency and wasted work under injected faults against in-process loopback mock cluster.
+.PHONY: fault-bench
+fault-bench: $(TARGET_TEST)/fault_bench
+	$(TARGET_TEST)/fault_bench
+
+# Cluster tend cost against in-process loopback mock cluster.
+.PHONY: tend-bench
+tend-bench: $(TARGET_TEST)/tend_bench
+	$(TARGET_TEST)/tend_bench
+
+# Replicas, peers and racks info response parse cost against in-process loopback mock cluster.
+.PHONY: info-bench
+info-bench: $(TARGET_TEST)/info_bench
+	$(TARGET_TEST)/info_bench
+
+# Multi-process shared memory partition lookup cost while the tender churns partitions.
+.PHONY: shm-bench
+shm-bench: $(TARGET_TEST)/shm_bench
+	$(TARGET_TEST)/shm_bench
+
+# Sync read latency and CPU per spin_read_us against in-process loopback mock cluster.
+.PHONY: spin-bench
+spin-bench: $(TARGET_TEST)/spin_bench
+	$(TARGET_TEST)/spin_bench
+
+# Cross-thread as_event_execute() submit throughput versus number of producer threads.
+# Requires an event library.
+.PHONY: ring-bench
+ring-bench: $(TARGET_TEST)/ring_bench
+	$(TARGET_TEST)/ring_bench
+
+# Async get cost of as_coroutine.hpp awaitables versus raw callbacks against in-process loopback
+# mock cluster. Requires an event library and a C++20 compiler.
+.PHONY: coroutine-bench
+coroutine-bench: $(TARGET_TEST)/coroutine_bench
+	$(TARGET_TEST)/coroutine_bench
+
 .PHONY: test-clean
 test-clean:
 	@rm -rf $(TARGET_TEST)
@@ -116,6 +186,50 @@ $(TARGET_TEST)/%.o: LDFLAGS += $(TEST_LDFLAGS)
 $(TARGET_TEST)/%.o: $(SOURCE_TEST)/%.c
 	$(object)
 
+$(TARGET_TEST)/partition_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/partition_bench: $(TARGET_TEST)/bench/partition_bench.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/hot_path_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/hot_path_bench: $(TARGET_TEST)/bench/hot_path_bench.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS) $(BENCH_LDFLAGS)
+
+$(TARGET_TEST)/mock_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/mock_bench: $(TARGET_TEST)/bench/mock_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/fault_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/fault_bench: $(TARGET_TEST)/bench/fault_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/tend_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/tend_bench: $(TARGET_TEST)/bench/tend_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS) $(BENCH_LDFLAGS)
+
+$(TARGET_TEST)/info_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/info_bench: $(TARGET_TEST)/bench/info_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/shm_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/shm_bench: $(TARGET_TEST)/bench/shm_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/spin_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/spin_bench: $(TARGET_TEST)/bench/spin_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/ring_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/ring_bench: $(TARGET_TEST)/bench/ring_bench.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS)
+
+$(TARGET_TEST)/bench/coroutine_bench.o: CFLAGS = $(TEST_CFLAGS) -std=c++20
+$(TARGET_TEST)/bench/coroutine_bench.o: $(SOURCE_TEST)/bench/coroutine_bench.cpp | build prepare
+	$(object)
+
+$(TARGET_TEST)/coroutine_bench: CFLAGS += $(TEST_CFLAGS)
+$(TARGET_TEST)/coroutine_bench: $(TARGET_TEST)/bench/coroutine_bench.o $(TARGET_TEST)/util/mock_server.o $(TARGET_LIB)/libaerospike.a | build prepare
+	$(executable) $(TEST_LDFLAGS) -lstdc++
+
 $(TARGET_TEST)/aerospike_test: CFLAGS += $(TEST_CFLAGS)
 $(TARGET_TEST)/aerospike_test: $(TEST_OBJECT) $(TARGET_TEST)/test.o $(TARGET_LIB)/libaerospike.a | build prepare
 	$(executable) $(TEST_LDFLAGS)
@@ -62,6 +62,7 @@
  * @defgroup aerospike_t Client Types
  */
 
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_config.h>
 #include <aerospike/as_log.h>
@@ -81,6 +82,19 @@ extern "C" {
  */
 struct as_cluster_s;
 
+/**
+ * @private
+ * Immutable copy of the client configuration published by dynamic configuration. Commands
+ * read policies from the latest snapshot without locks while the tend thread reloads the
+ * configuration file. Replaced snapshots are retained until aerospike_destroy(), because
+ * commands in flight may still reference their policies.
+ */
+typedef struct as_config_snapshot_s {
+	as_config config;
+	uint8_t* bitmap;
+	struct as_config_snapshot_s* prev;
+} as_config_snapshot;
+
 /**
  * The aerospike struct is used to connect and execute operations against an 
  * Aerospike database cluster.
@@ -173,6 +187,7 @@ typedef struct aerospike_s {
 
 	/**
 	 * Client configuration. Dynamic configuration can periodically update this field.
+	 * Commands read dynamic configuration through config_snapshot instead.
 	 */
 	as_config config;
 
@@ -188,6 +203,13 @@ typedef struct aerospike_s {
 	 */
 	uint8_t* config_bitmap;
 
+	/**
+	 * @private
+	 * Latest configuration snapshot published by dynamic configuration. NULL when dynamic
+	 * configuration is not enabled.
+	 */
+	as_config_snapshot* config_snapshot;
+
 	/**
 	 * @private
 	 * If true, then aerospike_destroy() will free this instance.
@@ -398,10 +420,27 @@ aerospike_set_xdr_filter(
 	const char* filter_b64
 	);
 
+/**
+ * @private
+ * Return current client configuration. When dynamic configuration is enabled, the latest
+ * published snapshot is returned so policies are never read while being reloaded.
+ */
 static inline as_config*
 aerospike_load_config(aerospike* as)
 {
-	return &as->config;
+	as_config_snapshot* snapshot = (as_config_snapshot*)as_load_ptr((void* const*)&as->config_snapshot);
+	return snapshot ? &snapshot->config : &as->config;
+}
+
+/**
+ * @private
+ * Return dynamic configuration bitmap that belongs to a config returned by
+ * aerospike_load_config().
+ */
+static inline uint8_t*
+aerospike_load_config_bitmap(aerospike* as, as_config* config)
+{
+	return (config == &as->config)? as->config_bitmap : ((as_config_snapshot*)config)->bitmap;
 }
 
 static inline void
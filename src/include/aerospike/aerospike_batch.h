@@ -26,6 +26,7 @@
 
 #include <aerospike/aerospike.h>
 #include <aerospike/as_batch.h>
+#include <aerospike/as_bin_projection.h>
 #include <aerospike/as_listener.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_key.h>
@@ -99,6 +100,12 @@ typedef struct as_batch_base_record_s {
 	 * to the server.
 	 */
 	bool in_doubt;
+
+	/**
+	 * @private
+	 * Record bin capacity was retained by as_batch_records_reset() for the next batch command.
+	 */
+	bool retained;
 } as_batch_base_record;
 
 /**
@@ -114,6 +121,7 @@ typedef struct as_batch_read_record_s {
 	as_batch_type type;
 	bool has_write;
 	bool in_doubt; // Will always be false for reads.
+	bool retained;
 
 	/**
 	 * Optional read policy.
@@ -143,6 +151,13 @@ typedef struct as_batch_read_record_s {
 	 * If false and bin_names are not set, read record header (generation, expiration) only.
 	 */
 	bool read_all_bins;
+
+	/**
+	 * Optional encoded bin names. Set with as_batch_read_set_projection(), which also
+	 * points bin_names at the projection's names. The projection must remain valid until
+	 * the batch completes.
+	 */
+	const as_bin_projection* projection;
 } as_batch_read_record;
 
 /**
@@ -163,6 +178,7 @@ typedef struct as_batch_write_record_s {
 	as_batch_type type;
 	bool has_write;
 	bool in_doubt;
+	bool retained;
 
 	/**
 	 * Optional write policy.
@@ -194,6 +210,7 @@ typedef struct as_batch_apply_record_s {
 	as_batch_type type;
 	bool has_write;
 	bool in_doubt;
+	bool retained;
 
 	/**
 	 * Optional apply policy.
@@ -237,6 +254,7 @@ typedef struct as_batch_remove_record_s {
 	as_batch_type type;
 	bool has_write;
 	bool in_doubt;
+	bool retained;
 
 	/**
 	 * Optional remove policy.
@@ -277,6 +295,33 @@ typedef struct as_batch_records_s {
  */
 typedef as_batch_records as_batch_read_records;
 
+/**
+ * Caller allocated result arrays for aerospike_batch_exists_flat(). Each array must have one
+ * entry per batch key and is indexed by the key's position in the batch. Results are written
+ * directly into the arrays, so no as_record is created for any key.
+ *
+ * @ingroup batch_operations
+ */
+typedef struct as_batch_exists_results_s {
+	/**
+	 * Result code of each key. AEROSPIKE_OK if the record exists.
+	 * AEROSPIKE_ERR_RECORD_NOT_FOUND if the record does not exist. AEROSPIKE_NO_RESPONSE if
+	 * the key's node command did not complete. Required.
+	 */
+	as_status* status;
+
+	/**
+	 * Record generation of each key that exists. Optional. Use NULL to ignore generations.
+	 */
+	uint16_t* gen;
+
+	/**
+	 * Record time-to-live in seconds of each key that exists. Optional. Use NULL to ignore
+	 * time-to-live values.
+	 */
+	uint32_t* ttl;
+} as_batch_exists_results;
+
 /**
  * This listener will be called with the results of batch commands for all keys.
  *
@@ -298,6 +343,26 @@ typedef as_batch_records as_batch_read_records;
  */
 typedef bool (*as_batch_listener)(const as_batch_result* results, uint32_t n, void* udata);
 
+/**
+ * This listener will be called once per key as results of a streaming batch command are
+ * parsed. Use aerospike_batch_read_stream() to start a streaming batch command.
+ *
+ * The `result` argument and its record bins are only available within the context of
+ * the listener. To use the data outside of the listener, copy the data. The record is
+ * released after the listener returns, so memory usage does not grow with batch size.
+ *
+ * Keys are not delivered in batch order. When as_policy_batch.concurrent is true, the listener
+ * is called concurrently from multiple threads. Keys that do not receive a response are
+ * delivered after all node commands complete.
+ *
+ * @param index			Index of the key in the batch.
+ * @param result		The result for the key.
+ * @param udata 		User-data provided to the calling function.
+ * @return `true` to continue receiving results. `false` to abort the batch.
+ * @ingroup batch_operations
+ */
+typedef bool (*as_batch_stream_listener)(uint32_t index, const as_batch_result* result, void* udata);
+
 /**
  * This listener will be called with the results of batch commands for all keys.
  *
@@ -322,6 +387,24 @@ typedef as_batch_listener aerospike_batch_read_callback;
 typedef void (*as_async_batch_listener)(as_error* err, as_batch_records* records, void* udata,
 	as_event_loop* event_loop);
 
+/**
+ * Asynchronous batch progress listener. This function is called each time a node sub-command
+ * completes, with the records that received a response since the previous progress call.
+ * Those records are final and may be processed before the batch completes. Records of failed
+ * sub-commands are only available in the final as_async_batch_listener call, which is still
+ * made once for every batch.
+ *
+ * @param records		All batch records. Only the listed records may be accessed. Records must
+ *						not be destroyed here.
+ * @param indexes		Indexes of completed records in records->list.
+ * @param n_indexes		Number of indexes.
+ * @param udata 		User data that is forwarded from asynchronous command function.
+ * @param event_loop	Event loop that this command was executed on.
+ * @ingroup batch_operations
+ */
+typedef void (*as_async_batch_progress_listener)(as_batch_records* records,
+	const uint32_t* indexes, uint32_t n_indexes, void* udata, as_event_loop* event_loop);
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -428,6 +511,21 @@ as_batch_read_reserve(as_batch_records* records)
 	return r;
 }
 
+/**
+ * Read the bins of a projection created by as_bin_projection_init(). Records that share a
+ * projection are written with the repeat flag when their namespace and set also match.
+ *
+ * @relates as_batch_read_record
+ * @ingroup batch_operations
+ */
+static inline void
+as_batch_read_set_projection(as_batch_read_record* rec, const as_bin_projection* proj)
+{
+	rec->projection = proj;
+	rec->bin_names = proj->bins;
+	rec->n_bin_names = proj->n_bins;
+}
+
 /**
  * Reserve a new `as_batch_write_record` slot. Capacity will be increased when necessary.
  * Return reference to record. The record is initialized to zeroes.
@@ -486,6 +584,31 @@ as_batch_remove_reserve(as_batch_records* records)
 AS_EXTERN void
 as_batch_records_destroy(as_batch_records* records);
 
+/**
+ * Prepare record list to be executed again with the same keys. Result bin values are released,
+ * but keys, bin name lists, operations and each result record's bin capacity are kept, so
+ * repeating a batch with the same shape does not allocate result storage. Results, generations
+ * and ttls are cleared. It's the responsility of the caller to keep user specified fields valid
+ * until the record list is destroyed with as_batch_records_destroy().
+ *
+ * @code
+ * as_batch_records* records = as_batch_records_create(n);
+ * // Add read records.
+ *
+ * while (running) {
+ *     aerospike_batch_read(&as, &err, NULL, records);
+ *     // Process results.
+ *     as_batch_records_reset(records);
+ * }
+ * as_batch_records_destroy(records);
+ * @endcode
+ *
+ * @relates as_batch_records
+ * @ingroup batch_operations
+ */
+AS_EXTERN void
+as_batch_records_reset(as_batch_records* records);
+
 /**
  * Destroy keys and records in record list. It's the responsility of the caller to
  * free additional user specified fields in the record.
@@ -611,6 +734,32 @@ aerospike_batch_read_async(
 	as_async_batch_listener listener, void* udata, as_event_loop* event_loop
 	);
 
+/**
+ * Asynchronously read multiple records like aerospike_batch_read_async() and also call progress
+ * with the records of each node sub-command as soon as that node completes. This lets results
+ * from fast nodes be processed before the slowest node responds.
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param records		List of keys and records to retrieve. Must create using
+ *						as_batch_records_create().
+ * @param listener 		User function to be called once when the batch completes.
+ * @param progress 		User function to be called when each node sub-command completes.
+ * @param udata 		User data to be forwarded to listener and progress.
+ * @param event_loop 	Event loop assigned to run this command. If NULL, an event loop will be
+ *						chosen by round-robin.
+ *
+ * @return AEROSPIKE_OK if async command succesfully queued. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_read_async_progress(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
+	as_async_batch_listener listener, as_async_batch_progress_listener progress, void* udata,
+	as_event_loop* event_loop
+	);
+
 /**
  * Read/Write multiple records for specified batch keys in one batch call.
  * This method allows different sub-commands for each key in the batch.
@@ -763,6 +912,31 @@ aerospike_batch_write_async(
 	as_async_batch_listener listener, void* udata, as_event_loop* event_loop
 	);
 
+/**
+ * Asynchronously write/read multiple records like aerospike_batch_write_async() and also call
+ * progress with the records of each node sub-command as soon as that node completes.
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param records		List of keys and records to write/read. Must create using
+ *						as_batch_records_create().
+ * @param listener 		User function to be called once when the batch completes.
+ * @param progress 		User function to be called when each node sub-command completes.
+ * @param udata 		User data to be forwarded to listener and progress.
+ * @param event_loop 	Event loop assigned to run this command. If NULL, an event loop will be
+ *						chosen by round-robin.
+ *
+ * @return AEROSPIKE_OK if async command succesfully queued. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_write_async_progress(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
+	as_async_batch_listener listener, as_async_batch_progress_listener progress, void* udata,
+	as_event_loop* event_loop
+	);
+
 /**
  * Look up multiple records by key, then return all bins.
  *
@@ -831,6 +1005,48 @@ aerospike_batch_get_bins(
 	const char** bins, uint32_t n_bins, as_batch_listener listener, void* udata
 	);
 
+/**
+ * Look up multiple records by key and stream each result to the listener as soon as it is
+ * received, instead of waiting for all nodes to complete. Results are not accumulated,
+ * so very large batches can be processed with flat memory usage.
+ *
+ * @code
+ * bool listener(uint32_t index, const as_batch_result* result, void* udata) {
+ *     if (result->result == AEROSPIKE_OK) {
+ *         // process result->record
+ *     }
+ *     return true;
+ * }
+ *
+ * as_batch batch;
+ * as_batch_inita(&batch, 3);
+ *
+ * as_key_init(as_batch_keyat(&batch,0), "ns", "set", "key1");
+ * as_key_init(as_batch_keyat(&batch,1), "ns", "set", "key2");
+ * as_key_init(as_batch_keyat(&batch,2), "ns", "set", "key3");
+ *
+ * as_status status = aerospike_batch_read_stream(as, &err, NULL, &batch, NULL, 0, listener, NULL);
+ * as_batch_destroy(&batch);
+ * @endcode
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param batch			The batch of keys to read.
+ * @param bins			Bin filters. Only return these bins. If NULL, return all bins.
+ * @param n_bins		The number of bin filters.
+ * @param listener 		User function to be called with each key result.
+ * @param udata 		User data to be forwarded to listener.
+ *
+ * @return AEROSPIKE_OK if successful or aborted by the listener. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_read_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	const char** bins, uint32_t n_bins, as_batch_stream_listener listener, void* udata
+	);
+
 /**
  * Look up multiple records by key, then return results from specified read operations.
  *
@@ -901,6 +1117,147 @@ aerospike_batch_exists(
 	as_batch_listener listener, void* udata
 	);
 
+/**
+ * Test whether multiple records exist in the cluster and write each key's result code,
+ * generation and time-to-live into caller allocated arrays. Unlike aerospike_batch_exists(),
+ * no per key as_batch_result or as_record is created, which keeps large existence probes
+ * cheap in memory.
+ *
+ * @code
+ * as_status status[3];
+ * uint16_t gen[3];
+ *
+ * as_batch_exists_results results = {
+ *     .status = status,
+ *     .gen = gen,
+ *     .ttl = NULL
+ * };
+ *
+ * aerospike_batch_exists_flat(as, &err, NULL, &batch, &results);
+ * @endcode
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param batch			The batch of keys to read.
+ * @param results		Result arrays with one entry per batch key.
+ *
+ * @return AEROSPIKE_OK if successful. AEROSPIKE_BATCH_FAILED if one or more keys could not
+ * be read. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_exists_flat(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	as_batch_exists_results* results
+	);
+
+/**
+ * Test whether multiple records of a digest batch exist in the cluster and write each key's
+ * result code, generation and time-to-live into caller allocated arrays. Neither an as_key nor
+ * an as_record is created for any key. Digest batches are not supported in transactions.
+ *
+ * @code
+ * as_batch_digests batch;
+ * as_batch_digests_init(&batch, "ns", "set", n);
+ *
+ * for (uint32_t i = 0; i < n; i++) {
+ *     as_batch_digests_set_int64(&batch, i, ids[i]);
+ * }
+ *
+ * as_batch_exists_results results = {
+ *     .status = status,
+ *     .gen = NULL,
+ *     .ttl = NULL
+ * };
+ *
+ * aerospike_batch_exists_digests(as, &err, NULL, &batch, &results);
+ * as_batch_digests_destroy(&batch);
+ * @endcode
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param batch			The digests to read.
+ * @param results		Result arrays with one entry per digest.
+ *
+ * @return AEROSPIKE_OK if successful. AEROSPIKE_BATCH_FAILED if one or more keys could not
+ * be read. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_exists_digests(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_digests* batch,
+	as_batch_exists_results* results
+	);
+
+/**
+ * Read records of a digest batch and deliver each key's result to the stream listener as it
+ * is parsed. The result key is NULL, so use the listener index to locate the digest.
+ * Digest batches are not supported in transactions.
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param batch			The digests to read.
+ * @param bins			Bin filters. Only return these bins. If NULL, all bins are returned.
+ * @param n_bins		The number of bin filters.
+ * @param listener 		User function to be called once per key.
+ * @param udata 		User data to be forwarded to listener.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_read_digests_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_digests* batch,
+	const char** bins, uint32_t n_bins, as_batch_stream_listener listener, void* udata
+	);
+
+/**
+ * Test whether multiple records of a compact key batch exist in the cluster and write each
+ * key's result code, generation and time-to-live into caller allocated arrays. Compact
+ * batches are not supported in transactions.
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param batch			The compact keys to read.
+ * @param results		Result arrays with one entry per compact key.
+ *
+ * @return AEROSPIKE_OK if successful. AEROSPIKE_BATCH_FAILED if one or more keys could not
+ * be read. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_exists_compact(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_compact* batch,
+	as_batch_exists_results* results
+	);
+
+/**
+ * Read records of a compact key batch and deliver each key's result to the stream listener
+ * as it is parsed. The result key is NULL, so use the listener index to locate the compact
+ * key. Compact batches are not supported in transactions.
+ *
+ * @param as			Aerospike cluster instance.
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param policy		Batch policy configuration parameters, pass in NULL for default.
+ * @param batch			The compact keys to read.
+ * @param bins			Bin filters. Only return these bins. If NULL, all bins are returned.
+ * @param n_bins		The number of bin filters.
+ * @param listener 		User function to be called once per key.
+ * @param udata 		User data to be forwarded to listener.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_status
+aerospike_batch_read_compact_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_compact* batch,
+	const char** bins, uint32_t n_bins, as_batch_stream_listener listener, void* udata
+	);
+
 /**
  * Perform read/write operations on multiple keys.
  * Requires server version 6.0+
@@ -1030,6 +1387,28 @@ aerospike_batch_remove(
 	as_batch_listener listener, void* udata
 	);
 
+/**
+ * @private
+ * Write batch records command for all records as it would be sent to a single node that
+ * supports batch any commands (server 6.0+). Key digests are calculated if not already set.
+ * Used to measure command serialization without a cluster.
+ *
+ * @param err			Error detail structure that is populated if an error occurs.
+ * @param defs			Default policies used for records that do not specify a policy.
+ * @param policy		Batch policy.
+ * @param records		List of records.
+ * @param buf			Command buffer.
+ * @param capacity		Command buffer capacity.
+ * @param size			Command size. Set to the required capacity when buf is too small.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ */
+AS_EXTERN as_status
+as_batch_records_serialize(
+	as_error* err, as_policies* defs, const as_policy_batch* policy, as_batch_records* records,
+	uint8_t* buf, size_t capacity, size_t* size
+	);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
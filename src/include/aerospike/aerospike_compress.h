@@ -0,0 +1,95 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+/**
+ * @defgroup compress_operations Bin Compression
+ *
+ * Compress bin values on the client with pre-trained zstd dictionaries. Dictionaries are
+ * assigned to a namespace and optional set with as_config_add_compress_dict(). Compressed
+ * values are zstd frames that contain the dictionary ID, so any client instance that has
+ * loaded the same dictionary can decompress them regardless of namespace or set.
+ *
+ * The client must be built with USE_ZSTD=1.
+ */
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_status.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Compress value with the dictionary assigned to the namespace and set. If the set does not
+ * have its own dictionary, the namespace dictionary is used. If neither exist, the value is
+ * compressed without a dictionary.
+ *
+ * @code
+ * as_bytes bytes;
+ *
+ * if (aerospike_compress_bytes(&as, &err, "test", "users", buf, size, &bytes) == AEROSPIKE_OK) {
+ *     as_record_set_bytes(&rec, "data", &bytes);
+ * }
+ * @endcode
+ *
+ * @param as		The aerospike instance.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param ns		The namespace used to select the dictionary.
+ * @param set		The set used to select the dictionary. May be NULL.
+ * @param value		The value to compress.
+ * @param size		The size of the value.
+ * @param bytes		The compressed value. Call as_bytes_destroy() when done.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup compress_operations
+ */
+AS_EXTERN as_status
+aerospike_compress_bytes(
+	aerospike* as, as_error* err, const char* ns, const char* set, const uint8_t* value,
+	uint32_t size, as_bytes* bytes
+	);
+
+/**
+ * Decompress value created by aerospike_compress_bytes(). The dictionary is found by the
+ * dictionary ID stored in the value.
+ *
+ * @param as		The aerospike instance.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param value		The compressed value.
+ * @param size		The size of the compressed value.
+ * @param bytes		The decompressed value. Call as_bytes_destroy() when done.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup compress_operations
+ */
+AS_EXTERN as_status
+aerospike_decompress_bytes(
+	aerospike* as, as_error* err, const uint8_t* value, uint32_t size, as_bytes* bytes
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
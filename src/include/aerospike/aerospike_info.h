@@ -55,6 +55,47 @@ extern "C" {
  */
 typedef bool (*aerospike_info_foreach_callback)(const as_error* err, const as_node* node, const char* req, char* res, void* udata);
 
+/**
+ * Info response from a single node for aerospike_info_all_async().
+ *
+ * @ingroup info_operations
+ */
+typedef struct as_info_node_response_s {
+	/**
+	 * Node that was sent the request. The node is reserved until the listener returns.
+	 */
+	as_node* node;
+
+	/**
+	 * Response string. NULL if the request failed on this node.
+	 */
+	char* response;
+
+	/**
+	 * Error for this node. err.code is AEROSPIKE_OK on success.
+	 */
+	as_error err;
+} as_info_node_response;
+
+/**
+ * Callback for aerospike_info_all_async(). Called once after every node has responded or failed.
+ *
+ * @param err			NULL if the request succeeded on every node. Otherwise, the first node
+ *						error with a message containing the number of failed nodes.
+ * @param responses		Per node responses in cluster node order. Do not free responses. This
+ *						will be done automatically after the listener returns.
+ * @param n_responses	Number of responses.
+ * @param udata			The udata provided to aerospike_info_all_async().
+ * @param event_loop	Event loop that ran the last node command. NULL if the last node failed
+ *						before its command was queued.
+ *
+ * @ingroup info_operations
+ */
+typedef void (*aerospike_info_all_listener)(
+	as_error* err, as_info_node_response* responses, uint32_t n_responses, void* udata,
+	as_event_loop* event_loop
+	);
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -273,6 +314,46 @@ aerospike_info_foreach(
 	aerospike_info_foreach_callback callback, void* udata
 	);
 
+/**
+ * Asynchronously send an info request to every node in the cluster. The requests are issued in
+ * parallel and the listener is called once with all node responses.
+ *
+ * @code
+ * void my_listener(as_error* err, as_info_node_response* responses, uint32_t n_responses,
+ *     void* udata, as_event_loop* event_loop)
+ * {
+ *     for (uint32_t i = 0; i < n_responses; i++) {
+ *         as_info_node_response* r = &responses[i];
+ *
+ *         if (r->response) {
+ *             printf("%s: %s\n", as_node_get_address_string(r->node), r->response);
+ *         }
+ *     }
+ * }
+ *
+ * aerospike_info_all_async(&as, &err, NULL, "sets", my_listener, NULL, NULL);
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The info policy. If NULL, the default info policy will be used.
+ * @param req			The info request to send.
+ * @param listener		User function to be called when all nodes have completed.
+ * @param udata			User data to be forwarded to user callback.
+ * @param event_loop 	Event loop assigned to run all node commands. If NULL, each node command
+ *						is assigned an event loop so the requests are spread across event loops.
+ *
+ * @return AEROSPIKE_OK if the requests were started. Otherwise an error and the listener is not
+ * called.
+ *
+ * @ingroup info_operations
+ */
+AS_EXTERN as_status
+aerospike_info_all_async(
+	aerospike* as, as_error* err, as_policy_info* policy, const char* req,
+	aerospike_info_all_listener listener, void* udata, as_event_loop* event_loop
+	);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -30,11 +30,14 @@
 
 #include <aerospike/aerospike.h>
 #include <aerospike/as_listener.h>
+#include <aerospike/as_bin_projection.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_list.h>
 #include <aerospike/as_operations.h>
 #include <aerospike/as_policy.h>
+#include <aerospike/as_prepared_operate.h>
+#include <aerospike/as_read_into.h>
 #include <aerospike/as_record.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_val.h>
@@ -163,6 +166,46 @@ aerospike_key_select(
 	const char* bins[], as_record** rec
 	);
 
+/**
+ * Read a record's bins directly into caller owned slots. Only the slot bins are requested.
+ * No record or bin values are allocated, so this suits hot paths that read a fixed schema.
+ * Each slot reports whether its bin was found, truncated or of a different type.
+ *
+ * @code
+ * int64_t count;
+ * char name[64];
+ *
+ * as_read_slot slots[2];
+ * as_read_slot_init_int64(&slots[0], "count", &count);
+ * as_read_slot_init_str(&slots[1], "name", name, sizeof(name));
+ *
+ * as_read_into into = {.slots = slots, .n_slots = 2};
+ *
+ * if (aerospike_key_select_into(&as, &err, NULL, &key, &into) != AEROSPIKE_OK) {
+ * 	   printf("error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ * else if (slots[1].status == AS_READ_SLOT_TRUNCATED) {
+ *     printf("name needs %u bytes\n", slots[1].size + 1);
+ * }
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ *						zero_copy, deserialize and lazy_deserialize do not apply.
+ * @param key			The key of the record.
+ * @param into			The slots to populate. Slot outputs and record metadata are reset before the read.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN as_status
+aerospike_key_select_into(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_read_into* into
+	);
+
 /**
  * Asynchronously read a record's bins given the NULL terminated bins array argument.
  *
@@ -296,6 +339,70 @@ aerospike_key_select_bins_async(
 	as_pipe_listener pipe_listener
 	);
 
+/**
+ * Read a record's bins given a projection created by as_bin_projection_init(). The
+ * encoded bin names are copied into the command as is.
+ *
+ * @code
+ * static const char* select[] = {"bin1", "bin2", "bin3"};
+ *
+ * as_bin_projection proj;
+ * as_bin_projection_init(&proj, &err, select, 3);
+ *
+ * as_record* rec = NULL;
+ * if (aerospike_key_select_projection(&as, &err, NULL, &key, &proj, &rec) != AEROSPIKE_OK) {
+ * 	   printf("error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ * else {
+ *     as_record_destroy(rec);
+ * }
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key			The key of the record.
+ * @param proj			The bins to select.
+ * @param rec 			The record to be populated with the data from request. If the record pointer is
+ *						preset to NULL, the record will be created and initialized. If the record pointer
+ *						is not NULL, the record is assumed to be valid and will be reused. Either way,
+ *						the record must be preset.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN as_status
+aerospike_key_select_projection(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const as_bin_projection* proj, as_record** rec
+	);
+
+/**
+ * Asynchronously read a record's bins given a projection created by as_bin_projection_init().
+ * The projection must remain valid until the listener is called.
+ *
+ * @param as				The aerospike instance to use for this operation.
+ * @param err				The as_error to be populated if an error occurs.
+ * @param policy			The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key				The key of the record.
+ * @param proj				The bins to select.
+ * @param listener			User function to be called with command results.
+ * @param udata				User data to be forwarded to user callback.
+ * @param event_loop		Event loop assigned to run this command. If NULL, an event loop will be chosen by round-robin.
+ * @param pipe_listener		Enables command pipelining, if not NULL.
+ *
+ * @return AEROSPIKE_OK if async command successfully queued. Otherwise an error.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN as_status
+aerospike_key_select_projection_async(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const as_bin_projection* proj, as_async_record_listener listener, void* udata,
+	as_event_loop* event_loop, as_pipe_listener pipe_listener
+	);
+
 /**
  * Check if a record exists in the cluster via its key. The record's metadata 
  * will be populated if the record exists.
@@ -575,6 +682,43 @@ aerospike_key_operate(
 	const as_operations* ops, as_record** rec
 	);
 
+/**
+ * Lookup a record by key, then perform operations serialized in a prepared template.
+ * This avoids sizing and serializing the same operations on every call. The result is the
+ * same as calling aerospike_key_operate() with the operations used to create the template.
+ *
+ * @code
+ * as_prepared_operate prep;
+ * as_prepared_operate_init(&prep, &err, &ops);
+ *
+ * as_record* rec = NULL;
+ *
+ * if (aerospike_key_operate_prepared(&as, &err, NULL, &key, &prep, &rec) != AEROSPIKE_OK) {
+ * 	   printf("error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ * else {
+ * 	   as_record_destroy(rec);
+ * }
+ * as_prepared_operate_destroy(&prep);
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key			The key of the record.
+ * @param prep			The prepared operations to perform on the record.
+ * @param rec			The record to be populated with the data from AS_OPERATOR_READ operations.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN as_status
+aerospike_key_operate_prepared(
+	aerospike* as, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_prepared_operate* prep, as_record** rec
+	);
+
 /**
  * Asynchronously lookup a record by key, then perform specified operations.
  *
@@ -723,6 +867,50 @@ aerospike_key_apply_async(
 	as_pipe_listener pipe_listener
 	);
 
+/**
+ * Merge a read policy with the client's dynamic configuration once, so commands that use the
+ * resolved policy skip the per-command merge. The resolved policy is used as is until the
+ * dynamic configuration changes. Commands then merge it again on every call until it is
+ * resolved again. Resolve the policy again after modifying any of its fields.
+ *
+ * @param as		The aerospike instance.
+ * @param src		The policy to resolve. If NULL, then the default policy will be used.
+ *					src and out may point to the same policy.
+ * @param out		The resolved policy.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN void
+as_policy_read_resolve(aerospike* as, const as_policy_read* src, as_policy_read* out);
+
+/**
+ * Merge a write policy with the client's dynamic configuration once.
+ * See as_policy_read_resolve().
+ *
+ * @param as		The aerospike instance.
+ * @param src		The policy to resolve. If NULL, then the default policy will be used.
+ *					src and out may point to the same policy.
+ * @param out		The resolved policy.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN void
+as_policy_write_resolve(aerospike* as, const as_policy_write* src, as_policy_write* out);
+
+/**
+ * Merge an operate policy with the client's dynamic configuration once.
+ * See as_policy_read_resolve().
+ *
+ * @param as		The aerospike instance.
+ * @param src		The policy to resolve. If NULL, then the default policy will be used.
+ *					src and out may point to the same policy.
+ * @param out		The resolved policy.
+ *
+ * @ingroup key_operations
+ */
+AS_EXTERN void
+as_policy_operate_resolve(aerospike* as, const as_policy_operate* src, as_policy_operate* out);
+
 /**
  * @cond SKIP_DOXYGEN
  * doxygen skips this section till endcond
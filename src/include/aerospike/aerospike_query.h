@@ -81,6 +81,7 @@
  */
 
 #include <aerospike/aerospike.h>
+#include <aerospike/as_async_flow.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_event.h>
 #include <aerospike/as_job.h>
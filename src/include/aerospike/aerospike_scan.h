@@ -89,6 +89,8 @@
  */
 
 #include <aerospike/aerospike.h>
+#include <aerospike/as_async_flow.h>
+#include <aerospike/as_columnar.h>
 #include <aerospike/as_listener.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_partition_filter.h>
@@ -141,6 +143,53 @@ typedef bool (*as_async_scan_listener)(
 	as_error* err, as_record* record, void* udata, as_event_loop* event_loop
 	);
 
+/**
+ * Caller supplied arrays filled by aerospike_scan_partitions_digests(). Row i of a chunk is
+ * digests[i], generations[i] and ttls[i]. Set generations or ttls to NULL when not needed.
+ *
+ * @ingroup scan_operations
+ */
+typedef struct as_digest_chunk_s {
+	/**
+	 * Record digests. Must hold capacity entries.
+	 */
+	as_digest_value* digests;
+
+	/**
+	 * Record generations or NULL. Must hold capacity entries when set.
+	 */
+	uint16_t* generations;
+
+	/**
+	 * Record ttls in seconds or NULL. Must hold capacity entries when set.
+	 */
+	uint32_t* ttls;
+
+	/**
+	 * Number of rows the arrays can hold.
+	 */
+	uint32_t capacity;
+
+	/**
+	 * Number of rows filled. Set by the client.
+	 */
+	uint32_t size;
+} as_digest_chunk;
+
+/**
+ * Digest scan callback. Called each time a node command fills its chunk and once more with
+ * the remaining rows when the node command completes. The chunk arrays are reused after
+ * the callback returns.
+ *
+ * @param chunk			Filled rows.
+ * @param udata			User-data provided to the calling function.
+ *
+ * @return `true` to continue the scan. Otherwise, the scan will end.
+ *
+ * @ingroup scan_operations
+ */
+typedef bool (*as_digest_callback)(const as_digest_chunk* chunk, void* udata);
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -391,6 +440,121 @@ aerospike_scan_partitions(
 	as_partition_filter* pf, aerospike_scan_foreach_callback callback, void* udata
 	);
 
+/**
+ * Scan records in specified namespace, set and partition filter and deliver them as Arrow
+ * record batches instead of one as_record per record. Bin values are copied from the server
+ * response directly into column buffers, so no as_record or as_val is created per record.
+ *
+ * Each node command fills its own batch, so with "scan.concurrent" the callback must be
+ * thread-safe. Only bins named in the schema are written. Use as_scan_select() with the
+ * same bin names to avoid transferring other bins. Scans with operations are not supported.
+ *
+ * Partition digests advance only after the callback returns, so max_records pagination and
+ * policy checkpoints resume after the last delivered batch.
+ *
+ * @code
+ * bool callback(struct ArrowArray* batch, void* udata)
+ * {
+ *     struct ArrowArray owned = *batch; // Move batch.
+ *     // Process or import owned.
+ *     owned.release(&owned);
+ *     return true;
+ * }
+ *
+ * as_column columns[2] = {{"name", AS_COLUMN_STRING}, {"age", AS_COLUMN_INT64}};
+ * as_columnar_schema schema = {columns, 2, 8192};
+ *
+ * as_scan scan;
+ * as_scan_init(&scan, "test", "demo");
+ *
+ * as_partition_filter pf;
+ * as_partition_filter_set_all(&pf);
+ *
+ * if (aerospike_scan_partitions_columnar(&as, &err, NULL, &scan, &pf, &schema, callback, NULL)
+ *     != AEROSPIKE_OK) {
+ *     printf("error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ * as_scan_destroy(&scan);
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		Scan policy configuration parameters, pass in NULL for default.
+ * @param scan			The scan to execute against the cluster.
+ * @param pf			Partition filter.
+ * @param schema		Columns and batch size. Must remain valid until the scan returns.
+ * @param callback		The function to be called for each record batch.
+ * @param udata			User-data to be passed to the callback.
+ *
+ * @return AEROSPIKE_OK on success. Otherwise an error occurred.
+ *
+ * @ingroup scan_operations
+ */
+AS_EXTERN as_status
+aerospike_scan_partitions_columnar(
+	aerospike* as, as_error* err, const as_policy_scan* policy, as_scan* scan,
+	as_partition_filter* pf, const as_columnar_schema* schema, as_columnar_callback callback,
+	void* udata
+	);
+
+/**
+ * Scan record digests, generations and ttls in specified namespace, set and partition filter.
+ * Rows are written directly into the caller's chunk arrays, so no as_record or key is created
+ * per record. Bins are not requested, so "scan.no_bins" is set.
+ *
+ * With "scan.concurrent", the chunk is split into one contiguous slice per node and the
+ * callback must be thread-safe. If capacity is less than the node count, nodes are scanned
+ * in series. Scans with operations are not supported.
+ *
+ * Partition digests advance only after the callback returns, so max_records pagination and
+ * policy checkpoints resume after the last delivered chunk.
+ *
+ * @code
+ * bool callback(const as_digest_chunk* chunk, void* udata)
+ * {
+ *     for (uint32_t i = 0; i < chunk->size; i++) {
+ *         // Process chunk->digests[i], chunk->generations[i], chunk->ttls[i].
+ *     }
+ *     return true;
+ * }
+ *
+ * static as_digest_value digests[16384];
+ * static uint16_t generations[16384];
+ * static uint32_t ttls[16384];
+ * as_digest_chunk chunk = {digests, generations, ttls, 16384, 0};
+ *
+ * as_scan scan;
+ * as_scan_init(&scan, "test", "demo");
+ *
+ * as_partition_filter pf;
+ * as_partition_filter_set_all(&pf);
+ *
+ * if (aerospike_scan_partitions_digests(&as, &err, NULL, &scan, &pf, &chunk, callback, NULL)
+ *     != AEROSPIKE_OK) {
+ *     printf("error(%d) %s at [%s:%d]", err.code, err.message, err.file, err.line);
+ * }
+ * as_scan_destroy(&scan);
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		Scan policy configuration parameters, pass in NULL for default.
+ * @param scan			The scan to execute against the cluster.
+ * @param pf			Partition filter.
+ * @param chunk			Caller supplied arrays. Must remain valid until the scan returns.
+ * @param callback		The function to be called for each filled chunk.
+ * @param udata			User-data to be passed to the callback.
+ *
+ * @return AEROSPIKE_OK on success. Otherwise an error occurred.
+ *
+ * @ingroup scan_operations
+ */
+AS_EXTERN as_status
+aerospike_scan_partitions_digests(
+	aerospike* as, as_error* err, const as_policy_scan* policy, as_scan* scan,
+	as_partition_filter* pf, as_digest_chunk* chunk, as_digest_callback callback, void* udata
+	);
+
 /**
  * Asynchronously scan the records in the specified namespace and set in the cluster.
  *
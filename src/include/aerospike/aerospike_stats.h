@@ -17,7 +17,9 @@
 #pragma once
 
 #include <aerospike/aerospike.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_node.h>
+#include <aerospike/as_slow_log.h>
 
 /**
  * @defgroup cluster_stats Cluster Statistics
@@ -60,8 +62,95 @@ typedef struct as_conn_stats_s {
 	 */
 	uint32_t closed;
 
+	/**
+	 * Number of times a sync connection pool lock was already held by another thread when
+	 * a command attempted to acquire it. Always zero for async connections.
+	 */
+	uint64_t contended;
+
+	/**
+	 * Number of sync connections retrieved from the lock-free connection cache without
+	 * acquiring the pool lock. Always zero for async connections.
+	 */
+	uint64_t cache_hits;
+
+	/**
+	 * Pipeline commands awaiting a response on this node. Always zero for sync and
+	 * non-pipeline async connections.
+	 */
+	uint32_t in_flight;
+
+	/**
+	 * Highest number of commands awaiting a response on a single pipeline connection on
+	 * this node. Always zero for sync and non-pipeline async connections.
+	 */
+	uint32_t max_depth;
+
+	/**
+	 * Predicted connections opened by warm-up when this node joined a running cluster.
+	 * Zero if warm-up was not performed. Always zero for async connections.
+	 */
+	uint32_t warm_up_target;
+
+	/**
+	 * Connections still to be opened before warm-up completes. Always zero for async
+	 * connections.
+	 */
+	uint32_t warm_up_remaining;
+
+	/**
+	 * Peak connections in use over the last as_config.conn_peak_window tend intervals.
+	 * Zero if conn_peak_window is disabled.
+	 */
+	uint32_t peak_in_use;
+
+	/**
+	 * Total number of idle connections closed because they were above peak usage.
+	 * Compare with opened to see how many trimmed connections had to be reopened.
+	 */
+	uint32_t trimmed;
+
+	/**
+	 * Total number of async connections opened beyond the node/event loop limit using the
+	 * unused share of other event loops. See as_config.async_borrow_conns. Always zero for
+	 * sync and pipeline connections.
+	 */
+	uint32_t borrowed;
+
 } as_conn_stats;
 
+/**
+ * Namespace statistics on a node.
+ * @ingroup cluster_stats
+ */
+typedef struct as_ns_stats_s {
+	/**
+	 * Namespace. Empty for commands that are not tied to a namespace (batch).
+	 */
+	const char* ns;
+
+	/**
+	 * Bytes received from the node.
+	 */
+	uint64_t bytes_in;
+
+	/**
+	 * Bytes sent to the node.
+	 */
+	uint64_t bytes_out;
+
+	/**
+	 * Bytes received from the node as if all responses were uncompressed.
+	 */
+	uint64_t bytes_in_raw;
+
+	/**
+	 * Bytes sent to the node as if all commands were uncompressed.
+	 */
+	uint64_t bytes_out_raw;
+
+} as_ns_stats;
+
 /**
  * Node statistics.
  * @ingroup cluster_stats
@@ -104,6 +193,75 @@ typedef struct as_node_stats_s {
 	 */
 	uint64_t key_busy_count;
 
+	/**
+	 * Circuit breaker state (AS_BREAKER_CLOSED, AS_BREAKER_OPEN or AS_BREAKER_HALF_OPEN).
+	 */
+	uint32_t breaker_state;
+
+	/**
+	 * Count of times the node's circuit breaker opened since node was initialized.
+	 */
+	uint64_t breaker_trips;
+
+	/**
+	 * Current adaptive concurrency limit. Zero when as_config.concurrency_limit_max is zero.
+	 */
+	uint32_t concurrency_limit;
+
+	/**
+	 * Count of commands rejected by the node's concurrency limit since node was initialized.
+	 */
+	uint64_t concurrency_limit_rejects;
+
+	/**
+	 * Smoothed kernel TCP state sampled from this node's pooled connections. Only populated
+	 * when metrics are enabled with a non-zero as_metrics_policy.tcp_info_interval.
+	 */
+	as_tcp_info tcp_info;
+
+	/**
+	 * Count of TCP state samples taken since metrics were enabled.
+	 */
+	uint64_t tcp_info_samples;
+
+	/**
+	 * Latency percentiles in microseconds for each latency type (AS_LATENCY_TYPE_CONN,
+	 * AS_LATENCY_TYPE_WRITE, ...) merged across all namespaces. Only populated when metrics
+	 * are enabled with a non-zero as_metrics_policy.latency_precision. Otherwise, all
+	 * values are zero.
+	 */
+	as_latency_percentiles latency[AS_LATENCY_TYPE_MAX];
+
+	/**
+	 * Bytes received from the node summed across namespaces.
+	 */
+	uint64_t bytes_in;
+
+	/**
+	 * Bytes sent to the node summed across namespaces.
+	 */
+	uint64_t bytes_out;
+
+	/**
+	 * Bytes received from the node before decompression summed across namespaces.
+	 */
+	uint64_t bytes_in_raw;
+
+	/**
+	 * Bytes sent to the node before compression summed across namespaces.
+	 */
+	uint64_t bytes_out_raw;
+
+	/**
+	 * Namespace statistics on this node.
+	 */
+	as_ns_stats* namespaces;
+
+	/**
+	 * Number of namespace statistics.
+	 */
+	uint32_t namespaces_size;
+
 } as_node_stats;
 
 /**
@@ -123,6 +281,46 @@ typedef struct as_event_loop_stats_s {
 	 */
 	uint32_t queue_size;
 
+	/**
+	 * Approximate number of freed commands cached in this event loop's
+	 * command pool.
+	 */
+	uint32_t cmd_pool_size;
+
+	/**
+	 * Maximum number of pooled commands that have been in use at the same
+	 * time on this event loop.
+	 */
+	uint32_t cmd_pool_high_water;
+
+	/**
+	 * Approximate number of functions and commands queued to this event loop by other
+	 * threads that the event loop has not run yet.
+	 */
+	uint32_t execute_size;
+
+	/**
+	 * Delay in microseconds between queueing the last monitor probe and the event loop
+	 * running it.
+	 */
+	uint32_t lag_us;
+
+	/**
+	 * Maximum monitor probe delay in microseconds over the last window of probes.
+	 */
+	uint32_t lag_max_us;
+
+	/**
+	 * Percentage of time the event loop thread was using cpu between the last two probes.
+	 */
+	uint32_t busy_pct;
+
+	/**
+	 * Average number of completed commands per event loop iteration between the last two
+	 * probes. Zero when the event library does not count iterations.
+	 */
+	uint32_t commands_per_iteration;
+
 } as_event_loop_stats;
 
 /**
@@ -145,6 +343,137 @@ typedef struct as_cluster_stats_s {
 	*/
 	uint64_t retry_count;
 
+	/**
+	 * Count of retries denied because the retry budget was exhausted since cluster was started.
+	 * See as_config.retry_budget_tokens.
+	 */
+	uint64_t retry_budget_exhausted_count;
+
+	/**
+	 * Count of hedged read requests sent to a second replica since cluster was started.
+	 */
+	uint64_t hedge_count;
+
+	/**
+	 * Count of hedged read requests that completed before the original request since
+	 * cluster was started.
+	 */
+	uint64_t hedge_win_count;
+
+	/**
+	 * Count of concurrent sync batches run sequentially in the calling thread because their
+	 * estimated cost was below the batch policy concurrent_threshold.
+	 */
+	uint64_t batch_inline_count;
+
+	/**
+	 * Count of concurrent sync batches run in parallel threads.
+	 */
+	uint64_t batch_parallel_count;
+
+	/**
+	 * Duration of the last completed cluster tend iteration in microseconds.
+	 */
+	uint64_t tend_duration;
+
+	/**
+	 * Tend phase latency percentiles in microseconds indexed by as_tend_phase. Each phase
+	 * is recorded once per tend iteration that reached it, even if it had nothing to do.
+	 * The balance phase is only recorded when connections are balanced.
+	 */
+	as_latency_percentiles tend_phases[AS_TEND_PHASE_MAX];
+
+	/**
+	 * Transaction commit and abort phase latency percentiles in microseconds indexed by
+	 * as_txn_phase. Phases that a transaction skips, like verify when it has no reads,
+	 * are not recorded.
+	 */
+	as_latency_percentiles txn_phases[AS_TXN_PHASE_MAX];
+
+	/**
+	 * Count of sync batch/scan/query tasks that were run by a thread pool worker other than
+	 * the one the task was queued to since cluster was started.
+	 */
+	uint64_t thread_pool_steal_count;
+
+	/**
+	 * Bytes currently charged to the client memory budget. Zero if the budget is disabled.
+	 */
+	uint64_t mem_budget_used;
+
+	/**
+	 * Maximum bytes charged to the client memory budget since cluster was started.
+	 */
+	uint64_t mem_budget_peak;
+
+	/**
+	 * Count of commands rejected by the client memory budget since cluster was started.
+	 */
+	uint64_t mem_budget_rejects;
+
+	/**
+	 * Count of TLS handshakes that negotiated a new session since cluster was started.
+	 */
+	uint64_t tls_full_handshakes;
+
+	/**
+	 * Count of TLS handshakes that resumed a cached session since cluster was started.
+	 * Always zero if as_config_tls.session_cache is false.
+	 */
+	uint64_t tls_resumed_handshakes;
+
+	/**
+	 * Count of seed and peer hostname lookups answered by the DNS cache since cluster was
+	 * started. Always zero if as_config.dns_cache_ttl is zero.
+	 */
+	uint64_t dns_cache_hits;
+
+	/**
+	 * Count of seed and peer hostname lookups that waited on DNS because the hostname was
+	 * not cached.
+	 */
+	uint64_t dns_cache_misses;
+
+	/**
+	 * Count of DNS resolutions performed by the DNS cache, including background refreshes.
+	 */
+	uint64_t dns_lookups;
+
+	/**
+	 * Count of DNS resolutions performed by the DNS cache that failed.
+	 */
+	uint64_t dns_lookup_errors;
+
+	/**
+	 * Total time spent in DNS resolutions performed by the DNS cache in microseconds.
+	 */
+	uint64_t dns_lookup_time;
+
+	/**
+	 * Count of client aggregations that used the cached lua states of their module.
+	 * Always zero if as_config_lua.cache_enabled is false. Lua configuration is global, so
+	 * this count includes aggregations run by all aerospike instances in the process.
+	 */
+	uint64_t lua_cache_hits;
+
+	/**
+	 * Count of client aggregations that reloaded their module because it was not yet
+	 * validated, its file changed or it was uploaded or removed with aerospike_udf_put()
+	 * or aerospike_udf_remove().
+	 */
+	uint64_t lua_cache_misses;
+
+	/**
+	 * Compression statistics indexed by as_compress_codec.
+	 */
+	as_compress_stats compress[AS_COMPRESS_CODEC_SIZE];
+
+	/**
+	 * Process wide client allocation statistics indexed by as_mem_tag. All counts are zero
+	 * if the client is not built with USE_MEM_STATS=1.
+	 */
+	as_mem_tag_stats mem[AS_MEM_TAG_MAX];
+
 	/**
 	 * Node count.
 	 */
@@ -163,6 +492,112 @@ typedef struct as_cluster_stats_s {
 
 } as_cluster_stats;
 
+/**
+ * Maximum latency histogram buckets copied into a metrics snapshot. Counts of higher
+ * buckets are added to the last copied bucket.
+ * @ingroup cluster_stats
+ */
+#define AS_METRICS_SNAPSHOT_BUCKETS 32
+
+/**
+ * Counters and latency histograms of one namespace on one node in a metrics snapshot.
+ * All values are cumulative unless the snapshot was produced by as_metrics_snapshot_delta().
+ * @ingroup cluster_stats
+ */
+typedef struct as_ns_snapshot_s {
+	/**
+	 * Node name.
+	 */
+	char node[AS_NODE_NAME_SIZE];
+
+	/**
+	 * Namespace. Empty for commands that are not tied to a namespace (batch).
+	 */
+	char ns[AS_MAX_NAMESPACE_SIZE];
+
+	uint64_t error_count;
+	uint64_t timeout_count;
+	uint64_t key_busy_count;
+	uint64_t near_cache_hit_count;
+	uint64_t near_cache_miss_count;
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+	uint64_t bytes_in_raw;
+	uint64_t bytes_out_raw;
+
+	/**
+	 * Latency histogram buckets indexed by latency type followed by application latency tags
+	 * (see AS_LATENCY_TAG_SLOT). Only the first latency_size buckets are used.
+	 */
+	uint64_t latency[AS_LATENCY_SLOTS][AS_METRICS_SNAPSHOT_BUCKETS];
+
+	/**
+	 * Number of used buckets in each latency histogram.
+	 */
+	uint8_t latency_size;
+
+	/**
+	 * Power of 2 multiple between latency histogram buckets.
+	 */
+	uint8_t latency_shift;
+
+} as_ns_snapshot;
+
+/**
+ * Metrics snapshot filled without allocating memory. The entries array is owned by the
+ * caller and can be reused for every snapshot.
+ *
+ * @code
+ * as_ns_snapshot entries[2][64];
+ * as_metrics_snapshot snaps[2];
+ * as_metrics_snapshot_init(&snaps[0], entries[0], 64);
+ * as_metrics_snapshot_init(&snaps[1], entries[1], 64);
+ * aerospike_metrics_snapshot(&as, &snaps[0]);
+ *
+ * // One interval later.
+ * as_ns_snapshot delta_entries[64];
+ * as_metrics_snapshot delta;
+ * as_metrics_snapshot_init(&delta, delta_entries, 64);
+ * aerospike_metrics_snapshot(&as, &snaps[1]);
+ * as_metrics_snapshot_delta(&snaps[0], &snaps[1], &delta);
+ * @endcode
+ *
+ * @ingroup cluster_stats
+ */
+typedef struct as_metrics_snapshot_s {
+	/**
+	 * Caller owned node/namespace entries.
+	 */
+	as_ns_snapshot* entries;
+
+	/**
+	 * Number of entries available.
+	 */
+	uint32_t capacity;
+
+	/**
+	 * Number of entries filled.
+	 */
+	uint32_t size;
+
+	/**
+	 * True if there were more node/namespace combinations than entries available.
+	 */
+	bool truncated;
+
+	/**
+	 * Snapshot time in milliseconds since an arbitrary point. For deltas, the elapsed time
+	 * between the two snapshots.
+	 */
+	uint64_t time_ms;
+
+	uint64_t command_count;
+	uint64_t retry_count;
+	uint64_t delay_queue_timeout_count;
+	uint32_t invalid_node_count;
+
+} as_metrics_snapshot;
+
 struct as_cluster_s;
 
 /******************************************************************************
@@ -222,7 +657,7 @@ AS_EXTERN void
 aerospike_node_stats(as_node* node, as_node_stats* stats);
 
 /**
- * Release node reference allocated in aerospike_node_stats().
+ * Release node reference and namespace statistics allocated in aerospike_node_stats().
  *
  * @param stats		The statistics summary for specified node.
  *
@@ -231,6 +666,7 @@ aerospike_node_stats(as_node* node, as_node_stats* stats);
 static inline void
 aerospike_node_stats_destroy(as_node_stats* stats)
 {
+	cf_free(stats->namespaces);
 	as_node_release(stats->node);
 }
 
@@ -248,6 +684,106 @@ aerospike_event_loop_stats(as_event_loop* event_loop, as_event_loop_stats* stats
 	// Warning: cross-thread references without a lock.
 	stats->process_size = as_event_loop_get_process_size(event_loop);
 	stats->queue_size = as_event_loop_get_queue_size(event_loop);
+	stats->cmd_pool_size = as_event_loop_get_cmd_pool_size(event_loop);
+	stats->cmd_pool_high_water = as_event_loop_get_cmd_pool_high_water(event_loop);
+	stats->execute_size = as_event_loop_get_execute_size(event_loop);
+	stats->lag_us = as_event_loop_get_lag(event_loop);
+	stats->lag_max_us = as_event_loop_get_lag_max(event_loop);
+	stats->busy_pct = as_event_loop_get_busy_pct(event_loop);
+	stats->commands_per_iteration = as_event_loop_get_commands_per_iteration(event_loop);
+}
+
+/**
+ * Initialize metrics snapshot with caller owned entries.
+ *
+ * @param snapshot	The metrics snapshot.
+ * @param entries	Caller owned node/namespace entries.
+ * @param capacity	Number of entries available.
+ *
+ * @ingroup cluster_stats
+ */
+static inline void
+as_metrics_snapshot_init(as_metrics_snapshot* snapshot, as_ns_snapshot* entries, uint32_t capacity)
+{
+	snapshot->entries = entries;
+	snapshot->capacity = capacity;
+	snapshot->size = 0;
+	snapshot->truncated = false;
+}
+
+/**
+ * Fill metrics snapshot with cumulative cluster, node and namespace counters and latency
+ * histograms. This function does not allocate memory or hold locks, so it is cheap enough
+ * to be called every second.
+ *
+ * @param cluster	The aerospike cluster.
+ * @param snapshot	The metrics snapshot initialized with as_metrics_snapshot_init().
+ *
+ * @ingroup cluster_stats
+ */
+AS_EXTERN void
+aerospike_cluster_metrics_snapshot(struct as_cluster_s* cluster, as_metrics_snapshot* snapshot);
+
+/**
+ * Fill metrics snapshot for the client instance. See aerospike_cluster_metrics_snapshot().
+ *
+ * @param as		The aerospike instance.
+ * @param snapshot	The metrics snapshot initialized with as_metrics_snapshot_init().
+ *
+ * @ingroup cluster_stats
+ */
+static inline void
+aerospike_metrics_snapshot(aerospike* as, as_metrics_snapshot* snapshot)
+{
+	aerospike_cluster_metrics_snapshot(as->cluster, snapshot);
+}
+
+/**
+ * Fill delta with the change of each counter and latency bucket from prev to cur.
+ * Entries are matched by node name and namespace. Entries that are not in prev and counters
+ * that were reset since prev are copied from cur. Delta entries capacity should be at least
+ * cur->size.
+ *
+ * @param prev		The earlier snapshot.
+ * @param cur		The later snapshot.
+ * @param delta		The delta snapshot initialized with as_metrics_snapshot_init().
+ *
+ * @ingroup cluster_stats
+ */
+AS_EXTERN void
+as_metrics_snapshot_delta(
+	const as_metrics_snapshot* prev, const as_metrics_snapshot* cur, as_metrics_snapshot* delta
+	);
+
+/**
+ * Copy slow commands recorded since cursor into out and advance cursor. Commands are
+ * recorded when as_config.slow_command_ms is set. Use an initial cursor of zero to start
+ * with the oldest entry still held by the log. Entries overwritten before they were read
+ * are skipped.
+ *
+ * @param cluster	The aerospike cluster.
+ * @param cursor	Read position. Updated on return.
+ * @param out		Array of at least max entries.
+ * @param max		Maximum number of entries to copy.
+ *
+ * @return Number of entries copied. Zero if the slow command log is disabled.
+ * @ingroup cluster_stats
+ */
+AS_EXTERN uint32_t
+aerospike_cluster_slow_commands(
+	struct as_cluster_s* cluster, uint64_t* cursor, as_slow_command* out, uint32_t max
+	);
+
+/**
+ * Copy slow commands recorded since cursor for the client instance.
+ * See aerospike_cluster_slow_commands().
+ *
+ * @ingroup cluster_stats
+ */
+static inline uint32_t
+aerospike_slow_commands(aerospike* as, uint64_t* cursor, as_slow_command* out, uint32_t max)
+{
+	return aerospike_cluster_slow_commands(as->cluster, cursor, out, max);
 }
 
 /**
@@ -266,6 +802,15 @@ as_conn_stats_init(as_conn_stats* stats)
 	stats->in_use = 0;
 	stats->opened = 0;
 	stats->closed = 0;
+	stats->contended = 0;
+	stats->cache_hits = 0;
+	stats->in_flight = 0;
+	stats->max_depth = 0;
+	stats->warm_up_target = 0;
+	stats->warm_up_remaining = 0;
+	stats->peak_in_use = 0;
+	stats->trimmed = 0;
+	stats->borrowed = 0;
 }
 
 void
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <citrusleaf/alloc.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Memory allocator used by an aerospike instance for command buffers, async commands and
+ * record response buffers. Functions receive the arena hint as their last argument, so a
+ * single set of functions can serve multiple jemalloc arenas or NUMA nodes.
+ *
+ * Either all functions must be set or none. When no functions are set, cf_malloc(),
+ * cf_realloc() and cf_free() are used.
+ *
+ * ~~~~~~~~~~{.c}
+ * static void* arena_malloc(size_t size, void* arena) { ... }
+ * static void* arena_realloc(void* ptr, size_t size, void* arena) { ... }
+ * static void arena_free(void* ptr, void* arena) { ... }
+ *
+ * as_config config;
+ * as_config_init(&config);
+ * config.allocator.malloc_fn = arena_malloc;
+ * config.allocator.realloc_fn = arena_realloc;
+ * config.allocator.free_fn = arena_free;
+ * config.allocator.arena = my_arena;
+ * ~~~~~~~~~~
+ *
+ * @ingroup as_config_object
+ */
+typedef struct as_allocator_s {
+	/**
+	 * Allocate size bytes.
+	 */
+	void* (*malloc_fn)(size_t size, void* arena);
+
+	/**
+	 * Resize memory returned by malloc_fn or realloc_fn.
+	 */
+	void* (*realloc_fn)(void* ptr, size_t size, void* arena);
+
+	/**
+	 * Free memory returned by malloc_fn or realloc_fn.
+	 */
+	void (*free_fn)(void* ptr, void* arena);
+
+	/**
+	 * Optional arena hint passed to all functions.
+	 */
+	void* arena;
+} as_allocator;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Return true if allocator uses cf_malloc(), cf_realloc() and cf_free().
+ */
+static inline bool
+as_allocator_is_default(const as_allocator* allocator)
+{
+	return allocator->malloc_fn == NULL;
+}
+
+/**
+ * @private
+ * Allocate memory with allocator.
+ */
+static inline void*
+as_allocator_malloc(const as_allocator* allocator, size_t size)
+{
+	return allocator->malloc_fn ? allocator->malloc_fn(size, allocator->arena) : cf_malloc(size);
+}
+
+/**
+ * @private
+ * Resize memory allocated by the same allocator.
+ */
+static inline void*
+as_allocator_realloc(const as_allocator* allocator, void* ptr, size_t size)
+{
+	return allocator->realloc_fn ? allocator->realloc_fn(ptr, size, allocator->arena) :
+		cf_realloc(ptr, size);
+}
+
+/**
+ * @private
+ * Free memory allocated by the same allocator.
+ */
+static inline void
+as_allocator_free(const as_allocator* allocator, void* ptr)
+{
+	if (allocator->free_fn) {
+		allocator->free_fn(ptr, allocator->arena);
+	}
+	else {
+		cf_free(ptr);
+	}
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Default size of heap blocks allocated after an arena's initial buffer is exhausted.
+ */
+#define AS_ARENA_BLOCK_SIZE 4096
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Heap block of an arena.
+ */
+typedef struct as_arena_block_s {
+	struct as_arena_block_s* next;
+	uint32_t capacity;
+	uint32_t offset;
+	uint8_t data[];
+} as_arena_block;
+
+/**
+ * Bump allocator for memory that is released all at once. Allocations are served from an
+ * optional caller provided buffer first and then from heap blocks. An arena is not thread
+ * safe.
+ *
+ * @code
+ * uint8_t buf[8192];
+ * as_arena arena;
+ * as_arena_init(&arena, buf, sizeof(buf));
+ *
+ * as_operations ops;
+ * as_operations_init_arena(&ops, 20, &arena);
+ * // Add operations and call aerospike_key_operate().
+ * as_operations_destroy(&ops);  // Resets arena.
+ *
+ * as_arena_destroy(&arena);
+ * @endcode
+ *
+ * @ingroup base_operations
+ */
+typedef struct as_arena_s {
+	/**
+	 * @private
+	 * Caller provided buffer. May be NULL.
+	 */
+	uint8_t* buffer;
+
+	/**
+	 * @private
+	 * Heap blocks allocated after buffer was exhausted. Most recent block first.
+	 */
+	as_arena_block* blocks;
+
+	/**
+	 * @private
+	 */
+	uint32_t capacity;
+
+	/**
+	 * @private
+	 */
+	uint32_t offset;
+
+	/**
+	 * @private
+	 * Count of as_operations that reference this arena. The arena is reset when the last
+	 * one is destroyed.
+	 */
+	uint32_t users;
+} as_arena;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize arena. buffer is used before heap blocks are allocated and must remain valid
+ * until the arena is destroyed. buffer may be NULL.
+ */
+AS_EXTERN void
+as_arena_init(as_arena* arena, uint8_t* buffer, uint32_t capacity);
+
+/**
+ * Allocate size bytes aligned to 8 bytes. The memory is released by as_arena_reset() or
+ * as_arena_destroy().
+ */
+AS_EXTERN void*
+as_arena_alloc(as_arena* arena, uint32_t size);
+
+/**
+ * Release all allocations. The caller provided buffer is reused and heap blocks are freed.
+ */
+AS_EXTERN void
+as_arena_reset(as_arena* arena);
+
+/**
+ * Free heap blocks of arena.
+ */
+static inline void
+as_arena_destroy(as_arena* arena)
+{
+	as_arena_reset(arena);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -58,6 +58,8 @@ typedef struct as_async_write_command {
 typedef struct as_async_record_command {
 	as_event_command command;
 	as_async_record_listener listener;
+	bool zero_copy;
+	bool lazy;
 	uint8_t space[];
 } as_async_record_command;
 
@@ -86,20 +88,25 @@ as_async_write_command_create(
 	)
 {
 	// Allocate enough memory to cover: struct size + write buffer size + auth max buffer size
-	// Then, round up memory size in 1KB increments.
+	// Then, round up memory size in 1KB increments. The event loop command pool may round up
+	// further to its size class.
+	as_event_loop* loop = policy->ordered ?
+		as_event_assign_ordered(event_loop, pi->partition_id) :
+		as_event_assign_partition(event_loop, cluster, pi->ns, pi->partition, pi->replica_size);
 	size_t s = (sizeof(as_async_write_command) + size + AS_AUTHENTICATION_MAX_SIZE + 1023) & ~1023;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	as_event_command* cmd = as_event_command_alloc(cluster, loop, &s);
 	as_async_write_command* wcmd = (as_async_write_command*)cmd;
 	cmd->total_deadline = policy->total_timeout;
 	cmd->socket_timeout = policy->socket_timeout;
 	cmd->max_retries = policy->max_retries;
 	cmd->iteration = 0;
 	cmd->replica = as_command_write_replica(replica);
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = loop;
 	cmd->cluster = cluster;
 	cmd->node = NULL;
 	cmd->ns = pi->ns;
 	cmd->partition = pi->partition;
+	cmd->partition_id = pi->partition_id;
 	cmd->udata = udata;
 	cmd->parse_results = parse_results;
 	cmd->pipe_listener = pipe_listener;
@@ -112,6 +119,13 @@ as_async_write_command_create(
 	cmd->replica_size = pi->replica_size;
 	cmd->replica_index = as_replica_index_init_write(cluster, cmd->replica);
 	cmd->txn = policy->txn;
+	cmd->cancel = policy->cancel;
+	cmd->priority = (uint8_t)policy->priority;
+	cmd->latency_tag = policy->latency_tag;
+	cmd->limited = false;
+	cmd->policy_socket_timeout = policy->socket_timeout;
+	cmd->adaptive_timeout_pct = policy->adaptive_timeout_pct;
+	cmd->adaptive_timeout_min = policy->adaptive_timeout_min;
 	cmd->ubuf = ubuf;
 	cmd->ubuf_size = ubuf_size;
 	cmd->latency_type = AS_LATENCY_TYPE_WRITE;
@@ -131,20 +145,25 @@ as_async_record_command_create(
 {
 	// Allocate enough memory to cover: struct size + write buffer size + auth max buffer size
 	// Then, round up memory size in 4KB increments to reduce fragmentation and to allow socket
-	// read to reuse buffer for small socket write sizes.
+	// read to reuse buffer for small socket write sizes. The event loop command pool may round up
+	// further to its size class.
+	as_event_loop* loop = policy->ordered ?
+		as_event_assign_ordered(event_loop, pi->partition_id) :
+		as_event_assign_partition(event_loop, cluster, pi->ns, pi->partition, pi->replica_size);
 	size_t s = (sizeof(as_async_record_command) + size + AS_AUTHENTICATION_MAX_SIZE + 4095) & ~4095;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	as_event_command* cmd = as_event_command_alloc(cluster, loop, &s);
 	as_async_record_command* rcmd = (as_async_record_command*)cmd;
 	cmd->total_deadline = policy->total_timeout;
 	cmd->socket_timeout = policy->socket_timeout;
 	cmd->max_retries = policy->max_retries;
 	cmd->iteration = 0;
 	cmd->replica = replica;
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = loop;
 	cmd->cluster = cluster;
 	cmd->node = NULL;
 	cmd->ns = pi->ns;
 	cmd->partition = pi->partition;
+	cmd->partition_id = pi->partition_id;
 	cmd->udata = udata;
 	cmd->parse_results = parse_results;
 	cmd->pipe_listener = pipe_listener;
@@ -166,10 +185,19 @@ as_async_record_command_create(
 	cmd->replica_size = pi->replica_size;
 	cmd->replica_index = replica_index;
 	cmd->txn = policy->txn;
+	cmd->cancel = policy->cancel;
+	cmd->priority = (uint8_t)policy->priority;
+	cmd->latency_tag = policy->latency_tag;
+	cmd->limited = false;
+	cmd->policy_socket_timeout = policy->socket_timeout;
+	cmd->adaptive_timeout_pct = policy->adaptive_timeout_pct;
+	cmd->adaptive_timeout_min = policy->adaptive_timeout_min;
 	cmd->ubuf = ubuf;
 	cmd->ubuf_size = ubuf_size;
 	cmd->latency_type = latency_type;
 	rcmd->listener = listener;
+	rcmd->zero_copy = false;
+	rcmd->lazy = false;
 	as_cluster_add_command_count(cluster);
 	return cmd;
 }
@@ -184,20 +212,25 @@ as_async_value_command_create(
 {
 	// Allocate enough memory to cover: struct size + write buffer size + auth max buffer size
 	// Then, round up memory size in 4KB increments to reduce fragmentation and to allow socket
-	// read to reuse buffer for small socket write sizes.
+	// read to reuse buffer for small socket write sizes. The event loop command pool may round up
+	// further to its size class.
+	as_event_loop* loop = policy->ordered ?
+		as_event_assign_ordered(event_loop, pi->partition_id) :
+		as_event_assign_partition(event_loop, cluster, pi->ns, pi->partition, pi->replica_size);
 	size_t s = (sizeof(as_async_value_command) + size + AS_AUTHENTICATION_MAX_SIZE + 4095) & ~4095;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	as_event_command* cmd = as_event_command_alloc(cluster, loop, &s);
 	as_async_value_command* vcmd = (as_async_value_command*)cmd;
 	cmd->total_deadline = policy->total_timeout;
 	cmd->socket_timeout = policy->socket_timeout;
 	cmd->max_retries = policy->max_retries;
 	cmd->iteration = 0;
 	cmd->replica = as_command_write_replica(replica);
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = loop;
 	cmd->cluster = cluster;
 	cmd->node = NULL;
 	cmd->ns = pi->ns;
 	cmd->partition = pi->partition;
+	cmd->partition_id = pi->partition_id;
 	cmd->udata = udata;
 	cmd->parse_results = parse_results;
 	cmd->pipe_listener = pipe_listener;
@@ -210,6 +243,13 @@ as_async_value_command_create(
 	cmd->replica_size = pi->replica_size;
 	cmd->replica_index = as_replica_index_init_write(cluster, cmd->replica);
 	cmd->txn = policy->txn;
+	cmd->cancel = policy->cancel;
+	cmd->priority = (uint8_t)policy->priority;
+	cmd->latency_tag = policy->latency_tag;
+	cmd->limited = false;
+	cmd->policy_socket_timeout = policy->socket_timeout;
+	cmd->adaptive_timeout_pct = policy->adaptive_timeout_pct;
+	cmd->adaptive_timeout_min = policy->adaptive_timeout_min;
 	cmd->ubuf = ubuf;
 	cmd->ubuf_size = ubuf_size;
 	cmd->latency_type = AS_LATENCY_TYPE_WRITE;
@@ -225,16 +265,18 @@ as_async_info_command_create(
 	)
 {
 	// Allocate enough memory to cover: struct size + write buffer size + auth max buffer size
-	// Then, round up memory size in 1KB increments.
+	// Then, round up memory size in 1KB increments. The event loop command pool may round up
+	// further to its size class.
+	as_event_loop* loop = as_event_assign_node(event_loop, node);
 	size_t s = (sizeof(as_async_info_command) + size + AS_AUTHENTICATION_MAX_SIZE + 1023) & ~1023;
-	as_event_command* cmd = (as_event_command*)cf_malloc(s);
+	as_event_command* cmd = as_event_command_alloc(node->cluster, loop, &s);
 	as_async_info_command* icmd = (as_async_info_command*)cmd;
 	cmd->total_deadline = policy->timeout;
 	cmd->socket_timeout = policy->timeout;
 	cmd->max_retries = 1;
 	cmd->iteration = 0;
 	cmd->replica = AS_POLICY_REPLICA_MASTER;
-	cmd->event_loop = as_event_assign(event_loop);
+	cmd->event_loop = loop;
 	cmd->cluster = node->cluster;
 	cmd->node = node;
 	cmd->ns = NULL;
@@ -251,6 +293,10 @@ as_async_info_command_create(
 	cmd->replica_size = 1;
 	cmd->replica_index = 0;
 	cmd->txn = NULL;
+	cmd->priority = AS_POLICY_PRIORITY_FOREGROUND;
+	cmd->latency_tag = 0;
+	cmd->limited = false;
+	cmd->adaptive_timeout_pct = 0;
 	cmd->ubuf = NULL;
 	cmd->ubuf_size = 0;
 	cmd->latency_type = AS_LATENCY_TYPE_NONE;
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_event_command;
+
+/**
+ * Cancellation handle for async single record and batch commands. Assign the handle to
+ * as_policy_base.cancel of each command that should be cancelled together, then call
+ * as_async_cancel_abort() to abort all of these commands. Aborted commands call their listener
+ * with AEROSPIKE_ERR_CLIENT_ABORT.
+ *
+ * Commands hold their own reference to the handle, so as_async_cancel_destroy() may be called
+ * while commands are still in process.
+ *
+ * @code
+ * as_async_cancel* cancel = as_async_cancel_create();
+ *
+ * as_policy_read p;
+ * as_policy_read_init(&p);
+ * p.base.cancel = cancel;
+ *
+ * aerospike_key_get_async(&as, &err, &p, &key, listener, udata, NULL, NULL);
+ * ...
+ * // Upstream request was cancelled.
+ * as_async_cancel_abort(cancel);
+ * as_async_cancel_destroy(cancel);
+ * @endcode
+ *
+ * @ingroup async_events
+ */
+typedef struct as_async_cancel_s {
+	/**
+	 * @private
+	 * Protects command list and reference count.
+	 */
+	pthread_mutex_t lock;
+
+	/**
+	 * @private
+	 * Commands that have started on their event loop and have not completed.
+	 */
+	struct as_event_command* commands;
+
+	/**
+	 * @private
+	 */
+	uint32_t ref_count;
+
+	/**
+	 * @private
+	 */
+	bool aborted;
+} as_async_cancel;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Create cancellation handle on heap.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN as_async_cancel*
+as_async_cancel_create(void);
+
+/**
+ * Release caller's reference to the cancellation handle. The handle is freed when all commands
+ * that reference it have completed. Destroying the handle does not abort its commands.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN void
+as_async_cancel_destroy(as_async_cancel* cancel);
+
+/**
+ * Abort all commands that reference this handle. The abort is processed in each command's
+ * event loop thread, so listeners may still be called with a result before the abort is
+ * applied. Commands that are started after this call fail with AEROSPIKE_ERR_CLIENT_ABORT.
+ *
+ * Commands waiting in the delay queue or waiting to retry are removed without using a
+ * connection. Commands in process have their connection closed, because the server response
+ * may still be in flight. Pipelined commands share their connection with other commands and
+ * are not aborted once they have started.
+ *
+ * This function may be called from any thread.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN void
+as_async_cancel_abort(as_async_cancel* cancel);
+
+/**
+ * Return if as_async_cancel_abort() has been called for this handle.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN bool
+as_async_cancel_is_aborted(as_async_cancel* cancel);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
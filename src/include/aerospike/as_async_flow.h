@@ -0,0 +1,133 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_event_executor;
+
+/**
+ * Flow control for an async scan or query. Assign to as_policy_scan.flow or
+ * as_policy_query.flow before starting the scan or query. When paused, each node command
+ * stops reading its socket after the record block currently being parsed, so records are
+ * not delivered faster than the application can consume them. The server stops sending
+ * when the socket buffers are full.
+ *
+ * The flow must remain valid until the scan or query completes and may only be used for
+ * one scan or query at a time. as_async_flow_pause() and as_async_flow_resume() must be
+ * called from the scan or query's event loop thread, for example from the record listener
+ * or through as_event_execute().
+ *
+ * A paused command is still subject to total_timeout. Socket timeouts are not applied while
+ * paused, but the server may abort a scan or query that is paused for longer than the
+ * server's socket send timeout.
+ *
+ * Flow control is not applied to TLS connections or when the io_uring event framework
+ * is used.
+ *
+ * ~~~~~~~~~~{.c}
+ * static as_async_flow flow;
+ *
+ * static bool
+ * my_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+ * {
+ *     if (rec && my_queue_full()) {
+ *         // Resume later with as_async_flow_resume(&flow) on the same event loop.
+ *         as_async_flow_pause(&flow);
+ *     }
+ *     return true;
+ * }
+ *
+ * as_async_flow_init(&flow);
+ *
+ * as_policy_scan policy;
+ * as_policy_scan_init(&policy);
+ * policy.flow = &flow;
+ * aerospike_scan_async(&as, &err, &policy, &scan, NULL, my_listener, NULL, NULL);
+ * ~~~~~~~~~~
+ *
+ * @ingroup async_events
+ */
+typedef struct as_async_flow_s {
+	/**
+	 * @private
+	 * Executor of the scan or query in progress. NULL if not running.
+	 */
+	struct as_event_executor* executor;
+
+	/**
+	 * @private
+	 * Record intake is paused.
+	 */
+	bool paused;
+} as_async_flow;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize flow control in the resumed state.
+ *
+ * @relates as_async_flow
+ */
+static inline void
+as_async_flow_init(as_async_flow* flow)
+{
+	flow->executor = NULL;
+	flow->paused = false;
+}
+
+/**
+ * Stop reading records for the scan or query using this flow. Records already received in
+ * the current block are still delivered. Pausing before the scan or query starts is allowed.
+ *
+ * @relates as_async_flow
+ */
+AS_EXTERN void
+as_async_flow_pause(as_async_flow* flow);
+
+/**
+ * Resume reading records for the scan or query using this flow.
+ *
+ * @relates as_async_flow
+ */
+AS_EXTERN void
+as_async_flow_resume(as_async_flow* flow);
+
+/**
+ * Return if the flow is paused.
+ *
+ * @relates as_async_flow
+ */
+static inline bool
+as_async_flow_paused(as_async_flow* flow)
+{
+	return flow->paused;
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_listener.h>
+#include <aerospike/as_policy.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Return if a single record async read with this policy can be merged into a batch read.
+ * Only default read policies without filters, transactions, hedging or record ownership
+ * transfer are merged, so the merged batch behaves the same as the single record reads.
+ */
+static inline bool
+as_auto_batch_eligible(aerospike* as, const as_policy_read* policy, as_pipe_listener pipe_listener)
+{
+	if (as->cluster->auto_batch_max <= 1 || policy || pipe_listener) {
+		return false;
+	}
+
+	const as_policy_read* p = &aerospike_load_config(as)->policies.read;
+
+	return ! p->base.filter_exp && ! p->base.txn && ! p->base.cancel && p->hedge_delay == 0 && ! p->async_heap_rec &&
+		! p->zero_copy && ! p->lazy_deserialize;
+}
+
+/**
+ * @private
+ * Queue single record read of all bins on the event loop's auto batch. Reads queued while
+ * the event loop processes its command queue, up to cluster->auto_batch_max keys, are sent
+ * as one batch read. Each listener is called with its own record or error.
+ */
+as_status
+as_auto_batch_get(
+	aerospike* as, as_error* err, const as_key* key, as_async_record_listener listener,
+	void* udata, as_event_loop* event_loop
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
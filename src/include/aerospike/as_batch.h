@@ -99,6 +99,87 @@ typedef struct as_batch_result_s {
  */
 typedef as_batch_result as_batch_read;
 
+/**
+ * Batch of keys that share one namespace and set, stored as a contiguous array of digests.
+ * Unlike as_batch, no as_key is constructed per key, so large batches only cost 20 bytes
+ * per key. Digests can be copied directly into the digests array or computed from user keys
+ * with as_batch_digests_set_int64() and as_batch_digests_set_str(). User keys are not stored,
+ * so records are always read by digest.
+ *
+ * @code
+ * as_batch_digests batch;
+ * as_batch_digests_init(&batch, "ns", "set", 10000);
+ *
+ * for (uint32_t i = 0; i < 10000; i++) {
+ *     as_batch_digests_set_int64(&batch, i, ids[i]);
+ * }
+ * aerospike_batch_exists_digests(&as, &err, NULL, &batch, &results);
+ * as_batch_digests_destroy(&batch);
+ * @endcode
+ *
+ * @ingroup batch_operations
+ */
+typedef struct as_batch_digests_s {
+	/**
+	 * Namespace of all keys.
+	 */
+	as_namespace ns;
+
+	/**
+	 * Set name of all keys.
+	 */
+	as_set set;
+
+	/**
+	 * Key digests.
+	 */
+	as_digest_value* digests;
+
+	/**
+	 * Number of digests.
+	 */
+	uint32_t size;
+
+	/**
+	 * If true, digests will be freed when as_batch_digests_destroy() is called.
+	 */
+	bool _free;
+} as_batch_digests;
+
+/**
+ * Batch of compact keys. Unlike as_batch_digests, keys may have different sets and may
+ * retain their user keys. Records are read by digest and user keys are not sent.
+ *
+ * @code
+ * as_batch_compact batch;
+ * as_batch_compact_init(&batch, n);
+ *
+ * for (uint32_t i = 0; i < n; i++) {
+ *     as_key_compact_init(&batch.keys[i], &err, &keys[i], false);
+ * }
+ * aerospike_batch_exists_compact(&as, &err, NULL, &batch, &results);
+ * as_batch_compact_destroy(&batch);
+ * @endcode
+ *
+ * @ingroup batch_operations
+ */
+typedef struct as_batch_compact_s {
+	/**
+	 * Compact keys.
+	 */
+	as_key_compact* keys;
+
+	/**
+	 * Number of keys.
+	 */
+	uint32_t size;
+
+	/**
+	 * If true, keys will be freed when as_batch_compact_destroy() is called.
+	 */
+	bool _free;
+} as_batch_compact;
+
 //---------------------------------
 // Macros
 //---------------------------------
@@ -214,6 +295,69 @@ as_batch_keyat(const as_batch* batch, uint32_t i)
 	return (batch != NULL && batch->keys.entries != NULL && batch->keys.size > i) ? &batch->keys.entries[i] : NULL;
 }
 
+/**
+ * Initialize digest batch for `size` keys in the given namespace and set. The digests array
+ * is allocated on the heap and is not initialized.
+ *
+ * @param batch		The digest batch to initialize.
+ * @param ns		Namespace of all keys.
+ * @param set		Set name of all keys.
+ * @param size		The number of keys.
+ *
+ * @relates as_batch_digests
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_batch_digests*
+as_batch_digests_init(as_batch_digests* batch, const char* ns, const char* set, uint32_t size);
+
+/**
+ * Release digests allocated by as_batch_digests_init().
+ *
+ * @relates as_batch_digests
+ * @ingroup batch_operations
+ */
+AS_EXTERN void
+as_batch_digests_destroy(as_batch_digests* batch);
+
+/**
+ * Compute digest of integer user key at position i.
+ *
+ * @return true if position is valid.
+ * @relates as_batch_digests
+ * @ingroup batch_operations
+ */
+AS_EXTERN bool
+as_batch_digests_set_int64(as_batch_digests* batch, uint32_t i, int64_t value);
+
+/**
+ * Compute digest of string user key at position i.
+ *
+ * @return true if position is valid.
+ * @relates as_batch_digests
+ * @ingroup batch_operations
+ */
+AS_EXTERN bool
+as_batch_digests_set_str(as_batch_digests* batch, uint32_t i, const char* value);
+
+/**
+ * Initialize compact batch for `size` keys. The keys array is allocated on the heap and
+ * zero initialized.
+ *
+ * @relates as_batch_compact
+ * @ingroup batch_operations
+ */
+AS_EXTERN as_batch_compact*
+as_batch_compact_init(as_batch_compact* batch, uint32_t size);
+
+/**
+ * Release user keys of all compact keys and the keys allocated by as_batch_compact_init().
+ *
+ * @relates as_batch_compact
+ * @ingroup batch_operations
+ */
+AS_EXTERN void
+as_batch_compact_destroy(as_batch_compact* batch);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Bin names encoded once as read operations and reused by many reads. Names are validated
+ * when the projection is created, so reads that use it copy the encoded operations into
+ * the command without calling strlen() on each name.
+ *
+ * A projection can be passed to aerospike_key_select_projection() and set on batch read
+ * records with as_batch_read_set_projection(). A projection is read only after creation and
+ * can be shared by any number of threads and pending commands.
+ *
+ * ~~~~~~~~~~{.c}
+ * static const char* bins[] = {"name", "age", "city"};
+ *
+ * as_bin_projection proj;
+ * as_bin_projection_init(&proj, &err, bins, 3);
+ *
+ * as_record* rec = NULL;
+ * aerospike_key_select_projection(&as, &err, NULL, &key, &proj, &rec);
+ * as_record_destroy(rec);
+ *
+ * as_bin_projection_destroy(&proj);
+ * ~~~~~~~~~~
+ *
+ * @ingroup key_operations
+ */
+typedef struct as_bin_projection_s {
+	/**
+	 * Copy of bin names. Used where encoded operations can not be copied as is,
+	 * for example batch reads on older servers.
+	 */
+	char** bins;
+
+	/**
+	 * @private
+	 * Bin names encoded as read operations.
+	 */
+	uint8_t* ops;
+
+	/**
+	 * @private
+	 * Size of encoded operations.
+	 */
+	uint32_t ops_size;
+
+	/**
+	 * Number of bin names.
+	 */
+	uint32_t n_bins;
+} as_bin_projection;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Copy and encode bin names. The bins array is not referenced after this call.
+ *
+ * @param proj		The projection to initialize.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param bins		The bin names. The array does not need a final NULL entry.
+ * @param n_bins	The count of bin names.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @relates as_bin_projection
+ */
+AS_EXTERN as_status
+as_bin_projection_init(
+	as_bin_projection* proj, as_error* err, const char* bins[], uint32_t n_bins
+	);
+
+/**
+ * Release memory held by projection.
+ *
+ * @relates as_bin_projection
+ */
+AS_EXTERN void
+as_bin_projection_destroy(as_bin_projection* proj);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Iterator over set bits of a big endian bitmap (bit 0 is the high bit of byte 0).
+ * The bitmap is scanned a 64 bit word at a time, so clear regions cost one load per word.
+ * When prev is set, only bits that are set in bitmap and clear in prev are returned.
+ */
+typedef struct as_bitmap_iter_s {
+	const uint8_t* bitmap;
+	const uint8_t* prev;
+	uint32_t size;
+	uint32_t base;
+	uint64_t word;
+} as_bitmap_iter;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Decode base64 encoded bitmap. Like cf_b64_decode(), the encoded characters are trusted
+ * to be valid. The output buffer must be at least cf_b64_decoded_buf_size(len) bytes.
+ * SIMD is used when available (AVX2/SSSE3 on x86_64 and NEON on arm64).
+ */
+AS_EXTERN void
+as_bitmap_b64_decode(const char* in, uint32_t len, uint8_t* out);
+
+/**
+ * @private
+ * Load the 64 bit word that starts at bit offset base. Bits at or beyond size are cleared.
+ */
+static inline uint64_t
+as_bitmap_load_word(const uint8_t* bitmap, uint32_t size, uint32_t base)
+{
+	const uint8_t* p = bitmap + (base >> 3);
+	uint32_t remaining = size - base;
+	uint64_t word;
+
+	if (remaining >= 64) {
+		memcpy(&word, p, sizeof(word));
+		return cf_swap_from_be64(word);
+	}
+
+	uint32_t nbytes = (remaining + 7) >> 3;
+	word = 0;
+
+	for (uint32_t i = 0; i < nbytes; i++) {
+		word |= (uint64_t)p[i] << (56 - (i << 3));
+	}
+	return word & ~(UINT64_MAX >> remaining);
+}
+
+/**
+ * @private
+ * Load next iterator word at iter->base.
+ */
+static inline uint64_t
+as_bitmap_iter_load(as_bitmap_iter* iter)
+{
+	uint64_t word = as_bitmap_load_word(iter->bitmap, iter->size, iter->base);
+
+	if (iter->prev) {
+		word &= ~as_bitmap_load_word(iter->prev, iter->size, iter->base);
+	}
+	return word;
+}
+
+/**
+ * @private
+ * Initialize iterator over the first size bits of bitmap.
+ */
+static inline void
+as_bitmap_iter_init(as_bitmap_iter* iter, const uint8_t* bitmap, uint32_t size)
+{
+	iter->bitmap = bitmap;
+	iter->prev = NULL;
+	iter->size = size;
+	iter->base = 0;
+	iter->word = size ? as_bitmap_iter_load(iter) : 0;
+}
+
+/**
+ * @private
+ * Initialize iterator over the first size bits that are set in bitmap, but not in prev.
+ */
+static inline void
+as_bitmap_iter_init_diff(
+	as_bitmap_iter* iter, const uint8_t* bitmap, const uint8_t* prev, uint32_t size
+	)
+{
+	iter->bitmap = bitmap;
+	iter->prev = prev;
+	iter->size = size;
+	iter->base = 0;
+	iter->word = size ? as_bitmap_iter_load(iter) : 0;
+}
+
+/**
+ * @private
+ * Return next set bit index in index. Return false when there are no more set bits.
+ */
+static inline bool
+as_bitmap_iter_next(as_bitmap_iter* iter, uint32_t* index)
+{
+	while (iter->word == 0) {
+		iter->base += 64;
+
+		if (iter->base >= iter->size) {
+			return false;
+		}
+		iter->word = as_bitmap_iter_load(iter);
+	}
+
+#if defined(_MSC_VER)
+	unsigned long msb;
+	_BitScanReverse64(&msb, iter->word);
+	uint32_t offset = 63 - (uint32_t)msb;
+#else
+	uint32_t offset = (uint32_t)__builtin_clzll(iter->word);
+#endif
+
+	iter->word &= UINT64_MAX >> offset >> 1;
+	*index = iter->base + offset;
+	return true;
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
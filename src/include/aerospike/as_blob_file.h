@@ -0,0 +1,115 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_record.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Read-only memory mapping of a file that is used as a bytes bin value.
+ *
+ * Large blobs stored from a mapping are never read into heap memory. When the write
+ * policy does not compress, aerospike_key_put() sends bytes values of at least 16KB
+ * directly from the bin's memory instead of copying them into the command buffer,
+ * so the file pages are written straight from the page cache to the socket. TLS
+ * connections encrypt the mapping in place, one TLS record at a time.
+ *
+ * @code
+ * as_blob_file blob;
+ *
+ * if (as_blob_file_open(&blob, &err, "/data/video.mp4") != AEROSPIKE_OK) {
+ *     return err.code;
+ * }
+ *
+ * as_record rec;
+ * as_record_inita(&rec, 1);
+ * as_blob_file_set(&blob, &rec, "media");
+ *
+ * aerospike_key_put(&as, &err, NULL, &key, &rec);
+ *
+ * as_record_destroy(&rec);
+ * as_blob_file_close(&blob);
+ * @endcode
+ *
+ * The mapping must stay open until the command completes. The file must not be
+ * truncated while it is mapped.
+ */
+typedef struct as_blob_file_s {
+	/**
+	 * Start of mapped file. NULL when the file is empty.
+	 */
+	uint8_t* data;
+
+	/**
+	 * File size in bytes.
+	 */
+	uint32_t size;
+
+#if defined(_MSC_VER)
+	void* mapping;
+#endif
+} as_blob_file;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Map file into memory for reading. Files larger than the maximum record size that the
+ * protocol can address are rejected.
+ *
+ * @param blob	The blob to initialize.
+ * @param err	The error is populated if the return value is not AEROSPIKE_OK.
+ * @param path	Path of file to map.
+ *
+ * @relates as_blob_file
+ */
+AS_EXTERN as_status
+as_blob_file_open(as_blob_file* blob, as_error* err, const char* path);
+
+/**
+ * Unmap file.
+ *
+ * @relates as_blob_file
+ */
+AS_EXTERN void
+as_blob_file_close(as_blob_file* blob);
+
+/**
+ * Set bin to a blob bytes value that references the mapped file without copying it.
+ *
+ * @return true on success, false on failure.
+ *
+ * @relates as_blob_file
+ */
+static inline bool
+as_blob_file_set(as_blob_file* blob, as_record* rec, const char* name)
+{
+	return as_record_set_raw_typep(rec, name, blob->data, blob->size, AS_BYTES_BLOB, false);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -71,6 +71,53 @@ typedef struct as_cdt_ctx {
 	as_vector list;
 } as_cdt_ctx;
 
+/**
+ * @private
+ * as_vector flag set on the context list of an as_cdt_ctx_prepared.
+ */
+#define AS_CDT_CTX_PREPARED 0x100
+
+/**
+ * Nested CDT context with its serialized form cached. Operations, expressions, secondary
+ * index and query filters that reference &prepared->ctx copy the cached bytes instead of
+ * serializing each context level again.
+ *
+ * @code
+ * as_cdt_ctx ctx;
+ * as_cdt_ctx_inita(&ctx, 2);
+ * as_cdt_ctx_add_map_key(&ctx, (as_val*)as_string_new("users", false));
+ * as_cdt_ctx_add_list_index(&ctx, -1);
+ *
+ * as_cdt_ctx_prepared prepared;
+ * as_cdt_ctx_prepare(&prepared, &ctx);
+ * as_cdt_ctx_destroy(&ctx);
+ *
+ * // Reuse prepared context in every request.
+ * as_operations_list_append(&ops, "bin", &prepared.ctx, NULL, (as_val*)&val);
+ *
+ * as_cdt_ctx_prepared_destroy(&prepared);
+ * @endcode
+ *
+ * @relates as_operations
+ * @ingroup base_operations
+ */
+typedef struct as_cdt_ctx_prepared_s {
+	/**
+	 * Context levels. Must not be modified after as_cdt_ctx_prepare().
+	 */
+	as_cdt_ctx ctx;
+
+	/**
+	 * Serialized context levels.
+	 */
+	uint8_t* packed;
+
+	/**
+	 * Size of packed.
+	 */
+	uint32_t packed_size;
+} as_cdt_ctx_prepared;
+
 //---------------------------------
 // Macros
 //---------------------------------
@@ -299,6 +346,30 @@ as_cdt_ctx_add_map_value(as_cdt_ctx* ctx, as_val* val)
 	as_vector_append(&ctx->list, &item);
 }
 
+/**
+ * Copy ctx levels into prepared and serialize them once. ctx is not modified and must still
+ * be destroyed by the caller. Values referenced by ctx levels are shared by reference count.
+ * Call as_cdt_ctx_prepared_destroy() when done with the prepared context.
+ *
+ * @param prepared	Target prepared context.
+ * @param ctx		Source CDT context.
+ * @return			true on success, false if ctx could not be serialized.
+ *
+ * @relates as_operations
+ * @ingroup base_operations
+ */
+AS_EXTERN bool
+as_cdt_ctx_prepare(as_cdt_ctx_prepared* prepared, const as_cdt_ctx* ctx);
+
+/**
+ * Destroy prepared context levels and cached bytes.
+ *
+ * @relates as_operations
+ * @ingroup base_operations
+ */
+AS_EXTERN void
+as_cdt_ctx_prepared_destroy(as_cdt_ctx_prepared* prepared);
+
 /**
  * Return exact serialized size of ctx. Return zero on error.
  */
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_bin.h>
+#include <aerospike/as_msgpack.h>
+#include <aerospike/as_record.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Cursor that reads list and map bin values directly from their msgpack bytes without building
+ * as_list or as_map values. The cursor does not allocate memory. Strings and blobs reference
+ * the bin bytes and remain valid while the record is not destroyed.
+ *
+ * Bins can only be read by a cursor when they hold raw bytes, so read the record with
+ * deserialize false or as_policy_read.lazy_deserialize true. This works for sync and async
+ * records alike.
+ *
+ * @code
+ * as_cdt_cursor cur;
+ *
+ * if (as_cdt_cursor_init_bin(&cur, rec, "values")) {
+ *     int64_t n = as_cdt_cursor_list(&cur);
+ *     int64_t sum = 0;
+ *
+ *     for (int64_t i = 0; i < n; i++) {
+ *         int64_t v;
+ *
+ *         if (as_cdt_cursor_type(&cur) == AS_INTEGER && as_cdt_cursor_int64(&cur, &v)) {
+ *             sum += v;
+ *         }
+ *         else {
+ *             as_cdt_cursor_skip(&cur);
+ *         }
+ *     }
+ * }
+ * @endcode
+ *
+ * @ingroup client_objects
+ */
+typedef struct as_cdt_cursor_s {
+	as_unpacker pk;
+} as_cdt_cursor;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize cursor over msgpack bytes.
+ */
+static inline void
+as_cdt_cursor_init(as_cdt_cursor* cur, const uint8_t* buffer, uint32_t size)
+{
+	cur->pk.buffer = buffer;
+	cur->pk.offset = 0;
+	cur->pk.length = size;
+}
+
+/**
+ * Initialize cursor over raw list or map bytes of a bin value. Return false if the value is
+ * not raw list or map bytes.
+ */
+AS_EXTERN bool
+as_cdt_cursor_init_value(as_cdt_cursor* cur, const as_bin_value* value);
+
+/**
+ * Initialize cursor over raw list or map bytes of a record bin. Lazy bins are not
+ * deserialized. Return false if the bin does not exist or has already been deserialized.
+ */
+AS_EXTERN bool
+as_cdt_cursor_init_bin(as_cdt_cursor* cur, const as_record* rec, const char* name);
+
+/**
+ * Return type of the next element without consuming it. Return AS_UNDEF at the end of the
+ * bytes or on invalid msgpack.
+ */
+AS_EXTERN as_val_t
+as_cdt_cursor_type(const as_cdt_cursor* cur);
+
+/**
+ * Consume list header. Return number of list elements that follow. Return -1 if the next
+ * element is not a list.
+ */
+AS_EXTERN int64_t
+as_cdt_cursor_list(as_cdt_cursor* cur);
+
+/**
+ * Consume map header. Return number of key/value pairs that follow. Each pair is read as a
+ * key element followed by a value element. The order header of sorted maps is skipped.
+ * Return -1 if the next element is not a map.
+ */
+AS_EXTERN int64_t
+as_cdt_cursor_map(as_cdt_cursor* cur);
+
+/**
+ * Read integer element. Return false if the next element is not an integer.
+ */
+AS_EXTERN bool
+as_cdt_cursor_int64(as_cdt_cursor* cur, int64_t* value);
+
+/**
+ * Read double element. Integer elements are converted. Return false if the next element is
+ * not a number.
+ */
+AS_EXTERN bool
+as_cdt_cursor_double(as_cdt_cursor* cur, double* value);
+
+/**
+ * Read boolean element. Return false if the next element is not a boolean.
+ */
+AS_EXTERN bool
+as_cdt_cursor_bool(as_cdt_cursor* cur, bool* value);
+
+/**
+ * Read string element. The returned string references the bin bytes and is not null
+ * terminated. Return NULL if the next element is not a string.
+ */
+AS_EXTERN const char*
+as_cdt_cursor_str(as_cdt_cursor* cur, uint32_t* len);
+
+/**
+ * Read blob element. The returned bytes reference the bin bytes. Return NULL if the next
+ * element is not a blob.
+ */
+AS_EXTERN const uint8_t*
+as_cdt_cursor_bytes(as_cdt_cursor* cur, uint32_t* size);
+
+/**
+ * Skip next element, including all elements of a nested list or map. Return false on
+ * invalid msgpack.
+ */
+AS_EXTERN bool
+as_cdt_cursor_skip(as_cdt_cursor* cur);
+
+/**
+ * Return true if all bytes have been read.
+ */
+static inline bool
+as_cdt_cursor_end(const as_cdt_cursor* cur)
+{
+	return cur->pk.offset >= cur->pk.length;
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
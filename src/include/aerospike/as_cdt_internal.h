@@ -17,8 +17,10 @@
 #pragma once
 
 #include <aerospike/as_msgpack.h>
+#include <aerospike/as_arena.h>
 #include <aerospike/as_cdt_ctx.h>
 #include <aerospike/as_operations.h>
+#include <citrusleaf/alloc.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,10 +46,35 @@ extern "C" {
 		break;\
 	}
 
+// Same as as_cdt_end(), but allocates the packed buffer from the operations arena if present.
+#define as_cdt_end_ops(pk, ops) \
+		if (!(pk)->buffer) {\
+			(pk)->buffer = as_cdt_alloc(ops, (pk)->offset);\
+			(pk)->capacity = (pk)->offset;\
+			(pk)->offset = 0;\
+			(pk)->head = NULL;\
+			(pk)->tail = NULL;\
+			continue;\
+		}\
+		break;\
+	}
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
 
+static inline const as_cdt_ctx_prepared*
+as_cdt_ctx_get_prepared(const as_cdt_ctx* ctx)
+{
+	return (ctx->list.flags & AS_CDT_CTX_PREPARED) ? (const as_cdt_ctx_prepared*)ctx : NULL;
+}
+
+static inline uint8_t*
+as_cdt_alloc(as_operations* ops, uint32_t size)
+{
+	return (ops && ops->arena) ? (uint8_t*)as_arena_alloc(ops->arena, size) : (uint8_t*)cf_malloc(size);
+}
+
 void
 as_cdt_pack_header(as_packer* pk, as_cdt_ctx* ctx, uint16_t command, uint32_t count);
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <citrusleaf/cf_clock.h>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+/**
+ * @private
+ * Read the coarse monotonic clock for deadlines and connection timestamps when supported.
+ * Set from as_config.coarse_clock.
+ */
+AS_EXTERN extern bool as_clock_coarse;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+/**
+ * @private
+ * Read kernel's cached monotonic time. This is a vDSO memory read without a hardware
+ * counter read. It shares the CLOCK_MONOTONIC base used by cf_getms()/cf_getns(), but
+ * lags it by up to one scheduler tick.
+ */
+static inline uint64_t
+as_clock_coarse_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+/**
+ * @private
+ * Current monotonic time in milliseconds for deadline arithmetic. Deadlines computed and
+ * checked with this clock may expire up to one scheduler tick late when the coarse
+ * clock is enabled.
+ */
+static inline uint64_t
+as_clock_getms(void)
+{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+	if (as_clock_coarse) {
+		return as_clock_coarse_ns() / 1000000;
+	}
+#endif
+	return cf_getms();
+}
+
+/**
+ * @private
+ * Current monotonic time in nanoseconds for millisecond scale intervals like connection
+ * idle times. Latency measurements must use cf_getns().
+ */
+static inline uint64_t
+as_clock_getns(void)
+{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+	if (as_clock_coarse) {
+		return as_clock_coarse_ns();
+	}
+#endif
+	return cf_getns();
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
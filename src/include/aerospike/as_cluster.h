@@ -23,7 +23,7 @@
 #include <aerospike/as_node.h>
 #include <aerospike/as_partition.h>
 #include <aerospike/as_policy.h>
-#include <aerospike/as_thread_pool.h>
+#include <aerospike/as_work_pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,6 +67,11 @@ typedef struct as_event_state_s {
 	 */
 	int pending;
 	
+	/**
+	 * Single record reads waiting to be merged into a batch read.
+	 */
+	struct as_auto_batch_s* auto_batch;
+
 	/**
 	 * Is cluster closed for this event loop.
 	 */
@@ -97,6 +102,15 @@ typedef struct as_gc_item_s {
 	as_release_fn release_fn;
 } as_gc_item;
 
+/**
+ * @private
+ * Garbage collected data and the epoch in which it was retired.
+ */
+typedef struct as_gc_epoch_item_s {
+	as_gc_item item;
+	uint64_t epoch;
+} as_gc_epoch_item;
+
 /**
  * Cluster of server nodes.
  */
@@ -113,11 +127,38 @@ typedef struct as_cluster_s {
 	 */
 	as_partition_tables partition_tables;
 
+	/**
+	 * @private
+	 * Process unique cluster number. Namespace handles cached in keys are only valid for the
+	 * cluster with the same serial.
+	 */
+	uint32_t serial;
+
+	/**
+	 * @private
+	 * Incremented when node racks or rack_ids change, so partition rack ranks are rebuilt.
+	 */
+	uint32_t racks_gen;
+
+	/**
+	 * @private
+	 * Incremented when a partition replica changes node or a node is removed. Key route hints
+	 * are only reused while routing_gen and racks_gen are unchanged.
+	 */
+	uint32_t routing_gen;
+
 	/**
 	 * @private
 	 * Garbage collector.
 	 */
 	as_vector* /* <as_gc_item> */ gc;
+
+	/**
+	 * @private
+	 * Garbage waiting for threads to leave the epoch in which it was retired.
+	 * Only used when epoch_reclaim is enabled.
+	 */
+	as_vector* /* <as_gc_epoch_item> */ gc_epoch;
 	
 	/**
 	 * @private
@@ -154,6 +195,12 @@ typedef struct as_cluster_s {
 	 */
 	char* app_id;
 
+	/**
+	 * @private
+	 * Application latency tag names. Entries may be null.
+	 */
+	char* latency_tags[AS_LATENCY_TAG_MAX];
+
 	/**
 	 * Cluster event function that will be called when nodes are added/removed from the cluster.
 	 */
@@ -164,6 +211,28 @@ typedef struct as_cluster_s {
 	 */
 	void* event_callback_udata;
 
+	/**
+	 * Command lifecycle trace function. NULL if tracing is disabled.
+	 */
+	as_trace_callback trace_callback;
+
+	/**
+	 * Trace user data that will be passed back to trace_callback.
+	 */
+	void* trace_udata;
+
+	/**
+	 * @private
+	 * Trace one out of every trace_sample_rate commands.
+	 */
+	uint32_t trace_sample_rate;
+
+	/**
+	 * @private
+	 * Count of commands considered for tracing. Only incremented when tracing is enabled.
+	 */
+	uint64_t trace_count;
+
 	/**
 	 * Cluster state for all event loops.
 	 */
@@ -195,8 +264,33 @@ typedef struct as_cluster_s {
 	/**
 	 * @private
 	 * Pool of threads used to query server nodes in parallel for batch, scan and query.
+	 * Points to local_pool or to the pool of shared_threads.
+	 */
+	as_work_pool* thread_pool;
+
+	/**
+	 * @private
+	 * Thread pool owned by this cluster when shared threads are not configured.
 	 */
-	as_thread_pool thread_pool;
+	as_work_pool local_pool;
+
+	/**
+	 * @private
+	 * Budget of in-flight command buffer bytes. NULL if as_config.memory_budget is zero.
+	 */
+	struct as_mem_budget_s* mem_budget;
+
+	/**
+	 * @private
+	 * Maximum milliseconds a sync command waits for the memory budget.
+	 */
+	uint32_t mem_budget_wait;
+
+	/**
+	 * @private
+	 * Shared worker pool and tend thread. NULL if this cluster runs its own threads.
+	 */
+	struct as_shared_threads_s* shared_threads;
 		
 	/**
 	 * @private
@@ -243,6 +337,25 @@ typedef struct as_cluster_s {
 	 */
 	uint64_t max_socket_idle_ns_trim;
 
+	/**
+	 * @private
+	 * Tend intervals in connection usage window.
+	 */
+	uint32_t conn_peak_window;
+
+	/**
+	 * @private
+	 * Pooled sync connections used or validated within this window skip checkout validation.
+	 * Zero validates on every checkout.
+	 */
+	uint64_t conn_validate_window_ns;
+
+	/**
+	 * @private
+	 * Sync commands use epoch based reclamation instead of node reference counts.
+	 */
+	bool epoch_reclaim;
+
 	/**
 	 * @private
 	 * Rack ids
@@ -261,18 +374,76 @@ typedef struct as_cluster_s {
 	 */
 	uint32_t error_rate_window;
 
+	/**
+	 * @private
+	 * Node circuit breaker settings. Breakers are disabled when breaker_ratio is zero.
+	 */
+	uint32_t breaker_ratio;
+	uint32_t breaker_min_commands;
+	uint32_t breaker_probes;
+	uint32_t breaker_open_tends;
+	uint32_t breaker_max_open_tends;
+
+	/**
+	 * @private
+	 * Node adaptive concurrency limit bounds. Limits are disabled when limit_max is zero.
+	 */
+	uint32_t limit_max;
+	uint32_t limit_min;
+
+	/**
+	 * @private
+	 * Retry budget in thousandths of a token. The budget is disabled when retry_budget_max
+	 * is zero.
+	 */
+	uint32_t retry_budget;
+	uint32_t retry_budget_max;
+	uint32_t retry_budget_refill;
+
 	/**
 	 * @private
 	 * Milliseconds between cluster tends.
 	 */
 	uint32_t tend_interval;
 
+	/**
+	 * @private
+	 * Maximum milliseconds between cluster tends. Adaptive tending is disabled when not greater
+	 * than tend_interval.
+	 */
+	uint32_t tend_interval_max;
+
+	/**
+	 * @private
+	 * Milliseconds until the next cluster tend. Only modified by the tend thread.
+	 */
+	uint32_t tend_interval_current;
+
+	/**
+	 * @private
+	 * Time in milliseconds of the next tend by the shared tend thread. Protected by the
+	 * shared threads lock.
+	 */
+	uint64_t tend_next;
+
 	/**
 	 * @private
 	 * Cluster tend counter.
 	 */
 	uint32_t tend_count;
 
+	/**
+	 * @private
+	 * Set by tend when the cluster changed during the last tend iteration.
+	 */
+	bool tend_changed;
+
+	/**
+	 * @private
+	 * Set by command threads to request a tend at the minimum interval.
+	 */
+	uint8_t tend_hurry;
+
 	/**
 	 * @private
 	 * Minimum sync connections per node.
@@ -284,6 +455,24 @@ typedef struct as_cluster_s {
 	 * Maximum sync connections per node.
 	 */
 	uint32_t max_conns_per_node;
+
+	/**
+	 * @private
+	 * Maximum sync connections opened per warming node per tend.
+	 */
+	uint32_t warm_up_conns_per_tend;
+
+	/**
+	 * @private
+	 * Maximum spare idle sync connections kept per node.
+	 */
+	uint32_t spare_conns_per_node;
+
+	/**
+	 * @private
+	 * Maximum sync connections concurrently opened by commands per node.
+	 */
+	uint32_t max_connects_per_node;
 	
 	/**
 	 * @private
@@ -291,17 +480,65 @@ typedef struct as_cluster_s {
 	 */
 	uint32_t async_min_conns_per_node;
 
+	/**
+	 * @private
+	 * Maximum async connections concurrently opened per node and event loop.
+	 */
+	uint32_t async_max_connects_per_loop;
+
+	/**
+	 * @private
+	 * Maximum single record async reads merged into one batch read.
+	 */
+	uint32_t auto_batch_max;
+
+	/**
+	 * @private
+	 * Run sync single record commands on the async event loops.
+	 */
+	bool sync_over_async;
+
+	/**
+	 * @private
+	 * Use pipelined connections for sync_over_async commands.
+	 */
+	bool sync_over_async_pipeline;
+
+	/**
+	 * @private
+	 * Minimum async response block size processed by the cluster thread pool.
+	 */
+	uint32_t offload_threshold;
+
 	/**
 	 * @private
 	 * Maximum async (non-pipeline) connections per node.
 	 */
 	uint32_t async_max_conns_per_node;
 
+	/**
+	 * @private
+	 * Allow event loops to borrow unused async connection share of other event loops.
+	 */
+	bool async_borrow_conns;
+
 	/**
 	 * @private
 	 * Maximum pipeline connections per node.
 	 */
 	uint32_t pipe_max_conns_per_node;
+
+	/**
+	 * @private
+	 * Maximum commands awaiting a response per pipeline connection. Zero if unlimited.
+	 */
+	uint32_t pipe_max_depth;
+
+	/**
+	 * @private
+	 * Pipeline response size that marks a connection busy. Zero if disabled.
+	 */
+	uint32_t pipe_large_response_size;
 	
 	/**
 	 * @private
@@ -309,6 +546,18 @@ typedef struct as_cluster_s {
 	 */
 	uint32_t conn_pools_per_node;
 
+	/**
+	 * @private
+	 * Number of lock-free connection cache slots per sync connection pool.
+	 */
+	uint32_t conn_cache_size;
+
+	/**
+	 * @private
+	 * Number of pipelined sync connections per node. Zero if disabled.
+	 */
+	uint32_t sync_pipes_per_node;
+
 	/**
 	 * @private
 	 * Initial connection timeout in milliseconds.
@@ -321,6 +570,18 @@ typedef struct as_cluster_s {
 	 */
 	uint32_t login_timeout_ms;
 
+	/**
+	 * @private
+	 * SO_BUSY_POLL microseconds set on sync connections.
+	 */
+	uint32_t socket_busy_poll_us;
+
+	/**
+	 * @private
+	 * TCP options applied to new connections.
+	 */
+	as_socket_options socket_options;
+
 	/**
 	 * @private
 	 * Random node index counter.
@@ -375,6 +636,13 @@ typedef struct as_cluster_s {
 	 */
 	bool rack_aware;
 
+	/**
+	 * @private
+	 * Request cluster-stable on each node tend. Set by the first query with
+	 * fail_on_cluster_change, so the query can read the cluster key from tend state.
+	 */
+	bool tend_cluster_key;
+
 	/**
 	 * @private
 	 * Is authentication enabled
@@ -387,12 +655,91 @@ typedef struct as_cluster_s {
 	 */
 	bool has_partition_query;
 
+	/**
+	 * @private
+	 * Configured compression codec.
+	 */
+	as_compress_codec compress_codec;
+
+	/**
+	 * @private
+	 * Compression codec used for commands. This is the configured codec when all nodes
+	 * support it. Otherwise, zlib.
+	 */
+	as_compress_codec compress_codec_current;
+
+	/**
+	 * @private
+	 * Compression statistics per codec.
+	 */
+	as_compress_stats compress_stats[AS_COMPRESS_CODEC_SIZE];
+
+	/**
+	 * @private
+	 * Pre-trained zstd dictionaries (as_compress_dict_entry). NULL if not configured.
+	 */
+	as_vector* compress_dicts;
+
+	/**
+	 * @private
+	 * Client quotas. NULL if not configured. Replaced when dynamic configuration changes.
+	 */
+	as_quotas* quotas;
+
+	/**
+	 * @private
+	 * Seed and peer hostname cache. NULL if not configured.
+	 */
+	struct as_dns_cache_s* dns_cache;
+
+	/**
+	 * @private
+	 * Multiplexed async background job waits.
+	 */
+	struct as_job_monitor_s* job_monitor;
+
+	/**
+	 * @private
+	 * Slow command log. NULL if not configured.
+	 */
+	struct as_slow_log_s* slow_log;
+
+	/**
+	 * @private
+	 * Cluster snapshot file path owned by as->config. NULL if not configured.
+	 */
+	char* snapshot_path;
+
+	/**
+	 * @private
+	 * Hash of node names and generations when the snapshot was last saved.
+	 */
+	uint64_t snapshot_key;
+
 	/**
 	 * @private
 	 * Fail on cluster init if seed node and all peers are not reachable.
 	 */
 	bool fail_if_not_connected;
 
+	/**
+	 * @private
+	 * Connect to seeds concurrently.
+	 */
+	bool seed_parallel;
+
+	/**
+	 * @private
+	 * Complete cluster init when partitions are covered.
+	 */
+	bool fast_start;
+
+	/**
+	 * @private
+	 * Cluster init is in progress with fast_start. Minimum connections are deferred to tend.
+	 */
+	bool fast_starting;
+
 	/**
 	 * @private
 	 * Should continue to tend cluster.
@@ -405,6 +752,13 @@ typedef struct as_cluster_s {
 	 */
 	bool metrics_enabled;
 
+	/**
+	 * @private
+	 * Set when a command uses adaptive socket timeouts. Node latency histograms used to
+	 * derive adaptive socket timeouts are only maintained after this is set.
+	 */
+	bool adaptive_timeouts;
+
 	/**
 	 * @private
 	 * Number of elapsed time range buckets in latency histograms. This is set using as_policy_metrics.
@@ -428,6 +782,35 @@ typedef struct as_cluster_s {
 	 */
 	uint8_t metrics_latency_shift;
 
+	/**
+	 * @private
+	 * Sub-bucket precision bits of high resolution latency histograms. Zero indicates that
+	 * high resolution latency histograms are disabled. This is set using as_policy_metrics.
+	 */
+	uint8_t metrics_latency_precision;
+
+	/**
+	 * @private
+	 * Number of heaviest keys tracked per node namespace. Zero indicates that hot key
+	 * tracking is disabled. This is set using as_policy_metrics.
+	 */
+	uint32_t metrics_hot_keys;
+
+	/**
+	 * @private
+	 * Latency sample rate of per-partition heatmaps. Zero indicates that heatmaps are
+	 * disabled. This is set using as_policy_metrics.
+	 */
+	uint32_t metrics_partition_heatmap;
+
+	/**
+	 * @private
+	 * Minimum milliseconds between kernel TCP state samples of a node's connections. Zero
+	 * indicates that sampling is disabled. This is set using as_policy_metrics and cleared
+	 * when metrics are disabled.
+	 */
+	uint32_t metrics_tcp_info_interval;
+
 	/**
 	 * @private
 	 * Number of cluster tend iterations between metrics notification events. One tend iteration
@@ -455,6 +838,13 @@ typedef struct as_cluster_s {
 	 */
 	uint64_t retry_count;
 
+	/**
+	 * @private
+	 * Count of retries denied because the retry budget was exhausted.
+	 * The value is cumulative and not reset per metrics interval.
+	 */
+	uint64_t retry_budget_exhausted_count;
+
 	/**
 	 * @private
 	 * Command count. The value is cumulative and not reset per metrics interval.
@@ -467,6 +857,84 @@ typedef struct as_cluster_s {
 	 */
 	uint64_t delay_queue_timeout_count;
 
+	/**
+	 * @private
+	 * Count of hedged read requests sent to a second replica.
+	 * The value is cumulative and not reset per metrics interval.
+	 */
+	uint64_t hedge_count;
+
+	/**
+	 * @private
+	 * Count of hedged read requests that completed before the original request.
+	 * The value is cumulative and not reset per metrics interval.
+	 */
+	uint64_t hedge_win_count;
+
+	/**
+	 * @private
+	 * Count of concurrent sync batches run sequentially in the calling thread because their
+	 * estimated cost was below the batch policy concurrent_threshold.
+	 */
+	uint64_t batch_inline_count;
+
+	/**
+	 * @private
+	 * Count of concurrent sync batches run in parallel threads.
+	 */
+	uint64_t batch_parallel_count;
+
+	/**
+	 * @private
+	 * Moving average of record size in batch responses. Used to estimate batch cost.
+	 */
+	uint32_t batch_record_size;
+
+	/**
+	 * @private
+	 * Duration of the last completed tend iteration in microseconds.
+	 */
+	uint64_t tend_duration;
+
+	/**
+	 * @private
+	 * Tend phase latency histograms indexed by as_tend_phase.
+	 */
+	as_latency_hdr* tend_latency[AS_TEND_PHASE_MAX];
+
+	/**
+	 * @private
+	 * Transaction commit and abort phase latency histograms indexed by as_txn_phase.
+	 */
+	as_latency_hdr* txn_latency[AS_TXN_PHASE_MAX];
+
+	/**
+	 * @private
+	 * Microseconds spent in each phase of the current tend iteration. Tend thread only.
+	 */
+	uint64_t tend_phase_us[AS_TEND_PHASE_MAX];
+
+	/**
+	 * @private
+	 * Info request that took longest to respond in the current tend iteration.
+	 * Tend thread only.
+	 */
+	const char* tend_slow_info;
+	uint64_t tend_slow_info_us;
+	char tend_slow_node[AS_NODE_NAME_SIZE];
+
+	/**
+	 * @private
+	 * Log tend iterations that take at least this many milliseconds. Zero disables logging.
+	 */
+	uint32_t tend_slow_threshold;
+
+	/**
+	 * @private
+	 * Allocator for command buffers, async commands and record response buffers.
+	 */
+	as_allocator allocator;
+
 	/**
 	 * @private
 	 * Aerospike back pointer.
@@ -481,7 +949,8 @@ typedef struct as_cluster_s {
 
 	/**
 	 * @private
-	 * Milliseconds between dynamic configuration check for file modifications.
+	 * Milliseconds between dynamic configuration check for file modifications when
+	 * file notifications are not available.
 	 */
 	uint32_t config_interval;
 
@@ -579,6 +1048,28 @@ as_cluster_add_seed(as_cluster* cluster, const char* hostname, const char* tls_n
 AS_EXTERN void
 as_cluster_remove_seed(as_cluster* cluster, const char* hostname, uint16_t port);
 
+/**
+ * @private
+ * Wake the tend thread when adaptive tending has extended the tend interval. Called on
+ * command errors that indicate a stale partition map.
+ */
+void
+as_cluster_hurry_tend(as_cluster* cluster);
+
+/**
+ * @private
+ * Wake the tend thread from its sleep between tends.
+ */
+void
+as_cluster_wake_tender(as_cluster* cluster);
+
+/**
+ * @private
+ * Run one tend iteration and return milliseconds until the next tend.
+ */
+uint32_t
+as_cluster_tend_run(as_cluster* cluster);
+
 /**
  * @private
  * Change user and password that is used to authenticate with cluster servers.
@@ -613,6 +1104,31 @@ as_partition_reg_get_node(
 	as_policy_replica replica, uint8_t replica_size, uint8_t* replica_index
 	);
 
+/**
+ * @private
+ * Get mapped node given partition and replica for the first attempt of a key command. Reuse
+ * the replica cached in the key's route hint if routing has not changed since the hint was
+ * stored. Otherwise, route normally and store a new hint.
+ */
+as_node*
+as_partition_reg_get_node_hint(
+	as_cluster* cluster, const struct as_key_s* key, const char* ns, as_partition* p,
+	as_policy_replica replica, uint8_t replica_size, uint8_t* replica_index
+	);
+
+/**
+ * @private
+ * Store active partition replicas that reside on the first rack in rack_ids order that
+ * contains any replica. Replicas are stored in sequence order starting at replica_index.
+ * The nodes array must hold AS_MAX_REPLICATION_FACTOR entries. Return number of nodes
+ * stored. The nodes are not reserved.
+ */
+uint32_t
+as_partition_reg_get_rack_nodes(
+	as_cluster* cluster, const char* ns, as_partition* p, uint8_t replica_size,
+	uint8_t replica_index, as_node** nodes
+	);
+
 struct as_partition_shm_s;
 
 /**
@@ -626,6 +1142,16 @@ as_partition_shm_get_node(
 	as_node* prev_node, as_policy_replica replica, uint8_t replica_size, uint8_t* replica_index
 	);
 
+/**
+ * @private
+ * Shared memory version of as_partition_reg_get_rack_nodes().
+ */
+uint32_t
+as_partition_shm_get_rack_nodes(
+	as_cluster* cluster, const char* ns, struct as_partition_shm_s* p, uint8_t replica_size,
+	uint8_t replica_index, as_node** nodes
+	);
+
 /**
  * @private
  * Enable the collection of metrics
@@ -652,6 +1178,22 @@ as_cluster_add_command_count(as_cluster* cluster)
 	}
 }
 
+/**
+ * @private
+ * Return trace id if command is sampled for tracing. Return zero if tracing is disabled or
+ * the command is not sampled.
+ */
+static inline uint64_t
+as_cluster_trace_begin(as_cluster* cluster)
+{
+	if (! cluster->trace_callback) {
+		return 0;
+	}
+
+	uint64_t count = as_aaf_uint64(&cluster->trace_count, 1);
+	return (count % cluster->trace_sample_rate == 0)? count : 0;
+}
+
 /**
  * @deprecated
  * Return command count. The value is cumulative and not reset per metrics interval.
@@ -703,6 +1245,74 @@ as_cluster_get_retry_count(const as_cluster* cluster)
 	return as_load_uint64(&cluster->retry_count);
 }
 
+/**
+ * @private
+ * Consume a retry budget token for a failed attempt. Return false if the budget is exhausted
+ * and the command should not be retried.
+ */
+static inline bool
+as_cluster_retry_budget_allow(as_cluster* cluster)
+{
+	if (cluster->retry_budget_max == 0) {
+		return true;
+	}
+
+	// A token is consumed even when the retry is denied, so the budget stays exhausted
+	// while failures continue.
+	while (true) {
+		uint32_t budget = as_load_uint32(&cluster->retry_budget);
+		uint32_t next = (budget > 1000)? budget - 1000 : 0;
+
+		if (as_cas_uint32(&cluster->retry_budget, budget, next)) {
+			if (next > cluster->retry_budget_max / 2) {
+				return true;
+			}
+			as_incr_uint64(&cluster->retry_budget_exhausted_count);
+			return false;
+		}
+	}
+}
+
+/**
+ * @private
+ * Refill retry budget after a successful command.
+ */
+static inline void
+as_cluster_retry_budget_success(as_cluster* cluster)
+{
+	if (cluster->retry_budget_max == 0) {
+		return;
+	}
+
+	// A full budget is only read, so successes do not contend on the budget cache line
+	// while the cluster is healthy.
+	uint32_t budget = as_load_uint32(&cluster->retry_budget);
+
+	while (budget < cluster->retry_budget_max) {
+		uint32_t next = budget + cluster->retry_budget_refill;
+
+		if (next > cluster->retry_budget_max) {
+			next = cluster->retry_budget_max;
+		}
+
+		if (as_cas_uint32(&cluster->retry_budget, budget, next)) {
+			return;
+		}
+		budget = as_load_uint32(&cluster->retry_budget);
+	}
+}
+
+/**
+ * @private
+ * Return count of retries denied by the retry budget. The value is cumulative and not reset
+ * per metrics interval.
+ */
+static inline uint64_t
+as_cluster_get_retry_budget_exhausted_count(const as_cluster* cluster)
+{
+	return as_load_uint64(&cluster->retry_budget_exhausted_count);
+}
+
 /**
  * @private
  * Increment async delay queue timeout count.
@@ -723,6 +1333,151 @@ as_cluster_get_delay_queue_timeout_count(const as_cluster* cluster)
 	return as_load_uint64(&cluster->delay_queue_timeout_count);
 }
 
+/**
+ * @private
+ * Increment hedged read count.
+ */
+static inline void
+as_cluster_add_hedge(as_cluster* cluster)
+{
+	as_incr_uint64(&cluster->hedge_count);
+}
+
+/**
+ * @private
+ * Return hedged read count.
+ */
+static inline uint64_t
+as_cluster_get_hedge_count(const as_cluster* cluster)
+{
+	return as_load_uint64(&cluster->hedge_count);
+}
+
+/**
+ * @private
+ * Increment count of hedged reads that won.
+ */
+static inline void
+as_cluster_add_hedge_win(as_cluster* cluster)
+{
+	as_incr_uint64(&cluster->hedge_win_count);
+}
+
+/**
+ * @private
+ * Return count of hedged reads that won.
+ */
+static inline uint64_t
+as_cluster_get_hedge_win_count(const as_cluster* cluster)
+{
+	return as_load_uint64(&cluster->hedge_win_count);
+}
+
+/**
+ * @private
+ * Increment count of batches run sequentially or in parallel threads.
+ */
+static inline void
+as_cluster_add_batch_strategy(as_cluster* cluster, bool parallel)
+{
+	as_incr_uint64(parallel ? &cluster->batch_parallel_count : &cluster->batch_inline_count);
+}
+
+/**
+ * @private
+ * Fold a batch response record size sample into the moving average. Concurrent updates
+ * may lose a sample, which is acceptable for an estimate.
+ */
+static inline void
+as_cluster_add_batch_record_size(as_cluster* cluster, uint32_t size)
+{
+	uint32_t avg = as_load_uint32(&cluster->batch_record_size);
+	avg = avg ? avg - (avg >> 3) + (size >> 3) : size;
+	as_store_uint32(&cluster->batch_record_size, avg);
+}
+
+/**
+ * @private
+ * Return moving average of batch response record size. Zero if no batch has completed.
+ */
+static inline uint32_t
+as_cluster_get_batch_record_size(const as_cluster* cluster)
+{
+	return as_load_uint32(&cluster->batch_record_size);
+}
+
+/**
+ * @private
+ * Return duration of the last completed tend iteration in microseconds.
+ */
+static inline uint64_t
+as_cluster_get_tend_duration(const as_cluster* cluster)
+{
+	return as_load_uint64(&cluster->tend_duration);
+}
+
+/**
+ * @private
+ * Admit a command to the client quota of its namespace and set. See as_quotas_acquire().
+ */
+static inline as_status
+as_cluster_quota_acquire(
+	as_cluster* cluster, as_error* err, const char* ns, const char* set, as_quota_type type,
+	uint32_t max_wait_ms, uint32_t* delay_ms
+	)
+{
+	as_quotas* quotas = (as_quotas*)as_load_ptr((void* const*)&cluster->quotas);
+
+	if (! quotas) {
+		*delay_ms = 0;
+		return AEROSPIKE_OK;
+	}
+	return as_quotas_acquire(quotas, err, ns, set, type, max_wait_ms, delay_ms);
+}
+
+/**
+ * @private
+ * Admit a command to the client quota of its namespace and set and sleep until it may be sent.
+ */
+static inline as_status
+as_cluster_quota_wait(
+	as_cluster* cluster, as_error* err, const char* ns, const char* set, as_quota_type type,
+	uint32_t max_wait_ms
+	)
+{
+	as_quotas* quotas = (as_quotas*)as_load_ptr((void* const*)&cluster->quotas);
+
+	if (! quotas) {
+		return AEROSPIKE_OK;
+	}
+	return as_quotas_wait(quotas, err, ns, set, type, max_wait_ms);
+}
+
+/**
+ * @private
+ * Calculate tend phase latency percentiles. The out array must have AS_TEND_PHASE_MAX entries.
+ */
+void
+as_cluster_tend_stats(as_cluster* cluster, as_latency_percentiles* out);
+
+/**
+ * @private
+ * Calculate transaction phase latency percentiles. The out array must have AS_TXN_PHASE_MAX
+ * entries.
+ */
+void
+as_cluster_txn_stats(as_cluster* cluster, as_latency_percentiles* out);
+
+/**
+ * @private
+ * Record duration of a transaction commit or abort phase that started at begin (cf_getns()).
+ */
+static inline void
+as_cluster_add_txn_latency(as_cluster* cluster, as_txn_phase phase, uint64_t begin)
+{
+	as_latency_hdr_add(cluster->txn_latency[phase], (cf_getns() - begin) / 1000);
+}
+
 /**
  * @private
  * Get mapped node given partition and replica.  This function does not reserve the node.
@@ -746,12 +1501,79 @@ as_partition_get_node(
 
 /**
  * @private
- * Increment node's error count.
+ * Get mapped node given key, partition and replica. The first attempt of deterministic replica
+ * algorithms reuses the key's route hint. This function does not reserve the node.
+ */
+static inline as_node*
+as_partition_get_node_key(
+	as_cluster* cluster, const struct as_key_s* key, const char* ns, void* partition,
+	as_node* prev_node, as_policy_replica replica, uint8_t replica_size, uint8_t* replica_index
+	)
+{
+	// Master routing is already a single load. Other algorithms depend on latency or rotation.
+	if (key && ! prev_node && ! cluster->shm_info &&
+		(replica == AS_POLICY_REPLICA_PREFER_RACK || replica == AS_POLICY_REPLICA_SEQUENCE)) {
+		return as_partition_reg_get_node_hint(cluster, key, ns, (as_partition*)partition,
+			replica, replica_size, replica_index);
+	}
+	return as_partition_get_node(cluster, ns, partition, prev_node, replica, replica_size,
+		replica_index);
+}
+
+/**
+ * @private
+ * Store active partition replicas on the preferred rack. See as_partition_reg_get_rack_nodes().
+ */
+static inline uint32_t
+as_partition_get_rack_nodes(
+	as_cluster* cluster, const char* ns, void* partition, uint8_t replica_size,
+	uint8_t replica_index, as_node** nodes
+	)
+{
+	if (cluster->shm_info) {
+		return as_partition_shm_get_rack_nodes(cluster, ns, (struct as_partition_shm_s*)partition,
+			replica_size, replica_index, nodes);
+	}
+	else {
+		return as_partition_reg_get_rack_nodes(cluster, ns, (as_partition*)partition,
+			replica_size, replica_index, nodes);
+	}
+}
+
+/**
+ * @private
+ * Return if single record commands to the node are subject to a concurrency limit.
+ */
+static inline bool
+as_node_limited(as_node* node)
+{
+	return node->cluster->limit_max > 0;
+}
+
+/**
+ * @private
+ * Increment node's error count and circuit breaker failures.
  */
 static inline void
 as_node_incr_error_rate(as_node* node)
 {
 	as_incr_uint32(&node->error_rate);
+
+	if (node->cluster->breaker_ratio > 0) {
+		as_incr_uint32(&node->breaker_failures);
+	}
+}
+
+/**
+ * @private
+ * Increment node's circuit breaker successes.
+ */
+static inline void
+as_node_breaker_success(as_node* node)
+{
+	if (node->cluster->breaker_ratio > 0) {
+		as_incr_uint32(&node->breaker_successes);
+	}
 }
 
 /**
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_cluster_s;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Restore nodes and partition maps from cluster->snapshot_path. Restored nodes are not
+ * validated until the first cluster tend. Return false if the snapshot does not exist, is
+ * invalid or no nodes could be restored. The cluster is not modified in that case.
+ */
+bool
+as_cluster_snapshot_load(struct as_cluster_s* cluster);
+
+/**
+ * @private
+ * Save nodes and partition maps to cluster->snapshot_path if they changed since the last
+ * save. Must be called from the tend thread.
+ */
+void
+as_cluster_snapshot_save(struct as_cluster_s* cluster);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_listener.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_policy.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Caller waiting on a coalesced operate.
+ */
+typedef struct as_coalesce_waiter_s {
+	as_async_record_listener listener;
+	void* udata;
+} as_coalesce_waiter;
+
+/**
+ * @private
+ * Pending bin operation. Integer and double increments on the same bin are summed. List
+ * appends are kept in call order.
+ */
+typedef struct as_coalesce_op_s {
+	char name[AS_BIN_NAME_MAX_SIZE];
+	as_val_t type;
+	union {
+		int64_t i;
+		double d;
+		as_bytes* bytes;
+	} value;
+} as_coalesce_op;
+
+/**
+ * @private
+ * Operations merged for one record. Entries are linked in a hash bucket by digest and in
+ * creation order, which is also deadline order.
+ */
+typedef struct as_coalesce_entry_s {
+	struct as_coalesce_entry_s* next;
+	struct as_coalesce_entry_s* fifo_prev;
+	struct as_coalesce_entry_s* fifo_next;
+	as_key key;
+	as_policy_operate policy;
+	const as_policy_operate* policy_src;
+	as_event_loop* event_loop;
+	as_coalesce_op* ops;
+	as_coalesce_waiter* waiters;
+	uint64_t deadline;
+	uint32_t ttl;
+	uint32_t n_ops;
+	uint32_t ops_capacity;
+	uint32_t n_waiters;
+	uint32_t waiters_capacity;
+} as_coalesce_entry;
+
+/**
+ * Async operate coalescer. Commutative operations on the same record that are submitted
+ * through as_coalescer_operate() within the coalescing window are sent to the server as one
+ * operate command, so concurrent updates of hot keys take one round trip and one record lock
+ * instead of one per call. Merged operations are integer and double increments
+ * (as_operations_add_incr(), as_operations_add_incr_double()) and list appends without
+ * context (as_operations_list_append()).
+ *
+ * Every caller's listener is called with the combined result. Calls that contain other
+ * operations, or use a generation check, filter expression, transaction or async_heap_rec,
+ * are executed immediately with aerospike_key_operate_async().
+ *
+ * ~~~~~~~~~~{.c}
+ * as_coalescer* coalescer = as_coalescer_create(&as, 2, 64);
+ *
+ * as_operations ops;
+ * as_operations_inita(&ops, 1);
+ * as_operations_add_incr(&ops, "count", 1);
+ * as_coalescer_operate(coalescer, &err, NULL, &key, &ops, my_listener, NULL, NULL);
+ * as_operations_destroy(&ops);
+ * ...
+ * as_coalescer_destroy(coalescer);
+ * ~~~~~~~~~~
+ *
+ * @ingroup async_events
+ */
+typedef struct as_coalescer_s {
+	aerospike* as;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+	as_coalesce_entry** buckets;
+	as_coalesce_entry* head;
+	as_coalesce_entry* tail;
+	uint32_t n_buckets;
+	uint32_t window_ms;
+	uint32_t max_waiters;
+	bool valid;
+
+	/**
+	 * Count of calls merged into another call's command.
+	 */
+	uint64_t merged;
+
+	/**
+	 * Count of commands sent for merged calls.
+	 */
+	uint64_t flushed;
+} as_coalescer;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Create coalescer and start its flush thread.
+ *
+ * @param as			Aerospike instance used to execute commands.
+ * @param window_ms		Maximum time in milliseconds a call waits for other calls on the same
+ *						record before its command is sent.
+ * @param max_waiters	Send command early when this many calls are merged. Zero means no limit.
+ *
+ * @return Coalescer or NULL if the flush thread could not be started.
+ * @relates as_coalescer
+ */
+AS_EXTERN as_coalescer*
+as_coalescer_create(aerospike* as, uint32_t window_ms, uint32_t max_waiters);
+
+/**
+ * Send pending commands, stop flush thread and release coalescer. Listeners of pending calls
+ * may be called after this function returns, so the aerospike instance must remain connected
+ * until they complete.
+ *
+ * @relates as_coalescer
+ */
+AS_EXTERN void
+as_coalescer_destroy(as_coalescer* coalescer);
+
+/**
+ * Asynchronously perform operations on a record, merging commutative operations with other
+ * calls on the same record within the coalescing window. The ops are copied and may be
+ * destroyed after this call. The policy and event loop of the first call on a record are used
+ * for the merged command, and only calls that reference the same policy instance and ttl are
+ * merged. Merged commands are sent with the key digest only, so the user key is not stored
+ * when as_policy_operate.key is AS_POLICY_KEY_SEND.
+ *
+ * @param coalescer		Coalescer.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key			The key of the record.
+ * @param ops			The operations to perform on the record.
+ * @param listener		User function to be called with command results.
+ * @param udata			User data to be forwarded to user callback.
+ * @param event_loop	Event loop assigned to run this command. If NULL, an event loop will be chosen.
+ *
+ * @return AEROSPIKE_OK if async command succesfully queued. Otherwise an error.
+ * @relates as_coalescer
+ */
+AS_EXTERN as_status
+as_coalescer_operate(
+	as_coalescer* coalescer, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_operations* ops, as_async_record_listener listener, void* udata,
+	as_event_loop* event_loop
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_bin.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Arrow C Data Interface
+//---------------------------------
+
+// Definitions from the Arrow C data interface specification. The guard lets applications
+// include Arrow headers that define the same structures.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+	void (*release)(struct ArrowSchema*);
+	void* private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+	void (*release)(struct ArrowArray*);
+	void* private_data;
+};
+
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Arrow type of a columnar scan column.
+ *
+ * @ingroup scan_operations
+ */
+typedef enum as_column_type_e {
+	/**
+	 * Integer bins as Arrow int64.
+	 */
+	AS_COLUMN_INT64,
+
+	/**
+	 * Double bins as Arrow float64.
+	 */
+	AS_COLUMN_DOUBLE,
+
+	/**
+	 * Boolean bins as Arrow boolean.
+	 */
+	AS_COLUMN_BOOL,
+
+	/**
+	 * String bins as Arrow utf8.
+	 */
+	AS_COLUMN_STRING,
+
+	/**
+	 * Blob bins as Arrow binary.
+	 */
+	AS_COLUMN_BYTES
+} as_column_type;
+
+/**
+ * Bin that is written to a column.
+ *
+ * @ingroup scan_operations
+ */
+typedef struct as_column_s {
+	/**
+	 * Bin name.
+	 */
+	as_bin_name name;
+
+	/**
+	 * Column type. A bin whose particle type does not match the column type is null in
+	 * that row.
+	 */
+	as_column_type type;
+} as_column;
+
+/**
+ * Columns written by aerospike_scan_partitions_columnar(). Every record batch is an Arrow
+ * struct array with one child array per column in schema order. Records without a bin
+ * have a null value in that bin's column.
+ *
+ * @ingroup scan_operations
+ */
+typedef struct as_columnar_schema_s {
+	/**
+	 * Columns in batch order.
+	 */
+	const as_column* columns;
+
+	/**
+	 * Number of columns.
+	 */
+	uint32_t n_columns;
+
+	/**
+	 * Maximum number of records in a batch. Batches are smaller at the end of each node
+	 * command and when variable length data of a batch exceeds 1 GiB.
+	 */
+	uint32_t batch_size;
+} as_columnar_schema;
+
+/**
+ * Callback for each record batch. The callback owns the batch buffers and must call
+ * release() when done with them. The ArrowArray structure itself is only valid during the
+ * callback, so copy (move) it to keep the batch. Multiple node commands may call back
+ * concurrently. Return false to abort the scan.
+ *
+ * @ingroup scan_operations
+ */
+typedef bool (*as_columnar_callback)(struct ArrowArray* batch, void* udata);
+
+/**
+ * @private
+ * Column buffers of the batch being filled.
+ */
+typedef struct as_column_builder_s {
+	uint8_t* validity;
+	uint8_t* values;
+	int32_t* offsets;
+	uint32_t size;
+	uint32_t capacity;
+	int64_t null_count;
+} as_column_builder;
+
+/**
+ * @private
+ * Writes wire bins of one node command into column buffers.
+ */
+typedef struct as_columnar_builder_s {
+	const as_columnar_schema* schema;
+	as_column_builder* columns;
+	as_digest* digests;
+	uint32_t n_rows;
+	uint32_t var_size;
+} as_columnar_builder;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Export Arrow schema of the record batches produced for this columnar schema. The caller
+ * must call schema->release() when done with it.
+ *
+ * @relates as_columnar_schema
+ */
+AS_EXTERN void
+as_columnar_schema_export(const as_columnar_schema* schema, struct ArrowSchema* out);
+
+/**
+ * @private
+ * Allocate buffers of the first batch.
+ */
+void
+as_columnar_builder_init(as_columnar_builder* cb, const as_columnar_schema* schema);
+
+/**
+ * @private
+ * Release buffers of the batch being filled.
+ */
+void
+as_columnar_builder_destroy(as_columnar_builder* cb);
+
+/**
+ * @private
+ * Write the wire bins of one record as the next row. Return pointer after the bins.
+ */
+uint8_t*
+as_columnar_builder_add(as_columnar_builder* cb, uint8_t* p, uint32_t n_ops, const as_digest* digest);
+
+/**
+ * @private
+ * Return pointer after the wire bins of one record.
+ */
+uint8_t*
+as_columnar_skip_bins(uint8_t* p, uint32_t n_ops);
+
+/**
+ * @private
+ * Move filled rows to an Arrow struct array and start a new batch. The digests of the moved
+ * rows remain in cb->digests until the next row is added.
+ */
+void
+as_columnar_builder_export(as_columnar_builder* cb, struct ArrowArray* out);
+
+/**
+ * @private
+ * Is the batch being filled complete.
+ */
+static inline bool
+as_columnar_builder_full(as_columnar_builder* cb)
+{
+	return cb->n_rows >= cb->schema->batch_size || cb->var_size >= (1u << 30);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -19,6 +19,7 @@
 #include <aerospike/as_bin.h>
 #include <aerospike/as_buffer.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_compress.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_operations.h>
 #include <aerospike/as_proto.h>
@@ -40,6 +41,8 @@ extern "C" {
 #define AS_COMMAND_FLAGS_LINEARIZE 4
 #define AS_COMMAND_FLAGS_SPLIT_RETRY 8
 #define AS_COMMAND_FLAGS_TXN_MONITOR 16
+#define AS_COMMAND_FLAGS_ZERO_COPY 32
+#define AS_COMMAND_FLAGS_HEDGE 64
 
 // Field IDs
 #define AS_FIELD_NAMESPACE 0
@@ -127,6 +130,19 @@ extern "C" {
 #define AS_STACK_BUF_SIZE (1024 * 16)
 #define AS_COMPRESS_THRESHOLD 128
 
+// Uncompressed bytes and string values of at least this size are sent from the caller's
+// memory instead of being copied into the command buffer.
+#define AS_COMMAND_REF_MIN_SIZE (1024 * 16)
+
+// Bin values compressed by the client are sent as blobs that start with this header:
+// magic (4), codec (1), original particle type (1), original size (4), compressed size (4),
+// checksum (4). The FNV-1a checksum covers the preceding header fields and the compressed
+// data, so reads only decompress blobs that were written by bin compression.
+#define AS_BIN_COMPRESS_MAGIC 0xA5435A42
+#define AS_BIN_COMPRESS_HEADER_SIZE 18
+#define AS_BIN_COMPRESS_CHECKSUM_OFFSET 14
+#define AS_BIN_COMPRESS_MAX_SIZE (1024 * 1024 * 128)
+
 /**
  * @private
  * Macros use these stand-ins for cf_malloc() / cf_free(), so that
@@ -144,17 +160,78 @@ local_free(void* memory)
 	cf_free(memory);
 }
 
+/**
+ * @private
+ * Maximum bytes of heap command buffers retained per thread for reuse.
+ * Zero disables the thread buffer cache. Set from as_config.command_buffer_cache_max.
+ */
+AS_EXTERN extern size_t as_command_buffer_cache_max;
+
+/**
+ * @private
+ * Get heap command buffer of at least the given size. When the thread buffer cache is
+ * enabled, the buffer is taken from the calling thread's size-classed cache or allocated at
+ * full class size. Otherwise, exactly size bytes are allocated.
+ */
+AS_EXTERN uint8_t*
+as_command_buffer_get(size_t size);
+
+/**
+ * @private
+ * Return heap command buffer allocated by as_command_buffer_get(). Full class size buffers
+ * are retained in the calling thread's cache unless the cache high-water mark would be
+ * exceeded.
+ */
+AS_EXTERN void
+as_command_buffer_put(uint8_t* buf, size_t size);
+
+/**
+ * @private
+ * Get heap command buffer of at least the given size from an instance allocator.
+ * The default allocator uses as_command_buffer_get(). Custom allocators bypass the thread
+ * buffer cache, because the cache is shared by all instances.
+ */
+AS_EXTERN uint8_t*
+as_command_buffer_get_alloc(const as_allocator* allocator, size_t size);
+
+/**
+ * @private
+ * Return heap command buffer allocated by as_command_buffer_get_alloc().
+ */
+AS_EXTERN void
+as_command_buffer_put_alloc(const as_allocator* allocator, uint8_t* buf, size_t size);
+
+/**
+ * Release all command buffers cached by the calling thread. The cache is also released
+ * automatically on thread exit.
+ */
+AS_EXTERN void
+as_command_buffer_release_thread(void);
+
 /**
  * @private
  * Allocate command buffer on stack or heap depending on given size.
  */
-#define as_command_buffer_init(_sz) (_sz > AS_STACK_BUF_SIZE) ? (uint8_t*)local_malloc(_sz) : (uint8_t*)alloca(_sz)
+#define as_command_buffer_init(_sz) (_sz > AS_STACK_BUF_SIZE) ? as_command_buffer_get(_sz) : (uint8_t*)alloca(_sz)
 
 /**
  * @private
  * Free command buffer.
  */
-#define as_command_buffer_free(_buf, _sz) if (_sz > AS_STACK_BUF_SIZE) {local_free(_buf);}
+#define as_command_buffer_free(_buf, _sz) if (_sz > AS_STACK_BUF_SIZE) {as_command_buffer_put(_buf, _sz);}
+
+/**
+ * @private
+ * Allocate command buffer on stack or heap from an instance allocator depending on
+ * given size.
+ */
+#define as_command_buffer_init_alloc(_al, _sz) (_sz > AS_STACK_BUF_SIZE) ? as_command_buffer_get_alloc(_al, _sz) : (uint8_t*)alloca(_sz)
+
+/**
+ * @private
+ * Free command buffer allocated by as_command_buffer_init_alloc().
+ */
+#define as_command_buffer_free_alloc(_al, _buf, _sz) if (_sz > AS_STACK_BUF_SIZE) {as_command_buffer_put_alloc(_al, _buf, _sz);}
 
 //---------------------------------
 // Types
@@ -192,9 +269,13 @@ typedef struct as_command_s {
 	void* udata;
 	uint8_t* buf;
 	size_t buf_size;
+	as_socket_iov* iov; // Segments sent instead of buf when set. buf_size is the total size.
+	uint32_t iov_count;
 	uint32_t partition_id;
 	as_policy_replica replica;
 	uint64_t deadline_ms;
+	uint64_t trace_id; // Zero if command is not traced.
+	struct as_slow_command_s* slow; // Filled in while command runs when slow log is enabled.
 	uint32_t socket_timeout;
 	uint32_t total_timeout;
 	uint32_t max_retries;
@@ -223,7 +304,10 @@ typedef struct as_command_txn_data_s {
  */
 typedef struct as_command_parse_result_data_s {
 	as_record** record;
+	as_record_buffer* buffer; // Response buffer read directly in zero-copy mode.
 	bool deserialize;
+	bool zero_copy;
+	bool lazy; // Deserialize list and map bins on first access. Only used with zero_copy.
 } as_command_parse_result_data;
 
 //---------------------------------
@@ -289,6 +373,46 @@ as_command_field_size(size_t size)
 as_status
 as_command_bin_size(const as_bin* bin, as_queue* buffers, size_t* size, as_error* err);
 
+/**
+ * @private
+ * Return if bin value is a string or blob that is compressed by the client when the
+ * compression threshold is threshold. Zero threshold disables bin compression.
+ */
+static inline bool
+as_command_bin_compressible(const as_bin* bin, uint32_t threshold)
+{
+	as_val* val = (as_val*)bin->valuep;
+
+	if (threshold == 0 || ! val) {
+		return false;
+	}
+
+	switch (val->type) {
+		case AS_STRING:
+			return as_string_len(as_string_fromval(val)) >= threshold;
+
+		case AS_BYTES: {
+			as_bytes* v = as_bytes_fromval(val);
+			return v->type == AS_BYTES_BLOB && v->size >= threshold;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * @private
+ * Increment size by bin size. String and blob values of at least threshold bytes are
+ * compressed with codec and the compressed value is pushed onto buffers for
+ * as_command_write_bin_compress().
+ */
+as_status
+as_command_bin_size_compress(
+	const as_bin* bin, as_compress_codec codec, uint32_t threshold, as_queue* buffers,
+	size_t* size, as_error* err
+	);
+
 /**
  * @private
  * Calculate size of bin name. Return error is bin name greater than AS_BIN_NAME_MAX_LEN characters.
@@ -558,26 +682,64 @@ as_command_write_bin(
 
 /**
  * @private
- * Finish writing command.
+ * Write bin whose size was computed by as_command_bin_size_compress() with the same
+ * threshold.
+ */
+uint8_t*
+as_command_write_bin_compress(
+	uint8_t* begin, as_operator operation_type, const as_bin* bin, uint32_t threshold,
+	as_queue* buffers
+	);
+
+/**
+ * @private
+ * Return size of bin value that can be sent from the bin's memory instead of being copied
+ * into the command buffer. Return zero if the value must be copied.
+ */
+size_t
+as_command_bin_ref_size(const as_bin* bin);
+
+/**
+ * @private
+ * Write bin without its value. The value is returned in value and must be sent directly
+ * after the returned position. Only valid when as_command_bin_ref_size() is not zero.
+ */
+uint8_t*
+as_command_write_bin_ref(
+	uint8_t* begin, as_operator operation_type, const as_bin* bin, as_socket_iov* value
+	);
+
+/**
+ * @private
+ * Finish writing command with total length that may include data sent outside the buffer.
  */
 static inline size_t
-as_command_write_end(uint8_t* begin, uint8_t* end)
+as_command_write_end_len(uint8_t* begin, uint64_t len)
 {
-	uint64_t len = end - begin;
 	uint64_t proto = (len - 8) | ((uint64_t)AS_PROTO_VERSION << 56) | ((uint64_t)AS_MESSAGE_TYPE << 48);
 	*(uint64_t*)begin = cf_swap_to_be64(proto);
 	return len;
 }
 
+/**
+ * @private
+ * Finish writing command.
+ */
+static inline size_t
+as_command_write_end(uint8_t* begin, uint8_t* end)
+{
+	return as_command_write_end_len(begin, end - begin);
+}
+
 /**
  * @private
  * Finish writing compressed command.
  */
 static inline size_t
-as_command_compress_write_end(uint8_t* begin, uint8_t* end, uint64_t uncompressed_sz)
+as_command_compress_write_end(uint8_t* begin, uint8_t* end, uint64_t uncompressed_sz, uint8_t type)
 {
 	uint64_t len = end - begin;
-	uint64_t proto = (len - 8) | ((uint64_t)AS_PROTO_VERSION << 56) | ((uint64_t)AS_COMPRESSED_MESSAGE_TYPE << 48);
+	uint64_t proto = (len - 8) | ((uint64_t)AS_PROTO_VERSION << 56) | ((uint64_t)type << 48);
 	*(uint64_t*)begin = cf_swap_to_be64(proto);
 	((as_compressed_proto *)begin)->uncompressed_sz = cf_swap_to_be64(uncompressed_sz);
 	return len;
@@ -592,10 +754,13 @@ as_command_compress_max_size(size_t cmd_sz);
 
 /**
  * @private
- * Compress command buffer.
+ * Compress command buffer with the cluster's current compression codec.
  */
 as_status
-as_command_compress(as_error* err, uint8_t* cmd, size_t cmd_sz, uint8_t* compressed_cmd, size_t* compressed_size);
+as_command_compress(
+	as_error* err, as_cluster* cluster, uint8_t* cmd, size_t cmd_sz, uint8_t* compressed_cmd,
+	size_t* compressed_size
+	);
 
 /**
  * @private
@@ -627,7 +792,7 @@ as_command_start_timer(as_command* cmd)
 								   policy->total_timeout : policy->socket_timeout;
 
 		cmd->total_timeout = policy->total_timeout;
-		cmd->deadline_ms = cf_getms() + policy->total_timeout;
+		cmd->deadline_ms = as_clock_getms() + policy->total_timeout;
 	}
 	else {
 		cmd->socket_timeout = policy->socket_timeout;
@@ -720,6 +885,42 @@ as_command_parse_success_failure_bins(uint8_t** pp, as_error* err, as_msg* msg,
 as_status
 as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize);
 
+/**
+ * @private
+ * Parse bins received from the server. String and blob values reference the buffer
+ * directly and string values are null terminated in place. The caller must ensure the
+ * buffer outlives the record bin values.
+ */
+as_status
+as_command_parse_bins_wrap(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize);
+
+/**
+ * @private
+ * Parse bins received from the server without copying string and blob values.
+ * Bin values reference the response buffer, which is attached to the record.
+ * If buffer is NULL, the bins region (p to end) is copied once to a new response buffer
+ * allocated by allocator. If buffer is not NULL, p and end must point within buffer data.
+ * If lazy and deserialize are true, list and map bins reference their raw bytes and are
+ * deserialized when first accessed through the record.
+ */
+as_status
+as_command_parse_bins_zero_copy(
+	uint8_t* p, uint8_t* end, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize,
+	bool lazy, as_record_buffer* buffer, const as_allocator* allocator
+	);
+
+/**
+ * @private
+ * Create heap record whose bin array and a copy of the bins region (p to end) share one
+ * allocation, then parse bins without copying string and blob values. The record is freed
+ * with a single free. lazy and deserialize behave as in as_command_parse_bins_zero_copy().
+ */
+as_status
+as_command_parse_record_arena(
+	uint8_t* p, uint8_t* end, as_error* err, uint32_t n_bins, bool deserialize, bool lazy,
+	as_record** recp
+	);
+
 /**
  * @private
  * Parse user defined function error.
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_std.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Number of compression codecs.
+ */
+#define AS_COMPRESS_CODEC_SIZE 3
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Compression codec used when a policy's compress flag is set.
+ *
+ * zlib is always available and supported by all servers that support compression. LZ4 and
+ * zstd are only available when the client is built with USE_LZ4=1 or USE_ZSTD=1. They are
+ * only used when every node in the cluster advertises support for the codec. Otherwise,
+ * zlib is used.
+ *
+ * @ingroup client_policies
+ */
+typedef enum as_compress_codec_e {
+	/**
+	 * zlib deflate.
+	 */
+	AS_COMPRESS_ZLIB,
+
+	/**
+	 * LZ4 block format. Faster than zlib with a lower compression ratio.
+	 */
+	AS_COMPRESS_LZ4,
+
+	/**
+	 * zstd frame format. Faster than zlib with a similar compression ratio.
+	 */
+	AS_COMPRESS_ZSTD
+} as_compress_codec;
+
+/**
+ * Compression statistics for a single codec. Byte savings are bytes_in - bytes_out for
+ * compression and bytes_out - bytes_in for decompression.
+ *
+ * @ingroup cluster_stats
+ */
+typedef struct as_compress_stats_s {
+	/**
+	 * Count of compressed commands.
+	 */
+	uint64_t compress_count;
+
+	/**
+	 * Uncompressed bytes of compressed commands.
+	 */
+	uint64_t compress_bytes_in;
+
+	/**
+	 * Compressed bytes of compressed commands, including the compression header.
+	 */
+	uint64_t compress_bytes_out;
+
+	/**
+	 * Time spent compressing commands in nanoseconds.
+	 */
+	uint64_t compress_ns;
+
+	/**
+	 * Count of decompressed responses.
+	 */
+	uint64_t decompress_count;
+
+	/**
+	 * Compressed bytes of decompressed responses, including the compression header.
+	 */
+	uint64_t decompress_bytes_in;
+
+	/**
+	 * Uncompressed bytes of decompressed responses.
+	 */
+	uint64_t decompress_bytes_out;
+
+	/**
+	 * Time spent decompressing responses in nanoseconds.
+	 */
+	uint64_t decompress_ns;
+} as_compress_stats;
+
+/**
+ * @private
+ * Pre-trained zstd dictionary. Dictionaries are loaded once per file path and shared
+ * read-only by all aerospike instances in the process.
+ */
+typedef struct as_compress_dict_s as_compress_dict;
+
+/**
+ * @private
+ * Dictionary assigned to a namespace and optional set.
+ */
+typedef struct as_compress_dict_entry_s {
+	const char* ns;
+	const char* set;
+	as_compress_dict* dict;
+} as_compress_dict_entry;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Return codec name.
+ *
+ * @relates as_compress_codec
+ */
+AS_EXTERN const char*
+as_compress_codec_name(as_compress_codec codec);
+
+/**
+ * Return if codec was compiled into the client.
+ *
+ * @relates as_compress_codec
+ */
+AS_EXTERN bool
+as_compress_codec_enabled(as_compress_codec codec);
+
+/**
+ * @private
+ * Return maximum compressed size of src_sz bytes for all enabled codecs.
+ */
+size_t
+as_compress_bound(size_t src_sz);
+
+/**
+ * @private
+ * Compress src into trg. On input, trg_sz is the capacity of trg. On output, trg_sz is the
+ * compressed size.
+ */
+as_status
+as_compress_data(
+	as_error* err, as_compress_codec codec, const uint8_t* src, size_t src_sz, uint8_t* trg,
+	size_t* trg_sz
+	);
+
+/**
+ * @private
+ * Decompress src into trg. On input, trg_sz is the capacity of trg. On output, trg_sz is the
+ * decompressed size.
+ */
+as_status
+as_decompress_data(
+	as_error* err, as_compress_codec codec, const uint8_t* src, size_t src_sz, uint8_t* trg,
+	size_t* trg_sz
+	);
+
+/**
+ * @private
+ * Return dictionary loaded from path, loading it if it is not already cached.
+ * Release with as_compress_dict_release().
+ */
+as_status
+as_compress_dict_acquire(as_error* err, const char* path, as_compress_dict** dict);
+
+/**
+ * @private
+ * Release dictionary reference. The dictionary is destroyed on last release.
+ */
+void
+as_compress_dict_release(as_compress_dict* dict);
+
+/**
+ * @private
+ * Return dictionary ID stored in the dictionary header.
+ */
+uint32_t
+as_compress_dict_id(as_compress_dict* dict);
+
+/**
+ * @private
+ * Compress src into a new zstd frame with optional dictionary. The frame header contains
+ * the dictionary ID and uncompressed size. Free trg with cf_free().
+ */
+as_status
+as_compress_frame(
+	as_error* err, as_compress_dict* dict, const uint8_t* src, size_t src_sz, uint8_t** trg,
+	size_t* trg_sz
+	);
+
+/**
+ * @private
+ * Return dictionary ID of zstd frame. Zero if the frame was compressed without a dictionary.
+ */
+uint32_t
+as_compress_frame_dict_id(const uint8_t* src, size_t src_sz);
+
+/**
+ * @private
+ * Decompress zstd frame into a new buffer with optional dictionary. Free trg with cf_free().
+ */
+as_status
+as_decompress_frame(
+	as_error* err, as_compress_dict* dict, const uint8_t* src, size_t src_sz, uint8_t** trg,
+	size_t* trg_sz
+	);
+
+/**
+ * @private
+ * Add compressed command to statistics.
+ */
+static inline void
+as_compress_stats_add_compress(as_compress_stats* stats, size_t in, size_t out, uint64_t ns)
+{
+	as_incr_uint64(&stats->compress_count);
+	as_faa_uint64(&stats->compress_bytes_in, in);
+	as_faa_uint64(&stats->compress_bytes_out, out);
+	as_faa_uint64(&stats->compress_ns, ns);
+}
+
+/**
+ * @private
+ * Add decompressed response to statistics.
+ */
+static inline void
+as_compress_stats_add_decompress(as_compress_stats* stats, size_t in, size_t out, uint64_t ns)
+{
+	as_incr_uint64(&stats->decompress_count);
+	as_faa_uint64(&stats->decompress_bytes_in, in);
+	as_faa_uint64(&stats->decompress_bytes_out, out);
+	as_faa_uint64(&stats->decompress_ns, ns);
+}
+
+/**
+ * @private
+ * Copy statistics.
+ */
+static inline void
+as_compress_stats_load(as_compress_stats* trg, as_compress_stats* src)
+{
+	trg->compress_count = as_load_uint64(&src->compress_count);
+	trg->compress_bytes_in = as_load_uint64(&src->compress_bytes_in);
+	trg->compress_bytes_out = as_load_uint64(&src->compress_bytes_out);
+	trg->compress_ns = as_load_uint64(&src->compress_ns);
+	trg->decompress_count = as_load_uint64(&src->decompress_count);
+	trg->decompress_bytes_in = as_load_uint64(&src->decompress_bytes_in);
+	trg->decompress_bytes_out = as_load_uint64(&src->decompress_bytes_out);
+	trg->decompress_ns = as_load_uint64(&src->decompress_ns);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -16,10 +16,16 @@
  */
 #pragma once 
 
+#include <aerospike/as_allocator.h>
+#include <aerospike/as_compress.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_host.h>
+#include <aerospike/as_latency.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_password.h>
+#include <aerospike/as_quota.h>
+#include <aerospike/as_socket.h>
+#include <aerospike/as_trace.h>
 #include <aerospike/as_vector.h>
 
 #ifdef __cplusplus
@@ -93,6 +99,67 @@ typedef struct as_addr_map_s {
 	
 } as_addr_map;
 
+/**
+ * Pre-trained zstd dictionary assigned to a namespace and optional set.
+ *
+ * @relates as_config
+ */
+typedef struct as_config_compress_dict_s {
+	/**
+	 * Namespace.
+	 */
+	char* ns;
+
+	/**
+	 * Set name. NULL if the dictionary applies to all sets in the namespace that do not have
+	 * their own dictionary.
+	 */
+	char* set;
+
+	/**
+	 * Dictionary file path. The file is the output of "zstd --train".
+	 */
+	char* path;
+} as_config_compress_dict;
+
+/**
+ * Client quota of a command class on a namespace and optional set.
+ *
+ * @relates as_config
+ */
+typedef struct as_config_quota_s {
+	/**
+	 * Namespace.
+	 */
+	char* ns;
+
+	/**
+	 * Set name. NULL if the quota applies to all sets in the namespace that do not have
+	 * their own quota of the same type.
+	 */
+	char* set;
+
+	/**
+	 * Class of commands counted by the quota.
+	 */
+	as_quota_type type;
+
+	/**
+	 * Action taken when the quota is exceeded.
+	 */
+	as_quota_mode mode;
+
+	/**
+	 * Commands per second admitted by this client instance.
+	 */
+	uint32_t rate;
+
+	/**
+	 * Commands admitted at once after an idle period. If zero, rate is used.
+	 */
+	uint32_t burst;
+} as_config_quota;
+
 /**
  * Authentication mode.
  *
@@ -146,7 +213,22 @@ typedef enum as_cluster_event_type_e {
 	/**
 	 * There are no active nodes in the cluster.
 	 */
-	AS_CLUSTER_DISCONNECTED = 2
+	AS_CLUSTER_DISCONNECTED = 2,
+
+	/**
+	 * Node circuit breaker opened. Commands to the node fail immediately.
+	 */
+	AS_CLUSTER_BREAKER_OPEN = 3,
+
+	/**
+	 * Node circuit breaker became half-open. A limited number of probe commands are sent.
+	 */
+	AS_CLUSTER_BREAKER_HALF_OPEN = 4,
+
+	/**
+	 * Node circuit breaker closed after successful probes.
+	 */
+	AS_CLUSTER_BREAKER_CLOSED = 5
 } as_cluster_event_type;
 
 /**
@@ -195,6 +277,10 @@ typedef struct as_config_lua_s {
 	/**
 	 * Enable caching of UDF files in the client
 	 * application.
+	 *
+	 * When enabled, client aggregations reuse lua states with the module already loaded.
+	 * A module is reloaded before an aggregation when its file modification time changes
+	 * or after it is uploaded with aerospike_udf_put() or removed with aerospike_udf_remove().
 	 */
 	bool cache_enabled;
 
@@ -353,6 +439,33 @@ typedef struct as_config_tls_s {
 	 */
 	bool for_login_only;
 
+	/**
+	 * Cache the TLS session of each node and resume it when opening new connections to the
+	 * same node. Resumed handshakes (session IDs or TLS 1.3 tickets) skip certificate
+	 * exchange and key agreement, which avoids handshake storms when connection pools are
+	 * refilled. Resumed sessions are not verified against the certificate blacklist again.
+	 * The cache is cleared when the TLS configuration is reloaded.
+	 *
+	 * Full and resumed handshake counts are reported in as_cluster_stats.
+	 *
+	 * Default: false
+	 */
+	bool session_cache;
+
+	/**
+	 * Enable kernel TLS (kTLS) offload. After the handshake, OpenSSL hands record
+	 * encryption and decryption to the kernel when the kernel, OpenSSL version and
+	 * negotiated cipher support it. Connections that can not be offloaded continue to
+	 * encrypt in userspace. Requires Linux with the tls kernel module and OpenSSL 3.0 or
+	 * later built with kTLS support. Not applied to libuv async connections, which encrypt
+	 * through memory buffers.
+	 *
+	 * Use log_session_info to log whether each connection was offloaded.
+	 *
+	 * Default: false
+	 */
+	bool ktls;
+
 } as_config_tls;
 
 /**
@@ -374,7 +487,9 @@ typedef struct as_config_provider_s {
 
 	/**
 	 * Interval in milliseconds between dynamic configuration check for file modifications.
-	 * The value must be greater than or equal to the tend interval.
+	 * The value must be greater than or equal to the tend interval. On Linux, file
+	 * notifications are used instead and the file is reloaded on the next tend after it
+	 * is written or replaced. The interval is still used if notifications are unavailable.
 	 *
 	 * Default: 60000
 	 */
@@ -497,6 +612,15 @@ typedef struct as_config_s {
 	 */
 	char* app_id;
 
+	/**
+	 * Application latency tag names. Entry i names as_policy_base.latency_tag i + 1.
+	 * Only named tags are written by the metrics writer. Use as_config_set_latency_tag()
+	 * to set these fields.
+	 *
+	 * Default: NULL
+	 */
+	char* latency_tags[AS_LATENCY_TAG_MAX];
+
 	/**
 	 * Cluster event function that will be called when nodes are added/removed from the cluster.
 	 *
@@ -511,6 +635,50 @@ typedef struct as_config_s {
 	 */
 	void* event_callback_udata;
 
+	/**
+	 * Command lifecycle trace function. When set, sampled commands report connection
+	 * acquisition, write, first response byte, parse, retry and completion times, so
+	 * applications can emit spans that show where a slow command spent its time.
+	 * Commands that are not sampled only pay for a branch at each lifecycle point.
+	 *
+	 * Use as_config_set_trace_callback() to set this field.
+	 *
+	 * Default: NULL (tracing disabled)
+	 */
+	as_trace_callback trace_callback;
+
+	/**
+	 * Trace user data that will be passed back to trace_callback.
+	 *
+	 * Default: NULL
+	 */
+	void* trace_udata;
+
+	/**
+	 * Trace one out of every trace_sample_rate commands. A value of 1 traces all commands.
+	 *
+	 * Default: 1
+	 */
+	uint32_t trace_sample_rate;
+
+	/**
+	 * Record commands that take at least this many milliseconds, including retries, in a
+	 * slow command log. Each entry holds the namespace, set, digest, node, partition id,
+	 * retries, connection wait time and bytes transferred. Entries are retrieved with
+	 * aerospike_slow_commands().
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t slow_command_ms;
+
+	/**
+	 * Maximum number of entries held by the slow command log. The oldest entries are
+	 * overwritten when the log is full. Rounded up to a power of 2.
+	 *
+	 * Default: 1024
+	 */
+	uint32_t slow_command_log_size;
+
 	/**
 	 * A IP translation table is used in cases where different clients use different server
 	 * IP addresses.  This may be necessary when using clients from both inside and outside
@@ -555,6 +723,42 @@ typedef struct as_config_s {
 	 * Default: 100
 	 */
 	uint32_t max_conns_per_node;
+
+	/**
+	 * Maximum number of sync connections opened per new node in each cluster tend iteration
+	 * while the node's connection pools warm up. When a node joins a running cluster, the
+	 * client predicts the node's share of traffic by dividing the sync connections of the
+	 * existing nodes by the new node count and pre-opens connections up to that prediction,
+	 * capped at max_conns_per_node. The first batch is opened before the node is added to
+	 * the partition map and the rest is opened at this rate on subsequent tends.
+	 *
+	 * Warm-up progress is reported in as_conn_stats.warm_up_target and
+	 * as_conn_stats.warm_up_remaining of the node's sync stats. Warm-up is not performed for
+	 * seed nodes found on the initial connect.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t warm_up_conns_per_tend;
+
+	/**
+	 * Maximum number of spare idle sync connections the cluster tend thread keeps open per
+	 * server node. The spare target follows recent demand: it jumps to the number of
+	 * connections that commands had to open themselves since the last tend, and decays by 25%
+	 * each tend when demand falls. Commands then find a pooled connection during bursts
+	 * instead of paying connect, TLS and authentication latency.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t spare_conns_per_node;
+
+	/**
+	 * Maximum number of sync connections that commands may be opening concurrently to a
+	 * single server node. Commands that exceed this limit wait for a pooled connection or a
+	 * free connect slot until their deadline, so a burst does not open many connections at once.
+	 *
+	 * Default: 0 (unlimited)
+	 */
+	uint32_t max_connects_per_node;
 	
 	/**
 	 * Minimum number of asynchronous connections allowed per server node.  Preallocate min
@@ -569,6 +773,75 @@ typedef struct as_config_s {
 	 */
 	uint32_t async_min_conns_per_node;
 
+	/**
+	 * Maximum number of asynchronous connections each event loop may be opening concurrently
+	 * to a single server node when filling the pool to async_min_conns_per_node or when the
+	 * cluster tend thread replaces closed connections. Connect, TLS handshake and
+	 * authentication of these connections overlap on the event loop, so opening many
+	 * connections takes a few round trips instead of one round trip per connection.
+	 *
+	 * If zero, min connections are opened with roughly 20 concurrent connects per node spread
+	 * across all event loops and replacement connections are opened one at a time.
+	 *
+	 * Default: 0
+	 */
+	uint32_t async_max_connects_per_loop;
+
+	/**
+	 * Maximum number of single record async reads merged into one batch read. If greater than
+	 * one, aerospike_key_get_async() calls with a NULL policy and no pipeline listener are not
+	 * sent immediately. Reads issued while the event loop processes its command queue are
+	 * merged into one batch read, which the client splits by node. A merged batch is sent when
+	 * the queue has been processed or when this many reads are waiting. Each listener is then
+	 * called with its own record or error.
+	 *
+	 * Fan-out workloads that issue many independent reads in a short time save round trips
+	 * and per-request server overhead. Reads are only merged if the default read policy has
+	 * no filter expression, transaction, hedge delay, async_heap_rec, zero_copy or
+	 * lazy_deserialize. Merged reads are sent by digest, so the user key is not sent.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t async_auto_batch_max;
+
+	/**
+	 * Run sync single record commands (aerospike_key_get(), aerospike_key_select(),
+	 * aerospike_key_exists(), aerospike_key_put(), aerospike_key_remove() and
+	 * aerospike_key_operate()) on the async event loops. The calling thread waits until the
+	 * async command completes, so results, errors, timeouts and retries are the same as the
+	 * blocking path. Sockets are shared by the event loops instead of being held by each
+	 * calling thread, which lets many blocking threads share a few connections per node.
+	 *
+	 * Event loops must be created before connecting. Calls made from an event loop thread and
+	 * calls that pass an existing record to be populated use the blocking path.
+	 *
+	 * Default: false
+	 */
+	bool sync_over_async;
+
+	/**
+	 * Send commands issued through sync_over_async on pipelined async connections.
+	 *
+	 * Default: false
+	 */
+	bool sync_over_async_pipeline;
+
+	/**
+	 * Minimum size in bytes of an async batch, scan or query response block that is
+	 * decompressed and parsed by the cluster thread pool instead of the event loop thread.
+	 * The command stops reading while the block is processed by a worker thread and the
+	 * results are delivered back on the event loop thread, so other commands on the event
+	 * loop are not stalled by large responses.
+	 *
+	 * Batch blocks are decompressed and parsed by the worker. Scan and query blocks are only
+	 * decompressed by the worker because their record listeners are called on the event loop
+	 * thread. Blocks are processed on the event loop thread for TLS connections and io_uring
+	 * event loops.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t async_offload_threshold;
+
 	/**
 	 * Maximum number of asynchronous (non-pipeline) connections allowed for each node.
 	 * This limit will be enforced at the node/event loop level.  If the value is 100 and 2 event
@@ -580,6 +853,21 @@ typedef struct as_config_s {
 	 */
 	uint32_t async_max_conns_per_node;
 
+	/**
+	 * Allow an event loop whose node connection pool is at its limit to open a connection
+	 * beyond that limit when the node's connections over all event loops are still below
+	 * async_max_conns_per_node. Bursts that are concentrated on a few event loops then use
+	 * the unused share of the other event loops instead of failing with
+	 * AEROSPIKE_ERR_NO_MORE_CONNECTIONS. A borrowed connection is closed instead of pooled
+	 * when its command completes, which returns the share to the other event loops.
+	 *
+	 * The node total is read without locks, so concurrent borrowing from several event
+	 * loops can briefly exceed async_max_conns_per_node by up to the number of event loops.
+	 *
+	 * Default: false
+	 */
+	bool async_borrow_conns;
+
 	/**
 	 * Maximum number of pipeline connections allowed for each node.
 	 * This limit will be enforced at the node/event loop level.  If the value is 100 and 2 event
@@ -590,6 +878,27 @@ typedef struct as_config_s {
 	 * Default: 64
 	 */
 	uint32_t pipe_max_conns_per_node;
+
+	/**
+	 * Maximum number of commands awaiting a response on a single pipeline connection.
+	 * When all node/event loop pipeline connections are at this depth and no new connection
+	 * can be opened, the command is retried and fails with AEROSPIKE_ERR_NO_MORE_CONNECTIONS
+	 * when retries are exhausted.  This bounds the number of commands that can be delayed
+	 * behind a slow response on the same connection.
+	 *
+	 * Default: 0 (unlimited)
+	 */
+	uint32_t pipe_max_depth;
+
+	/**
+	 * Pipeline response size threshold in bytes.  When a pipeline connection starts reading a
+	 * response larger than this value, new commands are not assigned to that connection until
+	 * the response has been read.  This prevents small commands from queuing behind large
+	 * responses.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t pipe_large_response_size;
 	
 	/**
 	 * Number of synchronous connection pools used for each node.  Machines with 8 cpu cores or
@@ -602,6 +911,46 @@ typedef struct as_config_s {
 	 */
 	uint32_t conn_pools_per_node;
 
+	/**
+	 * Number of lock-free connection cache slots placed in front of each synchronous connection
+	 * pool.  Commands first try to retrieve/return connections from these slots using atomic
+	 * compare-and-swap and only fall back to the mutex protected pool queue when all slots are
+	 * empty (on retrieval) or full (on return).  This reduces pool lock contention when many
+	 * application threads issue commands to the same node.
+	 *
+	 * Cached connections still count against max_conns_per_node and are still trimmed by the
+	 * cluster tend thread.  The value is capped at the pool's maximum size.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t conn_cache_size;
+
+	/**
+	 * Number of shared pipelined connections per node used by synchronous single record
+	 * commands.  When enabled, multiple application threads write commands to the same
+	 * connection and each thread reads its response in the order the commands were sent.
+	 * This reduces the number of connections per node when many threads issue commands
+	 * concurrently.  Batch, scan and query commands still use pooled connections.
+	 *
+	 * A command that times out waiting for earlier responses closes the shared connection,
+	 * so commands queued behind it are retried on a new connection.
+	 *
+	 * Pipelining is not used when TLS is enabled.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t sync_pipes_per_node;
+
+	/**
+	 * Compression codec used by commands with compress enabled in their policy.  LZ4 and zstd
+	 * must be enabled when building the client and are only used while every node in the
+	 * cluster advertises support for the codec.  Otherwise, zlib is used.  Compressed server
+	 * responses are decompressed with whichever codec the server used.
+	 *
+	 * Default: AS_COMPRESS_ZLIB
+	 */
+	as_compress_codec compress_codec;
+
 	/**
 	 * Initial host connection timeout in milliseconds.  The timeout when opening a connection
 	 * to the server host for the first time.
@@ -615,6 +964,24 @@ typedef struct as_config_s {
 	 */
 	uint32_t login_timeout_ms;
 
+	/**
+	 * Set SO_BUSY_POLL to this many microseconds on sync connections. The kernel then
+	 * polls the network device queue for this time on blocking receives instead of waiting
+	 * for an interrupt. Usually combined with as_policy_base.spin_read_us. Requires Linux and
+	 * may require CAP_NET_ADMIN for values greater than the net.core.busy_read sysctl.
+	 * Ignored on other platforms.
+	 *
+	 * Default: 0 (not set)
+	 */
+	uint32_t socket_busy_poll_us;
+
+	/**
+	 * TCP options applied to all sync, async and info connections. Use larger buffers for
+	 * high round trip time links and tcp_quick_ack or tcp_user_timeout_ms on low latency
+	 * networks. See as_socket_options for defaults.
+	 */
+	as_socket_options socket_options;
+
 	/**
 	 * Maximum socket idle in seconds.  Connection pools will discard sockets that have been 
 	 * idle longer than the maximum.
@@ -637,6 +1004,52 @@ typedef struct as_config_s {
 	 */
 	uint32_t max_socket_idle;
 
+	/**
+	 * Number of cluster tend intervals over which peak connection usage is tracked for each
+	 * sync and async (non-pipeline) connection pool. If greater than zero, idle connections
+	 * are trimmed by demand instead of by age: the peak number of connections in use during
+	 * the window is kept open, and a quarter of the connections above that peak (but never
+	 * below min connections) is closed each tend. Bursty workloads then keep enough
+	 * connections warm for the next burst without holding connections that are never used.
+	 *
+	 * The peak and the number of trimmed connections are reported in as_conn_stats.
+	 * Values above 64 are reduced to 64.
+	 *
+	 * Default: 0 (trim by max_socket_idle)
+	 */
+	uint32_t conn_peak_window;
+
+	/**
+	 * Sync connections that were returned to the pool or validated within this window are
+	 * handed out without first peeking at the socket receive buffer, which saves a syscall on
+	 * every sync command. The cluster tend thread validates pooled connections that have been
+	 * idle longer than this window and closes the ones the server has closed or that hold
+	 * unexpected data.
+	 *
+	 * A command whose write fails on a pooled connection reconnects once with a validated
+	 * connection before the failure counts as a retry.
+	 *
+	 * Default: 0 (validate on every checkout)
+	 */
+	uint32_t conn_validate_window_ms;
+
+	/**
+	 * Protect nodes and partition maps used by sync single record commands with epoch based
+	 * reclamation instead of node reference counts. Commands then route to a node without
+	 * atomic increments and decrements on the shared node reference count, which avoids
+	 * cache line contention on popular nodes at high command rates.
+	 *
+	 * Nodes and partition maps removed by the cluster tend thread are released only after
+	 * every in-flight sync command that might reference them has completed. A sync command
+	 * blocked on a slow server therefore delays the release of removed nodes until the
+	 * command times out.
+	 *
+	 * Async, batch and query commands always use node reference counts.
+	 *
+	 * Default: false
+	 */
+	bool epoch_reclaim;
+
 	/**
 	 * Maximum number of errors allowed per node per error_rate_window before backoff
 	 * algorithm returns AEROSPIKE_MAX_ERROR_RATE for database commands to that node.
@@ -662,12 +1075,118 @@ typedef struct as_config_s {
 	 */
 	uint32_t error_rate_window;
 
+	/**
+	 * Percentage of failed commands to a node within error_rate_window that opens the node's
+	 * circuit breaker. Failed commands are socket errors, client and server timeouts, server
+	 * device overload and cluster errors. An open breaker fails commands to the node
+	 * immediately with AEROSPIKE_MAX_ERROR_RATE, so they can retry on another node without
+	 * consuming their timeout.
+	 *
+	 * After circuit_breaker_open_tends tend iterations, the breaker becomes half-open and
+	 * lets circuit_breaker_probes commands per tend iteration through. The breaker closes
+	 * when the probes succeed and opens again for twice as long when they fail, up to
+	 * circuit_breaker_max_open_tends.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t circuit_breaker_ratio;
+
+	/**
+	 * Minimum commands to a node within error_rate_window before circuit_breaker_ratio is
+	 * evaluated.
+	 *
+	 * Default: 20
+	 */
+	uint32_t circuit_breaker_min_commands;
+
+	/**
+	 * Commands allowed through per tend iteration while a node's circuit breaker is half-open.
+	 *
+	 * Default: 10
+	 */
+	uint32_t circuit_breaker_probes;
+
+	/**
+	 * Tend iterations a node's circuit breaker stays open when it first opens.
+	 *
+	 * Default: 1
+	 */
+	uint32_t circuit_breaker_open_tends;
+
+	/**
+	 * Maximum tend iterations a node's circuit breaker stays open after repeated failed probes.
+	 *
+	 * Default: 32
+	 */
+	uint32_t circuit_breaker_max_open_tends;
+
+	/**
+	 * Maximum in-flight single record commands per node allowed by the node's adaptive
+	 * concurrency limiter. Each node's limit starts at this value and is recalculated every
+	 * tend iteration. The limit shrinks in proportion to the latency gradient when recent
+	 * command latency rises above 1.5 times long term latency, and by a quarter when commands
+	 * time out or the node reports device overload. It grows again while the node is busy
+	 * and latency is stable.
+	 *
+	 * Commands that would exceed a node's limit are not sent. They fail immediately with
+	 * AEROSPIKE_MAX_ERROR_RATE, so they can retry on another replica without consuming their
+	 * timeout. Batch, scan and query commands are not limited.
+	 *
+	 * Default: 0 (no concurrency limit)
+	 */
+	uint32_t concurrency_limit_max;
+
+	/**
+	 * Minimum adaptive concurrency limit per node. See concurrency_limit_max.
+	 *
+	 * Default: 10
+	 */
+	uint32_t concurrency_limit_min;
+
+	/**
+	 * Client wide retry budget in tokens, shared by all commands to limit retry storms during
+	 * partial outages. Each failed attempt that would be retried consumes one token, and each
+	 * successful command returns retry_budget_refill_pct percent of a token. Retries stop
+	 * while the budget is at or below half of retry_budget_tokens, so a command fails with its
+	 * last error instead of adding load to a struggling cluster. Retries resume once
+	 * successful commands refill the budget.
+	 *
+	 * Scan and query partition retries are not limited by the budget.
+	 *
+	 * Default: 0 (no retry budget)
+	 */
+	uint32_t retry_budget_tokens;
+
+	/**
+	 * Percent of a retry budget token returned by each successful command.
+	 * See retry_budget_tokens.
+	 *
+	 * Default: 10
+	 */
+	uint32_t retry_budget_refill_pct;
+
 	/**
 	 * Polling interval in milliseconds for cluster tender
 	 * Default: 1000
 	 */
 	uint32_t tender_interval;
 
+	/**
+	 * Maximum polling interval in milliseconds for cluster tender. If greater than
+	 * tender_interval, the tend interval doubles after each tend that finds no cluster change
+	 * (node, peers, partition map or rack change, node failure or circuit breaker change) until
+	 * it reaches tender_interval_max. The interval drops back to tender_interval on the next
+	 * cluster change, or immediately when a command finds no node for a partition or the server
+	 * reports the partition unavailable.
+	 *
+	 * Work counted in tend iterations (error_rate_window, metrics interval, connection
+	 * balancing) runs less often while the interval is extended. This option is ignored when
+	 * the cluster is tended through shared memory.
+	 *
+	 * Default: 0 (fixed tend interval)
+	 */
+	uint32_t tender_interval_max;
+
 	/**
 	 * Number of threads stored in underlying thread pool used by synchronous batch/scan/query commands.
 	 * These commands are often sent to multiple server nodes in parallel threads.  A thread pool 
@@ -677,10 +1196,112 @@ typedef struct as_config_s {
 	 * thread_pool_size = (concurrent synchronous batch/scan/query commands) * (server nodes)
 	 *
 	 * If your application only uses async commands, this field can be set to zero.
+	 * This field is ignored when shared_threads is set.
 	 * Default: 16
 	 */
 	uint32_t thread_pool_size;
 
+	/**
+	 * Worker pool and tend thread shared with other aerospike instances. When set, this
+	 * instance does not start its own thread pool or tend thread, and thread_pool_size and
+	 * tend_thread_cpu are ignored. See as_shared_threads_create().
+	 *
+	 * The shared threads are not owned by the config and must be destroyed with
+	 * as_shared_threads_destroy() after all instances that use them are closed.
+	 *
+	 * Default: NULL
+	 */
+	struct as_shared_threads_s* shared_threads;
+
+	/**
+	 * Maximum bytes of heap allocated command buffers that each thread may retain for reuse.
+	 * Sync commands that exceed the 16KB stack buffer (large operate commands, batch, scan
+	 * and query) normally allocate and free a heap buffer on every call.  When this value is
+	 * greater than zero, these request and response buffers are kept in a per-thread cache
+	 * of power of 2 size classes (32KB to 16MB) and reused by subsequent commands on the same
+	 * thread.  Buffers that would push a thread's cache above this high-water mark are
+	 * released immediately.  Cached buffers are released on thread exit or when
+	 * as_command_buffer_release_thread() is called.
+	 *
+	 * This is a process-wide setting.  The most recent aerospike_connect() with a non-zero
+	 * value takes effect.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t command_buffer_cache_max;
+
+	/**
+	 * Maximum bytes of request and response buffers held by in-flight sync and async commands
+	 * of this client. Heap request buffers (larger than 16KB) and all batch, scan and query
+	 * node commands must be admitted against this budget before they are sent. Response
+	 * buffers are charged when allocated, so usage can briefly exceed the budget while
+	 * admitted commands complete, but new large commands are not admitted until it drops.
+	 *
+	 * A sync command that is not admitted waits up to memory_budget_wait milliseconds
+	 * (bounded by its total timeout) and then fails with AEROSPIKE_ERR_MEMORY_BUDGET. Async
+	 * commands are never delayed and fail immediately. Current and peak usage are reported by
+	 * aerospike_stats().
+	 *
+	 * Default: 0 (no budget)
+	 */
+	uint64_t memory_budget;
+
+	/**
+	 * Maximum milliseconds a sync command waits for the memory budget. Zero fails
+	 * immediately.
+	 *
+	 * Default: 0
+	 */
+	uint32_t memory_budget_wait;
+
+	/**
+	 * Use the kernel's coarse monotonic clock (CLOCK_MONOTONIC_COARSE) for command deadlines,
+	 * socket read/write deadlines and connection last used timestamps. Reading this clock
+	 * avoids a hardware counter read on every retry loop iteration and socket operation, but
+	 * its resolution is one scheduler tick (typically 1-4ms), so timeouts may fire up to
+	 * one tick late. Latency metrics always use the precise clock.
+	 *
+	 * This is a process-wide setting and is only supported on Linux. The most recent
+	 * aerospike_connect() with this value set to true takes effect.
+	 *
+	 * Default: false
+	 */
+	bool coarse_clock;
+
+	/**
+	 * Allocator for heap command buffers, async command objects and record response
+	 * buffers of this instance. Sync command buffers allocated by a custom allocator bypass
+	 * the thread buffer cache, because the cache is shared by all instances. Custom
+	 * allocated async commands are not pooled by the event loop for the same reason.
+	 *
+	 * Record response buffers keep a copy of the allocator, so records read by this
+	 * instance may be destroyed after aerospike_close(). The allocator's functions and
+	 * arena must remain valid until then.
+	 *
+	 * Default: all NULL (cf_malloc(), cf_realloc() and cf_free())
+	 */
+	as_allocator allocator;
+
+	/**
+	 * Seconds that resolved seed and peer hostnames are cached by the cluster tend thread.
+	 * Cached hostnames that were used since they were last resolved are resolved again in
+	 * a background thread when they expire, so the tend thread only waits on DNS the first
+	 * time a hostname is seen.  Previous addresses continue to be used if a refresh fails.
+	 * Numeric IP addresses are never cached.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t dns_cache_ttl;
+
+	/**
+	 * Log a warning when a cluster tend iteration takes at least this many milliseconds.
+	 * The warning includes the time spent in each tend phase and the node and info
+	 * request that took longest to respond.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t tend_slow_threshold;
+
 	/**
 	 * Assign tend thread to this specific CPU ID.
 	 * Default: -1 (Any CPU).
@@ -742,6 +1363,26 @@ typedef struct as_config_s {
 	 * to the remaining nodes when they become available.
 	 */
 	bool fail_if_not_connected;
+
+	/**
+	 * Connect to all seed addresses concurrently when seeding the cluster. The first seed
+	 * that responds with valid peers is used, so unreachable seeds do not delay startup by
+	 * one connect timeout each.
+	 *
+	 * Default: false
+	 */
+	bool seed_parallel;
+
+	/**
+	 * Return from aerospike_connect() as soon as every partition of the discovered namespaces
+	 * has a master node, instead of waiting for minimum connection pools to fill. Minimum
+	 * connections are then created by the cluster tend thread. When fail_if_not_connected is
+	 * true, connect fails if partitions are not covered instead of when seed peers are
+	 * unreachable. Not used with shared memory.
+	 *
+	 * Default: false
+	 */
+	bool fast_start;
 	
 	/**
 	 * Flag to signify if alternate IP address discovery info commands should be used.
@@ -807,6 +1448,42 @@ typedef struct as_config_s {
 	 */
 	 as_vector* rack_ids;
 
+	/**
+	 * Pre-trained zstd dictionaries (as_config_compress_dict) used by aerospike_compress_bytes().
+	 * Do not set directly. Use as_config_add_compress_dict() to add dictionaries.
+	 *
+	 * Default: NULL
+	 */
+	as_vector* compress_dicts;
+
+	/**
+	 * Client side rate limits (as_config_quota) of namespaces and sets. Quotas are enforced
+	 * per client instance, so the total rate of an application is the sum of its instances.
+	 * Do not set directly. Use as_config_add_quota() to add quotas.
+	 *
+	 * Default: NULL
+	 */
+	as_vector* quotas;
+
+	/**
+	 * Path of cluster snapshot file used for fast client startup. If set, the tend thread
+	 * saves node addresses and partition maps to this file whenever they change. On the next
+	 * aerospike_connect(), nodes and partition maps are restored from the file, so commands
+	 * can be routed before the cluster has been tended. The first tend iteration validates
+	 * the restored nodes and replaces stale partition maps. If the file does not exist or
+	 * is invalid, the client connects normally through the seeds.
+	 *
+	 * Since aerospike_connect() does not contact the cluster when a snapshot is restored,
+	 * fail_if_not_connected is not applied and commands may fail and retry until the first
+	 * tend completes. The file contains native socket addresses and should only be shared by
+	 * clients on the same host. Not used with shared memory or force_single_node.
+	 *
+	 * Use as_config_set_snapshot_path() to set this field.
+	 *
+	 * Default: NULL
+	 */
+	char* snapshot_path;
+
 	/**
 	 * Indicates if shared memory should be used for cluster tending.  Shared memory
 	 * is useful when operating in single threaded mode with multiple client processes.
@@ -850,6 +1527,33 @@ typedef struct as_config_s {
 	 * Default: 30
 	 */
 	uint32_t shm_takeover_threshold_sec;
+
+	/**
+	 * Back the shared memory segment with huge pages (SHM_HUGETLB) when this process creates
+	 * the segment. Huge pages reduce TLB misses on partition lookups when the segment is
+	 * large. Huge pages must be reserved by the administrator (vm.nr_hugepages) and the
+	 * process must be permitted to use them (vm.hugetlb_shm_group). If huge pages are not
+	 * available, regular pages are used. Only supported on Linux.
+	 *
+	 * Default: false
+	 */
+	bool shm_huge_pages;
+
+	/**
+	 * Number of client processes that can share metrics through the shared memory segment.
+	 * When non-zero, each process with metrics enabled by the default metrics writer
+	 * (aerospike_enable_metrics()) publishes its node and namespace counters, connection
+	 * counts and latency buckets to its own shared memory slot every metrics interval. Only
+	 * the process that tends the shared memory cluster writes metrics files, and its node
+	 * lines are the sums over all running processes. Latency percentiles, hot keys, cpu and
+	 * memory usage remain local to the writing process.
+	 *
+	 * Each slot requires approximately shm_max_nodes * shm_max_namespaces * 2400 bytes.
+	 * This value must be the same in all processes that attach to the segment.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t shm_metrics_slots;
 } as_config;
 
 //---------------------------------
@@ -964,6 +1668,23 @@ as_config_set_cluster_name(as_config* config, const char* cluster_name)
 	as_config_set_string(&config->cluster_name, cluster_name);
 }
 
+/**
+ * Name application latency tag (1..AS_LATENCY_TAG_MAX) included in metrics output.
+ * Return false if tag is out of range. The name should not contain characters used as
+ * metrics delimiters (",[]").
+ *
+ * @relates as_config
+ */
+static inline bool
+as_config_set_latency_tag(as_config* config, uint8_t tag, const char* name)
+{
+	if (tag == 0 || tag > AS_LATENCY_TAG_MAX) {
+		return false;
+	}
+	as_config_set_string(&config->latency_tags[tag - 1], name);
+	return true;
+}
+
 /**
  * Set application identifier.
  *
@@ -975,6 +1696,17 @@ as_config_set_app_id(as_config* config, const char* app_id)
 	as_config_set_string(&config->app_id, app_id);
 }
 
+/**
+ * Set cluster snapshot file path.
+ *
+ * @relates as_config
+ */
+static inline void
+as_config_set_snapshot_path(as_config* config, const char* path)
+{
+	as_config_set_string(&config->snapshot_path, path);
+}
+
 /**
  * Set cluster event callback and user data.
  *
@@ -987,6 +1719,22 @@ as_config_set_cluster_event_callback(as_config* config, as_cluster_event_callbac
 	config->event_callback_udata = udata;
 }
 
+/**
+ * Set command lifecycle trace callback, user data and sample rate.
+ * See as_config.trace_callback.
+ *
+ * @relates as_config
+ */
+static inline void
+as_config_set_trace_callback(
+	as_config* config, as_trace_callback callback, void* udata, uint32_t sample_rate
+	)
+{
+	config->trace_callback = callback;
+	config->trace_udata = udata;
+	config->trace_sample_rate = sample_rate;
+}
+
 /**
  * Initialize global lua configuration to defaults.
  *
@@ -1188,6 +1936,70 @@ as_config_provider_set(as_config* config, const char* path, uint32_t interval)
 AS_EXTERN void
 as_config_add_rack_id(as_config* config, int rack_id);
 
+/**
+ * Assign pre-trained zstd dictionary file to a namespace and optional set. Small records
+ * with repeated content compress much better with a dictionary trained on sample records.
+ * The dictionary is loaded when the cluster is created and is shared read-only by all
+ * aerospike instances in the process that use the same path.
+ *
+ * The strings will be copied. The client must be built with USE_ZSTD=1.
+ *
+ * @code
+ * as_config config;
+ * as_config_init(&config);
+ * as_config_add_compress_dict(&config, "test", "users", "/etc/aerospike/users.dict");
+ * as_config_add_compress_dict(&config, "test", NULL, "/etc/aerospike/test.dict");
+ * @endcode
+ *
+ * @relates as_config
+ */
+AS_EXTERN void
+as_config_add_compress_dict(as_config* config, const char* ns, const char* set, const char* path);
+
+/**
+ * Limit the rate of single record reads, single record writes or scans/queries that this
+ * client instance sends to a namespace and optional set. A command over the limit is either
+ * rejected with AEROSPIKE_CLIENT_QUOTA_EXCEEDED or delayed until the limit allows it,
+ * depending on mode. Batch commands are not limited.
+ *
+ * Quotas of 2000 commands per second or more with a burst of at least 4 let each thread
+ * take up to 1 ms worth of tokens at once while the bucket is not empty. Tokens a thread
+ * does not use within 1 ms are dropped, so a client whose threads stall can admit slightly
+ * fewer commands than rate.
+ *
+ * The strings will be copied.
+ *
+ * @code
+ * as_config config;
+ * as_config_init(&config);
+ * // At most 5000 reads per second on test.users, with bursts of up to 500 reads.
+ * as_config_add_quota(&config, "test", "users", AS_QUOTA_READ, 5000, 500, AS_QUOTA_WAIT);
+ * // At most 10 scans/queries per second on the rest of namespace test.
+ * as_config_add_quota(&config, "test", NULL, AS_QUOTA_SCAN, 10, 0, AS_QUOTA_REJECT);
+ * @endcode
+ *
+ * @relates as_config
+ */
+AS_EXTERN void
+as_config_add_quota(
+	as_config* config, const char* ns, const char* set, as_quota_type type, uint32_t rate,
+	uint32_t burst, as_quota_mode mode
+	);
+
+/**
+ * @private
+ * Make full copy of as_config_quota list.
+ */
+as_vector*
+as_config_copy_quotas(as_vector* quotas);
+
+/**
+ * @private
+ * Destroy as_config_quota list.
+ */
+void
+as_config_destroy_quotas(as_vector* quotas);
+
 /**
  * Convert string into as_auth_mode enum.
  */
@@ -83,6 +83,7 @@ extern "C" {
 #define AS_BATCH_PARENT_WRITE 63
 #define AS_TXN_VERIFY 74
 #define AS_TXN_ROLL 85
+#define AS_QUOTAS 96
 
 #define AS_BATCH_SOCKET_TIMEOUT 0
 #define AS_BATCH_TOTAL_TIMEOUT 1
@@ -96,8 +97,8 @@ extern "C" {
 #define AS_BATCH_ALLOW_INLINE_SSD 9
 #define AS_BATCH_RESPOND_ALL_KEYS 10
 
-// 96 total bits / 8 = 12 bytes
-#define AS_CONFIG_BITMAP_SIZE 12
+// 97 total bits / 8 rounded up = 13 bytes
+#define AS_CONFIG_BITMAP_SIZE 13
 
 //---------------------------------
 // Types
@@ -16,18 +16,85 @@
  */
 #pragma once
 
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_queue.h>
 #include <aerospike/as_socket.h>
 #include <pthread.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define AS_CONN_CACHE_EMPTY 0
+#define AS_CONN_CACHE_BUSY 1
+#define AS_CONN_CACHE_FULL 2
+
+/**
+ * @private
+ * Maximum number of tend intervals in a connection usage window.
+ */
+#define AS_CONN_WINDOW_MAX 64
+
 /******************************************************************************
  * TYPES
  *****************************************************************************/
 
+/**
+ * @private
+ * Lock-free connection cache slot. The state transitions are
+ * EMPTY -> BUSY -> FULL on push and FULL -> BUSY -> EMPTY on pop.
+ */
+typedef struct as_conn_cache_slot_s {
+	/**
+	 * Slot state.
+	 */
+	uint32_t state;
+
+	/**
+	 * Cached socket. Only valid when state is FULL.
+	 */
+	as_socket sock;
+} as_conn_cache_slot;
+
+/**
+ * @private
+ * Sliding window of connection pool usage. Each tend interval records the fewest idle
+ * connections seen in the pool. Idle connections that remained in the pool through every
+ * interval of the window were not needed by peak usage and may be trimmed.
+ */
+typedef struct as_conn_window_s {
+	/**
+	 * Fewest idle connections seen in the current interval. Not atomic by design.
+	 */
+	uint32_t idle_min;
+
+	/**
+	 * Next sample index.
+	 */
+	uint32_t index;
+
+	/**
+	 * Peak connections in use over the last window.
+	 */
+	uint32_t peak;
+
+	/**
+	 * Idle connections closed by window trimming.
+	 */
+	uint32_t trimmed;
+
+	/**
+	 * Fewest idle connections seen per interval.
+	 */
+	uint32_t samples[AS_CONN_WINDOW_MAX];
+} as_conn_window;
+
 /**
  * @private
  * Sync connection pool.
@@ -43,26 +110,210 @@ typedef struct as_conn_pool_s {
 	 */
 	as_queue queue;
 
+	/**
+	 * Lock-free connection cache that is checked before the locked queue.
+	 * NULL if cache is disabled.
+	 */
+	as_conn_cache_slot* cache;
+
+	/**
+	 * Number of cache slots.
+	 */
+	uint32_t cache_size;
+
+	/**
+	 * Cache slot iterator.  Not atomic by design.
+	 */
+	uint32_t cache_iter;
+
 	/**
 	 * Minimum number of connections.
 	 */
 	uint32_t min_size;
+
+	/**
+	 * Number of times the pool lock was already held when a thread tried to acquire it.
+	 */
+	uint64_t contended;
+
+	/**
+	 * Number of connections retrieved from the lock-free cache.
+	 */
+	uint64_t cache_hits;
+
+	/**
+	 * Pool usage window.
+	 */
+	as_conn_window window;
 } as_conn_pool;
 
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
 
+/**
+ * @private
+ * Initialize a usage window. Empty samples are zero, so nothing is trimmed until the
+ * first window completes.
+ */
+static inline void
+as_conn_window_init(as_conn_window* window)
+{
+	memset(window, 0, sizeof(as_conn_window));
+	window->idle_min = UINT32_MAX;
+}
+
+/**
+ * @private
+ * Record idle connections remaining in pool after a connection was requested.
+ */
+static inline void
+as_conn_window_idle(as_conn_window* window, uint32_t idle)
+{
+	if (idle < window->idle_min) {
+		window->idle_min = idle;
+	}
+}
+
+/**
+ * @private
+ * Close current interval and return idle connections that were not used during the last
+ * size intervals. Must be called once per tend interval.
+ */
+static inline uint32_t
+as_conn_window_surplus(as_conn_window* window, uint32_t size, uint32_t idle, uint32_t total)
+{
+	uint32_t idle_min = window->idle_min;
+	window->idle_min = UINT32_MAX;
+
+	if (idle_min > idle) {
+		idle_min = idle;
+	}
+
+	window->samples[window->index++ % size] = idle_min;
+
+	uint32_t surplus = idle_min;
+
+	for (uint32_t i = 0; i < size; i++) {
+		if (window->samples[i] < surplus) {
+			surplus = window->samples[i];
+		}
+	}
+	window->peak = (total > surplus)? total - surplus : 0;
+	return surplus;
+}
+
 /**
  * @private
  * Initialize a connection pool.
  */
 static inline void
-as_conn_pool_init(as_conn_pool* pool, uint32_t item_size, uint32_t min_size, uint32_t max_size)
+as_conn_pool_init(
+	as_conn_pool* pool, uint32_t item_size, uint32_t min_size, uint32_t max_size, uint32_t cache_size
+	)
 {
 	pthread_mutex_init(&pool->lock, NULL);
 	as_queue_init(&pool->queue, item_size, max_size);
+
+	if (cache_size > max_size) {
+		cache_size = max_size;
+	}
+
+	pool->cache = cache_size > 0 ? cf_calloc(cache_size, sizeof(as_conn_cache_slot)) : NULL;
+	pool->cache_size = cache_size;
+	as_mem_stats_alloc(AS_MEM_TAG_POOL, (size_t)pool->queue.capacity * pool->queue.item_size +
+		sizeof(as_conn_cache_slot) * cache_size);
+	pool->cache_iter = 0;
 	pool->min_size = min_size;
+	pool->contended = 0;
+	pool->cache_hits = 0;
+	as_conn_window_init(&pool->window);
+}
+
+/**
+ * @private
+ * Acquire pool lock and count contention when the lock is already held.
+ */
+static inline void
+as_conn_pool_lock(as_conn_pool* pool)
+{
+	if (pthread_mutex_trylock(&pool->lock) != 0) {
+		as_incr_uint64(&pool->contended);
+		pthread_mutex_lock(&pool->lock);
+	}
+}
+
+/**
+ * @private
+ * Release pool lock acquired by as_conn_pool_lock().
+ */
+static inline void
+as_conn_pool_unlock(as_conn_pool* pool)
+{
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @private
+ * Pop connection from lock-free cache.
+ */
+static inline bool
+as_conn_cache_pop(as_conn_pool* pool, as_socket* sock)
+{
+	uint32_t max = pool->cache_size;
+	uint32_t start = pool->cache_iter++; // not atomic by design
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_conn_cache_slot* slot = &pool->cache[(start + i) % max];
+
+		if (as_load_uint32(&slot->state) == AS_CONN_CACHE_FULL &&
+			as_cas_uint32(&slot->state, AS_CONN_CACHE_FULL, AS_CONN_CACHE_BUSY)) {
+			*sock = slot->sock;
+			as_store_uint32_rls(&slot->state, AS_CONN_CACHE_EMPTY);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @private
+ * Push connection to lock-free cache if an empty slot exists.
+ */
+static inline bool
+as_conn_cache_push(as_conn_pool* pool, as_socket* sock)
+{
+	uint32_t max = pool->cache_size;
+	uint32_t start = pool->cache_iter++; // not atomic by design
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_conn_cache_slot* slot = &pool->cache[(start + i) % max];
+
+		if (as_load_uint32(&slot->state) == AS_CONN_CACHE_EMPTY &&
+			as_cas_uint32(&slot->state, AS_CONN_CACHE_EMPTY, AS_CONN_CACHE_BUSY)) {
+			slot->sock = *sock;
+			as_store_uint32_rls(&slot->state, AS_CONN_CACHE_FULL);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @private
+ * Return approximate number of connections residing in lock-free cache.
+ */
+static inline uint32_t
+as_conn_cache_count(as_conn_pool* pool)
+{
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < pool->cache_size; i++) {
+		if (as_load_uint32(&pool->cache[i].state) == AS_CONN_CACHE_FULL) {
+			count++;
+		}
+	}
+	return count;
 }
 
 /**
@@ -72,9 +323,15 @@ as_conn_pool_init(as_conn_pool* pool, uint32_t item_size, uint32_t min_size, uin
 static inline bool
 as_conn_pool_pop_head(as_conn_pool* pool, as_socket* sock)
 {
-	pthread_mutex_lock(&pool->lock);
+	if (pool->cache && as_conn_cache_pop(pool, sock)) {
+		as_incr_uint64(&pool->cache_hits);
+		return true;
+	}
+
+	as_conn_pool_lock(pool);
 	bool status = as_queue_pop(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
+	as_conn_window_idle(&pool->window, as_queue_size(&pool->queue));
+	as_conn_pool_unlock(pool);
 	return status;
 }
 
@@ -85,9 +342,9 @@ as_conn_pool_pop_head(as_conn_pool* pool, as_socket* sock)
 static inline bool
 as_conn_pool_pop_tail(as_conn_pool* pool, as_socket* sock)
 {
-	pthread_mutex_lock(&pool->lock);
+	as_conn_pool_lock(pool);
 	bool status = as_queue_pop_tail(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
+	as_conn_pool_unlock(pool);
 	return status;
 }
 
@@ -98,9 +355,26 @@ as_conn_pool_pop_tail(as_conn_pool* pool, as_socket* sock)
 static inline bool
 as_conn_pool_push_head(as_conn_pool* pool, as_socket* sock)
 {
-	pthread_mutex_lock(&pool->lock);
+	if (pool->cache && as_conn_cache_push(pool, sock)) {
+		return true;
+	}
+
+	as_conn_pool_lock(pool);
 	bool status = as_queue_push_head_limit(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
+	as_conn_pool_unlock(pool);
+	return status;
+}
+
+/**
+ * @private
+ * Push connection to head of locked queue, bypassing the lock-free cache.
+ */
+static inline bool
+as_conn_pool_push_head_queue(as_conn_pool* pool, as_socket* sock)
+{
+	as_conn_pool_lock(pool);
+	bool status = as_queue_push_head_limit(&pool->queue, sock);
+	as_conn_pool_unlock(pool);
 	return status;
 }
 
@@ -111,9 +385,9 @@ as_conn_pool_push_head(as_conn_pool* pool, as_socket* sock)
 static inline bool
 as_conn_pool_push_tail(as_conn_pool* pool, as_socket* sock)
 {
-	pthread_mutex_lock(&pool->lock);
+	as_conn_pool_lock(pool);
 	bool status = as_queue_push_limit(&pool->queue, sock);
-	pthread_mutex_unlock(&pool->lock);
+	as_conn_pool_unlock(pool);
 	return status;
 }
 
@@ -159,10 +433,19 @@ as_conn_pool_destroy(as_conn_pool* pool)
 
 	pthread_mutex_lock(&pool->lock);
 
+	if (pool->cache) {
+		while (as_conn_cache_pop(pool, &sock)) {
+			as_socket_close(&sock);
+		}
+		cf_free(pool->cache);
+	}
+
 	while (as_queue_pop(&pool->queue, &sock)) {
 		as_socket_close(&sock);
 	}
 
+	as_mem_stats_free(AS_MEM_TAG_POOL, (size_t)pool->queue.capacity * pool->queue.item_size +
+		sizeof(as_conn_cache_slot) * pool->cache_size);
 	as_queue_destroy(&pool->queue);
 	pthread_mutex_unlock(&pool->lock);
 	pthread_mutex_destroy(&pool->lock);
@@ -0,0 +1,479 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+/**
+ * @file as_coroutine.hpp
+ *
+ * C++20 awaitable adapters for async key, batch and query commands.
+ *
+ * Each awaitable passes itself as the command's udata, so awaiting a command does not allocate
+ * beyond the coroutine frame. The coroutine is resumed from the command listener on the event
+ * loop thread that ran the command. Resumption can be customized with the Resume template
+ * parameter, for example to post the coroutine handle to an application scheduler.
+ *
+ * ~~~~~~~~~~{.cpp}
+ * my_task read_counter(aerospike* as, const as_key* key)
+ * {
+ *     as_coro::record_result r = co_await as_coro::key_get(as, NULL, key);
+ *
+ *     if (r.status != AEROSPIKE_OK) {
+ *         printf("Get failed: %d %s\n", r.err.code, r.err.message);
+ *         co_return;
+ *     }
+ *     // r.record is destroyed by the client when the coroutine next suspends or returns,
+ *     // unless as_policy_read.async_heap_rec is set.
+ *     printf("count=%" PRId64 "\n", as_record_get_int64(r.record, "count", 0));
+ * }
+ * ~~~~~~~~~~
+ *
+ * Awaitables must be awaited immediately and at most once. The task type is supplied by the
+ * application.
+ */
+
+#if !defined(__cplusplus) || __cplusplus < 202002L
+#error "as_coroutine.hpp requires C++20"
+#endif
+
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/aerospike_query.h>
+#include <coroutine>
+#include <utility>
+
+namespace as_coro {
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Default resume hook. Resume coroutine inline on the event loop thread that completed the
+ * command.
+ */
+struct resume_inline {
+	void
+	operator()(std::coroutine_handle<> handle, as_event_loop* event_loop) const
+	{
+		(void)event_loop;
+		handle.resume();
+	}
+};
+
+/**
+ * Result of commands that do not return a record.
+ */
+struct status_result {
+	/**
+	 * Command status. err is only populated when status is not AEROSPIKE_OK.
+	 */
+	as_status status;
+
+	/**
+	 * Command error.
+	 */
+	as_error err;
+
+	/**
+	 * Event loop that completed the command. NULL if the command was not queued.
+	 */
+	as_event_loop* event_loop;
+};
+
+/**
+ * Result of single record commands.
+ */
+struct record_result : status_result {
+	/**
+	 * Returned record. NULL on error. The client destroys the record when the listener returns,
+	 * which is when the coroutine next suspends or returns, unless async_heap_rec is set in the
+	 * command policy. In that case, the coroutine must call as_record_destroy().
+	 */
+	as_record* record;
+};
+
+/**
+ * Result of batch commands.
+ */
+struct batch_result : status_result {
+	/**
+	 * Batch records passed to the command. Each record's result is populated on success.
+	 */
+	as_batch_records* records;
+};
+
+/**
+ * @private
+ * Common awaitable state. The Launch callable starts the async command with the supplied
+ * listener and udata and returns the status of queueing the command.
+ */
+template<typename Result, typename Launch, typename Resume>
+class awaitable_base {
+public:
+	explicit awaitable_base(Launch launch) : launch_(std::move(launch))
+	{
+		result_.status = AEROSPIKE_OK;
+		as_error_init(&result_.err);
+		result_.event_loop = NULL;
+	}
+
+	awaitable_base(const awaitable_base&) = delete;
+	awaitable_base& operator=(const awaitable_base&) = delete;
+
+	bool
+	await_ready() const noexcept
+	{
+		return false;
+	}
+
+	Result
+	await_resume()
+	{
+		return result_;
+	}
+
+protected:
+	template<typename Listener>
+	bool
+	start(std::coroutine_handle<> handle, Listener listener)
+	{
+		handle_ = handle;
+
+		// The listener may resume the coroutine on the event loop thread before launch
+		// returns, so this object must not be referenced after a successful launch.
+		as_status status = launch_(&result_.err, listener, this);
+
+		if (status != AEROSPIKE_OK) {
+			// Command was not queued and the listener will not be called.
+			result_.status = status;
+			return false;
+		}
+		return true;
+	}
+
+	void
+	complete(as_error* err, as_event_loop* event_loop)
+	{
+		if (err) {
+			result_.status = err->code;
+			as_error_copy(&result_.err, err);
+		}
+		else {
+			result_.status = AEROSPIKE_OK;
+		}
+		result_.event_loop = event_loop;
+		Resume{}(handle_, event_loop);
+	}
+
+	Result result_;
+	std::coroutine_handle<> handle_;
+	Launch launch_;
+};
+
+/**
+ * Awaitable for commands completed by as_async_write_listener.
+ */
+template<typename Launch, typename Resume = resume_inline>
+class write_awaitable : public awaitable_base<status_result, Launch, Resume> {
+	using base = awaitable_base<status_result, Launch, Resume>;
+
+public:
+	explicit write_awaitable(Launch launch) : base(std::move(launch))
+	{
+	}
+
+	bool
+	await_suspend(std::coroutine_handle<> handle)
+	{
+		return base::start(handle, &write_awaitable::listener);
+	}
+
+private:
+	static void
+	listener(as_error* err, void* udata, as_event_loop* event_loop)
+	{
+		static_cast<write_awaitable*>(udata)->complete(err, event_loop);
+	}
+};
+
+/**
+ * Awaitable for commands completed by as_async_record_listener.
+ */
+template<typename Launch, typename Resume = resume_inline>
+class record_awaitable : public awaitable_base<record_result, Launch, Resume> {
+	using base = awaitable_base<record_result, Launch, Resume>;
+
+public:
+	explicit record_awaitable(Launch launch) : base(std::move(launch))
+	{
+		this->result_.record = NULL;
+	}
+
+	bool
+	await_suspend(std::coroutine_handle<> handle)
+	{
+		return base::start(handle, &record_awaitable::listener);
+	}
+
+private:
+	static void
+	listener(as_error* err, as_record* record, void* udata, as_event_loop* event_loop)
+	{
+		record_awaitable* self = static_cast<record_awaitable*>(udata);
+		self->result_.record = record;
+		self->complete(err, event_loop);
+	}
+};
+
+/**
+ * Awaitable for commands completed by as_async_batch_listener.
+ */
+template<typename Launch, typename Resume = resume_inline>
+class batch_awaitable : public awaitable_base<batch_result, Launch, Resume> {
+	using base = awaitable_base<batch_result, Launch, Resume>;
+
+public:
+	batch_awaitable(Launch launch, as_batch_records* records) : base(std::move(launch))
+	{
+		this->result_.records = records;
+	}
+
+	bool
+	await_suspend(std::coroutine_handle<> handle)
+	{
+		return base::start(handle, &batch_awaitable::listener);
+	}
+
+private:
+	static void
+	listener(as_error* err, as_batch_records* records, void* udata, as_event_loop* event_loop)
+	{
+		batch_awaitable* self = static_cast<batch_awaitable*>(udata);
+		self->result_.records = records;
+		self->complete(err, event_loop);
+	}
+};
+
+/**
+ * Awaitable for queries. Callback is called inline for each record with signature
+ * bool(as_record*) and returns false to end the query. The coroutine is resumed when the query
+ * completes, fails or is ended by the callback. Ending the query results in
+ * AEROSPIKE_ERR_CLIENT_ABORT.
+ */
+template<typename Launch, typename Callback, typename Resume = resume_inline>
+class query_awaitable : public awaitable_base<status_result, Launch, Resume> {
+	using base = awaitable_base<status_result, Launch, Resume>;
+
+public:
+	query_awaitable(Launch launch, Callback callback)
+		: base(std::move(launch)), callback_(std::move(callback))
+	{
+	}
+
+	bool
+	await_suspend(std::coroutine_handle<> handle)
+	{
+		return base::start(handle, &query_awaitable::listener);
+	}
+
+private:
+	static bool
+	listener(as_error* err, as_record* record, void* udata, as_event_loop* event_loop)
+	{
+		query_awaitable* self = static_cast<query_awaitable*>(udata);
+
+		if (err) {
+			self->complete(err, event_loop);
+			return false;
+		}
+
+		if (! record) {
+			self->complete(NULL, event_loop);
+			return false;
+		}
+
+		if (self->callback_(record)) {
+			return true;
+		}
+
+		// The client does not call the listener again after it returns false.
+		as_error abort;
+		as_error_init(&abort);
+		as_error_set_message(&abort, AEROSPIKE_ERR_CLIENT_ABORT, "Query ended by callback");
+		self->complete(&abort, event_loop);
+		return false;
+	}
+
+	Callback callback_;
+};
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Await aerospike_key_get_async().
+ */
+template<typename Resume = resume_inline>
+inline auto
+key_get(
+	aerospike* as, const as_policy_read* policy, const as_key* key,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_record_listener listener, void* udata) {
+		return aerospike_key_get_async(as, err, policy, key, listener, udata, event_loop, NULL);
+	};
+	return record_awaitable<decltype(launch), Resume>(launch);
+}
+
+/**
+ * Await aerospike_key_select_async().
+ */
+template<typename Resume = resume_inline>
+inline auto
+key_select(
+	aerospike* as, const as_policy_read* policy, const as_key* key, const char* bins[],
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_record_listener listener, void* udata) {
+		return aerospike_key_select_async(as, err, policy, key, bins, listener, udata,
+			event_loop, NULL);
+	};
+	return record_awaitable<decltype(launch), Resume>(launch);
+}
+
+/**
+ * Await aerospike_key_put_async().
+ */
+template<typename Resume = resume_inline>
+inline auto
+key_put(
+	aerospike* as, const as_policy_write* policy, const as_key* key, as_record* rec,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_write_listener listener, void* udata) {
+		return aerospike_key_put_async(as, err, policy, key, rec, listener, udata, event_loop,
+			NULL);
+	};
+	return write_awaitable<decltype(launch), Resume>(launch);
+}
+
+/**
+ * Await aerospike_key_remove_async().
+ */
+template<typename Resume = resume_inline>
+inline auto
+key_remove(
+	aerospike* as, const as_policy_remove* policy, const as_key* key,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_write_listener listener, void* udata) {
+		return aerospike_key_remove_async(as, err, policy, key, listener, udata, event_loop,
+			NULL);
+	};
+	return write_awaitable<decltype(launch), Resume>(launch);
+}
+
+/**
+ * Await aerospike_key_operate_async().
+ */
+template<typename Resume = resume_inline>
+inline auto
+key_operate(
+	aerospike* as, const as_policy_operate* policy, const as_key* key, const as_operations* ops,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_record_listener listener, void* udata) {
+		return aerospike_key_operate_async(as, err, policy, key, ops, listener, udata,
+			event_loop, NULL);
+	};
+	return record_awaitable<decltype(launch), Resume>(launch);
+}
+
+/**
+ * Await aerospike_batch_read_async(). The records are not destroyed by the client.
+ */
+template<typename Resume = resume_inline>
+inline auto
+batch_read(
+	aerospike* as, const as_policy_batch* policy, as_batch_records* records,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_batch_listener listener, void* udata) {
+		return aerospike_batch_read_async(as, err, policy, records, listener, udata, event_loop);
+	};
+	return batch_awaitable<decltype(launch), Resume>(launch, records);
+}
+
+/**
+ * Await aerospike_batch_write_async(). The records are not destroyed by the client.
+ */
+template<typename Resume = resume_inline>
+inline auto
+batch_write(
+	aerospike* as, const as_policy_batch* policy, as_batch_records* records,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_batch_listener listener, void* udata) {
+		return aerospike_batch_write_async(as, err, policy, records, listener, udata,
+			event_loop);
+	};
+	return batch_awaitable<decltype(launch), Resume>(launch, records);
+}
+
+/**
+ * Await aerospike_query_async(). Callback is called on the event loop thread for each record.
+ */
+template<typename Resume = resume_inline, typename Callback>
+inline auto
+query(
+	aerospike* as, const as_policy_query* policy, as_query* q, Callback callback,
+	as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_query_record_listener listener, void* udata) {
+		return aerospike_query_async(as, err, policy, q, listener, udata, event_loop);
+	};
+	return query_awaitable<decltype(launch), Callback, Resume>(launch, std::move(callback));
+}
+
+/**
+ * Await aerospike_query_partitions_async(). Callback is called on the event loop thread for
+ * each record.
+ */
+template<typename Resume = resume_inline, typename Callback>
+inline auto
+query_partitions(
+	aerospike* as, const as_policy_query* policy, as_query* q, as_partition_filter* pf,
+	Callback callback, as_event_loop* event_loop = NULL
+	)
+{
+	auto launch = [=](as_error* err, as_async_query_record_listener listener, void* udata) {
+		return aerospike_query_partitions_async(as, err, policy, q, pf, listener, udata,
+			event_loop);
+	};
+	return query_awaitable<decltype(launch), Callback, Resume>(launch, std::move(callback));
+}
+
+} // namespace as_coro
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_lookup.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Resolved addresses of a hostname.
+ */
+typedef struct as_dns_entry_s {
+	struct as_dns_entry_s* next;
+	struct sockaddr_storage* addrs;
+	uint32_t addrs_size;
+	uint64_t expires_ms;
+	bool used;
+	char name[];
+} as_dns_entry;
+
+/**
+ * @private
+ * Hostname to address cache used by the cluster tend thread. Expired entries that were used
+ * since their last resolution are resolved again by a background thread, so the tend thread
+ * only waits on DNS the first time a hostname is seen.
+ */
+typedef struct as_dns_cache_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+	as_dns_entry* entries;
+	uint32_t ttl_ms;
+	bool valid;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t lookups;
+	uint64_t lookup_errors;
+	uint64_t lookup_ns;
+} as_dns_cache;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create cache and start its resolver thread. Return NULL if the thread could not be started.
+ */
+as_dns_cache*
+as_dns_cache_create(uint32_t ttl_sec);
+
+/**
+ * @private
+ * Stop resolver thread and release cache.
+ */
+void
+as_dns_cache_destroy(as_dns_cache* cache);
+
+/**
+ * @private
+ * Lookup hostname in cache and initialize address iterator. Expired addresses are still
+ * returned while the resolver thread refreshes them. Numeric addresses are not cached.
+ */
+as_status
+as_dns_cache_lookup(
+	as_dns_cache* cache, as_address_iterator* iter, as_error* err, const char* hostname,
+	uint16_t port
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_std.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Per-thread epoch record. epoch is the global epoch observed when the thread entered its
+ * outermost critical section, or zero when the thread is not in a critical section.
+ * Records are reused by new threads after their thread exits and are never freed.
+ */
+typedef struct as_epoch_record_s {
+	struct as_epoch_record_s* next;
+	uint64_t epoch;
+	uint32_t depth;
+	uint8_t used;
+} as_epoch_record;
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+/**
+ * @private
+ * Global epoch. Starts at 1, so zero can mark inactive records.
+ */
+AS_EXTERN extern uint64_t as_epoch_global;
+
+/**
+ * @private
+ * Thread key of calling thread's epoch record.
+ */
+AS_EXTERN extern pthread_key_t as_epoch_key;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Initialize epoch thread key. Must be called before the first as_epoch_enter().
+ */
+void
+as_epoch_init(void);
+
+/**
+ * @private
+ * Assign epoch record to calling thread.
+ */
+as_epoch_record*
+as_epoch_register(void);
+
+/**
+ * @private
+ * Enter critical section. Shared data structures loaded inside the critical section
+ * (nodes, node arrays and partition tables) are not released until the critical section
+ * is exited, so they can be used without reference counting. Critical sections can nest.
+ */
+static inline as_epoch_record*
+as_epoch_enter(void)
+{
+	as_epoch_record* rec = pthread_getspecific(as_epoch_key);
+
+	if (! rec) {
+		rec = as_epoch_register();
+	}
+
+	if (rec->depth++ == 0) {
+		// The epoch store must be visible before any shared pointer is loaded.
+		as_store_uint64(&rec->epoch, as_load_uint64(&as_epoch_global));
+		as_fence_seq();
+	}
+	return rec;
+}
+
+/**
+ * @private
+ * Exit critical section.
+ */
+static inline void
+as_epoch_exit(as_epoch_record* rec)
+{
+	if (--rec->depth == 0) {
+		as_store_uint64_rls(&rec->epoch, 0);
+	}
+}
+
+/**
+ * @private
+ * Advance global epoch and return the previous epoch. Data retired before this call may
+ * be referenced only by threads whose epoch is less than or equal to the returned value.
+ */
+uint64_t
+as_epoch_advance(void);
+
+/**
+ * @private
+ * Return the minimum epoch of all threads in a critical section, or UINT64_MAX if no thread
+ * is in a critical section. Data retired at epoch e can be released if e is less than the
+ * returned value.
+ */
+uint64_t
+as_epoch_min(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -146,6 +146,15 @@ typedef struct as_error_s {
 #define as_error_set_message(__err, __code, __msg) \
 	as_error_setall( __err, __code, __msg, __func__, __FILE__, __LINE__ );
 
+/**
+ * Set all as_error fields and default in_doubt to false. The message is the prefix and the
+ * message separated by a space. Variable arguments are not accepted.
+ *
+ * @relates as_error
+ */
+#define as_error_set_prefix(__err, __code, __prefix, __msg) \
+	as_error_setall_prefix( __err, __code, __prefix, __msg, __func__, __FILE__, __LINE__ );
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -236,6 +245,42 @@ as_error_setallv(as_error* err, as_status code, const char * func, const char *
 	return err->code;
 }
 
+/**
+ * Sets the error with message "<prefix> <message>". Equivalent to as_error_setallv() with
+ * format "%s %s", but copies the strings instead of parsing a format. Used for server result
+ * codes like record not found, which can be returned for most commands in some workloads.
+ *
+ * @return The status code set for the error.
+ *
+ * @relates as_error
+ */
+static inline as_status
+as_error_setall_prefix(
+	as_error* err, as_status code, const char* prefix, const char* message, const char* func,
+	const char* file, uint32_t line
+	)
+{
+	size_t plen = strlen(prefix);
+	size_t mlen = strlen(message);
+
+	if (plen + 1 + mlen <= AS_ERROR_MESSAGE_MAX_LEN) {
+		char* p = err->message;
+		memcpy(p, prefix, plen);
+		p += plen;
+		*p++ = ' ';
+		memcpy(p, message, mlen + 1);
+	}
+	else {
+		snprintf(err->message, AS_ERROR_MESSAGE_MAX_SIZE, "%s %s", prefix, message);
+	}
+	err->code = code;
+	err->func = func;
+	err->file = file;
+	err->line = line;
+	err->in_doubt = false;
+	return err->code;
+}
+
 /**
  * Set whether it is possible that the write command may have completed
  * even though this exception was generated.  This may be the case when a
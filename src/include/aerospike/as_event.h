@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_queue.h>
 #include <pthread.h>
@@ -26,7 +27,7 @@
  * Generic asynchronous events abstraction.  Designed to support multiple event libraries.
  * Only one library is supported per build.
  */
-#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT)
+#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT) || defined(AS_USE_LIBURING) || defined(AS_USE_IOCP)
 #define AS_EVENT_LIB_DEFINED 1
 #endif
 
@@ -37,16 +38,100 @@
 #elif defined(AS_USE_LIBEVENT)
 #include <event2/event_struct.h>
 #include <aerospike/as_vector.h>
+#elif defined(AS_USE_LIBURING)
+#include <liburing.h>
+struct as_uring_timer;
+#elif defined(AS_USE_IOCP)
+#include <winsock2.h>
+struct as_iocp_timer;
 #else
 #endif
 
+struct as_event_connection_s;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+/**
+ * Number of async command pool size classes. Class sizes start at 1KB and double
+ * for each class (1KB, 2KB, 4KB, 8KB, 16KB).
+ */
+#define AS_EVENT_COMMAND_POOL_CLASSES 5
+
+/**
+ * Maximum number of freed commands cached per size class on each event loop.
+ */
+#define AS_EVENT_COMMAND_POOL_MAX 256
+
+/**
+ * @private
+ * Command pool class of async commands allocated by a custom as_config.allocator.
+ * These commands are never pooled.
+ */
+#define AS_EVENT_COMMAND_POOL_CUSTOM 0xFF
+
 /******************************************************************************
  * TYPES
  *****************************************************************************/
+
+/**
+ * @private
+ * Per event loop free lists of async command memory. Commands are allocated in
+ * application threads and freed in the event loop thread, so the free lists are
+ * protected by a lock.
+ */
+typedef struct as_event_command_pool {
+	pthread_mutex_t lock;
+	void* free_list[AS_EVENT_COMMAND_POOL_CLASSES];
+	uint32_t free_size[AS_EVENT_COMMAND_POOL_CLASSES];
+	uint32_t in_use;
+	uint32_t high_water;
+} as_event_command_pool;
+
+/**
+ * Event loop selection for async commands that do not specify an event loop.
+ *
+ * @ingroup async_events
+ */
+typedef enum as_event_loop_selection_e {
+	/**
+	 * Distribute commands over event loops using round-robin. This is the default.
+	 */
+	AS_EVENT_LOOP_SELECTION_ROUND_ROBIN,
+
+	/**
+	 * Assign each command to the event loop with the fewest commands in process, waiting in
+	 * its delay queues or waiting to be registered.
+	 */
+	AS_EVENT_LOOP_SELECTION_LEAST_LOADED,
+
+	/**
+	 * Assign single record and info commands to the event loop of the target node, so all
+	 * commands for a node share one event loop's async connection pool and pipelines.
+	 * Single record commands use the partition's master node. Batch, scan and query
+	 * commands span multiple nodes and use AS_EVENT_LOOP_SELECTION_LEAST_LOADED.
+	 */
+	AS_EVENT_LOOP_SELECTION_NODE_AFFINITY,
+} as_event_loop_selection;
+
+struct as_event_loop;
+
+/**
+ * Event loop lag listener. Called in the event loop thread when the measured event loop lag
+ * reaches as_policy_event.lag_threshold_ms. The listener must not block.
+ *
+ * @param event_loop	Event loop that is lagging.
+ * @param lag_us		Measured lag in microseconds.
+ * @param udata			User data from as_policy_event.lag_udata.
+ *
+ * @ingroup async_events
+ */
+typedef void (*as_event_lag_listener)(struct as_event_loop* event_loop, uint32_t lag_us, void* udata);
 	
 /**
  * Asynchronous event loop configuration.
@@ -89,6 +174,30 @@ typedef struct as_policy_event {
 	 */
 	uint32_t max_commands_in_queue;
 
+	/**
+	 * Maximum number of async commands with as_policy_base.priority set to
+	 * AS_POLICY_PRIORITY_BACKGROUND that can be stored in each event loop's background delay
+	 * queue. Background commands do not count against max_commands_in_queue, so a backlog of
+	 * background commands never causes foreground commands to be rejected.
+	 *
+	 * If this limit is reached, the next background command will be rejected with error code
+	 * AEROSPIKE_ERR_ASYNC_QUEUE_FULL.  If this limit is zero, all background commands will be
+	 * accepted into the background delay queue.
+	 *
+	 * Default: 0 (no background delay queue limit)
+	 */
+	uint32_t max_background_in_queue;
+
+	/**
+	 * Number of foreground commands started from the delay queue for each background command
+	 * when both delay queues hold commands. This keeps background commands from starving
+	 * while foreground commands receive most of the available slots. If zero, background
+	 * commands are only started when the foreground delay queue is empty.
+	 *
+	 * Default: 8
+	 */
+	uint32_t foreground_burst;
+
 	/**
 	 * Initial capacity of each event loop's delay queue.  The delay queue can resize beyond this
 	 * initial capacity.
@@ -96,8 +205,112 @@ typedef struct as_policy_event {
 	 * Default: 256 (if delay queue is used)
 	 */
 	uint32_t queue_initial_capacity;
+
+	/**
+	 * CPU ids that event loop threads created by as_create_event_loops() are pinned to.
+	 * Event loop i is pinned to cpus[i % cpus_size]. The array is only referenced during
+	 * as_create_event_loops(). Externally created event loops are not pinned.
+	 *
+	 * Default: NULL (event loop threads are not pinned)
+	 */
+	int* cpus;
+
+	/**
+	 * Number of entries in cpus.
+	 *
+	 * Default: 0
+	 */
+	uint32_t cpus_size;
+
+	/**
+	 * Route commands to an event loop on the caller's NUMA node when as_event_loop_get()
+	 * is used. NUMA nodes are determined from the pinned cpus, so cpus must be defined.
+	 * Commands and their pooled buffers are allocated by the caller thread, so routing
+	 * keeps them on the same NUMA node as the event loop that processes them. Callers on
+	 * a NUMA node without event loops fall back to round-robin over all event loops.
+	 *
+	 * This option is only supported on Linux and is ignored on other platforms.
+	 *
+	 * Default: false
+	 */
+	bool numa_routing;
+
+	/**
+	 * Event loop selection for async commands that are not given an event loop. Commands
+	 * that are given an event loop, for example from as_event_loop_get_by_index(), always
+	 * run on that event loop. The selection applies to all event loops, so the last value
+	 * set by as_create_event_loops() or as_set_external_event_loop() is used.
+	 *
+	 * When numa_routing is enabled, AS_EVENT_LOOP_SELECTION_LEAST_LOADED only considers
+	 * event loops on the caller's NUMA node.
+	 *
+	 * Default: AS_EVENT_LOOP_SELECTION_ROUND_ROBIN
+	 */
+	as_event_loop_selection loop_selection;
+
+	/**
+	 * Call lag_listener when an event loop takes at least this many milliseconds to run a
+	 * monitor probe. Probes are queued to each event loop by cluster tend threads once per
+	 * tend interval. If zero, lag is still measured but lag_listener is not called.
+	 *
+	 * Default: 0
+	 */
+	uint32_t lag_threshold_ms;
+
+	/**
+	 * Optional listener that is called when event loop lag reaches lag_threshold_ms.
+	 *
+	 * Default: NULL
+	 */
+	as_event_lag_listener lag_listener;
+
+	/**
+	 * User data passed to lag_listener.
+	 *
+	 * Default: NULL
+	 */
+	void* lag_udata;
+
+	/**
+	 * Maximum number of event loops that as_create_event_loops() reserves room for. Additional
+	 * event loops can be started at runtime with as_event_add_loop() until this limit is
+	 * reached. Async connection pools are sized for this many event loops, so per event loop
+	 * connection limits are the per node limits divided by max_loops.
+	 *
+	 * If less than the as_create_event_loops() capacity, the capacity is used.
+	 *
+	 * Default: 0
+	 */
+	uint32_t max_loops;
 } as_policy_event;
 
+/**
+ * @private
+ * Event loop lag and saturation measurements. A probe is queued to the event loop and the
+ * measurements are updated in the event loop thread when the probe runs.
+ */
+typedef struct as_event_monitor_s {
+	// Time the outstanding probe was queued.
+	uint64_t sent_ns;
+	// Wall and thread cpu time when the previous probe ran.
+	uint64_t wall_ns;
+	uint64_t cpu_ns;
+	uint64_t commands_prev;
+	uint64_t iterations_prev;
+	// Commands completed on this event loop.
+	uint64_t commands;
+	as_event_lag_listener lag_listener;
+	void* lag_udata;
+	uint32_t lag_threshold_us;
+	uint32_t lag_us;
+	uint32_t lag_max_us;
+	uint32_t lag_window_us;
+	uint32_t busy_pct;
+	uint32_t commands_per_iteration;
+	uint32_t probes;
+	uint8_t probing;
+} as_event_monitor;
+
 /**
  * Generic asynchronous event loop abstraction.  There is one event loop per thread.
  * Event loops can be created by the client, or be referenced to externally created event loops.
@@ -108,26 +321,82 @@ typedef struct as_event_loop {
 #if defined(AS_USE_LIBEV)
 	struct ev_loop* loop;
 	struct ev_async wakeup;
+	struct ev_timer tick;
 #elif defined(AS_USE_LIBUV)
 	uv_loop_t* loop;
 	uv_async_t* wakeup;
+	uv_timer_t* tick;
 #elif defined(AS_USE_LIBEVENT)
 	struct event_base* loop;
 	struct event wakeup;
+	struct event tick;
 	struct event trim;
 	as_vector clusters;
+#elif defined(AS_USE_LIBURING)
+	struct io_uring* loop;
+	struct io_uring_buf_ring* buf_ring;
+	uint8_t* bufs;
+	struct as_uring_timer** timers;
+	struct io_uring_cqe* backlog;
+	uint32_t timers_size;
+	uint32_t timers_capacity;
+	uint32_t timers_pass;
+	uint32_t backlog_head;
+	uint32_t backlog_size;
+	uint32_t backlog_capacity;
+	uint64_t iterations;
+	uint64_t wakeup_value;
+	int wakeup_fd;
+	bool closing;
+	bool closed;
+#elif defined(AS_USE_IOCP)
+	HANDLE loop;
+	struct as_iocp_timer** timers;
+	uint32_t timers_size;
+	uint32_t timers_capacity;
+	uint32_t timers_pass;
+	uint64_t iterations;
+	bool closing;
+	bool closed;
 #else
 	void* loop;
 #endif
 		
 	struct as_event_loop* next;
+	// Next event loop on the same NUMA node. Only used with as_policy_event.numa_routing.
+	struct as_event_loop* numa_next;
 	pthread_mutex_t lock;
+	// Lock-free submission ring. The locked queue is only used when the ring is full.
+	struct as_event_ring_s* ring;
+	// Command timers. Not used with liburing, which keeps its own timer heap.
+	struct as_event_wheel_s* wheel;
 	as_queue queue;
 	as_queue delay_queue;
+	// Delay queue for commands with AS_POLICY_PRIORITY_BACKGROUND.
+	as_queue background_queue;
 	as_queue pipe_cb_queue;
+	// Pipeline connections corked while the command queue is processed.
+	struct as_event_connection_s* pipe_corked;
+	as_event_command_pool cmd_pool;
+	as_event_monitor monitor;
+	// Compressed response bytes are moved here, so the response can be decompressed into the
+	// command's read buffer. Freed when unused for AS_EVENT_DECOMPRESS_IDLE_MS.
+	uint8_t* decompress_buf;
+	uint64_t decompress_last_used;
+	uint32_t decompress_capacity;
+	// In-flight ordered commands hashed by key. Allocated on first ordered command.
+	struct as_event_command** order_buckets;
 	pthread_t thread;
 	uint32_t index;
+	// Pinned cpu or -1 if not pinned.
+	int cpu;
+	// NUMA node of pinned cpu or -1 if unknown.
+	int numa_node;
 	uint32_t max_commands_in_queue;
+	uint32_t max_background_in_queue;
+	uint32_t foreground_burst;
+	// Foreground commands started from the delay queue since the last background command.
+	uint32_t foreground_run;
 	int max_commands_in_process;
 	int pending;
 	// Count of consecutive errors occurring before event loop registration.
@@ -135,6 +404,9 @@ typedef struct as_event_loop {
 	uint32_t errors;
 	bool using_delay_queue;
 	bool pipe_cb_calling;
+	bool pipe_cork;
+	// Not selected for new commands. Set by as_event_loop_drain().
+	bool draining;
 } as_event_loop;
 
 /******************************************************************************
@@ -145,6 +417,8 @@ AS_EXTERN extern as_event_loop* as_event_loops;
 AS_EXTERN extern as_event_loop* as_event_loop_current;
 AS_EXTERN extern uint32_t as_event_loop_size;
 AS_EXTERN extern bool as_event_single_thread;
+AS_EXTERN extern bool as_event_numa_routing;
+AS_EXTERN extern as_event_loop_selection as_event_selection;
 
 /******************************************************************************
  * PUBLIC FUNCTIONS
@@ -160,7 +434,17 @@ as_policy_event_init(as_policy_event* policy)
 {
 	policy->max_commands_in_process = 0;
 	policy->max_commands_in_queue = 0;
+	policy->max_background_in_queue = 0;
+	policy->foreground_burst = 8;
 	policy->queue_initial_capacity = 256;
+	policy->cpus = NULL;
+	policy->cpus_size = 0;
+	policy->numa_routing = false;
+	policy->loop_selection = AS_EVENT_LOOP_SELECTION_ROUND_ROBIN;
+	policy->lag_threshold_ms = 0;
+	policy->lag_listener = NULL;
+	policy->lag_udata = NULL;
+	policy->max_loops = 0;
 }
 
 /**
@@ -348,6 +632,55 @@ as_event_set_external_loop(void* loop);
 AS_EXTERN as_status
 as_set_external_event_loop(as_error* err, as_policy_event* policy, void* loop, as_event_loop** event_loop);
 
+/**
+ * Start another aerospike internal event loop after as_create_event_loops(). The new event loop
+ * is added to event loop selection immediately and its async connections are created by the
+ * next cluster tend. The number of event loops can not exceed as_policy_event.max_loops.
+ *
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		Event loop configuration.  Pass in NULL for default configuration.
+ * @param event_loop	Added event loop.  Pass in NULL if event loop does not need to be retrieved.
+ * @return AEROSPIKE_OK If successful. Otherwise an error.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN as_status
+as_event_add_loop(as_error* err, as_policy_event* policy, as_event_loop** event_loop);
+
+/**
+ * Stop selecting an event loop for new async commands. Commands already queued or in process
+ * on the event loop complete normally. Connections released by those commands and idle pooled
+ * connections are closed, so connection demand moves to the remaining event loops. Commands
+ * that explicitly pass this event loop still run on it.
+ *
+ * The last event loop that is not draining can not be drained.
+ *
+ * @param err			The as_error to be populated if an error occurs.
+ * @param event_loop	Event loop to drain.
+ * @return AEROSPIKE_OK If successful. Otherwise an error.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN as_status
+as_event_loop_drain(as_error* err, as_event_loop* event_loop);
+
+/**
+ * Select a drained event loop for new async commands again.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN void
+as_event_loop_resume(as_event_loop* event_loop);
+
+/**
+ * Return true if the event loop is draining and has no commands in process or queued.
+ * The value is approximate when called from a different thread than the event loop thread.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN bool
+as_event_loop_is_drained(as_event_loop* event_loop);
+
 /**
  * Find client's event loop abstraction given the external event loop.
  *
@@ -375,7 +708,29 @@ as_event_loop_get_by_index(uint32_t index)
 }
 
 /**
- * Retrieve a random event loop using round robin distribution.
+ * Retrieve an event loop on the NUMA node of the calling thread using round-robin
+ * distribution. Fall back to round-robin over all event loops if the node has no event loops.
+ * Called by as_event_loop_get() when as_policy_event.numa_routing is enabled.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN as_event_loop*
+as_event_loop_get_local(void);
+
+/**
+ * Retrieve the event loop with the fewest commands in process, in its delay queues or waiting
+ * to be registered. Ties are broken using round-robin distribution. Called by
+ * as_event_loop_get() when as_policy_event.loop_selection is not
+ * AS_EVENT_LOOP_SELECTION_ROUND_ROBIN.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN as_event_loop*
+as_event_loop_get_least_loaded(void);
+
+/**
+ * Retrieve an event loop using the distribution defined by as_policy_event.loop_selection.
+ * Round-robin distribution is used by default.
  *
  * @return			Client's generic event loop abstraction that is used in client async commands.
  *
@@ -384,6 +739,14 @@ as_event_loop_get_by_index(uint32_t index)
 static inline as_event_loop*
 as_event_loop_get(void)
 {
+	if (as_event_selection != AS_EVENT_LOOP_SELECTION_ROUND_ROBIN) {
+		return as_event_loop_get_least_loaded();
+	}
+
+	if (as_event_numa_routing) {
+		return as_event_loop_get_local();
+	}
+
 	// The last event loop points to the first event loop to create a circular linked list.
 	// Not atomic because doesn't need to be exactly accurate.
 	as_event_loop* event_loop = as_event_loop_current;
@@ -407,7 +770,7 @@ as_event_loop_get_process_size(as_event_loop* event_loop)
 
 /**
  * Return the approximate number of commands stored on this event loop's
- * delay queue that have not been started yet.  The value is approximate
+ * foreground and background delay queues that have not been started yet.  The value is approximate
  * because the call may be from a different thread than the event loop’s
  * thread and there are no locks or atomics used.
  *
@@ -416,7 +779,94 @@ as_event_loop_get_process_size(as_event_loop* event_loop)
 static inline uint32_t
 as_event_loop_get_queue_size(as_event_loop* event_loop)
 {
-	return as_queue_size(&event_loop->delay_queue);
+	return as_queue_size(&event_loop->delay_queue) + as_queue_size(&event_loop->background_queue);
+}
+
+/**
+ * Return the approximate number of functions and commands queued to this event loop by other
+ * threads that the event loop has not run yet.
+ *
+ * @ingroup async_events
+ */
+AS_EXTERN uint32_t
+as_event_loop_get_execute_size(as_event_loop* event_loop);
+
+/**
+ * Return the delay in microseconds between queueing the last monitor probe to this event loop
+ * and the event loop running it. Probes are queued by the cluster tend thread on each tend
+ * interval. A high lag indicates the event loop thread is saturated or blocked by user callbacks.
+ *
+ * @ingroup async_events
+ */
+static inline uint32_t
+as_event_loop_get_lag(as_event_loop* event_loop)
+{
+	return as_load_uint32(&event_loop->monitor.lag_us);
+}
+
+/**
+ * Return the maximum monitor probe lag in microseconds over the last window of probes.
+ *
+ * @ingroup async_events
+ */
+static inline uint32_t
+as_event_loop_get_lag_max(as_event_loop* event_loop)
+{
+	return as_load_uint32(&event_loop->monitor.lag_max_us);
+}
+
+/**
+ * Return the percentage of time the event loop thread was using cpu between the last two
+ * monitor probes.
+ *
+ * @ingroup async_events
+ */
+static inline uint32_t
+as_event_loop_get_busy_pct(as_event_loop* event_loop)
+{
+	return as_load_uint32(&event_loop->monitor.busy_pct);
+}
+
+/**
+ * Return the average number of completed commands per event loop iteration between the last
+ * two monitor probes. Zero is returned when the event library does not count iterations.
+ *
+ * @ingroup async_events
+ */
+static inline uint32_t
+as_event_loop_get_commands_per_iteration(as_event_loop* event_loop)
+{
+	return as_load_uint32(&event_loop->monitor.commands_per_iteration);
+}
+
+/**
+ * Return the approximate number of freed commands cached in this event loop's
+ * command pool.  The value is approximate because no lock is used.
+ *
+ * @ingroup async_events
+ */
+static inline uint32_t
+as_event_loop_get_cmd_pool_size(as_event_loop* event_loop)
+{
+	as_event_command_pool* pool = &event_loop->cmd_pool;
+	uint32_t size = 0;
+
+	for (uint32_t i = 0; i < AS_EVENT_COMMAND_POOL_CLASSES; i++) {
+		size += pool->free_size[i];
+	}
+	return size;
+}
+
+/**
+ * Return the maximum number of pooled commands that have been in use at the
+ * same time on this event loop.
+ *
+ * @ingroup async_events
+ */
+static inline uint32_t
+as_event_loop_get_cmd_pool_high_water(as_event_loop* event_loop)
+{
+	return event_loop->cmd_pool.high_water;
 }
 
 /**
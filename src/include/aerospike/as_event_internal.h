@@ -18,12 +18,17 @@
 
 #include <aerospike/as_admin.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_event_wheel.h>
+#include <aerospike/as_key.h>
 #include <aerospike/as_listener.h>
+#include <aerospike/as_mem_budget.h>
 #include <aerospike/as_queue.h>
 #include <aerospike/as_proto.h>
 #include <aerospike/as_socket.h>
+#include <aerospike/as_trace.h>
 #include <citrusleaf/cf_ll.h>
 #include <pthread.h>
+#include <string.h>
 
 #if defined(AS_USE_LIBEV)
 #include <ev.h>
@@ -32,6 +37,10 @@
 struct as_uv_tls;
 #elif defined(AS_USE_LIBEVENT)
 #include <event2/event.h>
+#elif defined(AS_USE_LIBURING)
+#include <liburing.h>
+#elif defined(AS_USE_IOCP)
+#include <winsock2.h>
 #else
 #endif
 
@@ -56,6 +65,9 @@ extern "C" {
 #define AS_ASYNC_STATE_COMMAND_READ_BODY 10
 #define AS_ASYNC_STATE_QUEUE_ERROR 11
 #define AS_ASYNC_STATE_RETRY 12
+#define AS_ASYNC_STATE_HEDGE 13
+#define AS_ASYNC_STATE_PAUSED 14
+#define AS_ASYNC_STATE_OFFLOAD 15
 
 #define AS_ASYNC_FLAGS_DESERIALIZE 1
 #define AS_ASYNC_FLAGS_READ 2
@@ -66,6 +78,11 @@ extern "C" {
 #define AS_ASYNC_FLAGS_LINEARIZE 64
 #define AS_ASYNC_FLAGS_HEAP_REC 128
 
+#define AS_ASYNC_HEDGE_NONE 0
+#define AS_ASYNC_HEDGE_ORIGINAL 1
+#define AS_ASYNC_HEDGE_DUPLICATE 2
+#define AS_ASYNC_HEDGE_WON 3
+
 #define AS_ASYNC_AUTH_RETURN_CODE 1
 
 #define AS_EVENT_CONNECTION_COMPLETE 0
@@ -73,11 +90,24 @@ extern "C" {
 #define AS_EVENT_CONNECTION_ERROR 2
 
 #define AS_EVENT_QUEUE_INITIAL_CAPACITY 256
+
+// Submission ring capacity. Must be a power of 2.
+#define AS_EVENT_RING_CAPACITY 1024
 	
 struct as_event_command;
 struct as_event_executor;
 
-typedef struct {
+#if defined(AS_USE_IOCP)
+typedef struct as_iocp_op {
+	// Must be first, so completed overlapped pointers can be cast to the operation.
+	OVERLAPPED ov;
+	struct as_event_connection_s* conn;
+	uint8_t type;
+	bool pending;
+} as_iocp_op;
+#endif
+
+typedef struct as_event_connection_s {
 #if defined(AS_USE_LIBEV)
 	struct ev_io watcher;
 	as_socket socket;
@@ -93,10 +123,55 @@ typedef struct {
 #elif defined(AS_USE_LIBEVENT)
 	struct event watcher;
 	as_socket socket;
+#elif defined(AS_USE_LIBURING)
+	as_socket socket;
+	as_event_loop* event_loop;
+	// Received bytes not yet consumed by a command.
+	struct as_uring_chunk* chunks;
+	uint32_t chunk_head;
+	uint32_t chunk_size;
+	uint32_t chunk_capacity;
+	// Submitted operations not yet completed, plus one while a completion is dispatched.
+	// Connection memory is released when this count reaches zero after close.
+	uint32_t inflight;
+	// Connection owned receive buffer used when the loop buffer ring is exhausted.
+	uint8_t* fallback;
+	// Connection owned send buffer, so a command can be released while its send is pending.
+	uint8_t* send_buf;
+	uint32_t send_capacity;
+	uint32_t poll_mask;
+	int32_t rx_error;
+	int32_t tx_error;
+	uint8_t recv_state;
+	bool send_pending;
+	bool poll_pending;
+	bool starved;
+	bool closed;
+#elif defined(AS_USE_IOCP)
+	as_socket socket;
+	as_event_loop* event_loop;
+	// At most one receive and one connect/send operation is pending at a time.
+	as_iocp_op recv_op;
+	as_iocp_op send_op;
+	// Received bytes not yet consumed by a command are between recv_head and recv_tail.
+	uint8_t* recv_buf;
+	uint32_t recv_head;
+	uint32_t recv_tail;
+	// Connection owned send buffer, so a command can be released while its send is pending.
+	uint8_t* send_buf;
+	uint32_t send_capacity;
+	// Pending operations. Connection memory is released when this count reaches zero after close.
+	uint32_t inflight;
+	int32_t rx_error;
+	int32_t tx_error;
+	bool closed;
 #else
 #endif
 	int watching;
 	bool pipeline;
+	// Corked pipeline connection list links. Only valid for pipeline connections.
+	struct as_event_connection_s* cork_next;
+	struct as_event_connection_s** cork_prev;
 } as_event_connection;
 
 typedef struct {
@@ -113,19 +188,47 @@ typedef void (*as_event_executable) (as_event_loop* event_loop, void* udata);
 typedef bool (*as_event_parse_results_fn) (struct as_event_command* cmd);
 typedef void (*as_event_executor_complete_fn) (struct as_event_executor* executor);
 
+#if defined(AS_USE_LIBURING)
+typedef struct as_uring_chunk {
+	uint8_t* data;
+	uint32_t len;
+	uint16_t bid;
+} as_uring_chunk;
+
+typedef struct as_uring_timer {
+	void* data;
+	uint64_t deadline;
+	uint64_t repeat;
+	uint32_t index; // Heap index. Zero if timer is not active.
+	uint32_t pass;
+} as_uring_timer;
+#elif defined(AS_USE_IOCP)
+typedef struct as_iocp_timer {
+	void* data;
+	uint64_t deadline;
+	uint64_t repeat;
+	uint32_t index; // Heap index. Zero if timer is not active.
+	uint32_t pass;
+} as_iocp_timer;
+#endif
+
 typedef struct as_event_command {
-#if defined(AS_USE_LIBEV)
-	struct ev_timer timer;
-#elif defined(AS_USE_LIBUV)
-	uv_timer_t timer;
-#elif defined(AS_USE_LIBEVENT)
-	struct event timer;
+#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT)
+	as_event_wheel_timer timer;
+#elif defined(AS_USE_LIBURING)
+	as_uring_timer timer;
+#elif defined(AS_USE_IOCP)
+	as_iocp_timer timer;
 #else
 #endif
 	uint64_t total_deadline;
 	uint32_t socket_timeout;
+	uint32_t policy_socket_timeout; // Only valid when adaptive_timeout_pct is set.
+	uint32_t adaptive_timeout_pct; // Zero if adaptive socket timeouts are disabled.
+	uint32_t adaptive_timeout_min;
 	uint32_t max_retries;
 	uint32_t iteration;
+	uint32_t start_delay; // Only valid while a delayed command waits for its first attempt.
 	as_policy_replica replica;
 	as_event_loop* event_loop;
 	as_event_state* event_state;
@@ -142,6 +245,9 @@ typedef struct as_event_command {
 	
 	uint8_t* buf;
 	uint64_t begin; // Used for metrics
+	uint64_t trace_id; // Zero if command is not traced.
+	uint64_t slow_begin; // Zero if slow command log is disabled.
+	uint32_t partition_id; // Only valid when partition is set.
 	uint32_t command_sent_counter;
 	uint32_t write_offset;
 	uint32_t write_len;
@@ -157,13 +263,30 @@ typedef struct as_event_command {
 	uint8_t replica_size;
 	uint8_t replica_index;
 	uint8_t replica_index_sc; // Used in batch only.
+	uint8_t pool_class; // Command pool size class + 1, 0 if not pooled or AS_EVENT_COMMAND_POOL_CUSTOM.
+	uint8_t priority; // as_policy_priority
+	uint8_t latency_tag;
+	bool limited; // Attempt is counted by the node's concurrency limit.
+	bool heat_sample; // Attempt latency is sampled by the partition heatmap.
+	uint8_t hedge; // AS_ASYNC_HEDGE_*. Batch commands of a hedged batch are linked by hedge_next.
 
 	struct as_txn* txn;
+	struct as_async_cancel_s* cancel; // Set when command can be aborted by as_async_cancel_abort().
+	struct as_event_command* cancel_prev;
+	struct as_event_command* cancel_next;
+	uint8_t cancel_state;
 	uint8_t* ubuf; // Uncompressed send buffer. Used when compression is enabled.
 	uint32_t ubuf_size;
+	uint32_t budget_size; // Bytes charged to the cluster memory budget.
 	uint32_t bytes_in;
 	uint32_t bytes_out;
 	as_latency_type latency_type;
+	uint64_t order_hash; // Key ordering hash. Zero if command is not ordered.
+	struct as_event_command* order_link; // Next in-flight ordered command in the same bucket.
+	struct as_event_command* order_next; // Next command waiting on the same key.
+	struct as_event_command* order_tail; // Last command waiting on the same key.
+	struct as_event_command* hedge_prev; // Only valid when hedge is set.
+	struct as_event_command* hedge_next; // Only valid when hedge is set.
 } as_event_command;
 
 typedef struct {
@@ -171,6 +294,22 @@ typedef struct {
 	void* udata;
 } as_event_commander;
 
+typedef struct {
+	uint64_t seq;
+	as_event_commander cmd;
+} as_event_ring_cell;
+
+// Bounded multi-producer, single-consumer queue of commands sent to an event loop from other
+// threads. Producer fields are kept on a separate cache line from the consumer position.
+typedef struct as_event_ring_s {
+	uint64_t head;
+	uint32_t wakeup;
+	uint32_t overflow;
+	uint8_t pad[48];
+	uint64_t tail;
+	as_event_ring_cell cells[];
+} as_event_ring;
+
 typedef struct as_event_executor {
 	pthread_mutex_t lock;
 	struct as_event_command** commands;
@@ -179,25 +318,74 @@ typedef struct as_event_executor {
 	void* udata;
 	as_error* err;
 	char* ns;
+	struct as_async_flow_s* flow;
+	struct as_event_command** paused; // Commands paused by flow. Allocated on first pause.
 	uint64_t cluster_key;
+	uint64_t adapt_begin; // Start of current adaptive concurrency window.
+	uint64_t adapt_rate;  // Completions per second in the previous window.
+	uint32_t adapt_count; // Completions in the current window.
 	uint32_t max_concurrent;
 	uint32_t max;
 	uint32_t count;
 	uint32_t queued;
+	uint32_t n_paused;
 	bool notify;
 	bool valid;
+	bool adaptive;
+	bool spread; // Commands run on other event loops. complete_fn is queued to event_loop.
 } as_event_executor;
 
 //---------------------------------
 // Common Functions
 //---------------------------------
 
+bool
+as_event_thread_create(as_event_loop* event_loop, void* (*worker)(void*), void* udata);
+
+void
+as_event_thread_assign_cpu(as_event_loop* event_loop);
+
+/**
+ * Queue function for execution in the event loop thread. Set wakeup to true when the event
+ * loop must be signaled. Only the first command queued after the event loop starts
+ * processing its queue requests a wakeup.
+ */
+bool
+as_event_queue_push(
+	as_event_loop* event_loop, as_event_executable executable, void* udata, bool* wakeup
+	);
+
+/**
+ * Run commands queued before this call. Must be called from the event loop thread when it
+ * is signaled. Return false if the stop signal was received.
+ */
+bool
+as_event_queue_run(as_event_loop* event_loop);
+
 as_status
 as_event_command_execute(as_event_command* cmd, as_error* err);
 
+/**
+ * Execute command after delay_ms. The total timeout starts when the delay expires.
+ */
+as_status
+as_event_command_execute_delay(as_event_command* cmd, uint32_t delay_ms, as_error* err);
+
 void
 as_event_command_schedule(as_event_command* cmd);
 
+bool
+as_event_command_pause(as_event_command* cmd);
+
+/**
+ * Hand the fully read response block to the cluster thread pool when the block size is at
+ * least cluster->offload_threshold. Return true if the block was handed off. Reading resumes
+ * in the event loop thread after the block has been processed. The caller must not touch
+ * the command again when true is returned.
+ */
+bool
+as_event_offload(as_event_command* cmd);
+
 void
 as_event_connection_complete(as_event_command* cmd);
 
@@ -246,6 +434,13 @@ as_event_executor_cancel(as_event_executor* executor, uint32_t queued_count);
 void
 as_event_executor_complete(as_event_executor* executor);
 
+/**
+ * Set number of commands that run at once. If adaptive, start with a low concurrency and
+ * adjust it up to max_concurrent as commands complete.
+ */
+void
+as_event_executor_set_concurrency(as_event_executor* executor, uint32_t max_concurrent, bool adaptive);
+
 void
 as_event_error_callback(as_event_command* cmd, as_error* err);
 
@@ -276,6 +471,27 @@ as_event_command_parse_deadline(as_event_command* cmd);
 bool
 as_event_command_parse_info(as_event_command* cmd);
 
+bool
+as_event_command_parse_info_multi(as_event_command* cmd);
+
+as_status
+as_event_command_execute_hedge(as_event_command* cmd, uint32_t hedge_delay, as_error* err);
+
+void
+as_event_command_cancel(as_event_command* cmd);
+
+void
+as_batch_hedge_unlink(as_event_command* cmd);
+
+as_event_command*
+as_event_command_alloc(as_cluster* cluster, as_event_loop* event_loop, size_t* size);
+
+void
+as_event_command_dealloc(as_event_command* cmd);
+
+void
+as_event_command_pool_destroy(as_event_command_pool* pool);
+
 void
 as_event_command_free(as_event_command* cmd);
 
@@ -288,6 +504,13 @@ as_event_create_connections(as_node* node, as_async_conn_pool* pools);
 void
 as_event_close_cluster(as_cluster* cluster);
 
+/**
+ * Queue a monitor probe to each event loop that does not already have a probe outstanding.
+ * Probe delay, busy ratio and commands per iteration are measured when the probe runs.
+ */
+void
+as_event_monitor_probe(void);
+
 //----------------------------------
 // Implementation Specific Functions
 //----------------------------------
@@ -298,6 +521,13 @@ as_event_create_loop(as_event_loop* event_loop);
 void
 as_event_register_external_loop(as_event_loop* event_loop);
 
+/**
+ * Return number of event loop iterations or zero if the event library does not count
+ * iterations. Must be called in the event loop thread.
+ */
+uint64_t
+as_event_loop_iterations(as_event_loop* event_loop);
+
 /**
  * Schedule execution of function on specified event loop.
  * Command is placed on event loop queue and is never executed directly.
@@ -308,21 +538,34 @@ as_event_execute(as_event_loop* event_loop, as_event_executable executable, void
 void
 as_event_command_write_start(as_event_command* cmd);
 
+void
+as_event_command_resume_read(as_event_command* cmd);
+
 void
 as_event_connect(as_event_command* cmd, as_async_conn_pool* pool);
 
 void
 as_event_node_destroy(as_node* node);
 
+static inline void
+as_event_cork_unlink(as_event_connection* conn)
+{
+	if (conn->pipeline && conn->cork_prev) {
+		*conn->cork_prev = conn->cork_next;
+
+		if (conn->cork_next) {
+			conn->cork_next->cork_prev = conn->cork_prev;
+		}
+		conn->cork_prev = NULL;
+	}
+}
+
 //----------------------------------
 // Libev Inline Functions
 //----------------------------------
 
 #if defined(AS_USE_LIBEV)
 
-void as_ev_timer_cb(struct ev_loop* loop, ev_timer* timer, int revents);
-void as_ev_repeat_cb(struct ev_loop* loop, ev_timer* timer, int revents);
-
 static inline bool
 as_event_conn_current_trim(as_event_connection* conn, uint64_t max_socket_idle_ns)
 {
@@ -341,9 +584,16 @@ as_event_conn_validate(as_event_connection* conn)
 	return as_socket_validate_fd(conn->socket.fd);
 }
 
+static inline as_socket_fd
+as_event_conn_fd(as_event_connection* conn)
+{
+	return conn->socket.fd;
+}
+
 static inline void
 as_event_close_connection(as_event_connection* conn)
 {
+	as_event_cork_unlink(conn);
 	as_socket_close(&conn->socket);
 	cf_free(conn);
 }
@@ -351,39 +601,44 @@ as_event_close_connection(as_event_connection* conn)
 static inline void
 as_event_set_conn_last_used(as_event_connection* conn)
 {
-	conn->socket.last_used = cf_getns();
+	conn->socket.last_used = as_clock_getns();
 }
 
 static inline void
 as_event_timer_once(as_event_command* cmd, uint64_t timeout)
 {
-	ev_timer_init(&cmd->timer, as_ev_timer_cb, (double)timeout / 1000.0, 0.0);
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.link.next = NULL;
+	}
 	cmd->timer.data = cmd;
-	ev_timer_start(cmd->event_loop->loop, &cmd->timer);
+	as_event_wheel_start(cmd->event_loop, &cmd->timer, timeout, 0);
 	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER;
 }
 
 static inline void
 as_event_timer_repeat(as_event_command* cmd, uint64_t repeat)
 {
-	ev_init(&cmd->timer, as_ev_repeat_cb);
-	cmd->timer.repeat = (double)repeat / 1000.0;
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.link.next = NULL;
+	}
 	cmd->timer.data = cmd;
-	ev_timer_again(cmd->event_loop->loop, &cmd->timer);
+	as_event_wheel_start(cmd->event_loop, &cmd->timer, repeat, repeat);
 	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
 }
 
 static inline void
 as_event_timer_again(as_event_command* cmd)
 {
-	ev_timer_again(cmd->event_loop->loop, &cmd->timer);
+	as_event_wheel_again(cmd->event_loop, &cmd->timer);
 }
 
 static inline void
 as_event_timer_stop(as_event_command* cmd)
 {
 	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
-		ev_timer_stop(cmd->event_loop->loop, &cmd->timer);
+		as_event_wheel_stop(cmd->event_loop, &cmd->timer);
 	}
 }
 
@@ -412,8 +667,6 @@ as_event_command_release(as_event_command* cmd)
 
 #elif defined(AS_USE_LIBUV)
 
-void as_uv_timer_cb(uv_timer_t* timer);
-void as_uv_repeat_cb(uv_timer_t* timer);
 void as_event_close_connection(as_event_connection* conn);
 
 static inline bool
@@ -440,45 +693,58 @@ as_event_conn_validate(as_event_connection* conn)
 	return -1;
 }
 
+static inline as_socket_fd
+as_event_conn_fd(as_event_connection* conn)
+{
+	uv_os_fd_t fd;
+
+	if (uv_fileno((uv_handle_t*)&conn->socket, &fd) == 0) {
+		return (as_socket_fd)fd;
+	}
+	return (as_socket_fd)-1;
+}
+
 static inline void
 as_event_set_conn_last_used(as_event_connection* conn)
 {
-	conn->last_used = cf_getns();
+	conn->last_used = as_clock_getns();
 }
 
 static inline void
 as_event_timer_once(as_event_command* cmd, uint64_t timeout)
 {
-	if (!(cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
-		uv_timer_init(cmd->event_loop->loop, &cmd->timer);
-		cmd->timer.data = cmd;
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.link.next = NULL;
 	}
-	uv_timer_start(&cmd->timer, as_uv_timer_cb, timeout, 0);
+	cmd->timer.data = cmd;
+	as_event_wheel_start(cmd->event_loop, &cmd->timer, timeout, 0);
 	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER;
 }
 
 static inline void
 as_event_timer_repeat(as_event_command* cmd, uint64_t repeat)
 {
-	if (!(cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
-		uv_timer_init(cmd->event_loop->loop, &cmd->timer);
-		cmd->timer.data = cmd;
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.link.next = NULL;
 	}
-	uv_timer_start(&cmd->timer, as_uv_repeat_cb, repeat, repeat);
+	cmd->timer.data = cmd;
+	as_event_wheel_start(cmd->event_loop, &cmd->timer, repeat, repeat);
 	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
 }
 
 static inline void
 as_event_timer_again(as_event_command* cmd)
 {
-	// libuv socket timers automatically repeat.
+	as_event_wheel_again(cmd->event_loop, &cmd->timer);
 }
 
 static inline void
 as_event_timer_stop(as_event_command* cmd)
 {
 	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
-		uv_timer_stop(&cmd->timer);
+		as_event_wheel_stop(cmd->event_loop, &cmd->timer);
 	}
 }
 
@@ -497,19 +763,12 @@ as_event_stop_read(as_event_connection* conn)
 	uv_read_stop((uv_stream_t*)conn);
 }
 
-void
-as_uv_timer_closed(uv_handle_t* handle);
-
 static inline void
 as_event_command_release(as_event_command* cmd)
 {
-	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
-		// libuv requires that cmd can't be freed until timer is closed.
-		uv_close((uv_handle_t*)&cmd->timer, as_uv_timer_closed);
-	}
-	else {
-		as_event_command_free(cmd);
-	}
+	// Wheel timers do not hold event library handles, so the command can be freed now.
+	as_event_timer_stop(cmd);
+	as_event_command_free(cmd);
 }
 
 //----------------------------------
@@ -518,8 +777,6 @@ as_event_command_release(as_event_command* cmd)
 
 #elif defined(AS_USE_LIBEVENT)
 
-void as_libevent_timer_cb(evutil_socket_t sock, short events, void* udata);
-void as_libevent_repeat_cb(evutil_socket_t sock, short events, void* udata);
 
 static inline bool
 as_event_conn_current_trim(as_event_connection* conn, uint64_t max_socket_idle_ns)
@@ -539,9 +796,16 @@ as_event_conn_validate(as_event_connection* conn)
 	return as_socket_validate_fd(conn->socket.fd);
 }
 
+static inline as_socket_fd
+as_event_conn_fd(as_event_connection* conn)
+{
+	return conn->socket.fd;
+}
+
 static inline void
 as_event_close_connection(as_event_connection* conn)
 {
+	as_event_cork_unlink(conn);
 	as_socket_close(&conn->socket);
 	cf_free(conn);
 }
@@ -549,42 +813,44 @@ as_event_close_connection(as_event_connection* conn)
 static inline void
 as_event_set_conn_last_used(as_event_connection* conn)
 {
-	conn->socket.last_used = cf_getns();
+	conn->socket.last_used = as_clock_getns();
 }
 
 static inline void
 as_event_timer_once(as_event_command* cmd, uint64_t timeout)
 {
-	evtimer_assign(&cmd->timer, cmd->event_loop->loop, as_libevent_timer_cb, cmd);
-	struct timeval tv;
-	tv.tv_sec = (uint32_t)timeout / 1000;
-	tv.tv_usec = ((uint32_t)timeout % 1000) * 1000;
-	evtimer_add(&cmd->timer, &tv);
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.link.next = NULL;
+	}
+	cmd->timer.data = cmd;
+	as_event_wheel_start(cmd->event_loop, &cmd->timer, timeout, 0);
 	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER;
 }
 
 static inline void
 as_event_timer_repeat(as_event_command* cmd, uint64_t repeat)
 {
-	event_assign(&cmd->timer, cmd->event_loop->loop, -1, EV_PERSIST, as_libevent_repeat_cb, cmd);
-	struct timeval tv;
-	tv.tv_sec = (uint32_t)repeat / 1000;
-	tv.tv_usec = ((uint32_t)repeat % 1000) * 1000;
-	evtimer_add(&cmd->timer, &tv);
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.link.next = NULL;
+	}
+	cmd->timer.data = cmd;
+	as_event_wheel_start(cmd->event_loop, &cmd->timer, repeat, repeat);
 	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
 }
 
 static inline void
 as_event_timer_again(as_event_command* cmd)
 {
-	// libevent socket timers automatically repeat.
+	as_event_wheel_again(cmd->event_loop, &cmd->timer);
 }
 
 static inline void
 as_event_timer_stop(as_event_command* cmd)
 {
 	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
-		evtimer_del(&cmd->timer);
+		as_event_wheel_stop(cmd->event_loop, &cmd->timer);
 	}
 }
 
@@ -607,6 +873,204 @@ as_event_command_release(as_event_command* cmd)
 	as_event_command_free(cmd);
 }
 
+//----------------------------------
+// Liburing Inline Functions
+//----------------------------------
+
+#elif defined(AS_USE_LIBURING)
+
+void as_uring_timer_start(as_event_loop* event_loop, as_uring_timer* timer, uint64_t timeout, uint64_t repeat);
+void as_uring_timer_again(as_event_loop* event_loop, as_uring_timer* timer);
+void as_uring_timer_stop(as_event_loop* event_loop, as_uring_timer* timer);
+void as_uring_stop_watcher(as_event_connection* conn);
+int as_uring_conn_validate(as_event_connection* conn);
+void as_event_close_connection(as_event_connection* conn);
+
+static inline bool
+as_event_conn_current_trim(as_event_connection* conn, uint64_t max_socket_idle_ns)
+{
+	return as_socket_current_trim(conn->socket.last_used, max_socket_idle_ns);
+}
+
+static inline bool
+as_event_conn_current_tran(as_event_connection* conn, uint64_t max_socket_idle_ns)
+{
+	return as_socket_current_tran(conn->socket.last_used, max_socket_idle_ns);
+}
+
+static inline int
+as_event_conn_validate(as_event_connection* conn)
+{
+	return as_uring_conn_validate(conn);
+}
+
+static inline as_socket_fd
+as_event_conn_fd(as_event_connection* conn)
+{
+	return conn->socket.fd;
+}
+
+static inline void
+as_event_set_conn_last_used(as_event_connection* conn)
+{
+	conn->socket.last_used = as_clock_getns();
+}
+
+static inline void
+as_event_timer_once(as_event_command* cmd, uint64_t timeout)
+{
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.index = 0;
+	}
+	cmd->timer.data = cmd;
+	as_uring_timer_start(cmd->event_loop, &cmd->timer, timeout, 0);
+	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER;
+}
+
+static inline void
+as_event_timer_repeat(as_event_command* cmd, uint64_t repeat)
+{
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.index = 0;
+	}
+	cmd->timer.data = cmd;
+	as_uring_timer_start(cmd->event_loop, &cmd->timer, repeat, repeat);
+	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
+}
+
+static inline void
+as_event_timer_again(as_event_command* cmd)
+{
+	as_uring_timer_again(cmd->event_loop, &cmd->timer);
+}
+
+static inline void
+as_event_timer_stop(as_event_command* cmd)
+{
+	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
+		as_uring_timer_stop(cmd->event_loop, &cmd->timer);
+	}
+}
+
+static inline void
+as_event_stop_watcher(as_event_command* cmd, as_event_connection* conn)
+{
+	as_uring_stop_watcher(conn);
+}
+
+static inline void
+as_event_stop_read(as_event_connection* conn)
+{
+	// This method only needed for libuv pipelined connections.
+}
+
+static inline void
+as_event_command_release(as_event_command* cmd)
+{
+	as_event_command_free(cmd);
+}
+
+//----------------------------------
+// IOCP Inline Functions
+//----------------------------------
+
+#elif defined(AS_USE_IOCP)
+
+void as_iocp_timer_start(as_event_loop* event_loop, as_iocp_timer* timer, uint64_t timeout, uint64_t repeat);
+void as_iocp_timer_again(as_event_loop* event_loop, as_iocp_timer* timer);
+void as_iocp_timer_stop(as_event_loop* event_loop, as_iocp_timer* timer);
+void as_iocp_stop_watcher(as_event_connection* conn);
+int as_iocp_conn_validate(as_event_connection* conn);
+void as_event_close_connection(as_event_connection* conn);
+
+static inline bool
+as_event_conn_current_trim(as_event_connection* conn, uint64_t max_socket_idle_ns)
+{
+	return as_socket_current_trim(conn->socket.last_used, max_socket_idle_ns);
+}
+
+static inline bool
+as_event_conn_current_tran(as_event_connection* conn, uint64_t max_socket_idle_ns)
+{
+	return as_socket_current_tran(conn->socket.last_used, max_socket_idle_ns);
+}
+
+static inline int
+as_event_conn_validate(as_event_connection* conn)
+{
+	return as_iocp_conn_validate(conn);
+}
+
+static inline as_socket_fd
+as_event_conn_fd(as_event_connection* conn)
+{
+	return conn->socket.fd;
+}
+
+static inline void
+as_event_set_conn_last_used(as_event_connection* conn)
+{
+	conn->socket.last_used = as_clock_getns();
+}
+
+static inline void
+as_event_timer_once(as_event_command* cmd, uint64_t timeout)
+{
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.index = 0;
+	}
+	cmd->timer.data = cmd;
+	as_iocp_timer_start(cmd->event_loop, &cmd->timer, timeout, 0);
+	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER;
+}
+
+static inline void
+as_event_timer_repeat(as_event_command* cmd, uint64_t repeat)
+{
+	if (! (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER)) {
+		// Command memory is not zeroed.
+		cmd->timer.index = 0;
+	}
+	cmd->timer.data = cmd;
+	as_iocp_timer_start(cmd->event_loop, &cmd->timer, repeat, repeat);
+	cmd->flags |= AS_ASYNC_FLAGS_HAS_TIMER | AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
+}
+
+static inline void
+as_event_timer_again(as_event_command* cmd)
+{
+	as_iocp_timer_again(cmd->event_loop, &cmd->timer);
+}
+
+static inline void
+as_event_timer_stop(as_event_command* cmd)
+{
+	if (cmd->flags & AS_ASYNC_FLAGS_HAS_TIMER) {
+		as_iocp_timer_stop(cmd->event_loop, &cmd->timer);
+	}
+}
+
+static inline void
+as_event_stop_watcher(as_event_command* cmd, as_event_connection* conn)
+{
+	as_iocp_stop_watcher(conn);
+}
+
+static inline void
+as_event_stop_read(as_event_connection* conn)
+{
+	// This method only needed for libuv pipelined connections.
+}
+
+static inline void
+as_event_command_release(as_event_command* cmd)
+{
+	as_event_command_free(cmd);
+}
+
 //---------------------------------------
 // EVENT_LIB Not Defined Inline Functions
 //---------------------------------------
@@ -631,6 +1095,12 @@ as_event_conn_validate(as_event_connection* conn)
 	return -1;
 }
 
+static inline as_socket_fd
+as_event_conn_fd(as_event_connection* conn)
+{
+	return (as_socket_fd)-1;
+}
+
 static inline void
 as_event_close_connection(as_event_connection* conn)
 {
@@ -685,10 +1155,70 @@ as_event_command_release(as_event_command* cmd)
 static inline as_event_loop*
 as_event_assign(as_event_loop* event_loop)
 {
-	// Assign event loop using round robin distribution if not specified.
+	// Assign event loop using as_policy_event.loop_selection if not specified.
 	return event_loop ? event_loop : as_event_loop_get();
 }
 
+static inline as_event_loop*
+as_event_assign_node(as_event_loop* event_loop, as_node* node)
+{
+	if (event_loop) {
+		return event_loop;
+	}
+
+	if (as_event_selection == AS_EVENT_LOOP_SELECTION_NODE_AFFINITY && node) {
+		return &as_event_loops[node->event_loop_seq % as_event_loop_size];
+	}
+	return as_event_loop_get();
+}
+
+static inline as_event_loop*
+as_event_assign_partition(
+	as_event_loop* event_loop, as_cluster* cluster, const char* ns, void* partition,
+	uint8_t replica_size
+	)
+{
+	if (event_loop) {
+		return event_loop;
+	}
+
+	if (as_event_selection == AS_EVENT_LOOP_SELECTION_NODE_AFFINITY) {
+		// The node is only used to select the event loop. The command resolves its node
+		// again when it starts.
+		uint8_t replica_index = 0;
+		as_node* node = as_partition_get_node(cluster, ns, partition, NULL,
+			AS_POLICY_REPLICA_MASTER, replica_size, &replica_index);
+
+		if (node) {
+			return &as_event_loops[node->event_loop_seq % as_event_loop_size];
+		}
+	}
+	return as_event_loop_get();
+}
+
+/**
+ * Choose event loop for an ordered command. Commands on the same partition share an event
+ * loop, so commands on the same key are ordered regardless of the submitting thread.
+ */
+static inline as_event_loop*
+as_event_assign_ordered(as_event_loop* event_loop, uint32_t partition_id)
+{
+	if (event_loop) {
+		return event_loop;
+	}
+	return &as_event_loops[partition_id % as_event_loop_size];
+}
+
+static inline void
+as_event_command_set_order(as_event_command* cmd, const as_key* key)
+{
+	uint64_t hash;
+	memcpy(&hash, key->digest.value, sizeof(hash));
+
+	// Zero is reserved for unordered commands.
+	cmd->order_hash = hash ? hash : 1;
+}
+
 static inline void
 as_event_set_auth_write(as_event_command* cmd, as_session* session)
 {
@@ -739,6 +1269,10 @@ as_async_conn_pool_init(as_async_conn_pool* pool, uint32_t min_size, uint32_t ma
 	pool->limit = max_size;
 	pool->opened = 0;
 	pool->closed = 0;
+	pool->in_flight = 0;
+	pool->max_depth = 0;
+	pool->borrowed = 0;
+	as_conn_window_init(&pool->window);
 }
 
 static inline bool
@@ -814,6 +1348,16 @@ as_event_connection_timeout(as_event_command* cmd, as_async_conn_pool* pool)
 	}
 }
 
+static inline void
+as_event_command_trace(as_event_command* cmd, as_trace_point point, as_status status)
+{
+	if (cmd->trace_id) {
+		uint32_t partition_id = cmd->partition ? cmd->partition_id : AS_TRACE_NO_PARTITION;
+		as_trace_emit(cmd->cluster, cmd->trace_id, point, cmd->node, cmd->ns, partition_id,
+			cmd->iteration, status, true);
+	}
+}
+
 static inline uint8_t*
 as_event_get_ubuf(as_event_command* cmd)
 {
@@ -826,7 +1370,14 @@ static inline void
 as_event_command_destroy(as_event_command* cmd)
 {
 	// Use this function to free async commands that were never started.
+	if (cmd->type == AS_ASYNC_TYPE_BATCH && cmd->hedge) {
+		as_batch_hedge_unlink(cmd);
+	}
+
 	if (cmd->node) {
+		if (cmd->limited) {
+			as_node_limit_release(cmd->node);
+		}
 		as_node_release(cmd->node);
 	}
 
@@ -834,15 +1385,63 @@ as_event_command_destroy(as_event_command* cmd)
 		cf_free(cmd->ubuf);
 	}
 
-	cf_free(cmd);
+	if (cmd->budget_size) {
+		as_mem_budget_release(cmd->cluster->mem_budget, cmd->budget_size);
+	}
+
+	as_event_command_dealloc(cmd);
+}
+
+static inline void
+as_event_command_budget_charge(as_event_command* cmd, uint32_t size)
+{
+	as_mem_budget* budget = cmd->cluster->mem_budget;
+
+	if (budget) {
+		as_mem_budget_charge(budget, size);
+		cmd->budget_size += size;
+	}
+}
+
+static inline void
+as_event_command_budget_uncharge(as_event_command* cmd, uint32_t size)
+{
+	as_mem_budget* budget = cmd->cluster->mem_budget;
+
+	if (budget) {
+		as_mem_budget_release(budget, size);
+		cmd->budget_size -= size;
+	}
+}
+
+static inline void
+as_event_command_reserve_read(as_event_command* cmd)
+{
+	// Grow read buffer to hold cmd->len bytes. Heap read buffers are charged to the cluster
+	// memory budget until they are replaced or the command is freed.
+	if (cmd->len > cmd->read_capacity) {
+		if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
+			cf_free(cmd->buf);
+			as_event_command_budget_uncharge(cmd, cmd->read_capacity);
+		}
+		cmd->buf = cf_malloc(cmd->len);
+		cmd->read_capacity = cmd->len;
+		cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
+		as_event_command_budget_charge(cmd, cmd->len);
+	}
 }
 
 static inline void
 as_event_loop_destroy(as_event_loop* event_loop)
 {
+	cf_free(event_loop->ring);
+	cf_free(event_loop->wheel);
 	as_queue_destroy(&event_loop->queue);
 	as_queue_destroy(&event_loop->delay_queue);
+	as_queue_destroy(&event_loop->background_queue);
 	as_queue_destroy(&event_loop->pipe_cb_queue);
+	as_event_command_pool_destroy(&event_loop->cmd_pool);
+	cf_free(event_loop->decompress_buf);
 	pthread_mutex_destroy(&event_loop->lock);
 }
 
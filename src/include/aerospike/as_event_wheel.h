@@ -0,0 +1,132 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_EVENT_WHEEL_BITS 8
+#define AS_EVENT_WHEEL_SLOTS (1 << AS_EVENT_WHEEL_BITS)
+#define AS_EVENT_WHEEL_LEVELS 4
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_event_loop;
+
+/**
+ * @private
+ * Doubly linked timer list node. Wheel slots are list heads.
+ */
+typedef struct as_event_wheel_link_s {
+	struct as_event_wheel_link_s* next;
+	struct as_event_wheel_link_s* prev;
+} as_event_wheel_link;
+
+/**
+ * @private
+ * Command timer that is tracked by its event loop's timer wheel.
+ */
+typedef struct as_event_wheel_timer_s {
+	as_event_wheel_link link; // Must be first field. link.next is NULL if timer is not active.
+	void* data;
+	uint64_t deadline; // Millisecond tick.
+	uint64_t repeat;   // Zero if timer does not repeat.
+} as_event_wheel_timer;
+
+/**
+ * @private
+ * Hierarchical timer wheel with millisecond ticks. There is one wheel per event loop and a
+ * single backend timer drives it while any command timer is active, so starting and
+ * stopping command timers never touches the event library.
+ */
+typedef struct as_event_wheel_s {
+	as_event_wheel_link slots[AS_EVENT_WHEEL_LEVELS][AS_EVENT_WHEEL_SLOTS];
+	uint64_t now;
+	uint32_t size;
+	bool ticking;
+} as_event_wheel;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create timer wheel.
+ */
+as_event_wheel*
+as_event_wheel_create(void);
+
+/**
+ * @private
+ * Start timer. Active timers are rescheduled.
+ */
+void
+as_event_wheel_start(
+	struct as_event_loop* event_loop, as_event_wheel_timer* timer, uint64_t timeout,
+	uint64_t repeat
+	);
+
+/**
+ * @private
+ * Restart repeating timer from the current time.
+ */
+void
+as_event_wheel_again(struct as_event_loop* event_loop, as_event_wheel_timer* timer);
+
+/**
+ * @private
+ * Stop timer if active.
+ */
+void
+as_event_wheel_stop(struct as_event_loop* event_loop, as_event_wheel_timer* timer);
+
+/**
+ * @private
+ * Expire due timers. Called by the event loop's backend timer every millisecond while the
+ * wheel is ticking. Expired repeating timers call as_event_socket_timeout() and other
+ * timers call as_event_process_timer().
+ */
+void
+as_event_wheel_process(struct as_event_loop* event_loop);
+
+/**
+ * @private
+ * Start backend timer that calls as_event_wheel_process(). Implemented by each backend.
+ */
+void
+as_event_wheel_tick_start(struct as_event_loop* event_loop);
+
+/**
+ * @private
+ * Stop backend timer. Implemented by each backend.
+ */
+void
+as_event_wheel_tick_stop(struct as_event_loop* event_loop);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
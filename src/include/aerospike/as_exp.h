@@ -211,6 +211,8 @@ typedef struct {
 //---------------------------------
 
 AS_EXTERN as_exp* as_exp_compile(as_exp_entry* table, uint32_t n);
+AS_EXTERN as_exp* as_exp_compile_raw(as_exp_entry* table, uint32_t n);
+AS_EXTERN as_exp* as_exp_optimize(as_exp* exp);
 AS_EXTERN char* as_exp_compile_b64(as_exp* exp);
 AS_EXTERN void as_exp_destroy_b64(char* b64);
 AS_EXTERN uint8_t* as_exp_write(as_exp* exp, uint8_t* ptr);
@@ -261,6 +263,38 @@ as_exp_destroy_base64(char* base64)
 	as_exp_destroy_b64(base64);
 }
 
+/**
+ * Return the process-wide shared copy of an expression. Expressions with identical packed
+ * bytes share one copy, so applications that rebuild the same filter per command or per
+ * thread keep a single instance. The shared expression is read-only and may be assigned
+ * to policies used by multiple threads.
+ *
+ * Ownership of exp is transferred. If an identical expression is already shared, exp is
+ * destroyed and the shared expression is returned with an added reference. Otherwise, exp
+ * becomes the shared expression. Release with as_exp_release(), not as_exp_destroy().
+ *
+ * ~~~~~~~~~~{.c}
+ * as_exp* filter = as_exp_intern(as_exp_build(as_exp_cmp_eq(as_exp_bin_int("a"), as_exp_int(10))));
+ *
+ * as_policy_read p;
+ * as_policy_read_init(&p);
+ * p.base.filter_exp = filter;
+ * ...
+ * as_exp_release(filter);
+ * ~~~~~~~~~~
+ *
+ * @ingroup expression
+ */
+AS_EXTERN as_exp* as_exp_intern(as_exp* exp);
+
+/**
+ * Release reference to expression returned by as_exp_intern(). The expression is destroyed
+ * when the last reference is released.
+ *
+ * @ingroup expression
+ */
+AS_EXTERN void as_exp_release(as_exp* exp);
+
 //---------------------------------
 // Value Expressions
 //---------------------------------
@@ -3494,7 +3528,8 @@ as_exp_destroy_base64(char* base64)
 //---------------------------------
 
 /**
- * Declare and build an expression variable.
+ * Declare and build an expression variable. The expression is optimized when compiled,
+ * see as_exp_build_raw().
  *
  * @code
  * // a == 10
@@ -3537,6 +3572,31 @@ as_exp_destroy_base64(char* base64)
 			as_exp_destroy(temp); \
 		} while (false)
 
+/**
+ * Declare and build an expression variable without optimization.
+ *
+ * as_exp_build() folds constant comparisons and and/or/not/cond branches, flattens
+ * nested and/or and binds repeated sub-expressions to variables with as_exp_let().
+ * Use this builder when the expression must be sent exactly as written, for example
+ * to servers older than 5.6 that do not support as_exp_let().
+ *
+ * @code
+ * as_exp_build_raw(expression,
+ *     as_exp_and(as_exp_bool(true), as_exp_cmp_eq(as_exp_bin_int("a"), as_exp_int(10))));
+ * ...
+ * as_exp_destroy(expression);
+ * @endcode
+ *
+ * @param __name			Name of the variable to hold the expression
+ * @ingroup expression
+ */
+#define as_exp_build_raw(__name, ...) \
+		as_exp* __name; \
+		do { \
+			as_exp_entry __table__[] = { __VA_ARGS__ }; \
+			__name = as_exp_compile_raw(__table__, sizeof(__table__) / sizeof(as_exp_entry)); \
+		} while (false)
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+/**
+ * @file as_exp_static.h
+ *
+ * Expressions packed by the compiler. as_exp_build() packs its entry table at runtime.
+ * The macros in this file expand to the packed msgpack bytes, so as_exp_static() places
+ * a complete expression in read-only data. Building it costs nothing at startup and the
+ * expression can be shared by all threads without synchronization.
+ *
+ * The preprocessor cannot split string literals, so bin names and string values are
+ * written as character lists of at most 15 and 30 characters respectively. C++ callers can
+ * use as_exp_static.hpp, which accepts string literals.
+ *
+ * @code
+ * // age >= 21 && name == "bob"
+ * as_exp_static(filter,
+ *     as_exp_s_and(
+ *         as_exp_s_cmp_ge(as_exp_s_bin_int('a','g','e'), as_exp_s_int(21)),
+ *         as_exp_s_cmp_eq(as_exp_s_bin_str('n','a','m','e'), as_exp_s_str('b','o','b'))));
+ *
+ * as_policy_read p;
+ * as_policy_read_init(&p);
+ * p.base.filter_exp = filter;
+ * @endcode
+ *
+ * Static expressions are not optimized and must not be passed to as_exp_destroy() or
+ * as_exp_intern(). Integers are always packed in 9 bytes. Floats and CDT operations
+ * are not available, use as_exp_build() or as_exp_static.hpp for those.
+ */
+
+#include <aerospike/as_exp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Private Macros
+//---------------------------------
+
+#define _AS_EXP_S_X(__x) __x
+#define _AS_EXP_S_U(...) __VA_ARGS__
+#define _AS_EXP_S_CAT(__a, __b) _AS_EXP_S_CAT2(__a, __b)
+#define _AS_EXP_S_CAT2(__a, __b) __a##__b
+
+#define _AS_EXP_S_NARGS(...) \
+		_AS_EXP_S_X(_AS_EXP_S_NARGS_(__VA_ARGS__, \
+			31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, \
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define _AS_EXP_S_NARGS_( \
+		_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+		_17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, __n, ...) __n
+
+#define _AS_EXP_S_EACH_1(__a) _AS_EXP_S_U __a
+#define _AS_EXP_S_EACH_2(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_1(__VA_ARGS__))
+#define _AS_EXP_S_EACH_3(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_2(__VA_ARGS__))
+#define _AS_EXP_S_EACH_4(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_3(__VA_ARGS__))
+#define _AS_EXP_S_EACH_5(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_4(__VA_ARGS__))
+#define _AS_EXP_S_EACH_6(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_5(__VA_ARGS__))
+#define _AS_EXP_S_EACH_7(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_6(__VA_ARGS__))
+#define _AS_EXP_S_EACH_8(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_7(__VA_ARGS__))
+#define _AS_EXP_S_EACH_9(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_8(__VA_ARGS__))
+#define _AS_EXP_S_EACH_10(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_9(__VA_ARGS__))
+#define _AS_EXP_S_EACH_11(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_10(__VA_ARGS__))
+#define _AS_EXP_S_EACH_12(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_11(__VA_ARGS__))
+#define _AS_EXP_S_EACH_13(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_12(__VA_ARGS__))
+#define _AS_EXP_S_EACH_14(__a, ...) _AS_EXP_S_U __a, _AS_EXP_S_X(_AS_EXP_S_EACH_13(__VA_ARGS__))
+
+#define _AS_EXP_S_EACH(...) \
+		_AS_EXP_S_X(_AS_EXP_S_CAT(_AS_EXP_S_EACH_, _AS_EXP_S_NARGS(__VA_ARGS__))(__VA_ARGS__))
+
+// Operation with a variable number of expression arguments. Maximum 14 arguments.
+#define _AS_EXP_S_VA(__op, ...) \
+		(0x90 | (_AS_EXP_S_NARGS(__VA_ARGS__) + 1), __op, _AS_EXP_S_EACH(__VA_ARGS__))
+
+#define _AS_EXP_S_OP0(__op) (0x91, __op)
+#define _AS_EXP_S_OP1(__op, __a) (0x92, __op, _AS_EXP_S_U __a)
+#define _AS_EXP_S_OP2(__op, __a, __b) (0x93, __op, _AS_EXP_S_U __a, _AS_EXP_S_U __b)
+
+// Name without particle type. Maximum 31 characters.
+#define _AS_EXP_S_RAWSTR(...) 0xa0 | _AS_EXP_S_NARGS(__VA_ARGS__), __VA_ARGS__
+
+#define _AS_EXP_S_BIN(__type, ...) (0x93, _AS_EXP_CODE_BIN, __type, _AS_EXP_S_RAWSTR(__VA_ARGS__))
+
+#define _AS_EXP_S_BYTE(__v, __shift) (uint8_t)((uint64_t)(__v) >> (__shift))
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Declare a static expression named __name and initialize it with the packed bytes of
+ * __expr at compile time. May be used at file or function scope.
+ *
+ * @param __name	Name of the as_exp* variable.
+ * @param __expr	Expression built from as_exp_s_*() macros.
+ * @ingroup expression
+ */
+#define as_exp_static(__name, __expr) \
+		static const uint8_t __name##_bytes_[] = { _AS_EXP_S_U __expr }; \
+		static const struct { \
+			uint32_t packed_sz; \
+			uint8_t packed[sizeof(__name##_bytes_)]; \
+		} __name##_packed_ = { sizeof(__name##_bytes_), { _AS_EXP_S_U __expr } }; \
+		static as_exp* const __name = (as_exp*)&__name##_packed_
+
+/**
+ * Boolean value.
+ * @ingroup expression
+ */
+#define as_exp_s_bool(__val) ((__val) ? 0xc3 : 0xc2)
+
+/**
+ * 64 bit integer value.
+ * @ingroup expression
+ */
+#define as_exp_s_int(__val) (0xd3, \
+		_AS_EXP_S_BYTE(__val, 56), _AS_EXP_S_BYTE(__val, 48), _AS_EXP_S_BYTE(__val, 40), \
+		_AS_EXP_S_BYTE(__val, 32), _AS_EXP_S_BYTE(__val, 24), _AS_EXP_S_BYTE(__val, 16), \
+		_AS_EXP_S_BYTE(__val, 8), _AS_EXP_S_BYTE(__val, 0))
+
+/**
+ * String value written as a list of characters. Maximum 30 characters.
+ * @ingroup expression
+ */
+#define as_exp_s_str(...) (0xa1 + _AS_EXP_S_NARGS(__VA_ARGS__), AS_BYTES_STRING, __VA_ARGS__)
+
+/**
+ * Integer bin value. Bin name is written as a list of characters.
+ * @ingroup expression
+ */
+#define as_exp_s_bin_int(...) _AS_EXP_S_BIN(AS_EXP_TYPE_INT, __VA_ARGS__)
+
+/**
+ * String bin value. Bin name is written as a list of characters.
+ * @ingroup expression
+ */
+#define as_exp_s_bin_str(...) _AS_EXP_S_BIN(AS_EXP_TYPE_STR, __VA_ARGS__)
+
+/**
+ * Boolean bin value. Bin name is written as a list of characters.
+ * @ingroup expression
+ */
+#define as_exp_s_bin_bool(...) _AS_EXP_S_BIN(AS_EXP_TYPE_BOOL, __VA_ARGS__)
+
+/**
+ * Float bin value. Bin name is written as a list of characters.
+ * @ingroup expression
+ */
+#define as_exp_s_bin_float(...) _AS_EXP_S_BIN(AS_EXP_TYPE_FLOAT, __VA_ARGS__)
+
+/**
+ * Bin type, see as_bytes_type. Bin name is written as a list of characters.
+ * @ingroup expression
+ */
+#define as_exp_s_bin_type(...) (0x92, _AS_EXP_CODE_BIN_TYPE, _AS_EXP_S_RAWSTR(__VA_ARGS__))
+
+/**
+ * True if bin exists. Bin name is written as a list of characters.
+ * @ingroup expression
+ */
+#define as_exp_s_bin_exists(...) \
+		_AS_EXP_S_OP2(_AS_EXP_CODE_CMP_NE, as_exp_s_bin_type(__VA_ARGS__), (AS_BYTES_UNDEF))
+
+/**
+ * Record metadata, see the as_exp_*() macros of the same name.
+ * @ingroup expression
+ */
+#define as_exp_s_key_exist() _AS_EXP_S_OP0(_AS_EXP_CODE_KEY_EXIST)
+#define as_exp_s_set_name() _AS_EXP_S_OP0(_AS_EXP_CODE_SET_NAME)
+#define as_exp_s_last_update() _AS_EXP_S_OP0(_AS_EXP_CODE_LAST_UPDATE)
+#define as_exp_s_since_update() _AS_EXP_S_OP0(_AS_EXP_CODE_SINCE_UPDATE)
+#define as_exp_s_void_time() _AS_EXP_S_OP0(_AS_EXP_CODE_VOID_TIME)
+#define as_exp_s_ttl() _AS_EXP_S_OP0(_AS_EXP_CODE_TTL)
+#define as_exp_s_is_tombstone() _AS_EXP_S_OP0(_AS_EXP_CODE_IS_TOMBSTONE)
+#define as_exp_s_record_size() _AS_EXP_S_OP0(_AS_EXP_CODE_RECORD_SIZE)
+#define as_exp_s_digest_modulo(__mod) \
+		_AS_EXP_S_OP1(_AS_EXP_CODE_DIGEST_MODULO, as_exp_s_int(__mod))
+
+/**
+ * Comparisons, see as_exp_cmp_*().
+ * @ingroup expression
+ */
+#define as_exp_s_cmp_eq(__left, __right) _AS_EXP_S_OP2(_AS_EXP_CODE_CMP_EQ, __left, __right)
+#define as_exp_s_cmp_ne(__left, __right) _AS_EXP_S_OP2(_AS_EXP_CODE_CMP_NE, __left, __right)
+#define as_exp_s_cmp_gt(__left, __right) _AS_EXP_S_OP2(_AS_EXP_CODE_CMP_GT, __left, __right)
+#define as_exp_s_cmp_ge(__left, __right) _AS_EXP_S_OP2(_AS_EXP_CODE_CMP_GE, __left, __right)
+#define as_exp_s_cmp_lt(__left, __right) _AS_EXP_S_OP2(_AS_EXP_CODE_CMP_LT, __left, __right)
+#define as_exp_s_cmp_le(__left, __right) _AS_EXP_S_OP2(_AS_EXP_CODE_CMP_LE, __left, __right)
+
+/**
+ * Logical operations, see as_exp_and(), as_exp_or(), as_exp_not() and as_exp_exclusive().
+ * Maximum 14 arguments.
+ * @ingroup expression
+ */
+#define as_exp_s_and(...) _AS_EXP_S_VA(_AS_EXP_CODE_AND, __VA_ARGS__)
+#define as_exp_s_or(...) _AS_EXP_S_VA(_AS_EXP_CODE_OR, __VA_ARGS__)
+#define as_exp_s_exclusive(...) _AS_EXP_S_VA(_AS_EXP_CODE_EXCLUSIVE, __VA_ARGS__)
+#define as_exp_s_not(__expr) _AS_EXP_S_OP1(_AS_EXP_CODE_NOT, __expr)
+
+/**
+ * Integer arithmetic, see as_exp_add() and related macros. Maximum 14 arguments.
+ * @ingroup expression
+ */
+#define as_exp_s_add(...) _AS_EXP_S_VA(_AS_EXP_CODE_ADD, __VA_ARGS__)
+#define as_exp_s_sub(...) _AS_EXP_S_VA(_AS_EXP_CODE_SUB, __VA_ARGS__)
+#define as_exp_s_mul(...) _AS_EXP_S_VA(_AS_EXP_CODE_MUL, __VA_ARGS__)
+#define as_exp_s_div(...) _AS_EXP_S_VA(_AS_EXP_CODE_DIV, __VA_ARGS__)
+#define as_exp_s_min(...) _AS_EXP_S_VA(_AS_EXP_CODE_MIN, __VA_ARGS__)
+#define as_exp_s_max(...) _AS_EXP_S_VA(_AS_EXP_CODE_MAX, __VA_ARGS__)
+#define as_exp_s_mod(__num, __denom) _AS_EXP_S_OP2(_AS_EXP_CODE_MOD, __num, __denom)
+#define as_exp_s_abs(__value) _AS_EXP_S_OP1(_AS_EXP_CODE_ABS, __value)
+
+/**
+ * Conditional expression, see as_exp_cond(). Maximum 14 arguments.
+ * @ingroup expression
+ */
+#define as_exp_s_cond(...) _AS_EXP_S_VA(_AS_EXP_CODE_COND, __VA_ARGS__)
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
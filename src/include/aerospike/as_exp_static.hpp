@@ -0,0 +1,448 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+/**
+ * @file as_exp_static.hpp
+ *
+ * C++17 constexpr expression packing. Each function returns the packed msgpack bytes of its
+ * expression, so build() produces a complete expression at compile time that can be stored in
+ * a static constexpr variable, placed in read-only data and shared by all threads.
+ *
+ * ~~~~~~~~~~{.cpp}
+ * namespace xs = as_cexp;
+ *
+ * // age >= 21 && name == "bob"
+ * static constexpr auto filter = xs::build(
+ *     xs::and_(
+ *         xs::cmp_ge(xs::bin_int("age"), xs::int_val(21)),
+ *         xs::cmp_eq(xs::bin_str("name"), xs::str_val("bob"))));
+ *
+ * as_policy_read p;
+ * as_policy_read_init(&p);
+ * p.base.filter_exp = filter;
+ * ~~~~~~~~~~
+ *
+ * Static expressions are packed as written and must not be passed to as_exp_destroy() or
+ * as_exp_intern(). Integers are always packed in 9 bytes. Float values require C++20. CDT,
+ * bit and HLL operations are not available, use as_exp_build() for those.
+ */
+
+#if !defined(__cplusplus) || __cplusplus < 201703L
+#error "as_exp_static.hpp requires C++17"
+#endif
+
+#include <aerospike/as_exp.h>
+#include <cstddef>
+#include <cstdint>
+
+#if __cplusplus >= 202002L
+#include <bit>
+#endif
+
+namespace as_cexp {
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Packed bytes of an expression or value.
+ */
+template<std::size_t N>
+struct bytes {
+	uint8_t data[N];
+};
+
+/**
+ * @private
+ * Variable definition of let(). Counts as two list elements.
+ */
+template<std::size_t N>
+struct definition {
+	bytes<N> value;
+};
+
+/**
+ * Complete expression with the same layout as as_exp.
+ */
+template<std::size_t N>
+struct packed_exp {
+	uint32_t packed_sz;
+	uint8_t packed[N];
+
+	/**
+	 * Return expression for use in policies. The expression is never modified by the client.
+	 */
+	as_exp*
+	get() const
+	{
+		return const_cast<as_exp*>(reinterpret_cast<const as_exp*>(this));
+	}
+
+	operator as_exp*() const
+	{
+		return get();
+	}
+};
+
+//---------------------------------
+// Private Functions
+//---------------------------------
+
+namespace detail {
+
+template<std::size_t N, std::size_t M>
+constexpr void
+copy(bytes<N>& out, std::size_t& offset, const bytes<M>& in)
+{
+	for (std::size_t i = 0; i < M; i++) {
+		out.data[offset++] = in.data[i];
+	}
+}
+
+template<std::size_t... Ns>
+constexpr bytes<(Ns + ...)>
+cat(const bytes<Ns>&... parts)
+{
+	bytes<(Ns + ...)> out{};
+	std::size_t offset = 0;
+	(copy(out, offset, parts), ...);
+	return out;
+}
+
+constexpr bytes<1>
+byte(uint8_t b)
+{
+	return bytes<1>{{b}};
+}
+
+constexpr bytes<9>
+int64(int64_t v)
+{
+	uint64_t u = static_cast<uint64_t>(v);
+	bytes<9> out{};
+	out.data[0] = 0xd3;
+
+	for (int i = 0; i < 8; i++) {
+		out.data[i + 1] = static_cast<uint8_t>(u >> (56 - i * 8));
+	}
+	return out;
+}
+
+template<std::size_t L>
+constexpr bytes<L>
+rawstr(const char (&s)[L])
+{
+	static_assert(L - 1 <= 31, "name exceeds 31 characters");
+	bytes<L> out{};
+	out.data[0] = static_cast<uint8_t>(0xa0 | (L - 1));
+
+	for (std::size_t i = 0; i < L - 1; i++) {
+		out.data[i + 1] = static_cast<uint8_t>(s[i]);
+	}
+	return out;
+}
+
+template<std::size_t N>
+constexpr const bytes<N>&
+unwrap(const bytes<N>& arg)
+{
+	return arg;
+}
+
+template<std::size_t N>
+constexpr const bytes<N>&
+unwrap(const definition<N>& arg)
+{
+	return arg.value;
+}
+
+template<typename T>
+struct elements {
+	static constexpr std::size_t count = 1;
+};
+
+template<std::size_t N>
+struct elements<definition<N>> {
+	static constexpr std::size_t count = 2;
+};
+
+template<typename... Args>
+constexpr auto
+op(int64_t code, const Args&... args)
+{
+	constexpr std::size_t count = (elements<Args>::count + ... + 1);
+	static_assert(count <= 15, "too many arguments");
+	return cat(byte(static_cast<uint8_t>(0x90 | count)), byte(static_cast<uint8_t>(code)),
+		unwrap(args)...);
+}
+
+template<std::size_t L>
+constexpr auto
+bin(as_exp_type type, const char (&name)[L])
+{
+	return op(_AS_EXP_CODE_BIN, byte(static_cast<uint8_t>(type)), rawstr(name));
+}
+
+} // namespace detail
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Create complete expression from packed bytes.
+ */
+template<std::size_t N>
+constexpr packed_exp<N>
+build(const bytes<N>& expr)
+{
+	packed_exp<N> exp{};
+	exp.packed_sz = static_cast<uint32_t>(N);
+
+	for (std::size_t i = 0; i < N; i++) {
+		exp.packed[i] = expr.data[i];
+	}
+	return exp;
+}
+
+/**
+ * Boolean value.
+ */
+constexpr bytes<1>
+bool_val(bool v)
+{
+	return detail::byte(v ? 0xc3 : 0xc2);
+}
+
+/**
+ * 64 bit integer value.
+ */
+constexpr bytes<9>
+int_val(int64_t v)
+{
+	return detail::int64(v);
+}
+
+#if defined(__cpp_lib_bit_cast)
+/**
+ * 64 bit float value.
+ */
+constexpr bytes<9>
+float_val(double v)
+{
+	bytes<9> out = detail::int64(std::bit_cast<int64_t>(v));
+	out.data[0] = 0xcb;
+	return out;
+}
+#endif
+
+/**
+ * String value. Maximum 30 characters.
+ */
+template<std::size_t L>
+constexpr bytes<L + 1>
+str_val(const char (&s)[L])
+{
+	static_assert(L <= 31, "string exceeds 30 characters");
+	bytes<L + 1> out{};
+	out.data[0] = static_cast<uint8_t>(0xa0 | L);
+	out.data[1] = AS_BYTES_STRING;
+
+	for (std::size_t i = 0; i < L - 1; i++) {
+		out.data[i + 2] = static_cast<uint8_t>(s[i]);
+	}
+	return out;
+}
+
+/**
+ * Bin values, see as_exp_bin_int() and related macros.
+ */
+template<std::size_t L>
+constexpr auto bin_int(const char (&name)[L]) { return detail::bin(AS_EXP_TYPE_INT, name); }
+
+template<std::size_t L>
+constexpr auto bin_float(const char (&name)[L]) { return detail::bin(AS_EXP_TYPE_FLOAT, name); }
+
+template<std::size_t L>
+constexpr auto bin_str(const char (&name)[L]) { return detail::bin(AS_EXP_TYPE_STR, name); }
+
+template<std::size_t L>
+constexpr auto bin_bool(const char (&name)[L]) { return detail::bin(AS_EXP_TYPE_BOOL, name); }
+
+template<std::size_t L>
+constexpr auto
+bin_type(const char (&name)[L])
+{
+	return detail::op(_AS_EXP_CODE_BIN_TYPE, detail::rawstr(name));
+}
+
+template<std::size_t L>
+constexpr auto
+bin_exists(const char (&name)[L])
+{
+	return detail::op(_AS_EXP_CODE_CMP_NE, bin_type(name), detail::byte(AS_BYTES_UNDEF));
+}
+
+/**
+ * Record metadata, see the as_exp_*() macros of the same name.
+ */
+constexpr auto key_exist() { return detail::op(_AS_EXP_CODE_KEY_EXIST); }
+constexpr auto set_name() { return detail::op(_AS_EXP_CODE_SET_NAME); }
+constexpr auto last_update() { return detail::op(_AS_EXP_CODE_LAST_UPDATE); }
+constexpr auto since_update() { return detail::op(_AS_EXP_CODE_SINCE_UPDATE); }
+constexpr auto void_time() { return detail::op(_AS_EXP_CODE_VOID_TIME); }
+constexpr auto ttl() { return detail::op(_AS_EXP_CODE_TTL); }
+constexpr auto is_tombstone() { return detail::op(_AS_EXP_CODE_IS_TOMBSTONE); }
+constexpr auto record_size() { return detail::op(_AS_EXP_CODE_RECORD_SIZE); }
+
+constexpr auto
+digest_modulo(int64_t mod)
+{
+	return detail::op(_AS_EXP_CODE_DIGEST_MODULO, detail::int64(mod));
+}
+
+/**
+ * Comparisons, see as_exp_cmp_*().
+ */
+template<std::size_t L, std::size_t R>
+constexpr auto
+cmp_eq(const bytes<L>& left, const bytes<R>& right)
+{
+	return detail::op(_AS_EXP_CODE_CMP_EQ, left, right);
+}
+
+template<std::size_t L, std::size_t R>
+constexpr auto
+cmp_ne(const bytes<L>& left, const bytes<R>& right)
+{
+	return detail::op(_AS_EXP_CODE_CMP_NE, left, right);
+}
+
+template<std::size_t L, std::size_t R>
+constexpr auto
+cmp_gt(const bytes<L>& left, const bytes<R>& right)
+{
+	return detail::op(_AS_EXP_CODE_CMP_GT, left, right);
+}
+
+template<std::size_t L, std::size_t R>
+constexpr auto
+cmp_ge(const bytes<L>& left, const bytes<R>& right)
+{
+	return detail::op(_AS_EXP_CODE_CMP_GE, left, right);
+}
+
+template<std::size_t L, std::size_t R>
+constexpr auto
+cmp_lt(const bytes<L>& left, const bytes<R>& right)
+{
+	return detail::op(_AS_EXP_CODE_CMP_LT, left, right);
+}
+
+template<std::size_t L, std::size_t R>
+constexpr auto
+cmp_le(const bytes<L>& left, const bytes<R>& right)
+{
+	return detail::op(_AS_EXP_CODE_CMP_LE, left, right);
+}
+
+/**
+ * Logical operations, see as_exp_and(), as_exp_or(), as_exp_not() and as_exp_exclusive().
+ */
+template<std::size_t... Ns>
+constexpr auto and_(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_AND, args...); }
+
+template<std::size_t... Ns>
+constexpr auto or_(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_OR, args...); }
+
+template<std::size_t... Ns>
+constexpr auto
+exclusive(const bytes<Ns>&... args)
+{
+	return detail::op(_AS_EXP_CODE_EXCLUSIVE, args...);
+}
+
+template<std::size_t N>
+constexpr auto not_(const bytes<N>& expr) { return detail::op(_AS_EXP_CODE_NOT, expr); }
+
+/**
+ * Arithmetic, see as_exp_add() and related macros.
+ */
+template<std::size_t... Ns>
+constexpr auto add(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_ADD, args...); }
+
+template<std::size_t... Ns>
+constexpr auto sub(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_SUB, args...); }
+
+template<std::size_t... Ns>
+constexpr auto mul(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_MUL, args...); }
+
+template<std::size_t... Ns>
+constexpr auto div(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_DIV, args...); }
+
+template<std::size_t... Ns>
+constexpr auto min(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_MIN, args...); }
+
+template<std::size_t... Ns>
+constexpr auto max(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_MAX, args...); }
+
+template<std::size_t N, std::size_t D>
+constexpr auto
+mod(const bytes<N>& numerator, const bytes<D>& denominator)
+{
+	return detail::op(_AS_EXP_CODE_MOD, numerator, denominator);
+}
+
+template<std::size_t N>
+constexpr auto abs(const bytes<N>& value) { return detail::op(_AS_EXP_CODE_ABS, value); }
+
+/**
+ * Conditional expression, see as_exp_cond().
+ */
+template<std::size_t... Ns>
+constexpr auto cond(const bytes<Ns>&... args) { return detail::op(_AS_EXP_CODE_COND, args...); }
+
+/**
+ * Variable definition for let(), see as_exp_def().
+ */
+template<std::size_t L, std::size_t N>
+constexpr auto
+def(const char (&name)[L], const bytes<N>& expr)
+{
+	auto value = detail::cat(detail::rawstr(name), expr);
+	return definition<sizeof(value.data)>{value};
+}
+
+/**
+ * Define variables followed by the expression that uses them, see as_exp_let().
+ */
+template<typename... Args>
+constexpr auto let(const Args&... args) { return detail::op(_AS_EXP_CODE_LET, args...); }
+
+/**
+ * Variable value, see as_exp_var().
+ */
+template<std::size_t L>
+constexpr auto
+var(const char (&name)[L])
+{
+	return detail::op(_AS_EXP_CODE_VAR, detail::rawstr(name));
+}
+
+} // namespace as_cexp
@@ -22,6 +22,13 @@
 
 #include <sys/stat.h>
 
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +37,8 @@ extern "C" {
 
 typedef struct {
 	struct timespec timestamp;
+	int watch_fd;
+	const char* watch_name;
 } as_file_status;
 
 static inline struct timespec*
@@ -77,6 +86,114 @@ as_file_has_changed(const char* path, as_file_status* fs)
 	return false;
 }
 
+/**
+ * Start watching file for modifications. The file's directory is watched, so the file can
+ * be replaced by rename. Return false if file notifications are not available, in which
+ * case as_file_has_changed() must be polled instead.
+ */
+static inline bool
+as_file_watch(const char* path, as_file_status* fs)
+{
+	fs->watch_fd = -1;
+	fs->watch_name = NULL;
+
+#if defined(__linux__)
+	char dir[PATH_MAX];
+	const char* name = strrchr(path, '/');
+
+	if (name) {
+		size_t len = (name == path)? 1 : (size_t)(name - path);
+
+		if (len >= sizeof(dir)) {
+			return false;
+		}
+		memcpy(dir, path, len);
+		dir[len] = 0;
+		name++;
+	}
+	else {
+		dir[0] = '.';
+		dir[1] = 0;
+		name = path;
+	}
+
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	// Do not watch IN_MODIFY, because the file may still be partially written.
+	if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(fd);
+		return false;
+	}
+
+	fs->watch_fd = fd;
+	fs->watch_name = name;
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+/**
+ * Return if file notifications are active.
+ */
+static inline bool
+as_file_is_watched(as_file_status* fs)
+{
+	return fs->watch_fd >= 0;
+}
+
+/**
+ * Drain pending file notifications without blocking. Return true if the watched file was
+ * written or replaced since the last call.
+ */
+static inline bool
+as_file_watch_changed(as_file_status* fs)
+{
+#if defined(__linux__)
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	bool changed = false;
+	ssize_t len;
+
+	while ((len = read(fs->watch_fd, buf, sizeof(buf))) > 0) {
+		char* p = buf;
+		char* end = buf + len;
+
+		while (p < end) {
+			struct inotify_event* event = (struct inotify_event*)p;
+
+			if ((event->mask & IN_Q_OVERFLOW) ||
+				(event->len > 0 && strcmp(event->name, fs->watch_name) == 0)) {
+				changed = true;
+			}
+			p += sizeof(struct inotify_event) + event->len;
+		}
+	}
+	return changed;
+#else
+	(void)fs;
+	return false;
+#endif
+}
+
+/**
+ * Stop watching file.
+ */
+static inline void
+as_file_unwatch(as_file_status* fs)
+{
+#if defined(__linux__)
+	if (fs->watch_fd >= 0) {
+		close(fs->watch_fd);
+	}
+#endif
+	fs->watch_fd = -1;
+}
+
 #else
 
 typedef struct {
@@ -116,6 +233,34 @@ as_file_has_changed(const char* path, as_file_status* fs)
 	return false;
 }
 
+static inline bool
+as_file_watch(const char* path, as_file_status* fs)
+{
+	(void)path;
+	(void)fs;
+	return false;
+}
+
+static inline bool
+as_file_is_watched(as_file_status* fs)
+{
+	(void)fs;
+	return false;
+}
+
+static inline bool
+as_file_watch_changed(as_file_status* fs)
+{
+	(void)fs;
+	return false;
+}
+
+static inline void
+as_file_unwatch(as_file_status* fs)
+{
+	(void)fs;
+}
+
 #endif
 
 #ifdef __cplusplus
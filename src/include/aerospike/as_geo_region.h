@@ -0,0 +1,178 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_std.h>
+#include <aerospike/as_vector.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * GeoJSON region type.
+ *
+ * @ingroup query_operations
+ */
+typedef enum as_geo_region_type_e {
+	AS_GEO_REGION_POLYGON,
+	AS_GEO_REGION_MULTI_POLYGON,
+	AS_GEO_REGION_CIRCLE
+} as_geo_region_type;
+
+/**
+ * Longitude and latitude in degrees.
+ *
+ * @ingroup query_operations
+ */
+typedef struct as_geo_point_s {
+	double lng;
+	double lat;
+} as_geo_point;
+
+/**
+ * Prepared GeoJSON region for geospatial queries. The GeoJSON text is validated, copied and
+ * encoded as a query filter value once, so queries that reuse the region with
+ * as_query_where_region() copy the encoded filter instead of encoding the text again.
+ *
+ * Supported regions are Polygon, MultiPolygon and AeroCircle. The region also supports a
+ * client side point-in-region check for post-filtering query results. Region edges are
+ * treated as straight lines in longitude and latitude, while the server uses geodesic edges,
+ * so points very close to an edge of a large region may be classified differently.
+ *
+ * @code
+ * as_geo_region* region = as_geo_region_create(&err,
+ *     "{\"type\":\"AeroCircle\",\"coordinates\":[[-122.0,37.5],1000]}");
+ *
+ * as_query_where_inita(&query, 1);
+ * as_query_where_region(&query, "loc", region);
+ * ...
+ * as_geo_region_destroy(region);
+ * @endcode
+ *
+ * @ingroup query_operations
+ */
+typedef struct as_geo_region_s {
+	/**
+	 * @private
+	 * Copy of GeoJSON text.
+	 */
+	char* json;
+
+	/**
+	 * @private
+	 * Encoded query filter value.
+	 */
+	uint8_t* encoded;
+
+	/**
+	 * @private
+	 * Polygon vertices of type as_geo_point.
+	 */
+	as_vector points;
+
+	/**
+	 * @private
+	 * Polygon rings as pairs of uint32_t vertex offset and vertex count.
+	 */
+	as_vector rings;
+
+	/**
+	 * @private
+	 * Polygons as pairs of uint32_t ring offset and ring count. The first ring of each
+	 * polygon is its exterior and the remaining rings are holes.
+	 */
+	as_vector polygons;
+
+	/**
+	 * @private
+	 * Circle center.
+	 */
+	as_geo_point center;
+
+	/**
+	 * @private
+	 * Circle radius in meters.
+	 */
+	double radius;
+
+	/**
+	 * @private
+	 */
+	uint32_t json_size;
+
+	/**
+	 * @private
+	 */
+	uint32_t encoded_size;
+
+	/**
+	 * Region type.
+	 */
+	as_geo_region_type type;
+} as_geo_region;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Validate GeoJSON region and create a prepared region. Return NULL and populate err if the
+ * text is not a valid Polygon, MultiPolygon or AeroCircle.
+ *
+ * @relates as_geo_region
+ * @ingroup query_operations
+ */
+AS_EXTERN as_geo_region*
+as_geo_region_create(as_error* err, const char* geojson);
+
+/**
+ * Release region. Queries that reference the region must not be executed afterwards.
+ *
+ * @relates as_geo_region
+ * @ingroup query_operations
+ */
+AS_EXTERN void
+as_geo_region_destroy(as_geo_region* region);
+
+/**
+ * Return true if the point is inside the region.
+ *
+ * @relates as_geo_region
+ * @ingroup query_operations
+ */
+AS_EXTERN bool
+as_geo_region_contains_point(const as_geo_region* region, double lng, double lat);
+
+/**
+ * Return true if the GeoJSON Point, such as the value of a geojson bin, is inside the region.
+ * Return false if the text is not a GeoJSON Point.
+ *
+ * @relates as_geo_region
+ * @ingroup query_operations
+ */
+AS_EXTERN bool
+as_geo_region_contains_geojson(const as_geo_region* region, const char* geojson);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
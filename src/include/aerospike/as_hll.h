@@ -0,0 +1,180 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Minimum number of HLL index bits.
+ */
+#define AS_HLL_MIN_INDEX_BITS 4
+
+/**
+ * Maximum number of HLL index bits.
+ */
+#define AS_HLL_MAX_INDEX_BITS 16
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Client side HyperLogLog sketch. Sketches are loaded from HLL bin values returned by the
+ * server, so many HLL bins can be fetched with one batch read and merged and estimated
+ * locally instead of with one as_operations_hll_get_union_count() operation per request.
+ *
+ * Only the HLL part of each server register is kept. MinHash bits are dropped, so sketches
+ * serialized by as_hll_to_bytes() have zero MinHash bits.
+ *
+ * @code
+ * as_hll hll;
+ * as_hll_init(&hll, &err, 12);
+ *
+ * for (uint32_t i = 0; i < n_keys; i++) {
+ *     as_bytes* b = as_record_get_bytes(&results[i].record, "hll");
+ *
+ *     if (b) {
+ *         as_hll_merge_bytes(&hll, &err, b);
+ *     }
+ * }
+ * uint64_t count = as_hll_cardinality(&hll);
+ * as_hll_destroy(&hll);
+ * @endcode
+ *
+ * @ingroup hll_operations
+ */
+typedef struct as_hll_s {
+	/**
+	 * HLL value of each register.
+	 */
+	uint8_t* registers;
+
+	/**
+	 * Number of registers (2^n_index_bits).
+	 */
+	uint32_t n_registers;
+
+	/**
+	 * Number of index bits.
+	 */
+	uint8_t n_index_bits;
+} as_hll;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize empty sketch with n_index_bits index bits.
+ *
+ * @param hll			Sketch to initialize.
+ * @param err			Error message that is populated on error.
+ * @param n_index_bits	Number of index bits. Must be between 4 and 16 inclusive.
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN as_status
+as_hll_init(as_hll* hll, as_error* err, uint8_t n_index_bits);
+
+/**
+ * Initialize sketch from a server HLL bin value.
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN as_status
+as_hll_init_bytes(as_hll* hll, as_error* err, const as_bytes* bytes);
+
+/**
+ * Merge a server HLL bin value into the sketch. The value must have the same number of index
+ * bits as the sketch.
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN as_status
+as_hll_merge_bytes(as_hll* hll, as_error* err, const as_bytes* bytes);
+
+/**
+ * Merge another sketch into the sketch. Both sketches must have the same number of index bits.
+ * Registers are merged with SIMD instructions when available (AVX2/SSE2 on x86_64 and NEON
+ * on arm64).
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN as_status
+as_hll_merge(as_hll* hll, as_error* err, const as_hll* other);
+
+/**
+ * Estimate number of distinct entries added to the sketch.
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN uint64_t
+as_hll_cardinality(const as_hll* hll);
+
+/**
+ * Estimate number of distinct entries in the union of server HLL bin values.
+ *
+ * @param err		Error message that is populated on error.
+ * @param values	HLL bin values with the same number of index bits.
+ * @param n_values	Number of values.
+ * @param count		Estimated union cardinality.
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN as_status
+as_hll_union_count(
+	as_error* err, const as_bytes* const* values, uint32_t n_values, uint64_t* count
+	);
+
+/**
+ * Serialize sketch in the server HLL bin format. The returned bytes can be written to a bin
+ * with as_record_set_bytes() or as_operations_hll_set_union().
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN as_bytes*
+as_hll_to_bytes(const as_hll* hll);
+
+/**
+ * Release sketch registers.
+ *
+ * @relates as_hll
+ * @ingroup hll_operations
+ */
+AS_EXTERN void
+as_hll_destroy(as_hll* hll);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_key.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Number of count-min sketch rows. Each row is indexed by a different word of the digest.
+ */
+#define AS_HOT_KEYS_DEPTH 4
+
+/**
+ * Number of counters per count-min sketch row. Must be a power of 2.
+ */
+#define AS_HOT_KEYS_WIDTH 2048
+
+/**
+ * Maximum number of heaviest keys tracked per namespace.
+ */
+#define AS_HOT_KEYS_MAX 256
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Frequently accessed key.
+ */
+typedef struct as_hot_key_s {
+	/**
+	 * Key digest.
+	 */
+	uint8_t digest[AS_DIGEST_VALUE_SIZE];
+
+	/**
+	 * Key set name.
+	 */
+	char set[AS_SET_MAX_SIZE];
+
+	/**
+	 * Estimated number of commands in the current window. The estimate never undercounts.
+	 */
+	uint32_t count;
+} as_hot_key;
+
+/**
+ * Count-min sketch of key digests with a min-heap of the heaviest keys. Counts are halved
+ * every metrics interval, so estimates cover a sliding window of recent commands.
+ */
+typedef struct as_hot_keys_s {
+	pthread_mutex_t lock;
+	as_hot_key* heap;
+	uint32_t capacity;
+	uint32_t size;
+	uint32_t min; // Smallest count in a full heap. Zero while the heap is not full.
+	uint32_t sketch[AS_HOT_KEYS_DEPTH * AS_HOT_KEYS_WIDTH];
+} as_hot_keys;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create hot key tracker for the heaviest capacity keys.
+ */
+as_hot_keys*
+as_hot_keys_create(uint32_t capacity);
+
+/**
+ * @private
+ * Destroy hot key tracker.
+ */
+void
+as_hot_keys_destroy(as_hot_keys* hk);
+
+/**
+ * @private
+ * Count command on key. Heap updates are skipped when another thread holds the heap lock.
+ * The sketch still holds the count, so the key is picked up on its next command.
+ */
+void
+as_hot_keys_add(as_hot_keys* hk, const uint8_t* digest, const char* set);
+
+/**
+ * @private
+ * Halve all counts to age out keys that are no longer accessed.
+ */
+void
+as_hot_keys_decay(as_hot_keys* hk);
+
+/**
+ * @private
+ * Remove all counts.
+ */
+void
+as_hot_keys_clear(as_hot_keys* hk);
+
+/**
+ * Copy up to max heaviest keys to out in descending count order. Return number of keys copied.
+ */
+AS_EXTERN uint32_t
+as_hot_keys_get(as_hot_keys* hk, as_hot_key* out, uint32_t max);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
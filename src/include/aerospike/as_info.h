@@ -19,6 +19,7 @@
 #include <aerospike/aerospike.h>
 #include <aerospike/as_listener.h>
 #include <aerospike/as_cluster.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +62,19 @@ as_info_command_node_async(
 	as_async_info_listener listener, void* udata, as_event_loop* event_loop
 	);
 
+/**
+ * @private
+ * Asynchronously send newline separated info commands to specific node after delay_ms.
+ * Errors embedded in individual command responses are not checked, so the listener must
+ * validate each response line. The node must be reserved by the caller and is released
+ * when the command completes.
+ */
+as_status
+as_info_command_node_async_multi(
+	as_error* err, as_policy_info* policy, as_node* node, const char* command, uint32_t delay_ms,
+	as_async_info_listener listener, void* udata, as_event_loop* event_loop
+	);
+
 /**
  * @private
  * Send info command to random node. The values must be freed by the caller on success.
@@ -130,6 +144,31 @@ as_info_parse_single_response(char *values, char **value);
 void
 as_info_parse_multi_response(char* buf, as_vector* /* <as_name_value> */ values);
 
+/**
+ * @private
+ * Return pointer to the first character in info response text that is one of delims, or to
+ * the terminating null. Info parsers use this instead of character loops, because C library
+ * span functions scan many bytes per instruction on large responses.
+ */
+static inline char*
+as_info_find(char* p, const char* delims)
+{
+	return p + strcspn(p, delims);
+}
+
+/**
+ * @private
+ * Null terminate the token that starts at p at the first of delims. Return pointer to the
+ * terminated position, which is the terminating null when no delimiter was found.
+ */
+static inline char*
+as_info_terminate(char* p, const char* delims)
+{
+	p += strcspn(p, delims);
+	*p = 0;
+	return p;
+}
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -67,6 +67,21 @@ typedef struct as_job_info_s {
 	uint32_t records_read;
 } as_job_info;
 
+/**
+ * User callback when an asynchronous background job wait completes.
+ *
+ * @param err			This error structure is only populated when the wait fails. Null on success.
+ * @param info			Job information from the last status round. Do not free.
+ * @param udata			User data that is forwarded from aerospike_job_wait_async().
+ * @param event_loop 	Event loop that received the last job status. NULL if the wait failed
+ *						before any status command was sent.
+ */
+typedef void (*as_async_job_listener)(
+	as_error* err, as_job_info* info, void* udata, as_event_loop* event_loop
+	);
+
+struct as_job_monitor_s;
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -93,6 +108,50 @@ aerospike_job_wait(
 	aerospike* as, as_error* err, const as_policy_info* policy, const char* module, uint64_t job_id,
 	uint32_t interval_ms
 	);
+
+/**
+ * Asynchronously wait for a background job to be completed by servers. The listener is called
+ * from an event loop thread when the job completes or a job status request fails.
+ *
+ * All outstanding async job waits on a cluster are checked together. Each status round sends
+ * one info request per node covering every outstanding job. The delay between rounds starts
+ * small and doubles after each round up to interval_ms, so short jobs complete quickly
+ * while long jobs are polled less often.
+ *
+ * All async job waits must complete before aerospike_close() is called. Waits that have not
+ * started a status round when the cluster is closed fail with AEROSPIKE_ERR_CLIENT.
+ *
+ * @code
+ * void my_listener(as_error* err, as_job_info* info, void* udata, as_event_loop* event_loop)
+ * {
+ *     if (err) {
+ *         printf("Job wait failed: %d %s\n", err->code, err->message);
+ *         return;
+ *     }
+ *     printf("Job completed. Records read: %u\n", info->records_read);
+ * }
+ *
+ * aerospike_job_wait_async(&as, &err, NULL, "query", job_id, 0, my_listener, NULL, NULL);
+ * @endcode
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param policy		The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param module		Background module. Values: scan | query
+ * @param job_id		Job ID.
+ * @param interval_ms	Maximum polling interval in milliseconds. If zero, 1000 ms is used.
+ * @param listener		User function to be called when the job completes.
+ * @param udata			User data to be forwarded to user callback.
+ * @param event_loop 	Event loop assigned to the first round of status commands. If NULL, an
+ *						event loop is chosen per node.
+ *
+ * @return AEROSPIKE_OK if the wait was started. Otherwise an error and the listener is not called.
+ */
+AS_EXTERN as_status
+aerospike_job_wait_async(
+	aerospike* as, as_error* err, const as_policy_info* policy, const char* module, uint64_t job_id,
+	uint32_t interval_ms, as_async_job_listener listener, void* udata, as_event_loop* event_loop
+	);
 	
 /**
  * Check the progress of a background job running on the database. The status
@@ -126,6 +185,20 @@ aerospike_job_info(
 	bool stop_if_in_progress, as_job_info * info
 	);
 
+/**
+ * @private
+ * Create monitor that multiplexes async job waits for a cluster.
+ */
+struct as_job_monitor_s*
+as_job_monitor_create(struct as_cluster_s* cluster);
+
+/**
+ * @private
+ * Close monitor. The monitor is freed when its current status round completes.
+ */
+void
+as_job_monitor_destroy(struct as_job_monitor_s* monitor);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -83,6 +83,14 @@ typedef struct as_digest_s {
 
 } as_digest;
 
+/**
+ * Resolved namespace of one cluster. Holds the cluster serial in the upper 32 bits and the
+ * partition table index in the lower 32 bits. Zero means unresolved.
+ *
+ * @ingroup client_objects
+ */
+typedef uint64_t as_namespace_handle;
+
 /**
  * Key value
  */
@@ -212,8 +220,64 @@ typedef struct as_key_s {
 	 */
 	as_digest digest;
 
+	/**
+	 * @private
+	 * Cached partition table handle of ns. Resolved on first routing of the key.
+	 */
+	as_namespace_handle ns_handle;
+
+	/**
+	 * @private
+	 * Cached replica chosen for this key by the last command and the cluster routing
+	 * generation it was chosen in.
+	 */
+	uint64_t route_hint;
+
 } as_key;
 
+/**
+ * Compact key for large key arrays. Namespace and set point to names interned by
+ * as_key_intern() and the user key is an optional reference, so a compact key takes 48 bytes
+ * on 64-bit platforms instead of the size of as_key.
+ *
+ * Compact keys convert losslessly to and from as_key with as_key_compact_init() and
+ * as_key_compact_to_key(). Arrays of compact keys are accepted by batch reads through
+ * as_batch_compact.
+ *
+ * @code
+ * as_key key;
+ * as_key_init_int64(&key, "ns", "set", 1);
+ *
+ * as_key_compact ck;
+ * as_key_compact_init(&ck, &err, &key, false);
+ * as_key_destroy(&key);
+ * @endcode
+ *
+ * @ingroup client_objects
+ */
+typedef struct as_key_compact_s {
+	/**
+	 * Interned namespace name.
+	 */
+	const char* ns;
+
+	/**
+	 * Interned set name.
+	 */
+	const char* set;
+
+	/**
+	 * Optional user key. Released by as_key_compact_destroy().
+	 */
+	as_key_value* valuep;
+
+	/**
+	 * Record digest.
+	 */
+	as_digest_value digest;
+
+} as_key_compact;
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -654,6 +718,90 @@ as_key_digest(as_key* key);
 AS_EXTERN as_status
 as_key_set_digest(as_error* err, as_key* key);
 
+/**
+ * Set the digest values of multiple keys. Digests are computed concurrently when the cpu
+ * supports multi-buffer hashing (AVX2). Keys that already have a digest are skipped.
+ * Keys must be integer, string or blob. Otherwise, an error is returned.
+ *
+ * @param err	Error message that is populated on error.
+ * @param keys	Keys to set digests for.
+ * @param n		Number of keys.
+ *
+ * @return Status code.
+ *
+ * @relates as_key
+ */
+AS_EXTERN as_status
+as_key_set_digests(as_error* err, as_key** keys, uint32_t n);
+
+/**
+ * Set namespace handle resolved by as_partition_tables_resolve() for key->ns, so the first
+ * command on this key does not look up its namespace by name. Keys also cache the handle
+ * themselves after their first command.
+ *
+ * @param key		The key to set the handle for.
+ * @param handle	Handle of key->ns.
+ *
+ * @relates as_key
+ */
+static inline void
+as_key_set_ns_handle(as_key* key, as_namespace_handle handle)
+{
+	key->ns_handle = handle;
+}
+
+/**
+ * Return a process lifetime copy of a namespace or set name. Equal names return the same
+ * pointer, so compact keys can compare names by pointer. Interned names are never freed,
+ * so only intern the bounded set of namespace and set names an application uses.
+ *
+ * @param name	Namespace or set name.
+ *
+ * @return Interned name or NULL if the name is longer than a set name.
+ *
+ * @relates as_key_compact
+ */
+AS_EXTERN const char*
+as_key_intern(const char* name);
+
+/**
+ * Initialize compact key from an as_key. The key digest is computed if it was not already
+ * set. If keep_value is true, the user key is retained by the compact key.
+ *
+ * @param ck			Compact key to initialize.
+ * @param err			Error message that is populated on error.
+ * @param key			Source key.
+ * @param keep_value	Retain user key.
+ *
+ * @return Status code.
+ *
+ * @relates as_key_compact
+ */
+AS_EXTERN as_status
+as_key_compact_init(as_key_compact* ck, as_error* err, as_key* key, bool keep_value);
+
+/**
+ * Initialize an as_key from a compact key. The as_key holds its own reference to the user
+ * key, so it must be released with as_key_destroy().
+ *
+ * @param ck	Source compact key.
+ * @param key	Key to initialize.
+ *
+ * @return The initialized key.
+ *
+ * @relates as_key_compact
+ */
+AS_EXTERN as_key*
+as_key_compact_to_key(const as_key_compact* ck, as_key* key);
+
+/**
+ * Release user key of a compact key.
+ *
+ * @relates as_key_compact
+ */
+AS_EXTERN void
+as_key_compact_destroy(as_key_compact* ck);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
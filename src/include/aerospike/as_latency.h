@@ -18,6 +18,7 @@
 
 #include <aerospike/as_atomic.h>
 #include <citrusleaf/alloc.h>
+#include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,12 +35,85 @@ typedef uint8_t as_latency_type;
 #define AS_LATENCY_TYPE_READ 2
 #define AS_LATENCY_TYPE_BATCH 3
 #define AS_LATENCY_TYPE_QUERY 4
-#define AS_LATENCY_TYPE_NONE 5
-#define AS_LATENCY_TYPE_MAX 5
+#define AS_LATENCY_TYPE_OPERATE 5
+#define AS_LATENCY_TYPE_UDF 6
+#define AS_LATENCY_TYPE_SCAN 7
+#define AS_LATENCY_TYPE_TXN_VERIFY 8
+#define AS_LATENCY_TYPE_TXN_ROLL 9
+#define AS_LATENCY_TYPE_NONE 10
+#define AS_LATENCY_TYPE_MAX 10
+
+/**
+ * Maximum number of application latency tags. Commands with as_policy_base.latency_tag
+ * set to 1..AS_LATENCY_TAG_MAX are also recorded in that tag's latency histogram.
+ */
+#define AS_LATENCY_TAG_MAX 8
+
+/**
+ * Number of latency histograms per namespace: one for each latency type followed by one for
+ * each application latency tag.
+ */
+#define AS_LATENCY_SLOTS (AS_LATENCY_TYPE_MAX + AS_LATENCY_TAG_MAX)
+
+/**
+ * Latency histogram index of an application latency tag (1..AS_LATENCY_TAG_MAX).
+ */
+#define AS_LATENCY_TAG_SLOT(tag) (AS_LATENCY_TYPE_MAX + (tag) - 1)
+
+/**
+ * Cluster tend phases timed with their own high resolution latency histogram.
+ */
+typedef uint8_t as_tend_phase;
+
+#define AS_TEND_PHASE_NODES 0
+#define AS_TEND_PHASE_PEERS 1
+#define AS_TEND_PHASE_PARTITIONS 2
+#define AS_TEND_PHASE_RACKS 3
+#define AS_TEND_PHASE_MANAGE 4
+#define AS_TEND_PHASE_BALANCE 5
+#define AS_TEND_PHASE_MAX 6
+
+/**
+ * Transaction commit and abort phases timed with their own high resolution latency histogram.
+ */
+typedef uint8_t as_txn_phase;
+
+#define AS_TXN_PHASE_VERIFY 0
+#define AS_TXN_PHASE_MARK_ROLL_FORWARD 1
+#define AS_TXN_PHASE_ROLL_FORWARD 2
+#define AS_TXN_PHASE_ROLL_BACK 3
+#define AS_TXN_PHASE_CLOSE 4
+#define AS_TXN_PHASE_MAX 5
+
+/**
+ * Maximum sub-bucket precision bits of high resolution latency histograms.
+ */
+#define AS_LATENCY_HDR_PRECISION_MAX 7
+
+/**
+ * Number of independently updated copies of each high resolution latency histogram.
+ * Threads are spread across stripes to reduce cache line contention.
+ */
+#define AS_LATENCY_HDR_STRIPES 4
+
+/**
+ * Number of independently updated copies of each latency histogram and namespace metrics
+ * counter. Threads are spread across stripes to reduce cache line contention.
+ */
+#define AS_METRICS_STRIPES 8
+
+/**
+ * Maximum elapsed time in microseconds tracked by high resolution latency histograms
+ * (~134 seconds). Larger values are recorded in the last bucket.
+ */
+#define AS_LATENCY_HDR_MAX_US ((1ULL << 27) - 1)
 
 /**
  * Latency histogram for a command group.
  * Latency histogram counts are cumulative and not reset on each metrics snapshot interval
+ *
+ * Buckets are stored AS_METRICS_STRIPES times, each stripe as_latency_stride() buckets apart,
+ * and summed when read.
  */
 typedef struct as_latency_s {
 	uint32_t ref_count;
@@ -48,10 +122,74 @@ typedef struct as_latency_s {
 	uint64_t buckets[];
 } as_latency;
 
+/**
+ * High resolution log-linear latency histogram for a command group. Elapsed times (in
+ * microseconds) below 2^precision have their own bucket. Each subsequent power of 2 range
+ * is split into 2^(precision - 1) equal sized buckets, so the relative error of a recorded
+ * value is bounded by 2^-(precision - 1).
+ *
+ * Buckets are stored AS_LATENCY_HDR_STRIPES times and merged when read. Counts are
+ * cumulative and not reset on each metrics snapshot interval.
+ */
+typedef struct as_latency_hdr_s {
+	uint32_t ref_count;
+	uint8_t precision;
+	uint32_t size;
+	uint64_t buckets[];
+} as_latency_hdr;
+
+/**
+ * Latency percentiles in microseconds calculated from high resolution latency histograms.
+ * Each percentile is the highest value that is equivalent to its bucket.
+ */
+typedef struct as_latency_percentiles_s {
+	uint64_t count;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+	uint64_t p999;
+	uint64_t max;
+} as_latency_percentiles;
+
 //---------------------------------
 // Functions
 //---------------------------------
 
+/**
+ * @private
+ * Return metrics stripe of the current thread. Event loop threads and sync command threads
+ * have stable thread ids, so each thread usually stays on the same stripe.
+ */
+static inline uint32_t
+as_metrics_stripe(uint32_t stripes)
+{
+#if defined(_MSC_VER)
+	uintptr_t id = (uintptr_t)pthread_self().p;
+#else
+	uintptr_t id = (uintptr_t)pthread_self();
+#endif
+	id ^= id >> 17;
+	id ^= id >> 9;
+	return (uint32_t)(id % stripes);
+}
+
+/**
+ * @private
+ * Return distance in buckets between latency histogram stripes. Stripes are separated by at
+ * least one cache line, so buckets of different stripes never share a cache line.
+ */
+static inline uint32_t
+as_latency_stride(uint8_t size)
+{
+	return ((size + 7u) & ~7u) + 8;
+}
+
+/**
+ * Create latency histogram.
+ */
+AS_EXTERN as_latency*
+as_latency_create(uint8_t shift, uint8_t size);
+
 /**
  * Reserver latency histogram.
  */
@@ -76,20 +214,91 @@ as_latency_release(as_latency* latency)
 }
 
 /**
- * Retrieve specified bucket using atomics.
+ * Retrieve specified bucket summed across stripes using atomics.
  */
 static inline uint64_t
 as_latency_get_bucket(as_latency* latency, uint32_t index)
 {
-	return as_load_uint64(&latency->buckets[index]);
+	uint32_t stride = as_latency_stride(latency->size);
+	uint64_t sum = 0;
+
+	for (uint32_t i = 0; i < AS_METRICS_STRIPES; i++) {
+		sum += as_load_uint64(&latency->buckets[i * stride + index]);
+	}
+	return sum;
+}
+
+/**
+ * Create high resolution latency histogram. Precision must be between 1 and
+ * AS_LATENCY_HDR_PRECISION_MAX.
+ */
+AS_EXTERN as_latency_hdr*
+as_latency_hdr_create(uint8_t precision);
+
+/**
+ * Reserve high resolution latency histogram.
+ */
+static inline as_latency_hdr*
+as_latency_hdr_reserve(as_latency_hdr** ptr)
+{
+	as_latency_hdr* hdr = (as_latency_hdr*)as_load_ptr((void* const*)ptr);
+
+	if (hdr) {
+		as_incr_uint32(&hdr->ref_count);
+	}
+	return hdr;
+}
+
+/**
+ * Release high resolution latency histogram.
+ */
+static inline void
+as_latency_hdr_release(as_latency_hdr* hdr)
+{
+	if (as_aaf_uint32_rls(&hdr->ref_count, -1) == 0) {
+		as_fence_acq();
+		cf_free(hdr);
+	}
 }
 
+/**
+ * Record elapsed time in microseconds.
+ */
+AS_EXTERN void
+as_latency_hdr_add(as_latency_hdr* hdr, uint64_t elapsed_us);
+
+/**
+ * Add all stripes into counts. The counts array must have hdr->size entries.
+ */
+AS_EXTERN void
+as_latency_hdr_merge(as_latency_hdr* hdr, uint64_t* counts);
+
+/**
+ * Calculate percentiles from counts merged from histograms with the given precision.
+ */
+AS_EXTERN void
+as_latency_hdr_percentiles(
+	uint8_t precision, const uint64_t* counts, uint32_t size, as_latency_percentiles* out
+	);
+
 /**
  * Convert latency_type to string version for printing to the output file
  */
 AS_EXTERN char*
 as_latency_type_to_string(as_latency_type type);
 
+/**
+ * Convert tend phase to string version for printing to the output file
+ */
+AS_EXTERN const char*
+as_tend_phase_to_string(as_tend_phase phase);
+
+/**
+ * Convert transaction phase to string version for printing to the output file
+ */
+AS_EXTERN const char*
+as_txn_phase_to_string(as_txn_phase phase);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Maximum formatted log message size delivered by the async logger. Longer messages are
+ * truncated.
+ */
+#define AS_LOG_ASYNC_MSG_SIZE 512
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Deliver client log messages to callback from a background thread. Threads that log only
+ * format the message into a lock-free ring buffer, so slow callbacks (file or network writes)
+ * do not add latency to commands, retries or cluster tend during bursts of log messages.
+ * Messages are dropped when the ring buffer is full. See as_log_async_dropped().
+ *
+ * The callback is always called with format "%s" and the formatted message. Messages below
+ * the level set by as_log_set_level() are still skipped before they are formatted.
+ *
+ * Call this function before aerospike_connect() instead of as_log_set_callback().
+ *
+ * @param err		The as_error to be populated if an error occurs.
+ * @param capacity	Number of messages the ring buffer can hold. Rounded up to a power of 2.
+ * @param callback	User log callback called from the background thread.
+ * @return AEROSPIKE_OK If successful. Otherwise an error.
+ */
+AS_EXTERN as_status
+as_log_async_start(as_error* err, uint32_t capacity, as_log_callback callback);
+
+/**
+ * Deliver messages remaining in the ring buffer, stop the background thread and set callback
+ * to be called directly again. Call after all clients are closed.
+ */
+AS_EXTERN void
+as_log_async_stop(void);
+
+/**
+ * Return count of log messages dropped because the ring buffer was full.
+ */
+AS_EXTERN uint64_t
+as_log_async_dropped(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
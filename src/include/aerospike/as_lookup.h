@@ -19,6 +19,7 @@
 #include <aerospike/as_address.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_status.h>
+#include <citrusleaf/alloc.h>
 
 #if !defined(_MSC_VER)
 #include <netdb.h>
@@ -41,6 +42,7 @@ typedef struct as_sockaddr_iterator_s {
 	struct addrinfo* current;
 	uint16_t port_be;
 	bool hostname_is_alias;
+	bool cached;
 } as_address_iterator;
 
 struct as_cluster_s;
@@ -57,6 +59,16 @@ struct as_host_s;
  */
 as_status
 as_lookup_host(as_address_iterator* iter, as_error* err, const char* hostname, uint16_t port);
+
+/**
+ * @private
+ * Lookup hostname using the cluster's DNS cache when enabled and initialize address iterator.
+ */
+as_status
+as_lookup_host_cluster(
+	struct as_cluster_s* cluster, as_address_iterator* iter, as_error* err, const char* hostname,
+	uint16_t port
+	);
 	
 /**
  * @private
@@ -89,7 +101,13 @@ as_lookup_next(as_address_iterator* iter, struct sockaddr** addr)
 static inline void
 as_lookup_end(as_address_iterator* iter)
 {
-	freeaddrinfo(iter->addresses);
+	if (iter->cached) {
+		// Cached addresses are copied into a single allocation.
+		cf_free(iter->addresses);
+	}
+	else {
+		freeaddrinfo(iter->addresses);
+	}
 }
 
 /**
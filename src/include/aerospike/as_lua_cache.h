@@ -0,0 +1,63 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Reset tracked UDF files after the global lua configuration changed.
+ */
+void
+as_lua_cache_configure(as_config_lua* config);
+
+/**
+ * @private
+ * Make sure the lua states cached for a client aggregation module reflect the module file
+ * in as_config_lua.user_path. The module is reloaded when the file modification time changed
+ * or the module was uploaded or removed since it was last validated. Does nothing if
+ * as_config_lua.cache_enabled is false.
+ */
+void
+as_lua_cache_validate(const char* module);
+
+/**
+ * @private
+ * Force the next aggregation that uses this UDF file to reload its cached lua states.
+ */
+void
+as_lua_cache_invalidate(const char* filename);
+
+/**
+ * @private
+ * Return count of aggregations that used cached lua states and count of aggregations that
+ * reloaded the module. Counts are process-wide since lua configuration is global.
+ */
+void
+as_lua_cache_stats(uint64_t* hits, uint64_t* misses);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_std.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Client wide budget of bytes held by in-flight command request and response buffers.
+ * Large commands must be admitted before they are sent. Response buffers are always
+ * charged when allocated, so a budget may be temporarily exceeded by responses of already
+ * admitted commands, but no new large command is admitted until usage drops again.
+ */
+typedef struct as_mem_budget_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint64_t capacity;
+	uint64_t used;
+	uint64_t peak;
+	uint64_t rejects;
+	uint32_t waiters;
+} as_mem_budget;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create budget of capacity bytes.
+ */
+as_mem_budget*
+as_mem_budget_create(uint64_t capacity);
+
+/**
+ * @private
+ * Destroy budget.
+ */
+void
+as_mem_budget_destroy(as_mem_budget* budget);
+
+/**
+ * @private
+ * Admit a command holding size bytes. Wait up to max_wait_ms for other commands to release
+ * their buffers if the budget is exhausted. A command is always admitted when nothing else
+ * is charged, so a single command larger than the budget does not wait forever.
+ * Return AEROSPIKE_ERR_MEMORY_BUDGET if the command was not admitted.
+ */
+as_status
+as_mem_budget_acquire(as_mem_budget* budget, as_error* err, uint64_t size, uint32_t max_wait_ms);
+
+/**
+ * @private
+ * Release bytes that were acquired or charged.
+ */
+void
+as_mem_budget_release(as_mem_budget* budget, uint64_t size);
+
+/**
+ * @private
+ * Charge bytes without admission control. Used for response buffers of commands that were
+ * already admitted.
+ */
+static inline void
+as_mem_budget_charge(as_mem_budget* budget, uint64_t size)
+{
+	if (! budget || size == 0) {
+		return;
+	}
+
+	uint64_t used = as_aaf_uint64(&budget->used, size);
+	uint64_t peak = as_load_uint64(&budget->peak);
+
+	while (used > peak) {
+		if (as_cas_uint64(&budget->peak, peak, used)) {
+			break;
+		}
+		peak = as_load_uint64(&budget->peak);
+	}
+}
+
+/**
+ * @private
+ * Release bytes if the budget exists.
+ */
+static inline void
+as_mem_budget_uncharge(as_mem_budget* budget, uint64_t size)
+{
+	if (budget && size > 0) {
+		as_mem_budget_release(budget, size);
+	}
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
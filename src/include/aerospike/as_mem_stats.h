@@ -0,0 +1,151 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Client subsystem that owns an allocation. Allocations are only accounted when the client
+ * is built with USE_MEM_STATS=1.
+ *
+ * @ingroup cluster_stats
+ */
+typedef enum as_mem_tag_e {
+	/**
+	 * Heap command buffers, including buffers retained by the thread buffer cache, and
+	 * pooled async command objects. Async commands too large for the command pool are
+	 * not included.
+	 */
+	AS_MEM_TAG_COMMAND,
+
+	/**
+	 * Shared record response buffers referenced by zero copy and lazy records.
+	 */
+	AS_MEM_TAG_RECORD,
+
+	/**
+	 * Key arrays of as_batch.
+	 */
+	AS_MEM_TAG_BATCH,
+
+	/**
+	 * Partition trackers and command templates of async partition scans and queries.
+	 */
+	AS_MEM_TAG_SCAN,
+
+	/**
+	 * Sync connection pool queues and connection caches.
+	 */
+	AS_MEM_TAG_POOL,
+
+	/**
+	 * Nodes and partition tables.
+	 */
+	AS_MEM_TAG_CLUSTER,
+
+	/**
+	 * Transactions and their key tables.
+	 */
+	AS_MEM_TAG_TXN,
+
+	/**
+	 * Number of tags.
+	 */
+	AS_MEM_TAG_MAX
+} as_mem_tag;
+
+/**
+ * Allocated bytes of a single tag. Counts are process wide, because allocations like the
+ * thread buffer cache are shared by all aerospike instances.
+ *
+ * @ingroup cluster_stats
+ */
+typedef struct as_mem_tag_stats_s {
+	/**
+	 * Bytes currently allocated.
+	 */
+	uint64_t current;
+
+	/**
+	 * Highest value of current since the process started.
+	 */
+	uint64_t peak;
+} as_mem_tag_stats;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Return tag name.
+ */
+AS_EXTERN const char*
+as_mem_tag_name(as_mem_tag tag);
+
+/**
+ * Copy current and peak bytes of all tags into stats, which must hold AS_MEM_TAG_MAX
+ * entries. Counts are zero when the client is not built with USE_MEM_STATS=1.
+ */
+AS_EXTERN void
+as_mem_stats_get(as_mem_tag_stats* stats);
+
+#if defined(AS_MEM_STATS)
+
+/**
+ * @private
+ * Account bytes allocated by a tag.
+ */
+void
+as_mem_stats_alloc(as_mem_tag tag, size_t size);
+
+/**
+ * @private
+ * Account bytes freed by a tag. Size must match the size accounted on allocation.
+ */
+void
+as_mem_stats_free(as_mem_tag tag, size_t size);
+
+#else
+
+static inline void
+as_mem_stats_alloc(as_mem_tag tag, size_t size)
+{
+	(void)tag;
+	(void)size;
+}
+
+static inline void
+as_mem_stats_free(as_mem_tag tag, size_t size)
+{
+	(void)tag;
+	(void)size;
+}
+
+#endif
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
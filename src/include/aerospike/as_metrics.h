@@ -152,6 +152,54 @@ typedef struct as_metrics_policy_s {
 	 */
 	uint8_t latency_shift;
 
+	/**
+	 * Sub-bucket precision bits of optional high resolution (log-linear) latency histograms.
+	 * When non-zero, each latency type is also recorded in microsecond buckets where the
+	 * relative error is bounded by 2^-(latency_precision - 1). This allows p99 and p99.9 to
+	 * be distinguished. Percentiles are written by the default metrics writer and returned
+	 * by aerospike_stats(). Valid values are 0 (disabled) to 7.
+	 *
+	 * Default: 0
+	 */
+	uint8_t latency_precision;
+
+	/**
+	 * Number of heaviest keys tracked per node namespace. When non-zero, single record
+	 * commands count their key digest in a count-min sketch and the heaviest digests and
+	 * their sets are reported by the default metrics writer. Counts are halved every
+	 * metrics interval, so hot keys reflect recent traffic. Maximum is AS_HOT_KEYS_MAX.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t hot_keys;
+
+	/**
+	 * Latency sample rate of per-partition heatmaps. When non-zero, each node namespace
+	 * counts single record command attempts, timeouts, key busy errors and retries per
+	 * partition, and records the latency of one of every partition_heatmap attempts on a
+	 * partition. Counters cover the last metrics interval and are written by the default
+	 * metrics writer as [partitionId,commands,timeouts,keyBusy,retries,latencyCount,
+	 * latencySumUs] for each partition with activity. Partition ids match the output of
+	 * as_partition_tables_dump(). Custom listeners can call as_partition_heat_get_ns() for
+	 * a namespace wide heatmap.
+	 *
+	 * Each enabled node namespace uses 24 bytes per partition (96KB for 4096 partitions).
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t partition_heatmap;
+
+	/**
+	 * Minimum milliseconds between kernel TCP state (TCP_INFO) samples of each node. When
+	 * non-zero, a sync or async connection returned to a node's pool is sampled once the
+	 * interval has elapsed. Smoothed round trip time, its variance, retransmitted segments
+	 * per connection and the congestion window are reported per node by the default metrics
+	 * writer and aerospike_stats(), so network latency can be told apart from server latency.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t tcp_info_interval;
+
 	/**
 	 * @private
 	 * Should metrics be started as part of dynamic configuration. If aerospike_enable_metrics()
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_metrics.h>
+#include <aerospike/as_socket.h>
+#include <aerospike/as_status.h>
+#include <aerospike/as_string_builder.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Rendered metrics page. Scrapes reserve the current page, so a page that is replaced while
+ * it is being sent is freed by the last scrape that releases it.
+ */
+typedef struct as_prometheus_page_s {
+	uint32_t ref_count;
+	uint32_t length;
+	char data[];
+} as_prometheus_page;
+
+/**
+ * Metrics listener that serves the latest metrics snapshot in OpenMetrics text format on
+ * an embedded HTTP endpoint (GET /metrics). The page is rendered on each metrics snapshot
+ * interval into a reusable buffer, so scrapes only copy the last rendered page to the socket.
+ */
+typedef struct as_metrics_prometheus_s {
+	pthread_mutex_t lock;
+	pthread_t thread;
+	as_string_builder render;
+	as_prometheus_page* page;
+	as_vector* labels;
+	struct sockaddr_storage addr;
+	as_socket_fd fd;
+	uint16_t port;
+	uint8_t running;
+	bool enable;
+} as_metrics_prometheus;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Create OpenMetrics listener and assign its callbacks to listeners. The HTTP endpoint
+ * is started when metrics are enabled and stopped when metrics are disabled.
+ *
+ * @code
+ * as_metrics_policy policy;
+ * as_metrics_policy_init(&policy);
+ * as_metrics_policy_add_label(&policy, "region", "us-west");
+ *
+ * if (as_metrics_prometheus_create(&err, &policy, NULL, 9145, &policy.metrics_listeners) == AEROSPIKE_OK) {
+ *     aerospike_enable_metrics(&as, &err, &policy);
+ * }
+ * @endcode
+ *
+ * @param err		Error detail.
+ * @param policy	Metrics policy. Labels are copied into the listener.
+ * @param address	Numeric IPv4 or IPv6 address to listen on. Use "0.0.0.0" to listen on all
+ *					IPv4 interfaces. If NULL, only loopback connections ("127.0.0.1") are
+ *					accepted.
+ * @param port		TCP port to listen on.
+ * @param listeners	Listeners to populate.
+ */
+AS_EXTERN as_status
+as_metrics_prometheus_create(
+	as_error* err, const as_metrics_policy* policy, const char* address, uint16_t port,
+	as_metrics_listeners* listeners
+	);
+
+AS_EXTERN as_status
+as_metrics_prometheus_enable(as_error* err, void* udata);
+
+AS_EXTERN as_status
+as_metrics_prometheus_snapshot(as_error* err, as_cluster* cluster, void* udata);
+
+AS_EXTERN as_status
+as_metrics_prometheus_node_close(as_error* err, struct as_node_s* node, void* udata);
+
+AS_EXTERN as_status
+as_metrics_prometheus_disable(as_error* err, struct as_cluster_s* cluster, void* udata);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
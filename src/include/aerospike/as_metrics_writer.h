@@ -47,6 +47,10 @@ typedef struct as_metrics_writer_s {
 	uint64_t size;
 	uint8_t latency_columns;
 	uint8_t latency_shift;
+	uint8_t latency_precision;
+	uint32_t hot_keys;
+	uint32_t partition_heatmap;
+	uint32_t tcp_info_interval;
 #ifdef _MSC_VER
 	FILETIME prev_process_times_kernel;
 	FILETIME prev_system_times_kernel;
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_record.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Maximum number of clusters in a multi-cluster client.
+ */
+#define AS_MULTI_CLUSTER_MAX 8
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Multi-cluster routing policy.
+ *
+ * @ingroup client_objects
+ */
+typedef struct as_multi_cluster_policy_s {
+	/**
+	 * Index of the cluster that receives all writes.
+	 *
+	 * Default: 0
+	 */
+	uint32_t primary;
+
+	/**
+	 * Interval in milliseconds between cluster score updates. Each cluster is scored from
+	 * the read latency and error rate seen since the previous update. When metrics are
+	 * enabled on a cluster with aerospike_enable_metrics(), its namespace metrics are used,
+	 * which include reads not routed through this client. Otherwise, only reads routed
+	 * through this client are used.
+	 *
+	 * Default: 1000
+	 */
+	uint32_t score_interval_ms;
+
+	/**
+	 * Score penalty in microseconds for each percent of reads that failed, so a fast cluster
+	 * that fails often loses to a slower healthy cluster.
+	 *
+	 * Default: 10000
+	 */
+	uint32_t error_penalty_us;
+
+	/**
+	 * Percent of reads sent to a cluster other than the best cluster, so scores of idle
+	 * clusters stay current and a recovered cluster is chosen again.
+	 *
+	 * Default: 1
+	 */
+	uint32_t probe_pct;
+
+	/**
+	 * Start the same read on the next best cluster when the best cluster has not answered
+	 * within this many milliseconds. The first successful answer is returned. Requires
+	 * async event loops. Zero disables hedging.
+	 *
+	 * Default: 0
+	 */
+	uint32_t hedge_delay_ms;
+} as_multi_cluster_policy;
+
+/**
+ * Routing statistics of one cluster.
+ *
+ * @ingroup client_objects
+ */
+typedef struct as_multi_cluster_stats_s {
+	/**
+	 * Current score in microseconds. Lower is better. UINT64_MAX if the cluster is not
+	 * connected.
+	 */
+	uint64_t score_us;
+
+	/**
+	 * Reads sent to this cluster, including failovers, probes and hedges.
+	 */
+	uint64_t reads;
+
+	/**
+	 * Reads sent to this cluster that failed.
+	 */
+	uint64_t read_errors;
+
+	/**
+	 * Reads retried on another cluster after this cluster failed.
+	 */
+	uint64_t failovers;
+
+	/**
+	 * Hedged reads started on this cluster.
+	 */
+	uint64_t hedges;
+
+	/**
+	 * Writes sent to this cluster.
+	 */
+	uint64_t writes;
+} as_multi_cluster_stats;
+
+/**
+ * Thin client layer over aerospike instances connected to clusters that hold the same data,
+ * for example clusters in different regions replicated with XDR. Reads go to the cluster
+ * with the best score, fail over to the next best cluster on timeouts and connection or
+ * cluster errors, and can be hedged. Writes go to the primary cluster.
+ *
+ * Records written to the primary may not have been replicated to the cluster that serves a
+ * following read.
+ *
+ * ~~~~~~~~~~{.c}
+ * aerospike* clusters[] = {&local, &remote};
+ *
+ * as_multi_cluster_policy policy;
+ * as_multi_cluster_policy_init(&policy);
+ *
+ * as_multi_cluster* mc = as_multi_cluster_create(&err, clusters, 2, &policy);
+ *
+ * if (mc) {
+ *     as_multi_cluster_get(mc, &err, NULL, &key, &rec);
+ *     ...
+ *     as_multi_cluster_destroy(mc);
+ * }
+ * ~~~~~~~~~~
+ *
+ * @ingroup client_objects
+ */
+typedef struct as_multi_cluster_s as_multi_cluster;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize multi-cluster policy to default values.
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN void
+as_multi_cluster_policy_init(as_multi_cluster_policy* policy);
+
+/**
+ * Create multi-cluster client over connected aerospike instances. The instances are not
+ * owned and must outlive the multi-cluster client. Return NULL and set err on failure.
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN as_multi_cluster*
+as_multi_cluster_create(
+	as_error* err, aerospike** clusters, uint32_t n_clusters, const as_multi_cluster_policy* policy
+	);
+
+/**
+ * Release multi-cluster client. The aerospike instances are not closed.
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN void
+as_multi_cluster_destroy(as_multi_cluster* mc);
+
+/**
+ * Read all bins of a record from the best cluster. See aerospike_key_get().
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN as_status
+as_multi_cluster_get(
+	as_multi_cluster* mc, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_record** rec
+	);
+
+/**
+ * Read selected bins of a record from the best cluster. See aerospike_key_select().
+ * Select reads are not hedged.
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN as_status
+as_multi_cluster_select(
+	as_multi_cluster* mc, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record** rec
+	);
+
+/**
+ * Write record to the primary cluster. See aerospike_key_put().
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN as_status
+as_multi_cluster_put(
+	as_multi_cluster* mc, as_error* err, const as_policy_write* policy, const as_key* key,
+	as_record* rec
+	);
+
+/**
+ * Remove record from the primary cluster. See aerospike_key_remove().
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN as_status
+as_multi_cluster_remove(
+	as_multi_cluster* mc, as_error* err, const as_policy_remove* policy, const as_key* key
+	);
+
+/**
+ * Run operations on the primary cluster. See aerospike_key_operate().
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN as_status
+as_multi_cluster_operate(
+	as_multi_cluster* mc, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_operations* ops, as_record** rec
+	);
+
+/**
+ * Return the primary cluster for commands not routed by this layer.
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN aerospike*
+as_multi_cluster_primary(as_multi_cluster* mc);
+
+/**
+ * Copy routing statistics of the cluster at index. Return false if index is out of range.
+ *
+ * @relates as_multi_cluster
+ */
+AS_EXTERN bool
+as_multi_cluster_get_stats(as_multi_cluster* mc, uint32_t index, as_multi_cluster_stats* stats);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
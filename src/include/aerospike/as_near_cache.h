@@ -0,0 +1,299 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_near_cache_file.h>
+#include <aerospike/as_record.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Near cache configuration.
+ *
+ * @relates as_near_cache
+ */
+typedef struct as_near_cache_config_s {
+	/**
+	 * Maximum number of records held by the cache. When full, an entry that was not read
+	 * since the eviction hand last passed it is replaced.
+	 *
+	 * Default: 10000
+	 */
+	uint32_t max_entries;
+
+	/**
+	 * Number of independently locked shards. Keys are distributed by digest.
+	 *
+	 * Default: 16
+	 */
+	uint32_t shards;
+
+	/**
+	 * Maximum time in milliseconds a cached record is served. A record is also never served
+	 * after its server time-to-live has expired. Expired entries are read again in full.
+	 *
+	 * Default: 1000
+	 */
+	uint32_t ttl_ms;
+
+	/**
+	 * If non-zero, a cached record that has not been validated for this many milliseconds is
+	 * validated with a header-only read before it is served. The cached record is served if its
+	 * generation still matches. Otherwise, the record is read again in full. If zero, records
+	 * are served until ttl_ms expires without contacting the server.
+	 *
+	 * Default: 0
+	 */
+	uint32_t validate_ms;
+
+	/**
+	 * If not NULL, records are also cached in this memory-mapped file, which is reopened by
+	 * the next process that creates a cache with the same path. Reads that miss the in-process
+	 * cache are served from the file and copied into the in-process cache. Intended for large
+	 * read-mostly datasets that would otherwise be read again in full after every restart.
+	 * Not supported on Windows.
+	 *
+	 * Default: NULL
+	 */
+	const char* file_path;
+
+	/**
+	 * Size of the cache file in bytes, including its slot table. When the file is full, the
+	 * oldest records are dropped. A file created with another size or max entries is cleared.
+	 *
+	 * Default: 1 GiB
+	 */
+	uint64_t file_size;
+
+	/**
+	 * Maximum number of records held by the cache file.
+	 *
+	 * Default: 1000000
+	 */
+	uint32_t file_max_entries;
+
+	/**
+	 * A file record that has not been validated for this many seconds is validated with a
+	 * header-only read before it is served. Records are validated when written, by
+	 * as_near_cache_validate() and by as_near_cache_load(). If zero, every file record is
+	 * validated before it is served.
+	 *
+	 * Default: 600
+	 */
+	uint32_t file_validate_sec;
+} as_near_cache_config;
+
+/**
+ * @private
+ * Cached record.
+ */
+typedef struct as_near_cache_entry_s {
+	struct as_near_cache_entry_s* next;
+	as_record* rec;
+	uint64_t expires_ms;
+	uint64_t validated_ms;
+	uint32_t slot;
+	uint8_t referenced;
+	as_digest_value digest;
+	as_namespace ns;
+} as_near_cache_entry;
+
+/**
+ * @private
+ * Cache shard. Lookups hold the read lock, so hits on the same shard proceed in parallel.
+ * Entries are also held in a ring that the CLOCK eviction hand walks.
+ */
+typedef struct as_near_cache_shard_s {
+	pthread_rwlock_t lock;
+	as_near_cache_entry** buckets;
+	as_near_cache_entry** ring;
+	uint32_t n_buckets;
+	uint32_t capacity;
+	uint32_t size;
+	uint32_t hand;
+} as_near_cache_shard;
+
+/**
+ * Bounded in-process cache of records read with aerospike_key_get_cached(). Intended for
+ * records that are read far more often than they are written. Writes made through other
+ * clients, or through this client without calling as_near_cache_remove(), are only seen when
+ * the cached entry expires or fails generation validation.
+ *
+ * Cache hits and misses are counted per node and namespace in as_ns_metrics.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_near_cache_config config;
+ * as_near_cache_config_init(&config);
+ * config.validate_ms = 100;
+ *
+ * as_near_cache* cache = as_near_cache_create(&config);
+ *
+ * as_record* rec = NULL;
+ * aerospike_key_get_cached(&as, &err, cache, NULL, &key, &rec);
+ * as_record_destroy(rec);
+ * ...
+ * as_near_cache_destroy(cache);
+ * ~~~~~~~~~~
+ *
+ * @ingroup key_operations
+ */
+typedef struct as_near_cache_s {
+	as_near_cache_shard* shards;
+	uint32_t n_shards;
+	uint32_t ttl_ms;
+	uint32_t validate_ms;
+	as_near_cache_file* file;
+
+	/**
+	 * Count of reads served from the cache.
+	 */
+	uint64_t hits;
+
+	/**
+	 * Count of reads served from the cache file. Included in hits.
+	 */
+	uint64_t file_hits;
+
+	/**
+	 * Count of reads that required a full read from the server.
+	 */
+	uint64_t misses;
+
+	/**
+	 * Count of header-only generation validation reads.
+	 */
+	uint64_t validations;
+} as_near_cache;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize near cache configuration to default values.
+ *
+ * @relates as_near_cache
+ */
+AS_EXTERN void
+as_near_cache_config_init(as_near_cache_config* config);
+
+/**
+ * Create near cache. The cache is not bound to an aerospike instance, but a cache should only
+ * be used with one cluster.
+ *
+ * @return Cache or NULL if the configuration is invalid or the cache file could not be opened.
+ * @relates as_near_cache
+ */
+AS_EXTERN as_near_cache*
+as_near_cache_create(const as_near_cache_config* config);
+
+/**
+ * Release cache and all cached records. Records previously returned by
+ * aerospike_key_get_cached() remain valid.
+ *
+ * @relates as_near_cache
+ */
+AS_EXTERN void
+as_near_cache_destroy(as_near_cache* cache);
+
+/**
+ * Remove record from cache. Call after this client writes a cached record so the next
+ * aerospike_key_get_cached() reads the new record.
+ *
+ * @relates as_near_cache
+ */
+AS_EXTERN as_status
+as_near_cache_remove(as_near_cache* cache, as_error* err, const as_key* key);
+
+/**
+ * Validate generations of all records in the cache file with header-only batch reads. Records
+ * that changed or were removed on the server are dropped, and the rest are served without
+ * validation for as_near_cache_config.file_validate_sec. Call after creating the cache to
+ * serve a restarted process's reads from the file without a header read per record.
+ *
+ * @param as		The aerospike instance to use for this operation.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param cache		The near cache.
+ * @param policy	The batch policy. If NULL, then the default policy will be used.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ * @relates as_near_cache
+ */
+AS_EXTERN as_status
+as_near_cache_validate(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_batch* policy
+	);
+
+/**
+ * Populate the cache file with all records of a set. A scan without bins returns each
+ * record's generation. Records that are already cached with that generation are marked valid,
+ * and the others are read in full with digest batch reads.
+ *
+ * @param as			The aerospike instance to use for this operation.
+ * @param err			The as_error to be populated if an error occurs.
+ * @param cache			The near cache.
+ * @param scan_policy	The scan policy. If NULL, then the default policy will be used.
+ * @param batch_policy	The batch policy. If NULL, then the default policy will be used.
+ * @param ns			The namespace to scan.
+ * @param set			The set to scan.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ * @relates as_near_cache
+ */
+AS_EXTERN as_status
+as_near_cache_load(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_scan* scan_policy,
+	const as_policy_batch* batch_policy, const char* ns, const char* set
+	);
+
+/**
+ * Read all bins of a record, serving the record from the near cache when a valid entry exists.
+ * The returned record does not have to be destroyed before the cache, but list, map and other
+ * heap allocated bin values are shared with the cache and must not be modified.
+ *
+ * Reads in a transaction, or with a filter expression or read_touch_ttl_percent, always go to
+ * the server and are not cached.
+ *
+ * @param as		The aerospike instance to use for this operation.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param cache		The near cache.
+ * @param policy	The policy to use for this operation. If NULL, then the default policy will be used.
+ * @param key		The key of the record.
+ * @param rec		The record to be populated with the data from cache or request.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ * @relates as_near_cache
+ */
+AS_EXTERN as_status
+aerospike_key_get_cached(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_read* policy,
+	const as_key* key, as_record** rec
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
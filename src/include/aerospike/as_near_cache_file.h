@@ -0,0 +1,140 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_record.h>
+#include <citrusleaf/cf_clock.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Records of the near cache file tier are stored in a memory-mapped file that survives process
+ * restarts. The file holds a digest indexed slot table and a ring of encoded records. When the
+ * ring or the slot table is full, the oldest records are dropped. A file may only be opened by
+ * one process at a time.
+ */
+typedef struct as_near_cache_file_s as_near_cache_file;
+
+/**
+ * @private
+ * File tier lookup result.
+ */
+typedef enum {
+	AS_NEAR_CACHE_FILE_MISS,
+	AS_NEAR_CACHE_FILE_HIT,
+	AS_NEAR_CACHE_FILE_VALIDATE
+} as_near_cache_file_result;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Return wall clock time in seconds. File timestamps must remain valid after a restart, so
+ * the monotonic clock is not used.
+ */
+static inline uint32_t
+as_near_cache_file_now(void)
+{
+	return (uint32_t)(cf_clock_getabsolute() / 1000);
+}
+
+/**
+ * @private
+ * Open or create file tier. A file created with a different size or entry count is cleared.
+ */
+as_status
+as_near_cache_file_open(
+	as_near_cache_file** file_out, as_error* err, const char* path, uint64_t size,
+	uint32_t max_entries, uint32_t validate_sec
+	);
+
+/**
+ * @private
+ * Flush and close file tier.
+ */
+void
+as_near_cache_file_close(as_near_cache_file* file);
+
+/**
+ * @private
+ * Find record in file tier. On HIT or VALIDATE, rec is set to a new record that the caller
+ * destroys. VALIDATE means the entry must pass generation validation before it is served.
+ */
+as_near_cache_file_result
+as_near_cache_file_get(as_near_cache_file* file, const as_key* key, uint32_t now, as_record** rec);
+
+/**
+ * @private
+ * Mark entry validated if its generation still matches. Return false if the entry was removed
+ * or replaced.
+ */
+bool
+as_near_cache_file_validated(
+	as_near_cache_file* file, const as_key* key, uint16_t gen, uint32_t ttl, uint32_t now
+	);
+
+/**
+ * @private
+ * Store record in file tier, replacing any previous entry of the digest.
+ */
+void
+as_near_cache_file_put(
+	as_near_cache_file* file, const char* ns, const char* set, const uint8_t* digest,
+	const as_record* rec, uint32_t now
+	);
+
+/**
+ * @private
+ * Remove record from file tier.
+ */
+void
+as_near_cache_file_remove(as_near_cache_file* file, const as_key* key);
+
+/**
+ * @private
+ * Validate generations of all file entries with header-only digest batch reads.
+ */
+as_status
+as_near_cache_file_validate(
+	as_near_cache_file* file, aerospike* as, as_error* err, const as_policy_batch* policy
+	);
+
+/**
+ * @private
+ * Populate file tier from a digest-only scan of a set.
+ */
+as_status
+as_near_cache_file_load(
+	as_near_cache_file* file, aerospike* as, as_error* err, const as_policy_scan* scan_policy,
+	const as_policy_batch* batch_policy, const char* ns, const char* set
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
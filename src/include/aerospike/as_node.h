@@ -25,8 +25,11 @@
 #include <aerospike/as_socket.h>
 #include <aerospike/as_partition.h>
 #include <aerospike/as_queue.h>
+#include <aerospike/as_sync_pipe.h>
+#include <aerospike/as_tcp_info.h>
 #include <aerospike/as_vector.h>
 #include <aerospike/as_version.h>
+#include <stddef.h>
 
 #if !defined(_MSC_VER)
 #include <netinet/in.h>
@@ -58,10 +61,26 @@ extern "C" {
 #define AS_FEATURES_QUERY_SHOW (1 << 1)
 #define AS_FEATURES_BATCH_ANY (1 << 2)
 #define AS_FEATURES_PARTITION_QUERY (1 << 3)
+#define AS_FEATURES_COMPRESS_LZ4 (1 << 4)
+#define AS_FEATURES_COMPRESS_ZSTD (1 << 5)
 
 #define AS_ADDRESS4_MAX 4
 #define AS_ADDRESS6_MAX 8
 
+/**
+ * @private
+ * Scale of as_node.error_ewma. An error_ewma of AS_NODE_EWMA_ERROR_SCALE indicates that
+ * all recent commands failed.
+ */
+#define AS_NODE_EWMA_ERROR_SCALE 1024
+
+/**
+ * Node circuit breaker states.
+ */
+#define AS_BREAKER_CLOSED 0
+#define AS_BREAKER_OPEN 1
+#define AS_BREAKER_HALF_OPEN 2
+
 //---------------------------------
 // Types
 //---------------------------------
@@ -151,6 +170,12 @@ typedef struct as_session_s {
 	 */
 	uint64_t expiration;
 
+	/**
+	 * Time when the tend thread renews the session before it expires. Zero if session
+	 * does not expire.
+	 */
+	uint64_t refresh;
+
 	/**
 	 * Session token for this node.
 	 */
@@ -188,17 +213,35 @@ typedef struct as_async_conn_pool_s {
 	 */
 	uint32_t closed;
 
-} as_async_conn_pool;
+	/**
+	 * Pipeline commands awaiting a response. Always zero for non-pipeline pools.
+	 */
+	uint32_t in_flight;
 
-/**
- * Namespace metrics.
- */
-typedef struct {
 	/**
-	 * Namespace.
+	 * Highest number of commands awaiting a response on a single pipeline connection.
+	 * Always zero for non-pipeline pools.
 	 */
-	const char* ns;
+	uint32_t max_depth;
+
+	/**
+	 * Total async connections opened beyond limit using the unused share of other event loops.
+	 * Always zero for pipeline pools.
+	 */
+	uint32_t borrowed;
 
+	/**
+	 * Pool usage window. Not used for pipeline pools.
+	 */
+	as_conn_window window;
+
+} as_async_conn_pool;
+
+/**
+ * Namespace metrics counters updated by one stripe of threads. Padded to two cache lines,
+ * so counters of different stripes never share a cache line.
+ */
+typedef struct as_ns_counters_s {
 	/**
 	 * Bytes received from the server.
 	 */
@@ -209,6 +252,26 @@ typedef struct {
 	 */
 	uint64_t bytes_out;
 
+	/**
+	 * Bytes received from the server in compressed responses.
+	 */
+	uint64_t bytes_in_comp;
+
+	/**
+	 * Uncompressed size of compressed responses.
+	 */
+	uint64_t bytes_in_uncomp;
+
+	/**
+	 * Bytes sent to the server in compressed commands.
+	 */
+	uint64_t bytes_out_comp;
+
+	/**
+	 * Uncompressed size of compressed commands.
+	 */
+	uint64_t bytes_out_uncomp;
+
 	/**
 	 * Command error count since node was initialized. If the error is retryable, multiple errors per
 	 * command may occur.
@@ -227,9 +290,53 @@ typedef struct {
 	uint64_t key_busy_count;
 
 	/**
-	 * Latency histograms.
+	 * Near cache hit count since node was initialized.
 	 */
-	as_latency* latency[AS_LATENCY_TYPE_MAX];
+	uint64_t near_cache_hit_count;
+
+	/**
+	 * Near cache miss count since node was initialized.
+	 */
+	uint64_t near_cache_miss_count;
+
+	uint8_t pad[40];
+
+} as_ns_counters;
+
+/**
+ * Namespace metrics.
+ */
+typedef struct {
+	/**
+	 * Namespace.
+	 */
+	const char* ns;
+
+	/**
+	 * Counters striped by thread. Use the as_node_get_*() functions to read totals.
+	 */
+	as_ns_counters counters[AS_METRICS_STRIPES];
+
+	/**
+	 * Latency histograms indexed by latency type, followed by application latency tags.
+	 */
+	as_latency* latency[AS_LATENCY_SLOTS];
+
+	/**
+	 * High resolution latency histograms. Entries are NULL when
+	 * as_metrics_policy.latency_precision is zero.
+	 */
+	as_latency_hdr* latency_hdr[AS_LATENCY_SLOTS];
+
+	/**
+	 * Heaviest keys. NULL when as_metrics_policy.hot_keys is zero.
+	 */
+	struct as_hot_keys_s* hot_keys;
+
+	/**
+	 * Per-partition counters. NULL when as_metrics_policy.partition_heatmap is zero.
+	 */
+	struct as_partition_heat_s* partition_heat;
 
 } as_ns_metrics;
 
@@ -308,6 +415,11 @@ typedef struct as_node_s {
 	 * Pools of current, cached sockets.
 	 */
 	as_conn_pool* sync_conn_pools;
+
+	/**
+	 * Shared pipelined connections used by sync single record commands. NULL if disabled.
+	 */
+	as_sync_pipe* sync_pipes;
 	
 	/**
 	 * Array of connection pools used in async commands.  There is one pool per node/event loop.
@@ -330,6 +442,12 @@ typedef struct as_node_s {
 	 */
 	as_racks* racks;
 
+	/**
+	 * Last partition bitmaps received from node (as_partition_bitmaps* per namespace).
+	 * Only referenced in cluster tend thread.
+	 */
+	as_vector* partition_bitmaps;
+
 	/**
 	 * Socket used exclusively for cluster tend thread info requests.
 	 */
@@ -340,6 +458,11 @@ typedef struct as_node_s {
 	 */
 	uint32_t conn_iter;
 
+	/**
+	 * Pipelined connection iterator.  Not atomic by design.
+	 */
+	uint32_t sync_pipe_iter;
+
 	/**
 	 * Total sync connections opened.
 	 */
@@ -350,6 +473,32 @@ typedef struct as_node_s {
 	 */
 	uint32_t sync_conns_closed;
 
+	/**
+	 * Predicted sync connections for a node that joined a running cluster.
+	 * Zero if warm-up was not performed.
+	 */
+	uint32_t warm_up_target;
+
+	/**
+	 * Sync connections still to be opened before warm-up completes.
+	 */
+	uint32_t warm_up_remaining;
+
+	/**
+	 * Sync connections opened by commands since the last tend.
+	 */
+	uint32_t sync_conn_demand;
+
+	/**
+	 * Spare idle sync connections kept by the tend thread. Only accessed by tend thread.
+	 */
+	uint32_t spare_target;
+
+	/**
+	 * Sync connections currently being opened by commands.
+	 */
+	uint32_t sync_connects;
+
 	/**
 	 * Error count for this node's error_rate_window.
 	 */
@@ -360,6 +509,125 @@ typedef struct as_node_s {
 	 */
 	uint32_t max_error_rate;
 
+	/**
+	 * Circuit breaker state (AS_BREAKER_CLOSED, AS_BREAKER_OPEN or AS_BREAKER_HALF_OPEN).
+	 */
+	uint32_t breaker_state;
+
+	/**
+	 * Commands that succeeded since the circuit breaker was last evaluated.
+	 */
+	uint32_t breaker_successes;
+
+	/**
+	 * Commands that failed since the circuit breaker was last evaluated.
+	 */
+	uint32_t breaker_failures;
+
+	/**
+	 * Probe commands still allowed in the current tend iteration while half-open.
+	 */
+	uint32_t breaker_probes;
+
+	/**
+	 * Tend iterations the circuit breaker remains open.
+	 */
+	uint32_t breaker_open_remaining;
+
+	/**
+	 * Tend iterations the circuit breaker stays open on its next trip.
+	 */
+	uint32_t breaker_backoff;
+
+	/**
+	 * Count of times the circuit breaker opened since node was created.
+	 */
+	uint64_t breaker_trips;
+
+	/**
+	 * Adaptive concurrency limit of in-flight single record commands. Zero when
+	 * as_config.concurrency_limit_max is zero. Only modified by the tend thread.
+	 */
+	uint32_t limit;
+
+	/**
+	 * In-flight commands counted against limit.
+	 */
+	uint32_t limit_inflight;
+
+	/**
+	 * Approximate peak of limit_inflight since the last cluster tend.
+	 */
+	uint32_t limit_peak;
+
+	/**
+	 * Timed out or overloaded commands since the last cluster tend.
+	 */
+	uint32_t limit_drops;
+
+	/**
+	 * Count and sum in microseconds of command latency since the last cluster tend.
+	 */
+	uint32_t limit_rtt_count;
+	uint64_t limit_rtt_sum;
+
+	/**
+	 * Long term command latency in microseconds. Only accessed by the tend thread.
+	 */
+	uint32_t limit_rtt_long;
+
+	/**
+	 * Count of commands rejected by limit since node was created.
+	 */
+	uint64_t limit_rejects;
+
+	/**
+	 * Exponentially weighted moving average of command latency in microseconds.
+	 * Used by AS_POLICY_REPLICA_LOWEST_LATENCY.
+	 */
+	uint32_t latency_ewma;
+
+	/**
+	 * Exponentially weighted moving average of command error ratio scaled by
+	 * AS_NODE_EWMA_ERROR_SCALE. Used by AS_POLICY_REPLICA_LOWEST_LATENCY.
+	 */
+	uint32_t error_ewma;
+
+	/**
+	 * High resolution histogram of command latency recorded by commands that use adaptive
+	 * socket timeouts. NULL until the first such command is run on the cluster.
+	 */
+	as_latency_hdr* adaptive_latency;
+
+	/**
+	 * adaptive_latency counts at the previous cluster tend, followed by decayed counts of
+	 * recent tend intervals. Only accessed by the tend thread.
+	 */
+	uint64_t* adaptive_counts;
+
+	/**
+	 * P99.9 of recent command latency in microseconds. Zero when not enough samples have
+	 * been recorded. Used by as_policy_base.adaptive_timeout_pct.
+	 */
+	uint32_t adaptive_p999_us;
+
+	/**
+	 * Kernel TCP state sampled from pooled sync and async connections. Round trip time,
+	 * variance and retransmits are exponentially weighted moving averages of the samples.
+	 * Congestion window is from the last sample.
+	 */
+	as_tcp_info tcp_info;
+
+	/**
+	 * Count of TCP state samples since metrics were enabled.
+	 */
+	uint64_t tcp_info_samples;
+
+	/**
+	 * Nano timestamp of next TCP state sample. Zero if sampling is disabled.
+	 */
+	uint64_t tcp_info_next;
+
 	/**
 	 * Server's generation count for peers.
 	 */
@@ -375,6 +643,17 @@ typedef struct as_node_s {
 	 */
 	uint32_t rebalance_generation;
 
+	/**
+	 * Cluster key returned by cluster-stable on the last tend. Zero when migrations were in
+	 * progress or the cluster key has not been requested.
+	 */
+	uint64_t cluster_key;
+
+	/**
+	 * Time in milliseconds when cluster_key was tended.
+	 */
+	uint64_t cluster_key_ms;
+
 	/**
 	 * Number of other nodes that consider this node a member of the cluster.
 	 */
@@ -389,6 +668,12 @@ typedef struct as_node_s {
 	 * Shared memory node array index.
 	 */
 	uint32_t index;
+
+	/**
+	 * Sequence number used to assign node's event loop when as_policy_event.loop_selection is
+	 * AS_EVENT_LOOP_SELECTION_NODE_AFFINITY.
+	 */
+	uint32_t event_loop_seq;
 	
 	/**
 	 * Node/Namespace metrics.
@@ -415,6 +700,13 @@ typedef struct as_node_s {
 	 */
 	bool partition_changed;
 
+	/**
+	 * Should next partition map update apply all partitions claimed by node instead of only
+	 * partitions that changed since the last update. Set when another node took over one of
+	 * this node's partitions.
+	 */
+	bool partition_bitmaps_reset;
+
 	/**
 	 * Did rebalance generation change in current cluster tend.
 	 */
@@ -494,6 +786,15 @@ as_node_destroy(as_node* node);
 void
 as_node_create_min_connections(as_node* node);
 
+/**
+ * @private
+ * Predict sync connections needed by a node that joined a running cluster and open the first
+ * batch. new_nodes is the number of nodes that are joining, including this node. The
+ * remaining connections are opened at a paced rate in as_node_balance_connections().
+ */
+void
+as_node_warm_up(as_node* node, uint32_t new_nodes);
+
 /**
  * @private
  * Check if node is active from a command thread.
@@ -606,7 +907,20 @@ as_node_authenticate_connection(struct as_cluster_s* cluster, uint64_t deadline_
 
 /**
  * @private
- * Get a connection to the given node from pool and validate.  Return 0 on success.
+ * Create and authenticate a new sync connection. The connection is counted in pool if
+ * pool is not NULL.
+ */
+as_status
+as_node_create_connection(
+	as_error* err, as_node* node, const char* ns, uint32_t socket_timeout, uint64_t deadline_ms, as_conn_pool* pool,
+	as_socket* sock
+	);
+
+/**
+ * @private
+ * Get a connection to the given node from pool and validate.  Pooled connections used or
+ * validated within as_config.conn_validate_window_ms are not validated again.
+ * Return 0 on success.
  */
 as_status
 as_node_get_connection(
@@ -614,6 +928,17 @@ as_node_get_connection(
 	as_socket* sock
 	);
 
+/**
+ * @private
+ * Get a connection to the given node from pool and validate every pooled connection
+ * regardless of the validation window.  Return 0 on success.
+ */
+as_status
+as_node_get_validated_connection(
+	as_error* err, as_node* node, const char* ns, uint32_t socket_timeout, uint64_t deadline_ms,
+	as_socket* sock
+	);
+
 /**
  * @private
  * Close a node's connection and update node/pool statistics.
@@ -637,6 +962,33 @@ as_node_close_socket(as_node* node, as_socket* sock)
 	as_incr_uint32(&node->sync_conns_closed);
 }
 
+/**
+ * @private
+ * Sample kernel TCP state of connection. next is the expected value of node->tcp_info_next.
+ */
+void
+as_node_sample_tcp_info(as_node* node, as_socket_fd fd, uint64_t next, uint64_t now);
+
+/**
+ * Copy sampled kernel TCP state of node connections and the number of samples taken.
+ */
+AS_EXTERN void
+as_node_get_tcp_info(as_node* node, as_tcp_info* info, uint64_t* samples);
+
+/**
+ * @private
+ * Sample TCP state of a connection returned to its pool if the node's sample interval elapsed.
+ */
+static inline void
+as_node_check_tcp_info(as_node* node, as_socket_fd fd, uint64_t now)
+{
+	uint64_t next = as_load_uint64(&node->tcp_info_next);
+
+	if (next && now >= next) {
+		as_node_sample_tcp_info(node, fd, next, now);
+	}
+}
+
 /**
  * @private
  * Put connection back into pool.
@@ -648,7 +1000,8 @@ as_node_put_connection(as_node* node, as_socket* sock)
 	as_conn_pool* pool = sock->pool;
 
 	// Update last used timestamp.
-	sock->last_used = cf_getns();
+	sock->last_used = as_clock_getns();
+	as_node_check_tcp_info(node, sock->fd, sock->last_used);
 
 	// Put into pool.
 	if (! as_conn_pool_push_head(pool, sock)) {
@@ -712,6 +1065,23 @@ as_node_prepare_metrics(as_node* node, const char* ns);
 void
 as_node_add_latency(as_ns_metrics* metrics, as_latency_type latency_type, uint64_t elapsed_nanos);
 
+/**
+ * @private
+ * Record command latency of type latency_type and, when latency_tag is set, of that
+ * application latency tag.
+ */
+static inline void
+as_node_add_command_latency(
+	as_ns_metrics* metrics, as_latency_type latency_type, uint8_t latency_tag, uint64_t elapsed_nanos
+	)
+{
+	as_node_add_latency(metrics, latency_type, elapsed_nanos);
+
+	if (latency_tag && latency_tag <= AS_LATENCY_TAG_MAX) {
+		as_node_add_latency(metrics, AS_LATENCY_TAG_SLOT(latency_tag), elapsed_nanos);
+	}
+}
+
 struct as_metrics_policy_s;
 
 /**
@@ -721,13 +1091,38 @@ struct as_metrics_policy_s;
 void
 as_node_enable_metrics(as_node* node, const struct as_metrics_policy_s* policy);
 
+/**
+ * @private
+ * Return counters stripe of the current thread.
+ */
+static inline as_ns_counters*
+as_ns_metrics_counters(as_ns_metrics* metrics)
+{
+	return &metrics->counters[as_metrics_stripe(AS_METRICS_STRIPES)];
+}
+
+/**
+ * @private
+ * Sum counter at the given offset in as_ns_counters across stripes.
+ */
+static inline uint64_t
+as_ns_metrics_sum(as_ns_metrics* metrics, size_t offset)
+{
+	uint64_t sum = 0;
+
+	for (uint32_t i = 0; i < AS_METRICS_STRIPES; i++) {
+		sum += as_load_uint64((uint64_t*)((uint8_t*)&metrics->counters[i] + offset));
+	}
+	return sum;
+}
+
 /**
  * Add bytes received metrics to node/namespace.
  */
 static inline void
 as_node_add_bytes_in(as_ns_metrics* metrics, uint64_t bytes_in)
 {
-	as_add_uint64(&metrics->bytes_in, bytes_in);
+	as_add_uint64(&as_ns_metrics_counters(metrics)->bytes_in, bytes_in);
 }
 
 /**
@@ -736,7 +1131,7 @@ as_node_add_bytes_in(as_ns_metrics* metrics, uint64_t bytes_in)
 static inline uint64_t
 as_node_get_bytes_in(as_ns_metrics* metrics)
 {
-	return as_load_uint64(&metrics->bytes_in);
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, bytes_in));
 }
 
 /**
@@ -745,7 +1140,7 @@ as_node_get_bytes_in(as_ns_metrics* metrics)
 static inline void
 as_node_add_bytes_out(as_ns_metrics* metrics, uint64_t bytes_out)
 {
-	as_add_uint64(&metrics->bytes_out, bytes_out);
+	as_add_uint64(&as_ns_metrics_counters(metrics)->bytes_out, bytes_out);
 }
 
 /**
@@ -754,7 +1149,61 @@ as_node_add_bytes_out(as_ns_metrics* metrics, uint64_t bytes_out)
 static inline uint64_t
 as_node_get_bytes_out(as_ns_metrics* metrics)
 {
-	return as_load_uint64(&metrics->bytes_out);
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, bytes_out));
+}
+
+/**
+ * @private
+ * Add compressed response size and its uncompressed size to node/namespace.
+ */
+static inline void
+as_node_add_compressed_in(as_ns_metrics* metrics, uint64_t comp_size, uint64_t uncomp_size)
+{
+	as_ns_counters* counters = as_ns_metrics_counters(metrics);
+	as_add_uint64(&counters->bytes_in_comp, comp_size);
+	as_add_uint64(&counters->bytes_in_uncomp, uncomp_size);
+}
+
+/**
+ * @private
+ * Add compressed command size and its uncompressed size to node/namespace.
+ */
+static inline void
+as_node_add_compressed_out(as_ns_metrics* metrics, uint64_t comp_size, uint64_t uncomp_size)
+{
+	as_ns_counters* counters = as_ns_metrics_counters(metrics);
+	as_add_uint64(&counters->bytes_out_comp, comp_size);
+	as_add_uint64(&counters->bytes_out_uncomp, uncomp_size);
+}
+
+/**
+ * Return bytes received from the server as if all responses were uncompressed. The ratio of
+ * this value to as_node_get_bytes_in() shows the savings of response compression.
+ * The value is cumulative and not reset per metrics interval.
+ */
+static inline uint64_t
+as_node_get_bytes_in_raw(as_ns_metrics* metrics)
+{
+	uint64_t comp = as_ns_metrics_sum(metrics, offsetof(as_ns_counters, bytes_in_comp));
+	uint64_t uncomp = as_ns_metrics_sum(metrics, offsetof(as_ns_counters, bytes_in_uncomp));
+	uint64_t raw = as_node_get_bytes_in(metrics) + uncomp;
+
+	// Compressed sizes may be added before the command's total byte count.
+	return (raw > comp)? raw - comp : 0;
+}
+
+/**
+ * Return bytes sent to the server as if all commands were uncompressed. The ratio of
+ * this value to as_node_get_bytes_out() shows the savings of command compression.
+ * The value is cumulative and not reset per metrics interval.
+ */
+static inline uint64_t
+as_node_get_bytes_out_raw(as_ns_metrics* metrics)
+{
+	uint64_t comp = as_ns_metrics_sum(metrics, offsetof(as_ns_counters, bytes_out_comp));
+	uint64_t uncomp = as_ns_metrics_sum(metrics, offsetof(as_ns_counters, bytes_out_uncomp));
+	uint64_t raw = as_node_get_bytes_out(metrics) + uncomp;
+	return (raw > comp)? raw - comp : 0;
 }
 
 /**
@@ -763,7 +1212,7 @@ as_node_get_bytes_out(as_ns_metrics* metrics)
 static inline uint64_t
 as_node_get_error_count(as_ns_metrics* metrics)
 {
-	return as_load_uint64(&metrics->error_count);
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, error_count));
 }
 
 /**
@@ -779,7 +1228,7 @@ as_node_add_error(as_node* node, const char* ns, as_ns_metrics* metrics);
 static inline uint64_t
 as_node_get_timeout_count(as_ns_metrics* metrics)
 {
-	return as_load_uint64(&metrics->timeout_count);
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, timeout_count));
 }
 
 /**
@@ -795,7 +1244,7 @@ as_node_add_timeout(as_node* node, const char* ns, as_ns_metrics* metrics);
 static inline uint64_t
 as_node_get_key_busy_count(as_ns_metrics* metrics)
 {
-	return as_load_uint64(&metrics->key_busy_count);
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, key_busy_count));
 }
 
 /**
@@ -804,6 +1253,162 @@ as_node_get_key_busy_count(as_ns_metrics* metrics)
 void
 as_node_add_key_busy(as_node* node, const char* ns, as_ns_metrics* metrics);
 
+/**
+ * Return near cache hit count. The value is cumulative and not reset per metrics interval.
+ */
+static inline uint64_t
+as_node_get_near_cache_hit_count(as_ns_metrics* metrics)
+{
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, near_cache_hit_count));
+}
+
+/**
+ * Return near cache miss count. The value is cumulative and not reset per metrics interval.
+ */
+static inline uint64_t
+as_node_get_near_cache_miss_count(as_ns_metrics* metrics)
+{
+	return as_ns_metrics_sum(metrics, offsetof(as_ns_counters, near_cache_miss_count));
+}
+
+/**
+ * Increment near cache hit or miss count.
+ */
+void
+as_node_add_near_cache(as_node* node, const char* ns, bool hit);
+
+/**
+ * @private
+ * Add command latency and error sample to node's moving averages.
+ */
+void
+as_node_add_replica_sample(as_node* node, uint64_t elapsed_ns, bool error);
+
+/**
+ * @private
+ * Decay node's moving averages, so nodes that no longer receive commands are eventually
+ * tried again. Called every cluster tend iteration.
+ */
+void
+as_node_decay_replica_score(as_node* node);
+
+/**
+ * @private
+ * Add latency sample of a command with adaptive socket timeout.
+ */
+void
+as_node_add_adaptive_sample(as_node* node, uint64_t elapsed_ns);
+
+/**
+ * @private
+ * Recalculate recent p99.9 latency from samples added since the last call. Called every
+ * cluster tend iteration once adaptive socket timeouts are in use.
+ */
+void
+as_node_update_adaptive_timeout(as_node* node);
+
+/**
+ * @private
+ * Recalculate node's adaptive concurrency limit from samples added since the last call.
+ * Called every cluster tend iteration when concurrency limits are enabled.
+ */
+void
+as_node_update_limit(as_node* node);
+
+/**
+ * @private
+ * Count a command against the node's concurrency limit. Return false without counting
+ * the command if the limit has been reached.
+ */
+static inline bool
+as_node_limit_acquire(as_node* node)
+{
+	uint32_t inflight = as_aaf_uint32(&node->limit_inflight, 1);
+
+	if (inflight > as_load_uint32(&node->limit)) {
+		as_decr_uint32(&node->limit_inflight);
+		as_incr_uint64(&node->limit_rejects);
+		return false;
+	}
+
+	if (inflight > as_load_uint32(&node->limit_peak)) {
+		// A lost update only delays growth of the limit.
+		as_store_uint32(&node->limit_peak, inflight);
+	}
+	return true;
+}
+
+/**
+ * @private
+ * Release a command counted by as_node_limit_acquire().
+ */
+static inline void
+as_node_limit_release(as_node* node)
+{
+	as_decr_uint32(&node->limit_inflight);
+}
+
+/**
+ * @private
+ * Add latency sample of a command counted by as_node_limit_acquire(). Timeouts and device
+ * overload errors are counted as drops instead.
+ */
+static inline void
+as_node_add_limit_sample(as_node* node, uint64_t elapsed_ns, bool drop)
+{
+	if (drop) {
+		as_incr_uint32(&node->limit_drops);
+		return;
+	}
+	as_faa_uint64(&node->limit_rtt_sum, elapsed_ns / 1000);
+	as_incr_uint32(&node->limit_rtt_count);
+}
+
+/**
+ * @private
+ * Return socket timeout derived from node's recent p99.9 latency. The result is at least
+ * min_ms and never exceeds socket_timeout. Return socket_timeout when the node has not
+ * recorded enough samples.
+ */
+static inline uint32_t
+as_node_adaptive_timeout(as_node* node, uint32_t socket_timeout, uint32_t pct, uint32_t min_ms)
+{
+	uint64_t p999 = as_load_uint32(&node->adaptive_p999_us);
+
+	if (p999 == 0) {
+		return socket_timeout;
+	}
+
+	uint64_t timeout = (p999 * pct / 100 + 999) / 1000;
+
+	if (timeout < min_ms) {
+		timeout = min_ms;
+	}
+
+	if (timeout == 0) {
+		timeout = 1;
+	}
+
+	if (socket_timeout > 0 && timeout > socket_timeout) {
+		return socket_timeout;
+	}
+	return (uint32_t)timeout;
+}
+
+/**
+ * @private
+ * Return node's replica selection score. Lower is better.
+ */
+static inline uint64_t
+as_node_get_replica_score(as_node* node)
+{
+	uint64_t latency = as_load_uint32(&node->latency_ewma);
+	uint64_t error = as_load_uint32(&node->error_ewma);
+
+	// A node that only returns errors scores as if its latency was 9 times higher.
+	return latency * (AS_NODE_EWMA_ERROR_SCALE + error * 8) / AS_NODE_EWMA_ERROR_SCALE;
+}
+
 /**
  * @private
  * Validate node's error rate.
@@ -818,6 +1423,43 @@ as_node_valid_error_rate(as_node* node);
 void
 as_node_reset_error_rate(as_node* node);
 
+/**
+ * @private
+ * Advance node's circuit breaker state machine. Called by the cluster tend thread once per
+ * tend iteration. window_end is true at the end of each error_rate_window. Return new state.
+ */
+uint32_t
+as_node_update_breaker(as_node* node, bool window_end);
+
+/**
+ * @private
+ * Return if a command may be sent to the node according to its circuit breaker.
+ * Each call while half-open consumes a probe.
+ */
+static inline bool
+as_node_breaker_allow(as_node* node)
+{
+	uint32_t state = as_load_uint32(&node->breaker_state);
+
+	if (state == AS_BREAKER_CLOSED) {
+		return true;
+	}
+
+	if (state == AS_BREAKER_OPEN) {
+		return false;
+	}
+
+	uint32_t probes = as_load_uint32(&node->breaker_probes);
+
+	while (probes > 0) {
+		if (as_cas_uint32(&node->breaker_probes, probes, probes - 1)) {
+			return true;
+		}
+		probes = as_load_uint32(&node->breaker_probes);
+	}
+	return false;
+}
+
 /**
  * @private
  * Get node's error count.
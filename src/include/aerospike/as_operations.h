@@ -289,6 +289,12 @@ typedef struct as_operations_s {
 	 */
 	bool _free;
 
+	/**
+	 * @private
+	 * Arena that holds binops and packed CDT operations. NULL when heap allocated.
+	 */
+	struct as_arena_s* arena;
+
 } as_operations;
 
 //---------------------------------
@@ -319,7 +325,8 @@ typedef struct as_operations_s {
 	(__ops)->binops._free = false;\
 	(__ops)->ttl = 0;\
 	(__ops)->gen = 0;\
-	(__ops)->_free = false;
+	(__ops)->_free = false;\
+	(__ops)->arena = NULL;
 
 //---------------------------------
 // Functions
@@ -371,6 +378,42 @@ as_operations_init(as_operations* ops, uint16_t nops);
 AS_EXTERN as_operations*
 as_operations_new(uint16_t nops);
 
+/**
+ * Initialize a stack allocated `as_operations` whose entries and packed CDT,
+ * bit, HLL and expression operations are allocated from an arena instead of
+ * the heap. The arena is reset when the last `as_operations` initialized with
+ * it is destroyed, so a single arena can be reused for each command issued by
+ * a thread.
+ *
+ * The arena is not thread safe. Values added with as_operations_add_write()
+ * and similar functions are still owned by the caller, as with
+ * as_operations_init().
+ *
+ * @code
+ * uint8_t buf[4096];
+ * as_arena arena;
+ * as_arena_init(&arena, buf, sizeof(buf));
+ *
+ * as_operations ops;
+ * as_operations_init_arena(&ops, 2, &arena);
+ * as_operations_add_incr(&ops, "bin1", 123);
+ * as_operations_list_append(&ops, "bin2", NULL, NULL, (as_val*)&val);
+ * aerospike_key_operate(&as, &err, NULL, &key, &ops, &rec);
+ * as_operations_destroy(&ops);
+ * @endcode
+ *
+ * @param ops 		The `as_operations` to initialize.
+ * @param nops		The number of `as_operations.binops.entries` to allocate from the arena.
+ * @param arena		The arena to allocate from.
+ *
+ * @return The initialized `as_operations` on success. Otherwise NULL.
+ *
+ * @relates as_operations
+ * @ingroup base_operations
+ */
+AS_EXTERN as_operations*
+as_operations_init_arena(as_operations* ops, uint16_t nops, struct as_arena_s* arena);
+
 /**
  * Destroy an `as_operations` and release associated resources.
  *
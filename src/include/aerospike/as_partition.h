@@ -17,6 +17,7 @@
 #pragma once
 
 #include <aerospike/as_atomic.h>
+#include <aerospike/as_key.h>
 #include <aerospike/as_std.h>
 #include <aerospike/as_status.h>
 
@@ -49,6 +50,12 @@ extern "C" {
  */
 #define AS_MAX_REPLICATION_FACTOR 3
 
+// as_partition.rack_rank value when the node's rack must be looked up on the node.
+#define AS_PARTITION_RACK_UNKNOWN 0xFF
+
+// as_partition.rack_rank value when the node is not on any preferred rack.
+#define AS_PARTITION_RACK_NONE 0xFE
+
 //---------------------------------
 // Types
 //---------------------------------
@@ -65,6 +72,9 @@ struct as_key_s;
 typedef struct as_partition_s {
 	struct as_node_s* nodes[AS_MAX_REPLICATION_FACTOR];
 	uint32_t regime;
+	// Index in cluster rack_ids of each node's rack. Resides in the same cache line as
+	// nodes, so rack aware routing does not need to read node rack state.
+	uint8_t rack_rank[AS_MAX_REPLICATION_FACTOR];
 } as_partition;
 
 /**
@@ -76,7 +86,9 @@ typedef struct as_partition_table_s {
 	uint32_t size;
 	uint8_t replica_size;  // replication-factor on server.
 	bool sc_mode;
-	char pad[2];
+	bool racks_stale;  // rack_rank must be rebuilt.
+	char pad[1];
+	uint32_t racks_gen;  // cluster racks_gen when rack_rank was rebuilt.
 	as_partition partitions[];
 } as_partition_table;
 
@@ -89,6 +101,20 @@ typedef struct as_partition_tables_s {
 	uint32_t size;
 } as_partition_tables;
 
+/**
+ * @private
+ * Last partition bitmaps received from a node for a namespace. Partition map updates only
+ * apply partitions that are newly claimed relative to these bitmaps.
+ */
+typedef struct as_partition_bitmaps_s {
+	char ns[AS_MAX_NAMESPACE_SIZE];
+	uint32_t regime;
+	uint8_t replica_size;
+	bool valid;
+	char pad[2];
+	uint8_t bitmaps[];  // replica_size bitmaps.
+} as_partition_bitmaps;
+
 /**
  * @private
  * Partition info.
@@ -112,6 +138,13 @@ typedef struct as_partition_info_s {
 void
 as_partition_tables_destroy(as_partition_tables* tables);
 
+/**
+ * @private
+ * Destroy node's last partition bitmaps.
+ */
+void
+as_partition_bitmaps_destroy(struct as_node_s* node);
+
 /**
  * @private
  * Get partition table given namespace.
@@ -119,6 +152,22 @@ as_partition_tables_destroy(as_partition_tables* tables);
 AS_EXTERN as_partition_table*
 as_partition_tables_get(as_partition_tables* tables, const char* ns);
 
+/**
+ * @private
+ * Return true if partition tables exist and every partition has a master node.
+ */
+bool
+as_partition_tables_covered(as_partition_tables* tables);
+
+/**
+ * Resolve namespace to a handle that routes keys to the namespace partition table without a
+ * name lookup. Return zero if the namespace is not known yet or shared memory tending is
+ * enabled. Pass the handle to as_key_set_ns_handle(). Handles remain valid for the life of
+ * the cluster.
+ */
+AS_EXTERN as_namespace_handle
+as_partition_tables_resolve(struct as_cluster_s* cluster, const char* ns);
+
 /**
  * @private
  * Get global partition table namespace given local namespace.
@@ -151,9 +200,29 @@ as_partition_info_init(
  * @private
  * Log all partition maps in the cluster.
  */
+/**
+ * @private
+ * Add partition table restored from a cluster snapshot. nodes contains AS_MAX_REPLICATION_FACTOR
+ * owners (or NULL) for each partition. Must be called before the cluster is tended.
+ * Return false if the namespace already exists or the maximum namespaces is exceeded.
+ */
+bool
+as_partition_tables_restore(
+	struct as_cluster_s* cluster, const char* ns, uint8_t replica_size, bool sc_mode,
+	struct as_node_s** nodes, const uint32_t* regimes
+	);
+
 void
 as_partition_tables_dump(struct as_cluster_s* cluster);
 
+/**
+ * @private
+ * Rebuild rack_rank of partition tables whose nodes, node racks or cluster rack_ids
+ * changed. Must be called from the tend thread.
+ */
+void
+as_partition_tables_update_racks(struct as_cluster_s* cluster);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
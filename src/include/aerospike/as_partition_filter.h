@@ -170,6 +170,60 @@ as_partitions_status_release(as_partitions_status* parts_all)
 	}
 }
 
+/**
+ * Serialize status of all partitions to a compact binary format. Each partition takes one
+ * byte, or 29 bytes if it has a resume digest. The caller must free bytes with cf_free().
+ */
+AS_EXTERN bool
+as_partitions_status_to_bytes(
+	const as_partitions_status* parts_all, uint8_t** bytes, uint32_t* bytes_size
+	);
+
+/**
+ * Deserialize status of all partitions. Return NULL if bytes are not a valid serialized
+ * status. Release with as_partitions_status_release().
+ */
+AS_EXTERN as_partitions_status*
+as_partitions_status_from_bytes(const uint8_t* bytes, uint32_t bytes_size);
+
+/**
+ * Serialize status of all partitions to a file. The file is replaced atomically, so a reader
+ * sees either the previous or the new status.
+ */
+AS_EXTERN bool
+as_partitions_status_save(const as_partitions_status* parts_all, const char* path);
+
+/**
+ * Load status of all partitions saved with as_partitions_status_save() or by a scan/query
+ * checkpoint. Return NULL if the file does not exist or is invalid. Pass the result to
+ * as_partition_filter_set_partitions() to resume the scan/query, then release it with
+ * as_partitions_status_release().
+ *
+ * ~~~~~~~~~~{.c}
+ * as_partition_filter pf;
+ * as_partitions_status* parts_all = as_partitions_status_load("/var/run/export.ckpt");
+ *
+ * if (parts_all) {
+ *     as_partition_filter_set_partitions(&pf, parts_all);
+ * }
+ * else {
+ *     as_partition_filter_set_all(&pf);
+ * }
+ *
+ * as_policy_scan policy;
+ * as_policy_scan_init(&policy);
+ * policy.checkpoint_path = "/var/run/export.ckpt";
+ *
+ * aerospike_scan_partitions(&as, &err, &policy, &scan, &pf, callback, NULL);
+ *
+ * if (parts_all) {
+ *     as_partitions_status_release(parts_all);
+ * }
+ * ~~~~~~~~~~
+ */
+AS_EXTERN as_partitions_status*
+as_partitions_status_load(const char* path);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_cluster_s;
+
+/**
+ * Counters of one partition for the current metrics interval.
+ */
+typedef struct as_partition_heat_entry_s {
+	/**
+	 * Single record command attempts, including retries.
+	 */
+	uint32_t commands;
+
+	/**
+	 * Attempts that timed out.
+	 */
+	uint32_t timeouts;
+
+	/**
+	 * Attempts that failed with AEROSPIKE_ERR_RECORD_BUSY.
+	 */
+	uint32_t key_busy;
+
+	/**
+	 * Attempts that were retries of a previous attempt.
+	 */
+	uint32_t retries;
+
+	/**
+	 * Number of successful attempts whose latency was sampled.
+	 */
+	uint32_t latency_count;
+
+	/**
+	 * Sum of sampled latencies in microseconds.
+	 */
+	uint32_t latency_sum_us;
+} as_partition_heat_entry;
+
+/**
+ * Per-partition command counters of a node namespace. Timeouts, key busy errors and retries
+ * are always counted. Latency is recorded for one of every sample attempts on a partition.
+ * Counters are cleared after each metrics snapshot, so they cover the last metrics interval.
+ */
+typedef struct as_partition_heat_s {
+	uint32_t sample;
+	uint32_t size;
+	as_partition_heat_entry entries[];
+} as_partition_heat;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create heatmap for size partitions that samples latency of one of every sample attempts.
+ */
+as_partition_heat*
+as_partition_heat_create(uint32_t size, uint32_t sample);
+
+/**
+ * @private
+ * Destroy heatmap.
+ */
+void
+as_partition_heat_destroy(as_partition_heat* heat);
+
+/**
+ * @private
+ * Remove all counts.
+ */
+void
+as_partition_heat_clear(as_partition_heat* heat);
+
+/**
+ * @private
+ * Count command attempt on partition. Return true if the attempt's latency should be sampled.
+ */
+static inline bool
+as_partition_heat_add_command(as_partition_heat* heat, uint32_t partition_id, bool retry)
+{
+	as_partition_heat_entry* e = &heat->entries[partition_id];
+
+	if (retry) {
+		as_incr_uint32(&e->retries);
+	}
+	return as_aaf_uint32(&e->commands, 1) % heat->sample == 0;
+}
+
+/**
+ * @private
+ * Add sampled latency of a successful attempt.
+ */
+static inline void
+as_partition_heat_add_latency(as_partition_heat* heat, uint32_t partition_id, uint64_t elapsed_ns)
+{
+	as_partition_heat_entry* e = &heat->entries[partition_id];
+
+	as_incr_uint32(&e->latency_count);
+	as_faa_uint32(&e->latency_sum_us, (uint32_t)(elapsed_ns / 1000));
+}
+
+/**
+ * @private
+ * Count timeout on partition.
+ */
+static inline void
+as_partition_heat_add_timeout(as_partition_heat* heat, uint32_t partition_id)
+{
+	as_incr_uint32(&heat->entries[partition_id].timeouts);
+}
+
+/**
+ * @private
+ * Count key busy error on partition.
+ */
+static inline void
+as_partition_heat_add_key_busy(as_partition_heat* heat, uint32_t partition_id)
+{
+	as_incr_uint32(&heat->entries[partition_id].key_busy);
+}
+
+/**
+ * Add counters of heatmap to out, which holds size partition entries. Return number of
+ * partitions added.
+ */
+AS_EXTERN uint32_t
+as_partition_heat_merge(as_partition_heat* heat, as_partition_heat_entry* out, uint32_t size);
+
+/**
+ * Fill out with the namespace wide heatmap, which is the sum of the heatmaps of all nodes
+ * for this namespace. out must hold cluster->n_partitions entries. Must be called from the
+ * metrics snapshot listener, which runs while node metrics can not change.
+ * Return number of node heatmaps merged.
+ */
+AS_EXTERN uint32_t
+as_partition_heat_get_ns(
+	struct as_cluster_s* cluster, const char* ns, as_partition_heat_entry* out, uint32_t size
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
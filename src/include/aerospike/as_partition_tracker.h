@@ -58,6 +58,12 @@ typedef struct as_partition_tracker_s {
 	uint32_t node_capacity;
 	struct as_node_s* node_filter;
 	as_vector node_parts;
+
+	/**
+	 * Partition lists of the previous iteration. Entries are released by node, but their
+	 * vectors stay allocated, so retry iterations do not allocate new lists.
+	 */
+	as_vector np_pool;
 	as_vector* errors;
 	uint64_t max_records;
 	uint64_t record_count;
@@ -69,6 +75,11 @@ typedef struct as_partition_tracker_s {
 	uint32_t total_timeout;
 	uint32_t max_retries;
 	uint32_t iteration;
+	uint32_t commands_per_node;
+	char* checkpoint_path;
+	uint64_t checkpoint_next;
+	uint32_t checkpoint_interval;
+	uint32_t checkpoint_busy;
 	bool check_max;
 } as_partition_tracker;
 
@@ -79,24 +90,39 @@ typedef struct as_partition_tracker_s {
 as_status
 as_partition_tracker_init_nodes(
 	as_partition_tracker* pt, struct as_cluster_s* cluster, const as_policy_base* policy,
-	uint64_t max_records, as_policy_replica replica, as_partitions_status** parts_all,
-	bool paginate, uint32_t cluster_size, as_error* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node,
+	as_partitions_status** parts_all, bool paginate, uint32_t cluster_size, as_error* err
 	);
 
 as_status
 as_partition_tracker_init_node(
 	as_partition_tracker* pt, struct as_cluster_s* cluster, const as_policy_base* policy,
-	uint64_t max_records, as_policy_replica replica, as_partitions_status** parts_all, bool paginate,
-	struct as_node_s* node, as_error* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node,
+	as_partitions_status** parts_all, bool paginate, struct as_node_s* node, as_error* err
 	);
 
 as_status
 as_partition_tracker_init_filter(
 	as_partition_tracker* pt, struct as_cluster_s* cluster, const as_policy_base* policy,
-	uint64_t max_records, as_policy_replica replica, as_partitions_status** parts_all,
-	bool paginate, uint32_t cluster_size, as_partition_filter* pf, struct as_error_s* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node,
+	as_partitions_status** parts_all, bool paginate, uint32_t cluster_size, as_partition_filter* pf,
+	struct as_error_s* err
 	);
 
+/**
+ * @private
+ * Periodically save partition status to path while the scan/query runs.
+ */
+void
+as_partition_tracker_set_checkpoint(as_partition_tracker* pt, const char* path, uint32_t interval);
+
+/**
+ * @private
+ * Save partition status if the checkpoint interval elapsed or force is true.
+ */
+void
+as_partition_tracker_checkpoint(as_partition_tracker* pt, bool force);
+
 as_status
 as_partition_tracker_assign(
 	as_partition_tracker* pt, struct as_cluster_s* cluster, const char* ns, struct as_error_s* err
@@ -114,8 +140,18 @@ as_partition_tracker_set_digest(
 {
 	uint32_t part_id = as_partition_getid(digest->value, n_partitions);
 	as_partitions_status* ps = pt->parts_all;
-	ps->parts[part_id - ps->part_begin].digest = *digest;
+	as_partition_status* p = &ps->parts[part_id - ps->part_begin];
 	np->record_count++;
+
+	if (pt->checkpoint_path) {
+		// Checkpoints copy partition status from other threads.
+		pthread_mutex_lock(&pt->lock);
+		p->digest = *digest;
+		pthread_mutex_unlock(&pt->lock);
+		as_partition_tracker_checkpoint(pt, false);
+		return;
+	}
+	p->digest = *digest;
 }
 
 static inline void
@@ -127,9 +163,19 @@ as_partition_tracker_set_last(
 	uint32_t part_id = as_partition_getid(digest->value, n_partitions);
 	as_partitions_status* ps = pt->parts_all;
 	as_partition_status* p = &ps->parts[part_id - ps->part_begin];
+	np->record_count++;
+
+	if (pt->checkpoint_path) {
+		// Checkpoints copy partition status from other threads.
+		pthread_mutex_lock(&pt->lock);
+		p->digest = *digest;
+		p->bval = bval;
+		pthread_mutex_unlock(&pt->lock);
+		as_partition_tracker_checkpoint(pt, false);
+		return;
+	}
 	p->digest = *digest;
 	p->bval = bval;
-	np->record_count++;
 }
 
 static inline bool
@@ -44,6 +44,7 @@ typedef struct as_pipe_connection {
 	as_event_connection base;
 	as_event_command* writer;
 	cf_ll readers;
+	bool large;
 	bool canceling;
 	bool canceled;
 	bool in_pool;
@@ -61,6 +62,9 @@ as_pipe_get_connection(as_event_command* cmd);
 extern bool
 as_pipe_modify_fd(as_socket_fd fd);
 
+extern void
+as_pipe_uncork(as_event_loop* event_loop);
+
 extern void
 as_pipe_socket_error(as_event_command* cmd, as_error* err, bool retry);
 
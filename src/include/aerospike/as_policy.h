@@ -37,6 +37,7 @@
  * - as_policy_read_mode_ap
  * - as_policy_read_mode_sc
  * - as_policy_commit_level
+ * - as_policy_priority
  *
  * ## Operation Policies
  *
@@ -54,7 +55,9 @@
  */
 
 #include <aerospike/as_std.h>
+#include <aerospike/as_compress.h>
 #include <aerospike/as_metrics.h>
+#include <aerospike/as_rate_limiter.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -78,6 +81,13 @@ extern "C" {
  */
 #define AS_POLICY_TOTAL_TIMEOUT_DEFAULT 1000
 
+/**
+ * Default minimum adaptive socket timeout value
+ *
+ * @ingroup client_policies
+ */
+#define AS_POLICY_ADAPTIVE_TIMEOUT_MIN_DEFAULT 10
+
 /**
  * Default value for compression threshold
  *
@@ -140,6 +150,7 @@ extern "C" {
 
 struct as_exp;
 struct as_txn;
+struct as_async_cancel_s;
 
 /**
  * Retry Policy
@@ -312,7 +323,17 @@ typedef enum as_policy_replica_e {
 	 *
 	 * This option can also be used to test server proxies.
 	 */
-	AS_POLICY_REPLICA_RANDOM
+	AS_POLICY_REPLICA_RANDOM,
+
+	/**
+	 * For reads, try the replica with the lowest recent latency and error rate first.
+	 * The client tracks an exponentially weighted moving average of command latency and
+	 * errors per node. Reads only move off the current sequence replica when another
+	 * replica scores significantly better, so traffic does not flap between nodes with
+	 * similar latency. Degraded nodes are drained without operator action. Use SEQUENCE
+	 * for writes.
+	 */
+	AS_POLICY_REPLICA_LOWEST_LATENCY
 
 } as_policy_replica;
 
@@ -396,6 +417,30 @@ typedef enum as_policy_commit_level_e {
 
 } as_policy_commit_level;
 
+/**
+ * Async command priority.
+ *
+ * Determines which event loop delay queue holds the command when
+ * as_policy_event.max_commands_in_process is reached.
+ *
+ * @ingroup client_policies
+ */
+typedef enum as_policy_priority_e {
+
+	/**
+	 * Latency sensitive command. Foreground commands are started from the delay queue
+	 * before background commands. This is the default.
+	 */
+	AS_POLICY_PRIORITY_FOREGROUND,
+
+	/**
+	 * Bulk command that can wait behind foreground commands. Background commands have
+	 * their own delay queue limit, so they never cause foreground commands to be rejected.
+	 */
+	AS_POLICY_PRIORITY_BACKGROUND,
+
+} as_policy_priority;
+
 /**
  * Expected query duration. The server treats the query in different ways depending on the expected duration.
  * This enum is ignored for aggregation queries, background queries and server versions &lt; 6.0.
@@ -552,8 +597,17 @@ typedef struct as_policy_base_s {
 	struct as_txn* txn;
 
 	/**
-	 * Use zlib compression on write or batch read commands when the command buffer size is greater
-	 * than 128 bytes.  In addition, tell the server to compress it's response on read commands.
+	 * Cancellation handle created by as_async_cancel_create(). When set for an async single
+	 * record or batch command, as_async_cancel_abort() aborts the command with
+	 * AEROSPIKE_ERR_CLIENT_ABORT. Ignored by sync commands, scans and queries.
+	 *
+	 * Default: NULL
+	 */
+	struct as_async_cancel_s* cancel;
+
+	/**
+	 * Use compression on write or batch read commands when the command buffer size is greater
+	 * than 128 bytes.  The codec is selected by as_config.compress_codec (zlib by default).  In addition, tell the server to compress it's response on read commands.
 	 * The server response compression threshold is also 128 bytes.
 	 *
 	 * This option will increase cpu and memory usage (for extra compressed buffers), but
@@ -565,6 +619,88 @@ typedef struct as_policy_base_s {
 	 */
 	bool compress;
 
+	/**
+	 * Low latency read mode for sync commands. When waiting for the response header, spin on
+	 * non-blocking socket reads for up to this many microseconds before waiting in poll().
+	 * This avoids the poll system call and scheduler wakeup when responses arrive within a
+	 * few microseconds, at the cost of a busy cpu core while spinning. Only useful when
+	 * typical response latency is below the spin time. Ignored by async commands and TLS
+	 * connections.
+	 *
+	 * See also as_config.socket_busy_poll_us.
+	 *
+	 * Default: 0 (do not spin)
+	 */
+	uint32_t spin_read_us;
+
+	/**
+	 * Delay queue priority for async commands. Background commands wait in a separate delay
+	 * queue that is drained after foreground commands. See as_policy_event.foreground_burst
+	 * and as_policy_event.max_background_in_queue. Ignored by sync commands and when
+	 * as_policy_event.max_commands_in_process is zero.
+	 *
+	 * Default: AS_POLICY_PRIORITY_FOREGROUND
+	 */
+	as_policy_priority priority;
+
+	/**
+	 * Application latency tag used to break down command latency by business operation.
+	 * When set to 1..AS_LATENCY_TAG_MAX, the command's latency is also recorded in that tag's
+	 * latency histogram. Tag histograms are written by the metrics writer under the name
+	 * assigned with as_config_set_latency_tag(). Unnamed tags are recorded, but not written.
+	 *
+	 * Default: 0 (untagged)
+	 */
+	uint8_t latency_tag;
+
+	/**
+	 * Adaptive socket timeout as a percentage of the target node's recent p99.9 command
+	 * latency. When non-zero, each attempt of a single record command uses
+	 * p99.9 * adaptive_timeout_pct / 100 as its socket timeout, clamped between
+	 * adaptive_timeout_min and the socket timeout that would otherwise be used. An attempt
+	 * stalled by a slow node is then retried long before socket_timeout.
+	 *
+	 * Node latency is measured over the last few cluster tend intervals from commands that
+	 * enable this field. The configured socket timeout is used until a node has recorded
+	 * enough samples. Ignored by batch, scan and query commands.
+	 *
+	 * Default: 0 (do not adapt socket timeout)
+	 */
+	uint32_t adaptive_timeout_pct;
+
+	/**
+	 * Minimum adaptive socket timeout in milliseconds. See adaptive_timeout_pct.
+	 *
+	 * Default: 10
+	 */
+	uint32_t adaptive_timeout_min;
+
+	/**
+	 * Start async single record writes, operates, removes and applies on the same key one at a
+	 * time and in the order they arrive on their event loop. A command waits until the previous
+	 * ordered command on its key completes, even if that command failed or timed out. Time spent
+	 * waiting counts toward total_timeout.
+	 *
+	 * When the command's event_loop argument is NULL, the event loop is chosen from the key's
+	 * partition instead of the configured event loop selection, so commands on the same key
+	 * issued from different threads are ordered with each other. Commands given an explicit
+	 * event loop are only ordered with other commands on that event loop. Commands delayed by
+	 * a namespace quota are ordered when they start. Ignored by sync commands.
+	 *
+	 * Default: false
+	 */
+	bool ordered;
+
+	/**
+	 * @private
+	 * Configuration this policy was merged with by as_policy_read_resolve(),
+	 * as_policy_write_resolve() or as_policy_operate_resolve(). A resolved policy is used
+	 * as is until the dynamic configuration changes. Do not set directly.
+	 *
+	 * Default: NULL
+	 */
+	const void* resolved;
+
 } as_policy_base;
 
 /**
@@ -621,6 +757,21 @@ typedef struct as_policy_read_s {
 	 * Default: 0
 	 */
 	int read_touch_ttl_percent;
+
+	/**
+	 * Hedged read delay in milliseconds. If the first replica has not responded within this
+	 * delay, a duplicate request is sent to the next replica and the first response wins. The
+	 * losing request is cancelled by closing its connection. This is typically set near the
+	 * observed p99 read latency, so only the slowest reads are duplicated.
+	 *
+	 * Applies to single record gets/selects/exists in sync and async mode when the replica
+	 * policy allows multiple replicas. Hedging is not applied to pipelined commands, commands
+	 * in a transaction or sync commands on TLS connections. Batch reads are hedged by
+	 * as_policy_batch.hedge_delay.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t hedge_delay;
 	
 	/**
 	 * Should raw bytes representing a list or map be deserialized to as_list or as_map.
@@ -640,6 +791,30 @@ typedef struct as_policy_read_s {
 	 */
 	bool async_heap_rec;
 
+	/**
+	 * Should string and blob bin values reference the response buffer directly instead of
+	 * allocating and copying each value. If true, the response buffer is reference counted and
+	 * owned by the resulting as_record until as_record_destroy() is called. Values must not be
+	 * used after the record is destroyed. Raw list or map bytes (deserialize false) are also
+	 * referenced directly. Async heap records (async_heap_rec true) copy the response bins into
+	 * the record's own allocation, so as_record_destroy() frees the record with a single free.
+	 *
+	 * Default: false
+	 */
+	bool zero_copy;
+
+	/**
+	 * Should list and map bins be deserialized on first access instead of when the response
+	 * is parsed. The raw msgpack bytes are kept in the response buffer and deserialized when
+	 * the bin is read by as_record_get(), the typed getters, as_record_foreach() or
+	 * as_record_iterator_next(). Bins that are not read cost no allocation. Only applies
+	 * when zero_copy and deserialize are true. A record read lazily must not be accessed by
+	 * multiple threads at the same time.
+	 *
+	 * Default: false
+	 */
+	bool lazy_deserialize;
+
 } as_policy_read;
 	
 /**
@@ -699,6 +874,28 @@ typedef struct as_policy_write_s {
 	 */
 	uint32_t compression_threshold;
 
+	/**
+	 * Minimum size of a string or blob (AS_BYTES_BLOB) bin value that is compressed by the
+	 * client before it is sent. Unlike compression_threshold, the value is stored compressed
+	 * on the server as a blob with a small header, and reads decompress it transparently.
+	 * Values that do not shrink are sent unchanged.
+	 *
+	 * Compressed bins are blobs to the server, so string operations, bitwise operations and
+	 * expressions on these bins do not see the original value. Only enable this for bins
+	 * that are read and written whole by clients that support bin compression.
+	 *
+	 * Default: 0 (do not compress bin values)
+	 */
+	uint32_t bin_compress_threshold;
+
+	/**
+	 * Codec used to compress bin values above bin_compress_threshold. Every client that
+	 * reads the bins must be built with this codec.
+	 *
+	 * Default: AS_COMPRESS_ZLIB
+	 */
+	as_compress_codec bin_compress_codec;
+
 	/**
 	 * If the command results in a record deletion, leave a tombstone for the record.
 	 * This prevents deleted records from reappearing after node failures.
@@ -1025,6 +1222,35 @@ typedef struct as_policy_batch_s {
 	 */
 	int read_touch_ttl_percent;
 
+	/**
+	 * Maximum number of keys sent to a node in a single batch command. Keys that map to the
+	 * same node are split into multiple commands of at most this many keys. The split
+	 * commands are executed in parallel when concurrent is true or the batch is async, so a
+	 * large batch is not limited by a single large command buffer and server response.
+	 * Results are still stored in their original batch positions.
+	 *
+	 * If zero, all keys for a node are sent in one command.
+	 *
+	 * Default: 0
+	 */
+	uint32_t max_keys_per_node_command;
+
+	/**
+	 * Hedged batch read delay in milliseconds. If a node command has not responded within
+	 * this delay, the node command's keys are also sent to their next replicas and the first
+	 * response for each key wins. Node commands whose keys have all been answered by other
+	 * node commands are cancelled by closing their connections. This is typically set near
+	 * the observed p99 batch latency, so only the slowest node commands are duplicated.
+	 *
+	 * Applies to read-only batches in sync and async mode when the replica policy allows
+	 * multiple replicas. Hedging is not applied to batches in a transaction, streamed batch
+	 * results, async batches with a progress listener or sync batches on TLS connections.
+	 * Async hedged batches run all node commands on the batch's event loop.
+	 *
+	 * Default: 0 (disabled)
+	 */
+	uint32_t hedge_delay;
+
 	/**
 	 * Determine if batch commands to each server are run in parallel threads.
 	 *
@@ -1045,6 +1271,19 @@ typedef struct as_policy_batch_s {
 	 */
 	bool concurrent;
 
+	/**
+	 * Estimated batch response size in bytes at or above which concurrent batch commands are
+	 * run in parallel threads. The estimate is the number of keys multiplied by the average
+	 * record size observed in recent batch responses. Smaller batches are run sequentially in
+	 * the calling thread, which avoids thread handoff when the batch completes quickly anyway.
+	 * This field is only used when concurrent is true.
+	 *
+	 * If zero, concurrent batch commands are always run in parallel threads.
+	 *
+	 * Default: 0
+	 */
+	uint32_t concurrent_threshold;
+
 	/**
 	 * Allow batch to be processed immediately in the server's receiving thread for in-memory
 	 * namespaces. If false, the batch will always be processed in separate service threads.
@@ -1093,6 +1332,45 @@ typedef struct as_policy_batch_s {
 	 */
 	bool respond_all_keys;
 
+	/**
+	 * Balance batch reads across replicas on the same rack when replica is
+	 * AS_POLICY_REPLICA_PREFER_RACK. Each read key is assigned to the replica on the preferred
+	 * rack that has the fewest keys in this batch so far, so per-node commands are roughly
+	 * equal in size and stay within the rack. Keys without an active replica on a preferred
+	 * rack fall back to normal AS_POLICY_REPLICA_PREFER_RACK routing. Writes and retries are
+	 * not balanced.
+	 *
+	 * Default: false
+	 */
+	bool rack_balance;
+
+	/**
+	 * Send each distinct read key of the batch to the server once. Keys with the same
+	 * namespace and digest are detected while keys are grouped by node, and the result of the
+	 * first occurrence is copied into every duplicate slot. For as_batch_records, only read
+	 * records that also share bin names, operations and read policy are deduplicated.
+	 *
+	 * Batches that contain writes, streamed results and async batches with a progress
+	 * listener are not deduplicated.
+	 *
+	 * Default: false
+	 */
+	bool dedup_keys;
+
+	/**
+	 * Run the node commands of an async batch on different event loops, so responses from
+	 * many nodes are parsed in parallel. Each node command's event loop is selected by
+	 * as_policy_event.loop_selection, for example one loop per node with
+	 * AS_EVENT_LOOP_SELECTION_NODE_AFFINITY. The batch listener is still called from the
+	 * event loop assigned to the batch.
+	 *
+	 * Ignored for sync batches, batches with a progress listener and when only one event
+	 * loop exists.
+	 *
+	 * Default: false
+	 */
+	bool spread_event_loops;
+
 	/**
 	 * This method is deprecated and will eventually be removed.
 	 * The set name is now always sent for every distinct namespace/set in the batch.
@@ -1379,10 +1657,56 @@ typedef struct as_policy_query_s {
 	 */
 	uint32_t info_timeout;
 
+	/**
+	 * Number of concurrent commands a node's partitions are split into. Each command
+	 * covers a disjoint subset of the node's partitions and uses its own connection, so
+	 * a node can serve the query on multiple server threads. Partitions are retried per
+	 * command. A records_per_second limit applies to each command.
+	 *
+	 * Default: 1 (one command per node)
+	 */
+	uint32_t commands_per_node;
+
 	/**
 	 * Algorithm used to determine target node.
 	 */
 	as_policy_replica replica;
+
+	/**
+	 * Optional flow control used to pause and resume record intake of an async query.
+	 * Ignored by sync queries.
+	 *
+	 * Default: NULL
+	 */
+	struct as_async_flow_s* flow;
+
+	/**
+	 * File that partition status is periodically saved to while a query runs. Pass the status
+	 * loaded with as_partitions_status_load() to as_partition_filter_set_partitions() to
+	 * resume the query after a process restart. Records delivered after the last checkpoint
+	 * are returned again. Only used by aerospike_query_partitions() and aerospike_query_partitions_async(). The path is copied when the query starts.
+	 *
+	 * Default: NULL (do not checkpoint)
+	 */
+	const char* checkpoint_path;
+
+	/**
+	 * Minimum time in milliseconds between checkpoints. A checkpoint is also written each
+	 * time the query completes a round of node commands.
+	 *
+	 * Default: 10000
+	 */
+	uint32_t checkpoint_interval;
+
+	/**
+	 * Client-side records per second limit shared by all node commands and retries of the
+	 * query. Unlike as_query.records_per_second, which each server applies separately, the
+	 * limit applies to the aggregate rate received by the client. The limiter may be shared
+	 * with other queries and scans. Only synchronous queries are limited.
+	 *
+	 * Default: NULL (no client-side limit)
+	 */
+	as_rate_limiter* rate_limiter;
 	
 	/**
 	 * Expected query duration. The server treats the query in different ways depending on the expected duration.
@@ -1400,6 +1724,17 @@ typedef struct as_policy_query_s {
 	 */
 	bool fail_on_cluster_change;
 
+	/**
+	 * Let an async query start with a few node commands at once and add more while the
+	 * command completion rate keeps improving and event loop lag stays below
+	 * as_policy_event.lag_threshold_ms (10ms if zero). Concurrency is reduced again when
+	 * the completion rate drops or the event loop lags. Ignored by sync queries and when
+	 * fail_on_cluster_change is true.
+	 *
+	 * Default: false (run all node commands at once)
+	 */
+	bool adaptive_concurrency;
+
 	/**
 	 * Should raw bytes representing a list or map be deserialized to as_list or as_map.
 	 * Set to false for backup programs that just need access to raw bytes.
@@ -1458,11 +1793,59 @@ typedef struct as_policy_scan_s {
 	 */
 	uint32_t records_per_second;
 
+	/**
+	 * Number of concurrent commands a node's partitions are split into. Each command
+	 * covers a disjoint subset of the node's partitions and uses its own connection, so
+	 * a node can serve the scan on multiple server threads. Partitions are retried per
+	 * command. A records_per_second limit applies to each command.
+	 *
+	 * Values greater than one only run concurrently when as_scan.concurrent is true.
+	 *
+	 * Default: 1 (one command per node)
+	 */
+	uint32_t commands_per_node;
+
 	/**
 	 * Algorithm used to determine target node.
 	 */
 	as_policy_replica replica;
 
+	/**
+	 * Optional flow control used to pause and resume record intake of an async scan.
+	 * Ignored by sync scans.
+	 *
+	 * Default: NULL
+	 */
+	struct as_async_flow_s* flow;
+
+	/**
+	 * File that partition status is periodically saved to while a scan runs. Pass the status
+	 * loaded with as_partitions_status_load() to as_partition_filter_set_partitions() to
+	 * resume the scan after a process restart. Records delivered after the last checkpoint
+	 * are returned again. Only used by aerospike_scan_partitions() and aerospike_scan_partitions_async(). The path is copied when the scan starts.
+	 *
+	 * Default: NULL (do not checkpoint)
+	 */
+	const char* checkpoint_path;
+
+	/**
+	 * Minimum time in milliseconds between checkpoints. A checkpoint is also written each
+	 * time the scan completes a round of node commands.
+	 *
+	 * Default: 10000
+	 */
+	uint32_t checkpoint_interval;
+
+	/**
+	 * Client-side records per second limit shared by all node commands and retries of the
+	 * scan. Unlike records_per_second, which each server applies separately, the limit
+	 * applies to the aggregate rate received by the client. The limiter may be shared with
+	 * other scans and queries. Only synchronous scans are limited.
+	 *
+	 * Default: NULL (no client-side limit)
+	 */
+	as_rate_limiter* rate_limiter;
+
 	/**
 	 * The default time-to-live (expiration) of the record in seconds. This field will only be
 	 * used on background scan writes if "as_scan.ttl" is set to AS_RECORD_CLIENT_DEFAULT_TTL.
@@ -1485,6 +1868,15 @@ typedef struct as_policy_scan_s {
 	 */
 	bool durable_delete;
 
+	/**
+	 * Let an async scan start with a few node commands at once and add more while the
+	 * command completion rate keeps improving and event loop lag stays low. See
+	 * as_policy_query.adaptive_concurrency. Only used when as_scan.concurrent is true.
+	 *
+	 * Default: false (run all node commands at once)
+	 */
+	bool adaptive_concurrency;
+
 } as_policy_scan;
 
 /**
@@ -1654,7 +2046,15 @@ as_policy_base_read_init(as_policy_base* p)
 	p->sleep_between_retries = 0;
 	p->filter_exp = NULL;
 	p->txn = NULL;
+	p->cancel = NULL;
 	p->compress = false;
+	p->spin_read_us = 0;
+	p->priority = AS_POLICY_PRIORITY_FOREGROUND;
+	p->latency_tag = 0;
+	p->adaptive_timeout_pct = 0;
+	p->adaptive_timeout_min = AS_POLICY_ADAPTIVE_TIMEOUT_MIN_DEFAULT;
+	p->ordered = false;
+	p->resolved = NULL;
 }
 
 /**
@@ -1669,7 +2069,15 @@ as_policy_base_write_init(as_policy_base* p)
 	p->sleep_between_retries = 0;
 	p->filter_exp = NULL;
 	p->txn = NULL;
+	p->cancel = NULL;
 	p->compress = false;
+	p->spin_read_us = 0;
+	p->priority = AS_POLICY_PRIORITY_FOREGROUND;
+	p->latency_tag = 0;
+	p->adaptive_timeout_pct = 0;
+	p->adaptive_timeout_min = AS_POLICY_ADAPTIVE_TIMEOUT_MIN_DEFAULT;
+	p->ordered = false;
+	p->resolved = NULL;
 }
 
 /**
@@ -1697,7 +2105,15 @@ as_policy_base_query_init(as_policy_base* p)
 	p->sleep_between_retries = 0;
 	p->filter_exp = NULL;
 	p->txn = NULL;
+	p->cancel = NULL;
 	p->compress = false;
+	p->spin_read_us = 0;
+	p->priority = AS_POLICY_PRIORITY_FOREGROUND;
+	p->latency_tag = 0;
+	p->adaptive_timeout_pct = 0;
+	p->adaptive_timeout_min = AS_POLICY_ADAPTIVE_TIMEOUT_MIN_DEFAULT;
+	p->ordered = false;
+	p->resolved = NULL;
 }
 
 /**
@@ -1717,8 +2133,11 @@ as_policy_read_init(as_policy_read* p)
 	p->read_mode_ap = AS_POLICY_READ_MODE_AP_DEFAULT;
 	p->read_mode_sc = AS_POLICY_READ_MODE_SC_DEFAULT;
 	p->read_touch_ttl_percent = 0;
+	p->hedge_delay = 0;
 	p->deserialize = true;
 	p->async_heap_rec = false;
+	p->zero_copy = false;
+	p->lazy_deserialize = false;
 	return p;
 }
 
@@ -1755,6 +2174,8 @@ as_policy_write_init(as_policy_write* p)
 	p->exists = AS_POLICY_EXISTS_DEFAULT;
 	p->ttl = 0; // AS_RECORD_DEFAULT_TTL
 	p->compression_threshold = AS_POLICY_COMPRESSION_THRESHOLD_DEFAULT;
+	p->bin_compress_threshold = 0;
+	p->bin_compress_codec = AS_COMPRESS_ZLIB;
 	p->durable_delete = false;
 	p->on_locking_only = false;
 	return p;
@@ -1903,10 +2324,16 @@ as_policy_batch_init(as_policy_batch* p)
 	p->read_mode_ap = AS_POLICY_READ_MODE_AP_DEFAULT;
 	p->read_mode_sc = AS_POLICY_READ_MODE_SC_DEFAULT;
 	p->read_touch_ttl_percent = 0;
+	p->max_keys_per_node_command = 0;
+	p->hedge_delay = 0;
 	p->concurrent = false;
+	p->concurrent_threshold = 0;
 	p->allow_inline = true;
 	p->allow_inline_ssd = false;
 	p->respond_all_keys = true;
+	p->rack_balance = false;
+	p->dedup_keys = false;
+	p->spread_event_loops = false;
 	p->send_set_name = true;
 	p->deserialize = true;
 	return p;
@@ -2020,9 +2447,15 @@ as_policy_scan_init(as_policy_scan* p)
 	as_policy_base_query_init(&p->base);
 	p->max_records = 0;
 	p->records_per_second = 0;
+	p->commands_per_node = 1;
 	p->replica = AS_POLICY_REPLICA_SEQUENCE;
+	p->flow = NULL;
+	p->checkpoint_path = NULL;
+	p->checkpoint_interval = 10000;
+	p->rate_limiter = NULL;
 	p->ttl = 0; // AS_RECORD_DEFAULT_TTL
 	p->durable_delete = false;
+	p->adaptive_concurrency = false;
 	return p;
 }
 
@@ -2053,9 +2486,15 @@ as_policy_query_init(as_policy_query* p)
 {
 	as_policy_base_query_init(&p->base);
 	p->info_timeout = 10000;
+	p->commands_per_node = 1;
 	p->replica = AS_POLICY_REPLICA_SEQUENCE;
+	p->flow = NULL;
+	p->checkpoint_path = NULL;
+	p->checkpoint_interval = 10000;
+	p->rate_limiter = NULL;
 	p->expected_duration = AS_QUERY_DURATION_LONG;
 	p->fail_on_cluster_change = false;
+	p->adaptive_concurrency = false;
 	p->deserialize = true;
 	p->short_query = false;
 	return p;
@@ -2152,15 +2591,29 @@ as_policy_txn_verify_init(as_policy_txn_verify* p)
 	p->base.sleep_between_retries = 1000;
 	p->base.filter_exp = NULL;
 	p->base.txn = NULL;
+	p->base.cancel = NULL;
 	p->base.compress = false;
+	p->base.spin_read_us = 0;
+	p->base.priority = AS_POLICY_PRIORITY_FOREGROUND;
+	p->base.latency_tag = 0;
+	p->base.adaptive_timeout_pct = 0;
+	p->base.adaptive_timeout_min = AS_POLICY_ADAPTIVE_TIMEOUT_MIN_DEFAULT;
+	p->base.ordered = false;
+	p->base.resolved = NULL;
 	p->replica = AS_POLICY_REPLICA_MASTER;
 	p->read_mode_ap = AS_POLICY_READ_MODE_AP_DEFAULT;
 	p->read_mode_sc = AS_POLICY_READ_MODE_SC_LINEARIZE;
 	p->read_touch_ttl_percent = 0;
+	p->max_keys_per_node_command = 0;
+	p->hedge_delay = 0;
 	p->concurrent = false;
+	p->concurrent_threshold = 0;
 	p->allow_inline = true;
 	p->allow_inline_ssd = false;
 	p->respond_all_keys = true;
+	p->rack_balance = false;
+	p->dedup_keys = false;
+	p->spread_event_loops = false;
 	p->send_set_name = true;
 	p->deserialize = true;
 	return p;
@@ -2197,15 +2650,29 @@ as_policy_txn_roll_init(as_policy_txn_roll* p)
 	p->base.sleep_between_retries = 1000;
 	p->base.filter_exp = NULL;
 	p->base.txn = NULL;
+	p->base.cancel = NULL;
 	p->base.compress = false;
+	p->base.spin_read_us = 0;
+	p->base.priority = AS_POLICY_PRIORITY_FOREGROUND;
+	p->base.latency_tag = 0;
+	p->base.adaptive_timeout_pct = 0;
+	p->base.adaptive_timeout_min = AS_POLICY_ADAPTIVE_TIMEOUT_MIN_DEFAULT;
+	p->base.ordered = false;
+	p->base.resolved = NULL;
 	p->replica = AS_POLICY_REPLICA_MASTER;
 	p->read_mode_ap = AS_POLICY_READ_MODE_AP_DEFAULT;
 	p->read_mode_sc = AS_POLICY_READ_MODE_SC_DEFAULT;
 	p->read_touch_ttl_percent = 0;
+	p->max_keys_per_node_command = 0;
+	p->hedge_delay = 0;
 	p->concurrent = false;
+	p->concurrent_threshold = 0;
 	p->allow_inline = true;
 	p->allow_inline_ssd = false;
 	p->respond_all_keys = true;
+	p->rack_balance = false;
+	p->dedup_keys = false;
+	p->spread_event_loops = false;
 	p->send_set_name = true;
 	p->deserialize = true;
 	return p;
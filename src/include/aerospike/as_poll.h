@@ -100,6 +100,93 @@ as_poll_socket(as_poll* poll, as_socket_fd fd, uint32_t timeout, bool read)
 	return rv;
 }
 
+// Wait for either socket to become readable. The poll must be initialized with the larger fd.
+// Return -1 on error, 0 on timeout, otherwise bit 1 is set if fd1 is readable and bit 2 is
+// set if fd2 is readable.
+static inline int
+as_poll_sockets_read(as_poll* poll, as_socket_fd fd1, as_socket_fd fd2, uint32_t timeout)
+{
+	memset(poll->set, 0, poll->size);
+	FD_SET(fd1 % FD_SETSIZE, &poll->set[fd1 / FD_SETSIZE]);
+	FD_SET(fd2 % FD_SETSIZE, &poll->set[fd2 / FD_SETSIZE]);
+
+	struct timeval tv;
+	struct timeval* tvp;
+
+	if (timeout > 0) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		tvp = &tv;
+	}
+	else {
+		tvp = NULL;
+	}
+
+	as_socket_fd max = (fd1 > fd2)? fd1 : fd2;
+	int rv = select(max + 1, poll->set /*readfd*/, 0 /*writefd*/, 0/*oobfd*/, tvp);
+
+	if (rv <= 0) {
+		return rv;
+	}
+
+	rv = 0;
+
+	if (FD_ISSET(fd1 % FD_SETSIZE, &poll->set[fd1 / FD_SETSIZE])) {
+		rv |= 1;
+	}
+
+	if (FD_ISSET(fd2 % FD_SETSIZE, &poll->set[fd2 / FD_SETSIZE])) {
+		rv |= 2;
+	}
+	return rv;
+}
+
+// Wait for any socket to become readable. The poll must be initialized with the largest fd.
+// Return index of the first readable socket in fds, or -1 on error or timeout.
+static inline int
+as_poll_sockets_read_any(as_poll* poll, const as_socket_fd* fds, uint32_t n_fds, uint32_t timeout)
+{
+	memset(poll->set, 0, poll->size);
+
+	as_socket_fd max = 0;
+
+	for (uint32_t i = 0; i < n_fds; i++) {
+		as_socket_fd fd = fds[i];
+		FD_SET(fd % FD_SETSIZE, &poll->set[fd / FD_SETSIZE]);
+
+		if (fd > max) {
+			max = fd;
+		}
+	}
+
+	struct timeval tv;
+	struct timeval* tvp;
+
+	if (timeout > 0) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		tvp = &tv;
+	}
+	else {
+		tvp = NULL;
+	}
+
+	int rv = select(max + 1, poll->set /*readfd*/, 0 /*writefd*/, 0/*oobfd*/, tvp);
+
+	if (rv <= 0) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < n_fds; i++) {
+		as_socket_fd fd = fds[i];
+
+		if (FD_ISSET(fd % FD_SETSIZE, &poll->set[fd / FD_SETSIZE])) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
 static inline void
 as_poll_destroy(as_poll* poll)
 {
@@ -148,6 +235,78 @@ as_poll_socket(as_poll* poll, as_socket_fd fd, uint32_t timeout, bool read)
 	return rv;
 }
 
+static inline int
+as_poll_sockets_read(as_poll* poll, as_socket_fd fd1, as_socket_fd fd2, uint32_t timeout)
+{
+	FD_ZERO(&poll->set);
+	FD_SET(fd1, &poll->set);
+	FD_SET(fd2, &poll->set);
+
+	struct timeval tv;
+	struct timeval* tvp;
+
+	if (timeout > 0) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		tvp = &tv;
+	}
+	else {
+		tvp = NULL;
+	}
+
+	int rv = select(0, &poll->set /*readfd*/, 0 /*writefd*/, 0/*oobfd*/, tvp);
+
+	if (rv <= 0) {
+		return rv;
+	}
+
+	rv = 0;
+
+	if (FD_ISSET(fd1, &poll->set)) {
+		rv |= 1;
+	}
+
+	if (FD_ISSET(fd2, &poll->set)) {
+		rv |= 2;
+	}
+	return rv;
+}
+
+static inline int
+as_poll_sockets_read_any(as_poll* poll, const as_socket_fd* fds, uint32_t n_fds, uint32_t timeout)
+{
+	FD_ZERO(&poll->set);
+
+	for (uint32_t i = 0; i < n_fds; i++) {
+		FD_SET(fds[i], &poll->set);
+	}
+
+	struct timeval tv;
+	struct timeval* tvp;
+
+	if (timeout > 0) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		tvp = &tv;
+	}
+	else {
+		tvp = NULL;
+	}
+
+	int rv = select(0, &poll->set /*readfd*/, 0 /*writefd*/, 0/*oobfd*/, tvp);
+
+	if (rv <= 0) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < n_fds; i++) {
+		if (FD_ISSET(fds[i], &poll->set)) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
 #define as_poll_destroy(_poll)
 
 #endif
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_operations.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Operations serialized once and executed many times with aerospike_key_operate_prepared().
+ * Only the command header, key fields and filter expression are written on each execution.
+ * The serialized operations are copied into the command as is.
+ *
+ * Integer and double operation values can be changed in place with
+ * as_prepared_operate_set_int64() and as_prepared_operate_set_double(). Other values are
+ * fixed when the template is created. Changing a value modifies the template, so a template
+ * must not be changed while another thread executes it.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_operations ops;
+ * as_operations_inita(&ops, 2);
+ * as_operations_add_incr(&ops, "count", 1);
+ * as_operations_add_read(&ops, "count");
+ *
+ * as_prepared_operate prep;
+ * as_prepared_operate_init(&prep, &err, &ops);
+ * as_operations_destroy(&ops);
+ *
+ * for (uint32_t i = 0; i < n; i++) {
+ *     as_prepared_operate_set_int64(&prep, &err, 0, increments[i]);
+ *
+ *     as_record* rec = NULL;
+ *     aerospike_key_operate_prepared(&as, &err, NULL, &keys[i], &prep, &rec);
+ *     as_record_destroy(rec);
+ * }
+ * as_prepared_operate_destroy(&prep);
+ * ~~~~~~~~~~
+ *
+ * @ingroup base_operations
+ */
+typedef struct as_prepared_operate_s {
+	/**
+	 * @private
+	 * Serialized operations.
+	 */
+	uint8_t* buf;
+
+	/**
+	 * @private
+	 * Offset of each operation in buf.
+	 */
+	uint32_t* offsets;
+
+	/**
+	 * @private
+	 * Size of serialized operations.
+	 */
+	uint32_t size;
+
+	/**
+	 * Record time-to-live used when the operations write. Initialized from
+	 * as_operations.ttl and may be changed between executions.
+	 */
+	uint32_t ttl;
+
+	/**
+	 * Expected generation used when the policy gen is not AS_POLICY_GEN_IGNORE.
+	 * Initialized from as_operations.gen and may be changed between executions.
+	 */
+	uint16_t gen;
+
+	/**
+	 * @private
+	 * Number of operations.
+	 */
+	uint16_t n_operations;
+
+	/**
+	 * @private
+	 * Read attributes required by the operations.
+	 */
+	uint8_t read_attr;
+
+	/**
+	 * @private
+	 * Write attributes required by the operations.
+	 */
+	uint8_t write_attr;
+
+	/**
+	 * @private
+	 * Operations require a result for every operation.
+	 */
+	bool respond_all_ops;
+} as_prepared_operate;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Serialize operations into a prepared template. The operations are not referenced after
+ * this call and may be destroyed.
+ *
+ * @param prep		The template to initialize.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param ops		The operations to serialize.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @relates as_prepared_operate
+ */
+AS_EXTERN as_status
+as_prepared_operate_init(as_prepared_operate* prep, as_error* err, const as_operations* ops);
+
+/**
+ * Release memory held by prepared template.
+ *
+ * @relates as_prepared_operate
+ */
+AS_EXTERN void
+as_prepared_operate_destroy(as_prepared_operate* prep);
+
+/**
+ * Replace integer value of operation at index. The operation must have been added with an
+ * integer value, for example as_operations_add_write_int64() or as_operations_add_incr().
+ *
+ * @relates as_prepared_operate
+ */
+AS_EXTERN as_status
+as_prepared_operate_set_int64(as_prepared_operate* prep, as_error* err, uint16_t index, int64_t value);
+
+/**
+ * Replace double value of operation at index. The operation must have been added with a
+ * double value, for example as_operations_add_write_double() or as_operations_add_incr_double().
+ *
+ * @relates as_prepared_operate
+ */
+AS_EXTERN as_status
+as_prepared_operate_set_double(as_prepared_operate* prep, as_error* err, uint16_t index, double value);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <aerospike/as_std.h>
+#include <aerospike/as_compress.h>
 #include <aerospike/as_error.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <stddef.h>
@@ -37,6 +38,11 @@ extern "C" {
 #define AS_ADMIN_MESSAGE_TYPE 2
 #define AS_MESSAGE_TYPE 3
 #define AS_COMPRESSED_MESSAGE_TYPE 4
+
+// Compressed message types for codecs other than zlib. These are only sent to and received
+// from nodes that advertise the codec's compression feature.
+#define AS_COMPRESSED_LZ4_MESSAGE_TYPE 6
+#define AS_COMPRESSED_ZSTD_MESSAGE_TYPE 7
 #define PROTO_SIZE_MAX (128 * 1024 * 1024)
 
 /******************************************************************************
@@ -133,7 +139,43 @@ as_status as_proto_type_error(as_error* err, as_proto* proto, uint8_t expected);
 as_status as_proto_size_error(as_error* err, size_t size);
 as_status as_compressed_size_error(as_error* err, size_t size);
 as_status as_proto_parse(as_error* err, as_proto* proto);
-as_status as_proto_decompress(as_error* err, uint8_t* trg, size_t trg_sz, uint8_t* src, size_t src_sz);
+as_status as_proto_decompress(
+	as_error* err, uint8_t type, as_compress_stats* stats, uint8_t* trg, size_t trg_sz,
+	uint8_t* src, size_t src_sz
+	);
+
+static inline bool
+as_proto_is_compressed(uint8_t type)
+{
+	return type == AS_COMPRESSED_MESSAGE_TYPE || type == AS_COMPRESSED_LZ4_MESSAGE_TYPE ||
+		type == AS_COMPRESSED_ZSTD_MESSAGE_TYPE;
+}
+
+static inline uint8_t
+as_proto_compressed_type(as_compress_codec codec)
+{
+	switch (codec) {
+		case AS_COMPRESS_LZ4:
+			return AS_COMPRESSED_LZ4_MESSAGE_TYPE;
+		case AS_COMPRESS_ZSTD:
+			return AS_COMPRESSED_ZSTD_MESSAGE_TYPE;
+		default:
+			return AS_COMPRESSED_MESSAGE_TYPE;
+	}
+}
+
+static inline as_compress_codec
+as_proto_compressed_codec(uint8_t type)
+{
+	switch (type) {
+		case AS_COMPRESSED_LZ4_MESSAGE_TYPE:
+			return AS_COMPRESS_LZ4;
+		case AS_COMPRESSED_ZSTD_MESSAGE_TYPE:
+			return AS_COMPRESS_ZSTD;
+		default:
+			return AS_COMPRESS_ZLIB;
+	}
+}
 
 static inline as_status
 as_proto_parse_type(as_error* err, as_proto* proto, uint8_t expected_type)
@@ -260,6 +260,12 @@ typedef struct as_predicate_s {
 	 * The type of index predicate is on
 	 */
 	as_index_type itype;
+
+	/**
+	 * @private
+	 * Prepared geo region. Use as_query_where_region() to set.
+	 */
+	const struct as_geo_region_s* region;
 } as_predicate;
 
 /**
@@ -297,6 +303,30 @@ typedef struct as_ordering_s {
 
 } as_ordering;
 
+/**
+ * Record value used to order query results on the client.
+ *
+ * @ingroup query_operations
+ */
+typedef enum as_order_key_e {
+	/**
+	 * Order by bin value. Integer and double values are ordered numerically before string
+	 * values. Records without an integer, double or string value in the bin are returned last.
+	 */
+	AS_ORDER_KEY_BIN = 0,
+
+	/**
+	 * Order by record time-to-live.
+	 */
+	AS_ORDER_KEY_TTL = 1,
+
+	/**
+	 * Order by record generation.
+	 */
+	AS_ORDER_KEY_GEN = 2
+
+} as_order_key;
+
 /**
  * Sequence of bins which should be selected during a query.
  *
@@ -584,6 +614,29 @@ typedef struct as_query_s {
 	 */
 	bool no_bins;
 
+	/**
+	 * @private
+	 * Client side result ordering. Use as_query_orderby() or as_query_orderby_meta().
+	 */
+	bool ordered;
+
+	/**
+	 * @private
+	 */
+	as_order_key orderby_key;
+
+	/**
+	 * @private
+	 * Bin name and direction of result ordering.
+	 */
+	as_ordering orderby;
+
+	/**
+	 * @private
+	 * Maximum ordered records returned. Zero returns all records.
+	 */
+	uint32_t orderby_limit;
+
 } as_query;
 
 //---------------------------------
@@ -929,6 +982,32 @@ as_query_where_with_exp(
 	as_index_type itype, as_index_datatype dtype, ...
 	);
 
+/**
+ * Add a geo within predicate using a region prepared by as_geo_region_create(). The encoded
+ * region is copied into each query command instead of encoding the GeoJSON text again.
+ *
+ * The region is not owned by as_query and must not be destroyed until the query has been
+ * executed.
+ *
+ * @code
+ * as_query query;
+ * as_query_init(&query, ns, set);
+ * as_query_where_init(&query, 1);
+ * as_query_where_region(&query, "loc", region);
+ * @endcode
+ *
+ * @param query			The query add the predicate to.
+ * @param bin			The name of the geo indexed bin.
+ * @param region		The prepared region.
+ *
+ * @return On success, true. Otherwise an error occurred.
+ *
+ * @relates as_query
+ * @ingroup query_operations
+ */
+AS_EXTERN bool
+as_query_where_region(as_query* query, const char* bin, const struct as_geo_region_s* region);
+
 //---------------------------------
 // Background Query Functions
 //---------------------------------
@@ -988,6 +1067,48 @@ as_query_set_partitions(as_query* query, as_partitions_status* parts_all)
 	query->parts_all = as_partitions_status_reserve(parts_all);
 }
 
+/**
+ * Return foreground query records ordered by a bin value. Nodes return records in no particular
+ * order, so the client buffers records and returns them in order after all nodes have completed.
+ * If limit is greater than zero, only the first limit records in that order are returned and the
+ * client buffers at most limit records. Otherwise, all records are buffered.
+ *
+ * Ordering applies to aerospike_query_foreach(), aerospike_query_partitions() and their async
+ * versions. Aggregation, background and paginated queries can not be ordered. Ordering is not
+ * serialized by as_query_to_bytes().
+ *
+ * @code
+ * // Return the 10 records with the largest "ts" bin value.
+ * as_query_orderby(&query, "ts", AS_ORDER_DESCENDING, 10);
+ * @endcode
+ *
+ * @param query		The query to modify.
+ * @param bin		The bin to order by.
+ * @param order		Ascending or descending order.
+ * @param limit		Maximum records returned. Use zero to return all records.
+ *
+ * @return On success, true. Otherwise the bin name is invalid.
+ * @relates as_query
+ * @ingroup query_operations
+ */
+AS_EXTERN bool
+as_query_orderby(as_query* query, const char* bin, as_order order, uint32_t limit);
+
+/**
+ * Return foreground query records ordered by record metadata. See as_query_orderby().
+ *
+ * @param query		The query to modify.
+ * @param key		AS_ORDER_KEY_TTL or AS_ORDER_KEY_GEN.
+ * @param order		Ascending or descending order.
+ * @param limit		Maximum records returned. Use zero to return all records.
+ *
+ * @return On success, true. Otherwise key is not a metadata key.
+ * @relates as_query
+ * @ingroup query_operations
+ */
+AS_EXTERN bool
+as_query_orderby_meta(as_query* query, as_order_key key, as_order order, uint32_t limit);
+
 /**
  * If using query pagination, did the previous paginated query with this query instance
  * return all records?
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike_query.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_query.h>
+#include <aerospike/as_vector.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Buffers query records and returns them in as_query_orderby() order after the query
+ * completes. When a limit is set, records are kept in a bounded heap with the last record
+ * in sort order at the root, so at most limit records are buffered.
+ */
+typedef struct as_query_sorter_s {
+	pthread_mutex_t lock;
+	as_vector records;
+	aerospike_query_foreach_callback callback;
+	as_async_query_record_listener listener;
+	void* udata;
+	as_bin_name bin;
+	as_order_key key;
+	uint32_t limit;
+	bool descending;
+	bool complete;
+	bool free;
+} as_query_sorter;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Verify query can be ordered on the client.
+ */
+as_status
+as_query_order_validate(as_error* err, const as_query* query);
+
+/**
+ * @private
+ * Initialize sorter for a synchronous query. The sorter forwards ordered records to callback.
+ */
+void
+as_query_sorter_init(
+	as_query_sorter* sorter, const as_query* query, aerospike_query_foreach_callback callback,
+	void* udata
+	);
+
+/**
+ * @private
+ * Create sorter for an async query. The sorter forwards ordered records to listener and is
+ * destroyed when the query completes.
+ */
+as_query_sorter*
+as_query_sorter_create(
+	const as_query* query, as_async_query_record_listener listener, void* udata
+	);
+
+/**
+ * @private
+ * Forward buffered records to the synchronous callback in sort order, followed by the
+ * completion callback. Records are not forwarded if the query failed, but the completion
+ * callback is still made if the query made it.
+ */
+void
+as_query_sorter_complete(as_query_sorter* sorter, as_status status);
+
+/**
+ * @private
+ * Destroy buffered records and release sorter.
+ */
+void
+as_query_sorter_destroy(as_query_sorter* sorter);
+
+/**
+ * @private
+ * Synchronous query callback. The udata argument is the sorter. Records are buffered until
+ * as_query_sorter_complete() is called.
+ */
+bool
+as_query_sorter_callback(const as_val* val, void* udata);
+
+/**
+ * @private
+ * Async query listener. The udata argument is the sorter.
+ */
+bool
+as_query_sorter_listener(
+	as_error* err, as_record* record, void* udata, as_event_loop* event_loop
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
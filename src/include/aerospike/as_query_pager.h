@@ -0,0 +1,241 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_partition_filter.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_query.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_vector.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Records returned by one page of a paginated partition query.
+ *
+ * @ingroup query_operations
+ */
+typedef struct as_query_page_s {
+	/**
+	 * @private
+	 * Next prefetched page.
+	 */
+	struct as_query_page_s* next;
+
+	/**
+	 * Records of type as_record* in the order they were received.
+	 */
+	as_vector records;
+} as_query_page;
+
+/**
+ * Paginated partition query that fetches the next pages while the application consumes
+ * the current page. Pages are fetched by a background thread with
+ * aerospike_query_partitions() and at most depth pages are buffered ahead of the
+ * application.
+ *
+ * The query must have max_records set, which is the page size, and paginate enabled.
+ * The query, partition filter and policy must not be used or destroyed by the application
+ * until as_query_pager_destroy() returns.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_query query;
+ * as_query_init(&query, "test", "demo");
+ * query.max_records = 1000;
+ * as_query_set_paginate(&query, true);
+ *
+ * as_partition_filter pf;
+ * as_partition_filter_set_all(&pf);
+ *
+ * as_query_pager pager;
+ *
+ * if (as_query_pager_init(&pager, &as, &err, NULL, &query, &pf, 2) == AEROSPIKE_OK) {
+ *     as_query_page* page;
+ *
+ *     while (as_query_pager_next(&pager, &err, &page) == AEROSPIKE_OK && page) {
+ *         for (uint32_t i = 0; i < page->records.size; i++) {
+ *             as_record* rec = as_vector_get_ptr(&page->records, i);
+ *             // Process record
+ *         }
+ *         as_query_page_destroy(page);
+ *     }
+ *     as_query_pager_destroy(&pager);
+ * }
+ * as_query_destroy(&query);
+ * ~~~~~~~~~~
+ *
+ * @ingroup query_operations
+ */
+typedef struct as_query_pager_s {
+	/**
+	 * @private
+	 */
+	pthread_mutex_t lock;
+
+	/**
+	 * @private
+	 */
+	pthread_cond_t cond;
+
+	/**
+	 * @private
+	 */
+	pthread_t thread;
+
+	/**
+	 * @private
+	 */
+	aerospike* as;
+
+	/**
+	 * @private
+	 */
+	const as_policy_query* policy;
+
+	/**
+	 * @private
+	 */
+	as_query* query;
+
+	/**
+	 * @private
+	 */
+	as_partition_filter* pf;
+
+	/**
+	 * @private
+	 * Prefetched pages not yet returned to the application.
+	 */
+	as_query_page* head;
+
+	/**
+	 * @private
+	 */
+	as_query_page* tail;
+
+	/**
+	 * @private
+	 * Page currently filled by the background thread.
+	 */
+	as_query_page* fill;
+
+	/**
+	 * @private
+	 */
+	uint32_t n_pages;
+
+	/**
+	 * @private
+	 * Maximum number of prefetched pages.
+	 */
+	uint32_t depth;
+
+	/**
+	 * @private
+	 * Error that terminated the background thread.
+	 */
+	as_error err;
+
+	/**
+	 * @private
+	 */
+	as_status status;
+
+	/**
+	 * @private
+	 * Background thread has stopped fetching pages.
+	 */
+	bool done;
+
+	/**
+	 * @private
+	 */
+	bool closed;
+} as_query_pager;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Start paginated partition query and prefetch up to depth pages in a background thread.
+ *
+ * @param pager		The pager to initialize.
+ * @param as		Aerospike cluster instance.
+ * @param err		The as_error to be populated if an error occurs.
+ * @param policy	Query policy configuration parameters, pass in NULL for default.
+ * @param query		Paginated query definition with max_records set.
+ * @param pf		Partition filter.
+ * @param depth		Maximum number of pages fetched ahead of the application. Must be >= 1.
+ *
+ * @return AEROSPIKE_OK if successful. Otherwise an error.
+ *
+ * @relates as_query_pager
+ */
+AS_EXTERN as_status
+as_query_pager_init(
+	as_query_pager* pager, aerospike* as, as_error* err, const as_policy_query* policy,
+	as_query* query, as_partition_filter* pf, uint32_t depth
+	);
+
+/**
+ * Wait for the next page. Set page to NULL when all pages have been returned. The caller
+ * owns the returned page and must call as_query_page_destroy(). A query error is returned
+ * after all pages fetched before the error have been returned.
+ *
+ * @relates as_query_pager
+ */
+AS_EXTERN as_status
+as_query_pager_next(as_query_pager* pager, as_error* err, as_query_page** page);
+
+/**
+ * Stop background thread and release prefetched pages. If the query is not done, pages
+ * that were prefetched but not returned are lost and a subsequent paginated query with the
+ * same query instance resumes after them.
+ *
+ * @relates as_query_pager
+ */
+AS_EXTERN void
+as_query_pager_destroy(as_query_pager* pager);
+
+/**
+ * Destroy page records and release page.
+ *
+ * @relates as_query_page
+ */
+AS_EXTERN void
+as_query_page_destroy(as_query_page* page);
+
+/**
+ * @private
+ * Move contents of a query callback record to a new heap record.
+ */
+as_record*
+as_query_pager_move_record(as_record* src);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -37,7 +37,8 @@ struct as_event_loop;
 
 /**
  * @private
- * Verify migrations are not occurring and obtain cluster key.
+ * Verify migrations are not occurring and obtain cluster key. The cluster key from the
+ * node's last tend is used when it is recent.
  */
 as_status
 as_query_validate_begin(
@@ -58,20 +59,13 @@ as_query_validate(
 /**
  * @private
  * Verify migrations are not occurring and obtain cluster key in async mode.
+ * Then execute query commands.
  */
 as_status
 as_query_validate_begin_async(
 	struct as_event_executor* executor, const char* ns, as_error* err
 	);
 
-/**
- * @private
- * Verify migrations are not occurring and expected cluster key has not changed in async mode.
- * Then execute query.
- */
-as_status
-as_query_validate_next_async(struct as_event_executor* executor, uint32_t index);
-
 /**
  * @private
  * Verify migrations are not occurring and expected cluster key has not changed in async mode.
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_std.h>
+#include <aerospike/as_vector.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Class of commands counted by a client quota.
+ *
+ * @relates as_config
+ */
+typedef enum as_quota_type_e {
+	/**
+	 * Single record reads.
+	 */
+	AS_QUOTA_READ,
+
+	/**
+	 * Single record writes, deletes, operate and UDF commands.
+	 */
+	AS_QUOTA_WRITE,
+
+	/**
+	 * Scans and queries. Each scan or query call counts once.
+	 */
+	AS_QUOTA_SCAN
+} as_quota_type;
+
+/**
+ * Action taken when a command exceeds its client quota.
+ *
+ * @relates as_config
+ */
+typedef enum as_quota_mode_e {
+	/**
+	 * Fail the command with AEROSPIKE_CLIENT_QUOTA_EXCEEDED.
+	 */
+	AS_QUOTA_REJECT,
+
+	/**
+	 * Delay the command until the quota allows it. The command fails with
+	 * AEROSPIKE_CLIENT_QUOTA_EXCEEDED if the delay would exceed its total timeout.
+	 * Async scans and queries are rejected instead of delayed.
+	 */
+	AS_QUOTA_WAIT
+} as_quota_mode;
+
+/**
+ * @private
+ * Token bucket of a namespace, optional set and command class. The bucket is kept as the
+ * time the next command would be admitted on an empty bucket, so admitting a command is
+ * a single compare and swap. When the bucket holds at least batch tokens, a thread takes
+ * batch tokens in that compare and swap and admits its following commands from a thread
+ * local cache, so busy threads do not contend on next_ns for every command.
+ */
+typedef struct as_quota_s {
+	as_namespace ns;
+	as_set set;
+	as_quota_type type;
+	as_quota_mode mode;
+	uint32_t rate;
+	uint32_t burst;
+	uint32_t batch;
+	uint64_t interval_ns;
+	uint64_t next_ns;
+	uint64_t rejects;
+} as_quota;
+
+/**
+ * @private
+ * Client quotas of a cluster. Replaced as a whole when dynamic configuration changes.
+ */
+typedef struct as_quotas_s {
+	uint32_t id;
+	uint32_t size;
+	as_quota array[];
+} as_quotas;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create quotas from a list of as_config_quota. Return NULL if the list is NULL or empty.
+ */
+as_quotas*
+as_quotas_create(as_vector* list);
+
+/**
+ * @private
+ * Return if quotas were created from an equivalent list of as_config_quota.
+ */
+bool
+as_quotas_equal(as_quotas* quotas, as_vector* list);
+
+/**
+ * @private
+ * Admit a command of the given class to a namespace and set. A quota assigned to the set
+ * takes precedence over a quota assigned to the whole namespace. On success, delay_ms is
+ * the time the command must wait before it is sent. A command that would wait longer
+ * than max_wait_ms is rejected. Pass UINT32_MAX if the command has no deadline.
+ */
+as_status
+as_quotas_acquire(
+	as_quotas* quotas, as_error* err, const char* ns, const char* set, as_quota_type type,
+	uint32_t max_wait_ms, uint32_t* delay_ms
+	);
+
+/**
+ * @private
+ * Admit a command with as_quotas_acquire() and sleep until it may be sent.
+ */
+as_status
+as_quotas_wait(
+	as_quotas* quotas, as_error* err, const char* ns, const char* set, as_quota_type type,
+	uint32_t max_wait_ms
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
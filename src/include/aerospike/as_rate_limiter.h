@@ -0,0 +1,94 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Client-side records per second limiter. A limiter is assigned to
+ * as_policy_scan.rate_limiter or as_policy_query.rate_limiter and is shared by every node
+ * command and retry of the scan or query. Assign the same limiter to multiple scans and
+ * queries to limit their aggregate rate, for example one limiter per aerospike instance.
+ *
+ * Records are counted as they are received. When the rate is exceeded, the command thread
+ * sleeps before reading more records, which also slows the server through TCP flow control.
+ * Only synchronous scans and queries are limited.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_rate_limiter limiter;
+ * as_rate_limiter_init(&limiter, 5000);
+ *
+ * as_policy_scan policy;
+ * as_policy_scan_init(&policy);
+ * policy.rate_limiter = &limiter;
+ *
+ * aerospike_scan_partitions(&as, &err, &policy, &scan, &pf, callback, NULL);
+ * ~~~~~~~~~~
+ *
+ * @ingroup client_policies
+ */
+typedef struct as_rate_limiter_s {
+	/**
+	 * @private
+	 * Time in nanoseconds when all records acquired so far are within the rate.
+	 */
+	uint64_t next_ns;
+
+	/**
+	 * @private
+	 * Nanoseconds that next_ns may run ahead of the clock before acquirers sleep.
+	 */
+	uint64_t burst_ns;
+
+	/**
+	 * @private
+	 * Records per second.
+	 */
+	uint32_t rate;
+} as_rate_limiter;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize limiter to records_per_second. Bursts of up to 10 milliseconds of records are
+ * allowed so short sleeps are avoided. A rate of zero disables the limiter.
+ *
+ * @relates as_rate_limiter
+ */
+AS_EXTERN void
+as_rate_limiter_init(as_rate_limiter* rl, uint32_t records_per_second);
+
+/**
+ * @private
+ * Account for n_records received and sleep when the limiter rate is exceeded.
+ */
+void
+as_rate_limiter_acquire(as_rate_limiter* rl, uint32_t n_records);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
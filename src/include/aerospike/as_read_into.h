@@ -0,0 +1,217 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_bin.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Destination type of a read slot.
+ *
+ * @ingroup key_operations
+ */
+typedef enum as_read_slot_type_e {
+	/**
+	 * Integer bin into int64_t.
+	 */
+	AS_READ_SLOT_INT64,
+
+	/**
+	 * Double bin into double.
+	 */
+	AS_READ_SLOT_DOUBLE,
+
+	/**
+	 * Boolean bin into bool.
+	 */
+	AS_READ_SLOT_BOOL,
+
+	/**
+	 * String bin into a char buffer. The string is always null terminated.
+	 */
+	AS_READ_SLOT_STRING,
+
+	/**
+	 * Blob bin into a byte buffer.
+	 */
+	AS_READ_SLOT_BYTES
+} as_read_slot_type;
+
+/**
+ * Result of decoding a bin into its read slot.
+ *
+ * @ingroup key_operations
+ */
+typedef enum as_read_slot_status_e {
+	/**
+	 * Bin value was written to the slot.
+	 */
+	AS_READ_SLOT_OK,
+
+	/**
+	 * Record does not have this bin. The slot is not modified.
+	 */
+	AS_READ_SLOT_NOT_FOUND,
+
+	/**
+	 * String or blob is longer than the slot capacity. The slot holds the first capacity
+	 * bytes (capacity - 1 characters for strings) and size is the full value size.
+	 */
+	AS_READ_SLOT_TRUNCATED,
+
+	/**
+	 * Bin particle type does not match the slot type. The slot is not modified.
+	 */
+	AS_READ_SLOT_TYPE_MISMATCH
+} as_read_slot_status;
+
+/**
+ * Caller owned destination of one bin.
+ *
+ * @ingroup key_operations
+ */
+typedef struct as_read_slot_s {
+	/**
+	 * Bin name.
+	 */
+	as_bin_name name;
+
+	/**
+	 * Destination type.
+	 */
+	as_read_slot_type type;
+
+	/**
+	 * Destination. int64_t*, double* or bool* for fixed size types. Buffer of capacity
+	 * bytes for strings and blobs.
+	 */
+	void* data;
+
+	/**
+	 * Size of string or blob buffer. Ignored for fixed size types.
+	 */
+	uint32_t capacity;
+
+	/**
+	 * Output: size of the bin value on the wire.
+	 */
+	uint32_t size;
+
+	/**
+	 * Output: decode result.
+	 */
+	as_read_slot_status status;
+} as_read_slot;
+
+/**
+ * Fixed record layout read by aerospike_key_select_into(). Only the slot bins are requested
+ * and wire values are decoded straight into the slots, so the read does not allocate a
+ * record or bin values.
+ *
+ * @ingroup key_operations
+ */
+typedef struct as_read_into_s {
+	/**
+	 * Slots in any order.
+	 */
+	as_read_slot* slots;
+
+	/**
+	 * Number of slots.
+	 */
+	uint32_t n_slots;
+
+	/**
+	 * Output: record generation.
+	 */
+	uint16_t gen;
+
+	/**
+	 * Output: record time to live in seconds.
+	 */
+	uint32_t ttl;
+} as_read_into;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize slot that reads an integer bin.
+ *
+ * @relates as_read_slot
+ */
+AS_EXTERN void
+as_read_slot_init_int64(as_read_slot* slot, const char* name, int64_t* value);
+
+/**
+ * Initialize slot that reads a double bin.
+ *
+ * @relates as_read_slot
+ */
+AS_EXTERN void
+as_read_slot_init_double(as_read_slot* slot, const char* name, double* value);
+
+/**
+ * Initialize slot that reads a boolean bin.
+ *
+ * @relates as_read_slot
+ */
+AS_EXTERN void
+as_read_slot_init_bool(as_read_slot* slot, const char* name, bool* value);
+
+/**
+ * Initialize slot that reads a string bin into a buffer of capacity bytes.
+ *
+ * @relates as_read_slot
+ */
+AS_EXTERN void
+as_read_slot_init_str(as_read_slot* slot, const char* name, char* buf, uint32_t capacity);
+
+/**
+ * Initialize slot that reads a blob bin into a buffer of capacity bytes.
+ *
+ * @relates as_read_slot
+ */
+AS_EXTERN void
+as_read_slot_init_bytes(as_read_slot* slot, const char* name, uint8_t* buf, uint32_t capacity);
+
+/**
+ * @private
+ * Reset slot outputs before a read.
+ */
+void
+as_read_into_reset(as_read_into* into);
+
+/**
+ * @private
+ * Decode wire bins of a read response into the matching slots.
+ */
+void
+as_read_into_parse(as_read_into* into, uint8_t* p, uint32_t n_bins);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -16,6 +16,8 @@
  */
 #pragma once 
 
+#include <aerospike/as_allocator.h>
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_bin.h>
 #include <aerospike/as_bytes.h>
 #include <aerospike/as_integer.h>
@@ -36,6 +38,34 @@ extern "C" {
  * TYPES
  *****************************************************************************/
 
+/**
+ * @private
+ * Reference counted server response buffer. String and blob bin values of records
+ * parsed in zero-copy mode point directly into this buffer.
+ */
+typedef struct as_record_buffer_s {
+	/**
+	 * Reference count.
+	 */
+	uint32_t ref_count;
+
+	/**
+	 * Size of data.
+	 */
+	uint32_t size;
+
+	/**
+	 * Allocator that allocated this buffer. A copy is kept, so the buffer can be released
+	 * after the aerospike instance that read it is closed.
+	 */
+	as_allocator allocator;
+
+	/**
+	 * Response data.
+	 */
+	uint8_t data[];
+} as_record_buffer;
+
 /**
  * Records in Aerospike are collections of named bins. 
  *
@@ -132,6 +162,7 @@ extern "C" {
  *  `as_record_get_list()`      | Get the bin as an `as_list`. 
  *  `as_record_get_map()`       | Get the bin as an `as_map`.
  *  `as_record_get()`           | Get the bin as an `as_bin_value`.
+ *  `as_record_get_by_handle()` | Get the bin as an `as_bin_value` using an `as_bin_handle`.
  *
  * If you are unsure of the type of data stored in the bin, then you should 
  * use `as_record_get()`. You can then check the type of the value using
@@ -202,6 +233,20 @@ typedef struct as_record_s {
 	 */
 	as_bins bins;
 
+	/**
+	 * @private
+	 * Response buffer referenced by zero-copy bin values. Released in as_record_destroy().
+	 * NULL if bin values do not reference a response buffer.
+	 */
+	as_record_buffer* buffer;
+
+	/**
+	 * @private
+	 * List and map bins hold raw msgpack bytes that are deserialized on first access.
+	 * Set when the record is read with as_policy_read.lazy_deserialize.
+	 */
+	bool lazy;
+
 } as_record;
 
 /**
@@ -227,6 +272,37 @@ typedef struct as_record_s {
  */
 #define AS_RECORD_CLIENT_DEFAULT_TTL 0xFFFFFFFD
 
+/**
+ * Bin name with a cached bin position. Records returned by the server for the same
+ * command usually hold their bins in the same order, so a handle resolved on one record
+ * finds the bin on the next record without scanning all bin names. This makes reading
+ * many bins of wide records linear instead of quadratic.
+ *
+ * A handle is not thread safe. Use a separate handle per thread.
+ *
+ * @code
+ * as_bin_handle h;
+ * as_bin_handle_init(&h, "bin1");
+ *
+ * for (uint32_t i = 0; i < n; i++) {
+ *     as_bin_value* value = as_record_get_by_handle(records[i], &h);
+ * }
+ * @endcode
+ *
+ * @relates as_record
+ */
+typedef struct as_bin_handle_s {
+	/**
+	 * Bin name.
+	 */
+	as_bin_name name;
+
+	/**
+	 * Position of bin in the last record where it was found.
+	 */
+	uint16_t slot;
+} as_bin_handle;
+
 /******************************************************************************
  * MACROS
  *****************************************************************************/
@@ -306,6 +382,50 @@ as_record_new(uint16_t nbins);
 AS_EXTERN as_record*
 as_record_init(as_record* rec, uint16_t nbins);
 
+/**
+ * @private
+ * Allocate heap record, its bin array and data_size bytes of value storage in one block.
+ * as_record_destroy() frees the whole block with a single free. Bin values placed in the
+ * value storage must not own their memory. The value storage is returned in data when
+ * data_size is not zero. Return NULL on allocation failure.
+ */
+AS_EXTERN as_record*
+as_record_new_arena(uint16_t nbins, uint32_t data_size, uint8_t** data);
+
+/**
+ * @private
+ * Allocate reference counted response buffer with a reference count of one. If allocator
+ * is NULL, cf_malloc() is used.
+ */
+AS_EXTERN as_record_buffer*
+as_record_buffer_create(const as_allocator* allocator, uint32_t size);
+
+/**
+ * @private
+ * Increment response buffer reference count.
+ */
+static inline as_record_buffer*
+as_record_buffer_reserve(as_record_buffer* buffer)
+{
+	as_incr_uint32(&buffer->ref_count);
+	return buffer;
+}
+
+/**
+ * @private
+ * Decrement response buffer reference count and free buffer when count reaches zero.
+ */
+AS_EXTERN void
+as_record_buffer_release(as_record_buffer* buffer);
+
+/**
+ * @private
+ * Set response buffer that record bin values reference. The record takes ownership of
+ * one reference count. Any previous buffer is released.
+ */
+AS_EXTERN void
+as_record_set_buffer(as_record* rec, as_record_buffer* buffer);
+
 /**
  * Destroy the as_record and associated resources.
  *
@@ -721,6 +841,56 @@ as_record_set_nil(as_record* rec, const char* name);
 AS_EXTERN as_bin_value*
 as_record_get(const as_record* rec, const char* name);
 
+/**
+ * Initialize bin handle. Return false if the bin name is too long.
+ *
+ * @relates as_record
+ */
+static inline bool
+as_bin_handle_init(as_bin_handle* handle, const char* name)
+{
+	handle->slot = 0;
+	return ! as_strncpy(handle->name, name, sizeof(handle->name));
+}
+
+/**
+ * Get specified bin's value using a bin handle. The bin position cached in the handle
+ * is checked first. The bin names are only scanned when the record has a different
+ * bin order, and the handle is updated with the new position.
+ *
+ * @code
+ * as_bin_handle h;
+ * as_bin_handle_init(&h, "bin");
+ * as_val * value = as_record_get_by_handle(rec, &h);
+ * @endcode
+ *
+ * @param rec		The record containing the bin.
+ * @param handle	The initialized bin handle.
+ *
+ * @return the value if it exists, otherwise NULL.
+ *
+ * @relates as_record
+ */
+AS_EXTERN as_bin_value*
+as_record_get_by_handle(const as_record* rec, as_bin_handle* handle);
+
+/**
+ * @private
+ * Deserialize bin if it holds raw list or map bytes of a lazy record. Return bin value.
+ */
+AS_EXTERN as_bin_value*
+as_record_bin_deserialize(as_bin* bin);
+
+/**
+ * @private
+ * Return bin value, deserializing raw list or map bytes first when the record is lazy.
+ */
+static inline as_bin_value*
+as_record_bin_value(const as_record* rec, as_bin* bin)
+{
+	return rec->lazy ? as_record_bin_deserialize(bin) : bin->valuep;
+}
+
 /**
  * Get specified bin's value as a bool.
  *
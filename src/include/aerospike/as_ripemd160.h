@@ -0,0 +1,79 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * @private
+ * Maximum number of messages hashed concurrently by as_ripemd160_multi().
+ */
+#define AS_RIPEMD160_LANES 8
+
+/**
+ * @private
+ * RIPEMD-160 digest size in bytes.
+ */
+#define AS_RIPEMD160_SIZE 20
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * RIPEMD-160 message composed of up to three concatenated segments.
+ */
+typedef struct as_ripemd160_input_s {
+	const uint8_t* data[3];
+	uint32_t len[3];
+} as_ripemd160_input;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Return true if as_ripemd160_multi() is supported on this cpu (AVX2 on x86_64).
+ */
+AS_EXTERN bool
+as_ripemd160_multi_supported(void);
+
+/**
+ * @private
+ * Compute RIPEMD-160 digests of up to AS_RIPEMD160_LANES messages concurrently using one
+ * SIMD lane per message. Must only be called when as_ripemd160_multi_supported() is true.
+ *
+ * @param inputs	Messages.
+ * @param n			Number of messages (1 - AS_RIPEMD160_LANES).
+ * @param digests	AS_RIPEMD160_SIZE byte output buffer per message.
+ */
+AS_EXTERN void
+as_ripemd160_multi(const as_ripemd160_input* inputs, uint32_t n, uint8_t* const* digests);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_partition_filter.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Default partitions handed out by a single as_scan_ledger_claim() call.
+ */
+#define AS_SCAN_LEDGER_CHUNK_DEFAULT 16
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Ledger file layout. Each slot holds the state, owner and lease expiration of one
+ * partition and is only modified with atomic compare and swap.
+ */
+typedef struct as_scan_ledger_shm_s {
+	uint32_t magic;
+	uint16_t part_begin;
+	uint16_t part_count;
+	uint64_t slots[];
+} as_scan_ledger_shm;
+
+/**
+ * File-backed partition ledger shared by multiple processes that scan or query the same
+ * partitions. Instead of assigning a static partition range to each process, workers
+ * repeatedly claim small runs of unfinished partitions from the ledger, so the overall
+ * scan finishes when the last partition is done, not when the slowest worker is.
+ *
+ * Claims are leases. Partitions claimed by a worker that crashed or stalled are
+ * reclaimed (stolen) by other workers after lease_ms expires, so long running workers
+ * must call as_scan_ledger_renew() within that time. Lease times use the system
+ * monotonic clock, so all workers must run on the same host.
+ *
+ * Partitions are delivered at least once. A partition whose scan failed, or whose lease
+ * was stolen, may return some records twice.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_scan_ledger ledger;
+ * if (as_scan_ledger_open(&ledger, &err, "/dev/shm/export.ledger", 0, 4096, 60000) != AEROSPIKE_OK) {
+ *     return;
+ * }
+ *
+ * as_partition_filter pf;
+ *
+ * while (! as_scan_ledger_done(&ledger)) {
+ *     if (as_scan_ledger_claim(&ledger, AS_SCAN_LEDGER_CHUNK_DEFAULT, &pf) == 0) {
+ *         // Remaining partitions are claimed by other workers. Wait for them to finish
+ *         // or for their leases to expire.
+ *         as_sleep(1000);
+ *         continue;
+ *     }
+ *     as_status status = aerospike_scan_partitions(&as, &err, NULL, &scan, &pf, callback, NULL);
+ *     as_scan_ledger_complete(&ledger, &pf, status == AEROSPIKE_OK);
+ * }
+ * as_scan_ledger_close(&ledger);
+ * ~~~~~~~~~~
+ *
+ * @ingroup scan_operations
+ */
+typedef struct as_scan_ledger_s {
+	/**
+	 * @private
+	 * Shared ledger mapping.
+	 */
+	as_scan_ledger_shm* shm;
+
+	/**
+	 * @private
+	 * Mapping size in bytes.
+	 */
+	size_t size;
+
+	/**
+	 * @private
+	 * Milliseconds a claim remains valid without renewal.
+	 */
+	uint32_t lease_ms;
+
+	/**
+	 * @private
+	 * Slot where the next claim starts searching. Workers start at different slots, so
+	 * they rarely contend for the same partitions.
+	 */
+	uint32_t cursor;
+
+	/**
+	 * @private
+	 * Owner id stored in claimed slots.
+	 */
+	uint16_t owner;
+
+#if defined(_MSC_VER)
+	/**
+	 * @private
+	 * File mapping handle.
+	 */
+	void* mapping;
+#endif
+} as_scan_ledger;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Open ledger file for partitions part_begin to part_begin + part_count - 1. The file is
+ * created if it does not exist. All workers must use the same partition range. Delete the
+ * file to start a new scan. A ledger with a corrupt header is cleared. Slots with an invalid
+ * state, and claims that expire later than a new lease, are freed.
+ *
+ * @param ledger		Ledger to initialize.
+ * @param err			Error detail.
+ * @param path			Ledger file path. A tmpfs path like /dev/shm avoids disk writes.
+ * @param part_begin	First partition id.
+ * @param part_count	Number of partitions.
+ * @param lease_ms		Milliseconds before an unrenewed claim may be stolen by another worker.
+ */
+AS_EXTERN as_status
+as_scan_ledger_open(
+	as_scan_ledger* ledger, as_error* err, const char* path, uint32_t part_begin,
+	uint32_t part_count, uint32_t lease_ms
+	);
+
+/**
+ * Unmap ledger. The ledger file is not removed.
+ */
+AS_EXTERN void
+as_scan_ledger_close(as_scan_ledger* ledger);
+
+/**
+ * Claim a contiguous run of at most max unfinished partitions and set pf to that range.
+ * Free partitions and partitions with expired leases are claimed. Return the number of
+ * partitions claimed or zero if all unfinished partitions are claimed by other workers.
+ */
+AS_EXTERN uint32_t
+as_scan_ledger_claim(as_scan_ledger* ledger, uint32_t max, as_partition_filter* pf);
+
+/**
+ * Extend lease of partitions claimed in pf. Return false if any of those partitions was
+ * stolen by another worker after its lease expired.
+ */
+AS_EXTERN bool
+as_scan_ledger_renew(as_scan_ledger* ledger, const as_partition_filter* pf);
+
+/**
+ * Release partitions claimed in pf. If done is true, the partitions are marked finished.
+ * Otherwise, they are returned to the ledger and scanned again by the next claim.
+ * Partitions that were stolen are left to their new owner.
+ */
+AS_EXTERN void
+as_scan_ledger_complete(as_scan_ledger* ledger, const as_partition_filter* pf, bool done);
+
+/**
+ * Count partitions that are finished, claimed by a worker or not yet claimed.
+ */
+AS_EXTERN void
+as_scan_ledger_counts(
+	as_scan_ledger* ledger, uint32_t* done, uint32_t* claimed, uint32_t* available
+	);
+
+/**
+ * Return true if all partitions are finished.
+ */
+AS_EXTERN bool
+as_scan_ledger_done(as_scan_ledger* ledger);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
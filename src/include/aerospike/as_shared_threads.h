@@ -0,0 +1,161 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_vector.h>
+#include <aerospike/as_work_pool.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_cluster_s;
+
+/**
+ * Worker pool and tend thread shared by multiple aerospike instances.
+ *
+ * By default, each aerospike instance starts its own thread pool (as_config.thread_pool_size)
+ * and its own tend thread. Applications that connect to many clusters can create one
+ * as_shared_threads instance and assign it to as_config.shared_threads before calling
+ * aerospike_connect() for each cluster. Sync batch/scan/query node commands of all those
+ * clusters then run on one work stealing pool, and a single tend thread tends each cluster
+ * at that cluster's own tend interval.
+ *
+ * @code
+ * as_error err;
+ * as_shared_threads* st = as_shared_threads_create(&err, 32, -1);
+ *
+ * for (uint32_t i = 0; i < n_clusters; i++) {
+ *     as_config config;
+ *     as_config_init(&config);
+ *     as_config_add_hosts(&config, hosts[i], 3000);
+ *     config.shared_threads = st;
+ *     aerospike_init(&as[i], &config);
+ *     aerospike_connect(&as[i], &err);
+ * }
+ *
+ * // Close and destroy all aerospike instances before destroying the shared threads.
+ * as_shared_threads_destroy(st);
+ * @endcode
+ *
+ * Tend iterations of the clusters run one after another on the shared tend thread, so a
+ * cluster with slow nodes delays the tending of the other clusters. Clusters tended through
+ * shared memory (as_config.use_shm) still use the shared memory tender.
+ */
+typedef struct as_shared_threads_s {
+	/**
+	 * @private
+	 * Worker pool shared by all clusters.
+	 */
+	as_work_pool pool;
+
+	/**
+	 * @private
+	 * Clusters tended by the shared tend thread.
+	 */
+	as_vector /* <as_cluster*> */ clusters;
+
+	/**
+	 * @private
+	 * Cluster currently being tended.
+	 */
+	struct as_cluster_s* tending;
+
+	/**
+	 * @private
+	 * Lock for clusters and tending.
+	 */
+	pthread_mutex_t lock;
+
+	/**
+	 * @private
+	 * Signaled when a cluster is added, removed or needs to be tended early, and when a
+	 * cluster tend completes.
+	 */
+	pthread_cond_t cond;
+
+	/**
+	 * @private
+	 * Shared tend thread.
+	 */
+	pthread_t tend_thread;
+
+	/**
+	 * @private
+	 */
+	int tend_thread_cpu;
+
+	/**
+	 * @private
+	 */
+	bool valid;
+} as_shared_threads;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Start shared worker pool and shared tend thread. thread_pool_size may be zero if the
+ * clusters only run async commands. The tend thread is assigned to tend_thread_cpu when
+ * it is not negative. Return NULL and populate err on failure.
+ *
+ * @relates as_shared_threads
+ */
+AS_EXTERN as_shared_threads*
+as_shared_threads_create(as_error* err, uint32_t thread_pool_size, int tend_thread_cpu);
+
+/**
+ * Stop shared threads and release resources. All aerospike instances that reference the
+ * shared threads must be closed first.
+ *
+ * @relates as_shared_threads
+ */
+AS_EXTERN void
+as_shared_threads_destroy(as_shared_threads* st);
+
+/**
+ * @private
+ * Add cluster to the shared tender. The first tend occurs one tend interval later, since
+ * the cluster is tended once during cluster creation.
+ */
+void
+as_shared_threads_add(as_shared_threads* st, struct as_cluster_s* cluster);
+
+/**
+ * @private
+ * Remove cluster from the shared tender. Wait for an active tend of the cluster to finish.
+ */
+void
+as_shared_threads_remove(as_shared_threads* st, struct as_cluster_s* cluster);
+
+/**
+ * @private
+ * Tend cluster as soon as possible.
+ */
+void
+as_shared_threads_wake(as_shared_threads* st, struct as_cluster_s* cluster);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
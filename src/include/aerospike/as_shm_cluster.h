@@ -17,10 +17,12 @@
 #pragma once
 
 #include <aerospike/as_atomic.h>
+#include <aerospike/as_bitmap.h>
 #include <aerospike/as_config.h>
 #include <aerospike/as_node.h>
 #include <aerospike/as_partition.h>
 #include <citrusleaf/cf_queue.h>
+#include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,7 +68,7 @@ typedef struct as_node_shm_s {
 	uint32_t rebalance_generation;
 
 	/**
-	 * Rack ID.
+	 * Rack ID. Stored atomically, so readers may load it without the node lock.
 	 */
 	int rack_id;
 
@@ -99,7 +101,8 @@ typedef struct as_partition_shm_s {
 
 /**
  * @private
- * Shared memory representation of map of namespace to data partitions. 40 bytes + partitions size.
+ * Shared memory representation of map of namespace to data partitions. 64 bytes + partitions size.
+ * The header fills one cache line, so partitions start on a cache line boundary.
  */
 typedef struct as_partition_table_shm_s {
 	/**
@@ -118,9 +121,9 @@ typedef struct as_partition_table_shm_s {
 	uint8_t sc_mode;
 
 	/**
-	 * Pad to 8 byte boundary.
+	 * Pad to cache line boundary.
 	 */
-	char pad[6];
+	char pad[30];
 
 	/**
 	 * Array of partitions for a given namespace.
@@ -212,6 +215,59 @@ typedef struct as_cluster_shm_s {
 	 */
 	uint32_t rebalance_gen;
 
+	/**
+	 * Tender generation count.  Incremented whenever a process takes over cluster tending.
+	 */
+	uint32_t tender_gen;
+
+	/**
+	 * Number of process metrics slots. Zero if shared memory metrics are disabled.
+	 */
+	uint32_t metrics_capacity;
+
+	/**
+	 * Cluster offset to process metrics slots.
+	 */
+	uint32_t metrics_offset;
+
+	/**
+	 * Bytes required to hold one process metrics slot.
+	 */
+	uint32_t metrics_slot_size;
+
+	/**
+	 * Bytes required to hold the metrics of one node in a process metrics slot.
+	 */
+	uint32_t metrics_node_size;
+
+	/**
+	 * Maximum nodes in a process metrics slot.
+	 */
+	uint32_t metrics_nodes_capacity;
+
+	/**
+	 * Maximum namespaces per node in a process metrics slot.
+	 */
+	uint32_t metrics_ns_capacity;
+
+	/**
+	 * Has tender_mutex been initialized.
+	 */
+	uint8_t tender_mutex_ready;
+
+	/**
+	 * Pad to 8 byte boundary.
+	 */
+	char pad2[3];
+
+#if defined(__linux__)
+	/**
+	 * Robust process shared mutex held by the tender thread of the tend owner. Followers
+	 * detect a dead tend owner when a lock attempt returns EOWNERDEAD.
+	 */
+	pthread_mutex_t tender_mutex;
+#endif
+
 	/*
 	 * Dynamically allocated node array.
 	 */
@@ -220,6 +276,63 @@ typedef struct as_cluster_shm_s {
 	// This is where the dynamically allocated partition tables are located.
 } as_cluster_shm;
 
+/**
+ * @private
+ * Latency buckets per latency type in shared memory metrics. Buckets beyond this count are
+ * added to the last bucket.
+ */
+#define AS_SHM_METRICS_LATENCY_BUCKETS 16
+
+/**
+ * @private
+ * Shared memory representation of node namespace metrics published by one process.
+ */
+typedef struct as_ns_metrics_shm_s {
+	char ns[AS_MAX_NAMESPACE_SIZE];
+	uint64_t error_count;
+	uint64_t timeout_count;
+	uint64_t key_busy_count;
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+	uint64_t bytes_in_raw;
+	uint64_t bytes_out_raw;
+	uint8_t latency_size;
+	char pad[7];
+	uint64_t latency[AS_LATENCY_SLOTS][AS_SHM_METRICS_LATENCY_BUCKETS];
+} as_ns_metrics_shm;
+
+/**
+ * @private
+ * Shared memory representation of node metrics published by one process.
+ */
+typedef struct as_node_metrics_shm_s {
+	char name[AS_NODE_NAME_MAX_SIZE];
+	uint32_t sync_in_pool;
+	uint32_t sync_in_use;
+	uint32_t sync_opened;
+	uint32_t sync_closed;
+	uint32_t async_in_pool;
+	uint32_t async_in_use;
+	uint32_t async_opened;
+	uint32_t async_closed;
+	uint32_t ns_size;
+	as_ns_metrics_shm ns[];
+} as_node_metrics_shm;
+
+/**
+ * @private
+ * Shared memory metrics slot owned by one client process. Node metrics follow this header.
+ */
+typedef struct as_process_metrics_shm_s {
+	as_swlock lock;
+	uint32_t pid;
+	uint32_t nodes_size;
+	uint64_t timestamp;
+	uint64_t command_count;
+	uint64_t retry_count;
+	uint64_t delay_queue_timeout_count;
+} as_process_metrics_shm;
+
 /**
  * @private
  * Local data related to shared memory implementation.
@@ -255,6 +368,16 @@ typedef struct as_shm_info_s {
 	 * Is this process responsible for performing cluster tending.
 	 */
 	volatile bool is_tend_master;
+
+	/**
+	 * Does the tender thread hold the shared memory tender mutex.
+	 */
+	bool tender_mutex_held;
+
+	/**
+	 * Metrics slot owned by this process. NULL if shared memory metrics are disabled.
+	 */
+	as_process_metrics_shm* metrics;
 } as_shm_info;
 
 /******************************************************************************
@@ -309,7 +432,7 @@ as_shm_find_partition_table(as_cluster_shm* cluster_shm, const char* ns);
  */
 void
 as_shm_update_partitions(
-	as_shm_info* shm_info, const char* ns, char* bitmap_b64, int64_t len, as_node* node,
+	as_shm_info* shm_info, const char* ns, as_bitmap_iter* iter, as_node* node,
 	uint8_t replica_size, uint8_t replica_index, uint32_t regime
 	);
 
@@ -345,6 +468,35 @@ as_shm_next_partition_table(as_cluster_shm* cluster_shm, as_partition_table_shm*
 	return (as_partition_table_shm*) ((char*)table + cluster_shm->partition_table_byte_size);
 }
 
+/**
+ * @private
+ * Return true if metrics slot is owned by a running process.
+ */
+bool
+as_shm_metrics_active(as_process_metrics_shm* pm);
+
+/**
+ * @private
+ * Get process metrics slot identified by index.
+ */
+static inline as_process_metrics_shm*
+as_shm_get_metrics(as_cluster_shm* cluster_shm, uint32_t index)
+{
+	return (as_process_metrics_shm*) ((char*)cluster_shm + cluster_shm->metrics_offset +
+		((size_t)cluster_shm->metrics_slot_size * index));
+}
+
+/**
+ * @private
+ * Get node metrics identified by index in process metrics slot.
+ */
+static inline as_node_metrics_shm*
+as_shm_get_node_metrics(as_cluster_shm* cluster_shm, as_process_metrics_shm* pm, uint32_t index)
+{
+	return (as_node_metrics_shm*) ((char*)pm + sizeof(as_process_metrics_shm) +
+		((size_t)cluster_shm->metrics_node_size * index));
+}
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
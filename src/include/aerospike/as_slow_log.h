@@ -0,0 +1,178 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_key.h>
+#include <aerospike/as_latency.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_status.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Command that took at least as_config.slow_command_ms to complete.
+ */
+typedef struct as_slow_command_s {
+	/**
+	 * Completion time in milliseconds since epoch.
+	 */
+	uint64_t time_ms;
+
+	/**
+	 * Total elapsed time in microseconds, including retries.
+	 */
+	uint64_t elapsed_us;
+
+	/**
+	 * Time in microseconds spent acquiring connections, including pipeline waits.
+	 * Not measured for async commands.
+	 */
+	uint64_t conn_wait_us;
+
+	/**
+	 * Bytes sent and received by the last attempt.
+	 */
+	uint64_t bytes_out;
+	uint64_t bytes_in;
+
+	/**
+	 * Namespace. Empty if the command does not target a namespace.
+	 */
+	char ns[AS_MAX_NAMESPACE_SIZE];
+
+	/**
+	 * Set name. Only filled in when the command has a key.
+	 */
+	char set[AS_SET_MAX_SIZE];
+
+	/**
+	 * Key digest. Only valid when has_digest is true.
+	 */
+	uint8_t digest[AS_DIGEST_VALUE_SIZE];
+
+	/**
+	 * Name of the last node the command was sent to. Empty if no node was found.
+	 */
+	char node[AS_NODE_NAME_SIZE];
+
+	/**
+	 * Partition id. Only valid when has_digest is true.
+	 */
+	uint32_t partition_id;
+
+	/**
+	 * Number of retries.
+	 */
+	uint32_t retries;
+
+	/**
+	 * Command result.
+	 */
+	as_status status;
+
+	/**
+	 * Command latency type (AS_LATENCY_TYPE_NONE for commands without a latency type).
+	 */
+	as_latency_type latency_type;
+
+	/**
+	 * Is digest and partition_id valid.
+	 */
+	bool has_digest;
+
+	/**
+	 * Was the command run asynchronously.
+	 */
+	bool async;
+} as_slow_command;
+
+/**
+ * @private
+ */
+typedef struct as_slow_log_cell_s {
+	uint64_t seq;
+	as_slow_command cmd;
+} as_slow_log_cell;
+
+/**
+ * @private
+ * Fixed size ring of slow commands. Writers never block. Each cell is guarded by a sequence
+ * that is odd while the cell is written, so readers skip cells that are being overwritten
+ * instead of returning torn entries. When the ring is full, the oldest entries are lost.
+ */
+typedef struct as_slow_log_s {
+	uint64_t head;
+	uint64_t threshold_ns;
+	uint32_t mask;
+	uint8_t pad[44];
+	as_slow_log_cell cells[];
+} as_slow_log;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create slow command log. capacity is rounded up to a power of 2.
+ */
+as_slow_log*
+as_slow_log_create(uint32_t threshold_ms, uint32_t capacity);
+
+/**
+ * @private
+ * Release slow command log.
+ */
+void
+as_slow_log_destroy(as_slow_log* log);
+
+/**
+ * @private
+ * Add slow command to the log.
+ */
+void
+as_slow_log_add(as_slow_log* log, const as_slow_command* cmd);
+
+/**
+ * @private
+ * Copy entries added since cursor into out and advance cursor. An initial cursor of zero
+ * starts with the oldest available entry. Entries that were overwritten before they could
+ * be read are skipped. Return number of entries copied.
+ */
+uint32_t
+as_slow_log_read(as_slow_log* log, uint64_t* cursor, as_slow_command* out, uint32_t max);
+
+/**
+ * @private
+ * Return true if elapsed_ns is at or above the log threshold.
+ */
+static inline bool
+as_slow_log_check(as_slow_log* log, uint64_t elapsed_ns)
+{
+	return log && elapsed_ns >= log->threshold_ns;
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
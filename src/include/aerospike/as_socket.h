@@ -17,6 +17,7 @@
 #pragma once
 
 #include <aerospike/as_address.h>
+#include <aerospike/as_clock.h>
 #include <aerospike/as_error.h>
 #include <citrusleaf/cf_clock.h>
 #include <pthread.h>
@@ -66,10 +67,60 @@ typedef struct as_tls_context_s {
 	struct ssl_ctx_st* ssl_ctx;
 	struct evp_pkey_st* pkey;
 	void* cert_blacklist;
+	struct as_tls_session_s** sessions; // NULL if session cache is disabled.
+	uint64_t full_handshakes;
+	uint64_t resumed_handshakes;
 	bool log_session_info;
 	bool for_login_only;
 } as_tls_context;
 
+/**
+ * TCP socket options applied to every connection the client opens: sync, async and info.
+ * Pipeline connections then override buffer sizes and TCP_NODELAY with their own settings.
+ */
+typedef struct as_socket_options_s {
+	/**
+	 * SO_SNDBUF size in bytes. Larger buffers help high round trip time links, such as
+	 * cross-region connections, keep enough data in flight.
+	 *
+	 * Default: 0 (operating system default)
+	 */
+	uint32_t send_buffer_size;
+
+	/**
+	 * SO_RCVBUF size in bytes.
+	 *
+	 * Default: 0 (operating system default)
+	 */
+	uint32_t recv_buffer_size;
+
+	/**
+	 * TCP_USER_TIMEOUT in milliseconds. Maximum time transmitted data may remain
+	 * unacknowledged before the kernel closes the connection, so dead peers are detected
+	 * without waiting for the command timeout. Linux only.
+	 *
+	 * Default: 0 (operating system default)
+	 */
+	uint32_t tcp_user_timeout_ms;
+
+	/**
+	 * Enable TCP_NODELAY. Disabling it lets the kernel coalesce small writes at the cost of
+	 * latency.
+	 *
+	 * Default: true
+	 */
+	bool tcp_no_delay;
+
+	/**
+	 * Enable TCP_QUICKACK, so acknowledgements are sent immediately instead of delayed.
+	 * Useful on low latency networks. The kernel may leave quick ack mode later in the
+	 * connection lifetime. Linux only.
+	 *
+	 * Default: false
+	 */
+	bool tcp_quick_ack;
+} as_socket_options;
+
 struct as_conn_pool_s;
 struct as_node_s;
 
@@ -87,11 +138,27 @@ typedef struct as_socket_s {
 		struct as_conn_pool_s* pool; // Used when sync socket is active.
 		uint64_t last_used; // Last used nano timestamp. Used when socket in pool.
 	};
+	uint64_t validated; // Last nano timestamp the idle socket was validated by the tend thread.
 	as_tls_context* ctx;
 	const char* tls_name;
 	struct ssl_st* ssl;
 } as_socket;
 
+/**
+ * @private
+ * Maximum number of segments passed to as_socket_writev_deadline().
+ */
+#define AS_SOCKET_IOV_MAX 32
+
+/**
+ * @private
+ * Data segment written by as_socket_writev_deadline().
+ */
+typedef struct as_socket_iov_s {
+	uint8_t* data;
+	size_t size;
+} as_socket_iov;
+
 /**
  * @private
  * Return true if TLS context exists and not TLS login only.
@@ -129,12 +196,37 @@ as_socket_create_fd(int family, as_socket_fd* fdp);
 
 /**
  * @private
- * Create non-blocking socket.
+ * Initialize socket options to default values.
+ */
+static inline void
+as_socket_options_init(as_socket_options* options)
+{
+	options->send_buffer_size = 0;
+	options->recv_buffer_size = 0;
+	options->tcp_user_timeout_ms = 0;
+	options->tcp_no_delay = true;
+	options->tcp_quick_ack = false;
+}
+
+/**
+ * @private
+ * Apply socket options to fd. Options not supported on this platform are ignored.
+ * Return zero on success.
+ */
+int
+as_socket_set_options(as_socket_fd fd, const as_socket_options* options);
+
+/**
+ * @private
+ * Create non-blocking socket and apply options if not NULL.
  * Family should be AF_INET or AF_INET6.
  * Return zero on success.
  */
 int
-as_socket_create(as_socket* sock, int family, as_tls_context* ctx, const char* tls_name);
+as_socket_create(
+	as_socket* sock, int family, const as_socket_options* options, as_tls_context* ctx,
+	const char* tls_name
+	);
 
 /**
  * @private
@@ -166,7 +258,10 @@ as_socket_start_connect(as_socket* sock, struct sockaddr* addr, uint64_t deadlin
  * Create non-blocking socket and connect.
  */
 as_status
-as_socket_create_and_connect(as_socket* sock, as_error* err, struct sockaddr* addr, as_tls_context* ctx, const char* tls_name, uint64_t deadline_ms);
+as_socket_create_and_connect(
+	as_socket* sock, as_error* err, struct sockaddr* addr, const as_socket_options* options,
+	as_tls_context* ctx, const char* tls_name, uint64_t deadline_ms
+	);
 
 /**
  * @private
@@ -196,7 +291,19 @@ as_socket_error_append(as_error* err, struct sockaddr* addr);
 static inline bool
 as_socket_current_tran(uint64_t last_used, uint64_t max_socket_idle_ns)
 {
-	return max_socket_idle_ns == 0 || (cf_getns() - last_used) <= max_socket_idle_ns;
+	return max_socket_idle_ns == 0 || (as_clock_getns() - last_used) <= max_socket_idle_ns;
+}
+
+/**
+ * @private
+ * Was pooled socket used or validated within the given window. Such sockets are handed out
+ * without peeking at their receive buffer.
+ */
+static inline bool
+as_socket_recently_valid(as_socket* sock, uint64_t now, uint64_t window_ns)
+{
+	uint64_t last = (sock->validated > sock->last_used)? sock->validated : sock->last_used;
+	return now - last <= window_ns;
 }
 
 /**
@@ -206,7 +313,7 @@ as_socket_current_tran(uint64_t last_used, uint64_t max_socket_idle_ns)
 static inline bool
 as_socket_current_trim(uint64_t last_used, uint64_t max_socket_idle_ns)
 {
-	return (cf_getns() - last_used) <= max_socket_idle_ns;
+	return (as_clock_getns() - last_used) <= max_socket_idle_ns;
 }
 
 /**
@@ -228,7 +335,7 @@ as_socket_validate_fd(as_socket_fd fd);
 static inline uint64_t
 as_socket_deadline(uint32_t timeout_ms)
 {
-	return (timeout_ms && timeout_ms <= INT32_MAX)? cf_getms() + timeout_ms : 0;
+	return (timeout_ms && timeout_ms <= INT32_MAX)? as_clock_getms() + timeout_ms : 0;
 }
 
 /**
@@ -242,6 +349,18 @@ as_socket_write_deadline(
 	uint32_t socket_timeout, uint64_t deadline
 	);
 
+/**
+ * @private
+ * Write data segments in order with future deadline in milliseconds. Segments are sent with a
+ * single gather write when possible. The segment count must not exceed AS_SOCKET_IOV_MAX and
+ * segments must not be empty. If deadline is zero, do not set deadline.
+ */
+as_status
+as_socket_writev_deadline(
+	as_error* err, as_socket* sock, struct as_node_s* node, as_socket_iov* iov, uint32_t iov_count,
+	uint32_t socket_timeout, uint64_t deadline
+	);
+
 /**
  * @private
  * Read socket data with future deadline in milliseconds.
@@ -253,6 +372,36 @@ as_socket_read_deadline(
 	uint32_t socket_timeout, uint64_t deadline
 	);
 
+/**
+ * @private
+ * Read socket data with non-blocking reads for up to spin_us microseconds before waiting
+ * in poll(). TLS sockets do not spin.
+ */
+as_status
+as_socket_read_spin_deadline(
+	as_error* err, as_socket* sock, struct as_node_s* node, uint8_t *buf, size_t buf_len,
+	uint32_t socket_timeout, uint64_t deadline, uint32_t spin_us
+	);
+
+/**
+ * @private
+ * Read at least min_len and at most buf_len bytes. The number of bytes read is returned in
+ * read_len. Only use when no data other than the expected response can follow on the
+ * socket, because bytes read beyond min_len are consumed from the socket.
+ */
+as_status
+as_socket_read_ahead_deadline(
+	as_error* err, as_socket* sock, struct as_node_s* node, uint8_t *buf, size_t min_len,
+	size_t buf_len, uint32_t socket_timeout, uint64_t deadline, uint32_t spin_us, size_t* read_len
+	);
+
+/**
+ * @private
+ * Enable SO_BUSY_POLL on socket. Return zero on success or if not supported on this platform.
+ */
+int
+as_socket_set_busy_poll(as_socket_fd fd, uint32_t busy_poll_us);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -32,6 +32,17 @@ typedef enum as_status_e {
 	// Client Errors
 	//---------------------------------
 
+	/**
+	 * Command was not admitted because the client memory budget for in-flight request and
+	 * response buffers is exhausted.
+	 */
+	AEROSPIKE_ERR_MEMORY_BUDGET = -22,
+
+	/**
+	 * Command exceeded a client quota configured for its namespace or set.
+	 */
+	AEROSPIKE_CLIENT_QUOTA_EXCEEDED = -21,
+
 	/**
 	 * There is a conflict between metrics enable/disable and dynamic configuration metrics.
 	 */
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_record.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Return if the calling thread may wait on an async command. Event loop threads must not
+ * wait, because they are the threads that complete async commands.
+ */
+bool
+as_sync_async_can_wait(void);
+
+/**
+ * @private
+ * Return if sync single record commands should be sent through the async event loops.
+ */
+static inline bool
+as_sync_async_eligible(aerospike* as)
+{
+	return as->cluster->sync_over_async && as_sync_async_can_wait();
+}
+
+/**
+ * @private
+ * Run aerospike_key_get() on an event loop and wait for the result.
+ */
+as_status
+as_sync_async_get(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
+	);
+
+/**
+ * @private
+ * Run aerospike_key_select() on an event loop and wait for the result.
+ */
+as_status
+as_sync_async_select(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record** rec
+	);
+
+/**
+ * @private
+ * Run aerospike_key_exists() on an event loop and wait for the result.
+ */
+as_status
+as_sync_async_exists(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
+	);
+
+/**
+ * @private
+ * Run aerospike_key_put() on an event loop and wait for the result.
+ */
+as_status
+as_sync_async_put(
+	aerospike* as, as_error* err, const as_policy_write* policy, const as_key* key, as_record* rec
+	);
+
+/**
+ * @private
+ * Run aerospike_key_remove() on an event loop and wait for the result.
+ */
+as_status
+as_sync_async_remove(
+	aerospike* as, as_error* err, const as_policy_remove* policy, const as_key* key
+	);
+
+/**
+ * @private
+ * Run aerospike_key_operate() on an event loop and wait for the result.
+ */
+as_status
+as_sync_async_operate(
+	aerospike* as, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_operations* ops, as_record** rec
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
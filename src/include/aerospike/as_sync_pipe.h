@@ -0,0 +1,135 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_socket.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_node_s;
+
+/**
+ * @private
+ * Socket shared by multiple sync commands. The server responds to commands on a connection
+ * in the order they were sent, so each command is assigned a sequence number when it is
+ * written and reads its response when all previous responses have been read.
+ */
+typedef struct as_sync_conn_s {
+	as_socket socket;
+
+	/**
+	 * Sequence number of next command written. Protected by pipe write_lock.
+	 */
+	uint64_t write_seq;
+
+	/**
+	 * Sequence number of next response to read. Protected by pipe lock.
+	 */
+	uint64_t read_seq;
+
+	/**
+	 * References held by pipe and commands. Protected by pipe lock.
+	 */
+	uint32_t ref_count;
+
+	/**
+	 * False when the response stream is no longer in sync with written commands.
+	 * Protected by pipe lock.
+	 */
+	bool valid;
+} as_sync_conn;
+
+/**
+ * @private
+ * Pipelined sync connection slot.
+ */
+typedef struct as_sync_pipe_s {
+	pthread_mutex_t write_lock;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	as_sync_conn* conn;
+} as_sync_pipe;
+
+/**
+ * @private
+ * Position of a command on a pipelined connection.
+ */
+typedef struct as_sync_pipe_ticket_s {
+	as_sync_conn* conn;
+	uint64_t seq;
+} as_sync_pipe_ticket;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create pipelined sync connection slots.
+ */
+as_sync_pipe*
+as_sync_pipe_create(uint32_t size);
+
+/**
+ * @private
+ * Close connections and release pipelined sync connection slots.
+ */
+void
+as_sync_pipe_destroy(struct as_node_s* node, as_sync_pipe* pipes, uint32_t size);
+
+/**
+ * @private
+ * Write command segments to pipe's shared connection. A new connection is created when the pipe
+ * does not have a valid connection. On success, ticket holds a connection reference that
+ * must be released with as_sync_pipe_done().
+ */
+as_status
+as_sync_pipe_write(
+	as_sync_pipe* pipe, as_error* err, struct as_node_s* node, const char* ns, as_socket_iov* iov,
+	uint32_t iov_count, uint32_t socket_timeout, uint64_t deadline_ms, as_sync_pipe_ticket* ticket
+	);
+
+/**
+ * @private
+ * Wait until all responses before ticket have been read. On success, sock is set to the
+ * shared connection and the caller must read exactly one response from it.
+ */
+as_status
+as_sync_pipe_wait(
+	as_sync_pipe* pipe, as_error* err, as_sync_pipe_ticket* ticket, uint32_t socket_timeout,
+	uint64_t deadline_ms, as_socket* sock
+	);
+
+/**
+ * @private
+ * Finish command and release ticket's connection reference. If valid is false, the
+ * connection is closed and commands waiting on it fail with a connection error.
+ */
+void
+as_sync_pipe_done(as_sync_pipe* pipe, struct as_node_s* node, as_sync_pipe_ticket* ticket, bool valid);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
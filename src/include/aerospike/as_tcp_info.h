@@ -0,0 +1,69 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_socket.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Kernel TCP state of a connection.
+ */
+typedef struct as_tcp_info_s {
+	/**
+	 * Smoothed round trip time in microseconds.
+	 */
+	uint32_t rtt_us;
+
+	/**
+	 * Round trip time variance in microseconds. Zero if not reported by the platform.
+	 */
+	uint32_t rttvar_us;
+
+	/**
+	 * Congestion window in segments.
+	 */
+	uint32_t cwnd;
+
+	/**
+	 * Segments retransmitted since the connection was opened.
+	 */
+	uint32_t retrans;
+} as_tcp_info;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Read kernel TCP state of socket. Supported on Linux, macOS and Windows 10 1703 or later.
+ * Return false if the state is not available.
+ */
+bool
+as_tcp_info_read(as_socket_fd fd, as_tcp_info* info);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
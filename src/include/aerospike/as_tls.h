@@ -45,6 +45,10 @@ void as_tls_set_name(as_socket* sock, const char* tls_name);
 struct ssl_st;
 void as_tls_set_context_name(struct ssl_st* ssl, as_tls_context* ctx, const char* tls_name);
 
+void as_tls_session_resume(as_tls_context* ctx, struct ssl_st* ssl, const char* node_name, const char* tls_name);
+
+void as_tls_handshake_complete(as_tls_context* ctx, struct ssl_st* ssl);
+
 int as_tls_connect_once(as_socket* sock);
 
 int as_tls_connect(as_socket* sock, uint64_t deadline);
@@ -55,6 +59,8 @@ int as_tls_read_once(as_socket* sock, void* buf, size_t num);
 
 int as_tls_read(as_socket* sock, void* buf, size_t num, uint32_t socket_timeout, uint64_t deadline);
 
+int as_tls_read_ahead(as_socket* sock, void* buf, size_t min_len, size_t num, uint32_t socket_timeout, uint64_t deadline, size_t* read_len);
+
 int as_tls_write_once(as_socket* sock, void* buf, size_t num);
 
 int as_tls_write(as_socket* sock, void* buf, size_t num, uint32_t socket_timeout, uint64_t deadline);
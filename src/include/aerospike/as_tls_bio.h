@@ -0,0 +1,149 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_error.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_tls.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * @private
+ * Size of ciphertext socket reads and initial size of the staging buffer. Each half of the BIO
+ * pair holds twice this size, so a full socket read always fits behind ciphertext that has not
+ * been decrypted yet.
+ */
+#define AS_TLS_BIO_BUFFER_SIZE (32 * 1024)
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct ssl_st;
+struct bio_st;
+
+/**
+ * @private
+ * TLS session that is decoupled from the socket. OpenSSL reads and writes ciphertext through
+ * a memory BIO pair and the event loop moves ciphertext between the network BIO and the
+ * socket with its own non-blocking reads and writes.
+ */
+typedef struct as_tls_bio_s {
+	as_tls_context* ctx;
+	struct ssl_st* ssl;
+	struct bio_st* ibio;  // internal bio.
+	struct bio_st* nbio;  // network bio.
+	char* buf;            // ciphertext staging buffer.
+	int capacity;
+	int len;
+} as_tls_bio;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Create SSL session in client mode and attach it to a new memory BIO pair.
+ */
+as_status
+as_tls_bio_init(as_tls_bio* tb, as_error* err, as_tls_context* ctx, as_node* node);
+
+/**
+ * @private
+ * Release SSL session, BIO pair and staging buffer.
+ */
+void
+as_tls_bio_destroy(as_tls_bio* tb);
+
+/**
+ * @private
+ * Advance handshake. Return 1 when the handshake is complete. Otherwise, return SSL_do_handshake()
+ * result and set SSL error code.
+ */
+int
+as_tls_bio_handshake(as_tls_bio* tb, int* e);
+
+/**
+ * @private
+ * Send close notify alert. The alert must still be flushed from the network BIO.
+ */
+void
+as_tls_bio_shutdown(as_tls_bio* tb);
+
+/**
+ * @private
+ * Encrypt plaintext into the network BIO. Return bytes consumed or SSL_write() result and set
+ * SSL error code on failure.
+ */
+int
+as_tls_bio_encrypt(as_tls_bio* tb, const void* buf, int len, int* e);
+
+/**
+ * @private
+ * Decrypt plaintext from ciphertext already fed into the network BIO. Return bytes decrypted or
+ * SSL_read() result and set SSL error code on failure.
+ */
+int
+as_tls_bio_decrypt(as_tls_bio* tb, void* buf, int len, int* e);
+
+/**
+ * @private
+ * Feed ciphertext read from the socket into the network BIO.
+ */
+as_status
+as_tls_bio_feed(as_tls_bio* tb, as_error* err, const char* buf, int len);
+
+/**
+ * @private
+ * Return number of ciphertext bytes waiting to be sent to the socket.
+ */
+int
+as_tls_bio_pending(as_tls_bio* tb);
+
+/**
+ * @private
+ * Move up to len ciphertext bytes from the network BIO into buf.
+ */
+int
+as_tls_bio_drain(as_tls_bio* tb, char* buf, int len);
+
+/**
+ * @private
+ * Copy unsent ciphertext into the staging buffer and append the remaining bytes still held in
+ * the network BIO. Return false if the network BIO returned fewer bytes than expected.
+ */
+bool
+as_tls_bio_stage(as_tls_bio* tb, const char* unsent, int unsent_len, int remaining);
+
+/**
+ * @private
+ * Set error from SSL error code and OpenSSL error queue.
+ */
+as_status
+as_tls_bio_error(as_error* err, int rv, int e);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_status.h>
+#include <aerospike/as_std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * Partition id of trace events for commands that are not sent to a single partition
+ * (batch, scan, query, info).
+ */
+#define AS_TRACE_NO_PARTITION UINT32_MAX
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_cluster_s;
+struct as_node_s;
+
+/**
+ * Command lifecycle point reported to as_trace_callback.
+ *
+ * @relates as_config
+ */
+typedef enum as_trace_point_e {
+	/**
+	 * Command submitted with aerospike API call. Async commands are then queued to their
+	 * event loop and may wait in the delay queue.
+	 */
+	AS_TRACE_START = 0,
+
+	/**
+	 * Connection to node acquired from pool or newly connected and authenticated. For sync
+	 * pipelined commands, the shared connection became available for reading the response.
+	 */
+	AS_TRACE_CONNECTION = 1,
+
+	/**
+	 * Command write started on the connection.
+	 */
+	AS_TRACE_WRITE = 2,
+
+	/**
+	 * First response header received.
+	 */
+	AS_TRACE_FIRST_BYTE = 3,
+
+	/**
+	 * Response read finished. status contains the server result code or the error that
+	 * prevented the response from being read.
+	 */
+	AS_TRACE_PARSED = 4,
+
+	/**
+	 * Attempt failed and command will be retried. iteration is the number of the next attempt.
+	 * On sync commands, status contains the error that caused the retry.
+	 */
+	AS_TRACE_RETRY = 5,
+
+	/**
+	 * Command completed. status contains the final result code.
+	 */
+	AS_TRACE_COMPLETE = 6
+} as_trace_point;
+
+/**
+ * Command lifecycle trace event. Events of one command share the same id and are reported
+ * in lifecycle order. Strings are only valid during the callback.
+ *
+ * @relates as_config
+ */
+typedef struct as_trace_event_s {
+	/**
+	 * Trace id. Unique per traced command within a cluster.
+	 */
+	uint64_t id;
+
+	/**
+	 * Monotonic clock time of the event in nanoseconds (cf_getns()).
+	 */
+	uint64_t time_ns;
+
+	/**
+	 * User data passed to as_config_set_trace_callback().
+	 */
+	void* udata;
+
+	/**
+	 * Target node name. NULL when the node has not been assigned yet.
+	 */
+	const char* node_name;
+
+	/**
+	 * Namespace. NULL for commands that can span namespaces.
+	 */
+	const char* ns;
+
+	/**
+	 * Partition id or AS_TRACE_NO_PARTITION.
+	 */
+	uint32_t partition_id;
+
+	/**
+	 * Attempt number starting at zero.
+	 */
+	uint32_t iteration;
+
+	/**
+	 * Result code. See as_trace_point for the points that set a status.
+	 */
+	as_status status;
+
+	/**
+	 * Lifecycle point.
+	 */
+	as_trace_point point;
+
+	/**
+	 * Command runs on an event loop.
+	 */
+	bool async;
+} as_trace_event;
+
+/**
+ * Command lifecycle trace callback. Called from the command thread for sync commands and
+ * from the event loop thread for async commands, so the callback must be thread-safe and
+ * should only record the event, for example as an OpenTelemetry span event.
+ * as_trace_event is placed on the stack before calling.
+ *
+ * @relates as_config
+ */
+typedef void (*as_trace_callback) (const as_trace_event* event);
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Report trace event to the cluster trace callback. Only called for sampled commands.
+ */
+void
+as_trace_emit(
+	struct as_cluster_s* cluster, uint64_t id, as_trace_point point, struct as_node_s* node,
+	const char* ns, uint32_t partition_id, uint32_t iteration, as_status status, bool async
+	);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -31,12 +31,12 @@ extern "C" {
 //---------------------------------
 
 /**
- * Default number of transaction read hash buckets.
+ * Default number of transaction read hash slots.
  */
 #define AS_TXN_READ_CAPACITY_DEFAULT 128
 
 /**
- * Default number of transaction write hash buckets.
+ * Default number of transaction write hash slots.
  */
 #define AS_TXN_WRITE_CAPACITY_DEFAULT 128
 
@@ -55,33 +55,33 @@ typedef enum {
 } as_txn_state;
 
 /**
- * Transaction key.
+ * Transaction key. The set name is interned by the hash map that holds the key.
+ * An empty slot has a NULL set.
  */
 typedef struct as_txn_key {
 	as_digest_value digest;
-	char set[64];
 	uint64_t version;
-	struct as_txn_key* next;
+	const char* set;
 } as_txn_key;
 
 /**
- * Transaction hash map row.
- */
-typedef struct {
-	bool used;
-	as_txn_key head;
-} as_txn_hash_row;
-
-/**
- * Transaction hash map.
+ * Transaction hash map. Keys are stored inline in an open addressing table indexed by
+ * digest with linear probing. The table doubles when it becomes three quarters full.
  */
 typedef struct {
 	pthread_mutex_t lock;
 	uint32_t n_eles;
-	uint32_t n_rows;
-	as_txn_hash_row* table;
+	uint32_t n_slots;
+	as_txn_key* table;
+	char** sets;
+	uint32_t n_sets;
+	uint32_t sets_capacity;
 } as_txn_hash;
 
+struct as_txn_monitor_req_s;
+struct as_txn_monitor_async_req_s;
+struct as_event_loop;
+
 /**
  * Transaction. Each command in the transaction must use the same namespace.
  */
@@ -90,11 +90,25 @@ typedef struct as_txn {
 	as_namespace ns;
 	as_txn_hash reads;
 	as_txn_hash writes;
+
+	/**
+	 * @private
+	 * Concurrent writes coalesce their monitor record key additions. Keys that arrive while
+	 * a monitor record update is in flight are queued and sent together in the next update.
+	 */
+	pthread_mutex_t monitor_lock;
+	pthread_cond_t monitor_cond;
+	struct as_txn_monitor_req_s* monitor_pending;
+	struct as_txn_monitor_async_req_s* monitor_async_pending;
+	struct as_event_loop* monitor_async_loop;
+	bool monitor_busy;
+
 	uint32_t timeout;
 	uint32_t deadline;
 	as_txn_state state;
 	bool write_in_doubt;
 	bool in_doubt;
+	bool read_only;
 	bool free;
 } as_txn;
 
@@ -103,8 +117,6 @@ typedef struct as_txn {
  */
 typedef struct {
 	as_txn_hash* khash;
-	as_txn_hash_row* row;
-	as_txn_key* ele;
 	uint32_t idx;
 } as_txn_iter;
 
@@ -187,6 +199,18 @@ as_txn_set_timeout(as_txn* txn, uint32_t timeout)
 	txn->timeout = timeout;
 }
 
+/**
+ * Mark transaction as read-only. Writes in a read-only transaction fail with
+ * AEROSPIKE_ERR_PARAM, so a transaction monitor record is never created. aerospike_commit()
+ * then verifies read versions in one concurrent batch and releases the transaction without a
+ * roll phase. Set before the first command in the transaction.
+ */
+static inline void
+as_txn_set_read_only(as_txn* txn, bool read_only)
+{
+	txn->read_only = read_only;
+}
+
 /**
  * Return read hash size.
  */
@@ -280,8 +304,6 @@ static inline void
 as_txn_iter_reads(as_txn_iter* iter, as_txn* txn)
 {
 	iter->khash = &txn->reads;
-	iter->row = txn->reads.table;
-	iter->ele = NULL;
 	iter->idx = 0;
 }
 
@@ -292,8 +314,6 @@ static inline void
 as_txn_iter_writes(as_txn_iter* iter, as_txn* txn)
 {
 	iter->khash = &txn->writes;
-	iter->row = txn->writes.table;
-	iter->ele = NULL;
 	iter->idx = 0;
 }
 
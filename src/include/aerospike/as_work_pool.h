@@ -0,0 +1,170 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_queue.h>
+#include <aerospike/as_std.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+/**
+ * @private
+ * Number of task priority classes.
+ */
+#define AS_WORK_PRIORITY_SIZE 2
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * @private
+ * Task priority class. Workers always run queued high priority tasks before low priority
+ * tasks, so short batch tasks are not starved by long running scans and queries.
+ */
+typedef enum as_work_priority_e {
+	/**
+	 * Short latency sensitive tasks (sync batch node commands).
+	 */
+	AS_WORK_PRIORITY_HIGH,
+
+	/**
+	 * Long running tasks (sync scan and query node commands).
+	 */
+	AS_WORK_PRIORITY_LOW
+} as_work_priority;
+
+/**
+ * @private
+ * Task function.
+ */
+typedef void (*as_work_fn)(void* udata);
+
+/**
+ * @private
+ * Function called by each worker thread before it exits.
+ */
+typedef void (*as_work_fini_fn)(void);
+
+/**
+ * @private
+ * Queued task.
+ */
+typedef struct as_work_task_s {
+	as_work_fn fn;
+	void* udata;
+} as_work_task;
+
+/**
+ * @private
+ * Per worker task queues. Each queue has its own lock, so concurrent submitters and
+ * workers do not serialize on a single lock.
+ */
+typedef struct as_work_queue_s {
+	pthread_mutex_t lock;
+	as_queue tasks[AS_WORK_PRIORITY_SIZE];
+} as_work_queue;
+
+/**
+ * @private
+ * Worker thread.
+ */
+typedef struct as_work_worker_s {
+	struct as_work_pool_s* pool;
+	pthread_t thread;
+	uint32_t index;
+} as_work_worker;
+
+/**
+ * @private
+ * Work stealing thread pool. Tasks are distributed round-robin across per worker queues.
+ * A worker runs tasks from its own queue and steals from other worker queues when its own
+ * queue is empty.
+ */
+typedef struct as_work_pool_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	as_work_queue* queues;
+	as_work_worker* workers;
+	as_work_fini_fn fini_fn;
+	uint64_t steal_count;
+	uint32_t thread_size;
+	uint32_t next;
+	uint32_t queued;
+	uint32_t idle;
+	bool shutdown;
+} as_work_pool;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * @private
+ * Initialize pool and start worker threads. fini_fn is optional.
+ * Return zero on success.
+ */
+int
+as_work_pool_init(as_work_pool* pool, uint32_t thread_size, as_work_fini_fn fini_fn);
+
+/**
+ * @private
+ * Queue task for execution. Return zero on success, -1 if the pool has no threads and
+ * -2 if the pool is shutting down.
+ */
+int
+as_work_pool_queue_task(as_work_pool* pool, as_work_priority priority, as_work_fn fn, void* udata);
+
+/**
+ * @private
+ * Run remaining queued tasks, stop worker threads and release resources.
+ * Return zero on success.
+ */
+int
+as_work_pool_destroy(as_work_pool* pool);
+
+/**
+ * @private
+ * Return count of tasks awaiting execution.
+ */
+static inline uint32_t
+as_work_pool_queued_tasks(as_work_pool* pool)
+{
+	return as_load_uint32(&pool->queued);
+}
+
+/**
+ * @private
+ * Return count of tasks that were run by a worker other than the one they were queued to.
+ */
+static inline uint64_t
+as_work_pool_steal_count(as_work_pool* pool)
+{
+	return as_load_uint64(&pool->steal_count);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_record.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+/**
+ * Called when a buffered write fails with an error that is not retried. The key is only
+ * valid for the duration of the call.
+ *
+ * @ingroup async_events
+ */
+typedef void (*as_write_behind_listener)(as_error* err, const as_key* key, void* udata);
+
+/**
+ * Write-behind buffer configuration.
+ *
+ * @ingroup async_events
+ */
+typedef struct as_write_behind_config_s {
+	/**
+	 * Policy used for every buffered put. The policy timeouts apply to each attempt.
+	 */
+	as_policy_write policy;
+
+	/**
+	 * Spill log file path. Writes that do not fit in memory are appended to this file and
+	 * replayed once memory frees up. The file is created if it does not exist, and entries
+	 * left in an existing file are replayed when the buffer is created. An existing log with
+	 * corrupt offsets or records is cleared. NULL keeps writes in memory only. Not supported
+	 * on Windows.
+	 *
+	 * Default: NULL
+	 */
+	const char* spill_path;
+
+	/**
+	 * Size of a new spill log file in bytes. An existing file keeps its size.
+	 *
+	 * Default: 64 MiB
+	 */
+	uint64_t spill_size;
+
+	/**
+	 * Maximum writes held in memory, including writes in flight.
+	 *
+	 * Default: 10000
+	 */
+	uint32_t max_pending;
+
+	/**
+	 * Number of ordered lanes. Writes to the same key always use the same lane, and each
+	 * lane has at most one write in flight, so writes to a key are applied in the order
+	 * they were buffered.
+	 *
+	 * Default: 64
+	 */
+	uint32_t lanes;
+
+	/**
+	 * Maximum writes per second sent from retries, and from the spill log while writes are
+	 * failing with temporary errors. While the cluster accepts writes, the spill log is
+	 * replayed as fast as memory frees up, so producers that briefly outran the cluster do not
+	 * keep spilling. Zero is unlimited.
+	 *
+	 * Default: 5000
+	 */
+	uint32_t replay_rate;
+
+	/**
+	 * Milliseconds a lane waits before retrying a write that failed with a temporary error
+	 * such as a timeout, a connection error or a full async delay queue.
+	 *
+	 * Default: 100
+	 */
+	uint32_t retry_delay_ms;
+
+	/**
+	 * Optional listener called for writes that failed with an error that is not retried.
+	 */
+	as_write_behind_listener listener;
+
+	/**
+	 * User data passed to listener.
+	 */
+	void* udata;
+} as_write_behind_config;
+
+/**
+ * Write-behind buffer statistics.
+ *
+ * @ingroup async_events
+ */
+typedef struct as_write_behind_stats_s {
+	/**
+	 * Writes held in memory, including writes in flight.
+	 */
+	uint32_t pending;
+
+	/**
+	 * Spill log bytes waiting to be replayed.
+	 */
+	uint64_t spilled_bytes;
+
+	/**
+	 * Writes accepted by the server.
+	 */
+	uint64_t written;
+
+	/**
+	 * Attempts that failed with a temporary error and were retried.
+	 */
+	uint64_t retried;
+
+	/**
+	 * Writes that failed with an error that is not retried.
+	 */
+	uint64_t failed;
+
+	/**
+	 * Writes rejected because memory and the spill log were full.
+	 */
+	uint64_t rejected;
+} as_write_behind_stats;
+
+/**
+ * Write-behind buffer in front of async puts. Puts are copied into the buffer and return
+ * immediately. The buffer sends them with aerospike_key_put_async() and retries temporary
+ * failures, so producers keep their throughput while the cluster is briefly unavailable.
+ * When memory is full, writes spill to a circular memory mapped log that is replayed once
+ * memory frees up. Space of replayed writes is reused by later spills.
+ *
+ * Writes held in memory are lost if the process exits without as_write_behind_destroy().
+ * Spilled writes survive a process restart, but not an operating system crash unless the
+ * log resides on storage that is synced externally.
+ *
+ * ~~~~~~~~~~{.c}
+ * as_write_behind_config config;
+ * as_write_behind_config_init(&config);
+ * config.spill_path = "/var/lib/app/writes.log";
+ *
+ * as_write_behind* wb = as_write_behind_create(&as, &err, &config);
+ *
+ * if (wb) {
+ *     as_write_behind_put(wb, &err, &key, &rec);
+ *     ...
+ *     as_write_behind_destroy(wb);
+ * }
+ * ~~~~~~~~~~
+ *
+ * @ingroup async_events
+ */
+typedef struct as_write_behind_s as_write_behind;
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+/**
+ * Initialize write-behind configuration to default values.
+ *
+ * @relates as_write_behind
+ */
+AS_EXTERN void
+as_write_behind_config_init(as_write_behind_config* config);
+
+/**
+ * Create write-behind buffer for an aerospike instance with async event loops. Spilled
+ * writes left in an existing log are replayed. Return NULL and set err on failure.
+ *
+ * @relates as_write_behind
+ */
+AS_EXTERN as_write_behind*
+as_write_behind_create(aerospike* as, as_error* err, const as_write_behind_config* config);
+
+/**
+ * Buffer a put of the record's bins. The key and record are copied, so they may be
+ * destroyed when this function returns. Return AEROSPIKE_ERR_ASYNC_QUEUE_FULL when memory
+ * and the spill log are full.
+ *
+ * @relates as_write_behind
+ */
+AS_EXTERN as_status
+as_write_behind_put(as_write_behind* wb, as_error* err, const as_key* key, as_record* rec);
+
+/**
+ * Get write-behind buffer statistics.
+ *
+ * @relates as_write_behind
+ */
+AS_EXTERN void
+as_write_behind_get_stats(as_write_behind* wb, as_write_behind_stats* stats);
+
+/**
+ * Stop sending buffered writes, wait for writes in flight and release the buffer. Writes
+ * still held in memory are saved to the spill log when there is room, so they are replayed
+ * by the next buffer that opens the log. Other unsent writes are reported to the listener
+ * with AEROSPIKE_ERR_CLIENT_ABORT. Must not be called from an event loop thread.
+ *
+ * @relates as_write_behind
+ */
+AS_EXTERN void
+as_write_behind_destroy(as_write_behind* wb);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
@@ -20,6 +20,7 @@
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_lua_cache.h>
 #include <aerospike/as_module.h>
 #include <aerospike/as_string_builder.h>
 #include <aerospike/as_tls.h>
@@ -55,6 +56,7 @@ aerospike_defaults(aerospike* as, bool free, as_config* config)
 	as->cluster = NULL;
 	as->config_orig = NULL;
 	as->config_bitmap = NULL;
+	as->config_snapshot = NULL;
 
 	if (config) {
 		memcpy(&as->config, config, sizeof(as_config));
@@ -174,6 +176,7 @@ aerospike_init_lua(as_config_lua* config)
     as_strncpy(lua.user_path, config->user_path, sizeof(lua.user_path));
     
     as_module_configure(&mod_lua, &lua);
+	as_lua_cache_configure(config);
 	lua_initialized = true;
 }
 
@@ -195,6 +198,15 @@ void aerospike_destroy(aerospike* as)
 		cf_free(as->config_bitmap);
 	}
 
+	as_config_snapshot* snapshot = as->config_snapshot;
+
+	while (snapshot) {
+		// Snapshots are shallow copies of as->config.
+		as_config_snapshot* prev = snapshot->prev;
+		cf_free(snapshot);
+		snapshot = prev;
+	}
+
 	if (as->_free) {
 		cf_free(as);
 	}
@@ -18,6 +18,7 @@
 #include <aerospike/aerospike_batch.h>
 #include <aerospike/aerospike_key.h>
 #include <aerospike/as_async.h>
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_config_file.h>
 #include <aerospike/as_error.h>
@@ -31,10 +32,10 @@
 #include <aerospike/as_record.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_status.h>
-#include <aerospike/as_thread_pool.h>
 #include <aerospike/as_txn.h>
 #include <aerospike/as_txn_monitor.h>
 #include <aerospike/as_val.h>
+#include <aerospike/as_work_pool.h>
 #include <citrusleaf/cf_clock.h>
 #include <citrusleaf/cf_digest.h>
 
@@ -52,6 +53,20 @@
 #define BATCH_TYPE_RECORDS 0
 #define BATCH_TYPE_KEYS 1
 
+// Number of keys passed to as_key_set_digests() at a time.
+#define BATCH_DIGEST_CHUNK 64
+
+// Key to node index assigned to keys that could not be mapped to a node.
+#define BATCH_NODE_NONE UINT32_MAX
+
+// Maximum keys where key/node indexes and offsets are allocated on the stack.
+#define BATCH_STACK_KEYS 5000
+
+// Async batch row progress state.
+#define BATCH_ROW_PENDING 0
+#define BATCH_ROW_PARSED 1
+#define BATCH_ROW_DELIVERED 2
+
 //---------------------------------
 // Types
 //---------------------------------
@@ -64,11 +79,19 @@ typedef struct {
 	as_queue* buffers;
 	as_txn* txn;
 	uint64_t* versions;
+	// UDF arglist and operations of the first apply/operate row are serialized once and
+	// copied into every row that references the same instance.
+	const as_list* arglist;
+	as_buffer arglist_buffer;
+	const as_operations* ops;
+	uint8_t* ops_data;
+	uint32_t ops_size;
 	uint32_t versions_capacity;
 	uint16_t field_count_header;
 	uint8_t read_attr; // old batch only
 	// This field is only valid for txn attributes that are fixed for all keys.
 	uint8_t txn_attr;
+	bool arglist_cached;
 	bool batch_any;
 } as_batch_builder;
 
@@ -89,13 +112,60 @@ typedef struct {
 	as_policy_replica replica_sc;
 	uint8_t replica_index;
 	uint8_t replica_index_sc;
+	bool rack_balance;
 } as_batch_replica;
 
 typedef struct as_batch_node_s {
 	as_node* node;
 	as_vector offsets;
+	uint32_t count;  // Keys assigned to node while grouping keys.
 } as_batch_node;
 
+typedef struct as_batch_node_slot_s {
+	as_node* node;
+	uint32_t index;
+} as_batch_node_slot;
+
+// Open addressing hash of node to batch node index. Replaces a linear scan of batch nodes
+// for every key.
+typedef struct as_batch_node_map_s {
+	as_batch_node_slot* slots;
+	uint32_t capacity;  // Power of 2.
+	uint32_t size;
+	bool heap;
+} as_batch_node_map;
+
+typedef struct as_batch_dedup_slot_s {
+	const char* ns;
+	const uint8_t* digest;
+	uint32_t offset;
+} as_batch_dedup_slot;
+
+// Open addressing set of read keys already assigned to a node. Namespace and digest pointers
+// reference caller memory that outlives the batch.
+typedef struct as_batch_dedup_s {
+	as_batch_dedup_slot* slots;
+	uint32_t* dups;  // First offset of each duplicate key or BATCH_NODE_NONE.
+	uint32_t mask;
+	uint32_t count;  // Duplicate keys found.
+} as_batch_dedup;
+
+// Batch keys are either as_key entries, digests that share one namespace and set or
+// compact keys.
+typedef struct as_batch_key_src_s {
+	as_key* keys;
+	const as_batch_digests* digests;
+	const as_batch_compact* compact;
+} as_batch_key_src;
+
+// Digest and compact keys are materialized one at a time into a scratch key. Compact keys
+// switch to the other scratch key when namespace or set changes, so the previous key that
+// a full message was written for still holds its namespace and set for repeat detection.
+typedef struct as_batch_key_scratch_s {
+	as_key keys[2];
+	uint32_t current;
+} as_batch_key_scratch;
+
 typedef struct as_batch_task_s {
 	as_node* node;
 	as_vector offsets;
@@ -120,16 +190,20 @@ typedef struct as_batch_task_s {
 typedef struct as_batch_task_records_s {
 	as_batch_task base;
 	as_policies* defs;
+	uint8_t* config_bitmap;
 	as_vector* records;
 } as_batch_task_records;
 
 typedef struct as_batch_task_keys_s {
 	as_batch_task base;
 	const char* ns;
-	as_key* keys;
-	const as_batch* batch;
+	as_batch_key_src src;
 	as_batch_result* results;
+	as_batch_exists_results* flat;
 	as_batch_listener listener;
+	as_batch_stream_listener stream;
+	uint8_t* delivered;
+	uint32_t* stream_abort;
 	void* udata;
 	as_batch_base_record* rec;
 	as_batch_attr* attr;
@@ -146,6 +220,14 @@ typedef struct {
 	as_txn* txn;
 	uint64_t* versions;
 	as_async_batch_listener listener;
+	as_async_batch_progress_listener progress;
+	uint8_t* progress_state;   // BATCH_ROW_* per record. Only set when progress is set.
+	uint32_t* progress_indexes;
+	uint32_t* dups;  // First offset of each duplicate read record. NULL if not deduplicated.
+	as_event_command* hedge_cmds;   // Linked node commands of a hedged batch.
+	as_event_command* hedge_timer;  // Hedge delay timer. NULL when expired or cancelled.
+	uint32_t hedge_delay;  // 0 if batch is not hedged.
+	uint32_t unanswered;   // Keys of hedged node commands without a response.
 	as_policy_replica replica;
 	as_policy_replica replica_sc;
 	as_policy_read_mode_sc read_mode_sc;
@@ -163,7 +245,8 @@ typedef struct {
 	as_node* node;
 	as_vector offsets;
 	uint32_t size;
-	bool can_repeat;
+	uint32_t count;
+	uint32_t full_id;  // Last full message sent to node. Repeat rows are valid if current.
 } as_batch_retry_node;
 
 typedef struct {
@@ -172,10 +255,18 @@ typedef struct {
 	uint32_t size;
 } as_batch_retry_offset;
 
+// Parsed row of a batch retry buffer.
+typedef struct {
+	as_batch_retry_offset off;
+	uint32_t index;  // bnodes index or BATCH_NODE_NONE.
+	uint8_t type;
+} as_batch_retry_row;
+
 typedef struct {
 	aerospike* as;
 	as_batch_records* records;
 	as_async_batch_listener listener;
+	as_async_batch_progress_listener progress;
 	void* udata;
 	as_txn* txn;
 	uint64_t* versions;
@@ -221,6 +312,135 @@ destroy_versions(uint64_t* versions)
 	}
 }
 
+static inline void
+as_batch_key_scratch_init(const as_batch_key_src* src, as_batch_key_scratch* scratch)
+{
+	if (src->keys) {
+		return;
+	}
+
+	scratch->current = 0;
+
+	for (uint32_t i = 0; i < 2; i++) {
+		as_key* key = &scratch->keys[i];
+
+		if (src->digests) {
+			// Only the digest changes between keys.
+			as_strncpy(key->ns, src->digests->ns, sizeof(as_namespace));
+			as_strncpy(key->set, src->digests->set, sizeof(as_set));
+		}
+		else {
+			key->ns[0] = '\0';
+			key->set[0] = '\0';
+		}
+		key->valuep = NULL;
+		key->digest.init = true;
+		key->ns_handle = 0;
+		key->route_hint = 0;
+	}
+}
+
+static inline as_key*
+as_batch_key_at(const as_batch_key_src* src, uint32_t offset, as_batch_key_scratch* scratch)
+{
+	if (src->keys) {
+		return &src->keys[offset];
+	}
+
+	if (src->digests) {
+		as_key* key = &scratch->keys[0];
+		memcpy(key->digest.value, src->digests->digests[offset], AS_DIGEST_VALUE_SIZE);
+		return key;
+	}
+
+	const as_key_compact* ck = &src->compact->keys[offset];
+	as_key* key = &scratch->keys[scratch->current];
+
+	if (strcmp(key->ns, ck->ns) != 0 || strcmp(key->set, ck->set) != 0) {
+		scratch->current ^= 1;
+		key = &scratch->keys[scratch->current];
+
+		if (strcmp(key->ns, ck->ns) != 0) {
+			as_strncpy(key->ns, ck->ns, sizeof(as_namespace));
+			key->ns_handle = 0;
+		}
+		as_strncpy(key->set, ck->set, sizeof(as_set));
+	}
+
+	// User keys are not sent for compact keys and the route hint belongs to the previous key.
+	key->route_hint = 0;
+	memcpy(key->digest.value, ck->digest, AS_DIGEST_VALUE_SIZE);
+	return key;
+}
+
+// Return namespace and digest of key at offset. Unlike as_batch_key_at(), the returned
+// memory is owned by the caller's batch and is not overwritten by the next key.
+static inline void
+as_batch_key_src_id(
+	const as_batch_key_src* src, uint32_t offset, const char** ns, const uint8_t** digest
+	)
+{
+	if (src->keys) {
+		as_key* key = &src->keys[offset];
+		*ns = key->ns;
+		*digest = key->digest.value;
+	}
+	else if (src->digests) {
+		*ns = src->digests->ns;
+		*digest = src->digests->digests[offset];
+	}
+	else {
+		const as_key_compact* ck = &src->compact->keys[offset];
+		*ns = ck->ns;
+		*digest = ck->digest;
+	}
+}
+
+static as_status
+as_batch_keys_set_digests(as_error* err, as_key* entries, uint32_t n_keys)
+{
+	as_key* keys[BATCH_DIGEST_CHUNK];
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		keys[count++] = &entries[i];
+
+		if (count == BATCH_DIGEST_CHUNK || i == n_keys - 1) {
+			as_status status = as_key_set_digests(err, keys, count);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+			count = 0;
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_batch_records_set_digests(as_error* err, as_batch_records* records)
+{
+	as_key* keys[BATCH_DIGEST_CHUNK];
+	as_vector* list = &records->list;
+	uint32_t n_keys = list->size;
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_batch_base_record* rec = as_vector_get(list, i);
+		keys[count++] = &rec->key;
+
+		if (count == BATCH_DIGEST_CHUNK || i == n_keys - 1) {
+			as_status status = as_key_set_digests(err, keys, count);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+			count = 0;
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
 static as_status
 as_batch_keys_prepare_txn(as_txn* txn, const as_batch* batch, as_error* err, uint64_t** versions_pp)
 {
@@ -230,6 +450,12 @@ as_batch_keys_prepare_txn(as_txn* txn, const as_batch* batch, as_error* err, uin
 		return status;
 	}
 
+	status = as_batch_keys_set_digests(err, batch->keys.entries, batch->keys.size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
 	uint32_t n_keys = batch->keys.size;
 	uint64_t* versions = cf_malloc(sizeof(uint64_t) * n_keys);
 
@@ -242,13 +468,6 @@ as_batch_keys_prepare_txn(as_txn* txn, const as_batch* batch, as_error* err, uin
 			return status;
 		}
 
-		status = as_key_set_digest(err, key);
-
-		if (status != AEROSPIKE_OK) {
-			destroy_versions(versions);
-			return status;
-		}
-
 		versions[i] = as_txn_get_read_version(txn, key->digest.value);
 	}
 	*versions_pp = versions;
@@ -266,6 +485,12 @@ as_batch_records_prepare_txn(
 		return status;
 	}
 
+	status = as_batch_records_set_digests(err, records);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
 	as_vector* list = &records->list;
 	uint32_t n_keys = records->list.size;
 	uint64_t* versions = cf_malloc(sizeof(uint64_t) * n_keys);
@@ -279,13 +504,6 @@ as_batch_records_prepare_txn(
 			return status;
 		}
 
-		status = as_key_set_digest(err, &rec->key);
-
-		if (status != AEROSPIKE_OK) {
-			destroy_versions(versions);
-			return status;
-		}
-
 		versions[i] = as_txn_get_read_version(txn, rec->key.digest.value);
 	}
 	*versions_pp = versions;
@@ -295,7 +513,16 @@ as_batch_records_prepare_txn(
 static inline as_status
 as_batch_parse_record(uint8_t** pp, as_error* err, as_msg* msg, as_record* rec, bool deserialize)
 {
-	as_record_init(rec, msg->n_ops);
+	if (rec->bins._free && rec->bins.capacity >= msg->n_ops) {
+		// Reuse bin capacity retained by as_batch_records_reset().
+		rec->bins.size = 0;
+	}
+	else {
+		if (rec->bins._free) {
+			cf_free(rec->bins.entries);
+		}
+		as_record_init(rec, msg->n_ops);
+	}
 	rec->gen = msg->generation;
 	rec->ttl = cf_server_void_time_to_ttl(msg->record_ttl);
 
@@ -311,11 +538,20 @@ as_batch_parse_record(uint8_t** pp, as_error* err, as_msg* msg, as_record* rec,
 static void
 as_batch_complete_async(as_event_executor* executor)
 {
-	if (executor->notify) {
-		as_async_batch_executor* e = (as_async_batch_executor*)executor;
+	as_async_batch_executor* e = (as_async_batch_executor*)executor;
+
+	if (e->hedge_timer) {
+		as_event_command_cancel(e->hedge_timer);
+		e->hedge_timer = NULL;
+	}
 
+	if (executor->notify) {
 		destroy_versions(e->versions);
 
+		if (e->dups) {
+			as_batch_dedup_records_complete(e->dups, &e->records->list);
+		}
+
 		if (e->error_row && ! executor->err) {
 			as_error err;
 			as_error_set_message(&err, AEROSPIKE_BATCH_FAILED, "One or more batch sub-commands failed");
@@ -345,56 +581,160 @@ as_batch_in_doubt(const as_key* key, as_txn* txn, bool has_write, uint32_t sent)
 	return false;
 }
 
-static bool
-as_batch_async_parse_records(as_event_command* cmd)
+static as_status
+as_batch_stream_result(as_batch_task_keys* btk, as_error* err, uint32_t offset)
+{
+	as_batch_result* res = &btk->results[offset];
+	bool rv = true;
+
+	// A command retried on the same node can return keys that were already delivered.
+	if (! btk->delivered[offset]) {
+		btk->delivered[offset] = 1;
+
+		if (as_load_uint32(btk->stream_abort) == 0) {
+			rv = btk->stream(offset, res, btk->udata);
+
+			if (! rv) {
+				as_store_uint32(btk->stream_abort, 1);
+			}
+		}
+		else {
+			rv = false;
+		}
+	}
+
+	// Release bins after delivery, so memory does not grow with batch size.
+	as_record_destroy(&res->record);
+	as_record_init(&res->record, 0);
+
+	if (! rv) {
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT_ABORT, "");
+	}
+	return AEROSPIKE_OK;
+}
+
+static inline as_status
+as_batch_keys_get_result(as_batch_task_keys* btk, uint32_t offset)
+{
+	return btk->flat ? btk->flat->status[offset] : btk->results[offset].result;
+}
+
+static inline void
+as_batch_keys_set_result(as_batch_task_keys* btk, uint32_t offset, as_status status)
+{
+	if (btk->flat) {
+		btk->flat->status[offset] = status;
+	}
+	else {
+		btk->results[offset].result = status;
+	}
+}
+
+static inline void
+as_batch_flat_set_header(as_batch_exists_results* flat, uint32_t offset, uint16_t gen, uint32_t ttl)
+{
+	if (flat->gen) {
+		flat->gen[offset] = gen;
+	}
+
+	if (flat->ttl) {
+		flat->ttl[offset] = ttl;
+	}
+}
+
+static as_status
+as_batch_parse_flat(
+	uint8_t** pp, as_error* err, as_msg* msg, as_batch_task_keys* btk, as_txn* txn, uint32_t offset
+	)
+{
+	// Key is only referenced for transactions, which require as_key entries.
+	const as_key* key = txn ? &btk->src.keys[offset] : NULL;
+	as_status status = as_command_parse_fields(pp, err, msg, txn, key, btk->base.has_write);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	btk->flat->status[offset] = msg->result_code;
+
+	if (msg->result_code == AEROSPIKE_OK) {
+		as_batch_flat_set_header(btk->flat, offset, (uint16_t)msg->generation,
+			cf_server_void_time_to_ttl(msg->record_ttl));
+	}
+	else if (as_batch_set_error_row(msg->result_code)) {
+		*btk->base.error_row = true;
+	}
+
+	// Header-only reads do not return bins, but skip any that are returned.
+	*pp = as_command_ignore_bins(*pp, msg->n_ops);
+	return AEROSPIKE_OK;
+}
+
+// Parse one async batch response block into the batch records. Set last when the final
+// block was parsed. This function does not touch the event loop, so it may also be called
+// from a worker thread (see as_event_offload()).
+as_status
+as_batch_async_parse_block(as_event_command* cmd, as_error* err, bool* last)
 {
-	as_error err;
 	uint8_t* p = cmd->buf + cmd->pos;
 	uint8_t* end = cmd->buf + cmd->len;
 	as_async_batch_executor* executor = cmd->udata;  // udata is overloaded to contain executor.
 	as_vector* records = &executor->records->list;
 
+	*last = false;
+
 	while (p < end) {
 		as_msg* msg = (as_msg*)p;
 		as_msg_swap_header_from_be(msg);
 		p += sizeof(as_msg);
 		
 		if (msg->info3 & AS_MSG_INFO3_LAST) {
+			*last = true;
+
 			if (msg->result_code != AEROSPIKE_OK) {
-				as_error_set_message(&err, msg->result_code, as_error_string(msg->result_code));
-				as_event_response_error(cmd, &err);
-				return true;
+				return as_error_set_message(err, msg->result_code, as_error_string(msg->result_code));
 			}
-			as_event_batch_complete(cmd);
-			return true;
+			return AEROSPIKE_OK;
 		}
 		
 		uint32_t offset = msg->transaction_ttl; // overloaded to contain batch index
 		
 		if (offset >= records->size) {
-			as_error_update(&err, AEROSPIKE_ERR_CLIENT, "Batch index %u >= batch size: %u",
-							offset, records->size);
-			as_event_response_error(cmd, &err);
-			return true;
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Batch index %u >= batch size: %u",
+								   offset, records->size);
 		}
 		
 		as_batch_base_record* rec = as_vector_get(records, offset);
 
-		as_status status = as_command_parse_fields(&p, &err, msg, cmd->txn, &rec->key, rec->has_write);
+		as_status status = as_command_parse_fields(&p, err, msg, cmd->txn, &rec->key, rec->has_write);
 
 		if (status != AEROSPIKE_OK) {
 			return status;
 		}
 
+		if (cmd->hedge) {
+			if (rec->result != AEROSPIKE_NO_RESPONSE) {
+				// Key was answered by another hedged node command.
+				p = as_command_ignore_bins(p, msg->n_ops);
+				continue;
+			}
+			executor->unanswered--;
+
+			if (cmd->hedge == AS_ASYNC_HEDGE_DUPLICATE) {
+				// Count each hedge command that answered first once.
+				cmd->hedge = AS_ASYNC_HEDGE_WON;
+				as_cluster_add_hedge_win(cmd->cluster);
+			}
+		}
+
 		rec->result = msg->result_code;
 
 		if (msg->result_code == AEROSPIKE_OK) {
-			as_status status = as_batch_parse_record(&p, &err, msg, &rec->record,
+			as_status status = as_batch_parse_record(&p, err, msg, &rec->record,
 													 cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
 
 			if (status != AEROSPIKE_OK) {
-				as_event_response_error(cmd, &err);
-				return true;
+				return status;
 			}
 		}
 		else if (msg->result_code == AEROSPIKE_ERR_UDF) {
@@ -402,18 +742,156 @@ as_batch_async_parse_records(as_event_command* cmd)
 			executor->error_row = true;
 
 			// AEROSPIKE_ERR_UDF results in "FAILURE" bin that contains an error message.
-			as_status status = as_batch_parse_record(&p, &err, msg, &rec->record,
+			as_status status = as_batch_parse_record(&p, err, msg, &rec->record,
 													 cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
 
 			if (status != AEROSPIKE_OK) {
-				as_event_response_error(cmd, &err);
-				return true;
+				return status;
 			}
 		}
 		else if (as_batch_set_error_row(msg->result_code)) {
 			rec->in_doubt = as_batch_in_doubt(&rec->key, cmd->txn, rec->has_write, cmd->command_sent_counter);
 			executor->error_row = true;
 		}
+
+		if (executor->progress_state) {
+			// Publish the completed row to the event loop thread.
+			as_store_uint8_rls(&executor->progress_state[offset], BATCH_ROW_PARSED);
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static void
+as_batch_async_progress(as_async_batch_executor* executor)
+{
+	as_vector* records = &executor->records->list;
+	uint8_t* state = executor->progress_state;
+	uint32_t* indexes = executor->progress_indexes;
+	uint32_t n = 0;
+
+	// Rows parsed by other node commands are also complete, so they are delivered early too.
+	for (uint32_t i = 0; i < records->size; i++) {
+		if (as_load_uint8_acq(&state[i]) == BATCH_ROW_PARSED) {
+			state[i] = BATCH_ROW_DELIVERED;
+			indexes[n++] = i;
+		}
+	}
+
+	if (n > 0) {
+		executor->progress(executor->records, indexes, n, executor->executor.udata,
+			executor->executor.event_loop);
+	}
+}
+
+// Complete node command after its last block was parsed. Must run in the event loop thread.
+void
+as_batch_async_node_complete(as_event_command* cmd)
+{
+	as_async_batch_executor* executor = cmd->udata;  // udata is overloaded to contain executor.
+
+	if (executor->progress && executor->executor.notify && executor->executor.valid) {
+		as_batch_async_progress(executor);
+	}
+	as_event_batch_complete(cmd);
+}
+
+static inline void
+as_batch_hedge_link(as_async_batch_executor* executor, as_event_command* cmd, uint8_t hedge)
+{
+	// New commands are added to the head, so commands after the current command are not
+	// affected while the list is walked in as_batch_hedge_async().
+	cmd->hedge = hedge;
+	cmd->hedge_prev = NULL;
+	cmd->hedge_next = executor->hedge_cmds;
+
+	if (executor->hedge_cmds) {
+		executor->hedge_cmds->hedge_prev = cmd;
+	}
+	executor->hedge_cmds = cmd;
+}
+
+// Remove command from its hedged batch. Must run in the event loop thread.
+void
+as_batch_hedge_unlink(as_event_command* cmd)
+{
+	as_async_batch_executor* executor = cmd->udata;  // udata is overloaded to contain executor.
+
+	if (cmd->hedge_prev) {
+		cmd->hedge_prev->hedge_next = cmd->hedge_next;
+	}
+	else {
+		executor->hedge_cmds = cmd->hedge_next;
+	}
+
+	if (cmd->hedge_next) {
+		cmd->hedge_next->hedge_prev = cmd->hedge_prev;
+	}
+	cmd->hedge = AS_ASYNC_HEDGE_NONE;
+}
+
+// All keys of a hedged batch have a response. Cancel the losing node commands and complete
+// the current node command.
+static void
+as_batch_hedge_finish(as_event_command* cmd, bool last)
+{
+	as_async_batch_executor* executor = cmd->udata;  // udata is overloaded to contain executor.
+	as_event_executor* e = &executor->executor;
+
+	as_batch_hedge_unlink(cmd);
+
+	if (executor->hedge_timer) {
+		as_event_command_cancel(executor->hedge_timer);
+		executor->hedge_timer = NULL;
+	}
+
+	// Cancelling a command can start other commands from the delay queue, so commands are
+	// unlinked one at a time.
+	as_event_command* other;
+	uint32_t n_cancelled = 0;
+
+	while ((other = executor->hedge_cmds)) {
+		as_batch_hedge_unlink(other);
+		as_event_command_cancel(other);
+		n_cancelled++;
+	}
+
+	if (n_cancelled > 0) {
+		// The executor can not complete here because the current command is still counted.
+		pthread_mutex_lock(&e->lock);
+		e->count += n_cancelled;
+		pthread_mutex_unlock(&e->lock);
+	}
+
+	if (last) {
+		as_batch_async_node_complete(cmd);
+		return;
+	}
+
+	// Remaining response blocks are not needed.
+	as_event_command_cancel(cmd);
+	as_event_executor_complete(e);
+}
+
+static bool
+as_batch_async_parse_records(as_event_command* cmd)
+{
+	as_error err;
+	bool last;
+
+	if (as_batch_async_parse_block(cmd, &err, &last) != AEROSPIKE_OK) {
+		as_event_response_error(cmd, &err);
+		return true;
+	}
+
+	if (cmd->hedge && ((as_async_batch_executor*)cmd->udata)->unanswered == 0) {
+		as_batch_hedge_finish(cmd, last);
+		return true;
+	}
+
+	if (last) {
+		as_batch_async_node_complete(cmd);
+		return true;
 	}
 	return false;
 }
@@ -427,6 +905,7 @@ as_batch_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 
 	uint8_t* p = buf;
 	uint8_t* end = buf + size;
+	uint32_t n_records = 0;
 
 	while (p < end) {
 		as_msg* msg = (as_msg*)p;
@@ -437,6 +916,10 @@ as_batch_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 			if (msg->result_code != AEROSPIKE_OK) {
 				return as_error_set_message(err, msg->result_code, as_error_string(msg->result_code));
 			}
+
+			if (n_records > 0) {
+				as_cluster_add_batch_record_size(node->cluster, (uint32_t)(size / n_records));
+			}
 			return AEROSPIKE_NO_MORE_RECORDS;
 		}
 
@@ -488,13 +971,23 @@ as_batch_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 
 			case BATCH_TYPE_KEYS: {
 				as_batch_task_keys* btk = (as_batch_task_keys*)task;
-				as_batch_result* res = &btk->results[offset];
-
-				as_status status = as_command_parse_fields(&p, err, msg, txn, res->key, btk->base.has_write);
 
-				if (status != AEROSPIKE_OK) {
-					return status;
-				}
+				if (btk->flat) {
+					as_status status = as_batch_parse_flat(&p, err, msg, btk, txn, offset);
+
+					if (status != AEROSPIKE_OK) {
+						return status;
+					}
+					break;
+				}
+
+				as_batch_result* res = &btk->results[offset];
+
+				as_status status = as_command_parse_fields(&p, err, msg, txn, res->key, btk->base.has_write);
+
+				if (status != AEROSPIKE_OK) {
+					return status;
+				}
 
 				res->result = msg->result_code;
 
@@ -518,9 +1011,22 @@ as_batch_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 					res->in_doubt = as_batch_in_doubt(res->key, txn, task->has_write, cmd->sent);
 					*task->error_row = true;
 				}
+
+				if (btk->stream) {
+					status = as_batch_stream_result(btk, err, offset);
+
+					if (status != AEROSPIKE_OK) {
+						return status;
+					}
+				}
 				break;
 			}
 		}
+		n_records++;
+	}
+
+	if (n_records > 0) {
+		as_cluster_add_batch_record_size(node->cluster, (uint32_t)(size / n_records));
 	}
 	return AEROSPIKE_OK;
 }
@@ -603,6 +1109,65 @@ as_batch_write_ops(uint8_t* p, const as_operations* ops, as_queue* buffers)
 	return p;
 }
 
+static as_status
+as_batch_ops_size(as_batch_builder* bb, const as_operations* ops, as_error* err)
+{
+	if (ops == bb->ops) {
+		bb->size += bb->ops_size;
+		return AEROSPIKE_OK;
+	}
+
+	uint32_t n_operations = ops->binops.size;
+	as_status status;
+
+	if (bb->ops) {
+		// Operations differ from the cached operations.
+		for (uint32_t i = 0; i < n_operations; i++) {
+			status = as_command_bin_size(&ops->binops.entries[i].bin, bb->buffers, &bb->size, err);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+		}
+		return AEROSPIKE_OK;
+	}
+
+	// Serialize operations once for all rows that share them.
+	as_queue buffers;
+	as_queue_inita(&buffers, sizeof(as_buffer), 8);
+
+	size_t size = 0;
+
+	for (uint32_t i = 0; i < n_operations; i++) {
+		status = as_command_bin_size(&ops->binops.entries[i].bin, &buffers, &size, err);
+
+		if (status != AEROSPIKE_OK) {
+			as_buffers_destroy(&buffers);
+			return status;
+		}
+	}
+
+	uint8_t* data = cf_malloc(size);
+	uint8_t* end = as_batch_write_ops(data, ops, &buffers);
+	as_buffers_destroy(&buffers);
+
+	bb->ops = ops;
+	bb->ops_data = data;
+	bb->ops_size = (uint32_t)(end - data);
+	bb->size += bb->ops_size;
+	return AEROSPIKE_OK;
+}
+
+static inline uint8_t*
+as_batch_write_ops_cached(uint8_t* p, const as_operations* ops, as_batch_builder* bb)
+{
+	if (ops == bb->ops) {
+		memcpy(p, bb->ops_data, bb->ops_size);
+		return p + bb->ops_size;
+	}
+	return as_batch_write_ops(p, ops, bb->buffers);
+}
+
 static size_t
 as_batch_trailer_write(uint8_t* cmd, uint8_t* p, uint8_t* batch_field)
 {
@@ -683,15 +1248,19 @@ as_batch_records_size_old(
 
 static as_status
 as_batch_keys_size_old(
-	as_key* keys, as_vector* offsets, as_batch_read_record* rec, as_batch_builder* bb, as_error* err
+	const as_batch_key_src* src, as_vector* offsets, as_batch_read_record* rec,
+	as_batch_builder* bb, as_error* err
 	)
 {
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(src, &scratch);
+
 	as_key* prev = 0;
 	uint32_t n_offsets = offsets->size;
 
 	for (uint32_t i = 0; i < n_offsets; i++) {
 		uint32_t offset = *(uint32_t*)as_vector_get(offsets, i);
-		as_key* key = &keys[offset];
+		as_key* key = as_batch_key_at(src, offset, &scratch);
 
 		bb->size += AS_DIGEST_VALUE_SIZE + sizeof(uint32_t);
 
@@ -797,10 +1366,13 @@ as_batch_records_write_old(
 
 static size_t
 as_batch_keys_write_old(
-	const as_policy_batch* policy, as_key* keys, as_vector* offsets, as_batch_read_record* rec,
-	as_batch_attr* attr, as_batch_builder* bb, uint8_t* cmd
+	const as_policy_batch* policy, const as_batch_key_src* src, as_vector* offsets,
+	as_batch_read_record* rec, as_batch_attr* attr, as_batch_builder* bb, uint8_t* cmd
 	)
 {
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(src, &scratch);
+
 	uint32_t n_offsets = offsets->size;
 	uint8_t* p = as_batch_header_write_old(cmd, policy, n_offsets, bb);
 
@@ -817,7 +1389,7 @@ as_batch_keys_write_old(
 		*(uint32_t*)p = cf_swap_to_be32(offset);
 		p += sizeof(uint32_t);
 
-		as_key* key = &keys[offset];
+		as_key* key = as_batch_key_at(src, offset, &scratch);
 		memcpy(p, key->digest.value, AS_DIGEST_VALUE_SIZE);
 		p += AS_DIGEST_VALUE_SIZE;
 
@@ -1025,19 +1597,29 @@ as_batch_read_record_size(as_batch_read_record* rec, as_batch_builder* bb, as_er
 {
 	bb->size += 4; // read ttl
 
-	if (rec->bin_names) {
+	if (rec->projection) {
+		bb->size += rec->projection->ops_size;
+	}
+	else if (rec->bin_names) {
 		for (uint32_t j = 0; j < rec->n_bin_names; j++) {
 			bb->size += as_command_string_operation_size(rec->bin_names[j]);
 		}
 	}
 	else if (rec->ops) {
-		size_t s = 0;
-		as_status status = as_batch_estimate_ops(rec->ops, err, bb->buffers, &s, false);
+		const as_operations* ops = rec->ops;
+		uint32_t n_operations = ops->binops.size;
 
-		if (status != AEROSPIKE_OK) {
-			return status;
+		if (n_operations == 0) {
+			return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "No operations defined");
 		}
-		bb->size += s;
+
+		for (uint32_t i = 0; i < n_operations; i++) {
+			if (as_op_is_write[ops->binops.entries[i].op]) {
+				return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+											"Write operations not allowed in batch read");
+			}
+		}
+		return as_batch_ops_size(bb, ops, err);
 	}
 	return AEROSPIKE_OK;
 }
@@ -1055,16 +1637,9 @@ as_batch_write_record_size(as_batch_write_record* rec, as_batch_builder* bb, as_
 	uint32_t n_operations = ops->binops.size;
 
 	for (uint32_t i = 0; i < n_operations; i++) {
-		as_binop* op = &ops->binops.entries[i];
-
-		if (as_op_is_write[op->op]) {
+		if (as_op_is_write[ops->binops.entries[i].op]) {
 			has_write = true;
-		}
-
-		as_status status = as_command_bin_size(&op->bin, bb->buffers, &bb->size, err);
-
-		if (status != AEROSPIKE_OK) {
-			return status;
+			break;
 		}
 	}
 
@@ -1072,7 +1647,7 @@ as_batch_write_record_size(as_batch_write_record* rec, as_batch_builder* bb, as_
 		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
 									"Batch write operations do not contain a write");
 	}
-	return AEROSPIKE_OK;
+	return as_batch_ops_size(bb, ops, err);
 }
 
 static void
@@ -1084,12 +1659,26 @@ as_batch_apply_record_size(as_batch_apply_record* rec, as_batch_builder* bb)
 	bb->size += as_command_string_field_size(rec->module);
 	bb->size += as_command_string_field_size(rec->function);
 
+	if (bb->arglist_cached && rec->arglist == bb->arglist) {
+		bb->size += as_command_field_size(bb->arglist_buffer.size);
+		return;
+	}
+
 	as_buffer buffer;
 	as_serializer ser;
 	as_msgpack_init(&ser);
 	as_serializer_serialize(&ser, (as_val*)rec->arglist, &buffer);
 	as_serializer_destroy(&ser);
-	as_queue_push(bb->buffers, &buffer);
+
+	if (! bb->arglist_cached) {
+		// Serialize arglist once for all rows that share it.
+		bb->arglist = rec->arglist;
+		bb->arglist_buffer = buffer;
+		bb->arglist_cached = true;
+	}
+	else {
+		as_queue_push(bb->buffers, &buffer);
+	}
 	bb->size += as_command_field_size(buffer.size);
 }
 
@@ -1698,10 +2287,21 @@ as_batch_write_bin_names(
 	return p;
 }
 
+static uint8_t*
+as_batch_write_projection(
+	uint8_t* p, as_key* key, as_txn* txn, uint64_t ver, as_batch_attr* attr, as_exp* filter,
+	const as_bin_projection* proj
+	)
+{
+	p = as_batch_write_read(p, key, txn, ver, attr, filter, (uint16_t)proj->n_bins);
+	memcpy(p, proj->ops, proj->ops_size);
+	return p + proj->ops_size;
+}
+
 static uint8_t*
 as_batch_write_operations(
 	uint8_t* p, as_key* key, as_txn* txn, uint64_t ver, as_batch_attr* attr, as_exp* filter, const as_operations* ops,
-	as_queue* buffers
+	as_batch_builder* bb
 	)
 {
 	uint16_t n_ops = (uint16_t)ops->binops.size;
@@ -1712,22 +2312,26 @@ as_batch_write_operations(
 	else {
 		p = as_batch_write_read(p, key, txn, ver, attr, filter, n_ops);
 	}
-	p = as_batch_write_ops(p, ops, buffers);
+	p = as_batch_write_ops_cached(p, ops, bb);
 	return p;
 }
 
 static uint8_t*
 as_batch_write_udf(
 	uint8_t* p, as_key* key, as_txn* txn, uint64_t ver, as_batch_apply_record* rec, as_batch_attr* attr, as_exp* filter,
-	as_queue* buffers
+	as_batch_builder* bb
 	)
 {
 	p = as_batch_write_write(p, key, txn, ver, attr, filter, 3, 0);
 	p = as_command_write_field_string(p, AS_FIELD_UDF_PACKAGE_NAME, rec->module);
 	p = as_command_write_field_string(p, AS_FIELD_UDF_FUNCTION, rec->function);
 
+	if (bb->arglist_cached && rec->arglist == bb->arglist) {
+		return as_command_write_field_buffer(p, AS_FIELD_UDF_ARGLIST, &bb->arglist_buffer);
+	}
+
 	as_buffer buffer;
-	as_queue_pop(buffers, &buffer);
+	as_queue_pop(bb->buffers, &buffer);
 	p = as_command_write_field_buffer(p, AS_FIELD_UDF_ARGLIST, &buffer);
 	as_buffer_destroy(&buffer);
 	return p;
@@ -1781,14 +2385,18 @@ as_batch_records_write_new(
 						as_batch_attr_read_header(&attr, policy);
 					}
 
-					if (br->bin_names) {
+					if (br->projection) {
+						p = as_batch_write_projection(p, &br->key, txn, ver, &attr, attr.filter_exp,
+							br->projection);
+					}
+					else if (br->bin_names) {
 						p = as_batch_write_bin_names(p, &br->key, txn, ver, &attr, attr.filter_exp,
 							(const char**)br->bin_names, br->n_bin_names);
 					}
 					else if (br->ops) {
 						as_batch_attr_read_adjust_ops(&attr, br->ops);
 						p = as_batch_write_operations(p, &br->key, txn, ver, &attr, attr.filter_exp, br->ops,
-							bb->buffers);
+							bb);
 					}
 					else {
 						as_batch_attr_read_adjust(&attr, br->read_all_bins);
@@ -1825,7 +2433,7 @@ as_batch_records_write_new(
 
 					as_batch_attr_write(&attr, bw->ops, pbw, send_key, durable_delete);
 					p = as_batch_write_operations(p, &bw->key, txn, ver, &attr, attr.filter_exp, bw->ops,
-						bb->buffers);
+						bb);
 					break;
 				}
 
@@ -1856,7 +2464,7 @@ as_batch_records_write_new(
 					}
 
 					as_batch_attr_apply(&attr, pba, send_key, durable_delete);
-					p = as_batch_write_udf(p, &ba->key, txn, ver, ba, &attr, attr.filter_exp, bb->buffers);
+					p = as_batch_write_udf(p, &ba->key, txn, ver, ba, &attr, attr.filter_exp, bb);
 					break;
 				}
 
@@ -1932,11 +2540,13 @@ as_batch_replica_init(
 		rep->replica_sc = rep->replica;
 		rep->replica_index = as_replica_index_init_write(cluster, rep->replica);
 		rep->replica_index_sc = rep->replica_index;
+		rep->rack_balance = false;
 		return;
 	}
 
 	rep->replica = policy->replica;
 	rep->replica_index = as_replica_index_init_read(cluster, rep->replica);
+	rep->rack_balance = policy->rack_balance && rep->replica == AS_POLICY_REPLICA_PREFER_RACK;
 
 	switch (policy->read_mode_sc) {
 		case AS_POLICY_READ_MODE_SC_SESSION:
@@ -1962,139 +2572,524 @@ as_batch_replica_init(
 	}
 }
 
-static as_status
-as_batch_get_node(
-	as_cluster* cluster, const as_key* key, const as_batch_replica* rep, bool has_write,
-	as_node* prev_node, as_node** node_pp
-	)
+static inline uint32_t
+as_batch_node_map_capacity(uint32_t n_nodes)
 {
-	as_error err;
-	as_partition_info pi;
-	as_status status = as_partition_info_init(&pi, cluster, &err, key);
+	// Keep load factor at or below 50%.
+	uint32_t capacity = 16;
 
-	if (status != AEROSPIKE_OK) {
-		return status;
+	while (capacity < n_nodes * 2) {
+		capacity <<= 1;
 	}
+	return capacity;
+}
 
-	as_policy_replica replica;
-	uint8_t replica_index;
+#define as_batch_node_map_inita(__map, __n_nodes) \
+	(__map)->capacity = as_batch_node_map_capacity(__n_nodes);\
+	(__map)->slots = alloca(sizeof(as_batch_node_slot) * (__map)->capacity);\
+	memset((__map)->slots, 0, sizeof(as_batch_node_slot) * (__map)->capacity);\
+	(__map)->size = 0;\
+	(__map)->heap = false;
 
-	if (has_write || !pi.sc_mode) {
-		replica = rep->replica;
-		replica_index = rep->replica_index;
+static inline void
+as_batch_node_map_destroy(as_batch_node_map* map)
+{
+	if (map->heap) {
+		cf_free(map->slots);
 	}
-	else {
-		replica = rep->replica_sc;
-		replica_index = rep->replica_index_sc;
+}
+
+static inline uint32_t
+as_batch_node_hash(as_node* node)
+{
+	uint64_t h = (uint64_t)(uintptr_t)node * 0x9E3779B97F4A7C15ULL;
+	return (uint32_t)(h >> 32);
+}
+
+static uint32_t
+as_batch_node_map_find(as_batch_node_map* map, as_node* node)
+{
+	uint32_t mask = map->capacity - 1;
+	uint32_t i = as_batch_node_hash(node) & mask;
+
+	while (map->slots[i].node) {
+		if (map->slots[i].node == node) {
+			return map->slots[i].index;
+		}
+		i = (i + 1) & mask;
 	}
+	return BATCH_NODE_NONE;
+}
 
-	as_node* node = as_partition_get_node(cluster, pi.ns, pi.partition, prev_node, replica,
-		pi.replica_size, &replica_index);
+static void
+as_batch_node_map_insert(as_batch_node_slot* slots, uint32_t capacity, as_node* node, uint32_t index)
+{
+	uint32_t mask = capacity - 1;
+	uint32_t i = as_batch_node_hash(node) & mask;
 
-	if (! node) {
-		*node_pp = NULL;
-		return AEROSPIKE_ERR_INVALID_NODE;
+	while (slots[i].node) {
+		i = (i + 1) & mask;
 	}
+	slots[i].node = node;
+	slots[i].index = index;
+}
 
-	*node_pp = node;
-	return AEROSPIKE_OK;
+static void
+as_batch_node_map_add(as_batch_node_map* map, as_node* node, uint32_t index)
+{
+	if ((map->size + 1) * 2 > map->capacity) {
+		// Cluster grew after the map was sized. Rehash into a larger heap table.
+		uint32_t capacity = map->capacity << 1;
+		as_batch_node_slot* slots = cf_malloc(sizeof(as_batch_node_slot) * capacity);
+		memset(slots, 0, sizeof(as_batch_node_slot) * capacity);
+
+		for (uint32_t i = 0; i < map->capacity; i++) {
+			as_batch_node_slot* slot = &map->slots[i];
+
+			if (slot->node) {
+				as_batch_node_map_insert(slots, capacity, slot->node, slot->index);
+			}
+		}
+		as_batch_node_map_destroy(map);
+		map->slots = slots;
+		map->capacity = capacity;
+		map->heap = true;
+	}
+	as_batch_node_map_insert(map->slots, map->capacity, node, index);
+	map->size++;
 }
 
-static inline void
-as_batch_command_init(
-	as_command* cmd, as_batch_task* task, const as_policy_batch* policy, uint8_t* buf, size_t size,
-	const as_command* parent
-	)
+static uint32_t
+as_batch_assign_node(as_batch_node_map* map, as_vector* batch_nodes, as_node* node)
 {
-	cmd->cluster = task->as->cluster;
-	cmd->policy = &policy->base;
-	cmd->node = task->node;
-	cmd->key = NULL;       // Not referenced when node set.
-	cmd->ns = NULL;
-	cmd->partition = NULL; // Not referenced when node set.
-	cmd->parse_results_fn = as_batch_parse_records;
-	cmd->udata = task;
-	cmd->buf = buf;
-	cmd->buf_size = size;
-	cmd->partition_id = 0; // Not referenced when node set.
-	cmd->replica = task->replica;
-	cmd->latency_type = AS_LATENCY_TYPE_BATCH;
+	uint32_t index = as_batch_node_map_find(map, node);
 
-	// Note: Do not set flags to AS_COMMAND_FLAGS_LINEARIZE because AP and SC replicas
-	// are tracked separately for batch (cmd->master and cmd->master_sc).
-	// SC master/replica switch is done in as_batch_retry().
-	cmd->flags = AS_COMMAND_FLAGS_BATCH;
+	if (index == BATCH_NODE_NONE) {
+		// Add batch node. Offsets are allocated after all keys are counted.
+		index = batch_nodes->size;
+		as_node_reserve(node);
+		as_batch_node* batch_node = as_vector_reserve(batch_nodes);
+		batch_node->node = node;  // Transfer node
+		batch_node->count = 0;
+		as_batch_node_map_add(map, node, index);
+	}
 
-	if (! task->has_write) {
-		cmd->flags |= AS_COMMAND_FLAGS_READ;
+	as_batch_node* batch_node = as_vector_get(batch_nodes, index);
+	batch_node->count++;
+	return index;
+}
+
+static void
+as_batch_distribute_keys(
+	as_vector* batch_nodes, const uint32_t* key_nodes, const uint32_t* offsets, uint32_t n_keys
+	)
+{
+	// Offsets vectors were sized to the exact key count, so appends never reallocate.
+	for (uint32_t i = 0; i < n_keys; i++) {
+		uint32_t index = key_nodes[i];
+
+		if (index != BATCH_NODE_NONE) {
+			as_batch_node* batch_node = as_vector_get(batch_nodes, index);
+			uint32_t offset = offsets ? offsets[i] : i;
+			as_vector_append(&batch_node->offsets, &offset);
+		}
 	}
+}
 
-	if (! parent) {
-		// Normal batch.
-		cmd->replica_index = task->replica_index;
-		cmd->replica_index_sc = task->replica_index_sc;
-		as_command_start_timer(cmd);
+static void
+as_batch_dedup_init(as_batch_dedup* dd, uint32_t* dups, uint32_t n_keys)
+{
+	// Keep load factor at or below 50%.
+	uint32_t capacity = 16;
+
+	while (capacity < n_keys * 2) {
+		capacity <<= 1;
 	}
-	else {
-		// Split retry mode.  Do not reset timer.
-		cmd->replica_index = parent->replica_index;
-		cmd->replica_index_sc = parent->replica_index_sc;
-		cmd->iteration = parent->iteration;
-		cmd->socket_timeout = parent->socket_timeout;
-		cmd->total_timeout = parent->total_timeout;
-		cmd->max_retries = parent->max_retries;
-		cmd->deadline_ms = parent->deadline_ms;
-		cmd->sent = parent->sent;
+
+	dd->slots = cf_calloc(capacity, sizeof(as_batch_dedup_slot));
+	dd->dups = dups;
+	dd->mask = capacity - 1;
+	dd->count = 0;
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		dups[i] = BATCH_NODE_NONE;
 	}
 }
 
 static inline void
-as_batch_builder_set_node(as_batch_builder* bb, as_node* node)
+as_batch_dedup_release(as_batch_dedup* dd)
 {
-	bb->batch_any = (node->features & AS_FEATURES_BATCH_ANY);
+	cf_free(dd->slots);
+	dd->slots = NULL;
+}
+
+// Return slot of first key with the same namespace and digest. If not found, add key and
+// return NULL.
+static as_batch_dedup_slot*
+as_batch_dedup_add(as_batch_dedup* dd, const char* ns, const uint8_t* digest, uint32_t offset)
+{
+	// Digests are uniformly distributed, so the first bytes are a sufficient hash.
+	uint32_t h;
+	memcpy(&h, digest, sizeof(uint32_t));
+	uint32_t i = h & dd->mask;
+
+	while (dd->slots[i].digest) {
+		as_batch_dedup_slot* slot = &dd->slots[i];
+
+		if (memcmp(slot->digest, digest, AS_DIGEST_VALUE_SIZE) == 0 &&
+			(slot->ns == ns || strcmp(slot->ns, ns) == 0)) {
+			return slot;
+		}
+		i = (i + 1) & dd->mask;
+	}
+
+	as_batch_dedup_slot* slot = &dd->slots[i];
+	slot->ns = ns;
+	slot->digest = digest;
+	slot->offset = offset;
+	return NULL;
 }
 
 static inline void
-as_batch_builder_destroy(as_batch_builder* bb)
+as_batch_dedup_set(as_batch_dedup* dd, uint32_t offset, uint32_t first)
 {
-	as_buffers_destroy(bb->buffers);
+	dd->dups[offset] = first;
+	dd->count++;
 }
 
+// Copy record parsed for the first occurrence of a key into a duplicate's record. Heap
+// values are shared by reference count. Values stored inside a bin are copied unless they
+// reference memory the record does not own.
 static void
-as_batch_set_doubt_records(as_batch_task_records* btr, as_error* err)
+as_batch_copy_record(as_record* src, as_record* dst)
 {
-	if (!err->in_doubt) {
-		return;
+	as_record_destroy(dst);
+	as_record_init(dst, src->bins.size);
+	dst->gen = src->gen;
+	dst->ttl = src->ttl;
+	dst->lazy = src->lazy;
+
+	if (src->buffer) {
+		as_record_set_buffer(dst, as_record_buffer_reserve(src->buffer));
 	}
 
-	as_txn* txn = btr->base.txn;
-	uint32_t offsets_size = btr->base.offsets.size;
+	for (uint16_t i = 0; i < src->bins.size; i++) {
+		as_bin* bin = &src->bins.entries[i];
+		as_bin_value* v = bin->valuep;
 
-	for (uint32_t i = 0; i < offsets_size; i++) {
-		uint32_t offset = *(uint32_t*)as_vector_get(&btr->base.offsets, i);
-		as_batch_base_record* rec = as_vector_get(btr->records, offset);
+		if (! v) {
+			as_record_set_nil(dst, bin->name);
+			continue;
+		}
 
-		if (rec->result == AEROSPIKE_NO_RESPONSE && rec->has_write && err->in_doubt) {
-			rec->in_doubt = true;
+		if (v != &bin->value) {
+			as_val_reserve((as_val*)v);
+			as_record_set(dst, bin->name, v);
+			continue;
+		}
 
-			if (txn) {
-				as_txn_on_write_in_doubt(txn, rec->key.digest.value, rec->key.set);
+		switch (as_val_type((as_val*)v)) {
+			case AS_BOOLEAN:
+				as_record_set_bool(dst, bin->name, v->boolean.value);
+				break;
+
+			case AS_INTEGER:
+				as_record_set_int64(dst, bin->name, v->integer.value);
+				break;
+
+			case AS_DOUBLE:
+				as_record_set_double(dst, bin->name, v->dbl.value);
+				break;
+
+			case AS_STRING: {
+				as_string* s = &v->string;
+				// Unowned strings point into the shared response buffer.
+				as_record_set_strp(dst, bin->name, s->free ? cf_strdup(s->value) : s->value,
+					s->free);
+				break;
+			}
+
+			case AS_GEOJSON: {
+				as_geojson* g = (as_geojson*)v;
+				as_record_set_geojson_strp(dst, bin->name, g->free ? cf_strdup(g->value) : g->value,
+					g->free);
+				break;
+			}
+
+			case AS_BYTES: {
+				as_bytes* b = &v->bytes;
+				uint8_t* value = b->value;
+
+				if (b->free) {
+					value = cf_malloc(b->size);
+					memcpy(value, b->value, b->size);
+				}
+				// Raw list and map bytes of lazy records keep their type, so the copy is
+				// deserialized on first access too.
+				as_record_set_raw_typep(dst, bin->name, value, b->size, b->type, b->free);
+				break;
 			}
+
+			default:
+				as_record_set_nil(dst, bin->name);
+				break;
 		}
 	}
 }
 
+// Copy results of first occurrences into duplicate keys and free duplicate offsets.
 static void
-as_batch_set_doubt_keys(as_batch_task_keys* btk, as_error* err)
+as_batch_dedup_keys_complete(
+	as_batch_dedup* dd, as_batch_result* results, as_batch_exists_results* flat, uint32_t n_keys
+	)
 {
-	if (!err->in_doubt) {
-		return;
-	}
+	for (uint32_t i = 0; dd->count > 0 && i < n_keys; i++) {
+		uint32_t first = dd->dups[i];
 
-	as_txn* txn = btk->base.txn;
-	uint32_t offsets_size = btk->base.offsets.size;
+		if (first == BATCH_NODE_NONE) {
+			continue;
+		}
 
-	for (uint32_t i = 0; i < offsets_size; i++) {
+		if (flat) {
+			flat->status[i] = flat->status[first];
+
+			if (flat->gen) {
+				flat->gen[i] = flat->gen[first];
+			}
+
+			if (flat->ttl) {
+				flat->ttl[i] = flat->ttl[first];
+			}
+		}
+		else {
+			as_batch_result* dup = &results[i];
+			as_batch_result* res = &results[first];
+			dup->result = res->result;
+			dup->in_doubt = res->in_doubt;
+
+			if (res->result == AEROSPIKE_OK) {
+				as_batch_copy_record(&res->record, &dup->record);
+			}
+		}
+	}
+	cf_free(dd->dups);
+	dd->dups = NULL;
+}
+
+// Copy results of first occurrences into duplicate read records.
+static void
+as_batch_dedup_records_complete(const uint32_t* dups, as_vector* records)
+{
+	for (uint32_t i = 0; i < records->size; i++) {
+		uint32_t first = dups[i];
+
+		if (first == BATCH_NODE_NONE) {
+			continue;
+		}
+
+		as_batch_base_record* dup = as_vector_get(records, i);
+		as_batch_base_record* rec = as_vector_get(records, first);
+		dup->result = rec->result;
+		dup->in_doubt = rec->in_doubt;
+
+		if (rec->result == AEROSPIKE_OK) {
+			as_batch_copy_record(&rec->record, &dup->record);
+		}
+	}
+}
+
+static as_node*
+as_batch_get_rack_node(
+	as_cluster* cluster, as_partition_info* pi, uint8_t replica_index, as_vector* batch_nodes,
+	as_batch_node_map* map
+	)
+{
+	as_node* nodes[AS_MAX_REPLICATION_FACTOR];
+	uint32_t n_nodes = as_partition_get_rack_nodes(cluster, pi->ns, pi->partition,
+		pi->replica_size, replica_index, nodes);
+
+	if (n_nodes <= 1) {
+		return n_nodes ? nodes[0] : NULL;
+	}
+
+	// Assign key to the same rack replica with the fewest keys so far. Ties are resolved
+	// in replica sequence order.
+	as_node* best = NULL;
+	uint32_t best_size = 0;
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		uint32_t index = as_batch_node_map_find(map, nodes[i]);
+		uint32_t size = 0;
+
+		if (index != BATCH_NODE_NONE) {
+			as_batch_node* batch_node = as_vector_get(batch_nodes, index);
+			size = batch_node->count;
+		}
+
+		if (! best || size < best_size) {
+			best = nodes[i];
+			best_size = size;
+		}
+	}
+	return best;
+}
+
+static as_status
+as_batch_get_node(
+	as_cluster* cluster, const as_key* key, const as_batch_replica* rep, bool has_write,
+	as_node* prev_node, as_vector* batch_nodes, as_batch_node_map* map, as_node** node_pp
+	)
+{
+	as_error err;
+	as_partition_info pi;
+	as_status status = as_partition_info_init(&pi, cluster, &err, key);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_policy_replica replica;
+	uint8_t replica_index;
+
+	if (has_write || !pi.sc_mode) {
+		replica = rep->replica;
+		replica_index = rep->replica_index;
+	}
+	else {
+		replica = rep->replica_sc;
+		replica_index = rep->replica_index_sc;
+	}
+
+	if (rep->rack_balance && !has_write && replica == AS_POLICY_REPLICA_PREFER_RACK) {
+		as_node* node = as_batch_get_rack_node(cluster, &pi, replica_index, batch_nodes, map);
+
+		if (node) {
+			*node_pp = node;
+			return AEROSPIKE_OK;
+		}
+		// No replica on a preferred rack. Fall back to normal rack routing for this key.
+	}
+
+	as_node* node = as_partition_get_node_key(cluster, key, pi.ns, pi.partition, prev_node,
+		replica, pi.replica_size, &replica_index);
+
+	if (! node) {
+		as_cluster_hurry_tend(cluster);
+		*node_pp = NULL;
+		return AEROSPIKE_ERR_INVALID_NODE;
+	}
+
+	*node_pp = node;
+	return AEROSPIKE_OK;
+}
+
+static inline void
+as_batch_command_init(
+	as_command* cmd, as_batch_task* task, const as_policy_batch* policy, uint8_t* buf, size_t size,
+	const as_command* parent
+	)
+{
+	cmd->cluster = task->as->cluster;
+	cmd->policy = &policy->base;
+	cmd->node = task->node;
+	cmd->key = NULL;       // Not referenced when node set.
+	cmd->ns = NULL;
+	cmd->partition = NULL; // Not referenced when node set.
+	cmd->parse_results_fn = as_batch_parse_records;
+	cmd->udata = task;
+	cmd->buf = buf;
+	cmd->buf_size = size;
+	cmd->iov = NULL;
+	cmd->iov_count = 0;
+	cmd->partition_id = 0; // Not referenced when node set.
+	cmd->replica = task->replica;
+	cmd->latency_type = AS_LATENCY_TYPE_BATCH;
+
+	// Note: Do not set flags to AS_COMMAND_FLAGS_LINEARIZE because AP and SC replicas
+	// are tracked separately for batch (cmd->master and cmd->master_sc).
+	// SC master/replica switch is done in as_batch_retry().
+	cmd->flags = AS_COMMAND_FLAGS_BATCH;
+
+	if (! task->has_write) {
+		cmd->flags |= AS_COMMAND_FLAGS_READ;
+
+		if (policy->hedge_delay > 0 && ! task->txn) {
+			// See as_batch_hedge_create().
+			cmd->flags |= AS_COMMAND_FLAGS_HEDGE;
+		}
+	}
+
+	if (! parent) {
+		// Normal batch.
+		cmd->replica_index = task->replica_index;
+		cmd->replica_index_sc = task->replica_index_sc;
+		as_command_start_timer(cmd);
+	}
+	else {
+		// Split retry mode.  Do not reset timer.
+		cmd->replica_index = parent->replica_index;
+		cmd->replica_index_sc = parent->replica_index_sc;
+		cmd->iteration = parent->iteration;
+		cmd->socket_timeout = parent->socket_timeout;
+		cmd->total_timeout = parent->total_timeout;
+		cmd->max_retries = parent->max_retries;
+		cmd->deadline_ms = parent->deadline_ms;
+		cmd->sent = parent->sent;
+	}
+}
+
+static inline void
+as_batch_builder_set_node(as_batch_builder* bb, as_node* node)
+{
+	bb->batch_any = (node->features & AS_FEATURES_BATCH_ANY);
+}
+
+static inline void
+as_batch_builder_destroy(as_batch_builder* bb)
+{
+	as_buffers_destroy(bb->buffers);
+
+	if (bb->arglist_cached) {
+		as_buffer_destroy(&bb->arglist_buffer);
+	}
+	cf_free(bb->ops_data);
+}
+
+static void
+as_batch_set_doubt_records(as_batch_task_records* btr, as_error* err)
+{
+	if (!err->in_doubt) {
+		return;
+	}
+
+	as_txn* txn = btr->base.txn;
+	uint32_t offsets_size = btr->base.offsets.size;
+
+	for (uint32_t i = 0; i < offsets_size; i++) {
+		uint32_t offset = *(uint32_t*)as_vector_get(&btr->base.offsets, i);
+		as_batch_base_record* rec = as_vector_get(btr->records, offset);
+
+		if (rec->result == AEROSPIKE_NO_RESPONSE && rec->has_write && err->in_doubt) {
+			rec->in_doubt = true;
+
+			if (txn) {
+				as_txn_on_write_in_doubt(txn, rec->key.digest.value, rec->key.set);
+			}
+		}
+	}
+}
+
+static void
+as_batch_set_doubt_keys(as_batch_task_keys* btk, as_error* err)
+{
+	if (!err->in_doubt) {
+		return;
+	}
+
+	as_txn* txn = btk->base.txn;
+	uint32_t offsets_size = btk->base.offsets.size;
+
+	for (uint32_t i = 0; i < offsets_size; i++) {
 		uint32_t offset = *(uint32_t*)as_vector_get(&btk->base.offsets, i);
 		as_batch_result* res = &btk->results[offset];
 
@@ -2119,7 +3114,7 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 
 	as_batch_builder bb = {
 		.defs = btr->defs,
-		.config_bitmap = btr->base.as->config_bitmap,
+		.config_bitmap = btr->config_bitmap,
 		.filter_exp = policy->base.filter_exp,
 		.buffers = &buffers,
 		.txn = btr->base.txn,
@@ -2137,8 +3132,9 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 	}
 
 	// Write command
+	const as_allocator* allocator = &task->as->cluster->allocator;
 	size_t capacity = bb.size;
-	uint8_t* buf = as_command_buffer_init(capacity);
+	uint8_t* buf = as_command_buffer_init_alloc(allocator, capacity);
 	size_t size = as_batch_records_write(policy, btr->records, &task->offsets, &bb, buf);
 
 	if (size > capacity) {
@@ -2150,12 +3146,12 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 		// Compress command.
 		size_t comp_capacity = as_command_compress_max_size(size);
 		size_t comp_size = comp_capacity;
-		uint8_t* comp_buf = as_command_buffer_init(comp_capacity);
-		status = as_command_compress(err, buf, size, comp_buf, &comp_size);
-		as_command_buffer_free(buf, capacity);
+		uint8_t* comp_buf = as_command_buffer_init_alloc(allocator, comp_capacity);
+		status = as_command_compress(err, task->as->cluster, buf, size, comp_buf, &comp_size);
+		as_command_buffer_free_alloc(allocator, buf, capacity);
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(comp_buf, comp_capacity);
+			as_command_buffer_free_alloc(allocator, comp_buf, comp_capacity);
 			return status;
 		}
 		capacity = comp_capacity;
@@ -2176,16 +3172,19 @@ as_batch_execute_records(as_batch_task_records* btr, as_error* err, as_command*
 		as_batch_set_doubt_records(btr, err);
 	}
 
-	as_command_buffer_free(buf, capacity);
+	as_command_buffer_free_alloc(allocator, buf, capacity);
 	return status;
 }
 
 static as_status
 as_batch_keys_size_new(
-	as_key* keys, as_vector* offsets, as_batch_base_record* rec, as_batch_attr* attr,
+	const as_batch_key_src* src, as_vector* offsets, as_batch_base_record* rec, as_batch_attr* attr,
 	as_batch_builder* bb, as_error* err
 	)
 {
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(src, &scratch);
+
 	as_status status;
 	as_key* prev = 0;
 	uint64_t ver_prev = 0;
@@ -2193,7 +3192,7 @@ as_batch_keys_size_new(
 
 	for (uint32_t i = 0; i < n_offsets; i++) {
 		uint32_t offset = *(uint32_t*)as_vector_get(offsets, i);
-		as_key* key = &keys[offset];
+		as_key* key = as_batch_key_at(src, offset, &scratch);
 		uint64_t ver = bb->versions? bb->versions[i] : 0;
 
 		bb->size += AS_DIGEST_VALUE_SIZE + sizeof(uint32_t);
@@ -2254,30 +3253,33 @@ as_batch_keys_size_new(
 
 static as_status
 as_batch_keys_size(
-	as_key* keys, as_vector* offsets, as_batch_base_record* rec, as_batch_attr* attr,
+	const as_batch_key_src* src, as_vector* offsets, as_batch_base_record* rec, as_batch_attr* attr,
 	as_batch_builder* bb, as_error* err
 	)
 {
 	as_batch_init_size(bb);
 
 	if (bb->batch_any) {
-		return as_batch_keys_size_new(keys, offsets, rec, attr, bb, err);
+		return as_batch_keys_size_new(src, offsets, rec, attr, bb, err);
 	}
 	else {
 		if (rec->type != AS_BATCH_READ) {
 			return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
 										"Batch write operations not supported on older servers");
 		}
-		return as_batch_keys_size_old(keys, offsets, (as_batch_read_record*)rec, bb, err);
+		return as_batch_keys_size_old(src, offsets, (as_batch_read_record*)rec, bb, err);
 	}
 }
 
 static size_t
 as_batch_keys_write_new(
-	const as_policy_batch* policy, as_key* keys, as_vector* offsets, as_batch_base_record* rec,
-	as_batch_attr* attr, as_batch_builder* bb, uint8_t* cmd
+	const as_policy_batch* policy, const as_batch_key_src* src, as_vector* offsets,
+	as_batch_base_record* rec, as_batch_attr* attr, as_batch_builder* bb, uint8_t* cmd
 	)
 {
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(src, &scratch);
+
 	uint32_t n_offsets = offsets->size;
 	uint8_t* p = as_batch_header_write_new(cmd, policy, n_offsets, bb);
 
@@ -2296,7 +3298,7 @@ as_batch_keys_write_new(
 		*(uint32_t*)p = cf_swap_to_be32(offset);
 		p += sizeof(uint32_t);
 
-		as_key* key = &keys[offset];
+		as_key* key = as_batch_key_at(src, offset, &scratch);
 		uint64_t ver = bb->versions? bb->versions[i] : 0;
 
 		memcpy(p, key->digest.value, AS_DIGEST_VALUE_SIZE);
@@ -2317,8 +3319,7 @@ as_batch_keys_write_new(
 							(const char**)br->bin_names, br->n_bin_names);
 					}
 					else if (br->ops) {
-						p = as_batch_write_operations(p, key, txn, ver, attr, NULL, br->ops,
-							bb->buffers);
+						p = as_batch_write_operations(p, key, txn, ver, attr, NULL, br->ops, bb);
 					}
 					else {
 						p = as_batch_write_read(p, key, txn, ver, attr, NULL, 0);
@@ -2328,13 +3329,13 @@ as_batch_keys_write_new(
 
 				case AS_BATCH_WRITE: {
 					as_batch_write_record* bw = (as_batch_write_record*)rec;
-					p = as_batch_write_operations(p, key, txn, ver, attr, NULL, bw->ops, bb->buffers);
+					p = as_batch_write_operations(p, key, txn, ver, attr, NULL, bw->ops, bb);
 					break;
 				}
 
 				case AS_BATCH_APPLY: {
 					as_batch_apply_record* ba = (as_batch_apply_record*)rec;
-					p = as_batch_write_udf(p, key, txn, ver, ba, attr, NULL, bb->buffers);
+					p = as_batch_write_udf(p, key, txn, ver, ba, attr, NULL, bb);
 					break;
 				}
 
@@ -2352,15 +3353,15 @@ as_batch_keys_write_new(
 
 static inline size_t
 as_batch_keys_write(
-	const as_policy_batch* policy, as_key* keys, as_vector* offsets, as_batch_base_record* rec,
-	as_batch_attr* attr, as_batch_builder* bb, uint8_t* cmd
+	const as_policy_batch* policy, const as_batch_key_src* src, as_vector* offsets,
+	as_batch_base_record* rec, as_batch_attr* attr, as_batch_builder* bb, uint8_t* cmd
 	)
 {
 	if (bb->batch_any) {
-		return as_batch_keys_write_new(policy, keys, offsets, rec, attr, bb, cmd);
+		return as_batch_keys_write_new(policy, src, offsets, rec, attr, bb, cmd);
 	}
 	else {
-		return as_batch_keys_write_old(policy, keys, offsets, (as_batch_read_record*)rec, attr, bb,
+		return as_batch_keys_write_old(policy, src, offsets, (as_batch_read_record*)rec, attr, bb,
 			cmd);
 	}
 }
@@ -2377,7 +3378,7 @@ as_batch_execute_keys(as_batch_task_keys* btk, as_error* err, as_command* parent
 
 	as_batch_builder bb = {
 		.defs = &config->policies,
-		.config_bitmap = btk->base.as->config_bitmap,
+		.config_bitmap = aerospike_load_config_bitmap(btk->base.as, config),
 		.filter_exp = btk->attr->filter_exp ? btk->attr->filter_exp : policy->base.filter_exp,
 		.buffers = &buffers,
 		.txn = btk->base.txn,
@@ -2387,16 +3388,17 @@ as_batch_execute_keys(as_batch_task_keys* btk, as_error* err, as_command* parent
 
 	as_batch_builder_set_node(&bb, task->node);
 
-	as_status status = as_batch_keys_size(btk->keys, &task->offsets, btk->rec, btk->attr, &bb, err);
+	as_status status = as_batch_keys_size(&btk->src, &task->offsets, btk->rec, btk->attr, &bb, err);
 
 	if (status != AEROSPIKE_OK) {
 		as_batch_builder_destroy(&bb);
 		return status;
 	}
 
+	const as_allocator* allocator = &task->as->cluster->allocator;
 	size_t capacity = bb.size;
-	uint8_t* buf = as_command_buffer_init(capacity);
-	size_t size = as_batch_keys_write(policy, btk->keys, &task->offsets, btk->rec, btk->attr, &bb,
+	uint8_t* buf = as_command_buffer_init_alloc(allocator, capacity);
+	size_t size = as_batch_keys_write(policy, &btk->src, &task->offsets, btk->rec, btk->attr, &bb,
 		buf);
 
 	if (size > capacity) {
@@ -2409,12 +3411,12 @@ as_batch_execute_keys(as_batch_task_keys* btk, as_error* err, as_command* parent
 		// Compress command.
 		size_t comp_capacity = as_command_compress_max_size(size);
 		size_t comp_size = comp_capacity;
-		uint8_t* comp_buf = as_command_buffer_init(comp_capacity);
-		status = as_command_compress(err, buf, size, comp_buf, &comp_size);
-		as_command_buffer_free(buf, capacity);
+		uint8_t* comp_buf = as_command_buffer_init_alloc(allocator, comp_capacity);
+		status = as_command_compress(err, task->as->cluster, buf, size, comp_buf, &comp_size);
+		as_command_buffer_free_alloc(allocator, buf, capacity);
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(comp_buf, comp_capacity);
+			as_command_buffer_free_alloc(allocator, comp_buf, comp_capacity);
 			return status;
 		}
 		capacity = comp_capacity;
@@ -2436,7 +3438,7 @@ as_batch_execute_keys(as_batch_task_keys* btk, as_error* err, as_command* parent
 		as_batch_set_doubt_keys(btk, err);
 	}
 
-	as_command_buffer_free(buf, capacity);
+	as_command_buffer_free_alloc(allocator, buf, capacity);
 	return status;
 }
 
@@ -2454,6 +3456,10 @@ as_read_policy_copy(
 	trg->replica = pb->replica;
 	trg->deserialize = pb->deserialize;
 	trg->async_heap_rec = true; // Ignored in sync commands.
+	trg->zero_copy = false;
+	trg->lazy_deserialize = false;
+	// Single key batch reads are hedged like the batch's node commands.
+	trg->hedge_delay = pb->hedge_delay;
 
 	if (pbr) {
 		if (pbr->filter_exp) {
@@ -2588,6 +3594,13 @@ as_txn_roll_single(
 static void
 as_record_reset(as_record* record, uint32_t capacity)
 {
+	if (record->bins._free) {
+		if (record->bins.capacity >= capacity) {
+			record->bins.size = 0;
+			return;
+		}
+		cf_free(record->bins.entries);
+	}
 	record->bins.capacity = capacity;
 	record->bins.size = 0;
 	record->bins.entries = cf_malloc(sizeof(as_bin) * capacity);
@@ -2738,13 +3751,53 @@ as_single_execute_record(as_batch_task_records* btr, as_error* err)
 	return status;
 }
 
+static as_status
+as_single_execute_flat(as_batch_task_keys* btk, as_error* err, uint32_t offset)
+{
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(&btk->src, &scratch);
+	as_key* key = as_batch_key_at(&btk->src, offset, &scratch);
+
+	as_record rec;
+	as_record_init(&rec, 0);
+
+	as_status status = as_single_execute(&btk->base, err, key, btk->rec, &rec, 0);
+
+	if (status == AEROSPIKE_OK) {
+		btk->flat->status[offset] = AEROSPIKE_OK;
+		as_batch_flat_set_header(btk->flat, offset, rec.gen, rec.ttl);
+	}
+	else {
+		if (as_batch_set_error_row(status)) {
+			*btk->base.error_row = true;
+		}
+
+		// Only server generated errors should change key specific result.
+		if (status > AEROSPIKE_OK && status != AEROSPIKE_ERR_TIMEOUT) {
+			btk->flat->status[offset] = status;
+			status = AEROSPIKE_OK;
+		}
+	}
+	as_record_destroy(&rec);
+	return status;
+}
+
 static as_status
 as_single_execute_key(as_batch_task_keys* btk, as_error* err)
 {
 	uint32_t offset = *(uint32_t*)as_vector_get(&btk->base.offsets, 0);
+
+	if (btk->flat) {
+		return as_single_execute_flat(btk, err, offset);
+	}
+
 	as_batch_result* res = &btk->results[offset];
 
-	as_status status = as_single_execute(&btk->base, err, &btk->keys[offset], btk->rec, &res->record, 0);
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(&btk->src, &scratch);
+	as_key* key = as_batch_key_at(&btk->src, offset, &scratch);
+
+	as_status status = as_single_execute(&btk->base, err, key, btk->rec, &res->record, 0);
 
 	if (status == AEROSPIKE_OK) {
 		res->result = AEROSPIKE_OK;
@@ -2763,6 +3816,14 @@ as_single_execute_key(as_batch_task_keys* btk, as_error* err)
 			status = AEROSPIKE_OK;
 		}
 	}
+
+	if (btk->stream && res->result != AEROSPIKE_NO_RESPONSE) {
+		as_status s = as_batch_stream_result(btk, err, offset);
+
+		if (s != AEROSPIKE_OK) {
+			return s;
+		}
+	}
 	return status;
 }
 
@@ -3085,19 +4146,81 @@ as_batch_worker(void* data)
 	cf_queue_push(task->complete_q, &complete_task);
 }
 
-static as_batch_node*
-as_batch_node_find(as_vector* batch_nodes, as_node* node)
+static uint32_t
+as_batch_largest_node(as_vector* batch_nodes)
 {
 	as_batch_node* batch_node = batch_nodes->list;
+	uint32_t n_batch_nodes = batch_nodes->size;
+	uint32_t index = 0;
+
+	for (uint32_t i = 1; i < n_batch_nodes; i++) {
+		if (batch_node[i].offsets.size > batch_node[index].offsets.size) {
+			index = i;
+		}
+	}
+	return index;
+}
+
+static bool
+as_batch_use_threads(as_cluster* cluster, const as_policy_batch* policy, uint32_t n_keys)
+{
+	bool parallel = true;
+
+	if (policy->concurrent_threshold > 0) {
+		// Run in parallel until a record size estimate is available.
+		uint32_t record_size = as_cluster_get_batch_record_size(cluster);
+
+		if (record_size > 0) {
+			uint64_t cost = (uint64_t)n_keys * record_size;
+			parallel = cost >= policy->concurrent_threshold;
+		}
+	}
+	as_cluster_add_batch_strategy(cluster, parallel);
+	return parallel;
+}
+
+static void
+as_batch_split_nodes(as_vector* batch_nodes, uint32_t max_keys)
+{
+	if (max_keys == 0) {
+		return;
+	}
+
 	uint32_t n_batch_nodes = batch_nodes->size;
 
 	for (uint32_t i = 0; i < n_batch_nodes; i++) {
-		if (batch_node->node == node) {
-			return batch_node;
+		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
+		uint32_t n_offsets = batch_node->offsets.size;
+
+		if (n_offsets <= max_keys) {
+			continue;
+		}
+
+		// The first max_keys offsets stay with the original command. The remaining offsets
+		// are moved to new commands for the same node. Appending to batch_nodes may move
+		// the list, but the original offsets list itself does not move.
+		as_node* node = batch_node->node;
+		uint32_t* offsets = batch_node->offsets.list;
+		batch_node->offsets.size = max_keys;
+
+		for (uint32_t begin = max_keys; begin < n_offsets; begin += max_keys) {
+			uint32_t end = begin + max_keys;
+
+			if (end > n_offsets) {
+				end = n_offsets;
+			}
+
+			as_node_reserve(node);
+			as_batch_node* split = as_vector_reserve(batch_nodes);
+			split->node = node;  // Transfer node
+			split->count = end - begin;
+			as_vector_init(&split->offsets, sizeof(uint32_t), end - begin);
+
+			for (uint32_t j = begin; j < end; j++) {
+				as_vector_append(&split->offsets, &offsets[j]);
+			}
 		}
-		batch_node++;
 	}
-	return NULL;
 }
 
 static void
@@ -3151,6 +4274,10 @@ as_batch_keys_execute_seq(
 	as_status s;
 
 	for (uint32_t i = 0; i < batch_nodes->size; i++) {
+		if (btk->stream && as_load_uint32(btk->stream_abort) != 0) {
+			break;
+		}
+
 		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
 		as_error_init(&e);
 
@@ -3188,15 +4315,15 @@ as_batch_keys_execute_seq(
 #define batch_results_free(_results, _nkeys) if (_nkeys > 5000) {cf_free(_results);}
 
 static as_status
-as_batch_keys_execute(
-	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
-	as_batch_base_record* rec, uint64_t* versions, as_batch_attr* attr, as_batch_listener listener,
+as_batch_src_execute(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_key_src* src,
+	uint32_t n_keys, as_batch_base_record* rec, uint64_t* versions, as_batch_attr* attr,
+	as_batch_listener listener, as_batch_stream_listener stream, as_batch_exists_results* flat,
 	void* udata
 	)
 {
 	as_cluster* cluster = as->cluster;
 	as_cluster_add_command_count(cluster);
-	uint32_t n_keys = batch->keys.size;
 	
 	if (n_keys == 0) {
 		destroy_versions(versions);
@@ -3216,88 +4343,151 @@ as_batch_keys_execute(
 		return as_error_set_message(err, AEROSPIKE_ERR_SERVER, cluster_empty_error);
 	}
 
-	as_batch_result* results = batch_results_init(sizeof(as_batch_result), n_keys);
-
-	as_vector batch_nodes;
-	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
-
-	char* ns = batch->keys.entries[0].ns;
 	as_status status = AEROSPIKE_OK;
-	
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_capacity = n_keys / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
 
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
+	if (src->keys) {
+		// Compute all digests up front, so they can be hashed concurrently.
+		status = as_batch_keys_set_digests(err, src->keys, n_keys);
 
-	as_batch_replica rep;
-	as_batch_replica_init(cluster, &rep, policy, rec->has_write);
+		if (status != AEROSPIKE_OK) {
+			destroy_versions(versions);
+			return status;
+		}
+	}
+
+	// Flat results are written directly to the caller's arrays.
+	as_batch_result* results = flat ? NULL : batch_results_init(sizeof(as_batch_result), n_keys);
+
+	as_vector batch_nodes;
+	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
+
+	as_batch_node_map map;
+	as_batch_node_map_inita(&map, n_nodes);
+
+	const char* ns = src->keys ? src->keys[0].ns :
+		src->digests ? src->digests->ns : src->compact->keys[0].ns;
+
+	// Keys are grouped in two passes. The first pass records each key's node and counts keys
+	// per node. The second pass fills offsets that were allocated with exact capacity.
+	uint32_t* key_nodes = (n_keys <= BATCH_STACK_KEYS)?
+		alloca(sizeof(uint32_t) * n_keys) : cf_malloc(sizeof(uint32_t) * n_keys);
+
+	as_batch_replica rep;
+	as_batch_replica_init(cluster, &rep, policy, rec->has_write);
 
 	bool error_row = false;
 
+	// Duplicate read keys are sent once. Their results are copied after the batch completes.
+	// Streamed results are delivered as they arrive, so they are not deduplicated.
+	as_batch_dedup dd;
+	dd.dups = NULL;
+
+	if (policy->dedup_keys && ! rec->has_write && ! stream && n_keys > 1) {
+		as_batch_dedup_init(&dd, cf_malloc(sizeof(uint32_t) * n_keys), n_keys);
+	}
+
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(src, &scratch);
+
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < n_keys; i++) {
-		as_key* key = &batch->keys.entries[i];
+		as_key* key = as_batch_key_at(src, i, &scratch);
 
-		as_batch_result* result = &results[i];
-		result->key = key;
-		result->result = AEROSPIKE_NO_RESPONSE;
-		result->in_doubt = false;
-		as_record_init(&result->record, 0);
+		if (flat) {
+			flat->status[i] = AEROSPIKE_NO_RESPONSE;
+		}
+		else {
+			as_batch_result* result = &results[i];
+			result->key = src->keys ? key : NULL;
+			result->result = AEROSPIKE_NO_RESPONSE;
+			result->in_doubt = false;
+			as_record_init(&result->record, 0);
+		}
 
-		status = as_key_set_digest(err, key);
-		
-		if (status != AEROSPIKE_OK) {
-			destroy_versions(versions);
-			batch_results_free(results, n_keys);
-			as_batch_release_nodes(&batch_nodes);
-			return status;
+		if (dd.dups) {
+			const char* key_ns;
+			const uint8_t* digest;
+			as_batch_key_src_id(src, i, &key_ns, &digest);
+
+			as_batch_dedup_slot* slot = as_batch_dedup_add(&dd, key_ns, digest, i);
+
+			if (slot) {
+				as_batch_dedup_set(&dd, i, slot->offset);
+				key_nodes[i] = BATCH_NODE_NONE;
+				continue;
+			}
 		}
 
 		as_node* node;
-		status = as_batch_get_node(cluster, key, &rep, rec->has_write, NULL, &node);
+		status = as_batch_get_node(cluster, key, &rep, rec->has_write, NULL, &batch_nodes, &map,
+			&node);
 
 		if (status != AEROSPIKE_OK) {
-			result->result = status;
+			if (flat) {
+				flat->status[i] = status;
+			}
+			else {
+				results[i].result = status;
+			}
 			error_row = true;
+			key_nodes[i] = BATCH_NODE_NONE;
 			continue;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
-		
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
+		key_nodes[i] = as_batch_assign_node(&map, &batch_nodes, node);
+	}
 
-			if (n_keys <= 5000) {
-				// All keys and offsets should fit on stack.
-				as_vector_inita(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
-			else {
-				// Allocate vector on heap to avoid stack overflow.
-				as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
+	for (uint32_t i = 0; i < batch_nodes.size; i++) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
+
+		if (n_keys <= BATCH_STACK_KEYS) {
+			// All keys and offsets should fit on stack.
+			as_vector_inita(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
+		}
+		else {
+			// Allocate vector on heap to avoid stack overflow.
+			as_vector_init(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
 		}
-		as_vector_append(&batch_node->offsets, &i);
+	}
+	as_batch_distribute_keys(&batch_nodes, key_nodes, NULL, n_keys);
+	as_batch_node_map_destroy(&map);
+
+	if (n_keys > BATCH_STACK_KEYS) {
+		cf_free(key_nodes);
+	}
+
+	if (dd.dups) {
+		as_batch_dedup_release(&dd);
 	}
 
 	// Fatal if no key requests were generated on initialization.
 	if (batch_nodes.size == 0) {
 		destroy_versions(versions);
 
+		if (dd.dups) {
+			as_batch_dedup_keys_complete(&dd, results, flat, n_keys);
+		}
+
 		if (listener) {
 			listener(results, n_keys, udata);
 		}
-		batch_results_free(results, n_keys);
+		else if (stream) {
+			for (uint32_t i = 0; i < n_keys; i++) {
+				if (! stream(i, &results[i], udata)) {
+					break;
+				}
+			}
+		}
+		if (results) {
+			batch_results_free(results, n_keys);
+		}
 		return as_error_set_message(err, AEROSPIKE_BATCH_FAILED, "Batch failed");
 	}
 
+	as_batch_split_nodes(&batch_nodes, policy->max_keys_per_node_command);
+
 	uint32_t error_mutex = 0;
+	uint32_t stream_abort = 0;
 
 	// Initialize task.
 	as_batch_task_keys btk;
@@ -3318,19 +4508,26 @@ as_batch_keys_execute(
 	btk.base.replica_index_sc = rep.replica_index_sc;
 	btk.base.txn_attr = attr->txn_attr;
 	btk.ns = ns;
-	btk.keys = batch->keys.entries;
-	btk.batch = batch;
+	btk.src = *src;
 	btk.results = results;
+	btk.flat = flat;
 	btk.listener = listener;
+	btk.stream = stream;
+	btk.delivered = stream ? cf_calloc(n_keys, sizeof(uint8_t)) : NULL;
+	btk.stream_abort = &stream_abort;
 	btk.udata = udata;
 	btk.rec = rec;
 	btk.attr = attr;
 
-	if (policy->concurrent && batch_nodes.size > 1) {
+	if (policy->concurrent && batch_nodes.size > 1 && as_batch_use_threads(cluster, policy, n_keys)) {
 		// Run batch requests in parallel in separate threads.
 		btk.base.complete_q = cf_queue_create(sizeof(as_batch_complete_task), true);
 		
 		uint32_t n_wait_nodes = 0;
+
+		// The largest node command is run in this thread instead of waiting idle.
+		uint32_t inline_index = as_batch_largest_node(&batch_nodes);
+		as_batch_task_keys* btk_inline = NULL;
 		
 		// Run task for each node.
 		for (uint32_t i = 0; i < batch_nodes.size; i++) {
@@ -3343,7 +4540,13 @@ as_batch_keys_execute(
 			btk_node->base.node = batch_node->node;
 			memcpy(&btk_node->base.offsets, &batch_node->offsets, sizeof(as_vector));
 
-			int rc = as_thread_pool_queue_task(&cluster->thread_pool, as_batch_worker, btk_node);
+			if (i == inline_index) {
+				btk_inline = btk_node;
+				continue;
+			}
+
+			int rc = as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_HIGH,
+				as_batch_worker, btk_node);
 			
 			if (rc == 0) {
 				n_wait_nodes++;
@@ -3357,6 +4560,10 @@ as_batch_keys_execute(
 			}
 		}
 		
+		// Run remaining task after all other tasks have been queued.
+		as_batch_worker(btk_inline);
+		n_wait_nodes++;
+
 		// Wait for tasks to complete.
 		for (uint32_t i = 0; i < n_wait_nodes; i++) {
 			as_batch_complete_task complete;
@@ -3379,17 +4586,41 @@ as_batch_keys_execute(
 	as_batch_release_nodes(&batch_nodes);
 	destroy_versions(versions);
 
+	if (dd.dups) {
+		as_batch_dedup_keys_complete(&dd, results, flat, n_keys);
+	}
+
 	// Call user defined function with results.
 	if (listener) {
 		listener(btk.results, n_keys, udata);
 	}
+	else if (stream) {
+		if (as_load_uint32(&stream_abort) == 0) {
+			// Deliver keys that did not receive a response. These keys either could not be
+			// mapped to a node or their node command failed.
+			for (uint32_t i = 0; i < n_keys; i++) {
+				if (! btk.delivered[i] && ! stream(i, &btk.results[i], udata)) {
+					break;
+				}
+			}
+		}
+		else {
+			// If user aborts stream, command is considered successful.
+			as_error_reset(err);
+			status = AEROSPIKE_OK;
+			error_row = false;
+		}
+		cf_free(btk.delivered);
+	}
 
 	// Destroy records. User is responsible for destroying keys with as_batch_destroy().
-	for (uint32_t i = 0; i < n_keys; i++) {
-		as_batch_result* br = &btk.results[i];
-		as_record_destroy(&br->record);
+	if (results) {
+		for (uint32_t i = 0; i < n_keys; i++) {
+			as_batch_result* br = &btk.results[i];
+			as_record_destroy(&br->record);
+		}
+		batch_results_free(results, n_keys);
 	}
-	batch_results_free(results, n_keys);
 
 	if (status == AEROSPIKE_OK && error_row) {
 		return as_error_set_message(err, AEROSPIKE_BATCH_FAILED,
@@ -3398,6 +4629,22 @@ as_batch_keys_execute(
 	return status;
 }
 
+static inline as_status
+as_batch_keys_execute(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	as_batch_base_record* rec, uint64_t* versions, as_batch_attr* attr, as_batch_listener listener,
+	as_batch_stream_listener stream, as_batch_exists_results* flat, void* udata
+	)
+{
+	as_batch_key_src src = {
+		.keys = batch->keys.entries,
+		.digests = NULL,
+		.compact = NULL
+	};
+	return as_batch_src_execute(as, err, policy, &src, batch->keys.size, rec, versions, attr,
+		listener, stream, flat, udata);
+}
+
 static as_status
 as_batch_execute_sync(
 	aerospike* as, as_error* err, const as_policy_batch* policy, as_txn* txn, uint64_t* versions,
@@ -3431,15 +4678,21 @@ as_batch_execute_sync(
 	btr.base.replica_index_sc = rep->replica_index_sc;
 	btr.base.txn_attr = txn_attr;
 	btr.defs = defs;
+	btr.config_bitmap = aerospike_load_config_bitmap(as, config);
 	btr.records = records;
 
 	as_cluster* cluster = as->cluster;
 
-	if (policy->concurrent && n_batch_nodes > 1 && parent == NULL) {
+	if (policy->concurrent && n_batch_nodes > 1 && parent == NULL &&
+		as_batch_use_threads(cluster, policy, n_keys)) {
 		// Run batch requests in parallel in separate threads.
 		btr.base.complete_q = cf_queue_create(sizeof(as_batch_complete_task), true);
 		
 		uint32_t n_wait_nodes = 0;
+
+		// The largest node command is run in this thread instead of waiting idle.
+		uint32_t inline_index = as_batch_largest_node(batch_nodes);
+		as_batch_task_records* btr_inline = NULL;
 		
 		// Run task for each node.
 		for (uint32_t i = 0; i < n_batch_nodes; i++) {
@@ -3452,7 +4705,13 @@ as_batch_execute_sync(
 			btr_node->base.node = batch_node->node;
 			memcpy(&btr_node->base.offsets, &batch_node->offsets, sizeof(as_vector));
 
-			int rc = as_thread_pool_queue_task(&cluster->thread_pool, as_batch_worker, btr_node);
+			if (i == inline_index) {
+				btr_inline = btr_node;
+				continue;
+			}
+
+			int rc = as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_HIGH,
+				as_batch_worker, btr_node);
 
 			if (rc == 0) {
 				n_wait_nodes++;
@@ -3466,6 +4725,10 @@ as_batch_execute_sync(
 			}
 		}
 		
+		// Run remaining task after all other tasks have been queued.
+		as_batch_worker(btr_inline);
+		n_wait_nodes++;
+
 		// Wait for tasks to complete.
 		for (uint32_t i = 0; i < n_wait_nodes; i++) {
 			as_batch_complete_task complete;
@@ -3528,14 +4791,17 @@ as_batch_command_create(
 	// Allocate enough memory to cover, then, round up memory size in 8KB increments to reduce
 	// fragmentation and to allow socket read to reuse buffer.
 	size_t s = (sizeof(as_async_batch_command) + size + AS_AUTHENTICATION_MAX_SIZE + 8191) & ~8191;
-	as_async_batch_command* bc = cf_malloc(s);
+	as_event_loop* event_loop = executor->executor.spread ?
+		as_event_assign_node(NULL, node) : executor->executor.event_loop;
+	as_async_batch_command* bc = (as_async_batch_command*)as_event_command_alloc(cluster,
+		event_loop, &s);
 	as_event_command* cmd = &bc->command;
 	cmd->total_deadline = policy->base.total_timeout;
 	cmd->socket_timeout = policy->base.socket_timeout;
 	cmd->max_retries = policy->base.max_retries;
 	cmd->iteration = 0;
 	cmd->replica = rep->replica;
-	cmd->event_loop = executor->executor.event_loop;
+	cmd->event_loop = event_loop;
 	cmd->cluster = cluster;
 	cmd->node = node;
 	cmd->ns = NULL;
@@ -3559,12 +4825,213 @@ as_batch_command_create(
 	cmd->replica_index = rep->replica_index;
 	cmd->replica_index_sc = rep->replica_index_sc;
 	cmd->txn = executor->txn;
+	cmd->cancel = policy->base.cancel;
+	cmd->priority = (uint8_t)policy->base.priority;
+	cmd->latency_tag = policy->base.latency_tag;
+	cmd->limited = false;
+	cmd->adaptive_timeout_pct = 0;
 	cmd->ubuf = ubuf;
 	cmd->ubuf_size = ubuf_size;
 	cmd->latency_type = AS_LATENCY_TYPE_BATCH;
+	cmd->hedge = AS_ASYNC_HEDGE_NONE;
 	return bc;
 }
 
+// Create a node command with its send buffer written. The node is transferred to the command
+// on success only.
+static as_status
+as_batch_command_build(
+	as_cluster* cluster, as_error* err, const as_policy_batch* policy, as_batch_replica* rep,
+	as_vector* records, as_batch_node* batch_node, as_batch_builder* bb,
+	as_async_batch_executor* executor, uint8_t flags, as_event_command** cmd_pp
+	)
+{
+	as_batch_builder_set_node(bb, batch_node->node);
+
+	// Estimate buffer size.
+	as_status status = as_batch_records_size(records, &batch_node->offsets, bb, err);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (! (policy->base.compress && bb->size > AS_COMPRESS_THRESHOLD)) {
+		// Send uncompressed command.
+		as_async_batch_command* bc = as_batch_command_create(cluster, policy, rep,
+			batch_node->node, executor, bb->size, flags, NULL, 0);
+
+		as_event_command* cmd = &bc->command;
+
+		cmd->write_len = (uint32_t)as_batch_records_write(policy, records, &batch_node->offsets, bb,
+			cmd->buf);
+
+		if (cmd->write_len > bb->size) {
+			as_log_warn("Batch command buffer size %u exceeded capacity %zu", cmd->write_len, bb->size);
+		}
+		*cmd_pp = cmd;
+		return AEROSPIKE_OK;
+	}
+
+	// Send compressed command.
+	// First write uncompressed buffer.
+	size_t capacity = bb->size;
+	uint8_t* ubuf = cf_malloc(capacity);
+	size_t size = as_batch_records_write(policy, records, &batch_node->offsets, bb, ubuf);
+
+	// Allocate command with compressed upper bound.
+	size_t comp_size = as_command_compress_max_size(size);
+
+	as_async_batch_command* bc = as_batch_command_create(cluster, policy, rep,
+		batch_node->node, executor, comp_size, flags, ubuf, (uint32_t)size);
+
+	as_event_command* cmd = &bc->command;
+
+	// Compress buffer.
+	status = as_command_compress(err, cmd->cluster, ubuf, size, cmd->buf, &comp_size);
+
+	if (status != AEROSPIKE_OK) {
+		cf_free(ubuf);
+		as_event_command_dealloc(cmd);
+		return status;
+	}
+	cmd->write_len = (uint32_t)comp_size;
+	*cmd_pp = cmd;
+	return AEROSPIKE_OK;
+}
+
+typedef struct {
+	as_async_batch_executor* executor;
+	uint32_t n_cmds;
+	as_event_command* cmds[];
+} as_batch_hedge_start;
+
+static void
+as_batch_hedge_start_in_loop(as_event_loop* event_loop, as_batch_hedge_start* start)
+{
+	as_async_batch_executor* be = start->executor;
+	as_event_executor* exec = &be->executor;
+	uint32_t n_cmds = start->n_cmds;
+
+	for (uint32_t i = 0; i < n_cmds; i++) {
+		as_batch_hedge_link(be, start->cmds[i], AS_ASYNC_HEDGE_ORIGINAL);
+	}
+
+	// Hedge delay timer. Callback is as_event_process_timer() in hedge state.
+	size_t s = sizeof(as_event_command);
+	as_event_command* timer = as_event_command_alloc(start->cmds[0]->cluster, event_loop, &s);
+	timer->event_loop = event_loop;
+	timer->cluster = start->cmds[0]->cluster;
+	timer->node = NULL;
+	timer->udata = be;
+	timer->ubuf = NULL;
+	timer->type = AS_ASYNC_TYPE_BATCH;
+	timer->state = AS_ASYNC_STATE_HEDGE;
+	timer->flags = 0;
+	timer->budget_size = 0;
+	timer->hedge = AS_ASYNC_HEDGE_NONE;
+	be->hedge_timer = timer;
+	as_event_timer_once(timer, be->hedge_delay);
+
+	for (uint32_t i = 0; i < n_cmds; i++) {
+		as_event_command* cmd = start->cmds[i];
+		as_error err;
+
+		if (as_event_command_execute(cmd, &err) != AEROSPIKE_OK) {
+			// Current command was destroyed. Destroy commands that were not started.
+			for (uint32_t j = i + 1; j < n_cmds; j++) {
+				as_event_command_destroy(start->cmds[j]);
+			}
+			as_event_executor_error(exec, &err, n_cmds - i);
+			break;
+		}
+	}
+	cf_free(start);
+}
+
+// Build all node commands before any of them are started, so the hedged batch can be linked
+// and its hedge delay timer started in the event loop thread. The start is queued even when
+// called from the event loop thread.
+static as_status
+as_batch_execute_hedge_async(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_replica* rep,
+	as_vector* records, as_vector* batch_nodes, as_async_batch_executor* executor,
+	as_batch_builder* bb, uint8_t flags
+	)
+{
+	uint32_t n_batch_nodes = batch_nodes->size;
+	as_event_executor* exec = &executor->executor;
+	as_batch_hedge_start* start = cf_malloc(sizeof(as_batch_hedge_start) +
+		sizeof(as_event_command*) * n_batch_nodes);
+	uint32_t n_cmds = 0;
+
+	start->executor = executor;
+
+	for (uint32_t i = 0; i < n_batch_nodes; i++) {
+		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
+
+		if (batch_node->offsets.size == 1) {
+			// Single key commands are hedged by the read policy.
+			continue;
+		}
+
+		as_status status = as_batch_command_build(as->cluster, err, policy, rep, records,
+			batch_node, bb, executor, flags, &start->cmds[n_cmds]);
+
+		if (status != AEROSPIKE_OK) {
+			for (uint32_t j = 0; j < n_cmds; j++) {
+				as_event_command_destroy(start->cmds[j]);
+			}
+
+			// Release single key command nodes that were skipped.
+			for (uint32_t j = 0; j < i; j++) {
+				as_batch_node* bn = as_vector_get(batch_nodes, j);
+
+				if (bn->offsets.size == 1) {
+					as_node_release(bn->node);
+				}
+			}
+			cf_free(start);
+			as_event_executor_cancel(exec, 0);
+			as_batch_release_nodes_cancel_async(batch_nodes, i);
+			return status;
+		}
+		executor->unanswered += batch_node->offsets.size;
+		n_cmds++;
+	}
+
+	uint32_t n_single = 0;
+
+	for (uint32_t i = 0; i < n_batch_nodes; i++) {
+		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
+
+		if (batch_node->offsets.size == 1) {
+			as_single_execute_record_async(as, err, executor, policy, records, batch_node);
+			n_single++;
+		}
+	}
+
+	if (n_cmds == 0) {
+		cf_free(start);
+		return AEROSPIKE_OK;
+	}
+
+	start->n_cmds = n_cmds;
+
+	as_event_loop* event_loop = exec->event_loop;
+
+	if (! as_event_execute(event_loop, (as_event_executable)as_batch_hedge_start_in_loop, start)) {
+		event_loop->errors++;  // May not be in event loop thread, so not exactly accurate.
+
+		for (uint32_t i = 0; i < n_cmds; i++) {
+			as_event_command_destroy(start->cmds[i]);
+		}
+		cf_free(start);
+		as_event_executor_cancel(exec, n_single);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
+	}
+	return AEROSPIKE_OK;
+}
+
 static as_status
 as_batch_execute_async(
 	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_replica* rep,
@@ -3592,7 +5059,7 @@ as_batch_execute_async(
 
 	as_batch_builder bb = {
 		.defs = &config->policies,
-		.config_bitmap = as->config_bitmap,
+		.config_bitmap = aerospike_load_config_bitmap(as, config),
 		.filter_exp = policy->base.filter_exp,
 		.buffers = &buffers,
 		.txn = executor->txn,
@@ -3602,6 +5069,14 @@ as_batch_execute_async(
 
 	as_status status = AEROSPIKE_OK;
 
+	if (executor->hedge_delay) {
+		status = as_batch_execute_hedge_async(as, err, policy, rep, records, batch_nodes,
+			executor, &bb, flags);
+		as_batch_builder_destroy(&bb);
+		as_batch_release_nodes_after_async(batch_nodes);
+		return status;
+	}
+
 	for (uint32_t i = 0; i < n_batch_nodes; i++) {
 		as_batch_node* batch_node = as_vector_get(batch_nodes, i);
 
@@ -3609,61 +5084,18 @@ as_batch_execute_async(
 			as_single_execute_record_async(as, err, executor, policy, records, batch_node);
 		}
 		else {
-			as_batch_builder_set_node(&bb, batch_node->node);
+			as_event_command* cmd;
 
-			// Estimate buffer size.
-			status = as_batch_records_size(records, &batch_node->offsets, &bb, err);
+			status = as_batch_command_build(as->cluster, err, policy, rep, records, batch_node,
+				&bb, executor, flags, &cmd);
 
 			if (status != AEROSPIKE_OK) {
 				as_event_executor_cancel(exec, i);
+				// Current node not released, so start at current node.
 				as_batch_release_nodes_cancel_async(batch_nodes, i);
 				break;
 			}
-
-			if (! (policy->base.compress && bb.size > AS_COMPRESS_THRESHOLD)) {
-				// Send uncompressed command.
-				as_async_batch_command* bc = as_batch_command_create(as->cluster, policy, rep,
-					batch_node->node, executor, bb.size, flags, NULL, 0);
-
-				as_event_command* cmd = &bc->command;
-
-				cmd->write_len = (uint32_t)as_batch_records_write(policy, records, &batch_node->offsets, &bb,
-					cmd->buf);
-
-				if (cmd->write_len > bb.size) {
-					as_log_warn("Batch command buffer size %u exceeded capacity %zu", cmd->write_len, bb.size);
-				}
-				status = as_event_command_execute(cmd, err);
-			}
-			else {
-				// Send compressed command.
-				// First write uncompressed buffer.
-				size_t capacity = bb.size;
-				uint8_t* ubuf = cf_malloc(capacity);
-				size_t size = as_batch_records_write(policy, records, &batch_node->offsets, &bb, ubuf);
-
-				// Allocate command with compressed upper bound.
-				size_t comp_size = as_command_compress_max_size(size);
-
-				as_async_batch_command* bc = as_batch_command_create(as->cluster, policy, rep,
-					batch_node->node, executor, comp_size, flags, ubuf, (uint32_t)size);
-
-				as_event_command* cmd = &bc->command;
-
-				// Compress buffer and execute.
-				status = as_command_compress(err, ubuf, size, cmd->buf, &comp_size);
-
-				if (status != AEROSPIKE_OK) {
-					as_event_executor_cancel(exec, i);
-					// Current node not released, so start at current node.
-					as_batch_release_nodes_cancel_async(batch_nodes, i);
-					cf_free(ubuf);
-					cf_free(cmd);
-					break;
-				}
-				cmd->write_len = (uint32_t)comp_size;
-				status = as_event_command_execute(cmd, err);
-			}
+			status = as_event_command_execute(cmd, err);
 		}
 
 		if (status != AEROSPIKE_OK) {
@@ -3721,76 +5153,127 @@ as_batch_records_execute(
 		as_batch_records_cleanup(versions, async_executor, NULL);
 		return as_error_set_message(err, AEROSPIKE_ERR_SERVER, cluster_empty_error);
 	}
+
+	// Compute all digests up front, so they can be hashed concurrently.
+	as_status status = as_batch_records_set_digests(err, records);
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_records_cleanup(versions, async_executor, NULL);
+		return status;
+	}
 	
 	as_vector batch_nodes;
 	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
 
-	as_status status = AEROSPIKE_OK;
-	
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_capacity = n_keys / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
-	
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
-	
+	as_batch_node_map map;
+	as_batch_node_map_inita(&map, n_nodes);
+
+	// Keys are grouped in two passes. The first pass records each key's node and counts keys
+	// per node. The second pass fills offsets that were allocated with exact capacity.
+	uint32_t* key_nodes = (n_keys <= BATCH_STACK_KEYS)?
+		alloca(sizeof(uint32_t) * n_keys) : cf_malloc(sizeof(uint32_t) * n_keys);
+
 	as_batch_replica rep;
 	as_batch_replica_init(cluster, &rep, policy, has_write);
 
 	bool error_row = false;
 
+	// Duplicate read records are sent once. Their results are copied after the batch
+	// completes. Async executors reserve duplicate offsets when dedup applies.
+	as_batch_dedup dd;
+	dd.dups = NULL;
+
+	if (async_executor) {
+		if (async_executor->dups) {
+			as_batch_dedup_init(&dd, async_executor->dups, n_keys);
+		}
+	}
+	else if (policy->dedup_keys && ! has_write && n_keys > 1) {
+		as_batch_dedup_init(&dd, cf_malloc(sizeof(uint32_t) * n_keys), n_keys);
+	}
+
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < n_keys; i++) {
 		as_batch_base_record* rec = as_vector_get(list, i);
 		as_key* key = &rec->key;
 		
 		rec->result = AEROSPIKE_NO_RESPONSE;
-		as_record_init(&rec->record, 0);
-		
-		status = as_key_set_digest(err, key);
-		
-		if (status != AEROSPIKE_OK) {
-			as_batch_records_cleanup(versions, async_executor, &batch_nodes);
-			return status;
+
+		if (rec->retained) {
+			// Keep bin capacity for this command only. Records must be reset again before the
+			// next command.
+			rec->retained = false;
+		}
+		else {
+			as_record_init(&rec->record, 0);
+		}
+
+		if (dd.dups && rec->type == AS_BATCH_READ) {
+			as_batch_dedup_slot* slot = as_batch_dedup_add(&dd, key->ns, key->digest.value, i);
+
+			// Only reads that select the same bins and policy share a result.
+			if (slot && as_batch_equals_read(as_vector_get(list, slot->offset),
+				(as_batch_read_record*)rec)) {
+				as_batch_dedup_set(&dd, i, slot->offset);
+				key_nodes[i] = BATCH_NODE_NONE;
+				continue;
+			}
 		}
 		
 		as_node* node;
-		status = as_batch_get_node(cluster, key, &rep, rec->has_write, NULL, &node);
+		status = as_batch_get_node(cluster, key, &rep, rec->has_write, NULL, &batch_nodes, &map,
+			&node);
 
 		if (status != AEROSPIKE_OK) {
 			rec->result = status;
 			error_row = true;
+			key_nodes[i] = BATCH_NODE_NONE;
 			continue;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
-		
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
-			
-			if (n_keys <= 5000) {
-				// All keys and offsets should fit on stack.
-				as_vector_inita(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
-			else {
-				// Allocate vector on heap to avoid stack overflow.
-				as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-			}
+		key_nodes[i] = as_batch_assign_node(&map, &batch_nodes, node);
+	}
+
+	for (uint32_t i = 0; i < batch_nodes.size; i++) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
+
+		if (n_keys <= BATCH_STACK_KEYS) {
+			// All keys and offsets should fit on stack.
+			as_vector_inita(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
+		}
+		else {
+			// Allocate vector on heap to avoid stack overflow.
+			as_vector_init(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
+		}
+	}
+	as_batch_distribute_keys(&batch_nodes, key_nodes, NULL, n_keys);
+	as_batch_node_map_destroy(&map);
+
+	if (n_keys > BATCH_STACK_KEYS) {
+		cf_free(key_nodes);
+	}
+
+	if (dd.dups) {
+		as_batch_dedup_release(&dd);
+
+		if (async_executor && dd.count == 0) {
+			// Skip copying results on completion.
+			async_executor->dups = NULL;
 		}
-		as_vector_append(&batch_node->offsets, &i);
 	}
 
 	// Fatal if no key requests were generated on initialization.
 	if (batch_nodes.size == 0) {
+		if (dd.dups && ! async_executor) {
+			as_batch_dedup_records_complete(dd.dups, list);
+			cf_free(dd.dups);
+		}
 		as_batch_records_cleanup(versions, async_executor, NULL);
 		return as_error_set_message(err, AEROSPIKE_BATCH_FAILED, "Batch failed");
 	}
 
+	as_batch_split_nodes(&batch_nodes, policy->max_keys_per_node_command);
+
 	if (async_executor) {
 		async_executor->error_row = error_row;
 		return as_batch_execute_async(as, err, policy, &rep, list, &batch_nodes, async_executor);
@@ -3801,6 +5284,13 @@ as_batch_records_execute(
 
 		destroy_versions(versions);
 
+		if (dd.dups) {
+			if (dd.count > 0) {
+				as_batch_dedup_records_complete(dd.dups, list);
+			}
+			cf_free(dd.dups);
+		}
+
 		if (status != AEROSPIKE_OK) {
 			return status;
 		}
@@ -3816,8 +5306,9 @@ as_batch_records_execute(
 static as_status
 as_batch_records_execute_async(
 	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
-	as_txn* txn, uint64_t* versions, as_async_batch_listener listener, void* udata,
-	as_event_loop* event_loop, uint8_t txn_attr, bool has_write
+	as_txn* txn, uint64_t* versions, as_async_batch_listener listener,
+	as_async_batch_progress_listener progress, void* udata, as_event_loop* event_loop,
+	uint8_t txn_attr, bool has_write
 	)
 {
 	as_cluster_add_command_count(as->cluster);
@@ -3829,12 +5320,38 @@ as_batch_records_execute_async(
 	}
 	
 	// Batch will be split up into a command for each node.
-	// Allocate batch data shared by each command.
-	as_async_batch_executor* be = cf_malloc(sizeof(as_async_batch_executor));
+	// Allocate batch data shared by each command. Progress state is placed after the executor,
+	// so it is freed with the executor.
+	uint32_t n_records = records->list.size;
+	size_t progress_size = progress ? (sizeof(uint32_t) + sizeof(uint8_t)) * n_records : 0;
+
+	// Progress listeners receive rows as they are parsed, so duplicates are not skipped.
+	bool dedup = policy->dedup_keys && ! progress && ! has_write && n_records > 1;
+	size_t dedup_size = dedup ? sizeof(uint32_t) * n_records : 0;
+
+	as_async_batch_executor* be = cf_malloc(sizeof(as_async_batch_executor) + progress_size +
+		dedup_size);
 	be->records = records;
 	be->txn = txn;
 	be->versions = versions;
 	be->listener = listener;
+	be->progress = progress;
+
+	if (progress) {
+		be->progress_indexes = (uint32_t*)(be + 1);
+		be->progress_state = (uint8_t*)(be->progress_indexes + n_records);
+		memset(be->progress_state, BATCH_ROW_PENDING, n_records);
+	}
+	else {
+		be->progress_indexes = NULL;
+		be->progress_state = NULL;
+	}
+	be->dups = dedup ? (uint32_t*)(be + 1) : NULL;
+	be->hedge_cmds = NULL;
+	be->hedge_timer = NULL;
+	// Rows of hedged batches are claimed once, so progress listeners are not hedged.
+	be->hedge_delay = (! has_write && ! txn && ! progress) ? policy->hedge_delay : 0;
+	be->unanswered = 0;
 	// replica/replica_sc are set later in as_batch_execute_async().
 	be->read_mode_sc = policy->read_mode_sc;
 	be->txn_attr = txn_attr;
@@ -3849,13 +5366,22 @@ as_batch_records_execute_async(
 	exec->udata = udata;
 	exec->err = NULL;
 	exec->ns = NULL;
+	exec->flow = NULL;
+	exec->paused = NULL;
 	exec->cluster_key = 0;
 	exec->max_concurrent = 0;
 	exec->max = 0;
 	exec->count = 0;
 	exec->queued = 0;
+	exec->n_paused = 0;
 	exec->notify = true;
 	exec->valid = true;
+	exec->adaptive = false;
+	// Progress listeners are called from the node command's event loop, so they keep the
+	// batch on one event loop. Hedged node commands share rows, so they also run on one
+	// event loop.
+	exec->spread = policy->spread_event_loops && ! progress && ! be->hedge_delay &&
+		as_event_loop_size > 1;
 
 	return as_batch_records_execute(as, err, policy, records, txn, versions, be, txn_attr, has_write);
 }
@@ -3881,26 +5407,25 @@ as_batch_retry_records(as_batch_task_records* btr, as_command* parent, as_error*
 	as_vector batch_nodes;
 	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
 
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_size = task->offsets.size;
-	uint32_t offsets_capacity = offsets_size / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
+	as_batch_node_map map;
+	as_batch_node_map_inita(&map, n_nodes);
 
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
+	uint32_t offsets_size = task->offsets.size;
+	uint32_t* offsets = task->offsets.list;
+	uint32_t* key_nodes = cf_malloc(sizeof(uint32_t) * offsets_size);
 
 	as_batch_replica rep;
 	rep.replica = task->replica;
 	rep.replica_sc = task->replica_sc;
 	rep.replica_index = parent->replica_index;
 	rep.replica_index_sc = parent->replica_index_sc;
+	rep.rack_balance = false;
 
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < offsets_size; i++) {
-		uint32_t offset = *(uint32_t*)as_vector_get(&task->offsets, i);
+		uint32_t offset = offsets[i];
 		as_batch_read_record* rec = as_vector_get(btr->records, offset);
+		key_nodes[i] = BATCH_NODE_NONE;
 
 		if (rec->result != AEROSPIKE_NO_RESPONSE) {
 			// Do not retry keys that already have a response.
@@ -3910,7 +5435,8 @@ as_batch_retry_records(as_batch_task_records* btr, as_command* parent, as_error*
 		as_key* key = &rec->key;
 
 		as_node* node;
-		as_status status = as_batch_get_node(cluster, key, &rep, rec->has_write, parent->node, &node);
+		as_status status = as_batch_get_node(cluster, key, &rep, rec->has_write, parent->node,
+			NULL, NULL, &node);
 
 		if (status != AEROSPIKE_OK) {
 			rec->result = status;
@@ -3918,29 +5444,30 @@ as_batch_retry_records(as_batch_task_records* btr, as_command* parent, as_error*
 			continue;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
+		key_nodes[i] = as_batch_assign_node(&map, &batch_nodes, node);
+	}
 
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
+	for (uint32_t i = 0; i < batch_nodes.size; i++) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
 
-			// Allocate vector on heap to avoid stack overflow.
-			as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-		}
-		as_vector_append(&batch_node->offsets, &offset);
+		// Allocate vector on heap to avoid stack overflow.
+		as_vector_init(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
 	}
+	as_batch_distribute_keys(&batch_nodes, key_nodes, offsets, offsets_size);
+	as_batch_node_map_destroy(&map);
+	cf_free(key_nodes);
 
 	if (batch_nodes.size == 0) {
-		return AEROSPIKE_USE_NORMAL_RETRY;
+		// All keys received a response before the failure.
+		as_error_reset(err);
+		return AEROSPIKE_OK;
 	}
 
 	if (batch_nodes.size == 1) {
 		as_batch_node* batch_node = as_vector_get(&batch_nodes, 0);
 
-		if (batch_node->node == task->node) {
-			// Batch node is the same.
+		if (batch_node->node == task->node && batch_node->offsets.size == offsets_size) {
+			// Batch node and keys are the same.
 			as_batch_release_nodes(&batch_nodes);
 			return AEROSPIKE_USE_NORMAL_RETRY;
 		}
@@ -3972,63 +5499,71 @@ as_batch_retry_keys(as_batch_task_keys* btk, as_command* parent, as_error* err)
 
 	as_status status = AEROSPIKE_OK;
 
-	// Create initial key capacity for each node as average + 25%.
-	uint32_t offsets_size = task->offsets.size;
-	uint32_t offsets_capacity = offsets_size / n_nodes;
-	offsets_capacity += offsets_capacity >> 2;
+	as_batch_node_map map;
+	as_batch_node_map_inita(&map, n_nodes);
 
-	// The minimum key capacity is 10.
-	if (offsets_capacity < 10) {
-		offsets_capacity = 10;
-	}
+	uint32_t offsets_size = task->offsets.size;
+	uint32_t* offsets = task->offsets.list;
+	uint32_t* key_nodes = cf_malloc(sizeof(uint32_t) * offsets_size);
 
 	as_batch_replica rep;
 	rep.replica = task->replica;
 	rep.replica_sc = task->replica_sc;
 	rep.replica_index = parent->replica_index;
 	rep.replica_index_sc = parent->replica_index_sc;
+	rep.rack_balance = false;
 
 	as_batch_base_record* rec = btk->rec;
 
+	as_batch_key_scratch scratch;
+	as_batch_key_scratch_init(&btk->src, &scratch);
+
 	// Map keys to server nodes.
 	for (uint32_t i = 0; i < offsets_size; i++) {
-		uint32_t offset = *(uint32_t*)as_vector_get(&task->offsets, i);
-		as_key* key = &btk->batch->keys.entries[offset];
-		as_batch_result* res = &btk->results[offset];
+		uint32_t offset = offsets[i];
+		as_key* key = as_batch_key_at(&btk->src, offset, &scratch);
+		key_nodes[i] = BATCH_NODE_NONE;
 
-		if (res->result != AEROSPIKE_NO_RESPONSE) {
+		if (as_batch_keys_get_result(btk, offset) != AEROSPIKE_NO_RESPONSE) {
 			// Do not retry keys that already have a response.
 			continue;
 		}
 
 		as_node* node;
-		status = as_batch_get_node(cluster, key, &rep, rec->has_write, parent->node, &node);
+		status = as_batch_get_node(cluster, key, &rep, rec->has_write, parent->node, NULL, NULL,
+			&node);
 
 		if (status != AEROSPIKE_OK) {
-			res->result = status;
+			as_batch_keys_set_result(btk, offset, status);
 			*task->error_row = true;
 			continue;
 		}
 
-		as_batch_node* batch_node = as_batch_node_find(&batch_nodes, node);
+		key_nodes[i] = as_batch_assign_node(&map, &batch_nodes, node);
+	}
 
-		if (! batch_node) {
-			// Add batch node.
-			as_node_reserve(node);
-			batch_node = as_vector_reserve(&batch_nodes);
-			batch_node->node = node;  // Transfer node
+	for (uint32_t i = 0; i < batch_nodes.size; i++) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
 
-			// Allocate vector on heap to avoid stack overflow.
-			as_vector_init(&batch_node->offsets, sizeof(uint32_t), offsets_capacity);
-		}
-		as_vector_append(&batch_node->offsets, &offset);
+		// Allocate vector on heap to avoid stack overflow.
+		as_vector_init(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
+	}
+	as_batch_distribute_keys(&batch_nodes, key_nodes, offsets, offsets_size);
+	as_batch_node_map_destroy(&map);
+	cf_free(key_nodes);
+
+	if (batch_nodes.size == 0) {
+		// All keys received a response before the failure.
+		as_vector_destroy(&batch_nodes);
+		as_error_reset(err);
+		return AEROSPIKE_OK;
 	}
 
 	if (batch_nodes.size == 1) {
 		as_batch_node* batch_node = as_vector_get(&batch_nodes, 0);
 
-		if (batch_node->node == task->node) {
-			// Batch node is the same.
+		if (batch_node->node == task->node && batch_node->offsets.size == offsets_size) {
+			// Batch node and keys are the same.
 			as_batch_release_nodes(&batch_nodes);
 			return AEROSPIKE_USE_NORMAL_RETRY;
 		}
@@ -4049,14 +5584,11 @@ as_status
 as_batch_retry(as_command* parent, as_error* err)
 {
 	// Retry requires keys for this node to be split among other nodes.
-	// This is both recursive and exponential.
+	// This is both recursive and exponential. Keys that already received a response are not
+	// sent again, so a retry to the same node only includes the remaining keys. Master only
+	// replicas are also remapped because partitions may have migrated.
 	as_batch_task* task = parent->udata;
 
-	if (task->replica == AS_POLICY_REPLICA_MASTER) {
-		// Node assignment will not change.
-		return AEROSPIKE_USE_NORMAL_RETRY;
-	}
-
 	if (err->code != AEROSPIKE_ERR_TIMEOUT ||
 		task->policy->read_mode_sc != AS_POLICY_READ_MODE_SC_LINEARIZE) {
 		parent->replica_index_sc++;
@@ -4070,6 +5602,262 @@ as_batch_retry(as_command* parent, as_error* err)
 	}
 }
 
+//---------------------------------
+// Hedge Functions
+//---------------------------------
+
+// Sync command that sends the keys of a slow batch node command to one of their next
+// replicas. The task is a copy of the original task with the hedge node and offsets.
+typedef struct as_batch_hedge_s {
+	as_command cmd;
+	union {
+		as_batch_task base;
+		as_batch_task_records records;
+		as_batch_task_keys keys;
+	} task;
+	size_t capacity;
+} as_batch_hedge;
+
+static as_status
+as_batch_hedge_write(as_batch_hedge* h, as_error* err)
+{
+	as_batch_task* task = &h->task.base;
+	const as_policy_batch* policy = task->policy;
+	as_config* config = aerospike_load_config(task->as);
+
+	as_queue buffers;
+	as_queue_inita(&buffers, sizeof(as_buffer), 8);
+
+	as_batch_builder bb = {
+		.defs = &config->policies,
+		.config_bitmap = aerospike_load_config_bitmap(task->as, config),
+		.filter_exp = policy->base.filter_exp,
+		.buffers = &buffers,
+		.txn = task->txn,
+		.versions = task->versions,
+		.txn_attr = task->txn_attr
+	};
+
+	as_batch_builder_set_node(&bb, task->node);
+
+	as_batch_task_records* btr = &h->task.records;
+	as_batch_task_keys* btk = &h->task.keys;
+	as_status status;
+
+	if (task->type == BATCH_TYPE_RECORDS) {
+		bb.defs = btr->defs;
+		bb.config_bitmap = btr->config_bitmap;
+		status = as_batch_records_size(btr->records, &task->offsets, &bb, err);
+	}
+	else {
+		if (btk->attr->filter_exp) {
+			bb.filter_exp = btk->attr->filter_exp;
+		}
+		status = as_batch_keys_size(&btk->src, &task->offsets, btk->rec, btk->attr, &bb, err);
+	}
+
+	if (status != AEROSPIKE_OK) {
+		as_batch_builder_destroy(&bb);
+		return status;
+	}
+
+	// Hedge buffers outlive this function, so they are always allocated on the heap.
+	const as_allocator* allocator = &task->as->cluster->allocator;
+	size_t capacity = bb.size;
+	uint8_t* buf = as_command_buffer_get_alloc(allocator, capacity);
+	size_t size;
+
+	if (task->type == BATCH_TYPE_RECORDS) {
+		size = as_batch_records_write(policy, btr->records, &task->offsets, &bb, buf);
+	}
+	else {
+		size = as_batch_keys_write(policy, &btk->src, &task->offsets, btk->rec, btk->attr, &bb,
+			buf);
+	}
+	as_batch_builder_destroy(&bb);
+
+	if (policy->base.compress && size > AS_COMPRESS_THRESHOLD) {
+		size_t comp_capacity = as_command_compress_max_size(size);
+		size_t comp_size = comp_capacity;
+		uint8_t* comp_buf = as_command_buffer_get_alloc(allocator, comp_capacity);
+		status = as_command_compress(err, task->as->cluster, buf, size, comp_buf, &comp_size);
+		as_command_buffer_put_alloc(allocator, buf, capacity);
+
+		if (status != AEROSPIKE_OK) {
+			as_command_buffer_put_alloc(allocator, comp_buf, comp_capacity);
+			return status;
+		}
+		capacity = comp_capacity;
+		buf = comp_buf;
+		size = comp_size;
+	}
+
+	h->cmd.buf = buf;
+	h->cmd.buf_size = size;
+	h->capacity = capacity;
+	return AEROSPIKE_OK;
+}
+
+void
+as_batch_hedge_destroy(as_command** hedges, uint32_t n_hedges)
+{
+	for (uint32_t i = 0; i < n_hedges; i++) {
+		as_batch_hedge* h = (as_batch_hedge*)hedges[i];
+
+		if (h->cmd.buf) {
+			as_command_buffer_put_alloc(&h->task.base.as->cluster->allocator, h->cmd.buf,
+				h->capacity);
+		}
+		as_node_release(h->task.base.node);
+		as_vector_destroy(&h->task.base.offsets);
+		cf_free(h);
+	}
+	cf_free(hedges);
+}
+
+// Create commands that send the unanswered keys of a sync batch node command to their next
+// replicas. Return NULL if the keys can not be hedged, for example when a key's next replica
+// is the same node.
+as_command**
+as_batch_hedge_create(as_command* parent, uint32_t* n_hedges)
+{
+	as_batch_task* task = parent->udata;
+
+	if (task->type == BATCH_TYPE_KEYS && ((as_batch_task_keys*)task)->stream) {
+		// Streamed results are delivered while they are parsed.
+		return NULL;
+	}
+
+	as_cluster* cluster = task->as->cluster;
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t n_nodes = nodes->size;
+	as_nodes_release(nodes);
+
+	if (n_nodes <= 1) {
+		return NULL;
+	}
+
+	as_vector batch_nodes;
+	as_vector_inita(&batch_nodes, sizeof(as_batch_node), n_nodes);
+
+	as_batch_node_map map;
+	as_batch_node_map_inita(&map, n_nodes);
+
+	uint32_t offsets_size = task->offsets.size;
+	uint32_t* offsets = task->offsets.list;
+	uint32_t* key_nodes = cf_malloc(sizeof(uint32_t) * offsets_size);
+
+	// Target the next replica after the node command's current replica.
+	as_batch_replica rep;
+	rep.replica = task->replica;
+	rep.replica_sc = task->replica_sc;
+	rep.replica_index = parent->replica_index + 1;
+	rep.replica_index_sc = parent->replica_index_sc + 1;
+	rep.rack_balance = false;
+
+	as_batch_key_scratch scratch;
+
+	if (task->type == BATCH_TYPE_KEYS) {
+		as_batch_key_scratch_init(&((as_batch_task_keys*)task)->src, &scratch);
+	}
+
+	bool hedge = true;
+
+	for (uint32_t i = 0; i < offsets_size; i++) {
+		uint32_t offset = offsets[i];
+		as_key* key;
+		key_nodes[i] = BATCH_NODE_NONE;
+
+		if (task->type == BATCH_TYPE_RECORDS) {
+			as_batch_base_record* rec = as_vector_get(((as_batch_task_records*)task)->records,
+				offset);
+
+			if (rec->result != AEROSPIKE_NO_RESPONSE) {
+				continue;
+			}
+			key = &rec->key;
+		}
+		else {
+			as_batch_task_keys* btk = (as_batch_task_keys*)task;
+
+			if (as_batch_keys_get_result(btk, offset) != AEROSPIKE_NO_RESPONSE) {
+				continue;
+			}
+			key = as_batch_key_at(&btk->src, offset, &scratch);
+		}
+
+		as_node* node;
+		as_status status = as_batch_get_node(cluster, key, &rep, false, parent->node, NULL, NULL,
+			&node);
+
+		if (status != AEROSPIKE_OK || node == parent->node) {
+			// Every unanswered key must be hedged, because the original connection is closed
+			// when a hedge command wins.
+			hedge = false;
+			break;
+		}
+		key_nodes[i] = as_batch_assign_node(&map, &batch_nodes, node);
+	}
+
+	for (uint32_t i = 0; i < batch_nodes.size; i++) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
+		as_vector_init(&batch_node->offsets, sizeof(uint32_t), batch_node->count);
+	}
+
+	if (hedge) {
+		as_batch_distribute_keys(&batch_nodes, key_nodes, offsets, offsets_size);
+	}
+	as_batch_node_map_destroy(&map);
+	cf_free(key_nodes);
+
+	if (! hedge || batch_nodes.size == 0) {
+		as_batch_release_nodes(&batch_nodes);
+		return NULL;
+	}
+
+	size_t task_size = (task->type == BATCH_TYPE_RECORDS)?
+		sizeof(as_batch_task_records) : sizeof(as_batch_task_keys);
+	uint32_t n = batch_nodes.size;
+	as_command** hedges = cf_malloc(sizeof(as_command*) * n);
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_batch_node* batch_node = as_vector_get(&batch_nodes, i);
+		as_batch_hedge* h = cf_malloc(sizeof(as_batch_hedge));
+
+		memcpy(&h->task, task, task_size);
+		h->task.base.node = batch_node->node;  // Transfer node
+		h->task.base.offsets = batch_node->offsets;  // Transfer offsets
+		h->cmd.buf = NULL;
+		hedges[i] = &h->cmd;
+
+		as_error err;
+
+		if (as_batch_hedge_write(h, &err) != AEROSPIKE_OK) {
+			as_log_debug("Batch hedge failed: %d %s", err.code, err.message);
+			// Release remaining nodes and offsets that were not transferred.
+			for (uint32_t j = i + 1; j < n; j++) {
+				batch_node = as_vector_get(&batch_nodes, j);
+				as_node_release(batch_node->node);
+				as_vector_destroy(&batch_node->offsets);
+			}
+			as_vector_destroy(&batch_nodes);
+			as_batch_hedge_destroy(hedges, i + 1);
+			return NULL;
+		}
+
+		uint8_t* buf = h->cmd.buf;
+		size_t size = h->cmd.buf_size;
+		as_batch_command_init(&h->cmd, &h->task.base, task->policy, buf, size, parent);
+		h->cmd.replica_index = rep.replica_index;
+		h->cmd.replica_index_sc = rep.replica_index_sc;
+		h->cmd.flags &= ~AS_COMMAND_FLAGS_HEDGE;
+	}
+	as_vector_destroy(&batch_nodes);
+
+	*n_hedges = n;
+	return hedges;
+}
+
 static inline as_async_batch_command*
 as_batch_retry_command_create(
 	as_event_command* parent, as_node* node, as_batch_replica* rep, size_t size, uint64_t deadline,
@@ -4079,7 +5867,8 @@ as_batch_retry_command_create(
 	// Allocate enough memory to cover, then, round up memory size in 8KB increments to reduce
 	// fragmentation and to allow socket read to reuse buffer.
 	size_t s = (sizeof(as_async_batch_command) + size + AS_AUTHENTICATION_MAX_SIZE + 8191) & ~8191;
-	as_async_batch_command* bc = cf_malloc(s);
+	as_async_batch_command* bc = (as_async_batch_command*)as_event_command_alloc(parent->cluster,
+		parent->event_loop, &s);
 	as_event_command* cmd = &bc->command;
 	cmd->total_deadline = deadline;
 	cmd->socket_timeout = parent->socket_timeout;
@@ -4107,27 +5896,18 @@ as_batch_retry_command_create(
 	cmd->replica_index = rep->replica_index;
 	cmd->replica_index_sc = rep->replica_index_sc;
 	cmd->txn = parent->txn;
+	cmd->cancel = parent->cancel;
+	cmd->priority = parent->priority;
+	cmd->latency_tag = parent->latency_tag;
+	cmd->limited = false;
+	cmd->adaptive_timeout_pct = 0;
 	cmd->ubuf = ubuf;
 	cmd->ubuf_size = ubuf_size;
 	cmd->latency_type = AS_LATENCY_TYPE_BATCH;
+	cmd->hedge = AS_ASYNC_HEDGE_NONE;
 	return bc;
 }
 
-static as_batch_retry_node*
-as_batch_retry_node_find(as_vector* bnodes, as_node* node)
-{
-	as_batch_retry_node* bnode = bnodes->list;
-	uint32_t n_bnodes = bnodes->size;
-
-	for (uint32_t i = 0; i < n_bnodes; i++) {
-		if (bnode->node == node) {
-			return bnode;
-		}
-		bnode++;
-	}
-	return NULL;
-}
-
 static size_t
 as_batch_retry_write(
 	uint8_t* buf, uint8_t* header, uint32_t header_size, uint8_t header_flags, uint8_t* batch_field,
@@ -4253,32 +6033,22 @@ as_batch_retry_parse_row(uint8_t* p, uint8_t* type)
 	return p;
 }
 
-int
-as_batch_retry_async(as_event_command* parent, bool timeout)
-{
-	as_async_batch_executor* be = parent->udata; // udata is overloaded to contain executor.
-
-	if (parent->replica == AS_POLICY_REPLICA_MASTER) {
-		// Node assignment will not change. Go through normal retry.
-		return 1;
-	}
-
-	as_cluster* cluster = parent->cluster;
-	as_nodes* nodes = as_nodes_reserve(cluster);
-	uint32_t n_nodes = nodes->size;
-	as_nodes_release(nodes);
-
-	if (n_nodes == 0) {
-		return 1;  // Go through normal retry.
-	}
-
-	if (! timeout || (!be->has_write && be->read_mode_sc != AS_POLICY_READ_MODE_SC_LINEARIZE)) {
-		parent->replica_index++;
-	}
+// Batch index fields of an async node command's send buffer.
+typedef struct {
+	uint8_t* header;
+	uint8_t* batch_field;
+	uint8_t* rows;
+	uint32_t header_size;
+	uint32_t n_offsets;
+	uint8_t header_flags;
+} as_batch_retry_buf;
 
+static bool
+as_batch_retry_buf_init(as_batch_retry_buf* rb, as_event_command* cmd)
+{
 	// Batch offsets, read/write operations and other arguments are out of scope in async batch
-	// retry, so they must be parsed from the parent command's send buffer.
-	uint8_t* header = as_event_get_ubuf(parent);
+	// retry, so they must be parsed from the command's send buffer.
+	uint8_t* header = as_event_get_ubuf(cmd);
 	uint8_t* p = header;
 
 	p += AS_HEADER_SIZE;
@@ -4291,58 +6061,58 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 	// Field ID must be AS_FIELD_BATCH_INDEX at this point.
 	if (*(p + sizeof(uint32_t)) != AS_FIELD_BATCH_INDEX) {
 		as_log_error("Batch retry buffer is corrupt");
-		return -2;  // Defer to original error.
+		return false;
 	}
 
-	uint8_t* batch_field = p;
+	rb->header = header;
+	rb->batch_field = p;
 	p += AS_FIELD_HEADER_SIZE;
 
-	uint32_t header_size = (uint32_t)(p - header);
-	uint32_t n_offsets = cf_swap_from_be32(*(uint32_t*)p);
+	rb->header_size = (uint32_t)(p - header);
+	rb->n_offsets = cf_swap_from_be32(*(uint32_t*)p);
 	p += sizeof(uint32_t);
 
-	uint8_t header_flags = *p++;
+	rb->header_flags = *p++;
+	rb->rows = p;
+	return true;
+}
 
-	as_vector bnodes;
-	as_vector_inita(&bnodes, sizeof(as_batch_retry_node), n_nodes);
+// Map keys without a response to nodes and distribute their rows to bnodes. Retry keys that
+// can not be mapped are set to the mapping error. Hedge keys that can not be mapped or map to
+// the parent's node are skipped.
+static void
+as_batch_retry_map(
+	as_event_command* parent, as_batch_retry_buf* rb, as_batch_replica* rep, bool hedge,
+	uint32_t n_nodes, as_vector* bnodes
+	)
+{
+	as_async_batch_executor* be = parent->udata; // udata is overloaded to contain executor.
+	as_cluster* cluster = parent->cluster;
+	uint32_t n_offsets = rb->n_offsets;
+	uint8_t* p = rb->rows;
 
-	as_batch_replica rep;
-	rep.replica = be->replica;
-	rep.replica_sc = be->replica_sc;
-	rep.replica_index = parent->replica_index;
-	rep.replica_index_sc = parent->replica_index_sc;
+	as_batch_node_map map;
+	as_batch_node_map_inita(&map, n_nodes);
 
-	as_vector* records = &be->records->list;
+	as_batch_retry_row* rows = cf_malloc(sizeof(as_batch_retry_row) * n_offsets);
 
-	as_batch_retry_offset full = {0};
-	as_batch_retry_offset off;
+	as_vector* records = &be->records->list;
 
-	// Map keys to server nodes.
+	// Map keys to server nodes and count rows per node.
 	for (uint32_t i = 0; i < n_offsets; i++) {
-		off.begin = p;
-		off.copy = NULL;
+		as_batch_retry_row* row = &rows[i];
+		row->off.begin = p;
+		row->off.copy = NULL;
+		row->index = BATCH_NODE_NONE;
 
 		uint32_t offset = cf_swap_from_be32(*(uint32_t*)p);
 
-		uint8_t type;
-		p = as_batch_retry_parse_row(p, &type);
+		p = as_batch_retry_parse_row(p, &row->type);
 
-		off.size = (uint32_t)(p - off.begin);
+		row->off.size = (uint32_t)(p - row->off.begin);
 
 		as_batch_base_record* rec = as_vector_get(records, offset);
 
-		if (type != BATCH_MSG_REPEAT) {
-			// Full message.
-			full.size = off.size;
-			full.begin = off.begin;
-
-			// Disallow repeat on new nodes.
-			for (uint32_t j = 0; j < bnodes.size; j++) {
-				as_batch_retry_node* bn = as_vector_get(&bnodes, j);
-				bn->can_repeat = false;
-			}
-		}
-
 		if (rec->result != AEROSPIKE_NO_RESPONSE) {
 			// Do not retry keys that already have a response.
 			continue;
@@ -4351,54 +6121,214 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 		as_key* key = &rec->key;
 		as_node* node;
 
-		as_status status = as_batch_get_node(cluster, key, &rep, rec->has_write, parent->node, &node);
+		as_status status = as_batch_get_node(cluster, key, rep, rec->has_write, parent->node,
+			NULL, NULL, &node);
 
-		if (status != AEROSPIKE_OK) {
+		if (hedge) {
+			if (status != AEROSPIKE_OK || node == parent->node) {
+				// Key stays with the parent command only.
+				continue;
+			}
+		}
+		else if (status != AEROSPIKE_OK) {
 			rec->result = status;
 			be->error_row = true;
+
+			if (parent->hedge) {
+				be->unanswered--;
+			}
 			continue;
 		}
 
-		as_batch_retry_node* bnode = as_batch_retry_node_find(&bnodes, node);
+		uint32_t index = as_batch_node_map_find(&map, node);
 
-		if (! bnode) {
+		if (index == BATCH_NODE_NONE) {
 			// Add batch node.
+			index = bnodes->size;
 			as_node_reserve(node);
-			bnode = as_vector_reserve(&bnodes);
+			as_batch_retry_node* bnode = as_vector_reserve(bnodes);
 			bnode->node = node;  // Transfer node
-			bnode->size = header_size + 5;  // Add n_offsets(4) + flags(1) to header.
-			as_vector_init(&bnode->offsets, sizeof(as_batch_retry_offset), n_offsets);
+			bnode->size = rb->header_size + 5;  // Add n_offsets(4) + flags(1) to header.
+			bnode->count = 0;
+			bnode->full_id = UINT32_MAX;
+			as_batch_node_map_add(&map, node, index);
 		}
 
+		as_batch_retry_node* bnode = as_vector_get(bnodes, index);
+		bnode->count++;
+		row->index = index;
+	}
+	as_batch_node_map_destroy(&map);
+
+	for (uint32_t i = 0; i < bnodes->size; i++) {
+		as_batch_retry_node* bnode = as_vector_get(bnodes, i);
+		as_vector_init(&bnode->offsets, sizeof(as_batch_retry_offset), bnode->count);
+	}
+
+	as_batch_retry_offset full = {0};
+	uint32_t full_id = 0;
+
+	// Distribute rows to their nodes in the original order, so repeat rows can reference
+	// the last full message sent to the same node.
+	for (uint32_t i = 0; i < n_offsets; i++) {
+		as_batch_retry_row* row = &rows[i];
+		as_batch_retry_offset off = row->off;
+		uint8_t type = row->type;
+
+		if (type != BATCH_MSG_REPEAT) {
+			// Full message.
+			full.size = off.size;
+			full.begin = off.begin;
+
+			// Disallow repeat on nodes that have not received this full message.
+			full_id++;
+		}
+
+		if (row->index == BATCH_NODE_NONE) {
+			continue;
+		}
+
+		as_batch_retry_node* bnode = as_vector_get(bnodes, row->index);
+
 		if (type != BATCH_MSG_REPEAT) {
 			// Full message. Allow repeat on assigned node.
 			// full size/begin has already been set.
-			bnode->can_repeat = true;
+			bnode->full_id = full_id;
 		}
 		else {
 			// Repeat message.
-			if (!bnode->can_repeat) {
+			if (bnode->full_id != full_id) {
 				// Copy last full message.
 				off.copy = full.begin;
 				off.size = full.size;
 
 				// Allow repeat on assigned node.
-				bnode->can_repeat = true;
+				bnode->full_id = full_id;
 			}
 		}
 		bnode->size += off.size;
 		as_vector_append(&bnode->offsets, &off);
 	}
+	cf_free(rows);
+}
 
-	if (bnodes.size == 0) {
+// Create and schedule a command for each bnode. The executor must already count the commands.
+static void
+as_batch_retry_send(
+	as_event_command* parent, as_batch_retry_buf* rb, as_batch_replica* rep, as_vector* bnodes,
+	uint64_t deadline, uint8_t hedge
+	)
+{
+	as_async_batch_executor* be = parent->udata; // udata is overloaded to contain executor.
+	as_event_executor* e = &be->executor;
+
+	uint8_t flags = parent->flags &
+		(AS_ASYNC_FLAGS_READ | AS_ASYNC_FLAGS_DESERIALIZE | AS_ASYNC_FLAGS_HEAP_REC);
+
+	for (uint32_t i = 0; i < bnodes->size; i++) {
+		as_batch_retry_node* bnode = as_vector_get(bnodes, i);
+		as_event_command* cmd;
+
+		if (! (parent->ubuf && bnode->size > AS_COMPRESS_THRESHOLD)) {
+			as_async_batch_command* bc = as_batch_retry_command_create(parent, bnode->node, rep,
+				bnode->size, deadline, flags, NULL, 0);
+
+			cmd = &bc->command;
+
+			cmd->write_len = (uint32_t)as_batch_retry_write(cmd->buf, rb->header, rb->header_size,
+				rb->header_flags, rb->batch_field, &bnode->offsets);
+		}
+		else {
+			// Send compressed command.
+			// First write uncompressed buffer.
+			size_t capacity = bnode->size;
+			uint8_t* ubuf = cf_malloc(capacity);
+			size_t size = as_batch_retry_write(ubuf, rb->header, rb->header_size,
+				rb->header_flags, rb->batch_field, &bnode->offsets);
+
+			// Allocate command with compressed upper bound.
+			size_t comp_size = as_command_compress_max_size(bnode->size);
+
+			as_async_batch_command* bc = as_batch_retry_command_create(parent, bnode->node, rep,
+				comp_size, deadline, flags, ubuf, (uint32_t)size);
+
+			cmd = &bc->command;
+
+			// Compress buffer and execute.
+			as_error err;
+			as_status status = as_command_compress(&err, cmd->cluster, ubuf, size, cmd->buf,
+				&comp_size);
+
+			if (status != AEROSPIKE_OK) {
+				as_event_executor_error(e, &err, bnodes->size - i);
+				// Current node not released, so start at current node.
+				as_batch_retry_release_nodes_cancel_async(bnodes, i);
+				cf_free(ubuf);
+				as_event_command_dealloc(cmd);
+				break;
+			}
+			cmd->write_len = (uint32_t)comp_size;
+		}
+
+		if (hedge) {
+			as_batch_hedge_link(be, cmd, hedge);
+		}
+
+		// Retry command at the end of the queue so other commands have a chance to run first.
+		as_event_command_schedule(cmd);
+	}
+	as_batch_retry_release_nodes_after_async(bnodes);
+}
+
+int
+as_batch_retry_async(as_event_command* parent, bool timeout)
+{
+	as_async_batch_executor* be = parent->udata; // udata is overloaded to contain executor.
+	as_cluster* cluster = parent->cluster;
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t n_nodes = nodes->size;
+	as_nodes_release(nodes);
+
+	if (n_nodes == 0) {
 		return 1;  // Go through normal retry.
 	}
 
+	if (! timeout || (!be->has_write && be->read_mode_sc != AS_POLICY_READ_MODE_SC_LINEARIZE)) {
+		parent->replica_index++;
+	}
+
+	as_batch_retry_buf rb;
+
+	if (! as_batch_retry_buf_init(&rb, parent)) {
+		return -2;  // Defer to original error.
+	}
+
+	as_vector bnodes;
+	as_vector_inita(&bnodes, sizeof(as_batch_retry_node), n_nodes);
+
+	as_batch_replica rep;
+	rep.replica = be->replica;
+	rep.replica_sc = be->replica_sc;
+	rep.replica_index = parent->replica_index;
+	rep.replica_index_sc = parent->replica_index_sc;
+	rep.rack_balance = false;
+
+	as_batch_retry_map(parent, &rb, &rep, false, n_nodes, &bnodes);
+
+	if (bnodes.size == 0) {
+		// All keys received a response before the failure. Complete this node command.
+		as_vector_destroy(&bnodes);
+		as_event_timer_stop(parent);
+		as_event_command_release(parent);
+		as_event_executor_complete(&be->executor);
+		return 0;
+	}
+
 	if (bnodes.size == 1) {
 		as_batch_retry_node* bnode = as_vector_get(&bnodes, 0);
 
-		if (bnode->node == parent->node) {
-			// Batch node is the same.  Go through normal retry.
+		if (bnode->node == parent->node && bnode->offsets.size == rb.n_offsets) {
+			// Batch node and keys are the same.  Go through normal retry.
 			as_batch_retry_release_nodes(&bnodes);
 			return 1;  // Go through normal retry.
 		}
@@ -4429,102 +6359,174 @@ as_batch_retry_async(as_event_command* parent, bool timeout)
 	e->queued = e->max;
 	pthread_mutex_unlock(&e->lock);
 
-	uint8_t flags = parent->flags &
-		(AS_ASYNC_FLAGS_READ | AS_ASYNC_FLAGS_DESERIALIZE | AS_ASYNC_FLAGS_HEAP_REC);
+	as_batch_retry_send(parent, &rb, &rep, &bnodes, deadline, parent->hedge);
 
-	for (uint32_t i = 0; i < bnodes.size; i++) {
-		as_batch_retry_node* bnode = as_vector_get(&bnodes, i);
+	// Close parent command.
+	as_event_timer_stop(parent);
+	as_event_command_release(parent);
+	return 0;  // Split retry was initiated.
+}
 
-		if (! (parent->ubuf && bnode->size > AS_COMPRESS_THRESHOLD)) {
-			as_async_batch_command* bc = as_batch_retry_command_create(parent, bnode->node, &rep,
-				bnode->size, deadline, flags, NULL, 0);
+//---------------------------------
+// Async Hedge Functions
+//---------------------------------
 
-			as_event_command* cmd = &bc->command;
+// Send keys of a node command that have no response to their next replicas.
+static void
+as_batch_hedge_command_async(as_event_command* parent, uint32_t n_nodes)
+{
+	as_async_batch_executor* be = parent->udata; // udata is overloaded to contain executor.
+	uint64_t deadline = parent->total_deadline;
 
-			cmd->write_len = (uint32_t)as_batch_retry_write(cmd->buf, header, header_size,
-				header_flags, batch_field, &bnode->offsets);
+	if (deadline > 0) {
+		// Convert deadline back to timeout.
+		uint64_t now = cf_getms();
 
-			// Retry command at the end of the queue so other commands have a chance to run first.
-			as_event_command_schedule(cmd);
+		if (deadline <= now) {
+			// Node command is about to time out.
+			return;
 		}
-		else {
-			// Send compressed command.
-			// First write uncompressed buffer.
-			size_t capacity = bnode->size;
-			uint8_t* ubuf = cf_malloc(capacity);
-			size_t size = as_batch_retry_write(ubuf, header, header_size, header_flags, batch_field,
-				&bnode->offsets);
+		deadline -= now;
+	}
 
-			// Allocate command with compressed upper bound.
-			size_t comp_size = as_command_compress_max_size(bnode->size);
+	as_batch_retry_buf rb;
 
-			as_async_batch_command* bc = as_batch_retry_command_create(parent, bnode->node, &rep,
-				comp_size, deadline, flags, ubuf, (uint32_t)size);
+	if (! as_batch_retry_buf_init(&rb, parent)) {
+		return;
+	}
 
-			as_event_command* cmd = &bc->command;
+	as_vector bnodes;
+	as_vector_inita(&bnodes, sizeof(as_batch_retry_node), n_nodes);
 
-			// Compress buffer and execute.
-			as_error err;
-			as_status status = as_command_compress(&err, ubuf, size, cmd->buf, &comp_size);
+	// Target the next replica after the node command's current replica.
+	as_batch_replica rep;
+	rep.replica = be->replica;
+	rep.replica_sc = be->replica_sc;
+	rep.replica_index = parent->replica_index + 1;
+	rep.replica_index_sc = parent->replica_index_sc + 1;
+	rep.rack_balance = false;
 
-			if (status != AEROSPIKE_OK) {
-				as_event_executor_error(e, &err, bnodes.size - i);
-				// Current node not released, so start at current node.
-				as_batch_retry_release_nodes_cancel_async(&bnodes, i);
-				cf_free(ubuf);
-				cf_free(bc);
-				break;
-			}
-			cmd->write_len = (uint32_t)comp_size;
+	as_batch_retry_map(parent, &rb, &rep, true, n_nodes, &bnodes);
 
-			// Retry command at the end of the queue so other commands have a chance to run first.
-			as_event_command_schedule(cmd);
-		}
+	if (bnodes.size == 0) {
+		as_vector_destroy(&bnodes);
+		return;
 	}
-	as_batch_retry_release_nodes_after_async(&bnodes);
 
-	// Close parent command.
-	as_event_timer_stop(parent);
-	as_event_command_release(parent);
-	return 0;  // Split retry was initiated.
+	as_cluster_add_hedge(parent->cluster);
+
+	as_event_executor* e = &be->executor;
+	pthread_mutex_lock(&e->lock);
+	e->max += bnodes.size;
+	e->max_concurrent = e->max;
+	e->queued = e->max;
+	pthread_mutex_unlock(&e->lock);
+
+	as_batch_retry_send(parent, &rb, &rep, &bnodes, deadline, AS_ASYNC_HEDGE_DUPLICATE);
 }
 
+// Hedge delay timer of a batch expired. Hedge node commands that are still running.
 void
-as_async_batch_error(as_event_command* cmd, as_error* err)
+as_batch_hedge_async(as_event_command* timer)
 {
-	as_async_batch_executor* be = cmd->udata;  // udata is overloaded to contain executor.
+	as_async_batch_executor* be = timer->udata; // udata is overloaded to contain executor.
+	as_cluster* cluster = timer->cluster;
 
-	be->error_row = true;
+	be->hedge_timer = NULL;
+	timer->state = AS_ASYNC_STATE_QUEUE_ERROR;
+	as_event_command_release(timer);
 
-	if (!err->in_doubt) {
+	if (! be->executor.valid) {
 		return;
 	}
 
-	// Set error/in_doubt in each key contained in the command.
-	// Batch offsets are out of scope, so they must be parsed
-	// from the parent command's send buffer.
-	uint8_t* p = as_event_get_ubuf(cmd);
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t n_nodes = nodes->size;
+	as_nodes_release(nodes);
 
-	p += AS_HEADER_SIZE;
+	if (n_nodes <= 1) {
+		return;
+	}
 
-	// Field ID is located after field size.
-	if (*(p + sizeof(uint32_t)) == AS_FIELD_FILTER) {
-		p += cf_swap_from_be32(*(uint32_t*)p) + sizeof(uint32_t);
+	as_event_command* cmd = be->hedge_cmds;
+
+	while (cmd) {
+		// Hedge commands are added to the head of the list.
+		as_event_command* next = cmd->hedge_next;
+
+		// Registered commands have not been started, so their send buffer is not located yet.
+		if (cmd->hedge == AS_ASYNC_HEDGE_ORIGINAL && cmd->state != AS_ASYNC_STATE_REGISTERED) {
+			as_batch_hedge_command_async(cmd, n_nodes);
+		}
+		cmd = next;
 	}
+}
 
-	// Field ID must be AS_FIELD_BATCH_INDEX at this point.
-	if (*(p + sizeof(uint32_t)) != AS_FIELD_BATCH_INDEX) {
-		as_log_error("Batch retry buffer is corrupt");
-		return;
+// Return true if all keys of the command have a response.
+static bool
+as_batch_hedge_answered(as_event_command* cmd)
+{
+	as_async_batch_executor* be = cmd->udata; // udata is overloaded to contain executor.
+	as_batch_retry_buf rb;
+
+	if (! as_batch_retry_buf_init(&rb, cmd)) {
+		return false;
 	}
-	p += AS_FIELD_HEADER_SIZE;
 
-	uint32_t n_offsets = cf_swap_from_be32(*(uint32_t*)p);
-	p += sizeof(uint32_t) + 1; // Skip over n_offsets and header flags.
+	as_vector* records = &be->records->list;
+	uint8_t* p = rb.rows;
+
+	for (uint32_t i = 0; i < rb.n_offsets; i++) {
+		uint32_t offset = cf_swap_from_be32(*(uint32_t*)p);
+		as_batch_base_record* rec = as_vector_get(records, offset);
+
+		if (rec->result == AEROSPIKE_NO_RESPONSE) {
+			return false;
+		}
+
+		uint8_t type;
+		p = as_batch_retry_parse_row(p, &type);
+	}
+	return true;
+}
+
+// Return false if the error does not apply to the batch, because other hedged node commands
+// cover the command's keys.
+bool
+as_async_batch_error(as_event_command* cmd, as_error* err)
+{
+	as_async_batch_executor* be = cmd->udata;  // udata is overloaded to contain executor.
+	uint8_t hedge = cmd->hedge;
+
+	if (hedge) {
+		as_batch_hedge_unlink(cmd);
+
+		// Hedge command keys are also covered by the original node command, so hedge command
+		// errors are ignored.
+		if (hedge != AS_ASYNC_HEDGE_ORIGINAL || as_batch_hedge_answered(cmd)) {
+			return false;
+		}
+	}
+
+	be->error_row = true;
+
+	if (!err->in_doubt) {
+		return true;
+	}
+
+	// Set error/in_doubt in each key contained in the command.
+	// Batch offsets are out of scope, so they must be parsed
+	// from the parent command's send buffer.
+	as_batch_retry_buf rb;
+
+	if (! as_batch_retry_buf_init(&rb, cmd)) {
+		return true;
+	}
 
 	as_vector* records = &be->records->list;
+	uint8_t* p = rb.rows;
 
-	for (uint32_t i = 0; i < n_offsets; i++) {
+	for (uint32_t i = 0; i < rb.n_offsets; i++) {
 		uint32_t offset = cf_swap_from_be32(*(uint32_t*)p);
 		as_batch_base_record* rec = as_vector_get(records, offset);
 
@@ -4535,6 +6537,7 @@ as_async_batch_error(as_event_command* cmd, as_error* err)
 		uint8_t type;
 		p = as_batch_retry_parse_row(p, &type);
 	}
+	return true;
 }
 
 //---------------------------------
@@ -4549,8 +6552,8 @@ as_policy_batch_parent_read_merge(aerospike* as, const as_policy_batch* src, as_
 		return &config->policies.batch;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_batch* cfg = &config->policies.batch;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_BATCH_PARENT_READ + AS_BATCH_SOCKET_TIMEOUT)?
@@ -4578,8 +6581,20 @@ as_policy_batch_parent_read_merge(aerospike* as, const as_policy_batch* src, as_
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
 		mrg->read_touch_ttl_percent = src->read_touch_ttl_percent;
+		mrg->max_keys_per_node_command = src->max_keys_per_node_command;
+		mrg->hedge_delay = src->hedge_delay;
+		mrg->concurrent_threshold = src->concurrent_threshold;
+		mrg->rack_balance = src->rack_balance;
+		mrg->dedup_keys = src->dedup_keys;
+		mrg->spread_event_loops = src->spread_event_loops;
 		mrg->send_set_name = src->send_set_name;
 		mrg->deserialize = src->deserialize;
 		return mrg;
@@ -4597,8 +6612,8 @@ as_policy_batch_parent_write_merge(aerospike* as, const as_policy_batch* src, as
 		return &config->policies.batch_parent_write;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_batch* cfg = &config->policies.batch_parent_write;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_BATCH_PARENT_WRITE + AS_BATCH_SOCKET_TIMEOUT)?
@@ -4626,8 +6641,20 @@ as_policy_batch_parent_write_merge(aerospike* as, const as_policy_batch* src, as
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
 		mrg->read_touch_ttl_percent = src->read_touch_ttl_percent;
+		mrg->max_keys_per_node_command = src->max_keys_per_node_command;
+		mrg->hedge_delay = src->hedge_delay;
+		mrg->concurrent_threshold = src->concurrent_threshold;
+		mrg->rack_balance = src->rack_balance;
+		mrg->dedup_keys = src->dedup_keys;
+		mrg->spread_event_loops = src->spread_event_loops;
 		mrg->send_set_name = src->send_set_name;
 		mrg->deserialize = src->deserialize;
 		return mrg;
@@ -4645,8 +6672,8 @@ as_policy_batch_write_merge(aerospike* as, const as_policy_batch_write* src, as_
 		return &config->policies.batch_write;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_batch_write* cfg = &config->policies.batch_write;
 
 		mrg->key = as_field_is_set(bitmap, AS_BATCH_WRITE_SEND_KEY)?
@@ -4675,8 +6702,8 @@ as_policy_batch_apply_merge(aerospike* as, const as_policy_batch_apply* src, as_
 		return &config->policies.batch_apply;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_batch_apply* cfg = &config->policies.batch_apply;
 
 		mrg->key = as_field_is_set(bitmap, AS_BATCH_UDF_SEND_KEY)?
@@ -4703,8 +6730,8 @@ as_policy_batch_remove_merge(aerospike* as, const as_policy_batch_remove* src, a
 		return &config->policies.batch_remove;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_batch_remove* cfg = &config->policies.batch_remove;
 
 		mrg->key = as_field_is_set(bitmap, AS_BATCH_DELETE_SEND_KEY)?
@@ -4742,7 +6769,7 @@ as_batch_txn_callback(as_error* err, as_record* rec, void* udata, as_event_loop*
 	// Add txn monitor keys succeeded. Run original batch write.
 	as_error e;
 	as_status status = as_batch_records_execute_async(bt->as, &e, &bt->policy, bt->records,
-		bt->txn, bt->versions, bt->listener, bt->udata, event_loop, 0, true);
+		bt->txn, bt->versions, bt->listener, bt->progress, bt->udata, event_loop, 0, true);
 
 	if (status != AEROSPIKE_OK) {
 		bt->listener(&e, bt->records, bt->udata, event_loop);
@@ -4784,6 +6811,14 @@ as_txn_verify(aerospike* as, as_error* err, as_txn* txn)
 
 	as_config* config = aerospike_load_config(as);
 	as_policy_txn_verify* policy = &config->policies.txn_verify;
+	as_policy_txn_verify concurrent_policy;
+
+	if (txn->read_only && ! policy->concurrent) {
+		// Read-only commits consist of verify only, so verify all nodes in one parallel round.
+		concurrent_policy = *policy;
+		concurrent_policy.concurrent = true;
+		policy = &concurrent_policy;
+	}
 
 	// Do not pass txn instance for verify.
 	as_status status = as_batch_records_execute(as, err, policy, &records, NULL, versions, NULL, 0, false);
@@ -4861,7 +6896,7 @@ as_txn_verify_async(
 
 	// Do not pass txn instance for verify.
 	as_status status = as_batch_records_execute_async(as, err, policy, records, NULL, versions,
-		listener, udata, event_loop, 0, false);
+		listener, NULL, udata, event_loop, 0, false);
 
 	if (status != AEROSPIKE_OK) {
 		as_batch_records_destroy(records);
@@ -4898,7 +6933,7 @@ as_txn_roll_async(
 	}
 
 	as_status status = as_batch_records_execute_async(as, err, policy, records, txn, versions,
-		listener, udata, event_loop, txn_attr, true);
+		listener, NULL, udata, event_loop, txn_attr, true);
 
 	if (status != AEROSPIKE_OK) {
 		as_batch_records_destroy(records);
@@ -4939,6 +6974,17 @@ aerospike_batch_read_async(
 	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
 	as_async_batch_listener listener, void* udata, as_event_loop* event_loop
 	)
+{
+	return aerospike_batch_read_async_progress(as, err, policy, records, listener, NULL, udata,
+		event_loop);
+}
+
+as_status
+aerospike_batch_read_async_progress(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
+	as_async_batch_listener listener, as_async_batch_progress_listener progress, void* udata,
+	as_event_loop* event_loop
+	)
 {
 	as_error_reset(err);
 	
@@ -4956,8 +7002,8 @@ aerospike_batch_read_async(
 		}
 	}
 
-	return as_batch_records_execute_async(as, err, policy, records, txn, versions, listener, udata,
-		event_loop, 0, false);
+	return as_batch_records_execute_async(as, err, policy, records, txn, versions, listener,
+		progress, udata, event_loop, 0, false);
 }
 
 as_status
@@ -4996,6 +7042,17 @@ aerospike_batch_write_async(
 	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
 	as_async_batch_listener listener, void* udata, as_event_loop* event_loop
 	)
+{
+	return aerospike_batch_write_async_progress(as, err, policy, records, listener, NULL, udata,
+		event_loop);
+}
+
+as_status
+aerospike_batch_write_async_progress(
+	aerospike* as, as_error* err, const as_policy_batch* policy, as_batch_records* records,
+	as_async_batch_listener listener, as_async_batch_progress_listener progress, void* udata,
+	as_event_loop* event_loop
+	)
 {
 	as_error_reset(err);
 	
@@ -5017,6 +7074,7 @@ aerospike_batch_write_async(
 		bt->as = as; // Assume "as" is either global or was allocated on the heap.
 		bt->records = records; // Already required to be allocated on the heap.
 		bt->listener = listener;
+		bt->progress = progress;
 		bt->txn = txn;
 		bt->versions = versions;
 		bt->udata = udata; // Already required to be global or allocated on the heap.
@@ -5028,8 +7086,8 @@ aerospike_batch_write_async(
 	}
 	else {
 		// Perform batch write.
-		return as_batch_records_execute_async(as, err, policy, records, NULL, NULL, listener, udata, event_loop,
-			0, true);
+		return as_batch_records_execute_async(as, err, policy, records, NULL, NULL, listener,
+			progress, udata, event_loop, 0, true);
 	}
 }
 
@@ -5047,6 +7105,83 @@ as_batch_records_destroy(as_batch_records* records)
 	as_vector_destroy(list);
 }
 
+as_status
+as_batch_records_serialize(
+	as_error* err, as_policies* defs, const as_policy_batch* policy, as_batch_records* records,
+	uint8_t* buf, size_t capacity, size_t* size
+	)
+{
+	as_vector* list = &records->list;
+	uint32_t n_keys = list->size;
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_batch_base_record* rec = as_vector_get(list, i);
+		as_status status = as_key_set_digest(err, &rec->key);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	as_vector offsets;
+	as_vector_init(&offsets, sizeof(uint32_t), n_keys);
+
+	for (uint32_t i = 0; i < n_keys; i++) {
+		as_vector_append(&offsets, &i);
+	}
+
+	as_queue buffers;
+	as_queue_inita(&buffers, sizeof(as_buffer), 8);
+
+	as_batch_builder bb = {
+		.defs = defs,
+		.filter_exp = policy->base.filter_exp,
+		.buffers = &buffers,
+		.batch_any = true
+	};
+
+	as_status status = as_batch_records_size(list, &offsets, &bb, err);
+
+	if (status == AEROSPIKE_OK) {
+		if (bb.size <= capacity) {
+			*size = as_batch_records_write(policy, list, &offsets, &bb, buf);
+		}
+		else {
+			*size = bb.size;
+			status = as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Batch command size %zu exceeds buffer capacity %zu", bb.size, capacity);
+		}
+	}
+	as_batch_builder_destroy(&bb);
+	as_vector_destroy(&offsets);
+	return status;
+}
+
+void
+as_batch_records_reset(as_batch_records* records)
+{
+	as_vector* list = &records->list;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_batch_base_record* rec = as_vector_get(list, i);
+		as_record* r = &rec->record;
+		as_bin* bin = r->bins.entries;
+
+		for (uint16_t j = 0; j < r->bins.size; j++, bin++) {
+			as_val_destroy((as_val*)bin->valuep);
+			bin->valuep = NULL;
+		}
+		r->bins.size = 0;
+		as_record_set_buffer(r, NULL);
+		r->gen = 0;
+		r->ttl = 0;
+
+		rec->result = AEROSPIKE_OK;
+		rec->in_doubt = false;
+		rec->retained = true;
+	}
+}
+
 as_status
 aerospike_batch_get(
 	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
@@ -5078,7 +7213,7 @@ aerospike_batch_get(
 	attr.read_attr |= AS_MSG_INFO1_GET_ALL;
 
 	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-		listener, udata);
+		listener, NULL, NULL, udata);
 }
 
 as_status
@@ -5113,7 +7248,47 @@ aerospike_batch_get_bins(
 	as_batch_attr_read_header(&attr, policy);
 
 	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-		listener, udata);
+		listener, NULL, NULL, udata);
+}
+
+as_status
+aerospike_batch_read_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	const char** bins, uint32_t n_bins, as_batch_stream_listener listener, void* udata
+	)
+{
+	as_error_reset(err);
+
+	as_policy_batch merged;
+	policy = as_policy_batch_parent_read_merge(as, policy, &merged);
+
+	uint64_t* versions = NULL;
+
+	if (policy->base.txn) {
+		as_status status = as_batch_keys_prepare_txn(policy->base.txn, batch, err, &versions);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	as_batch_read_record rec = {
+		.type = AS_BATCH_READ,
+		// Cast to maintain backwards compatibility. Field is not really modified.
+		.bin_names = (char**)bins,
+		.n_bin_names = n_bins,
+		.read_all_bins = (bins == NULL)
+	};
+
+	as_batch_attr attr;
+	as_batch_attr_read_header(&attr, policy);
+
+	if (rec.read_all_bins) {
+		attr.read_attr |= AS_MSG_INFO1_GET_ALL;
+	}
+
+	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
+		NULL, listener, NULL, udata);
 }
 
 as_status
@@ -5147,7 +7322,7 @@ aerospike_batch_get_ops(
 	as_batch_attr_read_adjust_ops(&attr, ops);
 
 	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-		listener, udata);
+		listener, NULL, NULL, udata);
 }
 
 as_status
@@ -5180,7 +7355,218 @@ aerospike_batch_exists(
 	attr.read_attr |= AS_MSG_INFO1_GET_NOBINDATA;
 
 	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-		listener, udata);
+		listener, NULL, NULL, udata);
+}
+
+static as_status
+as_batch_digests_verify(as_error* err, const as_policy_batch* policy)
+{
+	// Transactions track keys by set name and digest per key, which requires as_key entries.
+	if (policy->base.txn) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Digest batches not supported in transactions");
+	}
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_batch_compact_verify(as_error* err, const as_policy_batch* policy, const as_batch_compact* batch)
+{
+	if (policy->base.txn) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Compact batches not supported in transactions");
+	}
+
+	for (uint32_t i = 0; i < batch->size; i++) {
+		if (! batch->keys[i].ns || ! batch->keys[i].set) {
+			return as_error_update(err, AEROSPIKE_ERR_PARAM,
+				"Compact key %u has no namespace or set", i);
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+as_status
+aerospike_batch_read_digests_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_digests* batch,
+	const char** bins, uint32_t n_bins, as_batch_stream_listener listener, void* udata
+	)
+{
+	as_error_reset(err);
+
+	as_policy_batch merged;
+	policy = as_policy_batch_parent_read_merge(as, policy, &merged);
+
+	as_status status = as_batch_digests_verify(err, policy);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_batch_read_record rec = {
+		.type = AS_BATCH_READ,
+		// Cast to maintain backwards compatibility. Field is not really modified.
+		.bin_names = (char**)bins,
+		.n_bin_names = n_bins,
+		.read_all_bins = (bins == NULL)
+	};
+
+	as_batch_attr attr;
+	as_batch_attr_read_header(&attr, policy);
+
+	if (rec.read_all_bins) {
+		attr.read_attr |= AS_MSG_INFO1_GET_ALL;
+	}
+
+	as_batch_key_src src = {
+		.keys = NULL,
+		.digests = batch,
+		.compact = NULL
+	};
+	return as_batch_src_execute(as, err, policy, &src, batch->size, (as_batch_base_record*)&rec,
+		NULL, &attr, NULL, listener, NULL, udata);
+}
+
+as_status
+aerospike_batch_exists_digests(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_digests* batch,
+	as_batch_exists_results* results
+	)
+{
+	as_error_reset(err);
+
+	as_policy_batch merged;
+	policy = as_policy_batch_parent_read_merge(as, policy, &merged);
+
+	as_status status = as_batch_digests_verify(err, policy);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_batch_read_record rec = {
+		.type = AS_BATCH_READ
+	};
+
+	as_batch_attr attr;
+	as_batch_attr_read_header(&attr, policy);
+	attr.read_attr |= AS_MSG_INFO1_GET_NOBINDATA;
+
+	as_batch_key_src src = {
+		.keys = NULL,
+		.digests = batch,
+		.compact = NULL
+	};
+	return as_batch_src_execute(as, err, policy, &src, batch->size, (as_batch_base_record*)&rec,
+		NULL, &attr, NULL, NULL, results, NULL);
+}
+
+as_status
+aerospike_batch_read_compact_stream(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_compact* batch,
+	const char** bins, uint32_t n_bins, as_batch_stream_listener listener, void* udata
+	)
+{
+	as_error_reset(err);
+
+	as_policy_batch merged;
+	policy = as_policy_batch_parent_read_merge(as, policy, &merged);
+
+	as_status status = as_batch_compact_verify(err, policy, batch);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_batch_read_record rec = {
+		.type = AS_BATCH_READ,
+		// Cast to maintain backwards compatibility. Field is not really modified.
+		.bin_names = (char**)bins,
+		.n_bin_names = n_bins,
+		.read_all_bins = (bins == NULL)
+	};
+
+	as_batch_attr attr;
+	as_batch_attr_read_header(&attr, policy);
+
+	if (rec.read_all_bins) {
+		attr.read_attr |= AS_MSG_INFO1_GET_ALL;
+	}
+
+	as_batch_key_src src = {
+		.keys = NULL,
+		.digests = NULL,
+		.compact = batch
+	};
+	return as_batch_src_execute(as, err, policy, &src, batch->size, (as_batch_base_record*)&rec,
+		NULL, &attr, NULL, listener, NULL, udata);
+}
+
+as_status
+aerospike_batch_exists_compact(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch_compact* batch,
+	as_batch_exists_results* results
+	)
+{
+	as_error_reset(err);
+
+	as_policy_batch merged;
+	policy = as_policy_batch_parent_read_merge(as, policy, &merged);
+
+	as_status status = as_batch_compact_verify(err, policy, batch);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_batch_read_record rec = {
+		.type = AS_BATCH_READ
+	};
+
+	as_batch_attr attr;
+	as_batch_attr_read_header(&attr, policy);
+	attr.read_attr |= AS_MSG_INFO1_GET_NOBINDATA;
+
+	as_batch_key_src src = {
+		.keys = NULL,
+		.digests = NULL,
+		.compact = batch
+	};
+	return as_batch_src_execute(as, err, policy, &src, batch->size, (as_batch_base_record*)&rec,
+		NULL, &attr, NULL, NULL, results, NULL);
+}
+
+as_status
+aerospike_batch_exists_flat(
+	aerospike* as, as_error* err, const as_policy_batch* policy, const as_batch* batch,
+	as_batch_exists_results* results
+	)
+{
+	as_error_reset(err);
+	
+	as_policy_batch merged;
+	policy = as_policy_batch_parent_read_merge(as, policy, &merged);
+
+	uint64_t* versions = NULL;
+
+	if (policy->base.txn) {
+		as_status status = as_batch_keys_prepare_txn(policy->base.txn, batch, err, &versions);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	as_batch_read_record rec = {
+		.type = AS_BATCH_READ
+	};
+
+	as_batch_attr attr;
+	as_batch_attr_read_header(&attr, policy);
+	attr.read_attr |= AS_MSG_INFO1_GET_NOBINDATA;
+
+	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
+		NULL, NULL, results, NULL);
 }
 
 as_status
@@ -5239,7 +7625,7 @@ aerospike_batch_operate(
 		as_batch_attr_write(&attr, ops, policy_write, policy_write->key, policy_write->durable_delete);
 
 		return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-			listener, udata);
+			listener, NULL, NULL, udata);
 	}
 	else {
 		as_policy_batch merged;
@@ -5265,7 +7651,7 @@ aerospike_batch_operate(
 		as_batch_attr_read_adjust_ops(&attr, ops);
 
 		return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-			listener, udata);
+			listener, NULL, NULL, udata);
 	}
 }
 
@@ -5315,7 +7701,7 @@ aerospike_batch_apply(
 	as_batch_attr_apply(&attr, policy_apply, policy_apply->key, policy_apply->durable_delete);
 
 	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-		listener, udata);
+		listener, NULL, NULL, udata);
 }
 
 as_status
@@ -5360,5 +7746,5 @@ aerospike_batch_remove(
 	as_batch_attr_remove(&attr, policy_remove, policy_remove->key, policy_remove->durable_delete);
 
 	return as_batch_keys_execute(as, err, policy, batch, (as_batch_base_record*)&rec, versions, &attr,
-		listener, udata);
+		listener, NULL, NULL, udata);
 }
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike_compress.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_compress.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static as_compress_dict*
+as_compress_dict_find(as_cluster* cluster, const char* ns, const char* set)
+{
+	as_vector* dicts = cluster->compress_dicts;
+
+	if (! dicts) {
+		return NULL;
+	}
+
+	as_compress_dict* ns_dict = NULL;
+
+	for (uint32_t i = 0; i < dicts->size; i++) {
+		as_compress_dict_entry* entry = as_vector_get(dicts, i);
+
+		if (strcmp(entry->ns, ns) != 0) {
+			continue;
+		}
+
+		if (! entry->set) {
+			ns_dict = entry->dict;
+		}
+		else if (set && strcmp(entry->set, set) == 0) {
+			return entry->dict;
+		}
+	}
+	return ns_dict;
+}
+
+static as_compress_dict*
+as_compress_dict_find_id(as_cluster* cluster, uint32_t id)
+{
+	as_vector* dicts = cluster->compress_dicts;
+
+	if (! dicts) {
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < dicts->size; i++) {
+		as_compress_dict_entry* entry = as_vector_get(dicts, i);
+
+		if (as_compress_dict_id(entry->dict) == id) {
+			return entry->dict;
+		}
+	}
+	return NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+aerospike_compress_bytes(
+	aerospike* as, as_error* err, const char* ns, const char* set, const uint8_t* value,
+	uint32_t size, as_bytes* bytes
+	)
+{
+	as_error_reset(err);
+
+	as_compress_dict* dict = as_compress_dict_find(as->cluster, ns, set);
+	uint8_t* buf;
+	size_t buf_size;
+	as_status status = as_compress_frame(err, dict, value, size, &buf, &buf_size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_bytes_init_wrap(bytes, buf, (uint32_t)buf_size, true);
+	return AEROSPIKE_OK;
+}
+
+as_status
+aerospike_decompress_bytes(
+	aerospike* as, as_error* err, const uint8_t* value, uint32_t size, as_bytes* bytes
+	)
+{
+	as_error_reset(err);
+
+	uint32_t id = as_compress_frame_dict_id(value, size);
+	as_compress_dict* dict = NULL;
+
+	if (id != 0) {
+		dict = as_compress_dict_find_id(as->cluster, id);
+
+		if (! dict) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Compression dictionary %u not loaded",
+				id);
+		}
+	}
+
+	uint8_t* buf;
+	size_t buf_size;
+	as_status status = as_decompress_frame(err, dict, value, size, &buf, &buf_size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_bytes_init_wrap(bytes, buf, (uint32_t)buf_size, true);
+	return AEROSPIKE_OK;
+}
@@ -16,6 +16,7 @@
  */
 #include <aerospike/aerospike_info.h>
 #include <aerospike/as_admin.h>
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_error.h>
@@ -28,6 +29,90 @@
 #include <aerospike/as_socket.h>
 #include <citrusleaf/alloc.h>
 
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct as_info_all_executor_s as_info_all_executor;
+
+typedef struct {
+	as_info_all_executor* executor;
+	uint32_t index;
+} as_info_all_slot;
+
+struct as_info_all_executor_s {
+	aerospike_info_all_listener listener;
+	void* udata;
+	as_info_node_response* responses;
+	as_info_all_slot* slots;
+	uint32_t n_responses;
+	uint32_t count;
+	uint32_t n_errors;
+};
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_info_all_complete(as_info_all_executor* ie, as_event_loop* event_loop)
+{
+	as_info_node_response* responses = ie->responses;
+	uint32_t n_responses = ie->n_responses;
+	as_error* err = NULL;
+	as_error e;
+
+	if (ie->n_errors > 0) {
+		for (uint32_t i = 0; i < n_responses; i++) {
+			if (responses[i].err.code != AEROSPIKE_OK) {
+				as_error_copy(&e, &responses[i].err);
+				break;
+			}
+		}
+
+		char str[64];
+		snprintf(str, sizeof(str), " (%u of %u nodes failed)", ie->n_errors, n_responses);
+		as_error_append(&e, str);
+		err = &e;
+	}
+
+	ie->listener(err, responses, n_responses, ie->udata, event_loop);
+
+	for (uint32_t i = 0; i < n_responses; i++) {
+		cf_free(responses[i].response);
+		as_node_release(responses[i].node);
+	}
+	cf_free(ie);
+}
+
+static void
+as_info_all_node_complete(
+	as_info_all_slot* slot, as_error* err, char* response, as_event_loop* event_loop
+	)
+{
+	as_info_all_executor* ie = slot->executor;
+	as_info_node_response* r = &ie->responses[slot->index];
+
+	if (err) {
+		as_error_copy(&r->err, err);
+		as_incr_uint32(&ie->n_errors);
+	}
+	else {
+		r->response = cf_strdup(response);
+	}
+
+	if (as_aaf_uint32_rls(&ie->count, -1) == 0) {
+		as_fence_acq();
+		as_info_all_complete(ie, event_loop);
+	}
+}
+
+static void
+as_info_all_listener(as_error* err, char* response, void* udata, as_event_loop* event_loop)
+{
+	as_info_all_node_complete(udata, err, response, event_loop);
+}
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -189,3 +274,65 @@ aerospike_info_foreach(
 	as_nodes_release(nodes);
 	return status;
 }
+
+as_status
+aerospike_info_all_async(
+	aerospike* as, as_error* err, as_policy_info* policy, const char* req,
+	aerospike_info_all_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_error_reset(err);
+
+	if (! policy) {
+		as_config* config = aerospike_load_config(as);
+		policy = &config->policies.info;
+	}
+
+	as_nodes* nodes = as_nodes_reserve(as->cluster);
+	uint32_t n_nodes = nodes->size;
+
+	if (n_nodes == 0) {
+		as_nodes_release(nodes);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLUSTER, "Cluster is empty");
+	}
+
+	// Allocate executor, responses and command slots in one block.
+	as_info_all_executor* ie = cf_malloc(sizeof(as_info_all_executor) +
+		(sizeof(as_info_node_response) + sizeof(as_info_all_slot)) * n_nodes);
+	ie->listener = listener;
+	ie->udata = udata;
+	ie->responses = (as_info_node_response*)(ie + 1);
+	ie->slots = (as_info_all_slot*)(ie->responses + n_nodes);
+	ie->n_responses = n_nodes;
+	ie->count = n_nodes;
+	ie->n_errors = 0;
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		as_node* node = nodes->array[i];
+		as_info_node_response* r = &ie->responses[i];
+
+		// One reservation is held for the response and one is released by the node command.
+		as_node_reserve(node);
+		as_node_reserve(node);
+		r->node = node;
+		r->response = NULL;
+		as_error_init(&r->err);
+		ie->slots[i].executor = ie;
+		ie->slots[i].index = i;
+	}
+	as_nodes_release(nodes);
+
+	// The executor may be freed by another thread as soon as the last command is started,
+	// so only slots for commands that have not yet started are referenced.
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		as_info_all_slot* slot = &ie->slots[i];
+		as_node* node = ie->responses[i].node;
+		as_error e;
+
+		if (as_info_command_node_async(as, &e, policy, node, req, as_info_all_listener, slot,
+			event_loop) != AEROSPIKE_OK) {
+			as_info_all_node_complete(slot, &e, NULL, NULL);
+		}
+	}
+	return AEROSPIKE_OK;
+}
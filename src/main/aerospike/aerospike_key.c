@@ -17,6 +17,7 @@
 #include <aerospike/aerospike.h>
 #include <aerospike/aerospike_key.h>
 #include <aerospike/as_async.h>
+#include <aerospike/as_auto_batch.h>
 #include <aerospike/as_bin.h>
 #include <aerospike/as_buffer.h>
 #include <aerospike/as_command.h>
@@ -31,11 +32,14 @@
 #include <aerospike/as_operations.h>
 #include <aerospike/as_partition.h>
 #include <aerospike/as_policy.h>
+#include <aerospike/as_prepared_operate.h>
 #include <aerospike/as_random.h>
+#include <aerospike/as_read_into.h>
 #include <aerospike/as_record.h>
 #include <aerospike/as_serializer.h>
 #include <aerospike/as_shm_cluster.h>
 #include <aerospike/as_status.h>
+#include <aerospike/as_sync_async.h>
 #include <aerospike/as_txn.h>
 #include <aerospike/as_txn_monitor.h>
 #include <citrusleaf/cf_clock.h>
@@ -140,6 +144,8 @@ as_command_init_read(
 	cmd->parse_results_fn = fn;
 	cmd->udata = udata;
 	cmd->buf_size = size;
+	cmd->iov = NULL;
+	cmd->iov_count = 0;
 	cmd->partition_id = pi->partition_id;
 	cmd->latency_type = AS_LATENCY_TYPE_READ;
 	as_cluster_add_command_count(cluster);
@@ -171,17 +177,26 @@ as_command_init_read(
 	cmd->replica_index = as_replica_index_init_read(cluster, cmd->replica);
 }
 
+static inline uint8_t
+as_command_hedge_flag(const as_policy_read* policy)
+{
+	// Hedged reads are not used in transactions because only one response can update the
+	// transaction's read versions.
+	return (policy->hedge_delay > 0 && ! policy->base.txn)? AS_COMMAND_FLAGS_HEDGE : 0;
+}
+
 static inline as_status
 as_command_execute_read(
 	as_cluster* cluster, as_error* err, const as_policy_base* policy, as_policy_replica replica,
 	as_policy_read_mode_sc read_mode_sc, const as_key* key, uint8_t* buf, size_t size,
-	as_partition_info* pi, const as_parse_results_fn fn, void* udata
+	as_partition_info* pi, const as_parse_results_fn fn, void* udata, uint8_t flags
 	)
 {
 	as_command cmd;
 	as_command_init_read(&cmd, cluster, policy, replica, read_mode_sc, key, size, pi,
 						 fn, udata);
 
+	cmd.flags |= flags;
 	cmd.buf = buf;
 	as_command_start_timer(&cmd);
 	return as_command_execute(&cmd, err);
@@ -202,6 +217,8 @@ as_command_init_write(
 	cmd->parse_results_fn = fn;
 	cmd->udata = udata;
 	cmd->buf_size = size;
+	cmd->iov = NULL;
+	cmd->iov_count = 0;
 	cmd->partition_id = pi->partition_id;
 	cmd->flags = 0;
 	cmd->replica = as_command_write_replica(replica);
@@ -297,7 +314,8 @@ as_txn_monitor_callback(as_error* err, as_record* rec, void* udata, as_event_loo
 		*(uint32_t*)(cmd->ubuf + cmd->pos) = cmd->txn->deadline;
 
 		size_t comp_size = cmd->write_len;
-		as_status status = as_command_compress(err, cmd->ubuf, cmd->len, cmd->buf, &comp_size);
+		as_status status = as_command_compress(err, cmd->cluster, cmd->ubuf, cmd->len, cmd->buf,
+			&comp_size);
 
 		if (status == AEROSPIKE_OK) {
 			cmd->write_len = (uint32_t)comp_size;
@@ -323,6 +341,48 @@ as_txn_monitor_callback(as_error* err, as_record* rec, void* udata, as_event_loo
 	}
 }
 
+static as_status
+as_event_command_quota(as_event_command* cmd, const as_key* key, as_error* err, uint32_t* delay_ms)
+{
+	if (! cmd->cluster->quotas) {
+		*delay_ms = 0;
+		return AEROSPIKE_OK;
+	}
+
+	// Total deadline is still the relative total timeout before the command is executed.
+	uint32_t max_wait = (cmd->total_deadline > 0)? (uint32_t)cmd->total_deadline : UINT32_MAX;
+	as_quota_type type = (cmd->flags & AS_ASYNC_FLAGS_READ)? AS_QUOTA_READ : AS_QUOTA_WRITE;
+	as_status status = as_cluster_quota_acquire(cmd->cluster, err, key->ns, key->set, type,
+		max_wait, delay_ms);
+
+	if (status != AEROSPIKE_OK) {
+		as_event_command_destroy(cmd);
+	}
+	return status;
+}
+
+static inline as_status
+as_event_command_execute_read(
+	as_event_command* cmd, const as_key* key, const as_policy_read* policy, as_error* err
+	)
+{
+	uint32_t delay_ms;
+	as_status status = as_event_command_quota(cmd, key, err, &delay_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (delay_ms > 0) {
+		return as_event_command_execute_delay(cmd, delay_ms, err);
+	}
+
+	if (as_command_hedge_flag(policy) && ! cmd->pipe_listener) {
+		return as_event_command_execute_hedge(cmd, policy->hedge_delay, err);
+	}
+	return as_event_command_execute(cmd, err);
+}
+
 static as_status
 as_event_command_execute_txn(
 	aerospike* as, as_error* err, const as_policy_base* cmd_policy, const as_key* key,
@@ -350,13 +410,26 @@ as_async_command_execute(
 	as_event_command* cmd, as_command_txn_data* tdata
 	)
 {
+	uint32_t delay_ms;
+	as_status status = as_event_command_quota(cmd, key, err, &delay_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (policy->ordered) {
+		as_event_command_set_order(cmd, key);
+	}
+
 	if (as_txn_key_add(policy->txn, key)) {
+		// Quota delay is not applied because the command is started from the txn monitor
+		// callback.
 		// Use overloaded pos to store deadline offset.
 		cmd->pos = tdata->deadline_offset;
 		return as_event_command_execute_txn(as, err, policy, key, cmd);
 	}
 	else {
-		return as_event_command_execute(cmd, err);
+		return as_event_command_execute_delay(cmd, delay_ms, err);
 	}
 }
 
@@ -367,6 +440,17 @@ as_async_compress_command_execute(
 	size_t comp_size, size_t* length, size_t* comp_length
 	)
 {
+	uint32_t delay_ms;
+	as_status status = as_event_command_quota(cmd, key, err, &delay_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (policy->ordered) {
+		as_event_command_set_order(cmd, key);
+	}
+
 	if (as_txn_key_add(policy->txn, key)) {
 		// Delay compression until key is added to txn monitor and txn deadline is returned.
 		// Use overloaded len to store uncompressed size.
@@ -378,7 +462,7 @@ as_async_compress_command_execute(
 	}
 	else {
 		// Compress buffer and execute.
-		as_status status = as_command_compress(err, ubuf, size, cmd->buf, &comp_size);
+		status = as_command_compress(err, cmd->cluster, ubuf, size, cmd->buf, &comp_size);
 
 		if (status != AEROSPIKE_OK) {
 			as_event_command_destroy(cmd);
@@ -395,7 +479,7 @@ as_async_compress_command_execute(
 			*comp_length = comp_size;
 		}
 
-		return as_event_command_execute(cmd, err);
+		return as_event_command_execute_delay(cmd, delay_ms, err);
 	}
 }
 
@@ -411,8 +495,14 @@ as_policy_read_merge(aerospike* as, const as_policy_read* src, as_policy_read* m
 		return &config->policies.read;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+
+		if (src->base.resolved == config) {
+			// Already merged with this configuration by as_policy_read_resolve().
+			return src;
+		}
+
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_read* cfg = &config->policies.read;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_READ_SOCKET_TIMEOUT)?
@@ -432,11 +522,21 @@ as_policy_read_merge(aerospike* as, const as_policy_read* src, as_policy_read* m
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
+		mrg->base.resolved = config;
 		mrg->key = src->key;
 		mrg->read_touch_ttl_percent = src->read_touch_ttl_percent;
 		mrg->deserialize = src->deserialize;
 		mrg->async_heap_rec = src->async_heap_rec;
+		mrg->zero_copy = src->zero_copy;
+		mrg->lazy_deserialize = src->lazy_deserialize;
+		mrg->hedge_delay = src->hedge_delay;
 		return mrg;
 	}
 	else {
@@ -444,11 +544,28 @@ as_policy_read_merge(aerospike* as, const as_policy_read* src, as_policy_read* m
 	}
 }
 
+void
+as_policy_read_resolve(aerospike* as, const as_policy_read* src, as_policy_read* out)
+{
+	if (!src) {
+		as_policy_read_default(as, out);
+	}
+	else if (src != out) {
+		as_policy_read_copy(src, out);
+	}
+	out->base.resolved = NULL;
+	as_policy_read_merge(as, out, out);
+}
+
 as_status
 aerospike_key_get(
 	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
 	)
 {
+	if (as_sync_async_eligible(as) && ! *rec) {
+		return as_sync_async_get(as, err, policy, key, rec);
+	}
+
 	as_policy_read merged;
 	policy = as_policy_read_merge(as, policy, &merged);
 
@@ -465,7 +582,7 @@ aerospike_key_get(
 	uint32_t filter_size = as_command_filter_size(&policy->base, &tdata.n_fields);
 	size += filter_size;
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(buf, &policy->base, policy->read_mode_ap,
 		policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields, 0,
@@ -477,12 +594,16 @@ aerospike_key_get(
 
 	as_command_parse_result_data data;
 	data.record = rec;
+	data.buffer = NULL;
 	data.deserialize = policy->deserialize;
+	data.zero_copy = policy->zero_copy;
+	data.lazy = policy->lazy_deserialize;
 
 	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data);
+				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data,
+				(policy->zero_copy ? AS_COMMAND_FLAGS_ZERO_COPY : 0) | as_command_hedge_flag(policy));
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 	return status;
 }
 
@@ -493,6 +614,10 @@ aerospike_key_get_async(
 	as_pipe_listener pipe_listener
 	)
 {
+	if (as_auto_batch_eligible(as, policy, pipe_listener)) {
+		return as_auto_batch_get(as, err, key, listener, udata, event_loop);
+	}
+
 	as_policy_read merged;
 	policy = as_policy_read_merge(as, policy, &merged);
 
@@ -517,6 +642,9 @@ aerospike_key_get_async(
 		policy->async_heap_rec, ri.flags, listener, udata, event_loop, pipe_listener, size,
 		as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, NULL, 0);
 
+	((as_async_record_command*)cmd)->zero_copy = policy->zero_copy;
+	((as_async_record_command*)cmd)->lazy = policy->lazy_deserialize;
+
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(cmd->buf, &policy->base, policy->read_mode_ap,
 		policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields, 0,
@@ -525,7 +653,7 @@ aerospike_key_get_async(
 	p = as_command_write_key(p, &policy->base, policy->key, key, &tdata);
 	p = as_command_write_filter(&policy->base, filter_size, p);
 	cmd->write_len = (uint32_t)as_command_write_end(cmd->buf, p);
-	return as_event_command_execute(cmd, err);
+	return as_event_command_execute_read(cmd, key, policy, err);
 }
 
 //---------------------------------
@@ -538,6 +666,10 @@ aerospike_key_select(
 	const char* bins[], as_record** rec
 	)
 {
+	if (as_sync_async_eligible(as) && ! *rec) {
+		return as_sync_async_select(as, err, policy, key, bins, rec);
+	}
+
 	as_policy_read merged;
 	policy = as_policy_read_merge(as, policy, &merged);
 	
@@ -564,7 +696,7 @@ aerospike_key_select(
 		}
 	}
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(buf, &policy->base, policy->read_mode_ap,
 				policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields, nvalues,
@@ -580,12 +712,101 @@ aerospike_key_select(
 
 	as_command_parse_result_data data;
 	data.record = rec;
+	data.buffer = NULL;
 	data.deserialize = policy->deserialize;
+	data.zero_copy = policy->zero_copy;
+	data.lazy = policy->lazy_deserialize;
 
 	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data);
+				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data,
+				(policy->zero_copy ? AS_COMMAND_FLAGS_ZERO_COPY : 0) | as_command_hedge_flag(policy));
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
+	return status;
+}
+
+static as_status
+as_read_into_parse_result(as_error* err, as_command* cmd, as_node* node, uint8_t* buf, size_t size)
+{
+	as_read_into* into = cmd->udata;
+	as_msg* msg = (as_msg*)buf;
+	as_status status = as_msg_parse(err, msg, size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	uint8_t* p = buf + sizeof(as_msg);
+	status = as_command_parse_fields(&p, err, msg, cmd->policy->txn, cmd->key, false);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	status = msg->result_code;
+
+	if (status != AEROSPIKE_OK) {
+		return as_error_set_prefix(err, status, as_node_get_address_string(node),
+								   as_error_string(status));
+	}
+
+	into->gen = (uint16_t)msg->generation;
+	into->ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+	as_read_into_parse(into, p, msg->n_ops);
+	return AEROSPIKE_OK;
+}
+
+as_status
+aerospike_key_select_into(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_read_into* into
+	)
+{
+	as_policy_read merged;
+	policy = as_policy_read_merge(as, policy, &merged);
+
+	as_cluster* cluster = as->cluster;
+	as_partition_info pi;
+	as_status status = as_command_prepare(cluster, err, &policy->base, key, &pi);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_command_txn_data tdata;
+	size_t size = as_command_key_size(&policy->base, policy->key, key, false, &tdata);
+	uint32_t filter_size = as_command_filter_size(&policy->base, &tdata.n_fields);
+	size += filter_size;
+
+	for (uint32_t i = 0; i < into->n_slots; i++) {
+		status = as_command_bin_name_size(err, into->slots[i].name, &size);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
+	uint32_t timeout = as_command_server_timeout(&policy->base);
+	uint8_t* p = as_command_write_header_read(buf, &policy->base, policy->read_mode_ap,
+				policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields,
+				into->n_slots, AS_MSG_INFO1_READ, 0, 0);
+
+	p = as_command_write_key(p, &policy->base, policy->key, key, &tdata);
+	p = as_command_write_filter(&policy->base, filter_size, p);
+
+	for (uint32_t i = 0; i < into->n_slots; i++) {
+		p = as_command_write_bin_name(p, into->slots[i].name);
+	}
+	size = as_command_write_end(buf, p);
+
+	as_read_into_reset(into);
+
+	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
+				policy->read_mode_sc, key, buf, size, &pi, as_read_into_parse_result, into,
+				as_command_hedge_flag(policy));
+
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 	return status;
 }
 
@@ -629,6 +850,9 @@ aerospike_key_select_async(
 		policy->async_heap_rec, ri.flags, listener, udata, event_loop, pipe_listener, size,
 		as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, NULL, 0);
 
+	((as_async_record_command*)cmd)->zero_copy = policy->zero_copy;
+	((as_async_record_command*)cmd)->lazy = policy->lazy_deserialize;
+
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(cmd->buf, &policy->base, policy->read_mode_ap,
 					policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields, nvalues,
@@ -641,7 +865,7 @@ aerospike_key_select_async(
 		p = as_command_write_bin_name(p, bins[i]);
 	}
 	cmd->write_len = (uint32_t)as_command_write_end(cmd->buf, p);
-	return as_event_command_execute(cmd, err);
+	return as_event_command_execute_read(cmd, key, policy, err);
 }
 
 as_status
@@ -674,7 +898,7 @@ aerospike_key_select_bins(
 		}
 	}
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(buf, &policy->base, policy->read_mode_ap,
 				policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields, n_bins,
@@ -690,12 +914,16 @@ aerospike_key_select_bins(
 
 	as_command_parse_result_data data;
 	data.record = rec;
+	data.buffer = NULL;
 	data.deserialize = policy->deserialize;
+	data.zero_copy = policy->zero_copy;
+	data.lazy = policy->lazy_deserialize;
 
 	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data);
+				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data,
+				(policy->zero_copy ? AS_COMMAND_FLAGS_ZERO_COPY : 0) | as_command_hedge_flag(policy));
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 	return status;
 }
 
@@ -738,6 +966,9 @@ aerospike_key_select_bins_async(
 		policy->async_heap_rec, ri.flags, listener, udata, event_loop, pipe_listener, size,
 		as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, NULL, 0);
 
+	((as_async_record_command*)cmd)->zero_copy = policy->zero_copy;
+	((as_async_record_command*)cmd)->lazy = policy->lazy_deserialize;
+
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* p = as_command_write_header_read(cmd->buf, &policy->base, policy->read_mode_ap,
 					policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields, n_bins,
@@ -750,7 +981,161 @@ aerospike_key_select_bins_async(
 		p = as_command_write_bin_name(p, bins[i]);
 	}
 	cmd->write_len = (uint32_t)as_command_write_end(cmd->buf, p);
-	return as_event_command_execute(cmd, err);
+	return as_event_command_execute_read(cmd, key, policy, err);
+}
+
+//---------------------------------
+// Bin Projection
+//---------------------------------
+
+as_status
+as_bin_projection_init(
+	as_bin_projection* proj, as_error* err, const char* bins[], uint32_t n_bins
+	)
+{
+	as_error_reset(err);
+
+	size_t ops_size = 0;
+
+	for (uint32_t i = 0; i < n_bins; i++) {
+		as_status status = as_command_bin_name_size(err, bins[i], &ops_size);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	// Names are the encoded operation size minus headers, plus a null byte per name.
+	size_t names_size = ops_size - (AS_OPERATION_HEADER_SIZE * n_bins) + n_bins;
+
+	// Single allocation: bin name pointers, encoded operations, bin names.
+	uint8_t* mem = cf_malloc(sizeof(char*) * n_bins + ops_size + names_size);
+	char** names = (char**)mem;
+	uint8_t* ops = mem + sizeof(char*) * n_bins;
+	char* name = (char*)(ops + ops_size);
+	uint8_t* p = ops;
+
+	for (uint32_t i = 0; i < n_bins; i++) {
+		p = as_command_write_bin_name(p, bins[i]);
+
+		size_t len = strlen(bins[i]) + 1;
+		memcpy(name, bins[i], len);
+		names[i] = name;
+		name += len;
+	}
+
+	proj->bins = names;
+	proj->ops = ops;
+	proj->ops_size = (uint32_t)ops_size;
+	proj->n_bins = n_bins;
+	return AEROSPIKE_OK;
+}
+
+void
+as_bin_projection_destroy(as_bin_projection* proj)
+{
+	// Name pointers are at the start of the single allocation.
+	cf_free(proj->bins);
+	proj->bins = NULL;
+	proj->ops = NULL;
+	proj->ops_size = 0;
+	proj->n_bins = 0;
+}
+
+as_status
+aerospike_key_select_projection(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const as_bin_projection* proj, as_record** rec
+	)
+{
+	as_policy_read merged;
+	policy = as_policy_read_merge(as, policy, &merged);
+
+	as_cluster* cluster = as->cluster;
+	as_partition_info pi;
+	as_status status = as_command_prepare(cluster, err, &policy->base, key, &pi);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_command_txn_data tdata;
+	size_t size = as_command_key_size(&policy->base, policy->key, key, false, &tdata);
+	uint32_t filter_size = as_command_filter_size(&policy->base, &tdata.n_fields);
+	size += filter_size + proj->ops_size;
+
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
+	uint32_t timeout = as_command_server_timeout(&policy->base);
+	uint8_t* p = as_command_write_header_read(buf, &policy->base, policy->read_mode_ap,
+				policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields,
+				proj->n_bins, AS_MSG_INFO1_READ, 0, 0);
+
+	p = as_command_write_key(p, &policy->base, policy->key, key, &tdata);
+	p = as_command_write_filter(&policy->base, filter_size, p);
+	memcpy(p, proj->ops, proj->ops_size);
+	p += proj->ops_size;
+	size = as_command_write_end(buf, p);
+
+	as_command_parse_result_data data;
+	data.record = rec;
+	data.buffer = NULL;
+	data.deserialize = policy->deserialize;
+	data.zero_copy = policy->zero_copy;
+	data.lazy = policy->lazy_deserialize;
+
+	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
+				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_result, &data,
+				(policy->zero_copy ? AS_COMMAND_FLAGS_ZERO_COPY : 0) | as_command_hedge_flag(policy));
+
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
+	return status;
+}
+
+as_status
+aerospike_key_select_projection_async(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const as_bin_projection* proj, as_async_record_listener listener, void* udata,
+	as_event_loop* event_loop, as_pipe_listener pipe_listener
+	)
+{
+	as_policy_read merged;
+	policy = as_policy_read_merge(as, policy, &merged);
+
+	as_cluster* cluster = as->cluster;
+	as_partition_info pi;
+	as_status status = as_command_prepare(cluster, err, &policy->base, key, &pi);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_read_info ri;
+	as_event_command_init_read(cluster, policy->replica, policy->read_mode_sc, pi.sc_mode, &ri);
+
+	as_command_txn_data tdata;
+	size_t size = as_command_key_size(&policy->base, policy->key, key, false, &tdata);
+	uint32_t filter_size = as_command_filter_size(&policy->base, &tdata.n_fields);
+	size += filter_size + proj->ops_size;
+
+	as_event_command* cmd = as_async_record_command_create(
+		cluster, &policy->base, &pi, ri.replica, ri.replica_index, policy->deserialize,
+		policy->async_heap_rec, ri.flags, listener, udata, event_loop, pipe_listener, size,
+		as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, NULL, 0);
+
+	((as_async_record_command*)cmd)->zero_copy = policy->zero_copy;
+	((as_async_record_command*)cmd)->lazy = policy->lazy_deserialize;
+
+	uint32_t timeout = as_command_server_timeout(&policy->base);
+	uint8_t* p = as_command_write_header_read(cmd->buf, &policy->base, policy->read_mode_ap,
+					policy->read_mode_sc, policy->read_touch_ttl_percent, timeout, tdata.n_fields,
+					proj->n_bins, AS_MSG_INFO1_READ, 0, 0);
+
+	p = as_command_write_key(p, &policy->base, policy->key, key, &tdata);
+	p = as_command_write_filter(&policy->base, filter_size, p);
+	memcpy(p, proj->ops, proj->ops_size);
+	p += proj->ops_size;
+	cmd->write_len = (uint32_t)as_command_write_end(cmd->buf, p);
+	return as_event_command_execute_read(cmd, key, policy, err);
 }
 
 //---------------------------------
@@ -762,6 +1147,10 @@ aerospike_key_exists(
 	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
 	)
 {
+	if (as_sync_async_eligible(as) && ! (rec && *rec)) {
+		return as_sync_async_exists(as, err, policy, key, rec);
+	}
+
 	as_policy_read merged;
 	policy = as_policy_read_merge(as, policy, &merged);
 
@@ -778,7 +1167,7 @@ aerospike_key_exists(
 	uint32_t filter_size = as_command_filter_size(&policy->base, &tdata.n_fields);
 	size += filter_size;
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint8_t* p = as_command_write_header_read_header(buf, &policy->base, policy->read_mode_ap,
 		policy->read_mode_sc, policy->read_touch_ttl_percent, tdata.n_fields, 0,
 		AS_MSG_INFO1_READ | AS_MSG_INFO1_GET_NOBINDATA);
@@ -788,9 +1177,10 @@ aerospike_key_exists(
 	size = as_command_write_end(buf, p);
 
 	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_header, rec);
+				policy->read_mode_sc, key, buf, size, &pi, as_command_parse_header, rec,
+				as_command_hedge_flag(policy));
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 
 	if (status != AEROSPIKE_OK && rec) {
 		*rec = NULL;
@@ -836,7 +1226,7 @@ aerospike_key_exists_async(
 	p = as_command_write_key(p, &policy->base, policy->key, key, &tdata);
 	p = as_command_write_filter(&policy->base, filter_size, p);
 	cmd->write_len = (uint32_t)as_command_write_end(cmd->buf, p);
-	return as_event_command_execute(cmd, err);
+	return as_event_command_execute_read(cmd, key, policy, err);
 }
 
 //---------------------------------
@@ -872,7 +1262,8 @@ as_put_init(
 	as_bin* bins = rec->bins.entries;
 
 	for (uint16_t i = 0; i < put->n_bins; i++) {
-		as_status status = as_command_bin_size(&bins[i], buffers, &put->size, err);
+		as_status status = as_command_bin_size_compress(&bins[i], policy->bin_compress_codec,
+			policy->bin_compress_threshold, buffers, &put->size, err);
 
 		if (status != AEROSPIKE_OK) {
 			return status;
@@ -881,10 +1272,9 @@ as_put_init(
 	return AEROSPIKE_OK;
 }
 
-static size_t
-as_put_write(void* udata, uint8_t* buf)
+static uint8_t*
+as_put_write_header(as_put* put, uint8_t* buf)
 {
-	as_put* put = udata;
 	const as_policy_write* policy = put->policy;
 	as_record* rec = put->rec;
 	uint32_t ttl = (rec->ttl == AS_RECORD_CLIENT_DEFAULT_TTL)? policy->ttl : rec->ttl;
@@ -894,19 +1284,94 @@ as_put_write(void* udata, uint8_t* buf)
 		policy->durable_delete, policy->on_locking_only, 0, AS_MSG_INFO2_WRITE, 0);
 
 	p = as_command_write_key(p, &policy->base, policy->key, put->key, &put->tdata);
-	p = as_command_write_filter(&policy->base, put->filter_size, p);
+	return as_command_write_filter(&policy->base, put->filter_size, p);
+}
 
-	as_bin* bins = rec->bins.entries;
+static size_t
+as_put_write(void* udata, uint8_t* buf)
+{
+	as_put* put = udata;
+	uint8_t* p = as_put_write_header(put, buf);
+	as_bin* bins = put->rec->bins.entries;
 	uint16_t n_bins = put->n_bins;
 	as_queue* buffers = put->buffers;
 
+	uint32_t threshold = put->policy->bin_compress_threshold;
+
 	for (uint16_t i = 0; i < n_bins; i++) {
-		p = as_command_write_bin(p, AS_OPERATOR_WRITE, &bins[i], buffers);
+		p = as_command_write_bin_compress(p, AS_OPERATOR_WRITE, &bins[i], threshold, buffers);
 	}
 	as_buffers_destroy(buffers);
 	return as_command_write_end(buf, p);
 }
 
+// Each referenced value adds a value segment and the command buffer segment before it.
+#define AS_PUT_REF_MAX ((AS_SOCKET_IOV_MAX - 1) / 2)
+
+static size_t
+as_put_ref_size(as_put* put)
+{
+	as_bin* bins = put->rec->bins.entries;
+	uint32_t threshold = put->policy->bin_compress_threshold;
+	size_t ref_size = 0;
+	uint32_t n_refs = 0;
+
+	for (uint16_t i = 0; i < put->n_bins && n_refs < AS_PUT_REF_MAX; i++) {
+		if (as_command_bin_compressible(&bins[i], threshold)) {
+			continue;
+		}
+
+		size_t size = as_command_bin_ref_size(&bins[i]);
+
+		if (size > 0) {
+			ref_size += size;
+			n_refs++;
+		}
+	}
+	return ref_size;
+}
+
+// Write command without large bytes/string values and return segments that interleave
+// the command buffer with those values.
+static size_t
+as_put_write_refs(as_put* put, uint8_t* buf, as_socket_iov* iov, uint32_t* iov_count)
+{
+	uint8_t* p = as_put_write_header(put, buf);
+	uint8_t* seg = buf;
+	as_bin* bins = put->rec->bins.entries;
+	uint16_t n_bins = put->n_bins;
+	as_queue* buffers = put->buffers;
+	uint32_t threshold = put->policy->bin_compress_threshold;
+	size_t ref_size = 0;
+	uint32_t n_refs = 0;
+	uint32_t n = 0;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		if (n_refs < AS_PUT_REF_MAX && ! as_command_bin_compressible(&bins[i], threshold) &&
+			as_command_bin_ref_size(&bins[i]) > 0) {
+			p = as_command_write_bin_ref(p, AS_OPERATOR_WRITE, &bins[i], &iov[n + 1]);
+			iov[n].data = seg;
+			iov[n].size = p - seg;
+			ref_size += iov[n + 1].size;
+			n += 2;
+			n_refs++;
+			seg = p;
+		}
+		else {
+			p = as_command_write_bin_compress(p, AS_OPERATOR_WRITE, &bins[i], threshold, buffers);
+		}
+	}
+	as_buffers_destroy(buffers);
+
+	if (p > seg) {
+		iov[n].data = seg;
+		iov[n].size = p - seg;
+		n++;
+	}
+	*iov_count = n;
+	return as_command_write_end_len(buf, (p - buf) + ref_size);
+}
+
 const as_policy_write*
 as_policy_write_merge(aerospike* as, const as_policy_write* src, as_policy_write* mrg)
 {
@@ -915,8 +1380,14 @@ as_policy_write_merge(aerospike* as, const as_policy_write* src, as_policy_write
 		return &config->policies.write;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+
+		if (src->base.resolved == config) {
+			// Already merged with this configuration by as_policy_write_resolve().
+			return src;
+		}
+
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_write* cfg = &config->policies.write;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_WRITE_SOCKET_TIMEOUT)?
@@ -936,12 +1407,22 @@ as_policy_write_merge(aerospike* as, const as_policy_write* src, as_policy_write
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
+		mrg->base.ordered = src->base.ordered;
+		mrg->base.resolved = config;
 		mrg->commit_level = src->commit_level;
 		mrg->gen = src->gen;
 		mrg->exists = src->exists;
 		mrg->ttl = src->ttl;
 		mrg->compression_threshold = src->compression_threshold;
+		mrg->bin_compress_threshold = src->bin_compress_threshold;
+		mrg->bin_compress_codec = src->bin_compress_codec;
 		mrg->on_locking_only = src->on_locking_only;
 		return mrg;
 	}
@@ -950,11 +1431,28 @@ as_policy_write_merge(aerospike* as, const as_policy_write* src, as_policy_write
 	}
 }
 
+void
+as_policy_write_resolve(aerospike* as, const as_policy_write* src, as_policy_write* out)
+{
+	if (!src) {
+		as_policy_write_default(as, out);
+	}
+	else if (src != out) {
+		as_policy_write_copy(src, out);
+	}
+	out->base.resolved = NULL;
+	as_policy_write_merge(as, out, out);
+}
+
 as_status
 aerospike_key_put(
 	aerospike* as, as_error* err, const as_policy_write* policy, const as_key* key, as_record* rec
 	)
 {
+	if (as_sync_async_eligible(as)) {
+		return as_sync_async_put(as, err, policy, key, rec);
+	}
+
 	as_policy_write merged;
 	policy = as_policy_write_merge(as, policy, &merged);
 
@@ -987,6 +1485,23 @@ aerospike_key_put(
 	as_command_init_write(&cmd, as->cluster, &policy->base, policy->replica, key, put.size, &pi,
 						  as_command_parse_header, NULL);
 
+	if (compression_threshold == 0 || put.size <= compression_threshold) {
+		size_t ref_size = as_put_ref_size(&put);
+
+		if (ref_size > 0) {
+			// Send large values from the record's memory instead of copying them.
+			as_socket_iov iov[AS_SOCKET_IOV_MAX];
+			size_t capacity = put.size - ref_size;
+			cmd.buf = as_command_buffer_init_alloc(&as->cluster->allocator, capacity);
+			cmd.buf_size = as_put_write_refs(&put, cmd.buf, iov, &cmd.iov_count);
+			cmd.iov = iov;
+			as_command_start_timer(&cmd);
+			status = as_command_execute(&cmd, err);
+			as_command_buffer_free_alloc(&as->cluster->allocator, cmd.buf, capacity);
+			return status;
+		}
+	}
+
 	status = as_command_send(&cmd, err, compression_threshold, as_put_write, &put);
 	return status;
 }
@@ -1083,8 +1598,8 @@ as_policy_remove_merge(aerospike* as, const as_policy_remove* src, as_policy_rem
 		return &config->policies.remove;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_remove* cfg = &config->policies.remove;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_WRITE_SOCKET_TIMEOUT)?
@@ -1104,7 +1619,14 @@ as_policy_remove_merge(aerospike* as, const as_policy_remove* src, as_policy_rem
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
+		mrg->base.ordered = src->base.ordered;
 		mrg->commit_level = src->commit_level;
 		mrg->gen = src->gen;
 		mrg->generation = src->generation;
@@ -1120,6 +1642,10 @@ aerospike_key_remove(
 	aerospike* as, as_error* err, const as_policy_remove* policy, const as_key* key
 	)
 {
+	if (as_sync_async_eligible(as)) {
+		return as_sync_async_remove(as, err, policy, key);
+	}
+
 	as_policy_remove merged;
 	policy = as_policy_remove_merge(as, policy, &merged);
 
@@ -1135,7 +1661,7 @@ aerospike_key_remove(
 	uint32_t filter_size = as_command_filter_size(&policy->base, &tdata.n_fields);
 	size += filter_size;
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint8_t* p = as_command_write_header_write(buf, &policy->base, policy->commit_level,
 		AS_POLICY_EXISTS_IGNORE, policy->gen, policy->generation, 0, tdata.n_fields, 0,
 		policy->durable_delete, false, 0, AS_MSG_INFO2_WRITE | AS_MSG_INFO2_DELETE, 0);
@@ -1152,7 +1678,7 @@ aerospike_key_remove(
 	as_command_start_timer(&cmd);
 	status = as_command_execute(&cmd, err);
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 	return status;
 }
 
@@ -1243,8 +1769,14 @@ as_policy_operate_merge(aerospike* as, bool is_write, const as_policy_operate* s
 		}
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+
+		if (src->base.resolved == config) {
+			// Already merged with this configuration by as_policy_operate_resolve().
+			return src;
+		}
+
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_operate* cfg = &config->policies.operate;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_WRITE_SOCKET_TIMEOUT)?
@@ -1268,7 +1800,15 @@ as_policy_operate_merge(aerospike* as, bool is_write, const as_policy_operate* s
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
+		mrg->base.ordered = src->base.ordered;
+		mrg->base.resolved = config;
 		mrg->commit_level = src->commit_level;
 		mrg->gen = src->gen;
 		mrg->exists = src->exists;
@@ -1285,6 +1825,77 @@ as_policy_operate_merge(aerospike* as, bool is_write, const as_policy_operate* s
 	}
 }
 
+void
+as_policy_operate_resolve(aerospike* as, const as_policy_operate* src, as_policy_operate* out)
+{
+	if (!src) {
+		as_policy_operate_default(as, out);
+	}
+	else if (src != out) {
+		as_policy_operate_copy(src, out);
+	}
+	out->base.resolved = NULL;
+	as_policy_operate_merge(as, true, out, out);
+}
+
+// Add command attributes required by operation. Return true if the operation requires
+// respond_all_ops.
+static inline bool
+as_operate_op_attr(const as_binop* op, uint8_t* read_attr, uint8_t* write_attr)
+{
+	bool respond_all_ops = false;
+
+	switch (op->op)	{
+		case AS_OPERATOR_MAP_READ:
+		case AS_OPERATOR_EXP_READ:
+		case AS_OPERATOR_BIT_READ:
+		case AS_OPERATOR_HLL_READ:
+			// Map operations require respond_all_ops to be true.
+			respond_all_ops = true;
+			// Fall through to read.
+		case AS_OPERATOR_CDT_READ:
+		case AS_OPERATOR_READ:
+			*read_attr |= AS_MSG_INFO1_READ;
+
+			if (op->bin.name[0] == 0) {
+				*read_attr |= AS_MSG_INFO1_GET_ALL;
+			}
+			break;
+			
+		case AS_OPERATOR_MAP_MODIFY:
+		case AS_OPERATOR_EXP_MODIFY:
+		case AS_OPERATOR_BIT_MODIFY:
+		case AS_OPERATOR_HLL_MODIFY:
+			// Map operations require respond_all_ops to be true.
+			respond_all_ops = true;
+			// Fall through to write.
+		default:
+			*write_attr |= AS_MSG_INFO2_WRITE;
+			break;
+	}
+	return respond_all_ops;
+}
+
+// Merge policy and add command attributes that depend on the policy.
+static const as_policy_operate*
+as_operate_policy_attr(
+	aerospike* as, const as_policy_operate* policy, as_policy_operate* policy_local,
+	bool respond_all_ops, uint8_t* read_attr, uint8_t* write_attr, uint8_t* info_attr
+	)
+{
+	bool is_write = (*write_attr & AS_MSG_INFO2_WRITE)? true : false;
+	policy = as_policy_operate_merge(as, is_write, policy, policy_local);
+
+	// When GET_ALL is specified, RESPOND_ALL_OPS must be disabled.
+	if ((respond_all_ops || policy->respond_all_ops) && !(*read_attr & AS_MSG_INFO1_GET_ALL)) {
+		*write_attr |= AS_MSG_INFO2_RESPOND_ALL_OPS;
+	}
+
+	as_command_set_attr_read(policy->read_mode_ap, policy->read_mode_sc, policy->base.compress,
+							 read_attr, info_attr);
+	return policy;
+}
+
 static as_status
 as_operate_init(
 	as_operate* oper, aerospike* as, const as_policy_operate* policy,
@@ -1305,34 +1916,9 @@ as_operate_init(
 
 	for (uint32_t i = 0; i < oper->n_operations; i++) {
 		as_binop* op = &oper->ops->binops.entries[i];
-		
-		switch (op->op)	{
-			case AS_OPERATOR_MAP_READ:
-			case AS_OPERATOR_EXP_READ:
-			case AS_OPERATOR_BIT_READ:
-			case AS_OPERATOR_HLL_READ:
-				// Map operations require respond_all_ops to be true.
-				respond_all_ops = true;
-				// Fall through to read.
-			case AS_OPERATOR_CDT_READ:
-			case AS_OPERATOR_READ:
-				oper->read_attr |= AS_MSG_INFO1_READ;
-
-				if (op->bin.name[0] == 0) {
-					oper->read_attr |= AS_MSG_INFO1_GET_ALL;
-				}
-				break;
-				
-			case AS_OPERATOR_MAP_MODIFY:
-			case AS_OPERATOR_EXP_MODIFY:
-			case AS_OPERATOR_BIT_MODIFY:
-			case AS_OPERATOR_HLL_MODIFY:
-				// Map operations require respond_all_ops to be true.
-				respond_all_ops = true;
-				// Fall through to write.
-			default:
-				oper->write_attr |= AS_MSG_INFO2_WRITE;
-				break;
+
+		if (as_operate_op_attr(op, &oper->read_attr, &oper->write_attr)) {
+			respond_all_ops = true;
 		}
 
 		as_status status = as_command_bin_size(&op->bin, oper->buffers, &oper->size, err);
@@ -1342,17 +1928,8 @@ as_operate_init(
 		}
 	}
 
-	bool is_write = (oper->write_attr & AS_MSG_INFO2_WRITE)? true : false;
-	policy = oper->policy = as_policy_operate_merge(as, is_write, policy, policy_local);
-
-	// When GET_ALL is specified, RESPOND_ALL_OPS must be disabled.
-	if ((respond_all_ops || policy->respond_all_ops) && !(oper->read_attr & AS_MSG_INFO1_GET_ALL)) {
-		oper->write_attr |= AS_MSG_INFO2_RESPOND_ALL_OPS;
-	}
-
-	as_command_set_attr_read(policy->read_mode_ap, policy->read_mode_sc, policy->base.compress,
-							 &oper->read_attr, &oper->info_attr);
-
+	oper->policy = as_operate_policy_attr(as, policy, policy_local, respond_all_ops,
+		&oper->read_attr, &oper->write_attr, &oper->info_attr);
 	return AEROSPIKE_OK;
 }
 
@@ -1367,23 +1944,26 @@ as_operate_size(as_operate* oper)
 	oper->size += oper->filter_size;
 }
 
+static inline uint32_t
+as_operate_ttl(const as_policy_operate* policy, uint8_t write_attr, uint32_t ops_ttl)
+{
+	if (write_attr & AS_MSG_INFO2_WRITE) {
+		return (ops_ttl == AS_RECORD_CLIENT_DEFAULT_TTL)? policy->ttl : ops_ttl;
+	}
+
+	// ttl is an unsigned 32 bit integer in the wire protocol, but it still
+	// works if a negative read_touch_ttl_percent is used. The server casts
+	// ttl back to a signed integer when all operations are read operations.
+	return (uint32_t)policy->read_touch_ttl_percent;
+}
+
 static size_t
 as_operate_write(void* udata, uint8_t* buf)
 {
 	as_operate* oper = udata;
 	const as_policy_operate* policy = oper->policy;
 	const as_operations* ops = oper->ops;
-	uint32_t ttl;
-	
-	if (oper->write_attr & AS_MSG_INFO2_WRITE) {
-		ttl = (ops->ttl == AS_RECORD_CLIENT_DEFAULT_TTL)? policy->ttl : ops->ttl;
-	}
-	else {
-		// ttl is an unsigned 32 bit integer in the wire protocol, but it still
-		// works if a negative read_touch_ttl_percent is used. The server casts
-		// ttl back to a signed integer when all operations are read operations.
-		ttl = (uint32_t)policy->read_touch_ttl_percent;
-	}
+	uint32_t ttl = as_operate_ttl(policy, oper->write_attr, ops->ttl);
 
 	uint8_t* p = as_command_write_header_write(buf, &policy->base, policy->commit_level,
 		policy->exists, policy->gen, ops->gen, ttl, oper->tdata.n_fields,
@@ -1416,6 +1996,10 @@ aerospike_key_operate(
 		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "No operations defined");
 	}
 
+	if (as_sync_async_eligible(as) && ! (rec && *rec)) {
+		return as_sync_async_operate(as, err, policy, key, ops, rec);
+	}
+
 	as_queue buffers;
 	as_queue_inita(&buffers, sizeof(as_buffer), n_operations);
 
@@ -1452,7 +2036,10 @@ aerospike_key_operate(
 
 	as_command_parse_result_data data;
 	data.record = rec;
+	data.buffer = NULL;
 	data.deserialize = policy->deserialize;
+	data.zero_copy = false;
+	data.lazy = false;
 
 	as_command cmd;
 
@@ -1464,6 +2051,7 @@ aerospike_key_operate(
 		as_command_init_read(&cmd, as->cluster, &policy->base, policy->replica, policy->read_mode_sc, key,
 							 oper.size, &pi, as_command_parse_result, &data);
 	}
+	cmd.latency_type = AS_LATENCY_TYPE_OPERATE;
 
 	uint32_t compression_threshold = policy->base.compress ? AS_COMPRESS_THRESHOLD : 0;
 
@@ -1519,7 +2107,7 @@ aerospike_key_operate_async(
 			cmd = as_async_record_command_create(
 				as->cluster, &policy->base, &pi, policy->replica, 0, policy->deserialize,
 				policy->async_heap_rec, 0, listener, udata, event_loop, pipe_listener, oper.size,
-				as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_WRITE, NULL, 0);
+				as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_OPERATE, NULL, 0);
 
 			cmd->write_len = (uint32_t)as_operate_write(&oper, cmd->buf);
 
@@ -1538,7 +2126,7 @@ aerospike_key_operate_async(
 			cmd = as_async_record_command_create(
 				as->cluster, &policy->base, &pi, policy->replica, 0, policy->deserialize,
 				policy->async_heap_rec, 0, listener, udata, event_loop, pipe_listener, comp_size,
-				as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_WRITE, ubuf, (uint32_t)size);
+				as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_OPERATE, ubuf, (uint32_t)size);
 
 			return as_async_compress_command_execute(as, err, &policy->base, key, cmd, &oper.tdata,
 				ubuf, size, comp_size, NULL, NULL);
@@ -1554,7 +2142,7 @@ aerospike_key_operate_async(
 			cmd = as_async_record_command_create(
 				as->cluster, &policy->base, &pi, ri.replica, ri.replica_index, policy->deserialize,
 				policy->async_heap_rec, ri.flags, listener, udata, event_loop, pipe_listener,
-				oper.size, as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, NULL, 0);
+				oper.size, as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_OPERATE, NULL, 0);
 
 			cmd->write_len = (uint32_t)as_operate_write(&oper, cmd->buf);
 		}
@@ -1574,10 +2162,10 @@ aerospike_key_operate_async(
 			cmd = as_async_record_command_create(
 				as->cluster, &policy->base, &pi, ri.replica, ri.replica_index, policy->deserialize,
 				policy->async_heap_rec, ri.flags, listener, udata, event_loop, pipe_listener,
-				comp_size, as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, ubuf, (uint32_t)size);
+				comp_size, as_event_command_parse_result, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_OPERATE, ubuf, (uint32_t)size);
 
 			// Compress buffer and execute.
-			status = as_command_compress(err, ubuf, size, cmd->buf, &comp_size);
+			status = as_command_compress(err, cmd->cluster, ubuf, size, cmd->buf, &comp_size);
 
 			if (status != AEROSPIKE_OK) {
 				as_event_command_destroy(cmd);
@@ -1587,9 +2175,224 @@ aerospike_key_operate_async(
 			cmd->write_len = (uint32_t)comp_size;
 		}
 
+		uint32_t delay_ms;
+		status = as_event_command_quota(cmd, key, err, &delay_ms);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+
 		// Call normal execute since readonly commands do not add keys to the transaction monitor.
-		return as_event_command_execute(cmd, err);
+		return as_event_command_execute_delay(cmd, delay_ms, err);
+	}
+}
+
+//---------------------------------
+// Prepared Operate
+//---------------------------------
+
+typedef struct as_operate_prepared_s {
+	const as_policy_operate* policy;
+	const as_key* key;
+	const as_prepared_operate* prep;
+	size_t size;
+	as_command_txn_data tdata;
+	uint32_t filter_size;
+	uint8_t read_attr;
+	uint8_t write_attr;
+	uint8_t info_attr;
+} as_operate_prepared;
+
+static size_t
+as_operate_prepared_write(void* udata, uint8_t* buf)
+{
+	as_operate_prepared* oper = udata;
+	const as_policy_operate* policy = oper->policy;
+	const as_prepared_operate* prep = oper->prep;
+	uint32_t ttl = as_operate_ttl(policy, oper->write_attr, prep->ttl);
+
+	uint8_t* p = as_command_write_header_write(buf, &policy->base, policy->commit_level,
+		policy->exists, policy->gen, prep->gen, ttl, oper->tdata.n_fields,
+		prep->n_operations, policy->durable_delete, policy->on_locking_only, oper->read_attr,
+		oper->write_attr, oper->info_attr);
+
+	p = as_command_write_key(p, &policy->base, policy->key, oper->key, &oper->tdata);
+	p = as_command_write_filter(&policy->base, oper->filter_size, p);
+	memcpy(p, prep->buf, prep->size);
+	p += prep->size;
+	return as_command_write_end(buf, p);
+}
+
+static as_status
+as_prepared_operate_value(
+	as_prepared_operate* prep, as_error* err, uint16_t index, uint8_t type, uint8_t** value
+	)
+{
+	if (index >= prep->n_operations) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid operation index: %u", index);
+	}
+
+	uint8_t* op = prep->buf + prep->offsets[index];
+	uint32_t op_size = cf_swap_from_be32(*(uint32_t*)op);
+	uint8_t name_len = op[7];
+
+	if (op[5] != type || op_size != 4 + name_len + 8) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Operation %u value type is not %s", index,
+			(type == AS_BYTES_INTEGER)? "integer" : "double");
+	}
+	*value = op + AS_OPERATION_HEADER_SIZE + name_len;
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_prepared_operate_init(as_prepared_operate* prep, as_error* err, const as_operations* ops)
+{
+	as_error_reset(err);
+
+	uint32_t n_operations = ops->binops.size;
+
+	if (n_operations == 0) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "No operations defined");
+	}
+
+	as_queue buffers;
+	as_queue_inita(&buffers, sizeof(as_buffer), n_operations);
+
+	uint8_t read_attr = 0;
+	uint8_t write_attr = 0;
+	bool respond_all_ops = false;
+	size_t size = 0;
+
+	for (uint32_t i = 0; i < n_operations; i++) {
+		as_binop* op = &ops->binops.entries[i];
+
+		if (as_operate_op_attr(op, &read_attr, &write_attr)) {
+			respond_all_ops = true;
+		}
+
+		as_status status = as_command_bin_size(&op->bin, &buffers, &size, err);
+
+		if (status != AEROSPIKE_OK) {
+			as_buffers_destroy(&buffers);
+			return status;
+		}
+	}
+
+	prep->buf = cf_malloc(size);
+	prep->offsets = cf_malloc(sizeof(uint32_t) * n_operations);
+
+	uint8_t* p = prep->buf;
+
+	for (uint32_t i = 0; i < n_operations; i++) {
+		as_binop* op = &ops->binops.entries[i];
+		prep->offsets[i] = (uint32_t)(p - prep->buf);
+		p = as_command_write_bin(p, op->op, &op->bin, &buffers);
+	}
+	as_buffers_destroy(&buffers);
+
+	prep->size = (uint32_t)size;
+	prep->ttl = ops->ttl;
+	prep->gen = ops->gen;
+	prep->n_operations = (uint16_t)n_operations;
+	prep->read_attr = read_attr;
+	prep->write_attr = write_attr;
+	prep->respond_all_ops = respond_all_ops;
+	return AEROSPIKE_OK;
+}
+
+void
+as_prepared_operate_destroy(as_prepared_operate* prep)
+{
+	cf_free(prep->buf);
+	cf_free(prep->offsets);
+}
+
+as_status
+as_prepared_operate_set_int64(as_prepared_operate* prep, as_error* err, uint16_t index, int64_t value)
+{
+	uint8_t* p;
+	as_status status = as_prepared_operate_value(prep, err, index, AS_BYTES_INTEGER, &p);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
 	}
+	*(uint64_t*)p = cf_swap_to_be64((uint64_t)value);
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_prepared_operate_set_double(as_prepared_operate* prep, as_error* err, uint16_t index, double value)
+{
+	uint8_t* p;
+	as_status status = as_prepared_operate_value(prep, err, index, AS_BYTES_DOUBLE, &p);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+	*(double*)p = cf_swap_to_big_float64(value);
+	return AEROSPIKE_OK;
+}
+
+as_status
+aerospike_key_operate_prepared(
+	aerospike* as, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_prepared_operate* prep, as_record** rec
+	)
+{
+	as_policy_operate policy_local;
+	as_operate_prepared oper;
+	oper.key = key;
+	oper.prep = prep;
+	oper.read_attr = prep->read_attr;
+	oper.write_attr = prep->write_attr;
+	oper.info_attr = 0;
+
+	policy = oper.policy = as_operate_policy_attr(as, policy, &policy_local, prep->respond_all_ops,
+		&oper.read_attr, &oper.write_attr, &oper.info_attr);
+
+	as_partition_info pi;
+	as_status status = as_command_prepare(as->cluster, err, &policy->base, key, &pi);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	bool is_write = (oper.write_attr & AS_MSG_INFO2_WRITE)? true : false;
+
+	if (policy->base.txn && is_write) {
+		status = as_txn_monitor_add_key(as, &policy->base, key, err);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	oper.size = as_command_key_size(&policy->base, policy->key, key, is_write, &oper.tdata);
+	oper.filter_size = as_command_filter_size(&policy->base, &oper.tdata.n_fields);
+	oper.size += oper.filter_size + prep->size;
+
+	as_command_parse_result_data data;
+	data.record = rec;
+	data.buffer = NULL;
+	data.deserialize = policy->deserialize;
+	data.zero_copy = false;
+	data.lazy = false;
+
+	as_command cmd;
+
+	if (is_write) {
+		as_command_init_write(&cmd, as->cluster, &policy->base, policy->replica, key, oper.size, &pi,
+							  as_command_parse_result, &data);
+	}
+	else {
+		as_command_init_read(&cmd, as->cluster, &policy->base, policy->replica, policy->read_mode_sc, key,
+							 oper.size, &pi, as_command_parse_result, &data);
+	}
+	cmd.latency_type = AS_LATENCY_TYPE_OPERATE;
+
+	uint32_t compression_threshold = policy->base.compress ? AS_COMPRESS_THRESHOLD : 0;
+	return as_command_send(&cmd, err, compression_threshold, as_operate_prepared_write, &oper);
 }
 
 //---------------------------------
@@ -1604,8 +2407,8 @@ as_policy_apply_merge(aerospike* as, const as_policy_apply* src, as_policy_apply
 		return &config->policies.apply;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_apply* cfg = &config->policies.apply;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_WRITE_SOCKET_TIMEOUT)?
@@ -1625,7 +2428,14 @@ as_policy_apply_merge(aerospike* as, const as_policy_apply* src, as_policy_apply
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
+		mrg->base.ordered = src->base.ordered;
 		mrg->commit_level = src->commit_level;
 		mrg->ttl = src->ttl;
 		mrg->on_locking_only = src->on_locking_only;
@@ -1718,6 +2528,7 @@ aerospike_key_apply(
 	as_command cmd;
 	as_command_init_write(&cmd, as->cluster, &policy->base, policy->replica, key, size, &pi,
 						  as_command_parse_success_failure, result);
+	cmd.latency_type = AS_LATENCY_TYPE_UDF;
 
 	uint32_t compression_threshold = policy->base.compress ? AS_COMPRESS_THRESHOLD : 0;
 
@@ -1754,6 +2565,7 @@ aerospike_key_apply_async(
 		as_event_command* cmd = as_async_value_command_create(as->cluster, &policy->base, &pi,
 			policy->replica, listener, udata, event_loop, pipe_listener, size,
 			as_event_command_parse_success_failure, NULL, 0);
+		cmd->latency_type = AS_LATENCY_TYPE_UDF;
 
 		cmd->write_len = (uint32_t)as_apply_write(&ap, cmd->buf);
 
@@ -1778,6 +2590,7 @@ aerospike_key_apply_async(
 		as_event_command* cmd = as_async_value_command_create(as->cluster, &policy->base, &pi,
 			policy->replica, listener, udata, event_loop, pipe_listener, comp_size,
 			as_event_command_parse_success_failure, ubuf, (uint32_t)size);
+		cmd->latency_type = AS_LATENCY_TYPE_UDF;
 
 		return as_async_compress_command_execute(as, err, &policy->base, key, cmd, &ap.tdata,
 			ubuf, size, comp_size, NULL, NULL);
@@ -1844,6 +2657,7 @@ as_txn_monitor_mark_roll_forward(
 	as_command cmd;
 	as_command_init_write(&cmd, as->cluster, &policy.base, policy.replica, key, put.size, &pi,
 						  as_txn_monitor_parse_header, NULL);
+	cmd.flags |= AS_COMMAND_FLAGS_TXN_MONITOR;
 
 	status = as_command_send(&cmd, err, 0, as_put_write, &put);
 
@@ -1915,7 +2729,8 @@ as_txn_monitor_mark_roll_forward_async(
 
 	cmd->write_len = (uint32_t)as_put_write(&put, cmd->buf);
 
-	status = as_async_command_execute(as, err, &policy.base, key, cmd, &put.tdata);
+	// Commit commands are not subject to client quotas.
+	status = as_event_command_execute(cmd, err);
 	
 	as_record_destroy(&rec);
 	return status;
@@ -2024,7 +2839,7 @@ as_txn_monitor_operate_async(
 			ubuf, (uint32_t)size);
 
 		// Compress buffer and execute.
-		status = as_command_compress(err, ubuf, size, cmd->buf, &comp_size);
+		status = as_command_compress(err, cmd->cluster, ubuf, size, cmd->buf, &comp_size);
 
 		if (status != AEROSPIKE_OK) {
 			as_event_command_destroy(cmd);
@@ -2074,7 +2889,7 @@ as_txn_verify_single(
 	size_t size = strlen(key->ns) + strlen(key->set) + sizeof(cf_digest) + 45;
 	size += 7 + AS_FIELD_HEADER_SIZE; // Version field
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 
 	buf[8] = 22;
@@ -2097,10 +2912,16 @@ as_txn_verify_single(
 	p = as_command_write_field_version(p, ver);
 	size = as_command_write_end(buf, p);
 
-	status = as_command_execute_read(cluster, err, &policy->base, policy->replica,
-			policy->read_mode_sc, key, buf, size, &pi, parse_result_code, NULL);
+	as_command cmd;
+	as_command_init_read(&cmd, cluster, &policy->base, policy->replica, policy->read_mode_sc, key,
+		size, &pi, parse_result_code, NULL);
+	cmd.buf = buf;
+	cmd.latency_type = AS_LATENCY_TYPE_TXN_VERIFY;
+	as_command_start_timer(&cmd);
+
+	status = as_command_execute(&cmd, err);
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 	return status;
 }
 
@@ -2149,7 +2970,7 @@ as_txn_verify_single_async(
 	as_event_command* cmd = as_async_record_command_create(
 		cluster, &policy->base, &pi, ri.replica, ri.replica_index, policy->deserialize,
 		false, ri.flags, listener, udata, event_loop, NULL, size,
-		txn_verify_parse, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_READ, NULL, 0);
+		txn_verify_parse, AS_ASYNC_TYPE_RECORD, AS_LATENCY_TYPE_TXN_VERIFY, NULL, 0);
 
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* buf = cmd->buf;
@@ -2207,7 +3028,7 @@ as_txn_roll_single(
 		n_fields++;
 	}
 
-	uint8_t* buf = as_command_buffer_init(size);
+	uint8_t* buf = as_command_buffer_init_alloc(&as->cluster->allocator, size);
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 
 	buf[8] = 22;
@@ -2237,11 +3058,12 @@ as_txn_roll_single(
 	as_command_init_write(&cmd, as->cluster, &policy->base, policy->replica, key, size, &pi,
 		parse_result_code, NULL);
 	cmd.buf = buf;
+	cmd.latency_type = AS_LATENCY_TYPE_TXN_ROLL;
 	as_command_start_timer(&cmd);
 
 	status = as_command_execute(&cmd, err);
 
-	as_command_buffer_free(buf, size);
+	as_command_buffer_free_alloc(&as->cluster->allocator, buf, size);
 	return status;
 }
 
@@ -2296,6 +3118,7 @@ as_txn_roll_single_async(
 	as_event_command* cmd = as_async_write_command_create(
 		as->cluster, &policy->base, &pi, policy->replica, listener, udata, event_loop,
 		NULL, size, txn_roll_parse, NULL, 0);
+	cmd->latency_type = AS_LATENCY_TYPE_TXN_ROLL;
 
 	uint32_t timeout = as_command_server_timeout(&policy->base);
 	uint8_t* buf = cmd->buf;
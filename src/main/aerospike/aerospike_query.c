@@ -24,22 +24,27 @@
 #include <aerospike/as_config_file.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_exp.h>
+#include <aerospike/as_geo_region.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_lua_cache.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_module.h>
 #include <aerospike/as_msgpack.h>
 #include <aerospike/as_operations.h>
 #include <aerospike/as_partition_tracker.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_query.h>
+#include <aerospike/as_query_order.h>
 #include <aerospike/as_query_validate.h>
 #include <aerospike/as_random.h>
+#include <aerospike/as_rate_limiter.h>
 #include <aerospike/as_serializer.h>
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_status.h>
 #include <aerospike/as_stream.h>
-#include <aerospike/as_thread_pool.h>
 #include <aerospike/as_udf_context.h>
+#include <aerospike/as_work_pool.h>
 #include <aerospike/mod_lua.h>
 
 extern bool as_op_is_write[];
@@ -51,6 +56,31 @@ extern bool as_op_is_write[];
 #define QUERY_FOREGROUND 1
 #define QUERY_BACKGROUND 2
 
+// Initial capacity of the aggregation input ring. Must be a power of 2.
+#define AS_QUERY_STREAM_CAPACITY 256
+
+// Maximum values the aggregation thread takes from the ring per lock acquisition.
+#define AS_QUERY_STREAM_BATCH 64
+
+/**
+ * Aggregation input stream. Node threads append values to a growable ring buffer. The
+ * aggregation thread moves up to AS_QUERY_STREAM_BATCH values at a time to a private batch,
+ * so it locks the ring once per batch instead of once per value. Node threads only signal
+ * the condition when the aggregation thread is waiting.
+ */
+typedef struct as_query_stream_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	as_val** ring;
+	uint32_t capacity;
+	uint32_t head;
+	uint32_t size;
+	bool waiting;
+	uint32_t batch_offset;
+	uint32_t batch_size;
+	as_val* batch[AS_QUERY_STREAM_BATCH];
+} as_query_stream;
+
 typedef struct as_query_user_callback_s {
 	aerospike_query_foreach_callback callback;
 	void* udata;
@@ -69,7 +99,7 @@ typedef struct as_query_task_s {
 	void* udata;
 	as_error* err;
 	uint32_t* error_mutex;
-	cf_queue* input_queue;
+	as_query_stream* input_queue;
 	cf_queue* complete_q;
 	uint64_t task_id;
 	uint64_t cluster_key;
@@ -77,7 +107,6 @@ typedef struct as_query_task_s {
 	uint8_t* cmd;
 	size_t cmd_size;
 	uint8_t query_type;
-	bool first;
 } as_query_task;
 
 typedef struct as_query_task_aggr_s {
@@ -110,6 +139,9 @@ typedef struct as_async_query_executor {
 	uint16_t n_fields;
 	bool deserialize;
 	bool has_where;
+	bool adaptive_concurrency;
+	uint8_t priority;
+	uint8_t latency_tag;
 } as_async_query_executor;
 
 typedef struct as_async_query_command {
@@ -177,7 +209,59 @@ static const as_aerospike_hooks query_aerospike_hooks = {
 	.log = as_query_aerospike_log,
 };
 
-// This is a no-op. the queue and its contents are destroyed at end of aerospike_query_foreach().
+static void
+as_query_stream_init(as_query_stream* qs)
+{
+	pthread_mutex_init(&qs->lock, NULL);
+	pthread_cond_init(&qs->cond, NULL);
+	qs->ring = cf_malloc(sizeof(as_val*) * AS_QUERY_STREAM_CAPACITY);
+	qs->capacity = AS_QUERY_STREAM_CAPACITY;
+	qs->head = 0;
+	qs->size = 0;
+	qs->waiting = false;
+	qs->batch_offset = 0;
+	qs->batch_size = 0;
+}
+
+static void
+as_query_stream_destroy(as_query_stream* qs)
+{
+	// Release values that the aggregation did not read.
+	for (uint32_t i = qs->batch_offset; i < qs->batch_size; i++) {
+		if (qs->batch[i]) {
+			as_val_destroy(qs->batch[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < qs->size; i++) {
+		as_val* val = qs->ring[(qs->head + i) & (qs->capacity - 1)];
+
+		if (val) {
+			as_val_destroy(val);
+		}
+	}
+	cf_free(qs->ring);
+	pthread_cond_destroy(&qs->cond);
+	pthread_mutex_destroy(&qs->lock);
+}
+
+// Must hold lock.
+static void
+as_query_stream_grow(as_query_stream* qs)
+{
+	uint32_t capacity = qs->capacity * 2;
+	as_val** ring = cf_malloc(sizeof(as_val*) * capacity);
+
+	for (uint32_t i = 0; i < qs->size; i++) {
+		ring[i] = qs->ring[(qs->head + i) & (qs->capacity - 1)];
+	}
+	cf_free(qs->ring);
+	qs->ring = ring;
+	qs->capacity = capacity;
+	qs->head = 0;
+}
+
+// This is a no-op. the stream and its contents are destroyed at end of aerospike_query_foreach().
 static int
 as_input_stream_destroy(as_stream *s)
 {
@@ -187,20 +271,53 @@ as_input_stream_destroy(as_stream *s)
 static as_val*
 as_input_stream_read(const as_stream* s)
 {
-	as_val* val = NULL;
-	cf_queue_pop(as_stream_source(s), &val, CF_QUEUE_FOREVER);
-	return val;
+	as_query_stream* qs = as_stream_source(s);
+
+	if (qs->batch_offset < qs->batch_size) {
+		return qs->batch[qs->batch_offset++];
+	}
+
+	pthread_mutex_lock(&qs->lock);
+
+	while (qs->size == 0) {
+		qs->waiting = true;
+		pthread_cond_wait(&qs->cond, &qs->lock);
+	}
+	qs->waiting = false;
+
+	uint32_t n = (qs->size < AS_QUERY_STREAM_BATCH)? qs->size : AS_QUERY_STREAM_BATCH;
+	uint32_t mask = qs->capacity - 1;
+
+	for (uint32_t i = 0; i < n; i++) {
+		qs->batch[i] = qs->ring[(qs->head + i) & mask];
+	}
+	qs->head = (qs->head + n) & mask;
+	qs->size -= n;
+	pthread_mutex_unlock(&qs->lock);
+
+	qs->batch_offset = 1;
+	qs->batch_size = n;
+	return qs->batch[0];
 }
 
 static as_stream_status
 as_input_stream_write(const as_stream* s, as_val* val)
 {
-    if (cf_queue_push(as_stream_source(s), &val) != CF_QUEUE_OK) {
-        as_log_error("Write to client side stream failed.");
-        as_val_destroy(val);
-        return AS_STREAM_ERR;
-    }
-    return AS_STREAM_OK;
+	as_query_stream* qs = as_stream_source(s);
+
+	pthread_mutex_lock(&qs->lock);
+
+	if (qs->size == qs->capacity) {
+		as_query_stream_grow(qs);
+	}
+	qs->ring[(qs->head + qs->size) & (qs->capacity - 1)] = val;
+	qs->size++;
+
+	if (qs->waiting) {
+		pthread_cond_signal(&qs->cond);
+	}
+	pthread_mutex_unlock(&qs->lock);
+	return AS_STREAM_OK;
 }
 
 static const as_stream_hooks input_stream_hooks = {
@@ -258,6 +375,7 @@ as_query_partition_executor_destroy(as_async_query_executor* qe)
 	as_partition_tracker_destroy(qe->pt);
 	cf_free(qe->pt);
 	cf_free(qe->cmd_buf);
+	as_mem_stats_free(AS_MEM_TAG_SCAN, sizeof(as_partition_tracker) + qe->cmd_size);
 }
 
 static void
@@ -503,7 +621,8 @@ as_query_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 	as_query_task* task = cmd->udata;
 	uint8_t* p = buf;
 	uint8_t* end = buf + size;
-	as_status status;
+	as_status status = AEROSPIKE_OK;
+	uint32_t n_records = 0;
 
 	while (p < end) {
 		as_msg* msg = (as_msg*)p;
@@ -515,7 +634,8 @@ as_query_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 				// The server returned a fatal error.
 				return as_error_set_message(err, msg->result_code, as_error_string(msg->result_code));
 			}
-			return AEROSPIKE_NO_MORE_RECORDS;
+			status = AEROSPIKE_NO_MORE_RECORDS;
+			break;
 		}
 
 		if (task->pt) {
@@ -535,7 +655,8 @@ as_query_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 			// when the set does not exist on the target node.
 			if (msg->result_code == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
 				// Non-fatal error.
-				return AEROSPIKE_NO_MORE_RECORDS;
+				status = AEROSPIKE_NO_MORE_RECORDS;
+				break;
 			}
 			return as_error_set_message(err, msg->result_code, as_error_string(msg->result_code));
 		}
@@ -545,13 +666,18 @@ as_query_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* b
 		if (status != AEROSPIKE_OK) {
 			return status;
 		}
+		n_records++;
 
 		if (as_load_uint32(task->error_mutex)) {
 			err->code = AEROSPIKE_ERR_QUERY_ABORTED;
 			return err->code;
 		}
 	}
-	return AEROSPIKE_OK;
+
+	if (task->query_policy && task->query_policy->rate_limiter) {
+		as_rate_limiter_acquire(task->query_policy->rate_limiter, n_records);
+	}
+	return status;
 }
 
 static uint8_t*
@@ -738,7 +864,8 @@ as_query_command_size(
 					filter_size += sizeof(int64_t) * 2;
 				}
 				else if (pred->dtype == AS_INDEX_GEO2DSPHERE) {
-					filter_size += (uint32_t)strlen(pred->value.string_val.string) * 2;
+					filter_size += pred->region ? pred->region->json_size * 2 :
+						(uint32_t)strlen(pred->value.string_val.string) * 2;
 				}
 				break;
 		}
@@ -988,8 +1115,14 @@ as_query_command_init(
 					p = as_query_write_range_integer(p, pred->value.integer_range.min, pred->value.integer_range.max);
 				}
 				else if (pred->dtype == AS_INDEX_GEO2DSPHERE) {
-					char* str = pred->value.string_val.string;
-					p = as_query_write_range_geojson(p, str, str);
+					if (pred->region) {
+						memcpy(p, pred->region->encoded, pred->region->encoded_size);
+						p += pred->region->encoded_size;
+					}
+					else {
+						char* str = pred->value.string_val.string;
+						p = as_query_write_range_geojson(p, str, str);
+					}
 				}
 				break;
 		}
@@ -1117,19 +1250,6 @@ as_query_command_execute_old(as_query_task* task)
 
 	as_status status;
 
-	if (task->cluster_key && ! task->first) {
-		uint32_t timeout = task->query_policy? task->query_policy->info_timeout : 10000;
-		status = as_query_validate(&err, task->node, task->query->ns, timeout, task->cluster_key);
-
-		if (status) {
-			// Set main error only once.
-			if (as_fas_uint32(task->error_mutex, 1) == 0) {
-				as_error_copy(task->err, &err);
-			}
-			return status;
-		}
-	}
-
 	const as_policy_base* policy;
 	uint8_t flags;
 
@@ -1154,6 +1274,8 @@ as_query_command_execute_old(as_query_task* task)
 	cmd.udata = task;
 	cmd.buf = task->cmd;
 	cmd.buf_size = task->cmd_size;
+	cmd.iov = NULL;
+	cmd.iov_count = 0;
 	cmd.partition_id = 0; // Not referenced when node set.
 	cmd.replica = AS_POLICY_REPLICA_MASTER;
 	cmd.flags = flags;
@@ -1180,6 +1302,8 @@ as_query_command_execute_old(as_query_task* task)
 	}
 
 	if (task->cluster_key) {
+		// A rebalance before or during this node's query changes the cluster key, so a single
+		// check after the query covers both. Node checks run in parallel on the thread pool.
 		uint32_t timeout = task->query_policy? task->query_policy->info_timeout : 10000;
 		status = as_query_validate(&err, task->node, task->query->ns, timeout, task->cluster_key);
 
@@ -1239,7 +1363,7 @@ as_query_command_execute_new(as_query_task* task)
 		return status;
 	}
 
-	uint8_t* buf = as_command_buffer_init(qb.size);
+	uint8_t* buf = as_command_buffer_init_alloc(&task->cluster->allocator, qb.size);
 	size_t size = as_query_command_init(buf, base_policy, task->query_policy, task->write_policy,
 		task->query, task->query_type, task->task_id, &qb);
 
@@ -1257,6 +1381,8 @@ as_query_command_execute_new(as_query_task* task)
 	cmd.udata = task;
 	cmd.buf = buf;
 	cmd.buf_size = size;
+	cmd.iov = NULL;
+	cmd.iov_count = 0;
 	cmd.partition_id = 0; // Not referenced when node set.
 	cmd.replica = AS_POLICY_REPLICA_MASTER;
 	cmd.flags = flags;
@@ -1272,7 +1398,7 @@ as_query_command_execute_new(as_query_task* task)
 	status = as_command_execute(&cmd, &err);
 
 	// Free command memory.
-	as_command_buffer_free(buf, qb.size);
+	as_command_buffer_free_alloc(&task->cluster->allocator, buf, qb.size);
 
 	if (status != AEROSPIKE_OK) {
 		if (task->pt && as_partition_tracker_should_retry(task->pt, task->np, status)) {
@@ -1332,7 +1458,15 @@ static as_status
 as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes)
 {
 	as_cluster_add_command_count(task->cluster);
-	as_status status = AEROSPIKE_OK;
+
+	const as_policy_base* base = task->query_policy ?
+		&task->query_policy->base : &task->write_policy->base;
+	as_status status = as_cluster_quota_wait(task->cluster, task->err, query->ns, query->set,
+		AS_QUOTA_SCAN, base->total_timeout ? base->total_timeout : UINT32_MAX);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
 
 	if (task->query_policy && task->query_policy->fail_on_cluster_change) {
 		status = as_query_validate_begin(task->err, nodes->array[0], query->ns,
@@ -1367,7 +1501,7 @@ as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes)
 		return status;
 	}
 
-	uint8_t* cmd = as_command_buffer_init(qb.size);
+	uint8_t* cmd = as_command_buffer_init_alloc(&task->cluster->allocator, qb.size);
 	size_t size = as_query_command_init(cmd, base_policy, task->query_policy, task->write_policy,
 		task->query, task->query_type, task->task_id, &qb);
 
@@ -1376,7 +1510,7 @@ as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes)
 	task->complete_q = cf_queue_create(sizeof(as_query_complete_task), true);
 
 	uint32_t n_wait_nodes = nodes->size;
-	uint32_t thread_pool_size = task->cluster->thread_pool.thread_size;
+	uint32_t thread_pool_size = task->cluster->thread_pool->thread_size;
 
 	// Run tasks in parallel.
 	for (uint32_t i = 0; i < nodes->size; i++) {
@@ -1388,7 +1522,8 @@ as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes)
 		
 		// If the thread pool size is > 0 farm out the tasks to the pool, otherwise run in current thread.
 		if (thread_pool_size > 0) {
-			int rc = as_thread_pool_queue_task(&task->cluster->thread_pool, as_query_worker_old, task_node);
+			int rc = as_work_pool_queue_task(task->cluster->thread_pool, AS_WORK_PRIORITY_LOW,
+				as_query_worker_old, task_node);
 			
 			if (rc) {
 				// Thread could not be added. Abort entire query.
@@ -1405,7 +1540,6 @@ as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes)
 				break;
 			}
 		}
-		task->first = false;
 	}
 
 	// Wait for tasks to complete.
@@ -1434,7 +1568,7 @@ as_query_execute(as_query_task* task, const as_query* query, as_nodes* nodes)
 	cf_queue_destroy(task->complete_q);
 	
 	// Free command memory.
-	as_command_buffer_free(cmd, qb.size);
+	as_command_buffer_free_alloc(&task->cluster->allocator, cmd, qb.size);
 	
 	return status;
 }
@@ -1462,7 +1596,9 @@ as_query_aggregate(void* data)
 	// Apply the UDF to the result stream
 	as_result res;
 	as_result_init(&res);
-	
+
+	as_lua_cache_validate(query->apply.module);
+
 	as_status status = as_module_apply_stream(&mod_lua, &ctx, query->apply.module, query->apply.function, task->input_stream, query->apply.arglist, &output_stream, &res);
 	
 	if (status) {
@@ -1500,8 +1636,14 @@ as_query_partitions(
 	as_partition_tracker* pt, aerospike_query_foreach_callback callback, void* udata)
 {
 	as_cluster_add_command_count(cluster);
+	as_status status = as_cluster_quota_wait(cluster, err, query->ns, query->set, AS_QUOTA_SCAN,
+		policy->base.total_timeout ? policy->base.total_timeout : UINT32_MAX);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
 	uint64_t parent_id = as_random_get_uint64();
-	as_status status = AEROSPIKE_OK;
 
 	while (true) {
 		uint64_t task_id = as_random_get_uint64();
@@ -1539,8 +1681,7 @@ as_query_partitions(
 			.cluster_key = 0,
 			.cmd = NULL,
 			.cmd_size = 0,
-			.query_type = QUERY_FOREGROUND,
-			.first = true
+			.query_type = QUERY_FOREGROUND
 		};
 
 		if (n_nodes > 1) {
@@ -1557,7 +1698,8 @@ as_query_partitions(
 				task_node->np = as_vector_get(&pt->node_parts, i);
 				task_node->node = task_node->np->node;
 
-				int rc = as_thread_pool_queue_task(&cluster->thread_pool, as_query_worker_new, task_node);
+				int rc = as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_LOW,
+					as_query_worker_new, task_node);
 				
 				if (rc) {
 					// Thread could not be added. Abort entire query.
@@ -1674,6 +1816,8 @@ as_query_partition_execute_async(
 
 		as_event_command* cmd = (as_event_command*)qcmd;
 		cmd->buf = qcmd->space;
+		cmd->pool_class = 0;
+		cmd->order_hash = 0;
 
 		uint8_t* p = cmd->buf;
 
@@ -1757,6 +1901,10 @@ as_query_partition_execute_async(
 		cmd->replica_size = 1;
 		cmd->replica_index = 0;
 		cmd->txn = NULL;
+		cmd->priority = qe->priority;
+		cmd->latency_tag = qe->latency_tag;
+		cmd->limited = false;
+		cmd->adaptive_timeout_pct = 0;
 		cmd->ubuf = NULL;
 		cmd->ubuf_size = 0;
 		cmd->latency_type = AS_LATENCY_TYPE_QUERY;
@@ -1800,7 +1948,15 @@ as_query_partition_async(
 {
 	as_cluster_add_command_count(cluster);
 	pt->sleep_between_retries = 0;
-	as_status status = as_partition_tracker_assign(pt, cluster, query->ns, err);
+
+	// Async queries can not wait for their quota.
+	uint32_t delay_ms;
+	as_status status = as_cluster_quota_acquire(cluster, err, query->ns, query->set,
+		AS_QUOTA_SCAN, 0, &delay_ms);
+
+	if (status == AEROSPIKE_OK) {
+		status = as_partition_tracker_assign(pt, cluster, query->ns, err);
+	}
 
 	if (status != AEROSPIKE_OK) {
 		as_partition_tracker_destroy(pt);
@@ -1837,6 +1993,7 @@ as_query_partition_async(
 	uint8_t* cmd_buf = cf_malloc(qb.size);
 	size_t cmd_size = as_query_command_init(cmd_buf, &policy->base, policy, NULL, query,
 		QUERY_FOREGROUND, task_id, &qb);
+	as_mem_stats_alloc(AS_MEM_TAG_SCAN, sizeof(as_partition_tracker) + (uint32_t)cmd_size);
 
 	as_async_query_executor* qe = cf_malloc(sizeof(as_async_query_executor));
 	qe->listener = listener;
@@ -1852,24 +2009,35 @@ as_query_partition_async(
 	qe->n_fields = qb.n_fields;
 	qe->deserialize = policy->deserialize;
 	qe->has_where = query->where.size > 0;
+	qe->adaptive_concurrency = policy->adaptive_concurrency;
+	qe->priority = (uint8_t)policy->base.priority;
+	qe->latency_tag = policy->base.latency_tag;
 
 	uint32_t n_nodes = pt->node_parts.size;
 
 	as_event_executor* ee = &qe->executor;
 	pthread_mutex_init(&ee->lock, NULL);
 	ee->max = n_nodes;
-	ee->max_concurrent = n_nodes;
 	ee->commands = cf_malloc(sizeof(as_event_command*) * n_nodes);
 	ee->event_loop = as_event_assign(event_loop);
 	ee->complete_fn = as_query_partition_complete_async;
 	ee->udata = udata;
 	ee->err = NULL;
 	ee->ns = cf_strdup(query->ns);
+	ee->flow = policy->flow;
+	ee->paused = NULL;
 	ee->cluster_key = 0;
 	ee->count = 0;
 	ee->queued = 0;
+	ee->n_paused = 0;
 	ee->notify = true;
 	ee->valid = true;
+	ee->spread = false;
+	as_event_executor_set_concurrency(ee, n_nodes, policy->adaptive_concurrency);
+
+	if (ee->flow) {
+		ee->flow->executor = ee;
+	}
 
 	return as_query_partition_execute_async(qe, pt, err);
 }
@@ -1891,6 +2059,9 @@ as_query_partition_retry_async(as_async_query_executor* qe_old, as_error* err)
 	qe->n_fields = qe_old->n_fields;
 	qe->deserialize = qe_old->deserialize;
 	qe->has_where = qe_old->has_where;
+	qe->adaptive_concurrency = qe_old->adaptive_concurrency;
+	qe->priority = qe_old->priority;
+	qe->latency_tag = qe_old->latency_tag;
 
 	// Must change task_id each round. Otherwise, server rejects command.
 	uint64_t task_id = as_random_get_uint64();
@@ -1903,7 +2074,6 @@ as_query_partition_retry_async(as_async_query_executor* qe_old, as_error* err)
 	as_event_executor* ee = &qe->executor;
 	pthread_mutex_init(&ee->lock, NULL);
 	ee->max = n_nodes;
-	ee->max_concurrent = n_nodes;
 	ee->commands = cf_malloc(sizeof(as_event_command*) * n_nodes);
 	ee->event_loop = ee_old->event_loop;
 	ee->complete_fn = ee_old->complete_fn;
@@ -1911,11 +2081,21 @@ as_query_partition_retry_async(as_async_query_executor* qe_old, as_error* err)
 	ee->err = NULL;
 	ee->ns = ee_old->ns;
 	ee_old->ns = NULL;
+	ee->flow = ee_old->flow;
+	ee->paused = NULL;
 	ee->cluster_key = 0;
 	ee->count = 0;
 	ee->queued = 0;
+	ee->n_paused = 0;
 	ee->notify = true;
 	ee->valid = true;
+	ee->spread = false;
+	as_event_executor_set_concurrency(ee, n_nodes, qe->adaptive_concurrency);
+
+	if (ee->flow) {
+		// Old executor is destroyed after this retry is started.
+		ee->flow->executor = ee;
+	}
 	as_cluster_add_retry(qe->cluster);
 
 	return as_query_partition_execute_async(qe, qe->pt, err);
@@ -1931,6 +2111,9 @@ convert_query_to_scan(
 	memcpy(&scan_policy->base, &query_policy->base, sizeof(as_policy_base));
 	scan_policy->max_records = query->max_records;
 	scan_policy->records_per_second = query->records_per_second;
+	scan_policy->flow = query_policy->flow;
+	scan_policy->rate_limiter = query_policy->rate_limiter;
+	scan_policy->adaptive_concurrency = query_policy->adaptive_concurrency;
 
 	as_scan_init(scan, query->ns, query->set);
 	scan->select.entries = query->select.entries;
@@ -1959,8 +2142,8 @@ as_policy_query_merge(aerospike* as, const as_policy_query* src, as_policy_query
 		return &config->policies.query;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_query* cfg = &config->policies.query;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_QUERY_SOCKET_TIMEOUT)?
@@ -1980,7 +2163,18 @@ as_policy_query_merge(aerospike* as, const as_policy_query* src, as_policy_query
 
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
+		mrg->base.cancel = src->base.cancel;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
+		mrg->commands_per_node = src->commands_per_node;
+		mrg->flow = src->flow;
+		mrg->checkpoint_path = src->checkpoint_path;
+		mrg->checkpoint_interval = src->checkpoint_interval;
+		mrg->rate_limiter = src->rate_limiter;
 		mrg->fail_on_cluster_change = src->fail_on_cluster_change;
 		mrg->deserialize = src->deserialize;
 		mrg->short_query = src->short_query;
@@ -1991,20 +2185,8 @@ as_policy_query_merge(aerospike* as, const as_policy_query* src, as_policy_query
 	}
 }
 
-//---------------------------------
-// Functions
-//---------------------------------
-
-bool
-as_async_query_should_retry(as_event_command* cmd, as_status status)
-{
-	as_async_query_command* qc = (as_async_query_command*)cmd;
-	as_async_query_executor* qe = cmd->udata;
-	return as_partition_tracker_should_retry(qe->pt, qc->np, status);
-}
-
-as_status
-aerospike_query_foreach(
+static as_status
+as_query_foreach(
 	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
 	aerospike_query_foreach_callback callback, void* udata)
 {
@@ -2032,7 +2214,7 @@ aerospike_query_foreach(
 
 		as_partition_tracker pt;
 		status = as_partition_tracker_init_nodes(&pt, cluster, &policy->base, query->max_records,
-			policy->replica, &query->parts_all, query->paginate, n_nodes, err);
+			policy->replica, policy->commands_per_node, &query->parts_all, query->paginate, n_nodes, err);
 
 		if (status != AEROSPIKE_OK) {
 			return status;
@@ -2086,13 +2268,14 @@ aerospike_query_foreach(
 		.cluster_key = 0,
 		.cmd = NULL,
 		.cmd_size = 0,
-		.query_type = QUERY_FOREGROUND,
-		.first = true
+		.query_type = QUERY_FOREGROUND
 	};
 		
 	if (query->apply.function[0]) {
 		// Query with aggregation.
-		task.input_queue = cf_queue_create(sizeof(void*), true);
+		as_query_stream input_queue;
+		as_query_stream_init(&input_queue);
+		task.input_queue = &input_queue;
 		
 		// Stream for results from each node
 		as_stream input_stream;
@@ -2114,7 +2297,8 @@ aerospike_query_foreach(
 		task_aggr.complete_q = cf_queue_create(sizeof(as_status), true);
 		
 		// Run lua aggregation in separate thread.
-		int rc = as_thread_pool_queue_task(&cluster->thread_pool, as_query_aggregate, &task_aggr);
+		int rc = as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_LOW,
+			as_query_aggregate, &task_aggr);
 		
 		if (rc == 0) {
 			status = as_query_execute(&task, query, nodes);
@@ -2133,12 +2317,8 @@ aerospike_query_foreach(
 			
 		cf_queue_destroy(task_aggr.complete_q);
 		
-		// Empty input queue.
-		as_val* val = NULL;
-		while (cf_queue_pop(task.input_queue, &val, CF_QUEUE_NOWAIT) == CF_QUEUE_OK) {
-			as_val_destroy(val);
-		}
-		cf_queue_destroy(task.input_queue);
+		// Empty input stream.
+		as_query_stream_destroy(&input_queue);
 	}
 	else {
 		// Normal query without aggregation.
@@ -2152,8 +2332,8 @@ aerospike_query_foreach(
 	return status;
 }
 
-as_status
-aerospike_query_partitions(
+static as_status
+as_query_foreach_partitions(
 	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
 	as_partition_filter* pf, aerospike_query_foreach_callback callback, void* udata
 	)
@@ -2188,12 +2368,13 @@ aerospike_query_partitions(
 
 	as_partition_tracker pt;
 	status = as_partition_tracker_init_filter(&pt, cluster, &policy->base, query->max_records,
-		policy->replica, &query->parts_all, query->paginate, n_nodes, pf, err);
+		policy->replica, policy->commands_per_node, &query->parts_all, query->paginate, n_nodes, pf, err);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
 	}
 
+	as_partition_tracker_set_checkpoint(&pt, policy->checkpoint_path, policy->checkpoint_interval);
 	status = as_query_partitions(cluster, err, policy, query, &pt, callback, udata);
 
 	if (status != AEROSPIKE_OK) {
@@ -2203,8 +2384,8 @@ aerospike_query_partitions(
 	return status;
 }
 
-as_status
-aerospike_query_async(
+static as_status
+as_query_async(
 	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
 	as_async_query_record_listener listener, void* udata, as_event_loop* event_loop)
 {
@@ -2232,7 +2413,7 @@ aerospike_query_async(
 
 		as_partition_tracker* pt = cf_malloc(sizeof(as_partition_tracker));
 		status = as_partition_tracker_init_nodes(pt, cluster, &policy->base, query->max_records,
-			policy->replica, &query->parts_all, query->paginate, n_nodes, err);
+			policy->replica, policy->commands_per_node, &query->parts_all, query->paginate, n_nodes, err);
 
 		if (status != AEROSPIKE_OK) {
 			return status;
@@ -2250,6 +2431,14 @@ aerospike_query_async(
 		return aerospike_scan_async(as, err, &scan_policy, &scan, NULL, listener, udata, event_loop);
 	}
 
+	uint32_t delay_ms;
+	status = as_cluster_quota_acquire(cluster, err, query->ns, query->set, AS_QUOTA_SCAN, 0,
+		&delay_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
 	uint64_t task_id = as_random_get_uint64();
 	as_query_log_iter(0, task_id, 1);
 
@@ -2271,7 +2460,7 @@ aerospike_query_async(
 		return status;
 	}
 
-	uint8_t* cmd_buf = as_command_buffer_init(qb.size);
+	uint8_t* cmd_buf = as_command_buffer_init_alloc(&cluster->allocator, qb.size);
 	size_t size = as_query_command_init(cmd_buf, &policy->base, policy, NULL, query,
 		QUERY_FOREGROUND, task_id, &qb);
 
@@ -2282,7 +2471,7 @@ aerospike_query_async(
 		if (query->ops) {
 			as_buffers_destroy(&opsbuffers);
 		}
-		as_command_buffer_free(cmd_buf, qb.size);
+		as_command_buffer_free_alloc(&cluster->allocator, cmd_buf, qb.size);
 		return status;
 	}
 
@@ -2297,13 +2486,22 @@ aerospike_query_async(
 	exec->udata = udata;
 	exec->err = NULL;
 	exec->ns = NULL;
+	exec->flow = policy->flow;
+	exec->paused = NULL;
 	exec->cluster_key = 0;
 	exec->max_concurrent = nodes->size;
 	exec->max = nodes->size;
 	exec->count = 0;
 	exec->queued = 0;
+	exec->n_paused = 0;
 	exec->notify = true;
 	exec->valid = true;
+	exec->spread = false;
+	exec->adaptive = false;
+
+	if (exec->flow) {
+		exec->flow->executor = exec;
+	}
 	executor->listener = listener;
 	executor->info_timeout = policy->info_timeout;
 	executor->parent_id = 0;
@@ -2321,6 +2519,8 @@ aerospike_query_async(
 		qcmd->np = NULL;
 
 		as_event_command* cmd = &qcmd->command;
+		cmd->pool_class = 0;
+		cmd->order_hash = 0;
 		cmd->total_deadline = policy->base.total_timeout;
 		cmd->socket_timeout = policy->base.socket_timeout;
 		cmd->max_retries = 0;
@@ -2344,6 +2544,10 @@ aerospike_query_async(
 		cmd->replica_size = 1;
 		cmd->replica_index = 0;
 		cmd->txn = NULL;
+		cmd->priority = (uint8_t)policy->base.priority;
+		cmd->latency_tag = policy->base.latency_tag;
+		cmd->limited = false;
+		cmd->adaptive_timeout_pct = 0;
 		cmd->ubuf = NULL;
 		cmd->ubuf_size = 0;
 		cmd->latency_type = AS_LATENCY_TYPE_QUERY;
@@ -2352,7 +2556,7 @@ aerospike_query_async(
 	}
 	
 	// Free command buffer.
-	as_command_buffer_free(cmd_buf, qb.size);
+	as_command_buffer_free_alloc(&cluster->allocator, cmd_buf, qb.size);
 	
 	if (policy->fail_on_cluster_change) {
 		// Verify migrations are not in progress.
@@ -2380,8 +2584,8 @@ aerospike_query_async(
 	return status;
 }
 
-as_status
-aerospike_query_partitions_async(
+static as_status
+as_query_partitions_async(
 	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
 	as_partition_filter* pf, as_async_query_record_listener listener, void* udata,
 	as_event_loop* event_loop
@@ -2417,15 +2621,126 @@ aerospike_query_partitions_async(
 
 	as_partition_tracker* pt = cf_malloc(sizeof(as_partition_tracker));
 	status = as_partition_tracker_init_filter(pt, cluster, &policy->base, query->max_records,
-		policy->replica, &query->parts_all, query->paginate, n_nodes, pf, err);
+		policy->replica, policy->commands_per_node, &query->parts_all, query->paginate, n_nodes, pf, err);
 
 	if (status != AEROSPIKE_OK) {
 		cf_free(pt);
 		return status;
 	}
+	as_partition_tracker_set_checkpoint(pt, policy->checkpoint_path, policy->checkpoint_interval);
 	return as_query_partition_async(cluster, err, policy, query, pt, listener, udata, event_loop);
 }
 
+//---------------------------------
+// Functions
+//---------------------------------
+
+bool
+as_async_query_should_retry(as_event_command* cmd, as_status status)
+{
+	as_async_query_command* qc = (as_async_query_command*)cmd;
+	as_async_query_executor* qe = cmd->udata;
+	return as_partition_tracker_should_retry(qe->pt, qc->np, status);
+}
+
+as_status
+aerospike_query_foreach(
+	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
+	aerospike_query_foreach_callback callback, void* udata)
+{
+	if (! query->ordered) {
+		return as_query_foreach(as, err, policy, query, callback, udata);
+	}
+
+	if (as_query_order_validate(err, query) != AEROSPIKE_OK) {
+		return err->code;
+	}
+
+	as_query_sorter sorter;
+	as_query_sorter_init(&sorter, query, callback, udata);
+
+	as_status status = as_query_foreach(as, err, policy, query, as_query_sorter_callback, &sorter);
+
+	as_query_sorter_complete(&sorter, status);
+	as_query_sorter_destroy(&sorter);
+	return status;
+}
+
+as_status
+aerospike_query_partitions(
+	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
+	as_partition_filter* pf, aerospike_query_foreach_callback callback, void* udata
+	)
+{
+	if (! query->ordered) {
+		return as_query_foreach_partitions(as, err, policy, query, pf, callback, udata);
+	}
+
+	if (as_query_order_validate(err, query) != AEROSPIKE_OK) {
+		return err->code;
+	}
+
+	as_query_sorter sorter;
+	as_query_sorter_init(&sorter, query, callback, udata);
+
+	as_status status = as_query_foreach_partitions(as, err, policy, query, pf,
+		as_query_sorter_callback, &sorter);
+
+	as_query_sorter_complete(&sorter, status);
+	as_query_sorter_destroy(&sorter);
+	return status;
+}
+
+as_status
+aerospike_query_async(
+	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
+	as_async_query_record_listener listener, void* udata, as_event_loop* event_loop)
+{
+	if (! query->ordered) {
+		return as_query_async(as, err, policy, query, listener, udata, event_loop);
+	}
+
+	if (as_query_order_validate(err, query) != AEROSPIKE_OK) {
+		return err->code;
+	}
+
+	as_query_sorter* sorter = as_query_sorter_create(query, listener, udata);
+	as_status status = as_query_async(as, err, policy, query, as_query_sorter_listener, sorter,
+		event_loop);
+
+	if (status != AEROSPIKE_OK) {
+		// The listener is not called when an error is returned.
+		as_query_sorter_destroy(sorter);
+	}
+	return status;
+}
+
+as_status
+aerospike_query_partitions_async(
+	aerospike* as, as_error* err, const as_policy_query* policy, as_query* query,
+	as_partition_filter* pf, as_async_query_record_listener listener, void* udata,
+	as_event_loop* event_loop
+	)
+{
+	if (! query->ordered) {
+		return as_query_partitions_async(as, err, policy, query, pf, listener, udata, event_loop);
+	}
+
+	if (as_query_order_validate(err, query) != AEROSPIKE_OK) {
+		return err->code;
+	}
+
+	as_query_sorter* sorter = as_query_sorter_create(query, listener, udata);
+	as_status status = as_query_partitions_async(as, err, policy, query, pf,
+		as_query_sorter_listener, sorter, event_loop);
+
+	if (status != AEROSPIKE_OK) {
+		// The listener is not called when an error is returned.
+		as_query_sorter_destroy(sorter);
+	}
+	return status;
+}
+
 const as_policy_write*
 as_policy_write_merge(aerospike* as, const as_policy_write* src, as_policy_write* mrg);
 
@@ -2476,8 +2791,7 @@ aerospike_query_background(
 		.cluster_key = 0,
 		.cmd = NULL,
 		.cmd_size = 0,
-		.query_type = QUERY_BACKGROUND,
-		.first = true
+		.query_type = QUERY_BACKGROUND
 	};
 
 	status = as_query_execute(&task, query, nodes);
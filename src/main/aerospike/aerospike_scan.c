@@ -17,21 +17,24 @@
 #include <aerospike/aerospike_scan.h>
 #include <aerospike/aerospike_info.h>
 #include <aerospike/as_async.h>
+#include <aerospike/as_columnar.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_config_file.h>
 #include <aerospike/as_exp.h>
 #include <aerospike/as_job.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_msgpack.h>
 #include <aerospike/as_operations.h>
 #include <aerospike/as_partition_tracker.h>
 #include <aerospike/as_query_validate.h>
 #include <aerospike/as_random.h>
+#include <aerospike/as_rate_limiter.h>
 #include <aerospike/as_serializer.h>
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_socket.h>
-#include <aerospike/as_thread_pool.h>
+#include <aerospike/as_work_pool.h>
 #include <citrusleaf/cf_clock.h>
 #include <citrusleaf/cf_queue.h>
 
@@ -48,6 +51,11 @@ typedef struct as_scan_task_s {
 	const as_policy_scan* policy;
 	const as_scan* scan;
 	aerospike_scan_foreach_callback callback;
+	const as_columnar_schema* schema;
+	as_columnar_callback batch_callback;
+	as_columnar_builder* builder;
+	as_digest_callback digest_callback;
+	as_digest_chunk chunk;
 	void* udata;
 	as_error* err;
 	cf_queue* complete_q;
@@ -76,7 +84,10 @@ typedef struct as_async_scan_executor {
 	uint32_t task_id_offset;
 	uint16_t n_fields;
 	bool concurrent;
+	bool adaptive_concurrency;
 	bool deserialize_list_map;
+	uint8_t priority;
+	uint8_t latency_tag;
 } as_async_scan_executor;
 
 typedef struct as_async_scan_command {
@@ -124,6 +135,7 @@ as_scan_partition_executor_destroy(as_async_scan_executor* se)
 	as_partition_tracker_destroy(se->pt);
 	cf_free(se->pt);
 	cf_free(se->cmd_buf);
+	as_mem_stats_free(AS_MEM_TAG_SCAN, sizeof(as_partition_tracker) + se->cmd_size);
 }
 
 static void
@@ -327,13 +339,141 @@ as_scan_parse_record(uint8_t** pp, as_msg* msg, as_scan_task* task, as_error* er
 	return AEROSPIKE_OK;
 }
 
+static as_status
+as_scan_flush_columnar(as_scan_task* task)
+{
+	as_columnar_builder* cb = task->builder;
+	uint32_t n_rows = cb->n_rows;
+
+	if (n_rows == 0) {
+		return AEROSPIKE_OK;
+	}
+
+	struct ArrowArray batch;
+	as_columnar_builder_export(cb, &batch);
+
+	if (! task->batch_callback(&batch, task->udata)) {
+		return AEROSPIKE_ERR_CLIENT_ABORT;
+	}
+
+	// Only advance partition digests after the batch has been delivered, so a retry or
+	// checkpoint resumes after the last record the user received.
+	if (task->pt) {
+		for (uint32_t i = 0; i < n_rows; i++) {
+			as_partition_tracker_set_digest(task->pt, task->np, &cb->digests[i],
+				task->cluster->n_partitions);
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_scan_parse_columnar(uint8_t** pp, as_msg* msg, as_scan_task* task)
+{
+	uint8_t* p = *pp;
+	as_digest digest;
+	digest.init = false;
+
+	for (uint32_t i = 0; i < msg->n_fields; i++) {
+		uint32_t len = cf_swap_from_be32(*(uint32_t*)p) - 1;
+		p += 4;
+
+		if (*p++ == AS_FIELD_DIGEST && len >= AS_DIGEST_VALUE_SIZE) {
+			memcpy(digest.value, p, AS_DIGEST_VALUE_SIZE);
+			digest.init = true;
+		}
+		p += len;
+	}
+
+	if (as_partition_tracker_reached_max_records_sync(task->pt, task->np)) {
+		*pp = as_columnar_skip_bins(p, msg->n_ops);
+		return AEROSPIKE_OK;
+	}
+
+	*pp = as_columnar_builder_add(task->builder, p, msg->n_ops, &digest);
+
+	if (as_columnar_builder_full(task->builder)) {
+		return as_scan_flush_columnar(task);
+	}
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_scan_flush_digests(as_scan_task* task)
+{
+	as_digest_chunk* chunk = &task->chunk;
+	uint32_t n_rows = chunk->size;
+
+	if (n_rows == 0) {
+		return AEROSPIKE_OK;
+	}
+
+	if (! task->digest_callback(chunk, task->udata)) {
+		return AEROSPIKE_ERR_CLIENT_ABORT;
+	}
+
+	// Only advance partition digests after the chunk has been delivered.
+	if (task->pt) {
+		as_digest digest;
+		digest.init = true;
+
+		for (uint32_t i = 0; i < n_rows; i++) {
+			memcpy(digest.value, chunk->digests[i], AS_DIGEST_VALUE_SIZE);
+			as_partition_tracker_set_digest(task->pt, task->np, &digest,
+				task->cluster->n_partitions);
+		}
+	}
+	chunk->size = 0;
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_scan_parse_digest(uint8_t** pp, as_msg* msg, as_scan_task* task)
+{
+	uint8_t* p = *pp;
+	as_digest_chunk* chunk = &task->chunk;
+	uint32_t row = chunk->size;
+	bool found = false;
+
+	for (uint32_t i = 0; i < msg->n_fields; i++) {
+		uint32_t len = cf_swap_from_be32(*(uint32_t*)p) - 1;
+		p += 4;
+
+		if (*p++ == AS_FIELD_DIGEST && len >= AS_DIGEST_VALUE_SIZE) {
+			memcpy(chunk->digests[row], p, AS_DIGEST_VALUE_SIZE);
+			found = true;
+		}
+		p += len;
+	}
+
+	*pp = as_columnar_skip_bins(p, msg->n_ops);
+
+	if (! found || as_partition_tracker_reached_max_records_sync(task->pt, task->np)) {
+		return AEROSPIKE_OK;
+	}
+
+	if (chunk->generations) {
+		chunk->generations[row] = (uint16_t)msg->generation;
+	}
+
+	if (chunk->ttls) {
+		chunk->ttls[row] = cf_server_void_time_to_ttl(msg->record_ttl);
+	}
+
+	if (++chunk->size == chunk->capacity) {
+		return as_scan_flush_digests(task);
+	}
+	return AEROSPIKE_OK;
+}
+
 static as_status
 as_scan_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* buf, size_t size)
 {
 	as_scan_task* task = cmd->udata;
 	uint8_t* p = buf;
 	uint8_t* end = buf + size;
-	as_status status;
+	as_status status = AEROSPIKE_OK;
+	uint32_t n_records = 0;
 	
 	while (p < end) {
 		as_msg* msg = (as_msg*)p;
@@ -345,7 +485,8 @@ as_scan_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* bu
 				// The server returned a fatal error.
 				return as_error_set_message(err, msg->result_code, as_error_string(msg->result_code));
 			}
-			return AEROSPIKE_NO_MORE_RECORDS;
+			status = AEROSPIKE_NO_MORE_RECORDS;
+			break;
 		}
 
 		if (task->pt) {
@@ -365,23 +506,37 @@ as_scan_parse_records(as_error* err, as_command* cmd, as_node* node, uint8_t* bu
 			// when the set does not exist on the target node.
 			if (msg->result_code == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
 				// Non-fatal error.
-				return AEROSPIKE_NO_MORE_RECORDS;
+				status = AEROSPIKE_NO_MORE_RECORDS;
+				break;
 			}
 			return as_error_set_message(err, msg->result_code, as_error_string(msg->result_code));
 		}
 
-		status = as_scan_parse_record(&p, msg, task, err);
+		if (task->builder) {
+			status = as_scan_parse_columnar(&p, msg, task);
+		}
+		else if (task->digest_callback) {
+			status = as_scan_parse_digest(&p, msg, task);
+		}
+		else {
+			status = as_scan_parse_record(&p, msg, task, err);
+		}
 		
 		if (status != AEROSPIKE_OK) {
 			return status;
 		}
+		n_records++;
 		
 		if (as_load_uint32(task->error_mutex)) {
 			err->code = AEROSPIKE_ERR_SCAN_ABORTED;
 			return err->code;
 		}
 	}
-	return AEROSPIKE_OK;
+
+	if (task->policy->rate_limiter) {
+		as_rate_limiter_acquire(task->policy->rate_limiter, n_records);
+	}
+	return status;
 }
 
 static as_status
@@ -667,7 +822,7 @@ as_scan_command_execute(as_scan_task* task)
 		return status;
 	}
 
-	uint8_t* buf = as_command_buffer_init(sb.size);
+	uint8_t* buf = as_command_buffer_init_alloc(&task->cluster->allocator, sb.size);
 	size_t size = as_scan_command_init(buf, task->cluster, task->policy, task->scan, task->task_id, &sb);
 
 	as_command cmd;
@@ -682,12 +837,14 @@ as_scan_command_execute(as_scan_task* task)
 	cmd.udata = task;
 	cmd.buf = buf;
 	cmd.buf_size = size;
+	cmd.iov = NULL;
+	cmd.iov_count = 0;
 	cmd.partition_id = 0; // Not referenced when node set.
 	cmd.replica = AS_POLICY_REPLICA_MASTER;
 	cmd.flags = AS_COMMAND_FLAGS_READ;
 	cmd.replica_size = 1;
 	cmd.replica_index = 0;
-	cmd.latency_type = AS_LATENCY_TYPE_QUERY;
+	cmd.latency_type = AS_LATENCY_TYPE_SCAN;
 
 	as_command_start_timer(&cmd);
 
@@ -695,10 +852,40 @@ as_scan_command_execute(as_scan_task* task)
 	// the caller, as_scan_partitions().
 	cmd.max_retries = 0;
 
+	as_columnar_builder builder;
+
+	if (task->schema) {
+		as_columnar_builder_init(&builder, task->schema);
+		task->builder = &builder;
+	}
+
 	status = as_command_execute(&cmd, &err);
 
 	// Free command memory.
-	as_command_buffer_free(buf, sb.size);
+	as_command_buffer_free_alloc(&task->cluster->allocator, buf, sb.size);
+
+	if (task->schema) {
+		// Deliver the partial batch unless the user already aborted.
+		if (status != AEROSPIKE_ERR_CLIENT_ABORT) {
+			as_status rv = as_scan_flush_columnar(task);
+
+			if (rv != AEROSPIKE_OK && status == AEROSPIKE_OK) {
+				status = rv;
+			}
+		}
+		as_columnar_builder_destroy(&builder);
+		task->builder = NULL;
+	}
+	else if (task->digest_callback) {
+		if (status != AEROSPIKE_ERR_CLIENT_ABORT) {
+			as_status rv = as_scan_flush_digests(task);
+
+			if (rv != AEROSPIKE_OK && status == AEROSPIKE_OK) {
+				status = rv;
+			}
+		}
+		task->chunk.size = 0;
+	}
 
 	if (status) {
 		if (task->pt && as_partition_tracker_should_retry(task->pt, task->np, status)) {
@@ -762,7 +949,14 @@ as_scan_generic(
 	)
 {
 	as_cluster_add_command_count(cluster);
-	as_status status = as_scan_validate(err, policy, scan);
+	as_status status = as_cluster_quota_wait(cluster, err, scan->ns, scan->set, AS_QUOTA_SCAN,
+		policy->base.total_timeout ? policy->base.total_timeout : UINT32_MAX);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	status = as_scan_validate(err, policy, scan);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
@@ -809,7 +1003,8 @@ as_scan_generic(
 			memcpy(task_node, &task, sizeof(as_scan_task));
 			task_node->node = nodes->array[i];
 
-			int rc = as_thread_pool_queue_task(&cluster->thread_pool, as_scan_worker, task_node);
+			int rc = as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_LOW,
+				as_scan_worker, task_node);
 			
 			if (rc) {
 				// Thread could not be added. Abort entire scan.
@@ -879,11 +1074,19 @@ as_scan_partitions_validate(
 static as_status
 as_scan_partitions(
 	as_cluster* cluster, as_error* err, const as_policy_scan* policy, const as_scan* scan,
-	as_partition_tracker* pt, aerospike_scan_foreach_callback callback, void* udata)
+	as_partition_tracker* pt, aerospike_scan_foreach_callback callback,
+	const as_columnar_schema* schema, as_columnar_callback batch_callback,
+	const as_digest_chunk* chunk, as_digest_callback digest_callback, void* udata)
 {
 	as_cluster_add_command_count(cluster);
+	as_status status = as_cluster_quota_wait(cluster, err, scan->ns, scan->set, AS_QUOTA_SCAN,
+		policy->base.total_timeout ? policy->base.total_timeout : UINT32_MAX);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
 	uint64_t parent_id = as_random_get_uint64();
-	as_status status = AEROSPIKE_OK;
 
 	while (true) {
 		uint64_t task_id = as_random_get_uint64();
@@ -910,6 +1113,10 @@ as_scan_partitions(
 			.policy = policy,
 			.scan = scan,
 			.callback = callback,
+			.schema = schema,
+			.batch_callback = batch_callback,
+			.builder = NULL,
+			.digest_callback = digest_callback,
 			.udata = udata,
 			.err = err,
 			.error_mutex = &error_mutex,
@@ -918,7 +1125,13 @@ as_scan_partitions(
 			.first = false
 		};
 
-		if (scan->concurrent && n_nodes > 1) {
+		if (chunk) {
+			task.chunk = *chunk;
+			task.chunk.size = 0;
+		}
+
+		// Concurrent digest scans need at least one chunk row per node.
+		if (scan->concurrent && n_nodes > 1 && (! chunk || chunk->capacity >= n_nodes)) {
 			uint32_t n_wait_nodes = n_nodes;
 			task.complete_q = cf_queue_create(sizeof(as_scan_complete_task), true);
 
@@ -932,7 +1145,20 @@ as_scan_partitions(
 				task_node->np = as_vector_get(&pt->node_parts, i);
 				task_node->node = task_node->np->node;
 
-				int rc = as_thread_pool_queue_task(&cluster->thread_pool, as_scan_worker, task_node);
+				if (chunk) {
+					// Give each node its own contiguous slice of the caller's arrays.
+					uint32_t slice = chunk->capacity / n_nodes;
+					uint32_t offset = slice * i;
+
+					task_node->chunk.digests = chunk->digests + offset;
+					task_node->chunk.generations = chunk->generations ?
+						chunk->generations + offset : NULL;
+					task_node->chunk.ttls = chunk->ttls ? chunk->ttls + offset : NULL;
+					task_node->chunk.capacity = slice;
+				}
+
+				int rc = as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_LOW,
+					as_scan_worker, task_node);
 				
 				if (rc) {
 					// Thread could not be added. Abort entire scan.
@@ -993,7 +1219,7 @@ as_scan_partitions(
 		}
 	}
 
-	if (status == AEROSPIKE_OK) {
+	if (callback && status == AEROSPIKE_OK) {
 		callback(NULL, udata);
 	}
 	return status;
@@ -1038,6 +1264,8 @@ as_scan_partition_execute_async(as_async_scan_executor* se, as_partition_tracker
 
 		as_event_command* cmd = (as_event_command*)scmd;
 		cmd->buf = scmd->space;
+		cmd->pool_class = 0;
+		cmd->order_hash = 0;
 
 		uint8_t* p = cmd->buf;
 
@@ -1108,9 +1336,13 @@ as_scan_partition_execute_async(as_async_scan_executor* se, as_partition_tracker
 		cmd->replica_size = 1;
 		cmd->replica_index = 0;
 		cmd->txn = NULL;
+		cmd->priority = se->priority;
+		cmd->latency_tag = se->latency_tag;
+		cmd->limited = false;
+		cmd->adaptive_timeout_pct = 0;
 		cmd->ubuf = NULL;
 		cmd->ubuf_size = 0;
-		cmd->latency_type = AS_LATENCY_TYPE_QUERY;
+		cmd->latency_type = AS_LATENCY_TYPE_SCAN;
 		ee->commands[i] = cmd;
 	}
 
@@ -1157,7 +1389,10 @@ as_scan_partition_retry_async(as_async_scan_executor* se_old, as_error* err)
 	se->task_id_offset = se_old->task_id_offset;
 	se->n_fields = se_old->n_fields;
 	se->concurrent = se_old->concurrent;
+	se->adaptive_concurrency = se_old->adaptive_concurrency;
 	se->deserialize_list_map = se_old->deserialize_list_map;
+	se->priority = se_old->priority;
+	se->latency_tag = se_old->latency_tag;
 
 	// Must change task_id each round. Otherwise, server rejects command.
 	uint64_t task_id = as_random_get_uint64();
@@ -1170,7 +1405,6 @@ as_scan_partition_retry_async(as_async_scan_executor* se_old, as_error* err)
 	as_event_executor* ee = &se->executor;
 	pthread_mutex_init(&ee->lock, NULL);
 	ee->max = n_nodes;
-	ee->max_concurrent = se->concurrent ? n_nodes : 1;
 	ee->commands = cf_malloc(sizeof(as_event_command*) * n_nodes);
 	ee->event_loop = ee_old->event_loop;
 	ee->complete_fn = ee_old->complete_fn;
@@ -1178,11 +1412,21 @@ as_scan_partition_retry_async(as_async_scan_executor* se_old, as_error* err)
 	ee->err = NULL;
 	ee->ns = ee_old->ns;
 	ee_old->ns = NULL;
+	ee->flow = ee_old->flow;
+	ee->paused = NULL;
 	ee->cluster_key = 0;
 	ee->count = 0;
 	ee->queued = 0;
+	ee->n_paused = 0;
 	ee->notify = true;
 	ee->valid = true;
+	ee->spread = false;
+	as_event_executor_set_concurrency(ee, se->concurrent ? n_nodes : 1, se->adaptive_concurrency);
+
+	if (ee->flow) {
+		// Old executor is destroyed after this retry is started.
+		ee->flow->executor = ee;
+	}
 	as_cluster_add_retry(se->cluster);
 
 	return as_scan_partition_execute_async(se, se->pt, err);
@@ -1197,7 +1441,15 @@ as_scan_partition_async(
 {
 	as_cluster_add_command_count(cluster);
 	pt->sleep_between_retries = 0;
-	as_status status = as_partition_tracker_assign(pt, cluster, scan->ns, err);
+
+	// Async scans can not wait for their quota.
+	uint32_t delay_ms;
+	as_status status = as_cluster_quota_acquire(cluster, err, scan->ns, scan->set, AS_QUOTA_SCAN,
+		0, &delay_ms);
+
+	if (status == AEROSPIKE_OK) {
+		status = as_partition_tracker_assign(pt, cluster, scan->ns, err);
+	}
 
 	if (status != AEROSPIKE_OK) {
 		as_partition_tracker_destroy(pt);
@@ -1236,6 +1488,7 @@ as_scan_partition_async(
 
 	uint8_t* cmd_buf = cf_malloc(sb.size);
 	size_t cmd_size = as_scan_command_init(cmd_buf, cluster, policy, scan, task_id, &sb);
+	as_mem_stats_alloc(AS_MEM_TAG_SCAN, sizeof(as_partition_tracker) + (uint32_t)cmd_size);
 
 	as_async_scan_executor* se = cf_malloc(sizeof(as_async_scan_executor));
 	se->listener = listener;
@@ -1249,25 +1502,37 @@ as_scan_partition_async(
 	se->task_id_offset = sb.task_id_offset;
 	se->n_fields = sb.n_fields;
 	se->concurrent = scan->concurrent;
+	se->adaptive_concurrency = policy->adaptive_concurrency;
 	se->deserialize_list_map = scan->deserialize_list_map;
+	se->priority = (uint8_t)policy->base.priority;
+	se->latency_tag = policy->base.latency_tag;
 
 	uint32_t n_nodes = pt->node_parts.size;
 
 	as_event_executor* ee = &se->executor;
 	pthread_mutex_init(&ee->lock, NULL);
 	ee->max = n_nodes;
-	ee->max_concurrent = scan->concurrent ? n_nodes : 1;
 	ee->commands = cf_malloc(sizeof(as_event_command*) * n_nodes);
 	ee->event_loop = as_event_assign(event_loop);
 	ee->complete_fn = as_scan_partition_complete_async;
 	ee->udata = udata;
 	ee->err = NULL;
 	ee->ns = cf_strdup(scan->ns);
+	ee->flow = policy->flow;
+	ee->paused = NULL;
 	ee->cluster_key = 0;
 	ee->count = 0;
 	ee->queued = 0;
+	ee->n_paused = 0;
 	ee->notify = true;
 	ee->valid = true;
+	ee->spread = false;
+	as_event_executor_set_concurrency(ee, scan->concurrent ? n_nodes : 1,
+		policy->adaptive_concurrency);
+
+	if (ee->flow) {
+		ee->flow->executor = ee;
+	}
 
 	return as_scan_partition_execute_async(se, pt, err);
 }
@@ -1284,8 +1549,8 @@ as_policy_scan_merge(aerospike* as, const as_policy_scan* src, as_policy_scan* m
 		return &config->policies.scan;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_policy_scan* cfg = &config->policies.scan;
 
 		mrg->base.socket_timeout = as_field_is_set(bitmap, AS_SCAN_SOCKET_TIMEOUT)?
@@ -1302,8 +1567,18 @@ as_policy_scan_merge(aerospike* as, const as_policy_scan* src, as_policy_scan* m
 		mrg->base.filter_exp = src->base.filter_exp;
 		mrg->base.txn = src->base.txn;
 		mrg->base.compress = src->base.compress;
+		mrg->base.spin_read_us = src->base.spin_read_us;
+		mrg->base.priority = src->base.priority;
+		mrg->base.latency_tag = src->base.latency_tag;
+		mrg->base.adaptive_timeout_pct = src->base.adaptive_timeout_pct;
+		mrg->base.adaptive_timeout_min = src->base.adaptive_timeout_min;
 		mrg->max_records = src->max_records;
 		mrg->records_per_second = src->records_per_second;
+		mrg->commands_per_node = src->commands_per_node;
+		mrg->flow = src->flow;
+		mrg->checkpoint_path = src->checkpoint_path;
+		mrg->checkpoint_interval = src->checkpoint_interval;
+		mrg->rate_limiter = src->rate_limiter;
 		mrg->ttl = src->ttl;
 		mrg->durable_delete = src->durable_delete;
 		return mrg;
@@ -1393,13 +1668,14 @@ aerospike_scan_foreach(
 
 	as_partition_tracker pt;
 	status = as_partition_tracker_init_nodes(&pt, cluster, &policy->base, policy->max_records,
-		policy->replica, &scan->parts_all, scan->paginate, n_nodes, err);
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, n_nodes, err);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
 	}
 
-	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, udata);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, NULL, NULL, NULL, NULL,
+		udata);
 
 	if (status != AEROSPIKE_OK) {
 		as_partition_error(scan->parts_all);
@@ -1435,14 +1711,15 @@ aerospike_scan_node(
 
 	as_partition_tracker pt;
 	status = as_partition_tracker_init_node(&pt, cluster, &policy->base, policy->max_records,
-		policy->replica, &scan->parts_all, scan->paginate, node, err);
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, node, err);
 
 	if (status != AEROSPIKE_OK) {
 		as_node_release(node);
 		return status;
 	}
 
-	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, udata);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, NULL, NULL, NULL, NULL,
+		udata);
 
 	if (status != AEROSPIKE_OK) {
 		as_partition_error(scan->parts_all);
@@ -1476,13 +1753,125 @@ aerospike_scan_partitions(
 
 	as_partition_tracker pt;
 	status = as_partition_tracker_init_filter(&pt, cluster, &policy->base, policy->max_records,
-		policy->replica, &scan->parts_all, scan->paginate, n_nodes, pf, err);
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, n_nodes, pf, err);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_partition_tracker_set_checkpoint(&pt, policy->checkpoint_path, policy->checkpoint_interval);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, NULL, NULL, NULL, NULL,
+		udata);
+
+	if (status != AEROSPIKE_OK) {
+		as_partition_error(scan->parts_all);
+	}
+	as_partition_tracker_destroy(&pt);
+	return status;
+}
+
+as_status
+aerospike_scan_partitions_columnar(
+	aerospike* as, as_error* err, const as_policy_scan* policy, as_scan* scan,
+	as_partition_filter* pf, const as_columnar_schema* schema, as_columnar_callback callback,
+	void* udata
+	)
+{
+	as_error_reset(err);
+
+	if (scan->ops) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Columnar scan does not support operations");
+	}
+
+	if (schema->n_columns == 0 || schema->batch_size == 0) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Columnar schema must have columns and a positive batch_size");
+	}
+
+	as_cluster* cluster = as->cluster;
+
+	as_policy_scan merged;
+	policy = as_policy_scan_merge(as, policy, &merged);
+
+	uint32_t n_nodes;
+	as_status status = as_scan_partitions_validate(cluster, err, policy, scan, &n_nodes);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (pf->parts_all && ! scan->parts_all) {
+		as_scan_set_partitions(scan, pf->parts_all);
+	}
+
+	as_partition_tracker pt;
+	status = as_partition_tracker_init_filter(&pt, cluster, &policy->base, policy->max_records,
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, n_nodes, pf, err);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_partition_tracker_set_checkpoint(&pt, policy->checkpoint_path, policy->checkpoint_interval);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, NULL, schema, callback, NULL, NULL,
+		udata);
+
+	if (status != AEROSPIKE_OK) {
+		as_partition_error(scan->parts_all);
+	}
+	as_partition_tracker_destroy(&pt);
+	return status;
+}
+
+as_status
+aerospike_scan_partitions_digests(
+	aerospike* as, as_error* err, const as_policy_scan* policy, as_scan* scan,
+	as_partition_filter* pf, as_digest_chunk* chunk, as_digest_callback callback, void* udata
+	)
+{
+	as_error_reset(err);
+
+	if (scan->ops) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Digest scan does not support operations");
+	}
+
+	if (! chunk->digests || chunk->capacity == 0) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Digest chunk must have digests and a positive capacity");
+	}
+
+	as_cluster* cluster = as->cluster;
+
+	as_policy_scan merged;
+	policy = as_policy_scan_merge(as, policy, &merged);
+
+	uint32_t n_nodes;
+	as_status status = as_scan_partitions_validate(cluster, err, policy, scan, &n_nodes);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (pf->parts_all && ! scan->parts_all) {
+		as_scan_set_partitions(scan, pf->parts_all);
+	}
+
+	as_partition_tracker pt;
+	status = as_partition_tracker_init_filter(&pt, cluster, &policy->base, policy->max_records,
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, n_nodes, pf, err);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
 	}
 
-	status = as_scan_partitions(cluster, err, policy, scan, &pt, callback, udata);
+	scan->no_bins = true;
+	chunk->size = 0;
+
+	as_partition_tracker_set_checkpoint(&pt, policy->checkpoint_path, policy->checkpoint_interval);
+	status = as_scan_partitions(cluster, err, policy, scan, &pt, NULL, NULL, NULL, chunk, callback,
+		udata);
 
 	if (status != AEROSPIKE_OK) {
 		as_partition_error(scan->parts_all);
@@ -1516,7 +1905,7 @@ aerospike_scan_async(
 
 	as_partition_tracker* pt = cf_malloc(sizeof(as_partition_tracker));
 	status = as_partition_tracker_init_nodes(pt, cluster, &policy->base, policy->max_records,
-		policy->replica, &scan->parts_all, scan->paginate, n_nodes, err);
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, n_nodes, err);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
@@ -1552,7 +1941,7 @@ aerospike_scan_node_async(
 
 	as_partition_tracker* pt = cf_malloc(sizeof(as_partition_tracker));
 	status = as_partition_tracker_init_node(pt, cluster, &policy->base, policy->max_records,
-		policy->replica, &scan->parts_all, scan->paginate, node, err);
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, node, err);
 
 	if (status != AEROSPIKE_OK) {
 		as_node_release(node);
@@ -1591,11 +1980,12 @@ aerospike_scan_partitions_async(
 
 	as_partition_tracker* pt = cf_malloc(sizeof(as_partition_tracker));
 	status = as_partition_tracker_init_filter(pt, cluster, &policy->base, policy->max_records,
-		policy->replica, &scan->parts_all, scan->paginate, n_nodes, pf, err);
+		policy->replica, policy->commands_per_node, &scan->parts_all, scan->paginate, n_nodes, pf, err);
 
 	if (status != AEROSPIKE_OK) {
 		cf_free(pt);
 		return status;
 	}
+	as_partition_tracker_set_checkpoint(pt, policy->checkpoint_path, policy->checkpoint_interval);
 	return as_scan_partition_async(cluster, err, policy, scan, pt, listener, udata, event_loop);
 }
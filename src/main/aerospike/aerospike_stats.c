@@ -16,8 +16,14 @@
  */
 #include <aerospike/aerospike_stats.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_dns_cache.h>
+#include <aerospike/as_lua_cache.h>
+#include <aerospike/as_mem_budget.h>
 #include <aerospike/as_node.h>
+#include <aerospike/as_slow_log.h>
 #include <aerospike/as_string_builder.h>
+#include <citrusleaf/cf_clock.h>
+#include <string.h>
 
 /******************************************************************************
  * GLOBALS
@@ -47,6 +53,64 @@ as_conn_stats_tostring(as_string_builder* sb, const char* title, as_conn_stats*
 	as_string_builder_append_char(sb, ')');
 }
 
+static void
+as_ns_snapshot_fill(as_ns_snapshot* entry, as_node* node, as_ns_metrics* metrics)
+{
+	memcpy(entry->node, node->name, AS_NODE_NAME_SIZE);
+	as_strncpy(entry->ns, metrics->ns, AS_MAX_NAMESPACE_SIZE);
+	entry->error_count = as_node_get_error_count(metrics);
+	entry->timeout_count = as_node_get_timeout_count(metrics);
+	entry->key_busy_count = as_node_get_key_busy_count(metrics);
+	entry->near_cache_hit_count = as_node_get_near_cache_hit_count(metrics);
+	entry->near_cache_miss_count = as_node_get_near_cache_miss_count(metrics);
+	entry->bytes_in = as_node_get_bytes_in(metrics);
+	entry->bytes_out = as_node_get_bytes_out(metrics);
+	entry->bytes_in_raw = as_node_get_bytes_in_raw(metrics);
+	entry->bytes_out_raw = as_node_get_bytes_out_raw(metrics);
+	entry->latency_size = 0;
+	entry->latency_shift = 0;
+
+	for (uint32_t i = 0; i < AS_LATENCY_SLOTS; i++) {
+		as_latency* latency = as_latency_reserve(metrics->latency[i]);
+		uint32_t size = latency->size;
+		uint32_t max = (size < AS_METRICS_SNAPSHOT_BUCKETS)? size : AS_METRICS_SNAPSHOT_BUCKETS;
+		uint64_t* buckets = entry->latency[i];
+
+		for (uint32_t j = 0; j < max; j++) {
+			buckets[j] = as_latency_get_bucket(latency, j);
+		}
+
+		for (uint32_t j = max; j < size; j++) {
+			buckets[max - 1] += as_latency_get_bucket(latency, j);
+		}
+
+		entry->latency_size = (uint8_t)max;
+		entry->latency_shift = latency->shift;
+		as_latency_release(latency);
+	}
+}
+
+static inline uint64_t
+as_snapshot_sub(uint64_t cur, uint64_t prev)
+{
+	// Counter was reset (metrics re-enabled) when cur is less than prev.
+	return (cur >= prev)? cur - prev : cur;
+}
+
+static const as_ns_snapshot*
+as_ns_snapshot_find(const as_metrics_snapshot* snapshot, const as_ns_snapshot* entry, uint32_t hint)
+{
+	// Node and namespace order is usually unchanged between snapshots, so try hint first.
+	for (uint32_t i = 0; i < snapshot->size; i++) {
+		const as_ns_snapshot* e = &snapshot->entries[(hint + i) % snapshot->size];
+
+		if (strcmp(e->node, entry->node) == 0 && strcmp(e->ns, entry->ns) == 0) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -78,9 +142,160 @@ aerospike_cluster_stats(as_cluster* cluster, as_cluster_stats* stats)
 		stats->event_loops = NULL;
 	}
 
-	// cf_queue applies locks, so we are safe here.
-	stats->thread_pool_queued_tasks = cf_queue_sz(cluster->thread_pool.dispatch_queue);
+	stats->thread_pool_queued_tasks = as_work_pool_queued_tasks(cluster->thread_pool);
+	stats->thread_pool_steal_count = as_work_pool_steal_count(cluster->thread_pool);
+
+	as_mem_budget* budget = cluster->mem_budget;
+
+	if (budget) {
+		stats->mem_budget_used = as_load_uint64(&budget->used);
+		stats->mem_budget_peak = as_load_uint64(&budget->peak);
+		stats->mem_budget_rejects = as_load_uint64(&budget->rejects);
+	}
+	else {
+		stats->mem_budget_used = 0;
+		stats->mem_budget_peak = 0;
+		stats->mem_budget_rejects = 0;
+	}
+
 	stats->retry_count = cluster->retry_count;
+	stats->retry_budget_exhausted_count = as_cluster_get_retry_budget_exhausted_count(cluster);
+	stats->hedge_count = as_cluster_get_hedge_count(cluster);
+	stats->hedge_win_count = as_cluster_get_hedge_win_count(cluster);
+	stats->batch_inline_count = as_load_uint64(&cluster->batch_inline_count);
+	stats->batch_parallel_count = as_load_uint64(&cluster->batch_parallel_count);
+	stats->tend_duration = as_cluster_get_tend_duration(cluster);
+	as_cluster_tend_stats(cluster, stats->tend_phases);
+	as_cluster_txn_stats(cluster, stats->txn_phases);
+
+	if (cluster->tls_ctx) {
+		stats->tls_full_handshakes = as_load_uint64(&cluster->tls_ctx->full_handshakes);
+		stats->tls_resumed_handshakes = as_load_uint64(&cluster->tls_ctx->resumed_handshakes);
+	}
+	else {
+		stats->tls_full_handshakes = 0;
+		stats->tls_resumed_handshakes = 0;
+	}
+
+	as_dns_cache* dns = cluster->dns_cache;
+
+	if (dns) {
+		stats->dns_cache_hits = as_load_uint64(&dns->hits);
+		stats->dns_cache_misses = as_load_uint64(&dns->misses);
+		stats->dns_lookups = as_load_uint64(&dns->lookups);
+		stats->dns_lookup_errors = as_load_uint64(&dns->lookup_errors);
+		stats->dns_lookup_time = as_load_uint64(&dns->lookup_ns) / 1000;
+	}
+	else {
+		stats->dns_cache_hits = 0;
+		stats->dns_cache_misses = 0;
+		stats->dns_lookups = 0;
+		stats->dns_lookup_errors = 0;
+		stats->dns_lookup_time = 0;
+	}
+
+	as_lua_cache_stats(&stats->lua_cache_hits, &stats->lua_cache_misses);
+
+	for (uint32_t i = 0; i < AS_COMPRESS_CODEC_SIZE; i++) {
+		as_compress_stats_load(&stats->compress[i], &cluster->compress_stats[i]);
+	}
+
+	as_mem_stats_get(stats->mem);
+}
+
+void
+aerospike_cluster_metrics_snapshot(as_cluster* cluster, as_metrics_snapshot* snapshot)
+{
+	snapshot->size = 0;
+	snapshot->truncated = false;
+	snapshot->time_ms = cf_getms();
+	snapshot->command_count = as_cluster_get_command_count(cluster);
+	snapshot->retry_count = as_cluster_get_retry_count(cluster);
+	snapshot->delay_queue_timeout_count = as_cluster_get_delay_queue_timeout_count(cluster);
+	snapshot->invalid_node_count = cluster->invalid_node_count;
+
+	as_nodes* nodes = as_nodes_reserve(cluster);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+		as_ns_metrics** array = node->metrics;
+		uint8_t max = node->metrics_size;
+
+		for (uint8_t j = 0; j < max; j++) {
+			if (snapshot->size >= snapshot->capacity) {
+				snapshot->truncated = true;
+				break;
+			}
+			as_ns_snapshot_fill(&snapshot->entries[snapshot->size++], node, array[j]);
+		}
+	}
+	as_nodes_release(nodes);
+}
+
+void
+as_metrics_snapshot_delta(
+	const as_metrics_snapshot* prev, const as_metrics_snapshot* cur, as_metrics_snapshot* delta
+	)
+{
+	delta->size = 0;
+	delta->truncated = cur->truncated;
+	delta->time_ms = cur->time_ms - prev->time_ms;
+	delta->command_count = as_snapshot_sub(cur->command_count, prev->command_count);
+	delta->retry_count = as_snapshot_sub(cur->retry_count, prev->retry_count);
+	delta->delay_queue_timeout_count = as_snapshot_sub(cur->delay_queue_timeout_count,
+		prev->delay_queue_timeout_count);
+	delta->invalid_node_count = (uint32_t)as_snapshot_sub(cur->invalid_node_count,
+		prev->invalid_node_count);
+
+	for (uint32_t i = 0; i < cur->size; i++) {
+		if (delta->size >= delta->capacity) {
+			delta->truncated = true;
+			break;
+		}
+
+		const as_ns_snapshot* c = &cur->entries[i];
+		const as_ns_snapshot* p = as_ns_snapshot_find(prev, c, i);
+		as_ns_snapshot* d = &delta->entries[delta->size++];
+
+		*d = *c;
+
+		if (! p) {
+			continue;
+		}
+
+		d->error_count = as_snapshot_sub(c->error_count, p->error_count);
+		d->timeout_count = as_snapshot_sub(c->timeout_count, p->timeout_count);
+		d->key_busy_count = as_snapshot_sub(c->key_busy_count, p->key_busy_count);
+		d->near_cache_hit_count = as_snapshot_sub(c->near_cache_hit_count, p->near_cache_hit_count);
+		d->near_cache_miss_count = as_snapshot_sub(c->near_cache_miss_count,
+			p->near_cache_miss_count);
+		d->bytes_in = as_snapshot_sub(c->bytes_in, p->bytes_in);
+		d->bytes_out = as_snapshot_sub(c->bytes_out, p->bytes_out);
+		d->bytes_in_raw = as_snapshot_sub(c->bytes_in_raw, p->bytes_in_raw);
+		d->bytes_out_raw = as_snapshot_sub(c->bytes_out_raw, p->bytes_out_raw);
+
+		if (c->latency_size != p->latency_size || c->latency_shift != p->latency_shift) {
+			// Latency histograms were recreated with a different layout.
+			continue;
+		}
+
+		for (uint32_t j = 0; j < AS_LATENCY_SLOTS; j++) {
+			for (uint32_t k = 0; k < c->latency_size; k++) {
+				d->latency[j][k] = as_snapshot_sub(c->latency[j][k], p->latency[j][k]);
+			}
+		}
+	}
+}
+
+uint32_t
+aerospike_cluster_slow_commands(
+	as_cluster* cluster, uint64_t* cursor, as_slow_command* out, uint32_t max
+	)
+{
+	if (! cluster->slow_log) {
+		return 0;
+	}
+	return as_slow_log_read(cluster->slow_log, cursor, out, max);
 }
 
 void
@@ -99,6 +314,47 @@ aerospike_stats_destroy(as_cluster_stats* stats)
 	}
 }
 
+static void
+aerospike_node_latency_stats(as_node* node, as_node_stats* stats)
+{
+	as_ns_metrics** array = node->metrics;
+	uint8_t max_ns = node->metrics_size;
+
+	for (uint8_t t = 0; t < AS_LATENCY_TYPE_MAX; t++) {
+		uint64_t* counts = NULL;
+		uint32_t size = 0;
+		uint8_t precision = 0;
+
+		// Merge all namespace histograms that have the same precision.
+		for (uint32_t i = 0; i < max_ns; i++) {
+			as_latency_hdr* hdr = as_latency_hdr_reserve(&array[i]->latency_hdr[t]);
+
+			if (! hdr) {
+				continue;
+			}
+
+			if (! counts) {
+				size = hdr->size;
+				precision = hdr->precision;
+				counts = cf_calloc(size, sizeof(uint64_t));
+			}
+
+			if (hdr->precision == precision) {
+				as_latency_hdr_merge(hdr, counts);
+			}
+			as_latency_hdr_release(hdr);
+		}
+
+		if (counts) {
+			as_latency_hdr_percentiles(precision, counts, size, &stats->latency[t]);
+			cf_free(counts);
+		}
+		else {
+			memset(&stats->latency[t], 0, sizeof(as_latency_percentiles));
+		}
+	}
+}
+
 void
 aerospike_node_stats(as_node* node, as_node_stats* stats)
 {
@@ -109,17 +365,44 @@ aerospike_node_stats(as_node* node, as_node_stats* stats)
 	stats->error_count = 0;
 	stats->timeout_count = 0;
 	stats->key_busy_count = 0;
+	stats->bytes_in = 0;
+	stats->bytes_out = 0;
+	stats->bytes_in_raw = 0;
+	stats->bytes_out_raw = 0;
 
 	as_ns_metrics** array = node->metrics;
 	uint8_t max_ns = node->metrics_size;
 
+	stats->namespaces = max_ns ? cf_malloc(sizeof(as_ns_stats) * max_ns) : NULL;
+	stats->namespaces_size = max_ns;
+
 	for (uint32_t i = 0; i < max_ns; i++) {
 		as_ns_metrics* metrics = array[i];
 		stats->error_count += as_node_get_error_count(metrics);
 		stats->timeout_count += as_node_get_timeout_count(metrics);
 		stats->key_busy_count += as_node_get_key_busy_count(metrics);
+
+		as_ns_stats* nss = &stats->namespaces[i];
+		nss->ns = metrics->ns;
+		nss->bytes_in = as_node_get_bytes_in(metrics);
+		nss->bytes_out = as_node_get_bytes_out(metrics);
+		nss->bytes_in_raw = as_node_get_bytes_in_raw(metrics);
+		nss->bytes_out_raw = as_node_get_bytes_out_raw(metrics);
+
+		stats->bytes_in += nss->bytes_in;
+		stats->bytes_out += nss->bytes_out;
+		stats->bytes_in_raw += nss->bytes_in_raw;
+		stats->bytes_out_raw += nss->bytes_out_raw;
 	}
 
+	stats->breaker_state = as_load_uint32(&node->breaker_state);
+	stats->breaker_trips = node->breaker_trips;
+	stats->concurrency_limit = as_load_uint32(&node->limit);
+	stats->concurrency_limit_rejects = as_load_uint64(&node->limit_rejects);
+	as_node_get_tcp_info(node, &stats->tcp_info, &stats->tcp_info_samples);
+
+	aerospike_node_latency_stats(node, stats);
+
 	as_conn_stats_init(&stats->sync);
 	as_conn_stats_init(&stats->async);
 	as_conn_stats_init(&stats->pipeline);
@@ -135,11 +418,26 @@ aerospike_node_stats(as_node* node, as_node_stats* stats)
 		uint32_t total = pool->queue.total;
 		pthread_mutex_unlock(&pool->lock);
 
+		if (pool->cache) {
+			// Warning: cross-thread references without a lock.
+			in_pool += as_conn_cache_count(pool);
+
+			if (in_pool > total) {
+				in_pool = total;
+			}
+		}
+
 		stats->sync.in_pool += in_pool;
 		stats->sync.in_use += total - in_pool;
+		stats->sync.contended += as_load_uint64(&pool->contended);
+		stats->sync.cache_hits += as_load_uint64(&pool->cache_hits);
+		stats->sync.peak_in_use += pool->window.peak;
+		stats->sync.trimmed += pool->window.trimmed;
 	}
 	stats->sync.opened = node->sync_conns_opened;
 	stats->sync.closed = node->sync_conns_closed;
+	stats->sync.warm_up_target = as_load_uint32(&node->warm_up_target);
+	stats->sync.warm_up_remaining = as_load_uint32(&node->warm_up_remaining);
 
 	// Async connection summary.
 	if (as_event_loop_capacity > 0) {
@@ -153,12 +451,32 @@ aerospike_node_stats(as_node* node, as_node_stats* stats)
 	}
 }
 
+static void
+as_phase_percentiles_tostring(as_string_builder* sb, const char* phase, as_latency_percentiles* lp)
+{
+	as_string_builder_append_char(sb, ' ');
+	as_string_builder_append(sb, phase);
+	as_string_builder_append_char(sb, '(');
+	as_string_builder_append_uint64(sb, lp->count);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, lp->p50);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, lp->p90);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, lp->p99);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, lp->p999);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, lp->max);
+	as_string_builder_append_char(sb, ')');
+}
+
 char*
 aerospike_stats_to_string(as_cluster_stats* stats)
 {
 	as_string_builder sb;
 	as_string_builder_init(&sb, 4096, true);
-	as_string_builder_append(&sb, "nodes(inUse,inPool,opened,closed) error_count,timeout_count,key_busy_count");
+	as_string_builder_append(&sb, "nodes(inUse,inPool,opened,closed) error_count,timeout_count,key_busy_count,breaker_state,breaker_trips bytes(in,out,inRaw,outRaw)");
 	as_string_builder_append_newline(&sb);
 
 	for (uint32_t i = 0; i < stats->nodes_size; i++) {
@@ -173,11 +491,60 @@ aerospike_stats_to_string(as_cluster_stats* stats)
 		as_string_builder_append_uint64(&sb, node_stats->timeout_count);
 		as_string_builder_append_char(&sb, ',');
 		as_string_builder_append_uint64(&sb, node_stats->key_busy_count);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, node_stats->breaker_state);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, node_stats->breaker_trips);
+		as_string_builder_append(&sb, " bytes(");
+		as_string_builder_append_uint64(&sb, node_stats->bytes_in);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, node_stats->bytes_out);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, node_stats->bytes_in_raw);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, node_stats->bytes_out_raw);
+		as_string_builder_append_char(&sb, ')');
+
+		if (node_stats->tcp_info_samples) {
+			as_tcp_info* ti = &node_stats->tcp_info;
+			as_string_builder_append(&sb, " tcp(rtt,rttvar,cwnd,retrans,samples)(");
+			as_string_builder_append_uint(&sb, ti->rtt_us);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ti->rttvar_us);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ti->cwnd);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ti->retrans);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint64(&sb, node_stats->tcp_info_samples);
+			as_string_builder_append_char(&sb, ')');
+		}
+
+		for (uint8_t t = 0; t < AS_LATENCY_TYPE_MAX; t++) {
+			as_latency_percentiles* lp = &node_stats->latency[t];
+
+			if (lp->count == 0) {
+				continue;
+			}
+			as_string_builder_append_char(&sb, ' ');
+			as_string_builder_append(&sb, as_latency_type_to_string(t));
+			as_string_builder_append(&sb, "(p50,p90,p99,p999,max)us(");
+			as_string_builder_append_uint64(&sb, lp->p50);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint64(&sb, lp->p90);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint64(&sb, lp->p99);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint64(&sb, lp->p999);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint64(&sb, lp->max);
+			as_string_builder_append_char(&sb, ')');
+		}
 		as_string_builder_append_newline(&sb);
 	}
 
 	if (stats->event_loops) {
-		as_string_builder_append(&sb, "event loops(processSize,queueSize): ");
+		as_string_builder_append(&sb, "event loops(processSize,queueSize,cmdPoolSize,cmdPoolHighWater,executeSize,lagUs,lagMaxUs,busyPct,commandsPerIteration): ");
 
 		for (uint32_t i = 0; i < stats->event_loops_size; i++) {
 			as_event_loop_stats* ev_stats = &stats->event_loops[i];
@@ -189,6 +556,20 @@ aerospike_stats_to_string(as_cluster_stats* stats)
 			as_string_builder_append_int(&sb, ev_stats->process_size);
 			as_string_builder_append_char(&sb, ',');
 			as_string_builder_append_uint(&sb, ev_stats->queue_size);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->cmd_pool_size);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->cmd_pool_high_water);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->execute_size);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->lag_us);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->lag_max_us);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->busy_pct);
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append_uint(&sb, ev_stats->commands_per_iteration);
 			as_string_builder_append_char(&sb, ')');
 		}
 		as_string_builder_append_newline(&sb);
@@ -196,6 +577,115 @@ aerospike_stats_to_string(as_cluster_stats* stats)
 	
 	as_string_builder_append(&sb, "retry_count: ");
 	as_string_builder_append_uint64(&sb, stats->retry_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "retry_budget_exhausted_count: ");
+	as_string_builder_append_uint64(&sb, stats->retry_budget_exhausted_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "hedge_count: ");
+	as_string_builder_append_uint64(&sb, stats->hedge_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "hedge_win_count: ");
+	as_string_builder_append_uint64(&sb, stats->hedge_win_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "batch_inline_count: ");
+	as_string_builder_append_uint64(&sb, stats->batch_inline_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "batch_parallel_count: ");
+	as_string_builder_append_uint64(&sb, stats->batch_parallel_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "tend_duration_us: ");
+	as_string_builder_append_uint64(&sb, stats->tend_duration);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "tend_phases(count,p50,p90,p99,p999,max)us:");
+
+	for (as_tend_phase i = 0; i < AS_TEND_PHASE_MAX; i++) {
+		as_phase_percentiles_tostring(&sb, as_tend_phase_to_string(i), &stats->tend_phases[i]);
+	}
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "txn_phases(count,p50,p90,p99,p999,max)us:");
+
+	for (as_txn_phase i = 0; i < AS_TXN_PHASE_MAX; i++) {
+		as_phase_percentiles_tostring(&sb, as_txn_phase_to_string(i), &stats->txn_phases[i]);
+	}
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "thread_pool_queued_tasks: ");
+	as_string_builder_append_uint(&sb, stats->thread_pool_queued_tasks);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "thread_pool_steal_count: ");
+	as_string_builder_append_uint64(&sb, stats->thread_pool_steal_count);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "mem_budget(used,peak,rejects): ");
+	as_string_builder_append_uint64(&sb, stats->mem_budget_used);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->mem_budget_peak);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->mem_budget_rejects);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "tls_handshakes(full,resumed): ");
+	as_string_builder_append_uint64(&sb, stats->tls_full_handshakes);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->tls_resumed_handshakes);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "dns_cache(hits,misses,lookups,errors,us): ");
+	as_string_builder_append_uint64(&sb, stats->dns_cache_hits);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->dns_cache_misses);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->dns_lookups);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->dns_lookup_errors);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->dns_lookup_time);
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "lua_cache(hits,misses): ");
+	as_string_builder_append_uint64(&sb, stats->lua_cache_hits);
+	as_string_builder_append_char(&sb, ',');
+	as_string_builder_append_uint64(&sb, stats->lua_cache_misses);
+
+	for (uint32_t i = 0; i < AS_COMPRESS_CODEC_SIZE; i++) {
+		as_compress_stats* cs = &stats->compress[i];
+
+		if (cs->compress_count == 0 && cs->decompress_count == 0) {
+			continue;
+		}
+
+		// (count,bytes_in,bytes_out,ns) for compression and decompression.
+		as_string_builder_append_newline(&sb);
+		as_string_builder_append(&sb, "compress_");
+		as_string_builder_append(&sb, as_compress_codec_name((as_compress_codec)i));
+		as_string_builder_append(&sb, ": (");
+		as_string_builder_append_uint64(&sb, cs->compress_count);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, cs->compress_bytes_in);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, cs->compress_bytes_out);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, cs->compress_ns);
+		as_string_builder_append(&sb, "),(");
+		as_string_builder_append_uint64(&sb, cs->decompress_count);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, cs->decompress_bytes_in);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, cs->decompress_bytes_out);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, cs->decompress_ns);
+		as_string_builder_append_char(&sb, ')');
+	}
+
+#if defined(AS_MEM_STATS)
+	as_string_builder_append_newline(&sb);
+	as_string_builder_append(&sb, "mem(current,peak):");
+
+	for (uint32_t i = 0; i < AS_MEM_TAG_MAX; i++) {
+		as_string_builder_append_char(&sb, ' ');
+		as_string_builder_append(&sb, as_mem_tag_name((as_mem_tag)i));
+		as_string_builder_append_char(&sb, '(');
+		as_string_builder_append_uint64(&sb, stats->mem[i].current);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, stats->mem[i].peak);
+		as_string_builder_append_char(&sb, ')');
+	}
+#endif
 
 	return sb.data;
 }
@@ -219,4 +709,12 @@ as_conn_stats_sum(as_conn_stats* stats, as_async_conn_pool* pool)
 	stats->in_use += tmp;
 	stats->opened += pool->opened;
 	stats->closed += pool->closed;
+	stats->in_flight += pool->in_flight;
+	stats->peak_in_use += pool->window.peak;
+	stats->trimmed += pool->window.trimmed;
+	stats->borrowed += pool->borrowed;
+
+	if (pool->max_depth > stats->max_depth) {
+		stats->max_depth = pool->max_depth;
+	}
 }
@@ -69,6 +69,53 @@ as_error_copy_fields(as_error* trg, as_error* src)
 	trg->in_doubt = src->in_doubt;
 }
 
+static inline as_txn_phase
+as_txn_roll_phase(uint8_t txn_attr)
+{
+	return (txn_attr == AS_MSG_INFO4_TXN_ROLL_FORWARD)?
+		AS_TXN_PHASE_ROLL_FORWARD : AS_TXN_PHASE_ROLL_BACK;
+}
+
+static as_status
+as_txn_verify_timed(aerospike* as, as_error* err, as_txn* txn)
+{
+	// Transactions without reads do not send a verify command.
+	if (as_txn_reads_size(txn) == 0) {
+		return AEROSPIKE_OK;
+	}
+
+	uint64_t begin = cf_getns();
+	as_status status = as_txn_verify(as, err, txn);
+	as_cluster_add_txn_latency(as->cluster, AS_TXN_PHASE_VERIFY, begin);
+	return status;
+}
+
+static as_status
+as_txn_roll_timed(
+	aerospike* as, as_error* err, as_policy_txn_roll* policy, as_txn* txn, uint8_t txn_attr
+	)
+{
+	if (as_txn_writes_size(txn) == 0) {
+		return AEROSPIKE_OK;
+	}
+
+	uint64_t begin = cf_getns();
+	as_status status = as_txn_roll(as, err, policy, txn, txn_attr);
+	as_cluster_add_txn_latency(as->cluster, as_txn_roll_phase(txn_attr), begin);
+	return status;
+}
+
+static as_status
+as_txn_monitor_remove_timed(
+	aerospike* as, as_error* err, const as_policy_base* base_policy, as_key* key
+	)
+{
+	uint64_t begin = cf_getns();
+	as_status status = as_txn_monitor_remove(as, err, base_policy, key);
+	as_cluster_add_txn_latency(as->cluster, AS_TXN_PHASE_CLOSE, begin);
+	return status;
+}
+
 //---------------------------------
 // Sync Commit
 //---------------------------------
@@ -94,7 +141,9 @@ as_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status* commit_st
 	as_txn_monitor_init_key(txn, &key);
 
 	if (as_txn_monitor_exists(txn)) {
+		uint64_t begin = cf_getns();
 		status = as_txn_monitor_mark_roll_forward(as, &local_err, &roll_policy->base, &key);
+		as_cluster_add_txn_latency(as->cluster, AS_TXN_PHASE_MARK_ROLL_FORWARD, begin);
 
 		if (status != AEROSPIKE_OK) {
 			if (local_err.code == AEROSPIKE_MRT_ABORTED) {
@@ -122,7 +171,7 @@ as_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status* commit_st
 	txn->state = AS_TXN_STATE_COMMITTED;
 	txn->in_doubt = false;
 
-	status = as_txn_roll(as, err, roll_policy, txn, AS_MSG_INFO4_TXN_ROLL_FORWARD);
+	status = as_txn_roll_timed(as, err, roll_policy, txn, AS_MSG_INFO4_TXN_ROLL_FORWARD);
 
 	if (status != AEROSPIKE_OK) {
 		// The client roll has error. The server will eventually roll forward the transaction
@@ -134,7 +183,7 @@ as_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status* commit_st
 	}
 
 	if (as_txn_close_monitor(txn)) {
-		status = as_txn_monitor_remove(as, err, &roll_policy->base, &key);
+		status = as_txn_monitor_remove_timed(as, err, &roll_policy->base, &key);
 
 		if (status != AEROSPIKE_OK) {
 			// The client transaction monitor remove has error. The server will eventually remove the
@@ -157,7 +206,7 @@ as_verify_and_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status
 	as_error verify_err;
 	as_status verify_status;
 
-	verify_status = as_txn_verify(as, &verify_err, txn);
+	verify_status = as_txn_verify_timed(as, &verify_err, txn);
 
 	if (verify_status == AEROSPIKE_OK) {
 		txn->state = AS_TXN_STATE_VERIFIED;
@@ -178,7 +227,7 @@ as_verify_and_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status
 	as_policy_txn_roll* roll_policy = &config->policies.txn_roll;
 
 	as_error roll_err;
-	as_status roll_status = as_txn_roll(as, &roll_err, roll_policy, txn, AS_MSG_INFO4_TXN_ROLL_BACK);
+	as_status roll_status = as_txn_roll_timed(as, &roll_err, roll_policy, txn, AS_MSG_INFO4_TXN_ROLL_BACK);
 
 	if (roll_status != AEROSPIKE_OK) {
 		as_error_update(err, verify_status, "Txn aborted:\nVerify failed: %s\nRollback abandoned: %s",
@@ -191,7 +240,7 @@ as_verify_and_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status
 		as_key key;
 		as_txn_monitor_init_key(txn, &key);
 
-		roll_status = as_txn_monitor_remove(as, &roll_err, &roll_policy->base, &key);
+		roll_status = as_txn_monitor_remove_timed(as, &roll_err, &roll_policy->base, &key);
 
 		if (roll_status != AEROSPIKE_OK) {
 			as_error_update(err, verify_status, "Txn aborted:\nVerify failed: %s\nClose abandoned: %s",
@@ -206,6 +255,36 @@ as_verify_and_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status
 	return verify_status;
 }
 
+static as_status
+as_verify_read_only(aerospike* as, as_error* err, as_txn* txn, as_commit_status* commit_status)
+{
+	// Read-only transactions have no monitor record and no writes to roll, so verify is the
+	// only phase.
+	as_error verify_err;
+	as_status status = as_txn_verify_timed(as, &verify_err, txn);
+
+	if (status != AEROSPIKE_OK) {
+		if (status == AEROSPIKE_BATCH_FAILED) {
+			status = AEROSPIKE_TXN_FAILED;
+			verify_err.code = AEROSPIKE_TXN_FAILED;
+			as_strncpy(verify_err.message, "One or more read keys failed to verify", sizeof(verify_err.message));
+		}
+
+		txn->state = AS_TXN_STATE_ABORTED;
+		as_set_commit_status(commit_status, AS_COMMIT_VERIFY_FAILED);
+		as_txn_clear(txn);
+		as_error_update(err, status, "Txn aborted:\nVerify failed: %s", verify_err.message);
+		as_error_copy_fields(err, &verify_err);
+		return status;
+	}
+
+	txn->state = AS_TXN_STATE_COMMITTED;
+	txn->in_doubt = false;
+	as_set_commit_status(commit_status, AS_COMMIT_OK);
+	as_txn_clear(txn);
+	return AEROSPIKE_OK;
+}
+
 as_status
 aerospike_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status* commit_status)
 {
@@ -214,6 +293,9 @@ aerospike_commit(aerospike* as, as_error* err, as_txn* txn, as_commit_status* co
 	switch (txn->state) {
 		default:
 		case AS_TXN_STATE_OPEN:
+			if (txn->read_only) {
+				return as_verify_read_only(as, err, txn, commit_status);
+			}
 			return as_verify_and_commit(as, err, txn, commit_status);
 
 		case AS_TXN_STATE_VERIFIED:
@@ -249,7 +331,7 @@ as_abort(aerospike* as, as_error* err, as_txn* txn, as_abort_status* abort_statu
 	as_config* config = aerospike_load_config(as);
 	as_policy_txn_roll* roll_policy = &config->policies.txn_roll;
 
-	as_status status = as_txn_roll(as, err, roll_policy, txn, AS_MSG_INFO4_TXN_ROLL_BACK);
+	as_status status = as_txn_roll_timed(as, err, roll_policy, txn, AS_MSG_INFO4_TXN_ROLL_BACK);
 
 	if (status != AEROSPIKE_OK) {
 		// The client roll has error. The server will eventually abort the transaction.
@@ -263,7 +345,7 @@ as_abort(aerospike* as, as_error* err, as_txn* txn, as_abort_status* abort_statu
 		as_key key;
 		as_txn_monitor_init_key(txn, &key);
 
-		status = as_txn_monitor_remove(as, err, &roll_policy->base, &key);
+		status = as_txn_monitor_remove_timed(as, err, &roll_policy->base, &key);
 
 		if (status != AEROSPIKE_OK) {
 			// The client transaction monitor remove has error. The server will eventually remove the
@@ -309,6 +391,7 @@ typedef struct {
 	as_commit_listener listener;
 	void* udata;
 	as_error* verify_err;
+	uint64_t begin;
 } as_commit_data;
 
 static as_commit_data*
@@ -324,9 +407,20 @@ as_commit_data_create(aerospike* as, as_txn* txn, as_commit_listener listener, v
 	data->listener = listener;
 	data->udata = udata;
 	data->verify_err = NULL;
+	data->begin = 0;
 	return data;
 }
 
+static inline void
+as_commit_end_phase(as_commit_data* data, as_txn_phase phase)
+{
+	// Phases that did not send a command have a zero begin time.
+	if (data->begin) {
+		as_cluster_add_txn_latency(data->as->cluster, phase, data->begin);
+		data->begin = 0;
+	}
+}
+
 static inline void
 as_commit_data_destroy(as_commit_data* data)
 {
@@ -427,6 +521,8 @@ as_commit_remove_listener(as_error* err, void* udata, as_event_loop* event_loop)
 {
 	as_commit_data* data = udata;
 
+	as_commit_end_phase(data, AS_TXN_PHASE_CLOSE);
+
 	if (err) {
 		if (data->verify_err) {
 			as_commit_notify_error_verify_close(err, data, event_loop);
@@ -458,6 +554,9 @@ as_commit_roll_listener(
 
 	as_commit_data* data = udata;
 
+	as_commit_end_phase(data, data->verify_err ?
+		AS_TXN_PHASE_ROLL_BACK : AS_TXN_PHASE_ROLL_FORWARD);
+
 	if (err) {
 		if (data->verify_err) {
 			as_commit_notify_error_verify_rollback(err, data, event_loop);
@@ -474,6 +573,7 @@ as_commit_roll_listener(
 	as_txn_monitor_init_key(data->txn, &key);
 
 	as_error close_err;
+	data->begin = cf_getns();
 	as_status status = as_txn_monitor_remove_async(data->as, &close_err, &data->roll_policy->base,
 		&key, as_commit_remove_listener, data, event_loop);
 
@@ -495,6 +595,8 @@ as_commit_mark_listener(as_error* err, void* udata, as_event_loop* event_loop)
 {
 	as_commit_data* data = udata;
 
+	as_commit_end_phase(data, AS_TXN_PHASE_MARK_ROLL_FORWARD);
+
 	if (err) {
 		as_commit_notify_error_mark(err, data, event_loop);
 		return;
@@ -504,6 +606,7 @@ as_commit_mark_listener(as_error* err, void* udata, as_event_loop* event_loop)
 	data->txn->in_doubt = false;
 
 	as_error roll_err;
+	data->begin = as_txn_writes_size(data->txn) ? cf_getns() : 0;
 	as_status status = as_txn_roll_async(data->as, &roll_err, data->roll_policy, data->txn,
 	 	AS_MSG_INFO4_TXN_ROLL_FORWARD, as_commit_roll_listener, data, event_loop);
 
@@ -526,6 +629,7 @@ as_commit_commit_async(as_commit_data* data, as_event_loop* event_loop)
 	as_txn_monitor_init_key(data->txn, &key);
 
 	as_error mark_err;
+	data->begin = cf_getns();
 	as_status status = as_txn_monitor_mark_roll_forward_async(data->as, &mark_err,
 		&data->roll_policy->base, &key, as_commit_mark_listener, data, event_loop);
 
@@ -545,6 +649,8 @@ as_commit_verify_listener(
 
 	as_commit_data* data = udata;
 
+	as_commit_end_phase(data, AS_TXN_PHASE_VERIFY);
+
 	if (err) {
 		// Verify failed. Rollback transaction.
 		if (err->code == AEROSPIKE_BATCH_FAILED) {
@@ -557,6 +663,7 @@ as_commit_verify_listener(
 		as_error_copy(data->verify_err, err);
 
 		as_error roll_err;
+		data->begin = as_txn_writes_size(data->txn) ? cf_getns() : 0;
 		as_status status = as_txn_roll_async(data->as, &roll_err, data->roll_policy, data->txn,
 			AS_MSG_INFO4_TXN_ROLL_BACK, as_commit_roll_listener, data, event_loop);
 
@@ -577,6 +684,7 @@ as_commit_verify_async(
 	)
 {
 	as_commit_data* data = as_commit_data_create(as, txn, listener, udata);
+	data->begin = as_txn_reads_size(txn) ? cf_getns() : 0;
 
 	as_status status = as_txn_verify_async(as, err, txn, as_commit_verify_listener, data, event_loop);
 
@@ -586,6 +694,57 @@ as_commit_verify_async(
 	return status;
 }
 
+static void
+as_commit_read_only_listener(
+	as_error* err, as_batch_records* records, void* udata, as_event_loop* event_loop
+	)
+{
+	if (records) {
+		as_batch_records_destroy(records);
+	}
+
+	as_commit_data* data = udata;
+	as_txn* txn = data->txn;
+
+	as_commit_end_phase(data, AS_TXN_PHASE_VERIFY);
+	as_txn_clear(txn);
+
+	if (err) {
+		if (err->code == AEROSPIKE_BATCH_FAILED) {
+			err->code = AEROSPIKE_TXN_FAILED;
+			as_strncpy(err->message, "One or more read keys failed to verify", sizeof(err->message));
+		}
+
+		txn->state = AS_TXN_STATE_ABORTED;
+		data->verify_err = cf_malloc(sizeof(as_error));
+		as_error_copy(data->verify_err, err);
+		as_commit_notify_error_verify(data, event_loop);
+		return;
+	}
+
+	txn->state = AS_TXN_STATE_COMMITTED;
+	txn->in_doubt = false;
+	as_commit_notify_success(AS_COMMIT_OK, data, event_loop);
+}
+
+static as_status
+as_commit_read_only_async(
+	aerospike* as, as_error* err, as_txn* txn, as_commit_listener listener, void* udata,
+	as_event_loop* event_loop
+	)
+{
+	as_commit_data* data = as_commit_data_create(as, txn, listener, udata);
+	data->begin = as_txn_reads_size(txn) ? cf_getns() : 0;
+
+	as_status status = as_txn_verify_async(as, err, txn, as_commit_read_only_listener, data,
+		event_loop);
+
+	if (status != AEROSPIKE_OK) {
+		as_commit_data_destroy(data);
+	}
+	return status;
+}
+
 static void
 as_commit_async(
 	aerospike* as, as_txn* txn, as_commit_listener listener, void* udata,
@@ -608,6 +767,9 @@ aerospike_commit_async(
 	switch (txn->state) {
 		default:
 		case AS_TXN_STATE_OPEN:
+			if (txn->read_only) {
+				return as_commit_read_only_async(as, err, txn, listener, udata, event_loop);
+			}
 			return as_commit_verify_async(as, err, txn, listener, udata, event_loop);
 
 		case AS_TXN_STATE_VERIFIED:
@@ -633,6 +795,7 @@ typedef struct {
 	as_policy_txn_roll* roll_policy;
 	as_abort_listener listener;
 	void* udata;
+	uint64_t begin;
 } as_abort_data;
 
 static inline void
@@ -653,6 +816,8 @@ as_abort_remove_listener(as_error* err, void* udata, as_event_loop* event_loop)
 {
 	as_abort_data* data = udata;
 
+	as_cluster_add_txn_latency(data->as->cluster, AS_TXN_PHASE_CLOSE, data->begin);
+
 	if (err) {
 		// The client transaction monitor remove has error. The server will eventually remove the
 		// monitor record. Therefore, notify success.
@@ -674,6 +839,10 @@ as_abort_roll_listener(
 
 	as_abort_data* data = udata;
 
+	if (data->begin) {
+		as_cluster_add_txn_latency(data->as->cluster, AS_TXN_PHASE_ROLL_BACK, data->begin);
+	}
+
 	if (err) {
 		// The client roll has error. The server will eventually roll back the transaction.
 		// Therefore, notify success.
@@ -685,6 +854,7 @@ as_abort_roll_listener(
 	as_txn_monitor_init_key(data->txn, &key);
 
 	as_error close_err;
+	data->begin = cf_getns();
 	as_status status = as_txn_monitor_remove_async(data->as, &close_err, &data->roll_policy->base,
 		&key, as_abort_remove_listener, data, event_loop);
 
@@ -710,6 +880,7 @@ as_abort_async(
 
 	data->listener = listener;
 	data->udata = udata;
+	data->begin = as_txn_writes_size(txn) ? cf_getns() : 0;
 
 	txn->state = AS_TXN_STATE_ABORTED;
 
@@ -19,6 +19,7 @@
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_log.h>
+#include <aerospike/as_lua_cache.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_status.h>
@@ -301,6 +302,9 @@ aerospike_udf_put(
 	}
 	
 	cf_free(response);
+
+	// The local copy used by client aggregation is commonly rewritten with the upload.
+	as_lua_cache_invalidate(filename);
 	return AEROSPIKE_OK;
 }
 
@@ -390,6 +394,7 @@ aerospike_udf_remove(
 	}
 	
 	cf_free(response);
+	as_lua_cache_invalidate(filename);
 	return AEROSPIKE_OK;
 }
 
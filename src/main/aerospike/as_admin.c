@@ -77,6 +77,7 @@ typedef as_status (*as_admin_parse_fn) (as_error* err, uint8_t* buffer, size_t s
 #define HEADER_REMAINING 16
 #define RESULT_CODE 9
 #define DEFAULT_TIMEOUT 60000  // one minute
+#define SESSION_REFRESH_PCT 80 // Renew session after this percent of server session TTL.
 
 //---------------------------------
 // Static Functions
@@ -505,6 +506,7 @@ as_cluster_login(
 
 	as_session* session = NULL;
 	uint64_t expiration = 0;
+	uint64_t refresh = 0;
 	int len;
 	uint8_t id;
 	p = buffer;
@@ -529,10 +531,20 @@ as_cluster_login(
 		}
 		else if (id == SESSION_TTL) {
 			// Subtract 60 seconds from ttl so client session expires before server session.
-			int64_t seconds = (int64_t)cf_swap_from_be32(*(uint32_t*)p) - 60;
+			int64_t ttl = (int64_t)cf_swap_from_be32(*(uint32_t*)p);
+			int64_t seconds = ttl - 60;
 
 			if (seconds > 0) {
-				expiration = cf_getns() + (seconds * 1000 * 1000 * 1000);
+				uint64_t now = cf_getns();
+				expiration = now + (seconds * 1000 * 1000 * 1000);
+
+				// Renew session on the tend thread well before it expires.
+				int64_t refresh_sec = ttl * SESSION_REFRESH_PCT / 100;
+
+				if (refresh_sec > seconds) {
+					refresh_sec = seconds;
+				}
+				refresh = now + (refresh_sec * 1000 * 1000 * 1000);
 			}
 			else {
 				as_log_warn("Invalid session TTL: %" PRIi64, seconds);
@@ -546,6 +558,7 @@ as_cluster_login(
 	}
 
 	session->expiration = expiration;
+	session->refresh = refresh;
 	node_info->session = session;
 	return AEROSPIKE_OK;
 }
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_arena.h>
+#include <citrusleaf/alloc.h>
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_arena_init(as_arena* arena, uint8_t* buffer, uint32_t capacity)
+{
+	arena->buffer = buffer;
+	arena->blocks = NULL;
+	arena->capacity = buffer ? capacity : 0;
+	arena->offset = 0;
+	arena->users = 0;
+}
+
+void*
+as_arena_alloc(as_arena* arena, uint32_t size)
+{
+	size = (size + 7) & ~7u;
+
+	// Align the caller's buffer offset too, since the buffer itself may be unaligned.
+	uintptr_t pad = arena->buffer ? (8 - ((uintptr_t)(arena->buffer + arena->offset) & 7)) & 7 : 0;
+
+	if (arena->offset + pad + size <= arena->capacity) {
+		void* p = arena->buffer + arena->offset + pad;
+		arena->offset += (uint32_t)pad + size;
+		return p;
+	}
+
+	as_arena_block* block = arena->blocks;
+
+	if (block && block->offset + size <= block->capacity) {
+		void* p = block->data + block->offset;
+		block->offset += size;
+		return p;
+	}
+
+	uint32_t capacity = (size > AS_ARENA_BLOCK_SIZE)? size : AS_ARENA_BLOCK_SIZE;
+	block = cf_malloc(sizeof(as_arena_block) + capacity);
+	block->next = arena->blocks;
+	block->capacity = capacity;
+	block->offset = size;
+	arena->blocks = block;
+	return block->data;
+}
+
+void
+as_arena_reset(as_arena* arena)
+{
+	as_arena_block* block = arena->blocks;
+
+	while (block) {
+		as_arena_block* next = block->next;
+		cf_free(block);
+		block = next;
+	}
+	arena->blocks = NULL;
+	arena->offset = 0;
+}
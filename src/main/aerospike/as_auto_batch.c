@@ -0,0 +1,253 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_auto_batch.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_command.h>
+#include <aerospike/as_event_internal.h>
+#include <aerospike/as_log_macros.h>
+#include <citrusleaf/alloc.h>
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	as_async_record_listener listener;
+	void* udata;
+} as_auto_batch_listener;
+
+typedef struct as_auto_batch_s {
+	aerospike* as;
+	as_batch_records* records;
+	as_auto_batch_listener* listeners;
+	uint32_t size;
+} as_auto_batch;
+
+// Read queued from outside the event loop thread.
+typedef struct {
+	aerospike* as;
+	as_key key;
+	as_async_record_listener listener;
+	void* udata;
+} as_auto_batch_key;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_auto_batch_destroy(as_auto_batch* ab)
+{
+	as_batch_records_destroy(ab->records);
+	cf_free(ab->listeners);
+	cf_free(ab);
+}
+
+static void
+as_auto_batch_complete(as_error* err, as_batch_records* records, void* udata, as_event_loop* event_loop)
+{
+	as_auto_batch* ab = udata;
+	as_vector* list = &records->list;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_batch_read_record* rec = as_vector_get(list, i);
+		as_auto_batch_listener* al = &ab->listeners[i];
+
+		if (rec->result == AEROSPIKE_OK) {
+			al->listener(NULL, &rec->record, al->udata, event_loop);
+		}
+		else if (rec->result == AEROSPIKE_NO_RESPONSE && err) {
+			al->listener(err, NULL, al->udata, event_loop);
+		}
+		else {
+			as_error e;
+			as_error_set_message(&e, rec->result, as_error_string(rec->result));
+			al->listener(&e, NULL, al->udata, event_loop);
+		}
+	}
+	as_auto_batch_destroy(ab);
+}
+
+static void
+as_auto_batch_flush(as_event_loop* event_loop, as_event_state* state, as_auto_batch* ab)
+{
+	state->auto_batch = NULL;
+
+	aerospike* as = ab->as;
+	const as_policy_read* rp = &aerospike_load_config(as)->policies.read;
+	uint32_t size = ab->size;
+	as_error err;
+	as_status status;
+
+	if (size == 1) {
+		// Nothing to merge. Send the original single record read.
+		as_batch_read_record* rec = as_vector_get(&ab->records->list, 0);
+		as_auto_batch_listener* al = &ab->listeners[0];
+
+		status = aerospike_key_get_async(as, &err, rp, &rec->key, al->listener, al->udata,
+			event_loop, NULL);
+
+		if (status != AEROSPIKE_OK) {
+			al->listener(&err, NULL, al->udata, event_loop);
+		}
+		as_auto_batch_destroy(ab);
+	}
+	else {
+		// Batch read with the same settings as the merged single record reads.
+		as_policy_batch bp;
+		as_policy_batch_init(&bp);
+		bp.base = rp->base;
+		bp.replica = rp->replica;
+		bp.read_mode_ap = rp->read_mode_ap;
+		bp.read_mode_sc = rp->read_mode_sc;
+		bp.read_touch_ttl_percent = rp->read_touch_ttl_percent;
+		bp.deserialize = rp->deserialize;
+
+		status = aerospike_batch_read_async(as, &err, &bp, ab->records, as_auto_batch_complete,
+			ab, event_loop);
+
+		if (status != AEROSPIKE_OK) {
+			for (uint32_t i = 0; i < size; i++) {
+				as_auto_batch_listener* al = &ab->listeners[i];
+				al->listener(&err, NULL, al->udata, event_loop);
+			}
+			as_auto_batch_destroy(ab);
+		}
+	}
+
+	// Queued reads no longer hold the cluster open. The batch commands are counted instead.
+	state->pending -= size;
+}
+
+static void
+as_auto_batch_flush_cb(as_event_loop* event_loop, aerospike* as)
+{
+	as_event_state* state = &as->cluster->event_state[event_loop->index];
+
+	// Scheduled flush holds the cluster open until it runs.
+	state->pending--;
+
+	if (state->auto_batch) {
+		as_auto_batch_flush(event_loop, state, state->auto_batch);
+	}
+}
+
+static void
+as_auto_batch_add(
+	as_event_loop* event_loop, aerospike* as, const as_key* key, as_async_record_listener listener,
+	void* udata
+	)
+{
+	as_cluster* cluster = as->cluster;
+	as_event_state* state = &cluster->event_state[event_loop->index];
+	if (state->closed) {
+		as_error err;
+		as_error_set_message(&err, AEROSPIKE_ERR_CLIENT, "Cluster has been closed");
+		listener(&err, NULL, udata, event_loop);
+		return;
+	}
+
+	as_auto_batch* ab = state->auto_batch;
+	bool flush = false;
+
+	if (! ab) {
+		uint32_t max = cluster->auto_batch_max;
+		ab = cf_malloc(sizeof(as_auto_batch));
+		ab->as = as;
+		ab->records = as_batch_records_create(max);
+		ab->listeners = cf_malloc(sizeof(as_auto_batch_listener) * max);
+		ab->size = 0;
+		state->auto_batch = ab;
+
+		// Flush after reads already in the event loop's command queue have been added.
+		state->pending++;
+
+		if (! as_event_execute(event_loop, (as_event_executable)as_auto_batch_flush_cb, as)) {
+			// No flush would run, so send this read now instead of leaving it queued.
+			as_log_error("Failed to queue auto batch flush");
+			state->pending--;
+			flush = true;
+		}
+	}
+
+	as_batch_read_record* rec = as_batch_read_reserve(ab->records);
+	rec->key = *key;
+	rec->read_all_bins = true;
+
+	as_auto_batch_listener* al = &ab->listeners[ab->size++];
+	al->listener = listener;
+	al->udata = udata;
+	state->pending++;
+
+	if (flush || ab->size >= cluster->auto_batch_max) {
+		as_auto_batch_flush(event_loop, state, ab);
+	}
+}
+
+static void
+as_auto_batch_add_cb(as_event_loop* event_loop, as_auto_batch_key* ak)
+{
+	as_auto_batch_add(event_loop, ak->as, &ak->key, ak->listener, ak->udata);
+	cf_free(ak);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+as_auto_batch_get(
+	aerospike* as, as_error* err, const as_key* key, as_async_record_listener listener,
+	void* udata, as_event_loop* event_loop
+	)
+{
+	const as_policy_read* policy = &aerospike_load_config(as)->policies.read;
+	as_cluster* cluster = as->cluster;
+	as_partition_info pi;
+	as_status status = as_command_prepare(cluster, err, &policy->base, key, &pi);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	// Keys on the same node are assigned to the same event loop with node affinity, so they
+	// are merged into the same batch.
+	event_loop = as_event_assign_partition(event_loop, cluster, pi.ns, pi.partition,
+		pi.replica_size);
+
+	// Merged reads are sent by digest. The user key is not needed for reads.
+	as_key dkey;
+	as_key_init_digest(&dkey, key->ns, key->set, key->digest.value);
+
+	if (pthread_equal(event_loop->thread, pthread_self())) {
+		as_auto_batch_add(event_loop, as, &dkey, listener, udata);
+		return AEROSPIKE_OK;
+	}
+
+	as_auto_batch_key* ak = cf_malloc(sizeof(as_auto_batch_key));
+	ak->as = as;
+	ak->key = dkey;
+	ak->listener = listener;
+	ak->udata = udata;
+
+	if (! as_event_execute(event_loop, (as_event_executable)as_auto_batch_add_cb, ak)) {
+		cf_free(ak);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
+	}
+	return AEROSPIKE_OK;
+}
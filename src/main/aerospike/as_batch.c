@@ -15,7 +15,12 @@
  * the License.
  */
 #include <aerospike/as_batch.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_mem_stats.h>
 #include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <citrusleaf/cf_digest.h>
+#include <string.h>
 
 /******************************************************************************
  * FUNCTIONS
@@ -26,6 +31,7 @@ as_batch_new(uint32_t size)
 {
 	as_batch* batch = (as_batch *) cf_malloc(sizeof(as_batch) + sizeof(as_key) * size);
 	if ( !batch ) return NULL;
+	as_mem_stats_alloc(AS_MEM_TAG_BATCH, sizeof(as_batch) + sizeof(as_key) * size);
 
 	batch->_free = true;
 	batch->keys._free = false;
@@ -43,6 +49,7 @@ as_batch_init(as_batch* batch, uint32_t size)
 	if ( size > 0 ) {
 		entries = (as_key *) cf_malloc(sizeof(as_key) * size);
 		if ( !entries ) return batch;
+		as_mem_stats_alloc(AS_MEM_TAG_BATCH, sizeof(as_key) * size);
 	}
 
 	batch->_free = false;
@@ -57,6 +64,8 @@ as_batch_destroy(as_batch* batch)
 {
 	if ( !batch ) return;
 
+	uint32_t size = batch->keys.size;
+
 	if ( batch->keys.entries ) {
 
 		for (uint32_t i = 0; i < batch->keys.size; i++ ) {
@@ -65,6 +74,7 @@ as_batch_destroy(as_batch* batch)
 
 		if ( batch->keys._free ) {
 			cf_free(batch->keys.entries);
+			as_mem_stats_free(AS_MEM_TAG_BATCH, sizeof(as_key) * size);
 		}
 
 		batch->keys._free = false;
@@ -74,5 +84,90 @@ as_batch_destroy(as_batch* batch)
 
 	if ( batch->_free ) {
 		cf_free(batch);
+		as_mem_stats_free(AS_MEM_TAG_BATCH, sizeof(as_batch) + sizeof(as_key) * size);
 	}
 }
+
+as_batch_digests*
+as_batch_digests_init(as_batch_digests* batch, const char* ns, const char* set, uint32_t size)
+{
+	if ( !batch ) return batch;
+
+	as_strncpy(batch->ns, ns, sizeof(as_namespace));
+	as_strncpy(batch->set, set ? set : "", sizeof(as_set));
+	batch->digests = size > 0 ? (as_digest_value *) cf_malloc(sizeof(as_digest_value) * size) : NULL;
+	batch->size = size;
+	batch->_free = true;
+	return batch;
+}
+
+void
+as_batch_digests_destroy(as_batch_digests* batch)
+{
+	if ( !batch ) return;
+
+	if ( batch->_free ) {
+		cf_free(batch->digests);
+	}
+
+	batch->digests = NULL;
+	batch->size = 0;
+	batch->_free = false;
+}
+
+bool
+as_batch_digests_set_int64(as_batch_digests* batch, uint32_t i, int64_t value)
+{
+	if ( i >= batch->size ) return false;
+
+	// Same digest input as as_key_set_digest().
+	uint8_t buf[9];
+	buf[0] = AS_BYTES_INTEGER;
+	*(uint64_t*)&buf[1] = cf_swap_to_be64((uint64_t)value);
+	cf_digest_compute2(batch->set, strlen(batch->set), buf, sizeof(buf),
+		(cf_digest*)batch->digests[i]);
+	return true;
+}
+
+bool
+as_batch_digests_set_str(as_batch_digests* batch, uint32_t i, const char* value)
+{
+	if ( i >= batch->size ) return false;
+
+	size_t len = strlen(value);
+	uint8_t* buf = (uint8_t*)alloca(len + 1);
+	buf[0] = AS_BYTES_STRING;
+	memcpy(&buf[1], value, len);
+	cf_digest_compute2(batch->set, strlen(batch->set), buf, len + 1,
+		(cf_digest*)batch->digests[i]);
+	return true;
+}
+
+as_batch_compact*
+as_batch_compact_init(as_batch_compact* batch, uint32_t size)
+{
+	if ( !batch ) return batch;
+
+	batch->keys = size > 0 ? (as_key_compact *) cf_calloc(size, sizeof(as_key_compact)) : NULL;
+	batch->size = size;
+	batch->_free = true;
+	return batch;
+}
+
+void
+as_batch_compact_destroy(as_batch_compact* batch)
+{
+	if ( !batch ) return;
+
+	for (uint32_t i = 0; i < batch->size; i++) {
+		as_key_compact_destroy(&batch->keys[i]);
+	}
+
+	if ( batch->_free ) {
+		cf_free(batch->keys);
+	}
+
+	batch->keys = NULL;
+	batch->size = 0;
+	batch->_free = false;
+}
@@ -50,7 +50,7 @@ as_bit_write(
 	as_pack_int64(&pk, offset);
 	as_pack_uint64(&pk, size);
 	as_bit_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -66,7 +66,7 @@ as_bit_shift(
 	as_pack_uint64(&pk, bit_size);
 	as_pack_uint64(&pk, shift);
 	as_bit_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -91,7 +91,7 @@ as_bit_math(
 	}
 	as_pack_uint64(&pk, flags);
 
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -107,7 +107,7 @@ as_bit_byte_math(
 	as_pack_uint64(&pk, bit_size);
 	as_pack_bytes(&pk, value, value_size);
 	as_bit_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -122,7 +122,7 @@ as_operations_bit_resize(
 	as_pack_uint64(&pk, byte_size);
 	as_bit_pack_policy(&pk, policy);
 	as_pack_uint64(&pk, (uint64_t)flags);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -137,7 +137,7 @@ as_operations_bit_insert(
 	as_pack_int64(&pk, byte_offset);
 	as_pack_bytes(&pk, value, value_byte_size);
 	as_bit_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -153,7 +153,7 @@ as_operations_bit_set_int(
 	as_pack_uint64(&pk, bit_size);
 	as_pack_int64(&pk, value);
 	as_bit_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_MODIFY);
 }
 
@@ -167,7 +167,7 @@ as_bit_read(
 	as_cdt_pack_header(&pk, ctx, command, 2);
 	as_pack_int64(&pk, bit_offset);
 	as_pack_uint64(&pk, bit_size);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_READ);
 }
 
@@ -182,7 +182,7 @@ as_bit_scan(
 	as_pack_int64(&pk, bit_offset);
 	as_pack_uint64(&pk, bit_size);
 	as_pack_bool(&pk, value);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_READ);
 }
 
@@ -200,6 +200,6 @@ as_operations_bit_get_int(
 	if (sign) {
 		as_pack_uint64(&pk, INT_FLAGS_SIGNED);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_BIT_READ);
 }
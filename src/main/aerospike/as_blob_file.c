@@ -0,0 +1,171 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_blob_file.h>
+#include <errno.h>
+#include <string.h>
+
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+#if !defined(_MSC_VER)
+
+as_status
+as_blob_file_open(as_blob_file* blob, as_error* err, const char* path)
+{
+	blob->data = NULL;
+	blob->size = 0;
+
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open %s: %s",
+							   path, strerror(errno));
+	}
+
+	struct stat stats;
+
+	if (fstat(fd, &stats) != 0) {
+		int e = errno;
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to stat %s: %s",
+							   path, strerror(e));
+	}
+
+	if ((uint64_t)stats.st_size > UINT32_MAX) {
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_RECORD_TOO_BIG, "File %s is too large: %lld",
+							   path, (long long)stats.st_size);
+	}
+
+	if (stats.st_size == 0) {
+		close(fd);
+		return AEROSPIKE_OK;
+	}
+
+	void* data = mmap(NULL, (size_t)stats.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	int e = errno;
+
+	// The mapping remains valid after the descriptor is closed.
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %s",
+							   path, strerror(e));
+	}
+
+	// The blob is read once from start to end when the command is sent.
+	madvise(data, (size_t)stats.st_size, MADV_SEQUENTIAL);
+
+	blob->data = data;
+	blob->size = (uint32_t)stats.st_size;
+	return AEROSPIKE_OK;
+}
+
+void
+as_blob_file_close(as_blob_file* blob)
+{
+	if (blob->data) {
+		munmap(blob->data, blob->size);
+		blob->data = NULL;
+	}
+	blob->size = 0;
+}
+
+#else
+
+as_status
+as_blob_file_open(as_blob_file* blob, as_error* err, const char* path)
+{
+	blob->data = NULL;
+	blob->size = 0;
+	blob->mapping = NULL;
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+							  FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open %s: %lu",
+							   path, GetLastError());
+	}
+
+	LARGE_INTEGER size;
+
+	if (! GetFileSizeEx(file, &size)) {
+		DWORD e = GetLastError();
+		CloseHandle(file);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to stat %s: %lu", path, e);
+	}
+
+	if ((uint64_t)size.QuadPart > UINT32_MAX) {
+		CloseHandle(file);
+		return as_error_update(err, AEROSPIKE_ERR_RECORD_TOO_BIG, "File %s is too large: %lld",
+							   path, (long long)size.QuadPart);
+	}
+
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return AEROSPIKE_OK;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	DWORD e = GetLastError();
+
+	// The mapping keeps the file open.
+	CloseHandle(file);
+
+	if (! mapping) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %lu", path, e);
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (! data) {
+		e = GetLastError();
+		CloseHandle(mapping);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %lu", path, e);
+	}
+
+	blob->data = data;
+	blob->size = (uint32_t)size.QuadPart;
+	blob->mapping = mapping;
+	return AEROSPIKE_OK;
+}
+
+void
+as_blob_file_close(as_blob_file* blob)
+{
+	if (blob->data) {
+		UnmapViewOfFile(blob->data);
+		CloseHandle(blob->mapping);
+		blob->data = NULL;
+		blob->mapping = NULL;
+	}
+	blob->size = 0;
+}
+
+#endif
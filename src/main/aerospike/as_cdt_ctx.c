@@ -40,6 +40,54 @@ as_cdt_ctx_destroy(as_cdt_ctx* ctx)
 	as_vector_destroy(list);
 }
 
+bool
+as_cdt_ctx_prepare(as_cdt_ctx_prepared* prepared, const as_cdt_ctx* ctx)
+{
+	uint32_t n = ctx->list.size;
+	as_cdt_ctx_init(&prepared->ctx, n > 0 ? n : 1);
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_cdt_ctx_item* item = as_vector_get((as_vector*)&ctx->list, i);
+
+		if (item->type & AS_CDT_CTX_VALUE) {
+			as_val_reserve(item->val.pval);
+		}
+		as_vector_append(&prepared->ctx.list, item);
+	}
+
+	as_packer pk = {.buffer = NULL, .capacity = UINT32_MAX};
+	uint32_t size = as_cdt_ctx_pack(&prepared->ctx, &pk);
+
+	if (size == 0) {
+		as_cdt_ctx_destroy(&prepared->ctx);
+		prepared->packed = NULL;
+		prepared->packed_size = 0;
+		return false;
+	}
+
+	pk.buffer = cf_malloc(size);
+	pk.capacity = size;
+	pk.offset = 0;
+	as_cdt_ctx_pack(&prepared->ctx, &pk);
+
+	prepared->packed = pk.buffer;
+	prepared->packed_size = size;
+
+	// Set after packing, so the levels above were serialized directly.
+	prepared->ctx.list.flags |= AS_CDT_CTX_PREPARED;
+	return true;
+}
+
+void
+as_cdt_ctx_prepared_destroy(as_cdt_ctx_prepared* prepared)
+{
+	prepared->ctx.list.flags &= ~AS_CDT_CTX_PREPARED;
+	as_cdt_ctx_destroy(&prepared->ctx);
+	cf_free(prepared->packed);
+	prepared->packed = NULL;
+	prepared->packed_size = 0;
+}
+
 uint32_t
 as_cdt_ctx_byte_capacity(const as_cdt_ctx* ctx)
 {
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_cdt_cursor.h>
+#include <aerospike/as_bytes.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static const uint8_t*
+as_cdt_cursor_particle(as_cdt_cursor* cur, uint32_t* size)
+{
+	uint32_t sz;
+	const uint8_t* p = as_unpack_str(&cur->pk, &sz);
+
+	if (! p || sz == 0) {
+		return NULL;
+	}
+
+	// Strings and blobs nested in list and map bins start with their particle type.
+	*size = sz - 1;
+	return p + 1;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+bool
+as_cdt_cursor_init_value(as_cdt_cursor* cur, const as_bin_value* value)
+{
+	if (! value || as_val_type((as_val*)value) != AS_BYTES) {
+		return false;
+	}
+
+	const as_bytes* b = &value->bytes;
+
+	if (! (b->type == AS_BYTES_LIST || b->type == AS_BYTES_MAP)) {
+		return false;
+	}
+
+	as_cdt_cursor_init(cur, b->value, b->size);
+	return true;
+}
+
+bool
+as_cdt_cursor_init_bin(as_cdt_cursor* cur, const as_record* rec, const char* name)
+{
+	// Read bin value directly, so lazy bins are not deserialized.
+	for (uint16_t i = 0; i < rec->bins.size; i++) {
+		const as_bin* bin = &rec->bins.entries[i];
+
+		if (strcmp(bin->name, name) == 0) {
+			return as_cdt_cursor_init_value(cur, bin->valuep);
+		}
+	}
+	return false;
+}
+
+as_val_t
+as_cdt_cursor_type(const as_cdt_cursor* cur)
+{
+	if (as_cdt_cursor_end(cur)) {
+		return AS_UNDEF;
+	}
+	return as_unpack_peek_type(&cur->pk);
+}
+
+int64_t
+as_cdt_cursor_list(as_cdt_cursor* cur)
+{
+	if (as_cdt_cursor_type(cur) != AS_LIST) {
+		return -1;
+	}
+
+	int64_t count = as_unpack_list_header_element_count(&cur->pk);
+
+	if (count > 0 && as_unpack_peek_is_ext(&cur->pk)) {
+		// Skip order flags of ordered lists.
+		if (as_unpack_size(&cur->pk) < 0) {
+			return -1;
+		}
+		count--;
+	}
+	return count;
+}
+
+int64_t
+as_cdt_cursor_map(as_cdt_cursor* cur)
+{
+	if (as_cdt_cursor_type(cur) != AS_MAP) {
+		return -1;
+	}
+
+	int64_t count = as_unpack_map_header_element_count(&cur->pk);
+
+	if (count > 0 && as_unpack_peek_is_ext(&cur->pk)) {
+		// Skip order flags key and nil value of sorted maps.
+		if (as_unpack_size(&cur->pk) < 0 || as_unpack_size(&cur->pk) < 0) {
+			return -1;
+		}
+		count--;
+	}
+	return count;
+}
+
+bool
+as_cdt_cursor_int64(as_cdt_cursor* cur, int64_t* value)
+{
+	if (as_cdt_cursor_type(cur) != AS_INTEGER) {
+		return false;
+	}
+	return as_unpack_int64(&cur->pk, value) == 0;
+}
+
+bool
+as_cdt_cursor_double(as_cdt_cursor* cur, double* value)
+{
+	as_val_t type = as_cdt_cursor_type(cur);
+
+	if (type == AS_INTEGER) {
+		int64_t v;
+
+		if (as_unpack_int64(&cur->pk, &v) != 0) {
+			return false;
+		}
+		*value = (double)v;
+		return true;
+	}
+
+	if (type != AS_DOUBLE) {
+		return false;
+	}
+	return as_unpack_double(&cur->pk, value) == 0;
+}
+
+bool
+as_cdt_cursor_bool(as_cdt_cursor* cur, bool* value)
+{
+	if (as_cdt_cursor_type(cur) != AS_BOOLEAN) {
+		return false;
+	}
+	return as_unpack_boolean(&cur->pk, value) == 0;
+}
+
+const char*
+as_cdt_cursor_str(as_cdt_cursor* cur, uint32_t* len)
+{
+	if (as_cdt_cursor_type(cur) != AS_STRING) {
+		return NULL;
+	}
+	return (const char*)as_cdt_cursor_particle(cur, len);
+}
+
+const uint8_t*
+as_cdt_cursor_bytes(as_cdt_cursor* cur, uint32_t* size)
+{
+	if (as_cdt_cursor_type(cur) != AS_BYTES) {
+		return NULL;
+	}
+	return as_cdt_cursor_particle(cur, size);
+}
+
+bool
+as_cdt_cursor_skip(as_cdt_cursor* cur)
+{
+	if (as_cdt_cursor_end(cur)) {
+		return false;
+	}
+	return as_unpack_size(&cur->pk) >= 0;
+}
@@ -73,6 +73,14 @@ as_cdt_pack_ctx(as_packer* pk, as_cdt_ctx* ctx)
 {
 	as_pack_list_header(pk, 3);
 	as_pack_uint64(pk, 0xff);
+
+	const as_cdt_ctx_prepared* prepared = as_cdt_ctx_get_prepared(ctx);
+
+	if (prepared) {
+		as_pack_append(pk, prepared->packed, prepared->packed_size);
+		return;
+	}
+
 	as_pack_list_header(pk, ctx->list.size * 2);
 
 	for (uint32_t i = 0; i < ctx->list.size; i++) {
@@ -91,6 +99,15 @@ as_cdt_pack_ctx(as_packer* pk, as_cdt_ctx* ctx)
 uint32_t
 as_cdt_ctx_pack(const as_cdt_ctx* ctx, as_packer* pk)
 {
+	const as_cdt_ctx_prepared* prepared = as_cdt_ctx_get_prepared(ctx);
+
+	if (prepared) {
+		if (as_pack_append(pk, prepared->packed, prepared->packed_size) != 0) {
+			return 0;
+		}
+		return prepared->packed_size;
+	}
+
 	uint32_t start = pk->offset;
 
 	if (as_pack_list_header(pk, ctx->list.size * 2) != 0) {
@@ -122,12 +139,16 @@ as_cdt_ctx_pack(const as_cdt_ctx* ctx, as_packer* pk)
 bool
 as_cdt_add_packed(as_packer* pk, as_operations* ops, const char* name, as_operator op_type)
 {
+	bool heap = !(ops && ops->arena);
 	as_binop* binop = as_binop_forappend(ops, op_type, name);
 	if (! binop) {
+		if (heap) {
+			cf_free(pk->buffer);
+		}
 		return false;
 	}
-	as_bytes* bytes = as_bytes_new_wrap(pk->buffer, pk->offset, true);
-	as_bin_init(&binop->bin, name, (as_bin_value*)bytes);
+	// Store bytes inline in the bin. Arena buffers are released with the arena.
+	as_bin_init_raw(&binop->bin, name, pk->buffer, pk->offset, heap);
 	return true;
 }
 
@@ -17,16 +17,27 @@
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_address.h>
 #include <aerospike/as_admin.h>
+#include <aerospike/as_clock.h>
+#include <aerospike/as_cluster_snapshot.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_config_file.h>
 #include <aerospike/as_cpu.h>
+#include <aerospike/as_dns_cache.h>
+#include <aerospike/as_epoch.h>
+#include <aerospike/as_event_internal.h>
+#include <aerospike/as_job.h>
+#include <aerospike/as_hot_keys.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_lookup.h>
+#include <aerospike/as_mem_budget.h>
 #include <aerospike/as_metrics_writer.h>
+#include <aerospike/as_partition_heat.h>
 #include <aerospike/as_password.h>
 #include <aerospike/as_peers.h>
+#include <aerospike/as_shared_threads.h>
 #include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_slow_log.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_string_builder.h>
@@ -38,6 +49,13 @@
 #include <citrusleaf/cf_byte_order.h>
 #include <citrusleaf/cf_clock.h>
 
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Tend phase histograms resolve elapsed times to within 1/8th.
+#define AS_TEND_LATENCY_PRECISION 4
+
 //---------------------------------
 // Globals
 //---------------------------------
@@ -45,26 +63,58 @@
 extern uint32_t as_event_loop_capacity;
 extern bool as_event_single_thread;
 uint32_t as_cluster_count = 0;
+static uint32_t as_cluster_serial = 0;
 
 //---------------------------------
 // Function Declarations
 //---------------------------------
 
 as_status
-as_node_refresh(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers);
+as_node_refresh_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms);
+
+as_status
+as_node_refresh_recv(
+	as_cluster* cluster, as_error* err, as_node* node, as_peers* peers, uint64_t deadline_ms
+	);
 
 as_status
 as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers);
 
+as_status
+as_node_refresh_peers_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms);
+
+as_status
+as_node_refresh_peers_recv(
+	as_cluster* cluster, as_error* err, as_node* node, as_peers* peers, uint64_t deadline_ms
+	);
+
 as_status
 as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node);
 
 as_status
-as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node);
+as_node_refresh_partitions_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms);
+
+as_status
+as_node_refresh_partitions_recv(as_cluster* cluster, as_error* err, as_node* node, uint64_t deadline_ms);
+
+as_status
+as_node_refresh_racks_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms);
+
+as_status
+as_node_refresh_racks_recv(as_cluster* cluster, as_error* err, as_node* node, uint64_t deadline_ms);
 
 void
 as_event_balance_connections(as_cluster* cluster);
 
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct as_tend_request_s {
+	as_node* node;
+	bool racks;
+} as_tend_request;
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -139,6 +189,70 @@ as_cluster_event_notify(as_cluster* cluster, as_node* node, as_cluster_event_typ
 	}
 }
 
+static as_compress_codec
+as_cluster_compress_codec(as_cluster* cluster, as_nodes* nodes)
+{
+	as_compress_codec codec = cluster->compress_codec;
+	uint32_t feature;
+
+	switch (codec) {
+		case AS_COMPRESS_LZ4:
+			feature = AS_FEATURES_COMPRESS_LZ4;
+			break;
+		case AS_COMPRESS_ZSTD:
+			feature = AS_FEATURES_COMPRESS_ZSTD;
+			break;
+		default:
+			return AS_COMPRESS_ZLIB;
+	}
+
+	if (nodes->size == 0 || ! as_compress_codec_enabled(codec)) {
+		return AS_COMPRESS_ZLIB;
+	}
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		if ((node->features & feature) == 0) {
+			return AS_COMPRESS_ZLIB;
+		}
+	}
+	return codec;
+}
+
+static as_status
+as_cluster_load_compress_dicts(as_cluster* cluster, as_vector* src, as_error* err)
+{
+	cluster->compress_dicts = as_vector_create(sizeof(as_compress_dict_entry), src->size);
+
+	for (uint32_t i = 0; i < src->size; i++) {
+		as_config_compress_dict* cd = as_vector_get(src, i);
+		as_compress_dict* dict;
+		as_status status = as_compress_dict_acquire(err, cd->path, &dict);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+
+		// Heap allocated strings continue to be owned by as->config. Make reference copies.
+		as_compress_dict_entry* entry = as_vector_reserve(cluster->compress_dicts);
+		entry->ns = cd->ns;
+		entry->set = cd->set;
+		entry->dict = dict;
+	}
+	return AEROSPIKE_OK;
+}
+
+static void
+as_cluster_release_compress_dicts(as_vector* dicts)
+{
+	for (uint32_t i = 0; i < dicts->size; i++) {
+		as_compress_dict_entry* entry = as_vector_get(dicts, i);
+		as_compress_dict_release(entry->dict);
+	}
+	as_vector_destroy(dicts);
+}
+
 static bool
 as_cluster_has_partition_query(as_nodes* nodes)
 {
@@ -217,6 +331,7 @@ as_cluster_add_nodes_copy(as_cluster* cluster, as_vector* /* <as_node*> */ nodes
 	set_nodes(cluster, nodes_new);
 
 	cluster->has_partition_query = as_cluster_has_partition_query(nodes_new);
+	cluster->compress_codec_current = as_cluster_compress_codec(cluster, nodes_new);
 
 	// Put old nodes on garbage collector stack.
 	as_gc_item item;
@@ -259,10 +374,90 @@ as_cluster_get_alternate_host(as_cluster* cluster, const char* hostname)
 	return alt;
 }
 
+static uint64_t
+as_cluster_end_phase(as_cluster* cluster, as_tend_phase phase, uint64_t begin)
+{
+	uint64_t now = cf_getns();
+	uint64_t us = (now - begin) / 1000;
+
+	cluster->tend_phase_us[phase] += us;
+	as_latency_hdr_add(cluster->tend_latency[phase], us);
+	return now;
+}
+
 static void
-as_cluster_refresh_peers(as_cluster* cluster, as_peers* peers)
+as_cluster_track_info(as_cluster* cluster, as_node* node, const char* info, uint64_t begin)
+{
+	uint64_t us = (cf_getns() - begin) / 1000;
+
+	if (us >= cluster->tend_slow_info_us) {
+		cluster->tend_slow_info = info;
+		cluster->tend_slow_info_us = us;
+		as_strncpy(cluster->tend_slow_node, node->name, sizeof(cluster->tend_slow_node));
+	}
+}
+
+/**
+ * Refresh peers of nodes that are active and did not fail. Requests are written to every
+ * node first and the responses are read afterwards.
+ */
+static void
+as_cluster_refresh_node_peers(
+	as_cluster* cluster, as_node** array, uint32_t size, as_peers* peers
+	)
 {
 	as_error error_local;
+	as_vector requests;
+	as_vector_inita(&requests, sizeof(as_tend_request), size);
+
+	for (uint32_t i = 0; i < size; i++) {
+		as_node* node = array[i];
+
+		if (node->failures > 0 || ! node->active) {
+			continue;
+		}
+
+		uint64_t deadline_ms;
+		as_status status = as_node_refresh_peers_send(cluster, &error_local, node,
+			&deadline_ms);
+
+		if (status == AEROSPIKE_OK) {
+			as_tend_request* req = as_vector_reserve(&requests);
+			req->node = node;
+			req->racks = false;
+		}
+		else {
+			as_log_warn("Node %s peers refresh failed: %s %s",
+				node->name, as_error_string(status), error_local.message);
+			as_cluster_node_failure(node);
+		}
+	}
+
+	for (uint32_t i = 0; i < requests.size; i++) {
+		as_tend_request* req = as_vector_get(&requests, i);
+		as_node* node = req->node;
+
+		// Parsing a previous response may have connected to new peers, so the read deadline
+		// starts when this response is read.
+		uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+		uint64_t begin = cf_getns();
+		as_status status = as_node_refresh_peers_recv(cluster, &error_local, node, peers,
+			deadline_ms);
+
+		as_cluster_track_info(cluster, node, "peers", begin);
+
+		if (status != AEROSPIKE_OK) {
+			as_log_warn("Node %s peers refresh failed: %s %s",
+				node->name, as_error_string(status), error_local.message);
+			as_cluster_node_failure(node);
+		}
+	}
+	as_vector_destroy(&requests);
+}
+
+static void
+as_cluster_refresh_peers(as_cluster* cluster, as_peers* peers)
+{
 	as_vector* peer_nodes = &peers->nodes;
 
 	as_vector nodes;
@@ -281,16 +476,7 @@ as_cluster_refresh_peers(as_cluster* cluster, as_peers* peers)
 
 		// Refresh peers of peers in order retrieve the node's peers_count which is
 		// used in as_node_refresh_partitions(). This call might add even more peers.
-		for (uint32_t i = 0; i < nodes.size; i++) {
-			as_node* node = as_vector_get_ptr(&nodes, i);
-			as_status status = as_node_refresh_peers(cluster, &error_local, node, peers);
-
-			if (status != AEROSPIKE_OK) {
-				as_log_warn("Node %s peers refresh failed: %s %s",
-					node->name, as_error_string(status), error_local.message);
-				as_cluster_node_failure(node);
-			}
-		}
+		as_cluster_refresh_node_peers(cluster, (as_node**)nodes.list, nodes.size, peers);
 
 		if (peer_nodes->size > 0) {
 			// Add new peer nodes to cluster.
@@ -304,17 +490,70 @@ as_cluster_refresh_peers(as_cluster* cluster, as_peers* peers)
 	as_vector_destroy(&nodes);
 }
 
-static as_status
-as_cluster_seed_node(as_cluster* cluster, as_error* err, as_peers* peers, bool enable_warnings)
+/**
+ * Create node from validated seed connection and refresh its peers. Return node if valid.
+ * A node without peers is suspect and is kept as fallback in case no valid seed is found.
+ */
+static as_node*
+as_cluster_seed_validate(
+	as_cluster* cluster, as_peers* peers, as_host* host, bool is_alias, as_node_info* node_info,
+	as_node** fallback, as_status* conn_status, bool enable_warnings, bool* found_node
+	)
+{
+	as_error error_local;
+	as_error_init(&error_local);
+
+	as_node* node = as_node_create(cluster, node_info);
+
+	if (is_alias) {
+		as_node_set_hostname(node, host->name);
+	}
+
+	peers->refresh_count = 0;
+	as_status status = as_node_refresh_peers(cluster, &error_local, node, peers);
+
+	if (status != AEROSPIKE_OK) {
+		if (enable_warnings) {
+			as_log_warn("Failed to refresh seed node peers %s %d. %s %s",
+				host->name, host->port, as_error_string(status), error_local.message);
+		}
+		*conn_status = status;
+		as_node_destroy(node);
+		return NULL;
+	}
+	*found_node = true;
+
+	if (node->peers_count == 0) {
+		// Node is suspect because it does not have any peers.
+		if (! *fallback) {
+			*fallback = node;
+		}
+		else {
+			as_node_destroy(node);
+		}
+		return NULL;
+	}
+
+	// Node is valid. Drop fallback if it exists.
+	if (*fallback) {
+		as_log_info("Skip orphan node: %s", as_node_get_address_string(*fallback));
+		as_node_destroy(*fallback);
+		*fallback = NULL;
+	}
+	return node;
+}
+
+static as_node*
+as_cluster_seed_serial(
+	as_cluster* cluster, as_peers* peers, bool enable_warnings, as_node** fallback,
+	as_status* conn_status
+	)
 {
 	as_node* node = NULL;
-	as_node* fallback = NULL;
 	as_node_info node_info;
 	as_error error_local;
 	as_error_init(&error_local);
-	as_status conn_status = AEROSPIKE_ERR_CLIENT;
-	
-	pthread_mutex_lock(&cluster->seed_lock);
+
 	as_vector* seeds = cluster->seeds;
 
 	for (uint32_t i = 0; i < seeds->size && node == NULL; i++) {
@@ -330,7 +569,7 @@ as_cluster_seed_node(as_cluster* cluster, as_error* err, as_peers* peers, bool e
 		}
 
 		as_address_iterator iter;
-		as_status status = as_lookup_host(&iter, &error_local, host.name, host.port);
+		as_status status = as_lookup_host_cluster(cluster, &iter, &error_local, host.name, host.port);
 		
 		if (status != AEROSPIKE_OK) {
 			as_peers_add_invalid_host(peers, &host);
@@ -348,52 +587,18 @@ as_cluster_seed_node(as_cluster* cluster, as_error* err, as_peers* peers, bool e
 			status = as_lookup_node(cluster, &error_local, &host, addr, true, &node_info);
 			
 			if (status == AEROSPIKE_OK) {
-				node = as_node_create(cluster, &node_info);
+				node = as_cluster_seed_validate(cluster, peers, &host, iter.hostname_is_alias,
+					&node_info, fallback, conn_status, enable_warnings, &found_node);
 
-				if (iter.hostname_is_alias) {
-					as_node_set_hostname(node, host.name);
+				if (node) {
+					break;
 				}
-
-				peers->refresh_count = 0;
-				status = as_node_refresh_peers(cluster, &error_local, node, peers);
-
-				if (status != AEROSPIKE_OK) {
-					if (enable_warnings) {
-						as_log_warn("Failed to refresh seed node peers %s %d. %s %s",
-							host.name, host.port, as_error_string(status), error_local.message);
-					}
-					conn_status = status;
-					as_node_destroy(node);
-					node = NULL;
-					continue;
-				}
-				found_node = true;
-
-				if (node->peers_count == 0) {
-					// Node is suspect because it does not have any peers.
-					if (! fallback) {
-						fallback = node;
-					}
-					else {
-						as_node_destroy(node);
-					}
-					node = NULL;
-					continue;
-				}
-
-				// Node is valid. Drop fallback if it exists.
-				if (fallback) {
-					as_log_info("Skip orphan node: %s", as_node_get_address_string(fallback));
-					as_node_destroy(fallback);
-					fallback = NULL;
-				}
-				break;
 			}
 			else {
 				if (enable_warnings) {
 					as_log_warn("Failed to connect to seed %s %d. %s %s", host.name, host.port, as_error_string(status), error_local.message);
 				}
-				conn_status = status;
+				*conn_status = status;
 			}
 		}
 		as_lookup_end(&iter);
@@ -402,6 +607,220 @@ as_cluster_seed_node(as_cluster* cluster, as_error* err, as_peers* peers, bool e
 			as_peers_add_invalid_host(peers, &host);
 		}
 	}
+	return node;
+}
+
+// Maximum seed addresses contacted concurrently.
+#define AS_SEED_PARALLEL_MAX 32
+
+typedef struct as_seed_state_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	as_cluster* cluster;
+} as_seed_state;
+
+typedef struct as_seed_lookup_s {
+	as_seed_state* state;
+	pthread_t thread;
+	as_host host;
+	struct sockaddr_storage addr;
+	as_node_info node_info;
+	as_error err;
+	as_status status;
+	uint32_t seed;
+	bool is_alias;
+	bool started;
+	bool done;
+	bool evaluated;
+	bool found;
+} as_seed_lookup;
+
+static void*
+as_seed_lookup_run(void* udata)
+{
+	as_seed_lookup* l = udata;
+	as_seed_state* state = l->state;
+	as_status status = as_lookup_node(state->cluster, &l->err, &l->host,
+		(struct sockaddr*)&l->addr, true, &l->node_info);
+
+	pthread_mutex_lock(&state->lock);
+	l->status = status;
+	l->done = true;
+	pthread_cond_signal(&state->cond);
+	pthread_mutex_unlock(&state->lock);
+	return NULL;
+}
+
+/**
+ * Connect to all seed addresses concurrently. The first seed to respond with valid peers wins,
+ * so unreachable seeds cost one connect timeout in total instead of one timeout per seed.
+ */
+static as_node*
+as_cluster_seed_parallel(
+	as_cluster* cluster, as_peers* peers, bool enable_warnings, as_node** fallback,
+	as_status* conn_status
+	)
+{
+	as_error error_local;
+	as_error_init(&error_local);
+
+	as_seed_state state;
+	pthread_mutex_init(&state.lock, NULL);
+	pthread_cond_init(&state.cond, NULL);
+	state.cluster = cluster;
+
+	as_vector* seeds = cluster->seeds;
+	as_host* hosts = alloca(sizeof(as_host) * seeds->size);
+	as_seed_lookup* lookups = cf_malloc(sizeof(as_seed_lookup) * AS_SEED_PARALLEL_MAX);
+	uint32_t n_lookups = 0;
+
+	// Resolve seed hostnames. Connections are started after all addresses are known.
+	for (uint32_t i = 0; i < seeds->size && n_lookups < AS_SEED_PARALLEL_MAX; i++) {
+		as_host* seed = as_vector_get(seeds, i);
+		as_host* host = &hosts[i];
+
+		host->name = (char*)as_cluster_get_alternate_host(cluster, seed->name);
+		host->tls_name = seed->tls_name;
+		host->port = seed->port;
+
+		if (as_peers_find_invalid_host(peers, host)) {
+			continue;
+		}
+
+		as_address_iterator iter;
+		as_status status = as_lookup_host_cluster(cluster, &iter, &error_local, host->name,
+			host->port);
+
+		if (status != AEROSPIKE_OK) {
+			as_peers_add_invalid_host(peers, host);
+
+			if (enable_warnings) {
+				as_log_warn("Failed to lookup %s %d. %s %s", host->name, host->port,
+					as_error_string(status), error_local.message);
+			}
+			continue;
+		}
+
+		struct sockaddr* addr;
+
+		while (n_lookups < AS_SEED_PARALLEL_MAX && as_lookup_next(&iter, &addr)) {
+			as_seed_lookup* l = &lookups[n_lookups++];
+			memset(l, 0, sizeof(as_seed_lookup));
+			l->state = &state;
+			l->host = *host;
+			as_address_copy_storage(addr, &l->addr);
+			as_error_init(&l->err);
+			l->seed = i;
+			l->is_alias = iter.hostname_is_alias;
+		}
+		as_lookup_end(&iter);
+	}
+
+	for (uint32_t i = 0; i < n_lookups; i++) {
+		as_seed_lookup* l = &lookups[i];
+
+		if (pthread_create(&l->thread, NULL, as_seed_lookup_run, l) == 0) {
+			l->started = true;
+		}
+		else {
+			// Connect in this thread when a thread can not be created.
+			as_seed_lookup_run(l);
+		}
+	}
+
+	as_node* node = NULL;
+	uint32_t n_evaluated = 0;
+
+	pthread_mutex_lock(&state.lock);
+
+	while (! node && n_evaluated < n_lookups) {
+		// Evaluate completed lookups in seed order.
+		as_seed_lookup* l = NULL;
+
+		for (uint32_t i = 0; i < n_lookups; i++) {
+			if (lookups[i].done && ! lookups[i].evaluated) {
+				l = &lookups[i];
+				break;
+			}
+		}
+
+		if (! l) {
+			pthread_cond_wait(&state.cond, &state.lock);
+			continue;
+		}
+
+		l->evaluated = true;
+		n_evaluated++;
+		pthread_mutex_unlock(&state.lock);
+
+		if (l->status == AEROSPIKE_OK) {
+			node = as_cluster_seed_validate(cluster, peers, &l->host, l->is_alias,
+				&l->node_info, fallback, conn_status, enable_warnings, &l->found);
+		}
+		else {
+			if (enable_warnings) {
+				as_log_warn("Failed to connect to seed %s %d. %s %s", l->host.name, l->host.port,
+					as_error_string(l->status), l->err.message);
+			}
+			*conn_status = l->status;
+		}
+		pthread_mutex_lock(&state.lock);
+	}
+	pthread_mutex_unlock(&state.lock);
+
+	// Remaining connects are bounded by the connect timeout. They must finish before the
+	// lookups are released.
+	for (uint32_t i = 0; i < n_lookups; i++) {
+		as_seed_lookup* l = &lookups[i];
+
+		if (l->started) {
+			pthread_join(l->thread, NULL);
+		}
+
+		if (! l->evaluated && l->status == AEROSPIKE_OK) {
+			as_node_info_destroy(&l->node_info);
+		}
+	}
+
+	// Seeds are invalid when all their addresses were tried and none of them succeeded.
+	for (uint32_t i = 0; i < n_lookups; ) {
+		uint32_t seed = lookups[i].seed;
+		bool invalid = true;
+
+		for (; i < n_lookups && lookups[i].seed == seed; i++) {
+			as_seed_lookup* l = &lookups[i];
+
+			if (l->found || (! l->evaluated && l->status == AEROSPIKE_OK)) {
+				invalid = false;
+			}
+		}
+
+		if (invalid) {
+			as_peers_add_invalid_host(peers, &hosts[seed]);
+		}
+	}
+
+	cf_free(lookups);
+	pthread_cond_destroy(&state.cond);
+	pthread_mutex_destroy(&state.lock);
+	return node;
+}
+
+static as_status
+as_cluster_seed_node(as_cluster* cluster, as_error* err, as_peers* peers, bool enable_warnings)
+{
+	as_node* node = NULL;
+	as_node* fallback = NULL;
+	as_status conn_status = AEROSPIKE_ERR_CLIENT;
+	
+	pthread_mutex_lock(&cluster->seed_lock);
+
+	if (cluster->seed_parallel) {
+		node = as_cluster_seed_parallel(cluster, peers, enable_warnings, &fallback, &conn_status);
+	}
+	else {
+		node = as_cluster_seed_serial(cluster, peers, enable_warnings, &fallback, &conn_status);
+	}
 	pthread_mutex_unlock(&cluster->seed_lock);
 
 	if (! node && fallback) {
@@ -545,6 +964,7 @@ as_cluster_remove_nodes_copy(as_cluster* cluster, as_vector* /* <as_node*> */ no
 	set_nodes(cluster, nodes_new);
 
 	cluster->has_partition_query = as_cluster_has_partition_query(nodes_new);
+	cluster->compress_codec_current = as_cluster_compress_codec(cluster, nodes_new);
 
 	if (nodes_new->size == 0) {
 		as_cluster_event_notify(cluster, NULL, AS_CLUSTER_DISCONNECTED);
@@ -602,6 +1022,12 @@ as_cluster_enable_metrics(as_error* err, as_cluster* cluster, const as_metrics_p
 	cluster->metrics_interval = policy->interval;
 	cluster->metrics_latency_columns = policy->latency_columns;
 	cluster->metrics_latency_shift = policy->latency_shift;
+	cluster->metrics_latency_precision = (policy->latency_precision <= AS_LATENCY_HDR_PRECISION_MAX)?
+		policy->latency_precision : AS_LATENCY_HDR_PRECISION_MAX;
+	cluster->metrics_hot_keys = (policy->hot_keys <= AS_HOT_KEYS_MAX)?
+		policy->hot_keys : AS_HOT_KEYS_MAX;
+	cluster->metrics_partition_heatmap = policy->partition_heatmap;
+	cluster->metrics_tcp_info_interval = policy->tcp_info_interval;
 
 	as_nodes* nodes = as_nodes_reserve(cluster);
 	
@@ -632,6 +1058,8 @@ as_cluster_disable_metrics(as_error* err, as_cluster* cluster)
 		status = cluster->metrics_listeners.disable_listener(err, cluster, cluster->metrics_listeners.udata);
 	}
 
+	// Nodes stop sampling TCP state on their next pooled connection.
+	cluster->metrics_tcp_info_interval = 0;
 	return status;
 }
 
@@ -661,6 +1089,7 @@ as_cluster_remove_nodes(as_cluster* cluster, as_vector* /* <as_node*> */ nodes_t
 			as_log_warn("Metrics error: %s %s", as_error_string(status), err.message);
 		}
 		as_node_deactivate(node);
+		as_incr_uint32(&cluster->routing_gen);
 	}
 
 	// Remove all nodes at once to avoid copying entire array multiple times.
@@ -744,21 +1173,149 @@ as_cluster_reset_error_rate(as_cluster* cluster)
 	}
 }
 
+static void
+as_cluster_update_breakers(as_cluster* cluster, bool window_end)
+{
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+		uint32_t old_state = node->breaker_state;
+		uint32_t state = as_node_update_breaker(node, window_end);
+
+		if (state == old_state) {
+			continue;
+		}
+
+		cluster->tend_changed = true;
+
+		switch (state) {
+			case AS_BREAKER_OPEN:
+				as_log_warn("Node %s circuit breaker opened for %u tend iterations",
+					node->name, node->breaker_open_remaining);
+				as_cluster_event_notify(cluster, node, AS_CLUSTER_BREAKER_OPEN);
+				break;
+
+			case AS_BREAKER_HALF_OPEN:
+				as_log_info("Node %s circuit breaker half-open", node->name);
+				as_cluster_event_notify(cluster, node, AS_CLUSTER_BREAKER_HALF_OPEN);
+				break;
+
+			default:
+				as_log_info("Node %s circuit breaker closed", node->name);
+				as_cluster_event_notify(cluster, node, AS_CLUSTER_BREAKER_CLOSED);
+				break;
+		}
+	}
+}
+
+static void
+as_cluster_decay_replica_scores(as_cluster* cluster)
+{
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node_decay_replica_score(nodes->array[i]);
+	}
+}
+
+static void
+as_cluster_update_adaptive_timeouts(as_cluster* cluster)
+{
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node_update_adaptive_timeout(nodes->array[i]);
+	}
+}
+
+static void
+as_cluster_update_limits(as_cluster* cluster)
+{
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node_update_limit(nodes->array[i]);
+	}
+}
+
+static void
+as_cluster_decay_hot_keys(as_cluster* cluster)
+{
+	// Must hold metrics_lock.
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		for (uint8_t j = 0; j < node->metrics_size; j++) {
+			as_hot_keys* hk = node->metrics[j]->hot_keys;
+
+			if (hk) {
+				as_hot_keys_decay(hk);
+			}
+		}
+	}
+}
+
+static void
+as_cluster_clear_partition_heat(as_cluster* cluster)
+{
+	// Must hold metrics_lock.
+	as_nodes* nodes = cluster->nodes;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		for (uint8_t j = 0; j < node->metrics_size; j++) {
+			as_partition_heat* heat = node->metrics[j]->partition_heat;
+
+			if (heat) {
+				as_partition_heat_clear(heat);
+			}
+		}
+	}
+}
+
 void
 as_cluster_manage(as_cluster* cluster)
 {
+	uint64_t begin = cf_getns();
+
 	cluster->tend_count++;
 
 	// Balance connections every 30 tend intervals.
 	if (cluster->tend_count % 30 == 0) {
 		as_cluster_balance_connections(cluster);
+		begin = as_cluster_end_phase(cluster, AS_TEND_PHASE_BALANCE, begin);
 	}
 
 	// Reset connection error window for all nodes every error_rate_window tend iterations.
-	if (cluster->tend_count % cluster->error_rate_window == 0) {
+	bool window_end = cluster->tend_count % cluster->error_rate_window == 0;
+
+	if (window_end) {
 		as_cluster_reset_error_rate(cluster);
 	}
 
+	if (cluster->breaker_ratio > 0) {
+		as_cluster_update_breakers(cluster, window_end);
+	}
+
+	as_cluster_decay_replica_scores(cluster);
+
+	if (as_event_loop_size > 0) {
+		// Measure event loop lag and saturation.
+		as_event_monitor_probe();
+	}
+
+	if (as_load_uint8((uint8_t*)&cluster->adaptive_timeouts)) {
+		as_cluster_update_adaptive_timeouts(cluster);
+	}
+
+	if (cluster->limit_max > 0) {
+		as_cluster_update_limits(cluster);
+	}
+
 	// Call metrics listener every metrics_interval when enabled.
 	as_status status = AEROSPIKE_OK;
 	as_error err;
@@ -767,6 +1324,14 @@ as_cluster_manage(as_cluster* cluster)
 
 	if (cluster->metrics_enabled && cluster->tend_count % cluster->metrics_interval == 0) {
 		status = cluster->metrics_listeners.snapshot_listener(&err, cluster, cluster->metrics_listeners.udata);
+
+		if (cluster->metrics_hot_keys) {
+			as_cluster_decay_hot_keys(cluster);
+		}
+
+		if (cluster->metrics_partition_heatmap) {
+			as_cluster_clear_partition_heat(cluster);
+		}
 	}
 	pthread_mutex_unlock(&cluster->metrics_lock);
 
@@ -777,10 +1342,22 @@ as_cluster_manage(as_cluster* cluster)
 	}
 
 	const char* path = cluster->as->config.config_provider.path;
-	uint32_t config_interval = cluster->config_interval / cluster->tend_interval;
 
-	if (path && cluster->tend_count % config_interval == 0) {
-		if (as_file_has_changed(path, &cluster->config_file_status)) {
+	if (path) {
+		bool changed;
+
+		if (as_file_is_watched(&cluster->config_file_status)) {
+			// Draining file notifications does not touch the file system, so check every tend.
+			changed = as_file_watch_changed(&cluster->config_file_status);
+		}
+		else {
+			uint32_t config_interval = cluster->config_interval / cluster->tend_interval;
+
+			changed = cluster->tend_count % config_interval == 0 &&
+				as_file_has_changed(path, &cluster->config_file_status);
+		}
+
+		if (changed) {
 			status = as_config_file_update(cluster->as, &err);
 
 			if (status != AEROSPIKE_OK) {
@@ -788,6 +1365,7 @@ as_cluster_manage(as_cluster* cluster)
 			}
 		}
 	}
+	as_cluster_end_phase(cluster, AS_TEND_PHASE_MANAGE, begin);
 }
 
 /**
@@ -800,45 +1378,287 @@ as_cluster_gc(as_vector* /* <as_gc_item> */ vector)
 		as_gc_item* item = as_vector_get(vector, i);
 		item->release_fn(item->data);
 	}
-	as_vector_clear(vector);
+	as_vector_clear(vector);
+}
+
+/**
+ * Retire data structures scheduled for removal in previous cluster tend and release retired
+ * data structures that can no longer be referenced by threads in an epoch critical section.
+ */
+static void
+as_cluster_gc_epoch(as_cluster* cluster)
+{
+	as_vector* gc = cluster->gc;
+	as_vector* pending = cluster->gc_epoch;
+
+	if (gc->size > 0) {
+		// All items were removed from shared structures before the epoch advanced.
+		uint64_t epoch = as_epoch_advance();
+
+		for (uint32_t i = 0; i < gc->size; i++) {
+			as_gc_epoch_item* item = as_vector_reserve(pending);
+			item->item = *(as_gc_item*)as_vector_get(gc, i);
+			item->epoch = epoch;
+		}
+		as_vector_clear(gc);
+	}
+
+	if (pending->size == 0) {
+		return;
+	}
+
+	uint64_t min = as_epoch_min();
+	uint32_t size = 0;
+
+	for (uint32_t i = 0; i < pending->size; i++) {
+		as_gc_epoch_item* item = as_vector_get(pending, i);
+
+		if (item->epoch < min) {
+			item->item.release_fn(item->item.data);
+		}
+		else {
+			// Still in use. Keep for next tend.
+			if (i != size) {
+				*(as_gc_epoch_item*)as_vector_get(pending, size) = *item;
+			}
+			size++;
+		}
+	}
+	pending->size = size;
+}
+
+static void
+as_cluster_destroy_peers(as_peers* peers)
+{
+	as_vector_destroy(&peers->nodes);
+	as_vector_destroy(&peers->nodes_to_remove);
+
+	as_vector* invalid_hosts = &peers->invalid_hosts;
+	
+	for (uint32_t i = 0; i < invalid_hosts->size; i++) {
+		as_host* host = as_vector_get(invalid_hosts, i);
+		as_host_destroy(host);
+	}
+	as_vector_destroy(invalid_hosts);
+}
+
+static as_status
+as_cluster_init_error(as_vector* invalid_hosts, as_error* err)
+{
+	as_string_builder sb;
+	as_string_builder_inita(&sb, 512, true);
+
+	as_string_builder_append(&sb, "Peers not reachable: ");
+
+	for (uint32_t i = 0; i < invalid_hosts->size; i++) {
+		as_host* h = as_vector_get(invalid_hosts, i);
+
+		if (i > 0) {
+			as_string_builder_append(&sb, ", ");
+		}
+		as_string_builder_append(&sb, h->name);
+		as_string_builder_append_char(&sb, ':');
+		as_string_builder_append_uint(&sb, h->port);
+	}
+	as_error_update(err, AEROSPIKE_ERR_CLIENT, sb.data);
+	as_string_builder_destroy(&sb);
+	return err->code;
+}
+
+/**
+ * Refresh all active nodes. Info requests are written to every node first and the responses
+ * are read afterwards, so a tend iteration waits roughly for the slowest node instead of the
+ * sum of all node round trips.
+ */
+static void
+as_cluster_refresh_nodes(as_cluster* cluster, as_nodes* nodes, as_peers* peers)
+{
+	as_error error_local;
+	as_vector requests;
+	as_vector_inita(&requests, sizeof(as_tend_request), nodes->size);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		if (! node->active) {
+			continue;
+		}
+
+		uint64_t deadline_ms;
+		as_status status = as_node_refresh_send(cluster, &error_local, node, &deadline_ms);
+
+		if (status == AEROSPIKE_OK) {
+			as_tend_request* req = as_vector_reserve(&requests);
+			req->node = node;
+		}
+		else {
+			// Use info level so aql doesn't see message by default.
+			as_log_info("Node %s refresh failed: %s %s",
+				node->name, as_error_string(status), error_local.message);
+			peers->gen_changed = true;
+			as_cluster_node_failure(node);
+		}
+	}
+
+	for (uint32_t i = 0; i < requests.size; i++) {
+		as_tend_request* req = as_vector_get(&requests, i);
+		as_node* node = req->node;
+
+		// Responses are read one node at a time, so the read deadline starts when this
+		// response is read. Otherwise, one slow node would consume the timeout of every
+		// node read after it.
+		uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+		uint64_t begin = cf_getns();
+		as_status status = as_node_refresh_recv(cluster, &error_local, node, peers,
+			deadline_ms);
+
+		as_cluster_track_info(cluster, node, "generations", begin);
+
+		if (status != AEROSPIKE_OK) {
+			as_log_info("Node %s refresh failed: %s %s",
+				node->name, as_error_string(status), error_local.message);
+			peers->gen_changed = true;
+			as_cluster_node_failure(node);
+		}
+	}
+	as_vector_destroy(&requests);
+}
+
+static inline bool
+as_cluster_rebalance_shm(as_cluster* cluster, as_node* node)
+{
+	return cluster->shm_info && node->racks && node->racks->size > 0;
+}
+
+/**
+ * Refresh partition maps of nodes that reported a partition generation change.
+ * Requests are pipelined across nodes in the same way as as_cluster_refresh_nodes().
+ * Racks of nodes that also reported a rebalance generation change are read in the same
+ * request. Return true if shared memory prole tenders should rebalance.
+ */
+static bool
+as_cluster_refresh_partitions(as_cluster* cluster, as_nodes* nodes, as_peers* peers)
+{
+	bool rebalance = false;
+	as_error error_local;
+	as_vector requests;
+	as_vector_inita(&requests, sizeof(as_tend_request), nodes->size);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		// Avoid "split cluster" case where this node thinks it's a 1-node cluster.
+		// Unchecked, such a node can dominate the partition map and cause all other
+		// nodes to be dropped.
+		if (! (node->partition_changed && node->failures == 0 && node->active &&
+			  (node->peers_count > 0 || peers->refresh_count == 1))) {
+			continue;
+		}
+
+		uint64_t deadline_ms;
+		bool racks = node->rebalance_changed;
+		as_status status = as_node_refresh_partitions_send(cluster, &error_local, node,
+			&deadline_ms);
+
+		if (status == AEROSPIKE_OK) {
+			as_tend_request* req = as_vector_reserve(&requests);
+			req->node = node;
+			req->racks = racks;
+		}
+		else {
+			as_log_warn("Node %s partition refresh failed: %s %s",
+						node->name, as_error_string(status), error_local.message);
+			as_cluster_node_failure(node);
+		}
+	}
+
+	for (uint32_t i = 0; i < requests.size; i++) {
+		as_tend_request* req = as_vector_get(&requests, i);
+		as_node* node = req->node;
+
+		// Read deadline starts when this response is read. See as_cluster_refresh_nodes().
+		uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+		uint64_t begin = cf_getns();
+		as_status status = as_node_refresh_partitions_recv(cluster, &error_local, node,
+			deadline_ms);
+
+		as_cluster_track_info(cluster, node, "replicas", begin);
+
+		if (status == AEROSPIKE_OK) {
+			if (req->racks && as_cluster_rebalance_shm(cluster, node)) {
+				rebalance = true;
+			}
+		}
+		else {
+			as_log_warn("Node %s partition refresh failed: %s %s",
+						node->name, as_error_string(status), error_local.message);
+			as_cluster_node_failure(node);
+		}
+	}
+	as_vector_destroy(&requests);
+	return rebalance;
 }
 
-static void
-as_cluster_destroy_peers(as_peers* peers)
+/**
+ * Refresh racks of nodes that reported a rebalance generation change and did not read racks
+ * with their partition map. Requests are pipelined across nodes in the same way as
+ * as_cluster_refresh_nodes(). Return true if shared memory prole tenders should rebalance.
+ */
+static bool
+as_cluster_refresh_racks(as_cluster* cluster, as_nodes* nodes)
 {
-	as_vector_destroy(&peers->nodes);
-	as_vector_destroy(&peers->nodes_to_remove);
+	bool rebalance = false;
+	as_error error_local;
+	as_vector requests;
+	as_vector_inita(&requests, sizeof(as_tend_request), nodes->size);
 
-	as_vector* invalid_hosts = &peers->invalid_hosts;
-	
-	for (uint32_t i = 0; i < invalid_hosts->size; i++) {
-		as_host* host = as_vector_get(invalid_hosts, i);
-		as_host_destroy(host);
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		if (! (node->rebalance_changed && node->failures == 0 && node->active)) {
+			continue;
+		}
+
+		uint64_t deadline_ms;
+		as_status status = as_node_refresh_racks_send(cluster, &error_local, node, &deadline_ms);
+
+		if (status == AEROSPIKE_OK) {
+			as_tend_request* req = as_vector_reserve(&requests);
+			req->node = node;
+			req->racks = true;
+		}
+		else {
+			as_log_warn("Node %s rack refresh failed: %s %s",
+						node->name, as_error_string(status), error_local.message);
+			as_cluster_node_failure(node);
+		}
 	}
-	as_vector_destroy(invalid_hosts);
-}
 
-static as_status
-as_cluster_init_error(as_vector* invalid_hosts, as_error* err)
-{
-	as_string_builder sb;
-	as_string_builder_inita(&sb, 512, true);
+	for (uint32_t i = 0; i < requests.size; i++) {
+		as_tend_request* req = as_vector_get(&requests, i);
+		as_node* node = req->node;
 
-	as_string_builder_append(&sb, "Peers not reachable: ");
+		// Read deadline starts when this response is read. See as_cluster_refresh_nodes().
+		uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+		uint64_t begin = cf_getns();
+		as_status status = as_node_refresh_racks_recv(cluster, &error_local, node,
+			deadline_ms);
 
-	for (uint32_t i = 0; i < invalid_hosts->size; i++) {
-		as_host* h = as_vector_get(invalid_hosts, i);
+		as_cluster_track_info(cluster, node, "rack-ids", begin);
 
-		if (i > 0) {
-			as_string_builder_append(&sb, ", ");
+		if (status == AEROSPIKE_OK) {
+			if (as_cluster_rebalance_shm(cluster, node)) {
+				rebalance = true;
+			}
+		}
+		else {
+			as_log_warn("Node %s rack refresh failed: %s %s",
+						node->name, as_error_string(status), error_local.message);
+			as_cluster_node_failure(node);
 		}
-		as_string_builder_append(&sb, h->name);
-		as_string_builder_append_char(&sb, ':');
-		as_string_builder_append_uint(&sb, h->port);
 	}
-	as_error_update(err, AEROSPIKE_ERR_CLIENT, sb.data);
-	as_string_builder_destroy(&sb);
-	return err->code;
+	as_vector_destroy(&requests);
+	return rebalance;
 }
 
 /**
@@ -847,15 +1667,25 @@ as_cluster_init_error(as_vector* invalid_hosts, as_error* err)
 as_status
 as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init)
 {
+	uint64_t begin = cf_getns();
+
+	memset(cluster->tend_phase_us, 0, sizeof(cluster->tend_phase_us));
+	cluster->tend_slow_info = NULL;
+	cluster->tend_slow_info_us = 0;
+
 	// All node additions/deletions are performed in tend thread.
 	// Garbage collect data structures released in previous tend.
 	// This tend interval delay substantially reduces the chance of
 	// deleting a ref counted data structure when other threads
 	// are stuck between assignment and incrementing the ref count.
-	as_cluster_gc(cluster->gc);
+	if (cluster->epoch_reclaim) {
+		as_cluster_gc_epoch(cluster);
+	}
+	else {
+		as_cluster_gc(cluster->gc);
+	}
 
 	// Initialize tend iteration node statistics.
-	as_error error_local;
 	as_peers peers;
 	as_vector_inita(&peers.nodes, sizeof(as_node*), 16);
 	as_vector_inita(&peers.nodes_to_remove, sizeof(as_node*), 8);
@@ -885,8 +1715,9 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init)
 		nodes = cluster->nodes;
 
 		// Abort cluster init if all peers of the seed are not reachable and
-		// fail_if_not_connected is true.
-		if (is_init && cluster->fail_if_not_connected && nodes->size == 1 &&
+		// fail_if_not_connected is true. With fast_start, partition coverage is
+		// checked after the tend instead.
+		if (is_init && cluster->fail_if_not_connected && ! cluster->fast_start && nodes->size == 1 &&
 			peers.invalid_hosts.size > 0) {
 			status = as_cluster_init_error(&peers.invalid_hosts, err);
 			as_cluster_destroy_peers(&peers);
@@ -902,6 +1733,7 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init)
 				return status;
 			}
 		}
+		begin = as_cluster_end_phase(cluster, AS_TEND_PHASE_NODES, begin);
 	}
 	else {
 		// Retrieve fixed number of partitions only once from any node.
@@ -915,41 +1747,15 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init)
 		}
 
 		// Refresh all known nodes.
-		for (uint32_t i = 0; i < nodes->size; i++) {
-			as_node* node = nodes->array[i];
-
-			if (node->active) {
-				as_status status = as_node_refresh(cluster, &error_local, node, &peers);
-
-				if (status != AEROSPIKE_OK) {
-					// Use info level so aql doesn't see message by default.
-					as_log_info("Node %s refresh failed: %s %s",
-						node->name, as_error_string(status), error_local.message);
-					peers.gen_changed = true;
-					as_cluster_node_failure(node);
-				}
-			}
-		}
+		as_cluster_refresh_nodes(cluster, nodes, &peers);
+		begin = as_cluster_end_phase(cluster, AS_TEND_PHASE_NODES, begin);
 
 		// Refresh peers when necessary.
 		if (peers.gen_changed) {
 			// Refresh peers for all nodes that responded the first time even if only one node's
 			// peers changed.
 			peers.refresh_count = 0;
-
-			for (uint32_t i = 0; i < nodes->size; i++) {
-				as_node* node = nodes->array[i];
-
-				if (node->failures == 0 && node->active) {
-					as_status status = as_node_refresh_peers(cluster, &error_local, node, &peers);
-	
-					if (status != AEROSPIKE_OK) {
-						as_log_warn("Node %s peers refresh failed: %s %s",
-							node->name, as_error_string(status), error_local.message);
-						as_cluster_node_failure(node);
-					}
-				}
-			}
+			as_cluster_refresh_node_peers(cluster, nodes->array, nodes->size, &peers);
 
 			// Remove nodes determined by refreshed peers.
 			as_cluster_find_nodes_to_remove(cluster, &peers);
@@ -967,42 +1773,29 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init)
 			as_cluster_refresh_peers(cluster, &peers);
 			nodes = cluster->nodes;
 		}
+		begin = as_cluster_end_phase(cluster, AS_TEND_PHASE_PEERS, begin);
 	}
 
 	cluster->invalid_node_count += as_peers_invalid_count(&peers);
 
-	// Refresh partition map when necessary.
-	for (uint32_t i = 0; i < nodes->size; i++) {
+	bool changed = peers.gen_changed || peers.nodes.size > 0 || peers.nodes_to_remove.size > 0;
+
+	for (uint32_t i = 0; i < nodes->size && ! changed; i++) {
 		as_node* node = nodes->array[i];
-		
-		// Avoid "split cluster" case where this node thinks it's a 1-node cluster.
-		// Unchecked, such a node can dominate the partition map and cause all other
-		// nodes to be dropped.
-		if (node->partition_changed && node->failures == 0 && node->active &&
-		   (node->peers_count > 0 || peers.refresh_count == 1)) {
-			as_status status = as_node_refresh_partitions(cluster, &error_local, node);
-			
-			if (status != AEROSPIKE_OK) {
-				as_log_warn("Node %s partition refresh failed: %s %s",
-							node->name, as_error_string(status), error_local.message);
-				as_cluster_node_failure(node);
-			}
-		}
+		changed = node->partition_changed || node->rebalance_changed || node->failures > 0;
+	}
+	cluster->tend_changed = changed;
 
-		if (node->rebalance_changed && node->failures == 0 && node->active) {
-			as_status status = as_node_refresh_racks(cluster, &error_local, node);
+	// Refresh partition map when necessary. Racks are read with the partition map when both
+	// changed.
+	if (as_cluster_refresh_partitions(cluster, nodes, &peers)) {
+		rebalance = true;
+	}
+	begin = as_cluster_end_phase(cluster, AS_TEND_PHASE_PARTITIONS, begin);
 
-			if (status == AEROSPIKE_OK) {
-				if (cluster->shm_info && node->racks && node->racks->size > 0) {
-					rebalance = true;
-				}
-			}
-			else {
-				as_log_warn("Node %s rack refresh failed: %s %s",
-							node->name, as_error_string(status), error_local.message);
-				as_cluster_node_failure(node);
-			}
-		}
+	// Refresh remaining racks when necessary.
+	if (as_cluster_refresh_racks(cluster, nodes)) {
+		rebalance = true;
 	}
 
 	if (rebalance && cluster->shm_info) {
@@ -1010,11 +1803,45 @@ as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init)
 		as_incr_uint32(&cluster->shm_info->cluster_shm->rebalance_gen);
 	}
 
+	if (! cluster->shm_info) {
+		as_partition_tables_update_racks(cluster);
+	}
+	as_cluster_end_phase(cluster, AS_TEND_PHASE_RACKS, begin);
+
 	as_cluster_destroy_peers(&peers);
 	as_cluster_manage(cluster);
 	return AEROSPIKE_OK;
 }
 
+static void
+as_cluster_phase_stats(as_latency_hdr** hdrs, uint32_t n_hdrs, as_latency_percentiles* out)
+{
+	// All phase histograms have the same size.
+	uint32_t size = hdrs[0]->size;
+	uint64_t* counts = cf_malloc(sizeof(uint64_t) * size);
+
+	for (uint32_t i = 0; i < n_hdrs; i++) {
+		as_latency_hdr* hdr = hdrs[i];
+
+		memset(counts, 0, sizeof(uint64_t) * size);
+		as_latency_hdr_merge(hdr, counts);
+		as_latency_hdr_percentiles(hdr->precision, counts, size, &out[i]);
+	}
+	cf_free(counts);
+}
+
+void
+as_cluster_tend_stats(as_cluster* cluster, as_latency_percentiles* out)
+{
+	as_cluster_phase_stats(cluster->tend_latency, AS_TEND_PHASE_MAX, out);
+}
+
+void
+as_cluster_txn_stats(as_cluster* cluster, as_latency_percentiles* out)
+{
+	as_cluster_phase_stats(cluster->txn_latency, AS_TXN_PHASE_MAX, out);
+}
+
 /**
  * Tend the cluster until it has stabilized and return control.
  * This helps avoid initial database request timeout issues when
@@ -1037,6 +1864,125 @@ as_wait_till_stabilized(as_cluster* cluster, as_error* err)
 	return AEROSPIKE_OK;
 }
 
+static void
+as_cluster_log_slow_tend(as_cluster* cluster, uint64_t duration)
+{
+	as_string_builder sb;
+	as_string_builder_inita(&sb, 512, false);
+
+	for (as_tend_phase i = 0; i < AS_TEND_PHASE_MAX; i++) {
+		as_string_builder_append_char(&sb, ' ');
+		as_string_builder_append(&sb, as_tend_phase_to_string(i));
+		as_string_builder_append_char(&sb, '=');
+		as_string_builder_append_uint64(&sb, cluster->tend_phase_us[i]);
+	}
+
+	if (cluster->tend_slow_info) {
+		as_string_builder_append(&sb, " slowest=");
+		as_string_builder_append(&sb, cluster->tend_slow_info);
+		as_string_builder_append_char(&sb, '@');
+		as_string_builder_append(&sb, cluster->tend_slow_node);
+		as_string_builder_append_char(&sb, '=');
+		as_string_builder_append_uint64(&sb, cluster->tend_slow_info_us);
+	}
+
+	as_log_warn("Slow tend %" PRIu64 "us:%s", duration, sb.data);
+	as_string_builder_destroy(&sb);
+}
+
+static uint32_t
+as_cluster_next_tend_interval(as_cluster* cluster, as_status status)
+{
+	uint32_t interval = cluster->tend_interval;
+	uint32_t max = cluster->tend_interval_max;
+
+	if (max <= interval) {
+		return interval;
+	}
+
+	// Clear hurry request. Commands that fail after this point request another fast tend.
+	bool hurry = as_cas_uint8(&cluster->tend_hurry, 1, 0);
+
+	if (status != AEROSPIKE_OK || cluster->tend_changed || hurry) {
+		return interval;
+	}
+
+	// Back off while the cluster is stable.
+	uint64_t next = (uint64_t)cluster->tend_interval_current * 2;
+	return (next < max)? (uint32_t)next : max;
+}
+
+void
+as_cluster_hurry_tend(as_cluster* cluster)
+{
+	if (as_load_uint32(&cluster->tend_interval_current) <= cluster->tend_interval) {
+		// Already tending at the minimum interval.
+		return;
+	}
+
+	// Only signal the tend thread once per tend iteration.
+	if (! as_cas_uint8(&cluster->tend_hurry, 0, 1)) {
+		return;
+	}
+
+	if (cluster->shared_threads && ! cluster->shm_info) {
+		as_shared_threads_wake(cluster->shared_threads, cluster);
+		return;
+	}
+
+	// The tend thread holds tend_lock while it tends. Do not block the command thread on a
+	// full tend. The tend thread checks tend_hurry before it sleeps again.
+	if (pthread_mutex_trylock(&cluster->tend_lock) == 0) {
+		pthread_cond_signal(&cluster->tend_cond);
+		pthread_mutex_unlock(&cluster->tend_lock);
+	}
+}
+
+void
+as_cluster_wake_tender(as_cluster* cluster)
+{
+	if (cluster->shared_threads && ! cluster->shm_info) {
+		as_shared_threads_wake(cluster->shared_threads, cluster);
+		return;
+	}
+
+	pthread_mutex_lock(&cluster->tend_lock);
+	pthread_cond_signal(&cluster->tend_cond);
+	pthread_mutex_unlock(&cluster->tend_lock);
+}
+
+uint32_t
+as_cluster_tend_run(as_cluster* cluster)
+{
+	uint64_t begin = cf_getns();
+
+	as_error err;
+	as_status status = as_cluster_tend(cluster, &err, false);
+
+	if (status != AEROSPIKE_OK) {
+		as_log_warn("Tend error: %s %s", as_error_string(status), err.message);
+	}
+	else if (cluster->snapshot_path) {
+		as_cluster_snapshot_save(cluster);
+	}
+
+	uint64_t duration = (cf_getns() - begin) / 1000;
+
+	as_store_uint64(&cluster->tend_duration, duration);
+
+	if (cluster->tend_slow_threshold > 0 &&
+		duration >= (uint64_t)cluster->tend_slow_threshold * 1000) {
+		as_cluster_log_slow_tend(cluster, duration);
+	}
+
+	uint32_t interval = as_cluster_next_tend_interval(cluster, status);
+
+	if (interval != cluster->tend_interval_current) {
+		as_store_uint32(&cluster->tend_interval_current, interval);
+	}
+	return interval;
+}
+
 static void*
 as_cluster_tender(void* data)
 {
@@ -1055,18 +2001,20 @@ as_cluster_tender(void* data)
 	
 	struct timespec abstime;
 	
-	as_status status;
-	as_error err;
-	
 	pthread_mutex_lock(&cluster->tend_lock);
 
 	while (cluster->valid) {
-		status = as_cluster_tend(cluster, &err, false);
-		
-		if (status != AEROSPIKE_OK) {
-			as_log_warn("Tend error: %s %s", as_error_string(status), err.message);
+		uint32_t interval = cluster->tend_interval_current;
+
+		if (as_cluster_tend_run(cluster) != interval) {
+			cf_clock_set_timespec_ms(cluster->tend_interval_current, &delta);
 		}
-		
+
+		if (as_load_uint8(&cluster->tend_hurry)) {
+			// Hurry was requested while tending, so its signal may have been skipped.
+			continue;
+		}
+
 		// Convert tend interval into absolute timeout.
 		cf_clock_current_add(&delta, &abstime);
 		
@@ -1166,8 +2114,26 @@ as_cluster_add_seeds(as_cluster* cluster)
 as_status
 as_cluster_init(as_cluster* cluster, as_error* err)
 {
+	if (cluster->snapshot_path && as_cluster_snapshot_load(cluster)) {
+		// Commands are routed with the restored partition maps. The tend thread validates
+		// restored nodes and replaces stale partition maps in its first iteration.
+		as_cluster_add_seeds(cluster);
+		cluster->valid = true;
+		return AEROSPIKE_OK;
+	}
+
 	// Tend cluster until all nodes identified.
+	cluster->fast_starting = cluster->fast_start;
+
 	as_status status = as_wait_till_stabilized(cluster, err);
+
+	cluster->fast_starting = false;
+
+	if (status == AEROSPIKE_OK && cluster->fast_start &&
+		! as_partition_tables_covered(&cluster->partition_tables)) {
+		status = as_error_set_message(err, AEROSPIKE_ERR_CLIENT,
+			"Cluster partitions are not covered by master nodes");
+	}
 	
 	if (status != AEROSPIKE_OK) {
 		if (cluster->fail_if_not_connected) {
@@ -1332,7 +2298,7 @@ as_cluster_force_single_node(as_cluster* cluster, as_error* err)
 	as_host* host = as_vector_get(cluster->seeds, 0);
 
 	as_address_iterator iter;
-	as_status status = as_lookup_host(&iter, err, host->name, host->port);
+	as_status status = as_lookup_host_cluster(cluster, &iter, err, host->name, host->port);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
@@ -1404,6 +2370,11 @@ as_cluster_create(aerospike* as, as_error* err)
 			"Invalid tend interval: %u. min value: %u", config->tender_interval, AS_TEND_INTERVAL_MIN);
 	}
 
+	if (config->tender_interval_max > 0 && config->tender_interval_max < config->tender_interval) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+			"Invalid tend interval range: %u - %u", config->tender_interval, config->tender_interval_max);
+	}
+
 	if (config->config_provider.path && config->config_provider.interval < config->tender_interval) {
 		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
 			"Dynamic config interval %u must be greater or equal to the tend interval %u",
@@ -1420,6 +2391,14 @@ as_cluster_create(aerospike* as, as_error* err)
 			config->async_min_conns_per_node, config->async_max_conns_per_node);
 	}
 
+	const as_allocator* allocator = &config->allocator;
+
+	if ((allocator->malloc_fn || allocator->realloc_fn || allocator->free_fn) &&
+		! (allocator->malloc_fn && allocator->realloc_fn && allocator->free_fn)) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"All allocator functions must be defined");
+	}
+
 	as_config_massage_error_rate(config);
 
 	char* pass_hash = NULL;
@@ -1452,6 +2431,8 @@ as_cluster_create(aerospike* as, as_error* err)
 	
 	as_cluster* cluster = cf_malloc(sizeof(as_cluster));
 	memset(cluster, 0, sizeof(as_cluster));
+	cluster->serial = as_aaf_uint32(&as_cluster_serial, 1);
+	cluster->routing_gen = 1;
 	cluster->auth_mode = config->auth_mode;
 
 	if (config->auth_mode == AS_AUTH_PKI) {
@@ -1468,29 +2449,78 @@ as_cluster_create(aerospike* as, as_error* err)
 		}
 	}
 
-	// Heap allocated cluster_name/app_id continue to be owned by as->config.
-	// Make a reference copy here.
+	// Heap allocated cluster_name/app_id/latency_tags/snapshot_path continue to be owned by
+	// as->config. Make a reference copy here.
 	cluster->cluster_name = config->cluster_name;
 	cluster->app_id = config->app_id;
+	memcpy(cluster->latency_tags, config->latency_tags, sizeof(cluster->latency_tags));
 	cluster->event_callback = config->event_callback;
 	cluster->event_callback_udata = config->event_callback_udata;
+	cluster->trace_callback = config->trace_callback;
+	cluster->trace_udata = config->trace_udata;
+	cluster->trace_sample_rate = config->trace_sample_rate ? config->trace_sample_rate : 1;
+	cluster->trace_count = 0;
+	cluster->snapshot_path = (config->use_shm || config->force_single_node)?
+		NULL : config->snapshot_path;
+	cluster->snapshot_key = 0;
 
 	// Initialize cluster tend and node parameters
 	cluster->max_error_rate = config->max_error_rate;
 	cluster->error_rate_window = config->error_rate_window;
+	cluster->breaker_ratio = config->circuit_breaker_ratio;
+	cluster->breaker_min_commands = config->circuit_breaker_min_commands;
+	cluster->breaker_probes = config->circuit_breaker_probes;
+	cluster->breaker_open_tends = config->circuit_breaker_open_tends;
+	cluster->breaker_max_open_tends = config->circuit_breaker_max_open_tends;
+	cluster->limit_max = config->concurrency_limit_max;
+	cluster->limit_min = config->concurrency_limit_min;
+
+	// Limit budget, so thousandths of a token fit in 32 bits.
+	uint32_t tokens = (config->retry_budget_tokens < 1000000)? config->retry_budget_tokens : 1000000;
+	cluster->retry_budget_max = tokens * 1000;
+	cluster->retry_budget = cluster->retry_budget_max;
+	cluster->retry_budget_refill = config->retry_budget_refill_pct * 10;
 	cluster->tend_interval = config->tender_interval;
+	cluster->tend_interval_max = config->tender_interval_max;
+	cluster->tend_interval_current = config->tender_interval;
+	cluster->tend_changed = false;
+	cluster->tend_hurry = 0;
 	cluster->min_conns_per_node = config->min_conns_per_node;
 	cluster->max_conns_per_node = config->max_conns_per_node;
+	cluster->warm_up_conns_per_tend = config->warm_up_conns_per_tend;
+	cluster->spare_conns_per_node = config->spare_conns_per_node;
+	cluster->max_connects_per_node = config->max_connects_per_node;
 	cluster->async_min_conns_per_node = config->async_min_conns_per_node;
+	cluster->async_max_connects_per_loop = config->async_max_connects_per_loop;
+	cluster->auto_batch_max = config->async_auto_batch_max;
+	cluster->sync_over_async = config->sync_over_async;
+	cluster->sync_over_async_pipeline = config->sync_over_async_pipeline;
+	cluster->mem_budget = (config->memory_budget > 0) ?
+		as_mem_budget_create(config->memory_budget) : NULL;
+	cluster->mem_budget_wait = config->memory_budget_wait;
+	cluster->offload_threshold = config->async_offload_threshold;
 	cluster->async_max_conns_per_node = config->async_max_conns_per_node;
+	cluster->async_borrow_conns = config->async_borrow_conns;
 	cluster->pipe_max_conns_per_node = config->pipe_max_conns_per_node;
+	cluster->pipe_max_depth = config->pipe_max_depth;
+	cluster->pipe_large_response_size = config->pipe_large_response_size;
 	cluster->conn_timeout_ms = (config->conn_timeout_ms == 0) ? 1000 : config->conn_timeout_ms;
 	cluster->login_timeout_ms = (config->login_timeout_ms == 0) ? 5000 : config->login_timeout_ms;
+	cluster->socket_busy_poll_us = config->socket_busy_poll_us;
+	cluster->socket_options = config->socket_options;
 	cluster->tend_thread_cpu = config->tend_thread_cpu;
+	cluster->tend_slow_threshold = config->tend_slow_threshold;
+	cluster->allocator = config->allocator;
 	cluster->conn_pools_per_node = config->conn_pools_per_node;
+	cluster->conn_cache_size = config->conn_cache_size;
+	cluster->sync_pipes_per_node = config->tls.enable ? 0 : config->sync_pipes_per_node;
+	cluster->compress_codec = config->compress_codec;
+	cluster->compress_codec_current = AS_COMPRESS_ZLIB;
 	cluster->use_services_alternate = config->use_services_alternate;
 	cluster->rack_aware = config->rack_aware;
 	cluster->fail_if_not_connected = config->fail_if_not_connected;
+	cluster->seed_parallel = config->seed_parallel;
+	cluster->fast_start = config->fast_start && ! config->use_shm;
 
 	if (config->rack_ids) {
 		uint32_t max = config->rack_ids->size;
@@ -1507,6 +2537,22 @@ as_cluster_create(aerospike* as, as_error* err)
 	}
 
 	as_cluster_set_max_socket_idle(cluster, config->max_socket_idle);
+	cluster->conn_peak_window = (config->conn_peak_window <= AS_CONN_WINDOW_MAX)?
+		config->conn_peak_window : AS_CONN_WINDOW_MAX;
+	cluster->conn_validate_window_ns = (uint64_t)config->conn_validate_window_ms * 1000 * 1000;
+	cluster->epoch_reclaim = config->epoch_reclaim;
+
+	if (cluster->epoch_reclaim) {
+		as_epoch_init();
+	}
+
+	if (config->command_buffer_cache_max > 0) {
+		as_command_buffer_cache_max = config->command_buffer_cache_max;
+	}
+
+	if (config->coarse_clock) {
+		as_clock_coarse = true;
+	}
 
 	// Initialize seed hosts.  Round initial capacity up to multiple of 16.
 	as_vector* src = config->hosts;
@@ -1547,18 +2593,25 @@ as_cluster_create(aerospike* as, as_error* err)
 
 	// Initialize garbage collection array.
 	cluster->gc = as_vector_create(sizeof(as_gc_item), 8);
+	cluster->gc_epoch = as_vector_create(sizeof(as_gc_epoch_item), 8);
 	
-	// Initialize thread pool.
-	int rc = as_thread_pool_init(&cluster->thread_pool, config->thread_pool_size);
+	if (config->shared_threads) {
+		// Use worker pool and tend thread shared with other clusters.
+		cluster->shared_threads = config->shared_threads;
+		cluster->thread_pool = &config->shared_threads->pool;
+	}
+	else {
+		// Initialize thread pool with per-thread TLS cleanup function.
+		int rc = as_work_pool_init(&cluster->local_pool, config->thread_pool_size,
+			as_tls_thread_cleanup);
 
-	// Setup per-thread TLS cleanup function.
-	cluster->thread_pool.fini_fn = as_tls_thread_cleanup;
-	
-	if (rc) {
-		as_status status = as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to initialize thread pool of size %u: %d",
-				config->thread_pool_size, rc);
-		as_cluster_destroy(cluster);
-		return status;
+		if (rc) {
+			as_status status = as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to initialize thread pool of size %u: %d",
+					config->thread_pool_size, rc);
+			as_cluster_destroy(cluster);
+			return status;
+		}
+		cluster->thread_pool = &cluster->local_pool;
 	}
 
 	if (config->tls.enable) {
@@ -1581,14 +2634,45 @@ as_cluster_create(aerospike* as, as_error* err)
 		}
 	}
 
+	if (config->compress_dicts) {
+		as_status status = as_cluster_load_compress_dicts(cluster, config->compress_dicts, err);
+
+		if (status != AEROSPIKE_OK) {
+			as_cluster_destroy(cluster);
+			return status;
+		}
+	}
+
+	cluster->quotas = as_quotas_create(config->quotas);
+
 	// Initialize metrics fields
 	cluster->metrics_enabled = false;
 	cluster->metrics_interval = 0;
 	cluster->metrics_latency_columns = 0;
 	cluster->metrics_latency_shift = 0;
+	cluster->metrics_latency_precision = 0;
+	cluster->metrics_hot_keys = 0;
+	cluster->metrics_partition_heatmap = 0;
+	cluster->metrics_tcp_info_interval = 0;
 	cluster->command_count = 0;
 	cluster->retry_count = 0;
+	cluster->retry_budget_exhausted_count = 0;
 	cluster->delay_queue_timeout_count = 0;
+	cluster->hedge_count = 0;
+	cluster->hedge_win_count = 0;
+	cluster->batch_inline_count = 0;
+	cluster->batch_parallel_count = 0;
+	cluster->batch_record_size = 0;
+	cluster->tend_duration = 0;
+
+	for (as_tend_phase i = 0; i < AS_TEND_PHASE_MAX; i++) {
+		cluster->tend_latency[i] = as_latency_hdr_create(AS_TEND_LATENCY_PRECISION);
+	}
+
+	for (as_txn_phase i = 0; i < AS_TXN_PHASE_MAX; i++) {
+		cluster->txn_latency[i] = as_latency_hdr_create(AS_TEND_LATENCY_PRECISION);
+	}
+	memset(cluster->compress_stats, 0, sizeof(cluster->compress_stats));
 
 	cluster->as = as;
 
@@ -1600,6 +2684,22 @@ as_cluster_create(aerospike* as, as_error* err)
 		if (!as_file_get_status(config->config_provider.path, &cluster->config_file_status)) {
 			as_log_warn("Failed to read: %s", config->config_provider.path);
 		}
+
+		if (!as_file_watch(config->config_provider.path, &cluster->config_file_status)) {
+			as_log_debug("Poll %s for changes every %u ms", config->config_provider.path,
+				cluster->config_interval);
+		}
+	}
+
+	if (config->dns_cache_ttl > 0) {
+		cluster->dns_cache = as_dns_cache_create(config->dns_cache_ttl);
+	}
+
+	cluster->job_monitor = as_job_monitor_create(cluster);
+
+	if (config->slow_command_ms > 0) {
+		cluster->slow_log = as_slow_log_create(config->slow_command_ms,
+			config->slow_command_log_size ? config->slow_command_log_size : 1024);
 	}
 
 	if (config->force_single_node) {
@@ -1635,6 +2735,13 @@ as_cluster_create(aerospike* as, as_error* err)
 			as_cluster_destroy(cluster);
 			return status;
 		}
+
+		if (cluster->shared_threads) {
+			as_shared_threads_add(cluster->shared_threads, cluster);
+			as->cluster = cluster;
+			return AEROSPIKE_OK;
+		}
+
 		// Run cluster tend thread.
 		pthread_attr_t attr;
 		pthread_attr_init(&attr);
@@ -1670,7 +2777,12 @@ as_cluster_destroy(as_cluster* cluster)
 		pthread_mutex_unlock(&cluster->tend_lock);
 		
 		// Wait for tend thread to finish.
-		pthread_join(cluster->tend_thread, NULL);
+		if (cluster->shared_threads && ! cluster->shm_info) {
+			as_shared_threads_remove(cluster->shared_threads, cluster);
+		}
+		else {
+			pthread_join(cluster->tend_thread, NULL);
+		}
 		
 		if (cluster->shm_info) {
 			as_shm_destroy(cluster);
@@ -1680,14 +2792,26 @@ as_cluster_destroy(as_cluster* cluster)
 		pthread_mutex_unlock(&cluster->tend_lock);
 	}
 
-	// Shutdown thread pool.
-	int rc = as_thread_pool_destroy(&cluster->thread_pool);
+	// Shutdown thread pool. Shared pools are destroyed by as_shared_threads_destroy().
+	if (cluster->thread_pool == &cluster->local_pool) {
+		int rc = as_work_pool_destroy(&cluster->local_pool);
 	
-	if (rc) {
-		as_log_warn("Failed to destroy thread pool: %d", rc);
+		if (rc) {
+			as_log_warn("Failed to destroy thread pool: %d", rc);
+		}
+	}
+
+	if (cluster->mem_budget) {
+		as_mem_budget_destroy(cluster->mem_budget);
 	}
 
 	// Release everything in garbage collector.
+	for (uint32_t i = 0; i < cluster->gc_epoch->size; i++) {
+		as_gc_epoch_item* item = as_vector_get(cluster->gc_epoch, i);
+		item->item.release_fn(item->item.data);
+	}
+	as_vector_destroy(cluster->gc_epoch);
+
 	as_cluster_gc(cluster->gc);
 	as_vector_destroy(cluster->gc);
 		
@@ -1712,6 +2836,15 @@ as_cluster_destroy(as_cluster* cluster)
 	// Destroy racks.
 	as_vector_destroy(cluster->rack_ids);
 
+	// Release compression dictionaries.
+	if (cluster->compress_dicts) {
+		as_cluster_release_compress_dicts(cluster->compress_dicts);
+	}
+
+	if (cluster->quotas) {
+		cf_free(cluster->quotas);
+	}
+
 	// Destroy seeds.
 	pthread_mutex_lock(&cluster->seed_lock);
 	as_vector* seeds = cluster->seeds;
@@ -1742,11 +2875,39 @@ as_cluster_destroy(as_cluster* cluster)
 	// Do not free config_file_path name because as->config owns it.
 	// cf_free(cluster->config_file_path);
 
+	if (cluster->as && cluster->as->config.config_provider.path) {
+		as_file_unwatch(&cluster->config_file_status);
+	}
+
 	if (cluster->tls_ctx) {
 		as_tls_context_destroy(cluster->tls_ctx);
 		cf_free(cluster->tls_ctx);
 	}
 
+	if (cluster->dns_cache) {
+		as_dns_cache_destroy(cluster->dns_cache);
+	}
+
+	if (cluster->job_monitor) {
+		as_job_monitor_destroy(cluster->job_monitor);
+	}
+
+	if (cluster->slow_log) {
+		as_slow_log_destroy(cluster->slow_log);
+	}
+
+	for (as_tend_phase i = 0; i < AS_TEND_PHASE_MAX; i++) {
+		if (cluster->tend_latency[i]) {
+			as_latency_hdr_release(cluster->tend_latency[i]);
+		}
+	}
+
+	for (as_txn_phase i = 0; i < AS_TXN_PHASE_MAX; i++) {
+		if (cluster->txn_latency[i]) {
+			as_latency_hdr_release(cluster->txn_latency[i]);
+		}
+	}
+
 #if defined(_MSC_VER)
 	// Call WSACleanup() for every cluster instance shutdown on windows.
 	WSACleanup();
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_cluster_snapshot.h>
+#include <aerospike/as_address.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_string.h>
+#include <aerospike/as_vector.h>
+#include <citrusleaf/alloc.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_SNAPSHOT_MAGIC 0x53435341 // "ASCS" in little endian.
+#define AS_SNAPSHOT_VERSION 1
+#define AS_SNAPSHOT_MAX_NODES 0xFFFF
+#define AS_SNAPSHOT_MAX_PARTITIONS 4096
+
+//---------------------------------
+// Types
+//---------------------------------
+
+// The snapshot is only read by clients on the host that wrote it, so fields are stored in
+// native byte order.
+typedef struct as_snapshot_header_s {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t n_partitions;
+	uint32_t n_nodes;
+	uint32_t n_tables;
+	uint32_t pad;
+} as_snapshot_header;
+
+typedef struct as_snapshot_node_s {
+	char name[AS_NODE_NAME_SIZE];
+	char tls_name[AS_HOSTNAME_SIZE];
+	struct sockaddr_storage addr;
+	as_version version;
+	uint32_t features;
+	uint32_t pad;
+} as_snapshot_node;
+
+typedef struct as_snapshot_table_s {
+	char ns[AS_MAX_NAMESPACE_SIZE];
+	uint8_t replica_size;
+	uint8_t sc_mode;
+	uint8_t pad[2];
+} as_snapshot_table;
+
+typedef struct as_snapshot_partition_s {
+	// Index into snapshot nodes plus one. Zero if replica does not have an owner.
+	uint16_t nodes[AS_MAX_REPLICATION_FACTOR];
+	uint16_t pad;
+	uint32_t regime;
+} as_snapshot_partition;
+
+//---------------------------------
+// Function declarations
+//---------------------------------
+
+as_status
+as_node_ensure_login_shm(as_error* err, as_node* node);
+
+void
+as_cluster_add_nodes_copy(as_cluster* cluster, as_vector* /* <as_node*> */ nodes_to_add);
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline size_t
+as_snapshot_table_size(uint32_t n_partitions)
+{
+	return sizeof(as_snapshot_table) + sizeof(as_snapshot_partition) * n_partitions;
+}
+
+static uint8_t*
+as_snapshot_read(const char* path, size_t* size)
+{
+	FILE* fp = fopen(path, "rb");
+
+	if (! fp) {
+		return NULL;
+	}
+
+	if (fseek(fp, 0, SEEK_END) != 0) {
+		fclose(fp);
+		return NULL;
+	}
+
+	long len = ftell(fp);
+
+	if (len < (long)sizeof(as_snapshot_header) || fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return NULL;
+	}
+
+	uint8_t* buf = cf_malloc(len);
+	size_t rv = fread(buf, 1, len, fp);
+	fclose(fp);
+
+	if (rv != (size_t)len) {
+		cf_free(buf);
+		return NULL;
+	}
+
+	*size = rv;
+	return buf;
+}
+
+static bool
+as_snapshot_validate(const uint8_t* buf, size_t size)
+{
+	const as_snapshot_header* header = (const as_snapshot_header*)buf;
+
+	if (header->magic != AS_SNAPSHOT_MAGIC || header->version != AS_SNAPSHOT_VERSION) {
+		return false;
+	}
+
+	uint32_t n_partitions = header->n_partitions;
+
+	// Partition ids are computed with a mask, so the partition count must be a power of two.
+	if (n_partitions == 0 || n_partitions > AS_SNAPSHOT_MAX_PARTITIONS ||
+		(n_partitions & (n_partitions - 1)) != 0) {
+		return false;
+	}
+
+	if (header->n_nodes == 0 || header->n_nodes > AS_SNAPSHOT_MAX_NODES ||
+		header->n_tables > AS_MAX_NAMESPACES) {
+		return false;
+	}
+
+	size_t expected = sizeof(as_snapshot_header) + sizeof(as_snapshot_node) * header->n_nodes +
+		as_snapshot_table_size(n_partitions) * header->n_tables;
+
+	if (size != expected) {
+		return false;
+	}
+
+	const as_snapshot_node* nodes = (const as_snapshot_node*)(header + 1);
+
+	for (uint32_t i = 0; i < header->n_nodes; i++) {
+		const as_snapshot_node* sn = &nodes[i];
+
+		if (memchr(sn->name, 0, sizeof(sn->name)) == NULL ||
+			memchr(sn->tls_name, 0, sizeof(sn->tls_name)) == NULL ||
+			(sn->addr.ss_family != AF_INET && sn->addr.ss_family != AF_INET6)) {
+			return false;
+		}
+	}
+
+	const uint8_t* p = (const uint8_t*)&nodes[header->n_nodes];
+
+	for (uint32_t i = 0; i < header->n_tables; i++) {
+		const as_snapshot_table* st = (const as_snapshot_table*)p;
+
+		if (memchr(st->ns, 0, sizeof(st->ns)) == NULL || st->ns[0] == 0 ||
+			st->replica_size == 0 || st->replica_size > AS_MAX_REPLICATION_FACTOR) {
+			return false;
+		}
+
+		const as_snapshot_partition* parts = (const as_snapshot_partition*)(st + 1);
+
+		for (uint32_t j = 0; j < n_partitions; j++) {
+			for (uint32_t k = 0; k < AS_MAX_REPLICATION_FACTOR; k++) {
+				if (parts[j].nodes[k] > header->n_nodes) {
+					return false;
+				}
+			}
+		}
+		p += as_snapshot_table_size(n_partitions);
+	}
+	return true;
+}
+
+static as_node*
+as_snapshot_create_node(as_cluster* cluster, const as_snapshot_node* sn)
+{
+	as_node_info node_info;
+	as_strncpy(node_info.name, sn->name, AS_NODE_NAME_SIZE);
+	as_socket_init(&node_info.socket);
+	node_info.features = sn->features;
+	node_info.host.name = NULL;
+	node_info.host.tls_name = sn->tls_name[0] ? (char*)sn->tls_name : NULL;
+	node_info.host.port = 0;
+	as_address_copy_storage((struct sockaddr*)&sn->addr, &node_info.addr);
+	node_info.session = NULL;
+	node_info.version = sn->version;
+
+	as_node* node = as_node_create(cluster, &node_info);
+
+	if (! node) {
+		return NULL;
+	}
+
+	if (cluster->auth_enabled) {
+		// Retrieve session token now, so commands issued before the first tend can
+		// authenticate. Failures are handled by the tend thread.
+		as_error err;
+		node->perform_login = 1;
+
+		if (as_node_ensure_login_shm(&err, node) != AEROSPIKE_OK) {
+			as_log_info("Snapshot node %s login failed: %s %s", node->name,
+				as_error_string(err.code), err.message);
+		}
+	}
+	as_node_create_min_connections(node);
+	return node;
+}
+
+static uint64_t
+as_snapshot_hash(uint64_t hash, const void* data, size_t size)
+{
+	const uint8_t* p = data;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static uint64_t
+as_snapshot_key(as_nodes* nodes)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	hash = as_snapshot_hash(hash, &nodes->size, sizeof(nodes->size));
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		hash = as_snapshot_hash(hash, node->name, strlen(node->name));
+		hash = as_snapshot_hash(hash, &node->partition_generation,
+			sizeof(node->partition_generation));
+		hash = as_snapshot_hash(hash, &node->peers_generation, sizeof(node->peers_generation));
+	}
+	return hash;
+}
+
+static uint16_t
+as_snapshot_node_index(as_nodes* nodes, as_node* node)
+{
+	if (! node) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		if (nodes->array[i] == node) {
+			return (uint16_t)(i + 1);
+		}
+	}
+	// Node is referenced by partition map, but was already removed from cluster.
+	return 0;
+}
+
+static bool
+as_snapshot_write(const char* path, const uint8_t* buf, size_t size)
+{
+	// Write to a temporary file and rename, so readers never see a partial snapshot.
+	size_t path_len = strlen(path);
+	char* tmp = cf_malloc(path_len + 5);
+	memcpy(tmp, path, path_len);
+	memcpy(tmp + path_len, ".tmp", 5);
+
+	FILE* fp = fopen(tmp, "wb");
+
+	if (! fp) {
+		cf_free(tmp);
+		return false;
+	}
+
+	size_t rv = fwrite(buf, 1, size, fp);
+
+	if (fclose(fp) != 0 || rv != size) {
+		remove(tmp);
+		cf_free(tmp);
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	// Windows rename() does not replace an existing file.
+	remove(path);
+#endif
+
+	bool ok = rename(tmp, path) == 0;
+
+	if (! ok) {
+		remove(tmp);
+	}
+	cf_free(tmp);
+	return ok;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+bool
+as_cluster_snapshot_load(as_cluster* cluster)
+{
+	const char* path = cluster->snapshot_path;
+	size_t size;
+	uint8_t* buf = as_snapshot_read(path, &size);
+
+	if (! buf) {
+		as_log_debug("Cluster snapshot not found: %s", path);
+		return false;
+	}
+
+	if (! as_snapshot_validate(buf, size)) {
+		as_log_warn("Ignore invalid cluster snapshot: %s", path);
+		cf_free(buf);
+		return false;
+	}
+
+	as_snapshot_header* header = (as_snapshot_header*)buf;
+	as_snapshot_node* snodes = (as_snapshot_node*)(header + 1);
+	uint32_t n_nodes = header->n_nodes;
+	uint32_t n_partitions = header->n_partitions;
+
+	// Map snapshot node index to created node.
+	as_node** map = cf_malloc(sizeof(as_node*) * n_nodes);
+
+	as_vector nodes_to_add;
+	as_vector_inita(&nodes_to_add, sizeof(as_node*), n_nodes);
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		as_node* node = as_snapshot_create_node(cluster, &snodes[i]);
+
+		map[i] = node;
+
+		if (node) {
+			as_vector_append(&nodes_to_add, &node);
+		}
+	}
+
+	if (nodes_to_add.size == 0) {
+		as_vector_destroy(&nodes_to_add);
+		cf_free(map);
+		cf_free(buf);
+		return false;
+	}
+
+	cluster->n_partitions = n_partitions;
+	as_cluster_add_nodes_copy(cluster, &nodes_to_add);
+	as_vector_destroy(&nodes_to_add);
+
+	// Restore partition maps.
+	as_node** owners = cf_malloc(sizeof(as_node*) * AS_MAX_REPLICATION_FACTOR * n_partitions);
+	uint32_t* regimes = cf_malloc(sizeof(uint32_t) * n_partitions);
+	uint8_t* p = (uint8_t*)&snodes[n_nodes];
+
+	for (uint32_t i = 0; i < header->n_tables; i++) {
+		as_snapshot_table* st = (as_snapshot_table*)p;
+		as_snapshot_partition* parts = (as_snapshot_partition*)(st + 1);
+
+		for (uint32_t j = 0; j < n_partitions; j++) {
+			as_snapshot_partition* sp = &parts[j];
+			as_node** o = &owners[j * AS_MAX_REPLICATION_FACTOR];
+
+			for (uint32_t k = 0; k < AS_MAX_REPLICATION_FACTOR; k++) {
+				o[k] = sp->nodes[k] ? map[sp->nodes[k] - 1] : NULL;
+			}
+			regimes[j] = sp->regime;
+		}
+
+		if (! as_partition_tables_restore(cluster, st->ns, st->replica_size, st->sc_mode != 0,
+			owners, regimes)) {
+			as_log_warn("Ignore duplicate cluster snapshot namespace: %s", st->ns);
+		}
+		p += as_snapshot_table_size(n_partitions);
+	}
+
+	as_log_info("Restored cluster snapshot %s: %u nodes %u namespaces", path,
+		cluster->nodes->size, cluster->partition_tables.size);
+
+	cf_free(regimes);
+	cf_free(owners);
+	cf_free(map);
+	cf_free(buf);
+	return true;
+}
+
+void
+as_cluster_snapshot_save(as_cluster* cluster)
+{
+	as_nodes* nodes = cluster->nodes;
+	as_partition_tables* tables = &cluster->partition_tables;
+	uint32_t n_partitions = cluster->n_partitions;
+
+	if (nodes->size == 0 || nodes->size > AS_SNAPSHOT_MAX_NODES || n_partitions == 0) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		// Do not save until every node's partition map has been received.
+		if (nodes->array[i]->partition_generation == 0xFFFFFFFF) {
+			return;
+		}
+	}
+
+	uint64_t key = as_snapshot_key(nodes);
+
+	if (key == cluster->snapshot_key) {
+		return;
+	}
+
+	size_t size = sizeof(as_snapshot_header) + sizeof(as_snapshot_node) * nodes->size +
+		as_snapshot_table_size(n_partitions) * tables->size;
+	uint8_t* buf = cf_malloc(size);
+	memset(buf, 0, size);
+
+	as_snapshot_header* header = (as_snapshot_header*)buf;
+	header->magic = AS_SNAPSHOT_MAGIC;
+	header->version = AS_SNAPSHOT_VERSION;
+	header->n_partitions = n_partitions;
+	header->n_nodes = nodes->size;
+	header->n_tables = tables->size;
+
+	as_snapshot_node* snodes = (as_snapshot_node*)(header + 1);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+		as_snapshot_node* sn = &snodes[i];
+
+		as_strncpy(sn->name, node->name, AS_NODE_NAME_SIZE);
+
+		if (node->tls_name) {
+			as_strncpy(sn->tls_name, node->tls_name, AS_HOSTNAME_SIZE);
+		}
+		as_address_copy_storage(as_node_get_address(node), &sn->addr);
+		sn->version = node->version;
+		sn->features = node->features;
+	}
+
+	uint8_t* p = (uint8_t*)&snodes[nodes->size];
+
+	for (uint32_t i = 0; i < tables->size; i++) {
+		as_partition_table* table = tables->tables[i];
+		as_snapshot_table* st = (as_snapshot_table*)p;
+
+		as_strncpy(st->ns, table->ns, AS_MAX_NAMESPACE_SIZE);
+		st->replica_size = table->replica_size;
+		st->sc_mode = table->sc_mode;
+
+		as_snapshot_partition* parts = (as_snapshot_partition*)(st + 1);
+
+		for (uint32_t j = 0; j < n_partitions; j++) {
+			as_partition* part = &table->partitions[j];
+			as_snapshot_partition* sp = &parts[j];
+
+			for (uint32_t k = 0; k < AS_MAX_REPLICATION_FACTOR; k++) {
+				sp->nodes[k] = as_snapshot_node_index(nodes, part->nodes[k]);
+			}
+			sp->regime = part->regime;
+		}
+		p += as_snapshot_table_size(n_partitions);
+	}
+
+	if (! as_snapshot_write(cluster->snapshot_path, buf, size)) {
+		// Do not retry until the cluster changes again.
+		as_log_warn("Failed to write cluster snapshot: %s", cluster->snapshot_path);
+	}
+	cluster->snapshot_key = key;
+	cf_free(buf);
+}
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_coalescer.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <string.h>
+#include "_bin.h"
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Must be a power of 2.
+#define AS_COALESCE_BUCKETS 1024
+
+// List operation code of as_operations_list_append().
+#define AS_COALESCE_LIST_APPEND 1
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static bool
+as_coalesce_is_list_append(const as_bin* bin)
+{
+	if (as_bin_get_type(bin) != AS_BYTES) {
+		return false;
+	}
+
+	// List appends without context are packed as [APPEND, value, ...]. Appends with context
+	// start with the context array and are not merged.
+	as_bytes* bytes = (as_bytes*)bin->valuep;
+	return bytes->size >= 2 && (bytes->value[0] & 0xf0) == 0x90 &&
+		bytes->value[1] == AS_COALESCE_LIST_APPEND;
+}
+
+static bool
+as_coalesce_can_merge(const as_policy_operate* policy, const as_operations* ops)
+{
+	if (policy->base.filter_exp || policy->base.txn || policy->gen != AS_POLICY_GEN_IGNORE ||
+		policy->async_heap_rec) {
+		return false;
+	}
+
+	if (ops->gen != 0 || ops->binops.size == 0) {
+		return false;
+	}
+
+	for (uint16_t i = 0; i < ops->binops.size; i++) {
+		as_binop* binop = &ops->binops.entries[i];
+
+		switch (binop->op) {
+			case AS_OPERATOR_INCR: {
+				as_val_t type = as_bin_get_type(&binop->bin);
+
+				if (type != AS_INTEGER && type != AS_DOUBLE) {
+					return false;
+				}
+				break;
+			}
+
+			case AS_OPERATOR_CDT_MODIFY:
+				if (! as_coalesce_is_list_append(&binop->bin)) {
+					return false;
+				}
+				break;
+
+			default:
+				return false;
+		}
+	}
+	return true;
+}
+
+static inline uint32_t
+as_coalesce_bucket(as_coalescer* coalescer, const as_digest_value digest)
+{
+	uint32_t h;
+	memcpy(&h, digest, sizeof(h));
+	return h & (coalescer->n_buckets - 1);
+}
+
+// Must hold coalescer lock.
+static as_coalesce_entry*
+as_coalesce_find(
+	as_coalescer* coalescer, const as_key* key, const as_policy_operate* policy, uint32_t ttl
+	)
+{
+	uint32_t b = as_coalesce_bucket(coalescer, key->digest.value);
+
+	for (as_coalesce_entry* e = coalescer->buckets[b]; e; e = e->next) {
+		if (memcmp(e->key.digest.value, key->digest.value, AS_DIGEST_VALUE_SIZE) == 0 &&
+			strcmp(e->key.ns, key->ns) == 0 && e->policy_src == policy && e->ttl == ttl) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+// Must hold coalescer lock.
+static void
+as_coalesce_detach(as_coalescer* coalescer, as_coalesce_entry* entry)
+{
+	uint32_t b = as_coalesce_bucket(coalescer, entry->key.digest.value);
+	as_coalesce_entry** pp = &coalescer->buckets[b];
+
+	while (*pp != entry) {
+		pp = &(*pp)->next;
+	}
+	*pp = entry->next;
+
+	if (entry->fifo_prev) {
+		entry->fifo_prev->fifo_next = entry->fifo_next;
+	}
+	else {
+		coalescer->head = entry->fifo_next;
+	}
+
+	if (entry->fifo_next) {
+		entry->fifo_next->fifo_prev = entry->fifo_prev;
+	}
+	else {
+		coalescer->tail = entry->fifo_prev;
+	}
+}
+
+static as_coalesce_op*
+as_coalesce_op_reserve(as_coalesce_entry* entry)
+{
+	if (entry->n_ops == entry->ops_capacity) {
+		entry->ops_capacity *= 2;
+		entry->ops = cf_realloc(entry->ops, sizeof(as_coalesce_op) * entry->ops_capacity);
+	}
+	return &entry->ops[entry->n_ops++];
+}
+
+static void
+as_coalesce_merge(as_coalesce_entry* entry, const as_operations* ops)
+{
+	for (uint16_t i = 0; i < ops->binops.size; i++) {
+		as_binop* binop = &ops->binops.entries[i];
+		as_val_t type = as_bin_get_type(&binop->bin);
+
+		if (binop->op == AS_OPERATOR_INCR) {
+			// Increments on the same bin are summed.
+			as_coalesce_op* op = NULL;
+
+			for (uint32_t j = 0; j < entry->n_ops; j++) {
+				if (entry->ops[j].type == type && strcmp(entry->ops[j].name, binop->bin.name) == 0) {
+					op = &entry->ops[j];
+					break;
+				}
+			}
+
+			if (op) {
+				if (type == AS_INTEGER) {
+					op->value.i += as_integer_get((as_integer*)binop->bin.valuep);
+				}
+				else {
+					op->value.d += as_double_get((as_double*)binop->bin.valuep);
+				}
+				continue;
+			}
+
+			op = as_coalesce_op_reserve(entry);
+			strcpy(op->name, binop->bin.name);
+			op->type = type;
+
+			if (type == AS_INTEGER) {
+				op->value.i = as_integer_get((as_integer*)binop->bin.valuep);
+			}
+			else {
+				op->value.d = as_double_get((as_double*)binop->bin.valuep);
+			}
+		}
+		else {
+			// List appends are applied in call order.
+			as_bytes* src = (as_bytes*)binop->bin.valuep;
+			uint8_t* buf = cf_malloc(src->size);
+			memcpy(buf, src->value, src->size);
+
+			as_coalesce_op* op = as_coalesce_op_reserve(entry);
+			strcpy(op->name, binop->bin.name);
+			op->type = AS_BYTES;
+			op->value.bytes = as_bytes_new_wrap(buf, src->size, true);
+		}
+	}
+}
+
+static void
+as_coalesce_add_waiter(as_coalesce_entry* entry, as_async_record_listener listener, void* udata)
+{
+	if (entry->n_waiters == entry->waiters_capacity) {
+		entry->waiters_capacity *= 2;
+		entry->waiters = cf_realloc(entry->waiters,
+			sizeof(as_coalesce_waiter) * entry->waiters_capacity);
+	}
+
+	as_coalesce_waiter* w = &entry->waiters[entry->n_waiters++];
+	w->listener = listener;
+	w->udata = udata;
+}
+
+static void
+as_coalesce_entry_destroy(as_coalesce_entry* entry)
+{
+	cf_free(entry->ops);
+	cf_free(entry->waiters);
+	cf_free(entry);
+}
+
+static void
+as_coalesce_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	as_coalesce_entry* entry = udata;
+
+	for (uint32_t i = 0; i < entry->n_waiters; i++) {
+		as_coalesce_waiter* w = &entry->waiters[i];
+		w->listener(err, rec, w->udata, event_loop);
+	}
+	as_coalesce_entry_destroy(entry);
+}
+
+static void
+as_coalesce_flush(as_coalescer* coalescer, as_coalesce_entry* entry)
+{
+	as_operations ops;
+	as_operations_init(&ops, (uint16_t)entry->n_ops);
+	ops.ttl = entry->ttl;
+
+	for (uint32_t i = 0; i < entry->n_ops; i++) {
+		as_coalesce_op* op = &entry->ops[i];
+
+		switch (op->type) {
+			case AS_INTEGER:
+				as_operations_add_incr(&ops, op->name, op->value.i);
+				break;
+
+			case AS_DOUBLE:
+				as_operations_add_incr_double(&ops, op->name, op->value.d);
+				break;
+
+			default: {
+				// Operations take ownership of the packed append.
+				as_binop* binop = &ops.binops.entries[ops.binops.size++];
+				binop->op = AS_OPERATOR_CDT_MODIFY;
+				as_bin_init(&binop->bin, op->name, (as_bin_value*)op->value.bytes);
+				break;
+			}
+		}
+	}
+
+	as_faa_uint64(&coalescer->merged, entry->n_waiters - 1);
+	as_incr_uint64(&coalescer->flushed);
+
+	as_error err;
+	as_status status = aerospike_key_operate_async(coalescer->as, &err,
+		entry->policy_src ? &entry->policy : NULL, &entry->key, &ops, as_coalesce_listener,
+		entry, entry->event_loop, NULL);
+
+	as_operations_destroy(&ops);
+
+	if (status != AEROSPIKE_OK) {
+		// Callers were told the command was queued, so the error is reported to each listener.
+		as_coalesce_listener(&err, NULL, entry, entry->event_loop);
+	}
+}
+
+static void*
+as_coalesce_run(void* udata)
+{
+	as_coalescer* coalescer = udata;
+
+	pthread_mutex_lock(&coalescer->lock);
+
+	while (coalescer->valid) {
+		as_coalesce_entry* entry = coalescer->head;
+
+		if (! entry) {
+			pthread_cond_wait(&coalescer->cond, &coalescer->lock);
+			continue;
+		}
+
+		uint64_t now = cf_getms();
+
+		if (entry->deadline > now) {
+			struct timespec delta;
+			struct timespec abstime;
+			cf_clock_set_timespec_ms((uint32_t)(entry->deadline - now), &delta);
+			cf_clock_current_add(&delta, &abstime);
+			pthread_cond_timedwait(&coalescer->cond, &coalescer->lock, &abstime);
+			continue;
+		}
+
+		as_coalesce_detach(coalescer, entry);
+		pthread_mutex_unlock(&coalescer->lock);
+		as_coalesce_flush(coalescer, entry);
+		pthread_mutex_lock(&coalescer->lock);
+	}
+	pthread_mutex_unlock(&coalescer->lock);
+	return NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_coalescer*
+as_coalescer_create(aerospike* as, uint32_t window_ms, uint32_t max_waiters)
+{
+	as_coalescer* coalescer = cf_malloc(sizeof(as_coalescer));
+	memset(coalescer, 0, sizeof(as_coalescer));
+	coalescer->as = as;
+	pthread_mutex_init(&coalescer->lock, NULL);
+	pthread_cond_init(&coalescer->cond, NULL);
+	coalescer->n_buckets = AS_COALESCE_BUCKETS;
+	coalescer->buckets = cf_calloc(coalescer->n_buckets, sizeof(as_coalesce_entry*));
+	coalescer->window_ms = window_ms;
+	coalescer->max_waiters = max_waiters;
+	coalescer->valid = true;
+
+	if (pthread_create(&coalescer->thread, NULL, as_coalesce_run, coalescer) != 0) {
+		as_log_error("Failed to create coalescer thread");
+		cf_free(coalescer->buckets);
+		pthread_cond_destroy(&coalescer->cond);
+		pthread_mutex_destroy(&coalescer->lock);
+		cf_free(coalescer);
+		return NULL;
+	}
+	return coalescer;
+}
+
+void
+as_coalescer_destroy(as_coalescer* coalescer)
+{
+	pthread_mutex_lock(&coalescer->lock);
+	coalescer->valid = false;
+	pthread_cond_signal(&coalescer->cond);
+	pthread_mutex_unlock(&coalescer->lock);
+	pthread_join(coalescer->thread, NULL);
+
+	// Send pending commands.
+	as_coalesce_entry* entry = coalescer->head;
+
+	while (entry) {
+		as_coalesce_entry* next = entry->fifo_next;
+		as_coalesce_flush(coalescer, entry);
+		entry = next;
+	}
+	cf_free(coalescer->buckets);
+	pthread_cond_destroy(&coalescer->cond);
+	pthread_mutex_destroy(&coalescer->lock);
+	cf_free(coalescer);
+}
+
+as_status
+as_coalescer_operate(
+	as_coalescer* coalescer, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_operations* ops, as_async_record_listener listener, void* udata,
+	as_event_loop* event_loop
+	)
+{
+	const as_policy_operate* check = policy ?
+		policy : &aerospike_load_config(coalescer->as)->policies.operate;
+
+	if (! as_coalesce_can_merge(check, ops)) {
+		return aerospike_key_operate_async(coalescer->as, err, policy, key, ops, listener, udata,
+			event_loop, NULL);
+	}
+
+	as_error_reset(err);
+
+	as_status status = as_key_set_digest(err, (as_key*)key);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	pthread_mutex_lock(&coalescer->lock);
+
+	if (! coalescer->valid) {
+		pthread_mutex_unlock(&coalescer->lock);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Coalescer is closed");
+	}
+
+	as_coalesce_entry* entry = as_coalesce_find(coalescer, key, policy, ops->ttl);
+
+	if (entry && entry->n_ops + ops->binops.size > UINT16_MAX) {
+		// The merged operations would not fit in one command. Send the pending command and
+		// start a new one.
+		as_coalesce_detach(coalescer, entry);
+		pthread_mutex_unlock(&coalescer->lock);
+		as_coalesce_flush(coalescer, entry);
+		pthread_mutex_lock(&coalescer->lock);
+		entry = as_coalesce_find(coalescer, key, policy, ops->ttl);
+	}
+
+	if (! entry) {
+		entry = cf_malloc(sizeof(as_coalesce_entry));
+		as_key_init_digest(&entry->key, key->ns, key->set, key->digest.value);
+
+		if (policy) {
+			entry->policy = *policy;
+		}
+		entry->policy_src = policy;
+		entry->event_loop = event_loop;
+		entry->ops_capacity = ops->binops.size;
+		entry->ops = cf_malloc(sizeof(as_coalesce_op) * entry->ops_capacity);
+		entry->n_ops = 0;
+		entry->waiters_capacity = 4;
+		entry->waiters = cf_malloc(sizeof(as_coalesce_waiter) * entry->waiters_capacity);
+		entry->n_waiters = 0;
+		entry->deadline = cf_getms() + coalescer->window_ms;
+		entry->ttl = ops->ttl;
+
+		uint32_t b = as_coalesce_bucket(coalescer, key->digest.value);
+		entry->next = coalescer->buckets[b];
+		coalescer->buckets[b] = entry;
+
+		entry->fifo_next = NULL;
+		entry->fifo_prev = coalescer->tail;
+
+		if (coalescer->tail) {
+			coalescer->tail->fifo_next = entry;
+		}
+		else {
+			coalescer->head = entry;
+			pthread_cond_signal(&coalescer->cond);
+		}
+		coalescer->tail = entry;
+	}
+
+	as_coalesce_merge(entry, ops);
+	as_coalesce_add_waiter(entry, listener, udata);
+
+	if (coalescer->max_waiters > 0 && entry->n_waiters >= coalescer->max_waiters) {
+		// Send early instead of waiting for the window to expire.
+		as_coalesce_detach(coalescer, entry);
+		pthread_mutex_unlock(&coalescer->lock);
+		as_coalesce_flush(coalescer, entry);
+		return AEROSPIKE_OK;
+	}
+
+	pthread_mutex_unlock(&coalescer->lock);
+	return AEROSPIKE_OK;
+}
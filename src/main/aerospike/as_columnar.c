@@ -0,0 +1,437 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_columnar.h>
+#include <aerospike/as_bytes.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Initial variable length data capacity per row.
+#define AS_COLUMN_VAR_ROW_SIZE 16
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct as_column_array_s {
+	const void* buffers[3];
+} as_column_array;
+
+typedef struct as_batch_array_s {
+	const void* buffers[1];
+	uint32_t n_columns;
+	struct ArrowArray* children[];
+} as_batch_array;
+
+typedef struct as_batch_schema_s {
+	uint32_t n_columns;
+	struct ArrowSchema* children[];
+} as_batch_schema;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline bool
+as_column_is_var(as_column_type type)
+{
+	return type == AS_COLUMN_STRING || type == AS_COLUMN_BYTES;
+}
+
+static inline uint32_t
+as_column_bitmap_size(uint32_t n)
+{
+	return (n + 7) / 8;
+}
+
+static inline void
+as_column_bit_set(uint8_t* bitmap, uint32_t i)
+{
+	bitmap[i >> 3] |= (uint8_t)(1 << (i & 7));
+}
+
+static inline bool
+as_column_bit_get(const uint8_t* bitmap, uint32_t i)
+{
+	return (bitmap[i >> 3] & (1 << (i & 7))) != 0;
+}
+
+static const char*
+as_column_format(as_column_type type)
+{
+	switch (type) {
+		case AS_COLUMN_INT64:
+			return "l";
+		case AS_COLUMN_DOUBLE:
+			return "g";
+		case AS_COLUMN_BOOL:
+			return "b";
+		case AS_COLUMN_STRING:
+			return "u";
+		default:
+			return "z";
+	}
+}
+
+static void
+as_column_alloc(as_column_builder* col, as_column_type type, uint32_t batch_size)
+{
+	uint32_t bitmap_size = as_column_bitmap_size(batch_size);
+
+	col->validity = cf_malloc(bitmap_size);
+	memset(col->validity, 0, bitmap_size);
+	col->offsets = NULL;
+	col->size = 0;
+	col->null_count = 0;
+
+	switch (type) {
+		case AS_COLUMN_INT64:
+		case AS_COLUMN_DOUBLE:
+			col->capacity = batch_size * 8;
+			col->values = cf_malloc(col->capacity);
+			memset(col->values, 0, col->capacity);
+			break;
+
+		case AS_COLUMN_BOOL:
+			col->capacity = bitmap_size;
+			col->values = cf_malloc(col->capacity);
+			memset(col->values, 0, col->capacity);
+			break;
+
+		default:
+			col->offsets = cf_malloc(sizeof(int32_t) * (batch_size + 1));
+			col->offsets[0] = 0;
+			col->capacity = batch_size * AS_COLUMN_VAR_ROW_SIZE;
+			col->values = cf_malloc(col->capacity);
+			break;
+	}
+}
+
+static void
+as_column_append(as_columnar_builder* cb, as_column_builder* col, const uint8_t* p, uint32_t size)
+{
+	uint32_t need = col->size + size;
+
+	if (need > col->capacity) {
+		uint32_t capacity = col->capacity * 2;
+
+		if (capacity < need) {
+			capacity = need;
+		}
+		col->values = cf_realloc(col->values, capacity);
+		col->capacity = capacity;
+	}
+	memcpy(col->values + col->size, p, size);
+	col->size = need;
+	cb->var_size += size;
+}
+
+static void
+as_column_set(
+	as_columnar_builder* cb, as_column_builder* col, as_column_type type, uint32_t row,
+	uint8_t particle_type, const uint8_t* p, uint32_t size
+	)
+{
+	switch (type) {
+		case AS_COLUMN_INT64:
+			if (particle_type != AS_BYTES_INTEGER || size != 8) {
+				return;
+			}
+			*(int64_t*)(col->values + row * 8) = (int64_t)cf_swap_from_be64(*(uint64_t*)p);
+			break;
+
+		case AS_COLUMN_DOUBLE:
+			if (particle_type != AS_BYTES_DOUBLE || size != 8) {
+				return;
+			}
+			*(double*)(col->values + row * 8) = cf_swap_from_big_float64(*(double*)p);
+			break;
+
+		case AS_COLUMN_BOOL:
+			if (particle_type != AS_BYTES_BOOL || size != 1) {
+				return;
+			}
+			if (*p) {
+				as_column_bit_set(col->values, row);
+			}
+			break;
+
+		case AS_COLUMN_STRING:
+			if (particle_type != AS_BYTES_STRING) {
+				return;
+			}
+			as_column_append(cb, col, p, size);
+			break;
+
+		case AS_COLUMN_BYTES:
+			if (particle_type != AS_BYTES_BLOB) {
+				return;
+			}
+			as_column_append(cb, col, p, size);
+			break;
+	}
+	as_column_bit_set(col->validity, row);
+}
+
+static void
+as_column_array_release(struct ArrowArray* array)
+{
+	as_column_array* ca = array->private_data;
+
+	for (int64_t i = 0; i < array->n_buffers; i++) {
+		cf_free((void*)ca->buffers[i]);
+	}
+	cf_free(ca);
+	array->release = NULL;
+}
+
+static void
+as_column_export(
+	as_column_builder* col, as_column_type type, uint32_t n_rows, struct ArrowArray* out
+	)
+{
+	as_column_array* ca = cf_malloc(sizeof(as_column_array));
+	ca->buffers[0] = col->validity;
+
+	if (as_column_is_var(type)) {
+		ca->buffers[1] = col->offsets;
+		ca->buffers[2] = col->values;
+		out->n_buffers = 3;
+	}
+	else {
+		ca->buffers[1] = col->values;
+		ca->buffers[2] = NULL;
+		out->n_buffers = 2;
+	}
+
+	out->length = n_rows;
+	out->null_count = col->null_count;
+	out->offset = 0;
+	out->n_children = 0;
+	out->buffers = ca->buffers;
+	out->children = NULL;
+	out->dictionary = NULL;
+	out->release = as_column_array_release;
+	out->private_data = ca;
+}
+
+static void
+as_batch_array_release(struct ArrowArray* array)
+{
+	as_batch_array* ba = array->private_data;
+
+	for (uint32_t i = 0; i < ba->n_columns; i++) {
+		struct ArrowArray* child = ba->children[i];
+
+		// Consumers may move children out of the batch, which clears their release.
+		if (child->release) {
+			child->release(child);
+		}
+	}
+	cf_free(ba);
+	array->release = NULL;
+}
+
+static void
+as_batch_schema_release(struct ArrowSchema* schema)
+{
+	as_batch_schema* bs = schema->private_data;
+
+	for (uint32_t i = 0; i < bs->n_columns; i++) {
+		struct ArrowSchema* child = bs->children[i];
+
+		if (child->release) {
+			child->release(child);
+		}
+	}
+	cf_free(bs);
+	schema->release = NULL;
+}
+
+static void
+as_column_schema_release(struct ArrowSchema* schema)
+{
+	cf_free((void*)schema->name);
+	schema->release = NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_columnar_schema_export(const as_columnar_schema* schema, struct ArrowSchema* out)
+{
+	uint32_t n = schema->n_columns;
+
+	// Child pointers are followed by the child schemas in the same allocation.
+	as_batch_schema* bs = cf_malloc(sizeof(as_batch_schema) +
+		(sizeof(struct ArrowSchema*) + sizeof(struct ArrowSchema)) * n);
+	struct ArrowSchema* children = (struct ArrowSchema*)&bs->children[n];
+	bs->n_columns = n;
+
+	for (uint32_t i = 0; i < n; i++) {
+		struct ArrowSchema* child = &children[i];
+		child->format = as_column_format(schema->columns[i].type);
+		child->name = cf_strdup(schema->columns[i].name);
+		child->metadata = NULL;
+		child->flags = ARROW_FLAG_NULLABLE;
+		child->n_children = 0;
+		child->children = NULL;
+		child->dictionary = NULL;
+		child->release = as_column_schema_release;
+		child->private_data = NULL;
+		bs->children[i] = child;
+	}
+
+	out->format = "+s";
+	out->name = "";
+	out->metadata = NULL;
+	out->flags = 0;
+	out->n_children = n;
+	out->children = bs->children;
+	out->dictionary = NULL;
+	out->release = as_batch_schema_release;
+	out->private_data = bs;
+}
+
+void
+as_columnar_builder_init(as_columnar_builder* cb, const as_columnar_schema* schema)
+{
+	cb->schema = schema;
+	cb->columns = cf_malloc(sizeof(as_column_builder) * schema->n_columns);
+	cb->digests = cf_malloc(sizeof(as_digest) * schema->batch_size);
+	cb->n_rows = 0;
+	cb->var_size = 0;
+
+	for (uint32_t i = 0; i < schema->n_columns; i++) {
+		as_column_alloc(&cb->columns[i], schema->columns[i].type, schema->batch_size);
+	}
+}
+
+void
+as_columnar_builder_destroy(as_columnar_builder* cb)
+{
+	for (uint32_t i = 0; i < cb->schema->n_columns; i++) {
+		as_column_builder* col = &cb->columns[i];
+		cf_free(col->validity);
+		cf_free(col->values);
+		cf_free(col->offsets);
+	}
+	cf_free(cb->columns);
+	cf_free(cb->digests);
+}
+
+uint8_t*
+as_columnar_builder_add(as_columnar_builder* cb, uint8_t* p, uint32_t n_ops, const as_digest* digest)
+{
+	const as_columnar_schema* schema = cb->schema;
+	uint32_t row = cb->n_rows;
+	as_bin_name name;
+
+	for (uint32_t i = 0; i < n_ops; i++) {
+		uint32_t op_size = cf_swap_from_be32(*(uint32_t*)p);
+		p += 5;
+		uint8_t type = *p;
+		p += 2;
+
+		uint8_t name_size = *p++;
+		uint8_t name_len = (name_size <= AS_BIN_NAME_MAX_LEN)? name_size : AS_BIN_NAME_MAX_LEN;
+		memcpy(name, p, name_len);
+		name[name_len] = 0;
+		p += name_size;
+
+		uint32_t value_size = (op_size - (name_size + 4));
+
+		for (uint32_t j = 0; j < schema->n_columns; j++) {
+			if (strcmp(schema->columns[j].name, name) == 0) {
+				as_column_set(cb, &cb->columns[j], schema->columns[j].type, row, type, p,
+					value_size);
+				break;
+			}
+		}
+		p += value_size;
+	}
+
+	// Finish row for every column. Missing and mismatched bins are null.
+	for (uint32_t j = 0; j < schema->n_columns; j++) {
+		as_column_builder* col = &cb->columns[j];
+
+		if (! as_column_bit_get(col->validity, row)) {
+			col->null_count++;
+		}
+
+		if (col->offsets) {
+			col->offsets[row + 1] = (int32_t)col->size;
+		}
+	}
+
+	cb->digests[row] = *digest;
+	cb->n_rows++;
+	return p;
+}
+
+uint8_t*
+as_columnar_skip_bins(uint8_t* p, uint32_t n_ops)
+{
+	for (uint32_t i = 0; i < n_ops; i++) {
+		uint32_t op_size = cf_swap_from_be32(*(uint32_t*)p);
+		p += 4 + op_size;
+	}
+	return p;
+}
+
+void
+as_columnar_builder_export(as_columnar_builder* cb, struct ArrowArray* out)
+{
+	const as_columnar_schema* schema = cb->schema;
+	uint32_t n = schema->n_columns;
+
+	// Child pointers are followed by the child arrays in the same allocation.
+	as_batch_array* ba = cf_malloc(sizeof(as_batch_array) +
+		(sizeof(struct ArrowArray*) + sizeof(struct ArrowArray)) * n);
+	struct ArrowArray* children = (struct ArrowArray*)&ba->children[n];
+	ba->buffers[0] = NULL;
+	ba->n_columns = n;
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_column_type type = schema->columns[i].type;
+		as_column_export(&cb->columns[i], type, cb->n_rows, &children[i]);
+		ba->children[i] = &children[i];
+
+		// Buffers now belong to the exported array.
+		as_column_alloc(&cb->columns[i], type, schema->batch_size);
+	}
+
+	out->length = cb->n_rows;
+	out->null_count = 0;
+	out->offset = 0;
+	out->n_buffers = 1;
+	out->n_children = n;
+	out->buffers = ba->buffers;
+	out->children = ba->children;
+	out->dictionary = NULL;
+	out->release = as_batch_array_release;
+	out->private_data = ba;
+
+	cb->n_rows = 0;
+	cb->var_size = 0;
+}
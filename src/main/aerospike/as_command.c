@@ -16,22 +16,53 @@
  */
 #include <aerospike/as_command.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_compress.h>
+#include <aerospike/as_epoch.h>
 #include <aerospike/as_event.h>
+#include <aerospike/as_hot_keys.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_mem_budget.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_msgpack.h>
+#include <aerospike/as_partition_heat.h>
 #include <aerospike/as_partition_tracker.h>
+#include <aerospike/as_poll.h>
+#include <aerospike/as_policy.h>
 #include <aerospike/as_record.h>
 #include <aerospike/as_serializer.h>
 #include <aerospike/as_sleep.h>
+#include <aerospike/as_slow_log.h>
 #include <aerospike/as_socket.h>
+#include <aerospike/as_sync_pipe.h>
+#include <aerospike/as_trace.h>
 #include <aerospike/as_txn.h>
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_clock.h>
 #include <citrusleaf/cf_digest.h>
 #include <stdlib.h>
 #include <string.h>
-#include <zlib.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Thread buffer cache size classes: 32KB, 64KB, ... 16MB.
+#define AS_BUF_CLASS_MIN_SHIFT 15
+#define AS_BUF_CLASS_MAX 10
+
+// Heap command buffers are preceded by a header that holds the buffer capacity, so
+// as_command_buffer_put() knows if the buffer was allocated at full class size.
+#define AS_BUF_HEADER_SIZE 16
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	uint8_t* bufs[AS_BUF_CLASS_MAX];
+	size_t size;
+} as_buffer_cache;
 
 //---------------------------------
 // Static Variables
@@ -40,6 +71,170 @@
 // These values must line up with as_operator enum.
 static uint8_t as_protocol_types[] = {1, 2, 3, 4, 3, 4, 5, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
 
+static pthread_once_t as_buffer_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t as_buffer_cache_key;
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+size_t as_command_buffer_cache_max = 0;
+
+//---------------------------------
+// Buffer Cache
+//---------------------------------
+
+static void
+as_buffer_cache_destroy(void* data)
+{
+	as_buffer_cache* cache = data;
+
+	for (uint32_t i = 0; i < AS_BUF_CLASS_MAX; i++) {
+		if (cache->bufs[i]) {
+			cf_free(cache->bufs[i] - AS_BUF_HEADER_SIZE);
+			as_mem_stats_free(AS_MEM_TAG_COMMAND, (size_t)1 << (i + AS_BUF_CLASS_MIN_SHIFT));
+		}
+	}
+	cf_free(cache);
+}
+
+static void
+as_buffer_cache_init_key(void)
+{
+	pthread_key_create(&as_buffer_cache_key, as_buffer_cache_destroy);
+}
+
+static inline int
+as_buffer_class(size_t size)
+{
+	// Return smallest class that can hold size or -1 if size exceeds largest class.
+	size_t cap = (size_t)1 << AS_BUF_CLASS_MIN_SHIFT;
+
+	for (int i = 0; i < AS_BUF_CLASS_MAX; i++) {
+		if (size <= cap) {
+			return i;
+		}
+		cap <<= 1;
+	}
+	return -1;
+}
+
+static inline as_buffer_cache*
+as_buffer_cache_get(bool create)
+{
+	pthread_once(&as_buffer_cache_once, as_buffer_cache_init_key);
+
+	as_buffer_cache* cache = pthread_getspecific(as_buffer_cache_key);
+
+	if (!cache && create) {
+		cache = cf_calloc(1, sizeof(as_buffer_cache));
+		pthread_setspecific(as_buffer_cache_key, cache);
+	}
+	return cache;
+}
+
+static inline uint8_t*
+as_buffer_alloc(size_t cap)
+{
+	uint8_t* p = local_malloc(AS_BUF_HEADER_SIZE + cap);
+	*(size_t*)p = cap;
+	as_mem_stats_alloc(AS_MEM_TAG_COMMAND, cap);
+	return p + AS_BUF_HEADER_SIZE;
+}
+
+static inline void
+as_buffer_free(uint8_t* buf, size_t cap)
+{
+	local_free(buf - AS_BUF_HEADER_SIZE);
+	as_mem_stats_free(AS_MEM_TAG_COMMAND, cap);
+}
+
+uint8_t*
+as_command_buffer_get(size_t size)
+{
+	int index = as_buffer_class(size);
+
+	if (index < 0 || as_command_buffer_cache_max == 0) {
+		// Buffer will not be cached, so allocate exact size.
+		return as_buffer_alloc(size);
+	}
+
+	as_buffer_cache* cache = as_buffer_cache_get(false);
+
+	if (cache) {
+		uint8_t* buf = cache->bufs[index];
+
+		if (buf) {
+			cache->bufs[index] = NULL;
+			cache->size -= (size_t)1 << (index + AS_BUF_CLASS_MIN_SHIFT);
+			return buf;
+		}
+	}
+
+	// Allocate full class size, so the buffer can be cached on return.
+	return as_buffer_alloc((size_t)1 << (index + AS_BUF_CLASS_MIN_SHIFT));
+}
+
+void
+as_command_buffer_put(uint8_t* buf, size_t size)
+{
+	(void)size;
+
+	size_t cap = *(size_t*)(buf - AS_BUF_HEADER_SIZE);
+	int index = as_buffer_class(cap);
+
+	if (index < 0 || cap != (size_t)1 << (index + AS_BUF_CLASS_MIN_SHIFT) ||
+		as_command_buffer_cache_max == 0) {
+		// Exact size buffers are not cached.
+		as_buffer_free(buf, cap);
+		return;
+	}
+
+	as_buffer_cache* cache = as_buffer_cache_get(true);
+
+	if (cache->bufs[index] || cache->size + cap > as_command_buffer_cache_max) {
+		as_buffer_free(buf, cap);
+		return;
+	}
+
+	cache->bufs[index] = buf;
+	cache->size += cap;
+}
+
+uint8_t*
+as_command_buffer_get_alloc(const as_allocator* allocator, size_t size)
+{
+	if (as_allocator_is_default(allocator)) {
+		return as_command_buffer_get(size);
+	}
+
+	as_mem_stats_alloc(AS_MEM_TAG_COMMAND, size);
+	return as_allocator_malloc(allocator, size);
+}
+
+void
+as_command_buffer_put_alloc(const as_allocator* allocator, uint8_t* buf, size_t size)
+{
+	if (as_allocator_is_default(allocator)) {
+		as_command_buffer_put(buf, size);
+		return;
+	}
+
+	as_allocator_free(allocator, buf);
+	as_mem_stats_free(AS_MEM_TAG_COMMAND, size);
+}
+
+void
+as_command_buffer_release_thread(void)
+{
+	as_buffer_cache* cache = as_buffer_cache_get(false);
+
+	if (cache) {
+		pthread_setspecific(as_buffer_cache_key, NULL);
+		as_buffer_cache_destroy(cache);
+	}
+}
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -74,14 +269,86 @@ as_replica_index_init_write(as_cluster* cluster, as_policy_replica replica)
 }
 
 static as_status
-as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_node* node, uint64_t* bytes_in);
+as_command_read_messages(
+	as_error* err, as_command* cmd, as_socket* sock, as_node* node, bool read_ahead,
+	uint64_t* bytes_in
+	);
 
 static as_status
-as_command_read_message(as_error* err, as_command* cmd, as_socket* sock, as_node* node, uint64_t* bytes_in);
+as_command_read_message(
+	as_error* err, as_command* cmd, as_socket* sock, as_node* node, bool read_ahead,
+	uint64_t* bytes_in
+	);
 
 as_status
 as_batch_retry(as_command* cmd, as_error* err);
 
+as_command**
+as_batch_hedge_create(as_command* parent, uint32_t* n_hedges);
+
+void
+as_batch_hedge_destroy(as_command** hedges, uint32_t n_hedges);
+
+static inline void
+as_command_trace(as_command* cmd, as_trace_point point, as_node* node, as_status status)
+{
+	if (cmd->trace_id) {
+		uint32_t partition_id = cmd->node ? AS_TRACE_NO_PARTITION : cmd->partition_id;
+		as_trace_emit(cmd->cluster, cmd->trace_id, point, node, cmd->ns, partition_id,
+			cmd->iteration, status, false);
+	}
+}
+
+static inline void
+as_command_slow_conn(as_command* cmd, as_node* node, uint64_t begin)
+{
+	if (cmd->slow) {
+		cmd->slow->conn_wait_us += (cf_getns() - begin) / 1000;
+		memcpy(cmd->slow->node, node->name, AS_NODE_NAME_SIZE);
+	}
+}
+
+static void
+as_command_slow_log(as_command* cmd, as_slow_command* slow, uint64_t begin, as_status status)
+{
+	uint64_t elapsed = cf_getns() - begin;
+	as_slow_log* log = cmd->cluster->slow_log;
+
+	if (! as_slow_log_check(log, elapsed)) {
+		return;
+	}
+
+	slow->time_ms = cf_clock_getabsolute();
+	slow->elapsed_us = elapsed / 1000;
+	slow->retries = cmd->iteration;
+	slow->status = status;
+	slow->latency_type = cmd->latency_type;
+	slow->async = false;
+
+	const as_key* key = cmd->key;
+
+	if (key) {
+		as_strncpy(slow->ns, key->ns, sizeof(slow->ns));
+		as_strncpy(slow->set, key->set, sizeof(slow->set));
+	}
+	else {
+		as_strncpy(slow->ns, cmd->ns ? cmd->ns : "", sizeof(slow->ns));
+		slow->set[0] = 0;
+	}
+
+	if (key && key->digest.init) {
+		memcpy(slow->digest, key->digest.value, AS_DIGEST_VALUE_SIZE);
+		slow->partition_id = cmd->partition_id;
+		slow->has_digest = true;
+	}
+	else {
+		memset(slow->digest, 0, AS_DIGEST_VALUE_SIZE);
+		slow->partition_id = 0;
+		slow->has_digest = false;
+	}
+	as_slow_log_add(log, slow);
+}
+
 size_t
 as_command_user_key_size(const as_key* key)
 {
@@ -207,16 +474,19 @@ as_command_bin_size(const as_bin* bin, as_queue* buffers, size_t* sizep, as_erro
 		}
 		case AS_LIST:
 		case AS_MAP: {
-			as_buffer buffer;
-			as_serializer ser;
-			as_msgpack_init(&ser);
-			int rv = as_serializer_serialize(&ser, val, &buffer);
-			as_serializer_destroy(&ser);
+			// Compute exact packed size only. The value is packed directly into the
+			// command buffer by as_command_write_bin().
+			as_packer pk = {.buffer = NULL, .capacity = UINT32_MAX};
+			int rv = as_pack_val(&pk, val);
 
 			if (rv != 0) {
 				return as_error_update(err, AEROSPIKE_ERR_CLIENT,
 					"map/list serialization failed: %d", rv);
 			}
+
+			as_buffer buffer;
+			buffer.data = NULL;
+			buffer.size = pk.offset;
 			as_queue_push(buffers, &buffer);
 			size += buffer.size;
 			break;
@@ -229,6 +499,95 @@ as_command_bin_size(const as_bin* bin, as_queue* buffers, size_t* sizep, as_erro
 	return AEROSPIKE_OK;
 }
 
+static uint32_t
+as_bin_compress_checksum(const uint8_t* header, const uint8_t* data, size_t size)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+
+	for (uint32_t i = 0; i < AS_BIN_COMPRESS_CHECKSUM_OFFSET; i++) {
+		hash ^= header[i];
+		hash *= 16777619u;
+	}
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+as_status
+as_command_bin_size_compress(
+	const as_bin* bin, as_compress_codec codec, uint32_t threshold, as_queue* buffers,
+	size_t* sizep, as_error* err
+	)
+{
+	if (! as_command_bin_compressible(bin, threshold)) {
+		return as_command_bin_size(bin, buffers, sizep, err);
+	}
+
+	as_val* val = (as_val*)bin->valuep;
+	const uint8_t* src;
+	size_t src_size;
+	uint8_t type;
+
+	if (val->type == AS_STRING) {
+		as_string* v = as_string_fromval(val);
+		src = (const uint8_t*)v->value;
+		src_size = v->len;
+		type = AS_BYTES_STRING;
+	}
+	else {
+		as_bytes* v = as_bytes_fromval(val);
+		src = v->value;
+		src_size = v->size;
+		type = AS_BYTES_BLOB;
+	}
+
+	if (src_size > AS_BIN_COMPRESS_MAX_SIZE) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Bin %s value too large to compress: %zu", bin->name, src_size);
+	}
+
+	size_t capacity = AS_BIN_COMPRESS_HEADER_SIZE + as_compress_bound(src_size);
+	uint8_t* buf = cf_malloc(capacity);
+	size_t comp_size = capacity - AS_BIN_COMPRESS_HEADER_SIZE;
+
+	as_status status = as_compress_data(err, codec, src, src_size,
+		buf + AS_BIN_COMPRESS_HEADER_SIZE, &comp_size);
+
+	if (status != AEROSPIKE_OK) {
+		cf_free(buf);
+		return status;
+	}
+
+	as_buffer buffer;
+
+	if (AS_BIN_COMPRESS_HEADER_SIZE + comp_size < src_size) {
+		*(uint32_t*)buf = cf_swap_to_be32(AS_BIN_COMPRESS_MAGIC);
+		buf[4] = (uint8_t)codec;
+		buf[5] = type;
+		*(uint32_t*)(buf + 6) = cf_swap_to_be32((uint32_t)src_size);
+		*(uint32_t*)(buf + 10) = cf_swap_to_be32((uint32_t)comp_size);
+
+		uint32_t checksum = as_bin_compress_checksum(buf, buf + AS_BIN_COMPRESS_HEADER_SIZE,
+			comp_size);
+		*(uint32_t*)(buf + AS_BIN_COMPRESS_CHECKSUM_OFFSET) = cf_swap_to_be32(checksum);
+		buffer.data = buf;
+		buffer.size = (uint32_t)(AS_BIN_COMPRESS_HEADER_SIZE + comp_size);
+	}
+	else {
+		// Value did not shrink. Send it as is.
+		cf_free(buf);
+		buffer.data = NULL;
+		buffer.size = (uint32_t)src_size;
+	}
+	as_queue_push(buffers, &buffer);
+	*sizep += strlen(bin->name) + 8 + buffer.size;
+	return AEROSPIKE_OK;
+}
+
 uint8_t*
 as_command_write_header_write(
 	uint8_t* cmd, const as_policy_base* policy, as_policy_commit_level commit_level,
@@ -557,24 +916,17 @@ as_command_write_bin(uint8_t* begin, as_operator op_type, const as_bin* bin, as_
 			val_type = v->type;
 			break;
 		}
-		case AS_LIST: {
-			as_buffer buffer;
-			as_queue_pop(buffers, &buffer);
-			memcpy(p, buffer.data, buffer.size);
-			p += buffer.size;
-			val_len = buffer.size;
-			val_type = AS_BYTES_LIST;
-			cf_free(buffer.data);
-			break;
-		}
+		case AS_LIST:
 		case AS_MAP: {
+			// Buffer holds packed size computed by as_command_bin_size().
 			as_buffer buffer;
 			as_queue_pop(buffers, &buffer);
-			memcpy(p, buffer.data, buffer.size);
+
+			as_packer pk = {.buffer = p, .capacity = buffer.size};
+			as_pack_val(&pk, val);
 			p += buffer.size;
 			val_len = buffer.size;
-			val_type = AS_BYTES_MAP;
-			cf_free(buffer.data);
+			val_type = (val->type == AS_LIST)? AS_BYTES_LIST : AS_BYTES_MAP;
 			break;
 		}
 	}
@@ -589,29 +941,144 @@ WriteFieldHeader:
 	return p;
 }
 
+uint8_t*
+as_command_write_bin_compress(
+	uint8_t* begin, as_operator op_type, const as_bin* bin, uint32_t threshold,
+	as_queue* buffers
+	)
+{
+	if (! as_command_bin_compressible(bin, threshold)) {
+		return as_command_write_bin(begin, op_type, bin, buffers);
+	}
+
+	// Buffer holds compressed value created by as_command_bin_size_compress().
+	as_buffer buffer;
+	as_queue_pop(buffers, &buffer);
+
+	if (! buffer.data) {
+		return as_command_write_bin(begin, op_type, bin, buffers);
+	}
+
+	uint8_t* p = begin + AS_OPERATION_HEADER_SIZE;
+	const char* name = bin->name;
+
+	while (*name) {
+		*p++ = *name++;
+	}
+	uint8_t name_len = (uint8_t)(p - begin - AS_OPERATION_HEADER_SIZE);
+
+	memcpy(p, buffer.data, buffer.size);
+	p += buffer.size;
+	cf_free(buffer.data);
+
+	*(uint32_t*)begin = cf_swap_to_be32(name_len + buffer.size + 4);
+	begin += 4;
+	*begin++ = as_protocol_types[op_type];
+	*begin++ = AS_BYTES_BLOB;
+	*begin++ = 0;
+	*begin++ = name_len;
+	return p;
+}
+
+size_t
+as_command_bin_ref_size(const as_bin* bin)
+{
+	as_val* val = (as_val*)bin->valuep;
+
+	if (!val) {
+		return 0;
+	}
+
+	size_t size;
+
+	switch (val->type) {
+		case AS_STRING:
+			// v->len has already been set by as_command_bin_size().
+			size = as_string_fromval(val)->len;
+			break;
+
+		case AS_BYTES:
+			size = as_bytes_fromval(val)->size;
+			break;
+
+		default:
+			return 0;
+	}
+	return (size >= AS_COMMAND_REF_MIN_SIZE)? size : 0;
+}
+
+uint8_t*
+as_command_write_bin_ref(
+	uint8_t* begin, as_operator op_type, const as_bin* bin, as_socket_iov* value
+	)
+{
+	uint8_t* p = begin + AS_OPERATION_HEADER_SIZE;
+	const char* name = bin->name;
+
+	// Copy string, but do not transfer null byte.
+	while (*name) {
+		*p++ = *name++;
+	}
+	uint8_t name_len = (uint8_t)(p - begin - AS_OPERATION_HEADER_SIZE);
+	as_val* val = (as_val*)bin->valuep;
+	uint8_t val_type;
+
+	if (val->type == AS_STRING) {
+		as_string* v = as_string_fromval(val);
+		value->data = (uint8_t*)v->value;
+		value->size = v->len;
+		val_type = AS_BYTES_STRING;
+	}
+	else {
+		as_bytes* v = as_bytes_fromval(val);
+		value->data = v->value;
+		value->size = v->size;
+		val_type = v->type;
+	}
+
+	*(uint32_t*)begin = cf_swap_to_be32(name_len + (uint32_t)value->size + 4);
+	begin += 4;
+	*begin++ = as_protocol_types[op_type];
+	*begin++ = val_type;
+	*begin++ = 0;
+	*begin++ = name_len;
+	return p;
+}
+
 size_t
 as_command_compress_max_size(size_t cmd_sz)
 {
-	return compressBound((uLong)cmd_sz) + sizeof(as_compressed_proto);
+	return as_compress_bound(cmd_sz) + sizeof(as_compressed_proto);
 }
 
 as_status
-as_command_compress(as_error* err, uint8_t* cmd, size_t cmd_sz, uint8_t* compressed_cmd, size_t* compressed_size)
+as_command_compress(
+	as_error* err, as_cluster* cluster, uint8_t* cmd, size_t cmd_sz, uint8_t* compressed_cmd,
+	size_t* compressed_size
+	)
 {
+	// Codec is set by the tend thread to the configured codec when all nodes support it.
+	as_compress_codec codec = cluster->compress_codec_current;
+
 	*compressed_size -= sizeof(as_compressed_proto);
-	int ret_val = compress2(compressed_cmd + sizeof(as_compressed_proto), (uLongf*)compressed_size,
-							cmd, (uLong)cmd_sz, Z_BEST_SPEED);
-	
-	if (ret_val) {
-		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Compress failed: %d", ret_val);
+
+	uint64_t begin = cf_getns();
+	as_status status = as_compress_data(err, codec, cmd, cmd_sz,
+		compressed_cmd + sizeof(as_compressed_proto), compressed_size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
 	}
-	
-	// compressed_size will now have to actual compressed size from compress2()
+
+	// compressed_size will now have to actual compressed size.
 	as_command_compress_write_end(compressed_cmd, compressed_cmd + sizeof(as_compressed_proto) +
-								  *compressed_size, cmd_sz);
+								  *compressed_size, cmd_sz, as_proto_compressed_type(codec));
 	
 	// Adjust the compressed size to include the header size
 	*compressed_size += sizeof(as_compressed_proto);
+
+	as_compress_stats_add_compress(&cluster->compress_stats[codec], cmd_sz, *compressed_size,
+		cf_getns() - begin);
 	return AEROSPIKE_OK;
 }
 
@@ -621,19 +1088,20 @@ as_command_send(
 	)
 {
 	size_t capacity = cmd->buf_size;
-	cmd->buf = as_command_buffer_init(capacity);
+	cmd->buf = as_command_buffer_init_alloc(&cmd->cluster->allocator, capacity);
 	cmd->buf_size = write_fn(udata, cmd->buf);
 
 	if (comp_threshold > 0 && cmd->buf_size > comp_threshold) {
 		// Compress command.
 		size_t comp_capacity = as_command_compress_max_size(cmd->buf_size);
 		size_t comp_size = comp_capacity;
-		uint8_t* comp_buf = as_command_buffer_init(comp_capacity);
-		as_status status = as_command_compress(err, cmd->buf, cmd->buf_size, comp_buf, &comp_size);
-		as_command_buffer_free(cmd->buf, capacity);
+		uint8_t* comp_buf = as_command_buffer_init_alloc(&cmd->cluster->allocator, comp_capacity);
+		as_status status = as_command_compress(err, cmd->cluster, cmd->buf, cmd->buf_size, comp_buf,
+			&comp_size);
+		as_command_buffer_free_alloc(&cmd->cluster->allocator, cmd->buf, capacity);
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(comp_buf, comp_capacity);
+			as_command_buffer_free_alloc(&cmd->cluster->allocator, comp_buf, comp_capacity);
 			return status;
 		}
 		capacity = comp_capacity;
@@ -644,7 +1112,7 @@ as_command_send(
 	as_command_start_timer(cmd);
 
 	as_status status = as_command_execute(cmd, err);
-	as_command_buffer_free(cmd->buf, capacity);
+	as_command_buffer_free_alloc(&cmd->cluster->allocator, cmd->buf, capacity);
 	return status;
 }
 
@@ -668,35 +1136,371 @@ as_command_prepare_error(as_command* cmd, as_error* err)
 	}
 }
 
-as_status
-as_command_execute(as_command* cmd, as_error* err)
+static inline void
+as_command_add_compressed_out(as_command* cmd, as_ns_metrics* metrics, size_t size)
 {
-	as_node* node = NULL;
-	as_status status;
-	bool release_node;
+	if (cmd->iov || size < sizeof(as_compressed_proto) || ! as_proto_is_compressed(cmd->buf[1])) {
+		return;
+	}
 
-	// Execute command until successful, timed out or maximum iterations have been reached.
-	while (true) {
-		if (cmd->node) {
-			node = cmd->node;
-			release_node = false;
+	uint64_t uncomp_size = cf_swap_from_be64(((as_compressed_proto*)cmd->buf)->uncompressed_sz);
+	as_node_add_compressed_out(metrics, size, uncomp_size);
+}
+
+static inline void
+as_command_add_compressed_in(as_command* cmd, as_node* node, size_t size, size_t uncomp_size)
+{
+	if (node->cluster->metrics_enabled) {
+		as_ns_metrics* metrics = as_node_prepare_metrics(node, cmd->ns);
+
+		if (metrics) {
+			as_node_add_compressed_in(metrics, size, uncomp_size);
+		}
+	}
+}
+
+static inline int
+as_command_wait_read(as_socket_fd fd1, as_socket_fd fd2, uint32_t timeout)
+{
+	as_poll poll;
+	as_poll_init(&poll, (fd1 > fd2)? fd1 : fd2);
+	int rv = as_poll_sockets_read(&poll, fd1, fd2, timeout);
+	as_poll_destroy(&poll);
+	return rv;
+}
+
+// Return time to wait for the first response of a hedged command.
+static inline uint32_t
+as_command_hedge_timeout(as_command* cmd)
+{
+	uint32_t timeout = cmd->socket_timeout;
+
+	if (cmd->deadline_ms > 0) {
+		uint64_t now = as_clock_getms();
+		uint32_t remaining = (cmd->deadline_ms > now)? (uint32_t)(cmd->deadline_ms - now) : 1;
+
+		if (timeout == 0 || remaining < timeout) {
+			timeout = remaining;
+		}
+	}
+	return timeout;
+}
+
+// Send a duplicate read to the next replica if the current replica has not responded within
+// the hedge delay. Return true if the hedged request responded first. In that case, the
+// original connection is closed and node, socket and metrics are replaced with the hedge
+// node's values.
+static bool
+as_command_hedge(
+	as_command* cmd, as_node** node_out, as_socket* sock, as_ns_metrics** metrics_out,
+	bool reserve
+	)
+{
+	// Hedge delay is only set for commands with an as_policy_read.
+	uint32_t delay = ((const as_policy_read*)cmd->policy)->hedge_delay;
+
+	if (cmd->deadline_ms > 0 && cmd->deadline_ms <= as_clock_getms() + delay) {
+		// Not enough time remaining for a hedged request.
+		return false;
+	}
+
+	// Wait for response from current replica within hedge delay.
+	if (as_command_wait_read(sock->fd, sock->fd, delay) != 0) {
+		// Response (or socket error) arrived in time.
+		return false;
+	}
+
+	as_node* node = *node_out;
+	uint8_t replica_index = cmd->replica_index + 1;
+	as_node* hnode = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition, node, cmd->replica,
+										   cmd->replica_size, &replica_index);
+
+	if (! hnode || hnode == node) {
+		return false;
+	}
+
+	// Nodes are protected by the caller's epoch critical section when reserve is false.
+	if (reserve) {
+		as_node_reserve(hnode);
+	}
+
+	// Hedge errors are ignored. The current replica's response is used instead.
+	as_error err;
+	as_socket hsock;
+	as_status status = as_node_get_connection(&err, hnode, cmd->ns, cmd->socket_timeout,
+											  cmd->deadline_ms, &hsock);
+
+	if (status != AEROSPIKE_OK) {
+		if (reserve) {
+			as_node_release(hnode);
+		}
+		return false;
+	}
+
+	status = as_socket_write_deadline(&err, &hsock, hnode, cmd->buf, cmd->buf_size,
+									  cmd->socket_timeout, cmd->deadline_ms);
+
+	if (status != AEROSPIKE_OK) {
+		as_node_close_conn_error(hnode, &hsock, hsock.pool);
+		if (reserve) {
+			as_node_release(hnode);
+		}
+		return false;
+	}
+
+	as_cluster_add_hedge(cmd->cluster);
+
+	as_ns_metrics* hmetrics = NULL;
+
+	if (*metrics_out) {
+		hmetrics = as_node_prepare_metrics(hnode, cmd->ns);
+		as_node_add_bytes_out(hmetrics, cmd->buf_size);
+		as_command_add_compressed_out(cmd, hmetrics, cmd->buf_size);
+	}
+
+	// Wait for first response from either replica.
+	int rv = as_command_wait_read(sock->fd, hsock.fd, as_command_hedge_timeout(cmd));
+
+	if (rv == 2) {
+		// Hedged request won. Cancel the original request by closing its connection.
+		as_node_close_connection(node, sock, sock->pool);
+
+		if (reserve) {
+			as_node_release(node);
+		}
+
+		*node_out = hnode;
+		*sock = hsock;
+		*metrics_out = hmetrics;
+		cmd->replica_index = replica_index;
+		as_cluster_add_hedge_win(cmd->cluster);
+		return true;
+	}
+
+	// Original request responded first or neither responded in time. Cancel hedged request.
+	as_node_close_connection(hnode, &hsock, hsock.pool);
+
+	if (reserve) {
+		as_node_release(hnode);
+	}
+	return false;
+}
+
+// Send the keys of a batch node command to their next replicas if the node has not responded
+// within the hedge delay. The first node command to respond wins. Return 0 if the original
+// node command should be read. Return 1 if the hedge commands won and all of them were read.
+// Return -1 if the hedge commands won, but at least one of them failed. The original
+// connection has been closed in both of these cases, and keys that still have no response
+// are retried by the caller.
+static int
+as_command_hedge_batch(as_command* cmd, as_error* err, as_node* node, as_socket* sock)
+{
+	uint32_t delay = ((const as_policy_batch*)cmd->policy)->hedge_delay;
+
+	if (cmd->deadline_ms > 0 && cmd->deadline_ms <= as_clock_getms() + delay) {
+		// Not enough time remaining for hedged commands.
+		return 0;
+	}
+
+	// Wait for response from the node within hedge delay.
+	if (as_command_wait_read(sock->fd, sock->fd, delay) != 0) {
+		return 0;
+	}
+
+	uint32_t n_hedges;
+	as_command** hedges = as_batch_hedge_create(cmd, &n_hedges);
+
+	if (! hedges) {
+		return 0;
+	}
+
+	as_socket* hsocks = cf_malloc(sizeof(as_socket) * n_hedges);
+	as_socket_fd* fds = cf_malloc(sizeof(as_socket_fd) * (n_hedges + 1));
+	as_socket_fd max_fd = sock->fd;
+	uint32_t n_sent = 0;
+
+	fds[0] = sock->fd;
+
+	// Hedge errors before the race are ignored. The node's response is used instead.
+	for (; n_sent < n_hedges; n_sent++) {
+		as_command* h = hedges[n_sent];
+		as_socket* hsock = &hsocks[n_sent];
+		as_error herr;
+
+		if (as_node_get_connection(&herr, h->node, h->ns, h->socket_timeout, h->deadline_ms,
+			hsock) != AEROSPIKE_OK) {
+			break;
+		}
+
+		if (as_socket_write_deadline(&herr, hsock, h->node, h->buf, h->buf_size,
+			h->socket_timeout, h->deadline_ms) != AEROSPIKE_OK) {
+			as_node_close_conn_error(h->node, hsock, hsock->pool);
+			break;
+		}
+
+		fds[n_sent + 1] = hsock->fd;
+
+		if (hsock->fd > max_fd) {
+			max_fd = hsock->fd;
+		}
+	}
+
+	int rv = 0;
+
+	if (n_sent == n_hedges) {
+		as_cluster_add_hedge(cmd->cluster);
+
+		// Wait for first response from any node.
+		as_poll poll;
+		as_poll_init(&poll, max_fd);
+		int index = as_poll_sockets_read_any(&poll, fds, n_hedges + 1,
+			as_command_hedge_timeout(cmd));
+		as_poll_destroy(&poll);
+
+		if (index > 0) {
+			rv = 1;
+		}
+	}
+
+	if (rv == 0) {
+		// Original node command responded first, neither responded in time or not all hedge
+		// commands were sent. Cancel hedge commands.
+		for (uint32_t i = 0; i < n_sent; i++) {
+			as_node_close_connection(hedges[i]->node, &hsocks[i], hsocks[i].pool);
+		}
+	}
+	else {
+		// Hedge commands won. Cancel the original node command by closing its connection.
+		as_node_close_connection(node, sock, sock->pool);
+		as_cluster_add_hedge_win(cmd->cluster);
+
+		for (uint32_t i = 0; i < n_hedges; i++) {
+			as_command* h = hedges[i];
+			as_ns_metrics* metrics = NULL;
+			uint64_t bytes_in = 0;
+			as_error herr;
+
+			if (cmd->cluster->metrics_enabled) {
+				metrics = as_node_prepare_metrics(h->node, h->ns);
+
+				if (metrics) {
+					as_node_add_bytes_out(metrics, h->buf_size);
+				}
+			}
+
+			as_status status = as_command_read_messages(&herr, h, &hsocks[i], h->node, true,
+				&bytes_in);
+
+			if (metrics) {
+				as_node_add_bytes_in(metrics, bytes_in);
+			}
+
+			if (status == AEROSPIKE_OK) {
+				as_node_put_connection(h->node, &hsocks[i]);
+			}
+			else {
+				as_node_close_conn_error(h->node, &hsocks[i], hsocks[i].pool);
+
+				if (rv == 1) {
+					// Keep first error.
+					as_error_copy(err, &herr);
+					err->code = status;
+					rv = -1;
+				}
+			}
+		}
+	}
+
+	cf_free(fds);
+	cf_free(hsocks);
+	as_batch_hedge_destroy(hedges, n_hedges);
+	return rv;
+}
+
+static inline as_sync_pipe*
+as_command_get_pipe(as_command* cmd, as_node* node)
+{
+	// Multi-record and hedged commands require a dedicated connection.
+	if (! node->sync_pipes || cmd->node || (cmd->flags & AS_COMMAND_FLAGS_HEDGE)) {
+		return NULL;
+	}
+
+	uint32_t index = node->sync_pipe_iter++ % cmd->cluster->sync_pipes_per_node;
+	return &node->sync_pipes[index];
+}
+
+static inline void
+as_command_put_conn(
+	as_node* node, as_socket* sock, as_sync_pipe* pipe, as_sync_pipe_ticket* ticket, bool error
+	)
+{
+	if (pipe) {
+		as_sync_pipe_done(pipe, node, ticket, true);
+	}
+	else if (error) {
+		as_node_put_conn_error(node, sock);
+	}
+	else {
+		as_node_put_connection(node, sock);
+	}
+}
+
+static inline void
+as_command_close_conn(as_node* node, as_socket* sock, as_sync_pipe* pipe, as_sync_pipe_ticket* ticket)
+{
+	if (pipe) {
+		as_sync_pipe_done(pipe, node, ticket, false);
+	}
+	else {
+		as_node_close_conn_error(node, sock, sock->pool);
+	}
+}
+
+static as_status
+as_command_run_epoch(as_command* cmd, as_error* err, bool epoch)
+{
+	as_node* node = NULL;
+	as_status status;
+	bool release_node;
+
+	// Adaptive socket timeouts only apply to single record commands. The policy socket timeout
+	// is saved while an attempt runs with the adaptive timeout.
+	bool adaptive = cmd->policy->adaptive_timeout_pct > 0 && ! cmd->node;
+	bool restore_timeout = false;
+	uint32_t socket_timeout = 0;
+
+	// Node whose concurrency limit counts the current attempt.
+	as_node* limit_node = NULL;
+
+	// Execute command until successful, timed out or maximum iterations have been reached.
+	while (true) {
+		if (cmd->node) {
+			node = cmd->node;
+			release_node = false;
 		}
 		else {
 			// node might already be destroyed on retry and is still set as the previous node.
 			// This works because the previous node is only used for pointer comparison
 			// and the previous node's contents are not examined during this call.
-			node = as_partition_get_node(cmd->cluster, cmd->ns, cmd->partition, node, cmd->replica,
-										 cmd->replica_size, &cmd->replica_index);
+			node = as_partition_get_node_key(cmd->cluster, cmd->key, cmd->ns, cmd->partition, node,
+				cmd->replica, cmd->replica_size, &cmd->replica_index);
 
 			if (! node) {
+				as_cluster_hurry_tend(cmd->cluster);
 				as_error_update(err, AEROSPIKE_ERR_INVALID_NODE,
 					"Node not found for partition %s:%u", cmd->ns, cmd->partition_id);
 
 				as_command_prepare_error(cmd, err);
 				return err->code;
 			}
-			as_node_reserve(node);
-			release_node = true;
+			if (epoch) {
+				// Node is protected by the epoch critical section.
+				release_node = false;
+			}
+			else {
+				as_node_reserve(node);
+				release_node = true;
+			}
 		}
 
 		if (! as_node_valid_error_rate(node)) {
@@ -704,8 +1508,25 @@ as_command_execute(as_command* cmd, as_error* err)
 			goto Retry;
 		}
 
+		if (! as_node_breaker_allow(node)) {
+			status = as_error_set_message(err, AEROSPIKE_MAX_ERROR_RATE, "Circuit breaker open");
+			goto Retry;
+		}
+
+		if (! cmd->node && as_node_limited(node)) {
+			if (! as_node_limit_acquire(node)) {
+				status = as_error_set_message(err, AEROSPIKE_MAX_ERROR_RATE,
+					"Node concurrency limit exceeded");
+				goto Retry;
+			}
+			limit_node = node;
+		}
+
 		as_ns_metrics* metrics = NULL;
+		as_partition_heat* heat = NULL;
 		uint64_t begin = 0;
+		bool track_latency = cmd->replica == AS_POLICY_REPLICA_LOWEST_LATENCY;
+		bool heat_latency = false;
 
 		if (cmd->cluster->metrics_enabled) {
 			metrics = as_node_prepare_metrics(node, cmd->ns);
@@ -713,57 +1534,216 @@ as_command_execute(as_command* cmd, as_error* err)
 			if (cmd->latency_type != AS_LATENCY_TYPE_NONE) {
 				begin = cf_getns();
 			}
+
+			if (metrics && metrics->hot_keys && cmd->key) {
+				as_hot_keys_add(metrics->hot_keys, cmd->key->digest.value, cmd->key->set);
+			}
+
+			if (metrics && metrics->partition_heat && cmd->partition && ! cmd->node) {
+				heat = metrics->partition_heat;
+				heat_latency = as_partition_heat_add_command(heat, cmd->partition_id,
+					cmd->iteration > 0);
+			}
+		}
+
+		if ((track_latency || adaptive || limit_node || heat_latency) && ! begin) {
+			begin = cf_getns();
+		}
+
+		if (adaptive) {
+			socket_timeout = cmd->socket_timeout;
+			cmd->socket_timeout = as_node_adaptive_timeout(node, socket_timeout,
+				cmd->policy->adaptive_timeout_pct, cmd->policy->adaptive_timeout_min);
+			restore_timeout = true;
 		}
 
 		as_socket socket;
-		status = as_node_get_connection(err, node, cmd->ns, cmd->socket_timeout, cmd->deadline_ms, &socket);
+		as_sync_pipe_ticket ticket;
+		as_sync_pipe* pipe = as_command_get_pipe(cmd, node);
+		uint64_t conn_begin = cmd->slow ? cf_getns() : 0;
 
-		if (status != AEROSPIKE_OK) {
-			// Do not retry on server error response such as invalid user/password.
-			if (status > 0 && status != AEROSPIKE_ERR_TIMEOUT) {
-				if (release_node) {
-					as_node_release(node);
+		if (pipe) {
+			as_socket_iov seg = {cmd->buf, cmd->buf_size};
+			as_socket_iov* iov = cmd->iov ? cmd->iov : &seg;
+			uint32_t iov_count = cmd->iov ? cmd->iov_count : 1;
+
+			as_command_trace(cmd, AS_TRACE_WRITE, node, AEROSPIKE_OK);
+
+			// Connect if necessary and send command on shared connection.  The pipe closes
+			// the connection on write errors.
+			status = as_sync_pipe_write(pipe, err, node, cmd->ns, iov, iov_count,
+				cmd->socket_timeout, cmd->deadline_ms, &ticket);
+
+			if (status != AEROSPIKE_OK) {
+				// Do not retry on server error response such as invalid user/password.
+				if (status > 0 && status != AEROSPIKE_ERR_TIMEOUT) {
+					if (limit_node) {
+						as_node_limit_release(limit_node);
+					}
+					if (release_node) {
+						as_node_release(node);
+					}
+					as_command_prepare_error(cmd, err);
+					return status;
 				}
-				as_command_prepare_error(cmd, err);
-				return status;
+				goto Retry;
 			}
-			goto Retry;
+			cmd->sent++;
+
+			// Wait for responses of previously sent commands to be read.
+			status = as_sync_pipe_wait(pipe, err, &ticket, cmd->socket_timeout, cmd->deadline_ms,
+				&socket);
+			as_command_slow_conn(cmd, node, conn_begin);
+
+			if (status != AEROSPIKE_OK) {
+				as_sync_pipe_done(pipe, node, &ticket, false);
+				goto Retry;
+			}
+			as_command_trace(cmd, AS_TRACE_CONNECTION, node, AEROSPIKE_OK);
 		}
-		
-		// Send command.
-		status = as_socket_write_deadline(err, &socket, node, cmd->buf, cmd->buf_size,
-										  cmd->socket_timeout, cmd->deadline_ms);
-		
-		if (status != AEROSPIKE_OK) {
-			// Socket errors are considered temporary anomalies.  Retry.
-			// Close socket to flush out possible garbage.	Do not put back in pool.
-			as_node_close_conn_error(node, &socket, socket.pool);
-			goto Retry;
+		else {
+			status = as_node_get_connection(err, node, cmd->ns, cmd->socket_timeout, cmd->deadline_ms, &socket);
+			as_command_slow_conn(cmd, node, conn_begin);
+
+			if (status != AEROSPIKE_OK) {
+				// Do not retry on server error response such as invalid user/password.
+				if (status > 0 && status != AEROSPIKE_ERR_TIMEOUT) {
+					if (limit_node) {
+						as_node_limit_release(limit_node);
+					}
+					if (release_node) {
+						as_node_release(node);
+					}
+					as_command_prepare_error(cmd, err);
+					return status;
+				}
+				goto Retry;
+			}
+			as_command_trace(cmd, AS_TRACE_CONNECTION, node, AEROSPIKE_OK);
+			as_command_trace(cmd, AS_TRACE_WRITE, node, AEROSPIKE_OK);
+
+			// Send command.
+			if (cmd->iov) {
+				status = as_socket_writev_deadline(err, &socket, node, cmd->iov, cmd->iov_count,
+												   cmd->socket_timeout, cmd->deadline_ms);
+			}
+			else {
+				status = as_socket_write_deadline(err, &socket, node, cmd->buf, cmd->buf_size,
+												  cmd->socket_timeout, cmd->deadline_ms);
+			}
+
+			if (status != AEROSPIKE_OK && status != AEROSPIKE_ERR_TIMEOUT &&
+				cmd->cluster->conn_validate_window_ns > 0) {
+				// The pooled socket may have been trusted without validation. Reconnect once
+				// with a validated connection before counting this attempt. The server discards
+				// partial requests, so the command can be sent again.
+				as_node_close_conn_error(node, &socket, socket.pool);
+
+				status = as_node_get_validated_connection(err, node, cmd->ns,
+					cmd->socket_timeout, cmd->deadline_ms, &socket);
+
+				if (status != AEROSPIKE_OK) {
+					goto Retry;
+				}
+
+				if (cmd->iov) {
+					status = as_socket_writev_deadline(err, &socket, node, cmd->iov,
+						cmd->iov_count, cmd->socket_timeout, cmd->deadline_ms);
+				}
+				else {
+					status = as_socket_write_deadline(err, &socket, node, cmd->buf,
+						cmd->buf_size, cmd->socket_timeout, cmd->deadline_ms);
+				}
+			}
+
+			if (status != AEROSPIKE_OK) {
+				// Socket errors are considered temporary anomalies.  Retry.
+				// Close socket to flush out possible garbage.	Do not put back in pool.
+				as_node_close_conn_error(node, &socket, socket.pool);
+				goto Retry;
+			}
+			cmd->sent++;
 		}
-		cmd->sent++;
 
 		if (metrics) {
 			as_node_add_bytes_out(metrics, cmd->buf_size);
+			as_command_add_compressed_out(cmd, metrics, cmd->buf_size);
+		}
+
+		if (cmd->slow) {
+			cmd->slow->bytes_out = cmd->buf_size;
+		}
+
+		if ((cmd->flags & AS_COMMAND_FLAGS_HEDGE) && ! socket.ctx) {
+			if (! cmd->node) {
+				as_command_hedge(cmd, &node, &socket, &metrics, release_node);
+			}
+			else {
+				int rv = as_command_hedge_batch(cmd, err, node, &socket);
+
+				if (rv > 0) {
+					// Hedge commands read all keys and the node connection was closed.
+					as_command_trace(cmd, AS_TRACE_PARSED, node, AEROSPIKE_OK);
+
+					if (cmd->iteration > 0) {
+						as_error_reset(err);
+					}
+					return AEROSPIKE_OK;
+				}
+
+				if (rv < 0) {
+					// Retry keys of the failed hedge commands.
+					status = err->code;
+					goto Retry;
+				}
+			}
 		}
 
 		uint64_t bytes_in = 0;
 
 		// Parse results returned by server.
+		// Pipelined connections can hold responses of other commands, so they can not
+		// read ahead.
 		if (cmd->node) {
-			status = as_command_read_messages(err, cmd, &socket, node, &bytes_in);
+			status = as_command_read_messages(err, cmd, &socket, node, ! pipe, &bytes_in);
 		}
 		else {
-			status = as_command_read_message(err, cmd, &socket, node, &bytes_in);
+			status = as_command_read_message(err, cmd, &socket, node, ! pipe, &bytes_in);
 		}
 
 		if (metrics) {
 			as_node_add_bytes_in(metrics, bytes_in);
 		}
 
+		if (adaptive) {
+			// Timed out attempts are recorded too, so repeated timeouts raise the timeout.
+			as_node_add_adaptive_sample(node, cf_getns() - begin);
+		}
+
+		if (limit_node) {
+			as_node_add_limit_sample(limit_node, cf_getns() - begin,
+				status == AEROSPIKE_ERR_TIMEOUT || status == AEROSPIKE_ERR_DEVICE_OVERLOAD);
+		}
+
+		if (cmd->slow) {
+			cmd->slow->bytes_in = bytes_in;
+		}
+
+		as_command_trace(cmd, AS_TRACE_PARSED, node, status);
+
 		if (status == AEROSPIKE_OK) {
 			if (metrics && cmd->latency_type != AS_LATENCY_TYPE_NONE) {
 				uint64_t elapsed = cf_getns() - begin;
-				as_node_add_latency(metrics, cmd->latency_type, elapsed);
+				as_node_add_command_latency(metrics, cmd->latency_type, cmd->policy->latency_tag,
+					elapsed);
+			}
+
+			if (track_latency) {
+				as_node_add_replica_sample(node, cf_getns() - begin, false);
+			}
+
+			if (heat_latency) {
+				as_partition_heat_add_latency(heat, cmd->partition_id, cf_getns() - begin);
 			}
 
 			// Reset error code if retry had occurred.
@@ -777,24 +1757,40 @@ as_command_execute(as_command* cmd, as_error* err)
 			// Close socket on errors that can leave unread data in socket.
 			switch (status) {
 				case AEROSPIKE_ERR_CLUSTER:
+					// Partition unavailable. Partition map may be stale.
+					as_cluster_hurry_tend(cmd->cluster);
+					// Fall through.
+
 				case AEROSPIKE_ERR_DEVICE_OVERLOAD:
 					as_node_add_error(node, cmd->ns, metrics);
-					as_node_put_conn_error(node, &socket);
+					if (track_latency) {
+						as_node_add_replica_sample(node, cf_getns() - begin, true);
+					}
+					as_command_put_conn(node, &socket, pipe, &ticket, true);
 					goto Retry;
 
 				case AEROSPIKE_ERR_CONNECTION:
 					as_node_add_error(node, cmd->ns, metrics);
-					as_node_close_conn_error(node, &socket, socket.pool);
+					if (track_latency) {
+						as_node_add_replica_sample(node, cf_getns() - begin, true);
+					}
+					as_command_close_conn(node, &socket, pipe, &ticket);
 					goto Retry;
 
 				case AEROSPIKE_ERR_TIMEOUT:
 					as_node_add_timeout(node, cmd->ns, metrics);
+					if (heat) {
+						as_partition_heat_add_timeout(heat, cmd->partition_id);
+					}
+					if (track_latency) {
+						as_node_add_replica_sample(node, cf_getns() - begin, true);
+					}
 					
 					if (is_server_timeout(err)) {
-						as_node_put_conn_error(node, &socket);
+						as_command_put_conn(node, &socket, pipe, &ticket, true);
 					}
 					else {
-						as_node_close_conn_error(node, &socket, socket.pool);
+						as_command_close_conn(node, &socket, pipe, &ticket);
 					}
 					goto Retry;
 
@@ -805,7 +1801,10 @@ as_command_execute(as_command* cmd, as_error* err)
 				case AEROSPIKE_ERR_CLIENT_ABORT:
 				case AEROSPIKE_ERR_CLIENT:
 					as_node_add_error(node, cmd->ns, metrics);
-					as_node_close_conn_error(node, &socket, socket.pool);
+					as_command_close_conn(node, &socket, pipe, &ticket);
+					if (limit_node) {
+						as_node_limit_release(limit_node);
+					}
 					if (release_node) {
 						as_node_release(node);
 					}
@@ -817,116 +1816,455 @@ as_command_execute(as_command* cmd, as_error* err)
 					// Add latency metrics instead.
 					if (metrics && cmd->latency_type != AS_LATENCY_TYPE_NONE) {
 						uint64_t elapsed = cf_getns() - begin;
-						as_node_add_latency(metrics, cmd->latency_type, elapsed);
+						as_node_add_command_latency(metrics, cmd->latency_type,
+							cmd->policy->latency_tag, elapsed);
+					}
+					if (track_latency) {
+						as_node_add_replica_sample(node, cf_getns() - begin, false);
 					}
+					if (heat_latency) {
+						as_partition_heat_add_latency(heat, cmd->partition_id, cf_getns() - begin);
+					}
+					as_command_prepare_error(cmd, err);
+					break;
+
+				case AEROSPIKE_ERR_RECORD_BUSY:
+					as_node_add_key_busy(node, cmd->ns, metrics);
+					if (heat) {
+						as_partition_heat_add_key_busy(heat, cmd->partition_id);
+					}
+					as_command_prepare_error(cmd, err);
+					break;
+
+				default:
+					as_node_add_error(node, cmd->ns, metrics);
 					as_command_prepare_error(cmd, err);
 					break;
+			}
+		}
+
+		as_node_breaker_success(node);
+		as_cluster_retry_budget_success(cmd->cluster);
+		
+		// Put connection back in pool.
+		as_command_put_conn(node, &socket, pipe, &ticket, false);
+		
+		// Release resources.
+		if (limit_node) {
+			as_node_limit_release(limit_node);
+		}
+
+		if (release_node) {
+			as_node_release(node);
+		}
+		return status;
+
+Retry:
+		if (restore_timeout) {
+			cmd->socket_timeout = socket_timeout;
+			restore_timeout = false;
+		}
+
+		if (limit_node) {
+			as_node_limit_release(limit_node);
+			limit_node = NULL;
+		}
+
+		// Check if max retries reached.
+		if (++cmd->iteration > cmd->max_retries) {
+			break;
+		}
+
+		if (! as_cluster_retry_budget_allow(cmd->cluster)) {
+			break;
+		}
+		as_command_trace(cmd, AS_TRACE_RETRY, node, status);
+
+		uint32_t sleep_between_retries;
+
+		// Alternate between master and prole on socket errors or database reads.
+		// Timeouts/NO_MORE_CONNECTIONS are not a good indicator of impending data migration.
+		if (cmd->replica != AS_POLICY_REPLICA_MASTER && (
+			((cmd->flags & AS_COMMAND_FLAGS_READ) && !(cmd->flags & AS_COMMAND_FLAGS_LINEARIZE)) ||
+			(status != AEROSPIKE_ERR_TIMEOUT && status != AEROSPIKE_ERR_NO_MORE_CONNECTIONS &&
+			 status != AEROSPIKE_MAX_ERROR_RATE)
+			)) {
+			// Note: SC session read will ignore this setting because it uses master only.
+			cmd->replica_index++;
+
+			// Disable sleep on first failure because target node is likely to change.
+			sleep_between_retries = (cmd->iteration == 1)? 0 : cmd->policy->sleep_between_retries;
+		}
+		else {
+			// Sleep as defined because target node is not likely to change.
+			sleep_between_retries = cmd->policy->sleep_between_retries;
+		}
+
+		if (cmd->deadline_ms > 0) {
+			// Check for total timeout.
+			int64_t remaining = cmd->deadline_ms - as_clock_getms() - sleep_between_retries;
+
+			if (remaining <= 0) {
+				break;
+			}
+
+			if (remaining < cmd->total_timeout) {
+				cmd->total_timeout = (uint32_t)remaining;
+
+				if (cmd->socket_timeout > cmd->total_timeout) {
+					cmd->socket_timeout = cmd->total_timeout;
+				}
+			}
+		}
+
+		// Prepare for retry.
+		if (release_node) {
+			as_node_release(node);
+		}
+
+		if (sleep_between_retries > 0) {
+			// Sleep before trying again.
+			as_sleep(sleep_between_retries);
+		}
+
+		if (cmd->flags & AS_COMMAND_FLAGS_BATCH) {
+			status = as_batch_retry(cmd, err);
+
+			if (status != AEROSPIKE_USE_NORMAL_RETRY) {
+				return status;
+			}
+		}
+
+		as_cluster_add_retry(cmd->cluster);
+	}
+
+	// Retries have been exhausted.
+	// Fill in timeout stats if timeout occurred.
+	if (err->code == AEROSPIKE_ERR_TIMEOUT) {
+		// Server timeouts have a message.  Client timeouts do not have a message.
+		const char* type = is_server_timeout(err)? "Server" : "Client";
+		as_error_update(err, AEROSPIKE_ERR_TIMEOUT,
+			"%s timeout: socket=%u total=%u iterations=%u lastNode=%s",
+			type, cmd->policy->socket_timeout, cmd->policy->total_timeout, cmd->iteration,
+			as_node_get_address_string(node));
+	}
+
+	if (release_node) {
+		as_node_release(node);
+	}
+	as_command_prepare_error(cmd, err);
+	return err->code;
+}
+
+static as_status
+as_command_run(as_command* cmd, as_error* err)
+{
+	if (! cmd->cluster->epoch_reclaim || cmd->node) {
+		return as_command_run_epoch(cmd, err, false);
+	}
+
+	as_epoch_record* rec = as_epoch_enter();
+	as_status status = as_command_run_epoch(cmd, err, true);
+	as_epoch_exit(rec);
+	return status;
+}
+
+static inline bool
+as_command_has_quota(as_command* cmd)
+{
+	// Transaction monitor, verify and roll commands are not subject to client quotas because
+	// rejecting them would leave the transaction unfinished.
+	return cmd->key && cmd->cluster->quotas && ! (cmd->flags & AS_COMMAND_FLAGS_TXN_MONITOR) &&
+		cmd->latency_type != AS_LATENCY_TYPE_TXN_VERIFY &&
+		cmd->latency_type != AS_LATENCY_TYPE_TXN_ROLL;
+}
+
+static inline uint32_t
+as_command_max_wait(as_command* cmd, uint32_t max_wait)
+{
+	if (cmd->deadline_ms > 0) {
+		uint64_t now = as_clock_getms();
+		uint32_t remaining = (cmd->deadline_ms > now)? (uint32_t)(cmd->deadline_ms - now) : 1;
+
+		if (remaining < max_wait) {
+			max_wait = remaining;
+		}
+	}
+	return max_wait;
+}
+
+static inline bool
+as_command_has_budget(as_command* cmd)
+{
+	// Multi-node commands (batch, scan, query) are admitted regardless of request size,
+	// because their responses are the large allocations.
+	return cmd->cluster->mem_budget && (cmd->node || cmd->buf_size > AS_STACK_BUF_SIZE);
+}
+
+static as_status
+as_command_execute_traced(as_command* cmd, as_error* err)
+{
+	cmd->trace_id = as_cluster_trace_begin(cmd->cluster);
+	cmd->slow = NULL;
+
+	if (! (cmd->trace_id || cmd->cluster->slow_log)) {
+		return as_command_run(cmd, err);
+	}
+
+	as_slow_command slow;
+	uint64_t begin = 0;
+
+	if (cmd->cluster->slow_log) {
+		slow.conn_wait_us = 0;
+		slow.bytes_out = 0;
+		slow.bytes_in = 0;
+		slow.node[0] = 0;
+		cmd->slow = &slow;
+		begin = cf_getns();
+	}
+
+	as_command_trace(cmd, AS_TRACE_START, cmd->node, AEROSPIKE_OK);
+	as_status status = as_command_run(cmd, err);
+	as_command_trace(cmd, AS_TRACE_COMPLETE, cmd->node, status);
+
+	if (cmd->slow) {
+		as_command_slow_log(cmd, &slow, begin, status);
+		cmd->slow = NULL;
+	}
+	return status;
+}
+
+as_status
+as_command_execute(as_command* cmd, as_error* err)
+{
+	if (as_command_has_quota(cmd)) {
+		uint32_t max_wait = as_command_max_wait(cmd, UINT32_MAX);
+		as_quota_type type = (cmd->flags & AS_COMMAND_FLAGS_READ)? AS_QUOTA_READ : AS_QUOTA_WRITE;
+		as_status status = as_cluster_quota_wait(cmd->cluster, err, cmd->key->ns, cmd->key->set,
+			type, max_wait);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+
+	if (! as_command_has_budget(cmd)) {
+		return as_command_execute_traced(cmd, err);
+	}
+
+	as_mem_budget* budget = cmd->cluster->mem_budget;
+	uint32_t max_wait = as_command_max_wait(cmd, cmd->cluster->mem_budget_wait);
+	as_status status = as_mem_budget_acquire(budget, err, cmd->buf_size, max_wait);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	status = as_command_execute_traced(cmd, err);
+	as_mem_budget_release(budget, cmd->buf_size);
+	return status;
+}
+
+// Read-ahead buffer for responses that contain multiple proto blocks.
+#define AS_COMMAND_READ_AHEAD_SIZE (1024 * 64)
+
+// Uncompressed multi-record blocks larger than this are parsed in chunks of at least this
+// size while the block is still being read.
+#define AS_COMMAND_STREAM_CHUNK_SIZE (1024 * 64)
+
+// Read-ahead buffer for single record responses. Allocated on the stack.
+#define AS_COMMAND_READ_AHEAD_SINGLE_SIZE (1024 * 4)
+
+/**
+ * Response reader that reads large chunks from the socket, so headers and small bodies are
+ * returned from the buffer instead of separate read calls. buf is NULL if read-ahead is
+ * disabled.
+ */
+typedef struct as_command_reader_s {
+	uint8_t* buf;
+	size_t capacity;
+	size_t offset;
+	size_t length;
+} as_command_reader;
+
+static inline size_t
+as_command_reader_available(as_command_reader* rd)
+{
+	return rd->length - rd->offset;
+}
+
+static as_status
+as_command_reader_read(
+	as_error* err, as_command_reader* rd, as_command* cmd, as_socket* sock, as_node* node,
+	uint8_t* dst, size_t size, uint32_t spin_us
+	)
+{
+	size_t avail = rd->length - rd->offset;
 
-				case AEROSPIKE_ERR_RECORD_BUSY:
-					as_node_add_key_busy(node, cmd->ns, metrics);
-					as_command_prepare_error(cmd, err);
-					break;
+	if (avail >= size) {
+		memcpy(dst, rd->buf + rd->offset, size);
+		rd->offset += size;
+		return AEROSPIKE_OK;
+	}
 
-				default:
-					as_node_add_error(node, cmd->ns, metrics);
-					as_command_prepare_error(cmd, err);
-					break;
-			}
-		}
-		
-		// Put connection back in pool.
-		as_node_put_connection(node, &socket);
-		
-		// Release resources.
-		if (release_node) {
-			as_node_release(node);
-		}
+	if (avail > 0) {
+		memcpy(dst, rd->buf + rd->offset, avail);
+		dst += avail;
+		size -= avail;
+	}
+	rd->offset = 0;
+	rd->length = 0;
+
+	if (! rd->buf || size >= rd->capacity) {
+		// Read large blocks directly into the destination.
+		return as_socket_read_spin_deadline(err, sock, node, dst, size, cmd->socket_timeout,
+			cmd->deadline_ms, spin_us);
+	}
+
+	size_t len;
+	as_status status = as_socket_read_ahead_deadline(err, sock, node, rd->buf, size,
+		rd->capacity, cmd->socket_timeout, cmd->deadline_ms, spin_us, &len);
+
+	if (status != AEROSPIKE_OK) {
 		return status;
+	}
 
-Retry:
-		// Check if max retries reached.
-		if (++cmd->iteration > cmd->max_retries) {
-			break;
-		}
+	memcpy(dst, rd->buf, size);
+	rd->offset = size;
+	rd->length = len;
+	return AEROSPIKE_OK;
+}
 
-		uint32_t sleep_between_retries;
+static inline void
+as_command_budget_charge(as_command* cmd, size_t size)
+{
+	// Only heap allocated response buffers count against the memory budget.
+	if (size > AS_STACK_BUF_SIZE) {
+		as_mem_budget_charge(cmd->cluster->mem_budget, size);
+	}
+}
 
-		// Alternate between master and prole on socket errors or database reads.
-		// Timeouts/NO_MORE_CONNECTIONS are not a good indicator of impending data migration.
-		if (cmd->replica != AS_POLICY_REPLICA_MASTER && (
-			((cmd->flags & AS_COMMAND_FLAGS_READ) && !(cmd->flags & AS_COMMAND_FLAGS_LINEARIZE)) ||
-			(status != AEROSPIKE_ERR_TIMEOUT && status != AEROSPIKE_ERR_NO_MORE_CONNECTIONS &&
-			 status != AEROSPIKE_MAX_ERROR_RATE)
-			)) {
-			// Note: SC session read will ignore this setting because it uses master only.
-			cmd->replica_index++;
+static inline void
+as_command_budget_uncharge(as_command* cmd, size_t size)
+{
+	if (size > AS_STACK_BUF_SIZE) {
+		as_mem_budget_uncharge(cmd->cluster->mem_budget, size);
+	}
+}
 
-			// Disable sleep on first failure because target node is likely to change.
-			sleep_between_retries = (cmd->iteration == 1)? 0 : cmd->policy->sleep_between_retries;
+static inline void
+as_command_stream_reserve(as_command* cmd, uint8_t** buf, size_t* capacity, size_t used, size_t size)
+{
+	if (size <= *capacity) {
+		return;
+	}
+
+	size_t cap = (size + 16383) & ~16383; // Round up in 16KB increments.
+
+	// The buffer outlives this function, so it must never come from alloca().
+	if (cap < AS_COMMAND_STREAM_CHUNK_SIZE) {
+		cap = AS_COMMAND_STREAM_CHUNK_SIZE;
+	}
+
+	uint8_t* b = as_command_buffer_get_alloc(&cmd->cluster->allocator, cap);
+
+	if (used > 0) {
+		memcpy(b, *buf, used);
+	}
+	as_command_buffer_free_alloc(&cmd->cluster->allocator, *buf, *capacity);
+	as_command_budget_uncharge(cmd, *capacity);
+	as_command_budget_charge(cmd, cap);
+	*buf = b;
+	*capacity = cap;
+}
+
+/**
+ * Parse a large uncompressed proto block while it is being read. Whole records are copied
+ * from the read-ahead buffer into buf and passed to the parse function once
+ * AS_COMMAND_STREAM_CHUNK_SIZE bytes have accumulated, so buf only grows beyond the chunk
+ * size to hold a single large record.
+ */
+static as_status
+as_command_stream_records(
+	as_error* err, as_command* cmd, as_command_reader* rd, as_socket* sock, as_node* node,
+	size_t size, uint8_t** buf, size_t* capacity
+	)
+{
+	size_t remain = size;
+	size_t pos = 0;
+	as_status status;
+
+	while (remain > 0) {
+		if (remain < sizeof(as_msg)) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Invalid record header size: %zu",
+				remain);
 		}
-		else {
-			// Sleep as defined because target node is not likely to change.
-			sleep_between_retries = cmd->policy->sleep_between_retries;
+
+		as_command_stream_reserve(cmd, buf, capacity, pos, pos + sizeof(as_msg));
+		status = as_command_reader_read(err, rd, cmd, sock, node, *buf + pos, sizeof(as_msg), 0);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
 		}
 
-		if (cmd->deadline_ms > 0) {
-			// Check for total timeout.
-			int64_t remaining = cmd->deadline_ms - cf_getms() - sleep_between_retries;
+		as_msg* msg = (as_msg*)(*buf + pos);
+		uint32_t n = (uint32_t)cf_swap_from_be16(msg->n_fields) + cf_swap_from_be16(msg->n_ops);
 
-			if (remaining <= 0) {
-				break;
+		pos += sizeof(as_msg);
+		remain -= sizeof(as_msg);
+
+		// Fields and operations are each prefixed by their size.
+		for (uint32_t i = 0; i < n; i++) {
+			if (remain < sizeof(uint32_t)) {
+				return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Truncated record");
 			}
 
-			if (remaining < cmd->total_timeout) {
-				cmd->total_timeout = (uint32_t)remaining;
+			as_command_stream_reserve(cmd, buf, capacity, pos, pos + sizeof(uint32_t));
+			status = as_command_reader_read(err, rd, cmd, sock, node, *buf + pos,
+				sizeof(uint32_t), 0);
 
-				if (cmd->socket_timeout > cmd->total_timeout) {
-					cmd->socket_timeout = cmd->total_timeout;
-				}
+			if (status != AEROSPIKE_OK) {
+				return status;
 			}
-		}
 
-		// Prepare for retry.
-		if (release_node) {
-			as_node_release(node);
-		}
+			uint32_t sz;
+			memcpy(&sz, *buf + pos, sizeof(uint32_t));
+			sz = cf_swap_from_be32(sz);
+			pos += sizeof(uint32_t);
+			remain -= sizeof(uint32_t);
 
-		if (sleep_between_retries > 0) {
-			// Sleep before trying again.
-			as_sleep(sleep_between_retries);
-		}
+			if (sz > remain) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"Record item size %u exceeds remaining block size %zu", sz, remain);
+			}
 
-		if (cmd->flags & AS_COMMAND_FLAGS_BATCH) {
-			status = as_batch_retry(cmd, err);
+			as_command_stream_reserve(cmd, buf, capacity, pos, pos + sz);
+			status = as_command_reader_read(err, rd, cmd, sock, node, *buf + pos, sz, 0);
 
-			if (status != AEROSPIKE_USE_NORMAL_RETRY) {
+			if (status != AEROSPIKE_OK) {
 				return status;
 			}
+			pos += sz;
+			remain -= sz;
 		}
 
-		as_cluster_add_retry(cmd->cluster);
-	}
-
-	// Retries have been exhausted.
-	// Fill in timeout stats if timeout occurred.
-	if (err->code == AEROSPIKE_ERR_TIMEOUT) {
-		// Server timeouts have a message.  Client timeouts do not have a message.
-		const char* type = is_server_timeout(err)? "Server" : "Client";
-		as_error_update(err, AEROSPIKE_ERR_TIMEOUT,
-			"%s timeout: socket=%u total=%u iterations=%u lastNode=%s",
-			type, cmd->policy->socket_timeout, cmd->policy->total_timeout, cmd->iteration,
-			as_node_get_address_string(node));
-	}
+		if (pos >= AS_COMMAND_STREAM_CHUNK_SIZE || remain == 0) {
+			status = cmd->parse_results_fn(err, cmd, node, *buf, pos);
 
-	if (release_node) {
-		as_node_release(node);
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+			pos = 0;
+		}
 	}
-	as_command_prepare_error(cmd, err);
-	return err->code;
+	return AEROSPIKE_OK;
 }
 
 static as_status
-as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_node* node, uint64_t* bytes_in)
+as_command_read_messages(
+	as_error* err, as_command* cmd, as_socket* sock, as_node* node, bool read_ahead,
+	uint64_t* bytes_in
+	)
 {
 	size_t capacity = 0;
 	uint8_t* buf = NULL;
@@ -936,16 +2274,28 @@ as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_nod
 	size_t size2;
 	as_proto proto;
 	as_status status;
+	uint32_t spin_us = cmd->policy->spin_read_us;
+
+	as_command_reader rd = {NULL, 0, 0, 0};
+
+	if (read_ahead) {
+		rd.buf = as_command_buffer_get(AS_COMMAND_READ_AHEAD_SIZE);
+		rd.capacity = AS_COMMAND_READ_AHEAD_SIZE;
+	}
 
 	while (true) {
 		// Read header
-		status = as_socket_read_deadline(err, sock, node, (uint8_t*)&proto, sizeof(as_proto),
-										 cmd->socket_timeout, cmd->deadline_ms);
+		status = as_command_reader_read(err, &rd, cmd, sock, node, (uint8_t*)&proto,
+			sizeof(as_proto), spin_us);
 		
 		if (status != AEROSPIKE_OK) {
 			break;
 		}
 
+		if (*bytes_in == 0) {
+			as_command_trace(cmd, AS_TRACE_FIRST_BYTE, node, AEROSPIKE_OK);
+		}
+
 		*bytes_in += sizeof(as_proto);
 		status = as_proto_parse(err, &proto);
 
@@ -959,44 +2309,72 @@ as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_nod
 			continue;
 		}
 
-		// Prepare buffer
-		if (size > capacity) {
-			as_command_buffer_free(buf, capacity);
-			capacity = (size + 16383) & ~16383; // Round up in 16KB increments.
-			buf = as_command_buffer_init(capacity);
+		uint8_t* data;
+
+		if (as_command_reader_available(&rd) >= size) {
+			// Parse message directly from the read-ahead buffer.
+			data = rd.buf + rd.offset;
+			rd.offset += size;
 		}
-		
-		// Read remaining message bytes in group
-		status = as_socket_read_deadline(err, sock, node, buf, size, cmd->socket_timeout,
-										 cmd->deadline_ms);
-		
-		if (status != AEROSPIKE_OK) {
-			break;
+		else if (rd.buf && proto.type == AS_MESSAGE_TYPE && size > AS_COMMAND_STREAM_CHUNK_SIZE) {
+			// Parse records while the rest of the block is still arriving.
+			*bytes_in += size;
+			status = as_command_stream_records(err, cmd, &rd, sock, node, size, &buf, &capacity);
+
+			if (status != AEROSPIKE_OK) {
+				if (status == AEROSPIKE_NO_MORE_RECORDS) {
+					status = AEROSPIKE_OK;
+				}
+				break;
+			}
+			continue;
+		}
+		else {
+			// Prepare buffer
+			if (size > capacity) {
+				as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, capacity);
+				as_command_budget_uncharge(cmd, capacity);
+				capacity = (size + 16383) & ~16383; // Round up in 16KB increments.
+				buf = as_command_buffer_init_alloc(&cmd->cluster->allocator, capacity);
+				as_command_budget_charge(cmd, capacity);
+			}
+
+			// Read remaining message bytes in group
+			status = as_command_reader_read(err, &rd, cmd, sock, node, buf, size, 0);
+
+			if (status != AEROSPIKE_OK) {
+				break;
+			}
+			data = buf;
 		}
 		
 		*bytes_in += size;
 
 		if (proto.type == AS_MESSAGE_TYPE) {
-			status = cmd->parse_results_fn(err, cmd, node, buf, size);
+			status = cmd->parse_results_fn(err, cmd, node, data, size);
 		}
-		else if (proto.type == AS_COMPRESSED_MESSAGE_TYPE) {
-			status = as_compressed_size_parse(err, buf, &size2);
+		else if (as_proto_is_compressed(proto.type)) {
+			status = as_compressed_size_parse(err, data, &size2);
 
 			if (status != AEROSPIKE_OK) {
 				break;
 			}
 
 			if (size2 > capacity2) {
-				as_command_buffer_free(buf2, capacity2);
+				as_command_buffer_free_alloc(&cmd->cluster->allocator, buf2, capacity2);
+				as_command_budget_uncharge(cmd, capacity2);
 				capacity2 = (size2 + 16383) & ~16383; // Round up in 16KB increments.
-				buf2 = as_command_buffer_init(capacity2);
+				buf2 = as_command_buffer_init_alloc(&cmd->cluster->allocator, capacity2);
+				as_command_budget_charge(cmd, capacity2);
 			}
 
-			status = as_proto_decompress(err, buf2, size2, buf, size);
+			status = as_proto_decompress(err, proto.type, node->cluster->compress_stats, buf2,
+				size2, data, size);
 
 			if (status != AEROSPIKE_OK) {
 				break;
 			}
+			as_command_add_compressed_in(cmd, node, sizeof(as_proto) + size, size2);
 
 			status = cmd->parse_results_fn(err, cmd, node, buf2 + sizeof(as_proto),
 										   size2 - sizeof(as_proto));
@@ -1013,22 +2391,40 @@ as_command_read_messages(as_error* err, as_command* cmd, as_socket* sock, as_nod
 			break;
 		}
 	}
-	as_command_buffer_free(buf, capacity);
-	as_command_buffer_free(buf2, capacity2);
+	as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, capacity);
+	as_command_buffer_free_alloc(&cmd->cluster->allocator, buf2, capacity2);
+	as_command_budget_uncharge(cmd, capacity);
+	as_command_budget_uncharge(cmd, capacity2);
+
+	if (rd.buf) {
+		as_command_buffer_put(rd.buf, AS_COMMAND_READ_AHEAD_SIZE);
+	}
 	return status;
 }
 
 static as_status
-as_command_read_message(as_error* err, as_command* cmd, as_socket* sock, as_node* node, uint64_t* bytes_in)
+as_command_read_message(
+	as_error* err, as_command* cmd, as_socket* sock, as_node* node, bool read_ahead,
+	uint64_t* bytes_in
+	)
 {
+	uint8_t ahead[AS_COMMAND_READ_AHEAD_SINGLE_SIZE];
+	as_command_reader rd = {NULL, 0, 0, 0};
+
+	if (read_ahead) {
+		rd.buf = ahead;
+		rd.capacity = sizeof(ahead);
+	}
+
 	as_proto proto;
-	as_status status = as_socket_read_deadline(err, sock, node, (uint8_t*)&proto, sizeof(as_proto),
-											   cmd->socket_timeout, cmd->deadline_ms);
+	as_status status = as_command_reader_read(err, &rd, cmd, sock, node, (uint8_t*)&proto,
+		sizeof(as_proto), cmd->policy->spin_read_us);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
 	}
 
+	as_command_trace(cmd, AS_TRACE_FIRST_BYTE, node, AEROSPIKE_OK);
 	*bytes_in += sizeof(as_proto);
 	status = as_proto_parse(err, &proto);
 
@@ -1042,45 +2438,98 @@ as_command_read_message(as_error* err, as_command* cmd, as_socket* sock, as_node
 		return as_proto_size_error(err, size);
 	}
 
-	uint8_t* buf = as_command_buffer_init(size);
-	status = as_socket_read_deadline(err, sock, node, buf, size, cmd->socket_timeout, cmd->deadline_ms);
+	if ((cmd->flags & AS_COMMAND_FLAGS_ZERO_COPY) && proto.type == AS_MESSAGE_TYPE) {
+		// Read directly into reference counted buffer that parsed records can own.
+		as_record_buffer* rb = as_record_buffer_create(&cmd->cluster->allocator, (uint32_t)size);
 
-	if (status != AEROSPIKE_OK) {
-		as_command_buffer_free(buf, size);
+		if (! rb) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "malloc failure: %zu", size);
+		}
+
+		status = as_command_reader_read(err, &rd, cmd, sock, node, rb->data, size, 0);
+
+		if (status == AEROSPIKE_OK) {
+			*bytes_in += size;
+
+			as_command_parse_result_data* data = cmd->udata;
+			data->buffer = rb;
+			status = cmd->parse_results_fn(err, cmd, node, rb->data, size);
+			data->buffer = NULL;
+		}
+		as_record_buffer_release(rb);
 		return status;
 	}
 
+	uint8_t* buf = NULL;
+	uint8_t* data;
+
+	if (as_command_reader_available(&rd) >= size) {
+		// Parse message directly from the read-ahead buffer.
+		data = rd.buf + rd.offset;
+	}
+	else {
+		buf = as_command_buffer_init_alloc(&cmd->cluster->allocator, size);
+		as_command_budget_charge(cmd, size);
+		status = as_command_reader_read(err, &rd, cmd, sock, node, buf, size, 0);
+
+		if (status != AEROSPIKE_OK) {
+			as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, size);
+			as_command_budget_uncharge(cmd, size);
+			return status;
+		}
+		data = buf;
+	}
+
 	*bytes_in += size;
 
 	if (proto.type == AS_MESSAGE_TYPE) {
-		status = cmd->parse_results_fn(err, cmd, node, buf, size);
-		as_command_buffer_free(buf, size);
+		status = cmd->parse_results_fn(err, cmd, node, data, size);
+
+		if (buf) {
+			as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, size);
+			as_command_budget_uncharge(cmd, size);
+		}
 		return status;
 	}
-	else if (proto.type == AS_COMPRESSED_MESSAGE_TYPE) {
+	else if (as_proto_is_compressed(proto.type)) {
 		size_t size2;
-		status = as_compressed_size_parse(err, buf, &size2);
+		status = as_compressed_size_parse(err, data, &size2);
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(buf, size);
+			if (buf) {
+				as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, size);
+				as_command_budget_uncharge(cmd, size);
+			}
 			return status;
 		}
 
-		uint8_t* buf2 = as_command_buffer_init(size2);
-		status = as_proto_decompress(err, buf2, size2, buf, size);
-		as_command_buffer_free(buf, size);
+		uint8_t* buf2 = as_command_buffer_init_alloc(&cmd->cluster->allocator, size2);
+		as_command_budget_charge(cmd, size2);
+		status = as_proto_decompress(err, proto.type, node->cluster->compress_stats, buf2, size2,
+			data, size);
+
+		if (buf) {
+			as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, size);
+			as_command_budget_uncharge(cmd, size);
+		}
 
 		if (status != AEROSPIKE_OK) {
-			as_command_buffer_free(buf2, size2);
+			as_command_buffer_free_alloc(&cmd->cluster->allocator, buf2, size2);
+			as_command_budget_uncharge(cmd, size2);
 			return status;
 		}
+		as_command_add_compressed_in(cmd, node, sizeof(as_proto) + size, size2);
 		status = cmd->parse_results_fn(err, cmd, node, buf2 + sizeof(as_proto),
 									   size2 - sizeof(as_proto));
-		as_command_buffer_free(buf2, size2);
+		as_command_buffer_free_alloc(&cmd->cluster->allocator, buf2, size2);
+		as_command_budget_uncharge(cmd, size2);
 		return status;
 	}
 	else {
-		as_command_buffer_free(buf, size);
+		if (buf) {
+			as_command_buffer_free_alloc(&cmd->cluster->allocator, buf, size);
+			as_command_budget_uncharge(cmd, size);
+		}
 		return as_proto_type_error(err, &proto, AS_MESSAGE_TYPE);
 	}
 }
@@ -1233,6 +2682,10 @@ as_command_parse_key(uint8_t* p, uint32_t n_fields, as_key* key, uint64_t* bval)
 {
 	uint32_t len;
 	uint32_t size;
+
+	// The key may be reused with another namespace, so cached routing state is cleared.
+	key->ns_handle = 0;
+	key->route_hint = 0;
 	
 	for (uint32_t i = 0; i < n_fields; i++) {
 		len = cf_swap_from_be32(*(uint32_t*)p) - 1;
@@ -1499,8 +2952,67 @@ abort_record_memory(as_error* err, as_record* rec, size_t size)
 	return as_error_update(err, AEROSPIKE_ERR_CLIENT, "malloc failure: %zu", size);
 }
 
-as_status
-as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize)
+static bool
+as_parse_compressed_bin(as_bin* bin, uint8_t* p, uint32_t value_size)
+{
+	if (value_size <= AS_BIN_COMPRESS_HEADER_SIZE ||
+		cf_swap_from_be32(*(uint32_t*)p) != AS_BIN_COMPRESS_MAGIC) {
+		return false;
+	}
+
+	uint8_t codec = p[4];
+	uint8_t type = p[5];
+	uint32_t size = cf_swap_from_be32(*(uint32_t*)(p + 6));
+	uint32_t comp_size = cf_swap_from_be32(*(uint32_t*)(p + 10));
+
+	if (codec >= AS_COMPRESS_CODEC_SIZE || size > AS_BIN_COMPRESS_MAX_SIZE ||
+		(type != AS_BYTES_STRING && type != AS_BYTES_BLOB) ||
+		comp_size != value_size - AS_BIN_COMPRESS_HEADER_SIZE) {
+		return false;
+	}
+
+	// A user blob may start with the magic bytes by chance. Only decompress blobs whose
+	// checksum matches.
+	uint32_t checksum = cf_swap_from_be32(*(uint32_t*)(p + AS_BIN_COMPRESS_CHECKSUM_OFFSET));
+
+	if (checksum != as_bin_compress_checksum(p, p + AS_BIN_COMPRESS_HEADER_SIZE, comp_size)) {
+		return false;
+	}
+
+	uint8_t* value = cf_malloc(size + 1);
+
+	if (! value) {
+		return false;
+	}
+
+	as_error err;
+	as_error_init(&err);
+
+	size_t out_size = size;
+	as_status status = as_decompress_data(&err, (as_compress_codec)codec,
+		p + AS_BIN_COMPRESS_HEADER_SIZE, comp_size, value, &out_size);
+
+	if (status != AEROSPIKE_OK || out_size != size) {
+		// Not a value compressed by this client. Return the blob unchanged.
+		cf_free(value);
+		return false;
+	}
+
+	if (type == AS_BYTES_STRING) {
+		value[size] = 0;
+		as_string_init_wlen((as_string*)&bin->value, (char*)value, size, true);
+	}
+	else {
+		as_bytes_init_wrap((as_bytes*)&bin->value, value, size, true);
+	}
+	bin->valuep = &bin->value;
+	return true;
+}
+
+static as_status
+as_parse_bins(
+	uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize, bool zero_copy
+	)
 {
 	uint8_t* p = *pp;
 	as_bin* bin = rec->bins.entries;
@@ -1549,6 +3061,17 @@ as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bi
 				break;
 			}
 			case AS_BYTES_STRING: {
+				if (zero_copy) {
+					// Shift string back one byte over the already parsed bin name (or name size)
+					// so the string can be null terminated in place.
+					char* value = (char*)p - 1;
+					memmove(value, p, value_size);
+					value[value_size] = 0;
+					as_string_init_wlen((as_string*)&bin->value, value, value_size, false);
+					bin->valuep = &bin->value;
+					break;
+				}
+
 				char* value = cf_malloc(value_size + 1);
 
 				if (! value) {
@@ -1606,6 +3129,11 @@ as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bi
 					}
 					bin->valuep = (as_bin_value*)value;
 				}
+				else if (zero_copy) {
+					as_bytes_init_wrap((as_bytes*)&bin->value, p, value_size, false);
+					bin->value.bytes.type = (as_bytes_type)type;
+					bin->valuep = &bin->value;
+				}
 				else {
 					void* value = cf_malloc(value_size);
 
@@ -1619,7 +3147,19 @@ as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bi
 				}
 				break;
 			}
+			case AS_BYTES_BLOB:
+				if (as_parse_compressed_bin(bin, p, value_size)) {
+					break;
+				}
+				// Fall through.
 			default: {
+				if (zero_copy) {
+					as_bytes_init_wrap((as_bytes*)&bin->value, p, value_size, false);
+					bin->value.bytes.type = (as_bytes_type)type;
+					bin->valuep = &bin->value;
+					break;
+				}
+
 				void* value = cf_malloc(value_size);
 
 				if (! value) {
@@ -1639,6 +3179,78 @@ as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bi
 	return AEROSPIKE_OK;
 }
 
+as_status
+as_command_parse_bins(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize)
+{
+	return as_parse_bins(pp, err, rec, n_bins, deserialize, false);
+}
+
+as_status
+as_command_parse_bins_wrap(uint8_t** pp, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize)
+{
+	return as_parse_bins(pp, err, rec, n_bins, deserialize, true);
+}
+
+as_status
+as_command_parse_bins_zero_copy(
+	uint8_t* p, uint8_t* end, as_error* err, as_record* rec, uint32_t n_bins, bool deserialize,
+	bool lazy, as_record_buffer* buffer, const as_allocator* allocator
+	)
+{
+	if (buffer) {
+		as_record_buffer_reserve(buffer);
+	}
+	else {
+		uint32_t size = (uint32_t)(end - p);
+		buffer = as_record_buffer_create(allocator, size);
+
+		if (! buffer) {
+			return abort_record_memory(err, rec, size);
+		}
+		memcpy(buffer->data, p, size);
+		p = buffer->data;
+	}
+
+	// Attach buffer before parsing so bin values that reference the buffer remain valid
+	// until the record is destroyed, even when parsing fails.
+	as_record_set_buffer(rec, buffer);
+
+	if (lazy && deserialize) {
+		// Keep raw list and map bytes. as_record deserializes them on first access.
+		rec->lazy = true;
+		deserialize = false;
+	}
+	return as_parse_bins(&p, err, rec, n_bins, deserialize, true);
+}
+
+as_status
+as_command_parse_record_arena(
+	uint8_t* p, uint8_t* end, as_error* err, uint32_t n_bins, bool deserialize, bool lazy,
+	as_record** recp
+	)
+{
+	uint32_t size = (uint32_t)(end - p);
+	uint8_t* data = NULL;
+	as_record* rec = as_record_new_arena((uint16_t)n_bins, size, &data);
+
+	if (! rec) {
+		*recp = NULL;
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "malloc failure: %u", size);
+	}
+
+	if (size > 0) {
+		memcpy(data, p, size);
+	}
+
+	if (lazy && deserialize) {
+		rec->lazy = true;
+		deserialize = false;
+	}
+
+	*recp = rec;
+	return as_parse_bins(&data, err, rec, n_bins, deserialize, true);
+}
+
 as_status
 as_command_parse_result(as_error* err, as_command* cmd, as_node* node, uint8_t* buf, size_t size)
 {
@@ -1685,14 +3297,21 @@ as_command_parse_result(as_error* err, as_command* cmd, as_node* node, uint8_t*
 					free_on_error = false;
 				}
 				else {
-					rec = as_record_new(msg->n_ops);
+					// Bin array shares the record allocation.
+					rec = as_record_new_arena(msg->n_ops, 0, NULL);
 					*data->record = rec;
 					free_on_error = true;
 				}
 				rec->gen = msg->generation;
 				rec->ttl = cf_server_void_time_to_ttl(msg->record_ttl);
 
-				status = as_command_parse_bins(&p, err, rec, msg->n_ops, data->deserialize);
+				if (data->zero_copy) {
+					status = as_command_parse_bins_zero_copy(p, buf + size, err, rec, msg->n_ops,
+						data->deserialize, data->lazy, data->buffer, &cmd->cluster->allocator);
+				}
+				else {
+					status = as_command_parse_bins(&p, err, rec, msg->n_ops, data->deserialize);
+				}
 
 				if (status != AEROSPIKE_OK && free_on_error) {
 					as_record_destroy(rec);
@@ -1707,7 +3326,7 @@ as_command_parse_result(as_error* err, as_command* cmd, as_node* node, uint8_t*
 		}
 
 		default:
-			as_error_update(err, status, "%s %s", as_node_get_address_string(node),
+			as_error_set_prefix(err, status, as_node_get_address_string(node),
 							as_error_string(status));
 			break;
 	}
@@ -1757,7 +3376,7 @@ as_command_parse_success_failure(
 		}
 
 		default:
-			as_error_update(err, status, "%s %s", as_node_get_address_string(node),
+			as_error_set_prefix(err, status, as_node_get_address_string(node),
 							as_error_string(status));
 			if (val) {
 				*val = 0;
@@ -1789,7 +3408,7 @@ as_command_parse_deadline(as_error* err, as_command* cmd, as_node* node, uint8_t
 	status = msg->result_code;
 
 	if (status != AEROSPIKE_OK) {
-		return as_error_update(err, status, "%s %s", as_node_get_address_string(node),
+		return as_error_set_prefix(err, status, as_node_get_address_string(node),
 			as_error_string(status));
 	}
 
@@ -0,0 +1,448 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_compress.h>
+#include <aerospike/as_proto.h>
+#include <citrusleaf/alloc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#if defined(AS_USE_LZ4)
+#include <lz4.h>
+#endif
+
+#if defined(AS_USE_ZSTD)
+#include <zstd.h>
+#endif
+
+//---------------------------------
+// Types
+//---------------------------------
+
+struct as_compress_dict_s {
+	struct as_compress_dict_s* next;
+	char* path;
+#if defined(AS_USE_ZSTD)
+	ZSTD_CDict* cdict;
+	ZSTD_DDict* ddict;
+#endif
+	uint32_t id;
+	uint32_t ref_count;
+};
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+// Dictionaries are shared by all aerospike instances in the process.
+static pthread_mutex_t as_compress_dict_lock = PTHREAD_MUTEX_INITIALIZER;
+static as_compress_dict* as_compress_dict_list = NULL;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static as_status
+as_compress_disabled(as_error* err, as_compress_codec codec)
+{
+	return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Compression codec %s is not enabled",
+		as_compress_codec_name(codec));
+}
+
+#if defined(AS_USE_ZSTD)
+
+static as_status
+as_compress_dict_read(as_error* err, const char* path, uint8_t** buf, size_t* size)
+{
+	FILE* fp = fopen(path, "rb");
+
+	if (! fp) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Failed to open dictionary: %s", path);
+	}
+
+	if (fseek(fp, 0, SEEK_END) != 0) {
+		fclose(fp);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Failed to read dictionary: %s", path);
+	}
+
+	long len = ftell(fp);
+
+	if (len <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Failed to read dictionary: %s", path);
+	}
+
+	uint8_t* data = cf_malloc(len);
+	size_t rv = fread(data, 1, len, fp);
+	fclose(fp);
+
+	if (rv != (size_t)len) {
+		cf_free(data);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Failed to read dictionary: %s", path);
+	}
+
+	*buf = data;
+	*size = rv;
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_compress_dict_load(as_error* err, const char* path, as_compress_dict** dict)
+{
+	uint8_t* buf;
+	size_t size;
+	as_status status = as_compress_dict_read(err, path, &buf, &size);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	uint32_t id = ZSTD_getDictID_fromDict(buf, size);
+
+	if (id == 0) {
+		cf_free(buf);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid zstd dictionary: %s", path);
+	}
+
+	// The digested dictionaries copy the dictionary content.
+	ZSTD_CDict* cdict = ZSTD_createCDict(buf, size, ZSTD_CLEVEL_DEFAULT);
+	ZSTD_DDict* ddict = ZSTD_createDDict(buf, size);
+	cf_free(buf);
+
+	if (! cdict || ! ddict) {
+		ZSTD_freeCDict(cdict);
+		ZSTD_freeDDict(ddict);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to load zstd dictionary: %s",
+			path);
+	}
+
+	as_compress_dict* d = cf_malloc(sizeof(as_compress_dict));
+	d->next = NULL;
+	d->path = cf_strdup(path);
+	d->cdict = cdict;
+	d->ddict = ddict;
+	d->id = id;
+	d->ref_count = 1;
+	*dict = d;
+	return AEROSPIKE_OK;
+}
+
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+const char*
+as_compress_codec_name(as_compress_codec codec)
+{
+	switch (codec) {
+		case AS_COMPRESS_ZLIB:
+			return "zlib";
+		case AS_COMPRESS_LZ4:
+			return "lz4";
+		case AS_COMPRESS_ZSTD:
+			return "zstd";
+		default:
+			return "unknown";
+	}
+}
+
+bool
+as_compress_codec_enabled(as_compress_codec codec)
+{
+	switch (codec) {
+		case AS_COMPRESS_ZLIB:
+			return true;
+#if defined(AS_USE_LZ4)
+		case AS_COMPRESS_LZ4:
+			return true;
+#endif
+#if defined(AS_USE_ZSTD)
+		case AS_COMPRESS_ZSTD:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+size_t
+as_compress_bound(size_t src_sz)
+{
+	size_t max = compressBound((uLong)src_sz);
+
+#if defined(AS_USE_LZ4)
+	size_t sz = (size_t)LZ4_compressBound((int)src_sz);
+
+	if (sz > max) {
+		max = sz;
+	}
+#endif
+
+#if defined(AS_USE_ZSTD)
+	size_t sz2 = ZSTD_compressBound(src_sz);
+
+	if (sz2 > max) {
+		max = sz2;
+	}
+#endif
+	return max;
+}
+
+as_status
+as_compress_data(
+	as_error* err, as_compress_codec codec, const uint8_t* src, size_t src_sz, uint8_t* trg,
+	size_t* trg_sz
+	)
+{
+	switch (codec) {
+		case AS_COMPRESS_ZLIB: {
+			uLongf sz = (uLongf)*trg_sz;
+			int rv = compress2(trg, &sz, src, (uLong)src_sz, Z_BEST_SPEED);
+
+			if (rv) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Compress failed: %d", rv);
+			}
+			*trg_sz = (size_t)sz;
+			return AEROSPIKE_OK;
+		}
+
+#if defined(AS_USE_LZ4)
+		case AS_COMPRESS_LZ4: {
+			int rv = LZ4_compress_default((const char*)src, (char*)trg, (int)src_sz, (int)*trg_sz);
+
+			if (rv <= 0) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT, "LZ4 compress failed: %d", rv);
+			}
+			*trg_sz = (size_t)rv;
+			return AEROSPIKE_OK;
+		}
+#endif
+
+#if defined(AS_USE_ZSTD)
+		case AS_COMPRESS_ZSTD: {
+			size_t rv = ZSTD_compress(trg, *trg_sz, src, src_sz, 1);
+
+			if (ZSTD_isError(rv)) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT, "zstd compress failed: %s",
+					ZSTD_getErrorName(rv));
+			}
+			*trg_sz = rv;
+			return AEROSPIKE_OK;
+		}
+#endif
+
+		default:
+			return as_compress_disabled(err, codec);
+	}
+}
+
+as_status
+as_decompress_data(
+	as_error* err, as_compress_codec codec, const uint8_t* src, size_t src_sz, uint8_t* trg,
+	size_t* trg_sz
+	)
+{
+	switch (codec) {
+		case AS_COMPRESS_ZLIB: {
+			uLongf sz = (uLongf)*trg_sz;
+			int rv = uncompress(trg, &sz, src, (uLong)src_sz);
+
+			if (rv != Z_OK) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Decompress failed: %d", rv);
+			}
+			*trg_sz = (size_t)sz;
+			return AEROSPIKE_OK;
+		}
+
+#if defined(AS_USE_LZ4)
+		case AS_COMPRESS_LZ4: {
+			int rv = LZ4_decompress_safe((const char*)src, (char*)trg, (int)src_sz, (int)*trg_sz);
+
+			if (rv < 0) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT, "LZ4 decompress failed: %d", rv);
+			}
+			*trg_sz = (size_t)rv;
+			return AEROSPIKE_OK;
+		}
+#endif
+
+#if defined(AS_USE_ZSTD)
+		case AS_COMPRESS_ZSTD: {
+			size_t rv = ZSTD_decompress(trg, *trg_sz, src, src_sz);
+
+			if (ZSTD_isError(rv)) {
+				return as_error_update(err, AEROSPIKE_ERR_CLIENT, "zstd decompress failed: %s",
+					ZSTD_getErrorName(rv));
+			}
+			*trg_sz = rv;
+			return AEROSPIKE_OK;
+		}
+#endif
+
+		default:
+			return as_compress_disabled(err, codec);
+	}
+}
+
+as_status
+as_compress_dict_acquire(as_error* err, const char* path, as_compress_dict** dict)
+{
+#if defined(AS_USE_ZSTD)
+	pthread_mutex_lock(&as_compress_dict_lock);
+
+	for (as_compress_dict* d = as_compress_dict_list; d; d = d->next) {
+		if (strcmp(d->path, path) == 0) {
+			d->ref_count++;
+			pthread_mutex_unlock(&as_compress_dict_lock);
+			*dict = d;
+			return AEROSPIKE_OK;
+		}
+	}
+
+	// Load while holding the lock, so the same file is never loaded twice.
+	as_status status = as_compress_dict_load(err, path, dict);
+
+	if (status == AEROSPIKE_OK) {
+		(*dict)->next = as_compress_dict_list;
+		as_compress_dict_list = *dict;
+	}
+	pthread_mutex_unlock(&as_compress_dict_lock);
+	return status;
+#else
+	return as_compress_disabled(err, AS_COMPRESS_ZSTD);
+#endif
+}
+
+void
+as_compress_dict_release(as_compress_dict* dict)
+{
+	pthread_mutex_lock(&as_compress_dict_lock);
+
+	if (--dict->ref_count > 0) {
+		pthread_mutex_unlock(&as_compress_dict_lock);
+		return;
+	}
+
+	as_compress_dict** prev = &as_compress_dict_list;
+
+	while (*prev != dict) {
+		prev = &(*prev)->next;
+	}
+	*prev = dict->next;
+	pthread_mutex_unlock(&as_compress_dict_lock);
+
+#if defined(AS_USE_ZSTD)
+	ZSTD_freeCDict(dict->cdict);
+	ZSTD_freeDDict(dict->ddict);
+#endif
+	cf_free(dict->path);
+	cf_free(dict);
+}
+
+uint32_t
+as_compress_dict_id(as_compress_dict* dict)
+{
+	return dict->id;
+}
+
+as_status
+as_compress_frame(
+	as_error* err, as_compress_dict* dict, const uint8_t* src, size_t src_sz, uint8_t** trg,
+	size_t* trg_sz
+	)
+{
+#if defined(AS_USE_ZSTD)
+	size_t capacity = ZSTD_compressBound(src_sz);
+	uint8_t* buf = cf_malloc(capacity);
+	ZSTD_CCtx* ctx = ZSTD_createCCtx();
+	size_t rv;
+
+	if (dict) {
+		rv = ZSTD_compress_usingCDict(ctx, buf, capacity, src, src_sz, dict->cdict);
+	}
+	else {
+		rv = ZSTD_compressCCtx(ctx, buf, capacity, src, src_sz, ZSTD_CLEVEL_DEFAULT);
+	}
+	ZSTD_freeCCtx(ctx);
+
+	if (ZSTD_isError(rv)) {
+		cf_free(buf);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "zstd compress failed: %s",
+			ZSTD_getErrorName(rv));
+	}
+
+	*trg = buf;
+	*trg_sz = rv;
+	return AEROSPIKE_OK;
+#else
+	return as_compress_disabled(err, AS_COMPRESS_ZSTD);
+#endif
+}
+
+uint32_t
+as_compress_frame_dict_id(const uint8_t* src, size_t src_sz)
+{
+#if defined(AS_USE_ZSTD)
+	return ZSTD_getDictID_fromFrame(src, src_sz);
+#else
+	return 0;
+#endif
+}
+
+as_status
+as_decompress_frame(
+	as_error* err, as_compress_dict* dict, const uint8_t* src, size_t src_sz, uint8_t** trg,
+	size_t* trg_sz
+	)
+{
+#if defined(AS_USE_ZSTD)
+	unsigned long long size = ZSTD_getFrameContentSize(src, src_sz);
+
+	if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN ||
+		size > PROTO_SIZE_MAX) {
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Invalid zstd frame");
+	}
+
+	// Allocate at least one byte, so an empty frame still returns a buffer.
+	uint8_t* buf = cf_malloc(size > 0 ? (size_t)size : 1);
+	ZSTD_DCtx* ctx = ZSTD_createDCtx();
+	size_t rv;
+
+	if (dict) {
+		rv = ZSTD_decompress_usingDDict(ctx, buf, (size_t)size, src, src_sz, dict->ddict);
+	}
+	else {
+		rv = ZSTD_decompressDCtx(ctx, buf, (size_t)size, src, src_sz);
+	}
+	ZSTD_freeDCtx(ctx);
+
+	if (ZSTD_isError(rv)) {
+		cf_free(buf);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "zstd decompress failed: %s",
+			ZSTD_getErrorName(rv));
+	}
+
+	*trg = buf;
+	*trg_sz = rv;
+	return AEROSPIKE_OK;
+#else
+	return as_compress_disabled(err, AS_COMPRESS_ZSTD);
+#endif
+}
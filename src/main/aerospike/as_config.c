@@ -35,23 +35,66 @@ as_config_init(as_config* c)
 	memset(c->password, 0, sizeof(c->password));
 	c->cluster_name = NULL;
 	c->app_id = NULL;
+	memset(c->latency_tags, 0, sizeof(c->latency_tags));
 	c->event_callback = NULL;
 	c->event_callback_udata = NULL;
+	c->trace_callback = NULL;
+	c->trace_udata = NULL;
+	c->trace_sample_rate = 1;
+	c->slow_command_ms = 0;
+	c->slow_command_log_size = 1024;
 	c->ip_map = NULL;
 	c->ip_map_size = 0;
 	c->min_conns_per_node = 0;
 	c->max_conns_per_node = 100;
+	c->warm_up_conns_per_tend = 0;
+	c->spare_conns_per_node = 0;
+	c->max_connects_per_node = 0;
 	c->async_min_conns_per_node = 0;
+	c->async_max_connects_per_loop = 0;
+	c->async_auto_batch_max = 0;
+	c->sync_over_async = false;
+	c->sync_over_async_pipeline = false;
+	c->async_offload_threshold = 0;
 	c->async_max_conns_per_node = 100;
+	c->async_borrow_conns = false;
 	c->pipe_max_conns_per_node = 64;
+	c->pipe_max_depth = 0;
+	c->pipe_large_response_size = 0;
 	c->conn_pools_per_node = 1;
+	c->conn_cache_size = 0;
+	c->sync_pipes_per_node = 0;
+	c->compress_codec = AS_COMPRESS_ZLIB;
 	c->conn_timeout_ms = 1000;
 	c->login_timeout_ms = 5000;
+	c->socket_busy_poll_us = 0;
+	as_socket_options_init(&c->socket_options);
 	c->max_socket_idle = 0;
+	c->conn_peak_window = 0;
+	c->conn_validate_window_ms = 0;
+	c->epoch_reclaim = false;
 	c->max_error_rate = 100;
 	c->error_rate_window = 1;
+	c->circuit_breaker_ratio = 0;
+	c->circuit_breaker_min_commands = 20;
+	c->circuit_breaker_probes = 10;
+	c->circuit_breaker_open_tends = 1;
+	c->circuit_breaker_max_open_tends = 32;
+	c->concurrency_limit_max = 0;
+	c->concurrency_limit_min = 10;
+	c->retry_budget_tokens = 0;
+	c->retry_budget_refill_pct = 10;
 	c->tender_interval = 1000;
+	c->tender_interval_max = 0;
 	c->thread_pool_size = 16;
+	c->shared_threads = NULL;
+	c->command_buffer_cache_max = 0;
+	c->memory_budget = 0;
+	c->memory_budget_wait = 0;
+	c->coarse_clock = false;
+	memset(&c->allocator, 0, sizeof(as_allocator));
+	c->dns_cache_ttl = 0;
+	c->tend_slow_threshold = 0;
 	c->tend_thread_cpu = -1;
 	as_policies_init(&c->policies);
 	c->config_provider.path = NULL;
@@ -60,16 +103,23 @@ as_config_init(as_config* c)
 	memset(&c->tls, 0, sizeof(as_config_tls));
 	c->auth_mode = AS_AUTH_INTERNAL;
 	c->fail_if_not_connected = true;
+	c->seed_parallel = false;
+	c->fast_start = false;
 	c->use_services_alternate = false;
 	c->force_single_node = false;
 	c->rack_aware = false;
 	c->rack_id = 0;
 	c->rack_ids = NULL;
+	c->compress_dicts = NULL;
+	c->quotas = NULL;
+	c->snapshot_path = NULL;
 	c->use_shm = false;
 	c->shm_key = 0xA9000000;
 	c->shm_max_nodes = 16;
 	c->shm_max_namespaces = 8;
 	c->shm_takeover_threshold_sec = 30;
+	c->shm_huge_pages = false;
+	c->shm_metrics_slots = 0;
 	return c;
 }
 
@@ -93,6 +143,25 @@ as_config_destroy(as_config* config) {
 		as_vector_destroy(config->rack_ids);
 	}
 
+	as_vector* dicts = config->compress_dicts;
+
+	if (dicts) {
+		for (uint32_t i = 0; i < dicts->size; i++) {
+			as_config_compress_dict* dict = as_vector_get(dicts, i);
+			cf_free(dict->ns);
+
+			if (dict->set) {
+				cf_free(dict->set);
+			}
+			cf_free(dict->path);
+		}
+		as_vector_destroy(dicts);
+	}
+
+	if (config->quotas) {
+		as_config_destroy_quotas(config->quotas);
+	}
+
 	if (config->cluster_name) {
 		cf_free(config->cluster_name);
 	}
@@ -101,6 +170,16 @@ as_config_destroy(as_config* config) {
 		cf_free(config->app_id);
 	}
 
+	for (uint32_t i = 0; i < AS_LATENCY_TAG_MAX; i++) {
+		if (config->latency_tags[i]) {
+			cf_free(config->latency_tags[i]);
+		}
+	}
+
+	if (config->snapshot_path) {
+		cf_free(config->snapshot_path);
+	}
+
 	if (config->config_provider.path) {
 		cf_free(config->config_provider.path);
 	}
@@ -364,6 +443,71 @@ as_config_add_rack_id(as_config* config, int rack_id)
 	as_vector_append(config->rack_ids, &rack_id);
 }
 
+void
+as_config_add_compress_dict(as_config* config, const char* ns, const char* set, const char* path)
+{
+	if (! config->compress_dicts) {
+		config->compress_dicts = as_vector_create(sizeof(as_config_compress_dict), 4);
+	}
+
+	as_config_compress_dict* dict = as_vector_reserve(config->compress_dicts);
+	dict->ns = cf_strdup(ns);
+	dict->set = (set && *set) ? cf_strdup(set) : NULL;
+	dict->path = cf_strdup(path);
+}
+
+void
+as_config_add_quota(
+	as_config* config, const char* ns, const char* set, as_quota_type type, uint32_t rate,
+	uint32_t burst, as_quota_mode mode
+	)
+{
+	if (! config->quotas) {
+		config->quotas = as_vector_create(sizeof(as_config_quota), 4);
+	}
+
+	as_config_quota* quota = as_vector_reserve(config->quotas);
+	quota->ns = cf_strdup(ns);
+	quota->set = (set && *set) ? cf_strdup(set) : NULL;
+	quota->type = type;
+	quota->mode = mode;
+	quota->rate = rate;
+	quota->burst = burst;
+}
+
+as_vector*
+as_config_copy_quotas(as_vector* quotas)
+{
+	if (! quotas) {
+		return NULL;
+	}
+
+	as_vector* list = as_vector_create(sizeof(as_config_quota), quotas->size);
+
+	for (uint32_t i = 0; i < quotas->size; i++) {
+		as_config_quota* src = as_vector_get(quotas, i);
+		as_config_quota* trg = as_vector_reserve(list);
+		*trg = *src;
+		trg->ns = cf_strdup(src->ns);
+		trg->set = src->set ? cf_strdup(src->set) : NULL;
+	}
+	return list;
+}
+
+void
+as_config_destroy_quotas(as_vector* quotas)
+{
+	for (uint32_t i = 0; i < quotas->size; i++) {
+		as_config_quota* quota = as_vector_get(quotas, i);
+		cf_free(quota->ns);
+
+		if (quota->set) {
+			cf_free(quota->set);
+		}
+	}
+	as_vector_destroy(quotas);
+}
+
 void
 as_config_set_string(char** str, const char* value)
 {
@@ -417,4 +561,25 @@ as_config_massage_error_rate(as_config* config)
 			"Invalid circuit breaker configuration: max_error_rate: %u, error_rate_window: %u, ratio: %.2f. The ratio (max_error_rate/error_rate_window) must be between 1 and 100. Resetting to defaults - max_error_rate: %u and error_rate_window: %u",
 			mer, erw, ratio, config->max_error_rate, config->error_rate_window);
 	}
+
+	if (config->circuit_breaker_ratio > 100) {
+		config->circuit_breaker_ratio = 100;
+	}
+
+	if (config->circuit_breaker_open_tends == 0) {
+		config->circuit_breaker_open_tends = 1;
+	}
+
+	if (config->circuit_breaker_max_open_tends < config->circuit_breaker_open_tends) {
+		config->circuit_breaker_max_open_tends = config->circuit_breaker_open_tends;
+	}
+
+	if (config->concurrency_limit_min == 0) {
+		config->concurrency_limit_min = 1;
+	}
+
+	if (config->concurrency_limit_max > 0 &&
+		config->concurrency_limit_min > config->concurrency_limit_max) {
+		config->concurrency_limit_min = config->concurrency_limit_max;
+	}
 }
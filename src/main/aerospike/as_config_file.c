@@ -436,6 +436,168 @@ as_parse_vector_int32(as_yaml* yaml, const char* name, as_vector** out, uint32_t
 	return true;
 }
 
+static bool
+as_parse_quota(as_yaml* yaml, as_vector* list)
+{
+	as_namespace ns = {0};
+	as_set set = {0};
+	as_quota_type type = AS_QUOTA_READ;
+	as_quota_mode mode = AS_QUOTA_REJECT;
+	uint32_t rate = 0;
+	uint32_t burst = 0;
+	char name[256];
+	char value[256];
+
+	while (as_parse_scalar(yaml, name, sizeof(name))) {
+		if (!as_parse_scalar(yaml, value, sizeof(value))) {
+			return false;
+		}
+
+		bool rv = true;
+
+		if (strcmp(name, "namespace") == 0) {
+			as_strncpy(ns, value, sizeof(ns));
+		}
+		else if (strcmp(name, "set") == 0) {
+			as_strncpy(set, value, sizeof(set));
+		}
+		else if (strcmp(name, "type") == 0) {
+			if (strcmp(value, "read") == 0) {
+				type = AS_QUOTA_READ;
+			}
+			else if (strcmp(value, "write") == 0) {
+				type = AS_QUOTA_WRITE;
+			}
+			else if (strcmp(value, "scan") == 0) {
+				type = AS_QUOTA_SCAN;
+			}
+			else {
+				as_error_update(&yaml->err, AEROSPIKE_ERR_PARAM, "Invalid quota type: %s", value);
+				return false;
+			}
+		}
+		else if (strcmp(name, "mode") == 0) {
+			if (strcmp(value, "reject") == 0) {
+				mode = AS_QUOTA_REJECT;
+			}
+			else if (strcmp(value, "wait") == 0) {
+				mode = AS_QUOTA_WAIT;
+			}
+			else {
+				as_error_update(&yaml->err, AEROSPIKE_ERR_PARAM, "Invalid quota mode: %s", value);
+				return false;
+			}
+		}
+		else if (strcmp(name, "rate") == 0) {
+			rv = parse_uint32(yaml, name, value, 1, UINT32_MAX, &rate);
+		}
+		else if (strcmp(name, "burst") == 0) {
+			rv = parse_uint32(yaml, name, value, 0, UINT32_MAX, &burst);
+		}
+		else {
+			as_log_info("Unexpected field: %s.quotas.%s", yaml->name, name);
+		}
+
+		if (!rv) {
+			return false;
+		}
+	}
+
+	if (! ns[0] || rate == 0) {
+		as_error_update(&yaml->err, AEROSPIKE_ERR_PARAM, "Quota requires namespace and rate");
+		return false;
+	}
+
+	as_config_quota* quota = as_vector_reserve(list);
+	quota->ns = cf_strdup(ns);
+	quota->set = set[0] ? cf_strdup(set) : NULL;
+	quota->type = type;
+	quota->mode = mode;
+	quota->rate = rate;
+	quota->burst = burst;
+	return true;
+}
+
+static bool
+as_parse_quotas(as_yaml* yaml, const char* name, as_vector** out, uint32_t field)
+{
+	static const char* types[] = {"read", "write", "scan"};
+	static const char* modes[] = {"reject", "wait"};
+
+	as_vector* list = as_vector_create(sizeof(as_config_quota), 4);
+
+	while (true) {
+		if (!as_parse_next(yaml)) {
+			as_config_destroy_quotas(list);
+			return false;
+		}
+
+		yaml_event_type_t type = yaml->event.type;
+
+		if (type == YAML_SEQUENCE_END_EVENT) {
+			yaml_event_delete(&yaml->event);
+			break;
+		}
+
+		if (type != YAML_MAPPING_START_EVENT) {
+			as_expected_error(yaml, YAML_MAPPING_START_EVENT);
+			yaml_event_delete(&yaml->event);
+			as_config_destroy_quotas(list);
+			return false;
+		}
+
+		yaml_event_delete(&yaml->event);
+
+		if (!as_parse_quota(yaml, list)) {
+			as_config_destroy_quotas(list);
+			return false;
+		}
+	}
+
+	as_string_builder sb;
+	as_string_builder_inita(&sb, 512, false);
+
+	as_string_builder_append(&sb, "Set ");
+	as_string_builder_append(&sb, yaml->name);
+	as_string_builder_append_char(&sb, '.');
+	as_string_builder_append(&sb, name);
+	as_string_builder_append(&sb, " = [");
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_config_quota* quota = as_vector_get(list, i);
+
+		if (i > 0) {
+			as_string_builder_append_char(&sb, ',');
+		}
+		as_string_builder_append_char(&sb, '[');
+		as_string_builder_append(&sb, quota->ns);
+
+		if (quota->set) {
+			as_string_builder_append_char(&sb, '.');
+			as_string_builder_append(&sb, quota->set);
+		}
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append(&sb, types[quota->type]);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, quota->rate);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, quota->burst);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append(&sb, modes[quota->mode]);
+		as_string_builder_append_char(&sb, ']');
+	}
+
+	as_string_builder_append_char(&sb, ']');
+	as_log_info(sb.data);
+
+	// Original vector will still exist and will be restored if
+	// there is an error while parsing the file.
+	*out = list;
+
+	as_field_set(yaml->bitmap, field);
+	return true;
+}
+
 static inline void
 as_assign_read_mode_ap(
 	const char* section, const char* name, const char* value, as_policy_read_mode_ap src,
@@ -548,6 +710,9 @@ as_parse_replica(
 	else if (strcmp(value, "RANDOM") == 0) {
 		val = AS_POLICY_REPLICA_RANDOM;
 	}
+	else if (strcmp(value, "LOWEST_LATENCY") == 0) {
+		val = AS_POLICY_REPLICA_LOWEST_LATENCY;
+	}
 	else {
 		as_error_update(&yaml->err, AEROSPIKE_ERR_PARAM, "Invalid %s: %s", name, value);
 		return false;
@@ -1340,6 +1505,9 @@ as_parse_dynamic_client(as_yaml* yaml)
 			if (strcmp(name, "rack_ids") == 0) {
 				rv = as_parse_vector_int32(yaml, name, &yaml->config->rack_ids, AS_RACK_IDS);
 			}
+			else if (strcmp(name, "quotas") == 0) {
+				rv = as_parse_quotas(yaml, name, &yaml->config->quotas, AS_QUOTAS);
+			}
 			else {
 				as_log_info("Unexpected sequence: %s.%s", yaml->name, name);
 				as_skip_sequence(yaml);
@@ -1617,6 +1785,12 @@ as_release_rack_ids(as_vector* rack_ids)
 	as_vector_destroy(rack_ids);
 }
 
+static void
+as_release_quotas(as_quotas* quotas)
+{
+	cf_free(quotas);
+}
+
 static void
 as_rack_ids_copy(as_vector* src, as_vector** trg)
 {
@@ -1917,6 +2091,29 @@ as_str_eq(const char* s1, const char* s2)
 	return strcmp(s1, s2) == 0;
 }
 
+static void
+as_config_snapshot_publish(aerospike* as)
+{
+	as_config_snapshot* current = as->config_snapshot;
+
+	if (current && memcmp(&current->config, &as->config, sizeof(as_config)) == 0 &&
+		memcmp(current->bitmap, as->config_bitmap, AS_CONFIG_BITMAP_SIZE) == 0) {
+		// Config did not change.
+		return;
+	}
+
+	// Heap allocated config fields are shared with as->config. Commands only reference
+	// the policies of older snapshots, so those snapshots are retained until
+	// aerospike_destroy() instead of being released by the cluster garbage collector.
+	as_config_snapshot* snapshot = cf_malloc(sizeof(as_config_snapshot) + AS_CONFIG_BITMAP_SIZE);
+	memcpy(&snapshot->config, &as->config, sizeof(as_config));
+	snapshot->bitmap = (uint8_t*)(snapshot + 1);
+	memcpy(snapshot->bitmap, as->config_bitmap, AS_CONFIG_BITMAP_SIZE);
+	snapshot->prev = current;
+
+	as_store_ptr_rls((void**)&as->config_snapshot, snapshot);
+}
+
 static as_status
 as_cluster_update(
 	aerospike* as, as_config* orig, as_config* src, uint8_t* bitmap, as_error* err
@@ -1968,6 +2165,24 @@ as_cluster_update(
 		}
 	}
 
+	if (as_field_is_set(bitmap, AS_QUOTAS)) {
+		if (config->quotas != src->quotas) {
+			// Commands only access cluster quotas.
+			if (config->quotas && config->quotas != orig->quotas) {
+				as_config_destroy_quotas(config->quotas);
+			}
+			config->quotas = src->quotas;
+		}
+	}
+	else {
+		if (config->quotas != orig->quotas) {
+			if (config->quotas) {
+				as_config_destroy_quotas(config->quotas);
+			}
+			config->quotas = as_config_copy_quotas(orig->quotas);
+		}
+	}
+
 	if (as_field_is_set(bitmap, AS_APP_ID)) {
 		if (!as_str_eq(config->app_id, src->app_id)) {
 			// app_id is referenced in metrics and user agent on tend connection.
@@ -2026,6 +2241,7 @@ as_cluster_update(
 
 		// Update cluster rack_ids.
 		as_store_ptr_rls((void**)&cluster->rack_ids, rack_ids);
+		as_incr_uint32(&cluster->racks_gen);
 
 		// Eventually destroy old cluster rack_ids.
 		as_gc_item item;
@@ -2034,11 +2250,30 @@ as_cluster_update(
 		as_vector_append(cluster->gc, &item);
 	}
 
+	if (!as_quotas_equal(cluster->quotas, config->quotas)) {
+		as_quotas* old = cluster->quotas;
+
+		// New buckets start full.
+		as_store_ptr_rls((void**)&cluster->quotas, as_quotas_create(config->quotas));
+
+		if (old) {
+			// Eventually destroy old cluster quotas.
+			as_gc_item item;
+			item.data = old;
+			item.release_fn = (as_release_fn)as_release_quotas;
+			as_vector_append(cluster->gc, &item);
+		}
+	}
+
 	as_cluster_update_policies(&orig->policies, &src->policies, &config->policies, bitmap);
-	memcpy(as->config_bitmap, bitmap, sizeof(AS_CONFIG_BITMAP_SIZE));
+	memcpy(as->config_bitmap, bitmap, AS_CONFIG_BITMAP_SIZE);
 
-	return as_cluster_update_metrics(cluster, err, &orig->policies.metrics,
+	as_status status = as_cluster_update_metrics(cluster, err, &orig->policies.metrics,
 		&src->policies.metrics, &config->policies.metrics, bitmap);
+
+	// Commands switch to the new policies in one step.
+	as_config_snapshot_publish(as);
+	return status;
 }
 
 //---------------------------------
@@ -2065,6 +2300,10 @@ as_config_file_init(aerospike* as, as_error* err)
 			as_vector_destroy(config->rack_ids);
 		}
 
+		if (config->quotas != as->config_orig->quotas) {
+			as_config_destroy_quotas(config->quotas);
+		}
+
 		if (config->app_id != as->config_orig->app_id) {
 			cf_free(config->app_id);
 		}
@@ -2076,6 +2315,8 @@ as_config_file_init(aerospike* as, as_error* err)
 		// Restore original config.
 		memcpy(&as->config, as->config_orig, sizeof(as_config));
 	}
+
+	as_config_snapshot_publish(as);
 	return status;
 }
 
@@ -2090,6 +2331,7 @@ as_config_file_update(aerospike* as, as_error* err)
 	// Start with empty vectors.
 	config.app_id = NULL;
 	config.rack_ids = NULL;
+	config.quotas = NULL;
 	config.policies.metrics.labels = NULL;
 
 	uint8_t bitmap[AS_CONFIG_BITMAP_SIZE];
@@ -2103,6 +2345,10 @@ as_config_file_update(aerospike* as, as_error* err)
 			as_vector_destroy(config.rack_ids);
 		}
 
+		if (config.quotas) {
+			as_config_destroy_quotas(config.quotas);
+		}
+
 		if (config.app_id) {
 			cf_free(config.app_id);
 		}
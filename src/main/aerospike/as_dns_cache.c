@@ -0,0 +1,354 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_dns_cache.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <citrusleaf/cf_clock.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Maximum time the resolver thread sleeps between scans of the cache.
+#define AS_DNS_CACHE_WAIT_MS 1000
+
+// Delay before resolving a hostname again after a failed refresh.
+#define AS_DNS_CACHE_RETRY_MS 1000
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static bool
+as_dns_is_numeric(const char* hostname)
+{
+	struct in_addr ipv4;
+
+	if (inet_pton(AF_INET, hostname, &ipv4) == 1) {
+		return true;
+	}
+
+	struct in6_addr ipv6;
+	return inet_pton(AF_INET6, hostname, &ipv6) == 1;
+}
+
+static void
+as_dns_copy_addresses(
+	struct addrinfo* addresses, struct sockaddr_storage** addrs_out, uint32_t* size_out
+	)
+{
+	uint32_t size = 0;
+
+	for (struct addrinfo* ai = addresses; ai; ai = ai->ai_next) {
+		if (ai->ai_family == AF_INET || ai->ai_family == AF_INET6) {
+			size++;
+		}
+	}
+
+	struct sockaddr_storage* addrs = size ? cf_malloc(sizeof(struct sockaddr_storage) * size) : NULL;
+	uint32_t i = 0;
+
+	for (struct addrinfo* ai = addresses; ai; ai = ai->ai_next) {
+		if (ai->ai_family == AF_INET || ai->ai_family == AF_INET6) {
+			memset(&addrs[i], 0, sizeof(struct sockaddr_storage));
+			memcpy(&addrs[i], ai->ai_addr, ai->ai_addrlen);
+			i++;
+		}
+	}
+	*addrs_out = addrs;
+	*size_out = size;
+}
+
+static as_status
+as_dns_resolve(as_dns_cache* cache, as_error* err, const char* hostname, struct addrinfo** addresses)
+{
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	uint64_t begin = cf_getns();
+	int ret = getaddrinfo(hostname, NULL, &hints, addresses);
+
+	as_incr_uint64(&cache->lookups);
+	as_faa_uint64(&cache->lookup_ns, cf_getns() - begin);
+
+	if (ret) {
+		as_incr_uint64(&cache->lookup_errors);
+		return as_error_update(err, AEROSPIKE_ERR_INVALID_HOST, "Invalid hostname %s: %s",
+							   hostname, gai_strerror(ret));
+	}
+	return AEROSPIKE_OK;
+}
+
+// Must hold cache lock.
+static as_dns_entry*
+as_dns_find(as_dns_cache* cache, const char* hostname)
+{
+	for (as_dns_entry* entry = cache->entries; entry; entry = entry->next) {
+		if (strcmp(entry->name, hostname) == 0) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+// Must hold cache lock.
+static void
+as_dns_iterator_init(as_dns_entry* entry, as_address_iterator* iter, uint16_t port)
+{
+	// Give each iterator its own copy, because as_lookup_next() assigns the port in place.
+	uint32_t size = entry->addrs_size;
+	struct addrinfo* ai = cf_malloc((sizeof(struct addrinfo) + sizeof(struct sockaddr_storage)) * size);
+	struct sockaddr_storage* addrs = (struct sockaddr_storage*)(ai + size);
+
+	memcpy(addrs, entry->addrs, sizeof(struct sockaddr_storage) * size);
+	memset(ai, 0, sizeof(struct addrinfo) * size);
+
+	for (uint32_t i = 0; i < size; i++) {
+		ai[i].ai_family = addrs[i].ss_family;
+		ai[i].ai_socktype = SOCK_STREAM;
+		ai[i].ai_protocol = IPPROTO_TCP;
+		ai[i].ai_addrlen = (addrs[i].ss_family == AF_INET)?
+			sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+		ai[i].ai_addr = (struct sockaddr*)&addrs[i];
+		ai[i].ai_next = (i + 1 < size)? &ai[i + 1] : NULL;
+	}
+
+	iter->addresses = ai;
+	iter->current = ai;
+	iter->port_be = cf_swap_to_be16(port);
+	iter->hostname_is_alias = true;
+	iter->cached = true;
+}
+
+static void*
+as_dns_cache_run(void* udata)
+{
+	as_dns_cache* cache = udata;
+
+	pthread_mutex_lock(&cache->lock);
+
+	while (cache->valid) {
+		uint64_t now = cf_getms();
+		uint64_t next = now + AS_DNS_CACHE_WAIT_MS;
+		as_dns_entry* prev = NULL;
+		as_dns_entry* entry = cache->entries;
+
+		// Entries are only removed by this thread and new entries are inserted at the head,
+		// so prev and entry remain valid while the lock is released.
+		while (entry && cache->valid) {
+			if (entry->expires_ms > now) {
+				if (entry->expires_ms < next) {
+					next = entry->expires_ms;
+				}
+				prev = entry;
+				entry = entry->next;
+				continue;
+			}
+
+			if (! entry->used) {
+				// Not looked up since last resolution.
+				as_dns_entry* remove = entry;
+				entry = entry->next;
+
+				if (prev) {
+					prev->next = entry;
+				}
+				else {
+					cache->entries = entry;
+				}
+				cf_free(remove->addrs);
+				cf_free(remove);
+				continue;
+			}
+
+			entry->used = false;
+			pthread_mutex_unlock(&cache->lock);
+
+			as_error err;
+			as_error_init(&err);
+
+			struct addrinfo* addresses = NULL;
+			struct sockaddr_storage* addrs = NULL;
+			uint32_t addrs_size = 0;
+			as_status status = as_dns_resolve(cache, &err, entry->name, &addresses);
+
+			if (status == AEROSPIKE_OK) {
+				as_dns_copy_addresses(addresses, &addrs, &addrs_size);
+				freeaddrinfo(addresses);
+			}
+
+			pthread_mutex_lock(&cache->lock);
+			now = cf_getms();
+
+			if (status == AEROSPIKE_OK && addrs_size > 0) {
+				cf_free(entry->addrs);
+				entry->addrs = addrs;
+				entry->addrs_size = addrs_size;
+				entry->expires_ms = now + cache->ttl_ms;
+			}
+			else {
+				// Keep serving the previous addresses until the hostname resolves again.
+				as_log_warn("DNS refresh failed for %s: %s", entry->name, err.message);
+				cf_free(addrs);
+				entry->expires_ms = now + AS_DNS_CACHE_RETRY_MS;
+			}
+
+			if (entry->expires_ms < next) {
+				next = entry->expires_ms;
+			}
+			prev = entry;
+			entry = entry->next;
+		}
+
+		if (! cache->valid) {
+			break;
+		}
+
+		now = cf_getms();
+
+		if (next > now) {
+			struct timespec delta;
+			struct timespec abstime;
+			cf_clock_set_timespec_ms((uint32_t)(next - now), &delta);
+			cf_clock_current_add(&delta, &abstime);
+			pthread_cond_timedwait(&cache->cond, &cache->lock, &abstime);
+		}
+	}
+	pthread_mutex_unlock(&cache->lock);
+	return NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_dns_cache*
+as_dns_cache_create(uint32_t ttl_sec)
+{
+	as_dns_cache* cache = cf_malloc(sizeof(as_dns_cache));
+	memset(cache, 0, sizeof(as_dns_cache));
+	pthread_mutex_init(&cache->lock, NULL);
+	pthread_cond_init(&cache->cond, NULL);
+	cache->ttl_ms = ttl_sec * 1000;
+	cache->valid = true;
+
+	if (pthread_create(&cache->thread, NULL, as_dns_cache_run, cache) != 0) {
+		as_log_warn("Failed to create DNS cache thread. Hostnames will not be cached.");
+		pthread_cond_destroy(&cache->cond);
+		pthread_mutex_destroy(&cache->lock);
+		cf_free(cache);
+		return NULL;
+	}
+	return cache;
+}
+
+void
+as_dns_cache_destroy(as_dns_cache* cache)
+{
+	pthread_mutex_lock(&cache->lock);
+	cache->valid = false;
+	pthread_cond_signal(&cache->cond);
+	pthread_mutex_unlock(&cache->lock);
+	pthread_join(cache->thread, NULL);
+
+	as_dns_entry* entry = cache->entries;
+
+	while (entry) {
+		as_dns_entry* next = entry->next;
+		cf_free(entry->addrs);
+		cf_free(entry);
+		entry = next;
+	}
+	pthread_cond_destroy(&cache->cond);
+	pthread_mutex_destroy(&cache->lock);
+	cf_free(cache);
+}
+
+as_status
+as_dns_cache_lookup(
+	as_dns_cache* cache, as_address_iterator* iter, as_error* err, const char* hostname,
+	uint16_t port
+	)
+{
+	if (as_dns_is_numeric(hostname)) {
+		return as_lookup_host(iter, err, hostname, port);
+	}
+
+	pthread_mutex_lock(&cache->lock);
+
+	as_dns_entry* entry = as_dns_find(cache, hostname);
+
+	if (entry) {
+		// Expired addresses are served until the resolver thread replaces them.
+		entry->used = true;
+		as_dns_iterator_init(entry, iter, port);
+		pthread_mutex_unlock(&cache->lock);
+		as_incr_uint64(&cache->hits);
+		return AEROSPIKE_OK;
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	// First lookup of this hostname must wait for DNS.
+	as_incr_uint64(&cache->misses);
+
+	struct addrinfo* addresses;
+	as_status status = as_dns_resolve(cache, err, hostname, &addresses);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	struct sockaddr_storage* addrs;
+	uint32_t addrs_size;
+	as_dns_copy_addresses(addresses, &addrs, &addrs_size);
+
+	if (addrs_size > 0) {
+		size_t len = strlen(hostname) + 1;
+		as_dns_entry* add = cf_malloc(sizeof(as_dns_entry) + len);
+		add->addrs = addrs;
+		add->addrs_size = addrs_size;
+		add->expires_ms = cf_getms() + cache->ttl_ms;
+		add->used = false;
+		memcpy(add->name, hostname, len);
+
+		pthread_mutex_lock(&cache->lock);
+
+		if (as_dns_find(cache, hostname)) {
+			// Another thread added the same hostname.
+			pthread_mutex_unlock(&cache->lock);
+			cf_free(add->addrs);
+			cf_free(add);
+		}
+		else {
+			add->next = cache->entries;
+			cache->entries = add;
+			pthread_mutex_unlock(&cache->lock);
+		}
+	}
+
+	iter->addresses = addresses;
+	iter->current = addresses;
+	iter->port_be = cf_swap_to_be16(port);
+	iter->hostname_is_alias = true;
+	iter->cached = false;
+	return AEROSPIKE_OK;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_epoch.h>
+#include <citrusleaf/alloc.h>
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+uint64_t as_epoch_global = 1;
+pthread_key_t as_epoch_key;
+
+//---------------------------------
+// Static Variables
+//---------------------------------
+
+static pthread_once_t as_epoch_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t as_epoch_lock = PTHREAD_MUTEX_INITIALIZER;
+static as_epoch_record* as_epoch_records = NULL;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_epoch_unregister(void* data)
+{
+	// Thread exited. Make record available to new threads.
+	as_epoch_record* rec = data;
+	rec->depth = 0;
+	as_store_uint64(&rec->epoch, 0);
+	as_store_uint8_rls(&rec->used, 0);
+}
+
+static void
+as_epoch_init_key(void)
+{
+	pthread_key_create(&as_epoch_key, as_epoch_unregister);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_epoch_init(void)
+{
+	pthread_once(&as_epoch_once, as_epoch_init_key);
+}
+
+as_epoch_record*
+as_epoch_register(void)
+{
+	pthread_mutex_lock(&as_epoch_lock);
+
+	as_epoch_record* rec = as_epoch_records;
+
+	while (rec && as_load_uint8(&rec->used)) {
+		rec = rec->next;
+	}
+
+	if (! rec) {
+		// Records are pushed at the head and never removed, so as_epoch_min() can walk the
+		// list without holding the lock.
+		rec = cf_malloc(sizeof(as_epoch_record));
+		rec->epoch = 0;
+		rec->depth = 0;
+		rec->used = 1;
+		rec->next = as_epoch_records;
+		as_store_ptr_rls((void**)&as_epoch_records, rec);
+	}
+	else {
+		rec->used = 1;
+	}
+	pthread_mutex_unlock(&as_epoch_lock);
+
+	pthread_setspecific(as_epoch_key, rec);
+	return rec;
+}
+
+uint64_t
+as_epoch_advance(void)
+{
+	return as_faa_uint64(&as_epoch_global, 1);
+}
+
+uint64_t
+as_epoch_min(void)
+{
+	uint64_t min = UINT64_MAX;
+
+	// Pairs with the fence in as_epoch_enter(). A thread that is not seen in a critical
+	// section here must see all retirements that happened before as_epoch_advance().
+	as_fence_seq();
+
+	as_epoch_record* rec = as_load_ptr((void* const*)&as_epoch_records);
+
+	while (rec) {
+		uint64_t epoch = as_load_uint64(&rec->epoch);
+
+		if (epoch != 0 && epoch < min) {
+			min = epoch;
+		}
+		rec = rec->next;
+	}
+	return min;
+}
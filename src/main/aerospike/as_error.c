@@ -33,6 +33,8 @@ as_error_string(as_status status)
 		CASE_ASSIGN(AEROSPIKE_OK);
 		CASE_ASSIGN(AEROSPIKE_QUERY_END);
 
+		CASE_ASSIGN(AEROSPIKE_ERR_MEMORY_BUDGET);
+		CASE_ASSIGN(AEROSPIKE_CLIENT_QUOTA_EXCEEDED);
 		CASE_ASSIGN(AEROSPIKE_METRICS_CONFLICT);
 		CASE_ASSIGN(AEROSPIKE_TXN_ALREADY_ABORTED);
 		CASE_ASSIGN(AEROSPIKE_TXN_ALREADY_COMMITTED);
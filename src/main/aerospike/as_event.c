@@ -17,17 +17,38 @@
 #include <aerospike/as_event.h>
 #include <aerospike/as_event_internal.h>
 #include <aerospike/as_admin.h>
+#include <aerospike/as_async.h>
+#include <aerospike/as_async_cancel.h>
+#include <aerospike/as_async_flow.h>
 #include <aerospike/as_command.h>
+#include <aerospike/as_cpu.h>
+#include <aerospike/as_hot_keys.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_monitor.h>
+#include <aerospike/as_partition_heat.h>
 #include <aerospike/as_pipe.h>
 #include <aerospike/as_proto.h>
 #include <aerospike/as_query_validate.h>
 #include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_slow_log.h>
 #include <aerospike/as_txn.h>
 #include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
 #include <pthread.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
 
 //---------------------------------
 // Macros
@@ -41,6 +62,19 @@
 #define as_in_event_loop(_t1) ((_t1).p == pthread_self().p)
 #endif
 
+// Release event loop decompression scratch buffer when unused for this period.
+#define AS_EVENT_DECOMPRESS_IDLE_MS 60000
+
+// Number of monitor probes in each maximum lag window.
+#define AS_EVENT_MONITOR_WINDOW 10
+
+// Initial number of commands run at once by an adaptive executor.
+#define AS_EVENT_ADAPTIVE_START 2
+
+// Event loop lag above which an adaptive executor reduces concurrency, unless the monitor
+// has its own lag threshold.
+#define AS_EVENT_ADAPTIVE_LAG_US 10000
+
 //---------------------------------
 // Globals
 //---------------------------------
@@ -53,10 +87,20 @@ int as_event_send_buffer_size = 0;
 int as_event_recv_buffer_size = 0;
 bool as_event_threads_created = false;
 bool as_event_single_thread = false;
+bool as_event_numa_routing = false;
+as_event_loop_selection as_event_selection = AS_EVENT_LOOP_SELECTION_ROUND_ROBIN;
 static pthread_mutex_t as_event_lock = PTHREAD_MUTEX_INITIALIZER;
 
+// NUMA node of each cpu and next event loop to use on each NUMA node.
+static int* as_event_cpu_nodes = NULL;
+static uint32_t as_event_cpu_nodes_size = 0;
+static as_event_loop** as_event_numa_current = NULL;
+
 as_status aerospike_library_init(as_error* err);
 int as_batch_retry_async(as_event_command* cmd, bool timeout);
+as_status as_batch_async_parse_block(as_event_command* cmd, as_error* err, bool* last);
+void as_batch_async_node_complete(as_event_command* cmd);
+void as_batch_hedge_async(as_event_command* cmd);
 
 //---------------------------------
 // Functions
@@ -68,29 +112,213 @@ as_event_validate_policy(as_error* err, as_policy_event* policy)
 	if (policy->max_commands_in_process < 0 || (policy->max_commands_in_process > 0 && policy->max_commands_in_process < 5)) {
 		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "max_commands_in_process %u must be 0 or >= 5", policy->max_commands_in_process);
 	}
+
+	for (uint32_t i = 0; i < policy->cpus_size; i++) {
+		if (policy->cpus[i] < 0) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Invalid event loop cpu: %d", policy->cpus[i]);
+		}
+	}
+
+	if (policy->numa_routing && policy->cpus_size == 0) {
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "numa_routing requires event loop cpus");
+	}
+
+	if ((uint32_t)policy->loop_selection > AS_EVENT_LOOP_SELECTION_NODE_AFFINITY) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Invalid loop_selection: %d", (int)policy->loop_selection);
+	}
 	return AEROSPIKE_OK;
 }
 
+#if defined(__linux__) && AS_EVENT_LIB_DEFINED
+
+static int
+as_event_read_cpu_node(uint32_t cpu)
+{
+	// The cpu directory contains a "node<n>" link for the NUMA node it belongs to.
+	char path[64];
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+	DIR* dir = opendir(path);
+
+	if (! dir) {
+		return -1;
+	}
+
+	int node = -1;
+	struct dirent* entry;
+
+	while ((entry = readdir(dir)) != NULL) {
+		int n;
+
+		if (sscanf(entry->d_name, "node%d", &n) == 1) {
+			node = n;
+			break;
+		}
+	}
+	closedir(dir);
+	return node;
+}
+
+static void
+as_event_init_numa(uint32_t capacity)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_CONF);
+
+	if (cpus <= 0) {
+		as_log_warn("Failed to determine cpu count. NUMA routing disabled.");
+		return;
+	}
+
+	as_event_cpu_nodes_size = (uint32_t)cpus;
+	as_event_cpu_nodes = cf_malloc(sizeof(int) * as_event_cpu_nodes_size);
+
+	int max_node = -1;
+
+	for (uint32_t i = 0; i < as_event_cpu_nodes_size; i++) {
+		int node = as_event_read_cpu_node(i);
+		as_event_cpu_nodes[i] = node;
+
+		if (node > max_node) {
+			max_node = node;
+		}
+	}
+
+	if (max_node < 0) {
+		as_log_warn("Failed to determine NUMA nodes. NUMA routing disabled.");
+		cf_free(as_event_cpu_nodes);
+		as_event_cpu_nodes = NULL;
+		as_event_cpu_nodes_size = 0;
+		return;
+	}
+
+	uint32_t nodes_size = (uint32_t)max_node + 1;
+	as_event_numa_current = cf_calloc(nodes_size, sizeof(as_event_loop*));
+
+	as_event_loop** last = cf_calloc(nodes_size, sizeof(as_event_loop*));
+
+	// Create circular linked list of event loops for each NUMA node.
+	for (uint32_t i = 0; i < capacity; i++) {
+		as_event_loop* event_loop = &as_event_loops[i];
+		int cpu = event_loop->cpu;
+
+		if (cpu < 0 || (uint32_t)cpu >= as_event_cpu_nodes_size) {
+			continue;
+		}
+
+		int node = as_event_cpu_nodes[cpu];
+
+		if (node < 0) {
+			continue;
+		}
+
+		event_loop->numa_node = node;
+
+		if (last[node]) {
+			last[node]->numa_next = event_loop;
+		}
+		else {
+			as_event_numa_current[node] = event_loop;
+		}
+		event_loop->numa_next = as_event_numa_current[node];
+		last[node] = event_loop;
+	}
+	cf_free(last);
+	as_event_numa_routing = true;
+}
+
+#endif
+
+static void
+as_event_destroy_numa(void)
+{
+	as_event_numa_routing = false;
+
+	if (as_event_cpu_nodes) {
+		cf_free(as_event_cpu_nodes);
+		as_event_cpu_nodes = NULL;
+		as_event_cpu_nodes_size = 0;
+	}
+
+	if (as_event_numa_current) {
+		cf_free(as_event_numa_current);
+		as_event_numa_current = NULL;
+	}
+}
+
+static void
+as_event_command_pool_init(as_event_command_pool* pool)
+{
+	pthread_mutex_init(&pool->lock, NULL);
+
+	for (uint32_t i = 0; i < AS_EVENT_COMMAND_POOL_CLASSES; i++) {
+		pool->free_list[i] = NULL;
+		pool->free_size[i] = 0;
+	}
+	pool->in_use = 0;
+	pool->high_water = 0;
+}
+
 static void
 as_event_initialize_loop(as_policy_event* policy, as_event_loop* event_loop, uint32_t index)
 {
 	pthread_mutex_init(&event_loop->lock, 0);
+
+	as_event_ring* ring = cf_malloc(sizeof(as_event_ring) +
+		sizeof(as_event_ring_cell) * AS_EVENT_RING_CAPACITY);
+	ring->head = 0;
+	ring->wakeup = 0;
+	ring->overflow = 0;
+	ring->tail = 0;
+
+	for (uint32_t i = 0; i < AS_EVENT_RING_CAPACITY; i++) {
+		ring->cells[i].seq = i;
+	}
+	event_loop->ring = ring;
+
+#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT)
+	event_loop->wheel = as_event_wheel_create();
+#else
+	event_loop->wheel = NULL;
+#endif
+
 	as_queue_init(&event_loop->queue, sizeof(as_event_commander), AS_EVENT_QUEUE_INITIAL_CAPACITY);
 
 	if (policy->max_commands_in_process > 0) {
 		as_queue_init(&event_loop->delay_queue, sizeof(as_event_command*), policy->queue_initial_capacity);
+		as_queue_init(&event_loop->background_queue, sizeof(as_event_command*), policy->queue_initial_capacity);
 	}
 	else {
 		memset(&event_loop->delay_queue, 0, sizeof(as_queue));
+		memset(&event_loop->background_queue, 0, sizeof(as_queue));
 	}
 	as_queue_init(&event_loop->pipe_cb_queue, sizeof(as_queued_pipe_cb), AS_EVENT_QUEUE_INITIAL_CAPACITY);
+	event_loop->pipe_corked = NULL;
+	event_loop->pipe_cork = false;
+	as_event_command_pool_init(&event_loop->cmd_pool);
+	event_loop->decompress_buf = NULL;
+	event_loop->decompress_last_used = 0;
+	event_loop->decompress_capacity = 0;
+	event_loop->order_buckets = NULL;
+	event_loop->numa_next = NULL;
 	event_loop->index = index;
+	event_loop->cpu = -1;
+	event_loop->numa_node = -1;
 	event_loop->max_commands_in_queue = policy->max_commands_in_queue;
+	event_loop->max_background_in_queue = policy->max_background_in_queue;
+	event_loop->foreground_burst = policy->foreground_burst;
+	event_loop->foreground_run = 0;
 	event_loop->max_commands_in_process = policy->max_commands_in_process;
 	event_loop->pending = 0;
 	event_loop->errors = 0;
 	event_loop->using_delay_queue = false;
 	event_loop->pipe_cb_calling = false;
+	event_loop->draining = false;
+
+	as_event_monitor* monitor = &event_loop->monitor;
+	memset(monitor, 0, sizeof(as_event_monitor));
+	monitor->lag_listener = policy->lag_listener;
+	monitor->lag_udata = policy->lag_udata;
+	monitor->lag_threshold_us = policy->lag_threshold_ms * 1000;
 }
 
 // Force link error on event initialization when event library not defined.
@@ -169,7 +397,9 @@ as_create_event_loops(as_error* err, as_policy_event* policy, uint32_t capacity,
 		as_policy_event_init(policy);
 	}
 
-	status = as_event_initialize_loops(err, capacity);
+	uint32_t max_loops = (policy->max_loops > capacity)? policy->max_loops : capacity;
+
+	status = as_event_initialize_loops(err, max_loops);
 
 	if (status != AEROSPIKE_OK) {
 		return status;
@@ -182,6 +412,10 @@ as_create_event_loops(as_error* err, as_policy_event* policy, uint32_t capacity,
 		as_event_initialize_loop(policy, event_loop, i);
 		event_loop->loop = NULL;
 
+		if (policy->cpus_size > 0) {
+			event_loop->cpu = policy->cpus[i % policy->cpus_size];
+		}
+
 #if !defined(_MSC_VER)
 		event_loop->thread = 0;
 #else
@@ -203,6 +437,14 @@ as_create_event_loops(as_error* err, as_policy_event* policy, uint32_t capacity,
 		as_event_loop_size++;
 	}
 
+#if defined(__linux__)
+	if (policy->numa_routing) {
+		as_event_init_numa(capacity);
+	}
+#endif
+
+	as_event_selection = policy->loop_selection;
+
 	if (event_loops) {
 		*event_loops = as_event_loops;
 	}
@@ -226,6 +468,85 @@ as_event_set_external_loop_capacity(uint32_t capacity)
 
 #endif
 
+// Must hold as_event_lock.
+static void
+as_event_link_loop(as_event_loop* event_loop)
+{
+	// Append after the last active loop, which points back to the first active loop.
+	for (uint32_t i = as_event_loop_size; i > 0; i--) {
+		as_event_loop* prev = &as_event_loops[i - 1];
+
+		if (prev != event_loop && ! prev->draining) {
+			event_loop->next = prev->next;
+			// Warning: not synchronized with as_event_loop_get()
+			prev->next = event_loop;
+			break;
+		}
+	}
+
+#if defined(__linux__)
+	int node = event_loop->numa_node;
+
+	if (as_event_numa_current && node >= 0) {
+		as_event_loop* head = as_event_numa_current[node];
+
+		if (head) {
+			event_loop->numa_next = head->numa_next;
+			head->numa_next = event_loop;
+		}
+		else {
+			event_loop->numa_next = event_loop;
+			as_event_numa_current[node] = event_loop;
+		}
+	}
+#endif
+}
+
+// Must hold as_event_lock.
+static void
+as_event_unlink_loop(as_event_loop* event_loop)
+{
+	// The removed loop keeps its next pointer, so a concurrent as_event_loop_get() that
+	// already selected it still advances to an active loop.
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		as_event_loop* prev = &as_event_loops[i];
+
+		if (prev != event_loop && prev->next == event_loop) {
+			prev->next = event_loop->next;
+			break;
+		}
+	}
+
+	if (as_event_loop_current == event_loop) {
+		as_event_loop_current = event_loop->next;
+	}
+
+#if defined(__linux__)
+	int node = event_loop->numa_node;
+
+	if (as_event_numa_current && node >= 0) {
+		if (event_loop->numa_next == event_loop) {
+			// Callers on this NUMA node fall back to round-robin over all loops.
+			as_event_numa_current[node] = NULL;
+			return;
+		}
+
+		for (uint32_t i = 0; i < as_event_loop_size; i++) {
+			as_event_loop* prev = &as_event_loops[i];
+
+			if (prev != event_loop && prev->numa_next == event_loop) {
+				prev->numa_next = event_loop->numa_next;
+				break;
+			}
+		}
+
+		if (as_event_numa_current[node] == event_loop) {
+			as_event_numa_current[node] = event_loop->numa_next;
+		}
+	}
+#endif
+}
+
 as_event_loop*
 as_event_set_external_loop(void* loop)
 {
@@ -277,16 +598,12 @@ as_set_external_event_loop(as_error* err, as_policy_event* policy, void* loop, a
 	as_event_register_external_loop(event_loop);
 
 	if (current > 0) {
-		// This loop points to first loop to create circular round-robin linked list.
-		event_loop->next = as_event_loops;
-		
-		// Adjust previous loop to point to this loop.
-		// Warning: not synchronized with as_event_loop_get()
-		as_event_loops[current - 1].next = event_loop;
+		as_event_link_loop(event_loop);
 	}
 
 	// Set as_event_loop_size now that event loop has been fully initialized.
 	as_event_loop_size = current + 1;
+	as_event_selection = policy->loop_selection;
 
 	pthread_mutex_unlock(&as_event_lock);
 
@@ -294,6 +611,111 @@ as_set_external_event_loop(as_error* err, as_policy_event* policy, void* loop, a
 	return AEROSPIKE_OK;
 }
 
+#if AS_EVENT_LIB_DEFINED
+
+as_status
+as_event_add_loop(as_error* err, as_policy_event* policy, as_event_loop** event_loop_out)
+{
+	as_error_reset(err);
+
+	if (! as_event_loops || ! as_event_threads_created) {
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT,
+			"Event loops must be created by as_create_event_loops()");
+	}
+
+	as_policy_event pol_local;
+
+	if (policy) {
+		as_status status = as_event_validate_policy(err, policy);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+	else {
+		policy = &pol_local;
+		as_policy_event_init(policy);
+	}
+
+	pthread_mutex_lock(&as_event_lock);
+
+	uint32_t current = as_event_loop_size;
+
+	if (current >= as_event_loop_capacity) {
+		pthread_mutex_unlock(&as_event_lock);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to add event loop. Capacity is %u",
+			as_event_loop_capacity);
+	}
+
+	as_event_loop* event_loop = &as_event_loops[current];
+	as_event_initialize_loop(policy, event_loop, current);
+	event_loop->loop = NULL;
+
+	if (policy->cpus_size > 0) {
+		event_loop->cpu = policy->cpus[current % policy->cpus_size];
+	}
+
+#if !defined(_MSC_VER)
+	event_loop->thread = 0;
+#else
+	memset(&event_loop->thread, 0, sizeof(pthread_t));
+#endif
+
+	if (! as_event_create_loop(event_loop)) {
+		pthread_mutex_unlock(&as_event_lock);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to create event_loop: %u", current);
+	}
+
+	// Cluster event state and node async connection pools are allocated for the full capacity,
+	// so the new event loop can be used as soon as it is counted.
+	as_event_link_loop(event_loop);
+	as_event_loop_size = current + 1;
+
+	pthread_mutex_unlock(&as_event_lock);
+
+	if (event_loop_out) {
+		*event_loop_out = event_loop;
+	}
+	return AEROSPIKE_OK;
+}
+
+#endif
+
+as_status
+as_event_loop_drain(as_error* err, as_event_loop* event_loop)
+{
+	as_error_reset(err);
+	pthread_mutex_lock(&as_event_lock);
+
+	if (event_loop->draining) {
+		pthread_mutex_unlock(&as_event_lock);
+		return AEROSPIKE_OK;
+	}
+
+	if (event_loop->next == event_loop) {
+		pthread_mutex_unlock(&as_event_lock);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT,
+			"Last active event loop can not be drained");
+	}
+
+	event_loop->draining = true;
+	as_event_unlink_loop(event_loop);
+	pthread_mutex_unlock(&as_event_lock);
+	return AEROSPIKE_OK;
+}
+
+void
+as_event_loop_resume(as_event_loop* event_loop)
+{
+	pthread_mutex_lock(&as_event_lock);
+
+	if (event_loop->draining) {
+		as_event_link_loop(event_loop);
+		event_loop->draining = false;
+	}
+	pthread_mutex_unlock(&as_event_lock);
+}
+
 as_event_loop*
 as_event_loop_find(void* loop)
 {
@@ -349,26 +771,468 @@ as_event_destroy_loops(void)
 	WSACleanup();
 #endif
 
+	as_event_destroy_numa();
+	as_event_selection = AS_EVENT_LOOP_SELECTION_ROUND_ROBIN;
+
 	if (as_event_loops) {
+		for (uint32_t i = 0; i < as_event_loop_size; i++) {
+			cf_free(as_event_loops[i].order_buckets);
+		}
 		cf_free(as_event_loops);
 		as_event_loops = NULL;
 		as_event_loop_size = 0;
 	}
 }
 
+as_event_loop*
+as_event_loop_get_local(void)
+{
+#if defined(__linux__)
+	int cpu = sched_getcpu();
+
+	if (cpu >= 0 && (uint32_t)cpu < as_event_cpu_nodes_size) {
+		int node = as_event_cpu_nodes[cpu];
+
+		if (node >= 0) {
+			// Not atomic because doesn't need to be exactly accurate.
+			as_event_loop* event_loop = as_event_numa_current[node];
+
+			if (event_loop) {
+				as_event_numa_current[node] = event_loop->numa_next;
+				return event_loop;
+			}
+		}
+	}
+#endif
+
+	as_event_loop* event_loop = as_event_loop_current;
+	as_event_loop_current = event_loop->next;
+	return event_loop;
+}
+
+static inline uint64_t
+as_event_loop_load(as_event_loop* event_loop)
+{
+	// Not synchronized because it doesn't need to be exactly accurate. Commands still in the
+	// submission ring are included, so a burst of new commands is not sent to the same loop.
+	as_event_ring* ring = event_loop->ring;
+	uint64_t submitted = ring ? as_load_uint64(&ring->head) - as_load_uint64(&ring->tail) : 0;
+	int pending = event_loop->pending;
+
+	return submitted + (pending > 0 ? (uint64_t)pending : 0) +
+		as_queue_size(&event_loop->delay_queue) + as_queue_size(&event_loop->background_queue);
+}
+
+as_event_loop*
+as_event_loop_get_least_loaded(void)
+{
+	// Start from the round-robin loop so ties are spread over all loops.
+	as_event_loop* start;
+	bool numa = false;
+
+	if (as_event_numa_routing) {
+		start = as_event_loop_get_local();
+		numa = start->numa_node >= 0;
+	}
+	else {
+		start = as_event_loop_current;
+		as_event_loop_current = start->next;
+	}
+
+	as_event_loop* best = start;
+	uint64_t best_load = as_event_loop_load(start);
+	as_event_loop* event_loop = numa ? start->numa_next : start->next;
+
+	while (event_loop != start && best_load > 0) {
+		uint64_t load = as_event_loop_load(event_loop);
+
+		if (load < best_load) {
+			best = event_loop;
+			best_load = load;
+		}
+		event_loop = numa ? event_loop->numa_next : event_loop->next;
+	}
+	return best;
+}
+
+bool
+as_event_loop_is_drained(as_event_loop* event_loop)
+{
+	return event_loop->draining && as_event_loop_load(event_loop) == 0 &&
+		as_event_loop_get_execute_size(event_loop) == 0;
+}
+
+bool
+as_event_thread_create(as_event_loop* event_loop, void* (*worker)(void*), void* udata)
+{
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+
+	if (event_loop->cpu >= 0) {
+		as_cpu_assign_thread_attr(&attr, event_loop->cpu);
+	}
+
+	bool rv = pthread_create(&event_loop->thread, &attr, worker, udata) == 0;
+	pthread_attr_destroy(&attr);
+	return rv;
+}
+
+void
+as_event_thread_assign_cpu(as_event_loop* event_loop)
+{
+	if (event_loop->cpu >= 0) {
+		if (as_cpu_assign_thread(pthread_self(), event_loop->cpu) != 0) {
+			as_log_warn("Failed to assign event loop %u to cpu %d", event_loop->index, event_loop->cpu);
+		}
+	}
+}
+
+static bool
+as_event_ring_push(as_event_ring* ring, as_event_commander* cmd)
+{
+	uint64_t pos = as_load_uint64(&ring->head);
+	as_event_ring_cell* cell;
+
+	while (true) {
+		cell = &ring->cells[pos & (AS_EVENT_RING_CAPACITY - 1)];
+
+		int64_t diff = (int64_t)as_load_uint64_acq(&cell->seq) - (int64_t)pos;
+
+		if (diff == 0) {
+			// Cell is free. Claim it.
+			if (as_cas_uint64(&ring->head, pos, pos + 1)) {
+				break;
+			}
+			pos = as_load_uint64(&ring->head);
+		}
+		else if (diff < 0) {
+			// Ring is full.
+			return false;
+		}
+		else {
+			// Another producer claimed the cell.
+			pos = as_load_uint64(&ring->head);
+		}
+	}
+
+	cell->cmd = *cmd;
+	as_store_uint64_rls(&cell->seq, pos + 1);
+	return true;
+}
+
+static inline bool
+as_event_ring_pop(as_event_ring* ring, as_event_commander* cmd)
+{
+	uint64_t pos = ring->tail;
+	as_event_ring_cell* cell = &ring->cells[pos & (AS_EVENT_RING_CAPACITY - 1)];
+
+	if (as_load_uint64_acq(&cell->seq) != pos + 1) {
+		// Empty or claimed cell not written yet. The producer will signal again.
+		return false;
+	}
+
+	*cmd = cell->cmd;
+	as_store_uint64_rls(&cell->seq, pos + AS_EVENT_RING_CAPACITY);
+	ring->tail = pos + 1;
+	return true;
+}
+
+bool
+as_event_queue_push(
+	as_event_loop* event_loop, as_event_executable executable, void* udata, bool* wakeup
+	)
+{
+	as_event_ring* ring = event_loop->ring;
+	as_event_commander qcmd = {.executable = executable, .udata = udata};
+	bool queued;
+
+	// Once commands overflow to the locked queue, keep using it until the event loop has
+	// drained it, so commands from the same thread run in order.
+	if (! as_load_uint32_acq(&ring->overflow) && as_event_ring_push(ring, &qcmd)) {
+		queued = true;
+	}
+	else {
+		pthread_mutex_lock(&event_loop->lock);
+		queued = as_queue_push(&event_loop->queue, &qcmd);
+		as_store_uint32(&ring->overflow, 1);
+		pthread_mutex_unlock(&event_loop->lock);
+	}
+
+	// Signal only when the event loop is not already going to process the queue.
+	*wakeup = queued && as_fas_uint32(&ring->wakeup, 1) == 0;
+	return queued;
+}
+
+// Run ring commands up to end. Return false on stop signal. Set done to false if a claimed
+// cell was not written yet.
+static bool
+as_event_ring_drain(as_event_loop* event_loop, as_event_ring* ring, uint64_t end, bool* done)
+{
+	as_event_commander cmd;
+
+	while (ring->tail < end && as_event_ring_pop(ring, &cmd)) {
+		if (! cmd.executable) {
+			// Received stop signal.
+			return false;
+		}
+		cmd.executable(event_loop, cmd.udata);
+	}
+	*done = ring->tail >= end;
+	return true;
+}
+
+static bool
+as_event_queue_execute(as_event_loop* event_loop)
+{
+	as_event_ring* ring = event_loop->ring;
+
+	// Clear wakeup before reading the queue, so commands queued from now on signal again.
+	as_fas_uint32(&ring->wakeup, 0);
+
+	// Only process original size of queue.  Recursive pre-registration errors can
+	// result in new commands being added while the loop is in process.  If we process
+	// them, we could end up in an infinite loop.
+	uint64_t end = as_load_uint64_acq(&ring->head);
+	bool done;
+
+	if (! as_event_ring_drain(event_loop, ring, end, &done)) {
+		return false;
+	}
+
+	// A claimed cell that is not written yet may precede ring commands of a thread that
+	// has since overflowed. Its producer signals again after writing the cell, so
+	// the overflow queue is processed on that wakeup.
+	if (! done || ! as_load_uint32_acq(&ring->overflow)) {
+		return true;
+	}
+
+	pthread_mutex_lock(&event_loop->lock);
+	uint32_t size = as_queue_size(&event_loop->queue);
+	pthread_mutex_unlock(&event_loop->lock);
+
+	// A thread can push to the ring and then overflow before the overflow flag is seen.
+	// Run every ring command pushed before the overflow commands counted above, so
+	// commands from the same thread run in order.
+	end = as_load_uint64_acq(&ring->head);
+
+	if (! as_event_ring_drain(event_loop, ring, end, &done)) {
+		return false;
+	}
+
+	if (! done) {
+		return true;
+	}
+
+	as_event_commander cmd;
+
+	for (uint32_t i = 0; i < size; i++) {
+		pthread_mutex_lock(&event_loop->lock);
+		bool status = as_queue_pop(&event_loop->queue, &cmd);
+		pthread_mutex_unlock(&event_loop->lock);
+
+		if (! status) {
+			break;
+		}
+
+		if (! cmd.executable) {
+			// Received stop signal.
+			return false;
+		}
+		cmd.executable(event_loop, cmd.udata);
+	}
+
+	pthread_mutex_lock(&event_loop->lock);
+
+	if (as_queue_size(&event_loop->queue) == 0) {
+		as_store_uint32(&ring->overflow, 0);
+	}
+	pthread_mutex_unlock(&event_loop->lock);
+	return true;
+}
+
+bool
+as_event_queue_run(as_event_loop* event_loop)
+{
+	// Cork pipeline connections written by queued commands, so commands sent on the same
+	// connection in this batch are coalesced into full packets.
+	event_loop->pipe_cork = true;
+	bool status = as_event_queue_execute(event_loop);
+	as_pipe_uncork(event_loop);
+	return status;
+}
+
+uint32_t
+as_event_loop_get_execute_size(as_event_loop* event_loop)
+{
+	// Warning: cross-thread references without a lock.
+	as_event_ring* ring = event_loop->ring;
+	uint64_t head = as_load_uint64(&ring->head);
+	uint64_t tail = as_load_uint64(&ring->tail);
+	uint32_t size = (head > tail)? (uint32_t)(head - tail) : 0;
+	return size + as_queue_size(&event_loop->queue);
+}
+
+static uint64_t
+as_event_thread_cpu_ns(void)
+{
+#if !defined(_MSC_VER)
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		return 0;
+	}
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#else
+	FILETIME create, exit, kernel, user;
+
+	if (! GetThreadTimes(GetCurrentThread(), &create, &exit, &kernel, &user)) {
+		return 0;
+	}
+
+	uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (k + u) * 100;
+#endif
+}
+
+static void
+as_event_monitor_run(as_event_loop* event_loop, void* udata)
+{
+	as_event_monitor* monitor = &event_loop->monitor;
+	uint64_t now = cf_getns();
+	uint64_t cpu = as_event_thread_cpu_ns();
+	uint64_t iterations = as_event_loop_iterations(event_loop);
+	uint64_t lag = (now - monitor->sent_ns) / 1000;
+	uint32_t lag_us = (lag < UINT32_MAX)? (uint32_t)lag : UINT32_MAX;
+
+	if (monitor->wall_ns) {
+		// Busy ratio is the event loop thread cpu time relative to elapsed time.
+		uint64_t wall = now - monitor->wall_ns;
+		uint64_t busy = (wall > 0)? (cpu - monitor->cpu_ns) * 100 / wall : 0;
+		as_store_uint32(&monitor->busy_pct, (busy < 100)? (uint32_t)busy : 100);
+
+		uint64_t n = iterations - monitor->iterations_prev;
+		uint64_t commands = monitor->commands - monitor->commands_prev;
+		as_store_uint32(&monitor->commands_per_iteration, (n > 0)? (uint32_t)(commands / n) : 0);
+	}
+
+	monitor->wall_ns = now;
+	monitor->cpu_ns = cpu;
+	monitor->iterations_prev = iterations;
+	monitor->commands_prev = monitor->commands;
+
+	as_store_uint32(&monitor->lag_us, lag_us);
+
+	if (lag_us > monitor->lag_window_us) {
+		monitor->lag_window_us = lag_us;
+	}
+
+	if (lag_us > monitor->lag_max_us) {
+		as_store_uint32(&monitor->lag_max_us, lag_us);
+	}
+
+	if (++monitor->probes % AS_EVENT_MONITOR_WINDOW == 0) {
+		// Maximum lag is reported over the last complete window.
+		as_store_uint32(&monitor->lag_max_us, monitor->lag_window_us);
+		monitor->lag_window_us = 0;
+	}
+
+	// Allow next probe.
+	as_store_uint8_rls(&monitor->probing, 0);
+
+	if (monitor->lag_listener && monitor->lag_threshold_us > 0 &&
+		lag_us >= monitor->lag_threshold_us) {
+		monitor->lag_listener(event_loop, lag_us, monitor->lag_udata);
+	}
+}
+
+void
+as_event_monitor_probe(void)
+{
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		as_event_loop* event_loop = &as_event_loops[i];
+		as_event_monitor* monitor = &event_loop->monitor;
+
+		// Skip event loop if its previous probe has not run yet. Probes from multiple
+		// cluster tend threads are also limited to one outstanding probe per event loop.
+		if (! as_cas_uint8(&monitor->probing, 0, 1)) {
+			continue;
+		}
+
+		monitor->sent_ns = cf_getns();
+
+		if (! as_event_execute(event_loop, as_event_monitor_run, NULL)) {
+			as_store_uint8_rls(&monitor->probing, 0);
+		}
+	}
+}
+
 //---------------------------------
 // Private Functions
 //---------------------------------
 
 static void as_event_command_execute_in_loop(as_event_loop* event_loop, as_event_command* cmd);
+static void as_event_hedge_start(as_event_command* cmd);
 static void as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd);
 static void as_event_execute_from_delay_queue(as_event_loop* event_loop);
+static bool as_async_cancel_register(as_event_command* cmd);
+static void as_event_command_abort(as_event_command* cmd);
+static void as_async_cancel_unregister(as_event_command* cmd);
 static void connector_error(as_event_command* cmd, as_error* err);
 
+static inline bool
+as_event_command_has_budget(as_event_command* cmd)
+{
+	if (! cmd->cluster->mem_budget) {
+		return false;
+	}
+
+	switch (cmd->type) {
+		case AS_ASYNC_TYPE_BATCH:
+		case AS_ASYNC_TYPE_SCAN:
+		case AS_ASYNC_TYPE_QUERY:
+		case AS_ASYNC_TYPE_SCAN_PARTITION:
+		case AS_ASYNC_TYPE_QUERY_PARTITION:
+			return true;
+
+		default:
+			return cmd->write_len > AS_STACK_BUF_SIZE;
+	}
+}
+
+static as_status
+as_event_command_admit(as_event_command* cmd, as_error* err)
+{
+	cmd->budget_size = 0;
+
+	if (! as_event_command_has_budget(cmd)) {
+		return AEROSPIKE_OK;
+	}
+
+	// Blocking is not allowed in event loop threads, so the budget never waits.
+	as_status status = as_mem_budget_acquire(cmd->cluster->mem_budget, err, cmd->write_len, 0);
+
+	if (status != AEROSPIKE_OK) {
+		as_event_command_destroy(cmd);
+		return status;
+	}
+	cmd->budget_size = cmd->write_len;
+	return AEROSPIKE_OK;
+}
+
 as_status
 as_event_command_execute(as_event_command* cmd, as_error* err)
 {
+	as_status status = as_event_command_admit(cmd, err);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
 	cmd->command_sent_counter = 0;
+	cmd->slow_begin = cmd->cluster->slow_log ? cf_getns() : 0;
+	cmd->trace_id = as_cluster_trace_begin(cmd->cluster);
+	as_event_command_trace(cmd, AS_TRACE_START, AEROSPIKE_OK);
 
 	as_event_loop* event_loop = cmd->event_loop;
 
@@ -384,38 +1248,159 @@ as_event_command_execute(as_event_command* cmd, as_error* err)
 			as_event_command_schedule(cmd);
 		}
 	}
-	else {
-		// Send command through queue so it can be executed in event loop thread.
-		if (cmd->total_deadline > 0) {
-			// Convert total timeout to deadline.
-			cmd->total_deadline += cf_getms();
-		}
-		cmd->state = AS_ASYNC_STATE_REGISTERED;
+	else {
+		// Send command through queue so it can be executed in event loop thread.
+		if (cmd->total_deadline > 0) {
+			// Convert total timeout to deadline.
+			cmd->total_deadline += as_clock_getms();
+		}
+		cmd->state = AS_ASYNC_STATE_REGISTERED;
+
+		if (! as_event_execute(cmd->event_loop,
+			(as_event_executable)as_event_command_execute_in_loop, cmd)) {
+
+			cmd->event_loop->errors++;  // May not be in event loop thread, so not exactly accurate.
+			as_event_command_destroy(cmd);
+			return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static void
+as_event_command_start_delayed(as_event_loop* event_loop, as_event_command* cmd)
+{
+	// Callback is as_event_process_timer() which starts the command in registered state.
+	as_event_timer_once(cmd, cmd->start_delay);
+}
+
+as_status
+as_event_command_execute_delay(as_event_command* cmd, uint32_t delay_ms, as_error* err)
+{
+	if (delay_ms == 0) {
+		return as_event_command_execute(cmd, err);
+	}
+
+	as_status status = as_event_command_admit(cmd, err);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	cmd->command_sent_counter = 0;
+	cmd->slow_begin = cmd->cluster->slow_log ? cf_getns() : 0;
+	cmd->trace_id = as_cluster_trace_begin(cmd->cluster);
+	as_event_command_trace(cmd, AS_TRACE_START, AEROSPIKE_OK);
+
+	if (cmd->total_deadline > 0) {
+		// Convert total timeout to deadline measured from the delayed start.
+		cmd->total_deadline += as_clock_getms() + delay_ms;
+	}
+	cmd->start_delay = delay_ms;
+	cmd->state = AS_ASYNC_STATE_REGISTERED;
+
+	as_event_loop* event_loop = cmd->event_loop;
+
+	if (as_in_event_loop(event_loop->thread)) {
+		as_event_command_start_delayed(event_loop, cmd);
+		return AEROSPIKE_OK;
+	}
+
+	if (! as_event_execute(event_loop, (as_event_executable)as_event_command_start_delayed, cmd)) {
+		event_loop->errors++;  // May not be in event loop thread, so not exactly accurate.
+		as_event_command_destroy(cmd);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
+	}
+	return AEROSPIKE_OK;
+}
+
+void
+as_event_command_schedule(as_event_command* cmd)
+{
+	// Schedule command to execute in next event loop iteration.
+	// Must be run in event loop thread.
+	if (cmd->total_deadline > 0) {
+		// Convert total timeout to deadline.
+		cmd->total_deadline += as_clock_getms();
+	}
+
+	// Callback is as_event_process_timer().
+	cmd->state = AS_ASYNC_STATE_REGISTERED;
+	as_event_timer_once(cmd, 0);
+}
+
+bool
+as_event_command_pause(as_event_command* cmd)
+{
+	// Flow control only applies to scan and query commands.
+	if (! (cmd->type == AS_ASYNC_TYPE_SCAN_PARTITION || cmd->type == AS_ASYNC_TYPE_QUERY_PARTITION ||
+		   cmd->type == AS_ASYNC_TYPE_SCAN || cmd->type == AS_ASYNC_TYPE_QUERY)) {
+		return false;
+	}
+
+	as_event_executor* executor = cmd->udata; // udata is overloaded to contain executor.
+	as_async_flow* flow = executor->flow;
+
+	// Do not pause commands of a failed executor, so they can finish.
+	if (! flow || ! flow->paused || ! executor->valid) {
+		return false;
+	}
+
+	if (! executor->paused) {
+		executor->paused = cf_malloc(sizeof(as_event_command*) * executor->max);
+	}
+	executor->paused[executor->n_paused++] = cmd;
+
+	// Caller has already consumed the current block. Read next header on resume.
+	as_event_stop_watcher(cmd, cmd->conn);
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_PAUSED;
+	return true;
+}
+
+static void
+as_event_executor_resume(as_event_executor* executor)
+{
+	for (uint32_t i = 0; i < executor->n_paused; i++) {
+		as_event_command* cmd = executor->paused[i];
+		cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+		as_event_command_resume_read(cmd);
+	}
+	executor->n_paused = 0;
+}
 
-		if (! as_event_execute(cmd->event_loop,
-			(as_event_executable)as_event_command_execute_in_loop, cmd)) {
+static void
+as_event_executor_remove_paused(as_event_command* cmd)
+{
+	as_event_executor* executor = cmd->udata;
 
-			cmd->event_loop->errors++;  // May not be in event loop thread, so not exactly accurate.
-			as_event_command_destroy(cmd);
-			return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
+	for (uint32_t i = 0; i < executor->n_paused; i++) {
+		if (executor->paused[i] == cmd) {
+			executor->paused[i] = executor->paused[--executor->n_paused];
+			break;
 		}
 	}
-	return AEROSPIKE_OK;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
 }
 
 void
-as_event_command_schedule(as_event_command* cmd)
+as_async_flow_pause(as_async_flow* flow)
 {
-	// Schedule command to execute in next event loop iteration.
-	// Must be run in event loop thread.
-	if (cmd->total_deadline > 0) {
-		// Convert total timeout to deadline.
-		cmd->total_deadline += cf_getms();
-	}
+	// Running commands pause themselves after parsing their current block.
+	flow->paused = true;
+}
 
-	// Callback is as_event_process_timer().
-	cmd->state = AS_ASYNC_STATE_REGISTERED;
-	as_event_timer_once(cmd, 0);
+void
+as_async_flow_resume(as_async_flow* flow)
+{
+	flow->paused = false;
+
+	if (flow->executor) {
+		// Resumed commands read on the next event loop iteration, so commands can not
+		// complete or pause again while the paused list is traversed.
+		as_event_executor_resume(flow->executor);
+	}
 }
 
 static inline void
@@ -426,9 +1411,100 @@ as_event_prequeue_error(as_event_loop* event_loop, as_event_command* cmd, as_err
 	as_event_error_callback(cmd, err);
 }
 
+#define AS_EVENT_ORDER_BUCKETS 1024
+
+// Return true if the command must wait for a previous command on the same key. Otherwise,
+// register the command as the key's in-flight command.
+static bool
+as_event_order_wait(as_event_loop* event_loop, as_event_command* cmd)
+{
+	if (! event_loop->order_buckets) {
+		event_loop->order_buckets = cf_calloc(AS_EVENT_ORDER_BUCKETS, sizeof(as_event_command*));
+	}
+
+	as_event_command** bucket =
+		&event_loop->order_buckets[cmd->order_hash % AS_EVENT_ORDER_BUCKETS];
+
+	for (as_event_command* head = *bucket; head; head = head->order_link) {
+		if (head->order_hash != cmd->order_hash) {
+			continue;
+		}
+
+		if (head == cmd) {
+			// Command was promoted after the previous command on its key completed.
+			return false;
+		}
+
+		if (head->order_next) {
+			head->order_tail->order_next = cmd;
+		}
+		else {
+			head->order_next = cmd;
+		}
+		head->order_tail = cmd;
+		cmd->order_next = NULL;
+
+		if (cmd->state != AS_ASYNC_STATE_REGISTERED) {
+			if (cmd->total_deadline > 0) {
+				// Convert total timeout to deadline, so the wait counts toward total timeout.
+				cmd->total_deadline += as_clock_getms();
+			}
+			cmd->state = AS_ASYNC_STATE_REGISTERED;
+		}
+		return true;
+	}
+
+	cmd->order_link = *bucket;
+	cmd->order_next = NULL;
+	*bucket = cmd;
+	return false;
+}
+
+// Remove completed command from in-flight commands and start the next command waiting on
+// the same key.
+static void
+as_event_order_release(as_event_loop* event_loop, as_event_command* cmd)
+{
+	if (! event_loop->order_buckets) {
+		return;
+	}
+
+	as_event_command** prev =
+		&event_loop->order_buckets[cmd->order_hash % AS_EVENT_ORDER_BUCKETS];
+
+	while (*prev && *prev != cmd) {
+		prev = &(*prev)->order_link;
+	}
+
+	if (! *prev) {
+		// Command failed before it was registered.
+		return;
+	}
+
+	as_event_command* next = cmd->order_next;
+
+	if (next) {
+		next->order_link = cmd->order_link;
+		next->order_next = (next == cmd->order_tail)? NULL : next->order_next;
+		next->order_tail = cmd->order_tail;
+		*prev = next;
+
+		// Callback is as_event_process_timer(), which starts the command in registered state.
+		as_event_timer_once(next, 0);
+	}
+	else {
+		*prev = cmd->order_link;
+	}
+}
+
 void
 as_event_command_execute_in_loop(as_event_loop* event_loop, as_event_command* cmd)
 {
+	if (cmd->order_hash && as_event_order_wait(event_loop, cmd)) {
+		// Command starts when the previous command on its key completes.
+		return;
+	}
+
 	// Initialize read buffer (buf) to be located after write buffer.
 	cmd->begin = 0;
 	cmd->write_offset = (uint32_t)(cmd->buf - (uint8_t*)cmd);
@@ -444,10 +1520,19 @@ as_event_command_execute_in_loop(as_event_loop* event_loop, as_event_command* cm
 		return;
 	}
 
+	if (cmd->cancel && ! as_async_cancel_register(cmd)) {
+		// Command was aborted before it started.
+		as_error err;
+		as_error_set_message(&err, AEROSPIKE_ERR_CLIENT_ABORT, "Command aborted");
+		cmd->state = AS_ASYNC_STATE_QUEUE_ERROR;
+		as_event_error_callback(cmd, &err);
+		return;
+	}
+
 	uint64_t total_timeout = 0;
 
 	if (cmd->total_deadline > 0) {
-		uint64_t now = cf_getms();
+		uint64_t now = as_clock_getms();
 
 		if (cmd->state == AS_ASYNC_STATE_REGISTERED) {
 			// Command was queued to event loop thread.
@@ -473,27 +1558,33 @@ as_event_command_execute_in_loop(as_event_loop* event_loop, as_event_command* cm
 
 		// Handle new command.
 		if (event_loop->pending >= event_loop->max_commands_in_process) {
-			// Pending queue full. Append new command to delay queue.
+			// Pending queue full. Append new command to the delay queue of its priority.
+			// Each queue has its own limit, so background commands never fill the
+			// foreground queue.
+			bool background = cmd->priority == AS_POLICY_PRIORITY_BACKGROUND;
+			as_queue* queue = background ? &event_loop->background_queue : &event_loop->delay_queue;
+			uint32_t max = background ?
+				event_loop->max_background_in_queue : event_loop->max_commands_in_queue;
 			bool status;
 
-			if (event_loop->max_commands_in_queue > 0) {
-				uint32_t size = as_queue_size(&event_loop->delay_queue);
+			if (max > 0) {
+				uint32_t size = as_queue_size(queue);
 
-				if (size < event_loop->max_commands_in_queue) {
-					status = as_queue_push(&event_loop->delay_queue, &cmd);
+				if (size < max) {
+					status = as_queue_push(queue, &cmd);
 				}
 				else {
 					status = false;
 				}
 			}
 			else {
-				status = as_queue_push(&event_loop->delay_queue, &cmd);
+				status = as_queue_push(queue, &cmd);
 			}
 
 			if (! status) {
 				as_error err;
-				as_error_update(&err, AEROSPIKE_ERR_ASYNC_QUEUE_FULL, "Async delay queue full: %u",
-								event_loop->max_commands_in_queue);
+				as_error_update(&err, AEROSPIKE_ERR_ASYNC_QUEUE_FULL, "Async %sdelay queue full: %u",
+								background ? "background " : "", max);
 				as_event_prequeue_error(event_loop, cmd, &err);
 				return;
 			}
@@ -529,6 +1620,28 @@ as_event_command_execute_in_loop(as_event_loop* event_loop, as_event_command* cm
 	as_event_command_begin(event_loop, cmd);
 }
 
+static bool
+as_event_pop_delay_queue(as_event_loop* event_loop, as_event_command** cmd)
+{
+	// Foreground commands take precedence. When both queues hold commands, start one
+	// background command after every foreground_burst foreground commands, so background
+	// commands still make progress under sustained foreground load.
+	if (event_loop->foreground_burst > 0 &&
+		event_loop->foreground_run >= event_loop->foreground_burst &&
+		as_queue_pop(&event_loop->background_queue, cmd)) {
+		event_loop->foreground_run = 0;
+		return true;
+	}
+
+	if (as_queue_pop(&event_loop->delay_queue, cmd)) {
+		event_loop->foreground_run++;
+		return true;
+	}
+
+	event_loop->foreground_run = 0;
+	return as_queue_pop(&event_loop->background_queue, cmd);
+}
+
 static void
 as_event_execute_from_delay_queue(as_event_loop* event_loop)
 {
@@ -537,7 +1650,7 @@ as_event_execute_from_delay_queue(as_event_loop* event_loop)
 	as_event_command* cmd;
 
 	while (event_loop->pending < event_loop->max_commands_in_process &&
-		   as_queue_pop(&event_loop->delay_queue, &cmd)) {
+		   as_event_pop_delay_queue(event_loop, &cmd)) {
 
 		if (cmd->state == AS_ASYNC_STATE_QUEUE_ERROR) {
 			// Command timed out and user has already been notified.
@@ -547,7 +1660,7 @@ as_event_execute_from_delay_queue(as_event_loop* event_loop)
 
 		if (cmd->socket_timeout > 0) {
 			if (cmd->total_deadline > 0) {
-				if (cmd->socket_timeout < cmd->total_deadline - cf_getms()) {
+				if (cmd->socket_timeout < cmd->total_deadline - as_clock_getms()) {
 					// Transition from total timer to socket timer.
 					as_event_timer_stop(cmd);
 					as_event_timer_repeat(cmd, cmd->socket_timeout);
@@ -585,12 +1698,172 @@ as_event_add_latency(as_event_command* cmd, as_latency_type type)
 	as_node_add_latency(cmd->metrics, type, elapsed);
 }
 
+static inline void
+as_event_add_command_latency(as_event_command* cmd)
+{
+	uint64_t elapsed = cf_getns() - cmd->begin;
+	as_node_add_command_latency(cmd->metrics, cmd->latency_type, cmd->latency_tag, elapsed);
+}
+
+static inline as_partition_heat*
+as_event_partition_heat(as_event_command* cmd)
+{
+	// Only single record commands target a partition.
+	return (cmd->metrics && cmd->partition)? cmd->metrics->partition_heat : NULL;
+}
+
+static inline void
+as_event_add_heat_latency(as_event_command* cmd)
+{
+	if (cmd->heat_sample) {
+		as_partition_heat_add_latency(cmd->metrics->partition_heat, cmd->partition_id,
+			cf_getns() - cmd->begin);
+	}
+}
+
+static inline void
+as_event_add_timeout(as_event_command* cmd)
+{
+	as_node_add_timeout(cmd->node, cmd->ns, cmd->metrics);
+
+	as_partition_heat* heat = as_event_partition_heat(cmd);
+
+	if (heat) {
+		as_partition_heat_add_timeout(heat, cmd->partition_id);
+	}
+}
+
+static inline void
+as_event_add_bytes(as_event_command* cmd)
+{
+	as_node_add_bytes_out(cmd->metrics, cmd->bytes_out);
+	as_node_add_bytes_in(cmd->metrics, cmd->bytes_in);
+
+	if (cmd->ubuf && cmd->bytes_out) {
+		// The uncompressed command is kept in ubuf when the command is sent compressed.
+		as_node_add_compressed_out(cmd->metrics, cmd->write_len, cmd->ubuf_size);
+	}
+}
+
+static as_status
+as_event_command_parse_set_digest(as_event_command* cmd, as_error* err, char* set, uint8_t* digest);
+
+static void
+as_event_add_hot_key(as_event_command* cmd)
+{
+	// Single record commands no longer hold the key, so set and digest are parsed from
+	// the send buffer.
+	if (! (cmd->partition && (cmd->type == AS_ASYNC_TYPE_WRITE ||
+		cmd->type == AS_ASYNC_TYPE_RECORD || cmd->type == AS_ASYNC_TYPE_VALUE))) {
+		return;
+	}
+
+	as_error err;
+	as_set set;
+	as_digest_value digest;
+
+	if (as_event_command_parse_set_digest(cmd, &err, set, digest) == AEROSPIKE_OK) {
+		as_hot_keys_add(cmd->metrics->hot_keys, digest, set);
+	}
+}
+
+static inline void
+as_event_add_node_sample(as_event_command* cmd, bool error)
+{
+	if (! cmd->begin) {
+		return;
+	}
+
+	if (cmd->replica == AS_POLICY_REPLICA_LOWEST_LATENCY) {
+		as_node_add_replica_sample(cmd->node, cf_getns() - cmd->begin, error);
+	}
+
+	if (cmd->adaptive_timeout_pct) {
+		// Timed out attempts are recorded too, so repeated timeouts raise the timeout.
+		as_node_add_adaptive_sample(cmd->node, cf_getns() - cmd->begin);
+	}
+
+	if (cmd->limited) {
+		as_node_add_limit_sample(cmd->node, cf_getns() - cmd->begin, error);
+	}
+}
+
+static void
+as_event_set_adaptive_timer(as_event_command* cmd)
+{
+	uint32_t timeout = as_node_adaptive_timeout(cmd->node, cmd->policy_socket_timeout,
+		cmd->adaptive_timeout_pct, cmd->adaptive_timeout_min);
+
+	if (timeout == cmd->socket_timeout) {
+		// Timer is already set for this socket timeout.
+		return;
+	}
+
+	cmd->socket_timeout = timeout;
+
+	if (cmd->total_deadline > 0) {
+		uint64_t now = as_clock_getms();
+
+		if (now >= cmd->total_deadline) {
+			// Total timer is about to fire.
+			return;
+		}
+
+		uint64_t remaining = cmd->total_deadline - now;
+
+		if (timeout == 0 || timeout >= remaining) {
+			if (cmd->flags & AS_ASYNC_FLAGS_USING_SOCKET_TIMER) {
+				// Transition to total timer.
+				cmd->flags &= ~AS_ASYNC_FLAGS_USING_SOCKET_TIMER;
+				as_event_timer_stop(cmd);
+				as_event_timer_once(cmd, remaining);
+			}
+			return;
+		}
+	}
+	else if (timeout == 0) {
+		return;
+	}
+
+	cmd->flags &= ~AS_ASYNC_FLAGS_EVENT_RECEIVED;
+	as_event_timer_stop(cmd);
+	as_event_timer_repeat(cmd, timeout);
+}
+
 void
 as_event_connection_complete(as_event_command* cmd)
 {
 	if (cmd->metrics) {
 		as_event_add_latency(cmd, AS_LATENCY_TYPE_CONN);
 	}
+	as_event_command_trace(cmd, AS_TRACE_CONNECTION, AEROSPIKE_OK);
+}
+
+static bool
+as_event_borrow_connection(as_node* node, as_async_conn_pool* pool)
+{
+	as_cluster* cluster = node->cluster;
+
+	if (! cluster->async_borrow_conns) {
+		return false;
+	}
+
+	uint32_t total = 0;
+
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		// Warning: cross-thread references without a lock.
+		total += as_load_uint32(&node->async_conn_pools[i].queue.total);
+	}
+
+	if (total >= cluster->async_max_conns_per_node) {
+		return false;
+	}
+
+	// The pool is now above limit, so as_async_conn_pool_push_head() closes the borrowed
+	// connection when it is released.
+	pool->queue.total++;
+	pool->borrowed++;
+	return true;
 }
 
 static void
@@ -601,6 +1874,10 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 	if (cmd->partition) {
 		// If in retry, need to release node from prior attempt.
 		if (cmd->node) {
+			if (cmd->limited) {
+				as_node_limit_release(cmd->node);
+				cmd->limited = false;
+			}
 			as_node_release(cmd->node);
 		}
 
@@ -612,6 +1889,7 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 
 		if (! cmd->node) {
 			event_loop->errors++;
+			as_cluster_hurry_tend(cmd->cluster);
 
 			as_error err;
 			as_error_update(&err, AEROSPIKE_ERR_INVALID_NODE, "Node not found for partition %s",
@@ -624,7 +1902,9 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 		as_node_reserve(cmd->node);
 	}
 
-	if (! as_node_valid_error_rate(cmd->node)) {
+	bool valid_error_rate = as_node_valid_error_rate(cmd->node);
+
+	if (! (valid_error_rate && as_node_breaker_allow(cmd->node))) {
 		event_loop->errors++;
 
 		if (as_event_command_retry(cmd, true)) {
@@ -632,23 +1912,76 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 		}
 
 		as_error err;
-		as_error_set_message(&err, AEROSPIKE_MAX_ERROR_RATE, "Max error rate exceeded");
+		as_error_set_message(&err, AEROSPIKE_MAX_ERROR_RATE, valid_error_rate?
+			"Circuit breaker open" : "Max error rate exceeded");
 
 		as_event_timer_stop(cmd);
 		as_event_error_callback(cmd, &err);
 		return;
 	}
 
+	if (cmd->partition && as_node_limited(cmd->node)) {
+		if (! as_node_limit_acquire(cmd->node)) {
+			event_loop->errors++;
+
+			if (as_event_command_retry(cmd, true)) {
+				return;
+			}
+
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_MAX_ERROR_RATE, "Node concurrency limit exceeded");
+
+			as_event_timer_stop(cmd);
+			as_event_error_callback(cmd, &err);
+			return;
+		}
+		cmd->limited = true;
+	}
+
 	cmd->metrics = NULL;
+	cmd->heat_sample = false;
 	cmd->bytes_in = 0;
 	cmd->bytes_out = 0;
+	cmd->proto_type_rcv = 0;
+
+	// Latency is also tracked for replica selection when AS_POLICY_REPLICA_LOWEST_LATENCY.
+	bool track_latency = cmd->replica == AS_POLICY_REPLICA_LOWEST_LATENCY;
 
 	if (cmd->cluster->metrics_enabled) {
 		cmd->metrics = as_node_prepare_metrics(cmd->node, cmd->ns);
 
 		if (cmd->latency_type != AS_LATENCY_TYPE_NONE) {
-			cmd->begin = cf_getns();
+			track_latency = true;
+		}
+
+		if (cmd->metrics && cmd->metrics->hot_keys) {
+			as_event_add_hot_key(cmd);
 		}
+
+		as_partition_heat* heat = as_event_partition_heat(cmd);
+
+		if (heat) {
+			cmd->heat_sample = as_partition_heat_add_command(heat, cmd->partition_id,
+				cmd->iteration > 0);
+
+			if (cmd->heat_sample) {
+				track_latency = true;
+			}
+		}
+	}
+
+	if (cmd->adaptive_timeout_pct) {
+		// Socket timer is derived from latency of the node selected for this attempt.
+		as_event_set_adaptive_timer(cmd);
+		track_latency = true;
+	}
+
+	if (cmd->limited) {
+		track_latency = true;
+	}
+
+	if (track_latency) {
+		cmd->begin = cf_getns();
 	}
 
 	if (cmd->pipe_listener) {
@@ -677,15 +2010,18 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 			continue;
 		}
 
+		as_conn_window_idle(&pool->window, as_queue_size(&pool->queue));
 		conn->cmd = cmd;
 		cmd->conn = (as_event_connection*)conn;
 		event_loop->errors = 0;  // Reset errors on valid connection.
+		as_event_command_trace(cmd, AS_TRACE_CONNECTION, AEROSPIKE_OK);
 		as_event_command_write_start(cmd);
 		return;
 	}
+	as_conn_window_idle(&pool->window, 0);
 
 	// Create connection only when connection count within limit.
-	if (as_async_conn_pool_incr_total(pool)) {
+	if (as_async_conn_pool_incr_total(pool) || as_event_borrow_connection(cmd->node, pool)) {
 		as_event_create_connection(cmd, pool);
 		return;
 	}
@@ -710,6 +2046,11 @@ as_event_command_begin(as_event_loop* event_loop, as_event_command* cmd)
 bool
 as_event_proto_parse(as_event_command* cmd, as_proto* proto)
 {
+	if (! cmd->proto_type_rcv) {
+		// First response header of this attempt.
+		as_event_command_trace(cmd, AS_TRACE_FIRST_BYTE, AEROSPIKE_OK);
+	}
+
 	if (proto->version != AS_PROTO_VERSION) {
 		as_error err;
 		as_proto_version_error(&err, proto);
@@ -717,7 +2058,7 @@ as_event_proto_parse(as_event_command* cmd, as_proto* proto)
 		return false;
 	}
 
-	if (proto->type != cmd->proto_type && proto->type != AS_COMPRESSED_MESSAGE_TYPE) {
+	if (proto->type != cmd->proto_type && ! as_proto_is_compressed(proto->type)) {
 		as_error err;
 		as_proto_type_error(&err, proto, cmd->proto_type);
 		as_event_parse_error(cmd, &err);
@@ -733,6 +2074,12 @@ as_event_proto_parse(as_event_command* cmd, as_proto* proto)
 		as_event_parse_error(cmd, &err);
 		return false;
 	}
+
+	if (cmd->pipe_listener && cmd->cluster->pipe_large_response_size > 0 &&
+		proto->sz > cmd->cluster->pipe_large_response_size) {
+		// Do not queue new commands behind this response.
+		((as_pipe_connection*)cmd->conn)->large = true;
+	}
 	return true;
 }
 
@@ -764,47 +2111,108 @@ as_event_proto_parse_auth(as_event_command* cmd, as_proto* proto)
 	return true;
 }
 
+static uint8_t*
+as_event_decompress_buffer(as_event_loop* event_loop, uint32_t size)
+{
+	if (size > event_loop->decompress_capacity) {
+		cf_free(event_loop->decompress_buf);
+		event_loop->decompress_capacity = (size + 16383) & ~16383; // Round up in 16KB increments.
+		event_loop->decompress_buf = cf_malloc(event_loop->decompress_capacity);
+	}
+	event_loop->decompress_last_used = cf_getms();
+	return event_loop->decompress_buf;
+}
+
+// Decompress response block in place of the compressed block. Worker threads can not use
+// the event loop's scratch buffer, so they copy the compressed bytes to a temporary buffer.
+static as_status
+as_event_decompress_block(as_event_command* cmd, as_error* err, bool worker)
+{
+	size_t size = (size_t)cf_swap_from_be64(*(uint64_t*)cmd->buf);
+
+	if (size > PROTO_SIZE_MAX) {
+		return as_proto_size_error(err, size);
+	}
+
+	uint8_t* src;
+	uint8_t* trg;
+
+	if (size <= cmd->read_capacity) {
+		// Decompress into the command's read buffer. Move the compressed bytes to the event
+		// loop's scratch buffer first, so they are not overwritten while decompressing.
+		src = worker ? cf_malloc(cmd->len) : as_event_decompress_buffer(cmd->event_loop, cmd->len);
+		memcpy(src, cmd->buf, cmd->len);
+		trg = cmd->buf;
+	}
+	else {
+		src = cmd->buf;
+		trg = cf_malloc(size);
+	}
+
+	as_status status = as_proto_decompress(err, cmd->proto_type_rcv, cmd->cluster->compress_stats,
+		trg, size, src, cmd->len);
+
+	if (worker && trg == cmd->buf) {
+		cf_free(src);
+	}
+
+	if (status != AEROSPIKE_OK) {
+		if (trg != cmd->buf) {
+			cf_free(trg);
+		}
+		return status;
+	}
+
+	if (cmd->metrics) {
+		as_node_add_compressed_in(cmd->metrics, sizeof(as_proto) + cmd->len, size);
+	}
+
+	if (trg != cmd->buf) {
+		if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
+			cf_free(cmd->buf);
+			as_event_command_budget_uncharge(cmd, cmd->read_capacity);
+		}
+		// Keep the larger buffer, so subsequent responses on this command can be read and
+		// decompressed without allocating.
+		cmd->buf = trg;
+		cmd->read_capacity = (uint32_t)size;
+		cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
+		as_event_command_budget_charge(cmd, cmd->read_capacity);
+	}
+	cmd->len = (uint32_t)size;
+	cmd->pos = sizeof(as_proto);
+	return AEROSPIKE_OK;
+}
+
 bool
 as_event_decompress(as_event_command* cmd)
 {
 	as_error err;
-	size_t size = (size_t)cf_swap_from_be64(*(uint64_t*)cmd->buf);
-
-	if (size > PROTO_SIZE_MAX) {
-		as_proto_size_error(&err, size);
-		as_event_parse_error(cmd, &err);
-		return false;
-	}
-
-	uint8_t* buf = cf_malloc(size);
 
-	if (as_proto_decompress(&err, buf, size, cmd->buf, cmd->len) != AEROSPIKE_OK) {
-		cf_free(buf);
+	if (as_event_decompress_block(cmd, &err, false) != AEROSPIKE_OK) {
 		as_event_parse_error(cmd, &err);
 		return false;
 	}
-
-	if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-		cf_free(cmd->buf);
-	}
-	cmd->buf = buf;
-	cmd->len = (uint32_t)size;
-	cmd->pos = sizeof(as_proto);
-	cmd->read_capacity = cmd->len;
-	cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
 	return true;
 }
 
 void
 as_event_socket_timeout(as_event_command* cmd)
 {
-	if (cmd->flags & AS_ASYNC_FLAGS_EVENT_RECEIVED) {
+	if (cmd->state == AS_ASYNC_STATE_OFFLOAD) {
+		// A worker thread owns the command buffer. Check timeouts when it returns.
+		as_event_timer_again(cmd);
+		return;
+	}
+
+	// Do not apply socket timeout while flow control has paused reading.
+	if ((cmd->flags & AS_ASYNC_FLAGS_EVENT_RECEIVED) || cmd->state == AS_ASYNC_STATE_PAUSED) {
 		// Event(s) received within socket timeout period.
 		cmd->flags &= ~AS_ASYNC_FLAGS_EVENT_RECEIVED;
 
 		if (cmd->total_deadline > 0) {
 			// Check total timeout.
-			uint64_t now = cf_getms();
+			uint64_t now = as_clock_getms();
 
 			if (now >= cmd->total_deadline) {
 				as_event_timer_stop(cmd);
@@ -830,7 +2238,8 @@ as_event_socket_timeout(as_event_command* cmd)
 		return;
 	}
 
-	as_node_add_timeout(cmd->node, cmd->ns, cmd->metrics);
+	as_event_add_timeout(cmd);
+	as_event_add_node_sample(cmd, true);
 
 	if (cmd->pipe_listener) {
 		as_pipe_timeout(cmd, true);
@@ -886,6 +2295,15 @@ as_event_process_timer(as_event_command* cmd)
 			as_event_execute_retry(cmd);
 			break;
 
+		case AS_ASYNC_STATE_HEDGE:
+			// Hedge delay expired before first response.
+			as_event_hedge_start(cmd);
+			break;
+
+		case AS_ASYNC_STATE_OFFLOAD:
+			// Total timeout is checked when the worker thread returns.
+			break;
+
 		default:
 			// Total timeout.
 			as_event_total_timeout(cmd);
@@ -896,8 +2314,13 @@ as_event_process_timer(as_event_command* cmd)
 void
 as_event_total_timeout(as_event_command* cmd)
 {
+	if (cmd->state == AS_ASYNC_STATE_PAUSED) {
+		as_event_executor_remove_paused(cmd);
+	}
+
 	// Node should not be null at this point.
-	as_node_add_timeout(cmd->node, cmd->ns, cmd->metrics);
+	as_event_add_timeout(cmd);
+	as_event_add_node_sample(cmd, true);
 	
 	if (cmd->pipe_listener) {
 		as_pipe_timeout(cmd, false);
@@ -916,8 +2339,7 @@ bool
 as_event_socket_retry(as_event_command* cmd)
 {
 	if (cmd->metrics) {
-		as_node_add_bytes_out(cmd->metrics, cmd->bytes_out);
-		as_node_add_bytes_in(cmd->metrics, cmd->bytes_in);
+		as_event_add_bytes(cmd);
 	}
 
 	if (cmd->pipe_listener) {
@@ -937,6 +2359,11 @@ as_event_command_retry(as_event_command* cmd, bool timeout)
 		return false;
 	}
 
+	if (! as_cluster_retry_budget_allow(cmd->cluster)) {
+		return false;
+	}
+	as_event_command_trace(cmd, AS_TRACE_RETRY, AEROSPIKE_OK);
+
 	// Alternate between master and prole on socket errors or database reads.
 	// Timeouts are not a good indicator of impending data migration.
 	if (! timeout || ((cmd->flags & AS_ASYNC_FLAGS_READ) &&
@@ -979,7 +2406,7 @@ as_event_execute_retry(as_event_command* cmd)
 	// Restore timer that was reset for retry.
 	if (cmd->total_deadline > 0) {
 		// Check total timeout.
-		uint64_t now = cf_getms();
+		uint64_t now = as_clock_getms();
 
 		if (now >= cmd->total_deadline) {
 			as_event_total_timeout(cmd);
@@ -1016,27 +2443,434 @@ as_event_execute_retry(as_event_command* cmd)
 	as_event_command_begin(cmd->event_loop, cmd);
 }
 
+//---------------------------------
+// Response Offload
+//---------------------------------
+
+#define AS_EVENT_OFFLOAD_PARSE 0 // Parse block in event loop thread.
+#define AS_EVENT_OFFLOAD_MORE 1 // Batch block parsed. Read next block.
+#define AS_EVENT_OFFLOAD_LAST 2 // Batch last block parsed.
+#define AS_EVENT_OFFLOAD_PARSE_ERROR 3
+#define AS_EVENT_OFFLOAD_RESPONSE_ERROR 4
+
+typedef struct {
+	as_event_command* cmd;
+	as_error err;
+	int result;
+} as_event_offload_task;
+
+static void
+as_event_offload_complete(as_event_loop* event_loop, as_event_offload_task* task)
+{
+	as_event_command* cmd = task->cmd;
+	int result = task->result;
+
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+	if (cmd->total_deadline > 0 && as_clock_getms() >= cmd->total_deadline) {
+		// Total timeout expired while the worker thread processed the block.
+		as_event_add_timeout(cmd);
+		as_error_update(&task->err, AEROSPIKE_ERR_TIMEOUT,
+			"Client timeout: iterations=%u lastNode=%s", cmd->iteration + 1,
+			as_node_get_address_string(cmd->node));
+		result = AS_EVENT_OFFLOAD_PARSE_ERROR;
+	}
+	else if (cmd->cancel && as_async_cancel_is_aborted(cmd->cancel)) {
+		as_error_set_message(&task->err, AEROSPIKE_ERR_CLIENT_ABORT, "Command aborted");
+		result = AS_EVENT_OFFLOAD_PARSE_ERROR;
+	}
+
+	switch (result) {
+		case AS_EVENT_OFFLOAD_PARSE_ERROR:
+			// Closes connection.
+			as_event_parse_error(cmd, &task->err);
+			cf_free(task);
+			return;
+
+		case AS_EVENT_OFFLOAD_RESPONSE_ERROR:
+			as_event_response_error(cmd, &task->err);
+			cf_free(task);
+			return;
+
+		case AS_EVENT_OFFLOAD_LAST:
+			cf_free(task);
+			as_batch_async_node_complete(cmd);
+			return;
+
+		case AS_EVENT_OFFLOAD_PARSE:
+			cf_free(task);
+
+			if (cmd->parse_results(cmd)) {
+				return;
+			}
+			break;
+
+		default:
+			cf_free(task);
+			break;
+	}
+
+	// Batch, scan, query is not finished. Read next header.
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	if (! as_event_command_pause(cmd)) {
+		as_event_command_resume_read(cmd);
+	}
+}
+
+static void
+as_event_offload_worker(void* udata)
+{
+	as_event_offload_task* task = udata;
+	as_event_command* cmd = task->cmd;
+
+	if (as_proto_is_compressed(cmd->proto_type_rcv) &&
+		as_event_decompress_block(cmd, &task->err, true) != AEROSPIKE_OK) {
+		task->result = AS_EVENT_OFFLOAD_PARSE_ERROR;
+	}
+	else if (cmd->type == AS_ASYNC_TYPE_BATCH) {
+		bool last;
+
+		if (as_batch_async_parse_block(cmd, &task->err, &last) != AEROSPIKE_OK) {
+			task->result = AS_EVENT_OFFLOAD_RESPONSE_ERROR;
+		}
+		else {
+			task->result = last ? AS_EVENT_OFFLOAD_LAST : AS_EVENT_OFFLOAD_MORE;
+		}
+	}
+	else {
+		// Scan and query records are passed to the user listener in the event loop thread.
+		task->result = AS_EVENT_OFFLOAD_PARSE;
+	}
+
+	if (! as_event_execute(cmd->event_loop, (as_event_executable)as_event_offload_complete, task)) {
+		// Event loops are only closed after all commands have completed.
+		as_log_error("Failed to queue offloaded command to event loop %u", cmd->event_loop->index);
+	}
+}
+
+bool
+as_event_offload(as_event_command* cmd)
+{
+	as_cluster* cluster = cmd->cluster;
+
+	if (cluster->offload_threshold == 0 || cmd->len < cluster->offload_threshold ||
+		cluster->thread_pool->thread_size == 0 || cmd->pipe_listener) {
+		return false;
+	}
+
+	switch (cmd->type) {
+		case AS_ASYNC_TYPE_BATCH:
+			if (cmd->hedge) {
+				// Rows of hedged batches are claimed in the event loop thread.
+				return false;
+			}
+			break;
+
+		case AS_ASYNC_TYPE_SCAN:
+		case AS_ASYNC_TYPE_SCAN_PARTITION:
+		case AS_ASYNC_TYPE_QUERY:
+		case AS_ASYNC_TYPE_QUERY_PARTITION:
+			break;
+
+		default:
+			return false;
+	}
+
+	// Stop reading while the worker thread owns the command buffer.
+	as_event_stop_watcher(cmd, cmd->conn);
+	cmd->state = AS_ASYNC_STATE_OFFLOAD;
+
+	as_event_offload_task* task = cf_malloc(sizeof(as_event_offload_task));
+	task->cmd = cmd;
+	task->result = AS_EVENT_OFFLOAD_PARSE;
+
+	if (as_work_pool_queue_task(cluster->thread_pool, AS_WORK_PRIORITY_HIGH,
+		as_event_offload_worker, task) != 0) {
+		// Pool is shutting down. Process block now and complete on the next loop iteration.
+		as_event_offload_worker(task);
+	}
+	return true;
+}
+
+//---------------------------------
+// Hedged Reads
+//---------------------------------
+
+struct as_event_hedge;
+
+typedef struct {
+	struct as_event_hedge* hedge;
+	as_event_command* cmd; // NULL when command completed or was cancelled.
+} as_event_hedge_leg;
+
+// Shared state of a record read and its hedged duplicate. legs[0] is the original command
+// and legs[1] is the hedge command.
+typedef struct as_event_hedge {
+	as_event_hedge_leg legs[2];
+	as_cluster* cluster;
+	as_async_record_listener listener;
+	void* udata;
+	uint32_t delay;
+	bool starting;
+} as_event_hedge;
+
+// Close connection of a command in process. The server response may still be in flight,
+// so the connection can not be returned to the pool.
+static void
+as_event_command_close_conn(as_event_command* cmd)
+{
+	as_event_connection* conn = cmd->conn;
+
+	if (conn) {
+		as_async_conn_pool* pool = &cmd->node->async_conn_pools[cmd->event_loop->index];
+
+		if (conn->watching > 0) {
+			as_event_stop_watcher(cmd, conn);
+			as_event_release_connection(conn, pool);
+		}
+		else {
+			cf_free(conn);
+			as_queue_decr_total(&pool->queue);
+			pool->closed++;
+		}
+	}
+}
+
+void
+as_event_command_cancel(as_event_command* cmd)
+{
+	as_event_timer_stop(cmd);
+
+	switch (cmd->state) {
+		case AS_ASYNC_STATE_UNREGISTERED:
+		case AS_ASYNC_STATE_REGISTERED:
+		case AS_ASYNC_STATE_HEDGE:
+			// Command was never started. Registered commands must have been scheduled by a
+			// timer in this event loop (see as_event_command_schedule()).
+			cmd->state = AS_ASYNC_STATE_QUEUE_ERROR;
+			as_event_command_release(cmd);
+			return;
+
+		case AS_ASYNC_STATE_DELAY_QUEUE:
+			// Command is released when it's popped from the delay queue.
+			cmd->state = AS_ASYNC_STATE_QUEUE_ERROR;
+			return;
+
+		default:
+			break;
+	}
+
+	// Command is in process. Close connection without notifying the listener.
+	as_event_command_close_conn(cmd);
+	as_event_command_release(cmd);
+}
+
+static void
+as_event_hedge_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	as_event_hedge_leg* leg = udata;
+	as_event_hedge* hedge = leg->hedge;
+	as_event_hedge_leg* other = (leg == &hedge->legs[0])? &hedge->legs[1] : &hedge->legs[0];
+
+	leg->cmd = NULL;
+
+	if (other->cmd) {
+		if (err && err->code != AEROSPIKE_ERR_RECORD_NOT_FOUND &&
+			other->cmd->state != AS_ASYNC_STATE_UNREGISTERED &&
+			other->cmd->state != AS_ASYNC_STATE_HEDGE) {
+			// Other command is in process. Let it determine the result.
+			return;
+		}
+		as_event_command_cancel(other->cmd);
+		other->cmd = NULL;
+	}
+
+	if (leg == &hedge->legs[1]) {
+		as_cluster_add_hedge_win(hedge->cluster);
+	}
+
+	as_async_record_listener listener = hedge->listener;
+	void* user_data = hedge->udata;
+
+	if (! hedge->starting) {
+		cf_free(hedge);
+	}
+	listener(err, rec, user_data, event_loop);
+}
+
+static void
+as_event_hedge_start(as_event_command* cmd)
+{
+	if (cmd->type == AS_ASYNC_TYPE_BATCH) {
+		// Hedge delay of a batch expired.
+		as_batch_hedge_async(cmd);
+		return;
+	}
+
+	as_event_hedge* hedge = ((as_event_hedge_leg*)cmd->udata)->hedge;
+	as_event_command* orig = hedge->legs[0].cmd;
+
+	if (orig->total_deadline > 0) {
+		uint64_t now = as_clock_getms();
+
+		if (now >= orig->total_deadline) {
+			// Original command is about to time out.
+			hedge->legs[1].cmd = NULL;
+			as_event_command_cancel(cmd);
+			return;
+		}
+		// Hedge command uses the original command's remaining total timeout.
+		cmd->total_deadline = orig->total_deadline - now;
+	}
+
+	// Target the next replica after the original command's current replica.
+	cmd->replica_index = orig->replica_index + 1;
+	cmd->state = AS_ASYNC_STATE_UNREGISTERED;
+	as_cluster_add_hedge(hedge->cluster);
+	as_event_command_execute_in_loop(cmd->event_loop, cmd);
+}
+
+static void
+as_event_hedge_execute_in_loop(as_event_loop* event_loop, as_event_hedge* hedge)
+{
+	// The original command may complete (with an error) before returning, so the hedge state
+	// is not freed by the listener until the hedge timer has been scheduled.
+	hedge->starting = true;
+	as_event_command_execute_in_loop(event_loop, hedge->legs[0].cmd);
+	hedge->starting = false;
+
+	as_event_command* cmd = hedge->legs[1].cmd;
+
+	if (! cmd) {
+		// Original command completed and hedge command was cancelled.
+		cf_free(hedge);
+		return;
+	}
+
+	// Callback is as_event_process_timer().
+	cmd->state = AS_ASYNC_STATE_HEDGE;
+	as_event_timer_once(cmd, hedge->delay);
+}
+
+as_status
+as_event_command_execute_hedge(as_event_command* cmd, uint32_t hedge_delay, as_error* err)
+{
+	// Hedging applies to single record reads only (AS_ASYNC_TYPE_RECORD).
+	if (cmd->replica_size <= 1 || cmd->pipe_listener || cmd->txn ||
+		(cmd->total_deadline > 0 && cmd->total_deadline <= hedge_delay)) {
+		return as_event_command_execute(cmd, err);
+	}
+
+	// Single record reads are never admitted against the memory budget.
+	cmd->budget_size = 0;
+
+	// The hedge command copy reports under the same trace id and slow log begin time.
+	cmd->slow_begin = cmd->cluster->slow_log ? cf_getns() : 0;
+	cmd->trace_id = as_cluster_trace_begin(cmd->cluster);
+	as_event_command_trace(cmd, AS_TRACE_START, AEROSPIKE_OK);
+
+	as_event_hedge* hedge = cf_malloc(sizeof(as_event_hedge));
+	as_async_record_command* rcmd = (as_async_record_command*)cmd;
+
+	hedge->cluster = cmd->cluster;
+	hedge->listener = rcmd->listener;
+	hedge->udata = cmd->udata;
+	hedge->delay = hedge_delay;
+	hedge->starting = false;
+	hedge->legs[0].hedge = hedge;
+	hedge->legs[0].cmd = cmd;
+	hedge->legs[1].hedge = hedge;
+
+	rcmd->listener = as_event_hedge_listener;
+	cmd->udata = &hedge->legs[0];
+
+	// Duplicate command. The read buffer does not need to be copied, but the command is
+	// copied in a single block for simplicity.
+	size_t size = (size_t)(cmd->buf - (uint8_t*)cmd) + cmd->write_len + cmd->read_capacity;
+	size_t alloc_size = size;
+	as_event_command* hcmd = as_event_command_alloc(cmd->cluster, cmd->event_loop, &alloc_size);
+	uint8_t pool_class = hcmd->pool_class;
+
+	memcpy(hcmd, cmd, size);
+	hcmd->pool_class = pool_class;
+	hcmd->buf = (uint8_t*)hcmd + (cmd->buf - (uint8_t*)cmd);
+	hcmd->udata = &hedge->legs[1];
+
+	if (cmd->ubuf) {
+		hcmd->ubuf = cf_malloc(cmd->ubuf_size);
+		memcpy(hcmd->ubuf, cmd->ubuf, cmd->ubuf_size);
+	}
+	hedge->legs[1].cmd = hcmd;
+
+	cmd->command_sent_counter = 0;
+	hcmd->command_sent_counter = 0;
+
+	as_event_loop* event_loop = cmd->event_loop;
+
+	if (as_in_event_loop(event_loop->thread)) {
+		as_event_hedge_execute_in_loop(event_loop, hedge);
+		return AEROSPIKE_OK;
+	}
+
+	// Send command through queue so it can be executed in event loop thread.
+	if (cmd->total_deadline > 0) {
+		// Convert total timeout to deadline.
+		cmd->total_deadline += as_clock_getms();
+	}
+	cmd->state = AS_ASYNC_STATE_REGISTERED;
+
+	if (! as_event_execute(event_loop, (as_event_executable)as_event_hedge_execute_in_loop, hedge)) {
+		event_loop->errors++;  // May not be in event loop thread, so not exactly accurate.
+		as_event_command_destroy(hcmd);
+		as_event_command_destroy(cmd);
+		cf_free(hedge);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to queue command");
+	}
+	return AEROSPIKE_OK;
+}
+
 static inline void
 as_event_put_connection(as_event_command* cmd, as_async_conn_pool* pool)
 {
 	as_event_set_conn_last_used(cmd->conn);
 
-	if (! as_async_conn_pool_push_head(pool, cmd->conn)) {
+	if (as_load_uint64(&cmd->node->tcp_info_next)) {
+		as_node_check_tcp_info(cmd->node, as_event_conn_fd(cmd->conn), cf_getns());
+	}
+
+	// Draining event loops do not keep connections for future commands.
+	if (cmd->event_loop->draining || ! as_async_conn_pool_push_head(pool, cmd->conn)) {
 		as_event_release_connection(cmd->conn, pool);
 	}
 }
 
+static void
+as_event_slow_log(as_event_command* cmd, as_status status);
+
 void
 as_event_response_complete(as_event_command* cmd)
 {
+	as_event_command_trace(cmd, AS_TRACE_PARSED, AEROSPIKE_OK);
+	as_event_command_trace(cmd, AS_TRACE_COMPLETE, AEROSPIKE_OK);
+
+	if (cmd->slow_begin) {
+		as_event_slow_log(cmd, AEROSPIKE_OK);
+	}
+
 	if (cmd->metrics) {
-		as_node_add_bytes_out(cmd->metrics, cmd->bytes_out);
-		as_node_add_bytes_in(cmd->metrics, cmd->bytes_in);
+		as_event_add_bytes(cmd);
 
 		if (cmd->latency_type != AS_LATENCY_TYPE_NONE) {
-			as_event_add_latency(cmd, cmd->latency_type);
+			as_event_add_command_latency(cmd);
 		}
+		as_event_add_heat_latency(cmd);
 	}
+	as_event_add_node_sample(cmd, false);
+	as_node_breaker_success(cmd->node);
+	as_cluster_retry_budget_success(cmd->cluster);
 
 	if (cmd->pipe_listener != NULL) {
 		as_pipe_response_complete(cmd);
@@ -1072,10 +2906,35 @@ as_event_executor_destroy(as_event_executor* executor)
 	if (executor->ns) {
 		cf_free(executor->ns);
 	}
+
+	if (executor->flow && executor->flow->executor == executor) {
+		executor->flow->executor = NULL;
+	}
+
+	if (executor->paused) {
+		cf_free(executor->paused);
+	}
 	
 	cf_free(executor);
 }
 
+static void
+as_event_executor_finish_in_loop(as_event_loop* event_loop, void* udata)
+{
+	as_event_executor* executor = udata;
+	executor->complete_fn(executor);
+	as_event_executor_destroy(executor);
+}
+
+// Call complete_fn in the executor's event loop when node commands were spread over other
+// event loops. Return false if complete_fn must be called by the current thread.
+static inline bool
+as_event_executor_finish_spread(as_event_executor* executor)
+{
+	return executor->spread &&
+		as_event_execute(executor->event_loop, as_event_executor_finish_in_loop, executor);
+}
+
 void
 as_event_executor_error(as_event_executor* executor, as_error* err, uint32_t command_count)
 {
@@ -1086,8 +2945,9 @@ as_event_executor_error(as_event_executor* executor, as_error* err, uint32_t com
 	bool first_error = executor->valid;
 	executor->valid = false;
 
-	if (executor->max_concurrent == 1) {
-		// Add current command that failed when running commands in sequence.
+	if (executor->max_concurrent == 1 || executor->adaptive) {
+		// Add current command that failed when running commands in sequence or with
+		// adaptive concurrency. Commands that were never queued will not run.
 		executor->count++;
 		complete = executor->count == executor->queued;
 	}
@@ -1097,11 +2957,24 @@ as_event_executor_error(as_event_executor* executor, as_error* err, uint32_t com
 		complete = executor->count == executor->max;
 	}
 
+	if (first_error && (executor->spread || ! complete)) {
+		// Save first error only. Spread executors complete in other threads, so the error
+		// must be saved before the lock is released.
+		executor->err = cf_malloc(sizeof(as_error));
+		as_error_copy(executor->err, err);
+	}
+
 	pthread_mutex_unlock(&executor->lock);
 
 	if (complete) {
 		// All commands have completed.
-		if (first_error) {
+		if (executor->spread) {
+			if (as_event_executor_finish_spread(executor)) {
+				return;
+			}
+			executor->complete_fn(executor);
+		}
+		else if (first_error) {
 			// Original error can be used directly.
 			executor->err = err;
 			executor->complete_fn(executor);
@@ -1114,9 +2987,8 @@ as_event_executor_error(as_event_executor* executor, as_error* err, uint32_t com
 		as_event_executor_destroy(executor);
 	}
 	else if (first_error) {
-		// Save first error only.
-		executor->err = cf_malloc(sizeof(as_error));
-		as_error_copy(executor->err, err);
+		// Let paused commands run, so they can detect the failure and finish.
+		as_event_executor_resume(executor);
 	}
 }
 
@@ -1135,7 +3007,7 @@ as_event_executor_cancel(as_event_executor* executor, uint32_t queued_count)
 	executor->notify = false;
 	executor->valid = false;
 
-	if (executor->max_concurrent == 1) {
+	if (executor->max_concurrent == 1 || executor->adaptive) {
 		// Add current task that failed when running commands in sequence.
 		executor->count++;
 		complete = executor->count == executor->queued;
@@ -1153,33 +3025,121 @@ as_event_executor_cancel(as_event_executor* executor, uint32_t queued_count)
 	}
 }
 
+void
+as_event_executor_set_concurrency(as_event_executor* executor, uint32_t max_concurrent, bool adaptive)
+{
+	// Adaptive concurrency is not used with cluster change validation.
+	executor->adaptive = adaptive && max_concurrent > AS_EVENT_ADAPTIVE_START &&
+		! executor->cluster_key;
+
+	if (executor->adaptive) {
+		executor->max_concurrent = AS_EVENT_ADAPTIVE_START;
+		executor->adapt_begin = cf_getns();
+		executor->adapt_rate = 0;
+		executor->adapt_count = 0;
+	}
+	else {
+		executor->max_concurrent = max_concurrent;
+	}
+}
+
+// Must hold executor lock.
+static void
+as_event_executor_adapt(as_event_executor* executor)
+{
+	// Measure the completion rate over a window in which each running command completes
+	// about once.
+	if (++executor->adapt_count < executor->max_concurrent) {
+		return;
+	}
+
+	uint64_t now = cf_getns();
+	uint64_t elapsed = now - executor->adapt_begin;
+
+	if (elapsed == 0) {
+		return;
+	}
+
+	uint64_t rate = (uint64_t)executor->adapt_count * 1000000000 / elapsed;
+	uint64_t prev = executor->adapt_rate;
+
+	as_event_loop* event_loop = executor->event_loop;
+	uint32_t lag_target = event_loop->monitor.lag_threshold_us;
+
+	if (lag_target == 0) {
+		lag_target = AS_EVENT_ADAPTIVE_LAG_US;
+	}
+
+	uint32_t c = executor->max_concurrent;
+
+	// Concurrency is reduced by at most one per completion, because each completion
+	// starts one less command than the previous concurrency.
+	if (as_event_loop_get_lag(event_loop) > lag_target) {
+		// Event loop is saturated.
+		if (c > 1) {
+			c--;
+		}
+	}
+	else if (rate * 8 > prev * 9) {
+		// Throughput still improves with more commands.
+		c += c / 4 + 1;
+	}
+	else if (rate * 8 < prev * 7 && c > 1) {
+		// Throughput dropped.
+		c--;
+	}
+
+	if (c > executor->max) {
+		c = executor->max;
+	}
+
+	executor->max_concurrent = c;
+	executor->adapt_rate = rate;
+	executor->adapt_count = 0;
+	executor->adapt_begin = now;
+}
+
 void
 as_event_executor_complete(as_event_executor* executor)
 {
 	pthread_mutex_lock(&executor->lock);
 	executor->count++;
-	uint32_t next = executor->count + executor->max_concurrent - 1;
-	bool complete = executor->count == executor->max;
-	bool start_new_command = next < executor->max && executor->valid;
+
+	// Commands [begin, end) are started by this completion.
+	uint32_t begin = executor->count + executor->max_concurrent - 1;
+
+	if (executor->adaptive && executor->valid) {
+		as_event_executor_adapt(executor);
+	}
+
+	uint32_t end = executor->count + executor->max_concurrent;
+	bool complete = executor->count == executor->max ||
+		(executor->adaptive && ! executor->valid && executor->count == executor->queued);
+	bool start_new_command = begin < end && begin < executor->max && executor->valid;
 	pthread_mutex_unlock(&executor->lock);
 
 	if (complete) {
 		// All commands completed.
+		if (as_event_executor_finish_spread(executor)) {
+			return;
+		}
 		executor->complete_fn(executor);
 		as_event_executor_destroy(executor);
 	}
 	else {
 		// Determine if a new command needs to be started.
 		if (start_new_command) {
-			if (executor->cluster_key) {
-				as_query_validate_next_async(executor, next);
+			if (end > executor->max) {
+				end = executor->max;
 			}
-			else {
+
+			for (uint32_t next = begin; next < end; next++) {
 				as_error err;
 				executor->queued++;
 
 				if (as_event_command_execute(executor->commands[next], &err) != AEROSPIKE_OK) {
 					as_event_executor_error(executor, &err, executor->max - next);
+					break;
 				}
 			}
 		}
@@ -1230,6 +3190,7 @@ as_event_error_callback(as_event_command* cmd, as_error* err)
 	    (cmd->type == AS_ASYNC_TYPE_QUERY_PARTITION &&
 		as_async_query_should_retry(cmd, err->code))) {
 		as_event_executor* executor = cmd->udata;
+		as_event_command_trace(cmd, AS_TRACE_COMPLETE, err->code);
 		as_event_command_release(cmd);
 		as_event_executor_complete(executor);
 		return;
@@ -1291,6 +3252,55 @@ as_event_command_parse_set_digest(as_event_command* cmd, as_error* err, char* se
 	return AEROSPIKE_OK;
 }
 
+static void
+as_event_slow_log(as_event_command* cmd, as_status status)
+{
+	uint64_t elapsed = cf_getns() - cmd->slow_begin;
+	as_slow_log* log = cmd->cluster->slow_log;
+
+	if (! as_slow_log_check(log, elapsed)) {
+		return;
+	}
+
+	// Connection wait time is not measured for async commands.
+	as_slow_command slow;
+	memset(&slow, 0, sizeof(as_slow_command));
+	slow.time_ms = cf_clock_getabsolute();
+	slow.elapsed_us = elapsed / 1000;
+	slow.bytes_out = cmd->bytes_out;
+	slow.bytes_in = cmd->bytes_in;
+	slow.retries = cmd->iteration;
+	slow.status = status;
+	slow.latency_type = cmd->latency_type;
+	slow.async = true;
+
+	if (cmd->ns) {
+		as_strncpy(slow.ns, cmd->ns, sizeof(slow.ns));
+	}
+
+	if (cmd->node) {
+		memcpy(slow.node, cmd->node->name, AS_NODE_NAME_SIZE);
+	}
+
+	// Single record commands no longer hold the key, so set and digest are parsed from
+	// the send buffer.
+	if (cmd->partition && (cmd->type == AS_ASYNC_TYPE_WRITE ||
+		cmd->type == AS_ASYNC_TYPE_RECORD || cmd->type == AS_ASYNC_TYPE_VALUE)) {
+		as_error err;
+		as_error_init(&err);
+
+		if (as_event_command_parse_set_digest(cmd, &err, slow.set, slow.digest) ==
+			AEROSPIKE_OK) {
+			slow.partition_id = cmd->partition_id;
+			slow.has_digest = true;
+		}
+		else {
+			slow.set[0] = 0;
+		}
+	}
+	as_slow_log_add(log, &slow);
+}
+
 static void
 as_event_check_in_doubt(as_event_command* cmd, as_error* err) {
 	if (err->in_doubt && cmd->txn) {
@@ -1312,11 +3322,16 @@ as_event_check_in_doubt(as_event_command* cmd, as_error* err) {
 	}
 }
 
-void as_async_batch_error(as_event_command* cmd, as_error* err);
+bool as_async_batch_error(as_event_command* cmd, as_error* err);
 
 void
 as_event_notify_error(as_event_command* cmd, as_error* err)
 {
+	as_event_command_trace(cmd, AS_TRACE_COMPLETE, err->code);
+
+	if (cmd->slow_begin) {
+		as_event_slow_log(cmd, err->code);
+	}
 	as_error_set_in_doubt(err, cmd->flags & AS_ASYNC_FLAGS_READ, cmd->command_sent_counter);
 
 	switch (cmd->type) {
@@ -1342,8 +3357,13 @@ as_event_notify_error(as_event_command* cmd, as_error* err)
 			connector_error(cmd, err);
 			break;
 		case AS_ASYNC_TYPE_BATCH:
-			as_async_batch_error(cmd, err);
-			as_event_executor_error(cmd->udata, err, 1);
+			if (as_async_batch_error(cmd, err)) {
+				as_event_executor_error(cmd->udata, err, 1);
+			}
+			else {
+				// Error does not apply to the hedged batch (see as_async_batch_error()).
+				as_event_executor_complete(cmd->udata);
+			}
 			break;
 		default:
 			// Handle command that is part of a group (scan, query).
@@ -1387,6 +3407,8 @@ as_event_socket_error(as_event_command* cmd, as_error* err)
 void
 as_event_response_error(as_event_command* cmd, as_error* err)
 {
+	as_event_command_trace(cmd, AS_TRACE_PARSED, err->code);
+
 	if (cmd->pipe_listener != NULL) {
 		as_pipe_response_error(cmd, err);
 		return;
@@ -1398,8 +3420,7 @@ as_event_response_error(as_event_command* cmd, as_error* err)
 	as_event_stop_watcher(cmd, cmd->conn);
 
 	if (cmd->metrics) {
-		as_node_add_bytes_out(cmd->metrics, cmd->bytes_out);
-		as_node_add_bytes_in(cmd->metrics, cmd->bytes_in);
+		as_event_add_bytes(cmd);
 	}
 
 	as_async_conn_pool* pool = &cmd->node->async_conn_pools[cmd->event_loop->index];
@@ -1407,9 +3428,14 @@ as_event_response_error(as_event_command* cmd, as_error* err)
 	// Close socket on errors that can leave unread data in socket.
 	switch (err->code) {
 		case AEROSPIKE_ERR_CLUSTER:
+			// Partition unavailable. Partition map may be stale.
+			as_cluster_hurry_tend(cmd->cluster);
+			// Fall through.
+
 		case AEROSPIKE_ERR_DEVICE_OVERLOAD:
 			as_node_add_error(cmd->node, cmd->ns, cmd->metrics);
 			as_node_incr_error_rate(cmd->node);
+			as_event_add_node_sample(cmd, true);
 			as_event_put_connection(cmd, pool);
 			break;
 
@@ -1426,7 +3452,8 @@ as_event_response_error(as_event_command* cmd, as_error* err)
 			break;
 		
 		case AEROSPIKE_ERR_TIMEOUT:
-			as_node_add_timeout(cmd->node, cmd->ns, cmd->metrics);
+			as_event_add_timeout(cmd);
+			as_event_add_node_sample(cmd, true);
 			as_event_put_connection(cmd, pool);
 			break;
 			
@@ -1434,18 +3461,33 @@ as_event_response_error(as_event_command* cmd, as_error* err)
 			// Do not increment error count on record not found.
 			// Add latency metrics instead.
 			if (cmd->metrics && cmd->latency_type != AS_LATENCY_TYPE_NONE) {
-				as_event_add_latency(cmd, cmd->latency_type);
+				as_event_add_command_latency(cmd);
 			}
+			as_event_add_heat_latency(cmd);
+			as_event_add_node_sample(cmd, false);
+			as_node_breaker_success(cmd->node);
+			as_cluster_retry_budget_success(cmd->cluster);
 			as_event_put_connection(cmd, pool);
 			break;
 
-		case AEROSPIKE_ERR_RECORD_BUSY:
+		case AEROSPIKE_ERR_RECORD_BUSY: {
 			as_node_add_key_busy(cmd->node, cmd->ns, cmd->metrics);
+
+			as_partition_heat* heat = as_event_partition_heat(cmd);
+
+			if (heat) {
+				as_partition_heat_add_key_busy(heat, cmd->partition_id);
+			}
+			as_node_breaker_success(cmd->node);
+			as_cluster_retry_budget_success(cmd->cluster);
 			as_event_put_connection(cmd, pool);
 			break;
+		}
 
 		default:
 			as_node_add_error(cmd->node, cmd->ns, cmd->metrics);
+			as_node_breaker_success(cmd->node);
+			as_cluster_retry_budget_success(cmd->cluster);
 			as_event_put_connection(cmd, pool);
 			break;
 	}
@@ -1526,13 +3568,25 @@ as_event_command_parse_result(as_event_command* cmd)
 		case AEROSPIKE_OK: {
 			if (cmd->flags & AS_ASYNC_FLAGS_HEAP_REC) {
 				// Create record on heap and let user call as_record_destroy() on success.
-				as_record* rec = as_record_new(msg->n_ops);
-
-				rec->gen = msg->generation;
-				rec->ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+				as_record* rec;
+
+				if (((as_async_record_command*)cmd)->zero_copy) {
+					// Command buffer is released after the listener, so copy bins once into
+					// the record's own allocation. The record is freed with a single free.
+					status = as_command_parse_record_arena(p, cmd->buf + cmd->len, &err,
+						msg->n_ops, cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE,
+						((as_async_record_command*)cmd)->lazy, &rec);
+				}
+				else {
+					rec = as_record_new_arena(msg->n_ops, 0, NULL);
+					status = as_command_parse_bins(&p, &err, rec, msg->n_ops,
+												   cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
+				}
 
-				status = as_command_parse_bins(&p, &err, rec, msg->n_ops,
-											   cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
+				if (rec) {
+					rec->gen = msg->generation;
+					rec->ttl = cf_server_void_time_to_ttl(msg->record_ttl);
+				}
 
 				if (status == AEROSPIKE_OK) {
 					as_event_response_complete(cmd);
@@ -1540,7 +3594,9 @@ as_event_command_parse_result(as_event_command* cmd)
 					as_event_command_release(cmd);
 				}
 				else {
-					as_record_destroy(rec);
+					if (rec) {
+						as_record_destroy(rec);
+					}
 					as_event_response_error(cmd, &err);
 				}
 			}
@@ -1558,8 +3614,16 @@ as_event_command_parse_result(as_event_command* cmd)
 				rec.gen = msg->generation;
 				rec.ttl = cf_server_void_time_to_ttl(msg->record_ttl);
 				
-				status = as_command_parse_bins(&p, &err, &rec, msg->n_ops,
-											   cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
+				if (((as_async_record_command*)cmd)->zero_copy) {
+					// Bin values can reference the command buffer directly because the listener
+					// completes before the command buffer is released.
+					status = as_command_parse_bins_wrap(&p, &err, &rec, msg->n_ops,
+														cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
+				}
+				else {
+					status = as_command_parse_bins(&p, &err, &rec, msg->n_ops,
+												   cmd->flags & AS_ASYNC_FLAGS_DESERIALIZE);
+				}
 
 				if (status == AEROSPIKE_OK) {
 					as_event_response_complete(cmd);
@@ -1581,7 +3645,7 @@ as_event_command_parse_result(as_event_command* cmd)
 		}
 			
 		default: {
-			as_error_update(&err, status, "%s %s", as_node_get_address_string(cmd->node), as_error_string(status));
+			as_error_set_prefix(&err, status, as_node_get_address_string(cmd->node), as_error_string(status));
 			as_event_response_error(cmd, &err);
 			break;
 		}
@@ -1637,7 +3701,7 @@ as_event_command_parse_success_failure(as_event_command* cmd)
 		}
 			
 		default: {
-			as_error_update(&err, status, "%s %s", as_node_get_address_string(cmd->node), as_error_string(status));
+			as_error_set_prefix(&err, status, as_node_get_address_string(cmd->node), as_error_string(status));
 			as_event_response_error(cmd, &err);
 			break;
 		}
@@ -1664,7 +3728,7 @@ as_event_command_parse_deadline(as_event_command* cmd)
 	status = msg->result_code;
 
 	if (status != AEROSPIKE_OK) {
-		as_error_update(&err, status, "%s %s", as_node_get_address_string(cmd->node), as_error_string(status));
+		as_error_set_prefix(&err, status, as_node_get_address_string(cmd->node), as_error_string(status));
 		as_event_response_error(cmd, &err);
 		return true;
 	}
@@ -1675,6 +3739,20 @@ as_event_command_parse_deadline(as_event_command* cmd)
 	return true;
 }
 
+bool
+as_event_command_parse_info_multi(as_event_command* cmd)
+{
+	uint8_t* p = cmd->buf + cmd->pos;
+	char* response = (char*)p;
+	response[cmd->len] = 0;
+
+	// Errors are embedded per command, so the listener validates each response line.
+	as_event_response_complete(cmd);
+	((as_async_info_command*)cmd)->listener(NULL, response, cmd->udata, cmd->event_loop);
+	as_event_command_release(cmd);
+	return true;
+}
+
 bool
 as_event_command_parse_info(as_event_command* cmd)
 {
@@ -1703,12 +3781,24 @@ as_event_command_free(as_event_command* cmd)
 {
 	as_event_loop* event_loop = cmd->event_loop;
 
+	if (cmd->type == AS_ASYNC_TYPE_BATCH && cmd->hedge) {
+		as_batch_hedge_unlink(cmd);
+	}
+
 	if (cmd->state != AS_ASYNC_STATE_QUEUE_ERROR) {
 		event_loop->pending--;
 		cmd->event_state->pending--;
+		event_loop->monitor.commands++;
+	}
+
+	if (cmd->cancel_state) {
+		as_async_cancel_unregister(cmd);
 	}
 
 	if (cmd->node) {
+		if (cmd->limited) {
+			as_node_limit_release(cmd->node);
+		}
 		as_node_release(cmd->node);
 	}
 
@@ -1720,7 +3810,15 @@ as_event_command_free(as_event_command* cmd)
 		cf_free(cmd->ubuf);
 	}
 
-	cf_free(cmd);
+	if (cmd->budget_size) {
+		as_mem_budget_release(cmd->cluster->mem_budget, cmd->budget_size);
+	}
+
+	if (cmd->order_hash) {
+		as_event_order_release(event_loop, cmd);
+	}
+
+	as_event_command_dealloc(cmd);
 
 	if (event_loop->max_commands_in_process > 0 && ! event_loop->using_delay_queue) {
 		// Try executing commands from the delay queue.
@@ -1728,6 +3826,347 @@ as_event_command_free(as_event_command* cmd)
 	}
 }
 
+//---------------------------------
+// Command Cancellation
+//---------------------------------
+
+#define AS_ASYNC_CANCEL_NONE 0
+#define AS_ASYNC_CANCEL_REGISTERED 1
+#define AS_ASYNC_CANCEL_ABORTING 2
+
+static void
+as_async_cancel_release(as_async_cancel* cancel)
+{
+	pthread_mutex_lock(&cancel->lock);
+	bool destroy = --cancel->ref_count == 0;
+	pthread_mutex_unlock(&cancel->lock);
+
+	if (destroy) {
+		pthread_mutex_destroy(&cancel->lock);
+		cf_free(cancel);
+	}
+}
+
+// Add command to the cancel handle's command list when the command first starts on its event
+// loop. Return false if the handle has already been aborted.
+static bool
+as_async_cancel_register(as_event_command* cmd)
+{
+	as_async_cancel* cancel = cmd->cancel;
+
+	pthread_mutex_lock(&cancel->lock);
+
+	if (cancel->aborted) {
+		pthread_mutex_unlock(&cancel->lock);
+		return false;
+	}
+
+	cmd->cancel_prev = NULL;
+	cmd->cancel_next = cancel->commands;
+
+	if (cancel->commands) {
+		cancel->commands->cancel_prev = cmd;
+	}
+	cancel->commands = cmd;
+	cancel->ref_count++;
+	cmd->cancel_state = AS_ASYNC_CANCEL_REGISTERED;
+	pthread_mutex_unlock(&cancel->lock);
+	return true;
+}
+
+static void
+as_async_cancel_unregister(as_event_command* cmd)
+{
+	as_async_cancel* cancel = cmd->cancel;
+
+	pthread_mutex_lock(&cancel->lock);
+
+	if (cmd->cancel_prev) {
+		cmd->cancel_prev->cancel_next = cmd->cancel_next;
+	}
+	else {
+		cancel->commands = cmd->cancel_next;
+	}
+
+	if (cmd->cancel_next) {
+		cmd->cancel_next->cancel_prev = cmd->cancel_prev;
+	}
+	pthread_mutex_unlock(&cancel->lock);
+
+	cmd->cancel_state = AS_ASYNC_CANCEL_NONE;
+	as_async_cancel_release(cancel);
+}
+
+static void
+as_event_command_abort(as_event_command* cmd)
+{
+	as_error err;
+	as_error_set_message(&err, AEROSPIKE_ERR_CLIENT_ABORT, "Command aborted");
+
+	switch (cmd->state) {
+		case AS_ASYNC_STATE_QUEUE_ERROR:
+			// Listener has already been notified.
+			return;
+
+		case AS_ASYNC_STATE_OFFLOAD:
+			// Command is aborted when the worker thread returns.
+			return;
+
+		case AS_ASYNC_STATE_DELAY_QUEUE:
+			// Notify user, but do not destroy command. The command is released when it's
+			// popped from the delay queue.
+			as_event_timer_stop(cmd);
+			cmd->state = AS_ASYNC_STATE_QUEUE_ERROR;
+			as_event_notify_error(cmd, &err);
+			return;
+
+		case AS_ASYNC_STATE_RETRY:
+			// Previous connection has already been released.
+			as_event_timer_stop(cmd);
+			as_event_error_callback(cmd, &err);
+			return;
+
+		case AS_ASYNC_STATE_PAUSED:
+			as_event_executor_remove_paused(cmd);
+			break;
+
+		default:
+			break;
+	}
+
+	if (cmd->pipe_listener) {
+		// Pipelined commands share their connection with other commands.
+		return;
+	}
+
+	as_event_timer_stop(cmd);
+	as_event_command_close_conn(cmd);
+	as_event_error_callback(cmd, &err);
+}
+
+static void
+as_async_cancel_run(as_event_loop* event_loop, as_async_cancel* cancel)
+{
+	// Aborting a command may free other commands (hedged reads), so the list is searched
+	// again after each abort.
+	while (true) {
+		pthread_mutex_lock(&cancel->lock);
+
+		as_event_command* cmd = cancel->commands;
+
+		while (cmd && (cmd->event_loop != event_loop ||
+			cmd->cancel_state != AS_ASYNC_CANCEL_REGISTERED)) {
+			cmd = cmd->cancel_next;
+		}
+
+		if (cmd) {
+			cmd->cancel_state = AS_ASYNC_CANCEL_ABORTING;
+		}
+		pthread_mutex_unlock(&cancel->lock);
+
+		if (! cmd) {
+			break;
+		}
+		as_event_command_abort(cmd);
+	}
+	as_async_cancel_release(cancel);
+}
+
+as_async_cancel*
+as_async_cancel_create(void)
+{
+	as_async_cancel* cancel = cf_malloc(sizeof(as_async_cancel));
+	pthread_mutex_init(&cancel->lock, NULL);
+	cancel->commands = NULL;
+	cancel->ref_count = 1;
+	cancel->aborted = false;
+	return cancel;
+}
+
+void
+as_async_cancel_destroy(as_async_cancel* cancel)
+{
+	as_async_cancel_release(cancel);
+}
+
+void
+as_async_cancel_abort(as_async_cancel* cancel)
+{
+	pthread_mutex_lock(&cancel->lock);
+
+	if (cancel->aborted) {
+		pthread_mutex_unlock(&cancel->lock);
+		return;
+	}
+	cancel->aborted = true;
+
+	// Find event loops that are processing commands for this handle. Commands that have
+	// not started yet are aborted when they start, because the aborted flag is now set.
+	bool* loops = cf_calloc(as_event_loop_size, sizeof(bool));
+	uint32_t count = 0;
+
+	for (as_event_command* cmd = cancel->commands; cmd; cmd = cmd->cancel_next) {
+		uint32_t index = cmd->event_loop->index;
+
+		if (! loops[index]) {
+			loops[index] = true;
+			count++;
+		}
+	}
+
+	// Each queued abort holds a reference to the handle.
+	cancel->ref_count += count;
+	pthread_mutex_unlock(&cancel->lock);
+
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		if (! loops[i]) {
+			continue;
+		}
+
+		as_event_loop* event_loop = &as_event_loops[i];
+
+		if (as_in_event_loop(event_loop->thread)) {
+			as_async_cancel_run(event_loop, cancel);
+		}
+		else if (! as_event_execute(event_loop, (as_event_executable)as_async_cancel_run, cancel)) {
+			as_log_warn("Failed to queue command abort to event loop %u", i);
+			as_async_cancel_release(cancel);
+		}
+	}
+	cf_free(loops);
+}
+
+bool
+as_async_cancel_is_aborted(as_async_cancel* cancel)
+{
+	pthread_mutex_lock(&cancel->lock);
+	bool aborted = cancel->aborted;
+	pthread_mutex_unlock(&cancel->lock);
+	return aborted;
+}
+
+//---------------------------------
+// Command Pool
+//---------------------------------
+
+#define AS_EVENT_COMMAND_POOL_MIN_SIZE 1024
+
+as_event_command*
+as_event_command_alloc(as_cluster* cluster, as_event_loop* event_loop, size_t* size)
+{
+	if (! as_allocator_is_default(&cluster->allocator)) {
+		// Command pools are shared by all instances, so do not pool custom allocations.
+		as_event_command* cmd = (as_event_command*)as_allocator_malloc(&cluster->allocator, *size);
+		cmd->pool_class = AS_EVENT_COMMAND_POOL_CUSTOM;
+		cmd->order_hash = 0;
+		cmd->cancel = NULL;
+		cmd->cancel_state = 0;
+		return cmd;
+	}
+
+	// Find smallest size class that covers the requested size.
+	size_t s = AS_EVENT_COMMAND_POOL_MIN_SIZE;
+	uint32_t i = 0;
+
+	while (s < *size && i < AS_EVENT_COMMAND_POOL_CLASSES) {
+		s <<= 1;
+		i++;
+	}
+
+	if (i == AS_EVENT_COMMAND_POOL_CLASSES) {
+		// Large commands are not pooled.
+		as_event_command* cmd = (as_event_command*)cf_malloc(*size);
+		cmd->pool_class = 0;
+		cmd->order_hash = 0;
+		cmd->cancel = NULL;
+		cmd->cancel_state = 0;
+		return cmd;
+	}
+
+	// Return full class size, so the caller can use the extra space for the read buffer.
+	*size = s;
+
+	as_event_command_pool* pool = &event_loop->cmd_pool;
+
+	pthread_mutex_lock(&pool->lock);
+
+	as_event_command* cmd = pool->free_list[i];
+
+	if (cmd) {
+		// Free list link is stored at the start of the freed command.
+		pool->free_list[i] = *(void**)cmd;
+		pool->free_size[i]--;
+	}
+
+	if (++pool->in_use > pool->high_water) {
+		pool->high_water = pool->in_use;
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+
+	if (! cmd) {
+		cmd = (as_event_command*)cf_malloc(s);
+		as_mem_stats_alloc(AS_MEM_TAG_COMMAND, s);
+	}
+	cmd->pool_class = (uint8_t)(i + 1);
+	cmd->order_hash = 0;
+	cmd->cancel = NULL;
+	cmd->cancel_state = 0;
+	return cmd;
+}
+
+void
+as_event_command_dealloc(as_event_command* cmd)
+{
+	if (cmd->pool_class == 0) {
+		cf_free(cmd);
+		return;
+	}
+
+	if (cmd->pool_class == AS_EVENT_COMMAND_POOL_CUSTOM) {
+		as_allocator_free(&cmd->cluster->allocator, cmd);
+		return;
+	}
+
+	uint32_t i = cmd->pool_class - 1;
+	as_event_command_pool* pool = &cmd->event_loop->cmd_pool;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->in_use--;
+
+	if (pool->free_size[i] < AS_EVENT_COMMAND_POOL_MAX) {
+		*(void**)cmd = pool->free_list[i];
+		pool->free_list[i] = cmd;
+		pool->free_size[i]++;
+		cmd = NULL;
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	if (cmd) {
+		// Free list is full.
+		cf_free(cmd);
+		as_mem_stats_free(AS_MEM_TAG_COMMAND, (size_t)AS_EVENT_COMMAND_POOL_MIN_SIZE << i);
+	}
+}
+
+void
+as_event_command_pool_destroy(as_event_command_pool* pool)
+{
+	for (uint32_t i = 0; i < AS_EVENT_COMMAND_POOL_CLASSES; i++) {
+		void* cmd = pool->free_list[i];
+
+		while (cmd) {
+			void* next = *(void**)cmd;
+			cf_free(cmd);
+			as_mem_stats_free(AS_MEM_TAG_COMMAND, (size_t)AS_EVENT_COMMAND_POOL_MIN_SIZE << i);
+			cmd = next;
+		}
+		pool->free_list[i] = NULL;
+		pool->free_size[i] = 0;
+	}
+	pthread_mutex_destroy(&pool->lock);
+}
+
 //---------------------------------
 // Connection Create
 //---------------------------------
@@ -1901,7 +4340,7 @@ connector_execute_command(as_event_loop* event_loop, connector_shared* cs)
 	event_loop->pending++;
 	cmd->event_state->pending++;
 
-	cmd->total_deadline = cf_getms() + cs->timeout_ms;
+	cmd->total_deadline = as_clock_getms() + cs->timeout_ms;
 	as_event_timer_once(cmd, cs->timeout_ms);
 
 	as_event_create_connection(cmd, cs->pool);
@@ -1917,11 +4356,18 @@ connector_create_commands(as_event_loop* event_loop, connector_shared* cs)
 	}
 }
 
+static inline uint32_t
+connector_max_concurrent(as_cluster* cluster, uint32_t loop_max)
+{
+	uint32_t max_concurrent = cluster->async_max_connects_per_loop;
+	return (max_concurrent > 0)? max_concurrent : 20 / loop_max + 1;
+}
+
 static void
 create_connections_wait(as_node* node, as_async_conn_pool* pools)
 {
 	uint32_t loop_max = as_event_loop_size;
-	uint32_t max_concurrent = 20 / loop_max + 1;
+	uint32_t max_concurrent = connector_max_concurrent(node->cluster, loop_max);
 	uint32_t timeout_ms = node->cluster->conn_timeout_ms;
 
 	connector_shared* array = alloca(sizeof(connector_shared) * loop_max);
@@ -1936,7 +4382,7 @@ create_connections_wait(as_node* node, as_async_conn_pool* pools)
 		as_async_conn_pool* pool = &pools[i];
 		uint32_t min_size = pool->min_size;
 
-		if (min_size > 0) {
+		if (min_size > 0 && ! as_event_loops[i].draining) {
 			connector_shared* cs = &array[i];
 			cs->parent = csw;
 			cs->node = node;
@@ -1971,7 +4417,7 @@ static void
 create_connections_nowait(as_node* node, as_async_conn_pool* pools)
 {
 	uint32_t loop_max = as_event_loop_size;
-	uint32_t max_concurrent = 20 / loop_max + 1;
+	uint32_t max_concurrent = connector_max_concurrent(node->cluster, loop_max);
 	uint32_t timeout_ms = node->cluster->conn_timeout_ms;
 
 	connector_shared* array = cf_malloc(sizeof(connector_shared) * loop_max);
@@ -1984,7 +4430,7 @@ create_connections_nowait(as_node* node, as_async_conn_pool* pools)
 		as_async_conn_pool* pool = &pools[i];
 		uint32_t min_size = pool->min_size;
 
-		if (min_size > 0) {
+		if (min_size > 0 && ! as_event_loops[i].draining) {
 			connector_shared* cs = &array[i];
 			cs->parent = csnw;
 			cs->node = node;
@@ -2002,6 +4448,9 @@ create_connections_nowait(as_node* node, as_async_conn_pool* pools)
 				connector_shared_nowait_release(csnw);
 			}
 		}
+		else {
+			connector_shared_nowait_release(csnw);
+		}
 	}
 }
 
@@ -2042,7 +4491,14 @@ create_connections(as_event_loop* event_loop, as_node* node, as_async_conn_pool*
 	cs->pool = pool;
 	cs->conn_count = 0;
 	cs->conn_max = count;
-	cs->concur_max = 1;
+
+	// Replacement connections are opened one at a time unless concurrent connects are enabled.
+	uint32_t max_concurrent = node->cluster->async_max_connects_per_loop;
+
+	if (max_concurrent == 0) {
+		max_concurrent = 1;
+	}
+	cs->concur_max = ((uint32_t)count >= max_concurrent)? max_concurrent : (uint32_t)count;
 	cs->timeout_ms = node->cluster->conn_timeout_ms;
 	cs->type = AS_CONNECTOR_SINGLE;
 	cs->error = false;
@@ -2068,10 +4524,11 @@ balancer_release(balancer_shared* bs)
 	}
 }
 
-static void
+static int
 close_idle_connections(as_async_conn_pool* pool, uint64_t max_socket_idle_ns, int count)
 {
 	as_event_connection* conn;
+	int closed = 0;
 
 	while (count > 0) {
 		if (! as_queue_pop_tail(&pool->queue, &conn)) {
@@ -2085,16 +4542,53 @@ close_idle_connections(as_async_conn_pool* pool, uint64_t max_socket_idle_ns, in
 			break;
 		}
 		as_event_release_connection(conn, pool);
+		closed++;
 		count--;
 	}
+	return closed;
+}
+
+static void
+trim_window_connections(as_async_conn_pool* pool, uint32_t window_size, int excess)
+{
+	uint32_t surplus = as_conn_window_surplus(&pool->window, window_size,
+		as_queue_size(&pool->queue), pool->queue.total);
+
+	if (excess <= 0 || surplus == 0) {
+		return;
+	}
+
+	if (surplus > (uint32_t)excess) {
+		surplus = (uint32_t)excess;
+	}
+
+	// Close a quarter of the connections not used in the window per tend, so a burst
+	// that recurs shortly after does not have to reopen them all.
+	int count = (int)((surplus + 3) / 4);
+	pool->window.trimmed += close_idle_connections(pool, 0, count);
 }
 
 void
 as_event_balance_connections_node(as_event_loop* event_loop, as_cluster* cluster, as_node* node)
 {
 	as_async_conn_pool* pool = &node->async_conn_pools[event_loop->index];
+
+	if (event_loop->draining) {
+		close_idle_connections(pool, 0, as_queue_size(&pool->queue));
+		return;
+	}
+
 	int excess = pool->queue.total - pool->min_size;
 
+	if (cluster->conn_peak_window > 0) {
+		trim_window_connections(pool, cluster->conn_peak_window, excess);
+
+		if (excess < 0 && as_node_valid_error_rate(node)) {
+			create_connections(event_loop, node, pool, -excess);
+		}
+		return;
+	}
+
 	if (excess > 0) {
 		close_idle_connections(pool, cluster->max_socket_idle_ns_trim, excess);
 		// Do not close idle pipeline connections because pipelines work better with a stable
@@ -2108,6 +4602,14 @@ as_event_balance_connections_node(as_event_loop* event_loop, as_cluster* cluster
 void
 as_event_balance_connections_cluster(as_event_loop* event_loop, as_cluster* cluster)
 {
+	// Release decompression scratch buffer when compressed responses have stopped arriving.
+	if (event_loop->decompress_buf &&
+		cf_getms() - event_loop->decompress_last_used >= AS_EVENT_DECOMPRESS_IDLE_MS) {
+		cf_free(event_loop->decompress_buf);
+		event_loop->decompress_buf = NULL;
+		event_loop->decompress_capacity = 0;
+	}
+
 	as_nodes* nodes = as_nodes_reserve(cluster);
 
 	for (uint32_t i = 0; i < nodes->size; i++) {
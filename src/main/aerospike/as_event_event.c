@@ -55,6 +55,7 @@ void
 as_event_close_loop(as_event_loop* event_loop)
 {
 	event_del(&event_loop->wakeup);
+	evtimer_del(&event_loop->tick);
 
 	if (event_loop->clusters.capacity > 0) {
 		event_del(&event_loop->trim);
@@ -73,38 +74,33 @@ as_event_close_loop(as_event_loop* event_loop)
 static void
 as_event_wakeup(evutil_socket_t socket, short revents, void* udata)
 {
-	// Read command pointers from queue.
 	as_event_loop* event_loop = udata;
-	as_event_commander cmd;
-	uint32_t i = 0;
-
-	// Only process original size of queue.  Recursive pre-registration errors can
-	// result in new commands being added while the loop is in process.  If we process
-	// them, we could end up in an infinite loop.
-	pthread_mutex_lock(&event_loop->lock);
-	uint32_t size = as_queue_size(&event_loop->queue);
-	bool status = as_queue_pop(&event_loop->queue, &cmd);
-	pthread_mutex_unlock(&event_loop->lock);
-
-	while (status) {
-		if (! cmd.executable) {
-			// Received stop signal.
-			as_event_close_loop(event_loop);
-			return;
-		}
-		cmd.executable(event_loop, cmd.udata);
 
-		if (++i < size) {
-			pthread_mutex_lock(&event_loop->lock);
-			status = as_queue_pop(&event_loop->queue, &cmd);
-			pthread_mutex_unlock(&event_loop->lock);
-		}
-		else {
-			break;
-		}
+	if (! as_event_queue_run(event_loop)) {
+		// Received stop signal.
+		as_event_close_loop(event_loop);
 	}
 }
 
+static void
+as_event_tick(evutil_socket_t socket, short revents, void* udata)
+{
+	as_event_wheel_process(udata);
+}
+
+void
+as_event_wheel_tick_start(as_event_loop* event_loop)
+{
+	struct timeval tv = {0, 1000};
+	evtimer_add(&event_loop->tick, &tv);
+}
+
+void
+as_event_wheel_tick_stop(as_event_loop* event_loop)
+{
+	evtimer_del(&event_loop->tick);
+}
+
 static void*
 as_event_worker(void* udata)
 {
@@ -122,6 +118,7 @@ as_event_worker(void* udata)
 	as_event_loop* event_loop = udata;
 
 	as_thread_set_name_index("event", event_loop->index);
+	as_event_thread_assign_cpu(event_loop);
 
 	struct event_base* loop = event_loop->loop;
 
@@ -155,6 +152,9 @@ as_event_init_loop(as_event_loop* event_loop)
     }
 
 	evtimer_assign(&event_loop->wakeup, event_loop->loop, as_event_wakeup, event_loop);
+
+	// Single timer that drives all command timers of this event loop.
+	event_assign(&event_loop->tick, event_loop->loop, -1, EV_PERSIST, as_event_tick, event_loop);
 	/*
 	event_assign(&event_loop->wakeup, event_loop->loop, -1, EV_PERSIST | EV_READ, as_event_wakeup, event_loop);
 
@@ -173,7 +173,12 @@ bool
 as_event_create_loop(as_event_loop* event_loop)
 {
 #if !defined(_MSC_VER)
-	event_loop->loop = event_base_new();
+	// Apply watcher changes once per fd at the end of each loop iteration instead of
+	// calling epoll_ctl() on every change. Ignored by non-epoll backends.
+	struct event_config* config = event_config_new();
+	event_config_set_flag(config, EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
+	event_loop->loop = event_base_new_with_config(config);
+	event_config_free(config);
 #else
 	struct event_config* config = event_config_new();
 	event_config_set_flag(config, EVENT_BASE_FLAG_STARTUP_IOCP);
@@ -192,7 +197,7 @@ as_event_create_loop(as_event_loop* event_loop)
 
 	as_event_init_loop(event_loop);
 
-	return pthread_create(&event_loop->thread, NULL, as_event_worker, event_loop) == 0;
+	return as_event_thread_create(event_loop, as_event_worker, event_loop);
 }
 
 void
@@ -202,6 +207,13 @@ as_event_register_external_loop(as_event_loop* event_loop)
 	as_event_init_loop(event_loop);
 }
 
+uint64_t
+as_event_loop_iterations(as_event_loop* event_loop)
+{
+	// libevent does not count loop iterations.
+	return 0;
+}
+
 bool
 as_event_execute(as_event_loop* event_loop, as_event_executable executable, void* udata)
 {
@@ -212,12 +224,10 @@ as_event_execute(as_event_loop* event_loop, as_event_executable executable, void
 	}
 
 	// Send command through queue so it can be executed in event loop thread.
-	pthread_mutex_lock(&event_loop->lock);
-	as_event_commander qcmd = {.executable = executable, .udata = udata};
-	bool queued = as_queue_push(&event_loop->queue, &qcmd);
-	pthread_mutex_unlock(&event_loop->lock);
+	bool wakeup;
+	bool queued = as_event_queue_push(event_loop, executable, udata, &wakeup);
 
-	if (queued) {
+	if (wakeup) {
 		if (! evtimer_pending(&event_loop->wakeup, NULL)) {
 			event_del(&event_loop->wakeup);
 			evtimer_add(&event_loop->wakeup, &as_immediate_tv);
@@ -271,6 +281,7 @@ as_event_watch_read(as_event_command* cmd)
 #define AS_EVENT_TLS_NEED_WRITE 7
 
 #define AS_EVENT_COMMAND_DONE 8
+#define AS_EVENT_COMMAND_PAUSED 9
 
 static int
 as_event_write(as_event_command* cmd)
@@ -281,7 +292,6 @@ as_event_write(as_event_command* cmd)
 		do {
 			int rv = as_tls_write_once(&cmd->conn->socket, buf + cmd->pos, cmd->len - cmd->pos);
 			if (rv > 0) {
-				as_event_watch_write(cmd);
 				cmd->pos += rv;
 				cmd->bytes_out += rv;
 				continue;
@@ -457,17 +467,27 @@ as_event_command_read_start(as_event_command* cmd)
 static inline void
 as_event_command_write(as_event_command* cmd)
 {
-	as_event_watch_write(cmd);
-
+	// Write before watching for writes. Most writes complete immediately, so the socket
+	// only needs to switch to read once per command. as_event_write() watches for writes
+	// when the socket buffer is full.
 	if (as_event_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
 		// Done with write. Register for read.
 		as_event_command_read_start(cmd);
 	}
 }
 
+void
+as_event_command_resume_read(as_event_command* cmd)
+{
+	// Socket is level triggered, so data received while paused is read on the next
+	// loop iteration.
+	as_event_watch_read(cmd);
+}
+
 void
 as_event_command_write_start(as_event_command* cmd)
 {
+	as_event_command_trace(cmd, AS_TRACE_WRITE, AEROSPIKE_OK);
 	cmd->state = AS_ASYNC_STATE_COMMAND_WRITE;
 	as_event_set_write(cmd);
 	as_event_command_write(cmd);
@@ -491,8 +511,6 @@ as_event_command_start(as_event_command* cmd)
 static inline void
 as_event_command_auth_write(as_event_command* cmd)
 {
-	as_event_watch_write(cmd);
-		
 	if (as_event_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
 		// Done with auth write. Register for auth read.
 		as_event_set_auth_read_header(cmd);
@@ -550,7 +568,7 @@ as_event_command_peek_block(as_event_command* cmd)
 	cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
 	
 	// Check for end block size.
-	if (cmd->len == sizeof(as_msg) && cmd->proto_type_rcv != AS_COMPRESSED_MESSAGE_TYPE) {
+	if (cmd->len == sizeof(as_msg) && ! as_proto_is_compressed(cmd->proto_type_rcv)) {
 		// Look like we received end block.  Read and parse to make sure.
 		rv = as_event_read(cmd);
 		if (rv != AS_EVENT_READ_COMPLETE) {
@@ -571,14 +589,7 @@ as_event_command_peek_block(as_event_command* cmd)
 	else {
 		// Received normal data block.  Stop reading for fairness reasons and wait
 		// till next iteration.
-		if (cmd->len > cmd->read_capacity) {
-			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-				cf_free(cmd->buf);
-			}
-			cmd->buf = cf_malloc(size);
-			cmd->read_capacity = cmd->len;
-			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
-		}
+		as_event_command_reserve_read(cmd);
 	}
 
 	return AS_EVENT_READ_COMPLETE;
@@ -651,14 +662,7 @@ as_event_command_read(as_event_command* cmd)
 		cmd->pos = 0;
 		cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
 		
-		if (cmd->len > cmd->read_capacity) {
-			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-				cf_free(cmd->buf);
-			}
-			cmd->buf = cf_malloc(size);
-			cmd->read_capacity = cmd->len;
-			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
-		}
+		as_event_command_reserve_read(cmd);
 	}
 	
 	// Read response body
@@ -668,7 +672,14 @@ as_event_command_read(as_event_command* cmd)
 	}
 	cmd->pos = 0;
 
-	if (cmd->proto_type_rcv == AS_COMPRESSED_MESSAGE_TYPE) {
+	// Large blocks are processed by a worker thread. Not supported with TLS because
+	// decrypted bytes may be buffered.
+	if (! cmd->conn->socket.ctx && as_event_offload(cmd)) {
+		// Reading resumes in as_event_command_resume_read().
+		return AS_EVENT_COMMAND_PAUSED;
+	}
+
+	if (as_proto_is_compressed(cmd->proto_type_rcv)) {
 		if (! as_event_decompress(cmd)) {
 			return AS_EVENT_READ_ERROR;
 		}
@@ -676,6 +687,10 @@ as_event_command_read(as_event_command* cmd)
 
 	if (! cmd->parse_results(cmd)) {
 		// Batch, scan, query is not finished.
+		// Flow control is not supported with TLS because decrypted bytes may be buffered.
+		if (! cmd->conn->socket.ctx && as_event_command_pause(cmd)) {
+			return AS_EVENT_COMMAND_PAUSED;
+		}
 		return as_event_command_peek_block(cmd);
 	}
 
@@ -779,6 +794,10 @@ as_event_callback_common(as_event_command* cmd, as_event_connection* conn) {
 			case AS_EVENT_READ_ERROR:
 				// Do not touch cmd again because it's been deallocated.
 				return;
+
+			case AS_EVENT_COMMAND_PAUSED:
+				// Reading resumes in as_event_command_resume_read().
+				return;
 			
 			case AS_EVENT_READ_COMPLETE:
 				as_event_watch_read(cmd);
@@ -887,6 +906,13 @@ as_event_try_family_connections(as_event_command* cmd, int family, int begin, in
 		return rv;
 	}
 
+	rv = as_socket_set_options(fd, &cmd->cluster->socket_options);
+
+	if (rv < 0) {
+		as_close(fd);
+		return rv;
+	}
+
 	if (cmd->pipe_listener && ! as_pipe_modify_fd(fd)) {
 		return -1000;
 	}
@@ -897,6 +923,10 @@ as_event_try_family_connections(as_event_command* cmd, int family, int begin, in
 		return -1001;
 	}
 
+	if (ctx) {
+		as_tls_session_resume(ctx, sock->ssl, cmd->node->name, cmd->node->tls_name);
+	}
+
 	// Try addresses.
 	as_address* addresses = cmd->node->addresses;
 	socklen_t size = (family == AF_INET)? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
@@ -998,18 +1028,6 @@ as_event_connect(as_event_command* cmd, as_async_conn_pool* pool)
 	cmd->event_loop->errors = 0; // Reset errors on valid connection.
 }
 
-void
-as_libevent_timer_cb(evutil_socket_t sock, short events, void* udata)
-{
-	as_event_process_timer(udata);
-}
-
-void
-as_libevent_repeat_cb(evutil_socket_t sock, short events, void* udata)
-{
-	as_event_socket_timeout(udata);
-}
-
 static void
 as_event_close_connections(as_node* node, as_async_conn_pool* pool)
 {
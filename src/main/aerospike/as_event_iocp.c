@@ -0,0 +1,1674 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_event.h>
+#include <aerospike/as_event_internal.h>
+#include <aerospike/as_admin.h>
+#include <aerospike/as_async.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_pipe.h>
+#include <aerospike/as_proto.h>
+#include <aerospike/as_socket.h>
+#include <aerospike/as_status.h>
+#include <aerospike/as_thread.h>
+#include <aerospike/as_tls.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <citrusleaf/cf_clock.h>
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+extern int as_event_send_buffer_size;
+extern int as_event_recv_buffer_size;
+extern bool as_event_threads_created;
+
+//---------------------------------
+// IOCP Functions
+//---------------------------------
+
+#if defined(AS_USE_IOCP)
+
+#include <mswsock.h>
+
+// Completion entries dequeued per wait.
+#define AS_IOCP_ENTRY_COUNT 128
+
+// Connection receive buffer size.
+#define AS_IOCP_RECV_SIZE 16384
+
+// Maximum bytes copied to a connection send buffer per send operation.
+#define AS_IOCP_SEND_MAX (1024 * 64)
+#define AS_IOCP_SEND_MIN 4096
+
+// Completion keys. Posted completions have no overlapped I/O result.
+#define AS_IOCP_KEY_CONN 0
+#define AS_IOCP_KEY_WAKEUP 1
+#define AS_IOCP_KEY_POST 2
+
+#define AS_IOCP_OP_CONNECT 1
+#define AS_IOCP_OP_RECV 2
+#define AS_IOCP_OP_READABLE 3
+#define AS_IOCP_OP_SEND 4
+#define AS_IOCP_OP_WRITABLE 5
+
+#define AS_IOCP_WATCH_READ 1
+#define AS_IOCP_WATCH_WRITE 2
+
+// Negative rx_error/tx_error value signifies socket closed by peer.
+#define AS_IOCP_EOF -1
+
+static LPFN_CONNECTEX as_iocp_connect_ex;
+
+static void
+as_event_close_loop(as_event_loop* event_loop)
+{
+	// Port resources are released by the worker thread after this iteration completes.
+	event_loop->closing = true;
+}
+
+static inline uint32_t
+as_iocp_staged(as_event_connection* conn)
+{
+	return conn->recv_tail - conn->recv_head;
+}
+
+static uint32_t
+as_iocp_consume(as_event_connection* conn, uint8_t* buf, uint32_t size)
+{
+	uint32_t n = as_iocp_staged(conn);
+
+	if (n > size) {
+		n = size;
+	}
+
+	memcpy(buf, conn->recv_buf + conn->recv_head, n);
+	conn->recv_head += n;
+	return n;
+}
+
+static void
+as_iocp_post(as_event_connection* conn, as_iocp_op* op, uint8_t type)
+{
+	op->type = type;
+
+	if (! PostQueuedCompletionStatus(conn->event_loop->loop, 0, AS_IOCP_KEY_POST, &op->ov)) {
+		// Command timers will eventually handle the operation that was not posted.
+		as_log_error("PostQueuedCompletionStatus failed: %u", GetLastError());
+		return;
+	}
+	op->pending = true;
+	conn->inflight++;
+}
+
+//---------------------------------
+// Timers
+//---------------------------------
+
+static void
+as_iocp_heap_up(as_event_loop* event_loop, uint32_t i)
+{
+	as_iocp_timer** heap = event_loop->timers;
+	as_iocp_timer* timer = heap[i];
+
+	while (i > 1) {
+		uint32_t parent = i >> 1;
+
+		if (heap[parent]->deadline <= timer->deadline) {
+			break;
+		}
+		heap[i] = heap[parent];
+		heap[i]->index = i;
+		i = parent;
+	}
+	heap[i] = timer;
+	timer->index = i;
+}
+
+static void
+as_iocp_heap_down(as_event_loop* event_loop, uint32_t i)
+{
+	as_iocp_timer** heap = event_loop->timers;
+	as_iocp_timer* timer = heap[i];
+	uint32_t size = event_loop->timers_size;
+
+	while (true) {
+		uint32_t child = i << 1;
+
+		if (child > size) {
+			break;
+		}
+
+		if (child < size && heap[child + 1]->deadline < heap[child]->deadline) {
+			child++;
+		}
+
+		if (timer->deadline <= heap[child]->deadline) {
+			break;
+		}
+		heap[i] = heap[child];
+		heap[i]->index = i;
+		i = child;
+	}
+	heap[i] = timer;
+	timer->index = i;
+}
+
+static void
+as_iocp_heap_insert(as_event_loop* event_loop, as_iocp_timer* timer)
+{
+	if (event_loop->timers_size + 1 >= event_loop->timers_capacity) {
+		// Heap is 1-based.
+		event_loop->timers_capacity = event_loop->timers_capacity ?
+			event_loop->timers_capacity * 2 : 256;
+		event_loop->timers = cf_realloc(event_loop->timers,
+			sizeof(as_iocp_timer*) * event_loop->timers_capacity);
+	}
+
+	uint32_t i = ++event_loop->timers_size;
+	event_loop->timers[i] = timer;
+	as_iocp_heap_up(event_loop, i);
+}
+
+static void
+as_iocp_heap_remove(as_event_loop* event_loop, as_iocp_timer* timer)
+{
+	uint32_t i = timer->index;
+	as_iocp_timer* last = event_loop->timers[event_loop->timers_size--];
+
+	timer->index = 0;
+
+	if (i <= event_loop->timers_size) {
+		event_loop->timers[i] = last;
+		last->index = i;
+		as_iocp_heap_up(event_loop, i);
+		as_iocp_heap_down(event_loop, last->index);
+	}
+}
+
+void
+as_iocp_timer_start(as_event_loop* event_loop, as_iocp_timer* timer, uint64_t timeout, uint64_t repeat)
+{
+	if (timer->index) {
+		as_iocp_heap_remove(event_loop, timer);
+	}
+
+	timer->deadline = cf_getms() + timeout;
+	timer->repeat = repeat;
+	timer->pass = event_loop->timers_pass;
+	as_iocp_heap_insert(event_loop, timer);
+}
+
+void
+as_iocp_timer_again(as_event_loop* event_loop, as_iocp_timer* timer)
+{
+	// Same semantics as ev_timer_again(). Restart repeating timer or stop non-repeating timer.
+	if (timer->index) {
+		as_iocp_heap_remove(event_loop, timer);
+	}
+
+	if (timer->repeat) {
+		timer->deadline = cf_getms() + timer->repeat;
+		timer->pass = event_loop->timers_pass;
+		as_iocp_heap_insert(event_loop, timer);
+	}
+}
+
+void
+as_iocp_timer_stop(as_event_loop* event_loop, as_iocp_timer* timer)
+{
+	if (timer->index) {
+		as_iocp_heap_remove(event_loop, timer);
+	}
+}
+
+static DWORD
+as_iocp_timer_wait(as_event_loop* event_loop)
+{
+	if (event_loop->timers_size == 0) {
+		return INFINITE;
+	}
+
+	uint64_t deadline = event_loop->timers[1]->deadline;
+	uint64_t now = cf_getms();
+	return (deadline > now)? (DWORD)(deadline - now) : 0;
+}
+
+static void
+as_iocp_process_timers(as_event_loop* event_loop)
+{
+	uint32_t pass = ++event_loop->timers_pass;
+	uint64_t now = cf_getms();
+
+	while (event_loop->timers_size > 0 && ! event_loop->closing) {
+		as_iocp_timer* timer = event_loop->timers[1];
+
+		// Timers started while processing this pass (retries use zero timeouts) run on the
+		// next loop iteration, so they can't starve socket completions.
+		if (timer->deadline > now || timer->pass == pass) {
+			break;
+		}
+
+		as_iocp_heap_remove(event_loop, timer);
+
+		as_event_command* cmd = timer->data;
+
+		if (timer->repeat) {
+			// Repeating timers are restarted before the callback, same as libev.
+			timer->deadline = now + timer->repeat;
+			timer->pass = pass;
+			as_iocp_heap_insert(event_loop, timer);
+			as_event_socket_timeout(cmd);
+		}
+		else {
+			as_event_process_timer(cmd);
+		}
+	}
+}
+
+
+//---------------------------------
+// Connection Operations
+//---------------------------------
+
+static void
+as_iocp_recv(as_event_connection* conn)
+{
+	if (conn->recv_op.pending || conn->rx_error || conn->closed) {
+		return;
+	}
+
+	WSABUF buf;
+	DWORD flags = 0;
+
+	if (conn->socket.ctx) {
+		// Zero byte receive completes when the socket is readable. The TLS library reads
+		// the data itself.
+		buf.buf = NULL;
+		buf.len = 0;
+		conn->recv_op.type = AS_IOCP_OP_READABLE;
+	}
+	else {
+		if (conn->recv_head < conn->recv_tail) {
+			// Staged bytes must be consumed before the buffer is reused.
+			return;
+		}
+
+		if (! conn->recv_buf) {
+			conn->recv_buf = cf_malloc(AS_IOCP_RECV_SIZE);
+		}
+
+		conn->recv_head = 0;
+		conn->recv_tail = 0;
+		buf.buf = (char*)conn->recv_buf;
+		buf.len = AS_IOCP_RECV_SIZE;
+		conn->recv_op.type = AS_IOCP_OP_RECV;
+	}
+
+	memset(&conn->recv_op.ov, 0, sizeof(OVERLAPPED));
+
+	if (WSARecv(conn->socket.fd, &buf, 1, NULL, &flags, &conn->recv_op.ov, NULL) == SOCKET_ERROR) {
+		int e = WSAGetLastError();
+
+		if (e != WSA_IO_PENDING) {
+			if (conn->socket.ctx) {
+				// Let the TLS library discover the socket error.
+				as_iocp_post(conn, &conn->recv_op, AS_IOCP_OP_READABLE);
+			}
+			else {
+				conn->rx_error = e;
+			}
+			return;
+		}
+	}
+	conn->recv_op.pending = true;
+	conn->inflight++;
+}
+
+static void
+as_iocp_send(as_event_command* cmd, uint8_t* buf)
+{
+	as_event_connection* conn = cmd->conn;
+	uint32_t size = cmd->len - cmd->pos;
+
+	if (size > AS_IOCP_SEND_MAX) {
+		size = AS_IOCP_SEND_MAX;
+	}
+
+	// Copy to connection owned buffer because the command may be released (timeout)
+	// while the send is still pending in the kernel.
+	if (size > conn->send_capacity) {
+		cf_free(conn->send_buf);
+		conn->send_capacity = (size < AS_IOCP_SEND_MIN)? AS_IOCP_SEND_MIN : size;
+		conn->send_buf = cf_malloc(conn->send_capacity);
+	}
+	memcpy(conn->send_buf, buf + cmd->pos, size);
+
+	WSABUF wsabuf;
+	wsabuf.buf = (char*)conn->send_buf;
+	wsabuf.len = size;
+
+	memset(&conn->send_op.ov, 0, sizeof(OVERLAPPED));
+	conn->send_op.type = AS_IOCP_OP_SEND;
+
+	if (WSASend(conn->socket.fd, &wsabuf, 1, NULL, 0, &conn->send_op.ov, NULL) == SOCKET_ERROR) {
+		int e = WSAGetLastError();
+
+		if (e != WSA_IO_PENDING) {
+			conn->tx_error = e;
+			return;
+		}
+	}
+	conn->send_op.pending = true;
+	conn->inflight++;
+}
+
+static void
+as_iocp_poll(as_event_connection* conn)
+{
+	// Poll is used for TLS sockets, which must be read/written by the TLS library.
+	if (conn->closed) {
+		return;
+	}
+
+	if ((conn->watching & AS_IOCP_WATCH_READ) && ! conn->recv_op.pending) {
+		as_iocp_recv(conn);
+	}
+
+	if ((conn->watching & AS_IOCP_WATCH_WRITE) && ! conn->send_op.pending) {
+		// Completion ports do not report write readiness, so retry the TLS write on the
+		// next loop iteration.
+		as_iocp_post(conn, &conn->send_op, AS_IOCP_OP_WRITABLE);
+	}
+}
+
+static void
+as_iocp_conn_init(as_event_loop* event_loop, as_event_connection* conn)
+{
+	conn->event_loop = event_loop;
+	memset(&conn->recv_op, 0, sizeof(as_iocp_op));
+	memset(&conn->send_op, 0, sizeof(as_iocp_op));
+	conn->recv_op.conn = conn;
+	conn->send_op.conn = conn;
+	conn->recv_buf = NULL;
+	conn->recv_head = 0;
+	conn->recv_tail = 0;
+	conn->send_buf = NULL;
+	conn->send_capacity = 0;
+	conn->inflight = 0;
+	conn->rx_error = 0;
+	conn->tx_error = 0;
+	conn->closed = false;
+}
+
+static void
+as_iocp_conn_free(as_event_connection* conn)
+{
+	cf_free(conn->recv_buf);
+	cf_free(conn->send_buf);
+	cf_free(conn);
+}
+
+static void
+as_iocp_conn_close(as_event_connection* conn)
+{
+	conn->closed = true;
+	conn->watching = 0;
+	conn->recv_head = 0;
+	conn->recv_tail = 0;
+
+	// Closing the socket cancels pending operations. Connection memory is released when
+	// the last canceled operation completes.
+	as_socket_close(&conn->socket);
+
+	if (conn->inflight == 0) {
+		as_iocp_conn_free(conn);
+	}
+}
+
+static void
+as_iocp_close_cb(as_event_loop* event_loop, void* udata)
+{
+	as_iocp_conn_close(udata);
+}
+
+void
+as_event_close_connection(as_event_connection* conn)
+{
+	as_event_loop* event_loop = conn->event_loop;
+
+	if (! event_loop) {
+		// Connection was never registered. No completions can reference this connection.
+		as_socket_close(&conn->socket);
+		as_iocp_conn_free(conn);
+		return;
+	}
+
+	if (as_load_uint8_acq((uint8_t*)&event_loop->closed)) {
+		as_socket_close(&conn->socket);
+
+		// The kernel may still write canceled operation status to connection memory,
+		// so only release the connection when nothing is pending.
+		if (conn->inflight == 0) {
+			as_iocp_conn_free(conn);
+		}
+		return;
+	}
+
+	if (pthread_equal(event_loop->thread, pthread_self())) {
+		as_iocp_conn_close(conn);
+		return;
+	}
+
+	// Connections can be closed from other threads (node destroy). Connection state must
+	// only be accessed from the event loop thread, so close the connection there.
+	if (! as_event_execute(event_loop, as_iocp_close_cb, conn)) {
+		as_log_warn("Failed to queue async connection close");
+		as_socket_close(&conn->socket);
+	}
+}
+
+void
+as_iocp_stop_watcher(as_event_connection* conn)
+{
+	// Pending operations complete normally and are ignored while not watching.
+	conn->watching = 0;
+}
+
+int
+as_iocp_conn_validate(as_event_connection* conn)
+{
+	if (conn->rx_error) {
+		return -1;
+	}
+
+	uint32_t staged = as_iocp_staged(conn);
+
+	if (staged > 0) {
+		return (int)staged;
+	}
+
+	if (! conn->socket.ctx && conn->recv_op.pending) {
+		// Pending receive would have reported any bytes or socket close.
+		return 0;
+	}
+	return as_socket_validate_fd(conn->socket.fd);
+}
+
+//---------------------------------
+// Event Loop
+//---------------------------------
+
+static void as_iocp_conn_event(as_event_connection* conn, as_iocp_op* op, int32_t res, uint32_t bytes);
+
+static void
+as_iocp_wakeup(as_event_loop* event_loop)
+{
+	if (! as_event_queue_run(event_loop)) {
+		// Received stop signal.
+		as_event_close_loop(event_loop);
+	}
+}
+
+static void
+as_iocp_process_completions(as_event_loop* event_loop, OVERLAPPED_ENTRY* entries, ULONG count)
+{
+	for (ULONG i = 0; i < count && ! event_loop->closing; i++) {
+		OVERLAPPED_ENTRY* entry = &entries[i];
+
+		if (entry->lpCompletionKey == AS_IOCP_KEY_WAKEUP) {
+			as_iocp_wakeup(event_loop);
+			continue;
+		}
+
+		as_iocp_op* op = (as_iocp_op*)entry->lpOverlapped;
+		as_event_connection* conn = op->conn;
+		int32_t res = 0;
+
+		if (entry->lpCompletionKey == AS_IOCP_KEY_CONN && ! conn->closed) {
+			// Retrieve the socket error of a failed operation.
+			DWORD bytes;
+			DWORD flags;
+
+			if (! WSAGetOverlappedResult(conn->socket.fd, &op->ov, &bytes, FALSE, &flags)) {
+				res = WSAGetLastError();
+			}
+		}
+		as_iocp_conn_event(conn, op, res, entry->dwNumberOfBytesTransferred);
+	}
+}
+
+static void
+as_iocp_loop_destroy(as_event_loop* event_loop)
+{
+	// Connections closed after this point are released directly.
+	as_store_uint8_rls((uint8_t*)&event_loop->closed, 1);
+
+	CloseHandle(event_loop->loop);
+	cf_free(event_loop->timers);
+
+	// Cleanup event loop resources.
+	as_event_loop_destroy(event_loop);
+}
+
+static void*
+as_iocp_worker(void* udata)
+{
+	as_event_loop* event_loop = udata;
+
+	as_thread_set_name_index("iocp", event_loop->index);
+	as_event_thread_assign_cpu(event_loop);
+
+	OVERLAPPED_ENTRY entries[AS_IOCP_ENTRY_COUNT];
+
+	while (! event_loop->closing) {
+		ULONG count = 0;
+
+		if (! GetQueuedCompletionStatusEx(event_loop->loop, entries, AS_IOCP_ENTRY_COUNT, &count,
+				as_iocp_timer_wait(event_loop), FALSE)) {
+			DWORD e = GetLastError();
+
+			if (e != WAIT_TIMEOUT) {
+				as_log_error("GetQueuedCompletionStatusEx failed: %u", e);
+			}
+			count = 0;
+		}
+
+		as_iocp_process_completions(event_loop, entries, count);
+		as_iocp_process_timers(event_loop);
+		event_loop->iterations++;
+	}
+
+	as_iocp_loop_destroy(event_loop);
+	as_tls_thread_cleanup();
+	return NULL;
+}
+
+static bool
+as_iocp_init_loop(as_event_loop* event_loop)
+{
+	// Only the event loop thread dequeues completions.
+	HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+
+	if (! port) {
+		as_log_error("CreateIoCompletionPort failed: %u", GetLastError());
+		return false;
+	}
+
+	event_loop->loop = port;
+	event_loop->timers = NULL;
+	event_loop->timers_size = 0;
+	event_loop->timers_capacity = 0;
+	event_loop->timers_pass = 0;
+	event_loop->iterations = 0;
+	event_loop->closing = false;
+	event_loop->closed = false;
+	return true;
+}
+
+bool
+as_event_create_loop(as_event_loop* event_loop)
+{
+	if (! as_iocp_init_loop(event_loop)) {
+		return false;
+	}
+	return as_event_thread_create(event_loop, as_iocp_worker, event_loop);
+}
+
+void
+as_event_register_external_loop(as_event_loop* event_loop)
+{
+	// The completion port is owned by the worker thread created in as_event_create_loop().
+	// External completion ports can not be driven by the client.
+	as_log_error("External event loops are not supported with IOCP");
+}
+
+uint64_t
+as_event_loop_iterations(as_event_loop* event_loop)
+{
+	return event_loop->iterations;
+}
+
+bool
+as_event_execute(as_event_loop* event_loop, as_event_executable executable, void* udata)
+{
+	// Send command through queue so it can be executed in event loop thread.
+	bool wakeup;
+	bool queued = as_event_queue_push(event_loop, executable, udata, &wakeup);
+
+	if (wakeup) {
+		if (! PostQueuedCompletionStatus(event_loop->loop, 0, AS_IOCP_KEY_WAKEUP, NULL)) {
+			as_log_error("Event loop wakeup post failed: %u", GetLastError());
+		}
+	}
+	return queued;
+}
+
+//---------------------------------
+// Command State Machine
+//---------------------------------
+
+static inline void
+as_iocp_watch(as_event_connection* conn, int watch)
+{
+	conn->watching = watch;
+
+	if (conn->socket.ctx) {
+		as_iocp_poll(conn);
+	}
+	else if (watch & AS_IOCP_WATCH_READ) {
+		// Make sure a receive is pending.
+		as_iocp_recv(conn);
+	}
+}
+
+static inline void
+as_iocp_watch_write(as_event_command* cmd)
+{
+	int watch = cmd->pipe_listener != NULL ?
+		AS_IOCP_WATCH_WRITE | AS_IOCP_WATCH_READ : AS_IOCP_WATCH_WRITE;
+	as_iocp_watch(cmd->conn, watch);
+}
+
+static inline void
+as_iocp_watch_read(as_event_command* cmd)
+{
+	as_iocp_watch(cmd->conn, AS_IOCP_WATCH_READ);
+}
+
+#define AS_EVENT_WRITE_COMPLETE 0
+#define AS_EVENT_WRITE_INCOMPLETE 1
+#define AS_EVENT_WRITE_ERROR 2
+
+#define AS_EVENT_READ_COMPLETE 3
+#define AS_EVENT_READ_INCOMPLETE 4
+#define AS_EVENT_READ_ERROR 5
+
+#define AS_EVENT_TLS_NEED_READ 6
+#define AS_EVENT_TLS_NEED_WRITE 7
+
+#define AS_EVENT_COMMAND_DONE 8
+
+static int
+as_iocp_write(as_event_command* cmd)
+{
+	uint8_t* buf = (uint8_t*)cmd + cmd->write_offset;
+	as_event_connection* conn = cmd->conn;
+	as_socket_fd fd = conn->socket.fd;
+
+	if (conn->socket.ctx) {
+		do {
+			int rv = as_tls_write_once(&conn->socket, buf + cmd->pos, cmd->len - cmd->pos);
+			if (rv > 0) {
+				as_iocp_watch_write(cmd);
+				cmd->pos += rv;
+				cmd->bytes_out += rv;
+				continue;
+			}
+			else if (rv == -1) {
+				// TLS sometimes need to read even when we are writing.
+				as_iocp_watch_read(cmd);
+				return AS_EVENT_TLS_NEED_READ;
+			}
+			else if (rv == -2) {
+				// TLS wants a write, we're all set for that.
+				as_iocp_watch_write(cmd);
+				return AS_EVENT_WRITE_INCOMPLETE;
+			}
+			else if (rv < -2) {
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_TLS_ERROR, "TLS write failed", rv);
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_WRITE_ERROR;
+			}
+			// as_tls_write_once can't return 0
+		} while (cmd->pos < cmd->len);
+	}
+	else {
+		if (! conn->tx_error && ! conn->send_op.pending && cmd->pos < cmd->len) {
+			// Send completion continues the write state machine.
+			as_iocp_send(cmd, buf);
+		}
+
+		if (conn->tx_error) {
+			int32_t e = conn->tx_error;
+
+			if (! as_event_socket_retry(cmd)) {
+				as_error err;
+
+				if (e == AS_IOCP_EOF) {
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket write closed by peer", 0);
+				}
+				else {
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket write failed", e);
+				}
+				as_event_socket_error(cmd, &err);
+			}
+			return AS_EVENT_WRITE_ERROR;
+		}
+
+		if (conn->send_op.pending) {
+			return AS_EVENT_WRITE_INCOMPLETE;
+		}
+	}
+
+	// Socket timeout applies only to read events.
+	// Reset event received because we are switching from a write to a read state.
+	// This handles case where write succeeds and read event does not occur.  If we didn't reset,
+	// the socket timeout would go through two iterations (double the timeout) because a write
+	// event occurred in the first timeout period.
+	cmd->flags &= ~AS_ASYNC_FLAGS_EVENT_RECEIVED;
+	return AS_EVENT_WRITE_COMPLETE;
+}
+
+static int
+as_iocp_read(as_event_command* cmd)
+{
+	cmd->flags |= AS_ASYNC_FLAGS_EVENT_RECEIVED;
+
+	as_event_connection* conn = cmd->conn;
+	as_socket_fd fd = conn->socket.fd;
+
+	if (conn->socket.ctx) {
+		do {
+			int rv = as_tls_read_once(&conn->socket, cmd->buf + cmd->pos, cmd->len - cmd->pos);
+			if (rv > 0) {
+				as_iocp_watch_read(cmd);
+				cmd->pos += rv;
+				cmd->bytes_in += rv;
+				continue;
+			}
+			else if (rv == -1) {
+				// TLS wants a read
+				as_iocp_watch_read(cmd);
+				return AS_EVENT_READ_INCOMPLETE;
+			}
+			else if (rv == -2) {
+				// TLS sometimes needs to write, even when the app is reading.
+				as_iocp_watch_write(cmd);
+				return AS_EVENT_TLS_NEED_WRITE;
+			}
+			else if (rv < -2) {
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_TLS_ERROR, "TLS read failed", rv);
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_READ_ERROR;
+			}
+			// as_tls_read_once doesn't return 0
+		} while (cmd->pos < cmd->len);
+	}
+	else {
+		while (cmd->pos < cmd->len) {
+			// Copy bytes already received by the connection.
+			uint32_t n = as_iocp_consume(conn, cmd->buf + cmd->pos, cmd->len - cmd->pos);
+
+			if (n > 0) {
+				cmd->pos += n;
+				cmd->bytes_in += n;
+				continue;
+			}
+
+			// Receive into the drained connection buffer.
+			as_iocp_recv(conn);
+
+			if (conn->rx_error) {
+				int32_t e = conn->rx_error;
+
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+
+					if (e == AS_IOCP_EOF) {
+						as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket read closed by peer", 0);
+					}
+					else {
+						as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket read failed", e);
+					}
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_READ_ERROR;
+			}
+
+			// Wait for receive completion.
+			return AS_EVENT_READ_INCOMPLETE;
+		}
+	}
+
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static inline void
+as_iocp_command_read_start(as_event_command* cmd)
+{
+	cmd->command_sent_counter++;
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	as_iocp_watch_read(cmd);
+
+	if (cmd->pipe_listener != NULL) {
+		as_pipe_read_start(cmd);
+	}
+}
+
+static inline void
+as_iocp_command_write(as_event_command* cmd)
+{
+	as_iocp_watch_write(cmd);
+
+	if (as_iocp_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
+		// Done with write. Register for read.
+		as_iocp_command_read_start(cmd);
+	}
+}
+
+void
+as_event_command_resume_read(as_event_command* cmd)
+{
+	// Flow control only stops the watcher. A pending receive continues to stage data.
+	as_iocp_watch_read(cmd);
+}
+
+void
+as_event_command_write_start(as_event_command* cmd)
+{
+	as_event_command_trace(cmd, AS_TRACE_WRITE, AEROSPIKE_OK);
+	cmd->state = AS_ASYNC_STATE_COMMAND_WRITE;
+	as_event_set_write(cmd);
+	as_iocp_command_write(cmd);
+}
+
+static int
+as_iocp_command_start(as_event_command* cmd)
+{
+	as_event_connection_complete(cmd);
+
+	if (cmd->type == AS_ASYNC_TYPE_CONNECTOR) {
+		as_event_connector_success(cmd);
+		return AS_EVENT_COMMAND_DONE;
+	}
+	else {
+		as_event_command_write_start(cmd);
+		return AS_EVENT_READ_COMPLETE;
+	}
+}
+
+static inline void
+as_iocp_command_auth_write(as_event_command* cmd)
+{
+	as_iocp_watch_write(cmd);
+
+	if (as_iocp_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
+		// Done with auth write. Register for auth read.
+		as_event_set_auth_read_header(cmd);
+		as_iocp_watch_read(cmd);
+	}
+}
+
+static void
+as_iocp_connect_complete(as_event_command* cmd)
+{
+	if (cmd->cluster->auth_enabled) {
+		as_session* session = as_session_load(&cmd->node->session);
+
+		if (session) {
+			as_incr_uint32(&session->ref_count);
+			as_event_set_auth_write(cmd, session);
+			as_session_release(session);
+
+			cmd->state = AS_ASYNC_STATE_AUTH_WRITE;
+			as_iocp_command_auth_write(cmd);
+		}
+		else {
+			as_iocp_command_start(cmd);
+		}
+	}
+	else {
+		as_iocp_command_start(cmd);
+	}
+}
+
+static int
+as_iocp_command_peek_block(as_event_command* cmd)
+{
+	// Batch, scan, query may be waiting on end block.
+	// Prepare for next message block.
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	int rv = as_iocp_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+
+	as_proto* proto = (as_proto*)cmd->buf;
+
+	if (! as_event_proto_parse(cmd, proto)) {
+		return AS_EVENT_READ_ERROR;
+	}
+
+	size_t size = proto->sz;
+
+	cmd->len = (uint32_t)size;
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+	// Check for end block size.
+	if (cmd->len == sizeof(as_msg) && ! as_proto_is_compressed(cmd->proto_type_rcv)) {
+		// Look like we received end block.  Read and parse to make sure.
+		rv = as_iocp_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+		cmd->pos = 0;
+
+		if (! cmd->parse_results(cmd)) {
+			// We did not finish after all. Prepare to read next header.
+			cmd->len = sizeof(as_proto);
+			cmd->pos = 0;
+			cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+		}
+		else {
+			return AS_EVENT_COMMAND_DONE;
+		}
+	}
+	else {
+		// Received normal data block.  Stop reading for fairness reasons and wait
+		// till next iteration.
+		as_event_command_reserve_read(cmd);
+	}
+
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static int
+as_iocp_parse_authentication(as_event_command* cmd)
+{
+	int rv;
+	if (cmd->state == AS_ASYNC_STATE_AUTH_READ_HEADER) {
+		// Read response length
+		rv = as_iocp_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+
+		if (! as_event_set_auth_parse_header(cmd)) {
+			return AS_EVENT_READ_ERROR;
+		}
+
+		if (cmd->len > cmd->read_capacity) {
+			as_error err;
+			as_error_update(&err, AEROSPIKE_ERR_CLIENT, "Authenticate response size is corrupt: %u", cmd->len);
+			as_event_parse_error(cmd, &err);
+			return AS_EVENT_READ_ERROR;
+		}
+	}
+
+	rv = as_iocp_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+
+	// Parse authentication response.
+	uint8_t code = cmd->buf[AS_ASYNC_AUTH_RETURN_CODE];
+
+	if (code && code != AEROSPIKE_SECURITY_NOT_ENABLED) {
+		// Can't authenticate socket, so must close it.
+		as_node_signal_login(cmd->node);
+		as_error err;
+		as_error_update(&err, code, "Authentication failed: %s", as_error_string(code));
+		as_event_parse_error(cmd, &err);
+		return AS_EVENT_READ_ERROR;
+	}
+
+	return as_iocp_command_start(cmd);
+}
+
+static int
+as_iocp_command_read(as_event_command* cmd)
+{
+	int rv;
+
+	if (cmd->state == AS_ASYNC_STATE_COMMAND_READ_HEADER) {
+		// Read response length
+		rv = as_iocp_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+
+		as_proto* proto = (as_proto*)cmd->buf;
+
+		if (! as_event_proto_parse(cmd, proto)) {
+			return AS_EVENT_READ_ERROR;
+		}
+
+		size_t size = proto->sz;
+
+		cmd->len = (uint32_t)size;
+		cmd->pos = 0;
+		cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+		as_event_command_reserve_read(cmd);
+	}
+
+	// Read response body
+	rv = as_iocp_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+	cmd->pos = 0;
+
+	if (as_proto_is_compressed(cmd->proto_type_rcv)) {
+		if (! as_event_decompress(cmd)) {
+			return AS_EVENT_READ_ERROR;
+		}
+	}
+
+	if (! cmd->parse_results(cmd)) {
+		// Batch, scan, query is not finished.
+		return as_iocp_command_peek_block(cmd);
+	}
+
+	return AS_EVENT_COMMAND_DONE;
+}
+
+static bool
+as_iocp_tls_connect(as_event_command* cmd, as_event_connection* conn)
+{
+	int rv = as_tls_connect_once(&conn->socket);
+
+	if (rv < -2) {
+		if (! as_event_socket_retry(cmd)) {
+			// Failed, error has been logged.
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_ERR_TLS_ERROR, "TLS connection failed");
+			as_event_socket_error(cmd, &err);
+		}
+		return false;
+	}
+
+	if (rv == -1) {
+		// TLS needs a read.
+		as_iocp_watch_read(cmd);
+		return true;
+	}
+
+	if (rv == -2) {
+		// TLS needs a write.
+		as_iocp_watch_write(cmd);
+		return true;
+	}
+
+	if (rv == 0) {
+		if (! as_event_socket_retry(cmd)) {
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_ERR_TLS_ERROR, "TLS connection shutdown");
+			as_event_socket_error(cmd, &err);
+		}
+		return false;
+	}
+
+	// TLS connection established.
+	as_iocp_connect_complete(cmd);
+	return false;
+}
+
+static void
+as_iocp_callback_common(as_event_command* cmd, as_event_connection* conn)
+{
+	switch (cmd->state) {
+	case AS_ASYNC_STATE_CONNECT:
+		as_iocp_connect_complete(cmd);
+		break;
+
+	case AS_ASYNC_STATE_TLS_CONNECT:
+		do {
+			if (! as_iocp_tls_connect(cmd, conn)) {
+				return;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	case AS_ASYNC_STATE_AUTH_WRITE:
+		as_iocp_command_auth_write(cmd);
+		break;
+
+	case AS_ASYNC_STATE_AUTH_READ_HEADER:
+	case AS_ASYNC_STATE_AUTH_READ_BODY:
+		// If we're using TLS we must loop until there are no bytes
+		// left in the encryption buffer because we won't get another
+		// poll event.
+		do {
+			switch (as_iocp_parse_authentication(cmd)) {
+				case AS_EVENT_COMMAND_DONE:
+				case AS_EVENT_READ_ERROR:
+					// Do not touch cmd again because it's been deallocated.
+					return;
+
+				case AS_EVENT_READ_COMPLETE:
+					as_iocp_watch_read(cmd);
+					break;
+
+				default:
+					break;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	case AS_ASYNC_STATE_COMMAND_WRITE:
+		as_iocp_command_write(cmd);
+		break;
+
+	case AS_ASYNC_STATE_COMMAND_READ_HEADER:
+	case AS_ASYNC_STATE_COMMAND_READ_BODY:
+		// If we're using TLS we must loop until there are no bytes
+		// left in the encryption buffer because we won't get another
+		// poll event.
+		do {
+			switch (as_iocp_command_read(cmd)) {
+			case AS_EVENT_COMMAND_DONE:
+			case AS_EVENT_READ_ERROR:
+				// Do not touch cmd again because it's been deallocated.
+				return;
+
+			case AS_EVENT_READ_COMPLETE:
+				as_iocp_watch_read(cmd);
+				break;
+
+			default:
+				break;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	default:
+		as_log_error("unexpected cmd state %d", cmd->state);
+		break;
+	}
+}
+
+static as_event_command*
+as_iocp_read_command(as_event_connection* conn)
+{
+	if (conn->pipeline) {
+		as_pipe_connection* pipe = (as_pipe_connection*)conn;
+
+		if (pipe->writer && cf_ll_size(&pipe->readers) == 0) {
+			// Authentication response will only have a writer.
+			return pipe->writer;
+		}
+
+		// Next response is at head of reader linked list.
+		cf_ll_element* link = cf_ll_get_head(&pipe->readers);
+
+		if (! link) {
+			as_log_debug("Pipeline read event ignored");
+			return NULL;
+		}
+		return as_pipe_link_to_command(link);
+	}
+	return ((as_async_connection*)conn)->cmd;
+}
+
+static inline as_event_command*
+as_iocp_write_command(as_event_connection* conn)
+{
+	return conn->pipeline ?
+		((as_pipe_connection*)conn)->writer :
+		((as_async_connection*)conn)->cmd;
+}
+
+static void
+as_iocp_dispatch_read(as_event_connection* conn)
+{
+	// A single receive can contain multiple pipeline responses or message blocks,
+	// so keep dispatching while the current reader makes progress.
+	while (! conn->closed && (conn->watching & AS_IOCP_WATCH_READ) &&
+		   (as_iocp_staged(conn) > 0 || conn->rx_error)) {
+		uint32_t staged = as_iocp_staged(conn);
+		as_event_command* cmd = as_iocp_read_command(conn);
+
+		if (! cmd) {
+			return;
+		}
+
+		as_iocp_callback_common(cmd, conn);
+
+		if (conn->closed || as_iocp_staged(conn) == staged) {
+			return;
+		}
+	}
+}
+
+static void
+as_iocp_connect_complete_op(as_event_connection* conn, int32_t res)
+{
+	if (conn->closed) {
+		return;
+	}
+
+	as_event_command* cmd = as_iocp_write_command(conn);
+
+	if (! cmd) {
+		return;
+	}
+
+	// Sockets connected with ConnectEx() need their context updated before other socket
+	// functions (shutdown, getpeername, TLS) work.
+	if (res == 0 && setsockopt(conn->socket.fd, SOL_SOCKET, SO_UPDATE_CONNECT_CONTEXT, NULL, 0) != 0) {
+		res = WSAGetLastError();
+	}
+
+	if (res) {
+		if (! as_event_socket_retry(cmd)) {
+			as_error err;
+			as_socket_error(conn->socket.fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket connect failed", res);
+			as_event_socket_error(cmd, &err);
+		}
+		return;
+	}
+
+	as_iocp_callback_common(cmd, conn);
+}
+
+static void
+as_iocp_recv_complete(as_event_connection* conn, int32_t res, uint32_t bytes)
+{
+	if (conn->closed) {
+		return;
+	}
+
+	if (res == 0) {
+		if (bytes > 0) {
+			conn->recv_head = 0;
+			conn->recv_tail = bytes;
+		}
+		else {
+			conn->rx_error = AS_IOCP_EOF;
+		}
+	}
+	else if (res != WSA_OPERATION_ABORTED) {
+		conn->rx_error = res;
+	}
+
+	as_iocp_dispatch_read(conn);
+}
+
+static void
+as_iocp_readable_complete(as_event_connection* conn, int32_t res)
+{
+	// Socket errors are detected by the TLS library on the next read.
+	if (conn->closed || res == WSA_OPERATION_ABORTED || ! (conn->watching & AS_IOCP_WATCH_READ)) {
+		return;
+	}
+
+	as_event_command* cmd = as_iocp_read_command(conn);
+
+	if (cmd) {
+		as_iocp_callback_common(cmd, conn);
+	}
+}
+
+static void
+as_iocp_send_complete(as_event_connection* conn, int32_t res, uint32_t bytes)
+{
+	if (conn->closed || ! (conn->watching & AS_IOCP_WATCH_WRITE)) {
+		return;
+	}
+
+	as_event_command* cmd = as_iocp_write_command(conn);
+
+	if (! cmd) {
+		return;
+	}
+
+	if (res == 0) {
+		if (bytes > 0) {
+			cmd->pos += bytes;
+			cmd->bytes_out += bytes;
+		}
+		else {
+			conn->tx_error = AS_IOCP_EOF;
+		}
+	}
+	else if (res != WSA_OPERATION_ABORTED) {
+		conn->tx_error = res;
+	}
+
+	as_iocp_callback_common(cmd, conn);
+}
+
+static void
+as_iocp_writable_complete(as_event_connection* conn)
+{
+	if (conn->closed || ! (conn->watching & AS_IOCP_WATCH_WRITE)) {
+		return;
+	}
+
+	as_event_command* cmd = as_iocp_write_command(conn);
+
+	if (cmd) {
+		as_iocp_callback_common(cmd, conn);
+	}
+}
+
+static void
+as_iocp_conn_event(as_event_connection* conn, as_iocp_op* op, int32_t res, uint32_t bytes)
+{
+	op->pending = false;
+
+	// The completed operation's reference is kept while the completion is dispatched,
+	// because the connection can be closed by the command state machine.
+	switch (op->type) {
+		case AS_IOCP_OP_CONNECT:
+			as_iocp_connect_complete_op(conn, res);
+			break;
+
+		case AS_IOCP_OP_RECV:
+			as_iocp_recv_complete(conn, res, bytes);
+			break;
+
+		case AS_IOCP_OP_READABLE:
+			as_iocp_readable_complete(conn, res);
+			break;
+
+		case AS_IOCP_OP_SEND:
+			as_iocp_send_complete(conn, res, bytes);
+			break;
+
+		case AS_IOCP_OP_WRITABLE:
+			as_iocp_writable_complete(conn);
+			break;
+
+		default:
+			as_log_error("Unknown IOCP operation: %u", op->type);
+			break;
+	}
+
+	conn->inflight--;
+
+	if (conn->closed) {
+		if (conn->inflight == 0) {
+			as_iocp_conn_free(conn);
+		}
+		return;
+	}
+
+	// Re-arm connection operations.
+	if (conn->socket.ctx) {
+		as_iocp_poll(conn);
+	}
+	else {
+		as_iocp_recv(conn);
+	}
+}
+
+//---------------------------------
+// Connect
+//---------------------------------
+
+static void
+as_iocp_watcher_init(as_event_command* cmd, as_socket* sock)
+{
+	as_event_connection* conn = cmd->conn;
+	memcpy(&conn->socket, sock, sizeof(as_socket));
+
+	// Change state if using TLS.
+	if (as_socket_use_tls(cmd->cluster->tls_ctx)) {
+		cmd->state = AS_ASYNC_STATE_TLS_CONNECT;
+	}
+
+	int watch = cmd->pipe_listener != NULL ?
+		AS_IOCP_WATCH_WRITE | AS_IOCP_WATCH_READ : AS_IOCP_WATCH_WRITE;
+	conn->watching = watch;
+
+	// ConnectEx() has been started. Its completion starts the command and arms the first
+	// receive, because sockets can't receive before they are connected.
+	conn->send_op.type = AS_IOCP_OP_CONNECT;
+	conn->send_op.pending = true;
+	conn->inflight++;
+}
+
+static bool
+as_iocp_connect_fd(as_socket_fd fd, struct sockaddr* addr, int size, OVERLAPPED* ov)
+{
+	memset(ov, 0, sizeof(OVERLAPPED));
+
+	if (as_iocp_connect_ex(fd, addr, size, NULL, 0, NULL, ov)) {
+		// Completion is still queued to the port.
+		return true;
+	}
+	return WSAGetLastError() == ERROR_IO_PENDING;
+}
+
+static int
+as_iocp_try_connections(as_socket_fd fd, as_address* addresses, int size, int i, int max, OVERLAPPED* ov)
+{
+	while (i < max) {
+		if (as_iocp_connect_fd(fd, (struct sockaddr*)&addresses[i].addr, size, ov)) {
+			return i;
+		}
+		i++;
+	}
+	return -1;
+}
+
+static bool
+as_iocp_register_fd(as_event_loop* event_loop, as_socket_fd fd, int family, int size)
+{
+	// ConnectEx() requires a bound socket.
+	struct sockaddr_storage local;
+	memset(&local, 0, sizeof(local));
+	local.ss_family = (ADDRESS_FAMILY)family;
+
+	if (bind(fd, (struct sockaddr*)&local, size) != 0) {
+		return false;
+	}
+
+	if (! CreateIoCompletionPort((HANDLE)fd, event_loop->loop, AS_IOCP_KEY_CONN, 0)) {
+		return false;
+	}
+
+	if (! as_iocp_connect_ex) {
+		// Load extension function. Concurrent loads from different event loops store the
+		// same pointer.
+		GUID guid = WSAID_CONNECTEX;
+		LPFN_CONNECTEX fn = NULL;
+		DWORD bytes;
+
+		if (WSAIoctl(fd, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid), &fn, sizeof(fn),
+				&bytes, NULL, NULL) != 0) {
+			return false;
+		}
+		as_iocp_connect_ex = fn;
+	}
+	return true;
+}
+
+static int
+as_iocp_try_family_connections(as_event_command* cmd, int family, int begin, int end, int index, as_address* primary, as_socket* sock)
+{
+	// Create a non-blocking socket.
+	as_socket_fd fd;
+	int rv = as_socket_create_fd(family, &fd);
+
+	if (rv < 0) {
+		return rv;
+	}
+
+	rv = as_socket_set_options(fd, &cmd->cluster->socket_options);
+
+	if (rv < 0) {
+		as_close(fd);
+		return rv;
+	}
+
+	if (cmd->pipe_listener && ! as_pipe_modify_fd(fd)) {
+		return -1000;
+	}
+
+	int size = (family == AF_INET)? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+
+	if (! as_iocp_register_fd(cmd->event_loop, fd, family, size)) {
+		as_close(fd);
+		return -1003;
+	}
+
+	as_tls_context* ctx = as_socket_get_tls_context(cmd->cluster->tls_ctx);
+
+	if (! as_socket_wrap(sock, family, fd, ctx, cmd->node->tls_name)) {
+		return -1001;
+	}
+
+	if (ctx) {
+		as_tls_session_resume(ctx, sock->ssl, cmd->node->name, cmd->node->tls_name);
+	}
+
+	// Try addresses.
+	as_address* addresses = cmd->node->addresses;
+	OVERLAPPED* ov = &cmd->conn->send_op.ov;
+
+	if (index >= 0) {
+		// Try primary address.
+		if (as_iocp_connect_fd(fd, (struct sockaddr*)&primary->addr, size, ov)) {
+			return index;
+		}
+
+		// Start from current index + 1 to end.
+		rv = as_iocp_try_connections(fd, addresses, size, index + 1, end, ov);
+
+		if (rv < 0) {
+			// Start from begin to index.
+			rv = as_iocp_try_connections(fd, addresses, size, begin, index, ov);
+		}
+	}
+	else {
+		rv = as_iocp_try_connections(fd, addresses, size, begin, end, ov);
+	}
+
+	if (rv < 0) {
+		// Couldn't start a connection on any socket address - close the socket.
+		as_socket_close(sock);
+		return -1002;
+	}
+	return rv;
+}
+
+static void
+as_iocp_connect_error(as_event_command* cmd, as_address* primary, int rv)
+{
+	// Socket has already been closed. Release connection.
+	cf_free(cmd->conn);
+	as_event_decr_conn(cmd);
+	cmd->event_loop->errors++;
+
+	if (as_event_command_retry(cmd, false)) {
+		return;
+	}
+
+	as_error err;
+	as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Connect failed: %d %s %s", rv, cmd->node->name, primary->name);
+
+	// Only timer needs to be released on socket connection failure.
+	// Operations have not been submitted yet.
+	as_event_timer_stop(cmd);
+	as_event_error_callback(cmd, &err);
+}
+
+void
+as_event_connect(as_event_command* cmd, as_async_conn_pool* pool)
+{
+	// Try addresses.
+	as_socket sock;
+	as_node* node = cmd->node;
+	uint32_t index = node->address_index;
+	as_address* primary = &node->addresses[index];
+	int rv;
+	int first_rv;
+
+	// Operation state must be valid before ConnectEx() is started.
+	as_iocp_conn_init(cmd->event_loop, cmd->conn);
+
+	if (primary->addr.ss_family == AF_INET) {
+		// Try IPv4 addresses first.
+		rv = as_iocp_try_family_connections(cmd, AF_INET, 0, node->address4_size, index, primary, &sock);
+
+		if (rv < 0) {
+			// Try IPv6 addresses.
+			first_rv = rv;
+			rv = as_iocp_try_family_connections(cmd, AF_INET6, AS_ADDRESS4_MAX, AS_ADDRESS4_MAX + node->address6_size, -1, NULL, &sock);
+		}
+	}
+	else {
+		// Try IPv6 addresses first.
+		rv = as_iocp_try_family_connections(cmd, AF_INET6, AS_ADDRESS4_MAX, AS_ADDRESS4_MAX + node->address6_size, index, primary, &sock);
+
+		if (rv < 0) {
+			// Try IPv4 addresses.
+			first_rv = rv;
+			rv = as_iocp_try_family_connections(cmd, AF_INET, 0, node->address4_size, -1, NULL, &sock);
+		}
+	}
+
+	if (rv < 0) {
+		as_iocp_connect_error(cmd, primary, first_rv);
+		return;
+	}
+
+	if (rv != index) {
+		// Replace invalid primary address with valid alias.
+		// Other threads may not see this change immediately.
+		// It's just a hint, not a requirement to try this new address first.
+		as_store_uint32(&node->address_index, rv);
+		as_log_debug("Change node address %s %s", node->name, as_node_get_address_string(node));
+	}
+
+	pool->opened++;
+	as_iocp_watcher_init(cmd, &sock);
+	cmd->event_loop->errors = 0; // Reset errors on valid connection.
+}
+
+static void
+as_iocp_close_connections(as_node* node, as_async_conn_pool* pool)
+{
+	as_event_connection* conn;
+
+	while (as_queue_pop(&pool->queue, &conn)) {
+		as_event_release_connection(conn, pool);
+	}
+	as_queue_destroy(&pool->queue);
+}
+
+void
+as_event_node_destroy(as_node* node)
+{
+	// Close connections.
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		as_iocp_close_connections(node, &node->async_conn_pools[i]);
+		as_iocp_close_connections(node, &node->pipe_conn_pools[i]);
+	}
+	cf_free(node->async_conn_pools);
+	cf_free(node->pipe_conn_pools);
+}
+
+#endif
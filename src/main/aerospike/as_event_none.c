@@ -34,12 +34,23 @@ as_event_register_external_loop(as_event_loop* event_loop)
 {
 }
 
+uint64_t
+as_event_loop_iterations(as_event_loop* event_loop)
+{
+	return 0;
+}
+
 bool
 as_event_execute(as_event_loop* event_loop, as_event_executable executable, void* udata)
 {
 	return false;
 }
 
+void
+as_event_command_resume_read(as_event_command* cmd)
+{
+}
+
 void
 as_event_command_write_start(as_event_command* cmd)
 {
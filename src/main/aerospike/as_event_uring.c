@@ -0,0 +1,1882 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_event.h>
+#include <aerospike/as_event_internal.h>
+#include <aerospike/as_admin.h>
+#include <aerospike/as_async.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_pipe.h>
+#include <aerospike/as_proto.h>
+#include <aerospike/as_socket.h>
+#include <aerospike/as_status.h>
+#include <aerospike/as_thread.h>
+#include <aerospike/as_tls.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <citrusleaf/cf_clock.h>
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+extern int as_event_send_buffer_size;
+extern int as_event_recv_buffer_size;
+extern bool as_event_threads_created;
+
+//---------------------------------
+// Liburing Functions
+//---------------------------------
+
+#if defined(AS_USE_LIBURING)
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Submission queue entries per event loop.
+#define AS_URING_QUEUE_SIZE 4096
+
+// Provided receive buffers registered per event loop. Count must be a power of 2.
+#define AS_URING_BUF_GROUP 0
+#define AS_URING_BUF_COUNT 256
+#define AS_URING_BUF_SIZE 16384
+
+// Connection receive buffer used when the buffer ring is exhausted.
+#define AS_URING_FALLBACK_SIZE 16384
+#define AS_URING_FALLBACK_BID 0xFFFF
+
+// Maximum bytes copied to a connection send buffer per send operation.
+#define AS_URING_SEND_MAX (1024 * 64)
+#define AS_URING_SEND_MIN 4096
+
+// Operation tags stored in the low bits of completion user data.
+#define AS_URING_OP_NONE 0
+#define AS_URING_OP_WAKEUP 1
+#define AS_URING_OP_RECV 2
+#define AS_URING_OP_RECV_FALLBACK 3
+#define AS_URING_OP_SEND 4
+#define AS_URING_OP_POLL 5
+#define AS_URING_OP_MASK 7
+
+#define AS_URING_RECV_NONE 0
+#define AS_URING_RECV_MULTISHOT 1
+#define AS_URING_RECV_FALLBACK 2
+
+#define AS_URING_WATCH_READ 1
+#define AS_URING_WATCH_WRITE 2
+
+// Positive rx_error/tx_error value signifies socket closed by peer.
+#define AS_URING_EOF 1
+
+static void
+as_event_close_loop(as_event_loop* event_loop)
+{
+	// Ring resources are released by the worker thread after this iteration completes.
+	event_loop->closing = true;
+}
+
+static inline uint64_t
+as_uring_data(void* ptr, uint8_t op)
+{
+	return (uint64_t)(uintptr_t)ptr | op;
+}
+
+// Move ready completions to the event loop backlog without dispatching them, so the kernel
+// has completion queue space to accept more submissions. Return number of entries moved.
+static uint32_t
+as_uring_stash_completions(as_event_loop* event_loop)
+{
+	struct io_uring* ring = event_loop->loop;
+	struct io_uring_cqe* cqe;
+	uint32_t count = 0;
+
+	while (io_uring_peek_cqe(ring, &cqe) == 0) {
+		if (event_loop->backlog_size == event_loop->backlog_capacity) {
+			event_loop->backlog_capacity = event_loop->backlog_capacity ?
+				event_loop->backlog_capacity * 2 : 256;
+			event_loop->backlog = cf_realloc(event_loop->backlog,
+				sizeof(struct io_uring_cqe) * event_loop->backlog_capacity);
+		}
+
+		struct io_uring_cqe* e = &event_loop->backlog[event_loop->backlog_size++];
+		e->user_data = cqe->user_data;
+		e->res = cqe->res;
+		e->flags = cqe->flags;
+		io_uring_cqe_seen(ring, cqe);
+		count++;
+	}
+	return count;
+}
+
+// Return a submission queue entry. Never returns NULL, because dropped operations can not be
+// recovered: the wakeup read is one-shot, cancels are needed to release connections and
+// commands without timeouts would hang.
+static struct io_uring_sqe*
+as_uring_get_sqe(as_event_loop* event_loop)
+{
+	struct io_uring* ring = event_loop->loop;
+	struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
+
+	while (! sqe) {
+		// Submission queue is full. Flush entries to the kernel and try again.
+		io_uring_submit(ring);
+		sqe = io_uring_get_sqe(ring);
+
+		if (sqe) {
+			break;
+		}
+
+		// The kernel did not accept entries, usually because the completion queue is full
+		// (-EBUSY). Reap completions into the backlog, which is dispatched before the ring.
+		if (as_uring_stash_completions(event_loop) == 0) {
+			int rv = io_uring_submit_and_wait(ring, 1);
+
+			if (rv < 0 && rv != -EBUSY && rv != -EAGAIN && rv != -EINTR) {
+				as_log_error("io_uring submit failed: %d", rv);
+			}
+			as_uring_stash_completions(event_loop);
+		}
+		sqe = io_uring_get_sqe(ring);
+	}
+	return sqe;
+}
+
+static void
+as_uring_cancel(as_event_connection* conn, uint8_t op)
+{
+	struct io_uring_sqe* sqe = as_uring_get_sqe(conn->event_loop);
+	io_uring_prep_cancel64(sqe, as_uring_data(conn, op), 0);
+	io_uring_sqe_set_data64(sqe, AS_URING_OP_NONE);
+}
+
+//---------------------------------
+// Timers
+//---------------------------------
+
+static void
+as_uring_heap_up(as_event_loop* event_loop, uint32_t i)
+{
+	as_uring_timer** heap = event_loop->timers;
+	as_uring_timer* timer = heap[i];
+
+	while (i > 1) {
+		uint32_t parent = i >> 1;
+
+		if (heap[parent]->deadline <= timer->deadline) {
+			break;
+		}
+		heap[i] = heap[parent];
+		heap[i]->index = i;
+		i = parent;
+	}
+	heap[i] = timer;
+	timer->index = i;
+}
+
+static void
+as_uring_heap_down(as_event_loop* event_loop, uint32_t i)
+{
+	as_uring_timer** heap = event_loop->timers;
+	as_uring_timer* timer = heap[i];
+	uint32_t size = event_loop->timers_size;
+
+	while (true) {
+		uint32_t child = i << 1;
+
+		if (child > size) {
+			break;
+		}
+
+		if (child < size && heap[child + 1]->deadline < heap[child]->deadline) {
+			child++;
+		}
+
+		if (timer->deadline <= heap[child]->deadline) {
+			break;
+		}
+		heap[i] = heap[child];
+		heap[i]->index = i;
+		i = child;
+	}
+	heap[i] = timer;
+	timer->index = i;
+}
+
+static void
+as_uring_heap_insert(as_event_loop* event_loop, as_uring_timer* timer)
+{
+	if (event_loop->timers_size + 1 >= event_loop->timers_capacity) {
+		// Heap is 1-based.
+		event_loop->timers_capacity = event_loop->timers_capacity ?
+			event_loop->timers_capacity * 2 : 256;
+		event_loop->timers = cf_realloc(event_loop->timers,
+			sizeof(as_uring_timer*) * event_loop->timers_capacity);
+	}
+
+	uint32_t i = ++event_loop->timers_size;
+	event_loop->timers[i] = timer;
+	as_uring_heap_up(event_loop, i);
+}
+
+static void
+as_uring_heap_remove(as_event_loop* event_loop, as_uring_timer* timer)
+{
+	uint32_t i = timer->index;
+	as_uring_timer* last = event_loop->timers[event_loop->timers_size--];
+
+	timer->index = 0;
+
+	if (i <= event_loop->timers_size) {
+		event_loop->timers[i] = last;
+		last->index = i;
+		as_uring_heap_up(event_loop, i);
+		as_uring_heap_down(event_loop, last->index);
+	}
+}
+
+void
+as_uring_timer_start(as_event_loop* event_loop, as_uring_timer* timer, uint64_t timeout, uint64_t repeat)
+{
+	if (timer->index) {
+		as_uring_heap_remove(event_loop, timer);
+	}
+
+	timer->deadline = cf_getms() + timeout;
+	timer->repeat = repeat;
+	timer->pass = event_loop->timers_pass;
+	as_uring_heap_insert(event_loop, timer);
+}
+
+void
+as_uring_timer_again(as_event_loop* event_loop, as_uring_timer* timer)
+{
+	// Same semantics as ev_timer_again(). Restart repeating timer or stop non-repeating timer.
+	if (timer->index) {
+		as_uring_heap_remove(event_loop, timer);
+	}
+
+	if (timer->repeat) {
+		timer->deadline = cf_getms() + timer->repeat;
+		timer->pass = event_loop->timers_pass;
+		as_uring_heap_insert(event_loop, timer);
+	}
+}
+
+void
+as_uring_timer_stop(as_event_loop* event_loop, as_uring_timer* timer)
+{
+	if (timer->index) {
+		as_uring_heap_remove(event_loop, timer);
+	}
+}
+
+static struct __kernel_timespec*
+as_uring_timer_wait(as_event_loop* event_loop, struct __kernel_timespec* ts)
+{
+	if (event_loop->timers_size == 0) {
+		return NULL;
+	}
+
+	uint64_t deadline = event_loop->timers[1]->deadline;
+	uint64_t now = cf_getms();
+	uint64_t wait = (deadline > now)? deadline - now : 0;
+
+	ts->tv_sec = (long long)(wait / 1000);
+	ts->tv_nsec = (long long)((wait % 1000) * 1000 * 1000);
+	return ts;
+}
+
+static void
+as_uring_process_timers(as_event_loop* event_loop)
+{
+	uint32_t pass = ++event_loop->timers_pass;
+	uint64_t now = cf_getms();
+
+	while (event_loop->timers_size > 0 && ! event_loop->closing) {
+		as_uring_timer* timer = event_loop->timers[1];
+
+		// Timers started while processing this pass (retries use zero timeouts) run on the
+		// next loop iteration, so they can't starve socket completions.
+		if (timer->deadline > now || timer->pass == pass) {
+			break;
+		}
+
+		as_uring_heap_remove(event_loop, timer);
+
+		as_event_command* cmd = timer->data;
+
+		if (timer->repeat) {
+			// Repeating timers are restarted before the callback, same as libev.
+			timer->deadline = now + timer->repeat;
+			timer->pass = pass;
+			as_uring_heap_insert(event_loop, timer);
+			as_event_socket_timeout(cmd);
+		}
+		else {
+			as_event_process_timer(cmd);
+		}
+	}
+}
+
+//---------------------------------
+// Connection Buffers
+//---------------------------------
+
+static inline void
+as_uring_buf_return(as_event_loop* event_loop, uint16_t bid)
+{
+	io_uring_buf_ring_add(event_loop->buf_ring, event_loop->bufs + ((size_t)bid * AS_URING_BUF_SIZE),
+		AS_URING_BUF_SIZE, bid, io_uring_buf_ring_mask(AS_URING_BUF_COUNT), 0);
+	io_uring_buf_ring_advance(event_loop->buf_ring, 1);
+}
+
+static void
+as_uring_chunk_push(as_event_connection* conn, uint8_t* data, uint32_t len, uint16_t bid)
+{
+	if (conn->chunk_head + conn->chunk_size == conn->chunk_capacity) {
+		if (conn->chunk_head > 0) {
+			// Compact consumed entries.
+			memmove(conn->chunks, conn->chunks + conn->chunk_head,
+				sizeof(as_uring_chunk) * conn->chunk_size);
+			conn->chunk_head = 0;
+		}
+		else {
+			conn->chunk_capacity = conn->chunk_capacity ? conn->chunk_capacity * 2 : 8;
+			conn->chunks = cf_realloc(conn->chunks, sizeof(as_uring_chunk) * conn->chunk_capacity);
+		}
+	}
+
+	as_uring_chunk* chunk = &conn->chunks[conn->chunk_head + conn->chunk_size];
+	chunk->data = data;
+	chunk->len = len;
+	chunk->bid = bid;
+	conn->chunk_size++;
+}
+
+static inline void
+as_uring_chunk_pop(as_event_connection* conn)
+{
+	as_uring_chunk* chunk = &conn->chunks[conn->chunk_head];
+
+	if (chunk->bid != AS_URING_FALLBACK_BID) {
+		as_uring_buf_return(conn->event_loop, chunk->bid);
+	}
+
+	conn->chunk_head++;
+
+	if (--conn->chunk_size == 0) {
+		conn->chunk_head = 0;
+	}
+}
+
+static uint32_t
+as_uring_consume(as_event_connection* conn, uint8_t* buf, uint32_t size)
+{
+	uint32_t total = 0;
+
+	while (conn->chunk_size > 0 && total < size) {
+		as_uring_chunk* chunk = &conn->chunks[conn->chunk_head];
+		uint32_t n = size - total;
+
+		if (n > chunk->len) {
+			n = chunk->len;
+		}
+
+		memcpy(buf + total, chunk->data, n);
+		chunk->data += n;
+		chunk->len -= n;
+		total += n;
+
+		if (chunk->len == 0) {
+			as_uring_chunk_pop(conn);
+		}
+	}
+	return total;
+}
+
+static uint32_t
+as_uring_staged(as_event_connection* conn)
+{
+	uint32_t total = 0;
+
+	for (uint32_t i = 0; i < conn->chunk_size; i++) {
+		total += conn->chunks[conn->chunk_head + i].len;
+	}
+	return total;
+}
+
+//---------------------------------
+// Connection Operations
+//---------------------------------
+
+static void
+as_uring_recv(as_event_connection* conn)
+{
+	if (conn->recv_state != AS_URING_RECV_NONE || conn->rx_error || conn->closed) {
+		return;
+	}
+
+	if (conn->starved && conn->chunk_size > 0) {
+		// Fallback buffer may still hold unconsumed bytes.
+		return;
+	}
+
+	struct io_uring_sqe* sqe = as_uring_get_sqe(conn->event_loop);
+
+	if (conn->starved) {
+		// Buffer ring is exhausted. Receive into connection owned buffer.
+		if (! conn->fallback) {
+			conn->fallback = cf_malloc(AS_URING_FALLBACK_SIZE);
+		}
+
+		io_uring_prep_recv(sqe, conn->socket.fd, conn->fallback, AS_URING_FALLBACK_SIZE, 0);
+		io_uring_sqe_set_data64(sqe, as_uring_data(conn, AS_URING_OP_RECV_FALLBACK));
+		conn->recv_state = AS_URING_RECV_FALLBACK;
+	}
+	else {
+		// Multishot receive remains armed for the life of the connection and selects
+		// buffers from the event loop's registered buffer ring.
+		io_uring_prep_recv_multishot(sqe, conn->socket.fd, NULL, 0, 0);
+		sqe->flags |= IOSQE_BUFFER_SELECT;
+		sqe->buf_group = AS_URING_BUF_GROUP;
+		io_uring_sqe_set_data64(sqe, as_uring_data(conn, AS_URING_OP_RECV));
+		conn->recv_state = AS_URING_RECV_MULTISHOT;
+	}
+	conn->inflight++;
+}
+
+static void
+as_uring_send(as_event_command* cmd, uint8_t* buf)
+{
+	as_event_connection* conn = cmd->conn;
+	struct io_uring_sqe* sqe = as_uring_get_sqe(cmd->event_loop);
+	uint32_t size = cmd->len - cmd->pos;
+
+	if (size > AS_URING_SEND_MAX) {
+		size = AS_URING_SEND_MAX;
+	}
+
+	// Copy to connection owned buffer because the command may be released (timeout)
+	// while the send is still pending in the kernel.
+	if (size > conn->send_capacity) {
+		cf_free(conn->send_buf);
+		conn->send_capacity = (size < AS_URING_SEND_MIN)? AS_URING_SEND_MIN : size;
+		conn->send_buf = cf_malloc(conn->send_capacity);
+	}
+	memcpy(conn->send_buf, buf + cmd->pos, size);
+
+	io_uring_prep_send(sqe, conn->socket.fd, conn->send_buf, size, MSG_NOSIGNAL);
+	io_uring_sqe_set_data64(sqe, as_uring_data(conn, AS_URING_OP_SEND));
+	conn->send_pending = true;
+	conn->inflight++;
+}
+
+static void
+as_uring_poll(as_event_connection* conn)
+{
+	// Poll is used for TLS sockets, which must be read/written by the TLS library.
+	if (conn->closed || conn->watching == 0) {
+		return;
+	}
+
+	uint32_t mask = 0;
+
+	if (conn->watching & AS_URING_WATCH_READ) {
+		mask |= POLLIN;
+	}
+
+	if (conn->watching & AS_URING_WATCH_WRITE) {
+		mask |= POLLOUT;
+	}
+
+	if (conn->poll_pending && conn->poll_mask == mask) {
+		return;
+	}
+
+	struct io_uring_sqe* sqe = as_uring_get_sqe(conn->event_loop);
+	uint64_t data = as_uring_data(conn, AS_URING_OP_POLL);
+
+	if (conn->poll_pending) {
+		io_uring_prep_poll_update(sqe, data, data, mask, IORING_POLL_UPDATE_EVENTS);
+		io_uring_sqe_set_data64(sqe, AS_URING_OP_NONE);
+	}
+	else {
+		io_uring_prep_poll_add(sqe, conn->socket.fd, mask);
+		io_uring_sqe_set_data64(sqe, data);
+		conn->poll_pending = true;
+		conn->inflight++;
+	}
+	conn->poll_mask = mask;
+}
+
+static void
+as_uring_conn_init(as_event_loop* event_loop, as_event_connection* conn, as_socket* sock)
+{
+	memcpy(&conn->socket, sock, sizeof(as_socket));
+	conn->event_loop = event_loop;
+	conn->chunks = NULL;
+	conn->chunk_head = 0;
+	conn->chunk_size = 0;
+	conn->chunk_capacity = 0;
+	conn->inflight = 0;
+	conn->fallback = NULL;
+	conn->send_buf = NULL;
+	conn->send_capacity = 0;
+	conn->poll_mask = 0;
+	conn->rx_error = 0;
+	conn->tx_error = 0;
+	conn->recv_state = AS_URING_RECV_NONE;
+	conn->send_pending = false;
+	conn->poll_pending = false;
+	conn->starved = false;
+	conn->closed = false;
+}
+
+static void
+as_uring_conn_free(as_event_connection* conn)
+{
+	cf_free(conn->chunks);
+	cf_free(conn->fallback);
+	cf_free(conn->send_buf);
+	cf_free(conn);
+}
+
+static void
+as_uring_conn_close(as_event_connection* conn)
+{
+	conn->closed = true;
+	conn->watching = 0;
+
+	// Return staged receive buffers to the buffer ring.
+	while (conn->chunk_size > 0) {
+		as_uring_chunk_pop(conn);
+	}
+
+	if (conn->recv_state == AS_URING_RECV_MULTISHOT) {
+		as_uring_cancel(conn, AS_URING_OP_RECV);
+	}
+	else if (conn->recv_state == AS_URING_RECV_FALLBACK) {
+		as_uring_cancel(conn, AS_URING_OP_RECV_FALLBACK);
+	}
+
+	if (conn->send_pending) {
+		as_uring_cancel(conn, AS_URING_OP_SEND);
+	}
+
+	if (conn->poll_pending) {
+		as_uring_cancel(conn, AS_URING_OP_POLL);
+	}
+
+	// Pending operations hold their own file reference, so the socket can be closed now.
+	as_socket_close(&conn->socket);
+
+	// Otherwise, connection memory is released when the last pending operation completes.
+	if (conn->inflight == 0) {
+		as_uring_conn_free(conn);
+	}
+}
+
+static void
+as_uring_close_cb(as_event_loop* event_loop, void* udata)
+{
+	as_uring_conn_close(udata);
+}
+
+void
+as_event_close_connection(as_event_connection* conn)
+{
+	as_event_loop* event_loop = conn->event_loop;
+
+	if (! event_loop || as_load_uint8_acq((uint8_t*)&event_loop->closed)) {
+		// Connection was never registered or event loop ring has been destroyed.
+		// No completions can reference this connection.
+		as_socket_close(&conn->socket);
+		as_uring_conn_free(conn);
+		return;
+	}
+
+	if (pthread_equal(event_loop->thread, pthread_self())) {
+		as_uring_conn_close(conn);
+		return;
+	}
+
+	// Connections can be closed from other threads (node destroy). The ring must only
+	// be accessed from the event loop thread, so close the connection there.
+	if (! as_event_execute(event_loop, as_uring_close_cb, conn)) {
+		as_log_warn("Failed to queue async connection close");
+		as_socket_close(&conn->socket);
+	}
+}
+
+void
+as_uring_stop_watcher(as_event_connection* conn)
+{
+	conn->watching = 0;
+
+	if (conn->poll_pending) {
+		as_uring_cancel(conn, AS_URING_OP_POLL);
+	}
+}
+
+int
+as_uring_conn_validate(as_event_connection* conn)
+{
+	if (conn->rx_error) {
+		return -1;
+	}
+
+	uint32_t staged = as_uring_staged(conn);
+
+	if (staged > 0) {
+		return (int)staged;
+	}
+
+	if (! conn->socket.ctx && conn->recv_state == AS_URING_RECV_MULTISHOT) {
+		// Armed receive would have reported any pending bytes or socket close.
+		return 0;
+	}
+	return as_socket_validate_fd(conn->socket.fd);
+}
+
+//---------------------------------
+// Event Loop
+//---------------------------------
+
+static void
+as_uring_wakeup_start(as_event_loop* event_loop)
+{
+	struct io_uring_sqe* sqe = as_uring_get_sqe(event_loop);
+	io_uring_prep_read(sqe, event_loop->wakeup_fd, &event_loop->wakeup_value, sizeof(uint64_t), 0);
+	io_uring_sqe_set_data64(sqe, as_uring_data(event_loop, AS_URING_OP_WAKEUP));
+}
+
+static void
+as_uring_wakeup(as_event_loop* event_loop, int32_t res)
+{
+	if (res < 0 && res != -EINTR) {
+		as_log_error("Event loop wakeup read failed: %d", res);
+	}
+
+	// Re-arm before processing so wakeups sent while processing are not lost.
+	as_uring_wakeup_start(event_loop);
+
+	if (! as_event_queue_run(event_loop)) {
+		// Received stop signal.
+		as_event_close_loop(event_loop);
+	}
+}
+
+static void as_uring_conn_event(as_event_connection* conn, uint8_t op, int32_t res, uint32_t flags);
+
+static void
+as_uring_process_completions(as_event_loop* event_loop)
+{
+	struct io_uring* ring = event_loop->loop;
+	struct io_uring_cqe* cqe;
+
+	while (! event_loop->closing) {
+		uint64_t data;
+		int32_t res;
+		uint32_t flags;
+
+		if (event_loop->backlog_head < event_loop->backlog_size) {
+			// Completions reaped while the submission queue was full arrived first.
+			struct io_uring_cqe* e = &event_loop->backlog[event_loop->backlog_head++];
+			data = e->user_data;
+			res = e->res;
+			flags = e->flags;
+
+			if (event_loop->backlog_head == event_loop->backlog_size) {
+				event_loop->backlog_head = 0;
+				event_loop->backlog_size = 0;
+			}
+		}
+		else if (io_uring_peek_cqe(ring, &cqe) == 0) {
+			// Copy and release entry before dispatch, because dispatch can submit operations
+			// that complete inline.
+			data = cqe->user_data;
+			res = cqe->res;
+			flags = cqe->flags;
+			io_uring_cqe_seen(ring, cqe);
+		}
+		else {
+			break;
+		}
+
+		uint8_t op = (uint8_t)(data & AS_URING_OP_MASK);
+		void* ptr = (void*)(uintptr_t)(data & ~(uint64_t)AS_URING_OP_MASK);
+
+		switch (op) {
+			case AS_URING_OP_NONE:
+				// Cancel and poll update results are not needed.
+				break;
+
+			case AS_URING_OP_WAKEUP:
+				as_uring_wakeup(event_loop, res);
+				break;
+
+			default:
+				as_uring_conn_event(ptr, op, res, flags);
+				break;
+		}
+	}
+}
+
+static void
+as_uring_loop_destroy(as_event_loop* event_loop)
+{
+	// io_uring_queue_exit() cancels all pending operations. Connections closed after this
+	// point are released directly.
+	as_store_uint8_rls((uint8_t*)&event_loop->closed, 1);
+
+	struct io_uring* ring = event_loop->loop;
+	io_uring_free_buf_ring(ring, event_loop->buf_ring, AS_URING_BUF_COUNT, AS_URING_BUF_GROUP);
+	io_uring_queue_exit(ring);
+	cf_free(ring);
+	cf_free(event_loop->bufs);
+	cf_free(event_loop->timers);
+	cf_free(event_loop->backlog);
+	close(event_loop->wakeup_fd);
+
+	// Cleanup event loop resources.
+	as_event_loop_destroy(event_loop);
+}
+
+static void*
+as_uring_worker(void* udata)
+{
+	as_event_loop* event_loop = udata;
+
+	as_thread_set_name_index("uring", event_loop->index);
+	as_event_thread_assign_cpu(event_loop);
+
+	while (! event_loop->closing) {
+		// Operations queued while processing the previous iteration are submitted
+		// in the same system call that waits for the next completions.
+		struct __kernel_timespec ts;
+		struct __kernel_timespec* tsp = as_uring_timer_wait(event_loop, &ts);
+		struct io_uring_cqe* cqe;
+		int rv;
+
+		if (event_loop->backlog_size > 0) {
+			// Reaped completions are waiting in the backlog. Do not block.
+			rv = io_uring_submit(event_loop->loop);
+		}
+		else {
+			rv = io_uring_submit_and_wait_timeout(event_loop->loop, &cqe, 1, tsp, NULL);
+		}
+
+		if (rv < 0 && rv != -ETIME && rv != -EINTR && rv != -EBUSY) {
+			as_log_error("io_uring wait failed: %d", rv);
+		}
+
+		as_uring_process_completions(event_loop);
+		as_uring_process_timers(event_loop);
+		event_loop->iterations++;
+	}
+
+	as_uring_loop_destroy(event_loop);
+	as_tls_thread_cleanup();
+	return NULL;
+}
+
+static bool
+as_uring_init_loop(as_event_loop* event_loop)
+{
+	struct io_uring* ring = cf_malloc(sizeof(struct io_uring));
+	struct io_uring_params params;
+
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_COOP_TASKRUN;
+
+	int rv = io_uring_queue_init_params(AS_URING_QUEUE_SIZE, ring, &params);
+
+	if (rv == -EINVAL) {
+		// Kernel does not support cooperative task running.
+		memset(&params, 0, sizeof(params));
+		rv = io_uring_queue_init_params(AS_URING_QUEUE_SIZE, ring, &params);
+	}
+
+	if (rv < 0) {
+		as_log_error("io_uring_queue_init failed: %d", rv);
+		cf_free(ring);
+		return false;
+	}
+
+	// Register provided buffer ring used by multishot receives.
+	event_loop->buf_ring = io_uring_setup_buf_ring(ring, AS_URING_BUF_COUNT, AS_URING_BUF_GROUP,
+		0, &rv);
+
+	if (! event_loop->buf_ring) {
+		as_log_error("io_uring_setup_buf_ring failed: %d", rv);
+		io_uring_queue_exit(ring);
+		cf_free(ring);
+		return false;
+	}
+
+	event_loop->bufs = cf_malloc((size_t)AS_URING_BUF_COUNT * AS_URING_BUF_SIZE);
+
+	int mask = io_uring_buf_ring_mask(AS_URING_BUF_COUNT);
+
+	for (int i = 0; i < AS_URING_BUF_COUNT; i++) {
+		io_uring_buf_ring_add(event_loop->buf_ring, event_loop->bufs + ((size_t)i * AS_URING_BUF_SIZE),
+			AS_URING_BUF_SIZE, (unsigned short)i, mask, i);
+	}
+	io_uring_buf_ring_advance(event_loop->buf_ring, AS_URING_BUF_COUNT);
+
+	event_loop->wakeup_fd = eventfd(0, EFD_CLOEXEC);
+
+	if (event_loop->wakeup_fd < 0) {
+		as_log_error("eventfd failed: %d", errno);
+		io_uring_free_buf_ring(ring, event_loop->buf_ring, AS_URING_BUF_COUNT, AS_URING_BUF_GROUP);
+		io_uring_queue_exit(ring);
+		cf_free(ring);
+		cf_free(event_loop->bufs);
+		return false;
+	}
+
+	event_loop->loop = ring;
+	event_loop->timers = NULL;
+	event_loop->timers_size = 0;
+	event_loop->timers_capacity = 0;
+	event_loop->timers_pass = 0;
+	event_loop->backlog = NULL;
+	event_loop->backlog_head = 0;
+	event_loop->backlog_size = 0;
+	event_loop->backlog_capacity = 0;
+	event_loop->closing = false;
+	event_loop->closed = false;
+	as_uring_wakeup_start(event_loop);
+	return true;
+}
+
+bool
+as_event_create_loop(as_event_loop* event_loop)
+{
+	if (! as_uring_init_loop(event_loop)) {
+		return false;
+	}
+	return as_event_thread_create(event_loop, as_uring_worker, event_loop);
+}
+
+void
+as_event_register_external_loop(as_event_loop* event_loop)
+{
+	// The ring and its completions are owned by the worker thread created in
+	// as_event_create_loop(). External rings can not be driven by the client.
+	as_log_error("External event loops are not supported with liburing");
+}
+
+uint64_t
+as_event_loop_iterations(as_event_loop* event_loop)
+{
+	return event_loop->iterations;
+}
+
+bool
+as_event_execute(as_event_loop* event_loop, as_event_executable executable, void* udata)
+{
+	// Send command through queue so it can be executed in event loop thread.
+	bool wakeup;
+	bool queued = as_event_queue_push(event_loop, executable, udata, &wakeup);
+
+	if (wakeup) {
+		uint64_t value = 1;
+
+		if (write(event_loop->wakeup_fd, &value, sizeof(value)) < 0) {
+			as_log_error("Event loop wakeup write failed: %d", errno);
+		}
+	}
+	return queued;
+}
+
+//---------------------------------
+// Command State Machine
+//---------------------------------
+
+static inline void
+as_uring_watch(as_event_connection* conn, int watch)
+{
+	conn->watching = watch;
+
+	if (conn->socket.ctx) {
+		as_uring_poll(conn);
+	}
+	else if (watch & AS_URING_WATCH_READ) {
+		// Make sure a receive is armed. Usually the multishot receive is already armed.
+		as_uring_recv(conn);
+	}
+}
+
+static inline void
+as_uring_watch_write(as_event_command* cmd)
+{
+	int watch = cmd->pipe_listener != NULL ?
+		AS_URING_WATCH_WRITE | AS_URING_WATCH_READ : AS_URING_WATCH_WRITE;
+	as_uring_watch(cmd->conn, watch);
+}
+
+static inline void
+as_uring_watch_read(as_event_command* cmd)
+{
+	as_uring_watch(cmd->conn, AS_URING_WATCH_READ);
+}
+
+#define AS_EVENT_WRITE_COMPLETE 0
+#define AS_EVENT_WRITE_INCOMPLETE 1
+#define AS_EVENT_WRITE_ERROR 2
+
+#define AS_EVENT_READ_COMPLETE 3
+#define AS_EVENT_READ_INCOMPLETE 4
+#define AS_EVENT_READ_ERROR 5
+
+#define AS_EVENT_TLS_NEED_READ 6
+#define AS_EVENT_TLS_NEED_WRITE 7
+
+#define AS_EVENT_COMMAND_DONE 8
+
+static int
+as_uring_write(as_event_command* cmd)
+{
+	uint8_t* buf = (uint8_t*)cmd + cmd->write_offset;
+	as_event_connection* conn = cmd->conn;
+	int fd = conn->socket.fd;
+
+	if (conn->socket.ctx) {
+		do {
+			int rv = as_tls_write_once(&conn->socket, buf + cmd->pos, cmd->len - cmd->pos);
+			if (rv > 0) {
+				as_uring_watch_write(cmd);
+				cmd->pos += rv;
+				cmd->bytes_out += rv;
+				continue;
+			}
+			else if (rv == -1) {
+				// TLS sometimes need to read even when we are writing.
+				as_uring_watch_read(cmd);
+				return AS_EVENT_TLS_NEED_READ;
+			}
+			else if (rv == -2) {
+				// TLS wants a write, we're all set for that.
+				as_uring_watch_write(cmd);
+				return AS_EVENT_WRITE_INCOMPLETE;
+			}
+			else if (rv < -2) {
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_TLS_ERROR, "TLS write failed", rv);
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_WRITE_ERROR;
+			}
+			// as_tls_write_once can't return 0
+		} while (cmd->pos < cmd->len);
+	}
+	else {
+		if (conn->tx_error) {
+			int32_t e = conn->tx_error;
+
+			if (! as_event_socket_retry(cmd)) {
+				as_error err;
+
+				if (e == AS_URING_EOF) {
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket write closed by peer", 0);
+				}
+				else {
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket write failed", -e);
+				}
+				as_event_socket_error(cmd, &err);
+			}
+			return AS_EVENT_WRITE_ERROR;
+		}
+
+		if (conn->send_pending) {
+			return AS_EVENT_WRITE_INCOMPLETE;
+		}
+
+		if (cmd->pos < cmd->len) {
+			// Send completion continues the write state machine.
+			as_uring_send(cmd, buf);
+			return AS_EVENT_WRITE_INCOMPLETE;
+		}
+	}
+
+	// Socket timeout applies only to read events.
+	// Reset event received because we are switching from a write to a read state.
+	// This handles case where write succeeds and read event does not occur.  If we didn't reset,
+	// the socket timeout would go through two iterations (double the timeout) because a write
+	// event occurred in the first timeout period.
+	cmd->flags &= ~AS_ASYNC_FLAGS_EVENT_RECEIVED;
+	return AS_EVENT_WRITE_COMPLETE;
+}
+
+static int
+as_uring_read(as_event_command* cmd)
+{
+	cmd->flags |= AS_ASYNC_FLAGS_EVENT_RECEIVED;
+
+	as_event_connection* conn = cmd->conn;
+	int fd = conn->socket.fd;
+
+	if (conn->socket.ctx) {
+		do {
+			int rv = as_tls_read_once(&conn->socket, cmd->buf + cmd->pos, cmd->len - cmd->pos);
+			if (rv > 0) {
+				as_uring_watch_read(cmd);
+				cmd->pos += rv;
+				cmd->bytes_in += rv;
+				continue;
+			}
+			else if (rv == -1) {
+				// TLS wants a read
+				as_uring_watch_read(cmd);
+				return AS_EVENT_READ_INCOMPLETE;
+			}
+			else if (rv == -2) {
+				// TLS sometimes needs to write, even when the app is reading.
+				as_uring_watch_write(cmd);
+				return AS_EVENT_TLS_NEED_WRITE;
+			}
+			else if (rv < -2) {
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+					as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_TLS_ERROR, "TLS read failed", rv);
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_READ_ERROR;
+			}
+			// as_tls_read_once doesn't return 0
+		} while (cmd->pos < cmd->len);
+	}
+	else {
+		while (cmd->pos < cmd->len) {
+			// Copy bytes already received by multishot receive.
+			uint32_t n = as_uring_consume(conn, cmd->buf + cmd->pos, cmd->len - cmd->pos);
+
+			if (n > 0) {
+				cmd->pos += n;
+				cmd->bytes_in += n;
+				continue;
+			}
+
+			if (conn->rx_error) {
+				int32_t e = conn->rx_error;
+
+				if (! as_event_socket_retry(cmd)) {
+					as_error err;
+
+					if (e == AS_URING_EOF) {
+						as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket read closed by peer", 0);
+					}
+					else {
+						as_socket_error(fd, cmd->node, &err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Socket read failed", -e);
+					}
+					as_event_socket_error(cmd, &err);
+				}
+				return AS_EVENT_READ_ERROR;
+			}
+
+			// Wait for next receive completion.
+			as_uring_recv(conn);
+			return AS_EVENT_READ_INCOMPLETE;
+		}
+	}
+
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static inline void
+as_uring_command_read_start(as_event_command* cmd)
+{
+	cmd->command_sent_counter++;
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	as_uring_watch_read(cmd);
+
+	if (cmd->pipe_listener != NULL) {
+		as_pipe_read_start(cmd);
+	}
+}
+
+static inline void
+as_uring_command_write(as_event_command* cmd)
+{
+	as_uring_watch_write(cmd);
+
+	if (as_uring_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
+		// Done with write. Register for read.
+		as_uring_command_read_start(cmd);
+	}
+}
+
+void
+as_event_command_resume_read(as_event_command* cmd)
+{
+	// Flow control does not pause io_uring commands because multishot receives keep
+	// staging data while the poll watcher is stopped.
+	as_uring_watch_read(cmd);
+}
+
+void
+as_event_command_write_start(as_event_command* cmd)
+{
+	as_event_command_trace(cmd, AS_TRACE_WRITE, AEROSPIKE_OK);
+	cmd->state = AS_ASYNC_STATE_COMMAND_WRITE;
+	as_event_set_write(cmd);
+	as_uring_command_write(cmd);
+}
+
+static int
+as_uring_command_start(as_event_command* cmd)
+{
+	as_event_connection_complete(cmd);
+
+	if (cmd->type == AS_ASYNC_TYPE_CONNECTOR) {
+		as_event_connector_success(cmd);
+		return AS_EVENT_COMMAND_DONE;
+	}
+	else {
+		as_event_command_write_start(cmd);
+		return AS_EVENT_READ_COMPLETE;
+	}
+}
+
+static inline void
+as_uring_command_auth_write(as_event_command* cmd)
+{
+	as_uring_watch_write(cmd);
+
+	if (as_uring_write(cmd) == AS_EVENT_WRITE_COMPLETE) {
+		// Done with auth write. Register for auth read.
+		as_event_set_auth_read_header(cmd);
+		as_uring_watch_read(cmd);
+	}
+}
+
+static void
+as_uring_connect_complete(as_event_command* cmd)
+{
+	if (cmd->cluster->auth_enabled) {
+		as_session* session = as_session_load(&cmd->node->session);
+
+		if (session) {
+			as_incr_uint32(&session->ref_count);
+			as_event_set_auth_write(cmd, session);
+			as_session_release(session);
+
+			cmd->state = AS_ASYNC_STATE_AUTH_WRITE;
+			as_uring_command_auth_write(cmd);
+		}
+		else {
+			as_uring_command_start(cmd);
+		}
+	}
+	else {
+		as_uring_command_start(cmd);
+	}
+}
+
+static int
+as_uring_command_peek_block(as_event_command* cmd)
+{
+	// Batch, scan, query may be waiting on end block.
+	// Prepare for next message block.
+	cmd->len = sizeof(as_proto);
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+	int rv = as_uring_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+
+	as_proto* proto = (as_proto*)cmd->buf;
+
+	if (! as_event_proto_parse(cmd, proto)) {
+		return AS_EVENT_READ_ERROR;
+	}
+
+	size_t size = proto->sz;
+
+	cmd->len = (uint32_t)size;
+	cmd->pos = 0;
+	cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+	// Check for end block size.
+	if (cmd->len == sizeof(as_msg) && ! as_proto_is_compressed(cmd->proto_type_rcv)) {
+		// Look like we received end block.  Read and parse to make sure.
+		rv = as_uring_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+		cmd->pos = 0;
+
+		if (! cmd->parse_results(cmd)) {
+			// We did not finish after all. Prepare to read next header.
+			cmd->len = sizeof(as_proto);
+			cmd->pos = 0;
+			cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+		}
+		else {
+			return AS_EVENT_COMMAND_DONE;
+		}
+	}
+	else {
+		// Received normal data block.  Stop reading for fairness reasons and wait
+		// till next iteration.
+		as_event_command_reserve_read(cmd);
+	}
+
+	return AS_EVENT_READ_COMPLETE;
+}
+
+static int
+as_uring_parse_authentication(as_event_command* cmd)
+{
+	int rv;
+	if (cmd->state == AS_ASYNC_STATE_AUTH_READ_HEADER) {
+		// Read response length
+		rv = as_uring_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+
+		if (! as_event_set_auth_parse_header(cmd)) {
+			return AS_EVENT_READ_ERROR;
+		}
+
+		if (cmd->len > cmd->read_capacity) {
+			as_error err;
+			as_error_update(&err, AEROSPIKE_ERR_CLIENT, "Authenticate response size is corrupt: %u", cmd->len);
+			as_event_parse_error(cmd, &err);
+			return AS_EVENT_READ_ERROR;
+		}
+	}
+
+	rv = as_uring_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+
+	// Parse authentication response.
+	uint8_t code = cmd->buf[AS_ASYNC_AUTH_RETURN_CODE];
+
+	if (code && code != AEROSPIKE_SECURITY_NOT_ENABLED) {
+		// Can't authenticate socket, so must close it.
+		as_node_signal_login(cmd->node);
+		as_error err;
+		as_error_update(&err, code, "Authentication failed: %s", as_error_string(code));
+		as_event_parse_error(cmd, &err);
+		return AS_EVENT_READ_ERROR;
+	}
+
+	return as_uring_command_start(cmd);
+}
+
+static int
+as_uring_command_read(as_event_command* cmd)
+{
+	int rv;
+
+	if (cmd->state == AS_ASYNC_STATE_COMMAND_READ_HEADER) {
+		// Read response length
+		rv = as_uring_read(cmd);
+		if (rv != AS_EVENT_READ_COMPLETE) {
+			return rv;
+		}
+
+		as_proto* proto = (as_proto*)cmd->buf;
+
+		if (! as_event_proto_parse(cmd, proto)) {
+			return AS_EVENT_READ_ERROR;
+		}
+
+		size_t size = proto->sz;
+
+		cmd->len = (uint32_t)size;
+		cmd->pos = 0;
+		cmd->state = AS_ASYNC_STATE_COMMAND_READ_BODY;
+
+		as_event_command_reserve_read(cmd);
+	}
+
+	// Read response body
+	rv = as_uring_read(cmd);
+	if (rv != AS_EVENT_READ_COMPLETE) {
+		return rv;
+	}
+	cmd->pos = 0;
+
+	if (as_proto_is_compressed(cmd->proto_type_rcv)) {
+		if (! as_event_decompress(cmd)) {
+			return AS_EVENT_READ_ERROR;
+		}
+	}
+
+	if (! cmd->parse_results(cmd)) {
+		// Batch, scan, query is not finished.
+		return as_uring_command_peek_block(cmd);
+	}
+
+	return AS_EVENT_COMMAND_DONE;
+}
+
+static bool
+as_uring_tls_connect(as_event_command* cmd, as_event_connection* conn)
+{
+	int rv = as_tls_connect_once(&conn->socket);
+
+	if (rv < -2) {
+		if (! as_event_socket_retry(cmd)) {
+			// Failed, error has been logged.
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_ERR_TLS_ERROR, "TLS connection failed");
+			as_event_socket_error(cmd, &err);
+		}
+		return false;
+	}
+
+	if (rv == -1) {
+		// TLS needs a read.
+		as_uring_watch_read(cmd);
+		return true;
+	}
+
+	if (rv == -2) {
+		// TLS needs a write.
+		as_uring_watch_write(cmd);
+		return true;
+	}
+
+	if (rv == 0) {
+		if (! as_event_socket_retry(cmd)) {
+			as_error err;
+			as_error_set_message(&err, AEROSPIKE_ERR_TLS_ERROR, "TLS connection shutdown");
+			as_event_socket_error(cmd, &err);
+		}
+		return false;
+	}
+
+	// TLS connection established.
+	as_uring_connect_complete(cmd);
+	return false;
+}
+
+static void
+as_uring_callback_common(as_event_command* cmd, as_event_connection* conn)
+{
+	switch (cmd->state) {
+	case AS_ASYNC_STATE_CONNECT:
+		as_uring_connect_complete(cmd);
+		break;
+
+	case AS_ASYNC_STATE_TLS_CONNECT:
+		do {
+			if (! as_uring_tls_connect(cmd, conn)) {
+				return;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	case AS_ASYNC_STATE_AUTH_WRITE:
+		as_uring_command_auth_write(cmd);
+		break;
+
+	case AS_ASYNC_STATE_AUTH_READ_HEADER:
+	case AS_ASYNC_STATE_AUTH_READ_BODY:
+		// If we're using TLS we must loop until there are no bytes
+		// left in the encryption buffer because we won't get another
+		// poll event.
+		do {
+			switch (as_uring_parse_authentication(cmd)) {
+				case AS_EVENT_COMMAND_DONE:
+				case AS_EVENT_READ_ERROR:
+					// Do not touch cmd again because it's been deallocated.
+					return;
+
+				case AS_EVENT_READ_COMPLETE:
+					as_uring_watch_read(cmd);
+					break;
+
+				default:
+					break;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	case AS_ASYNC_STATE_COMMAND_WRITE:
+		as_uring_command_write(cmd);
+		break;
+
+	case AS_ASYNC_STATE_COMMAND_READ_HEADER:
+	case AS_ASYNC_STATE_COMMAND_READ_BODY:
+		// If we're using TLS we must loop until there are no bytes
+		// left in the encryption buffer because we won't get another
+		// poll event.
+		do {
+			switch (as_uring_command_read(cmd)) {
+			case AS_EVENT_COMMAND_DONE:
+			case AS_EVENT_READ_ERROR:
+				// Do not touch cmd again because it's been deallocated.
+				return;
+
+			case AS_EVENT_READ_COMPLETE:
+				as_uring_watch_read(cmd);
+				break;
+
+			default:
+				break;
+			}
+		} while (as_tls_read_pending(&cmd->conn->socket) > 0);
+		break;
+
+	default:
+		as_log_error("unexpected cmd state %d", cmd->state);
+		break;
+	}
+}
+
+static as_event_command*
+as_uring_read_command(as_event_connection* conn)
+{
+	if (conn->pipeline) {
+		as_pipe_connection* pipe = (as_pipe_connection*)conn;
+
+		if (pipe->writer && cf_ll_size(&pipe->readers) == 0) {
+			// Authentication response will only have a writer.
+			return pipe->writer;
+		}
+
+		// Next response is at head of reader linked list.
+		cf_ll_element* link = cf_ll_get_head(&pipe->readers);
+
+		if (! link) {
+			as_log_debug("Pipeline read event ignored");
+			return NULL;
+		}
+		return as_pipe_link_to_command(link);
+	}
+	return ((as_async_connection*)conn)->cmd;
+}
+
+static inline as_event_command*
+as_uring_write_command(as_event_connection* conn)
+{
+	return conn->pipeline ?
+		((as_pipe_connection*)conn)->writer :
+		((as_async_connection*)conn)->cmd;
+}
+
+static void
+as_uring_dispatch_read(as_event_connection* conn)
+{
+	// A single receive can contain multiple pipeline responses or message blocks,
+	// so keep dispatching while the current reader makes progress.
+	while (! conn->closed && (conn->watching & AS_URING_WATCH_READ) &&
+		   (conn->chunk_size > 0 || conn->rx_error)) {
+		uint32_t staged = as_uring_staged(conn);
+		as_event_command* cmd = as_uring_read_command(conn);
+
+		if (! cmd) {
+			return;
+		}
+
+		as_uring_callback_common(cmd, conn);
+
+		if (conn->closed || as_uring_staged(conn) == staged) {
+			return;
+		}
+	}
+}
+
+static void
+as_uring_recv_complete(as_event_connection* conn, int32_t res, uint32_t flags)
+{
+	if (! (flags & IORING_CQE_F_MORE)) {
+		// Multishot receive terminated. It's re-armed after dispatch if still valid.
+		conn->recv_state = AS_URING_RECV_NONE;
+		conn->inflight--;
+	}
+
+	if (flags & IORING_CQE_F_BUFFER) {
+		uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+
+		if (res > 0 && ! conn->closed) {
+			as_uring_chunk_push(conn, conn->event_loop->bufs + ((size_t)bid * AS_URING_BUF_SIZE),
+				(uint32_t)res, bid);
+		}
+		else {
+			as_uring_buf_return(conn->event_loop, bid);
+		}
+	}
+
+	if (conn->closed) {
+		return;
+	}
+
+	if (res == 0) {
+		conn->rx_error = AS_URING_EOF;
+	}
+	else if (res == -ENOBUFS) {
+		// Buffer ring exhausted. Next receive uses the connection fallback buffer.
+		conn->starved = true;
+	}
+	else if (res < 0 && res != -ECANCELED) {
+		conn->rx_error = res;
+	}
+
+	as_uring_dispatch_read(conn);
+}
+
+static void
+as_uring_fallback_complete(as_event_connection* conn, int32_t res)
+{
+	conn->recv_state = AS_URING_RECV_NONE;
+	conn->inflight--;
+
+	if (conn->closed) {
+		return;
+	}
+
+	if (res > 0) {
+		// Try buffer ring again on next receive.
+		conn->starved = false;
+		as_uring_chunk_push(conn, conn->fallback, (uint32_t)res, AS_URING_FALLBACK_BID);
+	}
+	else if (res == 0) {
+		conn->rx_error = AS_URING_EOF;
+	}
+	else if (res != -ECANCELED) {
+		conn->rx_error = res;
+	}
+
+	as_uring_dispatch_read(conn);
+}
+
+static void
+as_uring_send_complete(as_event_connection* conn, int32_t res)
+{
+	conn->send_pending = false;
+	conn->inflight--;
+
+	if (conn->closed || ! (conn->watching & AS_URING_WATCH_WRITE)) {
+		return;
+	}
+
+	as_event_command* cmd = as_uring_write_command(conn);
+
+	if (! cmd) {
+		return;
+	}
+
+	if (res > 0) {
+		cmd->pos += res;
+		cmd->bytes_out += res;
+	}
+	else if (res == 0) {
+		conn->tx_error = AS_URING_EOF;
+	}
+	else if (res != -ECANCELED) {
+		conn->tx_error = res;
+	}
+
+	as_uring_callback_common(cmd, conn);
+}
+
+static void
+as_uring_poll_complete(as_event_connection* conn, int32_t res)
+{
+	conn->poll_pending = false;
+	conn->inflight--;
+
+	if (conn->closed || res <= 0) {
+		// Poll was canceled or failed. Socket errors are detected on next read/write.
+		return;
+	}
+
+	if ((res & (POLLIN | POLLERR | POLLHUP)) && (conn->watching & AS_URING_WATCH_READ)) {
+		as_event_command* cmd = as_uring_read_command(conn);
+
+		if (cmd) {
+			as_uring_callback_common(cmd, conn);
+		}
+	}
+	else if ((res & (POLLOUT | POLLERR | POLLHUP)) && (conn->watching & AS_URING_WATCH_WRITE)) {
+		as_event_command* cmd = as_uring_write_command(conn);
+
+		if (cmd) {
+			as_uring_callback_common(cmd, conn);
+		}
+	}
+}
+
+static void
+as_uring_conn_event(as_event_connection* conn, uint8_t op, int32_t res, uint32_t flags)
+{
+	// Keep connection memory valid while the completion is dispatched, because
+	// the connection can be closed by the command state machine.
+	conn->inflight++;
+
+	switch (op) {
+		case AS_URING_OP_RECV:
+			as_uring_recv_complete(conn, res, flags);
+			break;
+
+		case AS_URING_OP_RECV_FALLBACK:
+			as_uring_fallback_complete(conn, res);
+			break;
+
+		case AS_URING_OP_SEND:
+			as_uring_send_complete(conn, res);
+			break;
+
+		case AS_URING_OP_POLL:
+			as_uring_poll_complete(conn, res);
+			break;
+
+		default:
+			as_log_error("Unknown io_uring operation: %u", op);
+			break;
+	}
+
+	conn->inflight--;
+
+	if (conn->closed) {
+		if (conn->inflight == 0) {
+			as_uring_conn_free(conn);
+		}
+		return;
+	}
+
+	// Re-arm connection operations.
+	if (conn->socket.ctx) {
+		as_uring_poll(conn);
+	}
+	else if (! conn->starved || (conn->watching & AS_URING_WATCH_READ)) {
+		as_uring_recv(conn);
+	}
+}
+
+//---------------------------------
+// Connect
+//---------------------------------
+
+static void
+as_uring_watcher_init(as_event_command* cmd, as_socket* sock)
+{
+	as_event_connection* conn = cmd->conn;
+	as_uring_conn_init(cmd->event_loop, conn, sock);
+
+	// Change state if using TLS.
+	if (as_socket_use_tls(cmd->cluster->tls_ctx)) {
+		cmd->state = AS_ASYNC_STATE_TLS_CONNECT;
+	}
+
+	int watch = cmd->pipe_listener != NULL ?
+		AS_URING_WATCH_WRITE | AS_URING_WATCH_READ : AS_URING_WATCH_WRITE;
+	conn->watching = watch;
+
+	if (conn->socket.ctx) {
+		as_uring_poll(conn);
+		return;
+	}
+
+	// Wait for non-blocking connect to complete.
+	struct io_uring_sqe* sqe = as_uring_get_sqe(cmd->event_loop);
+	io_uring_prep_poll_add(sqe, conn->socket.fd, POLLOUT);
+	io_uring_sqe_set_data64(sqe, as_uring_data(conn, AS_URING_OP_POLL));
+	conn->poll_pending = true;
+	conn->poll_mask = POLLOUT;
+	conn->inflight++;
+
+	// Arm multishot receive for the life of the connection.
+	as_uring_recv(conn);
+}
+
+static int
+as_uring_try_connections(int fd, as_address* addresses, socklen_t size, int i, int max)
+{
+	while (i < max) {
+		if (as_socket_connect_fd(fd, (struct sockaddr*)&addresses[i].addr, size)) {
+			return i;
+		}
+		i++;
+	}
+	return -1;
+}
+
+static int
+as_uring_try_family_connections(as_event_command* cmd, int family, int begin, int end, int index, as_address* primary, as_socket* sock)
+{
+	// Create a non-blocking socket.
+	as_socket_fd fd;
+	int rv = as_socket_create_fd(family, &fd);
+
+	if (rv < 0) {
+		return rv;
+	}
+
+	rv = as_socket_set_options(fd, &cmd->cluster->socket_options);
+
+	if (rv < 0) {
+		as_close(fd);
+		return rv;
+	}
+
+	if (cmd->pipe_listener && ! as_pipe_modify_fd(fd)) {
+		return -1000;
+	}
+
+	as_tls_context* ctx = as_socket_get_tls_context(cmd->cluster->tls_ctx);
+
+	if (! as_socket_wrap(sock, family, fd, ctx, cmd->node->tls_name)) {
+		return -1001;
+	}
+
+	if (ctx) {
+		as_tls_session_resume(ctx, sock->ssl, cmd->node->name, cmd->node->tls_name);
+	}
+
+	// Try addresses.
+	as_address* addresses = cmd->node->addresses;
+	socklen_t size = (family == AF_INET)? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+
+	if (index >= 0) {
+		// Try primary address.
+		if (as_socket_connect_fd(fd, (struct sockaddr*)&primary->addr, size)) {
+			return index;
+		}
+
+		// Start from current index + 1 to end.
+		rv = as_uring_try_connections(fd, addresses, size, index + 1, end);
+
+		if (rv < 0) {
+			// Start from begin to index.
+			rv = as_uring_try_connections(fd, addresses, size, begin, index);
+		}
+	}
+	else {
+		rv = as_uring_try_connections(fd, addresses, size, begin, end);
+	}
+
+	if (rv < 0) {
+		// Couldn't start a connection on any socket address - close the socket.
+		as_socket_close(sock);
+		return -1002;
+	}
+	return rv;
+}
+
+static void
+as_uring_connect_error(as_event_command* cmd, as_address* primary, int rv)
+{
+	// Socket has already been closed. Release connection.
+	cf_free(cmd->conn);
+	as_event_decr_conn(cmd);
+	cmd->event_loop->errors++;
+
+	if (as_event_command_retry(cmd, false)) {
+		return;
+	}
+
+	as_error err;
+	as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "Connect failed: %d %s %s", rv, cmd->node->name, primary->name);
+
+	// Only timer needs to be released on socket connection failure.
+	// Operations have not been submitted yet.
+	as_event_timer_stop(cmd);
+	as_event_error_callback(cmd, &err);
+}
+
+void
+as_event_connect(as_event_command* cmd, as_async_conn_pool* pool)
+{
+	// Try addresses.
+	as_socket sock;
+	as_node* node = cmd->node;
+	uint32_t index = node->address_index;
+	as_address* primary = &node->addresses[index];
+	int rv;
+	int first_rv;
+
+	if (primary->addr.ss_family == AF_INET) {
+		// Try IPv4 addresses first.
+		rv = as_uring_try_family_connections(cmd, AF_INET, 0, node->address4_size, index, primary, &sock);
+
+		if (rv < 0) {
+			// Try IPv6 addresses.
+			first_rv = rv;
+			rv = as_uring_try_family_connections(cmd, AF_INET6, AS_ADDRESS4_MAX, AS_ADDRESS4_MAX + node->address6_size, -1, NULL, &sock);
+		}
+	}
+	else {
+		// Try IPv6 addresses first.
+		rv = as_uring_try_family_connections(cmd, AF_INET6, AS_ADDRESS4_MAX, AS_ADDRESS4_MAX + node->address6_size, index, primary, &sock);
+
+		if (rv < 0) {
+			// Try IPv4 addresses.
+			first_rv = rv;
+			rv = as_uring_try_family_connections(cmd, AF_INET, 0, node->address4_size, -1, NULL, &sock);
+		}
+	}
+
+	if (rv < 0) {
+		as_uring_connect_error(cmd, primary, first_rv);
+		return;
+	}
+
+	if (rv != index) {
+		// Replace invalid primary address with valid alias.
+		// Other threads may not see this change immediately.
+		// It's just a hint, not a requirement to try this new address first.
+		as_store_uint32(&node->address_index, rv);
+		as_log_debug("Change node address %s %s", node->name, as_node_get_address_string(node));
+	}
+
+	pool->opened++;
+	as_uring_watcher_init(cmd, &sock);
+	cmd->event_loop->errors = 0; // Reset errors on valid connection.
+}
+
+static void
+as_uring_close_connections(as_node* node, as_async_conn_pool* pool)
+{
+	as_event_connection* conn;
+
+	while (as_queue_pop(&pool->queue, &conn)) {
+		as_event_release_connection(conn, pool);
+	}
+	as_queue_destroy(&pool->queue);
+}
+
+void
+as_event_node_destroy(as_node* node)
+{
+	// Close connections.
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		as_uring_close_connections(node, &node->async_conn_pools[i]);
+		as_uring_close_connections(node, &node->pipe_conn_pools[i]);
+	}
+	cf_free(node->async_conn_pools);
+	cf_free(node->pipe_conn_pools);
+}
+
+#endif
@@ -23,11 +23,10 @@
 #include <aerospike/as_socket.h>
 #include <aerospike/as_thread.h>
 #include <aerospike/as_tls.h>
+#include <aerospike/as_tls_bio.h>
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <errno.h>
-#include <openssl/bio.h>
-#include <openssl/err.h>
 #include <openssl/ssl.h>
 
 //---------------------------------
@@ -50,14 +49,8 @@ static void as_uv_tls_command_write_start(as_event_command* cmd);
 typedef void (*as_uv_tls_fn) (as_event_command* cmd);
 
 typedef struct as_uv_tls {
-	as_tls_context* ctx;
-	struct ssl_st* ssl;
-	struct bio_st* ibio;  // internal bio.
-	struct bio_st* nbio;  // network bio.
+	as_tls_bio bio;
 	as_uv_tls_fn callback;
-	char* buf;
-	int capacity;
-	int len;
 	int error;
 } as_uv_tls;
 
@@ -66,14 +59,8 @@ typedef struct {
 	as_monitor monitor;
 } as_uv_thread_data;
 
-void
-as_uv_timer_closed(uv_handle_t* handle)
-{
-	as_event_command_free(handle->data);
-}
-
 static void
-as_uv_wakeup_closed(uv_handle_t* handle)
+as_uv_handle_closed(uv_handle_t* handle)
 {
 	cf_free(handle);
 }
@@ -87,9 +74,7 @@ as_uv_connection_closed(uv_handle_t* socket)
 
 	if (conn->tls) {
 		as_uv_tls* tls = conn->tls;
-		SSL_free(tls->ssl);
-		BIO_free(tls->nbio);
-		cf_free(tls->buf);
+		as_tls_bio_destroy(&tls->bio);
 		cf_free(tls);
 	}
 	cf_free(conn);
@@ -98,7 +83,8 @@ as_uv_connection_closed(uv_handle_t* socket)
 void
 as_event_close_loop(as_event_loop* event_loop)
 {
-	uv_close((uv_handle_t*)event_loop->wakeup, as_uv_wakeup_closed);
+	uv_close((uv_handle_t*)event_loop->wakeup, as_uv_handle_closed);
+	uv_close((uv_handle_t*)event_loop->tick, as_uv_handle_closed);
 	
 	// Only stop event loop if client created event loop.
 	if (as_event_threads_created) {
@@ -112,35 +98,11 @@ as_event_close_loop(as_event_loop* event_loop)
 static void
 as_uv_wakeup(uv_async_t* wakeup)
 {
-	// Read command pointers from queue.
 	as_event_loop* event_loop = wakeup->data;
-	as_event_commander cmd;
-	uint32_t i = 0;
-
-	// Only process original size of queue.  Recursive pre-registration errors can
-	// result in new commands being added while the loop is in process.  If we process
-	// them, we could end up in an infinite loop.
-	pthread_mutex_lock(&event_loop->lock);
-	uint32_t size = as_queue_size(&event_loop->queue);
-	bool status = as_queue_pop(&event_loop->queue, &cmd);
-	pthread_mutex_unlock(&event_loop->lock);
-
-	while (status) {
-		if (! cmd.executable) {
-			// Received stop signal.
-			as_event_close_loop(event_loop);
-			return;
-		}
-		cmd.executable(event_loop, cmd.udata);
 
-		if (++i < size) {
-			pthread_mutex_lock(&event_loop->lock);
-			status = as_queue_pop(&event_loop->queue, &cmd);
-			pthread_mutex_unlock(&event_loop->lock);
-		}
-		else {
-			break;
-		}
+	if (! as_event_queue_run(event_loop)) {
+		// Received stop signal.
+		as_event_close_loop(event_loop);
 	}
 }
 
@@ -168,6 +130,7 @@ as_uv_worker(void* udata)
 	as_event_loop* event_loop = data->event_loop;
 
 	as_thread_set_name_index("uv", event_loop->index);
+	as_event_thread_assign_cpu(event_loop);
 	
 	event_loop->loop = cf_malloc(sizeof(uv_loop_t));
 	
@@ -187,6 +150,11 @@ as_uv_worker(void* udata)
 
 	uv_loop_init(event_loop->loop);
 	uv_async_init(event_loop->loop, event_loop->wakeup, as_uv_wakeup);
+
+	// Single timer that drives all command timers of this event loop.
+	event_loop->tick = cf_malloc(sizeof(uv_timer_t));
+	event_loop->tick->data = event_loop;
+	uv_timer_init(event_loop->loop, event_loop->tick);
 	as_monitor_notify(&data->monitor);
 	
 	uv_run(event_loop->loop, UV_RUN_DEFAULT);
@@ -212,7 +180,7 @@ as_event_create_loop(as_event_loop* event_loop)
 	thread_data.event_loop = event_loop;
 	as_monitor_init(&thread_data.monitor);
 	
-	if (pthread_create(&event_loop->thread, NULL, as_uv_worker, &thread_data) != 0) {
+	if (! as_event_thread_create(event_loop, as_uv_worker, &thread_data)) {
 		return false;
 	}
 	
@@ -231,18 +199,34 @@ as_event_register_external_loop(as_event_loop* event_loop)
 
 	// Assume uv_async_init is called on the same thread as the event loop.
 	uv_async_init(event_loop->loop, event_loop->wakeup, as_uv_wakeup);
+
+	event_loop->tick = cf_malloc(sizeof(uv_timer_t));
+	event_loop->tick->data = event_loop;
+	uv_timer_init(event_loop->loop, event_loop->tick);
+}
+
+uint64_t
+as_event_loop_iterations(as_event_loop* event_loop)
+{
+#if UV_VERSION_HEX >= 0x012D00
+	uv_metrics_t metrics;
+
+	if (uv_metrics_info(event_loop->loop, &metrics) == 0) {
+		return metrics.loop_count;
+	}
+#endif
+	// Iteration count is not available in older versions of libuv.
+	return 0;
 }
 
 bool
 as_event_execute(as_event_loop* event_loop, as_event_executable executable, void* udata)
 {
 	// Send command through queue so it can be executed in event loop thread.
-	pthread_mutex_lock(&event_loop->lock);
-	as_event_commander qcmd = {.executable = executable, .udata = udata};
-	bool queued = as_queue_push(&event_loop->queue, &qcmd);
-	pthread_mutex_unlock(&event_loop->lock);
+	bool wakeup;
+	bool queued = as_event_queue_push(event_loop, executable, udata, &wakeup);
 
-	if (queued) {
+	if (wakeup) {
 		uv_async_send(event_loop->wakeup);
 	}
 	return queued;
@@ -337,19 +321,18 @@ as_uv_command_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf)
 			return;
 		}
 		
-		if (cmd->len > cmd->read_capacity) {
-			if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-				cf_free(cmd->buf);
-			}
-			cmd->buf = cf_malloc(size);
-			cmd->read_capacity = cmd->len;
-			cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
-		}
+		as_event_command_reserve_read(cmd);
 		return;
 	}
 	cmd->pos = 0;
 
-	if (cmd->proto_type_rcv == AS_COMPRESSED_MESSAGE_TYPE) {
+	if (as_event_offload(cmd)) {
+		// Large block is processed by a worker thread. Reading resumes in
+		// as_event_command_resume_read().
+		return;
+	}
+
+	if (as_proto_is_compressed(cmd->proto_type_rcv)) {
 		if (! as_event_decompress(cmd)) {
 			return;
 		}
@@ -360,6 +343,10 @@ as_uv_command_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf)
 		cmd->len = sizeof(as_proto);
 		cmd->pos = 0;
 		cmd->state = AS_ASYNC_STATE_COMMAND_READ_HEADER;
+
+		// Stop reading when flow control is paused. TLS connections use as_uv_tls_read()
+		// and do not support flow control.
+		as_event_command_pause(cmd);
 	}
 }
 
@@ -446,9 +433,26 @@ as_uv_command_start(as_event_command* cmd, uv_stream_t* stream)
 	as_uv_command_write_start(cmd, stream);
 }
 
+void
+as_event_command_resume_read(as_event_command* cmd)
+{
+	int status = uv_read_start((uv_stream_t*)cmd->conn, as_uv_command_buffer, as_uv_command_read);
+
+	if (status) {
+		if (! as_event_socket_retry(cmd)) {
+			as_error err;
+			as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION,
+							"uv_read_start failed: %s", uv_strerror(status));
+			as_event_socket_error(cmd, &err);
+		}
+	}
+}
+
 void
 as_event_command_write_start(as_event_command* cmd)
 {
+	as_event_command_trace(cmd, AS_TRACE_WRITE, AEROSPIKE_OK);
+
 	as_event_connection* conn = cmd->conn;
 
 	if (!conn->tls) {
@@ -607,7 +611,7 @@ as_uv_tls_try_send_pending(as_event_connection* conn)
 {
 	// Try quick writes from the stack.
 	as_uv_tls* tls = conn->tls;
-	int pending = BIO_pending(tls->nbio);
+	int pending = as_tls_bio_pending(&tls->bio);
 
 	if (pending <= 0) {
 		return 0;
@@ -619,7 +623,7 @@ as_uv_tls_try_send_pending(as_event_connection* conn)
 	buf.base = alloca(buf.len);
 
 	while (pending > 0) {
-		int rv = BIO_read(tls->nbio, buf.base, (int)buf.len);
+		int rv = as_tls_bio_drain(&tls->bio, buf.base, (int)buf.len);
 
 		if (rv != buf.len) {
 			return -2;
@@ -645,21 +649,8 @@ as_uv_tls_try_send_pending(as_event_connection* conn)
 		}
 
 		// Put remaining buffer on heap.
-		as_uv_tls* tls = conn->tls;
-		tls->len = pending - rv;
-		
-		if (tls->len > tls->capacity) {
-			tls->buf = cf_realloc(tls->buf, tls->len);
-			tls->capacity = tls->len;
-		}
-		
-		int unsent_len = buf.len - rv;
-		memcpy(tls->buf, buf.base + rv, unsent_len);
-		
-		int read_len = pending - buf.len;
-		rv = BIO_read(tls->nbio, tls->buf + unsent_len, read_len);
-		
-		if (rv != read_len) {
+		if (! as_tls_bio_stage(&tls->bio, buf.base + rv, (int)buf.len - rv,
+							   pending - (int)buf.len)) {
 			return -2;
 		}
 		return 1;
@@ -676,8 +667,8 @@ as_uv_tls_send_pending_slow(as_event_connection* conn, uv_write_cb cb)
 
 	as_uv_tls* tls = conn->tls;
 	uv_buf_t buf;
-	buf.base = tls->buf;
-	buf.len = tls->len;
+	buf.base = tls->bio.buf;
+	buf.len = tls->bio.len;
 
 	int rv = uv_write(write_req, (uv_stream_t*)conn, &buf, 1, cb);
 
@@ -719,19 +710,11 @@ as_uv_tls_fill_buffer(as_event_command* cmd, ssize_t nread)
 	cmd->bytes_in += (uint32_t)nread;
 
 	as_uv_tls* tls = conn->tls;
-	int len = (int)nread;
-	int rv = 0;
-
-	for (int pos = 0; pos < len; pos += rv) {
-		rv = BIO_write(tls->nbio, tls->buf + pos, len - pos);
+	as_error err;
 
-		if (rv <= 0) {
-			as_error err;
-			as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "BIO_write failed: %zd %d",
-							nread, rv);
-			as_event_parse_error(cmd, &err);
-			return false;
-		}
+	if (as_tls_bio_feed(&tls->bio, &err, tls->bio.buf, (int)nread) != AEROSPIKE_OK) {
+		as_event_parse_error(cmd, &err);
+		return false;
 	}
 	return true;
 }
@@ -756,8 +739,8 @@ as_uv_tls_buffer(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf)
 {
 	if (as_uv_connection_alive(handle)) {
 		as_uv_tls* tls = ((as_event_connection*)handle->data)->tls;
-		tls->len = 0;
-		*buf = uv_buf_init(tls->buf, tls->capacity);
+		tls->bio.len = 0;
+		*buf = uv_buf_init(tls->bio.buf, AS_TLS_BIO_BUFFER_SIZE);
 	}
 	else {
 		*buf = uv_buf_init(NULL, 0);
@@ -767,19 +750,8 @@ as_uv_tls_buffer(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf)
 static void
 as_uv_tls_handle_error(as_event_command* cmd, int rv, int e)
 {
-	unsigned long errcode = ERR_get_error();
-	char errbuf[1024];
-
-	if (errcode != 0) {
-		ERR_error_string_n(errcode, errbuf, sizeof(errbuf));
-	}
-	else {
-		errbuf[0] = 0;
-	}
-
 	as_error err;
-	as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "TLS failed: %d %d %d %s",
-					rv, e, errcode, errbuf);
+	as_tls_bio_error(&err, rv, e);
 	as_event_parse_error(cmd, &err);
 }
 
@@ -811,7 +783,7 @@ as_uv_tls_write_pending_complete(uv_write_t* req, int status)
 	as_event_command* cmd = as_uv_get_command(conn);
 
 	if (status == 0) {
-		cmd->bytes_out += tls->len;
+		cmd->bytes_out += tls->bio.len;
 
 		if (cmd->pos < cmd->len) {
 			if (tls->error == SSL_ERROR_WANT_READ) {
@@ -860,12 +832,14 @@ as_uv_tls_write(as_event_command* cmd)
 	as_uv_tls* tls = conn->tls;
 	tls->error = 0;
 
+	// Encrypt the whole command into the network BIO before touching the socket, so the
+	// TLS records of large or pipelined commands are flushed with as few writes as possible.
+	// The network BIO only forces an early flush when it is full.
 	while (cmd->pos < cmd->len) {
-		int rv = SSL_write(tls->ssl, buf + cmd->pos, cmd->len - cmd->pos);
+		int e;
+		int rv = as_tls_bio_encrypt(&tls->bio, buf + cmd->pos, cmd->len - cmd->pos, &e);
 
 		if (rv <= 0) {
-			int e = SSL_get_error(tls->ssl, rv);
-
 			if (e == SSL_ERROR_WANT_READ || e == SSL_ERROR_WANT_WRITE) {
 				tls->error = e;
 				as_uv_tls_send_pending(conn, as_uv_tls_write_pending_complete);
@@ -877,29 +851,28 @@ as_uv_tls_write(as_event_command* cmd)
 		}
 
 		cmd->pos += (uint32_t)rv;
-		rv = as_uv_tls_try_send_pending(conn);
+	}
 
-		if (rv == 0) {
-			continue;
-		}
+	int rv = as_uv_tls_try_send_pending(conn);
 
-		if (rv > 0) {
-			as_uv_tls_send_pending_slow(conn, as_uv_tls_write_pending_complete);
-			return;
-		}
+	if (rv == 0) {
+		// Write complete
+		tls->callback(cmd);
+		return;
+	}
 
-		if (! as_event_socket_retry(cmd)) {
-			as_error err;
-			as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION,
-							"TLS socket write failed: %d %s %s",
-							rv, cmd->node->name, as_node_get_address_string(cmd->node));
-			as_event_socket_error(cmd, &err);
-		}
+	if (rv > 0) {
+		as_uv_tls_send_pending_slow(conn, as_uv_tls_write_pending_complete);
 		return;
 	}
 
-	// Write complete
-	tls->callback(cmd);
+	if (! as_event_socket_retry(cmd)) {
+		as_error err;
+		as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION,
+						"TLS socket write failed: %d %s %s",
+						rv, cmd->node->name, as_node_get_address_string(cmd->node));
+		as_event_socket_error(cmd, &err);
+	}
 }
 
 static void
@@ -966,7 +939,7 @@ as_uv_tls_read_want_write_complete(uv_write_t* req, int status)
 	as_event_command* cmd = as_uv_get_command(req->data);
 
 	if (status == 0) {
-		cmd->bytes_out += cmd->conn->tls->len;
+		cmd->bytes_out += cmd->conn->tls->bio.len;
 		// Resume reading.
 		as_uv_tls_read(cmd);
 	}
@@ -987,11 +960,10 @@ as_uv_tls_read(as_event_command* cmd)
 	as_uv_tls* tls = conn->tls;
 
 	while (true) {
-		int rv = SSL_read(tls->ssl, (char*)cmd->buf + cmd->pos, cmd->len - cmd->pos);
+		int e;
+		int rv = as_tls_bio_decrypt(&tls->bio, (char*)cmd->buf + cmd->pos, cmd->len - cmd->pos, &e);
 
 		if (rv <= 0) {
-			int e = SSL_get_error(tls->ssl, rv);
-
 			if (e == SSL_ERROR_WANT_READ) {
 				return;
 			}
@@ -1068,14 +1040,7 @@ as_uv_tls_read(as_event_command* cmd)
 					return;
 				}
 
-				if (cmd->len > cmd->read_capacity) {
-					if (cmd->flags & AS_ASYNC_FLAGS_FREE_BUF) {
-						cf_free(cmd->buf);
-					}
-					cmd->buf = cf_malloc(size);
-					cmd->read_capacity = cmd->len;
-					cmd->flags |= AS_ASYNC_FLAGS_FREE_BUF;
-				}
+				as_event_command_reserve_read(cmd);
 				break;
 			}
 
@@ -1083,7 +1048,7 @@ as_uv_tls_read(as_event_command* cmd)
 				// Done reading command block.
 				cmd->pos = 0;
 
-				if (cmd->proto_type_rcv == AS_COMPRESSED_MESSAGE_TYPE) {
+				if (as_proto_is_compressed(cmd->proto_type_rcv)) {
 					if (! as_event_decompress(cmd)) {
 						return;
 					}
@@ -1150,7 +1115,8 @@ as_uv_tls_handshake_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf
 
 	as_uv_tls* tls = conn->tls;
 
-	int rv = SSL_do_handshake(tls->ssl);
+	int e;
+	int rv = as_tls_bio_handshake(&tls->bio, &e);
 
 	if (rv == 1) {
 		// Handshake complete.
@@ -1178,8 +1144,6 @@ as_uv_tls_handshake_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf
 		return;
 	}
 
-	int e = SSL_get_error(tls->ssl, rv);
-
 	if (e == SSL_ERROR_WANT_READ || e == SSL_ERROR_WANT_WRITE) {
 		// Per OpenSSL docs, flush pending data even if OpenSSL wants read.
 		as_uv_tls_send_pending(conn, as_uv_tls_handshake_send_complete);
@@ -1199,7 +1163,7 @@ as_uv_tls_handshake_send_complete(uv_write_t* req, int status)
 	as_event_command* cmd = as_uv_auth_get_command(req->data);
 
 	if (status == 0) {
-		cmd->bytes_out += cmd->conn->tls->len;
+		cmd->bytes_out += cmd->conn->tls->bio.len;
 
 		if (cmd->state == AS_ASYNC_STATE_CONNECT) {
 			// Initiate read once.
@@ -1245,45 +1209,20 @@ static void
 as_uv_tls_init_connection(as_event_command* cmd, uv_stream_t* stream, as_tls_context* ctx)
 {
 	as_uv_tls* tls = cf_malloc(sizeof(as_uv_tls));
-	tls->ctx = ctx;
-	tls->ssl = NULL;
-	tls->ibio = NULL;
-	tls->nbio = NULL;
 	tls->callback = NULL;
-	tls->capacity = 8 * 1024;
-	tls->buf = cf_malloc(tls->capacity);
-	tls->len = 0;
+	tls->error = 0;
 	cmd->conn->tls = tls;
 
-	pthread_mutex_lock(&ctx->lock);
-	tls->ssl = SSL_new(ctx->ssl_ctx);
-	pthread_mutex_unlock(&ctx->lock);
-
-	if (! tls->ssl) {
-		as_error err;
-		as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "SSL_new failed: %s %s",
-						cmd->node->name, as_node_get_address_string(cmd->node));
-		as_uv_tls_connect_fatal_error(cmd, &err);
-		return;
-	}
-
-	as_tls_set_context_name(tls->ssl, ctx, cmd->node->tls_name);
-
-	int rv = BIO_new_bio_pair(&tls->ibio, 0, &tls->nbio, 0);
+	as_error err;
 
-	if (rv != 1) {
-		as_error err;
-		as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION, "BIO_new_bio_pair failed: %d %s %s",
-						rv, cmd->node->name, as_node_get_address_string(cmd->node));
+	if (as_tls_bio_init(&tls->bio, &err, ctx, cmd->node) != AEROSPIKE_OK) {
 		as_uv_tls_connect_fatal_error(cmd, &err);
 		return;
 	}
 
-	SSL_set_bio(tls->ssl, tls->ibio, tls->ibio);
-	SSL_set_connect_state(tls->ssl);
-
 	// Handshake always fails the first time.
-	SSL_do_handshake(tls->ssl);
+	int e;
+	as_tls_bio_handshake(&tls->bio, &e);
 
 	// Send bytes created by handshake.
 	as_uv_tls_send_pending(cmd->conn, as_uv_tls_handshake_send_complete);
@@ -1308,7 +1247,7 @@ void
 as_event_close_connection(as_event_connection* conn)
 {
 	if (conn->tls) {
-		SSL_shutdown(conn->tls->ssl);
+		as_tls_bio_shutdown(&conn->tls->bio);
 		as_uv_tls_send_pending(conn, as_uv_tls_shutdown_complete);
 		return;
 	}
@@ -1418,6 +1357,17 @@ as_event_connect(as_event_command* cmd, as_async_conn_pool* pool)
 		return;
 	}
 
+	rv = as_socket_set_options(fd, &cmd->cluster->socket_options);
+
+	if (rv) {
+		as_close(fd);
+		as_error err;
+		as_error_update(&err, AEROSPIKE_ERR_ASYNC_CONNECTION,
+						"Socket options failed: %d %s %s", rv, cmd->node->name, address->name);
+		as_uv_fd_error(cmd, &err);
+		return;
+	}
+
 	if (cmd->pipe_listener && ! as_pipe_modify_fd(fd)) {
 		// as_pipe_modify_fd() will close fd on error.
 		as_error err;
@@ -1473,16 +1423,22 @@ as_event_connect(as_event_command* cmd, as_async_conn_pool* pool)
 	}
 }
 
+static void
+as_uv_tick(uv_timer_t* tick)
+{
+	as_event_wheel_process(tick->data);
+}
+
 void
-as_uv_timer_cb(uv_timer_t* timer)
+as_event_wheel_tick_start(as_event_loop* event_loop)
 {
-	as_event_process_timer(timer->data);
+	uv_timer_start(event_loop->tick, as_uv_tick, 1, 1);
 }
 
 void
-as_uv_repeat_cb(uv_timer_t* timer)
+as_event_wheel_tick_stop(as_event_loop* event_loop)
 {
-	as_event_socket_timeout(timer->data);
+	uv_timer_stop(event_loop->tick);
 }
 
 static void
@@ -1527,6 +1483,8 @@ as_event_node_destroy(as_node* node)
 		pthread_mutex_lock(&event_loop->lock);
 		as_uv_queue_close_connections(node, &node->async_conn_pools[i], &event_loop->queue);
 		as_uv_queue_close_connections(node, &node->pipe_conn_pools[i], &event_loop->queue);
+		// Commands were added to the locked queue directly.
+		as_store_uint32(&event_loop->ring->overflow, 1);
 		pthread_mutex_unlock(&event_loop->lock);
 		
 		uv_async_send(event_loop->wakeup);
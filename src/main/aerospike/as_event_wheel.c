@@ -0,0 +1,244 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_event_wheel.h>
+#include <aerospike/as_event_internal.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+
+#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBUV) || defined(AS_USE_LIBEVENT)
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_EVENT_WHEEL_MASK (AS_EVENT_WHEEL_SLOTS - 1)
+
+// Longest timeout that fits in the wheel.
+#define AS_EVENT_WHEEL_MAX ((1ULL << (AS_EVENT_WHEEL_BITS * AS_EVENT_WHEEL_LEVELS)) - 1)
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline void
+as_event_wheel_list_init(as_event_wheel_link* head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+// The slot of the current tick is only visited again if min is the current tick.
+static void
+as_event_wheel_link_timer(as_event_wheel* wheel, as_event_wheel_timer* timer, uint64_t min)
+{
+	uint64_t now = wheel->now;
+	uint64_t deadline = timer->deadline;
+
+	if (deadline < min) {
+		deadline = min;
+	}
+
+	uint64_t delta = deadline - now;
+
+	if (delta > AS_EVENT_WHEEL_MAX) {
+		delta = AS_EVENT_WHEEL_MAX;
+		deadline = now + delta;
+	}
+
+	// Find the lowest level whose range covers the delta.
+	uint32_t level = 0;
+
+	while (delta >= (1ULL << (AS_EVENT_WHEEL_BITS * (level + 1)))) {
+		level++;
+	}
+
+	uint32_t index = (uint32_t)(deadline >> (AS_EVENT_WHEEL_BITS * level)) & AS_EVENT_WHEEL_MASK;
+	as_event_wheel_link* head = &wheel->slots[level][index];
+	as_event_wheel_link* link = &timer->link;
+
+	link->next = head;
+	link->prev = head->prev;
+	head->prev->next = link;
+	head->prev = link;
+	wheel->size++;
+}
+
+static inline void
+as_event_wheel_unlink_timer(as_event_wheel* wheel, as_event_wheel_timer* timer)
+{
+	as_event_wheel_link* link = &timer->link;
+
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->next = NULL;
+	wheel->size--;
+}
+
+static inline void
+as_event_wheel_splice(as_event_wheel_link* src, as_event_wheel_link* dst)
+{
+	if (src->next == src) {
+		as_event_wheel_list_init(dst);
+		return;
+	}
+	dst->next = src->next;
+	dst->prev = src->prev;
+	dst->next->prev = dst;
+	dst->prev->next = dst;
+	as_event_wheel_list_init(src);
+}
+
+static uint32_t
+as_event_wheel_cascade(as_event_wheel* wheel, uint32_t level)
+{
+	uint32_t index = (uint32_t)(wheel->now >> (AS_EVENT_WHEEL_BITS * level)) & AS_EVENT_WHEEL_MASK;
+	as_event_wheel_link list;
+	as_event_wheel_splice(&wheel->slots[level][index], &list);
+
+	// Redistribute timers to lower levels now that they are closer to their deadline.
+	while (list.next != &list) {
+		as_event_wheel_timer* timer = (as_event_wheel_timer*)list.next;
+		list.next = timer->link.next;
+		list.next->prev = &list;
+		wheel->size--;
+
+		// Current tick slot is expired after cascading.
+		as_event_wheel_link_timer(wheel, timer, wheel->now);
+	}
+	return index;
+}
+
+static void
+as_event_wheel_expire(as_event_wheel* wheel)
+{
+	as_event_wheel_link list;
+	as_event_wheel_splice(&wheel->slots[0][wheel->now & AS_EVENT_WHEEL_MASK], &list);
+
+	// Callbacks may stop, start or free other timers in the list, so unlink each timer
+	// before its callback.
+	while (list.next != &list) {
+		as_event_wheel_timer* timer = (as_event_wheel_timer*)list.next;
+		as_event_wheel_unlink_timer(wheel, timer);
+
+		if (timer->repeat) {
+			timer->deadline = wheel->now + timer->repeat;
+			as_event_wheel_link_timer(wheel, timer, wheel->now + 1);
+			as_event_socket_timeout(timer->data);
+		}
+		else {
+			as_event_process_timer(timer->data);
+		}
+	}
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_event_wheel*
+as_event_wheel_create(void)
+{
+	as_event_wheel* wheel = cf_malloc(sizeof(as_event_wheel));
+
+	for (uint32_t i = 0; i < AS_EVENT_WHEEL_LEVELS; i++) {
+		for (uint32_t j = 0; j < AS_EVENT_WHEEL_SLOTS; j++) {
+			as_event_wheel_list_init(&wheel->slots[i][j]);
+		}
+	}
+	wheel->now = cf_getms();
+	wheel->size = 0;
+	wheel->ticking = false;
+	return wheel;
+}
+
+void
+as_event_wheel_start(
+	as_event_loop* event_loop, as_event_wheel_timer* timer, uint64_t timeout, uint64_t repeat
+	)
+{
+	as_event_wheel* wheel = event_loop->wheel;
+
+	if (timer->link.next) {
+		as_event_wheel_unlink_timer(wheel, timer);
+	}
+
+	uint64_t now = cf_getms();
+
+	if (wheel->size == 0) {
+		// Wheel is idle, so no timer is skipped by moving its clock forward.
+		wheel->now = now;
+	}
+
+	timer->deadline = now + timeout;
+	timer->repeat = repeat;
+	as_event_wheel_link_timer(wheel, timer, wheel->now + 1);
+
+	if (! wheel->ticking) {
+		wheel->ticking = true;
+		as_event_wheel_tick_start(event_loop);
+	}
+}
+
+void
+as_event_wheel_again(as_event_loop* event_loop, as_event_wheel_timer* timer)
+{
+	if (timer->link.next && timer->repeat) {
+		as_event_wheel* wheel = event_loop->wheel;
+		as_event_wheel_unlink_timer(wheel, timer);
+		timer->deadline = cf_getms() + timer->repeat;
+		as_event_wheel_link_timer(wheel, timer, wheel->now + 1);
+	}
+}
+
+void
+as_event_wheel_stop(as_event_loop* event_loop, as_event_wheel_timer* timer)
+{
+	if (timer->link.next) {
+		as_event_wheel_unlink_timer(event_loop->wheel, timer);
+	}
+}
+
+void
+as_event_wheel_process(as_event_loop* event_loop)
+{
+	as_event_wheel* wheel = event_loop->wheel;
+	uint64_t now = cf_getms();
+
+	while (wheel->now < now && wheel->size > 0) {
+		wheel->now++;
+
+		uint32_t level = 1;
+
+		// Cascade higher levels when the lower level wraps.
+		while (level < AS_EVENT_WHEEL_LEVELS &&
+			   ((wheel->now >> (AS_EVENT_WHEEL_BITS * (level - 1))) & AS_EVENT_WHEEL_MASK) == 0) {
+			if (as_event_wheel_cascade(wheel, level) != 0) {
+				break;
+			}
+			level++;
+		}
+		as_event_wheel_expire(wheel);
+	}
+
+	if (wheel->size == 0) {
+		wheel->now = now;
+		wheel->ticking = false;
+		as_event_wheel_tick_stop(event_loop);
+	}
+}
+
+#endif
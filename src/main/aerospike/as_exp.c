@@ -22,7 +22,9 @@
 #include <aerospike/as_key.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_msgpack.h>
+#include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_b64.h>
+#include <pthread.h>
 
 typedef enum {
 	CALL_CDT = 0,
@@ -32,8 +34,44 @@ typedef enum {
 
 #define AS_CDT_OP_CONTEXT_EVAL 0xff
 
+#define AS_EXP_INTERN_BUCKETS 256
+
+typedef struct as_exp_interned_s {
+	struct as_exp_interned_s* next;
+	as_exp* exp;
+	uint32_t hash;
+	uint32_t ref_count;
+} as_exp_interned;
+
+static as_exp_interned* as_exp_intern_table[AS_EXP_INTERN_BUCKETS];
+static pthread_mutex_t as_exp_intern_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t
+as_exp_hash(const as_exp* exp)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+
+	for (uint32_t i = 0; i < exp->packed_sz; i++) {
+		hash ^= exp->packed[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
 as_exp*
 as_exp_compile(as_exp_entry* table, uint32_t n)
+{
+	as_exp* exp = as_exp_compile_raw(table, n);
+
+	if (exp == NULL) {
+		return NULL;
+	}
+	return as_exp_optimize(exp);
+}
+
+as_exp*
+as_exp_compile_raw(as_exp_entry* table, uint32_t n)
 {
 	uint32_t total_sz = 0;
 	as_serializer s;
@@ -393,6 +431,70 @@ as_exp_destroy_b64(char* b64)
 	cf_free(b64);
 }
 
+as_exp*
+as_exp_intern(as_exp* exp)
+{
+	if (! exp) {
+		return NULL;
+	}
+
+	uint32_t hash = as_exp_hash(exp);
+	as_exp_interned** bucket = &as_exp_intern_table[hash % AS_EXP_INTERN_BUCKETS];
+
+	pthread_mutex_lock(&as_exp_intern_lock);
+
+	for (as_exp_interned* e = *bucket; e; e = e->next) {
+		if (e->hash == hash && e->exp->packed_sz == exp->packed_sz &&
+			memcmp(e->exp->packed, exp->packed, exp->packed_sz) == 0) {
+			e->ref_count++;
+			pthread_mutex_unlock(&as_exp_intern_lock);
+
+			if (e->exp != exp) {
+				as_exp_destroy(exp);
+			}
+			return e->exp;
+		}
+	}
+
+	as_exp_interned* e = cf_malloc(sizeof(as_exp_interned));
+	e->exp = exp;
+	e->hash = hash;
+	e->ref_count = 1;
+	e->next = *bucket;
+	*bucket = e;
+
+	pthread_mutex_unlock(&as_exp_intern_lock);
+	return exp;
+}
+
+void
+as_exp_release(as_exp* exp)
+{
+	if (! exp) {
+		return;
+	}
+
+	uint32_t hash = as_exp_hash(exp);
+	as_exp_interned** prev = &as_exp_intern_table[hash % AS_EXP_INTERN_BUCKETS];
+
+	pthread_mutex_lock(&as_exp_intern_lock);
+
+	for (as_exp_interned* e = *prev; e; prev = &e->next, e = e->next) {
+		if (e->exp == exp) {
+			if (--e->ref_count == 0) {
+				*prev = e->next;
+				pthread_mutex_unlock(&as_exp_intern_lock);
+				as_exp_destroy(exp);
+				cf_free(e);
+				return;
+			}
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&as_exp_intern_lock);
+}
+
 uint8_t*
 as_exp_write(as_exp* exp, uint8_t* ptr)
 {
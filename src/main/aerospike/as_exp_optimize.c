@@ -0,0 +1,862 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_exp.h>
+#include <aerospike/as_msgpack.h>
+#include <citrusleaf/alloc.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_EXP_NONE UINT32_MAX
+
+// Maximum expression nesting the optimizer descends into.
+#define AS_EXP_MAX_DEPTH 256
+
+// Larger expressions are still folded, but repeated sub-expressions are not searched
+// because the search is quadratic.
+#define AS_EXP_CSE_MAX_NODES 2048
+
+// Maximum variables introduced by sub-expression elimination.
+#define AS_EXP_CSE_MAX_VARS 16
+
+#define AS_EXP_VAR_NAME_SIZE 8
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef enum {
+	// Value or operation that is copied as is.
+	AS_EXP_NODE_RAW,
+	AS_EXP_NODE_BOOL,
+	AS_EXP_NODE_INT,
+	AS_EXP_NODE_FLOAT,
+	AS_EXP_NODE_STR,
+	AS_EXP_NODE_OP,
+	// Reference to a variable introduced by sub-expression elimination.
+	AS_EXP_NODE_REF
+} as_exp_node_type;
+
+typedef struct {
+	const uint8_t* buf;
+	uint32_t sz;
+	uint32_t child;
+	uint32_t next;
+	uint32_t n_args;
+	int64_t op;
+	union {
+		bool b;
+		int64_t i;
+		double f;
+		uint32_t ref;
+	} v;
+	uint8_t type;
+	bool has_var;
+} as_exp_node;
+
+typedef struct {
+	as_exp_node* nodes;
+	uint32_t size;
+	uint32_t capacity;
+	const as_exp* exp;
+	uint32_t n_vars;
+	uint32_t name_seq;
+	uint32_t defs[AS_EXP_CSE_MAX_VARS];
+	char names[AS_EXP_CSE_MAX_VARS][AS_EXP_VAR_NAME_SIZE];
+	bool invalid;
+	bool bad_arity;
+	bool changed;
+} as_exp_tree;
+
+typedef struct {
+	uint32_t id;
+	uint32_t sz;
+	bool uncond;
+} as_exp_candidate;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline bool
+as_exp_is_list_header(uint8_t b)
+{
+	return (b & 0xf0) == 0x90 || b == 0xdc || b == 0xdd;
+}
+
+static inline bool
+as_exp_is_int(uint8_t b)
+{
+	// uint64 (0xcf) may not fit in int64_t.
+	return b <= 0x7f || b >= 0xe0 || (b >= 0xcc && b <= 0xd3 && b != 0xcf);
+}
+
+static inline bool
+as_exp_is_str(uint8_t b)
+{
+	return (b & 0xe0) == 0xa0 || (b >= 0xd9 && b <= 0xdb);
+}
+
+static bool
+as_exp_raw_has_var(const uint8_t* p, uint32_t sz)
+{
+	// Look for [VAR, ...] headers anywhere in opaque bytes. False positives only
+	// prevent sub-expression elimination.
+	for (uint32_t i = 1; i < sz; i++) {
+		if (p[i - 1] == 0x92 && p[i] == _AS_EXP_CODE_VAR) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool
+as_exp_check_arity(as_exp_tree* t, as_exp_node* node)
+{
+	uint32_t n = node->n_args;
+
+	switch (node->op) {
+	case _AS_EXP_CODE_CMP_EQ:
+	case _AS_EXP_CODE_CMP_NE:
+	case _AS_EXP_CODE_CMP_GT:
+	case _AS_EXP_CODE_CMP_GE:
+	case _AS_EXP_CODE_CMP_LT:
+	case _AS_EXP_CODE_CMP_LE:
+	case _AS_EXP_CODE_CMP_GEO:
+		return n == 2;
+	case _AS_EXP_CODE_NOT:
+		return n == 1;
+	case _AS_EXP_CODE_COND:
+		return n >= 3 && (n & 1) == 1;
+	case _AS_EXP_CODE_LET: {
+		if (n < 3 || (n & 1) == 0) {
+			return false;
+		}
+
+		// Variable names precede each definition.
+		uint32_t c = node->child;
+
+		for (uint32_t i = 0; i < n - 1; i += 2) {
+			if (t->nodes[c].type != AS_EXP_NODE_STR) {
+				return false;
+			}
+			c = t->nodes[t->nodes[c].next].next;
+		}
+		return true;
+	}
+	case _AS_EXP_CODE_VAR:
+		return n == 1 && t->nodes[node->child].type == AS_EXP_NODE_STR;
+	default:
+		return true;
+	}
+}
+
+static uint32_t
+as_exp_parse(as_exp_tree* t, as_unpacker* pk, uint32_t depth)
+{
+	if (pk->offset >= pk->length || t->size >= t->capacity || depth > AS_EXP_MAX_DEPTH) {
+		t->invalid = true;
+		return AS_EXP_NONE;
+	}
+
+	uint32_t id = t->size++;
+	as_exp_node* node = &t->nodes[id];
+	int start = pk->offset;
+
+	memset(node, 0, sizeof(as_exp_node));
+	node->buf = pk->buffer + start;
+	node->child = AS_EXP_NONE;
+	node->next = AS_EXP_NONE;
+
+	uint8_t b = *node->buf;
+	bool ok = true;
+
+	if (as_exp_is_list_header(b)) {
+		as_unpacker header = *pk;
+		int64_t count = as_unpack_list_header_element_count(pk);
+
+		if (count > 0 && pk->offset < pk->length && as_exp_is_int(pk->buffer[pk->offset]) &&
+			as_unpack_int64(pk, &node->op) == 0 &&
+			node->op >= 0 && node->op < _AS_EXP_CODE_QUOTE) {
+			// Operation with expression arguments. QUOTE and CALL contain values and
+			// CDT operations that must not be interpreted as expressions.
+			node->type = AS_EXP_NODE_OP;
+			node->n_args = (uint32_t)(count - 1);
+			node->has_var = node->op == _AS_EXP_CODE_VAR;
+
+			uint32_t* link = &node->child;
+
+			for (uint32_t i = 0; i < node->n_args; i++) {
+				uint32_t c = as_exp_parse(t, pk, depth + 1);
+
+				if (c == AS_EXP_NONE) {
+					return AS_EXP_NONE;
+				}
+
+				// Parsing children does not move nodes, so node remains valid.
+				node->has_var |= t->nodes[c].has_var;
+				*link = c;
+				link = &t->nodes[c].next;
+			}
+
+			if (! as_exp_check_arity(t, node)) {
+				t->invalid = true;
+				t->bad_arity = true;
+				return AS_EXP_NONE;
+			}
+		}
+		else {
+			*pk = header;
+			ok = as_unpack_size(pk) >= 0;
+			node->type = AS_EXP_NODE_RAW;
+			node->has_var = ok && as_exp_raw_has_var(node->buf, (uint32_t)(pk->offset - start));
+		}
+	}
+	else if (b == 0xc2 || b == 0xc3) {
+		node->type = AS_EXP_NODE_BOOL;
+		node->v.b = b == 0xc3;
+		pk->offset++;
+	}
+	else if (as_exp_is_int(b)) {
+		node->type = AS_EXP_NODE_INT;
+		ok = as_unpack_int64(pk, &node->v.i) == 0;
+	}
+	else if (b == 0xca || b == 0xcb) {
+		node->type = AS_EXP_NODE_FLOAT;
+		ok = as_unpack_double(pk, &node->v.f) == 0;
+	}
+	else if (as_exp_is_str(b)) {
+		node->type = AS_EXP_NODE_STR;
+		ok = as_unpack_size(pk) >= 0;
+	}
+	else {
+		node->type = AS_EXP_NODE_RAW;
+		ok = as_unpack_size(pk) >= 0;
+	}
+
+	if (! ok || pk->offset > pk->length) {
+		t->invalid = true;
+		return AS_EXP_NONE;
+	}
+
+	node->sz = (uint32_t)(pk->offset - start);
+	return id;
+}
+
+static void
+as_exp_set_bool(as_exp_tree* t, as_exp_node* node, bool b)
+{
+	node->type = AS_EXP_NODE_BOOL;
+	node->v.b = b;
+	node->buf = NULL;
+	node->sz = 0;
+	node->child = AS_EXP_NONE;
+	node->n_args = 0;
+	node->has_var = false;
+	t->changed = true;
+}
+
+static void
+as_exp_replace(as_exp_tree* t, as_exp_node* node, uint32_t src)
+{
+	// Keep position among siblings.
+	uint32_t next = node->next;
+	*node = t->nodes[src];
+	node->next = next;
+	t->changed = true;
+}
+
+static void
+as_exp_fold_logic(as_exp_tree* t, as_exp_node* node)
+{
+	// true is the identity of and(), false is the identity of or().
+	bool identity = node->op == _AS_EXP_CODE_AND;
+	uint32_t* link = &node->child;
+	uint32_t n = 0;
+	uint32_t c = node->child;
+
+	while (c != AS_EXP_NONE) {
+		as_exp_node* child = &t->nodes[c];
+		uint32_t next = child->next;
+
+		if (child->type == AS_EXP_NODE_BOOL) {
+			if (child->v.b != identity) {
+				as_exp_set_bool(t, node, ! identity);
+				return;
+			}
+			t->changed = true;
+		}
+		else if (child->type == AS_EXP_NODE_OP && child->op == node->op) {
+			// Flatten and(a, and(b, c)) to and(a, b, c).
+			uint32_t g = child->child;
+			*link = g;
+
+			while (g != AS_EXP_NONE) {
+				link = &t->nodes[g].next;
+				g = t->nodes[g].next;
+				n++;
+			}
+			t->changed = true;
+		}
+		else {
+			*link = c;
+			link = &child->next;
+			n++;
+		}
+		c = next;
+	}
+	*link = AS_EXP_NONE;
+	node->n_args = n;
+
+	if (n == 0) {
+		as_exp_set_bool(t, node, identity);
+	}
+	else if (n == 1) {
+		as_exp_replace(t, node, node->child);
+	}
+}
+
+static void
+as_exp_fold_not(as_exp_tree* t, as_exp_node* node)
+{
+	as_exp_node* child = &t->nodes[node->child];
+
+	if (child->type == AS_EXP_NODE_BOOL) {
+		as_exp_set_bool(t, node, ! child->v.b);
+	}
+	else if (child->type == AS_EXP_NODE_OP && child->op == _AS_EXP_CODE_NOT) {
+		as_exp_replace(t, node, child->child);
+	}
+}
+
+static bool
+as_exp_str_particle(as_exp_node* node, const uint8_t** p, uint32_t* sz)
+{
+	as_unpacker pk = {
+		.buffer = node->buf,
+		.offset = 0,
+		.length = (int)node->sz
+	};
+
+	*p = as_unpack_str(&pk, sz);
+
+	// Only string values are comparable. Bin and variable names have no particle type.
+	return *p && *sz > 0 && **p == AS_BYTES_STRING;
+}
+
+static void
+as_exp_fold_cmp(as_exp_tree* t, as_exp_node* node)
+{
+	as_exp_node* left = &t->nodes[node->child];
+	as_exp_node* right = &t->nodes[left->next];
+
+	if (left->type != right->type) {
+		return;
+	}
+
+	int cmp;
+
+	switch (left->type) {
+	case AS_EXP_NODE_INT:
+		cmp = (left->v.i > right->v.i) - (left->v.i < right->v.i);
+		break;
+	case AS_EXP_NODE_FLOAT:
+		if (isnan(left->v.f) || isnan(right->v.f)) {
+			return;
+		}
+		cmp = (left->v.f > right->v.f) - (left->v.f < right->v.f);
+		break;
+	case AS_EXP_NODE_BOOL:
+	case AS_EXP_NODE_STR:
+		if (node->op != _AS_EXP_CODE_CMP_EQ && node->op != _AS_EXP_CODE_CMP_NE) {
+			return;
+		}
+
+		if (left->type == AS_EXP_NODE_BOOL) {
+			cmp = left->v.b != right->v.b;
+		}
+		else {
+			const uint8_t* lp;
+			const uint8_t* rp;
+			uint32_t lsz;
+			uint32_t rsz;
+
+			if (! as_exp_str_particle(left, &lp, &lsz) ||
+				! as_exp_str_particle(right, &rp, &rsz)) {
+				return;
+			}
+			cmp = lsz != rsz || memcmp(lp, rp, lsz) != 0;
+		}
+		break;
+	default:
+		return;
+	}
+
+	bool result;
+
+	switch (node->op) {
+	case _AS_EXP_CODE_CMP_EQ:
+		result = cmp == 0;
+		break;
+	case _AS_EXP_CODE_CMP_NE:
+		result = cmp != 0;
+		break;
+	case _AS_EXP_CODE_CMP_GT:
+		result = cmp > 0;
+		break;
+	case _AS_EXP_CODE_CMP_GE:
+		result = cmp >= 0;
+		break;
+	case _AS_EXP_CODE_CMP_LT:
+		result = cmp < 0;
+		break;
+	default:
+		result = cmp <= 0;
+		break;
+	}
+	as_exp_set_bool(t, node, result);
+}
+
+static void
+as_exp_fold_cond(as_exp_tree* t, as_exp_node* node)
+{
+	// cond(c1, v1, c2, v2, ..., default)
+	uint32_t* link = &node->child;
+	uint32_t n = 0;
+	uint32_t c = node->child;
+
+	while (t->nodes[c].next != AS_EXP_NONE) {
+		as_exp_node* test = &t->nodes[c];
+		uint32_t value = test->next;
+		uint32_t next = t->nodes[value].next;
+
+		if (test->type == AS_EXP_NODE_BOOL) {
+			t->changed = true;
+
+			if (test->v.b) {
+				// Remaining branches are never reached.
+				c = value;
+				break;
+			}
+			// Branch is never taken.
+		}
+		else {
+			*link = c;
+			link = &t->nodes[value].next;
+			n += 2;
+		}
+		c = next;
+	}
+
+	// Default value.
+	*link = c;
+	t->nodes[c].next = AS_EXP_NONE;
+	node->n_args = n + 1;
+
+	if (n == 0) {
+		as_exp_replace(t, node, c);
+	}
+}
+
+static void
+as_exp_fold(as_exp_tree* t, uint32_t id)
+{
+	as_exp_node* node = &t->nodes[id];
+
+	if (node->type != AS_EXP_NODE_OP) {
+		return;
+	}
+
+	for (uint32_t c = node->child; c != AS_EXP_NONE; c = t->nodes[c].next) {
+		as_exp_fold(t, c);
+	}
+
+	switch (node->op) {
+	case _AS_EXP_CODE_AND:
+	case _AS_EXP_CODE_OR:
+		as_exp_fold_logic(t, node);
+		break;
+	case _AS_EXP_CODE_NOT:
+		as_exp_fold_not(t, node);
+		break;
+	case _AS_EXP_CODE_CMP_EQ:
+	case _AS_EXP_CODE_CMP_NE:
+	case _AS_EXP_CODE_CMP_GT:
+	case _AS_EXP_CODE_CMP_GE:
+	case _AS_EXP_CODE_CMP_LT:
+	case _AS_EXP_CODE_CMP_LE:
+		as_exp_fold_cmp(t, node);
+		break;
+	case _AS_EXP_CODE_COND:
+		as_exp_fold_cond(t, node);
+		break;
+	default:
+		break;
+	}
+}
+
+static void
+as_exp_emit(as_exp_tree* t, uint32_t id, as_packer* pk)
+{
+	as_exp_node* node = &t->nodes[id];
+
+	switch (node->type) {
+	case AS_EXP_NODE_BOOL:
+		as_pack_bool(pk, node->v.b);
+		break;
+	case AS_EXP_NODE_REF: {
+		const char* name = t->names[node->v.ref];
+		as_pack_list_header(pk, 2);
+		as_pack_int64(pk, _AS_EXP_CODE_VAR);
+		as_pack_str(pk, (const uint8_t*)name, (uint32_t)strlen(name));
+		break;
+	}
+	case AS_EXP_NODE_OP:
+		as_pack_list_header(pk, node->n_args + 1);
+		as_pack_int64(pk, node->op);
+
+		for (uint32_t c = node->child; c != AS_EXP_NONE; c = t->nodes[c].next) {
+			as_exp_emit(t, c, pk);
+		}
+		break;
+	default:
+		as_pack_append(pk, node->buf, node->sz);
+		break;
+	}
+}
+
+static void
+as_exp_emit_root(as_exp_tree* t, uint32_t root, as_packer* pk)
+{
+	if (t->n_vars == 0) {
+		as_exp_emit(t, root, pk);
+		return;
+	}
+
+	// Variables found later are smaller and may be referenced by earlier definitions,
+	// so they are defined first.
+	as_pack_list_header(pk, t->n_vars * 2 + 2);
+	as_pack_int64(pk, _AS_EXP_CODE_LET);
+
+	for (uint32_t i = t->n_vars; i > 0; i--) {
+		const char* name = t->names[i - 1];
+		as_pack_str(pk, (const uint8_t*)name, (uint32_t)strlen(name));
+		as_exp_emit(t, t->defs[i - 1], pk);
+	}
+	as_exp_emit(t, root, pk);
+}
+
+static uint32_t
+as_exp_node_size(as_exp_tree* t, uint32_t id)
+{
+	as_packer pk = {.buffer = NULL, .capacity = UINT32_MAX};
+	as_exp_emit(t, id, &pk);
+	return pk.offset;
+}
+
+static bool
+as_exp_node_equal(as_exp_tree* t, uint32_t a, uint32_t b)
+{
+	as_exp_node* x = &t->nodes[a];
+	as_exp_node* y = &t->nodes[b];
+
+	if (x->type != y->type) {
+		return false;
+	}
+
+	switch (x->type) {
+	case AS_EXP_NODE_BOOL:
+		return x->v.b == y->v.b;
+	case AS_EXP_NODE_REF:
+		return x->v.ref == y->v.ref;
+	case AS_EXP_NODE_OP: {
+		if (x->op != y->op || x->n_args != y->n_args) {
+			return false;
+		}
+
+		uint32_t c = x->child;
+		uint32_t d = y->child;
+
+		while (c != AS_EXP_NONE) {
+			if (! as_exp_node_equal(t, c, d)) {
+				return false;
+			}
+			c = t->nodes[c].next;
+			d = t->nodes[d].next;
+		}
+		return true;
+	}
+	default:
+		return x->sz == y->sz && memcmp(x->buf, y->buf, x->sz) == 0;
+	}
+}
+
+static bool
+as_exp_mark_vars(as_exp_tree* t, uint32_t id)
+{
+	as_exp_node* node = &t->nodes[id];
+
+	if (node->type == AS_EXP_NODE_REF) {
+		return true;
+	}
+
+	if (node->type == AS_EXP_NODE_OP) {
+		bool has_var = node->op == _AS_EXP_CODE_VAR;
+
+		for (uint32_t c = node->child; c != AS_EXP_NONE; c = t->nodes[c].next) {
+			has_var |= as_exp_mark_vars(t, c);
+		}
+		node->has_var = has_var;
+	}
+	return node->has_var;
+}
+
+static void
+as_exp_collect(
+	as_exp_tree* t, uint32_t id, bool uncond, as_exp_candidate* list, uint32_t* n
+	)
+{
+	as_exp_node* node = &t->nodes[id];
+
+	// Opaque lists are complete expressions like CDT calls or quoted values.
+	bool raw_list = node->type == AS_EXP_NODE_RAW && as_exp_is_list_header(*node->buf);
+
+	if (! raw_list && node->type != AS_EXP_NODE_OP) {
+		return;
+	}
+
+	if (! node->has_var) {
+		as_exp_candidate* cand = &list[(*n)++];
+		cand->id = id;
+		cand->sz = as_exp_node_size(t, id);
+		cand->uncond = uncond;
+	}
+
+	if (raw_list) {
+		return;
+	}
+
+	// Only the first argument of and(), or() and cond() is always evaluated.
+	bool lazy = node->op == _AS_EXP_CODE_AND || node->op == _AS_EXP_CODE_OR ||
+		node->op == _AS_EXP_CODE_COND;
+	bool first = true;
+
+	for (uint32_t c = node->child; c != AS_EXP_NONE; c = t->nodes[c].next) {
+		as_exp_collect(t, c, uncond && (first || ! lazy), list, n);
+		first = false;
+	}
+}
+
+static bool
+as_exp_next_name(as_exp_tree* t, char* name)
+{
+	// Name must not collide with any string in the original expression.
+	while (t->name_seq < 1000) {
+		int len = snprintf(name, AS_EXP_VAR_NAME_SIZE, "_%u", t->name_seq++);
+		uint8_t enc[AS_EXP_VAR_NAME_SIZE];
+		enc[0] = (uint8_t)(0xa0 | len);
+		memcpy(enc + 1, name, len);
+
+		const uint8_t* p = t->exp->packed;
+		uint32_t sz = t->exp->packed_sz;
+		bool found = false;
+
+		for (uint32_t i = 0; i + len + 1 <= sz; i++) {
+			if (memcmp(p + i, enc, len + 1) == 0) {
+				found = true;
+				break;
+			}
+		}
+
+		if (! found) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool
+as_exp_cse_pass(as_exp_tree* t, uint32_t root, as_exp_candidate* list)
+{
+	uint32_t n = 0;
+
+	as_exp_collect(t, root, true, list, &n);
+
+	for (uint32_t i = 0; i < t->n_vars; i++) {
+		as_exp_collect(t, t->defs[i], true, list, &n);
+	}
+
+	char name[AS_EXP_VAR_NAME_SIZE];
+	uint32_t seq = t->name_seq;
+
+	if (! as_exp_next_name(t, name)) {
+		return false;
+	}
+	t->name_seq = seq;
+
+	int64_t name_sz = (int64_t)strlen(name) + 1;
+	int64_t let_sz = t->n_vars == 0 ? 2 : 0;
+	int64_t best_savings = 0;
+	uint32_t best = AS_EXP_NONE;
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_exp_candidate* a = &list[i];
+		uint32_t count = 1;
+		bool uncond = a->uncond;
+		bool dup = false;
+
+		for (uint32_t j = 0; j < n; j++) {
+			as_exp_candidate* b = &list[j];
+
+			if (i == j || a->sz != b->sz || ! as_exp_node_equal(t, a->id, b->id)) {
+				continue;
+			}
+
+			if (j < i) {
+				// Already evaluated as part of an earlier candidate.
+				dup = true;
+				break;
+			}
+			count++;
+			uncond |= b->uncond;
+		}
+
+		// At least one occurrence must be evaluated unconditionally, otherwise binding
+		// it to a variable would evaluate it where the original expression did not.
+		if (dup || count < 2 || ! uncond) {
+			continue;
+		}
+
+		// Definition costs the name plus one copy, each reference costs [VAR, name].
+		int64_t savings = (int64_t)a->sz * count - (a->sz + name_sz) - (2 + name_sz) * count - let_sz;
+
+		if (savings > best_savings) {
+			best_savings = savings;
+			best = i;
+		}
+	}
+
+	if (best == AS_EXP_NONE) {
+		return false;
+	}
+
+	as_exp_next_name(t, t->names[t->n_vars]);
+
+	// Move first occurrence into the definition.
+	uint32_t src = list[best].id;
+	uint32_t def = t->size++;
+	t->nodes[def] = t->nodes[src];
+	t->nodes[def].next = AS_EXP_NONE;
+
+	for (uint32_t j = best; j < n; j++) {
+		uint32_t id = list[j].id;
+
+		if (id == src || (list[j].sz == list[best].sz && as_exp_node_equal(t, def, id))) {
+			as_exp_node* node = &t->nodes[id];
+			node->type = AS_EXP_NODE_REF;
+			node->v.ref = t->n_vars;
+			node->child = AS_EXP_NONE;
+			node->n_args = 0;
+		}
+	}
+
+	t->defs[t->n_vars++] = def;
+	t->changed = true;
+
+	as_exp_mark_vars(t, root);
+
+	for (uint32_t i = 0; i < t->n_vars; i++) {
+		as_exp_mark_vars(t, t->defs[i]);
+	}
+	return true;
+}
+
+static void
+as_exp_cse(as_exp_tree* t, uint32_t root)
+{
+	if (t->size > AS_EXP_CSE_MAX_NODES) {
+		return;
+	}
+
+	as_exp_candidate* list = cf_malloc(sizeof(as_exp_candidate) * t->capacity);
+
+	while (t->n_vars < AS_EXP_CSE_MAX_VARS && as_exp_cse_pass(t, root, list)) {
+	}
+	cf_free(list);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_exp*
+as_exp_optimize(as_exp* exp)
+{
+	as_exp_tree t;
+	memset(&t, 0, sizeof(as_exp_tree));
+	t.exp = exp;
+
+	// Every msgpack element takes at least one byte.
+	t.capacity = exp->packed_sz + AS_EXP_CSE_MAX_VARS;
+	t.nodes = cf_malloc(sizeof(as_exp_node) * t.capacity);
+
+	as_unpacker pk = {
+		.buffer = exp->packed,
+		.offset = 0,
+		.length = (int)exp->packed_sz
+	};
+
+	uint32_t root = as_exp_parse(&t, &pk, 0);
+
+	if (t.bad_arity) {
+		// Operation with the wrong number of arguments.
+		cf_free(t.nodes);
+		as_exp_destroy(exp);
+		return NULL;
+	}
+
+	if (root == AS_EXP_NONE || pk.offset != pk.length) {
+		// Not understood, so leave as is.
+		cf_free(t.nodes);
+		return exp;
+	}
+
+	as_exp_fold(&t, root);
+	as_exp_cse(&t, root);
+
+	if (! t.changed) {
+		cf_free(t.nodes);
+		return exp;
+	}
+
+	as_packer sizer = {.buffer = NULL, .capacity = UINT32_MAX};
+	as_exp_emit_root(&t, root, &sizer);
+
+	as_exp* opt = cf_malloc(sizeof(as_exp) + sizer.offset);
+	opt->packed_sz = sizer.offset;
+
+	as_packer out = {.buffer = opt->packed, .capacity = sizer.offset};
+	as_exp_emit_root(&t, root, &out);
+
+	cf_free(t.nodes);
+	as_exp_destroy(exp);
+	return opt;
+}
@@ -0,0 +1,502 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_geo_region.h>
+#include <aerospike/as_bytes.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define GEO_PI 3.14159265358979323846
+#define GEO_EARTH_RADIUS 6371000.0
+#define GEO_MAX_DEPTH 64
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	const char* p;
+	uint32_t depth;
+} as_geo_parser;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_geo_skip_ws(as_geo_parser* ps)
+{
+	while (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r') {
+		ps->p++;
+	}
+}
+
+static bool
+as_geo_consume(as_geo_parser* ps, char c)
+{
+	as_geo_skip_ws(ps);
+
+	if (*ps->p != c) {
+		return false;
+	}
+	ps->p++;
+	return true;
+}
+
+static bool
+as_geo_parse_string(as_geo_parser* ps, const char** str, uint32_t* len)
+{
+	if (! as_geo_consume(ps, '"')) {
+		return false;
+	}
+
+	const char* begin = ps->p;
+
+	while (*ps->p != '"') {
+		if (*ps->p == '\0') {
+			return false;
+		}
+
+		if (*ps->p == '\\' && *++ps->p == '\0') {
+			return false;
+		}
+		ps->p++;
+	}
+
+	*str = begin;
+	*len = (uint32_t)(ps->p - begin);
+	ps->p++;
+	return true;
+}
+
+static bool
+as_geo_parse_number(as_geo_parser* ps, double* val)
+{
+	as_geo_skip_ws(ps);
+
+	char* end;
+	*val = strtod(ps->p, &end);
+
+	if (end == ps->p) {
+		return false;
+	}
+	ps->p = end;
+	return isfinite(*val);
+}
+
+static bool
+as_geo_skip_value(as_geo_parser* ps)
+{
+	as_geo_skip_ws(ps);
+
+	char c = *ps->p;
+
+	if (c == '"') {
+		const char* str;
+		uint32_t len;
+		return as_geo_parse_string(ps, &str, &len);
+	}
+
+	if (c == '{' || c == '[') {
+		if (++ps->depth > GEO_MAX_DEPTH) {
+			return false;
+		}
+
+		char close = (c == '{')? '}' : ']';
+		ps->p++;
+
+		if (! as_geo_consume(ps, close)) {
+			do {
+				if (c == '{') {
+					const char* key;
+					uint32_t len;
+
+					if (! (as_geo_parse_string(ps, &key, &len) && as_geo_consume(ps, ':'))) {
+						return false;
+					}
+				}
+
+				if (! as_geo_skip_value(ps)) {
+					return false;
+				}
+			} while (as_geo_consume(ps, ','));
+
+			if (! as_geo_consume(ps, close)) {
+				return false;
+			}
+		}
+		ps->depth--;
+		return true;
+	}
+
+	if (strncmp(ps->p, "true", 4) == 0 || strncmp(ps->p, "null", 4) == 0) {
+		ps->p += 4;
+		return true;
+	}
+
+	if (strncmp(ps->p, "false", 5) == 0) {
+		ps->p += 5;
+		return true;
+	}
+
+	double val;
+	return as_geo_parse_number(ps, &val);
+}
+
+// Parse top level object and return the type string and the start of the coordinates value.
+static bool
+as_geo_parse_object(
+	as_geo_parser* ps, const char** type, uint32_t* type_len, const char** coords
+	)
+{
+	*type = NULL;
+	*coords = NULL;
+
+	if (! as_geo_consume(ps, '{')) {
+		return false;
+	}
+
+	do {
+		const char* key;
+		uint32_t len;
+
+		if (! (as_geo_parse_string(ps, &key, &len) && as_geo_consume(ps, ':'))) {
+			return false;
+		}
+
+		if (len == 4 && memcmp(key, "type", 4) == 0) {
+			if (! as_geo_parse_string(ps, type, type_len)) {
+				return false;
+			}
+			continue;
+		}
+
+		if (len == 11 && memcmp(key, "coordinates", 11) == 0) {
+			as_geo_skip_ws(ps);
+			*coords = ps->p;
+		}
+
+		if (! as_geo_skip_value(ps)) {
+			return false;
+		}
+	} while (as_geo_consume(ps, ','));
+
+	if (! as_geo_consume(ps, '}')) {
+		return false;
+	}
+
+	as_geo_skip_ws(ps);
+	return *ps->p == '\0' && *type && *coords;
+}
+
+static inline bool
+as_geo_type_equals(const char* type, uint32_t type_len, const char* name)
+{
+	return strlen(name) == type_len && memcmp(type, name, type_len) == 0;
+}
+
+static bool
+as_geo_parse_point(as_geo_parser* ps, as_geo_point* pt)
+{
+	if (! (as_geo_consume(ps, '[') && as_geo_parse_number(ps, &pt->lng) &&
+		   as_geo_consume(ps, ',') && as_geo_parse_number(ps, &pt->lat))) {
+		return false;
+	}
+
+	// Ignore altitude.
+	while (as_geo_consume(ps, ',')) {
+		double val;
+
+		if (! as_geo_parse_number(ps, &val)) {
+			return false;
+		}
+	}
+
+	if (! as_geo_consume(ps, ']')) {
+		return false;
+	}
+	return pt->lng >= -180.0 && pt->lng <= 180.0 && pt->lat >= -90.0 && pt->lat <= 90.0;
+}
+
+static bool
+as_geo_parse_ring(as_geo_parser* ps, as_geo_region* region)
+{
+	uint32_t start = region->points.size;
+
+	if (! as_geo_consume(ps, '[')) {
+		return false;
+	}
+
+	do {
+		as_geo_point pt;
+
+		if (! as_geo_parse_point(ps, &pt)) {
+			return false;
+		}
+		as_vector_append(&region->points, &pt);
+	} while (as_geo_consume(ps, ','));
+
+	if (! as_geo_consume(ps, ']')) {
+		return false;
+	}
+
+	// Rings are closed and have at least three distinct vertices.
+	uint32_t count = region->points.size - start;
+
+	if (count < 4) {
+		return false;
+	}
+
+	as_geo_point* first = as_vector_get(&region->points, start);
+	as_geo_point* last = as_vector_get(&region->points, start + count - 1);
+
+	if (first->lng != last->lng || first->lat != last->lat) {
+		return false;
+	}
+
+	uint32_t ring[2] = {start, count};
+	as_vector_append(&region->rings, ring);
+	return true;
+}
+
+static bool
+as_geo_parse_polygon(as_geo_parser* ps, as_geo_region* region)
+{
+	uint32_t start = region->rings.size;
+
+	if (! as_geo_consume(ps, '[')) {
+		return false;
+	}
+
+	do {
+		if (! as_geo_parse_ring(ps, region)) {
+			return false;
+		}
+	} while (as_geo_consume(ps, ','));
+
+	if (! as_geo_consume(ps, ']')) {
+		return false;
+	}
+
+	uint32_t polygon[2] = {start, region->rings.size - start};
+	as_vector_append(&region->polygons, polygon);
+	return true;
+}
+
+static bool
+as_geo_parse_coordinates(as_geo_parser* ps, as_geo_region* region)
+{
+	switch (region->type) {
+		case AS_GEO_REGION_POLYGON:
+			return as_geo_parse_polygon(ps, region);
+
+		case AS_GEO_REGION_MULTI_POLYGON:
+			if (! as_geo_consume(ps, '[')) {
+				return false;
+			}
+
+			do {
+				if (! as_geo_parse_polygon(ps, region)) {
+					return false;
+				}
+			} while (as_geo_consume(ps, ','));
+
+			return as_geo_consume(ps, ']');
+
+		case AS_GEO_REGION_CIRCLE:
+			return as_geo_consume(ps, '[') && as_geo_parse_point(ps, &region->center) &&
+				as_geo_consume(ps, ',') && as_geo_parse_number(ps, &region->radius) &&
+				as_geo_consume(ps, ']') && region->radius >= 0.0;
+	}
+	return false;
+}
+
+static bool
+as_geo_ring_contains(const as_geo_point* pts, uint32_t n, double lng, double lat)
+{
+	// Even-odd ray casting. The closing vertex repeats the first vertex and is skipped.
+	bool inside = false;
+	n--;
+
+	for (uint32_t i = 0, j = n - 1; i < n; j = i++) {
+		const as_geo_point* a = &pts[i];
+		const as_geo_point* b = &pts[j];
+
+		if ((a->lat > lat) != (b->lat > lat) &&
+			lng < (b->lng - a->lng) * (lat - a->lat) / (b->lat - a->lat) + a->lng) {
+			inside = ! inside;
+		}
+	}
+	return inside;
+}
+
+static bool
+as_geo_polygon_contains(const as_geo_region* region, uint32_t index, double lng, double lat)
+{
+	const uint32_t* polygon = (const uint32_t*)region->polygons.list + index * 2;
+	const uint32_t* rings = (const uint32_t*)region->rings.list;
+	const as_geo_point* pts = (const as_geo_point*)region->points.list;
+
+	for (uint32_t i = 0; i < polygon[1]; i++) {
+		const uint32_t* ring = &rings[(polygon[0] + i) * 2];
+		bool inside = as_geo_ring_contains(&pts[ring[0]], ring[1], lng, lat);
+
+		// Point must be inside the exterior ring and outside all holes.
+		if (inside != (i == 0)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool
+as_geo_circle_contains(const as_geo_region* region, double lng, double lat)
+{
+	double rad = GEO_PI / 180.0;
+	double lat1 = region->center.lat * rad;
+	double lat2 = lat * rad;
+	double dlat = (lat - region->center.lat) * rad;
+	double dlng = (lng - region->center.lng) * rad;
+	double h = sin(dlat / 2) * sin(dlat / 2) +
+		cos(lat1) * cos(lat2) * sin(dlng / 2) * sin(dlng / 2);
+	double dist = 2 * GEO_EARTH_RADIUS * asin(fmin(1.0, sqrt(h)));
+	return dist <= region->radius;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_geo_region*
+as_geo_region_create(as_error* err, const char* geojson)
+{
+	as_geo_region* region = cf_malloc(sizeof(as_geo_region));
+	region->json = NULL;
+	region->encoded = NULL;
+	as_vector_init(&region->points, sizeof(as_geo_point), 16);
+	as_vector_init(&region->rings, sizeof(uint32_t) * 2, 2);
+	as_vector_init(&region->polygons, sizeof(uint32_t) * 2, 1);
+
+	as_geo_parser ps = {.p = geojson, .depth = 0};
+	const char* type;
+	uint32_t type_len;
+	const char* coords;
+
+	if (! as_geo_parse_object(&ps, &type, &type_len, &coords)) {
+		as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Invalid GeoJSON region");
+		as_geo_region_destroy(region);
+		return NULL;
+	}
+
+	if (as_geo_type_equals(type, type_len, "Polygon")) {
+		region->type = AS_GEO_REGION_POLYGON;
+	}
+	else if (as_geo_type_equals(type, type_len, "MultiPolygon")) {
+		region->type = AS_GEO_REGION_MULTI_POLYGON;
+	}
+	else if (as_geo_type_equals(type, type_len, "AeroCircle")) {
+		region->type = AS_GEO_REGION_CIRCLE;
+	}
+	else {
+		as_error_update(err, AEROSPIKE_ERR_PARAM, "Unsupported GeoJSON region type: %.*s",
+			(int)type_len, type);
+		as_geo_region_destroy(region);
+		return NULL;
+	}
+
+	ps.p = coords;
+
+	if (! as_geo_parse_coordinates(&ps, region)) {
+		as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Invalid GeoJSON region coordinates");
+		as_geo_region_destroy(region);
+		return NULL;
+	}
+
+	uint32_t len = (uint32_t)strlen(geojson);
+	region->json_size = len;
+	region->json = cf_malloc(len + 1);
+	memcpy(region->json, geojson, len + 1);
+
+	// Same encoding as the begin and end values written for a geo range filter.
+	region->encoded_size = 1 + (4 + len) * 2;
+	uint8_t* p = cf_malloc(region->encoded_size);
+	region->encoded = p;
+	*p++ = AS_BYTES_GEOJSON;
+
+	for (uint32_t i = 0; i < 2; i++) {
+		*(uint32_t*)p = cf_swap_to_be32(len);
+		p += sizeof(uint32_t);
+		memcpy(p, geojson, len);
+		p += len;
+	}
+	return region;
+}
+
+void
+as_geo_region_destroy(as_geo_region* region)
+{
+	as_vector_destroy(&region->points);
+	as_vector_destroy(&region->rings);
+	as_vector_destroy(&region->polygons);
+	cf_free(region->json);
+	cf_free(region->encoded);
+	cf_free(region);
+}
+
+bool
+as_geo_region_contains_point(const as_geo_region* region, double lng, double lat)
+{
+	if (region->type == AS_GEO_REGION_CIRCLE) {
+		return as_geo_circle_contains(region, lng, lat);
+	}
+
+	for (uint32_t i = 0; i < region->polygons.size; i++) {
+		if (as_geo_polygon_contains(region, i, lng, lat)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool
+as_geo_region_contains_geojson(const as_geo_region* region, const char* geojson)
+{
+	as_geo_parser ps = {.p = geojson, .depth = 0};
+	const char* type;
+	uint32_t type_len;
+	const char* coords;
+
+	if (! as_geo_parse_object(&ps, &type, &type_len, &coords) ||
+		! as_geo_type_equals(type, type_len, "Point")) {
+		return false;
+	}
+
+	ps.p = coords;
+
+	as_geo_point pt;
+
+	if (! as_geo_parse_point(&ps, &pt)) {
+		return false;
+	}
+	return as_geo_region_contains_point(region, pt.lng, pt.lat);
+}
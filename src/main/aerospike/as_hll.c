@@ -0,0 +1,383 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_hll.h>
+#include <citrusleaf/alloc.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AS_HLL_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define AS_HLL_NEON 1
+#include <arm_neon.h>
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Server HLL bin layout is flags(1) + n_index_bits(1) + n_minhash_bits(1) +
+// cached cardinality(8) followed by the registers. Each register holds a 6 bit HLL value
+// followed by n_minhash_bits MinHash bits. Registers are packed most significant bit first.
+#define HLL_HEADER_SIZE 11
+#define HLL_BITS 6
+#define HLL_MAX_MINHASH_BITS 51
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+#if defined(AS_HLL_X86)
+
+__attribute__((target("avx2")))
+static uint32_t
+as_hll_max_avx2(uint8_t* dst, const uint8_t* src, uint32_t n)
+{
+	uint32_t i = 0;
+
+	for (; i + 32 <= n; i += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_max_epu8(a, b));
+	}
+	return i;
+}
+
+static uint32_t
+as_hll_max_sse2(uint8_t* dst, const uint8_t* src, uint32_t n)
+{
+	uint32_t i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_max_epu8(a, b));
+	}
+	return i;
+}
+
+#elif defined(AS_HLL_NEON)
+
+static uint32_t
+as_hll_max_neon(uint8_t* dst, const uint8_t* src, uint32_t n)
+{
+	uint32_t i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+	}
+	return i;
+}
+
+#endif
+
+static void
+as_hll_max(uint8_t* dst, const uint8_t* src, uint32_t n)
+{
+	uint32_t i = 0;
+
+#if defined(AS_HLL_X86)
+	if (__builtin_cpu_supports("avx2")) {
+		i = as_hll_max_avx2(dst, src, n);
+	}
+	else {
+		i = as_hll_max_sse2(dst, src, n);
+	}
+#elif defined(AS_HLL_NEON)
+	i = as_hll_max_neon(dst, src, n);
+#endif
+
+	for (; i < n; i++) {
+		if (src[i] > dst[i]) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+static as_status
+as_hll_parse(as_error* err, const as_bytes* bytes, uint8_t* n_index_bits, uint8_t* n_minhash_bits)
+{
+	if (bytes->type != AS_BYTES_HLL) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid HLL bytes type: %d",
+			bytes->type);
+	}
+
+	if (bytes->size < HLL_HEADER_SIZE) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid HLL size: %u", bytes->size);
+	}
+
+	uint8_t ib = bytes->value[1];
+	uint8_t mb = bytes->value[2];
+
+	if (ib < AS_HLL_MIN_INDEX_BITS || ib > AS_HLL_MAX_INDEX_BITS || mb > HLL_MAX_MINHASH_BITS) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid HLL bits: index %u minhash %u",
+			ib, mb);
+	}
+
+	uint64_t reg_bytes = (((uint64_t)1 << ib) * (HLL_BITS + mb) + 7) / 8;
+
+	if (bytes->size < HLL_HEADER_SIZE + reg_bytes) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid HLL size: %u", bytes->size);
+	}
+
+	*n_index_bits = ib;
+	*n_minhash_bits = mb;
+	return AEROSPIKE_OK;
+}
+
+// Merge HLL values of packed server registers into one byte per register.
+static void
+as_hll_merge_packed(uint8_t* dst, uint32_t n_registers, const uint8_t* src, uint8_t n_minhash_bits)
+{
+	if (n_minhash_bits == 0) {
+		// Four 6 bit registers per three bytes. The register count is a multiple of four.
+		for (uint32_t i = 0; i < n_registers; i += 4) {
+			uint32_t w = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+			uint8_t v[4] = {
+				(uint8_t)(w >> 18), (uint8_t)((w >> 12) & 0x3F), (uint8_t)((w >> 6) & 0x3F),
+				(uint8_t)(w & 0x3F)
+			};
+
+			for (uint32_t j = 0; j < 4; j++) {
+				if (v[j] > dst[i + j]) {
+					dst[i + j] = v[j];
+				}
+			}
+			src += 3;
+		}
+		return;
+	}
+
+	uint32_t reg_bits = HLL_BITS + n_minhash_bits;
+
+	for (uint32_t i = 0; i < n_registers; i++) {
+		uint64_t bit = (uint64_t)i * reg_bits;
+		const uint8_t* p = src + (bit >> 3);
+		uint32_t shift = (uint32_t)(bit & 7);
+
+		// The 6 HLL bits only extend into the next byte when shift is greater than 2.
+		uint32_t w = (uint32_t)p[0] << 8;
+
+		if (shift > 2) {
+			w |= p[1];
+		}
+		uint8_t v = (uint8_t)((w >> (10 - shift)) & 0x3F);
+
+		if (v > dst[i]) {
+			dst[i] = v;
+		}
+	}
+}
+
+// Cardinality estimator functions from "New cardinality estimation algorithms for
+// HyperLogLog sketches" (Ertl).
+static double
+as_hll_sigma(double x)
+{
+	if (x == 1.0) {
+		return INFINITY;
+	}
+
+	double y = 1.0;
+	double z = x;
+	double prev;
+
+	do {
+		x *= x;
+		prev = z;
+		z += x * y;
+		y += y;
+	} while (z != prev);
+
+	return z;
+}
+
+static double
+as_hll_tau(double x)
+{
+	if (x == 0.0 || x == 1.0) {
+		return 0.0;
+	}
+
+	double y = 1.0;
+	double z = 1.0 - x;
+	double prev;
+
+	do {
+		x = sqrt(x);
+		prev = z;
+		y *= 0.5;
+		z -= (1.0 - x) * (1.0 - x) * y;
+	} while (z != prev);
+
+	return z / 3.0;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+as_hll_init(as_hll* hll, as_error* err, uint8_t n_index_bits)
+{
+	if (n_index_bits < AS_HLL_MIN_INDEX_BITS || n_index_bits > AS_HLL_MAX_INDEX_BITS) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid HLL index bits: %u",
+			n_index_bits);
+	}
+
+	hll->n_index_bits = n_index_bits;
+	hll->n_registers = (uint32_t)1 << n_index_bits;
+	hll->registers = cf_calloc(hll->n_registers, 1);
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_hll_init_bytes(as_hll* hll, as_error* err, const as_bytes* bytes)
+{
+	uint8_t ib;
+	uint8_t mb;
+	as_status status = as_hll_parse(err, bytes, &ib, &mb);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	as_hll_init(hll, err, ib);
+	as_hll_merge_packed(hll->registers, hll->n_registers, bytes->value + HLL_HEADER_SIZE, mb);
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_hll_merge_bytes(as_hll* hll, as_error* err, const as_bytes* bytes)
+{
+	uint8_t ib;
+	uint8_t mb;
+	as_status status = as_hll_parse(err, bytes, &ib, &mb);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (ib != hll->n_index_bits) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "HLL index bits mismatch: %u != %u",
+			ib, hll->n_index_bits);
+	}
+
+	as_hll_merge_packed(hll->registers, hll->n_registers, bytes->value + HLL_HEADER_SIZE, mb);
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_hll_merge(as_hll* hll, as_error* err, const as_hll* other)
+{
+	if (other->n_index_bits != hll->n_index_bits) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "HLL index bits mismatch: %u != %u",
+			other->n_index_bits, hll->n_index_bits);
+	}
+
+	as_hll_max(hll->registers, other->registers, hll->n_registers);
+	return AEROSPIKE_OK;
+}
+
+uint64_t
+as_hll_cardinality(const as_hll* hll)
+{
+	uint32_t q = 64 - hll->n_index_bits;
+	uint32_t counts[64] = {0};
+
+	for (uint32_t i = 0; i < hll->n_registers; i++) {
+		uint32_t v = hll->registers[i];
+		counts[v <= q + 1 ? v : q + 1]++;
+	}
+
+	double m = (double)hll->n_registers;
+	double z = m * as_hll_tau((m - counts[q + 1]) / m);
+
+	for (uint32_t k = q; k >= 1; k--) {
+		z += counts[k];
+		z *= 0.5;
+	}
+
+	z += m * as_hll_sigma(counts[0] / m);
+	return (uint64_t)llround(m * m / (2.0 * log(2.0) * z));
+}
+
+as_status
+as_hll_union_count(
+	as_error* err, const as_bytes* const* values, uint32_t n_values, uint64_t* count
+	)
+{
+	if (n_values == 0) {
+		*count = 0;
+		return AEROSPIKE_OK;
+	}
+
+	as_hll hll;
+	as_status status = as_hll_init_bytes(&hll, err, values[0]);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	for (uint32_t i = 1; i < n_values; i++) {
+		status = as_hll_merge_bytes(&hll, err, values[i]);
+
+		if (status != AEROSPIKE_OK) {
+			as_hll_destroy(&hll);
+			return status;
+		}
+	}
+
+	*count = as_hll_cardinality(&hll);
+	as_hll_destroy(&hll);
+	return AEROSPIKE_OK;
+}
+
+as_bytes*
+as_hll_to_bytes(const as_hll* hll)
+{
+	uint32_t size = HLL_HEADER_SIZE + hll->n_registers / 4 * 3;
+	uint8_t* buf = cf_malloc(size);
+
+	// Flags and cached cardinality are cleared, so the server computes the cardinality.
+	memset(buf, 0, HLL_HEADER_SIZE);
+	buf[1] = hll->n_index_bits;
+
+	uint8_t* p = buf + HLL_HEADER_SIZE;
+	const uint8_t* r = hll->registers;
+
+	for (uint32_t i = 0; i < hll->n_registers; i += 4) {
+		uint32_t w = ((uint32_t)r[i] << 18) | ((uint32_t)r[i + 1] << 12) |
+			((uint32_t)r[i + 2] << 6) | r[i + 3];
+		*p++ = (uint8_t)(w >> 16);
+		*p++ = (uint8_t)(w >> 8);
+		*p++ = (uint8_t)w;
+	}
+
+	as_bytes* bytes = as_bytes_new_wrap(buf, size, true);
+	bytes->type = AS_BYTES_HLL;
+	return bytes;
+}
+
+void
+as_hll_destroy(as_hll* hll)
+{
+	cf_free(hll->registers);
+	hll->registers = NULL;
+	hll->n_registers = 0;
+}
@@ -44,7 +44,7 @@ as_operations_hll_init_mh(
 	as_pack_int64(&pk, index_bit_count);
 	as_pack_int64(&pk, mh_bit_count);
 	as_hll_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_MODIFY);
 }
 
@@ -60,7 +60,7 @@ as_operations_hll_add_mh(
 	as_pack_int64(&pk, index_bit_count);
 	as_pack_int64(&pk, mh_bit_count);
 	as_hll_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_MODIFY);
 }
 
@@ -74,7 +74,7 @@ as_operations_hll_set_union(
 	as_cdt_pack_header(&pk, ctx, AS_HLL_OP_UNION, 2);
 	as_pack_val(&pk, (as_val*)list);
 	as_hll_pack_policy(&pk, policy);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_MODIFY);
 }
 
@@ -85,7 +85,7 @@ as_operations_hll_refresh_count(
 {
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, AS_HLL_OP_REFRESH_COUNT, 0);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_MODIFY);
 }
 
@@ -97,7 +97,7 @@ as_operations_hll_fold(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, AS_HLL_OP_FOLD, 1);
 	as_pack_int64(&pk, index_bit_count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_MODIFY);
 }
 
@@ -108,7 +108,7 @@ as_operations_hll_read(
 {
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, command, 0);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_READ);
 }
 
@@ -120,6 +120,6 @@ as_operations_hll_read_list(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, command, 1);
 	as_pack_val(&pk, (as_val*)list);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_HLL_READ);
 }
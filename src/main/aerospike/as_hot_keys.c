@@ -0,0 +1,242 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_hot_keys.h>
+#include <citrusleaf/alloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline uint32_t
+as_hot_keys_index(const uint8_t* digest, uint32_t row)
+{
+	// Digests are uniformly distributed, so each row uses a different digest word as its hash.
+	// The first word is skipped because it also determines the partition.
+	uint32_t word;
+	memcpy(&word, digest + (row + 1) * sizeof(uint32_t), sizeof(uint32_t));
+	return row * AS_HOT_KEYS_WIDTH + (word & (AS_HOT_KEYS_WIDTH - 1));
+}
+
+static void
+as_hot_keys_sift_up(as_hot_key* heap, uint32_t i)
+{
+	as_hot_key item = heap[i];
+
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+
+		if (heap[parent].count <= item.count) {
+			break;
+		}
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = item;
+}
+
+static void
+as_hot_keys_sift_down(as_hot_key* heap, uint32_t size, uint32_t i)
+{
+	as_hot_key item = heap[i];
+
+	while (true) {
+		uint32_t child = i * 2 + 1;
+
+		if (child >= size) {
+			break;
+		}
+
+		if (child + 1 < size && heap[child + 1].count < heap[child].count) {
+			child++;
+		}
+
+		if (item.count <= heap[child].count) {
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = item;
+}
+
+// Must hold heap lock.
+static void
+as_hot_keys_update(as_hot_keys* hk, const uint8_t* digest, const char* set, uint32_t count)
+{
+	as_hot_key* heap = hk->heap;
+
+	for (uint32_t i = 0; i < hk->size; i++) {
+		if (memcmp(heap[i].digest, digest, AS_DIGEST_VALUE_SIZE) == 0) {
+			heap[i].count = count;
+			as_hot_keys_sift_down(heap, hk->size, i);
+			goto Done;
+		}
+	}
+
+	as_hot_key* item;
+
+	if (hk->size < hk->capacity) {
+		item = &heap[hk->size];
+	}
+	else if (count > heap[0].count) {
+		item = &heap[0];
+	}
+	else {
+		return;
+	}
+
+	memcpy(item->digest, digest, AS_DIGEST_VALUE_SIZE);
+	as_strncpy(item->set, set ? set : "", sizeof(item->set));
+	item->count = count;
+
+	if (hk->size < hk->capacity) {
+		as_hot_keys_sift_up(heap, hk->size);
+		as_store_uint32(&hk->size, hk->size + 1);
+	}
+	else {
+		as_hot_keys_sift_down(heap, hk->size, 0);
+	}
+
+Done:
+	as_store_uint32(&hk->min, (hk->size == hk->capacity)? heap[0].count : 0);
+}
+
+static int
+as_hot_keys_compare(const void* v1, const void* v2)
+{
+	uint32_t c1 = ((const as_hot_key*)v1)->count;
+	uint32_t c2 = ((const as_hot_key*)v2)->count;
+	return (c1 < c2) - (c1 > c2);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_hot_keys*
+as_hot_keys_create(uint32_t capacity)
+{
+	if (capacity > AS_HOT_KEYS_MAX) {
+		capacity = AS_HOT_KEYS_MAX;
+	}
+
+	as_hot_keys* hk = cf_malloc(sizeof(as_hot_keys));
+	memset(hk, 0, sizeof(as_hot_keys));
+	pthread_mutex_init(&hk->lock, NULL);
+	hk->heap = cf_malloc(sizeof(as_hot_key) * capacity);
+	hk->capacity = capacity;
+	return hk;
+}
+
+void
+as_hot_keys_destroy(as_hot_keys* hk)
+{
+	pthread_mutex_destroy(&hk->lock);
+	cf_free(hk->heap);
+	cf_free(hk);
+}
+
+void
+as_hot_keys_add(as_hot_keys* hk, const uint8_t* digest, const char* set)
+{
+	uint32_t count = UINT32_MAX;
+
+	for (uint32_t row = 0; row < AS_HOT_KEYS_DEPTH; row++) {
+		uint32_t v = as_aaf_uint32(&hk->sketch[as_hot_keys_index(digest, row)], 1);
+
+		if (v < count) {
+			count = v;
+		}
+	}
+
+	// Only lock when the key is heavy enough to enter the heap.
+	if (as_load_uint32(&hk->size) == hk->capacity && count <= as_load_uint32(&hk->min)) {
+		return;
+	}
+
+	if (pthread_mutex_trylock(&hk->lock) != 0) {
+		return;
+	}
+	as_hot_keys_update(hk, digest, set, count);
+	pthread_mutex_unlock(&hk->lock);
+}
+
+void
+as_hot_keys_decay(as_hot_keys* hk)
+{
+	// Increments that race with the decay may be lost. This only lowers estimates slightly.
+	for (uint32_t i = 0; i < AS_HOT_KEYS_DEPTH * AS_HOT_KEYS_WIDTH; i++) {
+		uint32_t v = as_load_uint32(&hk->sketch[i]);
+
+		if (v) {
+			as_store_uint32(&hk->sketch[i], v >> 1);
+		}
+	}
+
+	pthread_mutex_lock(&hk->lock);
+
+	// Halving every count preserves heap order.
+	for (uint32_t i = 0; i < hk->size; i++) {
+		hk->heap[i].count >>= 1;
+	}
+	as_store_uint32(&hk->min, (hk->size == hk->capacity)? hk->heap[0].count : 0);
+	pthread_mutex_unlock(&hk->lock);
+}
+
+void
+as_hot_keys_clear(as_hot_keys* hk)
+{
+	for (uint32_t i = 0; i < AS_HOT_KEYS_DEPTH * AS_HOT_KEYS_WIDTH; i++) {
+		as_store_uint32(&hk->sketch[i], 0);
+	}
+
+	pthread_mutex_lock(&hk->lock);
+	as_store_uint32(&hk->size, 0);
+	as_store_uint32(&hk->min, 0);
+	pthread_mutex_unlock(&hk->lock);
+}
+
+uint32_t
+as_hot_keys_get(as_hot_keys* hk, as_hot_key* out, uint32_t max)
+{
+	pthread_mutex_lock(&hk->lock);
+
+	uint32_t size = hk->size;
+
+	if (size == 0) {
+		pthread_mutex_unlock(&hk->lock);
+		return 0;
+	}
+
+	as_hot_key* keys = cf_malloc(sizeof(as_hot_key) * size);
+	memcpy(keys, hk->heap, sizeof(as_hot_key) * size);
+	pthread_mutex_unlock(&hk->lock);
+
+	qsort(keys, size, sizeof(as_hot_key), as_hot_keys_compare);
+
+	uint32_t n = 0;
+
+	// Keys that decayed to zero are no longer hot.
+	while (n < size && n < max && keys[n].count > 0) {
+		out[n] = keys[n];
+		n++;
+	}
+	cf_free(keys);
+	return n;
+}
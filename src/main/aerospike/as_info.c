@@ -150,6 +150,25 @@ as_info_command_node(
 	return status;
 }
 
+static as_event_command*
+as_info_command_async_create(
+	as_policy_info* policy, as_node* node, const char* command, as_async_info_listener listener,
+	void* udata, as_event_loop* event_loop
+	)
+{
+	size_t size = strlen(command);
+	as_event_command* cmd = as_async_info_command_create(node, policy, listener, udata, event_loop, size);
+	uint8_t* p = cmd->buf + sizeof(uint64_t);
+
+	memcpy(p, command, size);
+	p += size;
+	size = p - cmd->buf;
+	uint64_t proto = (size - 8) | ((uint64_t)AS_PROTO_VERSION << 56) | ((uint64_t)AS_INFO_MESSAGE_TYPE << 48);
+	*(uint64_t*)cmd->buf = cf_swap_to_be64(proto);
+	cmd->write_len = (uint32_t)size;
+	return cmd;
+}
+
 as_status
 as_info_command_node_async(
 	aerospike* as, as_error* err, as_policy_info* policy, as_node* node, const char* command,
@@ -163,20 +182,27 @@ as_info_command_node_async(
 		policy = &config->policies.info;
 	}
 
-	size_t size = strlen(command);
-	as_event_command* cmd = as_async_info_command_create(node, policy, listener, udata, event_loop, size);
-	uint8_t* p = cmd->buf + sizeof(uint64_t);
-
-	memcpy(p, command, size);
-	p += size;
-	size = p - cmd->buf;
-	uint64_t proto = (size - 8) | ((uint64_t)AS_PROTO_VERSION << 56) | ((uint64_t)AS_INFO_MESSAGE_TYPE << 48);
-	*(uint64_t*)cmd->buf = cf_swap_to_be64(proto);
-	cmd->write_len = (uint32_t)size;
+	as_event_command* cmd = as_info_command_async_create(policy, node, command, listener, udata,
+		event_loop);
 
 	return as_event_command_execute(cmd, err);
 }
 
+as_status
+as_info_command_node_async_multi(
+	as_error* err, as_policy_info* policy, as_node* node, const char* command, uint32_t delay_ms,
+	as_async_info_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_error_reset(err);
+
+	as_event_command* cmd = as_info_command_async_create(policy, node, command, listener, udata,
+		event_loop);
+
+	cmd->parse_results = as_event_command_parse_info_multi;
+	return as_event_command_execute_delay(cmd, delay_ms, err);
+}
+
 as_status
 as_info_command_random_node(aerospike* as, as_error* err, as_policy_info* policy, char* command)
 {
@@ -376,7 +402,8 @@ as_info_create_socket(
 {
 	// This function can't authenticate because node and session token are not specified.
 	as_tls_context* ctx = as_socket_get_tls_context(cluster->tls_ctx);
-	return as_socket_create_and_connect(sock, err, addr, ctx, tls_name, deadline_ms);	
+	return as_socket_create_and_connect(sock, err, addr, &cluster->socket_options, ctx, tls_name,
+		deadline_ms);
 }
 
 as_status
@@ -465,13 +492,7 @@ as_info_parse_multi_response(char* buf, as_vector* /* <as_name_value> */ values)
 			begin = ++p;
 			
 			// Parse value.
-			while (*p) {
-				if (*p == '\n') {
-					*p = 0;
-					break;
-				}
-				p++;
-			}
+			p = as_info_terminate(p, "\n");
 			nv.value = begin;
 			as_vector_append(values, &nv);
 			begin = ++p;
@@ -15,12 +15,56 @@
  * the License.
  */
 #include <aerospike/as_job.h>
+#include <aerospike/as_cluster.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_socket.h>
+#include <aerospike/as_string.h>
 #include <citrusleaf/alloc.h>
 #include <stdlib.h>
 
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Info command buffer size for a single job.
+#define AS_JOB_COMMAND_SIZE 128
+
+// Initial delay between async job status rounds.
+#define AS_JOB_WAIT_MIN_MS 50
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct as_job_waiter_s {
+	struct as_job_waiter_s* next;
+	as_async_job_listener listener;
+	void* udata;
+	uint64_t job_id;
+	uint32_t interval_ms;
+	as_job_info info;
+	as_error err;
+	char module[16];
+} as_job_waiter;
+
+typedef struct as_job_monitor_s {
+	pthread_mutex_t lock;
+	as_cluster* cluster;
+	as_job_waiter* pending; // Waiters added since the current round started.
+	as_job_waiter* round;   // Waiters checked by the current round.
+	as_policy_info policy;
+	uint32_t delay_ms;
+	uint32_t count;         // Node commands outstanding in the current round.
+	bool running;
+	bool closed;
+} as_job_monitor;
+
+typedef struct {
+	as_job_monitor* monitor;
+	as_node* node;
+} as_job_round_node;
+
 //---------------------------------
 // Static Functions
 //---------------------------------
@@ -114,6 +158,291 @@ as_job_process(char* response, as_job_info* info)
 	}
 }
 
+static void
+as_job_command(as_node* node, const char* module, uint64_t job_id, char* command)
+{
+	if (node->features & AS_FEATURES_PARTITION_QUERY) {
+		// query-show works for both scan and query.
+		snprintf(command, AS_JOB_COMMAND_SIZE, "query-show:trid=%" PRIu64 "\n", job_id);
+	}
+	else if (node->features & AS_FEATURES_QUERY_SHOW) {
+		// scan-show and query-show are separate.
+		snprintf(command, AS_JOB_COMMAND_SIZE, "%s-show:trid=%" PRIu64 "\n", module, job_id);
+	}
+	else {
+		// old job monitor syntax.
+		snprintf(command, AS_JOB_COMMAND_SIZE, "jobs:module=%s;cmd=get-job;trid=%" PRIu64 "\n",
+			module, job_id);
+	}
+}
+
+static void as_job_monitor_start(as_job_monitor* m, as_event_loop* event_loop);
+
+static void
+as_job_waiters_notify(as_job_waiter* w, as_error* err, as_event_loop* event_loop)
+{
+	while (w) {
+		as_job_waiter* next = w->next;
+
+		if (err) {
+			w->listener(err, &w->info, w->udata, event_loop);
+		}
+		else {
+			w->listener(w->err.code ? &w->err : NULL, &w->info, w->udata, event_loop);
+		}
+		cf_free(w);
+		w = next;
+	}
+}
+
+static void
+as_job_monitor_free(as_job_monitor* m, as_job_waiter* waiters)
+{
+	as_error err;
+	as_error_set_message(&err, AEROSPIKE_ERR_CLIENT, "Cluster has been closed");
+	as_job_waiters_notify(waiters, &err, NULL);
+	pthread_mutex_destroy(&m->lock);
+	cf_free(m);
+}
+
+static void
+as_job_monitor_end(as_job_monitor* m, as_event_loop* event_loop)
+{
+	// Only this thread references the round list after the last node command completes.
+	as_job_waiter* done = NULL;
+	as_job_waiter* remain = NULL;
+	as_job_waiter* w = m->round;
+
+	while (w) {
+		as_job_waiter* next = w->next;
+
+		if (w->err.code || w->info.status != AS_JOB_STATUS_INPROGRESS) {
+			w->next = done;
+			done = w;
+		}
+		else {
+			w->next = remain;
+			remain = w;
+		}
+		w = next;
+	}
+	m->round = remain;
+
+	as_job_waiters_notify(done, NULL, event_loop);
+
+	// Later rounds let each node command choose its event loop.
+	as_job_monitor_start(m, NULL);
+}
+
+static void
+as_job_parse_response(as_job_monitor* m, as_node* node, char* response)
+{
+	char command[AS_JOB_COMMAND_SIZE];
+	char* p = response;
+
+	// Response contains one "<command>\t<value>\n" line per job.
+	while (*p) {
+		char* name = p;
+		char* value = NULL;
+
+		while (*p && *p != '\n') {
+			if (*p == '\t' && ! value) {
+				*p = 0;
+				value = p + 1;
+			}
+			p++;
+		}
+
+		if (*p) {
+			*p++ = 0;
+		}
+
+		if (! value) {
+			continue;
+		}
+
+		for (as_job_waiter* w = m->round; w; w = w->next) {
+			as_job_command(node, w->module, w->job_id, command);
+
+			// Command includes trailing newline.
+			size_t len = strlen(command) - 1;
+
+			if (strncmp(name, command, len) != 0 || name[len] != 0) {
+				continue;
+			}
+
+			if (strncmp(value, "ERROR:", 6) == 0) {
+				as_status status = (as_status)atoi(value + 6);
+
+				if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+					// Job is not running on this node.
+					if (w->info.status == AS_JOB_STATUS_UNDEF) {
+						w->info.status = AS_JOB_STATUS_COMPLETED;
+					}
+				}
+				else if (! w->err.code) {
+					as_error_update(&w->err, status ? status : AEROSPIKE_ERR_SERVER,
+						"Job status failed from %s: %s", as_node_get_address_string(node), value);
+				}
+			}
+			else {
+				as_job_process(value, &w->info);
+			}
+			break;
+		}
+	}
+}
+
+static void
+as_job_round_complete(
+	as_job_round_node* rn, as_error* err, char* response, as_event_loop* event_loop
+	)
+{
+	as_job_monitor* m = rn->monitor;
+
+	pthread_mutex_lock(&m->lock);
+
+	if (err) {
+		// Node failure fails every job in the round, as in aerospike_job_wait().
+		for (as_job_waiter* w = m->round; w; w = w->next) {
+			if (! w->err.code) {
+				as_error_copy(&w->err, err);
+			}
+		}
+	}
+	else {
+		as_job_parse_response(m, rn->node, response);
+	}
+
+	bool done = --m->count == 0;
+	pthread_mutex_unlock(&m->lock);
+	cf_free(rn);
+
+	if (done) {
+		as_job_monitor_end(m, event_loop);
+	}
+}
+
+static void
+as_job_round_listener(as_error* err, char* response, void* udata, as_event_loop* event_loop)
+{
+	as_job_round_complete(udata, err, response, event_loop);
+}
+
+static void
+as_job_monitor_start(as_job_monitor* m, as_event_loop* event_loop)
+{
+	pthread_mutex_lock(&m->lock);
+
+	// Append waiters added during the last round.
+	as_job_waiter* w = m->pending;
+
+	while (w) {
+		as_job_waiter* next = w->next;
+		w->next = m->round;
+		m->round = w;
+		w = next;
+	}
+	m->pending = NULL;
+
+	if (m->closed) {
+		as_job_waiter* waiters = m->round;
+		m->round = NULL;
+		pthread_mutex_unlock(&m->lock);
+		as_job_monitor_free(m, waiters);
+		return;
+	}
+
+	if (! m->round) {
+		m->running = false;
+		pthread_mutex_unlock(&m->lock);
+		return;
+	}
+
+	// Delay doubles each round up to the smallest interval of the outstanding jobs.
+	uint32_t n_waiters = 0;
+	uint32_t max_ms = UINT32_MAX;
+
+	for (w = m->round; w; w = w->next) {
+		w->info.status = AS_JOB_STATUS_UNDEF;
+		w->info.progress_pct = 0;
+		w->info.records_read = 0;
+
+		if (w->interval_ms < max_ms) {
+			max_ms = w->interval_ms;
+		}
+		n_waiters++;
+	}
+
+	uint32_t delay = m->delay_ms < max_ms ? m->delay_ms : max_ms;
+	m->delay_ms = (delay < max_ms / 2) ? delay * 2 : max_ms;
+
+	as_nodes* nodes = as_nodes_reserve(m->cluster);
+	uint32_t n_nodes = nodes->size;
+
+	if (n_nodes == 0) {
+		as_nodes_release(nodes);
+
+		as_error err;
+		as_error_set_message(&err, AEROSPIKE_ERR_CLUSTER, "Cluster is empty");
+
+		for (w = m->round; w; w = w->next) {
+			as_error_copy(&w->err, &err);
+		}
+		m->count = 1;
+		pthread_mutex_unlock(&m->lock);
+
+		as_job_round_node* rn = cf_malloc(sizeof(as_job_round_node));
+		rn->monitor = m;
+		rn->node = NULL;
+		as_job_round_complete(rn, &err, NULL, NULL);
+		return;
+	}
+
+	// Build all node requests before the first one is sent because the round list must not
+	// be referenced outside the lock after that.
+	size_t capacity = (size_t)n_waiters * AS_JOB_COMMAND_SIZE + 1;
+	char** requests = cf_malloc(sizeof(char*) * n_nodes);
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		as_node* node = nodes->array[i];
+		char* request = cf_malloc(capacity);
+		char* p = request;
+
+		for (w = m->round; w; w = w->next) {
+			as_job_command(node, w->module, w->job_id, p);
+			p += strlen(p);
+		}
+		requests[i] = request;
+	}
+
+	as_policy_info policy = m->policy;
+	m->count = n_nodes;
+	pthread_mutex_unlock(&m->lock);
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		as_node* node = nodes->array[i];
+		as_job_round_node* rn = cf_malloc(sizeof(as_job_round_node));
+		rn->monitor = m;
+		rn->node = node;
+
+		// Reservation is released when the node command completes.
+		as_node_reserve(node);
+
+		as_error err;
+		as_status status = as_info_command_node_async_multi(&err, &policy, node, requests[i],
+			delay, as_job_round_listener, rn, event_loop);
+
+		cf_free(requests[i]);
+
+		if (status != AEROSPIKE_OK) {
+			as_job_round_complete(rn, &err, NULL, NULL);
+		}
+	}
+	cf_free(requests);
+	as_nodes_release(nodes);
+}
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -151,12 +480,7 @@ aerospike_job_info(
 		policy = &config->policies.info;
 	}
 
-	char cmd1[128];
-	char cmd2[128];
-	char cmd3[128];
-	sprintf(cmd1, "query-show:trid=%" PRIu64 "\n", job_id);
-	sprintf(cmd2, "%s-show:trid=%" PRIu64 "\n", module, job_id);
-	sprintf(cmd3, "jobs:module=%s;cmd=get-job;trid=%" PRIu64 "\n", module, job_id);
+	char command[AS_JOB_COMMAND_SIZE];
 
 	info->status = AS_JOB_STATUS_UNDEF;
 	info->progress_pct = 0;
@@ -169,20 +493,7 @@ aerospike_job_info(
 	
 	for (uint32_t i = 0; i < nodes->size; i++) {
 		as_node* node = nodes->array[i];
-		char* command;
-
-		if (node->features & AS_FEATURES_PARTITION_QUERY) {
-			// query-show works for both scan and query.
-			command = cmd1;
-		}
-		else if (node->features & AS_FEATURES_QUERY_SHOW) {
-			// scan-show and query-show are separate.
-			command = cmd2;
-		}
-		else {
-			// old job monitor syntax.
-			command = cmd3;
-		}
+		as_job_command(node, module, job_id, command);
 
 		char* response = 0;
 		
@@ -210,3 +521,86 @@ aerospike_job_info(
 	as_nodes_release(nodes);
 	return status;
 }
+
+as_status
+aerospike_job_wait_async(
+	aerospike* as, as_error* err, const as_policy_info* policy, const char* module, uint64_t job_id,
+	uint32_t interval_ms, as_async_job_listener listener, void* udata, as_event_loop* event_loop
+	)
+{
+	as_error_reset(err);
+
+	if (! policy) {
+		as_config* config = aerospike_load_config(as);
+		policy = &config->policies.info;
+	}
+
+	as_job_waiter* w = cf_malloc(sizeof(as_job_waiter));
+
+	if (as_strncpy(w->module, module, sizeof(w->module))) {
+		cf_free(w);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Module too long: %s", module);
+	}
+
+	w->listener = listener;
+	w->udata = udata;
+	w->job_id = job_id;
+	w->interval_ms = interval_ms ? interval_ms : 1000;
+	w->info.status = AS_JOB_STATUS_UNDEF;
+	w->info.progress_pct = 0;
+	w->info.records_read = 0;
+	as_error_init(&w->err);
+
+	as_job_monitor* m = as->cluster->job_monitor;
+
+	pthread_mutex_lock(&m->lock);
+	w->next = m->pending;
+	m->pending = w;
+	m->policy = *policy;
+
+	// A new job resets the backoff so it is checked soon.
+	m->delay_ms = AS_JOB_WAIT_MIN_MS;
+
+	bool start = ! m->running;
+	m->running = true;
+	pthread_mutex_unlock(&m->lock);
+
+	if (start) {
+		as_job_monitor_start(m, event_loop);
+	}
+	return AEROSPIKE_OK;
+}
+
+as_job_monitor*
+as_job_monitor_create(as_cluster* cluster)
+{
+	as_job_monitor* m = cf_malloc(sizeof(as_job_monitor));
+	pthread_mutex_init(&m->lock, NULL);
+	m->cluster = cluster;
+	m->pending = NULL;
+	m->round = NULL;
+	as_policy_info_init(&m->policy);
+	m->delay_ms = AS_JOB_WAIT_MIN_MS;
+	m->count = 0;
+	m->running = false;
+	m->closed = false;
+	return m;
+}
+
+void
+as_job_monitor_destroy(as_job_monitor* m)
+{
+	pthread_mutex_lock(&m->lock);
+	m->closed = true;
+
+	if (m->running) {
+		// The current round frees the monitor when it completes.
+		pthread_mutex_unlock(&m->lock);
+		return;
+	}
+
+	as_job_waiter* waiters = m->pending;
+	m->pending = NULL;
+	pthread_mutex_unlock(&m->lock);
+	as_job_monitor_free(m, waiters);
+}
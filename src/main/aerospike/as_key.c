@@ -15,14 +15,35 @@
  * the License.
  */
 #include <aerospike/as_key.h>
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_double.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_ripemd160.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_bytes.h>
 
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <citrusleaf/cf_digest.h>
+#include <pthread.h>
+#include <string.h>
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct as_key_name_s {
+	struct as_key_name_s* next;
+	char name[];
+} as_key_name;
+
+/******************************************************************************
+ * GLOBALS
+ *****************************************************************************/
+
+// Interned namespace and set names. Names are only prepended and never removed.
+static as_key_name* as_key_names = NULL;
+static pthread_mutex_t as_key_names_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /******************************************************************************
  * STATIC FUNCTIONS
@@ -46,6 +67,8 @@ as_key_cons(
 
 	key->_free = free;
 	key->valuep = (as_key_value *) valuep;
+	key->ns_handle = 0;
+	key->route_hint = 0;
 	
 	if (digest == NULL) {
 		key->digest.init = false;
@@ -58,6 +81,99 @@ as_key_cons(
 	return key;
 }
 
+static as_status
+as_key_digest_input(as_error* err, as_key* key, uint8_t* head, as_ripemd160_input* in)
+{
+	as_val* val = (as_val*)key->valuep;
+
+	in->data[0] = (const uint8_t*)key->set;
+	in->len[0] = (uint32_t)strlen(key->set);
+	in->data[1] = head;
+
+	switch (val->type) {
+		case AS_INTEGER: {
+			as_integer* v = as_integer_fromval(val);
+			head[0] = AS_BYTES_INTEGER;
+			*(uint64_t*)&head[1] = cf_swap_to_be64(v->value);
+			in->len[1] = 9;
+			in->data[2] = NULL;
+			in->len[2] = 0;
+			break;
+		}
+		case AS_DOUBLE: {
+			as_double* v = as_double_fromval(val);
+			head[0] = AS_BYTES_DOUBLE;
+			*(double*)&head[1] = cf_swap_to_big_float64(v->value);
+			in->len[1] = 9;
+			in->data[2] = NULL;
+			in->len[2] = 0;
+			break;
+		}
+		case AS_STRING: {
+			as_string* v = as_string_fromval(val);
+			head[0] = AS_BYTES_STRING;
+			in->len[1] = 1;
+			in->data[2] = (const uint8_t*)v->value;
+			in->len[2] = (uint32_t)as_string_len(v);
+			break;
+		}
+		case AS_BYTES: {
+			as_bytes* v = as_bytes_fromval(val);
+			// Blob particle type is preserved. See as_key_set_digest().
+			head[0] = v->type;
+			in->len[1] = 1;
+			in->data[2] = v->value;
+			in->len[2] = v->size;
+			break;
+		}
+		default: {
+			return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid key type: %d", val->type);
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static const char*
+as_key_names_find(as_key_name* head, const char* name)
+{
+	for (as_key_name* n = head; n; n = n->next) {
+		if (strcmp(n->name, name) == 0) {
+			return n->name;
+		}
+	}
+	return NULL;
+}
+
+// Stack key values are not reference counted, so they are copied to the heap.
+static as_key_value*
+as_key_value_retain(as_key_value* src)
+{
+	as_val* val = (as_val*)src;
+
+	if (val->free) {
+		return (as_key_value*)as_val_reserve(val);
+	}
+
+	switch (val->type) {
+		case AS_INTEGER:
+			return (as_key_value*)as_integer_new(src->integer.value);
+
+		case AS_STRING:
+			return (as_key_value*)as_string_new_strdup(src->string.value);
+
+		case AS_BYTES: {
+			uint8_t* buf = cf_malloc(src->bytes.size);
+			memcpy(buf, src->bytes.value, src->bytes.size);
+			as_bytes* b = as_bytes_new_wrap(buf, src->bytes.size, true);
+			b->type = src->bytes.type;
+			return (as_key_value*)b;
+		}
+
+		default:
+			return NULL;
+	}
+}
+
 /******************************************************************************
  * FUNCTIONS
  *****************************************************************************/
@@ -296,3 +412,124 @@ as_key_set_digest(as_error* err, as_key* key)
 	key->digest.init = true;
 	return AEROSPIKE_OK;
 }
+
+as_status
+as_key_set_digests(as_error* err, as_key** keys, uint32_t n)
+{
+	if (! as_ripemd160_multi_supported()) {
+		for (uint32_t i = 0; i < n; i++) {
+			as_status status = as_key_set_digest(err, keys[i]);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+		}
+		return AEROSPIKE_OK;
+	}
+
+	as_ripemd160_input inputs[AS_RIPEMD160_LANES];
+	uint8_t heads[AS_RIPEMD160_LANES][9];
+	uint8_t* digests[AS_RIPEMD160_LANES];
+	as_key* lanes[AS_RIPEMD160_LANES];
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_key* key = keys[i];
+
+		if (key->digest.init) {
+			continue;
+		}
+
+		as_status status = as_key_digest_input(err, key, heads[count], &inputs[count]);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+
+		digests[count] = key->digest.value;
+		lanes[count++] = key;
+
+		if (count == AS_RIPEMD160_LANES) {
+			as_ripemd160_multi(inputs, count, digests);
+
+			for (uint32_t j = 0; j < count; j++) {
+				lanes[j]->digest.init = true;
+			}
+			count = 0;
+		}
+	}
+
+	if (count > 0) {
+		as_ripemd160_multi(inputs, count, digests);
+
+		for (uint32_t j = 0; j < count; j++) {
+			lanes[j]->digest.init = true;
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+const char*
+as_key_intern(const char* name)
+{
+	size_t len = strlen(name) + 1;
+
+	if (len > AS_SET_MAX_SIZE) {
+		return NULL;
+	}
+
+	const char* found = as_key_names_find(as_load_ptr((void* const*)&as_key_names), name);
+
+	if (found) {
+		return found;
+	}
+
+	pthread_mutex_lock(&as_key_names_lock);
+
+	found = as_key_names_find(as_key_names, name);
+
+	if (! found) {
+		as_key_name* n = cf_malloc(sizeof(as_key_name) + len);
+		memcpy(n->name, name, len);
+		n->next = as_key_names;
+		as_store_ptr_rls((void**)&as_key_names, n);
+		found = n->name;
+	}
+
+	pthread_mutex_unlock(&as_key_names_lock);
+	return found;
+}
+
+as_status
+as_key_compact_init(as_key_compact* ck, as_error* err, as_key* key, bool keep_value)
+{
+	as_status status = as_key_set_digest(err, key);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	ck->ns = as_key_intern(key->ns);
+	ck->set = as_key_intern(key->set);
+	ck->valuep = (keep_value && key->valuep)? as_key_value_retain(key->valuep) : NULL;
+	memcpy(ck->digest, key->digest.value, AS_DIGEST_VALUE_SIZE);
+	return AEROSPIKE_OK;
+}
+
+as_key*
+as_key_compact_to_key(const as_key_compact* ck, as_key* key)
+{
+	as_key_cons(key, false, ck->ns, ck->set, NULL, ck->digest);
+
+	if (ck->valuep) {
+		key->valuep = (as_key_value*)as_val_reserve((as_val*)ck->valuep);
+	}
+	return key;
+}
+
+void
+as_key_compact_destroy(as_key_compact* ck)
+{
+	as_val_destroy((as_val*)ck->valuep);
+	ck->valuep = NULL;
+}
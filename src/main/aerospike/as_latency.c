@@ -15,6 +15,169 @@
  * the License.
  */
 #include <aerospike/as_latency.h>
+#include <pthread.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline uint32_t
+as_latency_hdr_groups(uint8_t precision)
+{
+	// Group 0 covers [0, 2^precision). Each following group covers one power of 2 range.
+	return 28 - precision;
+}
+
+static inline uint32_t
+as_latency_hdr_index(uint8_t precision, uint64_t value)
+{
+	uint64_t sub_count = 1ULL << precision;
+
+	if (value < sub_count) {
+		return (uint32_t)value;
+	}
+
+	if (value > AS_LATENCY_HDR_MAX_US) {
+		value = AS_LATENCY_HDR_MAX_US;
+	}
+
+#if defined(_MSC_VER)
+	unsigned long msb;
+	_BitScanReverse64(&msb, value);
+#else
+	uint32_t msb = 63 - (uint32_t)__builtin_clzll(value);
+#endif
+	uint32_t shift = (uint32_t)msb - precision + 1;
+	uint64_t half = sub_count >> 1;
+
+	// Offset into the upper half of the sub-buckets, which is the only half used by groups
+	// above zero.
+	return (uint32_t)(sub_count + (shift - 1) * half + ((value >> shift) - half));
+}
+
+static inline uint64_t
+as_latency_hdr_value(uint8_t precision, uint32_t index)
+{
+	uint64_t sub_count = 1ULL << precision;
+
+	if (index < sub_count) {
+		return index;
+	}
+
+	uint64_t half = sub_count >> 1;
+	uint32_t shift = (uint32_t)((index - sub_count) / half) + 1;
+	uint64_t sub = (index - sub_count) % half + half;
+
+	// Return highest value equivalent to bucket.
+	return ((sub + 1) << shift) - 1;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_latency*
+as_latency_create(uint8_t shift, uint8_t size)
+{
+	as_latency* latency = cf_calloc(1, sizeof(as_latency) +
+		(sizeof(uint64_t) * as_latency_stride(size) * AS_METRICS_STRIPES));
+	latency->ref_count = 1;
+	latency->shift = shift;
+	latency->size = size;
+	return latency;
+}
+
+as_latency_hdr*
+as_latency_hdr_create(uint8_t precision)
+{
+	if (precision == 0) {
+		precision = 1;
+	}
+	else if (precision > AS_LATENCY_HDR_PRECISION_MAX) {
+		precision = AS_LATENCY_HDR_PRECISION_MAX;
+	}
+
+	uint32_t sub_count = 1 << precision;
+	uint32_t size = sub_count + (as_latency_hdr_groups(precision) - 1) * (sub_count >> 1);
+
+	as_latency_hdr* hdr = cf_calloc(1, sizeof(as_latency_hdr) +
+		(sizeof(uint64_t) * size * AS_LATENCY_HDR_STRIPES));
+	hdr->ref_count = 1;
+	hdr->precision = precision;
+	hdr->size = size;
+	return hdr;
+}
+
+void
+as_latency_hdr_add(as_latency_hdr* hdr, uint64_t elapsed_us)
+{
+	uint32_t index = as_latency_hdr_index(hdr->precision, elapsed_us);
+	uint64_t* stripe = &hdr->buckets[as_metrics_stripe(AS_LATENCY_HDR_STRIPES) * hdr->size];
+	as_incr_uint64(&stripe[index]);
+}
+
+void
+as_latency_hdr_merge(as_latency_hdr* hdr, uint64_t* counts)
+{
+	for (uint32_t i = 0; i < AS_LATENCY_HDR_STRIPES; i++) {
+		uint64_t* stripe = &hdr->buckets[i * hdr->size];
+
+		for (uint32_t j = 0; j < hdr->size; j++) {
+			counts[j] += as_load_uint64(&stripe[j]);
+		}
+	}
+}
+
+void
+as_latency_hdr_percentiles(
+	uint8_t precision, const uint64_t* counts, uint32_t size, as_latency_percentiles* out
+	)
+{
+	memset(out, 0, sizeof(as_latency_percentiles));
+
+	uint64_t total = 0;
+
+	for (uint32_t i = 0; i < size; i++) {
+		total += counts[i];
+	}
+
+	if (total == 0) {
+		return;
+	}
+
+	// Rank thresholds rounded up, so a percentile is never under reported.
+	uint64_t ranks[4] = {
+		(total * 500 + 999) / 1000,
+		(total * 900 + 999) / 1000,
+		(total * 990 + 999) / 1000,
+		(total * 999 + 999) / 1000
+	};
+	uint64_t* values[4] = {&out->p50, &out->p90, &out->p99, &out->p999};
+	uint32_t n = 0;
+	uint64_t sum = 0;
+
+	out->count = total;
+
+	for (uint32_t i = 0; i < size; i++) {
+		if (counts[i] == 0) {
+			continue;
+		}
+
+		sum += counts[i];
+
+		uint64_t value = as_latency_hdr_value(precision, i);
+
+		while (n < 4 && sum >= ranks[n]) {
+			*values[n++] = value;
+		}
+		out->max = value;
+	}
+}
 
 char*
 as_latency_type_to_string(as_latency_type type)
@@ -35,8 +198,74 @@ as_latency_type_to_string(as_latency_type type)
 	case AS_LATENCY_TYPE_QUERY:
 		return "query";
 
+	case AS_LATENCY_TYPE_OPERATE:
+		return "operate";
+
+	case AS_LATENCY_TYPE_UDF:
+		return "udf";
+
+	case AS_LATENCY_TYPE_SCAN:
+		return "scan";
+
+	case AS_LATENCY_TYPE_TXN_VERIFY:
+		return "txn_verify";
+
+	case AS_LATENCY_TYPE_TXN_ROLL:
+		return "txn_roll";
+
 	default:
 	case AS_LATENCY_TYPE_NONE:
 		return "none";
 	}
 }
+
+const char*
+as_tend_phase_to_string(as_tend_phase phase)
+{
+	switch (phase) {
+	case AS_TEND_PHASE_NODES:
+		return "nodes";
+
+	case AS_TEND_PHASE_PEERS:
+		return "peers";
+
+	case AS_TEND_PHASE_PARTITIONS:
+		return "partitions";
+
+	case AS_TEND_PHASE_RACKS:
+		return "racks";
+
+	case AS_TEND_PHASE_MANAGE:
+		return "manage";
+
+	case AS_TEND_PHASE_BALANCE:
+		return "balance";
+
+	default:
+		return "none";
+	}
+}
+
+const char*
+as_txn_phase_to_string(as_txn_phase phase)
+{
+	switch (phase) {
+	case AS_TXN_PHASE_VERIFY:
+		return "verify";
+
+	case AS_TXN_PHASE_MARK_ROLL_FORWARD:
+		return "mark_roll_forward";
+
+	case AS_TXN_PHASE_ROLL_FORWARD:
+		return "roll_forward";
+
+	case AS_TXN_PHASE_ROLL_BACK:
+		return "roll_back";
+
+	case AS_TXN_PHASE_CLOSE:
+		return "close";
+
+	default:
+		return "none";
+	}
+}
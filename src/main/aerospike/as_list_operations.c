@@ -79,7 +79,7 @@ as_list_range(
 	if (end) {
 		as_pack_val(&pk, end);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(begin);
 	as_val_destroy(end);
 	return as_cdt_add_packed(&pk, ops, name, op_type);
@@ -100,7 +100,7 @@ as_operations_list_create(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header_flag(&pk, ctx, SET_TYPE, 1, flag);
 	as_pack_uint64(&pk, (uint64_t)order);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -120,7 +120,7 @@ as_operations_list_create_all(
 		as_packer pk = as_cdt_begin();
 		as_cdt_pack_header(&pk, ctx, SET_TYPE, 1);
 		as_pack_uint64(&pk, flag);
-		as_cdt_end(&pk);
+		as_cdt_end_ops(&pk, ops);
 		return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 	}
 
@@ -130,7 +130,7 @@ as_operations_list_create_all(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header_flag(&pk, ctx, SET_TYPE, 1, flag);
 	as_pack_uint64(&pk, (uint64_t)order);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -142,7 +142,7 @@ as_operations_list_set_order(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, SET_TYPE, 1);
 	as_pack_uint64(&pk, (uint64_t)order);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -154,7 +154,7 @@ as_operations_list_sort(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, SORT, 1);
 	as_pack_uint64(&pk, (uint64_t)flags);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -173,7 +173,7 @@ as_operations_list_append(
 		as_pack_uint64(&pk, (uint64_t)policy->order);
 		as_pack_uint64(&pk, (uint64_t)policy->flags);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(val);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -193,7 +193,7 @@ as_operations_list_append_items(
 		as_pack_uint64(&pk, (uint64_t)policy->order);
 		as_pack_uint64(&pk, (uint64_t)policy->flags);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(list);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -214,7 +214,7 @@ as_operations_list_insert(
 		// as_list_policy.order is not sent because inserts are not allowed on sorted lists.
 		as_pack_uint64(&pk, (uint64_t)policy->flags);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(val);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -235,7 +235,7 @@ as_operations_list_insert_items(
 		// as_list_policy.order is not sent because inserts are not allowed on sorted lists.
 		as_pack_uint64(&pk, (uint64_t)policy->flags);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(list);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -264,7 +264,7 @@ as_operations_list_increment(
 		as_pack_uint64(&pk, (uint64_t)policy->order);
 		as_pack_uint64(&pk, (uint64_t)policy->flags);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(incr);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -284,7 +284,7 @@ as_operations_list_set(
 	if (policy) {
 		as_pack_uint64(&pk, (uint64_t)policy->flags);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(val);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -295,7 +295,7 @@ as_operations_list_pop(as_operations* ops, const char* name, as_cdt_ctx* ctx, in
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, POP, 1);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -308,7 +308,7 @@ as_operations_list_pop_range(as_operations* ops, const char* name, as_cdt_ctx* c
 	as_cdt_pack_header(&pk, ctx, POP_RANGE, 2);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -320,7 +320,7 @@ as_operations_list_pop_range_from(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, POP_RANGE, 1);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -332,7 +332,7 @@ as_operations_list_remove(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, REMOVE, 1);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -345,7 +345,7 @@ as_operations_list_remove_range(
 	as_cdt_pack_header(&pk, ctx, REMOVE_RANGE, 2);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -357,7 +357,7 @@ as_operations_list_remove_range_from(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, REMOVE_RANGE, 1);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -371,7 +371,7 @@ as_operations_list_remove_by_value(
 	as_cdt_pack_header(&pk, ctx, REMOVE_ALL_BY_VALUE, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_val(&pk, value);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -386,7 +386,7 @@ as_operations_list_remove_by_value_list(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_VALUE_LIST, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_val(&pk, (as_val*)values);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(values);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -412,7 +412,7 @@ as_operations_list_remove_by_value_rel_rank_range_to_end(
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -429,7 +429,7 @@ as_operations_list_remove_by_value_rel_rank_range(
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
@@ -444,7 +444,7 @@ as_operations_list_remove_by_index(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_INDEX, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -458,7 +458,7 @@ as_operations_list_remove_by_index_range_to_end(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_INDEX_RANGE, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -473,7 +473,7 @@ as_operations_list_remove_by_index_range(
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -487,7 +487,7 @@ as_operations_list_remove_by_rank(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_RANK, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -501,7 +501,7 @@ as_operations_list_remove_by_rank_range_to_end(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_RANK_RANGE, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -516,7 +516,7 @@ as_operations_list_remove_by_rank_range(
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -529,7 +529,7 @@ as_operations_list_trim(
 	as_cdt_pack_header(&pk, ctx, TRIM, 2);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -538,7 +538,7 @@ as_operations_list_clear(as_operations* ops, const char* name, as_cdt_ctx* ctx)
 {
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, CLEAR, 0);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_MODIFY);
 }
 
@@ -547,7 +547,7 @@ as_operations_list_size(as_operations* ops, const char* name, as_cdt_ctx* ctx)
 {
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, SIZE, 0);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -557,7 +557,7 @@ as_operations_list_get(as_operations* ops, const char* name, as_cdt_ctx* ctx, in
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, GET, 1);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -570,7 +570,7 @@ as_operations_list_get_range(
 	as_cdt_pack_header(&pk, ctx, GET_RANGE, 2);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -582,7 +582,7 @@ as_operations_list_get_range_from(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, GET_RANGE, 1);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -596,7 +596,7 @@ as_operations_list_get_by_value(
 	as_cdt_pack_header(&pk, ctx, GET_ALL_BY_VALUE, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_val(&pk, value);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
@@ -621,7 +621,7 @@ as_operations_list_get_by_value_list(
 	as_cdt_pack_header(&pk, ctx, GET_BY_VALUE_LIST, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_val(&pk, (as_val*)values);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(values);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
@@ -637,7 +637,7 @@ as_operations_list_get_by_value_rel_rank_range_to_end(
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
@@ -654,7 +654,7 @@ as_operations_list_get_by_value_rel_rank_range(
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
@@ -669,7 +669,7 @@ as_operations_list_get_by_index(
 	as_cdt_pack_header(&pk, ctx, GET_BY_INDEX, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -683,7 +683,7 @@ as_operations_list_get_by_index_range_to_end(
 	as_cdt_pack_header(&pk, ctx, GET_BY_INDEX_RANGE, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -698,7 +698,7 @@ as_operations_list_get_by_index_range(
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -712,7 +712,7 @@ as_operations_list_get_by_rank(
 	as_cdt_pack_header(&pk, ctx, GET_BY_RANK, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -726,7 +726,7 @@ as_operations_list_get_by_rank_range_to_end(
 	as_cdt_pack_header(&pk, ctx, GET_BY_RANK_RANGE, 2);
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
 
@@ -741,6 +741,6 @@ as_operations_list_get_by_rank_range(
 	as_pack_uint64(&pk, (uint64_t)return_type);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_CDT_READ);
 }
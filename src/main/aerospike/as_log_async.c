@@ -0,0 +1,282 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_log_async.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_sleep.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Time the delivery thread waits when the ring buffer is empty.
+#define AS_LOG_ASYNC_WAIT_MS 10
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct as_log_cell_s {
+	uint64_t seq;
+	const char* func;
+	const char* file;
+	uint32_t line;
+	as_log_level level;
+	char msg[AS_LOG_ASYNC_MSG_SIZE];
+} as_log_cell;
+
+// Bounded multi-producer, single-consumer ring of formatted log messages.
+typedef struct as_log_ring_s {
+	uint64_t head;
+	uint8_t pad[56];
+	uint64_t tail;
+	uint64_t mask;
+	as_log_cell cells[];
+} as_log_ring;
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+static pthread_mutex_t as_log_async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t as_log_async_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t as_log_async_thread;
+static as_log_ring* as_log_async_ring = NULL;
+static as_log_callback as_log_async_callback = NULL;
+static uint64_t as_log_async_drops = 0;
+static uint32_t as_log_async_producers = 0;
+static bool as_log_async_valid = false;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static bool
+as_log_async_record(
+	as_log_level level, const char* func, const char* file, uint32_t line, const char* fmt, ...
+	)
+{
+	// Producers that loaded this callback before as_log_async_stop() switched it back may
+	// still be running. Count them, so stop does not free the ring until they are done.
+	as_incr_uint32(&as_log_async_producers);
+	as_fence_seq();
+
+	as_log_ring* ring = (as_log_ring*)as_load_ptr(&as_log_async_ring);
+	va_list ap;
+
+	if (! ring) {
+		// Async logging stopped. Deliver directly.
+		char msg[AS_LOG_ASYNC_MSG_SIZE];
+		va_start(ap, fmt);
+		vsnprintf(msg, sizeof(msg), fmt, ap);
+		va_end(ap);
+		as_decr_uint32(&as_log_async_producers);
+		return as_log_async_callback(level, func, file, line, "%s", msg);
+	}
+
+	uint64_t pos = as_load_uint64(&ring->head);
+	as_log_cell* cell;
+
+	while (true) {
+		cell = &ring->cells[pos & ring->mask];
+
+		int64_t diff = (int64_t)as_load_uint64_acq(&cell->seq) - (int64_t)pos;
+
+		if (diff == 0) {
+			// Cell is free. Claim it.
+			if (as_cas_uint64(&ring->head, pos, pos + 1)) {
+				break;
+			}
+			pos = as_load_uint64(&ring->head);
+		}
+		else if (diff < 0) {
+			// Ring is full.
+			as_incr_uint64(&as_log_async_drops);
+			as_decr_uint32(&as_log_async_producers);
+			return true;
+		}
+		else {
+			// Another producer claimed the cell.
+			pos = as_load_uint64(&ring->head);
+		}
+	}
+
+	// Arguments can reference stack memory of the caller, so they must be formatted now.
+	va_start(ap, fmt);
+	vsnprintf(cell->msg, sizeof(cell->msg), fmt, ap);
+	va_end(ap);
+
+	cell->func = func;
+	cell->file = file;
+	cell->line = line;
+	cell->level = level;
+	as_store_uint64_rls(&cell->seq, pos + 1);
+	as_decr_uint32(&as_log_async_producers);
+	return true;
+}
+
+static bool
+as_log_async_deliver(as_log_ring* ring)
+{
+	uint64_t pos = ring->tail;
+	as_log_cell* cell = &ring->cells[pos & ring->mask];
+
+	if (as_load_uint64_acq(&cell->seq) != pos + 1) {
+		// Empty or claimed cell not written yet.
+		return false;
+	}
+
+	as_log_async_callback(cell->level, cell->func, cell->file, cell->line, "%s", cell->msg);
+	as_store_uint64_rls(&cell->seq, pos + ring->mask + 1);
+	ring->tail = pos + 1;
+	return true;
+}
+
+static void*
+as_log_async_run(void* udata)
+{
+	as_log_ring* ring = udata;
+
+	pthread_mutex_lock(&as_log_async_lock);
+
+	while (as_log_async_valid) {
+		pthread_mutex_unlock(&as_log_async_lock);
+
+		while (as_log_async_deliver(ring)) {
+		}
+
+		pthread_mutex_lock(&as_log_async_lock);
+
+		if (! as_log_async_valid) {
+			break;
+		}
+
+		struct timespec delta;
+		struct timespec abstime;
+		cf_clock_set_timespec_ms(AS_LOG_ASYNC_WAIT_MS, &delta);
+		cf_clock_current_add(&delta, &abstime);
+		pthread_cond_timedwait(&as_log_async_cond, &as_log_async_lock, &abstime);
+	}
+	pthread_mutex_unlock(&as_log_async_lock);
+
+	// Deliver messages recorded before stop.
+	while (as_log_async_deliver(ring)) {
+	}
+	return NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+as_log_async_start(as_error* err, uint32_t capacity, as_log_callback callback)
+{
+	as_error_reset(err);
+
+	if (! callback) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Log callback is required");
+	}
+
+	if (capacity == 0 || capacity > (1U << 24)) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid log capacity: %u", capacity);
+	}
+
+	uint32_t size = 1;
+
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	pthread_mutex_lock(&as_log_async_lock);
+
+	if (as_log_async_ring) {
+		pthread_mutex_unlock(&as_log_async_lock);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Async logging already started");
+	}
+
+	as_log_ring* ring = cf_malloc(sizeof(as_log_ring) + sizeof(as_log_cell) * size);
+	ring->head = 0;
+	ring->tail = 0;
+	ring->mask = size - 1;
+
+	for (uint32_t i = 0; i < size; i++) {
+		ring->cells[i].seq = i;
+	}
+
+	as_log_async_ring = ring;
+	as_log_async_callback = callback;
+	as_log_async_valid = true;
+
+	if (pthread_create(&as_log_async_thread, NULL, as_log_async_run, ring) != 0) {
+		as_log_async_ring = NULL;
+		as_log_async_valid = false;
+		pthread_mutex_unlock(&as_log_async_lock);
+		cf_free(ring);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to create log thread");
+	}
+	pthread_mutex_unlock(&as_log_async_lock);
+
+	as_log_set_callback(as_log_async_record);
+	return AEROSPIKE_OK;
+}
+
+void
+as_log_async_stop(void)
+{
+	pthread_mutex_lock(&as_log_async_lock);
+
+	as_log_ring* ring = as_log_async_ring;
+
+	if (! ring) {
+		pthread_mutex_unlock(&as_log_async_lock);
+		return;
+	}
+
+	// New messages go directly to callback, while the thread delivers the recorded messages.
+	as_log_set_callback(as_log_async_callback);
+
+	as_log_async_valid = false;
+	pthread_cond_signal(&as_log_async_cond);
+	pthread_mutex_unlock(&as_log_async_lock);
+	pthread_join(as_log_async_thread, NULL);
+
+	pthread_mutex_lock(&as_log_async_lock);
+	as_store_ptr_rls(&as_log_async_ring, NULL);
+	as_fence_seq();
+
+	// Wait for producers that loaded the ring before it was cleared. Their messages may have
+	// been written after the delivery thread exited, so deliver them here.
+	while (as_load_uint32(&as_log_async_producers) != 0) {
+		as_sleep(1);
+	}
+
+	while (as_log_async_deliver(ring)) {
+	}
+	pthread_mutex_unlock(&as_log_async_lock);
+	cf_free(ring);
+}
+
+uint64_t
+as_log_async_dropped(void)
+{
+	return as_load_uint64(&as_log_async_drops);
+}
@@ -17,6 +17,7 @@
 #include <aerospike/as_lookup.h>
 #include <aerospike/as_admin.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_dns_cache.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_string_builder.h>
@@ -69,14 +70,15 @@ as_switch_to_clear_socket(as_cluster* cluster, as_error* err, as_node_info* node
 	for (uint32_t i = 0; i < hosts.size; i++) {
 		host = as_vector_get(&hosts, i);
 		hostname = as_cluster_get_alternate_host(cluster, host->name);
-		status = as_lookup_host(&iter, &error_local, hostname, host->port);
+		status = as_lookup_host_cluster(cluster, &iter, &error_local, hostname, host->port);
 
 		if (status) {
 			continue;
 		}
 
 		while (as_lookup_next(&iter, &addr)) {
-			status = as_socket_create_and_connect(&node_info->socket, &error_local, addr, NULL, NULL, deadline);
+			status = as_socket_create_and_connect(&node_info->socket, &error_local, addr,
+				&cluster->socket_options, NULL, NULL, deadline);
 
 			if (status == AEROSPIKE_OK) {
 				if (node_info->session) {
@@ -156,7 +158,7 @@ as_set_node_address(as_cluster* cluster, as_error* err, char* response, char* tl
 	for (uint32_t i = 0; i < hosts.size; i++) {
 		host = as_vector_get(&hosts, i);
 		hostname = as_cluster_get_alternate_host(cluster, host->name);
-		status = as_lookup_host(&iter, &error_local, hostname, host->port);
+		status = as_lookup_host_cluster(cluster, &iter, &error_local, hostname, host->port);
 
 		if (status != AEROSPIKE_OK) {
 			continue;
@@ -164,8 +166,8 @@ as_set_node_address(as_cluster* cluster, as_error* err, char* response, char* tl
 
 		while (as_lookup_next(&iter, &addr)) {
 			uint64_t deadline = as_socket_deadline(cluster->conn_timeout_ms);
-			status = as_socket_create_and_connect(&sock, err, addr, cluster->tls_ctx,
-												  tls_name, deadline);
+			status = as_socket_create_and_connect(&sock, err, addr, &cluster->socket_options,
+												  cluster->tls_ctx, tls_name, deadline);
 
 			if (status == AEROSPIKE_OK) {
 				if (node_info->session) {
@@ -226,6 +228,7 @@ as_status
 as_lookup_host(as_address_iterator* iter, as_error* err, const char* hostname, uint16_t port)
 {
 	iter->hostname_is_alias = true;
+	iter->cached = false;
 
 	struct addrinfo hints;
 	memset(&hints, 0, sizeof(hints));
@@ -263,6 +266,18 @@ as_lookup_host(as_address_iterator* iter, as_error* err, const char* hostname, u
 	return AEROSPIKE_OK;
 }
 
+as_status
+as_lookup_host_cluster(
+	as_cluster* cluster, as_address_iterator* iter, as_error* err, const char* hostname,
+	uint16_t port
+	)
+{
+	if (cluster->dns_cache) {
+		return as_dns_cache_lookup(cluster->dns_cache, iter, err, hostname, port);
+	}
+	return as_lookup_host(iter, err, hostname, port);
+}
+
 as_status
 as_lookup_node(
 	as_cluster* cluster, as_error* err, as_host* host, struct sockaddr* addr,
@@ -271,8 +286,8 @@ as_lookup_node(
 {
 	uint64_t deadline = as_socket_deadline(cluster->conn_timeout_ms);
 	
-	as_status status = as_socket_create_and_connect(&node_info->socket, err, addr, cluster->tls_ctx,
-													host->tls_name, deadline);
+	as_status status = as_socket_create_and_connect(&node_info->socket, err, addr,
+		&cluster->socket_options, cluster->tls_ctx, host->tls_name, deadline);
 
 	if (status) {
 		return status;
@@ -426,6 +441,12 @@ as_lookup_node(
 		else if (strcmp(begin, "pquery") == 0) {
 			features |= AS_FEATURES_PARTITION_QUERY;
 		}
+		else if (strcmp(begin, "compression-lz4") == 0) {
+			features |= AS_FEATURES_COMPRESS_LZ4;
+		}
+		else if (strcmp(begin, "compression-zstd") == 0) {
+			features |= AS_FEATURES_COMPRESS_ZSTD;
+		}
 
 		begin = end;
 	}
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_lua_cache.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_file.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_module.h>
+#include <aerospike/mod_lua.h>
+#include <citrusleaf/alloc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------
+// Types
+//---------------------------------
+
+// UDF file whose cached lua states were last loaded with the given file status.
+typedef struct as_lua_file_s {
+	struct as_lua_file_s* next;
+	as_file_status status;
+	char name[];
+} as_lua_file;
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+static pthread_mutex_t as_lua_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static as_lua_file* as_lua_cache_files = NULL;
+static char as_lua_cache_path[AS_CONFIG_PATH_MAX_SIZE];
+static bool as_lua_cache_enabled = false;
+static uint64_t as_lua_cache_hits = 0;
+static uint64_t as_lua_cache_misses = 0;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline bool
+as_lua_file_status_equal(as_file_status* a, as_file_status* b)
+{
+#if !defined(_MSC_VER)
+	return a->timestamp.tv_sec == b->timestamp.tv_sec &&
+		a->timestamp.tv_nsec == b->timestamp.tv_nsec;
+#else
+	return a->timestamp == b->timestamp;
+#endif
+}
+
+// Must hold cache lock.
+static as_lua_file**
+as_lua_file_find(const char* module, size_t len)
+{
+	as_lua_file** link = &as_lua_cache_files;
+
+	while (*link) {
+		as_lua_file* file = *link;
+
+		if (strncmp(file->name, module, len) == 0 && file->name[len] == 0) {
+			return link;
+		}
+		link = &file->next;
+	}
+	return link;
+}
+
+// Must hold cache lock.
+static void
+as_lua_files_clear(void)
+{
+	as_lua_file* file = as_lua_cache_files;
+
+	while (file) {
+		as_lua_file* next = file->next;
+		cf_free(file);
+		file = next;
+	}
+	as_lua_cache_files = NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_lua_cache_configure(as_config_lua* config)
+{
+	pthread_mutex_lock(&as_lua_cache_lock);
+	// mod-lua scans user_path again on configure, so all files start unvalidated.
+	as_lua_files_clear();
+	as_strncpy(as_lua_cache_path, config->user_path, sizeof(as_lua_cache_path));
+	as_lua_cache_enabled = config->cache_enabled;
+	pthread_mutex_unlock(&as_lua_cache_lock);
+}
+
+void
+as_lua_cache_validate(const char* module)
+{
+	pthread_mutex_lock(&as_lua_cache_lock);
+
+	if (! as_lua_cache_enabled) {
+		pthread_mutex_unlock(&as_lua_cache_lock);
+		return;
+	}
+
+	char path[AS_CONFIG_PATH_MAX_SIZE + 256];
+	snprintf(path, sizeof(path), "%s/%s.lua", as_lua_cache_path, module);
+
+	as_file_status status;
+
+	if (! as_file_get_status(path, &status)) {
+		// Let mod-lua report the missing module.
+		pthread_mutex_unlock(&as_lua_cache_lock);
+		return;
+	}
+
+	size_t len = strlen(module);
+	as_lua_file** link = as_lua_file_find(module, len);
+	as_lua_file* file = *link;
+
+	if (file && as_lua_file_status_equal(&file->status, &status)) {
+		pthread_mutex_unlock(&as_lua_cache_lock);
+		as_incr_uint64(&as_lua_cache_hits);
+		return;
+	}
+
+	if (! file) {
+		file = cf_malloc(sizeof(as_lua_file) + len + 1);
+		memcpy(file->name, module, len + 1);
+		file->next = NULL;
+		*link = file;
+	}
+	file->status = status;
+
+	// Rebuild cached lua states from the current file. Aggregations already running keep
+	// the states they hold.
+	char filename[256 + 8];
+	snprintf(filename, sizeof(filename), "%s.lua", module);
+
+	as_module_event event = {
+		.type = AS_MODULE_EVENT_FILE_ADD,
+		.data.filename = filename
+	};
+	as_module_update(&mod_lua, &event);
+	pthread_mutex_unlock(&as_lua_cache_lock);
+
+	as_incr_uint64(&as_lua_cache_misses);
+	as_log_debug("Reloaded lua module %s", module);
+}
+
+void
+as_lua_cache_invalidate(const char* filename)
+{
+	const char* base = strrchr(filename, '/');
+	base = base ? base + 1 : filename;
+
+	const char* ext = strrchr(base, '.');
+	size_t len = ext ? (size_t)(ext - base) : strlen(base);
+
+	pthread_mutex_lock(&as_lua_cache_lock);
+
+	as_lua_file** link = as_lua_file_find(base, len);
+	as_lua_file* file = *link;
+
+	if (file) {
+		*link = file->next;
+		cf_free(file);
+	}
+	pthread_mutex_unlock(&as_lua_cache_lock);
+}
+
+void
+as_lua_cache_stats(uint64_t* hits, uint64_t* misses)
+{
+	*hits = as_load_uint64(&as_lua_cache_hits);
+	*misses = as_load_uint64(&as_lua_cache_misses);
+}
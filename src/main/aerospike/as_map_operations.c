@@ -81,7 +81,7 @@ as_map_range(
 	if (end) {
 		as_pack_val(&pk, end);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(begin);
 	as_val_destroy(end);
 	return as_cdt_add_packed(&pk, ops, name, op_type);
@@ -160,7 +160,7 @@ as_operations_map_create(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header_flag(&pk, ctx, SET_TYPE, 1, flag);
 	as_pack_uint64(&pk, (uint64_t)order);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -182,7 +182,7 @@ as_operations_map_create_all(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header_flag(&pk, ctx, SET_TYPE, 1, flag);
 	as_pack_uint64(&pk, (uint64_t)order);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -201,7 +201,7 @@ as_operations_map_set_policy(
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, SET_TYPE, 1);
 	as_pack_uint64(&pk, attr);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -237,7 +237,7 @@ as_operations_map_put(
 		as_pack_val(&pk, value);
 		as_pack_uint64(&pk, policy->attributes);
 	}
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
@@ -273,7 +273,7 @@ as_operations_map_put_items(
 		as_pack_uint64(&pk, policy->attributes);
 	}
 
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_map_destroy(items);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -291,7 +291,7 @@ as_operations_map_increment(
 	as_pack_val(&pk, key);
 	as_pack_val(&pk, val);
 	as_pack_uint64(&pk, policy->attributes);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
@@ -310,7 +310,7 @@ as_operations_map_decrement(
 	as_pack_val(&pk, key);
 	as_pack_val(&pk, val);
 	as_pack_uint64(&pk, policy->attributes);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
@@ -321,7 +321,7 @@ as_operations_map_clear(as_operations* ops, const char* name, as_cdt_ctx* ctx)
 {
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, CLEAR, 0);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -335,7 +335,7 @@ as_operations_map_remove_by_key(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_KEY, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, key);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -350,7 +350,7 @@ as_operations_map_remove_by_key_list(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_KEY_LIST, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, (as_val*)keys);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(keys);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -376,7 +376,7 @@ as_operations_map_remove_by_key_rel_index_range_to_end(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, key);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -393,7 +393,7 @@ as_operations_map_remove_by_key_rel_index_range(
 	as_pack_val(&pk, key);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -408,7 +408,7 @@ as_operations_map_remove_by_value(
 	as_cdt_pack_header(&pk, ctx, REMOVE_ALL_BY_VALUE, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, value);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -423,7 +423,7 @@ as_operations_map_remove_by_value_list(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_VALUE_LIST, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, (as_val*)values);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(values);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -449,7 +449,7 @@ as_operations_map_remove_by_value_rel_rank_range_to_end(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -466,7 +466,7 @@ as_operations_map_remove_by_value_rel_rank_range(
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
@@ -481,7 +481,7 @@ as_operations_map_remove_by_index(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_INDEX, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -495,7 +495,7 @@ as_operations_map_remove_by_index_range_to_end(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_INDEX_RANGE, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -510,7 +510,7 @@ as_operations_map_remove_by_index_range(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -524,7 +524,7 @@ as_operations_map_remove_by_rank(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_RANK, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -538,7 +538,7 @@ as_operations_map_remove_by_rank_range_to_end(
 	as_cdt_pack_header(&pk, ctx, REMOVE_BY_RANK_RANGE, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -553,7 +553,7 @@ as_operations_map_remove_by_rank_range(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_MODIFY);
 }
 
@@ -562,7 +562,7 @@ as_operations_map_size(as_operations* ops, const char* name, as_cdt_ctx* ctx)
 {
 	as_packer pk = as_cdt_begin();
 	as_cdt_pack_header(&pk, ctx, SIZE, 0);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
 
@@ -576,7 +576,7 @@ as_operations_map_get_by_key(
 	as_cdt_pack_header(&pk, ctx, GET_BY_KEY, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, key);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -601,7 +601,7 @@ as_operations_map_get_by_key_list(
 	as_cdt_pack_header(&pk, ctx, GET_BY_KEY_LIST, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, (as_val*)keys);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(keys);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -617,7 +617,7 @@ as_operations_map_get_by_key_rel_index_range_to_end(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, key);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -634,7 +634,7 @@ as_operations_map_get_by_key_rel_index_range(
 	as_pack_val(&pk, key);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(key);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -649,7 +649,7 @@ as_operations_map_get_by_value(
 	as_cdt_pack_header(&pk, ctx, GET_ALL_BY_VALUE, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, value);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -674,7 +674,7 @@ as_operations_map_get_by_value_list(
 	as_cdt_pack_header(&pk, ctx, GET_BY_VALUE_LIST, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, (as_val*)values);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_list_destroy(values);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -690,7 +690,7 @@ as_operations_map_get_by_value_rel_rank_range_to_end(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -707,7 +707,7 @@ as_operations_map_get_by_value_rel_rank_range(
 	as_pack_val(&pk, value);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	as_val_destroy(value);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
@@ -722,7 +722,7 @@ as_operations_map_get_by_index(
 	as_cdt_pack_header(&pk, ctx, GET_BY_INDEX, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
 
@@ -736,7 +736,7 @@ as_operations_map_get_by_index_range_to_end(
 	as_cdt_pack_header(&pk, ctx, GET_BY_INDEX_RANGE, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, index);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
 
@@ -751,7 +751,7 @@ as_operations_map_get_by_index_range(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, index);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
 
@@ -765,7 +765,7 @@ as_operations_map_get_by_rank(
 	as_cdt_pack_header(&pk, ctx, GET_BY_RANK, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
 
@@ -779,7 +779,7 @@ as_operations_map_get_by_rank_range_to_end(
 	as_cdt_pack_header(&pk, ctx, GET_BY_RANK_RANGE, 2);
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, rank);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
 
@@ -794,6 +794,6 @@ as_operations_map_get_by_rank_range(
 	as_pack_int64(&pk, (int64_t)return_type);
 	as_pack_int64(&pk, rank);
 	as_pack_uint64(&pk, count);
-	as_cdt_end(&pk);
+	as_cdt_end_ops(&pk, ops);
 	return as_cdt_add_packed(&pk, ops, name, AS_OPERATOR_MAP_READ);
 }
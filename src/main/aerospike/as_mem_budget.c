@@ -0,0 +1,126 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_mem_budget.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static bool
+as_mem_budget_try(as_mem_budget* budget, uint64_t size)
+{
+	while (true) {
+		uint64_t used = as_load_uint64(&budget->used);
+
+		if (used > 0 && used + size > budget->capacity) {
+			return false;
+		}
+
+		if (as_cas_uint64(&budget->used, used, used + size)) {
+			used += size;
+
+			uint64_t peak = as_load_uint64(&budget->peak);
+
+			while (used > peak) {
+				if (as_cas_uint64(&budget->peak, peak, used)) {
+					break;
+				}
+				peak = as_load_uint64(&budget->peak);
+			}
+			return true;
+		}
+	}
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_mem_budget*
+as_mem_budget_create(uint64_t capacity)
+{
+	as_mem_budget* budget = cf_malloc(sizeof(as_mem_budget));
+	memset(budget, 0, sizeof(as_mem_budget));
+	pthread_mutex_init(&budget->lock, NULL);
+	pthread_cond_init(&budget->cond, NULL);
+	budget->capacity = capacity;
+	return budget;
+}
+
+void
+as_mem_budget_destroy(as_mem_budget* budget)
+{
+	pthread_cond_destroy(&budget->cond);
+	pthread_mutex_destroy(&budget->lock);
+	cf_free(budget);
+}
+
+as_status
+as_mem_budget_acquire(as_mem_budget* budget, as_error* err, uint64_t size, uint32_t max_wait_ms)
+{
+	if (as_mem_budget_try(budget, size)) {
+		return AEROSPIKE_OK;
+	}
+
+	if (max_wait_ms > 0) {
+		struct timespec delta;
+		struct timespec abstime;
+		cf_clock_set_timespec_ms(max_wait_ms, &delta);
+		cf_clock_current_add(&delta, &abstime);
+
+		pthread_mutex_lock(&budget->lock);
+
+		// Releasers check waiters after lowering usage, so a release between the failed
+		// attempt and the wait is not missed.
+		as_incr_uint32(&budget->waiters);
+
+		bool admitted = false;
+		int rv = 0;
+
+		while (! (admitted = as_mem_budget_try(budget, size)) && rv == 0) {
+			rv = pthread_cond_timedwait(&budget->cond, &budget->lock, &abstime);
+		}
+
+		as_decr_uint32(&budget->waiters);
+		pthread_mutex_unlock(&budget->lock);
+
+		if (admitted) {
+			return AEROSPIKE_OK;
+		}
+	}
+
+	as_incr_uint64(&budget->rejects);
+	return as_error_update(err, AEROSPIKE_ERR_MEMORY_BUDGET,
+		"Memory budget exhausted: used=%" PRIu64 " capacity=%" PRIu64 " request=%" PRIu64,
+		as_load_uint64(&budget->used), budget->capacity, size);
+}
+
+void
+as_mem_budget_release(as_mem_budget* budget, uint64_t size)
+{
+	as_faa_uint64(&budget->used, -(int64_t)size);
+
+	if (as_load_uint32(&budget->waiters) > 0) {
+		pthread_mutex_lock(&budget->lock);
+		pthread_cond_broadcast(&budget->cond);
+		pthread_mutex_unlock(&budget->lock);
+	}
+}
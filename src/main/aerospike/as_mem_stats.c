@@ -0,0 +1,92 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_mem_stats.h>
+#include <aerospike/as_atomic.h>
+#include <string.h>
+
+//---------------------------------
+// Static Variables
+//---------------------------------
+
+#if defined(AS_MEM_STATS)
+static uint64_t as_mem_current[AS_MEM_TAG_MAX];
+static uint64_t as_mem_peak[AS_MEM_TAG_MAX];
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+const char*
+as_mem_tag_name(as_mem_tag tag)
+{
+	switch (tag) {
+		case AS_MEM_TAG_COMMAND:
+			return "command";
+		case AS_MEM_TAG_RECORD:
+			return "record";
+		case AS_MEM_TAG_BATCH:
+			return "batch";
+		case AS_MEM_TAG_SCAN:
+			return "scan";
+		case AS_MEM_TAG_POOL:
+			return "pool";
+		case AS_MEM_TAG_CLUSTER:
+			return "cluster";
+		case AS_MEM_TAG_TXN:
+			return "txn";
+		default:
+			return "unknown";
+	}
+}
+
+void
+as_mem_stats_get(as_mem_tag_stats* stats)
+{
+#if defined(AS_MEM_STATS)
+	for (uint32_t i = 0; i < AS_MEM_TAG_MAX; i++) {
+		stats[i].current = as_load_uint64(&as_mem_current[i]);
+		stats[i].peak = as_load_uint64(&as_mem_peak[i]);
+	}
+#else
+	memset(stats, 0, sizeof(as_mem_tag_stats) * AS_MEM_TAG_MAX);
+#endif
+}
+
+#if defined(AS_MEM_STATS)
+
+void
+as_mem_stats_alloc(as_mem_tag tag, size_t size)
+{
+	uint64_t current = as_aaf_uint64(&as_mem_current[tag], size);
+	uint64_t peak = as_load_uint64(&as_mem_peak[tag]);
+
+	while (current > peak) {
+		if (as_cas_uint64(&as_mem_peak[tag], peak, current)) {
+			break;
+		}
+		peak = as_load_uint64(&as_mem_peak[tag]);
+	}
+}
+
+void
+as_mem_stats_free(as_mem_tag tag, size_t size)
+{
+	as_faa_uint64(&as_mem_current[tag], -(int64_t)size);
+}
+
+#endif
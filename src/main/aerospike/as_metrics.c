@@ -34,8 +34,8 @@ as_metrics_policy_merge(aerospike* as, const as_metrics_policy* src, as_metrics_
 		return &config->policies.metrics;
 	}
 	else if (as->config_bitmap) {
-		uint8_t* bitmap = as->config_bitmap;
 		as_config* config = aerospike_load_config(as);
+		uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
 		as_metrics_policy* cfg = &config->policies.metrics;
 
 		mrg->labels = as_field_is_set(bitmap, AS_METRICS_LABELS)?
@@ -51,6 +51,10 @@ as_metrics_policy_merge(aerospike* as, const as_metrics_policy* src, as_metrics_
 		as_strncpy(mrg->report_dir, src->report_dir, sizeof(mrg->report_dir));
 		mrg->report_size_limit = src->report_size_limit;
 		mrg->interval = src->interval;
+		mrg->latency_precision = src->latency_precision;
+		mrg->hot_keys = src->hot_keys;
+		mrg->partition_heatmap = src->partition_heatmap;
+		mrg->tcp_info_interval = src->tcp_info_interval;
 		return mrg;
 	}
 	else {
@@ -69,9 +73,11 @@ aerospike_enable_metrics(aerospike* as, as_error* err, const as_metrics_policy*
 
 	pthread_mutex_lock(&cluster->metrics_lock);
 
-	if (as->config_bitmap &&
-		as_field_is_set(as->config_bitmap, AS_METRICS_ENABLE) &&
-		!as->config.policies.metrics.enable) {
+	as_config* config = aerospike_load_config(as);
+	uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
+
+	if (bitmap && as_field_is_set(bitmap, AS_METRICS_ENABLE) &&
+		!config->policies.metrics.enable) {
 		pthread_mutex_unlock(&cluster->metrics_lock);
 		return as_error_set_message(err, AEROSPIKE_METRICS_CONFLICT,
 			"Metrics can not be enabled by this function when metrics is disabled by dynamic configuration");
@@ -93,9 +99,11 @@ aerospike_disable_metrics(aerospike* as, as_error* err)
 
 	pthread_mutex_lock(&cluster->metrics_lock);
 
-	if (cluster->metrics_enabled && as->config_bitmap &&
-		as_field_is_set(as->config_bitmap, AS_METRICS_ENABLE) &&
-		as->config.policies.metrics.enable) {
+	as_config* config = aerospike_load_config(as);
+	uint8_t* bitmap = aerospike_load_config_bitmap(as, config);
+
+	if (cluster->metrics_enabled && bitmap && as_field_is_set(bitmap, AS_METRICS_ENABLE) &&
+		config->policies.metrics.enable) {
 		pthread_mutex_unlock(&cluster->metrics_lock);
 		return as_error_set_message(err, AEROSPIKE_METRICS_CONFLICT,
 			"Metrics can not be disabled by this function when metrics is enabled by dynamic configuration");
@@ -115,6 +123,10 @@ as_metrics_policy_init(as_metrics_policy* policy)
 	policy->interval = 30;
 	policy->latency_columns = 7;
 	policy->latency_shift = 1;
+	policy->latency_precision = 0;
+	policy->hot_keys = 0;
+	policy->partition_heatmap = 0;
+	policy->tcp_info_interval = 0;
 	policy->metrics_listeners.enable_listener = NULL;
 	policy->metrics_listeners.snapshot_listener = NULL;
 	policy->metrics_listeners.node_close_listener = NULL;
@@ -0,0 +1,967 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_metrics_prometheus.h>
+#include <aerospike/aerospike_stats.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_dns_cache.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_poll.h>
+#include <citrusleaf/alloc.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+#define AS_PROMETHEUS_PAGE_SIZE (64 * 1024)
+#define AS_PROMETHEUS_POLL_MS 250
+#define AS_PROMETHEUS_IO_TIMEOUT_MS 2000
+
+#define AS_PROMETHEUS_CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_prometheus_append_escaped(as_string_builder* sb, const char* value)
+{
+	// Escape label values as required by the OpenMetrics text format.
+	for (const char* p = value; *p; p++) {
+		switch (*p) {
+			case '\\':
+				as_string_builder_append(sb, "\\\\");
+				break;
+
+			case '"':
+				as_string_builder_append(sb, "\\\"");
+				break;
+
+			case '\n':
+				as_string_builder_append(sb, "\\n");
+				break;
+
+			default:
+				as_string_builder_append_char(sb, *p);
+				break;
+		}
+	}
+}
+
+static inline void
+as_prometheus_append_label(as_string_builder* sb, const char* name, const char* value)
+{
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append(sb, name);
+	as_string_builder_append(sb, "=\"");
+	as_prometheus_append_escaped(sb, value);
+	as_string_builder_append_char(sb, '"');
+}
+
+static void
+as_prometheus_begin_sample(
+	as_metrics_prometheus* mp, as_string_builder* sb, const char* name, as_cluster* cluster
+	)
+{
+	as_string_builder_append(sb, name);
+	as_string_builder_append(sb, "{cluster=\"");
+	as_prometheus_append_escaped(sb, cluster->cluster_name ? cluster->cluster_name : "");
+	as_string_builder_append_char(sb, '"');
+
+	if (cluster->app_id) {
+		as_prometheus_append_label(sb, "app_id", cluster->app_id);
+	}
+
+	as_vector* labels = mp->labels;
+
+	if (labels) {
+		for (uint32_t i = 0; i < labels->size; i++) {
+			as_metrics_label* label = as_vector_get(labels, i);
+			as_prometheus_append_label(sb, label->name, label->value);
+		}
+	}
+}
+
+static inline void
+as_prometheus_end_sample(as_string_builder* sb, uint64_t value)
+{
+	as_string_builder_append(sb, "} ");
+	as_string_builder_append_uint64(sb, value);
+	as_string_builder_append_newline(sb);
+}
+
+static inline void
+as_prometheus_append_family(as_string_builder* sb, const char* name, const char* type, const char* help)
+{
+	as_string_builder_append(sb, "# TYPE ");
+	as_string_builder_append(sb, name);
+	as_string_builder_append_char(sb, ' ');
+	as_string_builder_append(sb, type);
+	as_string_builder_append_newline(sb);
+	as_string_builder_append(sb, "# HELP ");
+	as_string_builder_append(sb, name);
+	as_string_builder_append_char(sb, ' ');
+	as_string_builder_append(sb, help);
+	as_string_builder_append_newline(sb);
+}
+
+static void
+as_prometheus_append_fraction(as_string_builder* sb, uint64_t value, uint32_t scale, uint32_t digits)
+{
+	// Convert integer ms/us to seconds without floating point formatting.
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%llu.%0*llu", (unsigned long long)(value / scale), (int)digits,
+		(unsigned long long)(value % scale));
+	as_string_builder_append(sb, buf);
+}
+
+static inline void
+as_prometheus_node_labels(as_string_builder* sb, as_node* node)
+{
+	as_prometheus_append_label(sb, "node", node->name);
+	as_prometheus_append_label(sb, "address", as_node_get_address_string(node));
+}
+
+static void
+as_prometheus_write_compress(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, const char* name,
+	const char* help, size_t offset, bool time
+	)
+{
+	as_prometheus_append_family(sb, name, "counter", help);
+
+	char sample[128];
+	snprintf(sample, sizeof(sample), "%s_total", name);
+
+	for (uint32_t i = 0; i < AS_COMPRESS_CODEC_SIZE; i++) {
+		if (! as_compress_codec_enabled((as_compress_codec)i)) {
+			continue;
+		}
+
+		uint64_t value = as_load_uint64((uint64_t*)((uint8_t*)&cluster->compress_stats[i] + offset));
+
+		as_prometheus_begin_sample(mp, sb, sample, cluster);
+		as_prometheus_append_label(sb, "codec", as_compress_codec_name((as_compress_codec)i));
+
+		if (time) {
+			as_string_builder_append(sb, "} ");
+			as_prometheus_append_fraction(sb, value, 1000000000, 9);
+			as_string_builder_append_newline(sb);
+		}
+		else {
+			as_prometheus_end_sample(sb, value);
+		}
+	}
+}
+
+static void
+as_prometheus_write_cluster_counters(as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster)
+{
+	as_prometheus_append_family(sb, "aerospike_client_commands", "counter",
+		"Commands started by the client.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_commands_total", cluster);
+	as_prometheus_end_sample(sb, as_cluster_get_command_count(cluster));
+
+	as_prometheus_append_family(sb, "aerospike_client_retries", "counter",
+		"Command retries.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_retries_total", cluster);
+	as_prometheus_end_sample(sb, as_cluster_get_retry_count(cluster));
+
+	as_prometheus_append_family(sb, "aerospike_client_retry_budget_exhausted", "counter",
+		"Command retries denied because the retry budget was exhausted.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_retry_budget_exhausted_total", cluster);
+	as_prometheus_end_sample(sb, as_cluster_get_retry_budget_exhausted_count(cluster));
+
+	as_prometheus_append_family(sb, "aerospike_client_delay_queue_timeouts", "counter",
+		"Async commands that timed out in an event loop delay queue.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_delay_queue_timeouts_total", cluster);
+	as_prometheus_end_sample(sb, as_cluster_get_delay_queue_timeout_count(cluster));
+
+	as_prometheus_append_family(sb, "aerospike_client_invalid_nodes", "gauge",
+		"Nodes that could not be added to the cluster.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_invalid_nodes", cluster);
+	as_prometheus_end_sample(sb, cluster->invalid_node_count);
+
+	as_prometheus_append_family(sb, "aerospike_client_tend_duration_microseconds", "gauge",
+		"Duration of the last completed cluster tend iteration.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_tend_duration_microseconds", cluster);
+	as_prometheus_end_sample(sb, as_cluster_get_tend_duration(cluster));
+
+	as_prometheus_append_family(sb, "aerospike_client_thread_pool_queued_tasks", "gauge",
+		"Sync batch, scan and query tasks awaiting a thread pool worker.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_thread_pool_queued_tasks", cluster);
+	as_prometheus_end_sample(sb, as_work_pool_queued_tasks(cluster->thread_pool));
+
+	as_prometheus_append_family(sb, "aerospike_client_thread_pool_steals", "counter",
+		"Thread pool tasks run by a worker other than the one they were queued to.");
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_thread_pool_steals_total", cluster);
+	as_prometheus_end_sample(sb, as_work_pool_steal_count(cluster->thread_pool));
+
+	if (cluster->tls_ctx) {
+		as_prometheus_append_family(sb, "aerospike_client_tls_handshakes", "counter",
+			"TLS handshakes by whether a cached session was resumed.");
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_tls_handshakes_total", cluster);
+		as_prometheus_append_label(sb, "type", "full");
+		as_prometheus_end_sample(sb, as_load_uint64(&cluster->tls_ctx->full_handshakes));
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_tls_handshakes_total", cluster);
+		as_prometheus_append_label(sb, "type", "resumed");
+		as_prometheus_end_sample(sb, as_load_uint64(&cluster->tls_ctx->resumed_handshakes));
+	}
+
+	as_dns_cache* dns = cluster->dns_cache;
+
+	if (dns) {
+		as_prometheus_append_family(sb, "aerospike_client_dns_cache_lookups", "counter",
+			"Seed and peer hostname lookups by whether the DNS cache answered them.");
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_dns_cache_lookups_total", cluster);
+		as_prometheus_append_label(sb, "result", "hit");
+		as_prometheus_end_sample(sb, as_load_uint64(&dns->hits));
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_dns_cache_lookups_total", cluster);
+		as_prometheus_append_label(sb, "result", "miss");
+		as_prometheus_end_sample(sb, as_load_uint64(&dns->misses));
+
+		as_prometheus_append_family(sb, "aerospike_client_dns_resolutions", "counter",
+			"DNS resolutions performed by the DNS cache, including background refreshes.");
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_dns_resolutions_total", cluster);
+		as_prometheus_end_sample(sb, as_load_uint64(&dns->lookups));
+
+		as_prometheus_append_family(sb, "aerospike_client_dns_resolution_errors", "counter",
+			"DNS resolutions performed by the DNS cache that failed.");
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_dns_resolution_errors_total", cluster);
+		as_prometheus_end_sample(sb, as_load_uint64(&dns->lookup_errors));
+
+		as_prometheus_append_family(sb, "aerospike_client_dns_resolution_seconds", "counter",
+			"Time spent in DNS resolutions performed by the DNS cache.");
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_dns_resolution_seconds_total", cluster);
+		as_string_builder_append(sb, "} ");
+		as_prometheus_append_fraction(sb, as_load_uint64(&dns->lookup_ns), 1000000000, 9);
+		as_string_builder_append_newline(sb);
+	}
+
+	as_prometheus_write_compress(mp, sb, cluster, "aerospike_client_compress_bytes_in",
+		"Uncompressed bytes of commands compressed by the client.",
+		offsetof(as_compress_stats, compress_bytes_in), false);
+	as_prometheus_write_compress(mp, sb, cluster, "aerospike_client_compress_bytes_out",
+		"Compressed bytes of commands compressed by the client.",
+		offsetof(as_compress_stats, compress_bytes_out), false);
+	as_prometheus_write_compress(mp, sb, cluster, "aerospike_client_compress_seconds",
+		"Time spent compressing commands.",
+		offsetof(as_compress_stats, compress_ns), true);
+	as_prometheus_write_compress(mp, sb, cluster, "aerospike_client_decompress_bytes_in",
+		"Compressed bytes of responses decompressed by the client.",
+		offsetof(as_compress_stats, decompress_bytes_in), false);
+	as_prometheus_write_compress(mp, sb, cluster, "aerospike_client_decompress_bytes_out",
+		"Uncompressed bytes of responses decompressed by the client.",
+		offsetof(as_compress_stats, decompress_bytes_out), false);
+	as_prometheus_write_compress(mp, sb, cluster, "aerospike_client_decompress_seconds",
+		"Time spent decompressing responses.",
+		offsetof(as_compress_stats, decompress_ns), true);
+
+	if (as_event_loop_size == 0) {
+		return;
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_event_loop_commands", "gauge",
+		"Async commands in process or waiting in the delay queue per event loop.");
+
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		as_event_loop* loop = &as_event_loops[i];
+		char index[16];
+		snprintf(index, sizeof(index), "%u", i);
+
+		int process_size = as_event_loop_get_process_size(loop);
+
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_event_loop_commands", cluster);
+		as_prometheus_append_label(sb, "event_loop", index);
+		as_prometheus_append_label(sb, "state", "process");
+		as_prometheus_end_sample(sb, (process_size > 0)? (uint64_t)process_size : 0);
+
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_event_loop_commands", cluster);
+		as_prometheus_append_label(sb, "event_loop", index);
+		as_prometheus_append_label(sb, "state", "queue");
+		as_prometheus_end_sample(sb, as_event_loop_get_queue_size(loop));
+	}
+}
+
+static void
+as_prometheus_write_conn(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_cluster_stats* stats
+	)
+{
+	static const char* types[] = {"sync", "async", "pipeline"};
+
+	as_prometheus_append_family(sb, "aerospike_client_connections", "gauge",
+		"Node connections in use or residing in pools.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_conn_stats* cs[] = {&ns->sync, &ns->async, &ns->pipeline};
+
+		for (uint32_t j = 0; j < 3; j++) {
+			as_prometheus_begin_sample(mp, sb, "aerospike_client_connections", cluster);
+			as_prometheus_node_labels(sb, ns->node);
+			as_prometheus_append_label(sb, "type", types[j]);
+			as_prometheus_append_label(sb, "state", "in_use");
+			as_prometheus_end_sample(sb, cs[j]->in_use);
+
+			as_prometheus_begin_sample(mp, sb, "aerospike_client_connections", cluster);
+			as_prometheus_node_labels(sb, ns->node);
+			as_prometheus_append_label(sb, "type", types[j]);
+			as_prometheus_append_label(sb, "state", "in_pool");
+			as_prometheus_end_sample(sb, cs[j]->in_pool);
+		}
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_connections_opened", "counter",
+		"Node connections opened since node creation.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_conn_stats* cs[] = {&ns->sync, &ns->async, &ns->pipeline};
+
+		for (uint32_t j = 0; j < 3; j++) {
+			as_prometheus_begin_sample(mp, sb, "aerospike_client_connections_opened_total", cluster);
+			as_prometheus_node_labels(sb, ns->node);
+			as_prometheus_append_label(sb, "type", types[j]);
+			as_prometheus_end_sample(sb, cs[j]->opened);
+		}
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_connections_closed", "counter",
+		"Node connections closed since node creation.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_conn_stats* cs[] = {&ns->sync, &ns->async, &ns->pipeline};
+
+		for (uint32_t j = 0; j < 3; j++) {
+			as_prometheus_begin_sample(mp, sb, "aerospike_client_connections_closed_total", cluster);
+			as_prometheus_node_labels(sb, ns->node);
+			as_prometheus_append_label(sb, "type", types[j]);
+			as_prometheus_end_sample(sb, cs[j]->closed);
+		}
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_pipeline_commands", "gauge",
+		"Pipeline commands awaiting a response.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_pipeline_commands", cluster);
+		as_prometheus_node_labels(sb, ns->node);
+		as_prometheus_end_sample(sb, ns->pipeline.in_flight);
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_pipeline_max_depth", "gauge",
+		"Highest number of commands awaiting a response on a single pipeline connection.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_pipeline_max_depth", cluster);
+		as_prometheus_node_labels(sb, ns->node);
+		as_prometheus_end_sample(sb, ns->pipeline.max_depth);
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_circuit_breaker_state", "gauge",
+		"Node circuit breaker state. 0 is closed, 1 is open and 2 is half-open.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_circuit_breaker_state", cluster);
+		as_prometheus_node_labels(sb, ns->node);
+		as_prometheus_end_sample(sb, ns->breaker_state);
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_circuit_breaker_trips", "counter",
+		"Times the node circuit breaker opened since node creation.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+		as_prometheus_begin_sample(mp, sb, "aerospike_client_circuit_breaker_trips_total", cluster);
+		as_prometheus_node_labels(sb, ns->node);
+		as_prometheus_end_sample(sb, ns->breaker_trips);
+	}
+}
+
+typedef uint64_t (*as_prometheus_ns_counter)(as_ns_metrics* metrics);
+
+static uint64_t
+as_prometheus_errors(as_ns_metrics* metrics)
+{
+	return as_node_get_error_count(metrics);
+}
+
+static uint64_t
+as_prometheus_timeouts(as_ns_metrics* metrics)
+{
+	return as_node_get_timeout_count(metrics);
+}
+
+static uint64_t
+as_prometheus_key_busy(as_ns_metrics* metrics)
+{
+	return as_node_get_key_busy_count(metrics);
+}
+
+static uint64_t
+as_prometheus_near_cache_hits(as_ns_metrics* metrics)
+{
+	return as_node_get_near_cache_hit_count(metrics);
+}
+
+static uint64_t
+as_prometheus_near_cache_misses(as_ns_metrics* metrics)
+{
+	return as_node_get_near_cache_miss_count(metrics);
+}
+
+static uint64_t
+as_prometheus_bytes_in(as_ns_metrics* metrics)
+{
+	return as_node_get_bytes_in(metrics);
+}
+
+static uint64_t
+as_prometheus_bytes_out(as_ns_metrics* metrics)
+{
+	return as_node_get_bytes_out(metrics);
+}
+
+static uint64_t
+as_prometheus_bytes_in_raw(as_ns_metrics* metrics)
+{
+	return as_node_get_bytes_in_raw(metrics);
+}
+
+static uint64_t
+as_prometheus_bytes_out_raw(as_ns_metrics* metrics)
+{
+	return as_node_get_bytes_out_raw(metrics);
+}
+
+static void
+as_prometheus_write_ns_counter(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_cluster_stats* stats,
+	const char* name, const char* help, as_prometheus_ns_counter fn
+	)
+{
+	char total[128];
+	snprintf(total, sizeof(total), "%s_total", name);
+
+	as_prometheus_append_family(sb, name, "counter", help);
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node* node = stats->nodes[i].node;
+		as_ns_metrics** array = node->metrics;
+		uint8_t max = node->metrics_size;
+
+		for (uint8_t j = 0; j < max; j++) {
+			as_ns_metrics* metrics = array[j];
+
+			as_prometheus_begin_sample(mp, sb, total, cluster);
+			as_prometheus_node_labels(sb, node);
+			as_prometheus_append_label(sb, "namespace", metrics->ns);
+			as_prometheus_end_sample(sb, fn(metrics));
+		}
+	}
+}
+
+static void
+as_prometheus_write_latency(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_cluster_stats* stats
+	)
+{
+	as_prometheus_append_family(sb, "aerospike_client_latency_seconds", "histogram",
+		"Command latency.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node* node = stats->nodes[i].node;
+		as_ns_metrics** array = node->metrics;
+		uint8_t max = node->metrics_size;
+
+		for (uint8_t j = 0; j < max; j++) {
+			as_ns_metrics* metrics = array[j];
+
+			for (uint8_t t = 0; t < AS_LATENCY_TYPE_MAX; t++) {
+				as_latency* latency = as_latency_reserve(metrics->latency[t]);
+				const char* type = as_latency_type_to_string(t);
+				uint64_t limit = 1;
+				uint64_t sum = 0;
+
+				// Histogram buckets are cumulative in OpenMetrics. Bucket limits are in ms.
+				for (uint8_t k = 0; k < latency->size; k++) {
+					sum += as_latency_get_bucket(latency, k);
+
+					as_prometheus_begin_sample(mp, sb, "aerospike_client_latency_seconds_bucket", cluster);
+					as_prometheus_node_labels(sb, node);
+					as_prometheus_append_label(sb, "namespace", metrics->ns);
+					as_prometheus_append_label(sb, "type", type);
+					as_string_builder_append(sb, ",le=\"");
+
+					if (k + 1 < latency->size) {
+						as_prometheus_append_fraction(sb, limit, 1000, 3);
+						limit <<= latency->shift;
+					}
+					else {
+						as_string_builder_append(sb, "+Inf");
+					}
+					as_string_builder_append_char(sb, '"');
+					as_prometheus_end_sample(sb, sum);
+				}
+				as_latency_release(latency);
+
+				as_prometheus_begin_sample(mp, sb, "aerospike_client_latency_seconds_count", cluster);
+				as_prometheus_node_labels(sb, node);
+				as_prometheus_append_label(sb, "namespace", metrics->ns);
+				as_prometheus_append_label(sb, "type", type);
+				as_prometheus_end_sample(sb, sum);
+			}
+		}
+	}
+}
+
+static void
+as_prometheus_append_quantile(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_node* node,
+	const char* type, const char* quantile, uint64_t us
+	)
+{
+	as_prometheus_begin_sample(mp, sb, "aerospike_client_latency_quantile_seconds", cluster);
+	as_prometheus_node_labels(sb, node);
+	as_prometheus_append_label(sb, "type", type);
+	as_prometheus_append_label(sb, "quantile", quantile);
+	as_string_builder_append(sb, "} ");
+	as_prometheus_append_fraction(sb, us, 1000000, 6);
+	as_string_builder_append_newline(sb);
+}
+
+static void
+as_prometheus_write_quantiles(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_cluster_stats* stats
+	)
+{
+	if (! cluster->metrics_latency_precision) {
+		return;
+	}
+
+	as_prometheus_append_family(sb, "aerospike_client_latency_quantile_seconds", "summary",
+		"Command latency percentiles from high resolution histograms.");
+
+	for (uint32_t i = 0; i < stats->nodes_size; i++) {
+		as_node_stats* ns = &stats->nodes[i];
+
+		for (uint8_t t = 0; t < AS_LATENCY_TYPE_MAX; t++) {
+			as_latency_percentiles* lp = &ns->latency[t];
+			const char* type = as_latency_type_to_string(t);
+
+			as_prometheus_append_quantile(mp, sb, cluster, ns->node, type, "0.5", lp->p50);
+			as_prometheus_append_quantile(mp, sb, cluster, ns->node, type, "0.9", lp->p90);
+			as_prometheus_append_quantile(mp, sb, cluster, ns->node, type, "0.99", lp->p99);
+			as_prometheus_append_quantile(mp, sb, cluster, ns->node, type, "0.999", lp->p999);
+			as_prometheus_append_quantile(mp, sb, cluster, ns->node, type, "1", lp->max);
+
+			as_prometheus_begin_sample(mp, sb, "aerospike_client_latency_quantile_seconds_count", cluster);
+			as_prometheus_node_labels(sb, ns->node);
+			as_prometheus_append_label(sb, "type", type);
+			as_prometheus_end_sample(sb, lp->count);
+		}
+	}
+}
+
+static void
+as_prometheus_append_phase_quantile(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, const char* name,
+	const char* phase, const char* quantile, uint64_t us
+	)
+{
+	as_prometheus_begin_sample(mp, sb, name, cluster);
+	as_prometheus_append_label(sb, "phase", phase);
+	as_prometheus_append_label(sb, "quantile", quantile);
+	as_string_builder_append(sb, "} ");
+	as_prometheus_append_fraction(sb, us, 1000000, 6);
+	as_string_builder_append_newline(sb);
+}
+
+static void
+as_prometheus_write_phase(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, const char* name,
+	const char* count_name, const char* phase, as_latency_percentiles* lp
+	)
+{
+	as_prometheus_append_phase_quantile(mp, sb, cluster, name, phase, "0.5", lp->p50);
+	as_prometheus_append_phase_quantile(mp, sb, cluster, name, phase, "0.9", lp->p90);
+	as_prometheus_append_phase_quantile(mp, sb, cluster, name, phase, "0.99", lp->p99);
+	as_prometheus_append_phase_quantile(mp, sb, cluster, name, phase, "0.999", lp->p999);
+	as_prometheus_append_phase_quantile(mp, sb, cluster, name, phase, "1", lp->max);
+
+	as_prometheus_begin_sample(mp, sb, count_name, cluster);
+	as_prometheus_append_label(sb, "phase", phase);
+	as_prometheus_end_sample(sb, lp->count);
+}
+
+static void
+as_prometheus_write_tend_phases(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_cluster_stats* stats
+	)
+{
+	as_prometheus_append_family(sb, "aerospike_client_tend_phase_seconds", "summary",
+		"Cluster tend phase durations.");
+
+	for (as_tend_phase i = 0; i < AS_TEND_PHASE_MAX; i++) {
+		as_prometheus_write_phase(mp, sb, cluster, "aerospike_client_tend_phase_seconds",
+			"aerospike_client_tend_phase_seconds_count", as_tend_phase_to_string(i),
+			&stats->tend_phases[i]);
+	}
+}
+
+static void
+as_prometheus_write_txn_phases(
+	as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster, as_cluster_stats* stats
+	)
+{
+	as_prometheus_append_family(sb, "aerospike_client_txn_phase_seconds", "summary",
+		"Transaction commit and abort phase durations.");
+
+	for (as_txn_phase i = 0; i < AS_TXN_PHASE_MAX; i++) {
+		as_prometheus_write_phase(mp, sb, cluster, "aerospike_client_txn_phase_seconds",
+			"aerospike_client_txn_phase_seconds_count", as_txn_phase_to_string(i),
+			&stats->txn_phases[i]);
+	}
+}
+
+static void
+as_prometheus_render(as_metrics_prometheus* mp, as_string_builder* sb, as_cluster* cluster)
+{
+	as_cluster_stats stats;
+	aerospike_cluster_stats(cluster, &stats);
+
+	as_string_builder_reset(sb);
+	as_prometheus_write_cluster_counters(mp, sb, cluster);
+	as_prometheus_write_conn(mp, sb, cluster, &stats);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_errors",
+		"Command errors.", as_prometheus_errors);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_timeouts",
+		"Command timeouts.", as_prometheus_timeouts);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_key_busy",
+		"Command key busy errors.", as_prometheus_key_busy);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_near_cache_hits",
+		"Reads served from near cache.", as_prometheus_near_cache_hits);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_near_cache_misses",
+		"Near cache reads sent to nodes.", as_prometheus_near_cache_misses);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_bytes_in",
+		"Bytes received from nodes.", as_prometheus_bytes_in);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_bytes_out",
+		"Bytes sent to nodes.", as_prometheus_bytes_out);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_bytes_in_raw",
+		"Bytes received from nodes before decompression.", as_prometheus_bytes_in_raw);
+	as_prometheus_write_ns_counter(mp, sb, cluster, &stats, "aerospike_client_bytes_out_raw",
+		"Bytes sent to nodes before compression.", as_prometheus_bytes_out_raw);
+	as_prometheus_write_latency(mp, sb, cluster, &stats);
+	as_prometheus_write_quantiles(mp, sb, cluster, &stats);
+	as_prometheus_write_tend_phases(mp, sb, cluster, &stats);
+	as_prometheus_write_txn_phases(mp, sb, cluster, &stats);
+	as_string_builder_append(sb, "# EOF\n");
+
+	aerospike_stats_destroy(&stats);
+}
+
+static as_prometheus_page*
+as_prometheus_page_create(const char* data, uint32_t length)
+{
+	as_prometheus_page* page = cf_malloc(sizeof(as_prometheus_page) + length);
+	page->ref_count = 1;
+	page->length = length;
+	memcpy(page->data, data, length);
+	return page;
+}
+
+static inline void
+as_prometheus_page_release(as_prometheus_page* page)
+{
+	if (as_aaf_uint32_rls(&page->ref_count, -1) == 0) {
+		as_fence_acq();
+		cf_free(page);
+	}
+}
+
+static bool
+as_prometheus_send(as_socket_fd fd, const char* buf, size_t len)
+{
+	while (len > 0) {
+		int rv = (int)send(fd, buf, (int)len, MSG_NOSIGNAL);
+
+		if (rv <= 0) {
+			return false;
+		}
+		buf += rv;
+		len -= rv;
+	}
+	return true;
+}
+
+static void
+as_prometheus_set_timeout(as_socket_fd fd)
+{
+#if !defined(_MSC_VER)
+	struct timeval tv;
+	tv.tv_sec = AS_PROMETHEUS_IO_TIMEOUT_MS / 1000;
+	tv.tv_usec = (AS_PROMETHEUS_IO_TIMEOUT_MS % 1000) * 1000;
+#else
+	DWORD tv = AS_PROMETHEUS_IO_TIMEOUT_MS;
+#endif
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv));
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&tv, sizeof(tv));
+}
+
+static void
+as_prometheus_handle(as_metrics_prometheus* mp, as_socket_fd fd)
+{
+	char req[2048];
+	int len = 0;
+
+	as_prometheus_set_timeout(fd);
+
+	// Read request headers. The request body is ignored.
+	while (len < (int)sizeof(req) - 1) {
+		int rv = (int)recv(fd, req + len, (int)sizeof(req) - 1 - len, 0);
+
+		if (rv <= 0) {
+			return;
+		}
+		len += rv;
+		req[len] = 0;
+
+		if (strstr(req, "\r\n\r\n")) {
+			break;
+		}
+	}
+
+	char header[256];
+
+	if (strncmp(req, "GET /metrics", 12) != 0 && strncmp(req, "GET / ", 6) != 0) {
+		static const char* not_found =
+			"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+		as_prometheus_send(fd, not_found, strlen(not_found));
+		return;
+	}
+
+	// Reserve last rendered page and send it outside of lock, so a slow scraper never
+	// blocks the metrics snapshot in the tend thread.
+	pthread_mutex_lock(&mp->lock);
+	as_prometheus_page* page = mp->page;
+	as_incr_uint32(&page->ref_count);
+	pthread_mutex_unlock(&mp->lock);
+
+	int hlen = snprintf(header, sizeof(header),
+		"HTTP/1.1 200 OK\r\nContent-Type: " AS_PROMETHEUS_CONTENT_TYPE
+		"\r\nContent-Length: %u\r\nConnection: close\r\n\r\n", page->length);
+
+	if (as_prometheus_send(fd, header, hlen)) {
+		as_prometheus_send(fd, page->data, page->length);
+	}
+	as_prometheus_page_release(page);
+}
+
+static void*
+as_prometheus_run(void* udata)
+{
+	as_metrics_prometheus* mp = udata;
+	as_poll poll;
+	as_poll_init(&poll, mp->fd);
+
+	while (as_load_uint8_acq(&mp->running)) {
+		int rv = as_poll_socket(&poll, mp->fd, AS_PROMETHEUS_POLL_MS, true);
+
+		if (rv <= 0) {
+			continue;
+		}
+
+		as_socket_fd fd = accept(mp->fd, NULL, NULL);
+
+		if (fd == (as_socket_fd)-1) {
+			continue;
+		}
+
+		as_prometheus_handle(mp, fd);
+		as_close(fd);
+	}
+	as_poll_destroy(&poll);
+	return NULL;
+}
+
+static void
+as_metrics_prometheus_destroy(as_metrics_prometheus* mp)
+{
+	if (mp->enable) {
+		as_store_uint8_rls(&mp->running, 0);
+		pthread_join(mp->thread, NULL);
+		as_close(mp->fd);
+	}
+	as_string_builder_destroy(&mp->render);
+	as_prometheus_page_release(mp->page);
+	as_metrics_labels_destroy(mp->labels);
+	pthread_mutex_destroy(&mp->lock);
+	cf_free(mp);
+}
+
+//---------------------------------
+// Public Functions
+//---------------------------------
+
+as_status
+as_metrics_prometheus_create(
+	as_error* err, const as_metrics_policy* policy, const char* address, uint16_t port,
+	as_metrics_listeners* listeners
+	)
+{
+	if (port == 0) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Metrics port must be non-zero");
+	}
+
+	if (! address) {
+		address = "127.0.0.1";
+	}
+
+	struct sockaddr_storage addr;
+	memset(&addr, 0, sizeof(addr));
+
+	struct sockaddr_in* addr4 = (struct sockaddr_in*)&addr;
+	struct sockaddr_in6* addr6 = (struct sockaddr_in6*)&addr;
+
+	if (inet_pton(AF_INET, address, &addr4->sin_addr) == 1) {
+		addr4->sin_family = AF_INET;
+		addr4->sin_port = htons(port);
+	}
+	else if (inet_pton(AF_INET6, address, &addr6->sin6_addr) == 1) {
+		addr6->sin6_family = AF_INET6;
+		addr6->sin6_port = htons(port);
+	}
+	else {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid metrics address: %s", address);
+	}
+
+	as_metrics_prometheus* mp = cf_calloc(1, sizeof(as_metrics_prometheus));
+	pthread_mutex_init(&mp->lock, NULL);
+	as_string_builder_init(&mp->render, AS_PROMETHEUS_PAGE_SIZE, true);
+	mp->page = as_prometheus_page_create("# EOF\n", 6);
+	mp->addr = addr;
+	mp->labels = as_metrics_labels_copy(policy->labels);
+	mp->port = port;
+	mp->running = 0;
+	mp->enable = false;
+
+	listeners->enable_listener = as_metrics_prometheus_enable;
+	listeners->snapshot_listener = as_metrics_prometheus_snapshot;
+	listeners->node_close_listener = as_metrics_prometheus_node_close;
+	listeners->disable_listener = as_metrics_prometheus_disable;
+	listeners->udata = mp;
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_metrics_prometheus_enable(as_error* err, void* udata)
+{
+	as_metrics_prometheus* mp = udata;
+
+	if (mp->enable) {
+		return AEROSPIKE_OK;
+	}
+
+	as_socket_fd fd = socket(mp->addr.ss_family, SOCK_STREAM, 0);
+
+	if (fd == (as_socket_fd)-1) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to create metrics socket: %d",
+			as_last_error());
+	}
+
+	int reuse = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	socklen_t addr_len = (mp->addr.ss_family == AF_INET) ?
+		sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+
+	if (bind(fd, (struct sockaddr*)&mp->addr, addr_len) != 0 || listen(fd, 16) != 0) {
+		int e = as_last_error();
+		as_close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to listen on metrics port %u: %d",
+			mp->port, e);
+	}
+
+	mp->fd = fd;
+	as_store_uint8_rls(&mp->running, 1);
+
+	if (pthread_create(&mp->thread, NULL, as_prometheus_run, mp) != 0) {
+		as_close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to create metrics thread: %d",
+			errno);
+	}
+
+	mp->enable = true;
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_metrics_prometheus_snapshot(as_error* err, as_cluster* cluster, void* udata)
+{
+	as_error_reset(err);
+	as_metrics_prometheus* mp = udata;
+
+	if (! mp->enable) {
+		return AEROSPIKE_OK;
+	}
+
+	// Render into the reusable buffer outside of lock and then swap in a copy as the served
+	// page. The replaced page is freed when its last scrape completes.
+	as_prometheus_render(mp, &mp->render, cluster);
+
+	as_prometheus_page* page = as_prometheus_page_create(mp->render.data, mp->render.length);
+
+	pthread_mutex_lock(&mp->lock);
+	as_prometheus_page* old = mp->page;
+	mp->page = page;
+	pthread_mutex_unlock(&mp->lock);
+
+	as_prometheus_page_release(old);
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_metrics_prometheus_node_close(as_error* err, as_node* node, void* udata)
+{
+	// Closed nodes are dropped from the next snapshot.
+	as_error_reset(err);
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_metrics_prometheus_disable(as_error* err, as_cluster* cluster, void* udata)
+{
+	as_error_reset(err);
+	as_metrics_prometheus* mp = udata;
+
+	if (mp != NULL) {
+		as_metrics_prometheus_destroy(mp);
+	}
+	return AEROSPIKE_OK;
+}
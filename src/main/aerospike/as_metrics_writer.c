@@ -17,7 +17,12 @@
 #include <aerospike/as_metrics_writer.h>
 #include <aerospike/aerospike_stats.h>
 #include <aerospike/as_event.h>
+#include <aerospike/as_hot_keys.h>
+#include <aerospike/as_partition_heat.h>
+#include <aerospike/as_shm_cluster.h>
 #include <aerospike/as_string_builder.h>
+#include <citrusleaf/cf_clock.h>
+#include <string.h>
 #include <time.h>
 
 //---------------------------------
@@ -368,9 +373,34 @@ as_metrics_open_writer(as_metrics_writer* mw, as_error* err)
 	char now_str[128];
 	timestamp_to_string(now_str, sizeof(now_str));
 	
-	char data[512];
-	int rv = snprintf(data, sizeof(data), "%s header(2) cluster[name,clientType,clientVersion,appId,label[],cpu,mem,invalidNodeCount,commandCount,retryCount,delayQueueTimeoutCount,eventloop[],node[]] label[name,value] eventloop[processSize,queueSize] node[name,address,port,syncConn,asyncConn,namespace[]] conn[inUse,inPool,opened,closed] namespace[name,errors,timeouts,keyBusy,bytesIn,bytesOut,latency[]] latency(%u,%u)[type[l1,l2,l3...]]\n",
-		now_str, mw->latency_columns, mw->latency_shift);
+	char data[2048];
+	int rv;
+	const char* hot_keys = mw->hot_keys ? ",hotKeys[]" : "";
+	const char* hot_keys_def = mw->hot_keys ? " hotKeys[digest,set,count]" : "";
+	const char* heat = mw->partition_heatmap ? ",partitionHeat[]" : "";
+	const char* heat_def = mw->partition_heatmap ?
+		" partitionHeat[partitionId,commands,timeouts,keyBusy,retries,latencyCount,latencySumUs]" : "";
+	const char* tcp = mw->tcp_info_interval ? ",tcp[]" : "";
+	const char* tcp_def = mw->tcp_info_interval ? " tcp[rttUs,rttVarUs,cwnd,retrans,samples]" : "";
+#if defined(AS_MEM_STATS)
+	const char* mem = ",mem[]";
+	const char* mem_def = " mem[tag[current,peak]]";
+#else
+	const char* mem = "";
+	const char* mem_def = "";
+#endif
+
+	if (mw->latency_precision) {
+		rv = snprintf(data, sizeof(data), "%s header(2) cluster[name,clientType,clientVersion,appId,label[],cpu,mem,invalidNodeCount,commandCount,retryCount,delayQueueTimeoutCount,eventloop[],node[],tend[]%s] label[name,value] eventloop[processSize,queueSize,executeSize,lagUs,lagMaxUs,busyPct,commandsPerIteration] node[name,address,port,syncConn,asyncConn%s,namespace[]] conn[inUse,inPool,opened,closed]%s namespace[name,errors,timeouts,keyBusy,bytesIn,bytesOut,bytesInRaw,bytesOutRaw,latency[],percentiles[]%s%s] latency(%u,%u)[type[l1,l2,l3...]] percentiles(%u)[type[count,p50,p90,p99,p999,max]]%s%s tend[phase[count,p50,p90,p99,p999,max]]%s\n",
+			now_str, mem, tcp, tcp_def, hot_keys, heat, mw->latency_columns, mw->latency_shift,
+			mw->latency_precision, hot_keys_def, heat_def, mem_def);
+	}
+	else {
+		rv = snprintf(data, sizeof(data), "%s header(2) cluster[name,clientType,clientVersion,appId,label[],cpu,mem,invalidNodeCount,commandCount,retryCount,delayQueueTimeoutCount,eventloop[],node[],tend[]%s] label[name,value] eventloop[processSize,queueSize,executeSize,lagUs,lagMaxUs,busyPct,commandsPerIteration] node[name,address,port,syncConn,asyncConn%s,namespace[]] conn[inUse,inPool,opened,closed]%s namespace[name,errors,timeouts,keyBusy,bytesIn,bytesOut,bytesInRaw,bytesOutRaw,latency[]%s%s] latency(%u,%u)[type[l1,l2,l3...]]%s%s tend[phase[count,p50,p90,p99,p999,max]]%s\n",
+			now_str, mem, tcp, tcp_def, hot_keys, heat, mw->latency_columns, mw->latency_shift,
+			hot_keys_def, heat_def, mem_def);
+	}
+
 	if (rv <= 0) {
 		fclose(mw->file);
 		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
@@ -399,8 +429,21 @@ as_metrics_get_node_sync_conn_stats(const struct as_node_s* node, struct as_conn
 		uint32_t total = pool->queue.total;
 		pthread_mutex_unlock(&pool->lock);
 
+		if (pool->cache) {
+			// Warning: cross-thread references without a lock.
+			in_pool += as_conn_cache_count(pool);
+
+			if (in_pool > total) {
+				in_pool = total;
+			}
+		}
+
 		sync->in_pool += in_pool;
 		sync->in_use += total - in_pool;
+		sync->contended += as_load_uint64(&pool->contended);
+		sync->cache_hits += as_load_uint64(&pool->cache_hits);
+		sync->peak_in_use += pool->window.peak;
+		sync->trimmed += pool->window.trimmed;
 	}
 	sync->opened = node->sync_conns_opened;
 	sync->closed = node->sync_conns_closed;
@@ -428,14 +471,30 @@ as_metrics_write_conn(as_metrics_writer* mw, as_string_builder* sb, const struct
 	as_string_builder_append_uint(sb, stats->closed); // Cumulative. Not reset on each interval.
 }
 
+static const char*
+as_metrics_latency_name(as_cluster* cluster, uint8_t slot)
+{
+	if (slot < AS_LATENCY_TYPE_MAX) {
+		return as_latency_type_to_string(slot);
+	}
+	// Unnamed application latency tags are not written.
+	return cluster->latency_tags[slot - AS_LATENCY_TYPE_MAX];
+}
+
 static void
-as_metrics_write_latencies(as_string_builder* sb, as_ns_metrics* metrics)
+as_metrics_write_latencies(as_string_builder* sb, as_cluster* cluster, as_ns_metrics* metrics)
 {
-	for (uint8_t i = 0; i < AS_LATENCY_TYPE_MAX; i++) {
+	for (uint8_t i = 0; i < AS_LATENCY_SLOTS; i++) {
+		const char* name = as_metrics_latency_name(cluster, i);
+
+		if (! name) {
+			continue;
+		}
+
 		if (i > 0) {
 			as_string_builder_append_char(sb, ',');
 		}
-		as_string_builder_append(sb, as_latency_type_to_string(i));
+		as_string_builder_append(sb, name);
 		as_string_builder_append_char(sb, '[');
 
 		as_latency* latency = as_latency_reserve(metrics->latency[i]);
@@ -453,7 +512,224 @@ as_metrics_write_latencies(as_string_builder* sb, as_ns_metrics* metrics)
 }
 
 static void
-as_metrics_write_node(as_metrics_writer* mw, as_string_builder* sb, struct as_node_s* node)
+as_metrics_write_percentiles(as_string_builder* sb, as_cluster* cluster, as_ns_metrics* metrics)
+{
+	uint64_t* counts = NULL;
+	uint32_t counts_size = 0;
+
+	for (uint8_t i = 0; i < AS_LATENCY_SLOTS; i++) {
+		const char* name = as_metrics_latency_name(cluster, i);
+
+		if (! name) {
+			continue;
+		}
+
+		if (i > 0) {
+			as_string_builder_append_char(sb, ',');
+		}
+		as_string_builder_append(sb, name);
+		as_string_builder_append_char(sb, '[');
+
+		as_latency_percentiles lp;
+		as_latency_hdr* hdr = as_latency_hdr_reserve(&metrics->latency_hdr[i]);
+
+		if (hdr) {
+			// Merge histogram stripes at snapshot time.
+			if (counts_size < hdr->size) {
+				cf_free(counts);
+				counts = cf_malloc(sizeof(uint64_t) * hdr->size);
+				counts_size = hdr->size;
+			}
+			memset(counts, 0, sizeof(uint64_t) * hdr->size);
+			as_latency_hdr_merge(hdr, counts);
+			as_latency_hdr_percentiles(hdr->precision, counts, hdr->size, &lp);
+			as_latency_hdr_release(hdr);
+		}
+		else {
+			memset(&lp, 0, sizeof(lp));
+		}
+
+		as_string_builder_append_uint64(sb, lp.count);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint64(sb, lp.p50);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint64(sb, lp.p90);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint64(sb, lp.p99);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint64(sb, lp.p999);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint64(sb, lp.max);
+		as_string_builder_append_char(sb, ']');
+	}
+	cf_free(counts);
+}
+
+static void
+as_metrics_write_hot_keys(as_string_builder* sb, as_ns_metrics* metrics)
+{
+	as_hot_keys* hk = metrics->hot_keys;
+
+	if (! hk) {
+		return;
+	}
+
+	static const char hex[] = "0123456789abcdef";
+	as_hot_key* keys = cf_malloc(sizeof(as_hot_key) * hk->capacity);
+	uint32_t n = as_hot_keys_get(hk, keys, hk->capacity);
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_hot_key* key = &keys[i];
+
+		if (i > 0) {
+			as_string_builder_append_char(sb, ',');
+		}
+		as_string_builder_append_char(sb, '[');
+
+		for (uint32_t j = 0; j < AS_DIGEST_VALUE_SIZE; j++) {
+			as_string_builder_append_char(sb, hex[key->digest[j] >> 4]);
+			as_string_builder_append_char(sb, hex[key->digest[j] & 0xf]);
+		}
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append(sb, key->set);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, key->count);
+		as_string_builder_append_char(sb, ']');
+	}
+	cf_free(keys);
+}
+
+static void
+as_metrics_write_partition_heat(as_string_builder* sb, as_ns_metrics* metrics)
+{
+	as_partition_heat* heat = metrics->partition_heat;
+
+	if (! heat) {
+		return;
+	}
+
+	// Only partitions with activity in the last interval are written.
+	bool first = true;
+
+	for (uint32_t i = 0; i < heat->size; i++) {
+		as_partition_heat_entry* e = &heat->entries[i];
+		uint32_t commands = as_load_uint32(&e->commands);
+
+		if (commands == 0) {
+			continue;
+		}
+
+		if (! first) {
+			as_string_builder_append_char(sb, ',');
+		}
+		first = false;
+
+		as_string_builder_append_char(sb, '[');
+		as_string_builder_append_uint(sb, i);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, commands);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, as_load_uint32(&e->timeouts));
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, as_load_uint32(&e->key_busy));
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, as_load_uint32(&e->retries));
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, as_load_uint32(&e->latency_count));
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, as_load_uint32(&e->latency_sum_us));
+		as_string_builder_append_char(sb, ']');
+	}
+}
+
+static void
+as_metrics_write_ns(as_string_builder* sb, as_cluster* cluster, as_ns_metrics* metrics)
+{
+	as_string_builder_append(sb, metrics->ns);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_error_count(metrics));
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_timeout_count(metrics));
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_key_busy_count(metrics));
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_bytes_in(metrics));
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_bytes_out(metrics));
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_bytes_in_raw(metrics));
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, as_node_get_bytes_out_raw(metrics));
+	as_string_builder_append(sb, ",[");
+	as_metrics_write_latencies(sb, cluster, metrics);
+	as_string_builder_append_char(sb, ']');
+}
+
+static void
+as_metrics_write_ns_shm(as_string_builder* sb, as_cluster* cluster, as_ns_metrics_shm* nsm)
+{
+	as_string_builder_append(sb, nsm->ns);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->error_count);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->timeout_count);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->key_busy_count);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->bytes_in);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->bytes_out);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->bytes_in_raw);
+	as_string_builder_append_char(sb, ',');
+	as_string_builder_append_uint64(sb, nsm->bytes_out_raw);
+	as_string_builder_append(sb, ",[");
+
+	for (uint8_t i = 0; i < AS_LATENCY_SLOTS; i++) {
+		const char* name = as_metrics_latency_name(cluster, i);
+
+		if (! name) {
+			continue;
+		}
+
+		if (i > 0) {
+			as_string_builder_append_char(sb, ',');
+		}
+		as_string_builder_append(sb, name);
+		as_string_builder_append_char(sb, '[');
+
+		for (uint8_t j = 0; j < nsm->latency_size; j++) {
+			if (j > 0) {
+				as_string_builder_append_char(sb, ',');
+			}
+			as_string_builder_append_uint64(sb, nsm->latency[i][j]);
+		}
+		as_string_builder_append_char(sb, ']');
+	}
+	as_string_builder_append_char(sb, ']');
+}
+
+static as_ns_metrics*
+as_metrics_find_ns(struct as_node_s* node, const char* ns)
+{
+	for (uint8_t i = 0; i < node->metrics_size; i++) {
+		as_ns_metrics* metrics = node->metrics[i];
+
+		if (strcmp(metrics->ns, ns) == 0) {
+			return metrics;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Write node metrics. If sum is not NULL, node counters and latencies are written from the
+ * metrics of all processes sharing the shared memory cluster.
+ */
+static void
+as_metrics_write_node(
+	as_metrics_writer* mw, as_string_builder* sb, struct as_node_s* node, as_node_metrics_shm* sum
+	)
 {
 	as_string_builder_append_char(sb, '[');
 	as_string_builder_append(sb, node->name);
@@ -475,41 +751,312 @@ as_metrics_write_node(as_metrics_writer* mw, as_string_builder* sb, struct as_no
 	struct as_conn_stats_s async;
 	as_conn_stats_init(&sync);
 	as_conn_stats_init(&async);
-	as_metrics_get_node_sync_conn_stats(node, &sync);
+
+	if (sum) {
+		sync.in_pool = sum->sync_in_pool;
+		sync.in_use = sum->sync_in_use;
+		sync.opened = sum->sync_opened;
+		sync.closed = sum->sync_closed;
+		async.in_pool = sum->async_in_pool;
+		async.in_use = sum->async_in_use;
+		async.opened = sum->async_opened;
+		async.closed = sum->async_closed;
+	}
+	else {
+		as_metrics_get_node_sync_conn_stats(node, &sync);
+		as_metrics_get_node_async_conn_stats(node, &async);
+	}
+
 	as_metrics_write_conn(mw, sb, &sync);
 	as_string_builder_append_char(sb, ',');
-	as_metrics_get_node_async_conn_stats(node, &async);
 	as_metrics_write_conn(mw, sb, &async);
+
+	if (mw->tcp_info_interval) {
+		// TCP state is sampled from this process's connections only.
+		as_tcp_info ti;
+		uint64_t samples;
+		as_node_get_tcp_info(node, &ti, &samples);
+
+		as_string_builder_append(sb, ",[");
+		as_string_builder_append_uint(sb, ti.rtt_us);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, ti.rttvar_us);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, ti.cwnd);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint(sb, ti.retrans);
+		as_string_builder_append_char(sb, ',');
+		as_string_builder_append_uint64(sb, samples);
+		as_string_builder_append_char(sb, ']');
+	}
 	as_string_builder_append(sb, ",[");
 
-	as_ns_metrics** array = node->metrics;
-	uint8_t max = node->metrics_size;
+	uint32_t max = sum ? sum->ns_size : node->metrics_size;
 
 	for (uint32_t i = 0; i < max; i++) {
-		as_ns_metrics* metrics = array[i];
+		as_ns_metrics* metrics;
 
 		if (i > 0) {
 			as_string_builder_append_char(sb, ',');
 		}
 
-		as_string_builder_append(sb, metrics->ns);
-		as_string_builder_append_char(sb, ',');
-		as_string_builder_append_uint64(sb, as_node_get_error_count(metrics));
-		as_string_builder_append_char(sb, ',');
-		as_string_builder_append_uint64(sb, as_node_get_timeout_count(metrics));
-		as_string_builder_append_char(sb, ',');
-		as_string_builder_append_uint64(sb, as_node_get_key_busy_count(metrics));
-		as_string_builder_append_char(sb, ',');
-		as_string_builder_append_uint64(sb, as_node_get_bytes_in(metrics));
-		as_string_builder_append_char(sb, ',');
-		as_string_builder_append_uint64(sb, as_node_get_bytes_out(metrics));
-		as_string_builder_append(sb, ",[");
-		as_metrics_write_latencies(sb, metrics);
-		as_string_builder_append_char(sb, ']');
+		if (sum) {
+			as_ns_metrics_shm* nsm = &sum->ns[i];
+			as_metrics_write_ns_shm(sb, node->cluster, nsm);
+
+			// Percentiles, hot keys and partition heatmaps are only available for this process.
+			metrics = as_metrics_find_ns(node, nsm->ns);
+		}
+		else {
+			metrics = node->metrics[i];
+			as_metrics_write_ns(sb, node->cluster, metrics);
+		}
+
+		if (mw->latency_precision) {
+			as_string_builder_append(sb, ",[");
+
+			if (metrics) {
+				as_metrics_write_percentiles(sb, node->cluster, metrics);
+			}
+			as_string_builder_append_char(sb, ']');
+		}
+
+		if (mw->hot_keys) {
+			as_string_builder_append(sb, ",[");
+
+			if (metrics) {
+				as_metrics_write_hot_keys(sb, metrics);
+			}
+			as_string_builder_append_char(sb, ']');
+		}
+
+		if (mw->partition_heatmap) {
+			as_string_builder_append(sb, ",[");
+
+			if (metrics) {
+				as_metrics_write_partition_heat(sb, metrics);
+			}
+			as_string_builder_append_char(sb, ']');
+		}
 	}
 	as_string_builder_append(sb, "]]");
 }
 
+static inline bool
+as_metrics_shm_enabled(as_cluster* cluster)
+{
+	return cluster->shm_info && cluster->shm_info->metrics;
+}
+
+/**
+ * Copy metrics of this process to its shared memory metrics slot.
+ */
+static void
+as_metrics_publish_shm(as_cluster* cluster)
+{
+	as_shm_info* shm_info = cluster->shm_info;
+	as_cluster_shm* cluster_shm = shm_info->cluster_shm;
+	as_process_metrics_shm* pm = shm_info->metrics;
+	uint32_t ns_capacity = cluster_shm->metrics_ns_capacity;
+
+	as_swlock_write_lock(&pm->lock);
+	pm->timestamp = cf_getms();
+	pm->command_count = as_cluster_get_command_count(cluster);
+	pm->retry_count = as_cluster_get_retry_count(cluster);
+	pm->delay_queue_timeout_count = as_cluster_get_delay_queue_timeout_count(cluster);
+
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t max = nodes->size;
+
+	if (max > cluster_shm->metrics_nodes_capacity) {
+		max = cluster_shm->metrics_nodes_capacity;
+	}
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_node* node = nodes->array[i];
+		as_node_metrics_shm* nm = as_shm_get_node_metrics(cluster_shm, pm, i);
+
+		as_strncpy(nm->name, node->name, sizeof(nm->name));
+
+		struct as_conn_stats_s sync;
+		struct as_conn_stats_s async;
+		as_conn_stats_init(&sync);
+		as_conn_stats_init(&async);
+		as_metrics_get_node_sync_conn_stats(node, &sync);
+		as_metrics_get_node_async_conn_stats(node, &async);
+
+		nm->sync_in_pool = sync.in_pool;
+		nm->sync_in_use = sync.in_use;
+		nm->sync_opened = sync.opened;
+		nm->sync_closed = sync.closed;
+		nm->async_in_pool = async.in_pool;
+		nm->async_in_use = async.in_use;
+		nm->async_opened = async.opened;
+		nm->async_closed = async.closed;
+
+		uint32_t ns_size = node->metrics_size;
+
+		if (ns_size > ns_capacity) {
+			ns_size = ns_capacity;
+		}
+
+		for (uint32_t j = 0; j < ns_size; j++) {
+			as_ns_metrics* metrics = node->metrics[j];
+			as_ns_metrics_shm* nsm = &nm->ns[j];
+
+			as_strncpy(nsm->ns, metrics->ns, sizeof(nsm->ns));
+			nsm->error_count = as_node_get_error_count(metrics);
+			nsm->timeout_count = as_node_get_timeout_count(metrics);
+			nsm->key_busy_count = as_node_get_key_busy_count(metrics);
+			nsm->bytes_in = as_node_get_bytes_in(metrics);
+			nsm->bytes_out = as_node_get_bytes_out(metrics);
+			nsm->bytes_in_raw = as_node_get_bytes_in_raw(metrics);
+			nsm->bytes_out_raw = as_node_get_bytes_out_raw(metrics);
+			nsm->latency_size = 0;
+			memset(nsm->latency, 0, sizeof(nsm->latency));
+
+			for (uint8_t k = 0; k < AS_LATENCY_SLOTS; k++) {
+				as_latency* latency = as_latency_reserve(metrics->latency[k]);
+				uint8_t size = latency->size;
+
+				if (size > AS_SHM_METRICS_LATENCY_BUCKETS) {
+					size = AS_SHM_METRICS_LATENCY_BUCKETS;
+				}
+
+				for (uint8_t b = 0; b < latency->size; b++) {
+					// Extra buckets are added to the last open ended bucket.
+					uint8_t t = (b < size)? b : size - 1;
+					nsm->latency[k][t] += as_latency_get_bucket(latency, b);
+				}
+				as_latency_release(latency);
+
+				if (size > nsm->latency_size) {
+					nsm->latency_size = size;
+				}
+			}
+		}
+		nm->ns_size = ns_size;
+	}
+	as_nodes_release(nodes);
+
+	pm->nodes_size = max;
+	as_swlock_write_unlock(&pm->lock);
+}
+
+static void
+as_metrics_add_node_shm(as_node_metrics_shm* sum, as_node_metrics_shm* nm, uint32_t ns_capacity)
+{
+	sum->sync_in_pool += nm->sync_in_pool;
+	sum->sync_in_use += nm->sync_in_use;
+	sum->sync_opened += nm->sync_opened;
+	sum->sync_closed += nm->sync_closed;
+	sum->async_in_pool += nm->async_in_pool;
+	sum->async_in_use += nm->async_in_use;
+	sum->async_opened += nm->async_opened;
+	sum->async_closed += nm->async_closed;
+
+	uint32_t ns_size = (nm->ns_size < ns_capacity)? nm->ns_size : ns_capacity;
+
+	for (uint32_t i = 0; i < ns_size; i++) {
+		as_ns_metrics_shm* src = &nm->ns[i];
+		as_ns_metrics_shm* trg = NULL;
+
+		for (uint32_t j = 0; j < sum->ns_size; j++) {
+			if (strcmp(sum->ns[j].ns, src->ns) == 0) {
+				trg = &sum->ns[j];
+				break;
+			}
+		}
+
+		if (! trg) {
+			if (sum->ns_size >= ns_capacity) {
+				continue;
+			}
+			trg = &sum->ns[sum->ns_size++];
+			memcpy(trg->ns, src->ns, sizeof(trg->ns));
+		}
+
+		trg->error_count += src->error_count;
+		trg->timeout_count += src->timeout_count;
+		trg->key_busy_count += src->key_busy_count;
+		trg->bytes_in += src->bytes_in;
+		trg->bytes_out += src->bytes_out;
+		trg->bytes_in_raw += src->bytes_in_raw;
+		trg->bytes_out_raw += src->bytes_out_raw;
+
+		uint8_t size = src->latency_size;
+
+		if (size > AS_SHM_METRICS_LATENCY_BUCKETS) {
+			size = AS_SHM_METRICS_LATENCY_BUCKETS;
+		}
+
+		if (size > trg->latency_size) {
+			trg->latency_size = size;
+		}
+
+		for (uint8_t k = 0; k < AS_LATENCY_SLOTS; k++) {
+			for (uint8_t b = 0; b < size; b++) {
+				trg->latency[k][b] += src->latency[k][b];
+			}
+		}
+	}
+}
+
+/**
+ * Sum node metrics of all running processes that share the shared memory cluster.
+ */
+static void
+as_metrics_sum_node_shm(as_cluster_shm* cluster_shm, const char* name, as_node_metrics_shm* sum)
+{
+	memset(sum, 0, cluster_shm->metrics_node_size);
+	as_strncpy(sum->name, name, sizeof(sum->name));
+
+	for (uint32_t i = 0; i < cluster_shm->metrics_capacity; i++) {
+		as_process_metrics_shm* pm = as_shm_get_metrics(cluster_shm, i);
+
+		if (! as_shm_metrics_active(pm)) {
+			continue;
+		}
+
+		as_swlock_read_lock(&pm->lock);
+
+		for (uint32_t j = 0; j < pm->nodes_size; j++) {
+			as_node_metrics_shm* nm = as_shm_get_node_metrics(cluster_shm, pm, j);
+
+			if (strcmp(nm->name, name) == 0) {
+				as_metrics_add_node_shm(sum, nm, cluster_shm->metrics_ns_capacity);
+				break;
+			}
+		}
+		as_swlock_read_unlock(&pm->lock);
+	}
+}
+
+static void
+as_metrics_sum_cluster_shm(
+	as_cluster_shm* cluster_shm, uint64_t* command_count, uint64_t* retry_count,
+	uint64_t* delay_queue_timeout_count
+	)
+{
+	*command_count = 0;
+	*retry_count = 0;
+	*delay_queue_timeout_count = 0;
+
+	for (uint32_t i = 0; i < cluster_shm->metrics_capacity; i++) {
+		as_process_metrics_shm* pm = as_shm_get_metrics(cluster_shm, i);
+
+		if (! as_shm_metrics_active(pm)) {
+			continue;
+		}
+
+		as_swlock_read_lock(&pm->lock);
+		*command_count += pm->command_count;
+		*retry_count += pm->retry_count;
+		*delay_queue_timeout_count += pm->delay_queue_timeout_count;
+		as_swlock_read_unlock(&pm->lock);
+	}
+}
+
 static as_status
 as_metrics_write_cluster(as_error* err, as_metrics_writer* mw, as_cluster* cluster)
 {
@@ -566,13 +1113,30 @@ as_metrics_write_cluster(as_error* err, as_metrics_writer* mw, as_cluster* clust
 	as_string_builder_append_char(&sb, ',');
 	as_string_builder_append_int(&sb, mem);
 	as_string_builder_append_char(&sb, ',');
+	as_cluster_shm* cluster_shm = NULL;
+	uint64_t command_count;
+	uint64_t retry_count;
+	uint64_t delay_queue_timeout_count;
+
+	if (as_metrics_shm_enabled(cluster)) {
+		// Write sums of all processes that share the shared memory cluster.
+		cluster_shm = cluster->shm_info->cluster_shm;
+		as_metrics_sum_cluster_shm(cluster_shm, &command_count, &retry_count,
+			&delay_queue_timeout_count);
+	}
+	else {
+		command_count = as_cluster_get_command_count(cluster);
+		retry_count = as_cluster_get_retry_count(cluster);
+		delay_queue_timeout_count = as_cluster_get_delay_queue_timeout_count(cluster);
+	}
+
 	as_string_builder_append_uint(&sb, cluster->invalid_node_count); // Cumulative. Not reset on each interval.
 	as_string_builder_append_char(&sb, ',');
-	as_string_builder_append_uint64(&sb, as_cluster_get_command_count(cluster));  // Cumulative. Not reset on each interval.
+	as_string_builder_append_uint64(&sb, command_count);  // Cumulative. Not reset on each interval.
 	as_string_builder_append_char(&sb, ',');
-	as_string_builder_append_uint64(&sb, as_cluster_get_retry_count(cluster)); // Cumulative. Not reset on each interval.
+	as_string_builder_append_uint64(&sb, retry_count); // Cumulative. Not reset on each interval.
 	as_string_builder_append_char(&sb, ',');
-	as_string_builder_append_uint64(&sb, as_cluster_get_delay_queue_timeout_count(cluster)); // Cumulative. Not reset on each interval.
+	as_string_builder_append_uint64(&sb, delay_queue_timeout_count); // Cumulative. Not reset on each interval.
 	as_string_builder_append(&sb, ",[");
 
 	for (uint32_t i = 0; i < as_event_loop_size; i++) {
@@ -585,10 +1149,21 @@ as_metrics_write_cluster(as_error* err, as_metrics_writer* mw, as_cluster* clust
 		as_string_builder_append_int(&sb, as_event_loop_get_process_size(loop));
 		as_string_builder_append_char(&sb, ',');
 		as_string_builder_append_uint(&sb, as_event_loop_get_queue_size(loop));
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, as_event_loop_get_execute_size(loop));
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, as_event_loop_get_lag(loop));
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, as_event_loop_get_lag_max(loop));
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, as_event_loop_get_busy_pct(loop));
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint(&sb, as_event_loop_get_commands_per_iteration(loop));
 		as_string_builder_append_char(&sb, ']');
 	}
 	as_string_builder_append(&sb, "],[");
 
+	as_node_metrics_shm* sum = cluster_shm ? cf_malloc(cluster_shm->metrics_node_size) : NULL;
 	as_nodes* nodes = as_nodes_reserve(cluster);
 	
 	for (uint32_t i = 0; i < nodes->size; i++) {
@@ -597,11 +1172,62 @@ as_metrics_write_cluster(as_error* err, as_metrics_writer* mw, as_cluster* clust
 		if (i > 0) {
 			as_string_builder_append_char(&sb, ',');
 		}
-		as_metrics_write_node(mw, &sb, node);
+
+		if (sum) {
+			as_metrics_sum_node_shm(cluster_shm, node->name, sum);
+		}
+		as_metrics_write_node(mw, &sb, node, sum);
 	}
 	as_nodes_release(nodes);
-	as_string_builder_append(&sb, "]]");
+	cf_free(sum);
+	as_string_builder_append(&sb, "],[");
+
+	as_latency_percentiles phases[AS_TEND_PHASE_MAX];
+	as_cluster_tend_stats(cluster, phases);
 
+	for (as_tend_phase i = 0; i < AS_TEND_PHASE_MAX; i++) {
+		as_latency_percentiles* lp = &phases[i];
+
+		if (i > 0) {
+			as_string_builder_append_char(&sb, ',');
+		}
+		as_string_builder_append(&sb, as_tend_phase_to_string(i));
+		as_string_builder_append_char(&sb, '[');
+		as_string_builder_append_uint64(&sb, lp->count);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, lp->p50);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, lp->p90);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, lp->p99);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, lp->p999);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, lp->max);
+		as_string_builder_append_char(&sb, ']');
+	}
+	as_string_builder_append_char(&sb, ']');
+
+#if defined(AS_MEM_STATS)
+	as_mem_tag_stats mem[AS_MEM_TAG_MAX];
+	as_mem_stats_get(mem);
+	as_string_builder_append(&sb, ",[");
+
+	for (uint32_t i = 0; i < AS_MEM_TAG_MAX; i++) {
+		if (i > 0) {
+			as_string_builder_append_char(&sb, ',');
+		}
+		as_string_builder_append(&sb, as_mem_tag_name((as_mem_tag)i));
+		as_string_builder_append_char(&sb, '[');
+		as_string_builder_append_uint64(&sb, mem[i].current);
+		as_string_builder_append_char(&sb, ',');
+		as_string_builder_append_uint64(&sb, mem[i].peak);
+		as_string_builder_append_char(&sb, ']');
+	}
+	as_string_builder_append_char(&sb, ']');
+#endif
+
+	as_string_builder_append_char(&sb, ']');
 	as_string_builder_append_newline(&sb);
 	as_status status = as_metrics_write_line(mw, sb.data, err);
 	as_string_builder_destroy(&sb);
@@ -634,6 +1260,10 @@ as_metrics_writer_create(as_error* err, const as_metrics_policy* policy, as_metr
 	mw->max_size = policy->report_size_limit;
 	mw->latency_columns = policy->latency_columns;
 	mw->latency_shift = policy->latency_shift;
+	mw->latency_precision = policy->latency_precision;
+	mw->hot_keys = policy->hot_keys;
+	mw->partition_heatmap = policy->partition_heatmap;
+	mw->tcp_info_interval = policy->tcp_info_interval;
 	mw->enable = false;
 
 #ifdef _MSC_VER
@@ -677,6 +1307,15 @@ as_metrics_writer_snapshot(as_error* err, as_cluster* cluster, void* udata)
 	as_metrics_writer* mw = udata;
 
 	if (mw->enable && mw->file != NULL) {
+		if (as_metrics_shm_enabled(cluster)) {
+			as_metrics_publish_shm(cluster);
+
+			if (! cluster->shm_info->is_tend_master) {
+				// Shared memory cluster tender writes metrics of all processes.
+				return AEROSPIKE_OK;
+			}
+		}
+
 		as_status status = as_metrics_write_cluster(err, mw, cluster);
 		if (status != AEROSPIKE_OK) {
 			return status;
@@ -698,6 +1337,19 @@ as_metrics_writer_node_close(as_error* err, as_node* node, void* udata)
 	as_metrics_writer* mw = udata;
 
 	if (mw->enable && mw->file != NULL) {
+		as_cluster* cluster = node->cluster;
+		as_node_metrics_shm* sum = NULL;
+
+		if (as_metrics_shm_enabled(cluster)) {
+			if (! cluster->shm_info->is_tend_master) {
+				return AEROSPIKE_OK;
+			}
+
+			as_cluster_shm* cluster_shm = cluster->shm_info->cluster_shm;
+			sum = cf_malloc(cluster_shm->metrics_node_size);
+			as_metrics_sum_node_shm(cluster_shm, node->name, sum);
+		}
+
 		char now_str[128];
 		timestamp_to_string(now_str, sizeof(now_str));
 		
@@ -705,12 +1357,13 @@ as_metrics_writer_node_close(as_error* err, as_node* node, void* udata)
 		as_string_builder_inita(&sb, 16384, true);
 		as_string_builder_append(&sb, now_str);
 		as_string_builder_append_char(&sb, ' ');
-		as_metrics_write_node(mw, &sb, node);
+		as_metrics_write_node(mw, &sb, node, sum);
 		as_string_builder_append_newline(&sb);
 		
 		as_status status = as_metrics_write_line(mw, sb.data, err);
 		
 		as_string_builder_destroy(&sb);
+		cf_free(sum);
 		return status;
 	}
 	return AEROSPIKE_OK;
@@ -727,7 +1380,13 @@ as_metrics_writer_disable(as_error* err, as_cluster* cluster, void* udata)
 		as_status status = AEROSPIKE_OK;
 		
 		if (mw->enable && mw->file != NULL) {
-			status = as_metrics_write_cluster(err, mw, cluster);
+			if (as_metrics_shm_enabled(cluster)) {
+				as_metrics_publish_shm(cluster);
+			}
+
+			if (! as_metrics_shm_enabled(cluster) || cluster->shm_info->is_tend_master) {
+				status = as_metrics_write_cluster(err, mw, cluster);
+			}
 		}
 		as_metrics_writer_destroy(mw);
 		return status;
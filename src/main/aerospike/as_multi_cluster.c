@@ -0,0 +1,591 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_multi_cluster.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_latency.h>
+#include <aerospike/as_node.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <pthread.h>
+#include <string.h>
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	aerospike* as;
+	uint64_t score_us;
+
+	// Reads routed through this layer since the last score update.
+	uint64_t window_reads;
+	uint64_t window_errors;
+	uint64_t window_us;
+
+	// Namespace metrics totals at the last score update. Only accessed while scoring.
+	uint64_t metrics_reads;
+	uint64_t metrics_us;
+	uint64_t metrics_errors;
+
+	uint64_t reads;
+	uint64_t read_errors;
+	uint64_t failovers;
+	uint64_t hedges;
+	uint64_t writes;
+} as_mc_cluster;
+
+struct as_multi_cluster_s {
+	as_multi_cluster_policy policy;
+	uint32_t n_clusters;
+	uint32_t scoring;
+	uint32_t probe_counter;
+	uint64_t next_score_ms;
+	as_mc_cluster clusters[AS_MULTI_CLUSTER_MAX];
+};
+
+struct as_mc_hedge_s;
+
+typedef struct {
+	struct as_mc_hedge_s* hedge;
+	uint64_t begin;
+	uint32_t index;
+} as_mc_leg;
+
+typedef struct as_mc_hedge_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	as_multi_cluster* mc;
+	as_record* rec;
+	as_error err;
+	as_mc_leg legs[2];
+	uint32_t ref_count;
+	uint32_t pending;
+	bool done;
+} as_mc_hedge;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+// Return true if a read that failed with status should be retried on another cluster.
+static bool
+as_mc_failover_status(as_status status)
+{
+	switch (status) {
+		case AEROSPIKE_ERR_MAX_RETRIES_EXCEEDED:
+		case AEROSPIKE_ERR_ASYNC_QUEUE_FULL:
+		case AEROSPIKE_ERR_CONNECTION:
+		case AEROSPIKE_ERR_TLS_ERROR:
+		case AEROSPIKE_ERR_INVALID_NODE:
+		case AEROSPIKE_ERR_NO_MORE_CONNECTIONS:
+		case AEROSPIKE_ERR_ASYNC_CONNECTION:
+		case AEROSPIKE_ERR_SERVER:
+		case AEROSPIKE_ERR_CLUSTER_CHANGE:
+		case AEROSPIKE_ERR_TIMEOUT:
+		case AEROSPIKE_ERR_CLUSTER:
+		case AEROSPIKE_ERR_DEVICE_OVERLOAD:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static void
+as_mc_record_read(as_mc_cluster* c, uint64_t begin, as_status status)
+{
+	as_incr_uint64(&c->reads);
+	as_incr_uint64(&c->window_reads);
+	as_faa_uint64(&c->window_us, (cf_getns() - begin) / 1000);
+
+	if (as_mc_failover_status(status)) {
+		as_incr_uint64(&c->read_errors);
+		as_incr_uint64(&c->window_errors);
+	}
+}
+
+// Sum read latency histograms and error counts of all nodes. Latency buckets count
+// milliseconds, so each sample is valued at the middle of its bucket.
+static bool
+as_mc_sum_metrics(as_cluster* cluster, uint64_t* reads, uint64_t* sum_us, uint64_t* errors)
+{
+	if (! cluster->metrics_enabled) {
+		return false;
+	}
+
+	*reads = 0;
+	*sum_us = 0;
+	*errors = 0;
+
+	as_nodes* nodes = as_nodes_reserve(cluster);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+		as_ns_metrics** array = node->metrics;
+		uint8_t max = node->metrics_size;
+
+		for (uint8_t j = 0; j < max; j++) {
+			as_ns_metrics* metrics = array[j];
+			as_latency* latency = as_latency_reserve(metrics->latency[AS_LATENCY_TYPE_READ]);
+			uint64_t lower = 0;
+			uint64_t upper = 1;
+
+			for (uint8_t b = 0; b < latency->size; b++) {
+				uint64_t count = as_latency_get_bucket(latency, b);
+				*reads += count;
+				*sum_us += count * (lower + upper) * 500;
+				lower = upper;
+				upper <<= latency->shift;
+			}
+			as_latency_release(latency);
+
+			*errors += as_node_get_error_count(metrics) + as_node_get_timeout_count(metrics);
+		}
+	}
+	as_nodes_release(nodes);
+	return true;
+}
+
+static void
+as_mc_update_scores(as_multi_cluster* mc)
+{
+	for (uint32_t i = 0; i < mc->n_clusters; i++) {
+		as_mc_cluster* c = &mc->clusters[i];
+
+		// Consume routed reads even when metrics are used, so they do not pile up.
+		uint64_t window_reads = as_fas_uint64(&c->window_reads, 0);
+		uint64_t window_errors = as_fas_uint64(&c->window_errors, 0);
+		uint64_t window_us = as_fas_uint64(&c->window_us, 0);
+
+		if (! as_cluster_is_connected(c->as->cluster)) {
+			as_store_uint64(&c->score_us, UINT64_MAX);
+			continue;
+		}
+
+		uint64_t reads = window_reads;
+		uint64_t errors = window_errors;
+		uint64_t sum_us = window_us;
+		uint64_t m_reads, m_sum_us, m_errors;
+
+		if (as_mc_sum_metrics(c->as->cluster, &m_reads, &m_sum_us, &m_errors)) {
+			// Totals shrink when nodes are removed. Restart from the new totals then.
+			if (m_reads > c->metrics_reads && m_sum_us >= c->metrics_us &&
+				m_errors >= c->metrics_errors) {
+				reads = m_reads - c->metrics_reads;
+				sum_us = m_sum_us - c->metrics_us;
+				errors = m_errors - c->metrics_errors;
+			}
+			c->metrics_reads = m_reads;
+			c->metrics_us = m_sum_us;
+			c->metrics_errors = m_errors;
+		}
+
+		uint64_t score = as_load_uint64(&c->score_us);
+
+		if (reads > 0) {
+			uint64_t error_pct = errors * 100 / (reads + errors);
+			score = sum_us / reads + error_pct * mc->policy.error_penalty_us;
+		}
+		else if (score == UINT64_MAX) {
+			// Reconnected cluster without samples competes again.
+			score = 0;
+		}
+		as_store_uint64(&c->score_us, score);
+	}
+}
+
+// Fill order with cluster indexes from best to worst score.
+static void
+as_mc_rank(as_multi_cluster* mc, uint32_t* order)
+{
+	uint64_t now = cf_getms();
+
+	if (now >= as_load_uint64(&mc->next_score_ms) && as_cas_uint32(&mc->scoring, 0, 1)) {
+		as_mc_update_scores(mc);
+		as_store_uint64(&mc->next_score_ms, now + mc->policy.score_interval_ms);
+		as_store_uint32(&mc->scoring, 0);
+	}
+
+	uint32_t n = mc->n_clusters;
+	uint64_t scores[AS_MULTI_CLUSTER_MAX];
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint64_t score = as_load_uint64(&mc->clusters[i].score_us);
+		uint32_t k = i;
+
+		// Insertion sort. Ties keep configuration order.
+		while (k > 0 && scores[k - 1] > score) {
+			scores[k] = scores[k - 1];
+			order[k] = order[k - 1];
+			k--;
+		}
+		scores[k] = score;
+		order[k] = i;
+	}
+
+	if (n > 1 && mc->policy.probe_pct > 0) {
+		uint32_t counter = as_faa_uint32(&mc->probe_counter, 1);
+
+		if (counter % 100 < mc->policy.probe_pct) {
+			// Probe a connected cluster other than the best.
+			uint32_t k = 1 + (counter / 100) % (n - 1);
+
+			if (scores[k] != UINT64_MAX) {
+				uint32_t tmp = order[0];
+				order[0] = order[k];
+				order[k] = tmp;
+			}
+		}
+	}
+}
+
+static void
+as_mc_hedge_release(as_mc_hedge* h)
+{
+	pthread_mutex_lock(&h->lock);
+	bool destroy = --h->ref_count == 0;
+	pthread_mutex_unlock(&h->lock);
+
+	if (destroy) {
+		if (h->rec) {
+			as_record_destroy(h->rec);
+		}
+		pthread_cond_destroy(&h->cond);
+		pthread_mutex_destroy(&h->lock);
+		cf_free(h);
+	}
+}
+
+static void
+as_mc_hedge_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	as_mc_leg* leg = udata;
+	as_mc_hedge* h = leg->hedge;
+
+	as_mc_record_read(&h->mc->clusters[leg->index], leg->begin, err ? err->code : AEROSPIKE_OK);
+
+	pthread_mutex_lock(&h->lock);
+
+	if (! h->done) {
+		if (err) {
+			as_error_copy(&h->err, err);
+			// Answers such as record not found are final. Other errors wait for the other leg.
+			h->done = ! as_mc_failover_status(err->code);
+		}
+		else {
+			as_error_reset(&h->err);
+			h->rec = rec;
+			h->done = true;
+			rec = NULL;
+		}
+	}
+	h->pending--;
+	pthread_cond_signal(&h->cond);
+	pthread_mutex_unlock(&h->lock);
+
+	if (rec) {
+		// Losing leg owns a heap record.
+		as_record_destroy(rec);
+	}
+	as_mc_hedge_release(h);
+}
+
+// Must hold hedge lock. Lock is released while the command is queued.
+static void
+as_mc_hedge_start(as_mc_hedge* h, uint32_t leg_index, uint32_t index, const as_policy_read* policy,
+	const as_key* key)
+{
+	as_multi_cluster* mc = h->mc;
+	as_mc_cluster* c = &mc->clusters[index];
+	as_mc_leg* leg = &h->legs[leg_index];
+
+	// The listener owns records, so a losing leg can release its record.
+	as_policy_read p = policy ? *policy : aerospike_load_config(c->as)->policies.read;
+	p.async_heap_rec = true;
+
+	leg->hedge = h;
+	leg->index = index;
+	leg->begin = cf_getns();
+	h->ref_count++;
+	h->pending++;
+	pthread_mutex_unlock(&h->lock);
+
+	as_error err;
+	as_status status = aerospike_key_get_async(c->as, &err, &p, key, as_mc_hedge_listener, leg,
+		NULL, NULL);
+
+	pthread_mutex_lock(&h->lock);
+
+	if (status != AEROSPIKE_OK) {
+		// Listener is not called.
+		as_mc_record_read(c, leg->begin, status);
+		h->ref_count--;
+		h->pending--;
+
+		if (! h->done) {
+			as_error_copy(&h->err, &err);
+		}
+	}
+}
+
+static as_status
+as_mc_get_hedged(
+	as_multi_cluster* mc, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_record** rec, const uint32_t* order
+	)
+{
+	as_mc_hedge* h = cf_malloc(sizeof(as_mc_hedge));
+	pthread_mutex_init(&h->lock, NULL);
+	pthread_cond_init(&h->cond, NULL);
+	h->mc = mc;
+	h->rec = NULL;
+	as_error_init(&h->err);
+	h->ref_count = 1;
+	h->pending = 0;
+	h->done = false;
+
+	pthread_mutex_lock(&h->lock);
+	as_mc_hedge_start(h, 0, order[0], policy, key);
+
+	if (! h->done && h->pending > 0) {
+		struct timespec delta;
+		struct timespec abstime;
+		cf_clock_set_timespec_ms(mc->policy.hedge_delay_ms, &delta);
+		cf_clock_current_add(&delta, &abstime);
+
+		while (! h->done && h->pending > 0) {
+			if (pthread_cond_timedwait(&h->cond, &h->lock, &abstime) != 0) {
+				break;
+			}
+		}
+	}
+
+	if (! h->done) {
+		// First cluster is slow or failed. Start the same read on the next best cluster.
+		as_mc_cluster* first = &mc->clusters[order[0]];
+
+		if (h->pending > 0) {
+			as_incr_uint64(&mc->clusters[order[1]].hedges);
+		}
+		else {
+			as_incr_uint64(&first->failovers);
+		}
+		as_mc_hedge_start(h, 1, order[1], policy, key);
+
+		while (! h->done && h->pending > 0) {
+			pthread_cond_wait(&h->cond, &h->lock);
+		}
+	}
+
+	as_status status = h->err.code;
+
+	if (status == AEROSPIKE_OK) {
+		*rec = h->rec;
+		h->rec = NULL;
+	}
+	else {
+		as_error_copy(err, &h->err);
+	}
+	pthread_mutex_unlock(&h->lock);
+	as_mc_hedge_release(h);
+	return status;
+}
+
+static as_status
+as_mc_read(
+	as_multi_cluster* mc, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record** rec
+	)
+{
+	as_error_reset(err);
+
+	uint32_t order[AS_MULTI_CLUSTER_MAX];
+	as_mc_rank(mc, order);
+
+	uint32_t start = 0;
+
+	if (mc->policy.hedge_delay_ms > 0 && ! bins && *rec == NULL && mc->n_clusters > 1 &&
+		as_event_loop_size > 0) {
+		as_status status = as_mc_get_hedged(mc, err, policy, key, rec, order);
+
+		if (! as_mc_failover_status(status) || mc->n_clusters == 2) {
+			return status;
+		}
+		// Both hedged clusters failed. Fail over to the remaining clusters.
+		start = 2;
+	}
+
+	as_status status = AEROSPIKE_OK;
+
+	for (uint32_t k = start; k < mc->n_clusters; k++) {
+		as_mc_cluster* c = &mc->clusters[order[k]];
+		uint64_t begin = cf_getns();
+
+		status = bins ?
+			aerospike_key_select(c->as, err, policy, key, bins, rec) :
+			aerospike_key_get(c->as, err, policy, key, rec);
+
+		as_mc_record_read(c, begin, status);
+
+		if (! as_mc_failover_status(status)) {
+			return status;
+		}
+
+		if (k + 1 < mc->n_clusters) {
+			as_incr_uint64(&c->failovers);
+		}
+	}
+	return status;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_multi_cluster_policy_init(as_multi_cluster_policy* policy)
+{
+	policy->primary = 0;
+	policy->score_interval_ms = 1000;
+	policy->error_penalty_us = 10000;
+	policy->probe_pct = 1;
+	policy->hedge_delay_ms = 0;
+}
+
+as_multi_cluster*
+as_multi_cluster_create(
+	as_error* err, aerospike** clusters, uint32_t n_clusters, const as_multi_cluster_policy* policy
+	)
+{
+	as_error_reset(err);
+
+	if (n_clusters == 0 || n_clusters > AS_MULTI_CLUSTER_MAX) {
+		as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid cluster count: %u", n_clusters);
+		return NULL;
+	}
+
+	as_multi_cluster_policy def;
+
+	if (! policy) {
+		as_multi_cluster_policy_init(&def);
+		policy = &def;
+	}
+
+	if (policy->primary >= n_clusters) {
+		as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid primary cluster: %u", policy->primary);
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < n_clusters; i++) {
+		if (! clusters[i] || ! clusters[i]->cluster) {
+			as_error_update(err, AEROSPIKE_ERR_PARAM, "Cluster %u is not connected", i);
+			return NULL;
+		}
+	}
+
+	as_multi_cluster* mc = cf_malloc(sizeof(as_multi_cluster));
+	memset(mc, 0, sizeof(as_multi_cluster));
+	mc->policy = *policy;
+	mc->n_clusters = n_clusters;
+
+	for (uint32_t i = 0; i < n_clusters; i++) {
+		mc->clusters[i].as = clusters[i];
+	}
+	return mc;
+}
+
+void
+as_multi_cluster_destroy(as_multi_cluster* mc)
+{
+	cf_free(mc);
+}
+
+as_status
+as_multi_cluster_get(
+	as_multi_cluster* mc, as_error* err, const as_policy_read* policy, const as_key* key,
+	as_record** rec
+	)
+{
+	return as_mc_read(mc, err, policy, key, NULL, rec);
+}
+
+as_status
+as_multi_cluster_select(
+	as_multi_cluster* mc, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record** rec
+	)
+{
+	return as_mc_read(mc, err, policy, key, bins, rec);
+}
+
+as_status
+as_multi_cluster_put(
+	as_multi_cluster* mc, as_error* err, const as_policy_write* policy, const as_key* key,
+	as_record* rec
+	)
+{
+	as_mc_cluster* c = &mc->clusters[mc->policy.primary];
+	as_incr_uint64(&c->writes);
+	return aerospike_key_put(c->as, err, policy, key, rec);
+}
+
+as_status
+as_multi_cluster_remove(
+	as_multi_cluster* mc, as_error* err, const as_policy_remove* policy, const as_key* key
+	)
+{
+	as_mc_cluster* c = &mc->clusters[mc->policy.primary];
+	as_incr_uint64(&c->writes);
+	return aerospike_key_remove(c->as, err, policy, key);
+}
+
+as_status
+as_multi_cluster_operate(
+	as_multi_cluster* mc, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_operations* ops, as_record** rec
+	)
+{
+	as_mc_cluster* c = &mc->clusters[mc->policy.primary];
+	as_incr_uint64(&c->writes);
+	return aerospike_key_operate(c->as, err, policy, key, ops, rec);
+}
+
+aerospike*
+as_multi_cluster_primary(as_multi_cluster* mc)
+{
+	return mc->clusters[mc->policy.primary].as;
+}
+
+bool
+as_multi_cluster_get_stats(as_multi_cluster* mc, uint32_t index, as_multi_cluster_stats* stats)
+{
+	if (index >= mc->n_clusters) {
+		return false;
+	}
+
+	as_mc_cluster* c = &mc->clusters[index];
+	stats->score_us = as_load_uint64(&c->score_us);
+	stats->reads = as_load_uint64(&c->reads);
+	stats->read_errors = as_load_uint64(&c->read_errors);
+	stats->failovers = as_load_uint64(&c->failovers);
+	stats->hedges = as_load_uint64(&c->hedges);
+	stats->writes = as_load_uint64(&c->writes);
+	return true;
+}
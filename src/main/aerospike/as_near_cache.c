@@ -0,0 +1,654 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_near_cache.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline uint32_t
+as_near_cache_hash(const as_digest_value digest, uint32_t offset)
+{
+	// Digests are uniformly distributed, so digest bytes are used directly.
+	uint32_t h;
+	memcpy(&h, digest + offset, sizeof(h));
+	return h;
+}
+
+static inline as_near_cache_shard*
+as_near_cache_get_shard(as_near_cache* cache, const as_key* key)
+{
+	return &cache->shards[as_near_cache_hash(key->digest.value, 4) % cache->n_shards];
+}
+
+static inline as_near_cache_entry**
+as_near_cache_get_bucket(as_near_cache_shard* shard, const as_key* key)
+{
+	return &shard->buckets[as_near_cache_hash(key->digest.value, 0) % shard->n_buckets];
+}
+
+// Must hold shard lock.
+static as_near_cache_entry*
+as_near_cache_find(as_near_cache_shard* shard, const as_key* key)
+{
+	as_near_cache_entry* entry = *as_near_cache_get_bucket(shard, key);
+
+	while (entry) {
+		if (memcmp(entry->digest, key->digest.value, AS_DIGEST_VALUE_SIZE) == 0 &&
+			strcmp(entry->ns, key->ns) == 0) {
+			return entry;
+		}
+		entry = entry->next;
+	}
+	return NULL;
+}
+
+static void
+as_near_cache_copy_bins(const as_record* src, as_record* trg)
+{
+	// Values that are stored in the bin itself are copied. Heap allocated values are reference
+	// counted and shared. Shared values may reference the response buffer, so the buffer is
+	// shared too.
+	if (src->buffer) {
+		as_record_set_buffer(trg, as_record_buffer_reserve(src->buffer));
+	}
+
+	// Raw list and map bytes of lazy records are copied as bytes and deserialized on
+	// first access of the copy.
+	if (src->lazy) {
+		trg->lazy = true;
+	}
+
+	for (uint16_t i = 0; i < src->bins.size; i++) {
+		const as_bin* bin = &src->bins.entries[i];
+		as_val* v = (as_val*)bin->valuep;
+
+		if (! v || as_val_type(v) == AS_NIL) {
+			as_record_set_nil(trg, bin->name);
+			continue;
+		}
+
+		if (bin->valuep != &bin->value) {
+			as_record_set(trg, bin->name, (as_bin_value*)as_val_reserve(v));
+			continue;
+		}
+
+		switch (as_val_type(v)) {
+			case AS_BOOLEAN:
+				as_record_set_bool(trg, bin->name, as_boolean_get((as_boolean*)v));
+				break;
+
+			case AS_INTEGER:
+				as_record_set_int64(trg, bin->name, as_integer_get((as_integer*)v));
+				break;
+
+			case AS_DOUBLE:
+				as_record_set_double(trg, bin->name, as_double_get((as_double*)v));
+				break;
+
+			case AS_STRING: {
+				as_string* s = (as_string*)v;
+				size_t len = as_string_len(s);
+				char* value = cf_malloc(len + 1);
+				memcpy(value, s->value, len + 1);
+				as_record_set_strp(trg, bin->name, value, true);
+				break;
+			}
+
+			case AS_GEOJSON: {
+				as_geojson* g = (as_geojson*)v;
+				size_t len = as_geojson_len(g);
+				char* value = cf_malloc(len + 1);
+				memcpy(value, g->value, len + 1);
+				as_record_set_geojson_strp(trg, bin->name, value, true);
+				break;
+			}
+
+			case AS_BYTES: {
+				as_bytes* b = (as_bytes*)v;
+				uint8_t* value = cf_malloc(b->size);
+				memcpy(value, b->value, b->size);
+				as_record_set_raw_typep(trg, bin->name, value, b->size, b->type, true);
+				break;
+			}
+
+			default:
+				// Lists and maps are always heap allocated when parsed.
+				break;
+		}
+	}
+}
+
+static as_record*
+as_near_cache_copy(const as_record* src, as_record* trg)
+{
+	if (trg) {
+		// Populate caller's record like aerospike_key_get() does.
+		as_bin* bin = trg->bins.entries;
+
+		for (uint16_t i = 0; i < trg->bins.size; i++, bin++) {
+			as_val_destroy((as_val*)bin->valuep);
+			bin->valuep = NULL;
+		}
+		trg->bins.size = 0;
+
+		if (src->bins.size > trg->bins.capacity) {
+			if (trg->bins._free) {
+				cf_free(trg->bins.entries);
+			}
+			trg->bins.capacity = src->bins.size;
+			trg->bins.entries = cf_malloc(sizeof(as_bin) * src->bins.size);
+			trg->bins._free = true;
+		}
+	}
+	else {
+		trg = as_record_new(src->bins.size);
+	}
+	trg->gen = src->gen;
+	trg->ttl = src->ttl;
+	as_near_cache_copy_bins(src, trg);
+	return trg;
+}
+
+// Must hold shard write lock.
+static void
+as_near_cache_unlink(as_near_cache_shard* shard, as_near_cache_entry* entry)
+{
+	as_near_cache_entry** prev = &shard->buckets[
+		as_near_cache_hash(entry->digest, 0) % shard->n_buckets];
+
+	while (*prev != entry) {
+		prev = &(*prev)->next;
+	}
+	*prev = entry->next;
+}
+
+static void
+as_near_cache_entry_destroy(as_near_cache_entry* entry)
+{
+	as_record_destroy(entry->rec);
+	cf_free(entry);
+}
+
+// Must hold shard write lock.
+static void
+as_near_cache_remove_entry(as_near_cache_shard* shard, as_near_cache_entry* entry)
+{
+	as_near_cache_unlink(shard, entry);
+
+	uint32_t last = --shard->size;
+
+	if (entry->slot != last) {
+		as_near_cache_entry* move = shard->ring[last];
+		shard->ring[entry->slot] = move;
+		move->slot = entry->slot;
+	}
+
+	if (shard->hand >= shard->size) {
+		shard->hand = 0;
+	}
+	as_near_cache_entry_destroy(entry);
+}
+
+// Must hold shard write lock.
+static void
+as_near_cache_insert(as_near_cache_shard* shard, as_near_cache_entry* entry, const as_key* key)
+{
+	if (shard->size < shard->capacity) {
+		entry->slot = shard->size;
+		shard->ring[shard->size++] = entry;
+	}
+	else {
+		// CLOCK eviction. Entries read since the hand last passed get a second chance.
+		while (true) {
+			as_near_cache_entry* victim = shard->ring[shard->hand];
+
+			if (as_load_uint8(&victim->referenced)) {
+				as_store_uint8(&victim->referenced, 0);
+				shard->hand = (shard->hand + 1) % shard->size;
+				continue;
+			}
+
+			as_near_cache_unlink(shard, victim);
+			as_near_cache_entry_destroy(victim);
+			entry->slot = shard->hand;
+			shard->ring[shard->hand] = entry;
+			shard->hand = (shard->hand + 1) % shard->size;
+			break;
+		}
+	}
+
+	as_near_cache_entry** bucket = as_near_cache_get_bucket(shard, key);
+	entry->next = *bucket;
+	*bucket = entry;
+}
+
+static void
+as_near_cache_put(as_near_cache* cache, const as_key* key, const as_record* rec, uint64_t now)
+{
+	uint64_t ttl_ms = cache->ttl_ms;
+	uint64_t record_ms = (uint64_t)rec->ttl * 1000;
+
+	if (record_ms < ttl_ms) {
+		ttl_ms = record_ms;
+	}
+
+	if (ttl_ms == 0) {
+		return;
+	}
+
+	as_near_cache_entry* entry = cf_malloc(sizeof(as_near_cache_entry));
+	entry->rec = as_near_cache_copy(rec, NULL);
+	entry->expires_ms = now + ttl_ms;
+	entry->validated_ms = now;
+	entry->referenced = 0;
+	memcpy(entry->digest, key->digest.value, AS_DIGEST_VALUE_SIZE);
+	as_strncpy(entry->ns, key->ns, AS_NAMESPACE_MAX_SIZE);
+
+	as_near_cache_shard* shard = as_near_cache_get_shard(cache, key);
+
+	pthread_rwlock_wrlock(&shard->lock);
+
+	as_near_cache_entry* old = as_near_cache_find(shard, key);
+
+	if (old) {
+		as_near_cache_remove_entry(shard, old);
+	}
+	as_near_cache_insert(shard, entry, key);
+	pthread_rwlock_unlock(&shard->lock);
+}
+
+static void
+as_near_cache_add_metrics(aerospike* as, const as_key* key, bool hit)
+{
+	// Counts are attributed to the partition's master node.
+	as_cluster* cluster = as->cluster;
+	as_partition_info pi;
+	as_error err;
+
+	if (as_partition_info_init(&pi, cluster, &err, key) != AEROSPIKE_OK) {
+		return;
+	}
+
+	uint8_t replica_index = 0;
+	as_node* node = as_partition_get_node(cluster, pi.ns, pi.partition, NULL,
+		AS_POLICY_REPLICA_MASTER, pi.replica_size, &replica_index);
+
+	if (node) {
+		as_node_add_near_cache(node, pi.ns, hit);
+	}
+}
+
+typedef enum {
+	AS_NEAR_CACHE_MISS,
+	AS_NEAR_CACHE_HIT,
+	AS_NEAR_CACHE_VALIDATE
+} as_near_cache_result;
+
+static as_near_cache_result
+as_near_cache_lookup(
+	as_near_cache* cache, const as_key* key, uint64_t now, as_record** rec, uint16_t* gen
+	)
+{
+	as_near_cache_shard* shard = as_near_cache_get_shard(cache, key);
+	as_near_cache_result result = AS_NEAR_CACHE_MISS;
+
+	pthread_rwlock_rdlock(&shard->lock);
+
+	as_near_cache_entry* entry = as_near_cache_find(shard, key);
+
+	if (entry && now < entry->expires_ms) {
+		if (cache->validate_ms &&
+			now >= as_load_uint64(&entry->validated_ms) + cache->validate_ms) {
+			*gen = entry->rec->gen;
+			result = AS_NEAR_CACHE_VALIDATE;
+		}
+		else {
+			if (! as_load_uint8(&entry->referenced)) {
+				as_store_uint8(&entry->referenced, 1);
+			}
+			*rec = as_near_cache_copy(entry->rec, *rec);
+			result = AS_NEAR_CACHE_HIT;
+		}
+	}
+	pthread_rwlock_unlock(&shard->lock);
+	return result;
+}
+
+static bool
+as_near_cache_revalidate(
+	as_near_cache* cache, const as_key* key, uint16_t gen, uint64_t now, as_record** rec
+	)
+{
+	as_near_cache_shard* shard = as_near_cache_get_shard(cache, key);
+	bool valid = false;
+
+	pthread_rwlock_rdlock(&shard->lock);
+
+	as_near_cache_entry* entry = as_near_cache_find(shard, key);
+
+	// The entry may have been replaced while the server was validating it.
+	if (entry && entry->rec->gen == gen && now < entry->expires_ms) {
+		as_store_uint64(&entry->validated_ms, now);
+		as_store_uint8(&entry->referenced, 1);
+		*rec = as_near_cache_copy(entry->rec, *rec);
+		valid = true;
+	}
+	pthread_rwlock_unlock(&shard->lock);
+	return valid;
+}
+
+static void
+as_near_cache_remove_key(as_near_cache* cache, const as_key* key)
+{
+	as_near_cache_shard* shard = as_near_cache_get_shard(cache, key);
+
+	pthread_rwlock_wrlock(&shard->lock);
+
+	as_near_cache_entry* entry = as_near_cache_find(shard, key);
+
+	if (entry) {
+		as_near_cache_remove_entry(shard, entry);
+	}
+	pthread_rwlock_unlock(&shard->lock);
+}
+
+// Serve read from the cache file. Return false if the record must be read in full.
+static bool
+as_near_cache_get_file(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_read* policy,
+	const as_key* key, as_record** rec, as_status* status
+	)
+{
+	uint32_t now = as_near_cache_file_now();
+	as_record* cached = NULL;
+	as_near_cache_file_result result = as_near_cache_file_get(cache->file, key, now, &cached);
+
+	if (result == AS_NEAR_CACHE_FILE_MISS) {
+		return false;
+	}
+
+	if (result == AS_NEAR_CACHE_FILE_VALIDATE) {
+		as_record* header = NULL;
+
+		as_incr_uint64(&cache->validations);
+		*status = aerospike_key_exists(as, err, policy, key, &header);
+
+		if (*status != AEROSPIKE_OK) {
+			if (*status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+				as_near_cache_file_remove(cache->file, key);
+			}
+			as_record_destroy(cached);
+			return true;
+		}
+
+		bool valid = header->gen == cached->gen &&
+			as_near_cache_file_validated(cache->file, key, header->gen, header->ttl, now);
+
+		cached->ttl = header->ttl;
+		as_record_destroy(header);
+
+		if (! valid) {
+			as_record_destroy(cached);
+			return false;
+		}
+	}
+
+	as_near_cache_put(cache, key, cached, cf_getms());
+
+	if (*rec) {
+		*rec = as_near_cache_copy(cached, *rec);
+		as_record_destroy(cached);
+	}
+	else {
+		*rec = cached;
+	}
+	*status = AEROSPIKE_OK;
+	return true;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_near_cache_config_init(as_near_cache_config* config)
+{
+	config->max_entries = 10000;
+	config->shards = 16;
+	config->ttl_ms = 1000;
+	config->validate_ms = 0;
+	config->file_path = NULL;
+	config->file_size = (uint64_t)1024 * 1024 * 1024;
+	config->file_max_entries = 1000000;
+	config->file_validate_sec = 600;
+}
+
+as_near_cache*
+as_near_cache_create(const as_near_cache_config* config)
+{
+	if (config->shards == 0 || config->max_entries < config->shards || config->ttl_ms == 0) {
+		return NULL;
+	}
+
+	as_near_cache* cache = cf_malloc(sizeof(as_near_cache));
+	memset(cache, 0, sizeof(as_near_cache));
+	cache->n_shards = config->shards;
+	cache->ttl_ms = config->ttl_ms;
+	cache->validate_ms = config->validate_ms;
+	cache->shards = cf_malloc(sizeof(as_near_cache_shard) * cache->n_shards);
+
+	uint32_t capacity = (config->max_entries + cache->n_shards - 1) / cache->n_shards;
+
+	for (uint32_t i = 0; i < cache->n_shards; i++) {
+		as_near_cache_shard* shard = &cache->shards[i];
+		pthread_rwlock_init(&shard->lock, NULL);
+		shard->n_buckets = capacity;
+		shard->buckets = cf_calloc(shard->n_buckets, sizeof(as_near_cache_entry*));
+		shard->ring = cf_malloc(sizeof(as_near_cache_entry*) * capacity);
+		shard->capacity = capacity;
+		shard->size = 0;
+		shard->hand = 0;
+	}
+
+	if (config->file_path) {
+		as_error err;
+		as_error_init(&err);
+
+		if (as_near_cache_file_open(&cache->file, &err, config->file_path, config->file_size,
+			config->file_max_entries, config->file_validate_sec) != AEROSPIKE_OK) {
+			as_log_error("Near cache file %s: %s", config->file_path, err.message);
+			as_near_cache_destroy(cache);
+			return NULL;
+		}
+	}
+	return cache;
+}
+
+void
+as_near_cache_destroy(as_near_cache* cache)
+{
+	for (uint32_t i = 0; i < cache->n_shards; i++) {
+		as_near_cache_shard* shard = &cache->shards[i];
+
+		for (uint32_t j = 0; j < shard->size; j++) {
+			as_near_cache_entry_destroy(shard->ring[j]);
+		}
+		cf_free(shard->ring);
+		cf_free(shard->buckets);
+		pthread_rwlock_destroy(&shard->lock);
+	}
+	cf_free(cache->shards);
+
+	if (cache->file) {
+		as_near_cache_file_close(cache->file);
+	}
+	cf_free(cache);
+}
+
+as_status
+as_near_cache_remove(as_near_cache* cache, as_error* err, const as_key* key)
+{
+	as_error_reset(err);
+
+	as_status status = as_key_set_digest(err, (as_key*)key);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+	as_near_cache_remove_key(cache, key);
+
+	if (cache->file) {
+		as_near_cache_file_remove(cache->file, key);
+	}
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_near_cache_validate(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_batch* policy
+	)
+{
+	if (! cache->file) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Near cache has no file");
+	}
+	return as_near_cache_file_validate(cache->file, as, err, policy);
+}
+
+as_status
+as_near_cache_load(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_scan* scan_policy,
+	const as_policy_batch* batch_policy, const char* ns, const char* set
+	)
+{
+	if (! cache->file) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Near cache has no file");
+	}
+	return as_near_cache_file_load(cache->file, as, err, scan_policy, batch_policy, ns, set);
+}
+
+as_status
+aerospike_key_get_cached(
+	aerospike* as, as_error* err, as_near_cache* cache, const as_policy_read* policy,
+	const as_key* key, as_record** rec
+	)
+{
+	if (! policy) {
+		policy = &aerospike_load_config(as)->policies.read;
+	}
+
+	if (policy->base.txn || policy->base.filter_exp || policy->read_touch_ttl_percent) {
+		return aerospike_key_get(as, err, policy, key, rec);
+	}
+
+	as_error_reset(err);
+
+	as_status status = as_key_set_digest(err, (as_key*)key);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	uint64_t now = cf_getms();
+	uint16_t gen = 0;
+	as_near_cache_result result = as_near_cache_lookup(cache, key, now, rec, &gen);
+
+	if (result == AS_NEAR_CACHE_VALIDATE) {
+		// Header-only read returns the generation without the bins.
+		as_record* header = NULL;
+
+		as_incr_uint64(&cache->validations);
+		status = aerospike_key_exists(as, err, policy, key, &header);
+
+		if (status == AEROSPIKE_OK) {
+			bool valid = header->gen == gen &&
+				as_near_cache_revalidate(cache, key, gen, cf_getms(), rec);
+
+			as_record_destroy(header);
+
+			if (valid) {
+				result = AS_NEAR_CACHE_HIT;
+			}
+		}
+		else if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			as_near_cache_remove_key(cache, key);
+
+			if (cache->file) {
+				as_near_cache_file_remove(cache->file, key);
+			}
+			as_incr_uint64(&cache->misses);
+			as_near_cache_add_metrics(as, key, false);
+			return status;
+		}
+		else {
+			return status;
+		}
+	}
+
+	if (result == AS_NEAR_CACHE_HIT) {
+		as_incr_uint64(&cache->hits);
+		as_near_cache_add_metrics(as, key, true);
+		return AEROSPIKE_OK;
+	}
+
+	// A record that failed in-process validation changed, so its file record is stale too.
+	if (result == AS_NEAR_CACHE_MISS && cache->file &&
+		as_near_cache_get_file(as, err, cache, policy, key, rec, &status)) {
+		if (status == AEROSPIKE_OK) {
+			as_incr_uint64(&cache->hits);
+			as_incr_uint64(&cache->file_hits);
+			as_near_cache_add_metrics(as, key, true);
+		}
+		else if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			as_near_cache_remove_key(cache, key);
+			as_incr_uint64(&cache->misses);
+			as_near_cache_add_metrics(as, key, false);
+		}
+		return status;
+	}
+
+	as_incr_uint64(&cache->misses);
+	as_near_cache_add_metrics(as, key, false);
+
+	status = aerospike_key_get(as, err, policy, key, rec);
+
+	if (status == AEROSPIKE_OK) {
+		as_near_cache_put(cache, key, *rec, cf_getms());
+
+		if (cache->file) {
+			as_near_cache_file_put(cache->file, key->ns, key->set, key->digest.value, *rec,
+				as_near_cache_file_now());
+		}
+	}
+	else if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+		as_near_cache_remove_key(cache, key);
+
+		if (cache->file) {
+			as_near_cache_file_remove(cache->file, key);
+		}
+	}
+	return status;
+}
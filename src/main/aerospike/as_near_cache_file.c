@@ -0,0 +1,1009 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_near_cache_file.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_scan.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_msgpack.h>
+#include <aerospike/as_serializer.h>
+#include <citrusleaf/alloc.h>
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_NC_FILE_MAGIC 0x41534e43
+#define AS_NC_FILE_VERSION 1
+
+// Maximum number of distinct namespace and set pairs in a file.
+#define AS_NC_FILE_NAMES 64
+
+// Digests per header-only validation batch and per batch read during load.
+#define AS_NC_FILE_BATCH 5000
+
+// Smallest ring of encoded records.
+#define AS_NC_FILE_MIN_DATA (1024 * 1024)
+
+#define AS_NC_FILE_ALIGN(_n) (((_n) + 7) & ~(uint64_t)7)
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	as_namespace ns;
+	as_set set;
+} as_nc_file_name;
+
+// File header. Ring offsets are logical and grow without bound. The physical position is the
+// offset modulo data_size.
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t n_slots;
+	uint64_t data_size;
+	uint64_t head;
+	uint64_t tail;
+	uint64_t count;
+	uint32_t max_entries;
+	uint32_t n_names;
+	as_nc_file_name names[AS_NC_FILE_NAMES];
+} as_nc_file_header;
+
+// Slot table entry. The table uses linear probing and backward shift deletion. Timestamps are
+// wall clock seconds. Zero expires means the record never expires.
+typedef struct {
+	uint64_t offset;
+	uint32_t size;
+	uint32_t expires;
+	uint32_t validated;
+	uint16_t gen;
+	uint8_t used;
+	uint8_t name_id;
+	as_digest_value digest;
+} as_nc_file_slot;
+
+// Ring record header followed by encoded bins: bin count (2) | { name length (1) | name |
+// value size (4) | value }. Values are msgpack encoded. Zero size marks the unused end of the
+// ring before it wraps.
+typedef struct {
+	uint32_t size;
+	uint32_t bins_size;
+	uint8_t name_id;
+	uint8_t pad[3];
+	as_digest_value digest;
+} as_nc_file_record;
+
+struct as_near_cache_file_s {
+	pthread_rwlock_t lock;
+	as_nc_file_header* header;
+	as_nc_file_slot* slots;
+	uint8_t* data;
+	size_t size;
+	uint32_t validate_sec;
+	int fd;
+};
+
+typedef struct {
+	uint8_t* p;
+	uint8_t* end;
+} as_nc_file_reader;
+
+typedef struct {
+	pthread_mutex_t lock;
+	as_near_cache_file* file;
+	aerospike* as;
+	const as_policy_batch* policy;
+	as_batch_digests batch;
+	uint32_t name_id;
+	as_status status;
+	as_error err;
+} as_nc_file_loader;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline uint64_t
+as_nc_file_hash(const uint8_t* digest)
+{
+	// The near cache shards use the leading digest bytes.
+	uint64_t h;
+	memcpy(&h, digest + 8, sizeof(h));
+	return h;
+}
+
+static inline uint32_t
+as_nc_file_expires(uint32_t ttl, uint32_t now)
+{
+	return (ttl == AS_RECORD_NO_EXPIRE_TTL) ? 0 : now + ttl;
+}
+
+static void
+as_nc_file_layout(
+	uint64_t size, uint32_t max_entries, uint64_t* n_slots, uint64_t* slots_off,
+	uint64_t* data_off, uint64_t* data_size
+	)
+{
+	// Keep the slot table at most half full so probe sequences stay short.
+	uint64_t n = 64;
+
+	while (n < (uint64_t)max_entries * 2) {
+		n <<= 1;
+	}
+
+	*n_slots = n;
+	*slots_off = AS_NC_FILE_ALIGN(sizeof(as_nc_file_header));
+	*data_off = AS_NC_FILE_ALIGN(*slots_off + n * sizeof(as_nc_file_slot));
+	*data_size = (size > *data_off) ? (size - *data_off) & ~(uint64_t)7 : 0;
+}
+
+// Must hold write lock.
+static void
+as_nc_file_clear(as_near_cache_file* file)
+{
+	as_nc_file_header* h = file->header;
+	memset(file->slots, 0, sizeof(as_nc_file_slot) * h->n_slots);
+	h->head = 0;
+	h->tail = 0;
+	h->count = 0;
+}
+
+// Header fields must already match the layout. Return false if the slot table does not match the
+// header, as left by a crash in the middle of a write or by outside modification.
+static bool
+as_nc_file_slots_valid(as_near_cache_file* file)
+{
+	as_nc_file_header* h = file->header;
+	uint64_t used = 0;
+
+	for (uint64_t i = 0; i < h->n_slots; i++) {
+		as_nc_file_slot* slot = &file->slots[i];
+
+		if (slot->used == 0) {
+			continue;
+		}
+
+		if (slot->used != 1 || slot->name_id >= h->n_names ||
+			slot->size < sizeof(as_nc_file_record) || slot->offset < h->tail ||
+			slot->offset + slot->size > h->head || ++used > h->count) {
+			return false;
+		}
+	}
+	return used == h->count;
+}
+
+// Must hold lock.
+static int
+as_nc_file_name_find(as_near_cache_file* file, const char* ns, const char* set)
+{
+	as_nc_file_header* h = file->header;
+
+	for (uint32_t i = 0; i < h->n_names; i++) {
+		if (strcmp(h->names[i].ns, ns) == 0 && strcmp(h->names[i].set, set) == 0) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+// Must hold write lock.
+static int
+as_nc_file_name_add(as_near_cache_file* file, const char* ns, const char* set)
+{
+	int id = as_nc_file_name_find(file, ns, set);
+
+	if (id >= 0) {
+		return id;
+	}
+
+	as_nc_file_header* h = file->header;
+
+	if (h->n_names == AS_NC_FILE_NAMES) {
+		return -1;
+	}
+
+	as_nc_file_name* name = &h->names[h->n_names];
+	as_strncpy(name->ns, ns, sizeof(name->ns));
+	as_strncpy(name->set, set, sizeof(name->set));
+	return (int)h->n_names++;
+}
+
+// Must hold lock.
+static as_nc_file_slot*
+as_nc_file_find(as_near_cache_file* file, uint32_t name_id, const uint8_t* digest)
+{
+	uint64_t n_slots = file->header->n_slots;
+	uint64_t mask = n_slots - 1;
+	uint64_t i = as_nc_file_hash(digest) & mask;
+
+	// The table is never full, so the probe ends at an unused slot. The probe is still bounded
+	// in case the mapped slot table was modified outside the client.
+	for (uint64_t n = 0; n < n_slots; n++) {
+		as_nc_file_slot* slot = &file->slots[i];
+
+		if (! slot->used) {
+			return NULL;
+		}
+
+		if (slot->name_id == name_id && memcmp(slot->digest, digest, AS_DIGEST_VALUE_SIZE) == 0) {
+			return slot;
+		}
+		i = (i + 1) & mask;
+	}
+	return NULL;
+}
+
+// Must hold write lock.
+static void
+as_nc_file_delete(as_near_cache_file* file, as_nc_file_slot* slot)
+{
+	uint64_t n_slots = file->header->n_slots;
+	uint64_t mask = n_slots - 1;
+	uint64_t i = (uint64_t)(slot - file->slots);
+	uint64_t j = i;
+
+	// Move following entries of the probe sequence into the hole, unless that would place an
+	// entry in front of its home slot.
+	for (uint64_t n = 1; n < n_slots; n++) {
+		j = (j + 1) & mask;
+
+		as_nc_file_slot* s = &file->slots[j];
+
+		if (! s->used) {
+			break;
+		}
+
+		uint64_t home = as_nc_file_hash(s->digest) & mask;
+
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			file->slots[i] = *s;
+			i = j;
+		}
+	}
+	file->slots[i].used = 0;
+	file->header->count--;
+}
+
+// Must hold lock. Return NULL if the slot does not reference a live ring record.
+static as_nc_file_record*
+as_nc_file_record_get(as_near_cache_file* file, const as_nc_file_slot* slot)
+{
+	as_nc_file_header* h = file->header;
+
+	if (slot->offset < h->tail || slot->offset + slot->size > h->head) {
+		return NULL;
+	}
+
+	uint64_t pos = slot->offset % h->data_size;
+
+	if (pos + slot->size > h->data_size) {
+		return NULL;
+	}
+
+	as_nc_file_record* r = (as_nc_file_record*)(file->data + pos);
+
+	if (r->size != slot->size || r->name_id != slot->name_id ||
+		sizeof(as_nc_file_record) + r->bins_size > r->size ||
+		memcmp(r->digest, slot->digest, AS_DIGEST_VALUE_SIZE) != 0) {
+		return NULL;
+	}
+	return r;
+}
+
+// Must hold write lock. Drop oldest ring record.
+static void
+as_nc_file_drop_tail(as_near_cache_file* file)
+{
+	as_nc_file_header* h = file->header;
+	uint64_t pos = h->tail % h->data_size;
+	uint64_t rem = h->data_size - pos;
+	as_nc_file_record* r = (as_nc_file_record*)(file->data + pos);
+
+	if (rem < sizeof(as_nc_file_record) || r->size == 0 || r->size > rem ||
+		r->size > h->head - h->tail) {
+		// Unused end of ring.
+		h->tail += rem;
+		return;
+	}
+
+	as_nc_file_slot* slot = as_nc_file_find(file, r->name_id, r->digest);
+
+	// Replaced records leave dead ring records that no slot references.
+	if (slot && slot->offset == h->tail) {
+		as_nc_file_delete(file, slot);
+	}
+	h->tail += r->size;
+}
+
+// Must hold write lock.
+static void
+as_nc_file_append(
+	as_near_cache_file* file, uint32_t name_id, const uint8_t* digest, const as_record* rec,
+	uint32_t now, const uint8_t* bins, uint32_t bins_size
+	)
+{
+	as_nc_file_header* h = file->header;
+	uint64_t size = AS_NC_FILE_ALIGN(sizeof(as_nc_file_record) + bins_size);
+
+	if (size > h->data_size / 4) {
+		return;
+	}
+
+	as_nc_file_slot* old = as_nc_file_find(file, name_id, digest);
+
+	if (old) {
+		as_nc_file_delete(file, old);
+	}
+
+	uint64_t mask = h->n_slots - 1;
+	uint64_t home = as_nc_file_hash(digest) & mask;
+
+	uint64_t pos;
+	uint64_t pad;
+
+	while (true) {
+		pos = h->head % h->data_size;
+		pad = (h->data_size - pos < size) ? h->data_size - pos : 0;
+
+		if (h->data_size - (h->head - h->tail) >= pad + size && h->count < h->max_entries) {
+			break;
+		}
+
+		if (h->head == h->tail) {
+			// Slots without ring records only remain after a crash in the middle of a write.
+			as_nc_file_clear(file);
+			continue;
+		}
+		as_nc_file_drop_tail(file);
+	}
+
+	uint64_t i = home;
+	uint64_t n = 0;
+
+	while (file->slots[i].used) {
+		if (++n == h->n_slots) {
+			// Count does not match the slot table. Start over instead of probing it again.
+			as_nc_file_clear(file);
+			pos = 0;
+			pad = 0;
+			i = home;
+			break;
+		}
+		i = (i + 1) & mask;
+	}
+
+	if (pad) {
+		memset(file->data + pos, 0, sizeof(uint32_t));
+		h->head += pad;
+		pos = 0;
+	}
+
+	// Write the record before the slot that references it.
+	as_nc_file_record* r = (as_nc_file_record*)(file->data + pos);
+	r->size = (uint32_t)size;
+	r->bins_size = bins_size;
+	r->name_id = (uint8_t)name_id;
+	memset(r->pad, 0, sizeof(r->pad));
+	memcpy(r->digest, digest, AS_DIGEST_VALUE_SIZE);
+	memcpy(r + 1, bins, bins_size);
+
+	as_nc_file_slot* slot = &file->slots[i];
+	slot->offset = h->head;
+	slot->size = (uint32_t)size;
+	slot->expires = as_nc_file_expires(rec->ttl, now);
+	slot->validated = now;
+	slot->gen = rec->gen;
+	slot->name_id = (uint8_t)name_id;
+	memcpy(slot->digest, digest, AS_DIGEST_VALUE_SIZE);
+	slot->used = 1;
+	h->count++;
+	h->head += size;
+}
+
+static uint8_t*
+as_nc_file_encode(const as_record* rec, uint32_t* size_out)
+{
+	uint16_t n_bins = rec->bins.size;
+	const as_bin* bins = rec->bins.entries;
+
+	// Compute packed sizes first.
+	as_packer pk = {.buffer = NULL, .capacity = UINT32_MAX};
+	size_t size = 2;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		pk.offset = 0;
+
+		if (bins[i].valuep && as_pack_val(&pk, (as_val*)bins[i].valuep) != 0) {
+			return NULL;
+		}
+		size += 1 + strlen(bins[i].name) + 4 + pk.offset;
+	}
+
+	if (size > UINT32_MAX / 2) {
+		return NULL;
+	}
+
+	uint8_t* buf = cf_malloc(size);
+	uint8_t* p = buf;
+
+	memcpy(p, &n_bins, 2);
+	p += 2;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		size_t name_len = strlen(bins[i].name);
+		*p++ = (uint8_t)name_len;
+		memcpy(p, bins[i].name, name_len);
+		p += name_len;
+
+		uint32_t len = 0;
+
+		if (bins[i].valuep) {
+			as_packer vp = {.buffer = p + 4, .capacity = UINT32_MAX};
+			as_pack_val(&vp, (as_val*)bins[i].valuep);
+			len = vp.offset;
+		}
+		memcpy(p, &len, 4);
+		p += 4 + len;
+	}
+	*size_out = (uint32_t)size;
+	return buf;
+}
+
+static inline bool
+as_nc_file_read(as_nc_file_reader* r, void* out, size_t size)
+{
+	if ((size_t)(r->end - r->p) < size) {
+		return false;
+	}
+	memcpy(out, r->p, size);
+	r->p += size;
+	return true;
+}
+
+static as_record*
+as_nc_file_decode(as_nc_file_record* r)
+{
+	uint8_t* bins = (uint8_t*)(r + 1);
+	as_nc_file_reader rd = {.p = bins, .end = bins + r->bins_size};
+	uint16_t n_bins;
+
+	if (! as_nc_file_read(&rd, &n_bins, 2)) {
+		return NULL;
+	}
+
+	as_record* rec = as_record_new(n_bins);
+	as_serializer ser;
+	as_msgpack_init(&ser);
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		as_bin_name name;
+		uint8_t name_len;
+		uint32_t len;
+
+		if (! as_nc_file_read(&rd, &name_len, 1) || name_len >= sizeof(name) ||
+			! as_nc_file_read(&rd, name, name_len) || ! as_nc_file_read(&rd, &len, 4) ||
+			(size_t)(rd.end - rd.p) < len) {
+			as_serializer_destroy(&ser);
+			as_record_destroy(rec);
+			return NULL;
+		}
+		name[name_len] = 0;
+
+		if (len == 0) {
+			as_record_set_nil(rec, name);
+			continue;
+		}
+
+		as_buffer buffer;
+		buffer.data = rd.p;
+		buffer.size = len;
+		rd.p += len;
+
+		as_val* val = NULL;
+
+		if (as_serializer_deserialize(&ser, &buffer, &val) != 0) {
+			as_serializer_destroy(&ser);
+			as_record_destroy(rec);
+			return NULL;
+		}
+		as_record_set(rec, name, (as_bin_value*)val);
+	}
+	as_serializer_destroy(&ser);
+	return rec;
+}
+
+static bool
+as_nc_file_read_listener(uint32_t index, const as_batch_result* result, void* udata)
+{
+	as_nc_file_loader* loader = udata;
+	as_nc_file_header* h = loader->file->header;
+	const as_nc_file_name* name = &h->names[loader->name_id];
+	const uint8_t* digest = loader->batch.digests[index];
+
+	if (result->result == AEROSPIKE_OK) {
+		as_near_cache_file_put(loader->file, name->ns, name->set, digest, &result->record,
+			as_near_cache_file_now());
+	}
+	return true;
+}
+
+// Must hold loader lock. Read records of collected digests in full.
+static void
+as_nc_file_load_flush(as_nc_file_loader* loader)
+{
+	if (loader->batch.size == 0) {
+		return;
+	}
+
+	as_error err;
+	as_status status = aerospike_batch_read_digests_stream(loader->as, &err, loader->policy,
+		&loader->batch, NULL, 0, as_nc_file_read_listener, loader);
+
+	// Keys that failed are read again when first accessed.
+	if (status != AEROSPIKE_OK && status != AEROSPIKE_BATCH_FAILED &&
+		loader->status == AEROSPIKE_OK) {
+		loader->status = status;
+		as_error_copy(&loader->err, &err);
+	}
+	loader->batch.size = 0;
+}
+
+static bool
+as_nc_file_scan_callback(const as_val* val, void* udata)
+{
+	if (! val) {
+		// Scan complete.
+		return true;
+	}
+
+	as_nc_file_loader* loader = udata;
+	as_near_cache_file* file = loader->file;
+	as_record* rec = as_record_fromval(val);
+
+	if (! rec || ! rec->key.digest.init) {
+		return true;
+	}
+
+	const uint8_t* digest = rec->key.digest.value;
+	uint32_t now = as_near_cache_file_now();
+	bool current = false;
+
+	pthread_rwlock_wrlock(&file->lock);
+
+	as_nc_file_slot* slot = as_nc_file_find(file, loader->name_id, digest);
+
+	// Entries with the scanned generation are valid without reading their bins.
+	if (slot && slot->gen == rec->gen) {
+		slot->validated = now;
+		slot->expires = as_nc_file_expires(rec->ttl, now);
+		current = true;
+	}
+	pthread_rwlock_unlock(&file->lock);
+
+	if (current) {
+		return true;
+	}
+
+	// Node scan callbacks may run in parallel.
+	pthread_mutex_lock(&loader->lock);
+	memcpy(loader->batch.digests[loader->batch.size++], digest, AS_DIGEST_VALUE_SIZE);
+
+	if (loader->batch.size == AS_NC_FILE_BATCH) {
+		as_nc_file_load_flush(loader);
+	}
+
+	bool more = loader->status == AEROSPIKE_OK;
+	pthread_mutex_unlock(&loader->lock);
+	return more;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+#if !defined(_MSC_VER)
+
+as_status
+as_near_cache_file_open(
+	as_near_cache_file** file_out, as_error* err, const char* path, uint64_t size,
+	uint32_t max_entries, uint32_t validate_sec
+	)
+{
+	uint64_t n_slots, slots_off, data_off, data_size;
+	as_nc_file_layout(size, max_entries, &n_slots, &slots_off, &data_off, &data_size);
+
+	if (max_entries == 0 || data_size < AS_NC_FILE_MIN_DATA) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Near cache file size %" PRIu64 " is too small for %u entries", size, max_entries);
+	}
+
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+
+	if (fd < 0) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open %s: %s",
+							   path, strerror(errno));
+	}
+
+	if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+			"Near cache file %s is used by another process", path);
+	}
+
+	struct stat stats;
+
+	if (fstat(fd, &stats) != 0) {
+		int e = errno;
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to stat %s: %s",
+							   path, strerror(e));
+	}
+
+	if ((uint64_t)stats.st_size != size) {
+		// A cache file of another size is discarded.
+		if (stats.st_size != 0) {
+			as_log_info("Resizing near cache file %s. Cached records are discarded.", path);
+		}
+
+		if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)size) != 0) {
+			int e = errno;
+			close(fd);
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to size %s: %s",
+								   path, strerror(e));
+		}
+	}
+
+	void* data = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (data == MAP_FAILED) {
+		int e = errno;
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %s",
+							   path, strerror(e));
+	}
+
+	as_near_cache_file* file = cf_malloc(sizeof(as_near_cache_file));
+	pthread_rwlock_init(&file->lock, NULL);
+	file->header = data;
+	file->slots = (as_nc_file_slot*)((uint8_t*)data + slots_off);
+	file->data = (uint8_t*)data + data_off;
+	file->size = (size_t)size;
+	file->validate_sec = validate_sec;
+
+	// The descriptor holds the file lock until close.
+	file->fd = fd;
+
+	as_nc_file_header* h = file->header;
+	bool valid = true;
+
+	if (h->magic != AS_NC_FILE_MAGIC || h->version != AS_NC_FILE_VERSION ||
+		h->n_slots != n_slots || h->data_size != data_size || h->max_entries != max_entries ||
+		h->tail > h->head || h->head - h->tail > data_size || h->count > max_entries ||
+		h->n_names > AS_NC_FILE_NAMES) {
+		if (h->magic != 0) {
+			as_log_warn("Near cache file %s has an invalid header or was created with another "
+				"layout. Clearing it.", path);
+		}
+		valid = false;
+	}
+	else if (! as_nc_file_slots_valid(file)) {
+		as_log_warn("Near cache file %s slot table is corrupt. Clearing it.", path);
+		valid = false;
+	}
+
+	if (! valid) {
+		h->magic = 0;
+		h->version = AS_NC_FILE_VERSION;
+		h->n_slots = n_slots;
+		h->data_size = data_size;
+		h->max_entries = max_entries;
+		h->n_names = 0;
+		as_nc_file_clear(file);
+		h->magic = AS_NC_FILE_MAGIC;
+	}
+	else if (h->count > 0) {
+		as_log_info("Opened near cache file %s with %" PRIu64 " records", path, h->count);
+	}
+
+	*file_out = file;
+	return AEROSPIKE_OK;
+}
+
+void
+as_near_cache_file_close(as_near_cache_file* file)
+{
+	msync(file->header, file->size, MS_SYNC);
+	munmap(file->header, file->size);
+	close(file->fd);
+	pthread_rwlock_destroy(&file->lock);
+	cf_free(file);
+}
+
+#else
+
+as_status
+as_near_cache_file_open(
+	as_near_cache_file** file_out, as_error* err, const char* path, uint64_t size,
+	uint32_t max_entries, uint32_t validate_sec
+	)
+{
+	return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+		"Near cache file is not supported on Windows");
+}
+
+void
+as_near_cache_file_close(as_near_cache_file* file)
+{
+}
+
+#endif
+
+as_near_cache_file_result
+as_near_cache_file_get(as_near_cache_file* file, const as_key* key, uint32_t now, as_record** rec)
+{
+	as_near_cache_file_result result = AS_NEAR_CACHE_FILE_MISS;
+
+	pthread_rwlock_rdlock(&file->lock);
+
+	int name_id = as_nc_file_name_find(file, key->ns, key->set);
+	as_nc_file_slot* slot = (name_id >= 0) ?
+		as_nc_file_find(file, (uint32_t)name_id, key->digest.value) : NULL;
+
+	if (slot && (slot->expires == 0 || now < slot->expires)) {
+		as_nc_file_record* r = as_nc_file_record_get(file, slot);
+		as_record* cached = r ? as_nc_file_decode(r) : NULL;
+
+		if (cached) {
+			cached->gen = slot->gen;
+			cached->ttl = slot->expires ? slot->expires - now : AS_RECORD_NO_EXPIRE_TTL;
+			*rec = cached;
+			result = (now < slot->validated + file->validate_sec) ?
+				AS_NEAR_CACHE_FILE_HIT : AS_NEAR_CACHE_FILE_VALIDATE;
+		}
+	}
+	pthread_rwlock_unlock(&file->lock);
+	return result;
+}
+
+bool
+as_near_cache_file_validated(
+	as_near_cache_file* file, const as_key* key, uint16_t gen, uint32_t ttl, uint32_t now
+	)
+{
+	bool valid = false;
+
+	pthread_rwlock_wrlock(&file->lock);
+
+	int name_id = as_nc_file_name_find(file, key->ns, key->set);
+	as_nc_file_slot* slot = (name_id >= 0) ?
+		as_nc_file_find(file, (uint32_t)name_id, key->digest.value) : NULL;
+
+	if (slot && slot->gen == gen) {
+		slot->validated = now;
+		slot->expires = as_nc_file_expires(ttl, now);
+		valid = true;
+	}
+	pthread_rwlock_unlock(&file->lock);
+	return valid;
+}
+
+void
+as_near_cache_file_put(
+	as_near_cache_file* file, const char* ns, const char* set, const uint8_t* digest,
+	const as_record* rec, uint32_t now
+	)
+{
+	// Lazy records hold list and map bytes that are not decoded yet.
+	if (rec->lazy) {
+		return;
+	}
+
+	uint32_t bins_size;
+	uint8_t* bins = as_nc_file_encode(rec, &bins_size);
+
+	if (! bins) {
+		return;
+	}
+
+	pthread_rwlock_wrlock(&file->lock);
+
+	int name_id = as_nc_file_name_add(file, ns, set);
+
+	if (name_id >= 0) {
+		as_nc_file_append(file, (uint32_t)name_id, digest, rec, now, bins, bins_size);
+	}
+	pthread_rwlock_unlock(&file->lock);
+	cf_free(bins);
+}
+
+void
+as_near_cache_file_remove(as_near_cache_file* file, const as_key* key)
+{
+	pthread_rwlock_wrlock(&file->lock);
+
+	int name_id = as_nc_file_name_find(file, key->ns, key->set);
+	as_nc_file_slot* slot = (name_id >= 0) ?
+		as_nc_file_find(file, (uint32_t)name_id, key->digest.value) : NULL;
+
+	if (slot) {
+		as_nc_file_delete(file, slot);
+	}
+	pthread_rwlock_unlock(&file->lock);
+}
+
+as_status
+as_near_cache_file_validate(
+	as_near_cache_file* file, aerospike* as, as_error* err, const as_policy_batch* policy
+	)
+{
+	as_error_reset(err);
+
+	uint16_t* gens = cf_malloc(sizeof(uint16_t) * AS_NC_FILE_BATCH);
+	as_status* results = cf_malloc(sizeof(as_status) * AS_NC_FILE_BATCH);
+	uint16_t* server_gens = cf_malloc(sizeof(uint16_t) * AS_NC_FILE_BATCH);
+	uint32_t* ttls = cf_malloc(sizeof(uint32_t) * AS_NC_FILE_BATCH);
+	as_batch_exists_results er = {.status = results, .gen = server_gens, .ttl = ttls};
+	as_status status = AEROSPIKE_OK;
+
+	pthread_rwlock_rdlock(&file->lock);
+	uint32_t n_names = file->header->n_names;
+	uint64_t n_slots = file->header->n_slots;
+	pthread_rwlock_unlock(&file->lock);
+
+	for (uint32_t id = 0; id < n_names && status == AEROSPIKE_OK; id++) {
+		as_batch_digests batch;
+		as_batch_digests_init(&batch, file->header->names[id].ns, file->header->names[id].set,
+			AS_NC_FILE_BATCH);
+
+		uint64_t pos = 0;
+
+		// Deletes shift slots backward, so a few entries may be skipped. Skipped entries are
+		// validated on first access.
+		while (pos < n_slots) {
+			uint32_t n = 0;
+
+			pthread_rwlock_rdlock(&file->lock);
+
+			while (pos < n_slots && n < AS_NC_FILE_BATCH) {
+				as_nc_file_slot* slot = &file->slots[pos++];
+
+				if (slot->used && slot->name_id == id) {
+					memcpy(batch.digests[n], slot->digest, AS_DIGEST_VALUE_SIZE);
+					gens[n] = slot->gen;
+					n++;
+				}
+			}
+			pthread_rwlock_unlock(&file->lock);
+
+			if (n == 0) {
+				continue;
+			}
+
+			batch.size = n;
+			status = aerospike_batch_exists_digests(as, err, policy, &batch, &er);
+
+			if (status == AEROSPIKE_BATCH_FAILED) {
+				// Keys without a response keep their previous validation time.
+				as_error_reset(err);
+				status = AEROSPIKE_OK;
+			}
+
+			if (status != AEROSPIKE_OK) {
+				break;
+			}
+
+			uint32_t now = as_near_cache_file_now();
+
+			pthread_rwlock_wrlock(&file->lock);
+
+			for (uint32_t i = 0; i < n; i++) {
+				as_nc_file_slot* slot = as_nc_file_find(file, id, batch.digests[i]);
+
+				// The entry may have been replaced while the server was validating it.
+				if (! slot || slot->gen != gens[i]) {
+					continue;
+				}
+
+				if (results[i] == AEROSPIKE_OK && server_gens[i] == slot->gen) {
+					slot->validated = now;
+					slot->expires = as_nc_file_expires(ttls[i], now);
+				}
+				else if (results[i] == AEROSPIKE_OK || results[i] == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+					as_nc_file_delete(file, slot);
+				}
+			}
+			pthread_rwlock_unlock(&file->lock);
+		}
+		as_batch_digests_destroy(&batch);
+	}
+
+	cf_free(ttls);
+	cf_free(server_gens);
+	cf_free(results);
+	cf_free(gens);
+	return status;
+}
+
+as_status
+as_near_cache_file_load(
+	as_near_cache_file* file, aerospike* as, as_error* err, const as_policy_scan* scan_policy,
+	const as_policy_batch* batch_policy, const char* ns, const char* set
+	)
+{
+	as_error_reset(err);
+
+	if (! set) {
+		set = "";
+	}
+
+	pthread_rwlock_wrlock(&file->lock);
+	int name_id = as_nc_file_name_add(file, ns, set);
+	pthread_rwlock_unlock(&file->lock);
+
+	if (name_id < 0) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Near cache file holds the maximum of %d sets", AS_NC_FILE_NAMES);
+	}
+
+	as_nc_file_loader loader;
+	pthread_mutex_init(&loader.lock, NULL);
+	loader.file = file;
+	loader.as = as;
+	loader.policy = batch_policy;
+	as_batch_digests_init(&loader.batch, ns, set, AS_NC_FILE_BATCH);
+	loader.batch.size = 0;
+	loader.name_id = (uint32_t)name_id;
+	loader.status = AEROSPIKE_OK;
+	as_error_init(&loader.err);
+
+	// Digest-only scan returns generations without bins, so only records that are missing or
+	// changed are read in full.
+	as_scan scan;
+	as_scan_init(&scan, ns, set);
+	as_scan_set_nobins(&scan, true);
+
+	as_status status = aerospike_scan_foreach(as, err, scan_policy, &scan,
+		as_nc_file_scan_callback, &loader);
+
+	as_scan_destroy(&scan);
+
+	pthread_mutex_lock(&loader.lock);
+	as_nc_file_load_flush(&loader);
+	pthread_mutex_unlock(&loader.lock);
+
+	if (loader.status != AEROSPIKE_OK) {
+		// Scan was aborted by the callback.
+		as_error_copy(err, &loader.err);
+		status = loader.status;
+	}
+
+	as_batch_digests_destroy(&loader.batch);
+	pthread_mutex_destroy(&loader.lock);
+	return status;
+}
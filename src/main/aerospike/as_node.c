@@ -21,17 +21,23 @@
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_event_internal.h>
+#include <aerospike/as_hot_keys.h>
 #include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_metrics.h>
+#include <aerospike/as_partition_heat.h>
 #include <aerospike/as_peers.h>
 #include <aerospike/as_queue.h>
 #include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_sleep.h>
 #include <aerospike/as_socket.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_tls.h>
 #include <citrusleaf/cf_b64.h>
 #include <citrusleaf/cf_byte_order.h>
+#include <errno.h>
+#include <limits.h>
 
 //---------------------------------
 // Macros
@@ -43,6 +49,9 @@
 // Number of nanoseconds per millisecond
 #define NS_TO_MS 1000000
 
+// Idle connections validated per pool lock acquisition.
+#define AS_VALIDATE_BATCH_SIZE 32
+
 //---------------------------------
 // Globals
 //---------------------------------
@@ -56,6 +65,9 @@ AS_EXTERN extern char* aerospike_client_version;
 // Empty string namespace for latency metrics without a namespace.
 static const char* as_ns_empty = "";
 
+// Spreads nodes over event loops for AS_EVENT_LOOP_SELECTION_NODE_AFFINITY.
+static uint32_t as_node_event_loop_seq = 0;
+
 //---------------------------------
 // Function declarations
 //---------------------------------
@@ -66,7 +78,10 @@ as_cluster_get_alternate_host(as_cluster* cluster, const char* hostname);
 bool
 as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf);
 
-static void
+static as_status
+as_node_parse_racks(as_cluster* cluster, as_error* err, as_node* node, char* buf);
+
+static int
 as_node_create_connections(as_node* node, as_conn_pool* pool, uint32_t timeout_ms, int count);
 
 void
@@ -172,12 +187,15 @@ as_node_create(as_cluster* cluster, as_node_info* node_info)
 	if (!node) {
 		return NULL;
 	}
+	as_mem_stats_alloc(AS_MEM_TAG_CLUSTER, sizeof(as_node));
 	
 	node->ref_count = 1;
 	node->partition_ref_count = 0;
 	node->peers_generation = 0xFFFFFFFF;
 	node->partition_generation = 0xFFFFFFFF;
 	node->rebalance_generation = 0xFFFFFFFF;
+	node->cluster_key = 0;
+	node->cluster_key_ms = 0;
 	node->cluster = cluster;
 
 	strcpy(node->name, node_info->name);
@@ -200,16 +218,42 @@ as_node_create(as_cluster* cluster, as_node_info* node_info)
 	}
 
 	node->racks = NULL;
+	node->partition_bitmaps = NULL;
 	node->peers_count = 0;
 	node->friends = 0;
 	node->failures = 0;
 	node->index = 0;
+	node->event_loop_seq = as_faa_uint32(&as_node_event_loop_seq, 1);
 	node->perform_login = 0;
 	node->active = true;
 	node->partition_changed = true;
+	node->partition_bitmaps_reset = false;
 	node->rebalance_changed = cluster->rack_aware;
 	node->error_rate = 0;
 	node->max_error_rate = cluster->max_error_rate;
+	node->breaker_state = AS_BREAKER_CLOSED;
+	node->breaker_successes = 0;
+	node->breaker_failures = 0;
+	node->breaker_probes = 0;
+	node->breaker_open_remaining = 0;
+	node->breaker_backoff = cluster->breaker_open_tends;
+	node->breaker_trips = 0;
+	node->limit = cluster->limit_max;
+	node->limit_inflight = 0;
+	node->limit_peak = 0;
+	node->limit_drops = 0;
+	node->limit_rtt_count = 0;
+	node->limit_rtt_sum = 0;
+	node->limit_rtt_long = 0;
+	node->limit_rejects = 0;
+	node->latency_ewma = 0;
+	node->error_ewma = 0;
+	node->adaptive_latency = NULL;
+	node->adaptive_counts = NULL;
+	node->adaptive_p999_us = 0;
+	memset(&node->tcp_info, 0, sizeof(as_tcp_info));
+	node->tcp_info_samples = 0;
+	node->tcp_info_next = cluster->metrics_tcp_info_interval ? cf_getns() : 0;
 	node->metrics_size = 0;
 	node->metrics = cf_calloc(AS_MAX_METRICS_NAMESPACES, sizeof(as_ns_metrics*));
 
@@ -217,7 +261,15 @@ as_node_create(as_cluster* cluster, as_node_info* node_info)
 	node->sync_conn_pools = cf_malloc(sizeof(as_conn_pool) * cluster->conn_pools_per_node);
 	node->sync_conns_opened = 1;
 	node->sync_conns_closed = 0;
+	node->warm_up_target = 0;
+	node->warm_up_remaining = 0;
+	node->sync_conn_demand = 0;
+	node->spare_target = 0;
+	node->sync_connects = 0;
 	node->conn_iter = 0;
+	node->sync_pipe_iter = 0;
+	node->sync_pipes = (cluster->sync_pipes_per_node > 0)?
+		as_sync_pipe_create(cluster->sync_pipes_per_node) : NULL;
 
 	as_node_send_user_agent(node);
 
@@ -230,7 +282,7 @@ as_node_create(as_cluster* cluster, as_node_info* node_info)
 		as_conn_pool* pool = &node->sync_conn_pools[i];
 		uint32_t min_size = i < rem_min ? min + 1 : min;
 		uint32_t max_size = i < rem_max ? max + 1 : max;
-		as_conn_pool_init(pool, sizeof(as_socket), min_size, max_size);
+		as_conn_pool_init(pool, sizeof(as_socket), min_size, max_size, cluster->conn_cache_size);
 	}
 
 	if (as_event_loop_capacity == 0) {
@@ -256,8 +308,20 @@ as_node_destroy_metrics(as_node* node)
 	for (uint8_t i = 0; i < max; i++) {
 		as_ns_metrics* metrics = array[i];
 
-		for (uint8_t j = 0; j < AS_LATENCY_TYPE_MAX; j++) {
+		for (uint8_t j = 0; j < AS_LATENCY_SLOTS; j++) {
 			cf_free(metrics->latency[j]);
+
+			if (metrics->latency_hdr[j]) {
+				cf_free(metrics->latency_hdr[j]);
+			}
+		}
+
+		if (metrics->hot_keys) {
+			as_hot_keys_destroy(metrics->hot_keys);
+		}
+
+		if (metrics->partition_heat) {
+			as_partition_heat_destroy(metrics->partition_heat);
 		}
 		cf_free(metrics);
 	}
@@ -280,6 +344,10 @@ as_node_destroy(as_node* node)
 	}
 	cf_free(node->sync_conn_pools);
 
+	if (node->sync_pipes) {
+		as_sync_pipe_destroy(node, node->sync_pipes, node->cluster->sync_pipes_per_node);
+	}
+
 	// Drain async connection pools.
 	if (as_event_loop_capacity > 0) {
 		// Close async and pipeline connections.
@@ -308,14 +376,29 @@ as_node_destroy(as_node* node)
 	if (racks) {
 		as_racks_release(racks);
 	}
-	
+
+	if (node->partition_bitmaps) {
+		as_partition_bitmaps_destroy(node);
+	}
+
 	as_node_destroy_metrics(node);
+
+	if (node->adaptive_latency) {
+		as_latency_hdr_release(node->adaptive_latency);
+		cf_free(node->adaptive_counts);
+	}
 	cf_free(node);
+	as_mem_stats_free(AS_MEM_TAG_CLUSTER, sizeof(as_node));
 }
 
 void
 as_node_create_min_connections(as_node* node)
 {
+	if (node->cluster->fast_starting) {
+		// Tend thread fills minimum connections after cluster init.
+		return;
+	}
+
 	// Create sync connections.
 	uint32_t max = node->cluster->conn_pools_per_node;
 
@@ -426,11 +509,20 @@ as_node_try_family_connections(as_node* node, int family, int begin, int end, in
 {
 	// Create a non-blocking socket.
 	as_tls_context* ctx = as_socket_get_tls_context(node->cluster->tls_ctx);
-	int rv = as_socket_create(sock, family, ctx, node->tls_name);
+	int rv = as_socket_create(sock, family, &node->cluster->socket_options, ctx, node->tls_name);
 	
 	if (rv < 0) {
 		return rv;
 	}
+
+	if (ctx) {
+		as_tls_session_resume(ctx, sock->ssl, node->name, node->tls_name);
+	}
+
+	if (node->cluster->socket_busy_poll_us > 0 &&
+		as_socket_set_busy_poll(sock->fd, node->cluster->socket_busy_poll_us) != 0) {
+		as_log_debug("Failed to set SO_BUSY_POLL: %d", as_last_error());
+	}
 	
 	// Try addresses.
 	as_address* addresses = node->addresses;
@@ -506,7 +598,7 @@ as_node_create_socket(
 	return AEROSPIKE_OK;
 }
 
-static as_status
+as_status
 as_node_create_connection(
 	as_error* err, as_node* node, const char* ns, uint32_t socket_timeout, uint64_t deadline_ms, as_conn_pool* pool,
 	as_socket* sock
@@ -552,12 +644,13 @@ as_node_create_connection(
 	return AEROSPIKE_OK;
 }
 
-static void
+static int
 as_node_create_connections(as_node* node, as_conn_pool* pool, uint32_t timeout_ms, int count)
 {
 	as_error err;
 	as_status status;
 	as_socket sock;
+	int created = 0;
 
 	// Create sync connections.
 	while (count > 0) {
@@ -566,11 +659,11 @@ as_node_create_connections(as_node* node, as_conn_pool* pool, uint32_t timeout_m
 
 		if (status != AEROSPIKE_OK) {
 			as_log_debug("Failed to create min connections: %d %s", err.code, err.message);
-			return;
+			return created;
 		}
 
 		// Update last used timestamp.
-		sock.last_used = cf_getns();
+		sock.last_used = as_clock_getns();
 
 		// Put into pool.
 		if (as_conn_pool_push_head(pool, &sock)) {
@@ -580,8 +673,88 @@ as_node_create_connections(as_node* node, as_conn_pool* pool, uint32_t timeout_m
 			as_node_close_socket(node, &sock);
 			break;
 		}
+		created++;
 		count--;
 	}
+	return created;
+}
+
+static void
+as_node_warm_up_connections(as_node* node)
+{
+	as_cluster* cluster = node->cluster;
+	uint32_t remaining = node->warm_up_remaining;
+	uint32_t count = remaining;
+
+	if (count > cluster->warm_up_conns_per_tend) {
+		count = cluster->warm_up_conns_per_tend;
+	}
+
+	// Distribute connections over pools taking remainder into account.
+	uint32_t max = cluster->conn_pools_per_node;
+	uint32_t per_pool = count / max;
+	uint32_t rem = count - (per_pool * max);
+	uint32_t created = 0;
+	bool full = false;
+
+	for (uint32_t i = 0; i < max; i++) {
+		int n = (int)(i < rem ? per_pool + 1 : per_pool);
+
+		if (n > 0) {
+			int rv = as_node_create_connections(node, &node->sync_conn_pools[i],
+				cluster->conn_timeout_ms, n);
+
+			created += rv;
+
+			if (rv < n) {
+				full = true;
+			}
+		}
+	}
+
+	// Stop warm-up when connections could not be created or pools are full. Normal pool
+	// balancing takes over from there.
+	as_store_uint32(&node->warm_up_remaining, full ? 0 : remaining - created);
+}
+
+void
+as_node_warm_up(as_node* node, uint32_t new_nodes)
+{
+	as_cluster* cluster = node->cluster;
+	as_nodes* nodes = cluster->nodes;
+	uint64_t total = 0;
+
+	// Partitions are distributed evenly, so the new node is expected to receive an even share
+	// of the connections currently used by the existing nodes.
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* n = nodes->array[i];
+
+		if (! n->active) {
+			continue;
+		}
+
+		for (uint32_t j = 0; j < cluster->conn_pools_per_node; j++) {
+			total += as_load_uint32(&n->sync_conn_pools[j].queue.total);
+		}
+	}
+
+	uint64_t target = total / (nodes->size + new_nodes);
+
+	if (target > cluster->max_conns_per_node) {
+		target = cluster->max_conns_per_node;
+	}
+
+	if (target <= cluster->min_conns_per_node) {
+		return;
+	}
+
+	as_store_uint32(&node->warm_up_target, (uint32_t)target);
+	as_store_uint32(&node->warm_up_remaining, (uint32_t)target - cluster->min_conns_per_node);
+
+	as_log_debug("Node %s warm-up %u connections", node->name, (uint32_t)target);
+
+	// Open first batch before the node is added to the partition map.
+	as_node_warm_up_connections(node);
 }
 
 as_status
@@ -604,10 +777,10 @@ as_node_authenticate_connection(as_cluster* cluster, uint64_t deadline_ms)
 	return status;
 }
 
-as_status
-as_node_get_connection(
+static as_status
+as_node_get_pool_connection(
 	as_error* err, as_node* node, const char* ns, uint32_t socket_timeout, uint64_t deadline_ms,
-	as_socket* sock
+	uint64_t validate_window_ns, as_socket* sock
 	)
 {
 	as_conn_pool* pools = node->sync_conn_pools;
@@ -638,13 +811,17 @@ as_node_get_connection(
 				continue;
 			}
 
-			// Verify that socket receive buffer is empty.
-			int len = as_socket_validate_fd(s.fd);
+			// Verify that socket receive buffer is empty. Sockets that were used or validated
+			// by the tend thread within the window are trusted.
+			if (validate_window_ns == 0 ||
+				! as_socket_recently_valid(&s, as_clock_getns(), validate_window_ns)) {
+				int len = as_socket_validate_fd(s.fd);
 
-			if (len != 0) {
-				as_log_debug("Invalid socket %d from pool: %d", s.fd, len);
-				as_node_close_conn_error(node, &s, pool);
-				continue;
+				if (len != 0) {
+					as_log_debug("Invalid socket %d from pool: %d", s.fd, len);
+					as_node_close_conn_error(node, &s, pool);
+					continue;
+				}
 			}
 
 			*sock = s;
@@ -653,10 +830,32 @@ as_node_get_connection(
 		}
 		else if (as_conn_pool_incr(pool)) {
 			// Socket not found and queue has available slot.
+			uint32_t max_connects = cluster->max_connects_per_node;
+
+			if (max_connects > 0 && as_faa_uint32(&node->sync_connects, 1) >= max_connects) {
+				// Too many commands are connecting to this node. Wait for a pooled connection
+				// or a free connect slot.
+				as_decr_uint32(&node->sync_connects);
+				as_conn_pool_decr(pool);
+
+				if (deadline_ms > 0 && as_clock_getms() >= deadline_ms) {
+					return as_error_update(err, AEROSPIKE_ERR_TIMEOUT,
+						"Timeout waiting for node %s connect slot: %u", node->name, max_connects);
+				}
+				as_sleep(1);
+				continue;
+			}
+
 			// Create new connection.
+			as_incr_uint32(&node->sync_conn_demand);
+
 			as_status status = as_node_create_connection(err, node, ns, socket_timeout, deadline_ms,
 														 pool, sock);
 
+			if (max_connects > 0) {
+				as_decr_uint32(&node->sync_connects);
+			}
+
 			if (status != AEROSPIKE_OK) {
 				as_conn_pool_decr(pool);
 			}
@@ -691,11 +890,32 @@ as_node_get_connection(
 						   node->name, cluster->max_conns_per_node);
 }
 
-static void
-as_node_close_idle_connections(as_node* node, as_conn_pool* pool, int count)
+as_status
+as_node_get_connection(
+	as_error* err, as_node* node, const char* ns, uint32_t socket_timeout, uint64_t deadline_ms,
+	as_socket* sock
+	)
+{
+	return as_node_get_pool_connection(err, node, ns, socket_timeout, deadline_ms,
+		node->cluster->conn_validate_window_ns, sock);
+}
+
+as_status
+as_node_get_validated_connection(
+	as_error* err, as_node* node, const char* ns, uint32_t socket_timeout, uint64_t deadline_ms,
+	as_socket* sock
+	)
+{
+	return as_node_get_pool_connection(err, node, ns, socket_timeout, deadline_ms, 0, sock);
+}
+
+static int
+as_node_close_idle_connections(
+	as_node* node, as_conn_pool* pool, uint64_t max_socket_idle_ns, int count
+	)
 {
-	uint64_t max_socket_idle_ns = as_load_uint64(&node->cluster->max_socket_idle_ns_trim);
 	as_socket s;
+	int closed = 0;
 
 	while (count > 0) {
 		if (! as_conn_pool_pop_tail(pool, &s)) {
@@ -709,8 +929,170 @@ as_node_close_idle_connections(as_node* node, as_conn_pool* pool, int count)
 			break;
 		}
 		as_node_close_connection(node, &s, pool);
+		closed++;
 		count--;
 	}
+	return closed;
+}
+
+static void
+as_node_validate_idle_connections(as_node* node, as_conn_pool* pool, uint64_t window_ns)
+{
+	// Rotate the queue from tail to head so connection order is preserved. Only connections
+	// that would not be trusted on checkout are peeked. Sockets are peeked in batches outside
+	// the pool lock, so commands are not blocked behind recv() calls.
+	as_socket batch[AS_VALIDATE_BATCH_SIZE];
+
+	as_conn_pool_lock(pool);
+	uint32_t remaining = as_queue_size(&pool->queue);
+	as_conn_pool_unlock(pool);
+
+	while (remaining > 0) {
+		uint32_t max = (remaining < AS_VALIDATE_BATCH_SIZE)? remaining : AS_VALIDATE_BATCH_SIZE;
+		uint32_t n = 0;
+
+		as_conn_pool_lock(pool);
+
+		while (n < max && as_queue_pop_tail(&pool->queue, &batch[n])) {
+			n++;
+		}
+		as_conn_pool_unlock(pool);
+
+		if (n == 0) {
+			break;
+		}
+		remaining -= n;
+
+		uint64_t now = as_clock_getns();
+		uint32_t valid = 0;
+
+		for (uint32_t i = 0; i < n; i++) {
+			as_socket* s = &batch[i];
+
+			if (! as_socket_recently_valid(s, now, window_ns)) {
+				int len = as_socket_validate_fd(s->fd);
+
+				if (len != 0) {
+					// Idle sockets closed by the server are expected, so the error rate is not
+					// incremented.
+					as_log_debug("Invalid idle socket %d: %d", s->fd, len);
+					as_node_close_connection(node, s, pool);
+					continue;
+				}
+				s->validated = now;
+			}
+			batch[valid++] = *s;
+		}
+
+		uint32_t rejected = 0;
+
+		as_conn_pool_lock(pool);
+
+		for (uint32_t i = 0; i < valid; i++) {
+			if (! as_queue_push_head_limit(&pool->queue, &batch[i])) {
+				batch[rejected++] = batch[i];
+			}
+		}
+		as_conn_pool_unlock(pool);
+
+		for (uint32_t i = 0; i < rejected; i++) {
+			as_node_close_connection(node, &batch[i], pool);
+		}
+	}
+}
+
+static void
+as_node_trim_window_connections(as_node* node, as_conn_pool* pool, uint32_t window_size, int excess)
+{
+	pthread_mutex_lock(&pool->lock);
+	uint32_t idle = as_queue_size(&pool->queue);
+	uint32_t total = pool->queue.total;
+	uint32_t surplus = as_conn_window_surplus(&pool->window, window_size, idle, total);
+	pthread_mutex_unlock(&pool->lock);
+
+	if (excess <= 0 || surplus == 0) {
+		return;
+	}
+
+	if (surplus > (uint32_t)excess) {
+		surplus = (uint32_t)excess;
+	}
+
+	// Close a quarter of the connections not used in the window per tend, so a burst
+	// that recurs shortly after does not have to reopen them all.
+	int count = (int)((surplus + 3) / 4);
+	pool->window.trimmed += as_node_close_idle_connections(node, pool, 0, count);
+}
+
+static void
+as_node_flush_conn_cache(as_node* node, as_conn_pool* pool)
+{
+	as_socket s;
+
+	// Move cached connections to the locked queue head, so idle connections
+	// residing in the cache are also subject to trimming.
+	while (as_conn_cache_pop(pool, &s)) {
+		if (! as_conn_pool_push_head_queue(pool, &s)) {
+			as_node_close_connection(node, &s, pool);
+		}
+	}
+}
+
+static void
+as_node_create_spare_connections(as_node* node)
+{
+	as_cluster* cluster = node->cluster;
+	uint32_t demand = as_fas_uint32(&node->sync_conn_demand, 0);
+
+	// Jump to recent demand and decay slowly when demand falls.
+	uint32_t spare = node->spare_target;
+	spare -= spare >> 2;
+
+	if (demand > spare) {
+		spare = demand;
+	}
+
+	if (spare > cluster->spare_conns_per_node) {
+		spare = cluster->spare_conns_per_node;
+	}
+	node->spare_target = spare;
+
+	if (spare == 0) {
+		return;
+	}
+
+	// Distribute spares over pools taking remainder into account.
+	as_conn_pool* pools = node->sync_conn_pools;
+	uint32_t max = cluster->conn_pools_per_node;
+	uint32_t per_pool = spare / max;
+	uint32_t rem = spare - (per_pool * max);
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_conn_pool* pool = &pools[i];
+		uint32_t target = i < rem ? per_pool + 1 : per_pool;
+		// Approximate idle count is sufficient.
+		uint32_t idle = as_queue_size(&pool->queue);
+
+		if (pool->cache) {
+			idle += as_conn_cache_count(pool);
+		}
+
+		if (idle >= target) {
+			continue;
+		}
+
+		uint32_t n = target - idle;
+		uint32_t total = as_load_uint32(&pool->queue.total);
+		uint32_t room = total < pool->queue.capacity ? pool->queue.capacity - total : 0;
+
+		if (n > room) {
+			n = room;
+		}
+
+		if (n > 0) {
+			as_node_create_connections(node, pool, cluster->conn_timeout_ms, (int)n);
+		}
+	}
 }
 
 void
@@ -725,13 +1107,39 @@ as_node_balance_connections(as_node* node)
 		as_conn_pool* pool = &pools[i];
 		int excess = as_conn_pool_excess(pool);
 
+		if (cluster->conn_validate_window_ns > 0) {
+			as_node_validate_idle_connections(node, pool, cluster->conn_validate_window_ns);
+		}
+
+		if (excess > 0 && pool->cache) {
+			as_node_flush_conn_cache(node, pool);
+		}
+
+		if (cluster->conn_peak_window > 0) {
+			as_node_trim_window_connections(node, pool, cluster->conn_peak_window, excess);
+
+			if (excess < 0 && as_node_valid_error_rate(node)) {
+				as_node_create_connections(node, pool, timeout_ms, -excess);
+			}
+			continue;
+		}
+
 		if (excess > 0) {
-			as_node_close_idle_connections(node, pool, excess);
+			uint64_t max_socket_idle_ns = as_load_uint64(&cluster->max_socket_idle_ns_trim);
+			as_node_close_idle_connections(node, pool, max_socket_idle_ns, excess);
 		}
 		else if (excess < 0 && as_node_valid_error_rate(node)) {
 			as_node_create_connections(node, pool, timeout_ms, -excess);
 		}
 	}
+
+	if (node->warm_up_remaining > 0 && as_node_valid_error_rate(node)) {
+		as_node_warm_up_connections(node);
+	}
+
+	if (cluster->spare_conns_per_node > 0 && as_node_valid_error_rate(node)) {
+		as_node_create_spare_connections(node);
+	}
 }
 
 void
@@ -740,11 +1148,7 @@ as_node_signal_login(as_node* node)
 	// Only login when login not already been requested.
 	if (as_cas_uint8(&node->perform_login, 0, 1)) {
 		// Signal tend thread to wake up from sleep, so node tend will occur faster.
-		as_cluster* cluster = node->cluster;
-
-		pthread_mutex_lock(&cluster->tend_lock);
-		pthread_cond_signal(&cluster->tend_cond);
-		pthread_mutex_unlock(&cluster->tend_lock);
+		as_cluster_wake_tender(node->cluster);
 	}
 }
 
@@ -787,6 +1191,26 @@ as_node_login(as_error* err, as_node* node, as_socket* sock)
 	return AEROSPIKE_OK;
 }
 
+static inline bool
+as_node_should_refresh_session(as_node* node)
+{
+	// Return true if session token should be renewed before it expires.
+	as_session* session = node->session;
+	return session && session->refresh > 0 && cf_getns() >= session->refresh;
+}
+
+static void
+as_node_refresh_session(as_node* node, as_socket* sock)
+{
+	as_error err;
+
+	if (as_node_login(&err, node, sock) != AEROSPIKE_OK) {
+		// Current session is still valid. Retry on next tend.
+		as_log_debug("Session refresh failed: %d %s", err.code, err.message);
+		as_store_uint8(&node->perform_login, 0);
+	}
+}
+
 as_status
 as_node_ensure_login_shm(as_error* err, as_node* node)
 {
@@ -811,6 +1235,16 @@ as_node_ensure_login_shm(as_error* err, as_node* node)
 		// Close socket immediately.
 		as_node_close_socket(node, &sock);
 	}
+	else if (as_node_should_refresh_session(node)) {
+		as_socket sock;
+		as_error e;
+		uint64_t deadline_ms = as_socket_deadline(node->cluster->conn_timeout_ms);
+
+		if (as_node_create_socket(&e, node, NULL, &sock, deadline_ms) == AEROSPIKE_OK) {
+			as_node_refresh_session(node, &sock);
+			as_node_close_socket(node, &sock);
+		}
+	}
 	return AEROSPIKE_OK;
 }
 
@@ -900,12 +1334,18 @@ as_node_get_tend_connection(as_error* err, as_node* node)
 		as_node_send_user_agent(node);
 	}
 	else {
-		if (cluster->auth_enabled && as_node_should_login(node)) {
-			status = as_node_login(err, node, &node->info_socket);
+		if (cluster->auth_enabled) {
+			if (as_node_should_login(node)) {
+				status = as_node_login(err, node, &node->info_socket);
 
-			if (status != AEROSPIKE_OK) {
-				as_node_close_socket(node, &node->info_socket);
-				return status;
+				if (status != AEROSPIKE_OK) {
+					as_node_close_socket(node, &node->info_socket);
+					return status;
+				}
+			}
+			else if (as_node_should_refresh_session(node)) {
+				// Renew session so commands never authenticate with an expired token.
+				as_node_refresh_session(node, &node->info_socket);
 			}
 		}
 
@@ -916,8 +1356,8 @@ as_node_get_tend_connection(as_error* err, as_node* node)
 	return status;
 }
 
-static uint8_t*
-as_node_get_info(as_error* err, as_node* node, const char* names, size_t names_len, uint64_t deadline_ms, uint8_t* stack_buf)
+static as_status
+as_node_send_info(as_error* err, as_node* node, const char* names, size_t names_len, uint64_t deadline_ms, uint8_t* stack_buf)
 {
 	as_socket* sock = &node->info_socket;
 	
@@ -934,7 +1374,7 @@ as_node_get_info(as_error* err, as_node* node, const char* names, size_t names_l
 
 	// Write the request. Note that timeout_ms is never 0.
 	if (as_socket_write_deadline(err, sock, node, stack_buf, write_size, 0, deadline_ms) != AEROSPIKE_OK) {
-		return 0;
+		return err->code;
 	}
 	
 	as_ns_metrics* metrics = (node->cluster->metrics_enabled)? as_node_prepare_metrics(node, NULL) : NULL;
@@ -942,8 +1382,16 @@ as_node_get_info(as_error* err, as_node* node, const char* names, size_t names_l
 	if (metrics) {
 		as_node_add_bytes_out(metrics, write_size);
 	}
+	return AEROSPIKE_OK;
+}
 
-	// Reuse the buffer, read the response - first 8 bytes contains body size.
+static uint8_t*
+as_node_recv_info(as_error* err, as_node* node, uint64_t deadline_ms, uint8_t* stack_buf)
+{
+	as_socket* sock = &node->info_socket;
+	as_ns_metrics* metrics = (node->cluster->metrics_enabled)? as_node_prepare_metrics(node, NULL) : NULL;
+
+	// Read the response - first 8 bytes contains body size.
 	if (as_socket_read_deadline(err, sock, node, stack_buf, sizeof(as_proto), 0, deadline_ms) != AEROSPIKE_OK) {
 		return 0;
 	}
@@ -1021,45 +1469,313 @@ as_node_restart(as_cluster* cluster, as_node* node)
 	}
 }
 
-bool
-as_node_valid_error_rate(as_node* node)
+// Moving average weight of a new sample is 1/8.
+#define AS_NODE_EWMA_SHIFT 3
+
+// Adaptive socket timeout histograms are accurate to within 12.5%.
+#define AS_NODE_ADAPTIVE_PRECISION 4
+
+// Minimum recent samples before p99.9 latency is used for adaptive socket timeouts.
+#define AS_NODE_ADAPTIVE_MIN_SAMPLES 100
+
+// Long term latency used by concurrency limits moves 1/16 toward each tend's average.
+#define AS_NODE_LIMIT_LONG_SHIFT 4
+
+static inline uint32_t
+as_node_ewma(uint32_t avg, uint32_t sample)
 {
-	return as_load_uint32(&node->error_rate) <= node->max_error_rate;
+	int64_t delta = (int64_t)sample - (int64_t)avg;
+	return (uint32_t)((int64_t)avg + (delta >> AS_NODE_EWMA_SHIFT));
 }
 
 void
-as_node_reset_error_rate(as_node* node)
+as_node_add_replica_sample(as_node* node, uint64_t elapsed_ns, bool error)
 {
-	if (as_node_valid_error_rate(node)) {
-		as_store_uint32(&node->error_rate, 0);
+	// The moving averages are updated without compare and swap. An occasional lost sample
+	// does not affect replica selection.
+	uint64_t us = elapsed_ns / 1000;
+	uint32_t latency = (us < UINT32_MAX)? (uint32_t)us : UINT32_MAX;
+	uint32_t avg = as_load_uint32(&node->latency_ewma);
+
+	// The first sample initializes the average.
+	avg = (avg == 0)? latency : as_node_ewma(avg, latency);
+	as_store_uint32(&node->latency_ewma, (avg == 0)? 1 : avg);
+
+	avg = as_load_uint32(&node->error_ewma);
+	as_store_uint32(&node->error_ewma, as_node_ewma(avg, error ? AS_NODE_EWMA_ERROR_SCALE : 0));
+}
 
-		// Double max_error_rate until cluster max_error_rate is reached.
-		if (node->max_error_rate != node->cluster->max_error_rate) {
-			uint32_t max = node->max_error_rate * 2;
-			node->max_error_rate = (max <= node->cluster->max_error_rate)?
-				max : node->cluster->max_error_rate;
-		}
+void
+as_node_add_adaptive_sample(as_node* node, uint64_t elapsed_ns)
+{
+	as_latency_hdr* hdr = (as_latency_hdr*)as_load_ptr((void* const*)&node->adaptive_latency);
+
+	if (hdr) {
+		as_latency_hdr_add(hdr, elapsed_ns / 1000);
 	}
-	else {
-		// Error rate was breached. Next error rate trigger is half.
-		as_store_uint32(&node->error_rate, 0);
-		node->max_error_rate = (node->max_error_rate >= 4)?
-			node->max_error_rate / 2 : 1;
+	else if (! as_load_uint8((uint8_t*)&node->cluster->adaptive_timeouts)) {
+		// Histograms are created by the tend thread on the next tend.
+		as_store_uint8((uint8_t*)&node->cluster->adaptive_timeouts, true);
 	}
 }
 
-static const char INFO_STR_CHECK_RACK[] = "node\npeers-generation\npartition-generation\nrebalance-generation\n";
-static const char INFO_STR_CHECK_PEERS[] = "node\npeers-generation\npartition-generation\n";
-
-static as_status
-as_node_process_response(as_cluster* cluster, as_error* err, as_node* node, as_vector* values,
-						 as_peers* peers)
+void
+as_node_update_adaptive_timeout(as_node* node)
 {
-	as_status status;
+	as_latency_hdr* hdr = node->adaptive_latency;
+
+	if (! hdr) {
+		hdr = as_latency_hdr_create(AS_NODE_ADAPTIVE_PRECISION);
+		node->adaptive_counts = cf_calloc(hdr->size * 2, sizeof(uint64_t));
+		as_store_ptr_rls((void**)&node->adaptive_latency, hdr);
+		return;
+	}
+
+	uint32_t size = hdr->size;
+	uint64_t* prev = node->adaptive_counts;
+	uint64_t* window = prev + size;
+	uint64_t* counts = alloca(sizeof(uint64_t) * size);
+
+	memset(counts, 0, sizeof(uint64_t) * size);
+	as_latency_hdr_merge(hdr, counts);
+
+	for (uint32_t i = 0; i < size; i++) {
+		// Samples lose 1/8 of their weight each tend, so recent pauses dominate the window
+		// and are forgotten after a few tend intervals.
+		window[i] -= (window[i] + 7) >> 3;
+		window[i] += counts[i] - prev[i];
+		prev[i] = counts[i];
+	}
+
+	as_latency_percentiles pct;
+	as_latency_hdr_percentiles(hdr->precision, window, size, &pct);
+
+	uint64_t p999 = (pct.count >= AS_NODE_ADAPTIVE_MIN_SAMPLES)? pct.p999 : 0;
+	as_store_uint32(&node->adaptive_p999_us, (p999 < UINT32_MAX)? (uint32_t)p999 : UINT32_MAX);
+}
+
+void
+as_node_update_limit(as_node* node)
+{
+	as_cluster* cluster = node->cluster;
+	uint32_t limit = node->limit;
+	uint32_t peak = as_fas_uint32(&node->limit_peak, 0);
+	uint32_t drops = as_fas_uint32(&node->limit_drops, 0);
+	uint32_t count = as_fas_uint32(&node->limit_rtt_count, 0);
+	uint64_t sum = as_fas_uint64(&node->limit_rtt_sum, 0);
+
+	if (drops > 0) {
+		// Timeouts and overload errors mean the node is already saturated.
+		limit -= limit / 4;
+	}
+	else if (count > 0) {
+		uint64_t rtt = sum / count;
+
+		if (rtt == 0) {
+			rtt = 1;
+		}
+
+		uint64_t rtt_long = node->limit_rtt_long;
+
+		if (rtt_long == 0) {
+			rtt_long = rtt;
+		}
+		else {
+			int64_t delta = (int64_t)rtt - (int64_t)rtt_long;
+			rtt_long = (uint64_t)((int64_t)rtt_long + (delta >> AS_NODE_LIMIT_LONG_SHIFT));
+		}
+		node->limit_rtt_long = (rtt_long < UINT32_MAX)? (uint32_t)rtt_long : UINT32_MAX;
+
+		if (rtt * 2 > rtt_long * 3) {
+			// Commands are queueing on the node. Shrink the limit by the latency gradient,
+			// but by no more than half per tend.
+			uint64_t target = (uint64_t)limit * rtt_long * 3 / (rtt * 2);
+			limit = (target > limit / 2)? (uint32_t)target : limit / 2;
+		}
+		else if (peak * 2 >= limit) {
+			// Latency is stable while the limit is in use. Probe for more capacity.
+			limit += limit / 8 + 1;
+		}
+	}
+
+	if (limit < cluster->limit_min) {
+		limit = cluster->limit_min;
+	}
+	else if (limit > cluster->limit_max) {
+		limit = cluster->limit_max;
+	}
+	as_store_uint32(&node->limit, limit);
+}
+
+void
+as_node_decay_replica_score(as_node* node)
+{
+	uint32_t avg = as_load_uint32(&node->latency_ewma);
+
+	if (avg > 1) {
+		as_store_uint32(&node->latency_ewma, avg - (avg >> AS_NODE_EWMA_SHIFT) - 1);
+	}
+
+	avg = as_load_uint32(&node->error_ewma);
+
+	if (avg > 0) {
+		as_store_uint32(&node->error_ewma, avg - (avg >> AS_NODE_EWMA_SHIFT) - 1);
+	}
+}
+
+bool
+as_node_valid_error_rate(as_node* node)
+{
+	return as_load_uint32(&node->error_rate) <= node->max_error_rate;
+}
+
+void
+as_node_reset_error_rate(as_node* node)
+{
+	if (as_node_valid_error_rate(node)) {
+		as_store_uint32(&node->error_rate, 0);
+
+		// Double max_error_rate until cluster max_error_rate is reached.
+		if (node->max_error_rate != node->cluster->max_error_rate) {
+			uint32_t max = node->max_error_rate * 2;
+			node->max_error_rate = (max <= node->cluster->max_error_rate)?
+				max : node->cluster->max_error_rate;
+		}
+	}
+	else {
+		// Error rate was breached. Next error rate trigger is half.
+		as_store_uint32(&node->error_rate, 0);
+		node->max_error_rate = (node->max_error_rate >= 4)?
+			node->max_error_rate / 2 : 1;
+	}
+}
+
+static inline bool
+as_node_breaker_exceeded(as_cluster* cluster, uint32_t successes, uint32_t failures)
+{
+	uint64_t total = (uint64_t)successes + failures;
+	return (uint64_t)failures * 100 >= total * cluster->breaker_ratio;
+}
+
+static void
+as_node_breaker_open(as_node* node)
+{
+	node->breaker_open_remaining = node->breaker_backoff;
+	node->breaker_trips++;
+	as_store_uint32(&node->breaker_probes, 0);
+	as_store_uint32(&node->breaker_state, AS_BREAKER_OPEN);
+}
+
+uint32_t
+as_node_update_breaker(as_node* node, bool window_end)
+{
+	as_cluster* cluster = node->cluster;
+
+	switch (node->breaker_state) {
+		case AS_BREAKER_CLOSED: {
+			if (! window_end) {
+				break;
+			}
+
+			uint32_t successes = as_load_uint32(&node->breaker_successes);
+			uint32_t failures = as_load_uint32(&node->breaker_failures);
+
+			as_store_uint32(&node->breaker_successes, 0);
+			as_store_uint32(&node->breaker_failures, 0);
+
+			if (successes + failures >= cluster->breaker_min_commands &&
+				as_node_breaker_exceeded(cluster, successes, failures)) {
+				as_node_breaker_open(node);
+			}
+			break;
+		}
+
+		case AS_BREAKER_OPEN: {
+			if (--node->breaker_open_remaining > 0) {
+				break;
+			}
+
+			// Commands still in flight when the breaker opened are not counted as probes.
+			as_store_uint32(&node->breaker_successes, 0);
+			as_store_uint32(&node->breaker_failures, 0);
+			as_store_uint32(&node->breaker_probes, cluster->breaker_probes);
+			as_store_uint32(&node->breaker_state, AS_BREAKER_HALF_OPEN);
+			break;
+		}
+
+		default: {
+			uint32_t successes = as_load_uint32(&node->breaker_successes);
+			uint32_t failures = as_load_uint32(&node->breaker_failures);
+
+			if (successes + failures == 0) {
+				// No probe completed yet. Allow another round of probes.
+				as_store_uint32(&node->breaker_probes, cluster->breaker_probes);
+				break;
+			}
+
+			as_store_uint32(&node->breaker_successes, 0);
+			as_store_uint32(&node->breaker_failures, 0);
+
+			if (as_node_breaker_exceeded(cluster, successes, failures)) {
+				// Probes failed. Double open duration until max is reached.
+				uint32_t backoff = node->breaker_backoff * 2;
+				node->breaker_backoff = (backoff <= cluster->breaker_max_open_tends)?
+					backoff : cluster->breaker_max_open_tends;
+				as_node_breaker_open(node);
+			}
+			else {
+				node->breaker_backoff = cluster->breaker_open_tends;
+				as_store_uint32(&node->breaker_state, AS_BREAKER_CLOSED);
+			}
+			break;
+		}
+	}
+	return node->breaker_state;
+}
+
+static const char INFO_STR_CHECK_RACK[] = "node\npeers-generation\npartition-generation\nrebalance-generation\n";
+static const char INFO_STR_CHECK_PEERS[] = "node\npeers-generation\npartition-generation\n";
+
+// Variants used after a query with fail_on_cluster_change was run. Without a namespace,
+// cluster-stable fails when any namespace is migrating.
+static const char INFO_STR_CHECK_RACK_KEY[] =
+	"node\npeers-generation\npartition-generation\nrebalance-generation\ncluster-stable\n";
+static const char INFO_STR_CHECK_PEERS_KEY[] =
+	"node\npeers-generation\npartition-generation\ncluster-stable\n";
+
+static void
+as_node_set_cluster_key(as_node* node, const char* value)
+{
+	uint64_t cluster_key = 0;
+
+	// Error responses like "ERROR::unstable-cluster" leave the key unset.
+	if (strncmp(value, "ERROR", 5) != 0) {
+		errno = 0;
+		cluster_key = strtoull(value, NULL, 16);
+
+		if (cluster_key == ULLONG_MAX && errno) {
+			cluster_key = 0;
+		}
+	}
+	as_store_uint64(&node->cluster_key, cluster_key);
+	as_store_uint64_rls(&node->cluster_key_ms, cf_getms());
+}
+
+static as_status
+as_node_process_response(as_cluster* cluster, as_error* err, as_node* node, as_vector* values,
+						 as_peers* peers)
+{
+	as_status status;
+
+	for (uint32_t i = 0; i < values->size; i++) {
+		as_name_value* nv = as_vector_get(values, i);
+
+		if (strcmp(nv->name, "cluster-stable") == 0) {
+			// Unstable cluster is an expected error response.
+			as_node_set_cluster_key(node, nv->value);
+			continue;
+		}
 
-	for (uint32_t i = 0; i < values->size; i++) {
-		as_name_value* nv = as_vector_get(values, i);
-		
 		status = as_info_validate_item(err, nv->value);
 
 		if (status != AEROSPIKE_OK) {
@@ -1110,7 +1826,7 @@ as_node_process_response(as_cluster* cluster, as_error* err, as_node* node, as_v
  * Request current status from server node.
  */
 as_status
-as_node_refresh(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
+as_node_refresh_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms)
 {
 	as_status status = as_node_get_tend_connection(err, node);
 	
@@ -1119,22 +1835,50 @@ as_node_refresh(as_cluster* cluster, as_error* err, as_node* node, as_peers* pee
 	}
 
 	// Set new deadline because login may have occurred which can take a long time.
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+	*deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
 
 	const char* command;
 	size_t command_len;
 	
+	bool cluster_key = as_load_uint8((uint8_t*)&cluster->tend_cluster_key);
+
 	if (cluster->rack_aware) {
-		command = INFO_STR_CHECK_RACK;
-		command_len = sizeof(INFO_STR_CHECK_RACK) - 1;
+		if (cluster_key) {
+			command = INFO_STR_CHECK_RACK_KEY;
+			command_len = sizeof(INFO_STR_CHECK_RACK_KEY) - 1;
+		}
+		else {
+			command = INFO_STR_CHECK_RACK;
+			command_len = sizeof(INFO_STR_CHECK_RACK) - 1;
+		}
 	}
 	else {
-		command = INFO_STR_CHECK_PEERS;
-		command_len = sizeof(INFO_STR_CHECK_PEERS) - 1;
+		if (cluster_key) {
+			command = INFO_STR_CHECK_PEERS_KEY;
+			command_len = sizeof(INFO_STR_CHECK_PEERS_KEY) - 1;
+		}
+		else {
+			command = INFO_STR_CHECK_PEERS;
+			command_len = sizeof(INFO_STR_CHECK_PEERS) - 1;
+		}
+	}
+
+	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
+	status = as_node_send_info(err, node, command, command_len, *deadline_ms, stack_buf);
+
+	if (status != AEROSPIKE_OK) {
+		as_node_close_socket(node, &node->info_socket);
 	}
+	return status;
+}
 
+as_status
+as_node_refresh_recv(
+	as_cluster* cluster, as_error* err, as_node* node, as_peers* peers, uint64_t deadline_ms
+	)
+{
 	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
+	uint8_t* buf = as_node_recv_info(err, node, deadline_ms, stack_buf);
 	
 	if (! buf) {
 		as_node_close_socket(node, &node->info_socket);
@@ -1146,7 +1890,7 @@ as_node_refresh(as_cluster* cluster, as_error* err, as_node* node, as_peers* pee
 	
 	as_info_parse_multi_response((char*)buf, &values);
 
-	status = as_node_process_response(cluster, err, node, &values, peers);
+	as_status status = as_node_process_response(cluster, err, node, &values, peers);
 
 	if (status == AEROSPIKE_ERR_CLIENT) {
 		as_node_close_socket(node, &node->info_socket);
@@ -1202,11 +1946,11 @@ as_node_process_peers(as_cluster* cluster, as_error* err, as_node* node, as_vect
 }
 
 as_status
-as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
+as_node_refresh_peers_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms)
 {
 	as_log_debug("Update peers for node %s", as_node_get_address_string(node));
 
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+	*deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
 	const char* command;
 	size_t command_len;
 
@@ -1230,9 +1974,23 @@ as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peer
 			command_len = sizeof(INFO_STR_PEERS_CLEAR_STD) - 1;
 		}
 	}
-	
+
+	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
+	as_status status = as_node_send_info(err, node, command, command_len, *deadline_ms, stack_buf);
+
+	if (status != AEROSPIKE_OK) {
+		as_node_close_socket(node, &node->info_socket);
+	}
+	return status;
+}
+
+as_status
+as_node_refresh_peers_recv(
+	as_cluster* cluster, as_error* err, as_node* node, as_peers* peers, uint64_t deadline_ms
+	)
+{
 	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
+	uint8_t* buf = as_node_recv_info(err, node, deadline_ms, stack_buf);
 	
 	if (! buf) {
 		as_node_close_socket(node, &node->info_socket);
@@ -1257,7 +2015,21 @@ as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peer
 	return status;
 }
 
+as_status
+as_node_refresh_peers(as_cluster* cluster, as_error* err, as_node* node, as_peers* peers)
+{
+	uint64_t deadline_ms;
+	as_status status = as_node_refresh_peers_send(cluster, err, node, &deadline_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+	return as_node_refresh_peers_recv(cluster, err, node, peers, deadline_ms);
+}
+
 static const char INFO_STR_GET_REPLICAS_REGIME[] = "partition-generation\nreplicas\n";
+static const char INFO_STR_GET_REPLICAS_RACKS[] =
+	"partition-generation\nreplicas\nrebalance-generation\nrack-ids\n";
 
 static as_status
 as_node_process_partitions(as_cluster* cluster, as_error* err, as_node* node, as_vector* values)
@@ -1271,6 +2043,28 @@ as_node_process_partitions(as_cluster* cluster, as_error* err, as_node* node, as
 		else if (strcmp(nv->name, "replicas") == 0) {
 			as_partition_tables_update_all(cluster, node, nv->value);
 		}
+		else if (strcmp(nv->name, "rebalance-generation") == 0) {
+			as_status status = as_info_validate_item(err, nv->value);
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+			node->rebalance_generation = (uint32_t)strtoul(nv->value, NULL, 10);
+		}
+		else if (strcmp(nv->name, "rack-ids") == 0) {
+			as_status status = as_info_validate_item(err, nv->value);
+
+			if (status == AEROSPIKE_OK) {
+				status = as_node_parse_racks(cluster, err, node, nv->value);
+			}
+
+			if (status != AEROSPIKE_OK) {
+				return status;
+			}
+
+			// Racks were read with the partition map, so a separate rack refresh is not needed.
+			node->rebalance_changed = false;
+		}
 		else {
 			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Node %s did not request info '%s'", node->name, nv->name);
 		}
@@ -1279,16 +2073,38 @@ as_node_process_partitions(as_cluster* cluster, as_error* err, as_node* node, as
 }
 
 as_status
-as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node)
+as_node_refresh_partitions_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms)
 {
 	as_log_debug("Update partition map for node %s", as_node_get_address_string(node));
 
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
-	const char* command = INFO_STR_GET_REPLICAS_REGIME;
-	size_t command_len = sizeof(INFO_STR_GET_REPLICAS_REGIME) - 1;
+	*deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+	const char* command;
+	size_t command_len;
+
+	if (node->rebalance_changed) {
+		// Fold the rack refresh into the same round trip.
+		command = INFO_STR_GET_REPLICAS_RACKS;
+		command_len = sizeof(INFO_STR_GET_REPLICAS_RACKS) - 1;
+	}
+	else {
+		command = INFO_STR_GET_REPLICAS_REGIME;
+		command_len = sizeof(INFO_STR_GET_REPLICAS_REGIME) - 1;
+	}
 
 	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, command, command_len, deadline_ms, stack_buf);
+	as_status status = as_node_send_info(err, node, command, command_len, *deadline_ms, stack_buf);
+
+	if (status != AEROSPIKE_OK) {
+		as_node_close_socket(node, &node->info_socket);
+	}
+	return status;
+}
+
+as_status
+as_node_refresh_partitions_recv(as_cluster* cluster, as_error* err, as_node* node, uint64_t deadline_ms)
+{
+	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
+	uint8_t* buf = as_node_recv_info(err, node, deadline_ms, stack_buf);
 
 	if (! buf) {
 		as_node_close_socket(node, &node->info_socket);
@@ -1309,6 +2125,18 @@ as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node)
 	return status;
 }
 
+as_status
+as_node_refresh_partitions(as_cluster* cluster, as_error* err, as_node* node)
+{
+	uint64_t deadline_ms;
+	as_status status = as_node_refresh_partitions_send(cluster, err, node, &deadline_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+	return as_node_refresh_partitions_recv(cluster, err, node, deadline_ms);
+}
+
 /**
  * Use non-inline function for garbarge collector function pointer reference.
  * Forward to inlined release.
@@ -1332,6 +2160,7 @@ as_node_replace_racks(as_cluster* cluster, as_node* node, as_racks* racks)
 	as_racks* old = node->racks;
 
 	as_store_ptr_rls((void**)&node->racks, racks);
+	as_incr_uint32(&cluster->racks_gen);
 
 	if (old) {
 		// Put old racks on garbage collector stack.
@@ -1355,25 +2184,20 @@ as_node_parse_racks(as_cluster* cluster, as_error* err, as_node* node, char* buf
 	char* p = buf;
 	uint32_t size = 0;
 
-	while (*p) {
-		if (*p == ':') {
-			p++;
-			size++;
+	while (*(p = as_info_find(p, ":"))) {
+		p++;
+		size++;
 
-			if (same) {
-				int r = (int)strtol(p, NULL, 10);
+		if (same) {
+			int r = (int)strtol(p, NULL, 10);
 
-				if (first) {
-					rack_id = r;
-					first = false;
-				}
-				else if (rack_id != r) {
-					same = false;
-				}
+			if (first) {
+				rack_id = r;
+				first = false;
+			}
+			else if (rack_id != r) {
+				same = false;
 			}
-		}
-		else {
-			p++;
 		}
 	}
 
@@ -1410,13 +2234,7 @@ as_node_parse_racks(as_cluster* cluster, as_error* err, as_node* node, char* buf
 			begin = ++p;
 
 			// Parse rack.
-			while (*p) {
-				if (*p == ';' || *p == '\n') {
-					*p = 0;
-					break;
-				}
-				p++;
-			}
+			p = as_info_terminate(p, ";\n");
 
 			int r = (int)strtol(begin, NULL, 10);
 			as_rack* rack = &racks->racks[current++];
@@ -1444,6 +2262,82 @@ release_latency(as_latency* latency)
 	as_latency_release(latency);
 }
 
+static inline void
+release_latency_hdr(as_latency_hdr* hdr)
+{
+	as_latency_hdr_release(hdr);
+}
+
+static void
+release_hot_keys(as_hot_keys* hk)
+{
+	as_hot_keys_destroy(hk);
+}
+
+static void
+release_partition_heat(as_partition_heat* heat)
+{
+	as_partition_heat_destroy(heat);
+}
+
+static inline uint32_t
+as_node_tcp_ewma(uint32_t avg, uint32_t sample)
+{
+	// Same 1/8 weight as the kernel's smoothed round trip time.
+	return (uint32_t)(((uint64_t)avg * 7 + sample) / 8);
+}
+
+void
+as_node_sample_tcp_info(as_node* node, as_socket_fd fd, uint64_t next, uint64_t now)
+{
+	as_cluster* cluster = node->cluster;
+	uint32_t interval = cluster->metrics_tcp_info_interval;
+
+	if (! interval) {
+		// Metrics were disabled. Stop sampling until they are enabled again.
+		as_cas_uint64(&node->tcp_info_next, next, 0);
+		return;
+	}
+
+	// Only the thread that advances the timestamp samples this interval.
+	if (! as_cas_uint64(&node->tcp_info_next, next, now + (uint64_t)interval * 1000 * 1000)) {
+		return;
+	}
+
+	as_tcp_info info;
+
+	if (! as_tcp_info_read(fd, &info)) {
+		return;
+	}
+
+	as_tcp_info* avg = &node->tcp_info;
+
+	if (as_load_uint64(&node->tcp_info_samples) == 0) {
+		as_store_uint32(&avg->rtt_us, info.rtt_us);
+		as_store_uint32(&avg->rttvar_us, info.rttvar_us);
+		as_store_uint32(&avg->retrans, info.retrans);
+	}
+	else {
+		as_store_uint32(&avg->rtt_us, as_node_tcp_ewma(avg->rtt_us, info.rtt_us));
+		as_store_uint32(&avg->rttvar_us, as_node_tcp_ewma(avg->rttvar_us, info.rttvar_us));
+		as_store_uint32(&avg->retrans, as_node_tcp_ewma(avg->retrans, info.retrans));
+	}
+	as_store_uint32(&avg->cwnd, info.cwnd);
+	as_incr_uint64(&node->tcp_info_samples);
+}
+
+void
+as_node_get_tcp_info(as_node* node, as_tcp_info* info, uint64_t* samples)
+{
+	as_tcp_info* avg = &node->tcp_info;
+
+	info->rtt_us = as_load_uint32(&avg->rtt_us);
+	info->rttvar_us = as_load_uint32(&avg->rttvar_us);
+	info->cwnd = as_load_uint32(&avg->cwnd);
+	info->retrans = as_load_uint32(&avg->retrans);
+	*samples = as_load_uint64(&node->tcp_info_samples);
+}
+
 void
 as_node_enable_metrics(as_node* node, const as_metrics_policy* policy)
 {
@@ -1451,26 +2345,29 @@ as_node_enable_metrics(as_node* node, const as_metrics_policy* policy)
 	as_ns_metrics** array = node->metrics;
 	uint8_t max = node->metrics_size;
 
+	// Restart TCP state sampling.
+	as_store_uint64(&node->tcp_info_samples, 0);
+	as_store_uint64(&node->tcp_info_next, node->cluster->metrics_tcp_info_interval ? cf_getns() : 0);
+
 	for (uint8_t i = 0; i < max; i++) {
 		as_ns_metrics* metrics = array[i];
 
 		// Initialize latency buckets.
-		for (uint8_t j = 0; j < AS_LATENCY_TYPE_MAX; j++) {
+		for (uint8_t j = 0; j < AS_LATENCY_SLOTS; j++) {
 			as_latency* latency = metrics->latency[j];
 
 			if (policy->latency_columns == latency->size && policy->latency_shift == latency->shift) {
 				// Initialize existing latency histogram.
-				for (uint8_t k = 0; k < latency->size; k++) {
+				uint32_t n = as_latency_stride(latency->size) * AS_METRICS_STRIPES;
+
+				for (uint32_t k = 0; k < n; k++) {
 					as_store_uint64(&latency->buckets[k], 0);
 				}
 			}
 			else {
 				// Create new latency histogram.
 				as_latency* latency_old = latency;
-				latency = cf_calloc(1, sizeof(as_latency) + (sizeof(uint64_t) * policy->latency_columns));
-				latency->ref_count = 1;
-				latency->shift = policy->latency_shift;
-				latency->size = policy->latency_columns;
+				latency = as_latency_create(policy->latency_shift, policy->latency_columns);
 
 				as_store_ptr_rls((void**)&metrics->latency[j], latency);
 
@@ -1480,6 +2377,68 @@ as_node_enable_metrics(as_node* node, const as_metrics_policy* policy)
 				item.release_fn = (as_release_fn)release_latency;
 				as_vector_append(node->cluster->gc, &item);
 			}
+
+			// Initialize high resolution latency histogram.
+			as_latency_hdr* hdr = metrics->latency_hdr[j];
+			uint8_t precision = node->cluster->metrics_latency_precision;
+
+			if (hdr && hdr->precision == precision) {
+				for (uint32_t k = 0; k < hdr->size * AS_LATENCY_HDR_STRIPES; k++) {
+					as_store_uint64(&hdr->buckets[k], 0);
+				}
+			}
+			else if (hdr || precision) {
+				as_latency_hdr* hdr_new = precision ? as_latency_hdr_create(precision) : NULL;
+
+				as_store_ptr_rls((void**)&metrics->latency_hdr[j], hdr_new);
+
+				if (hdr) {
+					// Put old histogram on garbage collector stack.
+					as_gc_item item;
+					item.data = hdr;
+					item.release_fn = (as_release_fn)release_latency_hdr;
+					as_vector_append(node->cluster->gc, &item);
+				}
+			}
+		}
+
+		// Initialize hot key tracker.
+		as_hot_keys* hk = metrics->hot_keys;
+		uint32_t hot_keys = node->cluster->metrics_hot_keys;
+
+		if (hk && hk->capacity == hot_keys) {
+			as_hot_keys_clear(hk);
+		}
+		else if (hk || hot_keys) {
+			as_store_ptr_rls((void**)&metrics->hot_keys, hot_keys ? as_hot_keys_create(hot_keys) : NULL);
+
+			if (hk) {
+				// Put old tracker on garbage collector stack.
+				as_gc_item item;
+				item.data = hk;
+				item.release_fn = (as_release_fn)release_hot_keys;
+				as_vector_append(node->cluster->gc, &item);
+			}
+		}
+
+		// Initialize partition heatmap.
+		as_partition_heat* heat = metrics->partition_heat;
+		uint32_t sample = node->cluster->metrics_partition_heatmap;
+
+		if (heat && heat->sample == sample) {
+			as_partition_heat_clear(heat);
+		}
+		else if (heat || sample) {
+			as_store_ptr_rls((void**)&metrics->partition_heat,
+				sample ? as_partition_heat_create(node->cluster->n_partitions, sample) : NULL);
+
+			if (heat) {
+				// Put old heatmap on garbage collector stack.
+				as_gc_item item;
+				item.data = heat;
+				item.release_fn = (as_release_fn)release_partition_heat;
+				as_vector_append(node->cluster->gc, &item);
+			}
 		}
 	}
 }
@@ -1523,11 +2482,7 @@ as_node_append_metrics(as_node* node, const char* ns)
 	if (!metrics) {
 		metrics = cf_malloc(sizeof(as_ns_metrics));
 		metrics->ns = ns;
-		metrics->bytes_in = 0;
-		metrics->bytes_out = 0;
-		metrics->error_count = 0;
-		metrics->timeout_count = 0;
-		metrics->key_busy_count = 0;
+		memset(metrics->counters, 0, sizeof(metrics->counters));
 
 		uint8_t latency_columns;
 		uint8_t latency_shift;
@@ -1541,13 +2496,17 @@ as_node_append_metrics(as_node* node, const char* ns)
 			latency_shift = 1;
 		}
 
-		for (uint8_t i = 0; i < AS_LATENCY_TYPE_MAX; i++) {
-			as_latency* latency = cf_calloc(1, sizeof(as_latency) + (sizeof(uint64_t) * latency_columns));
-			latency->ref_count = 1;
-			latency->shift = latency_shift;
-			latency->size = latency_columns;
-			metrics->latency[i] = latency;
+		for (uint8_t i = 0; i < AS_LATENCY_SLOTS; i++) {
+			metrics->latency[i] = as_latency_create(latency_shift, latency_columns);
+
+			metrics->latency_hdr[i] = (cluster->metrics_enabled && cluster->metrics_latency_precision)?
+				as_latency_hdr_create(cluster->metrics_latency_precision) : NULL;
 		}
+
+		metrics->hot_keys = (cluster->metrics_enabled && cluster->metrics_hot_keys)?
+			as_hot_keys_create(cluster->metrics_hot_keys) : NULL;
+		metrics->partition_heat = (cluster->metrics_enabled && cluster->metrics_partition_heatmap)?
+			as_partition_heat_create(cluster->n_partitions, cluster->metrics_partition_heatmap) : NULL;
 		node->metrics[node->metrics_size++] = metrics;
 	}
 	pthread_mutex_unlock(&cluster->metrics_lock);
@@ -1598,10 +2557,18 @@ as_node_add_latency(as_ns_metrics* metrics, as_latency_type latency_type, uint64
 
 	as_latency* latency = as_latency_reserve(metrics->latency[latency_type]);
 
+	uint32_t stripe = as_metrics_stripe(AS_METRICS_STRIPES);
 	uint8_t index = as_latency_get_index(latency, elapsed);
-	as_incr_uint64(&latency->buckets[index]);
+	as_incr_uint64(&latency->buckets[stripe * as_latency_stride(latency->size) + index]);
 
 	as_latency_release(latency);
+
+	as_latency_hdr* hdr = as_latency_hdr_reserve(&metrics->latency_hdr[latency_type]);
+
+	if (hdr) {
+		as_latency_hdr_add(hdr, elapsed_nanos / 1000);
+		as_latency_hdr_release(hdr);
+	}
 }
 
 void
@@ -1615,7 +2582,7 @@ as_node_add_error(as_node* node, const char* ns, as_ns_metrics* metrics)
 			return;
 		}
 	}
-	as_incr_uint64(&metrics->error_count);
+	as_incr_uint64(&as_ns_metrics_counters(metrics)->error_count);
 }
 
 void
@@ -1629,7 +2596,7 @@ as_node_add_timeout(as_node* node, const char* ns, as_ns_metrics* metrics)
 			return;
 		}
 	}
-	as_incr_uint64(&metrics->timeout_count);
+	as_incr_uint64(&as_ns_metrics_counters(metrics)->timeout_count);
 }
 
 void
@@ -1643,7 +2610,25 @@ as_node_add_key_busy(as_node* node, const char* ns, as_ns_metrics* metrics)
 			return;
 		}
 	}
-	as_incr_uint64(&metrics->key_busy_count);
+	as_incr_uint64(&as_ns_metrics_counters(metrics)->key_busy_count);
+}
+
+void
+as_node_add_near_cache(as_node* node, const char* ns, bool hit)
+{
+	// Near cache counts are always on.
+	as_ns_metrics* metrics = as_node_prepare_metrics(node, ns);
+
+	if (!metrics) {
+		return;
+	}
+
+	if (hit) {
+		as_incr_uint64(&as_ns_metrics_counters(metrics)->near_cache_hit_count);
+	}
+	else {
+		as_incr_uint64(&as_ns_metrics_counters(metrics)->near_cache_miss_count);
+	}
 }
 
 static as_status
@@ -1675,14 +2660,27 @@ as_node_process_racks(as_cluster* cluster, as_error* err, as_node* node, as_vect
 static const char INFO_STR_GET_RACKS[] = "rebalance-generation\nrack-ids\n";
 
 as_status
-as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node)
+as_node_refresh_racks_send(as_cluster* cluster, as_error* err, as_node* node, uint64_t* deadline_ms)
 {
 	as_log_debug("Update racks for node %s", as_node_get_address_string(node));
 
-	uint64_t deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+	*deadline_ms = as_socket_deadline(cluster->conn_timeout_ms);
+
+	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
+	as_status status = as_node_send_info(err, node, INFO_STR_GET_RACKS,
+		sizeof(INFO_STR_GET_RACKS) - 1, *deadline_ms, stack_buf);
+
+	if (status != AEROSPIKE_OK) {
+		as_node_close_socket(node, &node->info_socket);
+	}
+	return status;
+}
 
+as_status
+as_node_refresh_racks_recv(as_cluster* cluster, as_error* err, as_node* node, uint64_t deadline_ms)
+{
 	uint8_t stack_buf[INFO_STACK_BUF_SIZE];
-	uint8_t* buf = as_node_get_info(err, node, INFO_STR_GET_RACKS, sizeof(INFO_STR_GET_RACKS) - 1, deadline_ms, stack_buf);
+	uint8_t* buf = as_node_recv_info(err, node, deadline_ms, stack_buf);
 
 	if (! buf) {
 		as_node_close_socket(node, &node->info_socket);
@@ -1702,3 +2700,15 @@ as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node)
 	as_vector_destroy(&values);
 	return status;
 }
+
+as_status
+as_node_refresh_racks(as_cluster* cluster, as_error* err, as_node* node)
+{
+	uint64_t deadline_ms;
+	as_status status = as_node_refresh_racks_send(cluster, err, node, &deadline_ms);
+
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+	return as_node_refresh_racks_recv(cluster, err, node, deadline_ms);
+}
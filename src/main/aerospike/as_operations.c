@@ -15,6 +15,7 @@
  * the License.
  */
 #include <aerospike/as_operations.h>
+#include <aerospike/as_arena.h>
 #include <aerospike/as_bin.h>
 #include <citrusleaf/alloc.h>
 
@@ -32,6 +33,7 @@ as_operations_default(as_operations* ops, bool free, uint16_t nops)
 	ops->_free = free;
 	ops->gen = 0;
 	ops->ttl = 0;
+	ops->arena = NULL;
 
 	as_binop * entries = NULL;
 	if ( nops > 0 ) {
@@ -109,6 +111,24 @@ as_operations_new(uint16_t nops)
 	return as_operations_default(ops, true, nops);
 }
 
+as_operations*
+as_operations_init_arena(as_operations* ops, uint16_t nops, as_arena* arena)
+{
+	if ( !ops ) return ops;
+
+	ops->_free = false;
+	ops->gen = 0;
+	ops->ttl = 0;
+	ops->arena = arena;
+	ops->binops._free = false;
+	ops->binops.capacity = nops;
+	ops->binops.size = 0;
+	ops->binops.entries = (nops > 0)?
+		(as_binop*)as_arena_alloc(arena, sizeof(as_binop) * nops) : NULL;
+	arena->users++;
+	return ops;
+}
+
 void
 as_operations_destroy(as_operations* ops)
 {
@@ -130,6 +150,14 @@ as_operations_destroy(as_operations* ops)
 	ops->binops.size = 0;
 	ops->binops.entries = NULL;
 
+	// reset arena after its last user is done
+	if ( ops->arena ) {
+		if ( --ops->arena->users == 0 ) {
+			as_arena_reset(ops->arena);
+		}
+		ops->arena = NULL;
+	}
+
 	if ( ops->_free ) {
 		cf_free(ops);
 	}
@@ -16,9 +16,12 @@
  */
 #include <aerospike/as_partition.h>
 #include <aerospike/as_atomic.h>
+#include <aerospike/as_bitmap.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_info.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_log_macros.h>
+#include <aerospike/as_mem_stats.h>
 #include <aerospike/as_node.h>
 #include <aerospike/as_policy.h>
 #include <aerospike/as_shm_cluster.h>
@@ -84,11 +87,17 @@ as_partition_table_create(const char* ns, uint32_t capacity, uint8_t replica_siz
 {
 	size_t len = sizeof(as_partition_table) + (sizeof(as_partition) * capacity);
 	as_partition_table* table = cf_malloc(len);
+	as_mem_stats_alloc(AS_MEM_TAG_CLUSTER, len);
 	memset(table, 0, len);
 	as_strncpy(table->ns, ns, AS_MAX_NAMESPACE_SIZE);
 	table->size = capacity;
 	table->replica_size = replica_size;
 	table->sc_mode = sc_mode;
+	table->racks_stale = true;
+
+	for (uint32_t i = 0; i < capacity; i++) {
+		memset(table->partitions[i].rack_rank, AS_PARTITION_RACK_UNKNOWN, AS_MAX_REPLICATION_FACTOR);
+	}
 	return table;
 }
 
@@ -106,6 +115,8 @@ as_partition_table_destroy(as_partition_table* table)
 			}
 		}
 	}
+	as_mem_stats_free(AS_MEM_TAG_CLUSTER,
+		sizeof(as_partition_table) + (sizeof(as_partition) * table->size));
 	cf_free(table);
 }
 
@@ -145,6 +156,60 @@ get_replica_sequence(as_partition* p, uint8_t replica_size, uint8_t* replica_ind
 	return NULL;
 }
 
+static as_node*
+get_replica_latency(
+	as_partition* p, as_node* prev_node, uint8_t replica_size, uint8_t* replica_index
+	)
+{
+	as_node* best = NULL;
+	uint64_t best_score = 0;
+	uint8_t best_index = 0;
+	uint8_t seq = *replica_index;
+
+	for (uint8_t i = 0; i < replica_size; i++, seq++) {
+		uint8_t index = seq % replica_size;
+		as_node* node = as_node_load(&p->nodes[index]);
+
+		// Avoid retrying on node where command failed. The contents of prev_node may have
+		// already been destroyed, so just use pointer comparison.
+		if (! node || node == prev_node || ! as_node_is_active(node)) {
+			continue;
+		}
+
+		uint64_t score = as_node_get_replica_score(node);
+
+		// The first valid node in sequence order is kept unless another node scores at
+		// least 25% lower. This hysteresis avoids flapping between similar nodes.
+		if (! best || score * 4 < best_score * 3) {
+			best = node;
+			best_score = score;
+			best_index = index;
+		}
+	}
+
+	if (best) {
+		*replica_index = best_index;
+		return best;
+	}
+
+	// Fall back to previous node if it's the only one left.
+	return get_replica_sequence(p, replica_size, replica_index);
+}
+
+static inline bool
+partition_node_on_rack(
+	as_partition* p, uint32_t index, as_node* node, const char* ns, uint32_t rank, int rack_id
+	)
+{
+	uint8_t r = as_load_uint8(&p->rack_rank[index]);
+
+	if (r == AS_PARTITION_RACK_UNKNOWN) {
+		// Node changed since last rebuild.
+		return as_node_has_rack(node, ns, rack_id);
+	}
+	return r == rank;
+}
+
 static as_node*
 get_replica_rack(
 	as_cluster* cluster, const char* ns, as_partition* p, as_node* prev_node,
@@ -174,7 +239,7 @@ get_replica_rack(
 				// already been destroyed, so just use pointer comparison and never
 				// examine the contents of prev_node!
 				if (node != prev_node) {
-					if (as_node_has_rack(node, ns, rack_id)) {
+					if (partition_node_on_rack(p, index, node, ns, i, rack_id)) {
 						if (as_node_is_active(node)) {
 							*replica_index = (uint8_t)index;
 							return node;
@@ -210,6 +275,44 @@ get_replica_rack(
 	return NULL;
 }
 
+uint32_t
+as_partition_reg_get_rack_nodes(
+	as_cluster* cluster, const char* ns, as_partition* p, uint8_t replica_size,
+	uint8_t replica_index, as_node** nodes
+	)
+{
+	uint32_t replica_max = replica_size;
+
+	if (replica_max > AS_MAX_REPLICATION_FACTOR) {
+		replica_max = AS_MAX_REPLICATION_FACTOR;
+	}
+
+	as_vector* rack_ids = as_rack_ids_load(&cluster->rack_ids);
+	int* ids = rack_ids->list;
+	uint32_t rack_max = rack_ids->size;
+
+	for (uint32_t i = 0; i < rack_max; i++) {
+		int rack_id = ids[i];
+		uint32_t seq = replica_index;
+		uint32_t count = 0;
+
+		for (uint32_t j = 0; j < replica_max; j++, seq++) {
+			uint32_t index = seq % replica_max;
+			as_node* node = as_node_load(&p->nodes[index]);
+
+			if (node && as_node_is_active(node) &&
+				partition_node_on_rack(p, index, node, ns, i, rack_id)) {
+				nodes[count++] = node;
+			}
+		}
+
+		if (count > 0) {
+			return count;
+		}
+	}
+	return 0;
+}
+
 as_node*
 as_partition_reg_get_node(
 	as_cluster* cluster, const char* ns, as_partition* p, as_node* prev_node,
@@ -223,6 +326,9 @@ as_partition_reg_get_node(
 		case AS_POLICY_REPLICA_PREFER_RACK:
 			return get_replica_rack(cluster, ns, p, prev_node, replica_size, replica_index);
 
+		case AS_POLICY_REPLICA_LOWEST_LATENCY:
+			return get_replica_latency(p, prev_node, replica_size, replica_index);
+
 		// The remaining replica algorithms use replica_index as the starting point
 		// and iterate till a valid node is found.
 		default:
@@ -233,6 +339,79 @@ as_partition_reg_get_node(
 	}
 }
 
+static inline uint64_t
+as_partition_route_hint(as_cluster* cluster, as_policy_replica replica, uint8_t replica_index)
+{
+	// Hint layout: routing generation (32 bits) | cluster serial (8 bits) | replica (8 bits) |
+	// initial replica index (8 bits) | chosen replica index (8 bits).
+	uint32_t gen = as_load_uint32(&cluster->routing_gen) + as_load_uint32(&cluster->racks_gen);
+
+	return ((uint64_t)gen << 32) | ((uint64_t)(cluster->serial & 0xFF) << 24) |
+		((uint64_t)replica << 16) | ((uint64_t)replica_index << 8);
+}
+
+as_node*
+as_partition_reg_get_node_hint(
+	as_cluster* cluster, const as_key* key, const char* ns, as_partition* p,
+	as_policy_replica replica, uint8_t replica_size, uint8_t* replica_index
+	)
+{
+	// Load generation before routing, so a change during routing invalidates the new hint.
+	uint64_t expect = as_partition_route_hint(cluster, replica, *replica_index);
+	uint64_t hint = as_load_uint64((uint64_t*)&key->route_hint);
+
+	if ((hint & ~(uint64_t)0xFF) == expect && replica_size > 0) {
+		uint8_t index = (uint8_t)hint;
+		as_node* node = as_node_load(&p->nodes[index % replica_size]);
+
+		if (node && as_node_is_active(node)) {
+			*replica_index = index;
+			return node;
+		}
+	}
+
+	as_node* node = as_partition_reg_get_node(cluster, ns, p, NULL, replica, replica_size,
+		replica_index);
+
+	if (node) {
+		// Concurrent commands on the same key may overwrite each other's hint. Any stored hint
+		// names a replica that was valid for this generation.
+		as_store_uint64((uint64_t*)&key->route_hint, expect | *replica_index);
+	}
+	return node;
+}
+
+static inline uint64_t
+as_partition_tables_handle(as_cluster* cluster, uint32_t index)
+{
+	return ((uint64_t)cluster->serial << 32) | index;
+}
+
+static as_partition_table*
+as_partition_tables_get_key(as_cluster* cluster, const as_key* key)
+{
+	as_partition_tables* tables = &cluster->partition_tables;
+	uint64_t handle = as_load_uint64((uint64_t*)&key->ns_handle);
+
+	uint32_t max = as_load_uint32_acq(&tables->size);
+
+	if ((uint32_t)(handle >> 32) == cluster->serial && (uint32_t)handle < max) {
+		// Tables are only appended, so an index resolved for this cluster remains valid.
+		return tables->tables[(uint32_t)handle];
+	}
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_partition_table* table = tables->tables[i];
+
+		if (strcmp(table->ns, key->ns) == 0) {
+			// Cache handle in key. Concurrent commands on the same key store the same value.
+			as_store_uint64((uint64_t*)&key->ns_handle, as_partition_tables_handle(cluster, i));
+			return table;
+		}
+	}
+	return NULL;
+}
+
 as_status
 as_partition_info_init(as_partition_info* pi, as_cluster* cluster, as_error* err, const as_key* key)
 {
@@ -259,7 +438,7 @@ as_partition_info_init(as_partition_info* pi, as_cluster* cluster, as_error* err
 		pi->sc_mode = table->sc_mode;
 	}
 	else {
-		as_partition_table* table = as_partition_tables_get(&cluster->partition_tables, key->ns);
+		as_partition_table* table = as_partition_tables_get_key(cluster, key);
 
 		if (! table) {
 			as_nodes* nodes = as_nodes_reserve(cluster);
@@ -282,6 +461,24 @@ as_partition_info_init(as_partition_info* pi, as_cluster* cluster, as_error* err
 	return AEROSPIKE_OK;
 }
 
+as_namespace_handle
+as_partition_tables_resolve(as_cluster* cluster, const char* ns)
+{
+	if (cluster->shm_info) {
+		return 0;
+	}
+
+	as_partition_tables* tables = &cluster->partition_tables;
+	uint32_t max = as_load_uint32_acq(&tables->size);
+
+	for (uint32_t i = 0; i < max; i++) {
+		if (strcmp(tables->tables[i]->ns, ns) == 0) {
+			return as_partition_tables_handle(cluster, i);
+		}
+	}
+	return 0;
+}
+
 as_partition_table*
 as_partition_tables_get(as_partition_tables* tables, const char* ns)
 {
@@ -297,6 +494,27 @@ as_partition_tables_get(as_partition_tables* tables, const char* ns)
 	return NULL;
 }
 
+bool
+as_partition_tables_covered(as_partition_tables* tables)
+{
+	uint32_t max = as_load_uint32_acq(&tables->size);
+
+	if (max == 0) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_partition_table* table = tables->tables[i];
+
+		for (uint32_t j = 0; j < table->size; j++) {
+			if (! as_load_ptr((void* const*)&table->partitions[j].nodes[0])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 const char*
 as_partition_tables_get_ns(as_cluster* cluster, const char* ns)
 {
@@ -315,54 +533,118 @@ static inline void
 force_replicas_refresh(as_node* node)
 {
 	node->partition_generation = (uint32_t)-1;
+	node->partition_bitmaps_reset = true;
+}
+
+static as_partition_bitmaps*
+as_partition_bitmaps_create(const char* ns, uint8_t replica_size, uint32_t bitmap_size)
+{
+	size_t len = sizeof(as_partition_bitmaps) + ((size_t)replica_size * bitmap_size);
+	as_partition_bitmaps* pb = cf_malloc(len);
+	as_strncpy(pb->ns, ns, AS_MAX_NAMESPACE_SIZE);
+	pb->regime = 0;
+	pb->replica_size = replica_size;
+	pb->valid = false;
+	return pb;
+}
+
+static as_partition_bitmaps*
+as_partition_bitmaps_get(as_node* node, const char* ns, uint8_t replica_size, uint32_t bitmap_size)
+{
+	as_vector* list = node->partition_bitmaps;
+
+	if (! list) {
+		list = as_vector_create(sizeof(as_partition_bitmaps*), 4);
+		node->partition_bitmaps = list;
+	}
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_partition_bitmaps** item = as_vector_get(list, i);
+		as_partition_bitmaps* pb = *item;
+
+		if (strcmp(pb->ns, ns) == 0) {
+			if (pb->replica_size != replica_size) {
+				// Replication factor changed. Old bitmaps can't be compared.
+				cf_free(pb);
+				pb = as_partition_bitmaps_create(ns, replica_size, bitmap_size);
+				*item = pb;
+			}
+			return pb;
+		}
+	}
+
+	as_partition_bitmaps* pb = as_partition_bitmaps_create(ns, replica_size, bitmap_size);
+	as_vector_append(list, &pb);
+	return pb;
+}
+
+static void
+as_partition_bitmaps_invalidate(as_node* node)
+{
+	as_vector* list = node->partition_bitmaps;
+
+	if (list) {
+		for (uint32_t i = 0; i < list->size; i++) {
+			as_partition_bitmaps* pb = *(as_partition_bitmaps**)as_vector_get(list, i);
+			pb->valid = false;
+		}
+	}
+}
+
+void
+as_partition_bitmaps_destroy(as_node* node)
+{
+	as_vector* list = node->partition_bitmaps;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		cf_free(*(as_partition_bitmaps**)as_vector_get(list, i));
+	}
+	as_vector_destroy(list);
+	node->partition_bitmaps = NULL;
 }
 
 static void
-decode_and_update(
-	char* bitmap_b64, uint32_t len, as_partition_table* table, as_node* node,
-	uint8_t replica_index, uint32_t regime, bool* regime_error
+update_partitions(
+	as_bitmap_iter* iter, as_partition_table* table, as_node* node, uint8_t replica_index,
+	uint32_t regime, bool* regime_error
 	)
 {
-	// Size allows for padding - is actual size rounded up to multiple of 3.
-	uint8_t* bitmap = (uint8_t*)alloca(cf_b64_decoded_buf_size(len));
+	// Each bit returned by the iterator means this node claims ownership of partition.
+	uint32_t i;
 
-	// For now - for speed - trust validity of encoded characters.
-	cf_b64_decode(bitmap_b64, len, bitmap, NULL);
+	while (as_bitmap_iter_next(iter, &i)) {
+		// as_log_debug("Set partition %s:%s:%u:%s", master? "master" : "prole", table->ns, i,
+		//				node->name);
 
-	// Expand the bitmap.
-	for (uint32_t i = 0; i < table->size; i++) {
-		if ((bitmap[i >> 3] & (0x80 >> (i & 7))) != 0) {
-			// This node claims ownership of partition.
-			// as_log_debug("Set partition %s:%s:%u:%s", master? "master" : "prole", table->ns, i,
-			//				node->name);
-
-			// Volatile reads are not necessary because the tend thread exclusively modifies
-			// partition.  Volatile writes are used so other threads can view change.
-			as_partition* p = &table->partitions[i];
-
-			if (regime >= p->regime) {
-				if (regime > p->regime) {
-					p->regime = regime;
-				}
+		// Volatile reads are not necessary because the tend thread exclusively modifies
+		// partition.  Volatile writes are used so other threads can view change.
+		as_partition* p = &table->partitions[i];
+
+		if (regime >= p->regime) {
+			if (regime > p->regime) {
+				p->regime = regime;
+			}
 
-				as_node* node_old = p->nodes[replica_index];
+			as_node* node_old = p->nodes[replica_index];
 
-				if (node != node_old) {
-					as_partition_reserve_node(node);
-					as_node_store(&p->nodes[replica_index], node);
+			if (node != node_old) {
+				as_partition_reserve_node(node);
+				as_store_uint8(&p->rack_rank[replica_index], AS_PARTITION_RACK_UNKNOWN);
+				as_node_store(&p->nodes[replica_index], node);
+				as_incr_uint32(&node->cluster->routing_gen);
+				table->racks_stale = true;
 
-					if (node_old) {
-						force_replicas_refresh(node_old);
-						as_partition_release_node_delayed(node_old);
-					}
+				if (node_old) {
+					force_replicas_refresh(node_old);
+					as_partition_release_node_delayed(node_old);
 				}
 			}
-			else {
-				if (!(*regime_error)) {
-					as_log_info("%s regime(%u) < old regime(%u)",
-								as_node_get_address_string(node), regime, p->regime);
-					*regime_error = true;
-				}
+		}
+		else {
+			if (!(*regime_error)) {
+				as_log_info("%s regime(%u) < old regime(%u)",
+							as_node_get_address_string(node), regime, p->regime);
+				*regime_error = true;
 			}
 		}
 	}
@@ -379,6 +661,16 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 	uint32_t bitmap_size = (cluster->n_partitions + 7) / 8;
 	long expected_len = (long)cf_b64_encoded_len(bitmap_size);
 
+	// Size allows for padding - is actual size rounded up to multiple of 3.
+	uint8_t* bitmap = (uint8_t*)alloca(cf_b64_decoded_buf_size((uint32_t)expected_len));
+
+	// Bitmaps from the previous update can't be trusted after another node took over one of
+	// this node's partitions, so apply all partitions claimed by this node.
+	if (node->partition_bitmaps_reset) {
+		node->partition_bitmaps_reset = false;
+		as_partition_bitmaps_invalidate(node);
+	}
+
 	char* p = buf;
 	char* ns = p;
 	char* begin = 0;
@@ -399,24 +691,12 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 			begin = ++p;
 
 			// Parse regime.
-			while (*p) {
-				if (*p == ',') {
-					*p = 0;
-					break;
-				}
-				p++;
-			}
+			p = as_info_terminate(p, ",");
 			regime = (uint32_t)strtoul(begin, NULL, 10);
 			begin = ++p;
 
 			// Parse replica count.
-			while (*p) {
-				if (*p == ',') {
-					*p = 0;
-					break;
-				}
-				p++;
-			}
+			p = as_info_terminate(p, ",");
 			
 			int replication_factor = atoi(begin);
 
@@ -428,18 +708,19 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 			uint8_t replica_max = (uint8_t)replication_factor;
 			uint8_t replica_size = (replica_max <= AS_MAX_REPLICATION_FACTOR)?
 				replication_factor : AS_MAX_REPLICATION_FACTOR;
+
+			// Only apply partitions that this node newly claims when the last bitmaps from
+			// this node are complete and the regime did not change.
+			as_partition_bitmaps* pb = as_partition_bitmaps_get(node, ns, replica_size,
+				bitmap_size);
+			bool diff = pb->valid && pb->regime == regime;
+			pb->valid = false;
+			pb->regime = regime;
 			
 			// Parse partition bitmaps.
 			for (uint8_t replica_index = 0; replica_index < replica_max; replica_index++) {
 				begin = ++p;
-				
-				while (*p) {
-					if (*p == ',' || *p == ';') {
-						*p = 0;
-						break;
-					}
-					p++;
-				}
+				p = as_info_terminate(p, ",;");
 				int64_t len = p - begin;
 				
 				if (expected_len != len) {
@@ -451,8 +732,21 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 				
 				// Only handle AS_MAX_REPLICATION_FACTOR levels. Do not process other proles.
 				if (replica_index < AS_MAX_REPLICATION_FACTOR) {
+					// For now - for speed - trust validity of encoded characters.
+					as_bitmap_b64_decode(begin, (uint32_t)len, bitmap);
+
+					uint8_t* prev = pb->bitmaps + (replica_index * bitmap_size);
+					as_bitmap_iter iter;
+
+					if (diff) {
+						as_bitmap_iter_init_diff(&iter, bitmap, prev, cluster->n_partitions);
+					}
+					else {
+						as_bitmap_iter_init(&iter, bitmap, cluster->n_partitions);
+					}
+
 					if (cluster->shm_info) {
-						as_shm_update_partitions(cluster->shm_info, ns, begin, len, node,
+						as_shm_update_partitions(cluster->shm_info, ns, &iter, node,
 							replica_size, replica_index, regime);
 					}
 					else {
@@ -468,13 +762,16 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 
 							table = as_partition_table_create(ns, cluster->n_partitions,
 								replica_size, regime != 0);
+
+							// New table has no owners yet.
+							as_bitmap_iter_init(&iter, bitmap, cluster->n_partitions);
 						}
 						else {
 							table->replica_size = replica_size;
 						}
 						
-						// Decode partition bitmap and update client's view.
-						decode_and_update(begin, (uint32_t)len, table, node, replica_index, regime,
+						// Update client's view.
+						update_partitions(&iter, table, node, replica_index, regime,
 							&regime_error);
 
 						if (create) {
@@ -482,8 +779,10 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 							as_store_uint32_rls(&tables->size, tables->size + 1);
 						}
 					}
+					memcpy(prev, bitmap, bitmap_size);
 				}
 			}
+			pb->valid = true;
 			ns = ++p;
 		}
 		else {
@@ -493,6 +792,110 @@ as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf)
 	return true;
 }
 
+bool
+as_partition_tables_restore(
+	as_cluster* cluster, const char* ns, uint8_t replica_size, bool sc_mode, as_node** nodes,
+	const uint32_t* regimes
+	)
+{
+	as_partition_tables* tables = &cluster->partition_tables;
+
+	if (tables->size >= AS_MAX_NAMESPACES || as_partition_tables_get(tables, ns)) {
+		return false;
+	}
+
+	as_partition_table* table = as_partition_table_create(ns, cluster->n_partitions,
+		replica_size, sc_mode);
+
+	for (uint32_t i = 0; i < table->size; i++) {
+		as_partition* p = &table->partitions[i];
+		as_node** owners = &nodes[i * AS_MAX_REPLICATION_FACTOR];
+
+		for (uint32_t j = 0; j < AS_MAX_REPLICATION_FACTOR; j++) {
+			as_node* node = owners[j];
+
+			if (node) {
+				as_partition_reserve_node(node);
+				p->nodes[j] = node;
+			}
+		}
+		p->regime = regimes[i];
+	}
+
+	tables->tables[tables->size] = table;
+	as_store_uint32_rls(&tables->size, tables->size + 1);
+	return true;
+}
+
+typedef struct {
+	as_node* node;
+	uint8_t rank;
+} rack_rank_entry;
+
+static uint8_t
+get_rack_rank(as_vector* ranks, as_vector* rack_ids, as_node* node, const char* ns)
+{
+	for (uint32_t i = 0; i < ranks->size; i++) {
+		rack_rank_entry* e = as_vector_get(ranks, i);
+
+		if (e->node == node) {
+			return e->rank;
+		}
+	}
+
+	int* ids = rack_ids->list;
+	uint32_t max = rack_ids->size;
+	rack_rank_entry e = {.node = node, .rank = AS_PARTITION_RACK_NONE};
+
+	for (uint32_t i = 0; i < max; i++) {
+		if (as_node_has_rack(node, ns, ids[i])) {
+			// Ranks that do not fit are looked up on the node.
+			e.rank = (i < AS_PARTITION_RACK_NONE)? (uint8_t)i : AS_PARTITION_RACK_UNKNOWN;
+			break;
+		}
+	}
+	as_vector_append(ranks, &e);
+	return e.rank;
+}
+
+void
+as_partition_tables_update_racks(as_cluster* cluster)
+{
+	as_partition_tables* tables = &cluster->partition_tables;
+	uint32_t racks_gen = as_load_uint32(&cluster->racks_gen);
+	as_vector* rack_ids = as_rack_ids_load(&cluster->rack_ids);
+	as_vector ranks;
+	as_vector_inita(&ranks, sizeof(rack_rank_entry), 64);
+
+	for (uint32_t i = 0; i < tables->size; i++) {
+		as_partition_table* table = tables->tables[i];
+
+		if (! table->racks_stale && table->racks_gen == racks_gen) {
+			continue;
+		}
+
+		// Only the tend thread modifies partition nodes.
+		as_vector_clear(&ranks);
+
+		for (uint32_t j = 0; j < table->size; j++) {
+			as_partition* p = &table->partitions[j];
+
+			for (uint32_t k = 0; k < AS_MAX_REPLICATION_FACTOR; k++) {
+				as_node* node = p->nodes[k];
+				uint8_t rank = node ?
+					get_rack_rank(&ranks, rack_ids, node, table->ns) : AS_PARTITION_RACK_UNKNOWN;
+
+				if (p->rack_rank[k] != rank) {
+					as_store_uint8(&p->rack_rank[k], rank);
+				}
+			}
+		}
+		table->racks_stale = false;
+		table->racks_gen = racks_gen;
+	}
+	as_vector_destroy(&ranks);
+}
+
 void
 as_partition_tables_dump(as_cluster* cluster)
 {
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_partition_filter.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_PARTS_MAGIC 0x53505341 // "ASPS" in little endian.
+#define AS_PARTS_VERSION 1
+#define AS_PARTS_MAX 4096
+
+// magic(4) version(2) part_begin(2) part_count(2) flags(1) pad(1)
+#define AS_PARTS_HEADER_SIZE 12
+
+// Partition with a resume digest: flags(1) digest(20) bval(8). Otherwise flags(1).
+#define AS_PART_RESUME_SIZE (1 + AS_DIGEST_VALUE_SIZE + 8)
+
+#define AS_PARTS_FLAG_DONE 1
+#define AS_PART_FLAG_DIGEST 1
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static uint8_t*
+as_parts_read(const char* path, uint32_t* size)
+{
+	FILE* fp = fopen(path, "rb");
+
+	if (! fp) {
+		return NULL;
+	}
+
+	if (fseek(fp, 0, SEEK_END) != 0) {
+		fclose(fp);
+		return NULL;
+	}
+
+	long len = ftell(fp);
+
+	if (len < AS_PARTS_HEADER_SIZE || len > AS_PARTS_HEADER_SIZE + AS_PART_RESUME_SIZE * AS_PARTS_MAX ||
+		fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return NULL;
+	}
+
+	uint8_t* buf = cf_malloc(len);
+	size_t rv = fread(buf, 1, len, fp);
+	fclose(fp);
+
+	if (rv != (size_t)len) {
+		cf_free(buf);
+		return NULL;
+	}
+
+	*size = (uint32_t)rv;
+	return buf;
+}
+
+static bool
+as_parts_write(const char* path, const uint8_t* buf, uint32_t size)
+{
+	// Write to a temporary file and rename, so a crash never leaves a partial checkpoint.
+	size_t path_len = strlen(path);
+	char* tmp = cf_malloc(path_len + 5);
+	memcpy(tmp, path, path_len);
+	memcpy(tmp + path_len, ".tmp", 5);
+
+	FILE* fp = fopen(tmp, "wb");
+
+	if (! fp) {
+		cf_free(tmp);
+		return false;
+	}
+
+	size_t rv = fwrite(buf, 1, size, fp);
+
+	if (fclose(fp) != 0 || rv != size) {
+		remove(tmp);
+		cf_free(tmp);
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	// Windows rename() does not replace an existing file.
+	remove(path);
+#endif
+
+	bool ok = rename(tmp, path) == 0;
+
+	if (! ok) {
+		remove(tmp);
+	}
+	cf_free(tmp);
+	return ok;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+bool
+as_partitions_status_to_bytes(
+	const as_partitions_status* parts_all, uint8_t** bytes, uint32_t* bytes_size
+	)
+{
+	uint32_t size = AS_PARTS_HEADER_SIZE;
+
+	for (uint16_t i = 0; i < parts_all->part_count; i++) {
+		size += parts_all->parts[i].digest.init ? AS_PART_RESUME_SIZE : 1;
+	}
+
+	uint8_t* buf = cf_malloc(size);
+	uint8_t* p = buf;
+
+	*(uint32_t*)p = cf_swap_to_le32(AS_PARTS_MAGIC);
+	p += sizeof(uint32_t);
+	*(uint16_t*)p = cf_swap_to_le16(AS_PARTS_VERSION);
+	p += sizeof(uint16_t);
+	*(uint16_t*)p = cf_swap_to_le16(parts_all->part_begin);
+	p += sizeof(uint16_t);
+	*(uint16_t*)p = cf_swap_to_le16(parts_all->part_count);
+	p += sizeof(uint16_t);
+	*p++ = parts_all->done ? AS_PARTS_FLAG_DONE : 0;
+	*p++ = 0;
+
+	// Partition ids are implied by part_begin and position. Retry flags and replica state
+	// are not saved because all partitions are retried when a scan/query resumes.
+	for (uint16_t i = 0; i < parts_all->part_count; i++) {
+		const as_partition_status* ps = &parts_all->parts[i];
+
+		if (ps->digest.init) {
+			*p++ = AS_PART_FLAG_DIGEST;
+			memcpy(p, ps->digest.value, AS_DIGEST_VALUE_SIZE);
+			p += AS_DIGEST_VALUE_SIZE;
+			*(uint64_t*)p = cf_swap_to_le64(ps->bval);
+			p += sizeof(uint64_t);
+		}
+		else {
+			*p++ = 0;
+		}
+	}
+
+	*bytes = buf;
+	*bytes_size = size;
+	return true;
+}
+
+as_partitions_status*
+as_partitions_status_from_bytes(const uint8_t* bytes, uint32_t bytes_size)
+{
+	if (bytes_size < AS_PARTS_HEADER_SIZE) {
+		return NULL;
+	}
+
+	const uint8_t* p = bytes;
+	const uint8_t* end = bytes + bytes_size;
+
+	uint32_t magic = cf_swap_from_le32(*(uint32_t*)p);
+	p += sizeof(uint32_t);
+	uint16_t version = cf_swap_from_le16(*(uint16_t*)p);
+	p += sizeof(uint16_t);
+	uint16_t part_begin = cf_swap_from_le16(*(uint16_t*)p);
+	p += sizeof(uint16_t);
+	uint16_t part_count = cf_swap_from_le16(*(uint16_t*)p);
+	p += sizeof(uint16_t);
+	uint8_t flags = *p++;
+	p++;
+
+	if (magic != AS_PARTS_MAGIC || version != AS_PARTS_VERSION || part_count == 0 ||
+		(uint32_t)part_begin + part_count > AS_PARTS_MAX) {
+		return NULL;
+	}
+
+	as_partitions_status* parts_all = cf_malloc(sizeof(as_partitions_status) +
+		(sizeof(as_partition_status) * part_count));
+
+	parts_all->ref_count = 1;
+	parts_all->part_begin = part_begin;
+	parts_all->part_count = part_count;
+	parts_all->done = (flags & AS_PARTS_FLAG_DONE) != 0;
+	parts_all->retry = true;
+
+	for (uint16_t i = 0; i < part_count; i++) {
+		as_partition_status* ps = &parts_all->parts[i];
+		ps->part_id = part_begin + i;
+		ps->replica_index = 0;
+		ps->retry = true;
+		ps->node = NULL;
+
+		if (p >= end) {
+			cf_free(parts_all);
+			return NULL;
+		}
+
+		if (*p++ & AS_PART_FLAG_DIGEST) {
+			if (end - p < AS_DIGEST_VALUE_SIZE + (long)sizeof(uint64_t)) {
+				cf_free(parts_all);
+				return NULL;
+			}
+
+			ps->digest.init = true;
+			memcpy(ps->digest.value, p, AS_DIGEST_VALUE_SIZE);
+			p += AS_DIGEST_VALUE_SIZE;
+			ps->bval = cf_swap_from_le64(*(uint64_t*)p);
+			p += sizeof(uint64_t);
+		}
+		else {
+			ps->digest.init = false;
+			ps->bval = 0;
+		}
+	}
+
+	if (p != end) {
+		cf_free(parts_all);
+		return NULL;
+	}
+	return parts_all;
+}
+
+bool
+as_partitions_status_save(const as_partitions_status* parts_all, const char* path)
+{
+	uint8_t* bytes;
+	uint32_t size;
+
+	if (! as_partitions_status_to_bytes(parts_all, &bytes, &size)) {
+		return false;
+	}
+
+	bool ok = as_parts_write(path, bytes, size);
+	cf_free(bytes);
+	return ok;
+}
+
+as_partitions_status*
+as_partitions_status_load(const char* path)
+{
+	uint32_t size;
+	uint8_t* bytes = as_parts_read(path, &size);
+
+	if (! bytes) {
+		return NULL;
+	}
+
+	as_partitions_status* parts_all = as_partitions_status_from_bytes(bytes, size);
+	cf_free(bytes);
+	return parts_all;
+}
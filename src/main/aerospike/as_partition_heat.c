@@ -0,0 +1,109 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_partition_heat.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <citrusleaf/alloc.h>
+#include <string.h>
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_partition_heat*
+as_partition_heat_create(uint32_t size, uint32_t sample)
+{
+	size_t bytes = sizeof(as_partition_heat) + sizeof(as_partition_heat_entry) * size;
+	as_partition_heat* heat = cf_malloc(bytes);
+	memset(heat, 0, bytes);
+	heat->sample = sample ? sample : 1;
+	heat->size = size;
+	return heat;
+}
+
+void
+as_partition_heat_destroy(as_partition_heat* heat)
+{
+	cf_free(heat);
+}
+
+void
+as_partition_heat_clear(as_partition_heat* heat)
+{
+	// Increments that race with the clear may be lost. They are attributed to neither interval.
+	uint32_t* p = (uint32_t*)heat->entries;
+	uint32_t n = heat->size * (sizeof(as_partition_heat_entry) / sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < n; i++) {
+		if (as_load_uint32(&p[i])) {
+			as_store_uint32(&p[i], 0);
+		}
+	}
+}
+
+uint32_t
+as_partition_heat_merge(as_partition_heat* heat, as_partition_heat_entry* out, uint32_t size)
+{
+	uint32_t max = (heat->size < size)? heat->size : size;
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < max; i++) {
+		as_partition_heat_entry* e = &heat->entries[i];
+		uint32_t commands = as_load_uint32(&e->commands);
+
+		if (commands == 0) {
+			continue;
+		}
+
+		as_partition_heat_entry* o = &out[i];
+		o->commands += commands;
+		o->timeouts += as_load_uint32(&e->timeouts);
+		o->key_busy += as_load_uint32(&e->key_busy);
+		o->retries += as_load_uint32(&e->retries);
+		o->latency_count += as_load_uint32(&e->latency_count);
+		o->latency_sum_us += as_load_uint32(&e->latency_sum_us);
+		n++;
+	}
+	return n;
+}
+
+uint32_t
+as_partition_heat_get_ns(
+	as_cluster* cluster, const char* ns, as_partition_heat_entry* out, uint32_t size
+	)
+{
+	memset(out, 0, sizeof(as_partition_heat_entry) * size);
+
+	as_nodes* nodes = as_nodes_reserve(cluster);
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		as_node* node = nodes->array[i];
+
+		for (uint8_t j = 0; j < node->metrics_size; j++) {
+			as_ns_metrics* metrics = node->metrics[j];
+
+			if (metrics->partition_heat && strcmp(metrics->ns, ns) == 0) {
+				as_partition_heat_merge(metrics->partition_heat, out, size);
+				n++;
+				break;
+			}
+		}
+	}
+	as_nodes_release(nodes);
+	return n;
+}
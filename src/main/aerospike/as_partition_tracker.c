@@ -16,6 +16,7 @@
  */
 #include <aerospike/as_partition_tracker.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_log_macros.h>
 #include <aerospike/as_shm_cluster.h>
 #include <aerospike/as_string_builder.h>
 
@@ -70,8 +71,8 @@ parts_create(uint16_t part_begin, uint16_t part_count, const as_digest* digest)
 static as_status
 tracker_init(
 	as_partition_tracker* pt, const as_policy_base* policy, as_partitions_status** pp_resume,
-	uint64_t max_records, as_policy_replica replica, bool paginate, uint16_t part_begin,
-	uint16_t part_count, const as_digest* digest, as_error* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node, bool paginate,
+	uint16_t part_begin, uint16_t part_count, const as_digest* digest, as_error* err
 	)
 {
 	if (replica == AS_POLICY_REPLICA_RANDOM) {
@@ -79,6 +80,8 @@ tracker_init(
 			"Invalid replica: AS_POLICY_REPLICA_RANDOM");
 	}
 
+	pt->checkpoint_path = NULL;
+
 	as_partitions_status* resume = *pp_resume;
 
 	if (! resume) {
@@ -116,7 +119,10 @@ tracker_init(
 
 	pthread_mutex_init(&pt->lock, NULL);
 
+	pt->commands_per_node = (commands_per_node > 1)? commands_per_node : 1;
+	pt->node_capacity *= pt->commands_per_node;
 	as_vector_init(&pt->node_parts, sizeof(as_node_partitions), pt->node_capacity);
+	as_vector_init(&pt->np_pool, sizeof(as_node_partitions), pt->node_capacity);
 	pt->errors = NULL;
 	pt->max_records = max_records;
 	pt->record_count = 0;
@@ -129,7 +135,7 @@ tracker_init(
 	pt->max_retries = policy->max_retries;
 
 	if (pt->total_timeout > 0) {
-		pt->deadline = cf_getms() + pt->total_timeout;
+		pt->deadline = as_clock_getms() + pt->total_timeout;
 
 		if (pt->socket_timeout == 0 || pt->socket_timeout > pt->total_timeout) {
 			pt->socket_timeout = pt->total_timeout;
@@ -142,6 +148,34 @@ tracker_init(
 	return AEROSPIKE_OK;
 }
 
+static void
+init_lists(as_partition_tracker* pt, as_node_partitions* np, uint32_t capacity)
+{
+	as_vector* pool = &pt->np_pool;
+
+	if (pool->size > 0) {
+		// Reuse partition lists from a previous iteration.
+		as_node_partitions* old = as_vector_get(pool, pool->size - 1);
+		np->parts_full = old->parts_full;
+		np->parts_partial = old->parts_partial;
+		pool->size--;
+	}
+	else {
+		as_vector_init(&np->parts_full, sizeof(uint16_t), capacity);
+		as_vector_init(&np->parts_partial, sizeof(uint16_t), capacity);
+	}
+}
+
+static void
+recycle_lists(as_partition_tracker* pt, as_vector* parts_full, as_vector* parts_partial)
+{
+	as_node_partitions* np = as_vector_reserve(&pt->np_pool);
+	np->parts_full = *parts_full;
+	np->parts_partial = *parts_partial;
+	as_vector_clear(&np->parts_full);
+	as_vector_clear(&np->parts_partial);
+}
+
 static as_node_partitions*
 find_node_partitions(as_vector* list, as_node* node)
 {
@@ -168,8 +202,7 @@ assign_partition(as_partition_tracker* pt, as_partition_status* ps, as_node* nod
 		np = as_vector_reserve(&pt->node_parts);
 		as_node_reserve(node);
 		np->node = node;
-		as_vector_init(&np->parts_full, sizeof(uint16_t), pt->parts_capacity);
-		as_vector_init(&np->parts_partial, sizeof(uint16_t), pt->parts_capacity);
+		init_lists(pt, np, pt->parts_capacity);
 	}
 
 	if (ps->digest.init) {
@@ -180,6 +213,58 @@ assign_partition(as_partition_tracker* pt, as_partition_status* ps, as_node* nod
 	}
 }
 
+static void
+split_node_partitions(as_partition_tracker* pt)
+{
+	as_vector* list = &pt->node_parts;
+	uint32_t node_size = list->size;
+
+	for (uint32_t i = 0; i < node_size; i++) {
+		as_node_partitions* np = as_vector_get(list, i);
+		uint32_t n_parts = np->parts_full.size + np->parts_partial.size;
+		uint32_t n_cmds = (pt->commands_per_node < n_parts)? pt->commands_per_node : n_parts;
+
+		if (n_cmds <= 1) {
+			continue;
+		}
+
+		// Take the node's partition lists and deal them round robin to n_cmds commands.
+		// The first command reuses np. The others are appended to the list.
+		as_node* node = np->node;
+		as_vector parts_full = np->parts_full;
+		as_vector parts_partial = np->parts_partial;
+		uint32_t capacity = n_parts / n_cmds + 1;
+
+		init_lists(pt, np, capacity);
+
+		uint32_t first = list->size;
+
+		for (uint32_t j = 1; j < n_cmds; j++) {
+			as_node_partitions* sub = as_vector_reserve(list);
+			as_node_reserve(node);
+			sub->node = node;
+			init_lists(pt, sub, capacity);
+		}
+
+		// List may have been reallocated by as_vector_reserve().
+		uint32_t cmd = 0;
+
+		for (uint32_t j = 0; j < parts_full.size; j++) {
+			as_node_partitions* sub = as_vector_get(list, cmd == 0 ? i : first + cmd - 1);
+			as_vector_append(&sub->parts_full, as_vector_get(&parts_full, j));
+			cmd = (cmd + 1) % n_cmds;
+		}
+
+		for (uint32_t j = 0; j < parts_partial.size; j++) {
+			as_node_partitions* sub = as_vector_get(list, cmd == 0 ? i : first + cmd - 1);
+			as_vector_append(&sub->parts_partial, as_vector_get(&parts_partial, j));
+			cmd = (cmd + 1) % n_cmds;
+		}
+
+		recycle_lists(pt, &parts_full, &parts_partial);
+	}
+}
+
 static void
 add_error(as_partition_tracker* pt, as_node* node, as_status status, uint32_t part_id)
 {
@@ -254,6 +339,19 @@ release_node_partitions(as_vector* list)
 	}
 }
 
+static void
+recycle_node_partitions(as_partition_tracker* pt)
+{
+	as_vector* list = &pt->node_parts;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_node_partitions* np = as_vector_get(list, i);
+		as_node_release(np->node);
+		recycle_lists(pt, &np->parts_full, &np->parts_partial);
+	}
+	as_vector_clear(list);
+}
+
 //---------------------------------
 // Functions
 //---------------------------------
@@ -261,8 +359,8 @@ release_node_partitions(as_vector* list)
 as_status
 as_partition_tracker_init_nodes(
 	as_partition_tracker* pt, as_cluster* cluster, const as_policy_base* policy,
-	uint64_t max_records, as_policy_replica replica, as_partitions_status** parts_all,
-	bool paginate, uint32_t cluster_size, as_error* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node,
+	as_partitions_status** parts_all, bool paginate, uint32_t cluster_size, as_error* err
 	)
 {
 	pt->node_filter = NULL;
@@ -272,29 +370,30 @@ as_partition_tracker_init_nodes(
 	uint32_t ppn = cluster->n_partitions / cluster_size;
 	ppn += ppn >> 2;
 	pt->parts_capacity = ppn;
-	return tracker_init(pt, policy, parts_all, max_records, replica, paginate, 0,
+	return tracker_init(pt, policy, parts_all, max_records, replica, commands_per_node, paginate, 0,
 		cluster->n_partitions, NULL, err);
 }
 
 as_status
 as_partition_tracker_init_node(
 	as_partition_tracker* pt, as_cluster* cluster, const as_policy_base* policy,
-	uint64_t max_records, as_policy_replica replica, as_partitions_status** parts_all, bool paginate,
-	as_node* node, as_error* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node,
+	as_partitions_status** parts_all, bool paginate, as_node* node, as_error* err
 	)
 {
 	pt->node_filter = node;
 	pt->node_capacity = 1;
 	pt->parts_capacity = cluster->n_partitions;
-	return tracker_init(pt, policy, parts_all, max_records, replica, paginate, 0,
+	return tracker_init(pt, policy, parts_all, max_records, replica, commands_per_node, paginate, 0,
 		cluster->n_partitions, NULL, err);
 }
 
 as_status
 as_partition_tracker_init_filter(
 	as_partition_tracker* pt, as_cluster* cluster, const as_policy_base* policy,
-	uint64_t max_records, as_policy_replica replica, as_partitions_status** parts_all,
-	bool paginate, uint32_t cluster_size, as_partition_filter* pf, as_error* err
+	uint64_t max_records, as_policy_replica replica, uint32_t commands_per_node,
+	as_partitions_status** parts_all, bool paginate, uint32_t cluster_size, as_partition_filter* pf,
+	as_error* err
 	)
 {
 	if (pf->digest.init) {
@@ -318,7 +417,51 @@ as_partition_tracker_init_filter(
 	pt->node_filter = NULL;
 	pt->node_capacity = cluster_size;
 	pt->parts_capacity = pf->count;
-	return tracker_init(pt, policy, parts_all, max_records, replica, paginate, pf->begin, pf->count, &pf->digest, err);
+	return tracker_init(pt, policy, parts_all, max_records, replica, commands_per_node, paginate, pf->begin, pf->count, &pf->digest, err);
+}
+
+void
+as_partition_tracker_set_checkpoint(as_partition_tracker* pt, const char* path, uint32_t interval)
+{
+	if (! path || ! path[0]) {
+		return;
+	}
+
+	pt->checkpoint_path = cf_strdup(path);
+	pt->checkpoint_interval = interval;
+	pt->checkpoint_next = cf_getms() + interval;
+	pt->checkpoint_busy = 0;
+}
+
+void
+as_partition_tracker_checkpoint(as_partition_tracker* pt, bool force)
+{
+	if (! force && cf_getms() < as_load_uint64(&pt->checkpoint_next)) {
+		return;
+	}
+
+	// Only one thread writes the checkpoint file at a time. Others skip this interval.
+	if (as_fas_uint32(&pt->checkpoint_busy, 1) != 0) {
+		return;
+	}
+
+	as_partitions_status* parts_all = pt->parts_all;
+	size_t size = sizeof(as_partitions_status) +
+		(sizeof(as_partition_status) * parts_all->part_count);
+	as_partitions_status* copy = cf_malloc(size);
+
+	// Copy under lock, so digests updated by other threads are not torn.
+	pthread_mutex_lock(&pt->lock);
+	memcpy(copy, parts_all, size);
+	pthread_mutex_unlock(&pt->lock);
+
+	if (! as_partitions_status_save(copy, pt->checkpoint_path)) {
+		as_log_warn("Failed to write scan/query checkpoint %s", pt->checkpoint_path);
+	}
+	cf_free(copy);
+
+	as_store_uint64(&pt->checkpoint_next, cf_getms() + pt->checkpoint_interval);
+	as_store_uint32(&pt->checkpoint_busy, 0);
 }
 
 as_status
@@ -405,12 +548,17 @@ as_partition_tracker_assign(
 		}
 	}
 
-	uint32_t node_size = pt->node_parts.size;
-
-	if (node_size == 0) {
+	if (pt->node_parts.size == 0) {
 		return as_error_update(err, AEROSPIKE_ERR_INVALID_NODE, "No nodes were assigned");
 	}
 
+	if (pt->commands_per_node > 1) {
+		split_node_partitions(pt);
+	}
+
+	// Each command receives its own share of max_records.
+	uint32_t node_size = pt->node_parts.size;
+
 	// Set global retry to true because scan/query may terminate early and all partitions
 	// will need to be retried if the as_partitions_status instance is reused in a new query.
 	// Global retry will be set to false if the scan/query completes normally and max_records
@@ -458,10 +606,11 @@ as_partition_tracker_part_unavailable(
 	p->replica_index++;
 	np->parts_unavailable++;
 	add_error(pt, np->node, AEROSPIKE_ERR_CLUSTER, part_id);
+	as_cluster_hurry_tend(np->node->cluster);
 }
 
-as_status
-as_partition_tracker_is_complete(as_partition_tracker* pt, as_cluster* cluster, as_error* err)
+static as_status
+tracker_is_complete(as_partition_tracker* pt, as_cluster* cluster, as_error* err)
 {
 	as_vector* list = &pt->node_parts;
 	uint64_t record_count = 0;
@@ -589,12 +738,23 @@ as_partition_tracker_is_complete(as_partition_tracker* pt, as_cluster* cluster,
 	if (pt->max_records > 0) {
 		pt->max_records -= record_count;
 	}
-	release_node_partitions(&pt->node_parts);
-	as_vector_clear(&pt->node_parts);
+	recycle_node_partitions(pt);
 	pt->iteration++;
 	return AEROSPIKE_ERR_CLIENT;
 }
 
+as_status
+as_partition_tracker_is_complete(as_partition_tracker* pt, as_cluster* cluster, as_error* err)
+{
+	as_status status = tracker_is_complete(pt, cluster, err);
+
+	if (pt->checkpoint_path) {
+		// All node commands of this round have completed, so the status is consistent.
+		as_partition_tracker_checkpoint(pt, true);
+	}
+	return status;
+}
+
 bool
 as_partition_tracker_should_retry(
 	as_partition_tracker* pt, as_node_partitions* np, as_status status
@@ -626,8 +786,20 @@ as_partition_tracker_destroy(as_partition_tracker* pt)
 		pt->errors = NULL;
 	}
 
+	if (pt->checkpoint_path) {
+		cf_free(pt->checkpoint_path);
+		pt->checkpoint_path = NULL;
+	}
+
 	release_node_partitions(&pt->node_parts);
 	as_vector_destroy(&pt->node_parts);
+
+	for (uint32_t i = 0; i < pt->np_pool.size; i++) {
+		as_node_partitions* np = as_vector_get(&pt->np_pool, i);
+		as_vector_destroy(&np->parts_full);
+		as_vector_destroy(&np->parts_partial);
+	}
+	as_vector_destroy(&pt->np_pool);
 	as_partitions_status_release(pt->parts_all);
 	pthread_mutex_destroy(&pt->lock);
 }
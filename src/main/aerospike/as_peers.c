@@ -16,6 +16,7 @@
  */
 #include <aerospike/as_peers.h>
 #include <aerospike/as_cluster.h>
+#include <aerospike/as_info.h>
 #include <aerospike/as_log_macros.h>
 #include <aerospike/as_lookup.h>
 #include <citrusleaf/cf_byte_order.h>
@@ -104,7 +105,7 @@ as_peers_find_node(
 				// Peer name might be a hostname. Get peer IP addresses and check with node IP address.
 				as_error_reset(&err);
 				as_address_iterator iter;
-				as_status status = as_lookup_host(&iter, &err, host->name, 0);
+				as_status status = as_lookup_host_cluster(cluster, &iter, &err, host->name, 0);
 
 				if (status != AEROSPIKE_OK) {
 					as_log_error("Invalid peer received by cluster tend: %s", host->name);
@@ -171,6 +172,10 @@ as_peers_create_node(
 	as_node* node = as_node_create(cluster, node_info);
 	as_node_create_min_connections(node);
 
+	if (cluster->warm_up_conns_per_tend > 0) {
+		as_node_warm_up(node, peers->nodes.size + 1);
+	}
+
 	if (is_alias) {
 		as_node_set_hostname(node, host->name);
 	}
@@ -190,7 +195,7 @@ as_peers_validate_node(
 	as_error_init(&err);
 
 	as_address_iterator iter;
-	as_status status = as_lookup_host(&iter, &err, host->name, host->port);
+	as_status status = as_lookup_host_cluster(cluster, &iter, &err, host->name, host->port);
 	
 	if (status != AEROSPIKE_OK) {
 		as_log_warn("%s %s", as_error_string(status), err.message);
@@ -357,24 +362,20 @@ as_peers_parse_peers(as_peers* peers, as_error* err, as_cluster* cluster, as_nod
 		
 		// Parse peer node name.
 		char* node_name = p;
-		while (*p) {
-			if (*p == ',') {
-				*p++ = 0;
-				break;
-			}
-			p++;
+		p = as_info_find(p, ",");
+
+		if (*p) {
+			*p++ = 0;
 		}
 		
 		node->peers_count++;
 
 		// Parse peer TLS name
 		char* tls_name = p;
-		while (*p) {
-			if (*p == ',') {
-				*p++ = 0;
-				break;
-			}
-			p++;
+		p = as_info_find(p, ",");
+
+		if (*p) {
+			*p++ = 0;
 		}
 		
 		// Parse peer hosts
@@ -19,6 +19,10 @@
 #include <limits.h>
 #include <stdlib.h>
 
+#if !defined(_MSC_VER)
+#include <netinet/tcp.h>
+#endif
+
 #if defined(__linux__)
 #define PIPE_WRITE_BUFFER_SIZE (5 * 1024 * 1024)
 #define PIPE_READ_BUFFER_SIZE (15 * 1024 * 1024)
@@ -45,6 +49,32 @@ write_start(as_event_command* cmd)
 	conn->writer = cmd;
 }
 
+static void
+cork_connection(as_event_loop* event_loop, as_pipe_connection* conn)
+{
+#if defined(TCP_CORK) && (defined(AS_USE_LIBEV) || defined(AS_USE_LIBEVENT))
+	as_event_connection* base = &conn->base;
+
+	if (! event_loop->pipe_cork || base->cork_prev) {
+		return;
+	}
+
+	int arg = 1;
+
+	if (setsockopt(base->socket.fd, IPPROTO_TCP, TCP_CORK, &arg, sizeof(arg)) < 0) {
+		return;
+	}
+
+	base->cork_next = event_loop->pipe_corked;
+
+	if (base->cork_next) {
+		base->cork_next->cork_prev = &base->cork_next;
+	}
+	base->cork_prev = &event_loop->pipe_corked;
+	event_loop->pipe_corked = base;
+#endif
+}
+
 static void
 next_reader(as_event_command* reader)
 {
@@ -55,6 +85,12 @@ next_reader(as_event_command* reader)
 	cf_ll_delete(&conn->readers, &reader->pipe_link);
 	as_event_timer_stop(reader);
 
+	as_async_conn_pool* pool = &reader->node->pipe_conn_pools[reader->event_loop->index];
+	pool->in_flight--;
+
+	// Only the head reader can be reading a large response.
+	conn->large = false;
+
 	if (cf_ll_size(&conn->readers) == 0) {
 		if (conn->writer == NULL) {
 			// Stopping watcher also stops read.
@@ -67,7 +103,6 @@ next_reader(as_event_command* reader)
 			}
 
 			as_log_trace("Closing non-pooled pipeline connection %p", conn);
-			as_async_conn_pool* pool = &reader->node->pipe_conn_pools[reader->event_loop->index];
 			as_event_release_connection(reader->conn, pool);
 			return;
 		}
@@ -131,6 +166,7 @@ cancel_connection(as_event_command* cmd, as_error* err, int32_t source, bool ret
 	}
 
 	bool is_reader = false;
+	as_async_conn_pool* pool = &node->pipe_conn_pools[loop->index];
 
 	while (cf_ll_size(&conn->readers) > 0) {
 		cf_ll_element* link = cf_ll_get_head(&conn->readers);
@@ -142,6 +178,7 @@ cancel_connection(as_event_command* cmd, as_error* err, int32_t source, bool ret
 
 		as_log_trace("Canceling reader %p on %p", walker, conn);
 		cf_ll_delete(&conn->readers, link);
+		pool->in_flight--;
 		cancel_command(walker, err, retry, false);
 	}
 
@@ -153,7 +190,6 @@ cancel_connection(as_event_command* cmd, as_error* err, int32_t source, bool ret
 		as_log_trace("Closing canceled non-pooled pipeline connection %p", conn);
 		// For as_uv_connection_alive().
 		conn->canceled = true;
-		as_async_conn_pool* pool = &node->pipe_conn_pools[loop->index];
 		as_event_release_connection((as_event_connection*)conn, pool);
 		as_node_incr_error_rate(node);
 		as_node_release(node);
@@ -162,6 +198,7 @@ cancel_connection(as_event_command* cmd, as_error* err, int32_t source, bool ret
 
 	as_log_trace("Marking pooled pipeline connection %p as canceled", conn);
 	conn->writer = NULL;
+	conn->large = false;
 	conn->canceled = true;
 	conn->canceling = false;
 
@@ -318,8 +355,17 @@ as_pipe_get_connection(as_event_command* cmd)
 	// tends to open very few connections, which isn't good for write parallelism on the
 	// server. The server processes all commands from the same connection sequentially.
 	// More connections thus mean more parallelism.
+	uint32_t busy = 0;
+
 	if (pool->queue.total >= pool->limit) {
-		while (as_queue_pop(&pool->queue, &conn)) {
+		uint32_t max_depth = cmd->cluster->pipe_max_depth;
+
+		// Examine each pooled connection at most once, so busy connections that are
+		// pushed back are not examined again.
+		uint32_t n = as_queue_size(&pool->queue);
+
+		while (n > 0 && as_queue_pop(&pool->queue, &conn)) {
+			n--;
 			as_log_trace("Checking pipeline connection %p", conn);
 
 			if (conn->canceling) {
@@ -335,6 +381,15 @@ as_pipe_get_connection(as_event_command* cmd)
 				continue;
 			}
 
+			if (conn->large || (max_depth > 0 && cf_ll_size(&conn->readers) >= max_depth)) {
+				// Leave busy connection in pool and try the next one. Connections rotate
+				// through the pool, so commands are spread evenly over connections.
+				as_log_trace("Pipeline connection %p is busy", conn);
+				as_queue_push(&pool->queue, &conn);
+				busy++;
+				continue;
+			}
+
 			conn->in_pool = false;
 
 			// Verify that socket is active.
@@ -355,7 +410,9 @@ as_pipe_get_connection(as_event_command* cmd)
 
 			as_log_trace("Validation OK");
 			cmd->conn = (as_event_connection*)conn;
+			cork_connection(cmd->event_loop, conn);
 			write_start(cmd);
+			as_event_command_trace(cmd, AS_TRACE_CONNECTION, AEROSPIKE_OK);
 			as_event_command_write_start(cmd);
 			return;
 		}
@@ -368,13 +425,16 @@ as_pipe_get_connection(as_event_command* cmd)
 		conn = cf_malloc(sizeof(as_pipe_connection));
 		assert(conn != NULL);
 
-#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBEVENT)
+#if defined(AS_USE_LIBEV) || defined(AS_USE_LIBEVENT) || defined(AS_USE_LIBURING) || defined(AS_USE_IOCP)
 		as_socket_init(&conn->base.socket);
 #endif
 		conn->base.watching = 0;
 		conn->base.pipeline = true;
+		conn->base.cork_next = NULL;
+		conn->base.cork_prev = NULL;
 		conn->writer = NULL;
 		cf_ll_init(&conn->readers, NULL, false);
+		conn->large = false;
 		conn->canceling = false;
 		conn->canceled = false;
 		conn->in_pool = false;
@@ -394,9 +454,17 @@ as_pipe_get_connection(as_event_command* cmd)
 	}
 
 	as_error err;
-	as_error_update(&err, AEROSPIKE_ERR_NO_MORE_CONNECTIONS,
-					"Max node/event loop %s pipeline connections would be exceeded: %u",
-					cmd->node->name, pool->limit);
+
+	if (busy > 0) {
+		as_error_update(&err, AEROSPIKE_ERR_NO_MORE_CONNECTIONS,
+						"All node/event loop %s pipeline connections are busy: %u",
+						cmd->node->name, busy);
+	}
+	else {
+		as_error_update(&err, AEROSPIKE_ERR_NO_MORE_CONNECTIONS,
+						"Max node/event loop %s pipeline connections would be exceeded: %u",
+						cmd->node->name, pool->limit);
+	}
 
 	as_event_timer_stop(cmd);
 	as_event_error_callback(cmd, &err);
@@ -445,6 +513,26 @@ as_pipe_modify_fd(as_socket_fd fd)
 	return true;
 }
 
+void
+as_pipe_uncork(as_event_loop* event_loop)
+{
+	event_loop->pipe_cork = false;
+
+#if defined(TCP_CORK) && (defined(AS_USE_LIBEV) || defined(AS_USE_LIBEVENT))
+	while (event_loop->pipe_corked) {
+		as_event_connection* conn = event_loop->pipe_corked;
+		as_event_cork_unlink(conn);
+
+		// Uncorking sends any partial packet immediately.
+		int arg = 0;
+
+		if (setsockopt(conn->socket.fd, IPPROTO_TCP, TCP_CORK, &arg, sizeof(arg)) < 0) {
+			as_log_debug("Failed to uncork pipeline connection: %d", as_last_error());
+		}
+	}
+#endif
+}
+
 void
 as_pipe_socket_error(as_event_command* cmd, as_error* err, bool retry)
 {
@@ -506,7 +594,16 @@ as_pipe_read_start(as_event_command* cmd)
 
 	conn->writer = NULL;
 	cf_ll_append(&conn->readers, &cmd->pipe_link);
-	as_log_trace("Pipeline connection %p has %d reader(s)", conn, cf_ll_size(&conn->readers));
+
+	uint32_t depth = cf_ll_size(&conn->readers);
+	as_log_trace("Pipeline connection %p has %u reader(s)", conn, depth);
+
+	as_async_conn_pool* pool = &cmd->node->pipe_conn_pools[cmd->event_loop->index];
+	pool->in_flight++;
+
+	if (depth > pool->max_depth) {
+		pool->max_depth = depth;
+	}
 
 	put_connection(cmd);
 
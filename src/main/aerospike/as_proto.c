@@ -16,8 +16,8 @@
  */
 #include <aerospike/as_proto.h>
 #include <citrusleaf/cf_byte_order.h>
+#include <citrusleaf/cf_clock.h>
 #include <string.h>
-#include <zlib.h>
 
 // Byte swap proto from current machine byte order to network byte order (big endian).
 void
@@ -96,18 +96,28 @@ as_proto_parse(as_error* err, as_proto* proto)
 }
 
 as_status
-as_proto_decompress(as_error* err, uint8_t* trg, size_t trg_sz, uint8_t* src, size_t src_sz)
+as_proto_decompress(
+	as_error* err, uint8_t type, as_compress_stats* stats, uint8_t* trg, size_t trg_sz,
+	uint8_t* src, size_t src_sz
+	)
 {
-	uLongf sz = (uLongf)trg_sz;
-	int rv = uncompress(trg, &sz, src + sizeof(uint64_t), (uLong)(src_sz - sizeof(uint64_t)));
+	as_compress_codec codec = as_proto_compressed_codec(type);
+	size_t sz = trg_sz;
+	uint64_t begin = cf_getns();
+	as_status status = as_decompress_data(err, codec, src + sizeof(uint64_t),
+		src_sz - sizeof(uint64_t), trg, &sz);
 
-	if (rv != Z_OK) {
-		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Decompress failed: %d", rv);
+	if (status != AEROSPIKE_OK) {
+		return status;
+	}
+
+	if (stats) {
+		as_compress_stats_add_decompress(&stats[codec], src_sz, sz, cf_getns() - begin);
 	}
 
 	if (sz != trg_sz) {
 		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
-							   "Decompressed size %zu is not expected %zu", (size_t)sz, trg_sz);
+							   "Decompressed size %zu is not expected %zu", sz, trg_sz);
 	}
 
 	as_proto* proto = (as_proto*)trg;
@@ -18,6 +18,7 @@
 #include <aerospike/as_bin.h>
 #include <aerospike/as_cdt_internal.h>
 #include <aerospike/as_exp.h>
+#include <aerospike/as_geo_region.h>
 #include <aerospike/as_key.h>
 #include <aerospike/as_log.h>
 #include <aerospike/as_operations.h>
@@ -25,6 +26,7 @@
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <stdarg.h>
+#include <string.h>
 
 //---------------------------------
 // Init/Destroy
@@ -59,6 +61,12 @@ as_query_defaults(as_query* query, bool free, const char* ns, const char* set)
 	query->max_records = 0;
 	query->paginate = false;
 
+	query->ordered = false;
+	query->orderby_key = AS_ORDER_KEY_BIN;
+	query->orderby.bin[0] = '\0';
+	query->orderby.order = AS_ORDER_ASCENDING;
+	query->orderby_limit = 0;
+
 	return query;
 }
 
@@ -187,6 +195,40 @@ as_query_select(as_query* query, const char* bin)
 	return true;
 }
 
+//---------------------------------
+// Order By
+//---------------------------------
+
+bool
+as_query_orderby(as_query* query, const char* bin, as_order order, uint32_t limit)
+{
+	if (! bin || ! bin[0] || strlen(bin) >= AS_BIN_NAME_MAX_SIZE) {
+		return false;
+	}
+
+	strcpy(query->orderby.bin, bin);
+	query->orderby.order = order;
+	query->orderby_key = AS_ORDER_KEY_BIN;
+	query->orderby_limit = limit;
+	query->ordered = true;
+	return true;
+}
+
+bool
+as_query_orderby_meta(as_query* query, as_order_key key, as_order order, uint32_t limit)
+{
+	if (key != AS_ORDER_KEY_TTL && key != AS_ORDER_KEY_GEN) {
+		return false;
+	}
+
+	query->orderby.bin[0] = '\0';
+	query->orderby.order = order;
+	query->orderby_key = key;
+	query->orderby_limit = limit;
+	query->ordered = true;
+	return true;
+}
+
 //---------------------------------
 // Where
 //---------------------------------
@@ -293,6 +335,7 @@ as_query_where_internal(
 
 	p->exp = NULL;
 	p->exp_free = false;
+	p->region = NULL;
 
 	return as_query_where_predicate(p, type, dtype, ap);
 }
@@ -358,6 +401,7 @@ as_query_where_index_name(
 	p->ctx_size = 0;
 	p->exp = exp;
 	p->exp_free = false;
+	p->region = NULL;
 
 	return as_query_where_predicate(p, type, dtype, ap);
 }
@@ -392,6 +436,17 @@ as_query_where_with_exp(
 	return rv;
 }
 
+bool
+as_query_where_region(as_query* query, const char* bin, const as_geo_region* region)
+{
+	if (! region || ! as_query_where(query, bin, as_geo_within(region->json))) {
+		return false;
+	}
+
+	query->where.entries[query->where.size - 1].region = region;
+	return true;
+}
+
 //---------------------------------
 // Query UDF
 //---------------------------------
@@ -628,6 +683,7 @@ as_query_from_bytes(as_query* query, const uint8_t* bytes, uint32_t bytes_size)
 			pred->ctx_free = false;
 			pred->exp = NULL;
 			pred->exp_free = false;
+			pred->region = NULL;
 
 			if (! as_unpack_str_init(&pk, pred->index_name, AS_INDEX_NAME_MAX_SIZE)) {
 				goto HandleError;
@@ -808,6 +864,7 @@ as_query_from_bytes(as_query* query, const uint8_t* bytes, uint32_t bytes_size)
 	if (b) {
 		query->ops = cf_malloc(sizeof(as_operations));
 		query->ops->_free = true;
+		query->ops->arena = NULL;
 
 		if (as_unpack_uint64(&pk, &uval) != 0) {
 			goto HandleError;
@@ -0,0 +1,363 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_query_order.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_query_pager.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_string.h>
+#include <citrusleaf/alloc.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+// Numbers are ordered before strings. Bins that are missing or hold another type are
+// ordered last regardless of direction.
+static int
+as_query_order_rank(const as_val* val)
+{
+	if (! val) {
+		return 2;
+	}
+
+	switch (as_val_type(val)) {
+		case AS_INTEGER:
+		case AS_DOUBLE:
+			return 0;
+		case AS_STRING:
+			return 1;
+		default:
+			return 2;
+	}
+}
+
+static int
+as_query_order_compare_numbers(const as_val* a, const as_val* b)
+{
+	if (as_val_type(a) == AS_INTEGER && as_val_type(b) == AS_INTEGER) {
+		int64_t x = as_integer_get((as_integer*)a);
+		int64_t y = as_integer_get((as_integer*)b);
+		return (x > y) - (x < y);
+	}
+
+	double x = (as_val_type(a) == AS_INTEGER)?
+		(double)as_integer_get((as_integer*)a) : as_double_get((as_double*)a);
+	double y = (as_val_type(b) == AS_INTEGER)?
+		(double)as_integer_get((as_integer*)b) : as_double_get((as_double*)b);
+	return (x > y) - (x < y);
+}
+
+// Return negative if record a is returned before record b.
+static int
+as_query_sorter_compare(as_query_sorter* sorter, as_record* a, as_record* b)
+{
+	int rv;
+
+	switch (sorter->key) {
+		case AS_ORDER_KEY_TTL:
+			rv = (a->ttl > b->ttl) - (a->ttl < b->ttl);
+			break;
+
+		case AS_ORDER_KEY_GEN:
+			rv = (a->gen > b->gen) - (a->gen < b->gen);
+			break;
+
+		default: {
+			as_val* va = (as_val*)as_record_get(a, sorter->bin);
+			as_val* vb = (as_val*)as_record_get(b, sorter->bin);
+			int ra = as_query_order_rank(va);
+			int rb = as_query_order_rank(vb);
+
+			if (ra != rb) {
+				return ra - rb;
+			}
+
+			if (ra == 0) {
+				rv = as_query_order_compare_numbers(va, vb);
+			}
+			else if (ra == 1) {
+				rv = strcmp(as_string_get((as_string*)va), as_string_get((as_string*)vb));
+			}
+			else {
+				return 0;
+			}
+			break;
+		}
+	}
+	return sorter->descending ? -rv : rv;
+}
+
+// Heap root is the record returned last.
+static void
+as_query_sorter_sift_down(as_query_sorter* sorter, as_record** recs, uint32_t size, uint32_t i)
+{
+	while (true) {
+		uint32_t max = i;
+		uint32_t left = i * 2 + 1;
+		uint32_t right = left + 1;
+
+		if (left < size && as_query_sorter_compare(sorter, recs[left], recs[max]) > 0) {
+			max = left;
+		}
+
+		if (right < size && as_query_sorter_compare(sorter, recs[right], recs[max]) > 0) {
+			max = right;
+		}
+
+		if (max == i) {
+			return;
+		}
+
+		as_record* tmp = recs[i];
+		recs[i] = recs[max];
+		recs[max] = tmp;
+		i = max;
+	}
+}
+
+static void
+as_query_sorter_sift_up(as_query_sorter* sorter, as_record** recs, uint32_t i)
+{
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+
+		if (as_query_sorter_compare(sorter, recs[i], recs[parent]) <= 0) {
+			return;
+		}
+
+		as_record* tmp = recs[i];
+		recs[i] = recs[parent];
+		recs[parent] = tmp;
+		i = parent;
+	}
+}
+
+static void
+as_query_sorter_add(as_query_sorter* sorter, as_record* src)
+{
+	pthread_mutex_lock(&sorter->lock);
+
+	as_record** recs = (as_record**)sorter->records.list;
+	uint32_t size = sorter->records.size;
+
+	if (sorter->limit == 0) {
+		// Unbounded. The heap is built when the query completes.
+		as_record* rec = as_query_pager_move_record(src);
+		as_vector_append(&sorter->records, &rec);
+	}
+	else if (size < sorter->limit) {
+		as_record* rec = as_query_pager_move_record(src);
+		as_vector_append(&sorter->records, &rec);
+		recs = (as_record**)sorter->records.list;
+		as_query_sorter_sift_up(sorter, recs, size);
+	}
+	else if (as_query_sorter_compare(sorter, src, recs[0]) < 0) {
+		// Replace the last record in sort order.
+		as_record_destroy(recs[0]);
+		recs[0] = as_query_pager_move_record(src);
+		as_query_sorter_sift_down(sorter, recs, size, 0);
+	}
+
+	pthread_mutex_unlock(&sorter->lock);
+}
+
+static void
+as_query_sorter_sort(as_query_sorter* sorter)
+{
+	as_record** recs = (as_record**)sorter->records.list;
+	uint32_t size = sorter->records.size;
+
+	if (sorter->limit == 0) {
+		for (uint32_t i = size / 2; i > 0; i--) {
+			as_query_sorter_sift_down(sorter, recs, size, i - 1);
+		}
+	}
+
+	for (uint32_t end = size; end > 1; end--) {
+		as_record* tmp = recs[0];
+		recs[0] = recs[end - 1];
+		recs[end - 1] = tmp;
+		as_query_sorter_sift_down(sorter, recs, end - 1, 0);
+	}
+}
+
+static void
+as_query_sorter_clear(as_query_sorter* sorter)
+{
+	for (uint32_t i = 0; i < sorter->records.size; i++) {
+		as_record* rec = as_vector_get_ptr(&sorter->records, i);
+		as_record_destroy(rec);
+	}
+	sorter->records.size = 0;
+}
+
+static void
+as_query_sorter_init_common(
+	as_query_sorter* sorter, const as_query* query, aerospike_query_foreach_callback callback,
+	as_async_query_record_listener listener, void* udata, bool free
+	)
+{
+	pthread_mutex_init(&sorter->lock, NULL);
+
+	uint32_t capacity = query->orderby_limit;
+
+	if (capacity == 0 || capacity > 1024) {
+		capacity = 1024;
+	}
+	as_vector_init(&sorter->records, sizeof(as_record*), capacity);
+	sorter->callback = callback;
+	sorter->listener = listener;
+	sorter->udata = udata;
+	strcpy(sorter->bin, query->orderby.bin);
+	sorter->key = query->orderby_key;
+	sorter->limit = query->orderby_limit;
+	sorter->descending = query->orderby.order == AS_ORDER_DESCENDING;
+	sorter->complete = false;
+	sorter->free = free;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+as_query_order_validate(as_error* err, const as_query* query)
+{
+	if (query->apply.function[0] || query->ops) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Aggregation or background queries cannot be ordered");
+	}
+
+	if (query->paginate) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Paginated queries cannot be ordered");
+	}
+	return AEROSPIKE_OK;
+}
+
+void
+as_query_sorter_init(
+	as_query_sorter* sorter, const as_query* query, aerospike_query_foreach_callback callback,
+	void* udata
+	)
+{
+	as_query_sorter_init_common(sorter, query, callback, NULL, udata, false);
+}
+
+as_query_sorter*
+as_query_sorter_create(
+	const as_query* query, as_async_query_record_listener listener, void* udata
+	)
+{
+	as_query_sorter* sorter = cf_malloc(sizeof(as_query_sorter));
+	as_query_sorter_init_common(sorter, query, NULL, listener, udata, true);
+	return sorter;
+}
+
+void
+as_query_sorter_complete(as_query_sorter* sorter, as_status status)
+{
+	if (status == AEROSPIKE_OK) {
+		as_query_sorter_sort(sorter);
+
+		for (uint32_t i = 0; i < sorter->records.size; i++) {
+			as_record* rec = as_vector_get_ptr(&sorter->records, i);
+
+			if (! sorter->callback((as_val*)rec, sorter->udata)) {
+				break;
+			}
+		}
+		as_query_sorter_clear(sorter);
+		sorter->complete = true;
+	}
+
+	if (sorter->complete) {
+		sorter->callback(NULL, sorter->udata);
+	}
+}
+
+void
+as_query_sorter_destroy(as_query_sorter* sorter)
+{
+	as_query_sorter_clear(sorter);
+	as_vector_destroy(&sorter->records);
+	pthread_mutex_destroy(&sorter->lock);
+
+	if (sorter->free) {
+		cf_free(sorter);
+	}
+}
+
+bool
+as_query_sorter_callback(const as_val* val, void* udata)
+{
+	as_query_sorter* sorter = udata;
+
+	if (! val) {
+		sorter->complete = true;
+		return true;
+	}
+
+	as_record* rec = as_record_fromval(val);
+
+	if (rec) {
+		as_query_sorter_add(sorter, rec);
+	}
+	return true;
+}
+
+bool
+as_query_sorter_listener(
+	as_error* err, as_record* record, void* udata, as_event_loop* event_loop
+	)
+{
+	as_query_sorter* sorter = udata;
+
+	if (err) {
+		sorter->listener(err, NULL, sorter->udata, event_loop);
+		as_query_sorter_destroy(sorter);
+		return false;
+	}
+
+	if (record) {
+		as_query_sorter_add(sorter, record);
+		return true;
+	}
+
+	// Query complete.
+	as_query_sorter_sort(sorter);
+
+	bool notify = true;
+
+	for (uint32_t i = 0; i < sorter->records.size; i++) {
+		as_record* rec = as_vector_get_ptr(&sorter->records, i);
+
+		if (! sorter->listener(NULL, rec, sorter->udata, event_loop)) {
+			// Do not notify completion after the user aborted.
+			notify = false;
+			break;
+		}
+	}
+
+	if (notify) {
+		sorter->listener(NULL, NULL, sorter->udata, event_loop);
+	}
+	as_query_sorter_destroy(sorter);
+	return true;
+}
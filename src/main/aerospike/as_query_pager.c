@@ -0,0 +1,373 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_query_pager.h>
+#include <aerospike/aerospike_query.h>
+#include <aerospike/as_boolean.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_geojson.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_string.h>
+#include <citrusleaf/alloc.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+// Take ownership of a string buffer. Copy the buffer if the string does not own it.
+static char*
+as_query_pager_take_string(char* value, size_t len, bool* free)
+{
+	if (*free) {
+		*free = false;
+		return value;
+	}
+
+	char* copy = cf_malloc(len + 1);
+	memcpy(copy, value, len);
+	copy[len] = 0;
+	return copy;
+}
+
+static uint8_t*
+as_query_pager_take_bytes(uint8_t* value, uint32_t size, bool* free)
+{
+	if (*free) {
+		*free = false;
+		return value;
+	}
+
+	uint8_t* copy = cf_malloc(size);
+	memcpy(copy, value, size);
+	return copy;
+}
+
+// Move a value stored inline in a stack record to the heap.
+static as_val*
+as_query_pager_move_value(as_val* v)
+{
+	switch (as_val_type(v)) {
+		case AS_BOOLEAN:
+			return (as_val*)as_boolean_new(as_boolean_get((as_boolean*)v));
+
+		case AS_INTEGER:
+			return (as_val*)as_integer_new(as_integer_get((as_integer*)v));
+
+		case AS_DOUBLE:
+			return (as_val*)as_double_new(as_double_get((as_double*)v));
+
+		case AS_STRING: {
+			as_string* s = (as_string*)v;
+			size_t len = as_string_len(s);
+			char* value = as_query_pager_take_string(s->value, len, &s->free);
+			return (as_val*)as_string_new_wlen(value, len, true);
+		}
+
+		case AS_GEOJSON: {
+			as_geojson* g = (as_geojson*)v;
+			size_t len = as_geojson_len(g);
+			char* value = as_query_pager_take_string(g->value, len, &g->free);
+			return (as_val*)as_geojson_new_wlen(value, len, true);
+		}
+
+		case AS_BYTES: {
+			as_bytes* b = (as_bytes*)v;
+			uint8_t* value = as_query_pager_take_bytes(b->value, b->size, &b->free);
+			as_bytes* copy = as_bytes_new_wrap(value, b->size, true);
+			copy->type = b->type;
+			return (as_val*)copy;
+		}
+
+		default:
+			return as_val_reserve(v);
+	}
+}
+
+static void
+as_query_pager_move_key(as_key* src, as_key* trg)
+{
+	strcpy(trg->ns, src->ns);
+	strcpy(trg->set, src->set);
+	trg->digest = src->digest;
+	trg->valuep = NULL;
+
+	if (! src->valuep) {
+		return;
+	}
+
+	as_val* v = (as_val*)src->valuep;
+
+	switch (as_val_type(v)) {
+		case AS_INTEGER:
+			as_integer_init(&trg->value.integer, as_integer_get((as_integer*)v));
+			trg->valuep = &trg->value;
+			break;
+
+		case AS_STRING: {
+			as_string* s = (as_string*)v;
+			size_t len = as_string_len(s);
+			char* value = as_query_pager_take_string(s->value, len, &s->free);
+			as_string_init_wlen(&trg->value.string, value, len, true);
+			trg->valuep = &trg->value;
+			break;
+		}
+
+		case AS_BYTES: {
+			as_bytes* b = (as_bytes*)v;
+			uint8_t* value = as_query_pager_take_bytes(b->value, b->size, &b->free);
+			as_bytes_init_wrap(&trg->value.bytes, value, b->size, true);
+			trg->value.bytes.type = b->type;
+			trg->valuep = &trg->value;
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+// Query callback records are stack records that are destroyed when the callback returns.
+// Move their contents to a heap record that can be buffered.
+as_record*
+as_query_pager_move_record(as_record* src)
+{
+	as_record* rec = as_record_new(src->bins.size);
+	rec->gen = src->gen;
+	rec->ttl = src->ttl;
+	as_query_pager_move_key(&src->key, &rec->key);
+
+	for (uint16_t i = 0; i < src->bins.size; i++) {
+		as_bin* bin = &src->bins.entries[i];
+
+		if (! bin->valuep) {
+			continue;
+		}
+
+		as_val* v = (as_val*)bin->valuep;
+		v = (bin->valuep == &bin->value)? as_query_pager_move_value(v) : as_val_reserve(v);
+		as_record_set(rec, bin->name, (as_bin_value*)v);
+	}
+	return rec;
+}
+
+static bool
+as_query_pager_callback(const as_val* val, void* udata)
+{
+	if (! val) {
+		// Page complete.
+		return true;
+	}
+
+	as_query_pager* pager = udata;
+	as_record* rec = as_record_fromval(val);
+
+	if (! rec) {
+		return true;
+	}
+
+	rec = as_query_pager_move_record(rec);
+
+	// Node commands call back from multiple threads.
+	pthread_mutex_lock(&pager->lock);
+
+	if (pager->closed) {
+		pthread_mutex_unlock(&pager->lock);
+		as_record_destroy(rec);
+		return false;
+	}
+
+	as_vector_append(&pager->fill->records, &rec);
+	pthread_mutex_unlock(&pager->lock);
+	return true;
+}
+
+static void*
+as_query_pager_run(void* udata)
+{
+	as_query_pager* pager = udata;
+
+	pthread_mutex_lock(&pager->lock);
+
+	while (! pager->closed) {
+		while (pager->n_pages >= pager->depth && ! pager->closed) {
+			pthread_cond_wait(&pager->cond, &pager->lock);
+		}
+
+		if (pager->closed) {
+			break;
+		}
+
+		as_query_page* page = cf_malloc(sizeof(as_query_page));
+		page->next = NULL;
+		as_vector_init(&page->records, sizeof(as_record*), 64);
+		pager->fill = page;
+		pthread_mutex_unlock(&pager->lock);
+
+		as_error err;
+		as_status status = aerospike_query_partitions(pager->as, &err, pager->policy,
+			pager->query, pager->pf, as_query_pager_callback, pager);
+
+		pthread_mutex_lock(&pager->lock);
+		pager->fill = NULL;
+
+		if (status != AEROSPIKE_OK) {
+			as_query_page_destroy(page);
+
+			if (! pager->closed) {
+				as_error_copy(&pager->err, &err);
+				pager->status = status;
+			}
+			break;
+		}
+
+		if (page->records.size > 0) {
+			if (pager->tail) {
+				pager->tail->next = page;
+			}
+			else {
+				pager->head = page;
+			}
+			pager->tail = page;
+			pager->n_pages++;
+			pthread_cond_broadcast(&pager->cond);
+		}
+		else {
+			as_query_page_destroy(page);
+		}
+
+		if (as_query_is_done(pager->query)) {
+			break;
+		}
+	}
+
+	pager->done = true;
+	pthread_cond_broadcast(&pager->cond);
+	pthread_mutex_unlock(&pager->lock);
+	return NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+as_query_pager_init(
+	as_query_pager* pager, aerospike* as, as_error* err, const as_policy_query* policy,
+	as_query* query, as_partition_filter* pf, uint32_t depth
+	)
+{
+	as_error_reset(err);
+
+	if (query->max_records == 0 || ! query->paginate) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+			"Query prefetch requires max_records and paginate");
+	}
+
+	if (depth == 0) {
+		return as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Query prefetch depth must be >= 1");
+	}
+
+	memset(pager, 0, sizeof(as_query_pager));
+	pthread_mutex_init(&pager->lock, NULL);
+	pthread_cond_init(&pager->cond, NULL);
+	pager->as = as;
+	pager->policy = policy;
+	pager->query = query;
+	pager->pf = pf;
+	pager->depth = depth;
+	pager->status = AEROSPIKE_OK;
+	as_error_init(&pager->err);
+
+	if (pthread_create(&pager->thread, NULL, as_query_pager_run, pager) != 0) {
+		pthread_cond_destroy(&pager->cond);
+		pthread_mutex_destroy(&pager->lock);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to create query prefetch thread");
+	}
+	return AEROSPIKE_OK;
+}
+
+as_status
+as_query_pager_next(as_query_pager* pager, as_error* err, as_query_page** page)
+{
+	as_error_reset(err);
+	pthread_mutex_lock(&pager->lock);
+
+	while (! pager->head && ! pager->done) {
+		pthread_cond_wait(&pager->cond, &pager->lock);
+	}
+
+	as_query_page* head = pager->head;
+
+	if (head) {
+		pager->head = head->next;
+
+		if (! pager->head) {
+			pager->tail = NULL;
+		}
+		pager->n_pages--;
+		head->next = NULL;
+
+		// Wake background thread if it was waiting for room.
+		pthread_cond_broadcast(&pager->cond);
+		pthread_mutex_unlock(&pager->lock);
+		*page = head;
+		return AEROSPIKE_OK;
+	}
+
+	as_status status = pager->status;
+
+	if (status != AEROSPIKE_OK) {
+		as_error_copy(err, &pager->err);
+	}
+	pthread_mutex_unlock(&pager->lock);
+	*page = NULL;
+	return status;
+}
+
+void
+as_query_pager_destroy(as_query_pager* pager)
+{
+	pthread_mutex_lock(&pager->lock);
+	pager->closed = true;
+	pthread_cond_broadcast(&pager->cond);
+	pthread_mutex_unlock(&pager->lock);
+	pthread_join(pager->thread, NULL);
+
+	as_query_page* page = pager->head;
+
+	while (page) {
+		as_query_page* next = page->next;
+		as_query_page_destroy(page);
+		page = next;
+	}
+	pager->head = NULL;
+	pager->tail = NULL;
+	pthread_cond_destroy(&pager->cond);
+	pthread_mutex_destroy(&pager->lock);
+}
+
+void
+as_query_page_destroy(as_query_page* page)
+{
+	for (uint32_t i = 0; i < page->records.size; i++) {
+		as_record* rec = as_vector_get_ptr(&page->records, i);
+		as_record_destroy(rec);
+	}
+	as_vector_destroy(&page->records);
+	cf_free(page);
+}
@@ -16,6 +16,8 @@
  */
 #include <aerospike/as_query_validate.h>
 #include <aerospike/as_async.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_cluster.h>
 #include <aerospike/as_event.h>
 #include <aerospike/as_event_internal.h>
 #include <aerospike/as_info.h>
@@ -69,78 +71,71 @@ as_parse_cluster_key(char* response, uint64_t* cluster_key)
 	return true;
 }
 
-static void
-as_validate_begin_listener(as_error* err, char* response, void* udata, as_event_loop* event_loop)
+// Use cluster key from the node's last tend when the tend ran within one tend interval.
+// Start tending cluster keys when they are first requested.
+static bool
+as_tended_cluster_key(as_node* node, uint64_t* cluster_key)
 {
-	as_event_command* cmd = udata;
-	as_event_executor* executor = cmd->udata;
+	as_cluster* cluster = node->cluster;
 
-	if (err) {
-		as_event_command_destroy(cmd);
-		as_event_executor_error(executor, err, executor->max);
-		return;
+	if (! as_load_uint8((uint8_t*)&cluster->tend_cluster_key)) {
+		as_store_uint8((uint8_t*)&cluster->tend_cluster_key, 1);
+		return false;
 	}
 
-	as_error e;
+	uint64_t tend_ms = as_load_uint64_acq(&node->cluster_key_ms);
+	uint64_t key = as_load_uint64(&node->cluster_key);
 
-	if (! as_parse_cluster_key(response, &executor->cluster_key)) {
-		as_parse_error(&e, response);
-		as_event_command_destroy(cmd);
-		as_event_executor_error(executor, &e, executor->max);
-		return;
+	if (key == 0 || tend_ms == 0 || cf_getms() - tend_ms > cluster->tend_interval) {
+		return false;
 	}
+	*cluster_key = key;
+	return true;
+}
 
+// Start query commands without checking the cluster key on each node. Each node is checked
+// once when its command completes.
+static void
+as_validate_start_async(as_event_executor* executor)
+{
 	uint32_t max_concurrent = executor->max_concurrent;
-	as_status status = as_event_command_execute(cmd, &e);
 
-	if (status != AEROSPIKE_OK) {
-		// Command already destroyed.
-		as_event_executor_error(executor, &e, executor->max);
-		return;
-	}
+	for (uint32_t i = 0; i < max_concurrent; i++) {
+		as_error err;
+		as_event_command* cmd = executor->commands[i];
 
-	for (uint32_t i = 1; i < max_concurrent; i++) {
-		if (as_query_validate_next_async(executor, i) != AEROSPIKE_OK) {
+		if (i > 0) {
+			executor->queued++;
+		}
+
+		if (as_event_command_execute(cmd, &err) != AEROSPIKE_OK) {
+			// Command already destroyed.
+			as_event_executor_error(executor, &err, executor->max - i);
 			return;
 		}
 	}
 }
 
 static void
-as_validate_next_listener(as_error* err, char* response, void* udata, as_event_loop* event_loop)
+as_validate_begin_listener(as_error* err, char* response, void* udata, as_event_loop* event_loop)
 {
 	as_event_command* cmd = udata;
 	as_event_executor* executor = cmd->udata;
 
 	if (err) {
 		as_event_command_destroy(cmd);
-		as_event_executor_error(executor, err, 1);
+		as_event_executor_error(executor, err, executor->max);
 		return;
 	}
 
-	as_error e;
-	uint64_t cluster_key;
-
-	if (! as_parse_cluster_key(response, &cluster_key)) {
+	if (! as_parse_cluster_key(response, &executor->cluster_key)) {
+		as_error e;
 		as_parse_error(&e, response);
 		as_event_command_destroy(cmd);
-		as_event_executor_error(executor, &e, 1);
-		return;
-	}
-
-	if (executor->cluster_key != cluster_key) {
-		as_cluster_key_error(&e, executor->cluster_key, cluster_key);
-		as_event_command_destroy(cmd);
-		as_event_executor_error(executor, &e, 1);
+		as_event_executor_error(executor, &e, executor->max);
 		return;
 	}
-
-	as_status status = as_event_command_execute(cmd, &e);
-
-	if (status != AEROSPIKE_OK) {
-		// Command already destroyed.
-		as_event_executor_error(executor, &e, 1);
-	}
+	as_validate_start_async(executor);
 }
 
 static void
@@ -181,6 +176,10 @@ as_query_validate_begin(
 	as_error* err, as_node* node, const char* ns, uint32_t timeout, uint64_t* cluster_key
 	)
 {
+	if (as_tended_cluster_key(node, cluster_key)) {
+		return AEROSPIKE_OK;
+	}
+
 	char cmd[256];
 	as_write_cluster_stable(cmd, sizeof(cmd), ns);
 
@@ -235,51 +234,40 @@ as_query_validate_begin_async(as_event_executor* executor, const char* ns, as_er
 	executor->ns = cf_strdup(ns);
 	executor->queued++;
 
-	char info_cmd[256];
-	as_write_cluster_stable(info_cmd, sizeof(info_cmd), ns);
-
 	as_event_command* cmd = executor->commands[0];
 
-	// Reserve node again because the node will be released at end of async info processing.
-	// Node must be available for query.
-	as_node_reserve(cmd->node);
+	if (as_tended_cluster_key(cmd->node, &executor->cluster_key)) {
+		// Run query commands as if validation was not requested.
+		uint32_t max = executor->max_concurrent;
 
-	as_status status = as_info_command_node_async(NULL, err, &policy, cmd->node, info_cmd,
-												  as_validate_begin_listener, cmd, cmd->event_loop);
+		for (uint32_t i = 0; i < max; i++) {
+			if (i > 0) {
+				executor->queued++;
+			}
 
-	if (status != AEROSPIKE_OK) {
-		as_event_command_destroy(cmd);
-		as_event_executor_cancel(executor, 0);
-	}
-	return status;
-}
-
-as_status
-as_query_validate_next_async(as_event_executor* executor, uint32_t index)
-{
-	as_error err;
-	as_policy_info policy;
-	as_policy_info_init(&policy);
-	policy.timeout = as_query_get_info_timeout(executor);
+			as_status status = as_event_command_execute(executor->commands[i], err);
 
-	executor->queued++;
+			if (status != AEROSPIKE_OK) {
+				as_event_executor_cancel(executor, i);
+				return status;
+			}
+		}
+		return AEROSPIKE_OK;
+	}
 
 	char info_cmd[256];
-	as_write_cluster_stable(info_cmd, sizeof(info_cmd), executor->ns);
-
-	as_event_command* cmd = executor->commands[index];
+	as_write_cluster_stable(info_cmd, sizeof(info_cmd), ns);
 
 	// Reserve node again because the node will be released at end of async info processing.
 	// Node must be available for query.
 	as_node_reserve(cmd->node);
 
-	as_status status = as_info_command_node_async(NULL, &err, &policy, cmd->node, info_cmd,
-									  as_validate_next_listener, cmd, cmd->event_loop);
+	as_status status = as_info_command_node_async(NULL, err, &policy, cmd->node, info_cmd,
+												  as_validate_begin_listener, cmd, cmd->event_loop);
 
 	if (status != AEROSPIKE_OK) {
 		as_event_command_destroy(cmd);
-		as_event_executor_error(executor, &err, executor->max - index);
-		return status;
+		as_event_executor_cancel(executor, 0);
 	}
 	return status;
 }
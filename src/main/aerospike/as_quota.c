@@ -0,0 +1,275 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_quota.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_config.h>
+#include <aerospike/as_sleep.h>
+#include <aerospike/as_string.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <pthread.h>
+#include <string.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Number of quotas a thread caches tokens for. Quotas are mapped by index.
+#define AS_QUOTA_CACHE_SIZE 8
+
+// Cached tokens cover at most this much of the quota rate and expire after the same time,
+// so a thread can not save tokens for a later burst.
+#define AS_QUOTA_BATCH_NS 1000000
+
+#define AS_QUOTA_BATCH_MAX 16
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	uint64_t expire_ns;
+	uint32_t quotas_id;
+	uint32_t index;
+	uint32_t tokens;
+} as_quota_tokens;
+
+typedef struct {
+	as_quota_tokens entries[AS_QUOTA_CACHE_SIZE];
+} as_quota_cache;
+
+//---------------------------------
+// Static Variables
+//---------------------------------
+
+static pthread_once_t as_quota_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t as_quota_cache_key;
+static uint32_t as_quotas_id = 0;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_quota_cache_destroy(void* data)
+{
+	cf_free(data);
+}
+
+static void
+as_quota_cache_init_key(void)
+{
+	pthread_key_create(&as_quota_cache_key, as_quota_cache_destroy);
+}
+
+static inline as_quota_tokens*
+as_quota_tokens_get(uint32_t index)
+{
+	as_quota_cache* cache = pthread_getspecific(as_quota_cache_key);
+
+	if (! cache) {
+		cache = cf_calloc(1, sizeof(as_quota_cache));
+		pthread_setspecific(as_quota_cache_key, cache);
+	}
+	return &cache->entries[index % AS_QUOTA_CACHE_SIZE];
+}
+
+static as_quota*
+as_quotas_find(as_quotas* quotas, const char* ns, const char* set, as_quota_type type)
+{
+	as_quota* ns_quota = NULL;
+
+	for (uint32_t i = 0; i < quotas->size; i++) {
+		as_quota* quota = &quotas->array[i];
+
+		if (quota->type != type || strcmp(quota->ns, ns) != 0) {
+			continue;
+		}
+
+		if (! quota->set[0]) {
+			ns_quota = quota;
+		}
+		else if (set && strcmp(quota->set, set) == 0) {
+			return quota;
+		}
+	}
+	return ns_quota;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_quotas*
+as_quotas_create(as_vector* list)
+{
+	if (! list || list->size == 0) {
+		return NULL;
+	}
+
+	pthread_once(&as_quota_cache_once, as_quota_cache_init_key);
+
+	as_quotas* quotas = cf_malloc(sizeof(as_quotas) + sizeof(as_quota) * list->size);
+
+	// Thread caches identify quotas by table id, so tokens of a replaced table are never used.
+	// Id zero is never assigned because it matches empty cache entries.
+	quotas->id = as_faa_uint32(&as_quotas_id, 1) + 1;
+	quotas->size = list->size;
+
+	for (uint32_t i = 0; i < list->size; i++) {
+		as_config_quota* src = as_vector_get(list, i);
+		as_quota* quota = &quotas->array[i];
+
+		as_strncpy(quota->ns, src->ns, sizeof(quota->ns));
+		as_strncpy(quota->set, src->set ? src->set : "", sizeof(quota->set));
+		quota->type = src->type;
+		quota->mode = src->mode;
+		quota->rate = (src->rate > 0)? src->rate : 1;
+		quota->burst = (src->burst > 0)? src->burst : quota->rate;
+		quota->interval_ns = 1000000000ULL / quota->rate;
+
+		// Batch only when the bucket is deep enough for a thread to take a batch while other
+		// threads still find tokens.
+		uint64_t batch = (uint64_t)quota->rate * AS_QUOTA_BATCH_NS / 1000000000ULL;
+
+		if (batch > AS_QUOTA_BATCH_MAX) {
+			batch = AS_QUOTA_BATCH_MAX;
+		}
+
+		if (batch > quota->burst / 2) {
+			batch = quota->burst / 2;
+		}
+		quota->batch = (batch > 1)? (uint32_t)batch : 1;
+		quota->next_ns = 0;
+		quota->rejects = 0;
+	}
+	return quotas;
+}
+
+bool
+as_quotas_equal(as_quotas* quotas, as_vector* list)
+{
+	uint32_t size = list ? list->size : 0;
+
+	if (! quotas) {
+		return size == 0;
+	}
+
+	if (quotas->size != size) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < size; i++) {
+		as_config_quota* src = as_vector_get(list, i);
+		as_quota* quota = &quotas->array[i];
+
+		if (strcmp(quota->ns, src->ns) != 0 ||
+			strcmp(quota->set, src->set ? src->set : "") != 0 ||
+			quota->type != src->type || quota->mode != src->mode ||
+			quota->rate != ((src->rate > 0)? src->rate : 1) ||
+			quota->burst != ((src->burst > 0)? src->burst : quota->rate)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+as_status
+as_quotas_acquire(
+	as_quotas* quotas, as_error* err, const char* ns, const char* set, as_quota_type type,
+	uint32_t max_wait_ms, uint32_t* delay_ms
+	)
+{
+	*delay_ms = 0;
+
+	as_quota* quota = as_quotas_find(quotas, ns, set, type);
+
+	if (! quota) {
+		return AEROSPIKE_OK;
+	}
+
+	uint64_t now = cf_getns();
+	as_quota_tokens* tokens = NULL;
+
+	if (quota->batch > 1) {
+		uint32_t index = (uint32_t)(quota - quotas->array);
+
+		tokens = as_quota_tokens_get(index);
+
+		if (tokens->quotas_id == quotas->id && tokens->index == index && tokens->tokens > 0 &&
+			now < tokens->expire_ns) {
+			tokens->tokens--;
+			return AEROSPIKE_OK;
+		}
+	}
+
+	uint64_t burst_ns = quota->interval_ns * quota->burst;
+
+	while (true) {
+		uint64_t next = as_load_uint64(&quota->next_ns);
+		uint64_t base = (next > now)? next : now;
+		uint64_t admit = base + quota->interval_ns;
+
+		// A full bucket admits burst commands at once. Further commands are spaced by
+		// interval_ns.
+		uint64_t wait = (admit > now + burst_ns)? admit - now - burst_ns : 0;
+
+		if (tokens) {
+			// Take a batch if the bucket holds all of it. Otherwise take one token, so
+			// commands are admitted exactly while the quota is at its limit.
+			uint64_t batch_admit = base + quota->interval_ns * quota->batch;
+
+			if (batch_admit <= now + burst_ns) {
+				if (as_cas_uint64(&quota->next_ns, next, batch_admit)) {
+					tokens->quotas_id = quotas->id;
+					tokens->index = (uint32_t)(quota - quotas->array);
+					tokens->tokens = quota->batch - 1;
+					tokens->expire_ns = now + AS_QUOTA_BATCH_NS;
+					return AEROSPIKE_OK;
+				}
+				continue;
+			}
+		}
+
+		if (wait > 0 && (quota->mode == AS_QUOTA_REJECT ||
+			wait > (uint64_t)max_wait_ms * 1000000)) {
+			as_incr_uint64(&quota->rejects);
+			return as_error_update(err, AEROSPIKE_CLIENT_QUOTA_EXCEEDED,
+				"Client quota exceeded: %s.%s rate=%u", quota->ns, quota->set, quota->rate);
+		}
+
+		if (as_cas_uint64(&quota->next_ns, next, admit)) {
+			*delay_ms = (uint32_t)((wait + 999999) / 1000000);
+			return AEROSPIKE_OK;
+		}
+	}
+}
+
+as_status
+as_quotas_wait(
+	as_quotas* quotas, as_error* err, const char* ns, const char* set, as_quota_type type,
+	uint32_t max_wait_ms
+	)
+{
+	uint32_t delay_ms;
+	as_status status = as_quotas_acquire(quotas, err, ns, set, type, max_wait_ms, &delay_ms);
+
+	if (status == AEROSPIKE_OK && delay_ms > 0) {
+		as_sleep(delay_ms);
+	}
+	return status;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_rate_limiter.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_sleep.h>
+#include <citrusleaf/cf_clock.h>
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+// Allowed burst before acquirers sleep.
+#define AS_RATE_LIMITER_BURST_NS (10 * 1000 * 1000)
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_rate_limiter_init(as_rate_limiter* rl, uint32_t records_per_second)
+{
+	rl->next_ns = 0;
+	rl->burst_ns = AS_RATE_LIMITER_BURST_NS;
+	rl->rate = records_per_second;
+}
+
+void
+as_rate_limiter_acquire(as_rate_limiter* rl, uint32_t n_records)
+{
+	if (rl->rate == 0 || n_records == 0) {
+		return;
+	}
+
+	uint64_t cost = (uint64_t)n_records * 1000000000 / rl->rate;
+	uint64_t now;
+	uint64_t next;
+
+	// Reserve time slot for the records. Records that exceed the rate push next_ns ahead
+	// of the clock, so all limiter users sleep in proportion to the shared backlog.
+	while (true) {
+		now = cf_getns();
+
+		uint64_t old = as_load_uint64(&rl->next_ns);
+		uint64_t begin = (old > now)? old : now;
+		next = begin + cost;
+
+		if (as_cas_uint64(&rl->next_ns, old, next)) {
+			break;
+		}
+	}
+
+	if (next > now + rl->burst_ns) {
+		uint64_t wait_ns = next - now - rl->burst_ns;
+		as_sleep((uint32_t)((wait_ns + 999999) / 1000000));
+	}
+}
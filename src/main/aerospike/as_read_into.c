@@ -0,0 +1,199 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_read_into.h>
+#include <aerospike/as_bytes.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_read_slot_init(
+	as_read_slot* slot, const char* name, as_read_slot_type type, void* data, uint32_t capacity
+	)
+{
+	as_strncpy(slot->name, name, sizeof(as_bin_name));
+	slot->type = type;
+	slot->data = data;
+	slot->capacity = capacity;
+	slot->size = 0;
+	slot->status = AS_READ_SLOT_NOT_FOUND;
+}
+
+static as_read_slot*
+as_read_into_find(as_read_into* into, const uint8_t* name, uint8_t name_size)
+{
+	if (name_size >= sizeof(as_bin_name)) {
+		return NULL;
+	}
+
+	// Fixed schemas are small, so a linear scan beats hashing.
+	for (uint32_t i = 0; i < into->n_slots; i++) {
+		as_read_slot* slot = &into->slots[i];
+
+		if (strncmp(slot->name, (const char*)name, name_size) == 0 && slot->name[name_size] == 0) {
+			return slot;
+		}
+	}
+	return NULL;
+}
+
+static void
+as_read_slot_set(as_read_slot* slot, uint8_t particle_type, const uint8_t* p, uint32_t size)
+{
+	if (particle_type == AS_BYTES_UNDEF) {
+		return;
+	}
+
+	slot->size = size;
+
+	switch (slot->type) {
+		case AS_READ_SLOT_INT64:
+			if (particle_type != AS_BYTES_INTEGER || size != 8) {
+				slot->status = AS_READ_SLOT_TYPE_MISMATCH;
+				return;
+			}
+			*(int64_t*)slot->data = (int64_t)cf_swap_from_be64(*(uint64_t*)p);
+			break;
+
+		case AS_READ_SLOT_DOUBLE:
+			if (particle_type != AS_BYTES_DOUBLE || size != 8) {
+				slot->status = AS_READ_SLOT_TYPE_MISMATCH;
+				return;
+			}
+			*(double*)slot->data = cf_swap_from_big_float64(*(double*)p);
+			break;
+
+		case AS_READ_SLOT_BOOL:
+			if (particle_type != AS_BYTES_BOOL || size != 1) {
+				slot->status = AS_READ_SLOT_TYPE_MISMATCH;
+				return;
+			}
+			*(bool*)slot->data = *p != 0;
+			break;
+
+		case AS_READ_SLOT_STRING: {
+			if (particle_type != AS_BYTES_STRING) {
+				slot->status = AS_READ_SLOT_TYPE_MISMATCH;
+				return;
+			}
+
+			if (slot->capacity == 0) {
+				slot->status = AS_READ_SLOT_TRUNCATED;
+				return;
+			}
+
+			char* s = slot->data;
+
+			if (size >= slot->capacity) {
+				uint32_t len = slot->capacity - 1;
+				memcpy(s, p, len);
+				s[len] = 0;
+				slot->status = AS_READ_SLOT_TRUNCATED;
+				return;
+			}
+			memcpy(s, p, size);
+			s[size] = 0;
+			break;
+		}
+
+		case AS_READ_SLOT_BYTES:
+			if (particle_type != AS_BYTES_BLOB) {
+				slot->status = AS_READ_SLOT_TYPE_MISMATCH;
+				return;
+			}
+
+			if (size > slot->capacity) {
+				memcpy(slot->data, p, slot->capacity);
+				slot->status = AS_READ_SLOT_TRUNCATED;
+				return;
+			}
+			memcpy(slot->data, p, size);
+			break;
+	}
+	slot->status = AS_READ_SLOT_OK;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_read_slot_init_int64(as_read_slot* slot, const char* name, int64_t* value)
+{
+	as_read_slot_init(slot, name, AS_READ_SLOT_INT64, value, sizeof(int64_t));
+}
+
+void
+as_read_slot_init_double(as_read_slot* slot, const char* name, double* value)
+{
+	as_read_slot_init(slot, name, AS_READ_SLOT_DOUBLE, value, sizeof(double));
+}
+
+void
+as_read_slot_init_bool(as_read_slot* slot, const char* name, bool* value)
+{
+	as_read_slot_init(slot, name, AS_READ_SLOT_BOOL, value, sizeof(bool));
+}
+
+void
+as_read_slot_init_str(as_read_slot* slot, const char* name, char* buf, uint32_t capacity)
+{
+	as_read_slot_init(slot, name, AS_READ_SLOT_STRING, buf, capacity);
+}
+
+void
+as_read_slot_init_bytes(as_read_slot* slot, const char* name, uint8_t* buf, uint32_t capacity)
+{
+	as_read_slot_init(slot, name, AS_READ_SLOT_BYTES, buf, capacity);
+}
+
+void
+as_read_into_reset(as_read_into* into)
+{
+	for (uint32_t i = 0; i < into->n_slots; i++) {
+		into->slots[i].size = 0;
+		into->slots[i].status = AS_READ_SLOT_NOT_FOUND;
+	}
+	into->gen = 0;
+	into->ttl = 0;
+}
+
+void
+as_read_into_parse(as_read_into* into, uint8_t* p, uint32_t n_bins)
+{
+	for (uint32_t i = 0; i < n_bins; i++) {
+		uint32_t op_size = cf_swap_from_be32(*(uint32_t*)p);
+		p += 5;
+		uint8_t particle_type = *p;
+		p += 2;
+
+		uint8_t name_size = *p++;
+		const uint8_t* name = p;
+		p += name_size;
+
+		uint32_t value_size = op_size - (name_size + 4);
+		as_read_slot* slot = as_read_into_find(into, name, name_size);
+
+		if (slot) {
+			as_read_slot_set(slot, particle_type, p, value_size);
+		}
+		p += value_size;
+	}
+}
@@ -14,6 +14,7 @@
  * License for the specific language governing permissions and limitations under
  * the License.
  */
+#include <aerospike/as_atomic.h>
 #include <aerospike/as_bin.h>
 #include <aerospike/as_bytes.h>
 #include <aerospike/as_double.h>
@@ -21,8 +22,11 @@
 #include <aerospike/as_key.h>
 #include <aerospike/as_list.h>
 #include <aerospike/as_map.h>
+#include <aerospike/as_mem_stats.h>
+#include <aerospike/as_msgpack.h>
 #include <aerospike/as_nil.h>
 #include <aerospike/as_record.h>
+#include <aerospike/as_serializer.h>
 #include <aerospike/as_string.h>
 #include <citrusleaf/alloc.h>
 #include <stdlib.h>
@@ -72,9 +76,13 @@ as_record_defaults(as_record* rec, bool free, uint16_t nbins)
 
 	rec->key.digest.init = false;
 	memset(rec->key.digest.value, 0, AS_DIGEST_VALUE_SIZE);
+	rec->key.ns_handle = 0;
+	rec->key.route_hint = 0;
 
 	rec->gen = 0;
 	rec->ttl = 0;
+	rec->buffer = NULL;
+	rec->lazy = false;
 
 	if ( nbins > 0 ) {
 		rec->bins._free = true;
@@ -151,9 +159,58 @@ as_record_release(as_record* rec)
 		rec->key.valuep = NULL;
 
 		rec->key.digest.init = false;
+		rec->key.ns_handle = 0;
+		rec->key.route_hint = 0;
+
+		// Bin values that reference the buffer have already been destroyed.
+		if ( rec->buffer ) {
+			as_record_buffer_release(rec->buffer);
+			rec->buffer = NULL;
+		}
+		rec->lazy = false;
 	}
 }
 
+as_record_buffer*
+as_record_buffer_create(const as_allocator* allocator, uint32_t size)
+{
+	size_t len = sizeof(as_record_buffer) + size;
+	as_record_buffer* buffer = (as_record_buffer *) (allocator ?
+		as_allocator_malloc(allocator, len) : cf_malloc(len));
+	if ( !buffer ) return buffer;
+	as_mem_stats_alloc(AS_MEM_TAG_RECORD, len);
+	buffer->ref_count = 1;
+	buffer->size = size;
+
+	if ( allocator ) {
+		buffer->allocator = *allocator;
+	}
+	else {
+		memset(&buffer->allocator, 0, sizeof(as_allocator));
+	}
+	return buffer;
+}
+
+void
+as_record_buffer_release(as_record_buffer* buffer)
+{
+	if ( as_aaf_uint32_rls(&buffer->ref_count, -1) == 0 ) {
+		as_fence_acq();
+		as_mem_stats_free(AS_MEM_TAG_RECORD, sizeof(as_record_buffer) + buffer->size);
+		as_allocator allocator = buffer->allocator;
+		as_allocator_free(&allocator, buffer);
+	}
+}
+
+void
+as_record_set_buffer(as_record* rec, as_record_buffer* buffer)
+{
+	if ( rec->buffer ) {
+		as_record_buffer_release(rec->buffer);
+	}
+	rec->buffer = buffer;
+}
+
 as_record*
 as_record_new(uint16_t nbins)
 {
@@ -169,6 +226,24 @@ as_record_init(as_record* rec, uint16_t nbins)
 	return as_record_defaults(rec, false, nbins);
 }
 
+as_record*
+as_record_new_arena(uint16_t nbins, uint32_t data_size, uint8_t** data)
+{
+	// as_bin is pointer aligned, so value storage after the bin array is also aligned.
+	size_t bins_size = sizeof(as_bin) * nbins;
+	as_record* rec = (as_record *) cf_malloc(sizeof(as_record) + bins_size + data_size);
+	if ( !rec ) return rec;
+
+	as_record_defaults(rec, true, 0);
+	rec->bins.capacity = nbins;
+	rec->bins.entries = (as_bin *) (rec + 1);
+
+	if ( data_size > 0 ) {
+		*data = (uint8_t *) rec->bins.entries + bins_size;
+	}
+	return rec;
+}
+
 void
 as_record_destroy(as_record* rec)
 {
@@ -341,12 +416,63 @@ as_record_get(const as_record* rec, const char* name)
 {
 	for(int i=0; i<rec->bins.size; i++) {
 		if ( strcmp(rec->bins.entries[i].name, name) == 0 ) {
-			return (as_bin_value *) rec->bins.entries[i].valuep;
+			return as_record_bin_value(rec, &rec->bins.entries[i]);
+		}
+	}
+	return NULL;
+}
+
+as_bin_value*
+as_record_get_by_handle(const as_record* rec, as_bin_handle* handle)
+{
+	uint16_t size = rec->bins.size;
+	as_bin* entries = rec->bins.entries;
+	uint16_t slot = handle->slot;
+
+	if ( slot < size && strcmp(entries[slot].name, handle->name) == 0 ) {
+		return as_record_bin_value(rec, &entries[slot]);
+	}
+
+	for(uint16_t i = 0; i < size; i++) {
+		if ( strcmp(entries[i].name, handle->name) == 0 ) {
+			handle->slot = i;
+			return as_record_bin_value(rec, &entries[i]);
 		}
 	}
 	return NULL;
 }
 
+as_bin_value*
+as_record_bin_deserialize(as_bin* bin)
+{
+	as_bin_value* v = bin->valuep;
+
+	// Raw list and map bytes of lazy records are wrapped in the bin itself.
+	if ( v != &bin->value || as_val_type((as_val *) v) != AS_BYTES ||
+		 ! (v->bytes.type == AS_BYTES_LIST || v->bytes.type == AS_BYTES_MAP) ) {
+		return v;
+	}
+
+	as_buffer buffer;
+	buffer.data = v->bytes.value;
+	buffer.size = v->bytes.size;
+
+	as_val* value = NULL;
+	as_serializer ser;
+	as_msgpack_init(&ser);
+	int rv = as_serializer_deserialize(&ser, &buffer, &value);
+	as_serializer_destroy(&ser);
+
+	if ( rv != 0 || ! value ) {
+		// Leave raw bytes in place so the caller can still inspect them.
+		return v;
+	}
+
+	as_val_destroy((as_val *) &bin->value);
+	bin->valuep = (as_bin_value *) value;
+	return bin->valuep;
+}
+
 bool
 as_record_get_bool(const as_record* rec, const char* name)
 {
@@ -460,7 +586,9 @@ as_record_foreach(const as_record* rec, as_rec_foreach_callback callback, void*
 {
 	if ( rec->bins.entries ) {
 		for ( int i = 0; i < rec->bins.size; i++ ) {
-			if ( callback(rec->bins.entries[i].name, (as_val *) rec->bins.entries[i].valuep, udata) == false ) {
+			as_val* value = (as_val *) as_record_bin_value(rec, &rec->bins.entries[i]);
+
+			if ( callback(rec->bins.entries[i].name, value, udata) == false ) {
 				return false;
 			}
 		}
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_ripemd160.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AS_RIPEMD160_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(AS_RIPEMD160_AVX2)
+
+//---------------------------------
+// Globals
+//---------------------------------
+
+// Message word selection, left and right lines.
+static const uint8_t as_rl[80] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+	3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+	1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+	4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+};
+
+static const uint8_t as_rr[80] = {
+	5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+	6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+	15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+	8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+	12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+};
+
+// Rotate amounts, left and right lines.
+static const uint8_t as_sl[80] = {
+	11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+	7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+	11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+	11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+	9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+};
+
+static const uint8_t as_sr[80] = {
+	8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+	9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+	9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+	15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+	8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+};
+
+// Round constants, left and right lines.
+static const uint32_t as_kl[5] = {
+	0x00000000, 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xA953FD4E
+};
+
+static const uint32_t as_kr[5] = {
+	0x50A28BE6, 0x5C4DD124, 0x6D703EF3, 0x7A6D76E9, 0x00000000
+};
+
+static const uint32_t as_h_init[5] = {
+	0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+};
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+__attribute__((target("avx2")))
+static inline __m256i
+as_rol(__m256i x, uint32_t s)
+{
+	return _mm256_or_si256(_mm256_sll_epi32(x, _mm_cvtsi32_si128((int)s)),
+		_mm256_srl_epi32(x, _mm_cvtsi32_si128((int)(32 - s))));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i
+as_f(uint32_t round, __m256i x, __m256i y, __m256i z)
+{
+	const __m256i ones = _mm256_set1_epi32(-1);
+
+	switch (round) {
+		case 0:
+			return _mm256_xor_si256(_mm256_xor_si256(x, y), z);
+		case 1:
+			return _mm256_or_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z));
+		case 2:
+			return _mm256_xor_si256(_mm256_or_si256(x, _mm256_xor_si256(y, ones)), z);
+		case 3:
+			return _mm256_or_si256(_mm256_and_si256(x, z), _mm256_andnot_si256(z, y));
+		default:
+			return _mm256_xor_si256(x, _mm256_or_si256(y, _mm256_xor_si256(z, ones)));
+	}
+}
+
+__attribute__((target("avx2")))
+static void
+as_ripemd160_compress_avx2(__m256i* h, const __m256i* x)
+{
+	__m256i al = h[0], bl = h[1], cl = h[2], dl = h[3], el = h[4];
+	__m256i ar = h[0], br = h[1], cr = h[2], dr = h[3], er = h[4];
+
+	for (uint32_t j = 0; j < 80; j++) {
+		uint32_t round = j >> 4;
+
+		__m256i t = _mm256_add_epi32(al, as_f(round, bl, cl, dl));
+		t = _mm256_add_epi32(t, x[as_rl[j]]);
+		t = _mm256_add_epi32(t, _mm256_set1_epi32((int)as_kl[round]));
+		t = _mm256_add_epi32(as_rol(t, as_sl[j]), el);
+		al = el;
+		el = dl;
+		dl = as_rol(cl, 10);
+		cl = bl;
+		bl = t;
+
+		t = _mm256_add_epi32(ar, as_f(4 - round, br, cr, dr));
+		t = _mm256_add_epi32(t, x[as_rr[j]]);
+		t = _mm256_add_epi32(t, _mm256_set1_epi32((int)as_kr[round]));
+		t = _mm256_add_epi32(as_rol(t, as_sr[j]), er);
+		ar = er;
+		er = dr;
+		dr = as_rol(cr, 10);
+		cr = br;
+		br = t;
+	}
+
+	__m256i t = _mm256_add_epi32(h[1], _mm256_add_epi32(cl, dr));
+	h[1] = _mm256_add_epi32(h[2], _mm256_add_epi32(dl, er));
+	h[2] = _mm256_add_epi32(h[3], _mm256_add_epi32(el, ar));
+	h[3] = _mm256_add_epi32(h[4], _mm256_add_epi32(al, br));
+	h[4] = _mm256_add_epi32(h[0], _mm256_add_epi32(bl, cr));
+	h[0] = t;
+}
+
+static void
+as_ripemd160_fill_block(
+	const as_ripemd160_input* in, uint64_t total, uint32_t n_blocks, uint32_t block,
+	uint8_t* buf
+	)
+{
+	uint64_t begin = (uint64_t)block * 64;
+	uint64_t end = begin + 64;
+	uint64_t offset = 0;
+
+	memset(buf, 0, 64);
+
+	// Copy the part of each segment that overlaps this block.
+	for (uint32_t i = 0; i < 3; i++) {
+		uint64_t seg_end = offset + in->len[i];
+		uint64_t lo = (offset > begin)? offset : begin;
+		uint64_t hi = (seg_end < end)? seg_end : end;
+
+		if (lo < hi) {
+			memcpy(buf + (lo - begin), in->data[i] + (lo - offset), (size_t)(hi - lo));
+		}
+		offset = seg_end;
+	}
+
+	// Padding starts directly after the message.
+	if (total >= begin && total < end) {
+		buf[total - begin] = 0x80;
+	}
+
+	// Message length in bits is stored little endian in the last 8 bytes.
+	if (block == n_blocks - 1) {
+		uint64_t bits = total << 3;
+
+		for (uint32_t i = 0; i < 8; i++) {
+			buf[56 + i] = (uint8_t)(bits >> (i * 8));
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void
+as_ripemd160_multi_avx2(const as_ripemd160_input* inputs, uint32_t n, uint8_t* const* digests)
+{
+	uint64_t totals[AS_RIPEMD160_LANES];
+	uint32_t n_blocks[AS_RIPEMD160_LANES];
+	uint32_t max_blocks = 0;
+
+	for (uint32_t i = 0; i < n; i++) {
+		const as_ripemd160_input* in = &inputs[i];
+		totals[i] = (uint64_t)in->len[0] + in->len[1] + in->len[2];
+
+		// Padding requires one marker byte and eight length bytes.
+		n_blocks[i] = (uint32_t)((totals[i] + 8) / 64 + 1);
+
+		if (n_blocks[i] > max_blocks) {
+			max_blocks = n_blocks[i];
+		}
+	}
+
+	__m256i h[5];
+
+	for (uint32_t i = 0; i < 5; i++) {
+		h[i] = _mm256_set1_epi32((int)as_h_init[i]);
+	}
+
+	uint8_t buf[64];
+	uint32_t words[16][AS_RIPEMD160_LANES];
+	uint32_t state[5][AS_RIPEMD160_LANES];
+	__m256i x[16];
+
+	memset(words, 0, sizeof(words));
+
+	// Lanes whose messages have fewer blocks keep running on stale words. Their digests
+	// were already extracted after their final block.
+	for (uint32_t b = 0; b < max_blocks; b++) {
+		for (uint32_t i = 0; i < n; i++) {
+			if (b >= n_blocks[i]) {
+				continue;
+			}
+
+			as_ripemd160_fill_block(&inputs[i], totals[i], n_blocks[i], b, buf);
+
+			for (uint32_t j = 0; j < 16; j++) {
+				const uint8_t* p = buf + (j * 4);
+				words[j][i] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+					((uint32_t)p[3] << 24);
+			}
+		}
+
+		for (uint32_t j = 0; j < 16; j++) {
+			x[j] = _mm256_loadu_si256((const __m256i*)words[j]);
+		}
+
+		as_ripemd160_compress_avx2(h, x);
+
+		for (uint32_t j = 0; j < 5; j++) {
+			_mm256_storeu_si256((__m256i*)state[j], h[j]);
+		}
+
+		for (uint32_t i = 0; i < n; i++) {
+			if (b != n_blocks[i] - 1) {
+				continue;
+			}
+
+			uint8_t* d = digests[i];
+
+			for (uint32_t j = 0; j < 5; j++) {
+				uint32_t v = state[j][i];
+				d[j * 4] = (uint8_t)v;
+				d[j * 4 + 1] = (uint8_t)(v >> 8);
+				d[j * 4 + 2] = (uint8_t)(v >> 16);
+				d[j * 4 + 3] = (uint8_t)(v >> 24);
+			}
+		}
+	}
+}
+
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+bool
+as_ripemd160_multi_supported(void)
+{
+#if defined(AS_RIPEMD160_AVX2)
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+void
+as_ripemd160_multi(const as_ripemd160_input* inputs, uint32_t n, uint8_t* const* digests)
+{
+#if defined(AS_RIPEMD160_AVX2)
+	as_ripemd160_multi_avx2(inputs, n, digests);
+#else
+	(void)inputs;
+	(void)n;
+	(void)digests;
+#endif
+}
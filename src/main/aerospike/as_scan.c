@@ -348,6 +348,7 @@ as_scan_from_bytes(as_scan* scan, const uint8_t* bytes, uint32_t bytes_size)
 	if (b) {
 		scan->ops = cf_malloc(sizeof(as_operations));
 		scan->ops->_free = true;
+		scan->ops->arena = NULL;
 
 		if (as_unpack_uint64(&pk, &uval) != 0) {
 			goto HandleError;
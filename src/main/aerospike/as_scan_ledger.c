@@ -0,0 +1,420 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_scan_ledger.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <citrusleaf/cf_clock.h>
+#include <errno.h>
+#include <string.h>
+
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define LEDGER_MAGIC 0x4153444c
+
+// Slot layout: state (2 bits) | owner (16 bits) | lease expiration in ms (46 bits).
+#define SLOT_FREE 0
+#define SLOT_CLAIMED 1
+#define SLOT_DONE 2
+
+#define SLOT_EXPIRE_MASK (((uint64_t)1 << 46) - 1)
+#define SLOT_STATE(_v) ((uint32_t)((_v) >> 62))
+#define SLOT_OWNER(_v) ((uint16_t)((_v) >> 46))
+#define SLOT_EXPIRE(_v) ((_v) & SLOT_EXPIRE_MASK)
+#define SLOT_MAKE(_state, _owner, _expire) \
+	(((uint64_t)(_state) << 62) | ((uint64_t)(_owner) << 46) | ((_expire) & SLOT_EXPIRE_MASK))
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline bool
+as_scan_ledger_claimable(uint64_t v, uint64_t now)
+{
+	// Slots with an unknown state are corrupt and scanned again.
+	uint32_t state = SLOT_STATE(v);
+	return state != SLOT_DONE && (state != SLOT_CLAIMED || SLOT_EXPIRE(v) <= now);
+}
+
+// Free slots with an unknown state and claims that expire later than a new lease would. Those
+// claims were made before a reboot reset the monotonic clock, or are corrupt, and would not
+// expire in time.
+static void
+as_scan_ledger_repair(as_scan_ledger* ledger, const char* path)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+	uint64_t max_expire = cf_getms() + ledger->lease_ms;
+	uint32_t repaired = 0;
+
+	for (uint32_t i = 0; i < shm->part_count; i++) {
+		uint64_t v = as_load_uint64(&shm->slots[i]);
+		uint32_t state = SLOT_STATE(v);
+
+		if ((state > SLOT_DONE || (state == SLOT_CLAIMED && SLOT_EXPIRE(v) > max_expire)) &&
+			as_cas_uint64(&shm->slots[i], v, SLOT_MAKE(SLOT_FREE, 0, 0))) {
+			repaired++;
+		}
+	}
+
+	if (repaired > 0) {
+		as_log_warn("Ledger %s had %u invalid partition slots. Freed them.", path, repaired);
+	}
+}
+
+static inline bool
+as_scan_ledger_owned(as_scan_ledger* ledger, uint64_t v)
+{
+	return SLOT_STATE(v) == SLOT_CLAIMED && SLOT_OWNER(v) == ledger->owner;
+}
+
+static as_status
+as_scan_ledger_init(
+	as_scan_ledger* ledger, as_error* err, const char* path, uint32_t part_begin,
+	uint32_t part_count
+	)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+
+	if (as_load_uint32_acq(&shm->magic) == 0) {
+		// New ledger. Zeroed slots are free. Workers that open a new ledger at the same time
+		// write the same header.
+		shm->part_begin = (uint16_t)part_begin;
+		shm->part_count = (uint16_t)part_count;
+		as_store_uint32_rls(&shm->magic, LEDGER_MAGIC);
+	}
+	else if (shm->magic != LEDGER_MAGIC) {
+		// The file size matches the partition range, so the header is corrupt. Progress is
+		// lost and all partitions are scanned again.
+		as_log_warn("Ledger %s has a corrupt header. Clearing it.", path);
+		memset(shm->slots, 0, sizeof(uint64_t) * part_count);
+		shm->part_begin = (uint16_t)part_begin;
+		shm->part_count = (uint16_t)part_count;
+		as_store_uint32_rls(&shm->magic, LEDGER_MAGIC);
+	}
+	else if (shm->part_begin != part_begin || shm->part_count != part_count) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Ledger %s was created for a different partition range", path);
+	}
+
+	uint32_t pid = (uint32_t)getpid();
+	ledger->owner = (uint16_t)(pid ^ (pid >> 16) ^ (uint32_t)(cf_getns() >> 10));
+	ledger->cursor = (uint32_t)(((uint64_t)ledger->owner * part_count) >> 16);
+	as_scan_ledger_repair(ledger, path);
+	return AEROSPIKE_OK;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+#if !defined(_MSC_VER)
+
+as_status
+as_scan_ledger_open(
+	as_scan_ledger* ledger, as_error* err, const char* path, uint32_t part_begin,
+	uint32_t part_count, uint32_t lease_ms
+	)
+{
+	ledger->shm = NULL;
+	ledger->size = 0;
+	ledger->lease_ms = lease_ms;
+
+	if (part_count == 0 || part_begin + part_count > 4096 || lease_ms == 0) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Invalid ledger partition range %u,%u or lease %u", part_begin, part_count, lease_ms);
+	}
+
+	size_t size = sizeof(as_scan_ledger_shm) + sizeof(uint64_t) * part_count;
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+
+	if (fd < 0) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open %s: %s",
+							   path, strerror(errno));
+	}
+
+	struct stat stats;
+
+	if (fstat(fd, &stats) != 0) {
+		int e = errno;
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to stat %s: %s",
+							   path, strerror(e));
+	}
+
+	if (stats.st_size == 0) {
+		// Extending a new file multiple times to the same size is harmless.
+		if (ftruncate(fd, (off_t)size) != 0) {
+			int e = errno;
+			close(fd);
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to size %s: %s",
+								   path, strerror(e));
+		}
+	}
+	else if ((size_t)stats.st_size != size) {
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Ledger %s was created for a different partition range", path);
+	}
+
+	void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	int e = errno;
+
+	// The mapping remains valid after the descriptor is closed.
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %s",
+							   path, strerror(e));
+	}
+
+	ledger->shm = data;
+	ledger->size = size;
+
+	as_status status = as_scan_ledger_init(ledger, err, path, part_begin, part_count);
+
+	if (status != AEROSPIKE_OK) {
+		as_scan_ledger_close(ledger);
+	}
+	return status;
+}
+
+void
+as_scan_ledger_close(as_scan_ledger* ledger)
+{
+	if (ledger->shm) {
+		munmap(ledger->shm, ledger->size);
+		ledger->shm = NULL;
+	}
+	ledger->size = 0;
+}
+
+#else
+
+as_status
+as_scan_ledger_open(
+	as_scan_ledger* ledger, as_error* err, const char* path, uint32_t part_begin,
+	uint32_t part_count, uint32_t lease_ms
+	)
+{
+	ledger->shm = NULL;
+	ledger->size = 0;
+	ledger->lease_ms = lease_ms;
+	ledger->mapping = NULL;
+
+	if (part_count == 0 || part_begin + part_count > 4096 || lease_ms == 0) {
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Invalid ledger partition range %u,%u or lease %u", part_begin, part_count, lease_ms);
+	}
+
+	size_t size = sizeof(as_scan_ledger_shm) + sizeof(uint64_t) * part_count;
+	HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE,
+							  FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS,
+							  FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open %s: %lu",
+							   path, GetLastError());
+	}
+
+	LARGE_INTEGER file_size;
+
+	if (! GetFileSizeEx(file, &file_size)) {
+		DWORD e = GetLastError();
+		CloseHandle(file);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to stat %s: %lu", path, e);
+	}
+
+	if (file_size.QuadPart != 0 && (size_t)file_size.QuadPart != size) {
+		CloseHandle(file);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM,
+			"Ledger %s was created for a different partition range", path);
+	}
+
+	// A new file is extended with zeros to the mapping size.
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, (DWORD)size, NULL);
+	DWORD e = GetLastError();
+
+	// The mapping keeps the file open.
+	CloseHandle(file);
+
+	if (! mapping) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %lu", path, e);
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+	if (! data) {
+		e = GetLastError();
+		CloseHandle(mapping);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %lu", path, e);
+	}
+
+	ledger->shm = data;
+	ledger->size = size;
+	ledger->mapping = mapping;
+
+	as_status status = as_scan_ledger_init(ledger, err, path, part_begin, part_count);
+
+	if (status != AEROSPIKE_OK) {
+		as_scan_ledger_close(ledger);
+	}
+	return status;
+}
+
+void
+as_scan_ledger_close(as_scan_ledger* ledger)
+{
+	if (ledger->shm) {
+		UnmapViewOfFile(ledger->shm);
+		CloseHandle(ledger->mapping);
+		ledger->shm = NULL;
+		ledger->mapping = NULL;
+	}
+	ledger->size = 0;
+}
+
+#endif
+
+uint32_t
+as_scan_ledger_claim(as_scan_ledger* ledger, uint32_t max, as_partition_filter* pf)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+	uint32_t n_slots = shm->part_count;
+
+	if (max == 0) {
+		max = AS_SCAN_LEDGER_CHUNK_DEFAULT;
+	}
+
+	uint64_t now = cf_getms();
+	uint64_t claim = SLOT_MAKE(SLOT_CLAIMED, ledger->owner, now + ledger->lease_ms);
+
+	for (uint32_t k = 0; k < n_slots; k++) {
+		uint32_t i = (ledger->cursor + k) % n_slots;
+		uint64_t v = as_load_uint64(&shm->slots[i]);
+
+		if (! as_scan_ledger_claimable(v, now) || ! as_cas_uint64(&shm->slots[i], v, claim)) {
+			continue;
+		}
+
+		// Extend run while following partitions can be claimed. Partition filters are
+		// contiguous ranges, so the run does not wrap around.
+		uint32_t n = 1;
+
+		while (n < max && i + n < n_slots) {
+			uint64_t* slot = &shm->slots[i + n];
+			v = as_load_uint64(slot);
+
+			if (! as_scan_ledger_claimable(v, now) || ! as_cas_uint64(slot, v, claim)) {
+				break;
+			}
+			n++;
+		}
+
+		ledger->cursor = (i + n) % n_slots;
+		as_partition_filter_set_range(pf, shm->part_begin + i, n);
+		return n;
+	}
+	return 0;
+}
+
+bool
+as_scan_ledger_renew(as_scan_ledger* ledger, const as_partition_filter* pf)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+	uint64_t claim = SLOT_MAKE(SLOT_CLAIMED, ledger->owner, cf_getms() + ledger->lease_ms);
+	uint32_t begin = pf->begin - shm->part_begin;
+	bool owned = true;
+
+	for (uint32_t i = begin; i < begin + pf->count; i++) {
+		uint64_t v = as_load_uint64(&shm->slots[i]);
+
+		if (! as_scan_ledger_owned(ledger, v) || ! as_cas_uint64(&shm->slots[i], v, claim)) {
+			owned = false;
+		}
+	}
+	return owned;
+}
+
+void
+as_scan_ledger_complete(as_scan_ledger* ledger, const as_partition_filter* pf, bool done)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+	uint64_t release = done ? SLOT_MAKE(SLOT_DONE, 0, 0) : SLOT_MAKE(SLOT_FREE, 0, 0);
+	uint32_t begin = pf->begin - shm->part_begin;
+
+	for (uint32_t i = begin; i < begin + pf->count; i++) {
+		uint64_t v = as_load_uint64(&shm->slots[i]);
+
+		if (as_scan_ledger_owned(ledger, v)) {
+			// Failure means the partition was stolen after this load.
+			as_cas_uint64(&shm->slots[i], v, release);
+		}
+	}
+}
+
+void
+as_scan_ledger_counts(
+	as_scan_ledger* ledger, uint32_t* done, uint32_t* claimed, uint32_t* available
+	)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+	uint64_t now = cf_getms();
+
+	*done = 0;
+	*claimed = 0;
+	*available = 0;
+
+	for (uint32_t i = 0; i < shm->part_count; i++) {
+		uint64_t v = as_load_uint64(&shm->slots[i]);
+
+		if (SLOT_STATE(v) == SLOT_DONE) {
+			(*done)++;
+		}
+		else if (as_scan_ledger_claimable(v, now)) {
+			(*available)++;
+		}
+		else {
+			(*claimed)++;
+		}
+	}
+}
+
+bool
+as_scan_ledger_done(as_scan_ledger* ledger)
+{
+	as_scan_ledger_shm* shm = ledger->shm;
+
+	for (uint32_t i = 0; i < shm->part_count; i++) {
+		if (SLOT_STATE(as_load_uint64(&shm->slots[i])) != SLOT_DONE) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_shared_threads.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_cpu.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_thread.h>
+#include <aerospike/as_tls.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <errno.h>
+#include <string.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void*
+as_shared_tender(void* udata)
+{
+	as_thread_set_name("tend");
+
+	as_shared_threads* st = udata;
+
+	if (st->tend_thread_cpu >= 0) {
+		if (as_cpu_assign_thread(pthread_self(), st->tend_thread_cpu) != 0) {
+			as_log_warn("Failed to assign tend thread to cpu %d", st->tend_thread_cpu);
+		}
+	}
+
+	pthread_mutex_lock(&st->lock);
+
+	while (st->valid) {
+		// Find the cluster whose tend is most overdue.
+		as_cluster* cluster = NULL;
+		uint64_t next = UINT64_MAX;
+
+		for (uint32_t i = 0; i < st->clusters.size; i++) {
+			as_cluster* c = as_vector_get_ptr(&st->clusters, i);
+
+			if (c->tend_next < next) {
+				next = c->tend_next;
+				cluster = c;
+			}
+		}
+
+		if (! cluster) {
+			pthread_cond_wait(&st->cond, &st->lock);
+			continue;
+		}
+
+		uint64_t now = cf_getms();
+
+		if (next > now) {
+			struct timespec delta;
+			struct timespec abstime;
+			cf_clock_set_timespec_ms((uint32_t)(next - now), &delta);
+			cf_clock_current_add(&delta, &abstime);
+			pthread_cond_timedwait(&st->cond, &st->lock, &abstime);
+			continue;
+		}
+
+		// The cluster is not released while tending is set, so tend without holding the lock.
+		st->tending = cluster;
+		pthread_mutex_unlock(&st->lock);
+
+		uint32_t interval = as_cluster_tend_run(cluster);
+
+		pthread_mutex_lock(&st->lock);
+		cluster->tend_next = cf_getms() + interval;
+		st->tending = NULL;
+
+		// Wake a thread waiting to remove this cluster.
+		pthread_cond_broadcast(&st->cond);
+	}
+	pthread_mutex_unlock(&st->lock);
+
+	as_tls_thread_cleanup();
+	return NULL;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_shared_threads*
+as_shared_threads_create(as_error* err, uint32_t thread_pool_size, int tend_thread_cpu)
+{
+	as_shared_threads* st = cf_malloc(sizeof(as_shared_threads));
+	memset(st, 0, sizeof(as_shared_threads));
+
+	int rc = as_work_pool_init(&st->pool, thread_pool_size, as_tls_thread_cleanup);
+
+	if (rc) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT,
+			"Failed to initialize thread pool of size %u: %d", thread_pool_size, rc);
+		cf_free(st);
+		return NULL;
+	}
+
+	as_vector_init(&st->clusters, sizeof(as_cluster*), 8);
+	pthread_mutex_init(&st->lock, NULL);
+	pthread_cond_init(&st->cond, NULL);
+	st->tend_thread_cpu = tend_thread_cpu;
+	st->valid = true;
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+
+	if (tend_thread_cpu >= 0) {
+		as_cpu_assign_thread_attr(&attr, tend_thread_cpu);
+	}
+
+	if (pthread_create(&st->tend_thread, &attr, as_shared_tender, st) != 0) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to create tend thread: %s",
+			strerror(errno));
+		pthread_attr_destroy(&attr);
+		pthread_cond_destroy(&st->cond);
+		pthread_mutex_destroy(&st->lock);
+		as_vector_destroy(&st->clusters);
+		as_work_pool_destroy(&st->pool);
+		cf_free(st);
+		return NULL;
+	}
+	pthread_attr_destroy(&attr);
+	return st;
+}
+
+void
+as_shared_threads_destroy(as_shared_threads* st)
+{
+	pthread_mutex_lock(&st->lock);
+
+	if (st->clusters.size > 0) {
+		as_log_warn("Destroying shared threads with %u clusters still attached",
+			st->clusters.size);
+	}
+
+	st->valid = false;
+	pthread_cond_broadcast(&st->cond);
+	pthread_mutex_unlock(&st->lock);
+	pthread_join(st->tend_thread, NULL);
+
+	int rc = as_work_pool_destroy(&st->pool);
+
+	if (rc) {
+		as_log_warn("Failed to destroy thread pool: %d", rc);
+	}
+
+	pthread_cond_destroy(&st->cond);
+	pthread_mutex_destroy(&st->lock);
+	as_vector_destroy(&st->clusters);
+	cf_free(st);
+}
+
+void
+as_shared_threads_add(as_shared_threads* st, as_cluster* cluster)
+{
+	pthread_mutex_lock(&st->lock);
+	cluster->tend_next = cf_getms() + cluster->tend_interval;
+	as_vector_append(&st->clusters, &cluster);
+	pthread_cond_broadcast(&st->cond);
+	pthread_mutex_unlock(&st->lock);
+}
+
+void
+as_shared_threads_remove(as_shared_threads* st, as_cluster* cluster)
+{
+	pthread_mutex_lock(&st->lock);
+
+	for (uint32_t i = 0; i < st->clusters.size; i++) {
+		if (as_vector_get_ptr(&st->clusters, i) == cluster) {
+			as_vector_remove(&st->clusters, i);
+			break;
+		}
+	}
+
+	while (st->tending == cluster) {
+		pthread_cond_wait(&st->cond, &st->lock);
+	}
+	pthread_mutex_unlock(&st->lock);
+}
+
+void
+as_shared_threads_wake(as_shared_threads* st, as_cluster* cluster)
+{
+	pthread_mutex_lock(&st->lock);
+	cluster->tend_next = 0;
+	pthread_cond_broadcast(&st->cond);
+	pthread_mutex_unlock(&st->lock);
+}
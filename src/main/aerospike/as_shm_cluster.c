@@ -15,6 +15,7 @@
  * the License.
  */
 #include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_bitmap.h>
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_command.h>
 #include <aerospike/as_cpu.h>
@@ -24,7 +25,6 @@
 #include <aerospike/as_sleep.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_thread.h>
-#include <citrusleaf/cf_b64.h>
 #include <citrusleaf/cf_byte_order.h>
 #include <citrusleaf/cf_clock.h>
 #include <errno.h>
@@ -44,6 +44,12 @@
 #include <sys/sysctl.h>
 #endif
 
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_SHM_CACHE_LINE_SIZE 64
+
 //---------------------------------
 // Function declarations
 //---------------------------------
@@ -76,12 +82,17 @@ as_cluster_manage(as_cluster* cluster);
 // Functions
 //---------------------------------
 
-// Note on why shared memory robust mutex locks were not used:
+// Note on why shared memory robust mutex locks are not used to determine the tend owner:
 //
 // Shared memory robust mutex locks do not work properly on some supported platforms.
 // For example, Centos 6.5 will allow multiple contenders to get the same lock when EOWNERDEAD
 // condition is triggered.  Also, robust mutex locks are not supported at all on Mac OS X.
 // Therefore, use custom locking system which works on all platforms.
+//
+// On linux, a robust mutex is still held by the tend owner's tender thread, so followers are
+// notified of a dead tend owner without waiting for the takeover threshold. The robust mutex
+// only triggers the takeover check. The take over spin lock and owner process id decide which
+// follower takes over.
 
 /*
 static void
@@ -108,6 +119,39 @@ as_shm_dump_partition_tables(as_cluster_shm* cluster_shm)
 }
 */
 
+static inline uint32_t
+as_shm_align(size_t size)
+{
+	return (uint32_t)((size + AS_SHM_CACHE_LINE_SIZE - 1) & ~(size_t)(AS_SHM_CACHE_LINE_SIZE - 1));
+}
+
+#if defined(__linux__)
+static size_t
+as_shm_get_huge_page_size(void)
+{
+	const char* fn = "/proc/meminfo";
+	size_t huge_size = 2 * 1024 * 1024;
+	FILE* f = fopen(fn, "r");
+
+	if (!f) {
+		return huge_size;
+	}
+
+	char line[128];
+
+	while (fgets(line, sizeof(line), f)) {
+		size_t kb;
+
+		if (sscanf(line, "Hugepagesize: %zu kB", &kb) == 1) {
+			huge_size = kb * 1024;
+			break;
+		}
+	}
+	fclose(f);
+	return huge_size;
+}
+#endif
+
 #if !defined(_MSC_VER)
 static size_t
 as_shm_get_max_size(void)
@@ -423,7 +467,7 @@ as_shm_node_replace_racks(as_cluster_shm* cluster_shm, as_node* node, as_racks*
 	// Update shared memory node in write lock.
 	as_swlock_write_lock(&node_shm->lock);
 	node_shm->rebalance_generation = node->rebalance_generation;
-	node_shm->rack_id = rack_id;
+	as_store_uint32((uint32_t*)&node_shm->rack_id, (uint32_t)rack_id);
 	as_swlock_write_unlock(&node_shm->lock);
 }
 
@@ -475,43 +519,35 @@ as_shm_force_replicas_refresh(as_shm_info* shm_info, uint32_t node_index)
 	
 	if (node) {
 		node->partition_generation = (uint32_t)-1;
+		node->partition_bitmaps_reset = true;
 	}
 }
 
 static void
-as_shm_decode_and_update(
-	as_shm_info* shm_info, char* bitmap_b64, int64_t len, as_partition_table_shm* table,
+as_shm_update_table(
+	as_shm_info* shm_info, as_bitmap_iter* iter, as_partition_table_shm* table,
 	uint32_t node_index, uint8_t replica_index, uint32_t regime
 	)
 {
-	// Size allows for padding - is actual size rounded up to multiple of 3.
-	uint8_t* bitmap = (uint8_t*)alloca(cf_b64_decoded_buf_size((uint32_t)len));
-	
-	// For now - for speed - trust validity of encoded characters.
-	cf_b64_decode(bitmap_b64, (uint32_t)len, bitmap, NULL);
-	
-	// Expand the bitmap.
-	uint32_t max = shm_info->cluster_shm->n_partitions;
+	// Each bit returned by the iterator means this node claims ownership of partition.
+	uint32_t i;
 
-	for (uint32_t i = 0; i < max; i++) {
-		if ((bitmap[i >> 3] & (0x80 >> (i & 7))) != 0) {
-			// This node claims ownership of partition.
-			as_partition_shm* p = &table->partitions[i];
+	while (as_bitmap_iter_next(iter, &i)) {
+		as_partition_shm* p = &table->partitions[i];
 
-			if (regime >= as_load_uint32(&p->regime)) {
-				if (regime > p->regime) {
-					as_store_uint32(&p->regime, regime);
-				}
+		if (regime >= as_load_uint32(&p->regime)) {
+			if (regime > p->regime) {
+				as_store_uint32(&p->regime, regime);
+			}
 
-				uint32_t node_index_old = p->nodes[replica_index];
+			uint32_t node_index_old = p->nodes[replica_index];
 
-				if (node_index != node_index_old) {
-					// node index starts at one (zero indicates unset).
-					if (node_index_old) {
-						as_shm_force_replicas_refresh(shm_info, node_index_old);
-					}
-					as_store_uint32_rls(&p->nodes[replica_index], node_index);
+			if (node_index != node_index_old) {
+				// node index starts at one (zero indicates unset).
+				if (node_index_old) {
+					as_shm_force_replicas_refresh(shm_info, node_index_old);
 				}
+				as_store_uint32_rls(&p->nodes[replica_index], node_index);
 			}
 		}
 	}
@@ -519,7 +555,7 @@ as_shm_decode_and_update(
 
 void
 as_shm_update_partitions(
-	as_shm_info* shm_info, const char* ns, char* bitmap_b64, int64_t len, as_node* node,
+	as_shm_info* shm_info, const char* ns, as_bitmap_iter* iter, as_node* node,
 	uint8_t replica_size, uint8_t replica_index, uint32_t regime
 	)
 {
@@ -528,11 +564,13 @@ as_shm_update_partitions(
 	
 	if (! table) {
 		table = as_shm_add_partition_table(cluster_shm, ns, replica_size, regime != 0);
+
+		// New table has no owners yet.
+		as_bitmap_iter_init(iter, iter->bitmap, iter->size);
 	}
 	
 	if (table) {
-		as_shm_decode_and_update(shm_info, bitmap_b64, len, table, node->index + 1, replica_index,
-			regime);
+		as_shm_update_table(shm_info, iter, table, node->index + 1, replica_index, regime);
 	}
 }
 
@@ -575,6 +613,56 @@ as_shm_get_replica_sequence(
 	return NULL;
 }
 
+static as_node*
+as_shm_get_replica_latency(
+	as_node** local_nodes, as_partition_shm* p, as_node* prev_node, uint8_t replica_size,
+	uint8_t* replica_index
+	)
+{
+	as_node* best = NULL;
+	uint64_t best_score = 0;
+	uint8_t best_index = 0;
+	uint8_t seq = *replica_index;
+
+	for (uint8_t i = 0; i < replica_size; i++, seq++) {
+		uint8_t index = seq % replica_size;
+		uint32_t node_index = as_load_uint32_acq(&p->nodes[index]);
+
+		// node_index starts at one (zero indicates unset).
+		if (! node_index) {
+			continue;
+		}
+
+		as_node* node = as_node_load(&local_nodes[node_index-1]);
+
+		// Avoid retrying on node where command failed. The contents of prev_node may have
+		// already been destroyed, so just use pointer comparison.
+		if (! node || node == prev_node || ! as_node_is_active(node)) {
+			continue;
+		}
+
+		// Scores are kept in local process memory, so each process routes on its own
+		// observed latency.
+		uint64_t score = as_node_get_replica_score(node);
+
+		// The first valid node in sequence order is kept unless another node scores at
+		// least 25% lower. This hysteresis avoids flapping between similar nodes.
+		if (! best || score * 4 < best_score * 3) {
+			best = node;
+			best_score = score;
+			best_index = index;
+		}
+	}
+
+	if (best) {
+		*replica_index = best_index;
+		return best;
+	}
+
+	// Fall back to previous node if it's the only one left.
+	return as_shm_get_replica_sequence(local_nodes, p, replica_size, replica_index);
+}
+
 static as_node*
 as_shm_get_replica_rack(
 	as_cluster* cluster, as_node** local_nodes, const char* ns, as_partition_shm* p,
@@ -605,21 +693,14 @@ as_shm_get_replica_rack(
 			}
 			node_index--;
 
-			as_node_shm* node_shm = &nodes_shm[node_index];
-			int rack_id;
-			uint8_t active;
-
-			as_swlock_read_lock(&node_shm->lock);
-			rack_id = node_shm->rack_id;
-			active = node_shm->active;
-			as_swlock_read_unlock(&node_shm->lock);
+			// The local node is cleared or deactivated when the shared memory node is
+			// deactivated, so the shared memory node lock is not needed to check activity.
+			as_node* node = as_node_load(&local_nodes[node_index]);
 
-			if (! active) {
+			if (! node || ! as_node_is_active(node)) {
 				continue;
 			}
 
-			as_node* node = as_node_load(&local_nodes[node_index]);
-
 			// Avoid retrying on node where command failed even if node is the
 			// only one on the same rack. The contents of prev_node may have
 			// already been destroyed, so just use pointer comparison and never
@@ -635,7 +716,10 @@ as_shm_get_replica_rack(
 
 			// Rack ids may be different per namespace. A rack id of -1 indicates all ids are
 			// stored on the local node because there is not enough node shared memory to cover
-			// this case. Check rack id on node's shared memory first.
+			// this case. Check rack id on node's shared memory first. The rack id is a single
+			// word written atomically by the tender, so it is read without the node lock.
+			int rack_id = (int)as_load_uint32((uint32_t*)&nodes_shm[node_index].rack_id);
+
 			if (rack_id == search_id || (rack_id == -1 && as_node_has_rack(node, ns, search_id))) {
 				// Found node on same rack.
 				return node;
@@ -663,6 +747,58 @@ as_shm_get_replica_rack(
 	return NULL;
 }
 
+uint32_t
+as_partition_shm_get_rack_nodes(
+	as_cluster* cluster, const char* ns, as_partition_shm* p, uint8_t replica_size,
+	uint8_t replica_index, as_node** nodes
+	)
+{
+	as_node** local_nodes = cluster->shm_info->local_nodes;
+	as_node_shm* nodes_shm = cluster->shm_info->cluster_shm->nodes;
+	uint32_t replica_max = replica_size;
+
+	if (replica_max > AS_MAX_REPLICATION_FACTOR) {
+		replica_max = AS_MAX_REPLICATION_FACTOR;
+	}
+
+	as_vector* rack_ids = as_rack_ids_load(&cluster->rack_ids);
+	int* ids = rack_ids->list;
+	uint32_t rack_max = rack_ids->size;
+
+	for (uint32_t i = 0; i < rack_max; i++) {
+		int search_id = ids[i];
+		uint32_t seq = replica_index;
+		uint32_t count = 0;
+
+		for (uint32_t j = 0; j < replica_max; j++, seq++) {
+			uint32_t node_index = as_load_uint32_acq(&p->nodes[seq % replica_max]);
+
+			// node_index starts at one (zero indicates unset).
+			if (! node_index) {
+				continue;
+			}
+			node_index--;
+
+			as_node* node = as_node_load(&local_nodes[node_index]);
+
+			if (! node || ! as_node_is_active(node)) {
+				continue;
+			}
+
+			int rack_id = (int)as_load_uint32((uint32_t*)&nodes_shm[node_index].rack_id);
+
+			if (rack_id == search_id || (rack_id == -1 && as_node_has_rack(node, ns, search_id))) {
+				nodes[count++] = node;
+			}
+		}
+
+		if (count > 0) {
+			return count;
+		}
+	}
+	return 0;
+}
+
 as_node*
 as_partition_shm_get_node(
 	as_cluster* cluster, const char* ns, as_partition_shm* p, as_node* prev_node,
@@ -679,6 +815,10 @@ as_partition_shm_get_node(
 			return as_shm_get_replica_rack(cluster, local_nodes, ns, p, prev_node, replica_size,
 				replica_index);
 
+		case AS_POLICY_REPLICA_LOWEST_LATENCY:
+			return as_shm_get_replica_latency(local_nodes, p, prev_node, replica_size,
+				replica_index);
+
 		// The remaining replica algorithms use replica_index as the starting point
 		// and iterate till a valid node is found.
 		default:
@@ -719,13 +859,104 @@ as_shm_takeover_cluster(
 {
 	as_log_info("Take over shared memory cluster: %u", pid);
 	as_store_uint32(&cluster_shm->owner_pid, pid);
+
+	// Another process may have updated shared memory partition maps since this process
+	// last tended, so the next partition map update must apply all partitions.
+	as_nodes* nodes = as_nodes_reserve(cluster);
+
+	for (uint32_t i = 0; i < nodes->size; i++) {
+		nodes->array[i]->partition_bitmaps_reset = true;
+	}
+	as_nodes_release(nodes);
+
 	shm_info->is_tend_master = true;
+	as_incr_uint32(&cluster_shm->tender_gen);
 
 	if (cluster->rack_aware) {
 		as_shm_reset_rebalance_gen(shm_info, cluster_shm);
 	}
 }
 
+static void
+as_shm_tender_mutex_init(as_cluster_shm* cluster_shm)
+{
+#if defined(__linux__)
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+
+	int rv = pthread_mutex_init(&cluster_shm->tender_mutex, &attr);
+
+	pthread_mutexattr_destroy(&attr);
+
+	if (rv == 0) {
+		as_store_uint8_rls(&cluster_shm->tender_mutex_ready, 1);
+	}
+	else {
+		as_log_warn("Failed to initialize shared memory tender mutex: %d", rv);
+	}
+#endif
+}
+
+static void
+as_shm_tender_mutex_lock(as_shm_info* shm_info, as_cluster_shm* cluster_shm)
+{
+#if defined(__linux__)
+	if (shm_info->tender_mutex_held || ! as_load_uint8_acq(&cluster_shm->tender_mutex_ready)) {
+		return;
+	}
+
+	int rv = pthread_mutex_lock(&cluster_shm->tender_mutex);
+
+	if (rv == EOWNERDEAD) {
+		// Previous holder died. This process is already the tend owner.
+		pthread_mutex_consistent(&cluster_shm->tender_mutex);
+		rv = 0;
+	}
+	shm_info->tender_mutex_held = (rv == 0);
+#endif
+}
+
+static void
+as_shm_tender_mutex_unlock(as_shm_info* shm_info, as_cluster_shm* cluster_shm)
+{
+#if defined(__linux__)
+	if (shm_info->tender_mutex_held) {
+		shm_info->tender_mutex_held = false;
+		pthread_mutex_unlock(&cluster_shm->tender_mutex);
+	}
+#endif
+}
+
+/**
+ * Return true if the tender mutex holder died without releasing it. The mutex is then held
+ * by this thread.
+ */
+static bool
+as_shm_tender_mutex_orphaned(as_shm_info* shm_info, as_cluster_shm* cluster_shm)
+{
+#if defined(__linux__)
+	if (! as_load_uint8_acq(&cluster_shm->tender_mutex_ready)) {
+		return false;
+	}
+
+	int rv = pthread_mutex_trylock(&cluster_shm->tender_mutex);
+
+	if (rv == EOWNERDEAD) {
+		pthread_mutex_consistent(&cluster_shm->tender_mutex);
+		shm_info->tender_mutex_held = true;
+		return true;
+	}
+
+	if (rv == 0) {
+		// Tend owner has not locked the mutex yet or is in the process of releasing it.
+		pthread_mutex_unlock(&cluster_shm->tender_mutex);
+	}
+#endif
+	return false;
+}
+
 static bool
 as_process_exists(uint32_t pid)
 {
@@ -742,6 +973,76 @@ as_process_exists(uint32_t pid)
 #endif
 }
 
+bool
+as_shm_metrics_active(as_process_metrics_shm* pm)
+{
+	uint32_t pid = as_load_uint32(&pm->pid);
+	return pid != 0 && as_process_exists(pid);
+}
+
+static void
+as_shm_metrics_claim(
+	as_shm_info* shm_info, as_cluster_shm* cluster_shm, uint32_t slot_size, uint32_t pid
+	)
+{
+	if (! as_load_uint8_acq(&cluster_shm->ready)) {
+		return;
+	}
+
+	if (cluster_shm->metrics_capacity == 0 || cluster_shm->metrics_slot_size != slot_size) {
+		as_log_warn("Existing shared memory metrics slot size %u is not compatible with %u. "
+			"Shared memory metrics are disabled for process: %u",
+			cluster_shm->metrics_slot_size, slot_size, pid);
+		return;
+	}
+
+	for (uint32_t i = 0; i < cluster_shm->metrics_capacity; i++) {
+		as_process_metrics_shm* pm = as_shm_get_metrics(cluster_shm, i);
+		uint32_t owner = as_load_uint32(&pm->pid);
+
+		if (owner != 0 && as_process_exists(owner)) {
+			continue;
+		}
+
+		if (! as_cas_uint32(&pm->pid, owner, pid)) {
+			continue;
+		}
+
+		if (owner != 0) {
+			// Previous owner died and may have died while holding the slot lock.
+			memset(&pm->lock, 0, sizeof(as_swlock));
+		}
+
+		as_swlock_write_lock(&pm->lock);
+		pm->nodes_size = 0;
+		pm->timestamp = 0;
+		pm->command_count = 0;
+		pm->retry_count = 0;
+		pm->delay_queue_timeout_count = 0;
+		as_swlock_write_unlock(&pm->lock);
+
+		as_log_info("Claim shared memory metrics slot %u: %u", i, pid);
+		shm_info->metrics = pm;
+		return;
+	}
+	as_log_warn("Shared memory metrics slots are full. Metrics are not shared for process: %u",
+		pid);
+}
+
+static void
+as_shm_metrics_release(as_shm_info* shm_info)
+{
+	as_process_metrics_shm* pm = shm_info->metrics;
+
+	if (pm) {
+		shm_info->metrics = NULL;
+		as_swlock_write_lock(&pm->lock);
+		pm->nodes_size = 0;
+		as_swlock_write_unlock(&pm->lock);
+		as_store_uint32_rls(&pm->pid, 0);
+	}
+}
+
 static void*
 as_shm_tender(void* userdata)
 {
@@ -763,6 +1064,7 @@ as_shm_tender(void* userdata)
 	uint32_t pid = getpid();
 	uint32_t nodes_gen = 0;
 	uint32_t rebalance_gen = 0;
+	uint32_t tender_gen = as_load_uint32(&cluster_shm->tender_gen);
 
 	struct timespec delta;
 	cf_clock_set_timespec_ms(cluster->tend_interval, &delta);
@@ -776,6 +1078,9 @@ as_shm_tender(void* userdata)
 	
 	while (cluster->valid) {
 		if (shm_info->is_tend_master) {
+			// Hold tender mutex while tending, so followers are notified if this process dies.
+			as_shm_tender_mutex_lock(shm_info, cluster_shm);
+
 			// Tend shared memory cluster.
 			status = as_cluster_tend(cluster, &err, false);
 			as_store_uint64(&cluster_shm->timestamp, cf_getms());
@@ -792,6 +1097,25 @@ as_shm_tender(void* userdata)
 				continue;
 			}
 			
+			// Check if tend owner died while holding the tender mutex.
+			if (as_shm_tender_mutex_orphaned(shm_info, cluster_shm)) {
+				as_spinlock_lock(&cluster_shm->take_over_lock);
+
+				// Another follower may have taken over already.
+				uint32_t owner_pid = as_load_uint32(&cluster_shm->owner_pid);
+
+				if (owner_pid == 0 || !as_process_exists(owner_pid)) {
+					as_store_uint64(&cluster_shm->timestamp, cf_getms());
+					as_store_uint8(&cluster_shm->lock, 1);
+					as_store_uint32(&cluster_shm->owner_pid, pid);
+					as_spinlock_unlock(&cluster_shm->take_over_lock);
+					as_shm_takeover_cluster(cluster, shm_info, cluster_shm, pid);
+					continue;
+				}
+				as_spinlock_unlock(&cluster_shm->take_over_lock);
+				as_shm_tender_mutex_unlock(shm_info, cluster_shm);
+			}
+
 			// Check if tend owner died without releasing lock.
 			uint64_t now = cf_getms();
 			if (now >= limit) {
@@ -826,7 +1150,17 @@ as_shm_tender(void* userdata)
 			}
 			
 			// Synchronize local cluster with shared memory cluster.
-			uint32_t gen = as_load_uint32(&cluster_shm->nodes_gen);
+			uint32_t gen = as_load_uint32(&cluster_shm->tender_gen);
+
+			if (tender_gen != gen) {
+				// New tend owner. Refresh all local state from shared memory now.
+				tender_gen = gen;
+				nodes_gen = 0;
+				rebalance_gen = 0;
+				limit = 0;
+			}
+
+			gen = as_load_uint32(&cluster_shm->nodes_gen);
 			
 			if (nodes_gen != gen) {
 				nodes_gen = gen;
@@ -862,6 +1196,7 @@ as_shm_tender(void* userdata)
 		shm_info->is_tend_master = false;
 		as_store_uint8_rls(&cluster_shm->lock, 0);
 	}
+	as_shm_tender_mutex_unlock(shm_info, cluster_shm);
 	return 0;
 }
 
@@ -891,22 +1226,63 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 	// even before seeds have been validated.
 	// Hard code value for now.
 	cluster->n_partitions = 4096;
-	
-	uint32_t size = sizeof(as_cluster_shm) + (sizeof(as_node_shm) * config->shm_max_nodes) +
-		((sizeof(as_partition_table_shm) + (sizeof(as_partition_shm) * cluster->n_partitions)) *
-		config->shm_max_namespaces);
+
+	// Start partition tables on a cache line boundary. Table headers are padded to a cache
+	// line, so partitions never straddle cache lines.
+	uint32_t pt_offset = as_shm_align(sizeof(as_cluster_shm) +
+		(sizeof(as_node_shm) * config->shm_max_nodes));
+	uint32_t pt_size = sizeof(as_partition_table_shm) +
+		(sizeof(as_partition_shm) * cluster->n_partitions);
+	uint32_t size = pt_offset + (pt_size * config->shm_max_namespaces);
+
+	// Process metrics slots follow the partition tables.
+	uint32_t mt_offset = as_shm_align(size);
+	uint32_t mt_node_size = sizeof(as_node_metrics_shm) +
+		(sizeof(as_ns_metrics_shm) * config->shm_max_namespaces);
+	uint32_t mt_size = sizeof(as_process_metrics_shm) + (mt_node_size * config->shm_max_nodes);
+
+	if (config->shm_metrics_slots > 0) {
+		size = mt_offset + (mt_size * config->shm_metrics_slots);
+	}
 	
 	uint32_t pid = getpid();
 
 #if !defined(_MSC_VER)
 	// Create shared memory segment.  Only one process will succeed.
-	int id = shmget(config->shm_key, size, IPC_CREAT | IPC_EXCL | 0666);
+	int id = -1;
+	bool exists = false;
+	bool created = false;
+
+#if defined(__linux__)
+	if (config->shm_huge_pages) {
+		// Huge page segments must be a multiple of the huge page size.
+		size_t huge_size = as_shm_get_huge_page_size();
+		size_t huge_total = (size + huge_size - 1) / huge_size * huge_size;
+
+		id = shmget(config->shm_key, huge_total, IPC_CREAT | IPC_EXCL | SHM_HUGETLB | 0666);
+
+		if (id < 0) {
+			if (errno == EEXIST) {
+				exists = true;
+			}
+			else {
+				as_log_warn("Shared memory huge pages are not available: %s. Use regular pages.",
+					strerror(errno));
+			}
+		}
+	}
+#endif
+
+	if (id < 0 && ! exists) {
+		id = shmget(config->shm_key, size, IPC_CREAT | IPC_EXCL | 0666);
+	}
 
 	if (id >= 0) {
 		// Exclusive shared memory lock succeeded. shmget docs say shared memory create initializes
 		// memory to zero, so memset is not necessary.
 		// memset(cluster_shm, 0, size);
 		as_log_info("Create shared memory cluster: %u", pid);
+		created = true;
 	}
 	else if (errno == EEXIST) {
 		// Some other process has created shared memory.  Use that shared memory.
@@ -990,12 +1366,21 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 	}
 #endif
 
+#if !defined(_MSC_VER)
+	if (created) {
+		// Creator initializes tender mutex before any process uses it.
+		as_shm_tender_mutex_init(cluster_shm);
+	}
+#endif
+
 	// Initialize local data.
 	as_shm_info* shm_info = cf_malloc(sizeof(as_shm_info));
 	shm_info->local_nodes = cf_calloc(config->shm_max_nodes, sizeof(as_node*));
 	shm_info->cluster_shm = cluster_shm;
 	shm_info->shm_id = id;
 	shm_info->takeover_threshold_ms = config->shm_takeover_threshold_sec * 1000;
+	shm_info->tender_mutex_held = false;
+	shm_info->metrics = NULL;
 	shm_info->is_tend_master = as_cas_uint8(&cluster_shm->lock, 0, 1);
 	cluster->shm_info = shm_info;
 
@@ -1004,9 +1389,6 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 		as_store_uint64(&cluster_shm->timestamp, cf_getms());
 		as_store_uint32(&cluster_shm->owner_pid, pid);
 
-		uint32_t pt_offset = sizeof(as_cluster_shm) + (sizeof(as_node_shm) * config->shm_max_nodes);
-		uint32_t pt_size = sizeof(as_partition_table_shm) + (sizeof(as_partition_shm) * cluster->n_partitions);
-
 		// Ensure shared memory cluster is fully initialized.
 		if (as_load_uint8_acq(&cluster_shm->ready)) {
 			as_log_info("Cluster already initialized: %u", pid);
@@ -1042,6 +1424,15 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 			cluster_shm->partition_tables_offset = pt_offset;
 			cluster_shm->partition_table_byte_size = pt_size;
 
+			if (config->shm_metrics_slots > 0) {
+				cluster_shm->metrics_capacity = config->shm_metrics_slots;
+				cluster_shm->metrics_offset = mt_offset;
+				cluster_shm->metrics_slot_size = mt_size;
+				cluster_shm->metrics_node_size = mt_node_size;
+				cluster_shm->metrics_nodes_capacity = config->shm_max_nodes;
+				cluster_shm->metrics_ns_capacity = config->shm_max_namespaces;
+			}
+
 			as_status status = as_cluster_init(cluster, err);
 			
 			if (status != AEROSPIKE_OK) {
@@ -1060,10 +1451,26 @@ as_shm_create(as_cluster* cluster, as_error* err, as_config* config)
 			as_shm_wait_till_ready(cluster, cluster_shm, pid);
 		}
 
+		// Partition tables are located with the master's offset and size, so only the
+		// table layout needs to match.
+		if (as_load_uint8_acq(&cluster_shm->ready) &&
+			cluster_shm->partition_table_byte_size != pt_size) {
+			as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Existing shared memory partition table size %u is not compatible with %u. "
+				"Stop client processes and ensure shared memory is removed before "
+				"attempting new configuration", cluster_shm->partition_table_byte_size, pt_size);
+			as_shm_destroy(cluster);
+			return err->code;
+		}
+
 		// Copy shared memory nodes to local nodes.
 		as_shm_reset_nodes(cluster);
 		as_cluster_add_seeds(cluster);
 	}
+
+	if (config->shm_metrics_slots > 0) {
+		as_shm_metrics_claim(shm_info, cluster_shm, mt_size, pid);
+	}
 	cluster->valid = true;
 	
 	// Run tending thread which handles both master and prole tending.
@@ -1094,6 +1501,8 @@ as_shm_destroy(as_cluster* cluster)
 		return;
 	}
 
+	as_shm_metrics_release(shm_info);
+
 #if !defined(_MSC_VER)
 	// Detach shared memory.
 	shmdt(shm_info->cluster_shm);
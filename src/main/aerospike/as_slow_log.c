@@ -0,0 +1,99 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_slow_log.h>
+#include <aerospike/as_atomic.h>
+#include <citrusleaf/alloc.h>
+#include <string.h>
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_slow_log*
+as_slow_log_create(uint32_t threshold_ms, uint32_t capacity)
+{
+	uint32_t size = 1;
+
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	size_t alloc_size = sizeof(as_slow_log) + sizeof(as_slow_log_cell) * size;
+	as_slow_log* log = cf_malloc(alloc_size);
+	memset(log, 0, alloc_size);
+	log->threshold_ns = (uint64_t)threshold_ms * 1000 * 1000;
+	log->mask = size - 1;
+	return log;
+}
+
+void
+as_slow_log_destroy(as_slow_log* log)
+{
+	cf_free(log);
+}
+
+void
+as_slow_log_add(as_slow_log* log, const as_slow_command* cmd)
+{
+	uint64_t pos = as_faa_uint64(&log->head, 1);
+	as_slow_log_cell* cell = &log->cells[pos & log->mask];
+
+	// An odd sequence marks the cell as being written.
+	as_store_uint64(&cell->seq, pos * 2 + 1);
+	as_fence_rls();
+	memcpy(&cell->cmd, cmd, sizeof(as_slow_command));
+	as_store_uint64_rls(&cell->seq, pos * 2 + 2);
+}
+
+uint32_t
+as_slow_log_read(as_slow_log* log, uint64_t* cursor, as_slow_command* out, uint32_t max)
+{
+	uint64_t head = as_load_uint64_acq(&log->head);
+	uint64_t capacity = (uint64_t)log->mask + 1;
+	uint64_t pos = *cursor;
+
+	if (head - pos > capacity) {
+		// Oldest entries were overwritten.
+		pos = head - capacity;
+	}
+
+	uint32_t count = 0;
+
+	while (pos < head && count < max) {
+		as_slow_log_cell* cell = &log->cells[pos & log->mask];
+		uint64_t seq = pos * 2 + 2;
+		uint64_t cur = as_load_uint64_acq(&cell->seq);
+
+		if (cur < seq) {
+			// Entry is still being written. Read it on the next call.
+			break;
+		}
+
+		if (cur == seq) {
+			memcpy(&out[count], &cell->cmd, sizeof(as_slow_command));
+			as_fence_acq();
+
+			// Discard entry if a writer started overwriting the cell during the copy.
+			if (as_load_uint64(&cell->seq) == seq) {
+				count++;
+			}
+		}
+		pos++;
+	}
+	*cursor = pos;
+	return count;
+}
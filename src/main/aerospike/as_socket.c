@@ -29,6 +29,7 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 
 #define AS_EINTR EINTR
 
@@ -137,7 +138,54 @@ as_socket_create_fd(int family, as_socket_fd* fdp)
 }
 
 int
-as_socket_create(as_socket* sock, int family, as_tls_context* ctx, const char* tls_name)
+as_socket_set_options(as_socket_fd fd, const as_socket_options* options)
+{
+	if (! options->tcp_no_delay) {
+		int f = 0;
+		if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&f, sizeof(f)) < 0) {
+			return -6;
+		}
+	}
+
+	if (options->send_buffer_size > 0) {
+		int size = (int)options->send_buffer_size;
+		if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const char*)&size, sizeof(size)) < 0) {
+			return -7;
+		}
+	}
+
+	if (options->recv_buffer_size > 0) {
+		int size = (int)options->recv_buffer_size;
+		if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&size, sizeof(size)) < 0) {
+			return -8;
+		}
+	}
+
+#if defined(TCP_USER_TIMEOUT)
+	if (options->tcp_user_timeout_ms > 0) {
+		unsigned int ms = options->tcp_user_timeout_ms;
+		if (setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &ms, sizeof(ms)) < 0) {
+			return -9;
+		}
+	}
+#endif
+
+#if defined(TCP_QUICKACK)
+	if (options->tcp_quick_ack) {
+		int f = 1;
+		if (setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &f, sizeof(f)) < 0) {
+			return -10;
+		}
+	}
+#endif
+	return 0;
+}
+
+int
+as_socket_create(
+	as_socket* sock, int family, const as_socket_options* options, as_tls_context* ctx,
+	const char* tls_name
+	)
 {
 	as_socket_fd fd;
 	int rv = as_socket_create_fd(family, &fd);
@@ -145,6 +193,15 @@ as_socket_create(as_socket* sock, int family, as_tls_context* ctx, const char* t
 	if (rv != 0) {
 		return rv;
 	}
+
+	if (options) {
+		rv = as_socket_set_options(fd, options);
+
+		if (rv != 0) {
+			as_close(fd);
+			return rv;
+		}
+	}
 	
 	if (! as_socket_wrap(sock, family, fd, ctx, tls_name)) {
 		return -5;
@@ -160,6 +217,7 @@ as_socket_wrap(as_socket* sock, int family, as_socket_fd fd, as_tls_context* ctx
 	sock->family = family;
 #endif
 	sock->last_used = 0;
+	sock->validated = 0;
 
 	if (ctx) {
 		if (as_tls_wrap(ctx, sock, tls_name) < 0) {
@@ -194,10 +252,13 @@ as_socket_start_connect(as_socket* sock, struct sockaddr* addr, uint64_t deadlin
 }
 
 as_status
-as_socket_create_and_connect(as_socket* sock, as_error* err, struct sockaddr* addr, as_tls_context* ctx, const char* tls_name, uint64_t deadline_ms)
+as_socket_create_and_connect(
+	as_socket* sock, as_error* err, struct sockaddr* addr, const as_socket_options* options,
+	as_tls_context* ctx, const char* tls_name, uint64_t deadline_ms
+	)
 {
 	// Create the socket.
-	int rv = as_socket_create(sock, addr->sa_family, ctx, tls_name);
+	int rv = as_socket_create(sock, addr->sa_family, options, ctx, tls_name);
 	
 	if (rv < 0) {
 		char name[AS_IP_ADDRESS_SIZE];
@@ -330,7 +391,7 @@ as_socket_write_deadline(
 
 	do {
 		if (deadline > 0) {
-			uint64_t now = cf_getms();
+			uint64_t now = as_clock_getms();
 
 			if (now >= deadline) {
 				// Timeout.  Do not set error string to avoid affecting performance.
@@ -401,39 +462,172 @@ as_socket_write_deadline(
 }
 
 as_status
-as_socket_read_deadline(
-	as_error* err, as_socket* sock, as_node* node, uint8_t *buf, size_t buf_len,
+as_socket_writev_deadline(
+	as_error* err, as_socket* sock, struct as_node_s* node, as_socket_iov* iov, uint32_t iov_count,
 	uint32_t socket_timeout, uint64_t deadline
 	)
 {
-	if (sock->ctx) {
-		as_status status = AEROSPIKE_OK;
-		int rv = as_tls_read(sock, buf, buf_len, socket_timeout, deadline);
+#if !defined(_MSC_VER)
+	if (! sock->ctx) {
+		struct iovec vec[AS_SOCKET_IOV_MAX];
 
-		if (rv < 0) {
-			status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "TLS read error", rv);
-		}
-		else if (rv == 1) {
-			// Do not set error string to avoid affecting performance.
-			// Calling functions usually retry, so the error string is
-			// not used anyway.
-			status = err->code = AEROSPIKE_ERR_TIMEOUT;
-			err->message[0] = 0;
+		for (uint32_t i = 0; i < iov_count; i++) {
+			vec[i].iov_base = iov[i].data;
+			vec[i].iov_len = iov[i].size;
 		}
+
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = vec;
+		msg.msg_iovlen = iov_count;
+
+		as_poll poll;
+		as_poll_init(&poll, sock->fd);
+
+		as_status status = AEROSPIKE_OK;
+		uint32_t timeout;
+
+		do {
+			if (deadline > 0) {
+				uint64_t now = as_clock_getms();
+
+				if (now >= deadline) {
+					// Timeout.  Do not set error string to avoid affecting performance.
+					// Calling functions usually retry, so the error string is not used anyway.
+					status = err->code = AEROSPIKE_ERR_TIMEOUT;
+					err->message[0] = 0;
+					break;
+				}
+
+				timeout = (uint32_t)(deadline - now);
+
+				if (socket_timeout > 0 && socket_timeout < timeout) {
+					timeout = socket_timeout;
+				}
+			}
+			else {
+				timeout = socket_timeout;
+			}
+
+			int rv = as_poll_socket(&poll, sock->fd, timeout, false);
+
+			if (rv > 0) {
+#if defined(__linux__)
+				ssize_t w_bytes = sendmsg(sock->fd, &msg, MSG_NOSIGNAL);
+#else
+				ssize_t w_bytes = sendmsg(sock->fd, &msg, 0);
+#endif
+
+				if (w_bytes > 0) {
+					// Skip fully written segments and advance into a partially written one.
+					size_t n = (size_t)w_bytes;
+
+					while (msg.msg_iovlen > 0 && n >= msg.msg_iov->iov_len) {
+						n -= msg.msg_iov->iov_len;
+						msg.msg_iov++;
+						msg.msg_iovlen--;
+					}
+
+					if (n > 0) {
+						msg.msg_iov->iov_base = (uint8_t*)msg.msg_iov->iov_base + n;
+						msg.msg_iov->iov_len -= n;
+					}
+				}
+				else if (w_bytes == 0) {
+					// We shouldn't see 0 returned unless we try to write 0 bytes, which we don't.
+					status = as_error_set_message(err, AEROSPIKE_ERR_CONNECTION, "Bad file descriptor");
+					break;
+				}
+				else {
+					int e = as_last_error();
+					if (as_socket_is_error(e)) {
+						status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket write error", e);
+						break;
+					}
+				}
+			}
+			else if (rv == 0) {
+				// Timeout.  Do not set error string to avoid affecting performance.
+				// Calling functions usually retry, so the error string is not used anyway.
+				status = err->code = AEROSPIKE_ERR_TIMEOUT;
+				err->message[0] = 0;
+				break;
+			}
+			else if (rv == -1) {
+				int e = as_last_error();
+				if (e != AS_EINTR || as_socket_stop_on_interrupt) {
+					status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket write error", e);
+					break;
+				}
+			}
+		} while (msg.msg_iovlen > 0);
+
+		as_poll_destroy(&poll);
 		return status;
 	}
+#endif
+
+	// TLS and windows sockets write each segment in turn.
+	for (uint32_t i = 0; i < iov_count; i++) {
+		as_status status = as_socket_write_deadline(err, sock, node, iov[i].data, iov[i].size,
+			socket_timeout, deadline);
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static as_status
+as_socket_read_fd(
+	as_error* err, as_socket* sock, as_node* node, uint8_t *buf, size_t min_len, size_t buf_len,
+	uint32_t socket_timeout, uint64_t deadline, uint32_t spin_us, size_t* read_len
+	)
+{
+	size_t pos = 0;
+
+	if (spin_us > 0) {
+		// Spin on non-blocking reads before waiting in poll().
+		uint64_t limit = cf_getns() + (uint64_t)spin_us * 1000;
+
+		do {
+#if !defined(_MSC_VER)
+			int r_bytes = (int)read(sock->fd, buf + pos, buf_len - pos);
+#else
+			int r_bytes = (int)recv(sock->fd, buf + pos, (int)(buf_len - pos), 0);
+#endif
+
+			if (r_bytes > 0) {
+				pos += r_bytes;
+
+				if (pos >= min_len) {
+					*read_len = pos;
+					return AEROSPIKE_OK;
+				}
+			}
+			else if (r_bytes == 0) {
+				// We believe this means that the server has closed this socket.
+				return as_error_set_message(err, AEROSPIKE_ERR_CONNECTION, "Bad file descriptor");
+			}
+			else {
+				int e = as_last_error();
+				if (as_socket_is_error(e)) {
+					return as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "Socket read error", e);
+				}
+			}
+		} while (cf_getns() < limit);
+	}
 
 	as_poll poll;
 	as_poll_init(&poll, sock->fd);
 
-	size_t pos = 0;
 	as_status status = AEROSPIKE_OK;
 	uint32_t timeout;
-	//int try = 0;
 
-	do {
+	while (pos < min_len) {
 		if (deadline > 0) {
-			uint64_t now = cf_getms();
+			uint64_t now = as_clock_getms();
 
 			if (now >= deadline) {
 				// Timeout.  Do not set error string to avoid affecting performance.
@@ -492,11 +686,69 @@ as_socket_read_deadline(
 				break;
 			}
 		}
-	
-		//try++;
-	
-	} while (pos < buf_len);
+	}
 
 	as_poll_destroy(&poll);
+	*read_len = pos;
 	return status;
 }
+
+as_status
+as_socket_read_ahead_deadline(
+	as_error* err, as_socket* sock, as_node* node, uint8_t *buf, size_t min_len, size_t buf_len,
+	uint32_t socket_timeout, uint64_t deadline, uint32_t spin_us, size_t* read_len
+	)
+{
+	if (sock->ctx) {
+		as_status status = AEROSPIKE_OK;
+		int rv = as_tls_read_ahead(sock, buf, min_len, buf_len, socket_timeout, deadline, read_len);
+
+		if (rv < 0) {
+			status = as_socket_error(sock->fd, node, err, AEROSPIKE_ERR_CONNECTION, "TLS read error", rv);
+		}
+		else if (rv == 1) {
+			// Do not set error string to avoid affecting performance.
+			// Calling functions usually retry, so the error string is
+			// not used anyway.
+			status = err->code = AEROSPIKE_ERR_TIMEOUT;
+			err->message[0] = 0;
+		}
+		return status;
+	}
+
+	return as_socket_read_fd(err, sock, node, buf, min_len, buf_len, socket_timeout, deadline,
+		spin_us, read_len);
+}
+
+as_status
+as_socket_read_deadline(
+	as_error* err, as_socket* sock, as_node* node, uint8_t *buf, size_t buf_len,
+	uint32_t socket_timeout, uint64_t deadline
+	)
+{
+	size_t read_len;
+	return as_socket_read_ahead_deadline(err, sock, node, buf, buf_len, buf_len, socket_timeout,
+		deadline, 0, &read_len);
+}
+
+as_status
+as_socket_read_spin_deadline(
+	as_error* err, as_socket* sock, as_node* node, uint8_t *buf, size_t buf_len,
+	uint32_t socket_timeout, uint64_t deadline, uint32_t spin_us
+	)
+{
+	size_t read_len;
+	return as_socket_read_ahead_deadline(err, sock, node, buf, buf_len, buf_len, socket_timeout,
+		deadline, spin_us, &read_len);
+}
+
+int
+as_socket_set_busy_poll(as_socket_fd fd, uint32_t busy_poll_us)
+{
+#if defined(SO_BUSY_POLL)
+	int value = (int)busy_poll_us;
+	return setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value));
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_sync_async.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_event.h>
+#include <pthread.h>
+
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	as_error* err;
+	as_record* rec;
+	as_status status;
+	bool done;
+} as_sync_waiter;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static inline void
+as_sync_waiter_init(as_sync_waiter* w, as_error* err)
+{
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_cond_init(&w->cond, NULL);
+	w->err = err;
+	w->rec = NULL;
+	w->status = AEROSPIKE_OK;
+	w->done = false;
+}
+
+static void
+as_sync_waiter_complete(as_sync_waiter* w, as_error* err, as_record* rec)
+{
+	pthread_mutex_lock(&w->lock);
+
+	if (err) {
+		as_error_copy(w->err, err);
+		w->status = err->code;
+	}
+	w->rec = rec;
+	w->done = true;
+
+	// The waiter lives on the caller's stack and may be released as soon as the lock is
+	// released, so do not access it after unlocking.
+	pthread_cond_signal(&w->cond);
+	pthread_mutex_unlock(&w->lock);
+}
+
+static as_status
+as_sync_waiter_wait(as_sync_waiter* w, as_status status)
+{
+	if (status == AEROSPIKE_OK) {
+		pthread_mutex_lock(&w->lock);
+
+		while (! w->done) {
+			pthread_cond_wait(&w->cond, &w->lock);
+		}
+		pthread_mutex_unlock(&w->lock);
+		status = w->status;
+	}
+	// Otherwise, the command was not queued and the listener will not be called.
+
+	pthread_cond_destroy(&w->cond);
+	pthread_mutex_destroy(&w->lock);
+	return status;
+}
+
+static void
+as_sync_write_listener(as_error* err, void* udata, as_event_loop* event_loop)
+{
+	as_sync_waiter_complete(udata, err, NULL);
+}
+
+static void
+as_sync_record_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	as_sync_waiter_complete(udata, err, rec);
+}
+
+static void
+as_sync_pipe_listener(void* udata, as_event_loop* event_loop)
+{
+	// Callers submit their next command from their own thread, so there is nothing to start.
+}
+
+static inline as_pipe_listener
+as_sync_pipe(aerospike* as)
+{
+	return as->cluster->sync_over_async_pipeline ? as_sync_pipe_listener : NULL;
+}
+
+static inline const as_policy_read*
+as_sync_policy_read(aerospike* as, const as_policy_read* policy, as_policy_read* copy)
+{
+	// Heap records are owned by the listener, so they can be handed to the caller.
+	as_policy_read_copy(policy ? policy : &aerospike_load_config(as)->policies.read, copy);
+	copy->async_heap_rec = true;
+	return copy;
+}
+
+static as_status
+as_sync_record_result(as_sync_waiter* w, as_status status, as_record** rec)
+{
+	status = as_sync_waiter_wait(w, status);
+
+	if (w->rec) {
+		if (status == AEROSPIKE_OK && rec) {
+			*rec = w->rec;
+		}
+		else {
+			as_record_destroy(w->rec);
+		}
+	}
+	return status;
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+bool
+as_sync_async_can_wait(void)
+{
+	if (as_event_loop_size == 0) {
+		return false;
+	}
+
+	pthread_t self = pthread_self();
+
+	for (uint32_t i = 0; i < as_event_loop_size; i++) {
+		if (pthread_equal(as_event_loops[i].thread, self)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+as_status
+as_sync_async_get(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
+	)
+{
+	as_policy_read copy;
+	policy = as_sync_policy_read(as, policy, &copy);
+
+	as_sync_waiter w;
+	as_sync_waiter_init(&w, err);
+
+	as_status status = aerospike_key_get_async(as, err, policy, key, as_sync_record_listener,
+		&w, NULL, as_sync_pipe(as));
+
+	return as_sync_record_result(&w, status, rec);
+}
+
+as_status
+as_sync_async_select(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key,
+	const char* bins[], as_record** rec
+	)
+{
+	as_policy_read copy;
+	policy = as_sync_policy_read(as, policy, &copy);
+
+	as_sync_waiter w;
+	as_sync_waiter_init(&w, err);
+
+	as_status status = aerospike_key_select_async(as, err, policy, key, bins,
+		as_sync_record_listener, &w, NULL, as_sync_pipe(as));
+
+	return as_sync_record_result(&w, status, rec);
+}
+
+as_status
+as_sync_async_exists(
+	aerospike* as, as_error* err, const as_policy_read* policy, const as_key* key, as_record** rec
+	)
+{
+	as_policy_read copy;
+	policy = as_sync_policy_read(as, policy, &copy);
+
+	as_sync_waiter w;
+	as_sync_waiter_init(&w, err);
+
+	as_status status = aerospike_key_exists_async(as, err, policy, key, as_sync_record_listener,
+		&w, NULL, as_sync_pipe(as));
+
+	status = as_sync_record_result(&w, status, rec);
+
+	if (status != AEROSPIKE_OK && rec) {
+		*rec = NULL;
+	}
+	return status;
+}
+
+as_status
+as_sync_async_put(
+	aerospike* as, as_error* err, const as_policy_write* policy, const as_key* key, as_record* rec
+	)
+{
+	as_sync_waiter w;
+	as_sync_waiter_init(&w, err);
+
+	// The record is serialized into the command buffer before the async call returns.
+	as_status status = aerospike_key_put_async(as, err, policy, key, rec, as_sync_write_listener,
+		&w, NULL, as_sync_pipe(as));
+
+	return as_sync_waiter_wait(&w, status);
+}
+
+as_status
+as_sync_async_remove(
+	aerospike* as, as_error* err, const as_policy_remove* policy, const as_key* key
+	)
+{
+	as_sync_waiter w;
+	as_sync_waiter_init(&w, err);
+
+	as_status status = aerospike_key_remove_async(as, err, policy, key, as_sync_write_listener,
+		&w, NULL, as_sync_pipe(as));
+
+	return as_sync_waiter_wait(&w, status);
+}
+
+as_status
+as_sync_async_operate(
+	aerospike* as, as_error* err, const as_policy_operate* policy, const as_key* key,
+	const as_operations* ops, as_record** rec
+	)
+{
+	as_policy_operate copy;
+	as_policy_operate_copy(policy ? policy : &aerospike_load_config(as)->policies.operate, &copy);
+	copy.async_heap_rec = true;
+
+	as_sync_waiter w;
+	as_sync_waiter_init(&w, err);
+
+	as_status status = aerospike_key_operate_async(as, err, &copy, key, ops,
+		as_sync_record_listener, &w, NULL, as_sync_pipe(as));
+
+	return as_sync_record_result(&w, status, rec);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_sync_pipe.h>
+#include <aerospike/as_clock.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+// Must hold pipe lock.
+static void
+as_sync_pipe_invalidate(as_sync_pipe* pipe, as_sync_conn* conn)
+{
+	if (! conn->valid) {
+		return;
+	}
+
+	conn->valid = false;
+
+	// A valid connection is always the pipe's current connection.
+	pipe->conn = NULL;
+	conn->ref_count--;
+
+	// Wake commands waiting on this connection, so they can fail and retry.
+	pthread_cond_broadcast(&pipe->cond);
+}
+
+static inline void
+as_sync_conn_close(as_node* node, as_sync_conn* conn)
+{
+	as_node_close_socket(node, &conn->socket);
+	cf_free(conn);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_sync_pipe*
+as_sync_pipe_create(uint32_t size)
+{
+	as_sync_pipe* pipes = cf_malloc(sizeof(as_sync_pipe) * size);
+
+	for (uint32_t i = 0; i < size; i++) {
+		as_sync_pipe* pipe = &pipes[i];
+		pthread_mutex_init(&pipe->write_lock, NULL);
+		pthread_mutex_init(&pipe->lock, NULL);
+		pthread_cond_init(&pipe->cond, NULL);
+		pipe->conn = NULL;
+	}
+	return pipes;
+}
+
+void
+as_sync_pipe_destroy(as_node* node, as_sync_pipe* pipes, uint32_t size)
+{
+	// Node is destroyed after all commands referencing it have completed.
+	for (uint32_t i = 0; i < size; i++) {
+		as_sync_pipe* pipe = &pipes[i];
+
+		if (pipe->conn) {
+			as_sync_conn_close(node, pipe->conn);
+		}
+		pthread_cond_destroy(&pipe->cond);
+		pthread_mutex_destroy(&pipe->lock);
+		pthread_mutex_destroy(&pipe->write_lock);
+	}
+	cf_free(pipes);
+}
+
+as_status
+as_sync_pipe_write(
+	as_sync_pipe* pipe, as_error* err, as_node* node, const char* ns, as_socket_iov* iov,
+	uint32_t iov_count, uint32_t socket_timeout, uint64_t deadline_ms, as_sync_pipe_ticket* ticket
+	)
+{
+	as_sync_conn* idle = NULL;
+
+	pthread_mutex_lock(&pipe->write_lock);
+	pthread_mutex_lock(&pipe->lock);
+
+	as_sync_conn* conn = pipe->conn;
+
+	if (conn) {
+		if (conn->write_seq == conn->read_seq &&
+			! as_socket_current_tran(conn->socket.last_used, node->cluster->max_socket_idle_ns_tran)) {
+			// The server may have already closed the idle connection.
+			as_sync_pipe_invalidate(pipe, conn);
+
+			if (conn->ref_count == 0) {
+				idle = conn;
+			}
+			conn = NULL;
+		}
+		else {
+			conn->ref_count++;
+		}
+	}
+	pthread_mutex_unlock(&pipe->lock);
+
+	if (idle) {
+		as_sync_conn_close(node, idle);
+	}
+
+	if (! conn) {
+		as_socket sock;
+		as_status status = as_node_create_connection(err, node, ns, socket_timeout, deadline_ms,
+			NULL, &sock);
+
+		if (status != AEROSPIKE_OK) {
+			pthread_mutex_unlock(&pipe->write_lock);
+			return status;
+		}
+
+		conn = cf_malloc(sizeof(as_sync_conn));
+		conn->socket = sock;
+		conn->socket.last_used = as_clock_getns();
+		conn->write_seq = 0;
+		conn->read_seq = 0;
+		conn->ref_count = 2; // Pipe and this command.
+		conn->valid = true;
+
+		// Only writers replace the pipe connection, so no other connection was set meanwhile.
+		pthread_mutex_lock(&pipe->lock);
+		pipe->conn = conn;
+		pthread_mutex_unlock(&pipe->lock);
+	}
+
+	ticket->conn = conn;
+	ticket->seq = conn->write_seq;
+
+	as_status status = as_socket_writev_deadline(err, &conn->socket, node, iov, iov_count,
+		socket_timeout, deadline_ms);
+
+	if (status == AEROSPIKE_OK) {
+		conn->write_seq++;
+	}
+	pthread_mutex_unlock(&pipe->write_lock);
+
+	if (status != AEROSPIKE_OK) {
+		// A partial write leaves the connection unusable.
+		as_sync_pipe_done(pipe, node, ticket, false);
+	}
+	return status;
+}
+
+as_status
+as_sync_pipe_wait(
+	as_sync_pipe* pipe, as_error* err, as_sync_pipe_ticket* ticket, uint32_t socket_timeout,
+	uint64_t deadline_ms, as_socket* sock
+	)
+{
+	as_sync_conn* conn = ticket->conn;
+	uint64_t limit = deadline_ms;
+
+	if (socket_timeout > 0) {
+		uint64_t socket_deadline = as_clock_getms() + socket_timeout;
+
+		if (limit == 0 || socket_deadline < limit) {
+			limit = socket_deadline;
+		}
+	}
+
+	pthread_mutex_lock(&pipe->lock);
+
+	while (conn->valid && conn->read_seq != ticket->seq) {
+		if (limit == 0) {
+			pthread_cond_wait(&pipe->cond, &pipe->lock);
+			continue;
+		}
+
+		uint64_t now = as_clock_getms();
+
+		if (now >= limit) {
+			// This command's response will not be read, so the responses of all commands
+			// queued behind it can not be matched anymore.
+			as_sync_pipe_invalidate(pipe, conn);
+			pthread_mutex_unlock(&pipe->lock);
+
+			// Client timeouts do not have a message.
+			return err->code = AEROSPIKE_ERR_TIMEOUT;
+		}
+
+		struct timespec delta;
+		struct timespec abstime;
+		cf_clock_set_timespec_ms((uint32_t)(limit - now), &delta);
+		cf_clock_current_add(&delta, &abstime);
+		pthread_cond_timedwait(&pipe->cond, &pipe->lock, &abstime);
+	}
+
+	bool valid = conn->valid;
+
+	if (valid) {
+		*sock = conn->socket;
+	}
+	pthread_mutex_unlock(&pipe->lock);
+
+	if (! valid) {
+		return as_error_set_message(err, AEROSPIKE_ERR_CONNECTION, "Pipelined connection closed");
+	}
+	return AEROSPIKE_OK;
+}
+
+void
+as_sync_pipe_done(as_sync_pipe* pipe, as_node* node, as_sync_pipe_ticket* ticket, bool valid)
+{
+	as_sync_conn* conn = ticket->conn;
+
+	pthread_mutex_lock(&pipe->lock);
+
+	if (valid && conn->valid) {
+		// Let the next command read its response.
+		conn->read_seq++;
+		conn->socket.last_used = as_clock_getns();
+		pthread_cond_broadcast(&pipe->cond);
+	}
+	else {
+		as_sync_pipe_invalidate(pipe, conn);
+	}
+
+	bool release = --conn->ref_count == 0;
+	pthread_mutex_unlock(&pipe->lock);
+
+	if (release) {
+		as_sync_conn_close(node, conn);
+	}
+}
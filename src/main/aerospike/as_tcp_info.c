@@ -0,0 +1,98 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_tcp_info.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <netinet/tcp.h>
+#elif defined(_MSC_VER)
+#include <mstcpip.h>
+#endif
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+#if defined(__linux__)
+
+bool
+as_tcp_info_read(as_socket_fd fd, as_tcp_info* info)
+{
+	struct tcp_info ti;
+	socklen_t len = sizeof(ti);
+
+	if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) != 0) {
+		return false;
+	}
+
+	info->rtt_us = ti.tcpi_rtt;
+	info->rttvar_us = ti.tcpi_rttvar;
+	info->cwnd = ti.tcpi_snd_cwnd;
+	info->retrans = ti.tcpi_total_retrans;
+	return true;
+}
+
+#elif defined(__APPLE__) && defined(TCP_CONNECTION_INFO)
+
+bool
+as_tcp_info_read(as_socket_fd fd, as_tcp_info* info)
+{
+	struct tcp_connection_info ti;
+	socklen_t len = sizeof(ti);
+
+	if (getsockopt(fd, IPPROTO_TCP, TCP_CONNECTION_INFO, &ti, &len) != 0) {
+		return false;
+	}
+
+	// Darwin reports round trip times in milliseconds and the window in bytes.
+	info->rtt_us = ti.tcpi_srtt * 1000;
+	info->rttvar_us = ti.tcpi_rttvar * 1000;
+	info->cwnd = ti.tcpi_maxseg ? ti.tcpi_snd_cwnd / ti.tcpi_maxseg : 0;
+	info->retrans = (uint32_t)ti.tcpi_txretransmitpackets;
+	return true;
+}
+
+#elif defined(_MSC_VER) && defined(SIO_TCP_INFO)
+
+bool
+as_tcp_info_read(as_socket_fd fd, as_tcp_info* info)
+{
+	DWORD version = 0;
+	TCP_INFO_v0 ti;
+	DWORD bytes = 0;
+
+	if (WSAIoctl(fd, SIO_TCP_INFO, &version, sizeof(version), &ti, sizeof(ti), &bytes, NULL,
+		NULL) != 0) {
+		return false;
+	}
+
+	// Windows does not report round trip time variance. The window is reported in bytes.
+	info->rtt_us = ti.RttUs;
+	info->rttvar_us = 0;
+	info->cwnd = ti.Mss ? ti.SndCwnd / ti.Mss : 0;
+	info->retrans = ti.FastRetrans + ti.TimeoutEpisodes;
+	return true;
+}
+
+#else
+
+bool
+as_tcp_info_read(as_socket_fd fd, as_tcp_info* info)
+{
+	return false;
+}
+
+#endif
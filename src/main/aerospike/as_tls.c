@@ -41,6 +41,16 @@ static bool s_tls_inited = false;
 static pthread_mutex_t s_tls_init_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int s_ex_name_index = -1;
 static int s_ex_ctxt_index = -1;
+static int s_ex_session_index = -1;
+
+#define AS_TLS_SESSION_BUCKETS 64
+
+// Cached client session for one node and TLS name.
+typedef struct as_tls_session_s {
+	struct as_tls_session_s* next;
+	SSL_SESSION* session;
+	char key[];
+} as_tls_session;
 
 typedef enum as_tls_protocol_e {
 	// SSLv2 is always disabled per RFC 6176, we maintain knowledge of
@@ -232,6 +242,96 @@ threading_cleanup(void)
 }
 #endif
 
+static void
+as_tls_session_key_free(
+	void* parent, void* ptr, CRYPTO_EX_DATA* ad, int idx, long argl, void* argp
+	)
+{
+	if (ptr) {
+		cf_free(ptr);
+	}
+}
+
+static uint32_t
+as_tls_session_hash(const char* key)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+
+	while (*key) {
+		hash ^= (uint8_t)*key++;
+		hash *= 16777619u;
+	}
+	return hash % AS_TLS_SESSION_BUCKETS;
+}
+
+// Must hold context lock.
+static as_tls_session*
+as_tls_session_find(as_tls_context* ctx, const char* key, uint32_t hash)
+{
+	as_tls_session* entry = ctx->sessions[hash];
+
+	while (entry) {
+		if (strcmp(entry->key, key) == 0) {
+			return entry;
+		}
+		entry = entry->next;
+	}
+	return NULL;
+}
+
+// Must hold context lock.
+static void
+as_tls_sessions_clear(as_tls_context* ctx)
+{
+	for (uint32_t i = 0; i < AS_TLS_SESSION_BUCKETS; i++) {
+		as_tls_session* entry = ctx->sessions[i];
+
+		while (entry) {
+			as_tls_session* next = entry->next;
+			SSL_SESSION_free(entry->session);
+			cf_free(entry);
+			entry = next;
+		}
+		ctx->sessions[i] = NULL;
+	}
+}
+
+static int
+as_tls_session_new(SSL* ssl, SSL_SESSION* session)
+{
+	const char* key = SSL_get_ex_data(ssl, s_ex_session_index);
+	as_tls_context* ctx = SSL_get_ex_data(ssl, s_ex_ctxt_index);
+
+	if (! key || ! ctx || ! ctx->sessions) {
+		// Let OpenSSL free the session.
+		return 0;
+	}
+
+	uint32_t hash = as_tls_session_hash(key);
+
+	pthread_mutex_lock(&ctx->lock);
+
+	as_tls_session* entry = as_tls_session_find(ctx, key, hash);
+
+	if (entry) {
+		SSL_SESSION_free(entry->session);
+	}
+	else {
+		size_t len = strlen(key) + 1;
+		entry = cf_malloc(sizeof(as_tls_session) + len);
+		memcpy(entry->key, key, len);
+		entry->next = ctx->sessions[hash];
+		ctx->sessions[hash] = entry;
+	}
+	entry->session = session;
+
+	pthread_mutex_unlock(&ctx->lock);
+
+	// Returning one keeps the session reference for the cache.
+	return 1;
+}
+
 void
 as_tls_check_init(void)
 {
@@ -260,6 +360,7 @@ as_tls_check_init(void)
 
 		s_ex_name_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, NULL);
 		s_ex_ctxt_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+		s_ex_session_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, as_tls_session_key_free);
 				
 		s_tls_inited = true;
 	}
@@ -601,6 +702,9 @@ as_tls_context_setup(as_config_tls* tlscfg, as_tls_context* ctx, as_error* errp)
 	ctx->cert_blacklist = NULL;
 	ctx->log_session_info = tlscfg->log_session_info;
 	ctx->for_login_only = tlscfg->for_login_only;
+	ctx->sessions = NULL;
+	ctx->full_handshakes = 0;
+	ctx->resumed_handshakes = 0;
 
 	as_tls_check_init();
 	pthread_mutex_init(&ctx->lock, NULL);
@@ -681,6 +785,23 @@ as_tls_context_setup(as_config_tls* tlscfg, as_tls_context* ctx, as_error* errp)
 	if (! (protocols & AS_TLS_PROTOCOL_TLSV1_2)) {
 		SSL_CTX_set_options(ctx->ssl_ctx, SSL_OP_NO_TLSv1_2);
 	}
+
+	if (tlscfg->session_cache) {
+		// Sessions are stored per node in the context, so the internal cache is not used.
+		ctx->sessions = cf_calloc(AS_TLS_SESSION_BUCKETS, sizeof(as_tls_session*));
+		SSL_CTX_set_session_cache_mode(ctx->ssl_ctx,
+			SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(ctx->ssl_ctx, as_tls_session_new);
+	}
+
+	if (tlscfg->ktls) {
+#if defined(SSL_OP_ENABLE_KTLS)
+		// Records are encrypted in userspace when the kernel or cipher does not support kTLS.
+		SSL_CTX_set_options(ctx->ssl_ctx, SSL_OP_ENABLE_KTLS);
+#else
+		as_log_warn("Kernel TLS is not supported by this OpenSSL version");
+#endif
+	}
 	
 	if (tlscfg->cafile || tlscfg->capath) {
 		int rv = SSL_CTX_load_verify_locations(ctx->ssl_ctx, tlscfg->cafile, tlscfg->capath);
@@ -793,6 +914,11 @@ as_tls_context_setup(as_config_tls* tlscfg, as_tls_context* ctx, as_error* errp)
 void
 as_tls_context_destroy(as_tls_context* ctx)
 {
+	if (ctx->sessions) {
+		as_tls_sessions_clear(ctx);
+		cf_free(ctx->sessions);
+	}
+
 	if (ctx->cert_blacklist) {
 		cert_blacklist_destroy(ctx->cert_blacklist);
 	}
@@ -864,6 +990,12 @@ as_tls_config_reload(as_config_tls* tlscfg, as_tls_context* ctx,
 		ctx->cert_blacklist = new_cbl;
 	}
 
+	if (ctx->sessions) {
+		// Resumed sessions skip certificate verification, so do not resume sessions
+		// established with the previous certificates.
+		as_tls_sessions_clear(ctx);
+	}
+
 	pthread_mutex_unlock(&ctx->lock);
 	return AEROSPIKE_OK;
 }
@@ -894,6 +1026,55 @@ as_tls_wrap(as_tls_context* ctx, as_socket* sock, const char* tls_name)
 	return 0;
 }
 
+void
+as_tls_session_resume(
+	as_tls_context* ctx, struct ssl_st* ssl, const char* node_name, const char* tls_name
+	)
+{
+	if (! ctx->sessions) {
+		return;
+	}
+
+	size_t name_len = strlen(node_name);
+	size_t tls_len = tls_name ? strlen(tls_name) : 0;
+	char* key = cf_malloc(name_len + tls_len + 2);
+
+	memcpy(key, node_name, name_len);
+	key[name_len] = '/';
+
+	if (tls_len > 0) {
+		memcpy(key + name_len + 1, tls_name, tls_len);
+	}
+	key[name_len + tls_len + 1] = 0;
+
+	// Key is used to store the new session when the handshake completes and is freed
+	// with the SSL object.
+	SSL_set_ex_data(ssl, s_ex_session_index, key);
+
+	uint32_t hash = as_tls_session_hash(key);
+
+	pthread_mutex_lock(&ctx->lock);
+
+	as_tls_session* entry = as_tls_session_find(ctx, key, hash);
+
+	if (entry) {
+		SSL_set_session(ssl, entry->session);
+	}
+
+	pthread_mutex_unlock(&ctx->lock);
+}
+
+void
+as_tls_handshake_complete(as_tls_context* ctx, struct ssl_st* ssl)
+{
+	if (SSL_session_reused(ssl)) {
+		as_incr_uint64(&ctx->resumed_handshakes);
+	}
+	else {
+		as_incr_uint64(&ctx->full_handshakes);
+	}
+}
+
 void
 as_tls_set_name(as_socket* sock, const char* tls_name)
 {
@@ -927,6 +1108,14 @@ log_session_info(as_socket* sock)
 	else {
 		as_log_warn("TLS no current cipher");
 	}
+
+#if defined(SSL_OP_ENABLE_KTLS)
+	if (SSL_get_options(sock->ssl) & SSL_OP_ENABLE_KTLS) {
+		as_log_info("TLS kernel offload: send=%d recv=%d",
+			(int)BIO_get_ktls_send(SSL_get_wbio(sock->ssl)),
+			(int)BIO_get_ktls_recv(SSL_get_rbio(sock->ssl)));
+	}
+#endif
 }
 
 static void
@@ -943,6 +1132,7 @@ as_tls_connect_once(as_socket* sock)
 {
 	int rv = SSL_connect(sock->ssl);
 	if (rv == 1) {
+		as_tls_handshake_complete(sock->ctx, sock->ssl);
 		log_session_info(sock);
 		return 1;
 	}
@@ -1002,6 +1192,7 @@ as_tls_connect(as_socket* sock, uint64_t deadline)
 	while (true) {
 		rv = SSL_connect(sock->ssl);
 		if (rv == 1) {
+			as_tls_handshake_complete(sock->ctx, sock->ssl);
 			log_session_info(sock);
 			return 0;
 		}
@@ -1170,6 +1361,16 @@ as_tls_read_once(as_socket* sock, void* buf, size_t len)
 
 int
 as_tls_read(as_socket* sock, void* bufp, size_t len, uint32_t socket_timeout, uint64_t deadline)
+{
+	size_t read_len;
+	return as_tls_read_ahead(sock, bufp, len, len, socket_timeout, deadline, &read_len);
+}
+
+int
+as_tls_read_ahead(
+	as_socket* sock, void* bufp, size_t min_len, size_t len, uint32_t socket_timeout,
+	uint64_t deadline, size_t* read_len
+	)
 {
 	uint8_t* buf = (uint8_t *) bufp;
 	size_t pos = 0;
@@ -1178,7 +1379,8 @@ as_tls_read(as_socket* sock, void* bufp, size_t len, uint32_t socket_timeout, ui
 		int rv = SSL_read(sock->ssl, buf + pos, (int)(len - pos));
 		if (rv > 0) {
 			pos += rv;
-			if (pos >= len) {
+			if (pos >= min_len) {
+				*read_len = pos;
 				return 0;
 			}
 		}
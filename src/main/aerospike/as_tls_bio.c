@@ -0,0 +1,185 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_tls_bio.h>
+#include <citrusleaf/alloc.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <string.h>
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+as_status
+as_tls_bio_init(as_tls_bio* tb, as_error* err, as_tls_context* ctx, as_node* node)
+{
+	tb->ctx = ctx;
+	tb->ibio = NULL;
+	tb->nbio = NULL;
+	tb->capacity = AS_TLS_BIO_BUFFER_SIZE;
+	tb->buf = cf_malloc(tb->capacity);
+	tb->len = 0;
+
+	pthread_mutex_lock(&ctx->lock);
+	tb->ssl = SSL_new(ctx->ssl_ctx);
+	pthread_mutex_unlock(&ctx->lock);
+
+	if (! tb->ssl) {
+		return as_error_update(err, AEROSPIKE_ERR_ASYNC_CONNECTION, "SSL_new failed: %s %s",
+							   node->name, as_node_get_address_string(node));
+	}
+
+	as_tls_set_context_name(tb->ssl, ctx, node->tls_name);
+	as_tls_session_resume(ctx, tb->ssl, node->name, node->tls_name);
+
+	// Larger than the OpenSSL default, so several TLS records can be encrypted before the
+	// ciphertext is flushed to the socket.
+	size_t size = AS_TLS_BIO_BUFFER_SIZE * 2;
+	int rv = BIO_new_bio_pair(&tb->ibio, size, &tb->nbio, size);
+
+	if (rv != 1) {
+		return as_error_update(err, AEROSPIKE_ERR_ASYNC_CONNECTION,
+							   "BIO_new_bio_pair failed: %d %s %s",
+							   rv, node->name, as_node_get_address_string(node));
+	}
+
+	SSL_set_bio(tb->ssl, tb->ibio, tb->ibio);
+	SSL_set_connect_state(tb->ssl);
+	return AEROSPIKE_OK;
+}
+
+void
+as_tls_bio_destroy(as_tls_bio* tb)
+{
+	// SSL_free() also frees the internal bio.
+	if (tb->ssl) {
+		SSL_free(tb->ssl);
+	}
+
+	if (tb->nbio) {
+		BIO_free(tb->nbio);
+	}
+	cf_free(tb->buf);
+}
+
+int
+as_tls_bio_handshake(as_tls_bio* tb, int* e)
+{
+	int rv = SSL_do_handshake(tb->ssl);
+
+	if (rv == 1) {
+		as_tls_handshake_complete(tb->ctx, tb->ssl);
+		return 1;
+	}
+
+	*e = SSL_get_error(tb->ssl, rv);
+	return rv;
+}
+
+void
+as_tls_bio_shutdown(as_tls_bio* tb)
+{
+	SSL_shutdown(tb->ssl);
+}
+
+int
+as_tls_bio_encrypt(as_tls_bio* tb, const void* buf, int len, int* e)
+{
+	int rv = SSL_write(tb->ssl, buf, len);
+
+	if (rv <= 0) {
+		*e = SSL_get_error(tb->ssl, rv);
+	}
+	return rv;
+}
+
+int
+as_tls_bio_decrypt(as_tls_bio* tb, void* buf, int len, int* e)
+{
+	int rv = SSL_read(tb->ssl, buf, len);
+
+	if (rv <= 0) {
+		*e = SSL_get_error(tb->ssl, rv);
+	}
+	return rv;
+}
+
+as_status
+as_tls_bio_feed(as_tls_bio* tb, as_error* err, const char* buf, int len)
+{
+	int rv = 0;
+
+	for (int pos = 0; pos < len; pos += rv) {
+		rv = BIO_write(tb->nbio, buf + pos, len - pos);
+
+		if (rv <= 0) {
+			return as_error_update(err, AEROSPIKE_ERR_ASYNC_CONNECTION, "BIO_write failed: %d %d",
+								   len, rv);
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+int
+as_tls_bio_pending(as_tls_bio* tb)
+{
+	return (int)BIO_pending(tb->nbio);
+}
+
+int
+as_tls_bio_drain(as_tls_bio* tb, char* buf, int len)
+{
+	return BIO_read(tb->nbio, buf, len);
+}
+
+bool
+as_tls_bio_stage(as_tls_bio* tb, const char* unsent, int unsent_len, int remaining)
+{
+	tb->len = unsent_len + remaining;
+
+	if (tb->len > tb->capacity) {
+		tb->buf = cf_realloc(tb->buf, tb->len);
+		tb->capacity = tb->len;
+	}
+
+	memcpy(tb->buf, unsent, unsent_len);
+
+	if (remaining <= 0) {
+		return true;
+	}
+
+	int rv = BIO_read(tb->nbio, tb->buf + unsent_len, remaining);
+	return rv == remaining;
+}
+
+as_status
+as_tls_bio_error(as_error* err, int rv, int e)
+{
+	unsigned long errcode = ERR_get_error();
+	char errbuf[1024];
+
+	if (errcode != 0) {
+		ERR_error_string_n(errcode, errbuf, sizeof(errbuf));
+	}
+	else {
+		errbuf[0] = 0;
+	}
+
+	return as_error_update(err, AEROSPIKE_ERR_ASYNC_CONNECTION, "TLS failed: %d %d %lu %s",
+						   rv, e, errcode, errbuf);
+}
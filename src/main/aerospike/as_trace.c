@@ -0,0 +1,45 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_trace.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <citrusleaf/cf_clock.h>
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_trace_emit(
+	as_cluster* cluster, uint64_t id, as_trace_point point, as_node* node, const char* ns,
+	uint32_t partition_id, uint32_t iteration, as_status status, bool async
+	)
+{
+	as_trace_event event = {
+		.id = id,
+		.time_ns = cf_getns(),
+		.udata = cluster->trace_udata,
+		.node_name = node ? node->name : NULL,
+		.ns = ns,
+		.partition_id = partition_id,
+		.iteration = iteration,
+		.status = status,
+		.point = point,
+		.async = async
+	};
+	cluster->trace_callback(&event);
+}
@@ -15,6 +15,7 @@
  * the License.
  */
 #include <aerospike/as_txn.h>
+#include <aerospike/as_mem_stats.h>
 #include <citrusleaf/alloc.h>
 #include <citrusleaf/cf_random.h>
 
@@ -28,213 +29,209 @@ typedef void (*khash_reduce_fn)(const uint8_t* keyd, const char* set, uint64_t v
 // Static Functions
 //---------------------------------
 
-static inline as_txn_hash_row*
-get_row(const as_txn_hash* h, const uint8_t* keyd)
+static inline uint32_t
+as_txn_hash_index(const as_txn_hash* h, const uint8_t* keyd)
 {
-	return &h->table[*(uint32_t*)keyd % h->n_rows];
+	// Digests are uniformly distributed, so the first four bytes are a sufficient hash.
+	uint32_t v;
+	memcpy(&v, keyd, sizeof(v));
+	return v & (h->n_slots - 1);
 }
 
-static inline void
-fill_ele(as_txn_key* e, const uint8_t* keyd, const char* set, uint64_t version)
+static const char*
+as_txn_hash_intern(as_txn_hash* h, const char* set)
 {
-	memcpy(e->digest, keyd, sizeof(e->digest));
-	as_strncpy(e->set, set, sizeof(e->set));
-	e->version = version;
-	e->next = NULL;
+	if (! set) {
+		set = "";
+	}
+
+	// Transactions are restricted to one namespace, so there are very few distinct sets.
+	for (uint32_t i = 0; i < h->n_sets; i++) {
+		if (strcmp(h->sets[i], set) == 0) {
+			return h->sets[i];
+		}
+	}
+
+	if (h->n_sets == h->sets_capacity) {
+		h->sets_capacity = h->sets_capacity ? h->sets_capacity * 2 : 4;
+		h->sets = (char**)cf_realloc(h->sets, h->sets_capacity * sizeof(char*));
+	}
+
+	char* s = cf_strdup(set);
+	h->sets[h->n_sets++] = s;
+	return s;
+}
+
+// Must hold lock. Return slot containing digest or the empty slot where it belongs.
+static inline as_txn_key*
+as_txn_hash_find(const as_txn_hash* h, const uint8_t* keyd)
+{
+	uint32_t mask = h->n_slots - 1;
+	uint32_t i = as_txn_hash_index(h, keyd);
+
+	while (true) {
+		as_txn_key* e = &h->table[i];
+
+		if (! e->set || memcmp(keyd, e->digest, AS_DIGEST_VALUE_SIZE) == 0) {
+			return e;
+		}
+		i = (i + 1) & mask;
+	}
 }
 
 static void
-as_txn_hash_init(as_txn_hash* h, uint32_t n_rows)
+as_txn_hash_init(as_txn_hash* h, uint32_t n_slots)
 {
-	pthread_mutex_init(&h->lock, NULL);
-	h->n_eles = 0;
-	h->n_rows = n_rows;
-	h->table = (as_txn_hash_row*)cf_malloc(n_rows * sizeof(as_txn_hash_row));
+	// Round up to power of 2 so slot index is a mask.
+	uint32_t size = 16;
 
-	for (uint32_t i = 0; i < h->n_rows; i++) {
-		h->table[i].used = false;
+	while (size < n_slots) {
+		size <<= 1;
 	}
+
+	pthread_mutex_init(&h->lock, NULL);
+	h->n_eles = 0;
+	h->n_slots = size;
+	h->table = (as_txn_key*)cf_calloc(size, sizeof(as_txn_key));
+	as_mem_stats_alloc(AS_MEM_TAG_TXN, size * sizeof(as_txn_key));
+	h->sets = NULL;
+	h->n_sets = 0;
+	h->sets_capacity = 0;
 }
 
 static void
 as_txn_hash_clear(as_txn_hash* h)
 {
-	as_txn_hash_row* row = h->table;
-
-	for (uint32_t i = 0; i < h->n_rows; i++) {
-		if (row->used) {
-			as_txn_key* e = row->head.next;
-
-			while (e != NULL) {
-				as_txn_key* t = e->next;
-				cf_free(e);
-				e = t;
-			}
-			row->used = false;
-		}
-		row++;
-	}
-	
+	memset(h->table, 0, h->n_slots * sizeof(as_txn_key));
 	h->n_eles = 0;
+
+	for (uint32_t i = 0; i < h->n_sets; i++) {
+		cf_free(h->sets[i]);
+	}
+	h->n_sets = 0;
 }
 
 static void
 as_txn_hash_destroy(as_txn_hash* h)
 {
-	if (h->n_eles > 0) {
-		as_txn_hash_clear(h);
-	}
+	as_txn_hash_clear(h);
+	cf_free(h->sets);
 	pthread_mutex_destroy(&h->lock);
 	cf_free(h->table);
+	as_mem_stats_free(AS_MEM_TAG_TXN, h->n_slots * sizeof(as_txn_key));
 }
 
+// Must hold lock.
 static void
-as_txn_hash_put(as_txn_hash* h, const uint8_t* keyd, const char* set, uint64_t version)
+as_txn_hash_grow(as_txn_hash* h)
 {
-	as_txn_hash_row* row = get_row(h, keyd);
-	as_txn_key* e = &row->head;
+	as_txn_key* old = h->table;
+	uint32_t old_slots = h->n_slots;
+
+	h->n_slots = old_slots * 2;
+	h->table = (as_txn_key*)cf_calloc(h->n_slots, sizeof(as_txn_key));
+	as_mem_stats_alloc(AS_MEM_TAG_TXN, old_slots * sizeof(as_txn_key));
 
+	for (uint32_t i = 0; i < old_slots; i++) {
+		if (old[i].set) {
+			*as_txn_hash_find(h, old[i].digest) = old[i];
+		}
+	}
+	cf_free(old);
+}
+
+static void
+as_txn_hash_put(as_txn_hash* h, const uint8_t* keyd, const char* set, uint64_t version)
+{
 	pthread_mutex_lock(&h->lock);
 
-	// Most common case should be insert into empty row.
-	if (! row->used) {
-		fill_ele(e, keyd, set, version);
-		h->n_eles++;
-		row->used = true;
+	as_txn_key* e = as_txn_hash_find(h, keyd);
+
+	if (e->set) {
+		e->version = version;
 		pthread_mutex_unlock(&h->lock);
 		return;
 	}
 
-	do {
-		if (memcmp(keyd, e->digest, AS_DIGEST_VALUE_SIZE) == 0) {
-			e->version = version;
-			pthread_mutex_unlock(&h->lock);
-			return;
-		}
-
-		e = e->next;
-	} while (e != NULL);
+	// Keep load factor at or below 3/4 so probe sequences stay short.
+	if ((h->n_eles + 1) * 4 > h->n_slots * 3) {
+		as_txn_hash_grow(h);
+		e = as_txn_hash_find(h, keyd);
+	}
 
-	e = (as_txn_key*)cf_malloc(sizeof(as_txn_key));
-	fill_ele(e, keyd, set, version);
+	memcpy(e->digest, keyd, sizeof(e->digest));
+	e->version = version;
+	e->set = as_txn_hash_intern(h, set);
 	h->n_eles++;
 
-	// Insert just after head.
-	e->next = row->head.next;
-	row->head.next = e;
-
 	pthread_mutex_unlock(&h->lock);
 }
 
 static void
 as_txn_hash_remove(as_txn_hash* h, const uint8_t* keyd)
 {
-	as_txn_hash_row* row = get_row(h, keyd);
-	as_txn_key* e = &row->head;
-	as_txn_key* e_prev = NULL;
-	as_txn_key* free_e = NULL;
-
 	pthread_mutex_lock(&h->lock);
 
-	if (! row->used) {
+	as_txn_key* e = as_txn_hash_find(h, keyd);
+
+	if (! e->set) {
 		pthread_mutex_unlock(&h->lock);
 		return;
 	}
 
-	do {
-		if (memcmp(keyd, e->digest, AS_DIGEST_VALUE_SIZE) == 0) {
-			if (e_prev != NULL) {
-				e_prev->next = e->next;
-				free_e = e;
-			}
-			else if (e->next == NULL) {
-				row->used = false;
-			}
-			else {
-				free_e = e->next;
-				*e = *e->next;
-			}
-
-			h->n_eles--;
+	// Shift following keys of the probe sequence back so no tombstones are needed.
+	uint32_t mask = h->n_slots - 1;
+	uint32_t i = (uint32_t)(e - h->table);
+	uint32_t j = i;
+
+	while (true) {
+		j = (j + 1) & mask;
+
+		as_txn_key* next = &h->table[j];
+
+		if (! next->set) {
 			break;
 		}
-		
-		e_prev = e;
-		e = e->next;
-	} while (e != NULL);
 
-	pthread_mutex_unlock(&h->lock);
+		uint32_t k = as_txn_hash_index(h, next->digest);
 
-	if (free_e != NULL) {
-		cf_free(free_e);
+		// Move key if its home slot is not cyclically within (i, j].
+		if ((i <= j)? (k <= i || k > j) : (k <= i && k > j)) {
+			h->table[i] = *next;
+			i = j;
+		}
 	}
+
+	h->table[i].set = NULL;
+	h->n_eles--;
+	pthread_mutex_unlock(&h->lock);
 }
 
 static uint64_t
 as_txn_hash_get_version(as_txn_hash* h, const uint8_t* keyd)
 {
-	as_txn_hash_row* row = get_row(h, keyd);
-
-	if (! row->used) {
-		return 0;
-	}
-
-	as_txn_key* e = &row->head;
-
 	pthread_mutex_lock(&h->lock);
 
-	if (! row->used) {
-		pthread_mutex_unlock(&h->lock);
-		return 0;
-	}
-
-	do {
-		if (memcmp(keyd, e->digest, AS_DIGEST_VALUE_SIZE) == 0) {
-			uint64_t version = e->version;
-			pthread_mutex_unlock(&h->lock);
-			return version;
-		}
-
-		e = e->next;
-	} while (e != NULL);
+	as_txn_key* e = as_txn_hash_find(h, keyd);
+	uint64_t version = e->set ? e->version : 0;
 
 	pthread_mutex_unlock(&h->lock);
-	return 0;
+	return version;
 }
 
 static bool
 as_txn_hash_contains(as_txn_hash* h, const uint8_t* keyd)
 {
-	as_txn_hash_row* row = get_row(h, keyd);
-
-	if (! row->used) {
-		return false;
-	}
-
-	as_txn_key* e = &row->head;
-
 	pthread_mutex_lock(&h->lock);
 
-	if (! row->used) {
-		pthread_mutex_unlock(&h->lock);
-		return false;
-	}
-
-	do {
-		if (memcmp(keyd, e->digest, AS_DIGEST_VALUE_SIZE) == 0) {
-			pthread_mutex_unlock(&h->lock);
-			return true;
-		}
-
-		e = e->next;
-	} while (e != NULL);
+	bool found = as_txn_hash_find(h, keyd)->set != NULL;
 
 	pthread_mutex_unlock(&h->lock);
-	return false;
+	return found;
 }
 
 static void
-as_txn_init_all(as_txn* txn, uint32_t read_buckets, uint32_t write_buckets)
+as_txn_init_all(as_txn* txn, uint32_t read_slots, uint32_t write_slots)
 {
 	// An id of zero is considered invalid. Create random numbers
 	// in a loop until non-zero is returned.
@@ -251,8 +248,15 @@ as_txn_init_all(as_txn* txn, uint32_t read_buckets, uint32_t write_buckets)
 	txn->state = AS_TXN_STATE_OPEN;
 	txn->write_in_doubt = false;
 	txn->in_doubt = false;
-	as_txn_hash_init(&txn->reads, read_buckets);
-	as_txn_hash_init(&txn->writes, write_buckets);
+	txn->read_only = false;
+	as_txn_hash_init(&txn->reads, read_slots);
+	as_txn_hash_init(&txn->writes, write_slots);
+	pthread_mutex_init(&txn->monitor_lock, NULL);
+	pthread_cond_init(&txn->monitor_cond, NULL);
+	txn->monitor_pending = NULL;
+	txn->monitor_async_pending = NULL;
+	txn->monitor_async_loop = NULL;
+	txn->monitor_busy = false;
 }
 
 //---------------------------------
@@ -277,7 +281,7 @@ as_txn_init_capacity(as_txn* txn, uint32_t reads_capacity, uint32_t writes_capac
 		writes_capacity = 16;
 	}
 
-	// Double record capacity to allocate enough buckets to alleviate collisions.
+	// Double record capacity to keep the table below its maximum load factor.
 	as_txn_init_all(txn, reads_capacity * 2, writes_capacity * 2);
 	txn->free = false;
 }
@@ -286,6 +290,7 @@ as_txn*
 as_txn_create(void)
 {
 	as_txn* txn = cf_malloc(sizeof(as_txn));
+	as_mem_stats_alloc(AS_MEM_TAG_TXN, sizeof(as_txn));
 	as_txn_init(txn);
 	txn->free = true;
 	return txn;
@@ -295,6 +300,7 @@ as_txn*
 as_txn_create_capacity(uint32_t reads_capacity, uint32_t writes_capacity)
 {
 	as_txn* txn = cf_malloc(sizeof(as_txn));
+	as_mem_stats_alloc(AS_MEM_TAG_TXN, sizeof(as_txn));
 	as_txn_init_capacity(txn, reads_capacity, writes_capacity);
 	txn->free = true;
 	return txn;
@@ -305,9 +311,12 @@ as_txn_destroy(as_txn* txn)
 {
 	as_txn_hash_destroy(&txn->reads);
 	as_txn_hash_destroy(&txn->writes);
+	pthread_cond_destroy(&txn->monitor_cond);
+	pthread_mutex_destroy(&txn->monitor_lock);
 	
 	if (txn->free) {
 		cf_free(txn);
+		as_mem_stats_free(AS_MEM_TAG_TXN, sizeof(as_txn));
 	}
 }
 
@@ -391,22 +400,14 @@ as_txn_clear(as_txn* txn)
 as_txn_key*
 as_txn_iter_next(as_txn_iter* iter)
 {
-	if (iter->ele) {
-		as_txn_key* tmp = iter->ele;
-		iter->ele = tmp->next;
-		return tmp;
-	}
+	as_txn_hash* h = iter->khash;
+
+	while (iter->idx < h->n_slots) {
+		as_txn_key* e = &h->table[iter->idx++];
 
-	while (iter->idx < iter->khash->n_rows) {
-		if (iter->row->used) {
-			as_txn_key* tmp = &iter->row->head;
-			iter->ele = tmp->next;
-			iter->row++;
-			iter->idx++;
-			return tmp;
+		if (e->set) {
+			return e;
 		}
-		iter->row++;
-		iter->idx++;
 	}
 	return NULL;
 }
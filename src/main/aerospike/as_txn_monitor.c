@@ -35,12 +35,51 @@
 #define BIN_NAME_ID "id"
 #define BIN_NAME_DIGESTS "keyds"
 
+//---------------------------------
+// Types
+//---------------------------------
+
+typedef struct as_txn_monitor_req_s {
+	struct as_txn_monitor_req_s* next;
+	const uint8_t* digest;
+	as_error* err;
+	as_status status;
+	bool done;
+} as_txn_monitor_req;
+
+typedef struct as_txn_monitor_async_req_s {
+	struct as_txn_monitor_async_req_s* next;
+	as_async_record_listener listener;
+	void* udata;
+	as_digest_value digest;
+} as_txn_monitor_async_req;
+
+typedef struct {
+	aerospike* as;
+	as_txn* txn;
+	as_policy_base policy;
+	as_event_loop* event_loop;
+	as_txn_monitor_async_req* reqs;
+} as_txn_monitor_group;
+
+typedef struct {
+	as_txn_monitor_async_req* reqs;
+	as_error err;
+} as_txn_monitor_group_error;
+
 //---------------------------------
 // Common Functions
 //---------------------------------
 
+static inline as_status
+as_txn_monitor_read_only(as_error* err)
+{
+	return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+		"Read-only transaction does not allow writes");
+}
+
 static void
-as_txn_get_ops_single(as_txn* txn, const as_key* key, as_operations* ops)
+as_txn_get_ops_single(as_txn* txn, const uint8_t* digest, as_operations* ops)
 {
 	if (! as_txn_monitor_exists(txn)) {
 		// No existing monitor record.
@@ -51,11 +90,26 @@ as_txn_get_ops_single(as_txn* txn, const as_key* key, as_operations* ops)
 	as_list_policy_set(&lp, AS_LIST_ORDERED, AS_LIST_WRITE_ADD_UNIQUE | AS_LIST_WRITE_NO_FAIL | AS_LIST_WRITE_PARTIAL);
 
 	as_bytes bytes;
-	as_bytes_init_wrap(&bytes, (uint8_t*)key->digest.value, AS_DIGEST_VALUE_SIZE, false);
+	as_bytes_init_wrap(&bytes, (uint8_t*)digest, AS_DIGEST_VALUE_SIZE, false);
 
 	as_operations_list_append(ops, BIN_NAME_DIGESTS, NULL, &lp, (as_val*)&bytes);
 }
 
+static void
+as_txn_get_ops_digests(as_txn* txn, as_arraylist* digests, as_operations* ops)
+{
+	if (! as_txn_monitor_exists(txn)) {
+		// No existing monitor record.
+		as_operations_add_write_int64(ops, BIN_NAME_ID, txn->id);
+	}
+
+	as_list_policy lp;
+	as_list_policy_set(&lp, AS_LIST_ORDERED, AS_LIST_WRITE_ADD_UNIQUE | AS_LIST_WRITE_NO_FAIL | AS_LIST_WRITE_PARTIAL);
+
+	as_operations_list_append_items(ops, BIN_NAME_DIGESTS, NULL, &lp, (as_list*)digests);
+	// Do not destroy digests because the previous function took ownership.
+}
+
 static void
 as_txn_get_ops_keys(as_txn* txn, const as_batch* batch, as_operations* ops)
 {
@@ -81,16 +135,7 @@ as_txn_get_ops_keys(as_txn* txn, const as_batch* batch, as_operations* ops)
 		as_arraylist_append_bytes(&digests, &bytes);
 	}
 
-	if (! as_txn_monitor_exists(txn)) {
-		// No existing monitor record.
-		as_operations_add_write_int64(ops, BIN_NAME_ID, txn->id);
-	}
-
-	as_list_policy lp;
-	as_list_policy_set(&lp, AS_LIST_ORDERED, AS_LIST_WRITE_ADD_UNIQUE | AS_LIST_WRITE_NO_FAIL | AS_LIST_WRITE_PARTIAL);
-
-	as_operations_list_append_items(ops, BIN_NAME_DIGESTS, NULL, &lp, (as_list*)&digests);
-	// Do not destroy digests because the previous function took ownership.
+	as_txn_get_ops_digests(txn, &digests, ops);
 }
 
 static void
@@ -127,16 +172,7 @@ as_txn_get_ops_records(as_txn* txn, as_batch_records* records, as_operations* op
 		return;
 	}
 
-	if (! as_txn_monitor_exists(txn)) {
-		// No existing monitor record.
-		as_operations_add_write_int64(ops, BIN_NAME_ID, txn->id);
-	}
-
-	as_list_policy lp;
-	as_list_policy_set(&lp, AS_LIST_ORDERED, AS_LIST_WRITE_ADD_UNIQUE | AS_LIST_WRITE_NO_FAIL | AS_LIST_WRITE_PARTIAL);
-
-	as_operations_list_append_items(ops, BIN_NAME_DIGESTS, NULL, &lp, (as_list*)&digests);
-	// Do not destroy digests because the previous function took ownership.
+	as_txn_get_ops_digests(txn, &digests, ops);
 }
 
 static void
@@ -179,6 +215,36 @@ as_txn_monitor_add_keys(
 	return as_txn_monitor_operate(as, err, txn, &txn_policy, &key, ops);
 }
 
+static as_status
+as_txn_monitor_add_reqs(
+	aerospike* as, as_txn* txn, const as_policy_base* cmd_policy, as_txn_monitor_req* reqs,
+	as_error* err
+	)
+{
+	as_operations ops;
+	as_operations_inita(&ops, 2);
+
+	if (! reqs->next) {
+		as_txn_get_ops_single(txn, reqs->digest, &ops);
+	}
+	else {
+		as_arraylist digests;
+		as_arraylist_init(&digests, 16, 16);
+
+		as_bytes bytes;
+
+		for (as_txn_monitor_req* r = reqs; r; r = r->next) {
+			as_bytes_init_wrap(&bytes, (uint8_t*)r->digest, AS_DIGEST_VALUE_SIZE, false);
+			as_arraylist_append_bytes(&digests, &bytes);
+		}
+		as_txn_get_ops_digests(txn, &digests, &ops);
+	}
+
+	as_status status = as_txn_monitor_add_keys(as, txn, cmd_policy, &ops, err);
+	as_operations_destroy(&ops);
+	return status;
+}
+
 as_status
 as_txn_monitor_add_key(
 	aerospike* as, const as_policy_base* cmd_policy, const as_key* cmd_key, as_error* err
@@ -186,18 +252,66 @@ as_txn_monitor_add_key(
 {
 	as_txn* txn = cmd_policy->txn;
 
+	if (txn->read_only) {
+		return as_txn_monitor_read_only(err);
+	}
+
 	if (as_txn_writes_contain(txn, cmd_key)) {
 		// Transaction monitor already contains this key.
 		return AEROSPIKE_OK;
 	}
 
-	as_operations ops;
-	as_operations_inita(&ops, 2);
+	as_txn_monitor_req req = {
+		.next = NULL,
+		.digest = cmd_key->digest.value,
+		.err = err,
+		.status = AEROSPIKE_OK,
+		.done = false
+	};
+
+	pthread_mutex_lock(&txn->monitor_lock);
+	req.next = txn->monitor_pending;
+	txn->monitor_pending = &req;
+
+	// Wait for the monitor record update in flight. It may already include this key.
+	while (txn->monitor_busy && ! req.done) {
+		pthread_cond_wait(&txn->monitor_cond, &txn->monitor_lock);
+	}
 
-	as_txn_get_ops_single(txn, cmd_key, &ops);
+	if (req.done) {
+		pthread_mutex_unlock(&txn->monitor_lock);
+		return req.status;
+	}
 
-	as_status status = as_txn_monitor_add_keys(as, txn, cmd_policy, &ops, err);
-	as_operations_destroy(&ops);
+	// Send all pending keys, including this one, in one monitor record update.
+	as_txn_monitor_req* reqs = txn->monitor_pending;
+	txn->monitor_pending = NULL;
+	txn->monitor_busy = true;
+	pthread_mutex_unlock(&txn->monitor_lock);
+
+	as_status status = as_txn_monitor_add_reqs(as, txn, cmd_policy, reqs, err);
+
+	pthread_mutex_lock(&txn->monitor_lock);
+
+	as_txn_monitor_req* r = reqs;
+
+	while (r) {
+		// Waiting threads own their requests, so read next before marking done.
+		as_txn_monitor_req* next = r->next;
+
+		if (r != &req) {
+			r->status = status;
+
+			if (status != AEROSPIKE_OK) {
+				as_error_copy(r->err, err);
+			}
+			r->done = true;
+		}
+		r = next;
+	}
+	txn->monitor_busy = false;
+	pthread_cond_broadcast(&txn->monitor_cond);
+	pthread_mutex_unlock(&txn->monitor_lock);
 	return status;
 }
 
@@ -208,6 +322,10 @@ as_txn_monitor_add_keys_batch(
 {
 	as_txn* txn = cmd_policy->txn;
 
+	if (txn->read_only) {
+		return as_txn_monitor_read_only(err);
+	}
+
 	as_operations ops;
 	as_operations_inita(&ops, 2);
 
@@ -236,6 +354,11 @@ as_txn_monitor_add_keys_records(
 		return AEROSPIKE_OK;
 	}
 
+	if (txn->read_only) {
+		as_operations_destroy(&ops);
+		return as_txn_monitor_read_only(err);
+	}
+
 	as_status status = as_txn_monitor_add_keys(as, txn, cmd_policy, &ops, err);
 	as_operations_destroy(&ops);
 	return status;
@@ -286,6 +409,124 @@ as_txn_monitor_add_keys_async(
 	return as_txn_monitor_operate_async(as, err, txn, &txn_policy, &key, ops, listener, udata, event_loop);
 }
 
+static void
+as_txn_monitor_group_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop);
+
+static as_status
+as_txn_monitor_group_send(as_txn_monitor_group* group, as_error* err)
+{
+	as_txn* txn = group->txn;
+
+	as_arraylist digests;
+	as_arraylist_init(&digests, 16, 16);
+
+	as_bytes bytes;
+
+	for (as_txn_monitor_async_req* r = group->reqs; r; r = r->next) {
+		as_bytes_init_wrap(&bytes, r->digest, AS_DIGEST_VALUE_SIZE, false);
+		as_arraylist_append_bytes(&digests, &bytes);
+	}
+
+	as_operations ops;
+	as_operations_inita(&ops, 2);
+	as_txn_get_ops_digests(txn, &digests, &ops);
+
+	as_status status = as_txn_monitor_add_keys_async(group->as, err, txn, &group->policy, &ops,
+		as_txn_monitor_group_listener, group, group->event_loop);
+	as_operations_destroy(&ops);
+	return status;
+}
+
+static void
+as_txn_monitor_group_notify(
+	as_txn_monitor_group* group, as_error* err, as_record* rec, as_event_loop* event_loop
+	)
+{
+	as_txn_monitor_async_req* r = group->reqs;
+
+	while (r) {
+		as_txn_monitor_async_req* next = r->next;
+		r->listener(err, rec, r->udata, event_loop);
+		cf_free(r);
+		r = next;
+	}
+	group->reqs = NULL;
+}
+
+static void
+as_txn_monitor_group_error_run(as_event_loop* event_loop, as_txn_monitor_group_error* ge)
+{
+	as_txn_monitor_async_req* r = ge->reqs;
+
+	while (r) {
+		as_txn_monitor_async_req* next = r->next;
+		r->listener(&ge->err, NULL, r->udata, event_loop);
+		cf_free(r);
+		r = next;
+	}
+	cf_free(ge);
+}
+
+static void
+as_txn_monitor_group_fail(as_txn_monitor_group* group, as_error* err)
+{
+	// The send failure may be detected in a caller thread that is not an event loop thread.
+	// Queued keys only come from the group's event loop, so run their listeners there.
+	as_txn_monitor_group_error* ge = cf_malloc(sizeof(as_txn_monitor_group_error));
+	ge->reqs = group->reqs;
+	as_error_copy(&ge->err, err);
+	group->reqs = NULL;
+
+	if (! as_event_execute(group->event_loop, (as_event_executable)as_txn_monitor_group_error_run,
+		ge)) {
+		// Event loop is closed. Notify listeners in the current thread rather than losing them.
+		as_log_warn("Failed to queue transaction monitor error callbacks");
+		as_txn_monitor_group_error_run(group->event_loop, ge);
+	}
+}
+
+static void
+as_txn_monitor_group_next(as_txn_monitor_group* group)
+{
+	as_txn* txn = group->txn;
+
+	while (true) {
+		pthread_mutex_lock(&txn->monitor_lock);
+
+		as_txn_monitor_async_req* reqs = txn->monitor_async_pending;
+
+		if (! reqs) {
+			txn->monitor_async_loop = NULL;
+			pthread_mutex_unlock(&txn->monitor_lock);
+			cf_free(group);
+			return;
+		}
+
+		txn->monitor_async_pending = NULL;
+		pthread_mutex_unlock(&txn->monitor_lock);
+
+		// Send keys that were queued while the previous update was in flight.
+		group->reqs = reqs;
+
+		as_error err;
+		as_status status = as_txn_monitor_group_send(group, &err);
+
+		if (status == AEROSPIKE_OK) {
+			return;
+		}
+		as_txn_monitor_group_fail(group, &err);
+	}
+}
+
+static void
+as_txn_monitor_group_listener(as_error* err, as_record* rec, void* udata, as_event_loop* event_loop)
+{
+	as_txn_monitor_group* group = udata;
+
+	as_txn_monitor_group_notify(group, err, rec, event_loop);
+	as_txn_monitor_group_next(group);
+}
+
 as_status
 as_txn_monitor_add_key_async(
 	aerospike* as, as_error* err, const as_policy_base* cmd_policy, const as_key* cmd_key,
@@ -295,13 +536,64 @@ as_txn_monitor_add_key_async(
 	// Add key to transaction monitor.
 	as_txn* txn = cmd_policy->txn;
 
-	as_operations ops;
-	as_operations_inita(&ops, 2);
-	as_txn_get_ops_single(txn, cmd_key, &ops);
+	if (txn->read_only) {
+		return as_txn_monitor_read_only(err);
+	}
 
-	as_status status = as_txn_monitor_add_keys_async(as, err, txn, cmd_policy, &ops, listener, udata,
-		event_loop);
-	as_operations_destroy(&ops);
+	pthread_mutex_lock(&txn->monitor_lock);
+
+	if (txn->monitor_async_loop == event_loop) {
+		// A monitor record update from the same event loop is in flight. Queue key for the
+		// next update. Only keys from the same event loop are coalesced, so listeners always
+		// run in their own event loop thread.
+		as_txn_monitor_async_req* req = cf_malloc(sizeof(as_txn_monitor_async_req));
+		req->next = txn->monitor_async_pending;
+		req->listener = listener;
+		req->udata = udata;
+		memcpy(req->digest, cmd_key->digest.value, AS_DIGEST_VALUE_SIZE);
+		txn->monitor_async_pending = req;
+		pthread_mutex_unlock(&txn->monitor_lock);
+		return AEROSPIKE_OK;
+	}
+
+	if (txn->monitor_async_loop) {
+		// Update from another event loop is in flight. Send key separately.
+		pthread_mutex_unlock(&txn->monitor_lock);
+
+		as_operations ops;
+		as_operations_inita(&ops, 2);
+		as_txn_get_ops_single(txn, cmd_key->digest.value, &ops);
+
+		as_status status = as_txn_monitor_add_keys_async(as, err, txn, cmd_policy, &ops, listener,
+			udata, event_loop);
+		as_operations_destroy(&ops);
+		return status;
+	}
+
+	txn->monitor_async_loop = event_loop;
+	pthread_mutex_unlock(&txn->monitor_lock);
+
+	as_txn_monitor_async_req* req = cf_malloc(sizeof(as_txn_monitor_async_req));
+	req->next = NULL;
+	req->listener = listener;
+	req->udata = udata;
+	memcpy(req->digest, cmd_key->digest.value, AS_DIGEST_VALUE_SIZE);
+
+	as_txn_monitor_group* group = cf_malloc(sizeof(as_txn_monitor_group));
+	group->as = as;
+	group->txn = txn;
+	group->policy = *cmd_policy;
+	group->event_loop = event_loop;
+	group->reqs = req;
+
+	as_status status = as_txn_monitor_group_send(group, err);
+
+	if (status != AEROSPIKE_OK) {
+		// Caller handles failure of its own key. Send keys queued in the meantime.
+		cf_free(req);
+		group->reqs = NULL;
+		as_txn_monitor_group_next(group);
+	}
 	return status;
 }
 
@@ -325,6 +617,11 @@ as_txn_monitor_add_keys_records_async(
 		return AEROSPIKE_OK;
 	}
 
+	if (txn->read_only) {
+		as_operations_destroy(&ops);
+		return as_txn_monitor_read_only(err);
+	}
+
 	as_status status = as_txn_monitor_add_keys_async(as, err, txn, cmd_policy, &ops, listener, udata, event_loop);
 	as_operations_destroy(&ops);
 	return status;
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_work_pool.h>
+#include <citrusleaf/alloc.h>
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static bool
+as_work_queue_pop(as_work_queue* queue, uint32_t priority, as_work_task* task)
+{
+	pthread_mutex_lock(&queue->lock);
+	bool rv = as_queue_pop(&queue->tasks[priority], task);
+	pthread_mutex_unlock(&queue->lock);
+	return rv;
+}
+
+static bool
+as_work_pool_find(as_work_pool* pool, uint32_t index, as_work_task* task)
+{
+	uint32_t max = pool->thread_size;
+
+	// Tasks of a higher priority on any queue take precedence over lower priority tasks on
+	// the worker's own queue.
+	for (uint32_t p = 0; p < AS_WORK_PRIORITY_SIZE; p++) {
+		if (as_work_queue_pop(&pool->queues[index], p, task)) {
+			return true;
+		}
+
+		// Steal oldest task from other queues. Tasks are independent requests, so the oldest
+		// task is taken to minimize its latency while its owner is busy.
+		for (uint32_t i = 1; i < max; i++) {
+			uint32_t victim = index + i;
+
+			if (victim >= max) {
+				victim -= max;
+			}
+
+			if (as_work_queue_pop(&pool->queues[victim], p, task)) {
+				as_incr_uint64(&pool->steal_count);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static bool
+as_work_pool_take(as_work_pool* pool, uint32_t index, as_work_task* task)
+{
+	while (true) {
+		if (as_work_pool_find(pool, index, task)) {
+			as_decr_uint32(&pool->queued);
+			return true;
+		}
+
+		pthread_mutex_lock(&pool->lock);
+
+		// Register as idle before checking the queued count. Submitters increment the queued
+		// count before checking idle, so either this worker sees the new task or the
+		// submitter sees this worker and signals it.
+		as_incr_uint32(&pool->idle);
+
+		while (as_load_uint32(&pool->queued) == 0 && ! pool->shutdown) {
+			pthread_cond_wait(&pool->cond, &pool->lock);
+		}
+
+		as_decr_uint32(&pool->idle);
+
+		// Remaining tasks are run before shutdown completes.
+		bool done = pool->shutdown && as_load_uint32(&pool->queued) == 0;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (done) {
+			return false;
+		}
+	}
+}
+
+static void*
+as_work_pool_worker(void* udata)
+{
+	as_work_worker* worker = udata;
+	as_work_pool* pool = worker->pool;
+	as_work_task task;
+
+	while (as_work_pool_take(pool, worker->index, &task)) {
+		task.fn(task.udata);
+	}
+
+	if (pool->fini_fn) {
+		pool->fini_fn();
+	}
+	return NULL;
+}
+
+static void
+as_work_pool_release(as_work_pool* pool, uint32_t n_queues)
+{
+	for (uint32_t i = 0; i < n_queues; i++) {
+		as_work_queue* queue = &pool->queues[i];
+
+		for (uint32_t p = 0; p < AS_WORK_PRIORITY_SIZE; p++) {
+			as_queue_destroy(&queue->tasks[p]);
+		}
+		pthread_mutex_destroy(&queue->lock);
+	}
+
+	cf_free(pool->queues);
+	cf_free(pool->workers);
+	pool->queues = NULL;
+	pool->workers = NULL;
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->lock);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+int
+as_work_pool_init(as_work_pool* pool, uint32_t thread_size, as_work_fini_fn fini_fn)
+{
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->cond, NULL);
+	pool->fini_fn = fini_fn;
+	pool->steal_count = 0;
+	pool->next = 0;
+	pool->queued = 0;
+	pool->idle = 0;
+	pool->shutdown = false;
+
+	// Allocate at least one queue, so queue access never needs a size check.
+	uint32_t n_queues = thread_size > 0 ? thread_size : 1;
+	pool->queues = cf_malloc(sizeof(as_work_queue) * n_queues);
+	pool->workers = cf_malloc(sizeof(as_work_worker) * n_queues);
+
+	for (uint32_t i = 0; i < n_queues; i++) {
+		as_work_queue* queue = &pool->queues[i];
+		pthread_mutex_init(&queue->lock, NULL);
+
+		for (uint32_t p = 0; p < AS_WORK_PRIORITY_SIZE; p++) {
+			as_queue_init(&queue->tasks[p], sizeof(as_work_task), 16);
+		}
+	}
+
+	pool->thread_size = thread_size;
+
+	for (uint32_t i = 0; i < thread_size; i++) {
+		as_work_worker* worker = &pool->workers[i];
+		worker->pool = pool;
+		worker->index = i;
+
+		int rc = pthread_create(&worker->thread, NULL, as_work_pool_worker, worker);
+
+		if (rc) {
+			// Stop threads already started.
+			pthread_mutex_lock(&pool->lock);
+			pool->shutdown = true;
+			pthread_cond_broadcast(&pool->cond);
+			pthread_mutex_unlock(&pool->lock);
+
+			for (uint32_t j = 0; j < i; j++) {
+				pthread_join(pool->workers[j].thread, NULL);
+			}
+			as_work_pool_release(pool, n_queues);
+			pool->thread_size = 0;
+			return rc;
+		}
+	}
+	return 0;
+}
+
+int
+as_work_pool_queue_task(as_work_pool* pool, as_work_priority priority, as_work_fn fn, void* udata)
+{
+	uint32_t max = pool->thread_size;
+
+	if (max == 0) {
+		return -1;
+	}
+
+	if (pool->shutdown) {
+		return -2;
+	}
+
+	as_work_task task = {
+		.fn = fn,
+		.udata = udata
+	};
+
+	// Distribute tasks round-robin, so submitters rarely contend on the same queue lock.
+	as_work_queue* queue = &pool->queues[as_faa_uint32(&pool->next, 1) % max];
+
+	pthread_mutex_lock(&queue->lock);
+	as_queue_push(&queue->tasks[priority], &task);
+	pthread_mutex_unlock(&queue->lock);
+
+	as_incr_uint32(&pool->queued);
+
+	// Only take the pool lock when a worker is waiting for tasks.
+	if (as_load_uint32(&pool->idle) > 0) {
+		pthread_mutex_lock(&pool->lock);
+		pthread_cond_signal(&pool->cond);
+		pthread_mutex_unlock(&pool->lock);
+	}
+	return 0;
+}
+
+int
+as_work_pool_destroy(as_work_pool* pool)
+{
+	if (! pool->queues) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	pool->shutdown = true;
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	uint32_t max = pool->thread_size;
+
+	for (uint32_t i = 0; i < max; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+
+	as_work_pool_release(pool, max > 0 ? max : 1);
+	return 0;
+}
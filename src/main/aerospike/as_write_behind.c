@@ -0,0 +1,1029 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_write_behind.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_msgpack.h>
+#include <aerospike/as_rate_limiter.h>
+#include <aerospike/as_serializer.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define AS_WB_LOG_MAGIC 0x4153574c
+#define AS_WB_LOG_VERSION 1
+
+// Maximum time the background thread sleeps between checks for retries and replay.
+#define AS_WB_WAIT_MS 10
+
+#define AS_WB_ALIGN(_n) (((_n) + 7) & ~(uint64_t)7)
+
+//---------------------------------
+// Types
+//---------------------------------
+
+// Serialized put: digest (20) | ttl (4) | ns length (1) | ns | set length (1) | set |
+// user key size (4) | user key | bin count (2) | { name length (1) | name | value size (4) |
+// value }. Values are msgpack encoded. The same layout is used in memory and in the log.
+typedef struct as_wb_entry_s {
+	struct as_wb_entry_s* next;
+	uint32_t size;
+	uint8_t data[];
+} as_wb_entry;
+
+typedef struct as_wb_lane_s {
+	struct as_write_behind_s* wb;
+	as_wb_entry* head;
+	as_wb_entry* tail;
+
+	// Lane is stalled until this time after a temporary failure. Zero if not stalled.
+	uint64_t retry_ms;
+
+	// Head entry is in flight.
+	bool busy;
+} as_wb_lane;
+
+// Spill log file header. Offsets are logical and grow while the log is not empty. The
+// position in data is the offset modulo capacity. Each log record is a 4 byte size followed
+// by the entry data, padded to 8 bytes. Records never wrap. A zero size, or too little space
+// for a size, marks the unused end of data before the log wraps.
+typedef struct as_wb_log_s {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t read_off;
+	uint64_t write_off;
+	uint8_t data[];
+} as_wb_log;
+
+struct as_write_behind_s {
+	aerospike* as;
+	as_write_behind_config config;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+	as_wb_lane* lanes;
+	as_wb_log* log;
+	uint64_t log_capacity;
+	size_t log_size;
+	as_rate_limiter limiter;
+	uint32_t pending;
+	uint32_t in_flight;
+
+	// Time of the last temporary failure. Replay is rate limited until retry_delay_ms later.
+	uint64_t failure_ms;
+	bool valid;
+	bool closing;
+	uint64_t written;
+	uint64_t retried;
+	uint64_t failed;
+	uint64_t rejected;
+};
+
+typedef struct as_wb_reader_s {
+	uint8_t* p;
+	uint8_t* end;
+} as_wb_reader;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+as_wb_listener(as_error* err, void* udata, as_event_loop* event_loop);
+
+static inline bool
+as_wb_retryable(as_status status)
+{
+	switch (status) {
+		case AEROSPIKE_MAX_ERROR_RATE:
+		case AEROSPIKE_ERR_ASYNC_QUEUE_FULL:
+		case AEROSPIKE_ERR_CONNECTION:
+		case AEROSPIKE_ERR_INVALID_NODE:
+		case AEROSPIKE_ERR_NO_MORE_CONNECTIONS:
+		case AEROSPIKE_ERR_ASYNC_CONNECTION:
+		case AEROSPIKE_ERR_CLUSTER_CHANGE:
+		case AEROSPIKE_ERR_TIMEOUT:
+		case AEROSPIKE_ERR_CLUSTER:
+		case AEROSPIKE_ERR_RECORD_BUSY:
+		case AEROSPIKE_ERR_DEVICE_OVERLOAD:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static as_wb_entry*
+as_wb_encode(as_error* err, const as_key* key, as_record* rec)
+{
+	as_digest* digest = as_key_digest((as_key*)key);
+
+	if (! digest) {
+		as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Invalid key");
+		return NULL;
+	}
+
+	size_t ns_len = strlen(key->ns);
+	size_t set_len = strlen(key->set);
+	uint16_t n_bins = rec->bins.size;
+	as_bin* bins = rec->bins.entries;
+
+	// Compute packed sizes first.
+	as_packer pk = {.buffer = NULL, .capacity = UINT32_MAX};
+	size_t size = AS_DIGEST_VALUE_SIZE + 4 + 1 + ns_len + 1 + set_len + 4 + 2;
+
+	if (key->valuep && as_pack_val(&pk, (as_val*)key->valuep) != 0) {
+		as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Key serialization failed");
+		return NULL;
+	}
+	size += pk.offset;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		pk.offset = 0;
+
+		if (bins[i].valuep && as_pack_val(&pk, (as_val*)bins[i].valuep) != 0) {
+			as_error_update(err, AEROSPIKE_ERR_PARAM, "Bin %s serialization failed",
+				bins[i].name);
+			return NULL;
+		}
+		size += 1 + strlen(bins[i].name) + 4 + pk.offset;
+	}
+
+	if (size > UINT32_MAX) {
+		as_error_set_message(err, AEROSPIKE_ERR_PARAM, "Record too large");
+		return NULL;
+	}
+
+	as_wb_entry* entry = cf_malloc(sizeof(as_wb_entry) + size);
+	entry->next = NULL;
+	entry->size = (uint32_t)size;
+
+	uint8_t* p = entry->data;
+	memcpy(p, digest->value, AS_DIGEST_VALUE_SIZE);
+	p += AS_DIGEST_VALUE_SIZE;
+
+	uint32_t ttl = rec->ttl;
+	memcpy(p, &ttl, 4);
+	p += 4;
+	*p++ = (uint8_t)ns_len;
+	memcpy(p, key->ns, ns_len);
+	p += ns_len;
+	*p++ = (uint8_t)set_len;
+	memcpy(p, key->set, set_len);
+	p += set_len;
+
+	uint32_t len = 0;
+
+	if (key->valuep) {
+		as_packer kp = {.buffer = p + 4, .capacity = UINT32_MAX};
+		as_pack_val(&kp, (as_val*)key->valuep);
+		len = kp.offset;
+	}
+	memcpy(p, &len, 4);
+	p += 4 + len;
+
+	memcpy(p, &n_bins, 2);
+	p += 2;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		size_t name_len = strlen(bins[i].name);
+		*p++ = (uint8_t)name_len;
+		memcpy(p, bins[i].name, name_len);
+		p += name_len;
+
+		len = 0;
+
+		if (bins[i].valuep) {
+			as_packer vp = {.buffer = p + 4, .capacity = UINT32_MAX};
+			as_pack_val(&vp, (as_val*)bins[i].valuep);
+			len = vp.offset;
+		}
+		memcpy(p, &len, 4);
+		p += 4 + len;
+	}
+	return entry;
+}
+
+static inline bool
+as_wb_read(as_wb_reader* r, void* out, size_t size)
+{
+	if ((size_t)(r->end - r->p) < size) {
+		return false;
+	}
+	memcpy(out, r->p, size);
+	r->p += size;
+	return true;
+}
+
+static bool
+as_wb_read_name(as_wb_reader* r, char* name, size_t capacity)
+{
+	uint8_t len;
+
+	if (! as_wb_read(r, &len, 1) || len >= capacity) {
+		return false;
+	}
+
+	if (! as_wb_read(r, name, len)) {
+		return false;
+	}
+	name[len] = 0;
+	return true;
+}
+
+static bool
+as_wb_read_val(as_wb_reader* r, as_val** val)
+{
+	uint32_t len;
+
+	if (! as_wb_read(r, &len, 4) || (size_t)(r->end - r->p) < len) {
+		return false;
+	}
+
+	if (len == 0) {
+		*val = NULL;
+		return true;
+	}
+
+	as_buffer buffer;
+	buffer.data = r->p;
+	buffer.size = len;
+	r->p += len;
+
+	as_serializer ser;
+	as_msgpack_init(&ser);
+	int rv = as_serializer_deserialize(&ser, &buffer, val);
+	as_serializer_destroy(&ser);
+	return rv == 0;
+}
+
+// Decode key and record. The caller destroys the record and the user key value.
+static as_status
+as_wb_decode(
+	as_error* err, as_wb_entry* entry, as_key* key, as_val** key_val, as_record* rec
+	)
+{
+	as_wb_reader r = {.p = entry->data, .end = entry->data + entry->size};
+	as_digest_value digest;
+	uint32_t ttl;
+	as_namespace ns;
+	as_set set;
+	uint16_t n_bins;
+
+	*key_val = NULL;
+
+	if (! as_wb_read(&r, digest, AS_DIGEST_VALUE_SIZE) || ! as_wb_read(&r, &ttl, 4) ||
+		! as_wb_read_name(&r, ns, sizeof(ns)) || ! as_wb_read_name(&r, set, sizeof(set)) ||
+		! as_wb_read_val(&r, key_val) || ! as_wb_read(&r, &n_bins, 2)) {
+		as_val_destroy(*key_val);
+		*key_val = NULL;
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Corrupt write-behind entry");
+	}
+
+	if (*key_val) {
+		as_key_init_value(key, ns, set, (as_key_value*)*key_val);
+		key->digest.init = true;
+		memcpy(key->digest.value, digest, AS_DIGEST_VALUE_SIZE);
+	}
+	else {
+		as_key_init_digest(key, ns, set, digest);
+	}
+
+	as_record_init(rec, n_bins);
+	rec->ttl = ttl;
+
+	for (uint16_t i = 0; i < n_bins; i++) {
+		as_bin_name name;
+		as_val* val;
+
+		if (! as_wb_read_name(&r, name, sizeof(name)) || ! as_wb_read_val(&r, &val)) {
+			as_record_destroy(rec);
+			as_val_destroy(*key_val);
+			*key_val = NULL;
+			return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Corrupt write-behind entry");
+		}
+		if (val) {
+			as_record_set(rec, name, (as_bin_value*)val);
+		}
+		else {
+			as_record_set_nil(rec, name);
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+static inline as_wb_lane*
+as_wb_lane_get(as_write_behind* wb, as_wb_entry* entry)
+{
+	uint32_t h;
+	memcpy(&h, entry->data, sizeof(h));
+	return &wb->lanes[h % wb->config.lanes];
+}
+
+// Must hold lock. Append entry to its lane and return true if the caller must send it.
+static bool
+as_wb_lane_push(as_write_behind* wb, as_wb_entry* entry, as_wb_lane** lane_out)
+{
+	as_wb_lane* lane = as_wb_lane_get(wb, entry);
+
+	if (lane->tail) {
+		lane->tail->next = entry;
+	}
+	else {
+		lane->head = entry;
+	}
+	lane->tail = entry;
+	wb->pending++;
+	*lane_out = lane;
+
+	if (lane->busy || lane->retry_ms != 0 || wb->closing) {
+		return false;
+	}
+	lane->busy = true;
+	wb->in_flight++;
+	return true;
+}
+
+// Must hold lock. Return first stalled lane whose retry time has passed and mark it busy.
+static as_wb_lane*
+as_wb_lane_retry(as_write_behind* wb, uint64_t now)
+{
+	for (uint32_t i = 0; i < wb->config.lanes; i++) {
+		as_wb_lane* lane = &wb->lanes[i];
+
+		if (! lane->busy && lane->head && lane->retry_ms != 0 && lane->retry_ms <= now) {
+			lane->retry_ms = 0;
+			lane->busy = true;
+			wb->in_flight++;
+			return lane;
+		}
+	}
+	return NULL;
+}
+
+static void
+as_wb_notify(as_write_behind* wb, as_error* err, as_wb_entry* entry)
+{
+	if (! wb->config.listener) {
+		return;
+	}
+
+	as_key key;
+	as_val* key_val;
+	as_record rec;
+	as_error derr;
+
+	if (as_wb_decode(&derr, entry, &key, &key_val, &rec) != AEROSPIKE_OK) {
+		return;
+	}
+	as_record_destroy(&rec);
+	wb->config.listener(err, &key, wb->config.udata);
+	as_val_destroy(key_val);
+}
+
+// Finish head write of a busy lane. Return true if the next write of the lane must be sent.
+static bool
+as_wb_finish(as_wb_lane* lane, as_error* err)
+{
+	as_write_behind* wb = lane->wb;
+
+	pthread_mutex_lock(&wb->lock);
+	wb->in_flight--;
+	lane->busy = false;
+
+	if (err && as_wb_retryable(err->code)) {
+		// Keep write at head of lane so later writes to the same key wait behind it.
+		wb->failure_ms = cf_getms();
+		lane->retry_ms = wb->failure_ms + wb->config.retry_delay_ms;
+		wb->retried++;
+
+		if (wb->closing) {
+			pthread_cond_broadcast(&wb->cond);
+		}
+		pthread_mutex_unlock(&wb->lock);
+		return false;
+	}
+
+	as_wb_entry* entry = lane->head;
+	lane->head = entry->next;
+
+	if (! lane->head) {
+		lane->tail = NULL;
+	}
+	wb->pending--;
+
+	if (err) {
+		wb->failed++;
+	}
+	else {
+		wb->written++;
+	}
+
+	bool next = lane->head && ! wb->closing;
+
+	if (next) {
+		lane->busy = true;
+		wb->in_flight++;
+	}
+	else if (wb->closing) {
+		pthread_cond_broadcast(&wb->cond);
+	}
+
+	if (wb->log && wb->log->read_off != wb->log->write_off && ! wb->closing) {
+		// Memory freed up. Wake the thread to replay the next spilled write.
+		pthread_cond_signal(&wb->cond);
+	}
+	pthread_mutex_unlock(&wb->lock);
+
+	if (err) {
+		as_wb_notify(wb, err, entry);
+	}
+	cf_free(entry);
+	return next;
+}
+
+// Send head writes of a busy lane until one is in flight or the lane is idle.
+static void
+as_wb_run(as_wb_lane* lane)
+{
+	as_write_behind* wb = lane->wb;
+
+	while (true) {
+		// Head is only removed by as_wb_finish(), so it is stable while the lane is busy.
+		as_wb_entry* entry = lane->head;
+		as_error err;
+		as_key key;
+		as_val* key_val;
+		as_record rec;
+
+		as_error_init(&err);
+
+		as_status status = as_wb_decode(&err, entry, &key, &key_val, &rec);
+
+		if (status == AEROSPIKE_OK) {
+			status = aerospike_key_put_async(wb->as, &err, &wb->config.policy, &key, &rec,
+				as_wb_listener, lane, NULL, NULL);
+			as_record_destroy(&rec);
+			as_val_destroy(key_val);
+		}
+
+		if (status == AEROSPIKE_OK || ! as_wb_finish(lane, &err)) {
+			return;
+		}
+	}
+}
+
+static void
+as_wb_listener(as_error* err, void* udata, as_event_loop* event_loop)
+{
+	as_wb_lane* lane = udata;
+
+	if (as_wb_finish(lane, err)) {
+		as_wb_run(lane);
+	}
+}
+
+// Must hold lock. Append entry to spill log.
+static as_status
+as_wb_log_append(as_write_behind* wb, as_error* err, as_wb_entry* entry)
+{
+	as_wb_log* log = wb->log;
+	uint64_t size = AS_WB_ALIGN(4 + (uint64_t)entry->size);
+	uint64_t pos = log->write_off % wb->log_capacity;
+	uint64_t pad = (wb->log_capacity - pos < size) ? wb->log_capacity - pos : 0;
+
+	if (wb->log_capacity - (log->write_off - log->read_off) < pad + size) {
+		wb->rejected++;
+		return as_error_set_message(err, AEROSPIKE_ERR_ASYNC_QUEUE_FULL,
+			"Write-behind memory and spill log are full");
+	}
+
+	uint64_t write_off = log->write_off;
+
+	if (pad) {
+		memset(log->data + pos, 0, 4);
+		write_off += pad;
+		pos = 0;
+	}
+
+	uint8_t* p = log->data + pos;
+	memcpy(p, &entry->size, 4);
+	memcpy(p + 4, entry->data, entry->size);
+
+	// Publish offset after the record is written, so a crash never exposes a partial record.
+	as_store_uint64_rls(&log->write_off, write_off + size);
+	return AEROSPIKE_OK;
+}
+
+// Must hold lock. Move next spilled write into memory. Return NULL if log is empty.
+static as_wb_entry*
+as_wb_log_pop(as_write_behind* wb)
+{
+	as_wb_log* log = wb->log;
+
+	if (! log || log->read_off == log->write_off) {
+		return NULL;
+	}
+
+	uint64_t pos = log->read_off % wb->log_capacity;
+	uint64_t rem = wb->log_capacity - pos;
+	uint32_t size;
+	memcpy(&size, log->data + pos, 4);
+
+	if (size == 0 && rem < log->write_off - log->read_off) {
+		// Unused end of data. Continue at the beginning.
+		log->read_off += rem;
+		pos = 0;
+		memcpy(&size, log->data, 4);
+	}
+
+	uint8_t* p = log->data + pos;
+	uint64_t rec_size = AS_WB_ALIGN(4 + (uint64_t)size);
+
+	if (size == 0 || log->read_off + rec_size > log->write_off ||
+		pos + rec_size > wb->log_capacity) {
+		as_log_error("Corrupt write-behind spill log at offset %" PRIu64 ". Dropping %" PRIu64
+			" bytes", log->read_off, log->write_off - log->read_off);
+		log->read_off = 0;
+		log->write_off = 0;
+		return NULL;
+	}
+
+	as_wb_entry* entry = cf_malloc(sizeof(as_wb_entry) + size);
+	entry->next = NULL;
+	entry->size = size;
+	memcpy(entry->data, p + 4, size);
+
+	log->read_off += rec_size;
+
+	if (log->read_off == log->write_off) {
+		// Log drained. Start over at the beginning of the file.
+		log->read_off = 0;
+		as_store_uint64_rls(&log->write_off, 0);
+	}
+	return entry;
+}
+
+static inline bool
+as_wb_log_empty(as_write_behind* wb)
+{
+	return ! wb->log || wb->log->read_off == wb->log->write_off;
+}
+
+static void*
+as_wb_thread(void* udata)
+{
+	as_write_behind* wb = udata;
+
+	pthread_mutex_lock(&wb->lock);
+
+	while (wb->valid) {
+		uint64_t now = cf_getms();
+		as_wb_lane* lane;
+
+		// Retry stalled lanes.
+		while (wb->valid && (lane = as_wb_lane_retry(wb, now)) != NULL) {
+			pthread_mutex_unlock(&wb->lock);
+			as_rate_limiter_acquire(&wb->limiter, 1);
+			as_wb_run(lane);
+			pthread_mutex_lock(&wb->lock);
+		}
+
+		// Replay spilled writes while memory is available. Replay is only rate limited while
+		// writes fail with temporary errors. Spilled writes are replayed in order, and new
+		// puts spill while the log is not empty, so writes to a key stay ordered.
+		while (wb->valid && wb->pending < wb->config.max_pending) {
+			as_wb_entry* entry = as_wb_log_pop(wb);
+
+			if (! entry) {
+				break;
+			}
+
+			bool limit = wb->failure_ms != 0 &&
+				cf_getms() < wb->failure_ms + wb->config.retry_delay_ms;
+			bool run = as_wb_lane_push(wb, entry, &lane);
+			pthread_mutex_unlock(&wb->lock);
+
+			if (limit) {
+				as_rate_limiter_acquire(&wb->limiter, 1);
+			}
+
+			if (run) {
+				as_wb_run(lane);
+			}
+			pthread_mutex_lock(&wb->lock);
+		}
+
+		if (! wb->valid) {
+			break;
+		}
+
+		struct timespec delta;
+		struct timespec abstime;
+		cf_clock_set_timespec_ms(AS_WB_WAIT_MS, &delta);
+		cf_clock_current_add(&delta, &abstime);
+		pthread_cond_timedwait(&wb->cond, &wb->lock, &abstime);
+	}
+	pthread_mutex_unlock(&wb->lock);
+	return NULL;
+}
+
+// Walk log records from read to write offset. Return false if offsets or a record size are
+// corrupt, so the log is cleared on open instead of during replay.
+static bool
+as_wb_log_valid(as_wb_log* log, uint64_t capacity)
+{
+	if (log->read_off > log->write_off || log->write_off - log->read_off > capacity ||
+		(log->read_off & 7) != 0 || (log->write_off & 7) != 0) {
+		return false;
+	}
+
+	uint64_t off = log->read_off;
+
+	// Each step moves at least 8 bytes forward.
+	while (off < log->write_off) {
+		uint64_t pos = off % capacity;
+		uint64_t rem = capacity - pos;
+		uint32_t size;
+		memcpy(&size, log->data + pos, 4);
+
+		if (size == 0) {
+			// Unused end of data must be followed by a record at the beginning.
+			if (rem >= log->write_off - off) {
+				return false;
+			}
+			off += rem;
+			continue;
+		}
+
+		uint64_t rec_size = AS_WB_ALIGN(4 + (uint64_t)size);
+
+		if (pos + rec_size > capacity || off + rec_size > log->write_off) {
+			return false;
+		}
+		off += rec_size;
+	}
+	return true;
+}
+
+#if !defined(_MSC_VER)
+
+static as_status
+as_wb_log_open(as_write_behind* wb, as_error* err, const char* path)
+{
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+
+	if (fd < 0) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to open %s: %s",
+							   path, strerror(errno));
+	}
+
+	struct stat stats;
+
+	if (fstat(fd, &stats) != 0) {
+		int e = errno;
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to stat %s: %s",
+							   path, strerror(e));
+	}
+
+	size_t size = (size_t)stats.st_size;
+
+	if (size == 0) {
+		size = (size_t)wb->config.spill_size;
+
+		if (ftruncate(fd, (off_t)size) != 0) {
+			int e = errno;
+			close(fd);
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to size %s: %s",
+								   path, strerror(e));
+		}
+	}
+
+	if (size < sizeof(as_wb_log) + 8) {
+		close(fd);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Spill log %s is too small: %zu",
+							   path, size);
+	}
+
+	void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	int e = errno;
+
+	// The mapping remains valid after the descriptor is closed.
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT, "Failed to map %s: %s",
+							   path, strerror(e));
+	}
+
+	as_wb_log* log = data;
+	// Records are 8 byte aligned, so the end of data is too.
+	uint64_t capacity = (size - sizeof(as_wb_log)) & ~(uint64_t)7;
+
+	if (log->magic == 0) {
+		// New log. Zeroed offsets are empty.
+		log->version = AS_WB_LOG_VERSION;
+		log->magic = AS_WB_LOG_MAGIC;
+	}
+	else if (log->magic != AS_WB_LOG_MAGIC || log->version != AS_WB_LOG_VERSION) {
+		// The file may not be a spill log, so it is not overwritten.
+		munmap(data, size);
+		return as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid spill log %s", path);
+	}
+	else if (! as_wb_log_valid(log, capacity)) {
+		as_log_error("Corrupt write-behind spill log %s. Dropping %" PRIu64 " bytes", path,
+			(log->write_off > log->read_off) ? log->write_off - log->read_off : 0);
+		log->read_off = 0;
+		log->write_off = 0;
+	}
+	else if (log->write_off > 0) {
+		as_log_info("Replaying %" PRIu64 " bytes from spill log %s",
+			log->write_off - log->read_off, path);
+	}
+
+	wb->log = log;
+	wb->log_size = size;
+	wb->log_capacity = capacity;
+	return AEROSPIKE_OK;
+}
+
+static void
+as_wb_log_close(as_write_behind* wb)
+{
+	if (wb->log) {
+		msync(wb->log, wb->log_size, MS_SYNC);
+		munmap(wb->log, wb->log_size);
+		wb->log = NULL;
+	}
+}
+
+#else
+
+static as_status
+as_wb_log_open(as_write_behind* wb, as_error* err, const char* path)
+{
+	return as_error_set_message(err, AEROSPIKE_ERR_PARAM,
+		"Write-behind spill log is not supported on Windows");
+}
+
+static void
+as_wb_log_close(as_write_behind* wb)
+{
+}
+
+#endif
+
+// Must hold lock. Save writes left in memory to the spill log in front of spilled writes,
+// so they are replayed first.
+static void
+as_wb_save(as_write_behind* wb)
+{
+	uint64_t total = 0;
+
+	for (uint32_t i = 0; i < wb->config.lanes; i++) {
+		for (as_wb_entry* e = wb->lanes[i].head; e; e = e->next) {
+			total += AS_WB_ALIGN(4 + (uint64_t)e->size);
+		}
+	}
+
+	if (total == 0) {
+		return;
+	}
+
+	as_wb_log* log = wb->log;
+	uint64_t pos;
+
+	if (! log) {
+		return;
+	}
+
+	if (log->read_off == log->write_off) {
+		if (total > wb->log_capacity) {
+			return;
+		}
+		pos = 0;
+		log->write_off = total;
+	}
+	else if (total <= log->read_off % wb->log_capacity &&
+		total <= wb->log_capacity - (log->write_off - log->read_off)) {
+		// Saved writes must fit in front of the oldest spilled write without wrapping.
+		pos = log->read_off - total;
+	}
+	else {
+		return;
+	}
+	log->read_off = pos;
+
+	for (uint32_t i = 0; i < wb->config.lanes; i++) {
+		as_wb_lane* lane = &wb->lanes[i];
+		as_wb_entry* e = lane->head;
+
+		while (e) {
+			as_wb_entry* next = e->next;
+			uint8_t* p = log->data + pos % wb->log_capacity;
+			memcpy(p, &e->size, 4);
+			memcpy(p + 4, e->data, e->size);
+			pos += AS_WB_ALIGN(4 + (uint64_t)e->size);
+			cf_free(e);
+			e = next;
+		}
+		lane->head = NULL;
+		lane->tail = NULL;
+	}
+	wb->pending = 0;
+}
+
+static void
+as_wb_release(as_write_behind* wb)
+{
+	as_wb_log_close(wb);
+	pthread_cond_destroy(&wb->cond);
+	pthread_mutex_destroy(&wb->lock);
+	cf_free((char*)wb->config.spill_path);
+	cf_free(wb->lanes);
+	cf_free(wb);
+}
+
+//---------------------------------
+// Functions
+//---------------------------------
+
+void
+as_write_behind_config_init(as_write_behind_config* config)
+{
+	as_policy_write_init(&config->policy);
+	config->spill_path = NULL;
+	config->spill_size = (uint64_t)64 * 1024 * 1024;
+	config->max_pending = 10000;
+	config->lanes = 64;
+	config->replay_rate = 5000;
+	config->retry_delay_ms = 100;
+	config->listener = NULL;
+	config->udata = NULL;
+}
+
+as_write_behind*
+as_write_behind_create(aerospike* as, as_error* err, const as_write_behind_config* config)
+{
+	as_error_reset(err);
+
+	if (config->max_pending == 0 || config->lanes == 0) {
+		as_error_set_message(err, AEROSPIKE_ERR_PARAM, "max_pending and lanes must be positive");
+		return NULL;
+	}
+
+	as_write_behind* wb = cf_malloc(sizeof(as_write_behind));
+	memset(wb, 0, sizeof(as_write_behind));
+	wb->as = as;
+	wb->config = *config;
+	wb->config.spill_path = config->spill_path ? cf_strdup(config->spill_path) : NULL;
+	wb->lanes = cf_calloc(config->lanes, sizeof(as_wb_lane));
+
+	for (uint32_t i = 0; i < config->lanes; i++) {
+		wb->lanes[i].wb = wb;
+	}
+
+	pthread_mutex_init(&wb->lock, NULL);
+	pthread_cond_init(&wb->cond, NULL);
+	as_rate_limiter_init(&wb->limiter, config->replay_rate);
+
+	if (config->spill_path && as_wb_log_open(wb, err, config->spill_path) != AEROSPIKE_OK) {
+		as_wb_release(wb);
+		return NULL;
+	}
+
+	wb->valid = true;
+
+	if (pthread_create(&wb->thread, NULL, as_wb_thread, wb) != 0) {
+		as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Failed to create write-behind thread");
+		as_wb_release(wb);
+		return NULL;
+	}
+	return wb;
+}
+
+as_status
+as_write_behind_put(as_write_behind* wb, as_error* err, const as_key* key, as_record* rec)
+{
+	as_error_reset(err);
+
+	as_wb_entry* entry = as_wb_encode(err, key, rec);
+
+	if (! entry) {
+		return err->code;
+	}
+
+	pthread_mutex_lock(&wb->lock);
+
+	if (wb->closing) {
+		pthread_mutex_unlock(&wb->lock);
+		cf_free(entry);
+		return as_error_set_message(err, AEROSPIKE_ERR_CLIENT, "Write-behind buffer is closed");
+	}
+
+	if (wb->pending >= wb->config.max_pending || ! as_wb_log_empty(wb)) {
+		// Writes are spilled while the log is not empty, so they are replayed after the
+		// writes spilled before them.
+		as_status status;
+
+		if (wb->log) {
+			status = as_wb_log_append(wb, err, entry);
+		}
+		else {
+			wb->rejected++;
+			status = as_error_set_message(err, AEROSPIKE_ERR_ASYNC_QUEUE_FULL,
+				"Write-behind memory is full");
+		}
+		pthread_mutex_unlock(&wb->lock);
+		cf_free(entry);
+		return status;
+	}
+
+	as_wb_lane* lane;
+	bool run = as_wb_lane_push(wb, entry, &lane);
+	pthread_mutex_unlock(&wb->lock);
+
+	if (run) {
+		as_wb_run(lane);
+	}
+	return AEROSPIKE_OK;
+}
+
+void
+as_write_behind_get_stats(as_write_behind* wb, as_write_behind_stats* stats)
+{
+	pthread_mutex_lock(&wb->lock);
+	stats->pending = wb->pending;
+	stats->spilled_bytes = wb->log ? wb->log->write_off - wb->log->read_off : 0;
+	stats->written = wb->written;
+	stats->retried = wb->retried;
+	stats->failed = wb->failed;
+	stats->rejected = wb->rejected;
+	pthread_mutex_unlock(&wb->lock);
+}
+
+void
+as_write_behind_destroy(as_write_behind* wb)
+{
+	pthread_mutex_lock(&wb->lock);
+	wb->closing = true;
+	wb->valid = false;
+	pthread_cond_broadcast(&wb->cond);
+	pthread_mutex_unlock(&wb->lock);
+	pthread_join(wb->thread, NULL);
+
+	pthread_mutex_lock(&wb->lock);
+
+	while (wb->in_flight > 0) {
+		pthread_cond_wait(&wb->cond, &wb->lock);
+	}
+
+	as_wb_save(wb);
+	pthread_mutex_unlock(&wb->lock);
+
+	// Report writes that could not be saved. No other thread uses the buffer now.
+	as_error err;
+	as_error_init(&err);
+	as_error_set_message(&err, AEROSPIKE_ERR_CLIENT_ABORT, "Write-behind buffer closed");
+
+	for (uint32_t i = 0; i < wb->config.lanes; i++) {
+		as_wb_entry* e = wb->lanes[i].head;
+
+		while (e) {
+			as_wb_entry* next = e->next;
+			as_wb_notify(wb, &err, e);
+			cf_free(e);
+			e = next;
+		}
+	}
+	as_wb_release(wb);
+}
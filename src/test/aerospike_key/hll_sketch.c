@@ -0,0 +1,424 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_hll.h>
+#include <aerospike/as_status.h>
+#include <citrusleaf/alloc.h>
+#include <math.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Server HLL bin header: flags, n_index_bits, n_minhash_bits and cached cardinality.
+#define HEADER_SIZE 11
+#define HLL_BITS 6
+#define MAX_MINHASH_BITS 51
+#define MAX_REGISTERS (1 << AS_HLL_MAX_INDEX_BITS)
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+static uint64_t g_seed;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint64_t
+hll_random(void)
+{
+	// splitmix64
+	uint64_t z = (g_seed += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static uint64_t
+hll_hash(uint64_t v)
+{
+	uint64_t z = v + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Add element to registers the way the server does: the top index bits select the register
+// and the register keeps the maximum number of leading zeros of the remaining bits plus one.
+static void
+hll_add(uint8_t* registers, uint8_t n_index_bits, uint64_t element)
+{
+	uint64_t h = hll_hash(element);
+	uint32_t index = (uint32_t)(h >> (64 - n_index_bits));
+	uint64_t w = h << n_index_bits;
+	uint8_t v = w ? (uint8_t)(__builtin_clzll(w) + 1) : (uint8_t)(64 - n_index_bits + 1);
+
+	if (v > registers[index]) {
+		registers[index] = v;
+	}
+}
+
+// Fill registers with random HLL values, so every value from 0 to 63 is used.
+static void
+hll_random_registers(uint8_t* registers, uint32_t n_registers)
+{
+	for (uint32_t i = 0; i < n_registers; i++) {
+		registers[i] = (uint8_t)(hll_random() & 0x3F);
+	}
+}
+
+static void
+hll_set_bits(uint8_t* buf, uint64_t bit, uint64_t value, uint32_t n_bits)
+{
+	// Most significant bit first.
+	for (uint32_t i = 0; i < n_bits; i++) {
+		uint64_t b = bit + i;
+
+		if ((value >> (n_bits - 1 - i)) & 1) {
+			buf[b >> 3] |= (uint8_t)(0x80 >> (b & 7));
+		}
+	}
+}
+
+// Pack registers in the server HLL bin format with random MinHash bits.
+static as_bytes*
+hll_pack(const uint8_t* registers, uint8_t n_index_bits, uint8_t n_minhash_bits)
+{
+	uint32_t n_registers = (uint32_t)1 << n_index_bits;
+	uint32_t reg_bits = HLL_BITS + n_minhash_bits;
+	uint32_t size = HEADER_SIZE + (uint32_t)(((uint64_t)n_registers * reg_bits + 7) / 8);
+	uint8_t* buf = cf_calloc(size, 1);
+
+	buf[1] = n_index_bits;
+	buf[2] = n_minhash_bits;
+
+	for (uint32_t i = 0; i < n_registers; i++) {
+		uint64_t bit = (uint64_t)HEADER_SIZE * 8 + (uint64_t)i * reg_bits;
+		hll_set_bits(buf, bit, registers[i], HLL_BITS);
+
+		if (n_minhash_bits > 0) {
+			uint64_t minhash = hll_random() & (((uint64_t)1 << n_minhash_bits) - 1);
+			hll_set_bits(buf, bit + HLL_BITS, minhash, n_minhash_bits);
+		}
+	}
+
+	as_bytes* bytes = as_bytes_new_wrap(buf, size, true);
+	bytes->type = AS_BYTES_HLL;
+	return bytes;
+}
+
+static void
+hll_max(uint8_t* dst, const uint8_t* src, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		if (src[i] > dst[i]) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+// Return if estimate is within four standard errors of the exact count. Small counts are
+// allowed an absolute error of two.
+static bool
+hll_estimate_ok(uint64_t estimate, uint64_t exact, uint32_t n_registers)
+{
+	double error = fabs((double)estimate - (double)exact);
+	double limit = 4.0 * 1.04 / sqrt((double)n_registers) * (double)exact + 2.0;
+	return error <= limit;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(hll_sketch_merge_bytes, "merge packed server values for all index and minhash bits") {
+	static const uint8_t minhash_bits[] = {0, 1, 2, 3, 7, 12, 26, MAX_MINHASH_BITS};
+	uint8_t* r1 = cf_malloc(MAX_REGISTERS);
+	uint8_t* r2 = cf_malloc(MAX_REGISTERS);
+	uint8_t* expect = cf_malloc(MAX_REGISTERS);
+	bool ok = true;
+
+	g_seed = 1;
+
+	for (uint8_t ib = AS_HLL_MIN_INDEX_BITS; ib <= AS_HLL_MAX_INDEX_BITS && ok; ib++) {
+		uint32_t n = (uint32_t)1 << ib;
+
+		for (uint32_t m = 0; m < sizeof(minhash_bits) && ok; m++) {
+			// Second value has different MinHash bits, which must not matter.
+			uint8_t mb1 = minhash_bits[m];
+			uint8_t mb2 = minhash_bits[(m + 3) % sizeof(minhash_bits)];
+
+			hll_random_registers(r1, n);
+			hll_random_registers(r2, n);
+
+			as_bytes* b1 = hll_pack(r1, ib, mb1);
+			as_bytes* b2 = hll_pack(r2, ib, mb2);
+
+			as_error err;
+			as_hll hll;
+
+			ok = as_hll_init_bytes(&hll, &err, b1) == AEROSPIKE_OK;
+			ok = ok && hll.n_registers == n && hll.n_index_bits == ib &&
+				memcmp(hll.registers, r1, n) == 0;
+
+			if (ok) {
+				memcpy(expect, r1, n);
+				hll_max(expect, r2, n);
+				ok = as_hll_merge_bytes(&hll, &err, b2) == AEROSPIKE_OK &&
+					memcmp(hll.registers, expect, n) == 0;
+				as_hll_destroy(&hll);
+			}
+
+			if (! ok) {
+				info("index bits %u minhash bits %u/%u", ib, mb1, mb2);
+			}
+			as_bytes_destroy(b1);
+			as_bytes_destroy(b2);
+		}
+	}
+
+	cf_free(expect);
+	cf_free(r2);
+	cf_free(r1);
+	assert_true(ok);
+}
+
+TEST(hll_sketch_merge, "merge sketches for all index bits") {
+	uint8_t* expect = cf_malloc(MAX_REGISTERS);
+	bool ok = true;
+
+	g_seed = 2;
+
+	for (uint8_t ib = AS_HLL_MIN_INDEX_BITS; ib <= AS_HLL_MAX_INDEX_BITS && ok; ib++) {
+		as_error err;
+		as_hll a;
+		as_hll b;
+
+		as_hll_init(&a, &err, ib);
+		as_hll_init(&b, &err, ib);
+		hll_random_registers(a.registers, a.n_registers);
+		hll_random_registers(b.registers, b.n_registers);
+
+		memcpy(expect, a.registers, a.n_registers);
+		hll_max(expect, b.registers, b.n_registers);
+
+		ok = as_hll_merge(&a, &err, &b) == AEROSPIKE_OK &&
+			memcmp(a.registers, expect, a.n_registers) == 0;
+
+		if (! ok) {
+			info("index bits %u", ib);
+		}
+		as_hll_destroy(&a);
+		as_hll_destroy(&b);
+	}
+
+	cf_free(expect);
+	assert_true(ok);
+}
+
+TEST(hll_sketch_merge_tail, "merge register counts that are not a multiple of the SIMD width") {
+	uint8_t dst[200];
+	uint8_t src[200];
+	uint8_t expect[200];
+
+	g_seed = 3;
+
+	// Register counts are powers of two in sketches created by the client. Build sketches
+	// directly, so the vector loops stop at every offset before the scalar tail.
+	for (uint32_t n = 1; n <= sizeof(dst); n++) {
+		hll_random_registers(dst, n);
+		hll_random_registers(src, n);
+
+		// Registers past n must not be touched.
+		memset(dst + n, 0x7F, sizeof(dst) - n);
+		memset(src + n, 0x7F, sizeof(src) - n);
+
+		memcpy(expect, dst, sizeof(dst));
+		hll_max(expect, src, n);
+
+		as_hll a = {.registers = dst, .n_registers = n, .n_index_bits = 4};
+		as_hll b = {.registers = src, .n_registers = n, .n_index_bits = 4};
+		as_error err;
+
+		as_status status = as_hll_merge(&a, &err, &b);
+		assert_int_eq(status, AEROSPIKE_OK);
+
+		int cmp = memcmp(dst, expect, sizeof(dst));
+
+		if (cmp != 0) {
+			info("register count %u", n);
+		}
+		assert_int_eq(cmp, 0);
+	}
+}
+
+TEST(hll_sketch_cardinality, "cardinality of known inputs") {
+	static const uint32_t counts[] = {0, 1, 2, 10, 100, 1000, 10000, 100000, 1000000};
+	static const uint8_t index_bits[] = {10, 12, 14, 16};
+
+	for (uint32_t b = 0; b < sizeof(index_bits); b++) {
+		for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+			as_error err;
+			as_hll hll;
+
+			as_hll_init(&hll, &err, index_bits[b]);
+
+			for (uint32_t i = 0; i < counts[c]; i++) {
+				hll_add(hll.registers, hll.n_index_bits, i);
+			}
+
+			uint64_t estimate = as_hll_cardinality(&hll);
+			bool ok = hll_estimate_ok(estimate, counts[c], hll.n_registers);
+
+			if (! ok) {
+				info("index bits %u count %u estimate %" PRIu64, index_bits[b], counts[c],
+					estimate);
+			}
+			as_hll_destroy(&hll);
+			assert_true(ok);
+		}
+	}
+
+	// Empty sketch is exactly zero.
+	as_error err;
+	as_hll hll;
+	as_hll_init(&hll, &err, AS_HLL_MIN_INDEX_BITS);
+	uint64_t estimate = as_hll_cardinality(&hll);
+	as_hll_destroy(&hll);
+	assert_int_eq(estimate, 0);
+}
+
+TEST(hll_sketch_union_count, "union cardinality of overlapping server values") {
+	uint8_t* r1 = cf_calloc(1 << 14, 1);
+	uint8_t* r2 = cf_calloc(1 << 14, 1);
+
+	g_seed = 4;
+
+	// Elements 0-59999 and 40000-99999. The union has 100000 elements.
+	for (uint32_t i = 0; i < 60000; i++) {
+		hll_add(r1, 14, i);
+		hll_add(r2, 14, i + 40000);
+	}
+
+	as_bytes* values[2] = {hll_pack(r1, 14, 0), hll_pack(r2, 14, 5)};
+	as_error err;
+	uint64_t count = 0;
+	as_status status = as_hll_union_count(&err, (const as_bytes* const*)values, 2, &count);
+
+	as_bytes_destroy(values[0]);
+	as_bytes_destroy(values[1]);
+	cf_free(r2);
+	cf_free(r1);
+
+	assert_int_eq(status, AEROSPIKE_OK);
+	assert_true(hll_estimate_ok(count, 100000, 1 << 14));
+}
+
+TEST(hll_sketch_to_bytes, "serialize and reload sketches") {
+	g_seed = 5;
+
+	for (uint8_t ib = AS_HLL_MIN_INDEX_BITS; ib <= AS_HLL_MAX_INDEX_BITS; ib++) {
+		as_error err;
+		as_hll hll;
+
+		as_hll_init(&hll, &err, ib);
+		hll_random_registers(hll.registers, hll.n_registers);
+
+		as_bytes* bytes = as_hll_to_bytes(&hll);
+		bool ok = bytes->type == AS_BYTES_HLL &&
+			bytes->size == HEADER_SIZE + hll.n_registers / 4 * 3 &&
+			bytes->value[1] == ib && bytes->value[2] == 0;
+
+		as_hll copy;
+
+		if (ok) {
+			ok = as_hll_init_bytes(&copy, &err, bytes) == AEROSPIKE_OK;
+		}
+
+		if (ok) {
+			ok = copy.n_registers == hll.n_registers &&
+				memcmp(copy.registers, hll.registers, hll.n_registers) == 0 &&
+				as_hll_cardinality(&copy) == as_hll_cardinality(&hll);
+			as_hll_destroy(&copy);
+		}
+
+		if (! ok) {
+			info("index bits %u", ib);
+		}
+		as_bytes_destroy(bytes);
+		as_hll_destroy(&hll);
+		assert_true(ok);
+	}
+}
+
+TEST(hll_sketch_invalid, "reject invalid values") {
+	uint8_t registers[16] = {0};
+	as_error err;
+	as_hll hll;
+
+	assert_int_eq(as_hll_init(&hll, &err, AS_HLL_MIN_INDEX_BITS - 1), AEROSPIKE_ERR_PARAM);
+	assert_int_eq(as_hll_init(&hll, &err, AS_HLL_MAX_INDEX_BITS + 1), AEROSPIKE_ERR_PARAM);
+
+	// Wrong bytes type.
+	as_bytes* bytes = hll_pack(registers, 4, 0);
+	bytes->type = AS_BYTES_BLOB;
+	as_status status = as_hll_init_bytes(&hll, &err, bytes);
+	as_bytes_destroy(bytes);
+	assert_int_eq(status, AEROSPIKE_ERR_PARAM);
+
+	// Registers truncated.
+	bytes = hll_pack(registers, 4, 3);
+	bytes->size--;
+	status = as_hll_init_bytes(&hll, &err, bytes);
+	as_bytes_destroy(bytes);
+	assert_int_eq(status, AEROSPIKE_ERR_PARAM);
+
+	// Too many MinHash bits.
+	bytes = hll_pack(registers, 4, 0);
+	bytes->value[2] = MAX_MINHASH_BITS + 1;
+	status = as_hll_init_bytes(&hll, &err, bytes);
+	as_bytes_destroy(bytes);
+	assert_int_eq(status, AEROSPIKE_ERR_PARAM);
+
+	// Index bits mismatch.
+	as_hll_init(&hll, &err, 5);
+	bytes = hll_pack(registers, 4, 0);
+	status = as_hll_merge_bytes(&hll, &err, bytes);
+	as_bytes_destroy(bytes);
+	as_hll_destroy(&hll);
+	assert_int_eq(status, AEROSPIKE_ERR_PARAM);
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(hll_sketch, "as_hll client side sketch tests") {
+	suite_add(hll_sketch_merge_bytes);
+	suite_add(hll_sketch_merge);
+	suite_add(hll_sketch_merge_tail);
+	suite_add(hll_sketch_cardinality);
+	suite_add(hll_sketch_union_count);
+	suite_add(hll_sketch_to_bytes);
+	suite_add(hll_sketch_invalid);
+}
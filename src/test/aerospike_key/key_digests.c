@@ -0,0 +1,214 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_error.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_status.h>
+#include <string.h>
+
+#include "../test.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define NAMESPACE "test"
+#define MAX_KEYS 64
+#define MAX_VALUE_SIZE 1024
+
+/******************************************************************************
+ * GLOBAL VARS
+ *****************************************************************************/
+
+// Set name lengths move the value across the first 64 byte block boundary.
+static const char* g_sets[] = {
+	"",
+	"d",
+	"test_digests",
+	"test_digests_with_a_set_name_that_is_exactly_sixty_three_chars_"
+};
+
+// Value sizes around the 55/56 byte padding boundary and the 64 byte block size, plus
+// values that span many blocks.
+static const uint32_t g_sizes[] = {
+	1, 3, 7, 19, 54, 55, 56, 57, 63, 64, 65, 119, 120, 127, 128, 200, 511, 1000
+};
+
+static char g_str[MAX_VALUE_SIZE + 1];
+static uint8_t g_blob[MAX_VALUE_SIZE];
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+key_digests_init_values(void)
+{
+	for (uint32_t i = 0; i < MAX_VALUE_SIZE; i++) {
+		g_str[i] = (char)('a' + i % 26);
+		g_blob[i] = (uint8_t)(i * 31 + 7);
+	}
+	g_str[MAX_VALUE_SIZE] = 0;
+}
+
+static void
+key_digests_init_key(as_key* key, uint32_t i, uint32_t variant)
+{
+	uint32_t n_sizes = (uint32_t)(sizeof(g_sizes) / sizeof(g_sizes[0]));
+	uint32_t v = i + variant;
+
+	// Shift type and set by the number of passes over sizes, so every size is paired with
+	// every key type and set name.
+	const char* set = g_sets[(v / 3) % (sizeof(g_sets) / sizeof(g_sets[0]))];
+	uint32_t size = g_sizes[v % n_sizes];
+
+	switch ((v + v / n_sizes) % 3) {
+		case 0:
+			as_key_init_int64(key, NAMESPACE, set, (int64_t)v * 1000003 - 500);
+			break;
+
+		case 1:
+			// String keys must be null terminated, so point into the shared buffer at an
+			// offset that leaves exactly size bytes.
+			as_key_init_str(key, NAMESPACE, set, &g_str[MAX_VALUE_SIZE - size]);
+			break;
+
+		default:
+			as_key_init_raw(key, NAMESPACE, set, &g_blob[v % 13], size);
+			break;
+	}
+}
+
+/**
+ * Compute digests for n keys with as_key_set_digests() and compare each one against
+ * as_key_set_digest() on an identical key. Return index of first mismatch or -1.
+ */
+static int
+key_digests_compare(uint32_t n, uint32_t variant)
+{
+	as_key keys[MAX_KEYS];
+	as_key* ptrs[MAX_KEYS];
+	as_error err;
+
+	for (uint32_t i = 0; i < n; i++) {
+		key_digests_init_key(&keys[i], i, variant);
+		ptrs[i] = &keys[i];
+	}
+
+	if (as_key_set_digests(&err, ptrs, n) != AEROSPIKE_OK) {
+		return (int)n;
+	}
+
+	int rv = -1;
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_key expect;
+		key_digests_init_key(&expect, i, variant);
+
+		if (as_key_set_digest(&err, &expect) != AEROSPIKE_OK ||
+			! keys[i].digest.init ||
+			memcmp(keys[i].digest.value, expect.digest.value, AS_DIGEST_VALUE_SIZE) != 0) {
+			if (rv < 0) {
+				rv = (int)i;
+			}
+		}
+		as_key_destroy(&expect);
+	}
+
+	for (uint32_t i = 0; i < n; i++) {
+		as_key_destroy(&keys[i]);
+	}
+	return rv;
+}
+
+/******************************************************************************
+ * TEST CASES
+ *****************************************************************************/
+
+TEST(key_digests_counts, "batch digests match single digests for partial and full lanes") {
+	static const uint32_t counts[] = {1, 7, 8, 9, 17};
+
+	key_digests_init_values();
+
+	for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		// Rotate key types, set names and sizes across lanes.
+		for (uint32_t variant = 0; variant < 6; variant++) {
+			int mismatch = key_digests_compare(counts[c], variant);
+			assert_int_eq(mismatch, -1);
+		}
+	}
+}
+
+TEST(key_digests_sizes, "batch digests match single digests for all value sizes") {
+	key_digests_init_values();
+
+	// Cover every size and set in every lane position.
+	uint32_t n = (uint32_t)(sizeof(g_sizes) / sizeof(g_sizes[0]) * 3);
+
+	for (uint32_t variant = 0; variant < 24; variant++) {
+		int mismatch = key_digests_compare(n, variant);
+		assert_int_eq(mismatch, -1);
+	}
+}
+
+TEST(key_digests_skip, "batch digests skip keys that already have a digest") {
+	as_key keys[9];
+	as_key* ptrs[9];
+	as_error err;
+
+	key_digests_init_values();
+
+	for (uint32_t i = 0; i < 9; i++) {
+		key_digests_init_key(&keys[i], i, 1);
+		ptrs[i] = &keys[i];
+	}
+
+	// Preset digest on every other key. Those digests must not be overwritten.
+	for (uint32_t i = 0; i < 9; i += 2) {
+		memset(keys[i].digest.value, 0xA5, AS_DIGEST_VALUE_SIZE);
+		keys[i].digest.init = true;
+	}
+
+	as_status status = as_key_set_digests(&err, ptrs, 9);
+	assert_int_eq(status, AEROSPIKE_OK);
+
+	for (uint32_t i = 0; i < 9; i++) {
+		as_key expect;
+		key_digests_init_key(&expect, i, 1);
+
+		if (i % 2 == 0) {
+			memset(expect.digest.value, 0xA5, AS_DIGEST_VALUE_SIZE);
+		}
+		else {
+			as_key_set_digest(&err, &expect);
+		}
+
+		int cmp = memcmp(keys[i].digest.value, expect.digest.value, AS_DIGEST_VALUE_SIZE);
+		as_key_destroy(&expect);
+		as_key_destroy(&keys[i]);
+		assert_int_eq(cmp, 0);
+	}
+}
+
+/******************************************************************************
+ * TEST SUITE
+ *****************************************************************************/
+
+SUITE(key_digests, "as_key_set_digests tests") {
+	suite_add(key_digests_counts);
+	suite_add(key_digests_sizes);
+	suite_add(key_digests_skip);
+}
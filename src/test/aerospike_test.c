@@ -464,6 +464,7 @@ PLAN(aerospike_test)
 	plan_after(after);
 
 	plan_add(key_basics);
+	plan_add(key_digests);
 	plan_add(key_apply);
 	plan_add(key_apply2);
 	plan_add(key_operate);
@@ -474,6 +475,7 @@ PLAN(aerospike_test)
 	plan_add(map_sort);
 	plan_add(bit);
 	plan_add(hll);
+	plan_add(hll_sketch);
 	plan_add(filter_exp);
 	plan_add(exp_operate);
 	plan_add(info_basics);
@@ -487,6 +489,9 @@ PLAN(aerospike_test)
 	plan_add(scan_basics);
 	plan_add(batch);
 	plan_add(transaction);
+	plan_add(transaction_hash);
+	plan_add(near_cache_file);
+	plan_add(scan_ledger);
 
 #if AS_EVENT_LIB_DEFINED
 	plan_add(key_basics_async);
@@ -498,5 +503,6 @@ PLAN(aerospike_test)
 	plan_add(scan_async);
 	plan_add(query_async);
 	plan_add(transaction_async);
+	plan_add(write_behind);
 #endif
 }
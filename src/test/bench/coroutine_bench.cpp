@@ -0,0 +1,302 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+/**
+ * Async get overhead of as_coroutine.hpp awaitables versus raw listener callbacks against an
+ * in-process loopback mock cluster. Each case keeps a fixed number of gets in flight. The
+ * callback case issues the next get from the listener. The coroutine case runs one coroutine
+ * per in-flight get that loops on co_await as_coro::key_get(). Reports throughput, average
+ * latency and process CPU time per get, which includes the mock server threads.
+ *
+ * Usage: coroutine_bench [concurrency] [seconds per case] [event loops]
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_coroutine.hpp>
+#include <aerospike/as_event.h>
+#include <aerospike/as_record.h>
+#include <citrusleaf/cf_clock.h>
+#include <atomic>
+#include <exception>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+extern "C" {
+#include "../util/mock_server.h"
+}
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_KEYS 100000
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	aerospike* as;
+	uint64_t end_ns;
+	std::atomic<uint64_t> ops;
+	std::atomic<uint64_t> errors;
+	std::atomic<uint64_t> latency_ns;
+	std::atomic<uint32_t> inflight;
+} bench_ctx;
+
+typedef struct {
+	bench_ctx* ctx;
+	uint64_t begin;
+	uint32_t seed;
+	as_key key;
+} callback_slot;
+
+// Coroutine that starts immediately and frees its frame when it returns.
+struct bench_task {
+	struct promise_type {
+		bench_task
+		get_return_object() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never
+		initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never
+		final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void
+		return_void() noexcept
+		{
+		}
+
+		void
+		unhandled_exception() noexcept
+		{
+			std::terminate();
+		}
+	};
+};
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint64_t
+cpu_us(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec +
+		(uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+}
+
+static inline void
+record_result(bench_ctx* ctx, uint64_t begin, bool ok)
+{
+	ctx->latency_ns.fetch_add(cf_getns() - begin, std::memory_order_relaxed);
+
+	if (ok) {
+		ctx->ops.fetch_add(1, std::memory_order_relaxed);
+	}
+	else {
+		ctx->errors.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+static void callback_get(callback_slot* slot);
+
+static void
+callback_listener(as_error* err, as_record* record, void* udata, as_event_loop* event_loop)
+{
+	(void)record;
+	(void)event_loop;
+
+	callback_slot* slot = (callback_slot*)udata;
+	bench_ctx* ctx = slot->ctx;
+
+	record_result(ctx, slot->begin, err == NULL);
+
+	if (cf_getns() < ctx->end_ns) {
+		callback_get(slot);
+		return;
+	}
+	ctx->inflight.fetch_sub(1);
+}
+
+static void
+callback_get(callback_slot* slot)
+{
+	as_error err;
+
+	as_key_init_int64(&slot->key, "test", "bench", (int64_t)(rand_r(&slot->seed) % N_KEYS));
+	slot->begin = cf_getns();
+
+	if (aerospike_key_get_async(slot->ctx->as, &err, NULL, &slot->key, callback_listener, slot,
+		NULL, NULL) != AEROSPIKE_OK) {
+		// Listener is not called when the command could not be queued.
+		slot->ctx->errors.fetch_add(1, std::memory_order_relaxed);
+		slot->ctx->inflight.fetch_sub(1);
+	}
+}
+
+static void
+callback_run(bench_ctx* ctx, uint32_t concurrency)
+{
+	callback_slot* slots = (callback_slot*)malloc(sizeof(callback_slot) * concurrency);
+
+	for (uint32_t i = 0; i < concurrency; i++) {
+		slots[i].ctx = ctx;
+		slots[i].seed = i + 1;
+		callback_get(&slots[i]);
+	}
+
+	while (ctx->inflight.load() > 0) {
+		usleep(1000);
+	}
+	free(slots);
+}
+
+static bench_task
+coroutine_get(bench_ctx* ctx, uint32_t seed)
+{
+	as_key key;
+
+	while (cf_getns() < ctx->end_ns) {
+		as_key_init_int64(&key, "test", "bench", (int64_t)(rand_r(&seed) % N_KEYS));
+		uint64_t begin = cf_getns();
+
+		as_coro::record_result r = co_await as_coro::key_get(ctx->as, NULL, &key);
+
+		record_result(ctx, begin, r.status == AEROSPIKE_OK);
+	}
+	ctx->inflight.fetch_sub(1);
+}
+
+static void
+coroutine_run(bench_ctx* ctx, uint32_t concurrency)
+{
+	for (uint32_t i = 0; i < concurrency; i++) {
+		coroutine_get(ctx, i + 1);
+	}
+
+	while (ctx->inflight.load() > 0) {
+		usleep(1000);
+	}
+}
+
+static void
+bench_case_run(aerospike* as, const char* name, bool coroutine, uint32_t concurrency,
+	uint32_t seconds)
+{
+	bench_ctx ctx;
+	ctx.as = as;
+	ctx.ops = 0;
+	ctx.errors = 0;
+	ctx.latency_ns = 0;
+	ctx.inflight = concurrency;
+
+	uint64_t cpu_begin = cpu_us();
+	uint64_t begin = cf_getns();
+	ctx.end_ns = begin + (uint64_t)seconds * 1000 * 1000 * 1000;
+
+	if (coroutine) {
+		coroutine_run(&ctx, concurrency);
+	}
+	else {
+		callback_run(&ctx, concurrency);
+	}
+
+	double elapsed = (double)(cf_getns() - begin) / 1e9;
+	uint64_t cpu = cpu_us() - cpu_begin;
+	uint64_t ops = ctx.ops.load();
+	uint64_t total = ops + ctx.errors.load();
+	double latency = total ? (double)ctx.latency_ns.load() / total / 1000.0 : 0;
+	double cpu_per_op = ops ? (double)cpu / ops : 0;
+
+	printf("%-10s %12.0f %10.1f %11.2f %10" PRIu64 "\n", name, ops / elapsed, latency,
+		cpu_per_op, ctx.errors.load());
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t concurrency = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+	uint32_t seconds = argc > 2 ? (uint32_t)atoi(argv[2]) : 3;
+	uint32_t n_loops = argc > 3 ? (uint32_t)atoi(argv[3]) : 1;
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+
+	mock_server* server = mock_server_start(&mc);
+
+	if (! server) {
+		printf("mock server start failed\n");
+		return 1;
+	}
+
+	if (! as_event_create_loops(n_loops)) {
+		printf("event loop create failed\n");
+		mock_server_stop(server);
+		return 1;
+	}
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(server, 0));
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("connect failed: %d %s\n", err.code, err.message);
+		aerospike_destroy(&as);
+		as_event_close_loops();
+		mock_server_stop(server);
+		return 1;
+	}
+
+	printf("concurrency: %u seconds: %u event loops: %u\n", concurrency, seconds, n_loops);
+	printf("%-10s %12s %10s %11s %10s\n", "mode", "gets/s", "avg us", "cpu us/get", "errors");
+
+	// Run each mode twice, so connection pool warmup is not charged to the first mode.
+	for (uint32_t i = 0; i < 2; i++) {
+		bench_case_run(&as, "callback", false, concurrency, seconds);
+		bench_case_run(&as, "coroutine", true, concurrency, seconds);
+	}
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	as_event_close_loops();
+	mock_server_stop(server);
+	return 0;
+}
@@ -0,0 +1,602 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/**
+ * Fault injection harness against an in-process loopback mock cluster. Each case injects
+ * delays, connection resets or truncated responses on one mock node, or takes a node down
+ * halfway through the run. Sync gets, batch reads and async gets are measured under each
+ * case. Reports the latency distribution, errors and wasted work: server commands and request
+ * bytes beyond what the same number of operations needed in the fault free baseline, which
+ * are retries and duplicate sends. Use it to compare retry and timeout policies.
+ *
+ * On Linux, epoll_ctl(), write/send and read/recv calls made by event loop threads are counted
+ * and reported per async operation. The executable interposes these libc functions, so calls
+ * made by the event library are counted too. Run it before and after a change to the async
+ * backends to compare watcher and socket syscalls per command.
+ *
+ * Usage: fault_bench [nodes] [threads] [seconds per case] [socket timeout ms] [max retries]
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_event_internal.h>
+#include <aerospike/as_record.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../util/mock_server.h"
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#endif
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_KEYS 100000
+#define N_BATCH 20
+#define MAX_SAMPLES (1 << 21)
+#define ASYNC_CONCURRENCY 64
+#define N_EVENT_LOOPS 2
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef enum {
+	CASE_BASELINE,
+	CASE_DELAY,
+	CASE_RESET,
+	CASE_PARTIAL,
+	CASE_FAILOVER,
+	CASE_MAX
+} fault_case;
+
+typedef enum {
+	WORKLOAD_GET,
+	WORKLOAD_BATCH,
+	WORKLOAD_ASYNC_GET,
+	WORKLOAD_MAX
+} workload;
+
+typedef struct {
+	aerospike* as;
+	workload type;
+	uint64_t end_ns;
+	uint64_t ops;
+	uint64_t errors;
+} bench_ctx;
+
+typedef struct {
+	bench_ctx* ctx;
+	uint64_t begin;
+	uint32_t seed;
+	as_key key;
+} async_slot;
+
+typedef struct {
+	double commands_per_op;
+	double bytes_per_op;
+} baseline;
+
+typedef enum {
+	SYSCALL_EPOLL_CTL,
+	SYSCALL_WRITE,
+	SYSCALL_READ,
+	SYSCALL_MAX
+} syscall_type;
+
+/******************************************************************************
+ * GLOBALS
+ *****************************************************************************/
+
+static uint32_t g_samples[MAX_SAMPLES];
+static uint32_t g_sample_count;
+static uint32_t g_async_inflight;
+static baseline g_baselines[WORKLOAD_MAX];
+
+static const char* case_names[] = {"baseline", "delay", "reset", "partial", "failover"};
+static const char* workload_names[] = {"get", "batch", "async"};
+
+/******************************************************************************
+ * SYSCALL COUNTER
+ *****************************************************************************/
+
+// Mock nodes also read and write sockets, so only count event loop threads.
+static __thread bool g_count_syscalls;
+static uint64_t g_syscalls[SYSCALL_MAX];
+static uint32_t g_counted_loops;
+
+#if defined(__linux__)
+#define SYSCALLS_COUNTED true
+
+// Resolve the libc function on first call. Concurrent first calls store the same pointer.
+#define SYSCALL_REAL(_name, _type) \
+	static _type real; \
+	if (! real) { \
+		real = (_type)dlsym(RTLD_NEXT, _name); \
+	}
+
+static inline void
+count_syscall(syscall_type type)
+{
+	if (g_count_syscalls) {
+		as_incr_uint64(&g_syscalls[type]);
+	}
+}
+
+int
+epoll_ctl(int epfd, int op, int fd, struct epoll_event* event)
+{
+	SYSCALL_REAL("epoll_ctl", int (*)(int, int, int, struct epoll_event*));
+	count_syscall(SYSCALL_EPOLL_CTL);
+	return real(epfd, op, fd, event);
+}
+
+ssize_t
+write(int fd, const void* buf, size_t count)
+{
+	SYSCALL_REAL("write", ssize_t (*)(int, const void*, size_t));
+	count_syscall(SYSCALL_WRITE);
+	return real(fd, buf, count);
+}
+
+ssize_t
+send(int fd, const void* buf, size_t len, int flags)
+{
+	SYSCALL_REAL("send", ssize_t (*)(int, const void*, size_t, int));
+	count_syscall(SYSCALL_WRITE);
+	return real(fd, buf, len, flags);
+}
+
+ssize_t
+read(int fd, void* buf, size_t count)
+{
+	SYSCALL_REAL("read", ssize_t (*)(int, void*, size_t));
+	count_syscall(SYSCALL_READ);
+	return real(fd, buf, count);
+}
+
+ssize_t
+recv(int fd, void* buf, size_t len, int flags)
+{
+	SYSCALL_REAL("recv", ssize_t (*)(int, void*, size_t, int));
+	count_syscall(SYSCALL_READ);
+	return real(fd, buf, len, flags);
+}
+#else
+#define SYSCALLS_COUNTED false
+#endif
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static inline void
+record_latency(uint64_t begin)
+{
+	uint32_t i = as_faa_uint32(&g_sample_count, 1);
+
+	if (i < MAX_SAMPLES) {
+		uint64_t us = (cf_getns() - begin) / 1000;
+		g_samples[i] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+	}
+}
+
+static int
+compare_u32(const void* a, const void* b)
+{
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+static uint32_t
+percentile(uint32_t* samples, uint32_t n, double pct)
+{
+	if (n == 0) {
+		return 0;
+	}
+
+	uint32_t i = (uint32_t)(pct / 100.0 * n);
+	return samples[i < n ? i : n - 1];
+}
+
+static void*
+sync_run(void* udata)
+{
+	bench_ctx* ctx = udata;
+	uint32_t seed = (uint32_t)(uintptr_t)pthread_self();
+	uint64_t ops = 0;
+	uint64_t errors = 0;
+	as_batch_records* records = NULL;
+	as_error err;
+	as_key key;
+
+	if (ctx->type == WORKLOAD_BATCH) {
+		records = as_batch_records_create(N_BATCH);
+	}
+
+	while (cf_getns() < ctx->end_ns) {
+		uint64_t begin = cf_getns();
+		as_status status;
+
+		if (ctx->type == WORKLOAD_GET) {
+			as_key_init_int64(&key, "test", "fault", (int64_t)(rand_r(&seed) % N_KEYS));
+			as_record* rec = NULL;
+			status = aerospike_key_get(ctx->as, &err, NULL, &key, &rec);
+			as_record_destroy(rec);
+		}
+		else {
+			for (uint32_t i = 0; i < N_BATCH; i++) {
+				as_batch_read_record* r = as_batch_read_reserve(records);
+				as_key_init_int64(&r->key, "test", "fault", (int64_t)(rand_r(&seed) % N_KEYS));
+				r->read_all_bins = true;
+			}
+			status = aerospike_batch_read(ctx->as, &err, NULL, records);
+			as_batch_records_reset(records);
+		}
+		record_latency(begin);
+
+		if (status == AEROSPIKE_OK) {
+			ops++;
+		}
+		else {
+			errors++;
+		}
+	}
+
+	if (records) {
+		as_batch_records_destroy(records);
+	}
+	ctx->ops = ops;
+	ctx->errors = errors;
+	return NULL;
+}
+
+#if AS_EVENT_LIB_DEFINED
+static void
+count_loop_syscalls(as_event_loop* event_loop, void* udata)
+{
+	(void)event_loop;
+	(void)udata;
+
+	g_count_syscalls = true;
+	as_incr_uint32(&g_counted_loops);
+}
+
+static void async_get(async_slot* slot);
+
+static void
+async_listener(as_error* err, as_record* record, void* udata, as_event_loop* event_loop)
+{
+	async_slot* slot = udata;
+	bench_ctx* ctx = slot->ctx;
+
+	record_latency(slot->begin);
+
+	if (err) {
+		as_incr_uint64(&ctx->errors);
+	}
+	else {
+		as_incr_uint64(&ctx->ops);
+	}
+
+	if (cf_getns() < ctx->end_ns) {
+		async_get(slot);
+		return;
+	}
+	as_decr_uint32(&g_async_inflight);
+}
+
+static void
+async_get(async_slot* slot)
+{
+	as_error err;
+
+	as_key_init_int64(&slot->key, "test", "fault", (int64_t)(rand_r(&slot->seed) % N_KEYS));
+	slot->begin = cf_getns();
+
+	if (aerospike_key_get_async(slot->ctx->as, &err, NULL, &slot->key, async_listener, slot,
+		NULL, NULL) != AEROSPIKE_OK) {
+		// Listener is not called when the command could not be queued.
+		as_incr_uint64(&slot->ctx->errors);
+		as_decr_uint32(&g_async_inflight);
+	}
+}
+
+static void
+async_run(bench_ctx* ctx)
+{
+	async_slot* slots = malloc(sizeof(async_slot) * ASYNC_CONCURRENCY);
+
+	ctx->ops = 0;
+	ctx->errors = 0;
+	as_store_uint32(&g_async_inflight, ASYNC_CONCURRENCY);
+
+	for (uint32_t i = 0; i < ASYNC_CONCURRENCY; i++) {
+		slots[i].ctx = ctx;
+		slots[i].seed = i + 1;
+		async_get(&slots[i]);
+	}
+
+	while (as_load_uint32(&g_async_inflight) > 0) {
+		usleep(1000);
+	}
+	free(slots);
+}
+#endif
+
+static void
+run_workload(
+	aerospike* as, mock_server* server, fault_case fc, workload type, uint32_t n_threads,
+	uint32_t seconds, uint32_t kill_index
+	)
+{
+#if !AS_EVENT_LIB_DEFINED
+	if (type == WORKLOAD_ASYNC_GET) {
+		return;
+	}
+#endif
+
+	mock_server_stats before;
+	mock_server_get_stats(server, &before);
+	as_store_uint32(&g_sample_count, 0);
+
+	uint64_t syscalls_before[SYSCALL_MAX];
+
+	for (uint32_t i = 0; i < SYSCALL_MAX; i++) {
+		syscalls_before[i] = as_load_uint64(&g_syscalls[i]);
+	}
+
+	uint64_t begin = cf_getns();
+	uint64_t duration = (uint64_t)seconds * 1000 * 1000 * 1000;
+	uint64_t ops = 0;
+	uint64_t errors = 0;
+
+	if (fc == CASE_FAILOVER) {
+		// Run first half healthy, then lose the last node.
+		duration /= 2;
+	}
+
+	for (uint32_t half = 0; half < ((fc == CASE_FAILOVER) ? 2 : 1); half++) {
+		if (half == 1) {
+			mock_server_kill_node(server, kill_index);
+		}
+
+		uint64_t end = cf_getns() + duration;
+
+		if (type == WORKLOAD_ASYNC_GET) {
+#if AS_EVENT_LIB_DEFINED
+			bench_ctx ctx_async;
+			ctx_async.as = as;
+			ctx_async.type = type;
+			ctx_async.end_ns = end;
+			async_run(&ctx_async);
+			ops += ctx_async.ops;
+			errors += ctx_async.errors;
+#endif
+			continue;
+		}
+
+		pthread_t* threads = malloc(sizeof(pthread_t) * n_threads);
+		bench_ctx* ctxs = malloc(sizeof(bench_ctx) * n_threads);
+
+		for (uint32_t i = 0; i < n_threads; i++) {
+			ctxs[i].as = as;
+			ctxs[i].type = type;
+			ctxs[i].end_ns = end;
+			pthread_create(&threads[i], NULL, sync_run, &ctxs[i]);
+		}
+
+		for (uint32_t i = 0; i < n_threads; i++) {
+			pthread_join(threads[i], NULL);
+			ops += ctxs[i].ops;
+			errors += ctxs[i].errors;
+		}
+		free(ctxs);
+		free(threads);
+	}
+
+	double elapsed = (double)(cf_getns() - begin) / 1e9;
+
+	mock_server_stats after;
+	mock_server_get_stats(server, &after);
+
+	uint64_t commands = after.commands - before.commands;
+	uint64_t bytes = after.bytes_in - before.bytes_in;
+	uint64_t total = ops + errors;
+	uint32_t n = as_load_uint32(&g_sample_count);
+
+	if (n > MAX_SAMPLES) {
+		n = MAX_SAMPLES;
+	}
+	qsort(g_samples, n, sizeof(uint32_t), compare_u32);
+
+	baseline* base = &g_baselines[type];
+
+	if (fc == CASE_BASELINE && total > 0) {
+		base->commands_per_op = (double)commands / total;
+		base->bytes_per_op = (double)bytes / total;
+	}
+
+	double wasted_commands = (double)commands - base->commands_per_op * total;
+	double wasted_bytes = (double)bytes - base->bytes_per_op * total;
+
+	printf("%-9s %-6s %9.0f ops/s p50: %7u p90: %7u p99: %7u p99.9: %7u max: %8u us "
+		"errors: %" PRIu64 " wasted commands: %.0f (%.1f%%) wasted bytes: %.0f\n",
+		case_names[fc], workload_names[type], ops / elapsed, percentile(g_samples, n, 50),
+		percentile(g_samples, n, 90), percentile(g_samples, n, 99),
+		percentile(g_samples, n, 99.9), n ? g_samples[n - 1] : 0, errors,
+		wasted_commands > 0 ? wasted_commands : 0,
+		commands ? (wasted_commands > 0 ? wasted_commands : 0) * 100 / commands : 0,
+		wasted_bytes > 0 ? wasted_bytes : 0);
+
+	if (SYSCALLS_COUNTED && type == WORKLOAD_ASYNC_GET && total > 0) {
+		double per_op[SYSCALL_MAX];
+
+		for (uint32_t i = 0; i < SYSCALL_MAX; i++) {
+			per_op[i] = (double)(as_load_uint64(&g_syscalls[i]) - syscalls_before[i]) / total;
+		}
+
+		printf("%-9s %-6s syscalls/op epoll_ctl: %.2f write: %.2f read: %.2f\n",
+			case_names[fc], workload_names[type], per_op[SYSCALL_EPOLL_CTL],
+			per_op[SYSCALL_WRITE], per_op[SYSCALL_READ]);
+	}
+}
+
+static void
+set_case_fault(mock_server* server, fault_case fc, uint32_t socket_timeout)
+{
+	mock_fault fault;
+	memset(&fault, 0, sizeof(fault));
+
+	switch (fc) {
+		case CASE_DELAY:
+			// Delay well past the socket timeout, so delayed attempts time out and retry.
+			fault.delay_pct = 10;
+			fault.delay_us = socket_timeout * 1000 * 5;
+			break;
+
+		case CASE_RESET:
+			fault.reset_pct = 5;
+			break;
+
+		case CASE_PARTIAL:
+			fault.partial_pct = 5;
+			break;
+
+		default:
+			mock_server_set_fault(server, 0, NULL);
+			return;
+	}
+	mock_server_set_fault(server, 0, &fault);
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_nodes = argc > 1 ? (uint32_t)atoi(argv[1]) : 3;
+	uint32_t n_threads = argc > 2 ? (uint32_t)atoi(argv[2]) : 8;
+	uint32_t seconds = argc > 3 ? (uint32_t)atoi(argv[3]) : 2;
+	uint32_t socket_timeout = argc > 4 ? (uint32_t)atoi(argv[4]) : 20;
+	uint32_t max_retries = argc > 5 ? (uint32_t)atoi(argv[5]) : 2;
+
+	if (n_nodes < 2 || n_threads == 0 || seconds == 0 || socket_timeout == 0) {
+		printf("Usage: fault_bench [nodes (2+)] [threads] [seconds per case] "
+			"[socket timeout ms] [max retries]\n");
+		return 1;
+	}
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	mc.n_nodes = n_nodes;
+
+	mock_server* server = mock_server_start(&mc);
+
+	if (! server) {
+		printf("mock server start failed\n");
+		return 1;
+	}
+
+	as_error err;
+
+#if AS_EVENT_LIB_DEFINED
+	if (! as_event_create_loops(N_EVENT_LOOPS)) {
+		printf("event loop create failed\n");
+		mock_server_stop(server);
+		return 1;
+	}
+
+	// Enable syscall counting on each event loop thread.
+	for (uint32_t i = 0; i < N_EVENT_LOOPS; i++) {
+		as_event_execute(as_event_loop_get_by_index(i), count_loop_syscalls, NULL);
+	}
+
+	while (as_load_uint32(&g_counted_loops) < N_EVENT_LOOPS) {
+		usleep(1000);
+	}
+#endif
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(server, 0));
+
+	as_policy_base* bases[] = {&config.policies.read.base, &config.policies.batch.base};
+
+	for (uint32_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+		bases[i]->socket_timeout = socket_timeout;
+		bases[i]->total_timeout = 1000;
+		bases[i]->max_retries = max_retries;
+	}
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("connect failed: %d %s\n", err.code, err.message);
+		aerospike_destroy(&as);
+#if AS_EVENT_LIB_DEFINED
+		as_event_close_loops();
+#endif
+		mock_server_stop(server);
+		return 1;
+	}
+
+	printf("nodes: %u threads: %u seconds: %u socket timeout: %u ms max retries: %u\n",
+		n_nodes, n_threads, seconds, socket_timeout, max_retries);
+
+	for (uint32_t fc = 0; fc < CASE_MAX; fc++) {
+		for (uint32_t type = 0; type < WORKLOAD_MAX; type++) {
+			// Each failover run loses one more node, so only the first workload starts from
+			// a full cluster. At least one node must survive.
+			if (fc == CASE_FAILOVER && n_nodes - type < 2) {
+				break;
+			}
+			set_case_fault(server, (fault_case)fc, socket_timeout);
+			run_workload(&as, server, (fault_case)fc, (workload)type, n_threads, seconds,
+				n_nodes - 1 - type);
+		}
+	}
+
+	mock_server_set_fault(server, 0, NULL);
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+
+#if AS_EVENT_LIB_DEFINED
+	as_event_close_loops();
+#endif
+	mock_server_stop(server);
+	return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/**
+ * Micro-benchmark for command serialization and parse hot paths. Runs without a server on
+ * canned values and wire buffers, reporting time and heap allocations per operation.
+ * Allocations are counted on Linux, where the link wraps malloc(), calloc() and realloc().
+ *
+ * Usage: hot_path_bench [min ms per case]
+ */
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_command.h>
+#include <aerospike/as_exp.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_list_operations.h>
+#include <aerospike/as_map_operations.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_policy.h>
+#include <aerospike/as_queue.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_stringmap.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_BINS 5
+#define N_BATCH 100
+#define BUF_SIZE (1024 * 1024)
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef void (*bench_fn)(void* udata);
+
+typedef struct {
+	as_record rec;
+	as_queue buffers;
+	uint8_t* buf;
+	uint8_t* wire;
+	uint8_t* wire_end;
+	as_record out;
+	uint32_t first;
+	uint32_t n_bins;
+} bin_ctx;
+
+typedef struct {
+	as_policies defs;
+	as_policy_batch policy;
+	as_batch_records* records;
+	uint8_t* buf;
+} batch_ctx;
+
+/******************************************************************************
+ * ALLOCATION COUNTER
+ *****************************************************************************/
+
+static uint64_t g_allocs;
+
+#if defined(__linux__)
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void*
+__wrap_malloc(size_t size)
+{
+	g_allocs++;
+	return __real_malloc(size);
+}
+
+void*
+__wrap_calloc(size_t n, size_t size)
+{
+	g_allocs++;
+	return __real_calloc(n, size);
+}
+
+void*
+__wrap_realloc(void* ptr, size_t size)
+{
+	g_allocs++;
+	return __real_realloc(ptr, size);
+}
+#define ALLOCS_COUNTED true
+#else
+#define ALLOCS_COUNTED false
+#endif
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void
+run(const char* name, bench_fn fn, void* udata, uint64_t min_ns)
+{
+	// Warm caches and one-time initialization.
+	fn(udata);
+
+	uint64_t n = 1;
+	uint64_t elapsed;
+	uint64_t allocs;
+
+	while (true) {
+		uint64_t allocs_begin = g_allocs;
+		uint64_t begin = cf_getns();
+
+		for (uint64_t i = 0; i < n; i++) {
+			fn(udata);
+		}
+
+		elapsed = cf_getns() - begin;
+		allocs = g_allocs - allocs_begin;
+
+		if (elapsed >= min_ns) {
+			break;
+		}
+		n *= 2;
+	}
+
+	if (ALLOCS_COUNTED) {
+		printf("%-32s %10" PRIu64 " ops %10.1f ns/op %8.2f allocs/op\n", name, n,
+			(double)elapsed / n, (double)allocs / n);
+	}
+	else {
+		printf("%-32s %10" PRIu64 " ops %10.1f ns/op %8s allocs/op\n", name, n,
+			(double)elapsed / n, "n/a");
+	}
+}
+
+static void
+bin_ctx_init(bin_ctx* c)
+{
+	as_record_init(&c->rec, N_BINS);
+	as_record_set_int64(&c->rec, "int", 1234567);
+
+	char* str = cf_malloc(101);
+	memset(str, 's', 100);
+	str[100] = 0;
+	as_record_set_strp(&c->rec, "str", str, true);
+
+	uint8_t* bytes = cf_malloc(1024);
+
+	for (uint32_t i = 0; i < 1024; i++) {
+		bytes[i] = (uint8_t)i;
+	}
+	as_record_set_rawp(&c->rec, "bytes", bytes, 1024, true);
+
+	as_arraylist* list = as_arraylist_new(10, 0);
+
+	for (int64_t i = 0; i < 10; i++) {
+		as_arraylist_append_int64(list, i * 1000);
+	}
+	as_record_set_list(&c->rec, "list", (as_list*)list);
+
+	as_hashmap* map = as_hashmap_new(10);
+
+	for (int64_t i = 0; i < 10; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%" PRId64, i);
+		as_stringmap_set_int64((as_map*)map, key, i);
+	}
+	as_record_set_map(&c->rec, "map", (as_map*)map);
+
+	as_queue_init(&c->buffers, sizeof(as_buffer), 8);
+	c->buf = cf_malloc(BUF_SIZE);
+
+	// Response bins have the same layout as written bins.
+	as_error err;
+	size_t size = 0;
+
+	for (uint32_t i = 0; i < N_BINS; i++) {
+		as_command_bin_size(&c->rec.bins.entries[i], &c->buffers, &size, &err);
+	}
+
+	c->wire = cf_malloc(size);
+	uint8_t* p = c->wire;
+
+	for (uint32_t i = 0; i < N_BINS; i++) {
+		p = as_command_write_bin(p, AS_OPERATOR_READ, &c->rec.bins.entries[i], &c->buffers);
+	}
+	c->wire_end = p;
+	as_record_init(&c->out, N_BINS);
+}
+
+static void
+bin_ctx_destroy(bin_ctx* c)
+{
+	as_record_destroy(&c->rec);
+	as_record_destroy(&c->out);
+	as_queue_destroy(&c->buffers);
+	cf_free(c->buf);
+	cf_free(c->wire);
+}
+
+static void
+bench_write_bins(void* udata)
+{
+	bin_ctx* c = udata;
+	as_bin* bins = c->rec.bins.entries + c->first;
+	as_error err;
+	size_t size = 0;
+
+	for (uint32_t i = 0; i < c->n_bins; i++) {
+		as_command_bin_size(&bins[i], &c->buffers, &size, &err);
+	}
+
+	uint8_t* p = c->buf;
+
+	for (uint32_t i = 0; i < c->n_bins; i++) {
+		p = as_command_write_bin(p, AS_OPERATOR_WRITE, &bins[i], &c->buffers);
+	}
+}
+
+static void
+clear_out(as_record* rec)
+{
+	for (uint16_t i = 0; i < rec->bins.size; i++) {
+		as_val_destroy((as_val*)rec->bins.entries[i].valuep);
+	}
+	rec->bins.size = 0;
+}
+
+static void
+bench_parse_bins(void* udata)
+{
+	bin_ctx* c = udata;
+	uint8_t* p = c->wire;
+	as_error err;
+
+	as_command_parse_bins(&p, &err, &c->out, N_BINS, false);
+	clear_out(&c->out);
+}
+
+static void
+bench_parse_bins_deserialize(void* udata)
+{
+	bin_ctx* c = udata;
+	uint8_t* p = c->wire;
+	as_error err;
+
+	as_command_parse_bins(&p, &err, &c->out, N_BINS, true);
+	clear_out(&c->out);
+}
+
+static void
+bench_parse_bins_wrap(void* udata)
+{
+	bin_ctx* c = udata;
+	uint8_t* p = c->wire;
+	as_error err;
+
+	// The string is null terminated in place over the high byte of the next bin's size,
+	// which is already zero, so the canned buffer stays valid.
+	as_command_parse_bins_wrap(&p, &err, &c->out, N_BINS, false);
+	clear_out(&c->out);
+}
+
+static void
+batch_ctx_init(batch_ctx* c, bool write, as_operations* ops)
+{
+	as_policies_init(&c->defs);
+	as_policy_batch_init(&c->policy);
+	c->records = as_batch_records_create(N_BATCH);
+	c->buf = cf_malloc(BUF_SIZE);
+
+	for (uint32_t i = 0; i < N_BATCH; i++) {
+		if (write) {
+			as_batch_write_record* r = as_batch_write_reserve(c->records);
+			as_key_init_int64(&r->key, "test", "bench", (int64_t)i);
+			r->ops = ops;
+		}
+		else {
+			as_batch_read_record* r = as_batch_read_reserve(c->records);
+			as_key_init_int64(&r->key, "test", "bench", (int64_t)i);
+			r->read_all_bins = true;
+		}
+	}
+}
+
+static void
+batch_ctx_destroy(batch_ctx* c)
+{
+	as_batch_records_destroy(c->records);
+	cf_free(c->buf);
+}
+
+static void
+bench_batch_write(void* udata)
+{
+	batch_ctx* c = udata;
+	as_error err;
+	size_t size;
+
+	if (as_batch_records_serialize(&err, &c->defs, &c->policy, c->records, c->buf, BUF_SIZE,
+		&size) != AEROSPIKE_OK) {
+		printf("batch serialize failed: %s\n", err.message);
+		exit(1);
+	}
+}
+
+static void
+bench_exp_build(void* udata)
+{
+	as_exp_build(exp,
+		as_exp_and(
+			as_exp_cmp_eq(as_exp_bin_int("a"), as_exp_int(10)),
+			as_exp_cmp_gt(as_exp_bin_float("b"), as_exp_float(1.5)),
+			as_exp_cmp_eq(as_exp_bin_str("c"), as_exp_str("abc"))));
+	as_exp_destroy(exp);
+}
+
+static void
+bench_cdt_ops(void* udata)
+{
+	as_operations ops;
+	as_operations_inita(&ops, 3);
+
+	// Stack values are not freed when operations take ownership.
+	as_integer v;
+	as_integer_init(&v, 5);
+	as_operations_list_append(&ops, "list", NULL, NULL, (as_val*)&v);
+
+	as_string k;
+	as_string_init(&k, "key", false);
+	as_integer mv;
+	as_integer_init(&mv, 7);
+	as_operations_map_put(&ops, "map", NULL, NULL, (as_val*)&k, (as_val*)&mv);
+
+	as_string gk;
+	as_string_init(&gk, "key", false);
+	as_operations_map_get_by_key(&ops, "map", NULL, (as_val*)&gk, AS_MAP_RETURN_VALUE);
+
+	as_operations_destroy(&ops);
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char* argv[])
+{
+	int64_t min_ms = argc > 1 ? atoll(argv[1]) : 200;
+
+	if (min_ms <= 0) {
+		printf("Usage: hot_path_bench [min ms per case]\n");
+		return 1;
+	}
+
+	uint64_t min_ns = (uint64_t)min_ms * 1000 * 1000;
+
+	bin_ctx bc;
+	bin_ctx_init(&bc);
+
+	static const char* names[N_BINS] = {
+		"write_bin int", "write_bin string 100", "write_bin bytes 1k", "write_bin list 10",
+		"write_bin map 10"
+	};
+
+	for (uint32_t i = 0; i < N_BINS; i++) {
+		bc.first = i;
+		bc.n_bins = 1;
+		run(names[i], bench_write_bins, &bc, min_ns);
+	}
+
+	bc.first = 0;
+	bc.n_bins = N_BINS;
+	run("write_bin 5 bins", bench_write_bins, &bc, min_ns);
+	run("parse_bins 5 bins", bench_parse_bins, &bc, min_ns);
+	run("parse_bins 5 bins deserialize", bench_parse_bins_deserialize, &bc, min_ns);
+	run("parse_bins_wrap 5 bins", bench_parse_bins_wrap, &bc, min_ns);
+	bin_ctx_destroy(&bc);
+
+	batch_ctx reads;
+	batch_ctx_init(&reads, false, NULL);
+	run("batch_records_write_new 100 reads", bench_batch_write, &reads, min_ns);
+	batch_ctx_destroy(&reads);
+
+	as_operations ops;
+	as_operations_inita(&ops, 2);
+	as_operations_add_write_int64(&ops, "a", 1);
+	as_operations_add_incr(&ops, "b", 1);
+
+	batch_ctx writes;
+	batch_ctx_init(&writes, true, &ops);
+	run("batch_records_write_new 100 writes", bench_batch_write, &writes, min_ns);
+	batch_ctx_destroy(&writes);
+	as_operations_destroy(&ops);
+
+	run("exp_build 3 comparisons", bench_exp_build, NULL, min_ns);
+	run("cdt list_append+map_put+get", bench_cdt_ops, NULL, min_ns);
+	return 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/**
+ * Info response parse benchmark against an in-process loopback mock cluster. The replicas and
+ * peers responses are captured from a mock node after the client connects. Replicas responses
+ * are captured after successive partition churns, so each update moves partitions. Racks are
+ * parsed from the mock response, where every namespace is on the same rack, and from a
+ * generated response with a different rack per namespace. The multi response case splits the
+ * full replicas info response into name/value pairs.
+ *
+ * Responses are parsed by the same functions the tender uses, on the connected cluster with the
+ * tend lock held. Parsing is destructive, so each iteration parses a fresh copy. The copy is
+ * not included in the reported time.
+ *
+ * Usage: info_bench [nodes] [namespaces] [iterations]
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_info.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_info.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_peers.h>
+#include <aerospike/as_string_builder.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../util/mock_server.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Tend thread interval. The benchmark holds the tend lock, so the tend thread never runs.
+#define TEND_INTERVAL_MS (3600 * 1000)
+
+// Number of captured replicas responses. Updates rotate through them.
+#define N_ROTATIONS 4
+
+// Release retired racks and partition structures after this many parses.
+#define GC_INTERVAL 256
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef enum {
+	PARSE_REPLICAS,
+	PARSE_PEERS,
+	PARSE_RACKS,
+	PARSE_MULTI
+} parse_type;
+
+/******************************************************************************
+ * DECLARATIONS
+ *****************************************************************************/
+
+bool
+as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf);
+
+as_status
+as_node_parse_racks(as_cluster* cluster, as_error* err, as_node* node, char* buf);
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+// Fetch one info value from node. Return copy of the full response, which the caller must free
+// with cf_free(). If value is not NULL, split the copy and point value at the value.
+static char*
+capture(aerospike* as, as_node* node, const char* name, char** value)
+{
+	as_error err;
+	char req[64];
+	char* res = NULL;
+
+	snprintf(req, sizeof(req), "%s\n", name);
+
+	if (aerospike_info_node(as, &err, NULL, node, req, &res) != AEROSPIKE_OK) {
+		printf("info %s failed: %d %s\n", name, err.code, err.message);
+		return NULL;
+	}
+
+	char* copy = cf_strdup(res);
+	free(res);
+
+	if (value && as_info_parse_single_response(copy, value) != AEROSPIKE_OK) {
+		printf("info %s invalid response\n", name);
+		cf_free(copy);
+		return NULL;
+	}
+	return copy;
+}
+
+// Nothing else references retired structures while the tend lock is held and no commands run.
+static void
+release_gc(as_cluster* cluster)
+{
+	as_vector* gc = cluster->gc;
+
+	for (uint32_t i = 0; i < gc->size; i++) {
+		as_gc_item* item = as_vector_get(gc, i);
+		item->release_fn(item->data);
+	}
+	as_vector_clear(gc);
+}
+
+static bool
+parse_run(
+	as_cluster* cluster, as_node* node, parse_type type, const char* label, char** inputs,
+	uint32_t n_inputs, uint32_t iterations
+	)
+{
+	size_t max_len = 0;
+	uint64_t bytes = 0;
+
+	for (uint32_t i = 0; i < n_inputs; i++) {
+		size_t len = strlen(inputs[i]) + 1;
+
+		if (len > max_len) {
+			max_len = len;
+		}
+	}
+
+	char* buf = cf_malloc(max_len);
+	as_vector values;
+	as_vector_inita(&values, sizeof(as_name_value), 2);
+
+	as_peers peers;
+	as_vector_inita(&peers.nodes, sizeof(as_node*), 16);
+	as_vector_inita(&peers.nodes_to_remove, sizeof(as_node*), 8);
+	as_vector_inita(&peers.invalid_hosts, sizeof(as_host), 4);
+	peers.refresh_count = 0;
+	peers.gen_changed = false;
+
+	uint64_t total = 0;
+	bool ok = true;
+
+	for (uint32_t k = 0; k < iterations && ok; k++) {
+		const char* input = inputs[k % n_inputs];
+		size_t len = strlen(input);
+
+		memcpy(buf, input, len + 1);
+		bytes += len;
+
+		as_error err;
+		uint64_t begin = cf_getns();
+
+		switch (type) {
+			case PARSE_REPLICAS:
+				ok = as_partition_tables_update_all(cluster, node, buf);
+				break;
+
+			case PARSE_PEERS:
+				ok = as_peers_parse_peers(&peers, &err, cluster, node, buf) == AEROSPIKE_OK;
+				break;
+
+			case PARSE_RACKS:
+				ok = as_node_parse_racks(cluster, &err, node, buf) == AEROSPIKE_OK;
+				break;
+
+			case PARSE_MULTI:
+				as_vector_clear(&values);
+				as_info_parse_multi_response(buf, &values);
+				ok = values.size > 0;
+				break;
+		}
+		total += cf_getns() - begin;
+
+		if (k % GC_INTERVAL == 0) {
+			release_gc(cluster);
+		}
+	}
+	release_gc(cluster);
+
+	// Every peer is already in the cluster, so no nodes are added or removed.
+	ok = ok && peers.nodes.size == 0 && peers.nodes_to_remove.size == 0;
+
+	if (ok) {
+		printf("%-16s %8zu bytes %10.2f us/parse %10.1f MB/s\n", label, max_len - 1,
+			(double)total / 1000 / iterations, (double)bytes * 1000 / total);
+	}
+	else {
+		printf("%-16s parse failed\n", label);
+	}
+
+	as_vector_destroy(&peers.nodes);
+	as_vector_destroy(&peers.nodes_to_remove);
+	as_vector_destroy(&peers.invalid_hosts);
+	as_vector_destroy(&values);
+	cf_free(buf);
+	return ok;
+}
+
+static bool
+run(aerospike* as, mock_server* server, uint32_t n_namespaces, uint32_t iterations)
+{
+	as_cluster* cluster = as->cluster;
+	as_nodes* nodes = as_nodes_reserve(cluster);
+
+	if (nodes->size == 0) {
+		printf("cluster is empty\n");
+		as_nodes_release(nodes);
+		return false;
+	}
+
+	as_node* node = nodes->array[0];
+	char* replicas[N_ROTATIONS] = {NULL};
+	char* replicas_values[N_ROTATIONS];
+	char* multi = NULL;
+	char* peers = NULL;
+	char* peers_value;
+	char* racks = NULL;
+	char* racks_value;
+	bool ok = false;
+
+	// Each churn moves a quarter of the partitions whose owner rotates over the nodes.
+	for (uint32_t r = 0; r < N_ROTATIONS; r++) {
+		mock_server_churn_partitions(server, 4096 / N_ROTATIONS);
+
+		if (! (replicas[r] = capture(as, node, "replicas", &replicas_values[r]))) {
+			goto done;
+		}
+	}
+
+	if (! (multi = capture(as, node, "replicas", NULL)) ||
+		! (peers = capture(as, node, "peers-clear-std", &peers_value)) ||
+		! (racks = capture(as, node, "rack-ids", &racks_value))) {
+		goto done;
+	}
+
+	// Generate a racks response with a different rack per namespace.
+	as_string_builder sb;
+	as_string_builder_init(&sb, 1024, true);
+
+	for (uint32_t i = 0; i < n_namespaces; i++) {
+		char tmp[64];
+		snprintf(tmp, sizeof(tmp), "%s:%u;", mock_server_namespace(server, i), i + 1);
+		as_string_builder_append(&sb, tmp);
+	}
+
+	char* racks_mixed = sb.data;
+
+	pthread_mutex_lock(&cluster->tend_lock);
+	ok = parse_run(cluster, node, PARSE_REPLICAS, "replicas", replicas_values, N_ROTATIONS,
+			iterations) &&
+		parse_run(cluster, node, PARSE_PEERS, "peers", &peers_value, 1, iterations) &&
+		parse_run(cluster, node, PARSE_RACKS, "racks same", &racks_value, 1, iterations) &&
+		parse_run(cluster, node, PARSE_RACKS, "racks mixed", &racks_mixed, 1, iterations) &&
+		parse_run(cluster, node, PARSE_MULTI, "multi response", &multi, 1, iterations);
+	pthread_mutex_unlock(&cluster->tend_lock);
+
+	as_string_builder_destroy(&sb);
+
+done:
+	for (uint32_t r = 0; r < N_ROTATIONS; r++) {
+		cf_free(replicas[r]);
+	}
+	cf_free(multi);
+	cf_free(peers);
+	cf_free(racks);
+	as_nodes_release(nodes);
+	return ok;
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_nodes = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+	uint32_t n_namespaces = argc > 2 ? (uint32_t)atoi(argv[2]) : 8;
+	uint32_t iterations = argc > 3 ? (uint32_t)atoi(argv[3]) : 2000;
+
+	if (n_nodes == 0 || n_namespaces == 0 || n_namespaces > AS_MAX_NAMESPACES ||
+		iterations == 0) {
+		printf("Usage: info_bench [nodes] [namespaces (1-%u)] [iterations]\n",
+			AS_MAX_NAMESPACES);
+		return 1;
+	}
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	mc.n_nodes = n_nodes;
+	mc.n_namespaces = n_namespaces;
+
+	mock_server* server = mock_server_start(&mc);
+
+	if (! server) {
+		printf("mock server start failed\n");
+		return 1;
+	}
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(server, 0));
+	config.tender_interval = TEND_INTERVAL_MS;
+	config.rack_aware = true;
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("connect failed: %d %s\n", err.code, err.message);
+		aerospike_destroy(&as);
+		mock_server_stop(server);
+		return 1;
+	}
+
+	printf("nodes: %u namespaces: %u iterations: %u\n", n_nodes, n_namespaces, iterations);
+
+	bool ok = run(&as, server, n_namespaces, iterations);
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	mock_server_stop(server);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+/**
+ * Client throughput benchmark against an in-process loopback mock cluster. Measures cluster
+ * connect time and sync get, put and batch read rates without a real server, so runs are
+ * repeatable on a single machine and in CI. Server latency can be emulated with delay_us.
+ *
+ * Usage: mock_bench [nodes] [threads] [seconds per case] [delay_us]
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_batch.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_record.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../util/mock_server.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_KEYS 100000
+#define N_BATCH 100
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef enum {
+	CASE_GET,
+	CASE_PUT,
+	CASE_BATCH
+} bench_case;
+
+typedef struct {
+	aerospike* as;
+	bench_case type;
+	uint64_t end_ns;
+	uint64_t ops;
+	uint64_t errors;
+} bench_ctx;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static void*
+bench_run(void* udata)
+{
+	bench_ctx* ctx = udata;
+	uint32_t seed = (uint32_t)(uintptr_t)pthread_self();
+	uint64_t ops = 0;
+	uint64_t errors = 0;
+	as_error err;
+	as_key key;
+
+	as_batch_records* records = NULL;
+
+	if (ctx->type == CASE_BATCH) {
+		records = as_batch_records_create(N_BATCH);
+
+		for (uint32_t i = 0; i < N_BATCH; i++) {
+			as_batch_read_record* r = as_batch_read_reserve(records);
+			as_key_init_int64(&r->key, "test", "bench", (int64_t)i);
+			r->read_all_bins = true;
+		}
+	}
+
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_int64(&rec, "b0", 1);
+
+	while (cf_getns() < ctx->end_ns) {
+		as_status status;
+
+		switch (ctx->type) {
+			case CASE_GET: {
+				as_key_init_int64(&key, "test", "bench", (int64_t)(rand_r(&seed) % N_KEYS));
+				as_record* out = NULL;
+				status = aerospike_key_get(ctx->as, &err, NULL, &key, &out);
+				as_record_destroy(out);
+				break;
+			}
+			case CASE_PUT:
+				as_key_init_int64(&key, "test", "bench", (int64_t)(rand_r(&seed) % N_KEYS));
+				status = aerospike_key_put(ctx->as, &err, NULL, &key, &rec);
+				break;
+			default:
+				status = aerospike_batch_read(ctx->as, &err, NULL, records);
+				as_batch_records_reset(records);
+				break;
+		}
+
+		if (status == AEROSPIKE_OK) {
+			ops++;
+		}
+		else {
+			errors++;
+		}
+	}
+
+	as_record_destroy(&rec);
+
+	if (records) {
+		as_batch_records_destroy(records);
+	}
+	ctx->ops = ops;
+	ctx->errors = errors;
+	return NULL;
+}
+
+static void
+bench_case_run(aerospike* as, bench_case type, const char* name, uint32_t n_threads,
+	uint32_t seconds)
+{
+	pthread_t* threads = malloc(sizeof(pthread_t) * n_threads);
+	bench_ctx* ctxs = malloc(sizeof(bench_ctx) * n_threads);
+	uint64_t begin = cf_getns();
+	uint64_t end = begin + (uint64_t)seconds * 1000 * 1000 * 1000;
+
+	for (uint32_t i = 0; i < n_threads; i++) {
+		ctxs[i].as = as;
+		ctxs[i].type = type;
+		ctxs[i].end_ns = end;
+		pthread_create(&threads[i], NULL, bench_run, &ctxs[i]);
+	}
+
+	uint64_t ops = 0;
+	uint64_t errors = 0;
+
+	for (uint32_t i = 0; i < n_threads; i++) {
+		pthread_join(threads[i], NULL);
+		ops += ctxs[i].ops;
+		errors += ctxs[i].errors;
+	}
+
+	double elapsed = (double)(cf_getns() - begin) / 1e9;
+	uint32_t per_op = (type == CASE_BATCH)? N_BATCH : 1;
+
+	printf("%-8s %12.0f ops/s %12.0f records/s errors: %" PRIu64 "\n", name, ops / elapsed,
+		ops * per_op / elapsed, errors);
+
+	free(ctxs);
+	free(threads);
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_nodes = argc > 1 ? (uint32_t)atoi(argv[1]) : 3;
+	uint32_t n_threads = argc > 2 ? (uint32_t)atoi(argv[2]) : 8;
+	uint32_t seconds = argc > 3 ? (uint32_t)atoi(argv[3]) : 3;
+	uint32_t delay_us = argc > 4 ? (uint32_t)atoi(argv[4]) : 0;
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	mc.n_nodes = n_nodes;
+	mc.delay_us = delay_us;
+
+	mock_server* server = mock_server_start(&mc);
+
+	if (! server) {
+		printf("mock server start failed\n");
+		return 1;
+	}
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(server, 0));
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+	uint64_t begin = cf_getns();
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("connect failed: %d %s\n", err.code, err.message);
+		aerospike_destroy(&as);
+		mock_server_stop(server);
+		return 1;
+	}
+
+	printf("nodes: %u threads: %u seconds: %u delay: %u us\n", n_nodes, n_threads, seconds,
+		delay_us);
+	printf("connect: %8.1f ms\n", (double)(cf_getns() - begin) / 1e6);
+
+	bench_case_run(&as, CASE_GET, "get", n_threads, seconds);
+	bench_case_run(&as, CASE_PUT, "put", n_threads, seconds);
+	bench_case_run(&as, CASE_BATCH, "batch", n_threads, seconds);
+
+	printf("server commands: %" PRIu64 "\n", mock_server_commands(server));
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	mock_server_stop(server);
+	return 0;
+}
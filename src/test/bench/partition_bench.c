@@ -0,0 +1,225 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/**
+ * Micro-benchmark for the partition map update path (node "replicas" info response).
+ * Runs without a server: a detached cluster and node set are fed generated responses.
+ *
+ * Usage: partition_bench [namespaces] [iterations]
+ */
+#include <aerospike/as_bitmap.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_string_builder.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_b64.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_PARTITIONS 4096
+#define N_NODES 3
+#define N_REPLICAS 3
+
+/******************************************************************************
+ * DECLARATIONS
+ *****************************************************************************/
+
+bool
+as_partition_tables_update_all(as_cluster* cluster, as_node* node, char* buf);
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+// Build replicas response of node for rotation. Partition replica ownership rotates across
+// nodes on every rotation to simulate migrations during a rolling restart.
+static char*
+build_response(uint32_t n_namespaces, uint32_t node_index, uint32_t rotation)
+{
+	uint8_t bitmap[N_PARTITIONS / 8];
+	char b64[cf_b64_encoded_len(N_PARTITIONS / 8) + 1];
+	as_string_builder sb;
+	as_string_builder_init(&sb, 64 * 1024, true);
+
+	for (uint32_t ns = 0; ns < n_namespaces; ns++) {
+		char ns_name[32];
+		snprintf(ns_name, sizeof(ns_name), "ns%u", ns);
+		as_string_builder_append(&sb, ns_name);
+		as_string_builder_append(&sb, ":0,3");
+
+		for (uint32_t r = 0; r < N_REPLICAS; r++) {
+			memset(bitmap, 0, sizeof(bitmap));
+
+			for (uint32_t i = 0; i < N_PARTITIONS; i++) {
+				if ((i + r + rotation) % N_NODES == node_index) {
+					bitmap[i >> 3] |= (uint8_t)(0x80 >> (i & 7));
+				}
+			}
+			cf_b64_encode(bitmap, sizeof(bitmap), b64);
+			b64[cf_b64_encoded_len(sizeof(bitmap))] = 0;
+			as_string_builder_append_char(&sb, ',');
+			as_string_builder_append(&sb, b64);
+		}
+		as_string_builder_append_char(&sb, ';');
+	}
+	return sb.data;
+}
+
+static void
+bench_decode(const char* b64, uint32_t len, uint32_t iterations)
+{
+	uint8_t bitmap[cf_b64_decoded_buf_size(len)];
+	uint64_t count = 0;
+	uint64_t begin = cf_getns();
+
+	for (uint32_t k = 0; k < iterations; k++) {
+		cf_b64_decode(b64, len, bitmap, NULL);
+
+		for (uint32_t i = 0; i < N_PARTITIONS; i++) {
+			if ((bitmap[i >> 3] & (0x80 >> (i & 7))) != 0) {
+				count++;
+			}
+		}
+	}
+
+	uint64_t mid = cf_getns();
+
+	for (uint32_t k = 0; k < iterations; k++) {
+		as_bitmap_b64_decode(b64, len, bitmap);
+
+		as_bitmap_iter iter;
+		as_bitmap_iter_init(&iter, bitmap, N_PARTITIONS);
+
+		uint32_t i;
+
+		while (as_bitmap_iter_next(&iter, &i)) {
+			count--;
+		}
+	}
+
+	uint64_t end = cf_getns();
+
+	printf("bitmap decode+scan bytewise: %8.1f ns/bitmap\n", (double)(mid - begin) / iterations);
+	printf("bitmap decode+scan wordwise: %8.1f ns/bitmap\n", (double)(end - mid) / iterations);
+
+	if (count != 0) {
+		printf("bitmap scan mismatch: %" PRIu64 "\n", count);
+		exit(1);
+	}
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char* argv[])
+{
+	uint32_t n_namespaces = argc > 1 ? (uint32_t)atoi(argv[1]) : 8;
+	uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 1000;
+
+	if (n_namespaces == 0 || n_namespaces > AS_MAX_NAMESPACES || iterations == 0) {
+		printf("Usage: partition_bench [namespaces (1-%u)] [iterations]\n", AS_MAX_NAMESPACES);
+		return 1;
+	}
+
+	as_cluster* cluster = cf_calloc(1, sizeof(as_cluster));
+	cluster->n_partitions = N_PARTITIONS;
+
+	as_node* nodes[N_NODES];
+
+	for (uint32_t n = 0; n < N_NODES; n++) {
+		as_node* node = cf_calloc(1, sizeof(as_node));
+		snprintf(node->name, sizeof(node->name), "BB9%011u", n);
+		node->cluster = cluster;
+		node->ref_count = 1;
+		// Hold an extra partition reference so rotation never releases a node.
+		node->partition_ref_count = 1;
+		nodes[n] = node;
+	}
+
+	// Pre-render one response per node and rotation. Parsing is destructive, so each
+	// update works on a copy.
+	char* responses[N_NODES][N_NODES];
+	size_t max_len = 0;
+
+	for (uint32_t n = 0; n < N_NODES; n++) {
+		for (uint32_t r = 0; r < N_NODES; r++) {
+			responses[n][r] = build_response(n_namespaces, n, r);
+			size_t len = strlen(responses[n][r]) + 1;
+
+			if (len > max_len) {
+				max_len = len;
+			}
+		}
+	}
+
+	char* buf = cf_malloc(max_len);
+	uint64_t total = 0;
+
+	for (uint32_t k = 0; k < iterations; k++) {
+		uint32_t rotation = k % N_NODES;
+
+		for (uint32_t n = 0; n < N_NODES; n++) {
+			strcpy(buf, responses[n][rotation]);
+
+			uint64_t begin = cf_getns();
+
+			if (! as_partition_tables_update_all(cluster, nodes[n], buf)) {
+				printf("partition update failed\n");
+				return 1;
+			}
+			total += cf_getns() - begin;
+		}
+	}
+
+	printf("namespaces: %u replicas: %u nodes: %u iterations: %u\n", n_namespaces, N_REPLICAS,
+		N_NODES, iterations);
+	printf("partition update: %8.1f us/node\n", (double)total / 1000 / iterations / N_NODES);
+
+	// Benchmark the bitmap step alone using the first replica bitmap of the first response.
+	char* b64 = strchr(responses[0][0], ',') + 1;
+	b64 = strchr(b64, ',') + 1;
+	uint32_t b64_len = (uint32_t)(strchr(b64, ',') - b64);
+	bench_decode(b64, b64_len, iterations * 10);
+
+	// Partition tables reference the detached nodes, so release process memory directly.
+	for (uint32_t i = 0; i < cluster->partition_tables.size; i++) {
+		cf_free(cluster->partition_tables.tables[i]);
+	}
+
+	for (uint32_t n = 0; n < N_NODES; n++) {
+		for (uint32_t r = 0; r < N_NODES; r++) {
+			cf_free(responses[n][r]);
+		}
+
+		if (nodes[n]->partition_bitmaps) {
+			as_partition_bitmaps_destroy(nodes[n]);
+		}
+		cf_free(nodes[n]);
+	}
+	cf_free(buf);
+	cf_free(cluster);
+	return 0;
+}
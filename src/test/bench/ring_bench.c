@@ -0,0 +1,182 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+/**
+ * Cross-thread event loop submission benchmark. Producer threads queue functions to the event
+ * loops with as_event_execute(), which goes through each loop's lock-free submission ring and
+ * only wakes the loop on the empty to non-empty transition. Each producer keeps a bounded
+ * number of functions in flight, so the ring overflow queue is only used when the window is
+ * larger than the ring. Reports submit throughput, submit cost per producer and the process
+ * CPU time per submit for each producer count.
+ *
+ * Usage: ring_bench [event loops] [seconds per case] [window per producer] [max producers]
+ */
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_event.h>
+#include <aerospike/as_event_internal.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t n_loops;
+	uint32_t window;
+	uint32_t index;
+	uint64_t end_ns;
+	uint64_t submits;
+	uint64_t submit_ns;
+	uint64_t failures;
+	uint64_t done;
+} bench_ctx;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint64_t
+cpu_us(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec +
+		(uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+}
+
+static void
+bench_executable(as_event_loop* event_loop, void* udata)
+{
+	(void)event_loop;
+
+	bench_ctx* ctx = udata;
+	as_incr_uint64(&ctx->done);
+}
+
+static void*
+bench_run(void* udata)
+{
+	bench_ctx* ctx = udata;
+	uint32_t loop_index = ctx->index % ctx->n_loops;
+	uint64_t submits = 0;
+	uint64_t failures = 0;
+	uint64_t begin = cf_getns();
+
+	while (cf_getns() < ctx->end_ns) {
+		// Spread producers over all loops.
+		as_event_loop* event_loop = as_event_loop_get_by_index(loop_index);
+
+		if (++loop_index == ctx->n_loops) {
+			loop_index = 0;
+		}
+
+		while (submits - as_load_uint64(&ctx->done) >= ctx->window) {
+			sched_yield();
+		}
+
+		if (as_event_execute(event_loop, bench_executable, ctx)) {
+			submits++;
+		}
+		else {
+			failures++;
+		}
+	}
+
+	ctx->submit_ns = cf_getns() - begin;
+	ctx->submits = submits;
+	ctx->failures = failures;
+
+	// Wait for queued functions before the context is released.
+	while (as_load_uint64(&ctx->done) < submits) {
+		sched_yield();
+	}
+	return NULL;
+}
+
+static void
+bench_case_run(uint32_t n_producers, uint32_t n_loops, uint32_t window, uint32_t seconds)
+{
+	pthread_t* threads = malloc(sizeof(pthread_t) * n_producers);
+	bench_ctx* ctxs = calloc(n_producers, sizeof(bench_ctx));
+	uint64_t cpu_begin = cpu_us();
+	uint64_t begin = cf_getns();
+	uint64_t end = begin + (uint64_t)seconds * 1000 * 1000 * 1000;
+
+	for (uint32_t i = 0; i < n_producers; i++) {
+		ctxs[i].n_loops = n_loops;
+		ctxs[i].window = window;
+		ctxs[i].index = i;
+		ctxs[i].end_ns = end;
+		pthread_create(&threads[i], NULL, bench_run, &ctxs[i]);
+	}
+
+	uint64_t submits = 0;
+	uint64_t submit_ns = 0;
+	uint64_t failures = 0;
+
+	for (uint32_t i = 0; i < n_producers; i++) {
+		pthread_join(threads[i], NULL);
+		submits += ctxs[i].submits;
+		submit_ns += ctxs[i].submit_ns;
+		failures += ctxs[i].failures;
+	}
+
+	double elapsed = (double)(cf_getns() - begin) / 1e9;
+	uint64_t cpu = cpu_us() - cpu_begin;
+	double ns_per_submit = submits ? (double)submit_ns / submits : 0;
+	double cpu_per_submit = submits ? (double)cpu * 1000.0 / submits : 0;
+
+	printf("%9u %14.0f %14.1f %14.1f %10" PRIu64 "\n", n_producers, submits / elapsed,
+		ns_per_submit, cpu_per_submit, failures);
+
+	free(ctxs);
+	free(threads);
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_loops = argc > 1 ? (uint32_t)atoi(argv[1]) : 8;
+	uint32_t seconds = argc > 2 ? (uint32_t)atoi(argv[2]) : 3;
+	uint32_t window = argc > 3 ? (uint32_t)atoi(argv[3]) : 256;
+	uint32_t max_producers = argc > 4 ? (uint32_t)atoi(argv[4]) : 32;
+
+	if (! as_event_create_loops(n_loops)) {
+		printf("event loop create failed\n");
+		return 1;
+	}
+
+	printf("event loops: %u seconds: %u window: %u\n", n_loops, seconds, window);
+	printf("%9s %14s %14s %14s %10s\n", "producers", "submits/s", "ns/submit", "cpu ns/submit",
+		"failures");
+
+	for (uint32_t n = 1; n <= max_producers; n *= 2) {
+		bench_case_run(n, n_loops, window, seconds);
+	}
+
+	as_event_close_loops();
+	return 0;
+}
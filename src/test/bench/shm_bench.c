@@ -0,0 +1,480 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/**
+ * Multi-process shared memory partition lookup benchmark against an in-process loopback mock
+ * cluster. Child processes are forked before any client or mock server thread exists. The
+ * parent is the shared memory tend master and each child follows the same shared memory
+ * cluster and resolves keys to nodes in a tight loop, the same way commands do. Every replica
+ * policy is measured while the cluster is steady and while the parent churns partition
+ * ownership, which bumps rebalance generation, so the tender rewrites partition entries and
+ * node rack ids under the node write lock while children read them.
+ *
+ * Reports aggregate lookups per second, ns per lookup, the worst time spent on one batch of
+ * lookups in any child and lookups that resolved to no node.
+ *
+ * Usage: shm_bench [processes] [seconds per case] [nodes] [partitions moved per churn]
+ *        [churn interval ms]
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_shm_cluster.h>
+#include <aerospike/as_sleep.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../util/mock_server.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Parent tend thread interval. Tend cycles are run by the benchmark.
+#define TEND_INTERVAL_MS (3600 * 1000)
+
+// Child tend thread interval. Followers copy node and rack changes from shared memory.
+#define FOLLOW_INTERVAL_MS 50
+
+#define SET "shm"
+#define N_KEYS 4096
+#define BATCH_SIZE 256
+
+// Control command that tells a child to disconnect and exit.
+#define CMD_EXIT UINT32_MAX
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	uint32_t replica;
+	uint32_t seconds;
+} bench_cmd;
+
+typedef struct {
+	int32_t ok;
+	uint32_t pad;
+	uint64_t lookups;
+	uint64_t ns;
+	uint64_t max_batch_ns;
+	uint64_t nulls;
+} bench_result;
+
+typedef struct {
+	pid_t pid;
+	int cmd_fd;
+} bench_child;
+
+typedef struct {
+	uint32_t n_nodes;
+	uint32_t n_namespaces;
+	int shm_key;
+} bench_cluster;
+
+/******************************************************************************
+ * DECLARATIONS
+ *****************************************************************************/
+
+as_status
+as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init);
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static bool
+read_full(int fd, void* buf, size_t size)
+{
+	uint8_t* p = buf;
+
+	while (size > 0) {
+		ssize_t rv = read(fd, p, size);
+
+		if (rv <= 0) {
+			return false;
+		}
+		p += rv;
+		size -= (size_t)rv;
+	}
+	return true;
+}
+
+static bool
+write_full(int fd, const void* buf, size_t size)
+{
+	// Result and command records are smaller than PIPE_BUF, so writes are atomic.
+	return write(fd, buf, size) == (ssize_t)size;
+}
+
+static void
+config_init(as_config* config, const bench_cluster* bc, uint16_t port, uint32_t tend_interval)
+{
+	as_config_init(config);
+	as_config_add_host(config, "127.0.0.1", port);
+	config->tender_interval = tend_interval;
+	config->use_shm = true;
+	config->shm_key = bc->shm_key;
+	config->shm_max_nodes = bc->n_nodes;
+	config->shm_max_namespaces = bc->n_namespaces;
+
+	// The mock cluster reports rack 0 for every node and namespace.
+	config->rack_aware = true;
+	config->rack_id = 0;
+}
+
+static void
+child_lookups(as_cluster* cluster, as_key* keys, const bench_cmd* cmd, bench_result* res)
+{
+	as_policy_replica replica = (as_policy_replica)cmd->replica;
+	uint64_t begin = cf_getns();
+	uint64_t end = begin + (uint64_t)cmd->seconds * 1000 * 1000 * 1000;
+	uint64_t now = begin;
+	uint32_t k = 0;
+
+	while (now < end) {
+		uint64_t batch_begin = now;
+
+		for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+			as_partition_info pi;
+			as_error err;
+
+			if (as_partition_info_init(&pi, cluster, &err, &keys[k]) != AEROSPIKE_OK) {
+				res->nulls++;
+			}
+			else {
+				uint8_t replica_index = 0;
+				as_node* node = as_partition_get_node(cluster, pi.ns, pi.partition, NULL,
+					replica, pi.replica_size, &replica_index);
+
+				if (! node) {
+					res->nulls++;
+				}
+			}
+
+			if (++k == N_KEYS) {
+				k = 0;
+			}
+		}
+
+		now = cf_getns();
+
+		uint64_t elapsed = now - batch_begin;
+
+		if (elapsed > res->max_batch_ns) {
+			res->max_batch_ns = elapsed;
+		}
+		res->lookups += BATCH_SIZE;
+	}
+	res->ns = now - begin;
+}
+
+static int
+child_run(const bench_cluster* bc, int cmd_fd, int res_fd)
+{
+	uint32_t port;
+
+	if (! read_full(cmd_fd, &port, sizeof(port))) {
+		return 1;
+	}
+
+	as_config config;
+	config_init(&config, bc, (uint16_t)port, FOLLOW_INTERVAL_MS);
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+	bench_result res;
+	memset(&res, 0, sizeof(res));
+	res.ok = aerospike_connect(&as, &err) == AEROSPIKE_OK;
+
+	write_full(res_fd, &res, sizeof(res));
+
+	if (! res.ok) {
+		aerospike_destroy(&as);
+		return 1;
+	}
+
+	as_key* keys = malloc(sizeof(as_key) * N_KEYS);
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		// Alternate between the mock cluster's two namespaces.
+		as_key_init_int64(&keys[i], (i & 1) ? "ns1" : "test", SET, (int64_t)i);
+		as_key_set_digest(&err, &keys[i]);
+	}
+
+	bench_cmd cmd;
+
+	while (read_full(cmd_fd, &cmd, sizeof(cmd)) && cmd.replica != CMD_EXIT) {
+		memset(&res, 0, sizeof(res));
+		res.ok = 1;
+		child_lookups(as.cluster, keys, &cmd, &res);
+		write_full(res_fd, &res, sizeof(res));
+	}
+
+	for (uint32_t i = 0; i < N_KEYS; i++) {
+		as_key_destroy(&keys[i]);
+	}
+	free(keys);
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	return 0;
+}
+
+// Run one tend cycle the same way the shared memory tend thread does. The tend lock keeps
+// the tend thread out.
+static void
+tend_cycle(as_cluster* cluster)
+{
+	as_error err;
+
+	pthread_mutex_lock(&cluster->tend_lock);
+	as_cluster_tend(cluster, &err, false);
+	as_store_uint64(&cluster->shm_info->cluster_shm->timestamp, cf_getms());
+	pthread_mutex_unlock(&cluster->tend_lock);
+}
+
+static bool
+run_case(
+	as_cluster* cluster, mock_server* server, bench_child* children, uint32_t n_children,
+	int res_fd, as_policy_replica replica, bool churn, uint32_t seconds, uint32_t moves,
+	uint32_t interval_ms
+	)
+{
+	bench_cmd cmd = {.replica = (uint32_t)replica, .seconds = seconds};
+
+	for (uint32_t i = 0; i < n_children; i++) {
+		write_full(children[i].cmd_fd, &cmd, sizeof(cmd));
+	}
+
+	// Keep tending while children run, so steady and churn cases pay the same tend cost.
+	uint64_t end = cf_getms() + (uint64_t)seconds * 1000;
+	uint64_t churns = 0;
+
+	while (cf_getms() < end) {
+		if (churn) {
+			mock_server_churn_partitions(server, moves);
+			churns++;
+		}
+		tend_cycle(cluster);
+		as_sleep(interval_ms);
+	}
+
+	bench_result total;
+	memset(&total, 0, sizeof(total));
+
+	for (uint32_t i = 0; i < n_children; i++) {
+		bench_result res;
+
+		if (! read_full(res_fd, &res, sizeof(res)) || ! res.ok) {
+			printf("child result failed\n");
+			return false;
+		}
+
+		total.lookups += res.lookups;
+		total.ns += res.ns;
+		total.nulls += res.nulls;
+
+		if (res.max_batch_ns > total.max_batch_ns) {
+			total.max_batch_ns = res.max_batch_ns;
+		}
+	}
+
+	static const char* names[] = {"master", "any", "sequence", "prefer_rack", "random",
+		"latency"};
+
+	// Children run concurrently, so throughput is total lookups over the case length.
+	uint64_t n = total.lookups ? total.lookups : 1;
+
+	printf("%-12s %-7s %14.0f %12.1f %14.1f %10" PRIu64 " %8" PRIu64 "\n", names[replica],
+		churn ? "churn" : "steady", (double)total.lookups / seconds, (double)total.ns / n,
+		(double)total.max_batch_ns / 1000, total.nulls, churns);
+	return true;
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_children = argc > 1 ? (uint32_t)atoi(argv[1]) : 32;
+	uint32_t seconds = argc > 2 ? (uint32_t)atoi(argv[2]) : 3;
+	uint32_t n_nodes = argc > 3 ? (uint32_t)atoi(argv[3]) : 16;
+	uint32_t moves = argc > 4 ? (uint32_t)atoi(argv[4]) : 64;
+	uint32_t interval_ms = argc > 5 ? (uint32_t)atoi(argv[5]) : 5;
+
+	if (n_children == 0 || seconds == 0 || n_nodes == 0 || moves == 0) {
+		printf("Usage: shm_bench [processes] [seconds per case] [nodes] "
+			"[partitions moved per churn] [churn interval ms]\n");
+		return 1;
+	}
+
+	bench_cluster bc = {
+		.n_nodes = n_nodes,
+		.n_namespaces = 2,
+		.shm_key = (int)(0xA9200000 | (getpid() & 0xFFFFF))
+	};
+
+	int res_pipe[2];
+
+	if (pipe(res_pipe) != 0) {
+		printf("pipe failed\n");
+		return 1;
+	}
+
+	// Fork before the mock server and parent client start threads.
+	bench_child* children = calloc(n_children, sizeof(bench_child));
+
+	for (uint32_t i = 0; i < n_children; i++) {
+		int cmd_pipe[2];
+
+		if (pipe(cmd_pipe) != 0) {
+			printf("pipe failed\n");
+			return 1;
+		}
+
+		pid_t pid = fork();
+
+		if (pid == 0) {
+			close(cmd_pipe[1]);
+			close(res_pipe[0]);
+
+			// Control pipes of earlier children are inherited. Close them, so those children
+			// see end of file when the parent exits.
+			for (uint32_t j = 0; j < i; j++) {
+				close(children[j].cmd_fd);
+			}
+			_exit(child_run(&bc, cmd_pipe[0], res_pipe[1]));
+		}
+
+		close(cmd_pipe[0]);
+
+		if (pid < 0) {
+			printf("fork failed\n");
+			return 1;
+		}
+		children[i].pid = pid;
+		children[i].cmd_fd = cmd_pipe[1];
+	}
+	close(res_pipe[1]);
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	mc.n_nodes = n_nodes;
+	mc.n_namespaces = bc.n_namespaces;
+
+	mock_server* server = mock_server_start(&mc);
+	int rv = 1;
+
+	if (! server) {
+		printf("mock server start failed\n");
+		goto exit_children;
+	}
+
+	// Connect the parent first, so it creates shared memory and becomes tend master.
+	as_config config;
+	config_init(&config, &bc, mock_server_port(server, 0), TEND_INTERVAL_MS);
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("connect failed: %d %s\n", err.code, err.message);
+		aerospike_destroy(&as);
+		mock_server_stop(server);
+		goto exit_children;
+	}
+
+	uint32_t port = mock_server_port(server, 0);
+	uint32_t ready = 0;
+
+	for (uint32_t i = 0; i < n_children; i++) {
+		write_full(children[i].cmd_fd, &port, sizeof(port));
+	}
+
+	for (uint32_t i = 0; i < n_children; i++) {
+		bench_result res;
+
+		if (read_full(res_pipe[0], &res, sizeof(res)) && res.ok) {
+			ready++;
+		}
+	}
+
+	if (ready != n_children) {
+		printf("%u of %u children connected\n", ready, n_children);
+	}
+	else {
+		printf("processes: %u nodes: %u seconds: %u partitions moved: %u interval: %u ms\n",
+			n_children, n_nodes, seconds, moves, interval_ms);
+		printf("%-12s %-7s %14s %12s %14s %10s %8s\n", "replica", "phase", "lookups/s",
+			"ns/lookup", "max batch us", "nulls", "churns");
+
+		static const as_policy_replica replicas[] = {
+			AS_POLICY_REPLICA_MASTER, AS_POLICY_REPLICA_SEQUENCE, AS_POLICY_REPLICA_PREFER_RACK
+		};
+
+		rv = 0;
+
+		for (uint32_t r = 0; r < sizeof(replicas) / sizeof(replicas[0]) && rv == 0; r++) {
+			for (uint32_t c = 0; c < 2; c++) {
+				if (! run_case(as.cluster, server, children, n_children, res_pipe[0],
+					replicas[r], c == 1, seconds, moves, interval_ms)) {
+					rv = 1;
+					break;
+				}
+			}
+		}
+	}
+
+	bench_cmd cmd = {.replica = CMD_EXIT, .seconds = 0};
+
+	for (uint32_t i = 0; i < n_children; i++) {
+		write_full(children[i].cmd_fd, &cmd, sizeof(cmd));
+	}
+
+	// Followers must detach before the tend master removes shared memory.
+	for (uint32_t i = 0; i < n_children; i++) {
+		close(children[i].cmd_fd);
+		waitpid(children[i].pid, NULL, 0);
+	}
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	mock_server_stop(server);
+	free(children);
+	return rv;
+
+exit_children:
+	for (uint32_t i = 0; i < n_children; i++) {
+		close(children[i].cmd_fd);
+		waitpid(children[i].pid, NULL, 0);
+	}
+	free(children);
+	return rv;
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+/**
+ * Sync read latency versus CPU benchmark for as_policy_base.spin_read_us against an
+ * in-process loopback mock cluster. Each case runs sync gets with a different spin budget
+ * and reports throughput, latency percentiles and the CPU time the command threads spent
+ * per get. Server latency can be emulated with delay_us to see where spinning stops paying
+ * off. When busy_poll_us is set, connections also use as_config.socket_busy_poll_us.
+ *
+ * Usage: spin_bench [threads] [seconds per case] [delay_us] [busy_poll_us]
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_record.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "../util/mock_server.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define N_KEYS 100000
+
+// Latency samples kept per thread. Later gets are counted but not sampled.
+#define MAX_SAMPLES (1024 * 1024)
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct {
+	aerospike* as;
+	uint32_t spin_read_us;
+	uint64_t end_ns;
+	uint64_t ops;
+	uint64_t errors;
+	uint64_t cpu_us;
+	uint32_t n_samples;
+	uint32_t* samples;
+} bench_ctx;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint64_t
+cpu_us(void)
+{
+	struct rusage usage;
+#if defined(RUSAGE_THREAD)
+	getrusage(RUSAGE_THREAD, &usage);
+#else
+	getrusage(RUSAGE_SELF, &usage);
+#endif
+	return (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec +
+		(uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+}
+
+static int
+sample_compare(const void* p1, const void* p2)
+{
+	uint32_t a = *(const uint32_t*)p1;
+	uint32_t b = *(const uint32_t*)p2;
+	return (a > b) - (a < b);
+}
+
+static void*
+bench_run(void* udata)
+{
+	bench_ctx* ctx = udata;
+	uint32_t seed = (uint32_t)(uintptr_t)pthread_self();
+	uint64_t ops = 0;
+	uint64_t errors = 0;
+	uint32_t n_samples = 0;
+	as_error err;
+	as_key key;
+
+	as_policy_read policy;
+	as_policy_read_copy(&ctx->as->config.policies.read, &policy);
+	policy.base.spin_read_us = ctx->spin_read_us;
+
+	uint64_t cpu_begin = cpu_us();
+
+	while (cf_getns() < ctx->end_ns) {
+		as_key_init_int64(&key, "test", "bench", (int64_t)(rand_r(&seed) % N_KEYS));
+
+		as_record* rec = NULL;
+		uint64_t begin = cf_getns();
+		as_status status = aerospike_key_get(ctx->as, &err, &policy, &key, &rec);
+		uint64_t elapsed = cf_getns() - begin;
+
+		as_record_destroy(rec);
+
+		if (status == AEROSPIKE_OK) {
+			ops++;
+
+			if (n_samples < MAX_SAMPLES) {
+				ctx->samples[n_samples++] = (uint32_t)(elapsed / 100);
+			}
+		}
+		else {
+			errors++;
+		}
+	}
+
+	ctx->cpu_us = cpu_us() - cpu_begin;
+	ctx->ops = ops;
+	ctx->errors = errors;
+	ctx->n_samples = n_samples;
+	return NULL;
+}
+
+static void
+bench_case_run(aerospike* as, uint32_t spin_read_us, uint32_t n_threads, uint32_t seconds)
+{
+	pthread_t* threads = malloc(sizeof(pthread_t) * n_threads);
+	bench_ctx* ctxs = malloc(sizeof(bench_ctx) * n_threads);
+	uint64_t begin = cf_getns();
+	uint64_t end = begin + (uint64_t)seconds * 1000 * 1000 * 1000;
+
+	for (uint32_t i = 0; i < n_threads; i++) {
+		ctxs[i].as = as;
+		ctxs[i].spin_read_us = spin_read_us;
+		ctxs[i].end_ns = end;
+		ctxs[i].samples = malloc(sizeof(uint32_t) * MAX_SAMPLES);
+		pthread_create(&threads[i], NULL, bench_run, &ctxs[i]);
+	}
+
+	uint64_t ops = 0;
+	uint64_t errors = 0;
+	uint64_t cpu = 0;
+	uint64_t n_samples = 0;
+
+	for (uint32_t i = 0; i < n_threads; i++) {
+		pthread_join(threads[i], NULL);
+		ops += ctxs[i].ops;
+		errors += ctxs[i].errors;
+		cpu += ctxs[i].cpu_us;
+		n_samples += ctxs[i].n_samples;
+	}
+
+	double elapsed = (double)(cf_getns() - begin) / 1e9;
+
+	// Merge samples, in units of 100 ns.
+	uint32_t* samples = malloc(sizeof(uint32_t) * (n_samples ? n_samples : 1));
+	uint64_t offset = 0;
+
+	for (uint32_t i = 0; i < n_threads; i++) {
+		memcpy(samples + offset, ctxs[i].samples, sizeof(uint32_t) * ctxs[i].n_samples);
+		offset += ctxs[i].n_samples;
+		free(ctxs[i].samples);
+	}
+
+	qsort(samples, n_samples, sizeof(uint32_t), sample_compare);
+
+	double p50 = n_samples ? samples[n_samples / 2] / 10.0 : 0;
+	double p99 = n_samples ? samples[n_samples * 99 / 100] / 10.0 : 0;
+	double p999 = n_samples ? samples[n_samples * 999 / 1000] / 10.0 : 0;
+	double cpu_per_op = ops ? (double)cpu / ops : 0;
+
+	printf("%6u %12.0f %9.1f %9.1f %9.1f %11.2f %10" PRIu64 "\n", spin_read_us, ops / elapsed,
+		p50, p99, p999, cpu_per_op, errors);
+
+	free(samples);
+	free(ctxs);
+	free(threads);
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_threads = argc > 1 ? (uint32_t)atoi(argv[1]) : 1;
+	uint32_t seconds = argc > 2 ? (uint32_t)atoi(argv[2]) : 3;
+	uint32_t delay_us = argc > 3 ? (uint32_t)atoi(argv[3]) : 0;
+	uint32_t busy_poll_us = argc > 4 ? (uint32_t)atoi(argv[4]) : 0;
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	mc.delay_us = delay_us;
+
+	mock_server* server = mock_server_start(&mc);
+
+	if (! server) {
+		printf("mock server start failed\n");
+		return 1;
+	}
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(server, 0));
+	config.socket_busy_poll_us = busy_poll_us;
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("connect failed: %d %s\n", err.code, err.message);
+		aerospike_destroy(&as);
+		mock_server_stop(server);
+		return 1;
+	}
+
+	printf("threads: %u seconds: %u delay: %u us busy poll: %u us\n", n_threads, seconds,
+		delay_us, busy_poll_us);
+	printf("%6s %12s %9s %9s %9s %11s %10s\n", "spin", "gets/s", "p50 us", "p99 us",
+		"p99.9 us", "cpu us/get", "errors");
+
+	static const uint32_t spins[] = {0, 10, 25, 50, 100, 200};
+
+	for (uint32_t i = 0; i < sizeof(spins) / sizeof(spins[0]); i++) {
+		bench_case_run(&as, spins[i], n_threads, seconds);
+	}
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	mock_server_stop(server);
+	return 0;
+}
@@ -0,0 +1,349 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/**
+ * Cluster tend benchmark against an in-process loopback mock cluster. Measures tend cycle time,
+ * tend thread CPU time and heap allocations per cycle while the cluster is steady, while
+ * partition ownership churns and while peers lists churn. Partition update latency is the
+ * time from a mock ownership change until the client's partition map routes the moved
+ * partition to its new owner. Both the process local cluster and the shared memory cluster
+ * are measured. Allocations are counted on Linux, where the link wraps malloc(), calloc() and
+ * realloc(). Only allocations made by the tending thread are counted.
+ *
+ * Usage: tend_bench [nodes] [namespaces] [cycles per phase] [partitions moved per cycle]
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_shm_cluster.h>
+#include <citrusleaf/cf_clock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "../util/mock_server.h"
+
+/******************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+// Tend thread interval. Cycles are run by the benchmark, so the tend thread never wakes.
+#define TEND_INTERVAL_MS (3600 * 1000)
+
+// Maximum tend cycles to wait for a partition move to become visible.
+#define MAX_UPDATE_CYCLES 10
+
+/******************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef enum {
+	PHASE_STEADY,
+	PHASE_PARTITIONS,
+	PHASE_PEERS
+} bench_phase;
+
+typedef struct {
+	uint64_t cycles;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t cpu_us;
+	uint64_t allocs;
+	uint64_t errors;
+	uint64_t updates;
+	uint64_t update_total_ns;
+	uint64_t update_max_ns;
+	uint64_t update_misses;
+} bench_stats;
+
+/******************************************************************************
+ * DECLARATIONS
+ *****************************************************************************/
+
+as_status
+as_cluster_tend(as_cluster* cluster, as_error* err, bool is_init);
+
+/******************************************************************************
+ * ALLOCATION COUNTER
+ *****************************************************************************/
+
+// Mock nodes allocate on their own threads, so only count the benchmark thread.
+static __thread uint64_t g_allocs;
+
+#if defined(__linux__)
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void*
+__wrap_malloc(size_t size)
+{
+	g_allocs++;
+	return __real_malloc(size);
+}
+
+void*
+__wrap_calloc(size_t n, size_t size)
+{
+	g_allocs++;
+	return __real_calloc(n, size);
+}
+
+void*
+__wrap_realloc(void* ptr, size_t size)
+{
+	g_allocs++;
+	return __real_realloc(ptr, size);
+}
+#define ALLOCS_COUNTED true
+#else
+#define ALLOCS_COUNTED false
+#endif
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint64_t
+cpu_us(void)
+{
+	struct rusage usage;
+#if defined(RUSAGE_THREAD)
+	getrusage(RUSAGE_THREAD, &usage);
+#else
+	getrusage(RUSAGE_SELF, &usage);
+#endif
+	return (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec +
+		(uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+}
+
+// Return name of the node the client routes partition writes to, or NULL if none.
+static const char*
+partition_master(as_cluster* cluster, const char* ns, uint32_t partition_id)
+{
+	as_node* node = NULL;
+
+	if (cluster->shm_info) {
+		as_shm_info* shm_info = cluster->shm_info;
+		as_partition_table_shm* table = as_shm_find_partition_table(shm_info->cluster_shm, ns);
+
+		if (table) {
+			uint32_t index = as_load_uint32_acq(&table->partitions[partition_id].nodes[0]);
+
+			if (index) {
+				node = as_node_load(&shm_info->local_nodes[index - 1]);
+			}
+		}
+	}
+	else {
+		as_partition_table* table = as_partition_tables_get(&cluster->partition_tables, ns);
+
+		if (table) {
+			node = as_node_load(&table->partitions[partition_id].nodes[0]);
+		}
+	}
+	return node ? node->name : NULL;
+}
+
+// Run one tend cycle the same way the tend thread does. The tend lock keeps the tend thread out.
+static void
+tend_cycle(as_cluster* cluster, bench_stats* stats)
+{
+	as_error err;
+
+	pthread_mutex_lock(&cluster->tend_lock);
+
+	uint64_t allocs = g_allocs;
+	uint64_t cpu = cpu_us();
+	uint64_t begin = cf_getns();
+	as_status status = as_cluster_tend(cluster, &err, false);
+	uint64_t elapsed = cf_getns() - begin;
+
+	stats->cpu_us += cpu_us() - cpu;
+	stats->allocs += g_allocs - allocs;
+
+	if (cluster->shm_info) {
+		as_store_uint64(&cluster->shm_info->cluster_shm->timestamp, cf_getms());
+	}
+	pthread_mutex_unlock(&cluster->tend_lock);
+
+	if (status != AEROSPIKE_OK) {
+		stats->errors++;
+	}
+
+	stats->cycles++;
+	stats->total_ns += elapsed;
+
+	if (elapsed > stats->max_ns) {
+		stats->max_ns = elapsed;
+	}
+}
+
+static void
+run_phase(
+	as_cluster* cluster, mock_server* server, bench_phase phase, uint32_t cycles, uint32_t moves
+	)
+{
+	bench_stats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	const char* ns = mock_server_namespace(server, 0);
+
+	for (uint32_t i = 0; i < cycles; i++) {
+		if (phase == PHASE_PEERS) {
+			mock_server_churn_peers(server);
+		}
+		else if (phase == PHASE_PARTITIONS) {
+			uint32_t pid = mock_server_churn_partitions(server, moves);
+			const char* expected = mock_server_node_name(server,
+				mock_server_partition_owner(server, pid));
+			uint64_t begin = cf_getns();
+			bool visible = false;
+
+			for (uint32_t k = 0; k < MAX_UPDATE_CYCLES && ! visible; k++) {
+				tend_cycle(cluster, &stats);
+
+				const char* name = partition_master(cluster, ns, pid);
+				visible = name && strcmp(name, expected) == 0;
+			}
+
+			if (visible) {
+				uint64_t elapsed = cf_getns() - begin;
+				stats.updates++;
+				stats.update_total_ns += elapsed;
+
+				if (elapsed > stats.update_max_ns) {
+					stats.update_max_ns = elapsed;
+				}
+			}
+			else {
+				stats.update_misses++;
+			}
+			continue;
+		}
+		tend_cycle(cluster, &stats);
+	}
+
+	static const char* names[] = {"steady", "partitions", "peers"};
+	uint64_t n = stats.cycles ? stats.cycles : 1;
+
+	printf("%-10s tend: %9.1f us avg %9.1f us max cpu: %9.1f us allocs: ",
+		names[phase], (double)stats.total_ns / 1000 / n, (double)stats.max_ns / 1000,
+		(double)stats.cpu_us / n);
+
+	if (ALLOCS_COUNTED) {
+		printf("%8.1f", (double)stats.allocs / n);
+	}
+	else {
+		printf("%8s", "n/a");
+	}
+	printf(" errors: %" PRIu64 "\n", stats.errors);
+
+	if (phase == PHASE_PARTITIONS) {
+		uint64_t u = stats.updates ? stats.updates : 1;
+		printf("%-10s update: %9.1f us avg %9.1f us max misses: %" PRIu64 "\n", "",
+			(double)stats.update_total_ns / 1000 / u, (double)stats.update_max_ns / 1000,
+			stats.update_misses);
+	}
+}
+
+static bool
+run_mode(
+	mock_server* server, bool use_shm, uint32_t n_nodes, uint32_t n_namespaces, uint32_t cycles,
+	uint32_t moves
+	)
+{
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(server, 0));
+	config.tender_interval = TEND_INTERVAL_MS;
+
+	if (use_shm) {
+		config.use_shm = true;
+		config.shm_key = (int)(0xA9100000 | (getpid() & 0xFFFFF));
+		config.shm_max_nodes = n_nodes;
+		config.shm_max_namespaces = n_namespaces;
+	}
+
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	as_error err;
+	uint64_t begin = cf_getns();
+
+	if (aerospike_connect(&as, &err) != AEROSPIKE_OK) {
+		printf("%s connect failed: %d %s\n", use_shm ? "shm" : "local", err.code, err.message);
+		aerospike_destroy(&as);
+		return false;
+	}
+
+	printf("%s cluster connect: %.1f ms\n", use_shm ? "shm" : "local",
+		(double)(cf_getns() - begin) / 1e6);
+
+	run_phase(as.cluster, server, PHASE_STEADY, cycles, moves);
+	run_phase(as.cluster, server, PHASE_PARTITIONS, cycles, moves);
+	run_phase(as.cluster, server, PHASE_PEERS, cycles, moves);
+
+	aerospike_close(&as, &err);
+	aerospike_destroy(&as);
+	return true;
+}
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_nodes = argc > 1 ? (uint32_t)atoi(argv[1]) : 200;
+	uint32_t n_namespaces = argc > 2 ? (uint32_t)atoi(argv[2]) : 2;
+	uint32_t cycles = argc > 3 ? (uint32_t)atoi(argv[3]) : 100;
+	uint32_t moves = argc > 4 ? (uint32_t)atoi(argv[4]) : 64;
+
+	if (n_nodes == 0 || n_namespaces == 0 || n_namespaces > AS_MAX_NAMESPACES || cycles == 0 ||
+		moves == 0) {
+		printf("Usage: tend_bench [nodes] [namespaces (1-%u)] [cycles per phase] "
+			"[partitions moved per cycle]\n", AS_MAX_NAMESPACES);
+		return 1;
+	}
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	mc.n_nodes = n_nodes;
+	mc.n_namespaces = n_namespaces;
+
+	mock_server* server = mock_server_start(&mc);
+
+	if (! server) {
+		printf("mock server start failed\n");
+		return 1;
+	}
+
+	printf("nodes: %u namespaces: %u cycles: %u partitions moved: %u\n", n_nodes, n_namespaces,
+		cycles, moves);
+
+	bool ok = run_mode(server, false, n_nodes, n_namespaces, cycles, moves) &&
+		run_mode(server, true, n_nodes, n_namespaces, cycles, moves);
+
+	mock_server_stop(server);
+	return ok ? 0 : 1;
+}
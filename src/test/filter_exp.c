@@ -18,6 +18,7 @@
 #include <aerospike/aerospike_batch.h>
 #include <aerospike/aerospike_key.h>
 #include <aerospike/as_exp.h>
+#include <aerospike/as_exp_static.h>
 #include <aerospike/as_arraylist.h>
 #include <aerospike/as_hashmap.h>
 #include <aerospike/as_map_operations.h>
@@ -145,6 +146,34 @@ filter_prepare_bitwise(as_key* keyA)
 	return true;
 }
 
+static as_status
+filter_exists(as_exp* filter, as_key* key)
+{
+	as_policy_read p;
+	as_policy_read_init(&p);
+	p.base.filter_exp = filter;
+
+	as_error err;
+	as_record* rec = NULL;
+	as_status rc = aerospike_key_exists(as, &err, &p, key, &rec);
+
+	if (rec) {
+		as_record_destroy(rec);
+	}
+	return rc;
+}
+
+static bool
+filter_equivalent(as_exp* raw, as_exp* opt, as_key* keyA, as_key* keyB)
+{
+	if (raw == NULL || opt == NULL || opt->packed_sz >= raw->packed_sz) {
+		return false;
+	}
+
+	return filter_exists(raw, keyA) == filter_exists(opt, keyA) &&
+		   filter_exists(raw, keyB) == filter_exists(opt, keyB);
+}
+
 
 /******************************************************************************
  * TEST CASES
@@ -3012,6 +3041,117 @@ TEST(filter_cond, "filter cond")
 	as_exp_destroy(predexp3);
 }
 
+TEST(filter_optimize, "filter optimize")
+{
+	as_key keyA;
+	as_key keyB;
+	bool b = filter_prepare(&keyA, &keyB);
+	assert_true(b);
+
+	// Constant operands and nested and().
+	as_exp_build_raw(raw1,
+		as_exp_and(
+			as_exp_bool(true),
+			as_exp_cmp_eq(as_exp_bin_int(AString), as_exp_int(1)),
+			as_exp_and(
+				as_exp_cmp_eq(as_exp_bin_int(DString), as_exp_int(1)),
+				as_exp_not(as_exp_bool(false)))));
+	as_exp_build(opt1,
+		as_exp_and(
+			as_exp_bool(true),
+			as_exp_cmp_eq(as_exp_bin_int(AString), as_exp_int(1)),
+			as_exp_and(
+				as_exp_cmp_eq(as_exp_bin_int(DString), as_exp_int(1)),
+				as_exp_not(as_exp_bool(false)))));
+	assert_true(filter_equivalent(raw1, opt1, &keyA, &keyB));
+	assert_int_eq(filter_exists(opt1, &keyA), AEROSPIKE_OK);
+	assert_int_eq(filter_exists(opt1, &keyB), AEROSPIKE_FILTERED_OUT);
+
+	// Dead cond() branches and constant comparisons.
+	as_exp_build_raw(raw2,
+		as_exp_cond(
+			as_exp_cmp_eq(as_exp_int(1), as_exp_int(2)), as_exp_bool(false),
+			as_exp_cmp_ge(as_exp_bin_int(AString), as_exp_int(2)), as_exp_bool(true),
+			as_exp_cmp_lt(as_exp_int(1), as_exp_int(2)), as_exp_bool(false),
+			as_exp_bool(true)));
+	as_exp_build(opt2,
+		as_exp_cond(
+			as_exp_cmp_eq(as_exp_int(1), as_exp_int(2)), as_exp_bool(false),
+			as_exp_cmp_ge(as_exp_bin_int(AString), as_exp_int(2)), as_exp_bool(true),
+			as_exp_cmp_lt(as_exp_int(1), as_exp_int(2)), as_exp_bool(false),
+			as_exp_bool(true)));
+	assert_true(filter_equivalent(raw2, opt2, &keyA, &keyB));
+	assert_int_eq(filter_exists(opt2, &keyA), AEROSPIKE_FILTERED_OUT);
+	assert_int_eq(filter_exists(opt2, &keyB), AEROSPIKE_OK);
+
+	// Repeated sub-expression is bound to a variable.
+	as_exp_build_raw(raw3,
+		as_exp_and(
+			as_exp_cmp_gt(
+				as_exp_add(as_exp_bin_int(AString), as_exp_bin_int(DString),
+					as_exp_bin_int(AString)),
+				as_exp_int(2)),
+			as_exp_cmp_lt(
+				as_exp_add(as_exp_bin_int(AString), as_exp_bin_int(DString),
+					as_exp_bin_int(AString)),
+				as_exp_int(4))));
+	as_exp_build(opt3,
+		as_exp_and(
+			as_exp_cmp_gt(
+				as_exp_add(as_exp_bin_int(AString), as_exp_bin_int(DString),
+					as_exp_bin_int(AString)),
+				as_exp_int(2)),
+			as_exp_cmp_lt(
+				as_exp_add(as_exp_bin_int(AString), as_exp_bin_int(DString),
+					as_exp_bin_int(AString)),
+				as_exp_int(4))));
+	assert_true(filter_equivalent(raw3, opt3, &keyA, &keyB));
+	assert_int_eq(filter_exists(opt3, &keyA), AEROSPIKE_OK);
+	assert_int_eq(filter_exists(opt3, &keyB), AEROSPIKE_FILTERED_OUT);
+
+	// Constant string comparison inside or().
+	as_exp_build_raw(raw4,
+		as_exp_or(
+			as_exp_cmp_eq(as_exp_str("abc"), as_exp_str("abd")),
+			as_exp_cmp_eq(as_exp_bin_str(CString), as_exp_str("abcde"))));
+	as_exp_build(opt4,
+		as_exp_or(
+			as_exp_cmp_eq(as_exp_str("abc"), as_exp_str("abd")),
+			as_exp_cmp_eq(as_exp_bin_str(CString), as_exp_str("abcde"))));
+	assert_true(filter_equivalent(raw4, opt4, &keyA, &keyB));
+	assert_int_eq(filter_exists(opt4, &keyA), AEROSPIKE_OK);
+	assert_int_eq(filter_exists(opt4, &keyB), AEROSPIKE_FILTERED_OUT);
+
+	// Wrong number of arguments is rejected.
+	as_exp_entry bad[] = {{.op=_AS_EXP_CODE_NOT, .count=3}, as_exp_bool(true), as_exp_bool(false)};
+	assert_null(as_exp_compile(bad, sizeof(bad) / sizeof(as_exp_entry)));
+
+	as_exp_destroy(raw1);
+	as_exp_destroy(opt1);
+	as_exp_destroy(raw2);
+	as_exp_destroy(opt2);
+	as_exp_destroy(raw3);
+	as_exp_destroy(opt3);
+	as_exp_destroy(raw4);
+	as_exp_destroy(opt4);
+}
+
+TEST(filter_static, "filter static")
+{
+	as_key keyA;
+	as_key keyB;
+	bool b = filter_prepare(&keyA, &keyB);
+	assert_true(b);
+
+	as_exp_static(filter,
+		as_exp_s_and(
+			as_exp_s_cmp_eq(as_exp_s_bin_int('A'), as_exp_s_int(1)),
+			as_exp_s_cmp_eq(as_exp_s_bin_str('C'), as_exp_s_str('a','b','c','d','e'))));
+
+	assert_int_eq(filter_exists(filter, &keyA), AEROSPIKE_OK);
+	assert_int_eq(filter_exists(filter, &keyB), AEROSPIKE_FILTERED_OUT);
+}
+
 TEST(filter_list_value_to_bin, "filter list value to bin")
 {
 	as_key keyA;
@@ -3226,6 +3366,8 @@ SUITE(filter_exp, "filter expression tests")
 	suite_add(filter_max_float);
 	suite_add(filter_let);
 	suite_add(filter_cond);
+	suite_add(filter_optimize);
+	suite_add(filter_static);
 	// Value to bin promotion tests:
 	suite_add(filter_list_value_to_bin);
 	suite_add(filter_map_value_to_bin);
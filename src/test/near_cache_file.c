@@ -0,0 +1,390 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_near_cache_file.h>
+#include <aerospike/as_record.h>
+#include <citrusleaf/alloc.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define NS "test"
+#define SET "ncfile"
+#define BIN "v"
+
+// 2 MB file with 64 entries leaves a ring of about 2 MB.
+#define FILE_SIZE (2 * 1024 * 1024)
+#define MAX_ENTRIES 64
+#define VALIDATE_SEC 3600
+
+// Ring records of this string size fill the ring after ten records.
+#define LARGE 200000
+#define SMALL 100
+
+// File layout offsets of header fields and slot table entries. Must match as_near_cache_file.c.
+#define HDR_N_SLOTS 8
+#define HDR_DATA_SIZE 16
+#define HDR_HEAD 24
+#define HDR_TAIL 32
+#define SLOT_SIZE 48
+#define SLOT_USED 22
+
+//---------------------------------
+// Global Variables
+//---------------------------------
+
+static char g_path[64];
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static as_near_cache_file*
+nc_open(uint32_t max_entries)
+{
+	as_near_cache_file* file = NULL;
+	as_error err;
+
+	if (as_near_cache_file_open(&file, &err, g_path, FILE_SIZE, max_entries, VALIDATE_SEC) !=
+		AEROSPIKE_OK) {
+		error("open %s failed: %d %s", g_path, err.code, err.message);
+		return NULL;
+	}
+	return file;
+}
+
+static void
+nc_put(as_near_cache_file* file, int64_t id, uint32_t len, char c)
+{
+	char* value = cf_malloc(len + 1);
+	memset(value, c, len);
+	value[len] = 0;
+
+	as_key key;
+	as_key_init_int64(&key, NS, SET, id);
+	as_key_digest(&key);
+
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_str(&rec, BIN, value);
+	rec.gen = 1;
+	rec.ttl = AS_RECORD_NO_EXPIRE_TTL;
+
+	as_near_cache_file_put(file, NS, SET, key.digest.value, &rec, as_near_cache_file_now());
+	as_record_destroy(&rec);
+	as_key_destroy(&key);
+	cf_free(value);
+}
+
+// Return true if the file holds the record written by nc_put() with the same arguments.
+static bool
+nc_hit(as_near_cache_file* file, int64_t id, uint32_t len, char c)
+{
+	as_key key;
+	as_key_init_int64(&key, NS, SET, id);
+
+	as_record* rec = NULL;
+	as_near_cache_file_result result = as_near_cache_file_get(file, &key, as_near_cache_file_now(),
+		&rec);
+	as_key_destroy(&key);
+
+	if (result != AS_NEAR_CACHE_FILE_HIT) {
+		if (rec) {
+			as_record_destroy(rec);
+		}
+		return false;
+	}
+
+	char* value = as_record_get_str(rec, BIN);
+	bool ok = value && strlen(value) == len && value[0] == c && value[len - 1] == c &&
+		rec->gen == 1;
+	as_record_destroy(rec);
+	return ok;
+}
+
+static bool
+nc_pread(off_t offset, void* buf, size_t size)
+{
+	int fd = open(g_path, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	bool ok = pread(fd, buf, size, offset) == (ssize_t)size;
+	close(fd);
+	return ok;
+}
+
+static bool
+nc_pwrite(off_t offset, const void* buf, size_t size)
+{
+	int fd = open(g_path, O_WRONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	bool ok = pwrite(fd, buf, size, offset) == (ssize_t)size;
+	close(fd);
+	return ok;
+}
+
+static bool
+nc_suite_before(atf_suite* suite)
+{
+	snprintf(g_path, sizeof(g_path), "/tmp/aerospike_nc_file_%d", (int)getpid());
+	unlink(g_path);
+	return true;
+}
+
+static bool
+nc_suite_after(atf_suite* suite)
+{
+	unlink(g_path);
+	return true;
+}
+
+//---------------------------------
+// Test Cases
+//---------------------------------
+
+TEST(nc_file_reopen, "reopen populated file")
+{
+	unlink(g_path);
+
+	as_near_cache_file* file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 20; id++) {
+		nc_put(file, id, SMALL, 'a' + (char)id);
+	}
+	as_near_cache_file_close(file);
+
+	// Same layout keeps records.
+	file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 20; id++) {
+		assert_true(nc_hit(file, id, SMALL, 'a' + (char)id));
+	}
+
+	// Records added after reopen are kept with the old ones.
+	nc_put(file, 20, SMALL, 'z');
+	as_near_cache_file_close(file);
+
+	file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+	assert_true(nc_hit(file, 0, SMALL, 'a'));
+	assert_true(nc_hit(file, 20, SMALL, 'z'));
+	as_near_cache_file_close(file);
+
+	// Another entry count clears the file.
+	file = nc_open(MAX_ENTRIES * 2);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id <= 20; id++) {
+		assert_false(nc_hit(file, id, SMALL, (id == 20) ? 'z' : 'a' + (char)id));
+	}
+	as_near_cache_file_close(file);
+}
+
+TEST(nc_file_ring_wrap, "ring wraps and drops oldest records")
+{
+	unlink(g_path);
+
+	as_near_cache_file* file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	// Thirty large records wrap the ring about three times. At least the last eight fit.
+	for (int64_t id = 0; id < 30; id++) {
+		nc_put(file, id, LARGE, 'a' + (char)(id % 26));
+	}
+
+	for (int64_t id = 0; id < 20; id++) {
+		assert_false(nc_hit(file, id, LARGE, 'a' + (char)(id % 26)));
+	}
+
+	for (int64_t id = 22; id < 30; id++) {
+		assert_true(nc_hit(file, id, LARGE, 'a' + (char)(id % 26)));
+	}
+
+	// Wrapped ring offsets survive reopen.
+	as_near_cache_file_close(file);
+	file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 22; id < 30; id++) {
+		assert_true(nc_hit(file, id, LARGE, 'a' + (char)(id % 26)));
+	}
+
+	// Small records fill the space in front of the tail.
+	for (int64_t id = 100; id < 110; id++) {
+		nc_put(file, id, SMALL, 's');
+	}
+
+	for (int64_t id = 100; id < 110; id++) {
+		assert_true(nc_hit(file, id, SMALL, 's'));
+	}
+	assert_true(nc_hit(file, 29, LARGE, 'a' + 29 % 26));
+	as_near_cache_file_close(file);
+}
+
+TEST(nc_file_tail_drop, "entry limit drops oldest records and skips replaced ones")
+{
+	unlink(g_path);
+
+	as_near_cache_file* file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 100; id++) {
+		nc_put(file, id, SMALL, 'a');
+	}
+
+	for (int64_t id = 0; id < 100; id++) {
+		assert_true(nc_hit(file, id, SMALL, 'a') == (id >= 100 - MAX_ENTRIES));
+	}
+
+	// Replacing leaves a dead ring record that no slot references.
+	nc_put(file, 50, SMALL, 'b');
+	assert_true(nc_hit(file, 50, SMALL, 'b'));
+
+	// Drop 36-49, pass the dead record of 50, then drop 51-56.
+	for (int64_t id = 100; id < 120; id++) {
+		nc_put(file, id, SMALL, 'c');
+	}
+
+	for (int64_t id = 36; id < 57; id++) {
+		if (id != 50) {
+			assert_false(nc_hit(file, id, SMALL, 'a'));
+		}
+	}
+	assert_true(nc_hit(file, 50, SMALL, 'b'));
+
+	for (int64_t id = 57; id < 100; id++) {
+		assert_true(nc_hit(file, id, SMALL, 'a'));
+	}
+
+	for (int64_t id = 100; id < 120; id++) {
+		assert_true(nc_hit(file, id, SMALL, 'c'));
+	}
+	as_near_cache_file_close(file);
+}
+
+TEST(nc_file_corrupt_header, "corrupt header is cleared")
+{
+	unlink(g_path);
+
+	as_near_cache_file* file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 10; id++) {
+		nc_put(file, id, SMALL, 'a');
+	}
+	as_near_cache_file_close(file);
+
+	// Tail past head.
+	uint64_t head;
+	assert_true(nc_pread(HDR_HEAD, &head, sizeof(head)));
+
+	uint64_t tail = head + 8;
+	assert_true(nc_pwrite(HDR_TAIL, &tail, sizeof(tail)));
+
+	file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 10; id++) {
+		assert_false(nc_hit(file, id, SMALL, 'a'));
+	}
+
+	nc_put(file, 1, SMALL, 'b');
+	assert_true(nc_hit(file, 1, SMALL, 'b'));
+	as_near_cache_file_close(file);
+
+	// Bad magic.
+	uint32_t magic = 0xdeadbeef;
+	assert_true(nc_pwrite(0, &magic, sizeof(magic)));
+
+	file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+	assert_false(nc_hit(file, 1, SMALL, 'b'));
+	as_near_cache_file_close(file);
+}
+
+TEST(nc_file_corrupt_slots, "slot table with every slot used is cleared")
+{
+	unlink(g_path);
+
+	as_near_cache_file* file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 10; id++) {
+		nc_put(file, id, SMALL, 'a');
+	}
+	as_near_cache_file_close(file);
+
+	// The slot table ends where the ring starts.
+	uint64_t n_slots;
+	uint64_t data_size;
+	assert_true(nc_pread(HDR_N_SLOTS, &n_slots, sizeof(n_slots)));
+	assert_true(nc_pread(HDR_DATA_SIZE, &data_size, sizeof(data_size)));
+
+	off_t slots_off = (off_t)(FILE_SIZE - data_size - n_slots * SLOT_SIZE);
+	uint8_t used = 1;
+
+	// A lookup would never reach an unused slot.
+	for (uint64_t i = 0; i < n_slots; i++) {
+		assert_true(nc_pwrite(slots_off + (off_t)(i * SLOT_SIZE) + SLOT_USED, &used, 1));
+	}
+
+	file = nc_open(MAX_ENTRIES);
+	assert_not_null(file);
+
+	for (int64_t id = 0; id < 10; id++) {
+		assert_false(nc_hit(file, id, SMALL, 'a'));
+	}
+
+	for (int64_t id = 0; id < 100; id++) {
+		nc_put(file, id, SMALL, 'b');
+	}
+
+	for (int64_t id = 100 - MAX_ENTRIES; id < 100; id++) {
+		assert_true(nc_hit(file, id, SMALL, 'b'));
+	}
+	as_near_cache_file_close(file);
+}
+
+//---------------------------------
+// Test Suite
+//---------------------------------
+
+SUITE(near_cache_file, "Near cache file tier tests")
+{
+	suite_before(nc_suite_before);
+	suite_after(nc_suite_after);
+
+	suite_add(nc_file_reopen);
+	suite_add(nc_file_ring_wrap);
+	suite_add(nc_file_tail_drop);
+	suite_add(nc_file_corrupt_header);
+	suite_add(nc_file_corrupt_slots);
+}
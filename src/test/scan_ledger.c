@@ -0,0 +1,305 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_scan_ledger.h>
+#include <aerospike/as_sleep.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define PART_BEGIN 100
+#define PART_COUNT 256
+#define CHUNK 16
+#define LEASE_MS 60000
+#define SHORT_LEASE_MS 500
+
+//---------------------------------
+// Global Variables
+//---------------------------------
+
+static char g_path[64];
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static bool
+ledger_open(as_scan_ledger* ledger, uint32_t part_count, uint32_t lease_ms)
+{
+	as_error err;
+
+	if (as_scan_ledger_open(ledger, &err, g_path, PART_BEGIN, part_count, lease_ms) !=
+		AEROSPIKE_OK) {
+		error("open %s failed: %d %s", g_path, err.code, err.message);
+		return false;
+	}
+	return true;
+}
+
+static bool
+ledger_counts_eq(as_scan_ledger* ledger, uint32_t done, uint32_t claimed, uint32_t available)
+{
+	uint32_t d, c, a;
+	as_scan_ledger_counts(ledger, &d, &c, &a);
+
+	if (d != done || c != claimed || a != available) {
+		info("counts: done %u claimed %u available %u", d, c, a);
+		return false;
+	}
+	return true;
+}
+
+// Claim and finish every available partition. Return number of partitions finished.
+static uint32_t
+ledger_finish_all(as_scan_ledger* ledger)
+{
+	as_partition_filter pf;
+	uint32_t total = 0;
+	uint32_t n;
+
+	while ((n = as_scan_ledger_claim(ledger, CHUNK, &pf)) > 0) {
+		as_scan_ledger_complete(ledger, &pf, true);
+		total += n;
+	}
+	return total;
+}
+
+static bool
+ledger_suite_before(atf_suite* suite)
+{
+	snprintf(g_path, sizeof(g_path), "/tmp/aerospike_ledger_%d", (int)getpid());
+	unlink(g_path);
+	return true;
+}
+
+static bool
+ledger_suite_after(atf_suite* suite)
+{
+	unlink(g_path);
+	return true;
+}
+
+//---------------------------------
+// Test Cases
+//---------------------------------
+
+TEST(ledger_reopen, "reopen populated ledger")
+{
+	unlink(g_path);
+
+	as_scan_ledger ledger;
+	assert_true(ledger_open(&ledger, PART_COUNT, LEASE_MS));
+
+	as_partition_filter done_pf, free_pf, held_pf;
+	ledger.cursor = 0;
+	assert_int_eq(as_scan_ledger_claim(&ledger, CHUNK, &done_pf), CHUNK);
+	assert_int_eq(as_scan_ledger_claim(&ledger, CHUNK, &free_pf), CHUNK);
+	assert_int_eq(as_scan_ledger_claim(&ledger, CHUNK, &held_pf), CHUNK);
+	assert_int_eq(done_pf.begin, PART_BEGIN);
+
+	as_scan_ledger_complete(&ledger, &done_pf, true);
+	as_scan_ledger_complete(&ledger, &free_pf, false);
+
+	uint16_t owner = ledger.owner;
+	as_scan_ledger_close(&ledger);
+
+	// Finished partitions and unexpired claims survive reopen.
+	assert_true(ledger_open(&ledger, PART_COUNT, LEASE_MS));
+	assert_true(ledger_counts_eq(&ledger, CHUNK, CHUNK, PART_COUNT - CHUNK * 2));
+
+	// Another worker does not take the claimed run.
+	ledger.owner = owner + 1;
+	assert_int_eq(ledger_finish_all(&ledger), PART_COUNT - CHUNK * 2);
+	assert_false(as_scan_ledger_done(&ledger));
+
+	as_scan_ledger_complete(&ledger, &held_pf, true);
+	assert_true(ledger_counts_eq(&ledger, PART_COUNT - CHUNK, CHUNK, 0));
+
+	// The claiming worker finishes its run after reopening.
+	ledger.owner = owner;
+	assert_true(as_scan_ledger_renew(&ledger, &held_pf));
+	as_scan_ledger_complete(&ledger, &held_pf, true);
+	assert_true(as_scan_ledger_done(&ledger));
+	as_scan_ledger_close(&ledger);
+
+	// Another partition range is rejected.
+	as_error err;
+	assert_int_eq(as_scan_ledger_open(&ledger, &err, g_path, PART_BEGIN, PART_COUNT / 2,
+		LEASE_MS), AEROSPIKE_ERR_PARAM);
+}
+
+TEST(ledger_wrap, "claims wrap around the ledger end")
+{
+	unlink(g_path);
+
+	as_scan_ledger ledger;
+	assert_true(ledger_open(&ledger, 100, LEASE_MS));
+
+	bool claimed[100] = {false};
+	as_partition_filter pf;
+	uint32_t total = 0;
+	uint32_t n;
+
+	// The run stops at the last partition and the next claim starts at the first.
+	ledger.cursor = 95;
+	assert_int_eq(as_scan_ledger_claim(&ledger, CHUNK, &pf), 5);
+	assert_int_eq(pf.begin, PART_BEGIN + 95);
+	assert_int_eq(pf.count, 5);
+	total += 5;
+
+	for (uint32_t i = 95; i < 100; i++) {
+		claimed[i] = true;
+	}
+
+	assert_int_eq(as_scan_ledger_claim(&ledger, CHUNK, &pf), CHUNK);
+	assert_int_eq(pf.begin, PART_BEGIN);
+	total += CHUNK;
+
+	for (uint32_t i = 0; i < CHUNK; i++) {
+		claimed[i] = true;
+	}
+
+	// Remaining claims hand out every partition once.
+	while ((n = as_scan_ledger_claim(&ledger, CHUNK, &pf)) > 0) {
+		assert_true(pf.begin >= PART_BEGIN && pf.begin + pf.count <= PART_BEGIN + 100);
+		assert_int_eq(pf.count, n);
+
+		for (uint32_t i = pf.begin - PART_BEGIN; i < pf.begin - PART_BEGIN + n; i++) {
+			assert_false(claimed[i]);
+			claimed[i] = true;
+		}
+		total += n;
+	}
+	assert_int_eq(total, 100);
+	assert_true(ledger_counts_eq(&ledger, 0, 100, 0));
+	as_scan_ledger_close(&ledger);
+}
+
+TEST(ledger_steal, "expired leases are stolen")
+{
+	unlink(g_path);
+
+	as_scan_ledger a;
+	as_scan_ledger b;
+	assert_true(ledger_open(&a, PART_COUNT, SHORT_LEASE_MS));
+	assert_true(ledger_open(&b, PART_COUNT, SHORT_LEASE_MS));
+	b.owner = a.owner + 1;
+
+	as_partition_filter pf_a, pf_b;
+	a.cursor = 0;
+	assert_int_eq(as_scan_ledger_claim(&a, CHUNK, &pf_a), CHUNK);
+
+	// Unexpired claim is skipped.
+	b.cursor = 0;
+	assert_int_eq(as_scan_ledger_claim(&b, CHUNK, &pf_b), CHUNK);
+	assert_int_eq(pf_b.begin, PART_BEGIN + CHUNK);
+	as_scan_ledger_complete(&b, &pf_b, false);
+
+	as_sleep(SHORT_LEASE_MS * 2);
+
+	// Expired claim is taken over.
+	b.cursor = 0;
+	assert_int_eq(as_scan_ledger_claim(&b, CHUNK, &pf_b), CHUNK);
+	assert_int_eq(pf_b.begin, pf_a.begin);
+	assert_false(as_scan_ledger_renew(&a, &pf_a));
+
+	// The previous owner does not release stolen partitions.
+	as_scan_ledger_complete(&a, &pf_a, true);
+	assert_true(ledger_counts_eq(&b, 0, CHUNK, PART_COUNT - CHUNK));
+
+	as_scan_ledger_complete(&b, &pf_b, true);
+	assert_true(ledger_counts_eq(&b, CHUNK, 0, PART_COUNT - CHUNK));
+	as_scan_ledger_close(&b);
+	as_scan_ledger_close(&a);
+}
+
+TEST(ledger_corrupt_slots, "invalid slots are freed")
+{
+	unlink(g_path);
+
+	as_scan_ledger ledger;
+	assert_true(ledger_open(&ledger, PART_COUNT, LEASE_MS));
+
+	// Unknown slot state.
+	for (uint32_t i = 0; i < 10; i++) {
+		ledger.shm->slots[i] = UINT64_MAX;
+	}
+
+	// Running workers claim corrupt slots instead of waiting for them forever.
+	assert_true(ledger_counts_eq(&ledger, 0, 0, PART_COUNT));
+
+	// Claim that expires after a lease of the next open.
+	as_partition_filter pf;
+	ledger.cursor = 100;
+	assert_int_eq(as_scan_ledger_claim(&ledger, CHUNK, &pf), CHUNK);
+	as_scan_ledger_close(&ledger);
+
+	assert_true(ledger_open(&ledger, PART_COUNT, SHORT_LEASE_MS));
+	assert_true(ledger_counts_eq(&ledger, 0, 0, PART_COUNT));
+
+	for (uint32_t i = 0; i < 10; i++) {
+		assert_int_eq(ledger.shm->slots[i], 0);
+	}
+
+	// Unknown states set while running are claimed too.
+	ledger.shm->slots[200] = UINT64_MAX;
+	assert_int_eq(ledger_finish_all(&ledger), PART_COUNT);
+	assert_true(as_scan_ledger_done(&ledger));
+	as_scan_ledger_close(&ledger);
+}
+
+TEST(ledger_corrupt_header, "corrupt header is cleared")
+{
+	unlink(g_path);
+
+	as_scan_ledger ledger;
+	assert_true(ledger_open(&ledger, PART_COUNT, LEASE_MS));
+	assert_int_eq(ledger_finish_all(&ledger), PART_COUNT);
+	assert_true(as_scan_ledger_done(&ledger));
+
+	ledger.shm->magic = 0xdeadbeef;
+	as_scan_ledger_close(&ledger);
+
+	// All partitions are scanned again.
+	assert_true(ledger_open(&ledger, PART_COUNT, LEASE_MS));
+	assert_false(as_scan_ledger_done(&ledger));
+	assert_true(ledger_counts_eq(&ledger, 0, 0, PART_COUNT));
+	assert_int_eq(ledger.shm->part_begin, PART_BEGIN);
+	assert_int_eq(ledger.shm->part_count, PART_COUNT);
+	assert_int_eq(ledger_finish_all(&ledger), PART_COUNT);
+	as_scan_ledger_close(&ledger);
+}
+
+//---------------------------------
+// Test Suite
+//---------------------------------
+
+SUITE(scan_ledger, "Scan partition ledger tests")
+{
+	suite_before(ledger_suite_before);
+	suite_after(ledger_suite_after);
+
+	suite_add(ledger_reopen);
+	suite_add(ledger_wrap);
+	suite_add(ledger_steal);
+	suite_add(ledger_corrupt_slots);
+	suite_add(ledger_corrupt_header);
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/as_txn.h>
+#include <string.h>
+#include "test.h"
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define SET "txn"
+
+// as_txn_create_capacity(16, 16) creates 32 slot tables.
+#define N_SLOTS 32
+#define MAX_IDS 256
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+// Build digest whose home slot (low bits of the first four bytes) is home. The id is stored
+// in following bytes to keep digests unique.
+static void
+txn_hash_digest(uint8_t* d, uint32_t home, uint32_t id)
+{
+	memset(d, 0, AS_DIGEST_VALUE_SIZE);
+	memcpy(d, &home, sizeof(home));
+	memcpy(d + 4, &id, sizeof(id));
+}
+
+static void
+txn_hash_put(as_txn* txn, uint32_t home, uint32_t id)
+{
+	uint8_t d[AS_DIGEST_VALUE_SIZE];
+	txn_hash_digest(d, home, id);
+	as_txn_on_read(txn, d, SET, id + 1);
+}
+
+static void
+txn_hash_remove(as_txn* txn, uint32_t home, uint32_t id)
+{
+	// A successful write without version moves the key from reads to writes.
+	uint8_t d[AS_DIGEST_VALUE_SIZE];
+	txn_hash_digest(d, home, id);
+	as_txn_on_write(txn, d, SET, 0, AEROSPIKE_OK);
+}
+
+/**
+ * Verify reads contain exactly the present ids with their versions. Return first id that
+ * does not match, n when the element count is wrong or -1 when all match.
+ */
+static int
+txn_hash_verify(as_txn* txn, const uint32_t* homes, const bool* present, uint32_t n)
+{
+	uint32_t count = 0;
+
+	for (uint32_t id = 0; id < n; id++) {
+		uint8_t d[AS_DIGEST_VALUE_SIZE];
+		txn_hash_digest(d, homes[id], id);
+
+		uint64_t expect = present[id] ? id + 1 : 0;
+
+		if (as_txn_get_read_version(txn, d) != expect) {
+			return (int)id;
+		}
+
+		if (present[id]) {
+			count++;
+		}
+	}
+	return (txn->reads.n_eles == count)? -1 : (int)n;
+}
+
+//---------------------------------
+// Test Cases
+//---------------------------------
+
+TEST(txn_hash_cluster_remove, "remove keys inside a colliding cluster")
+{
+	uint32_t homes[10];
+	bool present[10];
+
+	as_txn* txn = as_txn_create_capacity(16, 16);
+	assert_int_eq(txn->reads.n_slots, N_SLOTS);
+
+	// Six keys share home slot 5 and fill slots 5-10. Keys homed at 7 and 8 are pushed
+	// behind them, so they must shift back when earlier cluster members are removed.
+	for (uint32_t id = 0; id < 10; id++) {
+		homes[id] = (id < 6)? 5 : (id < 8)? 7 : 8;
+		present[id] = true;
+		txn_hash_put(txn, homes[id], id);
+	}
+	assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+
+	// Middle of the shared home run.
+	txn_hash_remove(txn, homes[2], 2);
+	present[2] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+
+	// Head of the cluster.
+	txn_hash_remove(txn, homes[0], 0);
+	present[0] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+
+	// Key displaced from its own home slot.
+	txn_hash_remove(txn, homes[6], 6);
+	present[6] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+
+	// Tail of the cluster.
+	txn_hash_remove(txn, homes[9], 9);
+	present[9] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+
+	// Removing a missing key must not disturb the cluster.
+	txn_hash_remove(txn, homes[2], 2);
+	assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+
+	// Reinsert in a different order.
+	uint32_t order[] = {9, 0, 6, 2};
+
+	for (uint32_t i = 0; i < 4; i++) {
+		txn_hash_put(txn, homes[order[i]], order[i]);
+		present[order[i]] = true;
+		assert_int_eq(txn_hash_verify(txn, homes, present, 10), -1);
+	}
+	as_txn_destroy(txn);
+}
+
+TEST(txn_hash_wraparound, "colliding cluster that wraps around the table end")
+{
+	uint32_t homes[9];
+	bool present[9];
+
+	as_txn* txn = as_txn_create_capacity(16, 16);
+	assert_int_eq(txn->reads.n_slots, N_SLOTS);
+
+	// Five keys homed at slot 30 occupy 30, 31, 0, 1 and 2. Keys homed at 31, 0 and 1
+	// follow them and a key homed at 3 is displaced too.
+	for (uint32_t id = 0; id < 9; id++) {
+		homes[id] = (id < 5)? 30 : (id < 6)? 31 : (id < 7)? 0 : (id < 8)? 1 : 3;
+		present[id] = true;
+		txn_hash_put(txn, homes[id], id);
+	}
+	assert_int_eq(txn_hash_verify(txn, homes, present, 9), -1);
+
+	// Remove the key in slot 31. Keys past the table end must shift back across it.
+	txn_hash_remove(txn, homes[1], 1);
+	present[1] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 9), -1);
+
+	// Remove the key homed at 0, which sits after the wrap.
+	txn_hash_remove(txn, homes[6], 6);
+	present[6] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 9), -1);
+
+	// Remove the head of the cluster in slot 30.
+	txn_hash_remove(txn, homes[0], 0);
+	present[0] = false;
+	assert_int_eq(txn_hash_verify(txn, homes, present, 9), -1);
+
+	// Remove the remaining keys homed at 30 one by one.
+	for (uint32_t id = 2; id < 5; id++) {
+		txn_hash_remove(txn, homes[id], id);
+		present[id] = false;
+		assert_int_eq(txn_hash_verify(txn, homes, present, 9), -1);
+	}
+
+	for (uint32_t id = 0; id < 7; id++) {
+		txn_hash_put(txn, homes[id], id);
+		present[id] = true;
+		assert_int_eq(txn_hash_verify(txn, homes, present, 9), -1);
+	}
+	as_txn_destroy(txn);
+}
+
+TEST(txn_hash_churn, "lookups after many removes and reinserts")
+{
+	uint32_t homes[MAX_IDS];
+	bool present[MAX_IDS];
+	uint32_t seed = 7;
+
+	as_txn* txn = as_txn_create_capacity(16, 16);
+
+	// Few distinct low bits keep clusters long at every table size, including after growth.
+	for (uint32_t id = 0; id < MAX_IDS; id++) {
+		homes[id] = (id % 5) * 6 + ((id % 3) << 8);
+		present[id] = false;
+	}
+
+	uint32_t limit = 24;
+
+	for (uint32_t round = 0; round < 20000; round++) {
+		// Stay below the first resize at the start, then let the table grow.
+		if (round == 10000) {
+			limit = MAX_IDS;
+		}
+
+		seed = seed * 1103515245 + 12345;
+		uint32_t id = (seed >> 8) % limit;
+
+		if (present[id]) {
+			txn_hash_remove(txn, homes[id], id);
+			present[id] = false;
+		}
+		else {
+			txn_hash_put(txn, homes[id], id);
+			present[id] = true;
+		}
+
+		if (round % 16 == 0 || round < 2000) {
+			assert_int_eq(txn_hash_verify(txn, homes, present, MAX_IDS), -1);
+		}
+	}
+	assert_int_eq(txn_hash_verify(txn, homes, present, MAX_IDS), -1);
+
+	// Remove everything and confirm the table is empty.
+	for (uint32_t id = 0; id < MAX_IDS; id++) {
+		if (present[id]) {
+			txn_hash_remove(txn, homes[id], id);
+			present[id] = false;
+		}
+	}
+	assert_int_eq(txn_hash_verify(txn, homes, present, MAX_IDS), -1);
+	assert_int_eq(txn->reads.n_eles, 0);
+	as_txn_destroy(txn);
+}
+
+//---------------------------------
+// Test Suite
+//---------------------------------
+
+SUITE(transaction_hash, "Transaction key hash map tests")
+{
+	suite_add(txn_hash_cluster_remove);
+	suite_add(txn_hash_wraparound);
+	suite_add(txn_hash_churn);
+}
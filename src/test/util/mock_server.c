@@ -0,0 +1,940 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include "mock_server.h"
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_command.h>
+#include <aerospike/as_proto.h>
+#include <citrusleaf/alloc.h>
+#include <citrusleaf/cf_b64.h>
+#include <citrusleaf/cf_byte_order.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*****************************************************************************
+ * MACROS
+ *****************************************************************************/
+
+#define MOCK_PARTITIONS 4096
+#define MOCK_PROTO_SIZE 8
+#define MOCK_MSG_SIZE 22
+#define MOCK_NS_SIZE 32
+
+/*****************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct mock_node_s mock_node;
+
+typedef struct mock_conn_s {
+	struct mock_conn_s* next;
+	mock_node* node;
+	pthread_t thread;
+	int fd;
+} mock_conn;
+
+struct mock_node_s {
+	mock_server* server;
+	char name[20];
+	char* replicas;
+	char* peers;
+	mock_fault fault;
+	pthread_t thread;
+	int listen_fd;
+	uint16_t port;
+	bool started;
+	volatile bool down;
+};
+
+struct mock_server_s {
+	mock_server_config config;
+	char* namespaces; // n_namespaces names of MOCK_NS_SIZE bytes.
+	mock_node* nodes;
+	uint32_t* owners; // Owner node index of each partition.
+	uint32_t churn_cursor;
+	uint32_t peers_rotation;
+	uint32_t partition_gen;
+	uint32_t peers_gen;
+	uint8_t* bins;
+	uint32_t bins_size;
+	pthread_mutex_t lock;
+	mock_conn* conns;
+	uint64_t commands;
+	uint64_t received;
+	uint64_t bytes_in;
+	uint64_t delays;
+	uint64_t resets;
+	uint64_t partials;
+	volatile bool running;
+};
+
+typedef struct {
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+} mock_buf;
+
+typedef enum {
+	MOCK_FAULT_NONE,
+	MOCK_FAULT_DELAY,
+	MOCK_FAULT_RESET,
+	MOCK_FAULT_PARTIAL
+} mock_fault_type;
+
+/*****************************************************************************
+ * STATIC FUNCTIONS
+ *****************************************************************************/
+
+static uint8_t*
+mock_buf_reserve(mock_buf* b, size_t len)
+{
+	if (b->size + len > b->capacity) {
+		size_t capacity = b->capacity ? b->capacity * 2 : 4096;
+
+		while (capacity < b->size + len) {
+			capacity *= 2;
+		}
+		b->data = cf_realloc(b->data, capacity);
+		b->capacity = capacity;
+	}
+
+	uint8_t* p = b->data + b->size;
+	b->size += len;
+	return p;
+}
+
+static void
+mock_buf_append(mock_buf* b, const char* s)
+{
+	size_t len = strlen(s);
+	memcpy(mock_buf_reserve(b, len), s, len);
+}
+
+static bool
+mock_read(int fd, uint8_t* buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t rv = recv(fd, buf, len, 0);
+
+		if (rv <= 0) {
+			return false;
+		}
+		buf += rv;
+		len -= (size_t)rv;
+	}
+	return true;
+}
+
+static bool
+mock_write(int fd, const uint8_t* buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t rv = send(fd, buf, len, MSG_NOSIGNAL);
+
+		if (rv <= 0) {
+			return false;
+		}
+		buf += rv;
+		len -= (size_t)rv;
+	}
+	return true;
+}
+
+static void
+mock_reset(int fd)
+{
+	// Zero linger makes close() send a reset instead of a normal shutdown.
+	struct linger lin;
+	lin.l_onoff = 1;
+	lin.l_linger = 0;
+	setsockopt(fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+}
+
+static mock_fault_type
+mock_draw_fault(mock_node* node, uint32_t* seed, uint32_t* delay_us)
+{
+	mock_fault* f = &node->fault;
+	uint32_t reset_pct = as_load_uint32(&f->reset_pct);
+	uint32_t partial_pct = as_load_uint32(&f->partial_pct);
+	uint32_t delay_pct = as_load_uint32(&f->delay_pct);
+
+	if (reset_pct == 0 && partial_pct == 0 && delay_pct == 0) {
+		return MOCK_FAULT_NONE;
+	}
+
+	uint32_t r = (uint32_t)rand_r(seed) % 100;
+
+	if (r < reset_pct) {
+		return MOCK_FAULT_RESET;
+	}
+	r -= reset_pct;
+
+	if (r < partial_pct) {
+		return MOCK_FAULT_PARTIAL;
+	}
+	r -= partial_pct;
+
+	if (r < delay_pct) {
+		*delay_us = as_load_uint32(&f->delay_us);
+		return MOCK_FAULT_DELAY;
+	}
+	return MOCK_FAULT_NONE;
+}
+
+static void
+mock_write_proto(uint8_t* p, uint8_t type, size_t size)
+{
+	uint64_t proto = ((uint64_t)AS_PROTO_VERSION << 56) | ((uint64_t)type << 48) | size;
+	*(uint64_t*)p = cf_swap_to_be64(proto);
+}
+
+static void
+mock_write_msg(mock_buf* out, uint8_t info3, uint32_t trid, uint16_t n_ops)
+{
+	uint8_t* p = mock_buf_reserve(out, MOCK_MSG_SIZE);
+	*p++ = MOCK_MSG_SIZE;
+	*p++ = 0;
+	*p++ = 0;
+	*p++ = info3;
+	*p++ = 0;
+	*p++ = AEROSPIKE_OK;
+	*(uint32_t*)p = cf_swap_to_be32(1); // generation
+	p += 4;
+	*(uint32_t*)p = 0; // record void time
+	p += 4;
+	*(uint32_t*)p = cf_swap_to_be32(trid);
+	p += 4;
+	*(uint16_t*)p = 0; // n_fields
+	p += 2;
+	*(uint16_t*)p = cf_swap_to_be16(n_ops);
+}
+
+static void
+mock_write_bins(mock_server* s, mock_buf* out, uint32_t trid, uint8_t info3)
+{
+	mock_write_msg(out, info3, trid, (uint16_t)s->config.bins);
+	memcpy(mock_buf_reserve(out, s->bins_size), s->bins, s->bins_size);
+}
+
+static void
+mock_info_value(mock_node* node, const char* name, mock_buf* out)
+{
+	mock_server* s = node->server;
+	char tmp[64];
+
+	if (strcmp(name, "node") == 0) {
+		mock_buf_append(out, node->name);
+	}
+	else if (strcmp(name, "partition-generation") == 0 ||
+			 strcmp(name, "rebalance-generation") == 0) {
+		snprintf(tmp, sizeof(tmp), "%u", s->partition_gen);
+		mock_buf_append(out, tmp);
+	}
+	else if (strcmp(name, "peers-generation") == 0) {
+		snprintf(tmp, sizeof(tmp), "%u", s->peers_gen);
+		mock_buf_append(out, tmp);
+	}
+	else if (strcmp(name, "build") == 0) {
+		mock_buf_append(out, "8.0.0.0");
+	}
+	else if (strcmp(name, "features") == 0) {
+		mock_buf_append(out, "pscans;query-show;batch-any;pquery");
+	}
+	else if (strcmp(name, "cluster-name") == 0) {
+		mock_buf_append(out, "mock");
+	}
+	else if (strcmp(name, "replicas") == 0) {
+		mock_buf_append(out, node->replicas);
+	}
+	else if (strcmp(name, "partitions") == 0) {
+		snprintf(tmp, sizeof(tmp), "%u", MOCK_PARTITIONS);
+		mock_buf_append(out, tmp);
+	}
+	else if (strcmp(name, "rack-ids") == 0) {
+		for (uint32_t i = 0; i < s->config.n_namespaces; i++) {
+			mock_buf_append(out, &s->namespaces[i * MOCK_NS_SIZE]);
+			mock_buf_append(out, ":0;");
+		}
+	}
+	else if (strncmp(name, "peers-", 6) == 0) {
+		mock_buf_append(out, node->peers);
+	}
+	else if (strncmp(name, "service-", 8) == 0) {
+		snprintf(tmp, sizeof(tmp), "127.0.0.1:%u", node->port);
+		mock_buf_append(out, tmp);
+	}
+	// Unknown names are answered with an empty value.
+}
+
+static void
+mock_handle_info(mock_node* node, char* names, mock_buf* out)
+{
+	mock_server* s = node->server;
+	char* name = names;
+
+	// Replicas, peers and generations are replaced while churning.
+	pthread_mutex_lock(&s->lock);
+
+	while (*name) {
+		char* end = strchr(name, '\n');
+
+		if (end) {
+			*end = 0;
+		}
+
+		if (*name) {
+			mock_buf_append(out, name);
+			mock_buf_append(out, "\t");
+			mock_info_value(node, name, out);
+			mock_buf_append(out, "\n");
+		}
+
+		if (! end) {
+			break;
+		}
+		name = end + 1;
+	}
+	pthread_mutex_unlock(&s->lock);
+}
+
+static bool
+mock_handle_msg(mock_node* node, uint8_t* body, size_t size, mock_buf* out)
+{
+	mock_server* s = node->server;
+
+	if (size < MOCK_MSG_SIZE) {
+		return false;
+	}
+
+	uint8_t info1 = body[1];
+	uint16_t n_fields = cf_swap_from_be16(*(uint16_t*)(body + 18));
+	uint8_t* p = body + MOCK_MSG_SIZE;
+	uint8_t* end = body + size;
+	uint32_t n_keys = 0;
+	bool batch = false;
+	bool query = false;
+
+	for (uint16_t i = 0; i < n_fields; i++) {
+		if (p + 5 > end) {
+			return false;
+		}
+
+		uint32_t field_size = cf_swap_from_be32(*(uint32_t*)p);
+		uint8_t type = p[4];
+
+		if (type == AS_FIELD_BATCH_INDEX) {
+			if (p + 9 > end) {
+				return false;
+			}
+			n_keys = cf_swap_from_be32(*(uint32_t*)(p + 5));
+			batch = true;
+		}
+		else if (type == AS_FIELD_TASK_ID) {
+			query = true;
+		}
+		p += 4 + field_size;
+	}
+
+	if (s->config.delay_us) {
+		usleep(s->config.delay_us);
+	}
+	as_incr_uint64(&s->commands);
+
+	if (batch) {
+		// Batch records are always answered with bins. Clients ignore bins they did not ask for.
+		for (uint32_t i = 0; i < n_keys; i++) {
+			mock_write_bins(s, out, i, 0);
+		}
+		mock_write_msg(out, AS_MSG_INFO3_LAST, 0, 0);
+	}
+	else if (query) {
+		mock_write_msg(out, AS_MSG_INFO3_LAST, 0, 0);
+	}
+	else if ((info1 & AS_MSG_INFO1_READ) && !(info1 & AS_MSG_INFO1_GET_NOBINDATA)) {
+		mock_write_bins(s, out, 0, 0);
+	}
+	else {
+		mock_write_msg(out, 0, 0, 0);
+	}
+	return true;
+}
+
+static void*
+mock_conn_run(void* udata)
+{
+	mock_conn* conn = udata;
+	mock_node* node = conn->node;
+	mock_server* s = node->server;
+	int fd = conn->fd;
+	uint8_t* buf = NULL;
+	size_t capacity = 0;
+	mock_buf out = {0};
+	uint32_t seed = (uint32_t)(uintptr_t)conn;
+
+	while (s->running) {
+		uint8_t header[MOCK_PROTO_SIZE];
+
+		if (! mock_read(fd, header, sizeof(header))) {
+			break;
+		}
+
+		uint64_t proto = cf_swap_from_be64(*(uint64_t*)header);
+		uint8_t version = (uint8_t)(proto >> 56);
+		uint8_t type = (uint8_t)(proto >> 48);
+		size_t size = (size_t)(proto & 0xFFFFFFFFFFFFULL);
+
+		if (version != AS_PROTO_VERSION || size > PROTO_SIZE_MAX) {
+			break;
+		}
+
+		if (size + 1 > capacity) {
+			capacity = size + 1;
+			buf = cf_realloc(buf, capacity);
+		}
+
+		if (! mock_read(fd, buf, size)) {
+			break;
+		}
+		buf[size] = 0;
+
+		// Reserve proto header and fill in size after the body is known.
+		out.size = 0;
+		mock_buf_reserve(&out, MOCK_PROTO_SIZE);
+
+		mock_fault_type fault = MOCK_FAULT_NONE;
+
+		if (type == AS_INFO_MESSAGE_TYPE) {
+			mock_handle_info(node, (char*)buf, &out);
+		}
+		else if (type == AS_MESSAGE_TYPE) {
+			as_incr_uint64(&s->received);
+			as_faa_uint64(&s->bytes_in, MOCK_PROTO_SIZE + size);
+
+			uint32_t delay_us = 0;
+			fault = mock_draw_fault(node, &seed, &delay_us);
+
+			if (fault == MOCK_FAULT_RESET) {
+				as_incr_uint64(&s->resets);
+				mock_reset(fd);
+				break;
+			}
+
+			if (fault == MOCK_FAULT_DELAY) {
+				as_incr_uint64(&s->delays);
+				usleep(delay_us);
+			}
+
+			if (! mock_handle_msg(node, buf, size, &out)) {
+				break;
+			}
+		}
+		else {
+			// Login and compressed commands are not supported.
+			break;
+		}
+
+		mock_write_proto(out.data, type, out.size - MOCK_PROTO_SIZE);
+
+		if (fault == MOCK_FAULT_PARTIAL) {
+			as_incr_uint64(&s->partials);
+			mock_write(fd, out.data, out.size / 2);
+			mock_reset(fd);
+			break;
+		}
+
+		if (! mock_write(fd, out.data, out.size)) {
+			break;
+		}
+	}
+
+	if (node->down) {
+		mock_reset(fd);
+	}
+
+	pthread_mutex_lock(&s->lock);
+	close(fd);
+	conn->fd = -1;
+	pthread_mutex_unlock(&s->lock);
+
+	cf_free(buf);
+	cf_free(out.data);
+	return NULL;
+}
+
+static void*
+mock_node_run(void* udata)
+{
+	mock_node* node = udata;
+	mock_server* s = node->server;
+
+	while (s->running) {
+		int fd = accept(node->listen_fd, NULL, NULL);
+
+		if (fd < 0) {
+			if (! s->running) {
+				break;
+			}
+			continue;
+		}
+
+		if (node->down) {
+			mock_reset(fd);
+			close(fd);
+			continue;
+		}
+
+		int flag = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+		mock_conn* conn = cf_malloc(sizeof(mock_conn));
+		conn->node = node;
+		conn->fd = fd;
+
+		pthread_mutex_lock(&s->lock);
+
+		if (! s->running || pthread_create(&conn->thread, NULL, mock_conn_run, conn) != 0) {
+			pthread_mutex_unlock(&s->lock);
+			close(fd);
+			cf_free(conn);
+			continue;
+		}
+		conn->next = s->conns;
+		s->conns = conn;
+		pthread_mutex_unlock(&s->lock);
+	}
+	return NULL;
+}
+
+static bool
+mock_node_listen(mock_node* node)
+{
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	int flag = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+
+	socklen_t len = sizeof(addr);
+
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 1024) != 0 ||
+		getsockname(fd, (struct sockaddr*)&addr, &len) != 0) {
+		close(fd);
+		return false;
+	}
+	node->listen_fd = fd;
+	node->port = ntohs(addr.sin_port);
+	return true;
+}
+
+static char*
+mock_build_replicas(mock_server* s, uint32_t index)
+{
+	uint8_t bitmap[MOCK_PARTITIONS / 8];
+	char b64[cf_b64_encoded_len(MOCK_PARTITIONS / 8) + 1];
+
+	memset(bitmap, 0, sizeof(bitmap));
+
+	for (uint32_t i = 0; i < MOCK_PARTITIONS; i++) {
+		if (s->owners[i] == index) {
+			bitmap[i >> 3] |= (uint8_t)(0x80 >> (i & 7));
+		}
+	}
+	cf_b64_encode(bitmap, sizeof(bitmap), b64);
+	b64[cf_b64_encoded_len(sizeof(bitmap))] = 0;
+
+	mock_buf b = {0};
+
+	for (uint32_t i = 0; i < s->config.n_namespaces; i++) {
+		mock_buf_append(&b, &s->namespaces[i * MOCK_NS_SIZE]);
+		mock_buf_append(&b, ":0,1,");
+		mock_buf_append(&b, b64);
+		mock_buf_append(&b, ";");
+	}
+	*mock_buf_reserve(&b, 1) = 0;
+	return (char*)b.data;
+}
+
+static char*
+mock_build_peers(mock_server* s, uint32_t index)
+{
+	mock_buf b = {0};
+	mock_buf_append(&b, "1,,[");
+
+	uint32_t n_nodes = s->config.n_nodes;
+	bool first = true;
+
+	for (uint32_t j = 0; j < n_nodes; j++) {
+		uint32_t i = (j + s->peers_rotation) % n_nodes;
+
+		if (i == index || s->nodes[i].down) {
+			continue;
+		}
+
+		mock_node* node = &s->nodes[i];
+		char peer[64];
+		snprintf(peer, sizeof(peer), "%s[%s,,[127.0.0.1:%u]]", first ? "" : ",", node->name,
+			node->port);
+		mock_buf_append(&b, peer);
+		first = false;
+	}
+	mock_buf_append(&b, "]");
+	*mock_buf_reserve(&b, 1) = 0;
+	return (char*)b.data;
+}
+
+static void
+mock_build_bins(mock_server* s)
+{
+	uint32_t n = s->config.bins;
+	uint32_t value_size = s->config.bin_size;
+	uint32_t size = 0;
+	char name[16];
+
+	for (uint32_t i = 0; i < n; i++) {
+		snprintf(name, sizeof(name), "b%u", i);
+		size += 8 + (uint32_t)strlen(name) + value_size;
+	}
+
+	uint8_t* p = cf_malloc(size ? size : 1);
+	s->bins = p;
+	s->bins_size = size;
+
+	for (uint32_t i = 0; i < n; i++) {
+		snprintf(name, sizeof(name), "b%u", i);
+		uint8_t name_len = (uint8_t)strlen(name);
+
+		*(uint32_t*)p = cf_swap_to_be32(4 + name_len + value_size);
+		p += 4;
+		*p++ = 1; // read
+		*p++ = AS_BYTES_BLOB;
+		*p++ = 0;
+		*p++ = name_len;
+		memcpy(p, name, name_len);
+		p += name_len;
+
+		for (uint32_t j = 0; j < value_size; j++) {
+			*p++ = (uint8_t)(i + j);
+		}
+	}
+}
+
+/*****************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+void
+mock_server_config_init(mock_server_config* config)
+{
+	config->ns = "test";
+	config->n_namespaces = 1;
+	config->n_nodes = 1;
+	config->bins = 1;
+	config->bin_size = 100;
+	config->delay_us = 0;
+}
+
+mock_server*
+mock_server_start(const mock_server_config* config)
+{
+	// Leave room for the namespace index suffix.
+	if (config->n_nodes == 0 || config->n_namespaces == 0 || config->n_namespaces > 1000 ||
+		strlen(config->ns) >= MOCK_NS_SIZE - 3) {
+		return NULL;
+	}
+
+	mock_server* s = cf_calloc(1, sizeof(mock_server));
+	s->config = *config;
+	s->namespaces = cf_malloc((size_t)config->n_namespaces * MOCK_NS_SIZE);
+
+	for (uint32_t i = 0; i < config->n_namespaces; i++) {
+		char* ns = &s->namespaces[i * MOCK_NS_SIZE];
+
+		if (i == 0) {
+			strcpy(ns, config->ns);
+		}
+		else {
+			snprintf(ns, MOCK_NS_SIZE, "%s%u", config->ns, i);
+		}
+	}
+
+	s->owners = cf_malloc(sizeof(uint32_t) * MOCK_PARTITIONS);
+
+	for (uint32_t i = 0; i < MOCK_PARTITIONS; i++) {
+		s->owners[i] = i % config->n_nodes;
+	}
+	s->partition_gen = 1;
+	s->peers_gen = 1;
+	pthread_mutex_init(&s->lock, NULL);
+	mock_build_bins(s);
+
+	s->nodes = cf_calloc(config->n_nodes, sizeof(mock_node));
+	s->running = true;
+
+	for (uint32_t i = 0; i < config->n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+		node->server = s;
+		node->listen_fd = -1;
+		snprintf(node->name, sizeof(node->name), "BB9%013X", i + 1);
+
+		if (! mock_node_listen(node)) {
+			mock_server_stop(s);
+			return NULL;
+		}
+	}
+
+	// Peers are known after all nodes are listening.
+	for (uint32_t i = 0; i < config->n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+		node->replicas = mock_build_replicas(s, i);
+		node->peers = mock_build_peers(s, i);
+	}
+
+	for (uint32_t i = 0; i < config->n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+
+		if (pthread_create(&node->thread, NULL, mock_node_run, node) != 0) {
+			mock_server_stop(s);
+			return NULL;
+		}
+		node->started = true;
+	}
+	return s;
+}
+
+uint16_t
+mock_server_port(mock_server* server, uint32_t index)
+{
+	return index < server->config.n_nodes ? server->nodes[index].port : 0;
+}
+
+const char*
+mock_server_node_name(mock_server* server, uint32_t index)
+{
+	return index < server->config.n_nodes ? server->nodes[index].name : NULL;
+}
+
+const char*
+mock_server_namespace(mock_server* server, uint32_t index)
+{
+	return index < server->config.n_namespaces ?
+		&server->namespaces[index * MOCK_NS_SIZE] : NULL;
+}
+
+uint32_t
+mock_server_churn_partitions(mock_server* s, uint32_t count)
+{
+	uint32_t n_nodes = s->config.n_nodes;
+
+	if (count > MOCK_PARTITIONS) {
+		count = MOCK_PARTITIONS;
+	}
+
+	pthread_mutex_lock(&s->lock);
+
+	uint32_t first = s->churn_cursor;
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t pid = (first + i) % MOCK_PARTITIONS;
+		s->owners[pid] = (s->owners[pid] + 1) % n_nodes;
+	}
+	s->churn_cursor = (first + count) % MOCK_PARTITIONS;
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+		cf_free(node->replicas);
+		node->replicas = mock_build_replicas(s, i);
+	}
+	s->partition_gen++;
+	pthread_mutex_unlock(&s->lock);
+	return first;
+}
+
+uint32_t
+mock_server_partition_owner(mock_server* s, uint32_t partition_id)
+{
+	pthread_mutex_lock(&s->lock);
+	uint32_t owner = s->owners[partition_id % MOCK_PARTITIONS];
+	pthread_mutex_unlock(&s->lock);
+	return owner;
+}
+
+void
+mock_server_churn_peers(mock_server* s)
+{
+	uint32_t n_nodes = s->config.n_nodes;
+
+	pthread_mutex_lock(&s->lock);
+	s->peers_rotation = (s->peers_rotation + 1) % n_nodes;
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+		cf_free(node->peers);
+		node->peers = mock_build_peers(s, i);
+	}
+	s->peers_gen++;
+	pthread_mutex_unlock(&s->lock);
+}
+
+void
+mock_server_set_fault(mock_server* s, uint32_t index, const mock_fault* fault)
+{
+	if (index >= s->config.n_nodes) {
+		return;
+	}
+
+	mock_fault* f = &s->nodes[index].fault;
+	as_store_uint32(&f->delay_pct, fault ? fault->delay_pct : 0);
+	as_store_uint32(&f->delay_us, fault ? fault->delay_us : 0);
+	as_store_uint32(&f->reset_pct, fault ? fault->reset_pct : 0);
+	as_store_uint32(&f->partial_pct, fault ? fault->partial_pct : 0);
+}
+
+void
+mock_server_kill_node(mock_server* s, uint32_t index)
+{
+	uint32_t n_nodes = s->config.n_nodes;
+
+	if (index >= n_nodes) {
+		return;
+	}
+
+	pthread_mutex_lock(&s->lock);
+
+	mock_node* down = &s->nodes[index];
+
+	if (down->down) {
+		pthread_mutex_unlock(&s->lock);
+		return;
+	}
+	down->down = true;
+
+	// Move partitions of the down node to the next live node.
+	uint32_t next = index;
+
+	for (uint32_t i = 1; i < n_nodes; i++) {
+		uint32_t candidate = (index + i) % n_nodes;
+
+		if (! s->nodes[candidate].down) {
+			next = candidate;
+			break;
+		}
+	}
+
+	for (uint32_t i = 0; i < MOCK_PARTITIONS; i++) {
+		if (s->owners[i] == index) {
+			s->owners[i] = next;
+		}
+	}
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+		cf_free(node->replicas);
+		cf_free(node->peers);
+		node->replicas = mock_build_replicas(s, i);
+		node->peers = mock_build_peers(s, i);
+	}
+	s->partition_gen++;
+	s->peers_gen++;
+
+	for (mock_conn* conn = s->conns; conn; conn = conn->next) {
+		if (conn->node == down && conn->fd >= 0) {
+			shutdown(conn->fd, SHUT_RDWR);
+		}
+	}
+	pthread_mutex_unlock(&s->lock);
+}
+
+void
+mock_server_get_stats(mock_server* s, mock_server_stats* stats)
+{
+	stats->commands = as_load_uint64(&s->received);
+	stats->bytes_in = as_load_uint64(&s->bytes_in);
+	stats->delays = as_load_uint64(&s->delays);
+	stats->resets = as_load_uint64(&s->resets);
+	stats->partials = as_load_uint64(&s->partials);
+}
+
+uint64_t
+mock_server_commands(mock_server* server)
+{
+	return as_load_uint64(&server->commands);
+}
+
+void
+mock_server_stop(mock_server* s)
+{
+	s->running = false;
+
+	for (uint32_t i = 0; i < s->config.n_nodes; i++) {
+		mock_node* node = &s->nodes[i];
+
+		if (node->listen_fd >= 0) {
+			// Wake accept().
+			shutdown(node->listen_fd, SHUT_RDWR);
+
+			if (node->started) {
+				pthread_join(node->thread, NULL);
+			}
+			close(node->listen_fd);
+		}
+	}
+
+	pthread_mutex_lock(&s->lock);
+
+	for (mock_conn* conn = s->conns; conn; conn = conn->next) {
+		if (conn->fd >= 0) {
+			shutdown(conn->fd, SHUT_RDWR);
+		}
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	mock_conn* conn = s->conns;
+
+	while (conn) {
+		mock_conn* next = conn->next;
+		pthread_join(conn->thread, NULL);
+		cf_free(conn);
+		conn = next;
+	}
+
+	for (uint32_t i = 0; i < s->config.n_nodes; i++) {
+		cf_free(s->nodes[i].replicas);
+		cf_free(s->nodes[i].peers);
+	}
+	pthread_mutex_destroy(&s->lock);
+	cf_free(s->nodes);
+	cf_free(s->owners);
+	cf_free(s->namespaces);
+	cf_free(s->bins);
+	cf_free(s);
+}
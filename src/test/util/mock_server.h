@@ -0,0 +1,206 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * In-process fake cluster for client performance and stress tests. Each node listens on a
+ * loopback port and answers the info commands used by cluster tending (node, features, peers,
+ * partition-generation, replicas, ...) and single record, batch and query commands with
+ * canned responses. Partitions are spread over nodes with replication factor 1.
+ *
+ * Reads return the configured canned bins regardless of the requested bins. Writes, deletes
+ * and touches succeed without storing anything. Queries and scans return no records.
+ * Login, compression and TLS are not supported.
+ *
+ * Partition ownership and peers lists can be churned while the server runs to emulate
+ * migrations and cluster changes seen by the tend thread. Record commands sent to a node can
+ * be delayed, reset or answered with a truncated response, and nodes can be taken down, to
+ * exercise client retry, timeout and failover paths.
+ */
+
+/*****************************************************************************
+ * TYPES
+ *****************************************************************************/
+
+typedef struct mock_server_config_s {
+	/**
+	 * Namespace reported in the partition map. Default: "test"
+	 */
+	const char* ns;
+
+	/**
+	 * Number of namespaces. Namespaces after the first are named ns1, ns2, ... where ns is
+	 * the first namespace. All namespaces share the same partition map. Default: 1
+	 */
+	uint32_t n_namespaces;
+
+	/**
+	 * Number of nodes. Default: 1
+	 */
+	uint32_t n_nodes;
+
+	/**
+	 * Number of bytes bins returned by reads. Default: 1
+	 */
+	uint32_t bins;
+
+	/**
+	 * Size of each returned bin value. Default: 100
+	 */
+	uint32_t bin_size;
+
+	/**
+	 * Delay before answering each record command to emulate server latency. Default: 0
+	 */
+	uint32_t delay_us;
+} mock_server_config;
+
+/**
+ * Faults injected into record commands answered by one node. Each percentage is the chance
+ * that a command gets that fault. Info commands are never faulted.
+ */
+typedef struct mock_fault_s {
+	/**
+	 * Percent of commands answered after delay_us.
+	 */
+	uint32_t delay_pct;
+
+	/**
+	 * Injected delay in microseconds.
+	 */
+	uint32_t delay_us;
+
+	/**
+	 * Percent of commands whose connection is reset before answering.
+	 */
+	uint32_t reset_pct;
+
+	/**
+	 * Percent of commands whose connection is reset after sending half of the response.
+	 */
+	uint32_t partial_pct;
+} mock_fault;
+
+/**
+ * Server counters.
+ */
+typedef struct mock_server_stats_s {
+	/**
+	 * Record commands received, including faulted commands.
+	 */
+	uint64_t commands;
+
+	/**
+	 * Bytes of record commands received, including proto headers.
+	 */
+	uint64_t bytes_in;
+
+	uint64_t delays;
+	uint64_t resets;
+	uint64_t partials;
+} mock_server_stats;
+
+typedef struct mock_server_s mock_server;
+
+/*****************************************************************************
+ * FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * Initialize configuration to default values.
+ */
+void
+mock_server_config_init(mock_server_config* config);
+
+/**
+ * Start nodes on ephemeral loopback ports. Return NULL on failure.
+ */
+mock_server*
+mock_server_start(const mock_server_config* config);
+
+/**
+ * Return port of node at index. Any node can be used as the seed.
+ */
+uint16_t
+mock_server_port(mock_server* server, uint32_t index);
+
+/**
+ * Return name of node at index.
+ */
+const char*
+mock_server_node_name(mock_server* server, uint32_t index);
+
+/**
+ * Return name of namespace at index.
+ */
+const char*
+mock_server_namespace(mock_server* server, uint32_t index);
+
+/**
+ * Move count partitions to the next node and increment partition-generation on all nodes.
+ * Successive calls move successive partition ranges. Return the first partition moved.
+ */
+uint32_t
+mock_server_churn_partitions(mock_server* server, uint32_t count);
+
+/**
+ * Return index of the node that currently owns the partition.
+ */
+uint32_t
+mock_server_partition_owner(mock_server* server, uint32_t partition_id);
+
+/**
+ * Rotate the order of each node's peers list and increment peers-generation on all nodes,
+ * so the client fetches and compares peers again without a membership change.
+ */
+void
+mock_server_churn_peers(mock_server* server);
+
+/**
+ * Inject faults into record commands answered by node at index. Pass NULL to clear faults.
+ */
+void
+mock_server_set_fault(mock_server* server, uint32_t index, const mock_fault* fault);
+
+/**
+ * Take node at index down. Its connections are reset, new connections are reset on accept,
+ * it is removed from the peers lists of the other nodes and its partitions move to the next
+ * live node. The client removes the node on a following tend.
+ */
+void
+mock_server_kill_node(mock_server* server, uint32_t index);
+
+/**
+ * Copy server counters.
+ */
+void
+mock_server_get_stats(mock_server* server, mock_server_stats* stats);
+
+/**
+ * Return number of record commands answered by all nodes.
+ */
+uint64_t
+mock_server_commands(mock_server* server);
+
+/**
+ * Close all connections, stop nodes and release server.
+ */
+void
+mock_server_stop(mock_server* server);
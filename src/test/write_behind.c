@@ -0,0 +1,418 @@
+/*
+ * Copyright 2008-2025 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#include <aerospike/aerospike.h>
+#include <aerospike/as_atomic.h>
+#include <aerospike/as_write_behind.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "util/mock_server.h"
+
+//---------------------------------
+// Macros
+//---------------------------------
+
+#define NS "test"
+#define SET "wb"
+#define BIN "v"
+#define VALUE_SIZE 100
+
+#define SPILL_SIZE (256 * 1024)
+
+// Small log that wraps many times while a slow node replays it.
+#define WRAP_SPILL_SIZE (16 * 1024)
+#define WRAP_WRITES 2000
+
+// Spill log layout. Must match as_write_behind.c.
+#define LOG_READ_OFF 8
+#define LOG_WRITE_OFF 16
+#define LOG_DATA 24
+
+//---------------------------------
+// Global Variables
+//---------------------------------
+
+static mock_server* g_server;
+static aerospike g_mock_as;
+static char g_path[64];
+static uint32_t g_aborts;
+static uint32_t g_failures;
+
+//---------------------------------
+// Static Functions
+//---------------------------------
+
+static void
+wb_listener(as_error* err, const as_key* key, void* udata)
+{
+	if (err->code == AEROSPIKE_ERR_CLIENT_ABORT) {
+		as_incr_uint32(&g_aborts);
+	}
+	else {
+		as_incr_uint32(&g_failures);
+	}
+}
+
+static void
+wb_config_init(as_write_behind_config* config, uint64_t spill_size)
+{
+	as_write_behind_config_init(config);
+	config->spill_path = g_path;
+	config->spill_size = spill_size;
+	// One write in memory, so every other write spills.
+	config->max_pending = 1;
+	config->lanes = 1;
+	config->retry_delay_ms = 10;
+	config->listener = wb_listener;
+}
+
+static as_status
+wb_put(as_write_behind* wb, as_error* err, int64_t id)
+{
+	char value[VALUE_SIZE + 1];
+	memset(value, 'a' + (char)(id % 26), VALUE_SIZE);
+	value[VALUE_SIZE] = 0;
+
+	as_key key;
+	as_key_init_int64(&key, NS, SET, id);
+
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_str(&rec, BIN, value);
+
+	as_status status = as_write_behind_put(wb, err, &key, &rec);
+	as_record_destroy(&rec);
+	as_key_destroy(&key);
+	return status;
+}
+
+// Wait until written reaches target and nothing is pending or spilled.
+static bool
+wb_wait_written(as_write_behind* wb, uint64_t target)
+{
+	as_write_behind_stats stats;
+
+	for (uint32_t i = 0; i < 10000; i++) {
+		as_write_behind_get_stats(wb, &stats);
+
+		if (stats.written >= target && stats.pending == 0 && stats.spilled_bytes == 0) {
+			return stats.written == target;
+		}
+		usleep(1000);
+	}
+	return false;
+}
+
+static bool
+wb_pread(off_t offset, void* buf, size_t size)
+{
+	int fd = open(g_path, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	bool ok = pread(fd, buf, size, offset) == (ssize_t)size;
+	close(fd);
+	return ok;
+}
+
+static bool
+wb_pwrite(off_t offset, const void* buf, size_t size)
+{
+	int fd = open(g_path, O_WRONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	bool ok = pwrite(fd, buf, size, offset) == (ssize_t)size;
+	close(fd);
+	return ok;
+}
+
+// Spill n - 1 writes to a new log while the node resets every command. The first write stalls
+// in memory and is aborted on destroy. Return logged bytes or 0 on failure.
+static uint64_t
+wb_fill(uint32_t n)
+{
+	unlink(g_path);
+
+	mock_fault fault = {.reset_pct = 100};
+	mock_server_set_fault(g_server, 0, &fault);
+
+	as_write_behind_config config;
+	wb_config_init(&config, SPILL_SIZE);
+	// The lane is not retried before destroy.
+	config.retry_delay_ms = 60000;
+
+	as_error err;
+	as_write_behind* wb = as_write_behind_create(&g_mock_as, &err, &config);
+
+	if (! wb) {
+		error("create failed: %d %s", err.code, err.message);
+		mock_server_set_fault(g_server, 0, NULL);
+		return 0;
+	}
+
+	uint32_t aborts = as_load_uint32(&g_aborts);
+	bool ok = true;
+
+	for (uint32_t id = 0; id < n && ok; id++) {
+		ok = wb_put(wb, &err, id) == AEROSPIKE_OK;
+	}
+	as_write_behind_destroy(wb);
+	mock_server_set_fault(g_server, 0, NULL);
+
+	uint64_t read_off;
+	uint64_t write_off;
+
+	if (! ok || as_load_uint32(&g_aborts) != aborts + 1 ||
+		! wb_pread(LOG_READ_OFF, &read_off, sizeof(read_off)) ||
+		! wb_pread(LOG_WRITE_OFF, &write_off, sizeof(write_off)) || read_off != 0) {
+		return 0;
+	}
+	return write_off;
+}
+
+static bool
+wb_suite_before(atf_suite* suite)
+{
+	snprintf(g_path, sizeof(g_path), "/tmp/aerospike_wb_log_%d", (int)getpid());
+
+	mock_server_config mc;
+	mock_server_config_init(&mc);
+	g_server = mock_server_start(&mc);
+
+	if (! g_server) {
+		error("mock server start failed");
+		return false;
+	}
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, "127.0.0.1", mock_server_port(g_server, 0));
+	aerospike_init(&g_mock_as, &config);
+
+	as_error err;
+
+	if (aerospike_connect(&g_mock_as, &err) != AEROSPIKE_OK) {
+		error("connect failed: %d %s", err.code, err.message);
+		aerospike_destroy(&g_mock_as);
+		mock_server_stop(g_server);
+		return false;
+	}
+	return true;
+}
+
+static bool
+wb_suite_after(atf_suite* suite)
+{
+	as_error err;
+	aerospike_close(&g_mock_as, &err);
+	aerospike_destroy(&g_mock_as);
+	mock_server_stop(g_server);
+	unlink(g_path);
+	return true;
+}
+
+//---------------------------------
+// Test Cases
+//---------------------------------
+
+TEST(wb_reopen, "reopen populated spill log")
+{
+	uint64_t logged = wb_fill(100);
+	assert_true(logged > 0);
+
+	as_write_behind_config config;
+	wb_config_init(&config, SPILL_SIZE);
+
+	as_error err;
+	uint32_t failures = as_load_uint32(&g_failures);
+	as_write_behind* wb = as_write_behind_create(&g_mock_as, &err, &config);
+	assert_not_null(wb);
+
+	// Spilled writes are replayed in order.
+	assert_true(wb_wait_written(wb, 99));
+
+	// New writes follow the replayed ones.
+	for (int64_t id = 100; id < 110; id++) {
+		assert_int_eq(wb_put(wb, &err, id), AEROSPIKE_OK);
+	}
+	assert_true(wb_wait_written(wb, 109));
+	as_write_behind_destroy(wb);
+	assert_int_eq(as_load_uint32(&g_failures), failures);
+
+	// Drained log starts over.
+	uint64_t read_off = 1;
+	uint64_t write_off = 1;
+	assert_true(wb_pread(LOG_READ_OFF, &read_off, sizeof(read_off)));
+	assert_true(wb_pread(LOG_WRITE_OFF, &write_off, sizeof(write_off)));
+	assert_int_eq(read_off, 0);
+	assert_int_eq(write_off, 0);
+}
+
+TEST(wb_ring_wrap, "spill log wraps and rejects writes when full")
+{
+	unlink(g_path);
+
+	// Slow node keeps the log from draining while writes are spilled.
+	mock_fault fault = {.delay_pct = 100, .delay_us = 200};
+	mock_server_set_fault(g_server, 0, &fault);
+
+	as_write_behind_config config;
+	wb_config_init(&config, WRAP_SPILL_SIZE);
+
+	as_error err;
+	as_write_behind* wb = as_write_behind_create(&g_mock_as, &err, &config);
+	assert_not_null(wb);
+
+	uint64_t capacity = (WRAP_SPILL_SIZE - LOG_DATA) & ~(uint64_t)7;
+	uint32_t rejects = 0;
+	bool wrapped = false;
+
+	for (int64_t id = 0; id < WRAP_WRITES; id++) {
+		as_status status;
+
+		// A full log rejects the write. Nothing queued is dropped.
+		while ((status = wb_put(wb, &err, id)) == AEROSPIKE_ERR_ASYNC_QUEUE_FULL) {
+			rejects++;
+			usleep(200);
+		}
+		assert_int_eq(status, AEROSPIKE_OK);
+
+		uint64_t write_off;
+		assert_true(wb_pread(LOG_WRITE_OFF, &write_off, sizeof(write_off)));
+
+		if (write_off > capacity) {
+			wrapped = true;
+		}
+	}
+
+	bool drained = wb_wait_written(wb, WRAP_WRITES);
+	as_write_behind_stats stats;
+	as_write_behind_get_stats(wb, &stats);
+	as_write_behind_destroy(wb);
+	mock_server_set_fault(g_server, 0, NULL);
+
+	info("rejects: %u", rejects);
+	assert_true(drained);
+	assert_true(wrapped);
+	assert_true(rejects > 0);
+	assert_int_eq(stats.rejected, rejects);
+	assert_int_eq(stats.failed, 0);
+}
+
+TEST(wb_corrupt_header, "spill log with corrupt offsets is cleared")
+{
+	uint64_t logged = wb_fill(20);
+	assert_true(logged > 0);
+
+	// Read offset past write offset.
+	uint64_t read_off = logged + 8;
+	assert_true(wb_pwrite(LOG_READ_OFF, &read_off, sizeof(read_off)));
+
+	as_write_behind_config config;
+	wb_config_init(&config, SPILL_SIZE);
+
+	as_error err;
+	as_write_behind* wb = as_write_behind_create(&g_mock_as, &err, &config);
+	assert_not_null(wb);
+
+	as_write_behind_stats stats;
+	as_write_behind_get_stats(wb, &stats);
+	assert_int_eq(stats.spilled_bytes, 0);
+
+	for (int64_t id = 0; id < 10; id++) {
+		assert_int_eq(wb_put(wb, &err, id), AEROSPIKE_OK);
+	}
+	assert_true(wb_wait_written(wb, 10));
+	as_write_behind_destroy(wb);
+
+	// A file that is not a spill log is not overwritten.
+	uint32_t magic = 0xdeadbeef;
+	assert_true(wb_pwrite(0, &magic, sizeof(magic)));
+
+	wb = as_write_behind_create(&g_mock_as, &err, &config);
+	assert_null(wb);
+	assert_int_eq(err.code, AEROSPIKE_ERR_PARAM);
+
+	uint32_t current = 0;
+	assert_true(wb_pread(0, &current, sizeof(current)));
+	assert_int_eq(current, magic);
+	unlink(g_path);
+}
+
+TEST(wb_corrupt_record, "spill log with corrupt record size is cleared")
+{
+	uint64_t logged = wb_fill(20);
+	assert_true(logged > 0);
+
+	// First record claims more bytes than were logged.
+	uint32_t size = (uint32_t)logged + 64;
+	assert_true(wb_pwrite(LOG_DATA, &size, sizeof(size)));
+
+	as_write_behind_config config;
+	wb_config_init(&config, SPILL_SIZE);
+
+	as_error err;
+	uint32_t failures = as_load_uint32(&g_failures);
+	as_write_behind* wb = as_write_behind_create(&g_mock_as, &err, &config);
+	assert_not_null(wb);
+
+	as_write_behind_stats stats;
+	as_write_behind_get_stats(wb, &stats);
+	assert_int_eq(stats.spilled_bytes, 0);
+
+	for (int64_t id = 0; id < 10; id++) {
+		assert_int_eq(wb_put(wb, &err, id), AEROSPIKE_OK);
+	}
+	assert_true(wb_wait_written(wb, 10));
+	as_write_behind_destroy(wb);
+	assert_int_eq(as_load_uint32(&g_failures), failures);
+
+	logged = wb_fill(20);
+	assert_true(logged > 0);
+
+	// Zero size record without a following record.
+	size = 0;
+	assert_true(wb_pwrite(LOG_DATA, &size, sizeof(size)));
+
+	wb = as_write_behind_create(&g_mock_as, &err, &config);
+	assert_not_null(wb);
+	as_write_behind_get_stats(wb, &stats);
+	assert_int_eq(stats.spilled_bytes, 0);
+	as_write_behind_destroy(wb);
+}
+
+//---------------------------------
+// Test Suite
+//---------------------------------
+
+SUITE(write_behind, "Write-behind spill log tests")
+{
+	suite_before(wb_suite_before);
+	suite_after(wb_suite_after);
+
+	suite_add(wb_reopen);
+	suite_add(wb_ring_wrap);
+	suite_add(wb_corrupt_header);
+	suite_add(wb_corrupt_record);
+}